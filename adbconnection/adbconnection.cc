@@ -310,8 +310,27 @@ void AdbConnectionState::PublishDdmData(uint32_t type, const art::ArrayRef<const
     { const_cast<uint8_t*>(data.data()), data.size() },
   };
   // now pkt_header has the header.
-  // use writev to send the actual data.
-  ssize_t res = TEMP_FAILURE_RETRY(writev(adb_connection_socket_, iovs, kIovSize));
+  // use writev to send the actual data. Large chunks might not be sent in one go, so keep sending
+  // the rest from where the socket stopped instead of giving up on (or copying) the packet.
+  ssize_t res = 0;
+  struct iovec* cur_iov = iovs;
+  uint32_t iov_count = kIovSize;
+  while (static_cast<size_t>(res) != (kDdmPacketHeaderSize + data.size())) {
+    ssize_t sent = TEMP_FAILURE_RETRY(writev(adb_connection_socket_, cur_iov, iov_count));
+    if (sent <= 0) {
+      break;
+    }
+    res += sent;
+    while (iov_count != 0 && static_cast<size_t>(sent) >= cur_iov->iov_len) {
+      sent -= cur_iov->iov_len;
+      ++cur_iov;
+      --iov_count;
+    }
+    if (iov_count != 0) {
+      cur_iov->iov_base = reinterpret_cast<uint8_t*>(cur_iov->iov_base) + sent;
+      cur_iov->iov_len -= sent;
+    }
+  }
   if (static_cast<size_t>(res) != (kDdmPacketHeaderSize + data.size())) {
     PLOG(ERROR) << StringPrintf("Failed to send DDMS packet %c%c%c%c to debugger (%zd of %zu)",
                                 static_cast<char>(type >> 24),
@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.io.BufferedReader;
+import java.io.FileReader;
+import java.io.IOException;
+import java.lang.ref.WeakReference;
+import java.lang.reflect.Method;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.Comparator;
+import java.util.List;
+
+public class GcBenchmark {
+  // The number of objects allocated by one repetition.
+  private static final int ALLOCATIONS_PER_REP = 1000;
+  // The number of objects kept alive by the survival benchmarks.
+  private static final int RETAINED_OBJECTS = 64 * 1024;
+  // The depth of the trees of the reference graph benchmark.
+  private static final int TREE_DEPTH = 10;
+  // The number of trees kept alive by the reference graph benchmark.
+  private static final int RETAINED_TREES = 16;
+  // Above the large object space threshold (three pages by default).
+  private static final int LARGE_ARRAY_SIZE = 256 * 1024;
+  private static final int RETAINED_LARGE_ARRAYS = 8;
+
+  // Sinks defeating the elimination of the allocations.
+  private Object[] retained = new Object[RETAINED_OBJECTS];
+  private Node[] trees = new Node[RETAINED_TREES];
+  private byte[][] largeArrays = new byte[RETAINED_LARGE_ARRAYS][];
+  private int seed = 42;
+
+  static class Node {
+    Node left;
+    Node right;
+    Node sibling;
+    int value;
+
+    Node(int value) {
+      this.value = value;
+    }
+  }
+
+  static class Finalizable {
+    static volatile int finalized;
+    int[] payload = new int[4];
+
+    @Override
+    protected void finalize() {
+      ++finalized;
+    }
+  }
+
+  // Allocation rate by object size.
+
+  public void timeAllocSmall(int reps) {
+    allocate(reps, 16);
+  }
+
+  public void timeAllocMedium(int reps) {
+    allocate(reps, 256);
+  }
+
+  public void timeAllocLarge(int reps) {
+    allocate(reps, 4096);
+  }
+
+  // Allocation with a fraction of the objects surviving, replacing older survivors.
+
+  public void timeSurvival10(int reps) {
+    survive(reps, 10);
+  }
+
+  public void timeSurvival50(int reps) {
+    survive(reps, 50);
+  }
+
+  public void timeSurvival90(int reps) {
+    survive(reps, 90);
+  }
+
+  // Trees whose nodes also point to their siblings, so that marking follows many references.
+  public void timeReferenceGraph(int reps) {
+    int sum = 0;
+    for (int i = 0; i < reps; ++i) {
+      Node tree = buildTree(TREE_DEPTH, null);
+      trees[i % RETAINED_TREES] = tree;
+      sum += tree.value;
+    }
+    if (sum < 0) {
+      throw new Error("Unexpected sum " + sum);
+    }
+  }
+
+  public void timeFinalizerChurn(int reps) {
+    for (int i = 0; i < reps; ++i) {
+      for (int j = 0; j < ALLOCATIONS_PER_REP; ++j) {
+        new Finalizable();
+      }
+    }
+  }
+
+  // Weak references to objects of which half are kept alive a while, so that the collector
+  // both clears and preserves referents.
+  public void timeWeakReferenceChurn(int reps) {
+    int cleared = 0;
+    for (int i = 0; i < reps; ++i) {
+      for (int j = 0; j < ALLOCATIONS_PER_REP; ++j) {
+        Object referent = new int[4];
+        WeakReference<Object> reference = new WeakReference<Object>(referent);
+        if ((j & 1) == 0) {
+          retained[nextRandom() % RETAINED_OBJECTS] = referent;
+        }
+        retained[nextRandom() % RETAINED_OBJECTS] = reference;
+        if (reference.get() == null) {
+          ++cleared;
+        }
+      }
+    }
+    if (cleared != 0) {
+      throw new Error("Cleared strongly reachable referents: " + cleared);
+    }
+  }
+
+  // Arrays allocated in the large object space, a few of them alive at a time.
+  public void timeLargeArrays(int reps) {
+    for (int i = 0; i < reps; ++i) {
+      byte[] array = new byte[LARGE_ARRAY_SIZE];
+      array[i % LARGE_ARRAY_SIZE] = (byte) i;
+      largeArrays[i % RETAINED_LARGE_ARRAYS] = array;
+    }
+  }
+
+  private static void allocate(int reps, int bytes) {
+    byte[] last = null;
+    for (int i = 0; i < reps; ++i) {
+      for (int j = 0; j < ALLOCATIONS_PER_REP; ++j) {
+        last = new byte[bytes];
+      }
+    }
+    if (last != null && last.length != bytes) {
+      throw new Error("Unexpected length " + last.length);
+    }
+  }
+
+  private void survive(int reps, int percent) {
+    for (int i = 0; i < reps; ++i) {
+      for (int j = 0; j < ALLOCATIONS_PER_REP; ++j) {
+        Object object = new int[12];
+        int random = nextRandom();
+        if (random % 100 < percent) {
+          retained[(random >>> 8) % RETAINED_OBJECTS] = object;
+        }
+      }
+    }
+  }
+
+  private static Node buildTree(int depth, Node sibling) {
+    Node node = new Node(depth);
+    node.sibling = sibling;
+    if (depth != 0) {
+      node.right = buildTree(depth - 1, null);
+      node.left = buildTree(depth - 1, node.right);
+    }
+    return node;
+  }
+
+  // A linear congruential generator, so that the runs are reproducible.
+  private int nextRandom() {
+    seed = seed * 1103515245 + 12345;
+    return seed >>> 1;
+  }
+
+  // Runs the named benchmarks, or all of them, with the given number of repetitions and reports
+  // their throughput and the collector behavior. Run one benchmark per process for pause
+  // percentiles that are not mixed with those of the other benchmarks.
+  //
+  //   dalvikvm -cp gc-benchmark.jar GcBenchmark [--reps N] [AllocSmall ...]
+  public static void main(String[] args) throws Exception {
+    int reps = 1000;
+    List<String> names = new ArrayList<String>();
+    for (int i = 0; i < args.length; ++i) {
+      if (args[i].equals("--reps")) {
+        reps = Integer.parseInt(args[++i]);
+      } else {
+        names.add(args[i]);
+      }
+    }
+    List<Method> benchmarks = getBenchmarks();
+    GcBenchmark benchmark = new GcBenchmark();
+    for (Method method : benchmarks) {
+      String name = method.getName().substring("time".length());
+      if (!names.isEmpty() && !names.contains(name)) {
+        continue;
+      }
+      long gcCount = getLongStat("art.gc.gc-count");
+      long bytesAllocated = getLongStat("art.gc.bytes-allocated");
+      long start = System.nanoTime();
+      method.invoke(benchmark, reps);
+      long elapsed = System.nanoTime() - start;
+      long allocated = getLongStat("art.gc.bytes-allocated") - bytesAllocated;
+      System.out.println(name + ": " + (elapsed / reps) + " ns/rep, "
+          + (allocated * 1000L / Math.max(elapsed, 1L)) + " MB/s, "
+          + (getLongStat("art.gc.gc-count") - gcCount) + " GCs, "
+          + "RSS " + getRssKb() + " KB");
+    }
+    String pauses = getRuntimeStat("art.gc.pause-time-percentiles");
+    System.out.print("GC pauses (us):\n" + (pauses != null ? pauses : "unavailable\n"));
+  }
+
+  // The time* methods, sorted by name.
+  public static List<Method> getBenchmarks() {
+    List<Method> benchmarks = new ArrayList<Method>();
+    for (Method method : GcBenchmark.class.getDeclaredMethods()) {
+      if (method.getName().startsWith("time")) {
+        benchmarks.add(method);
+      }
+    }
+    Collections.sort(benchmarks, new Comparator<Method>() {
+      @Override
+      public int compare(Method a, Method b) {
+        return a.getName().compareTo(b.getName());
+      }
+    });
+    return benchmarks;
+  }
+
+  private static String getRuntimeStat(String name) {
+    try {
+      Class<?> vmDebug = Class.forName("dalvik.system.VMDebug");
+      Method getRuntimeStat = vmDebug.getDeclaredMethod("getRuntimeStat", String.class);
+      return (String) getRuntimeStat.invoke(null, name);
+    } catch (Exception e) {
+      // Not running on ART.
+      return null;
+    }
+  }
+
+  private static long getLongStat(String name) {
+    String value = getRuntimeStat(name);
+    return (value != null) ? Long.parseLong(value) : 0L;
+  }
+
+  // The resident set size, from /proc as the heap does not account for native allocations,
+  // or -1 if unavailable.
+  private static long getRssKb() {
+    try (BufferedReader reader = new BufferedReader(new FileReader("/proc/self/status"))) {
+      for (String line = reader.readLine(); line != null; line = reader.readLine()) {
+        if (line.startsWith("VmRSS:")) {
+          return Long.parseLong(line.substring("VmRSS:".length()).replace("kB", "").trim());
+        }
+      }
+    } catch (IOException e) {
+      // Fall through.
+    }
+    return -1L;
+  }
+}
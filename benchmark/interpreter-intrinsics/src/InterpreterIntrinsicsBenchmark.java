@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Field;
+import sun.misc.Unsafe;
+
+public class InterpreterIntrinsicsBenchmark {
+  private static final String string16 = "0123456789ABCDEF";
+  // Differs from string16 in the last character only.
+  private static final String string16Last = "0123456789ABCDE_";
+
+  private static final Unsafe unsafe = getUnsafe();
+  private static final long valueOffset = getValueOffset();
+
+  private final char[] src = new char[16];
+  private final char[] dst = new char[16];
+  private volatile int value;
+
+  private static Unsafe getUnsafe() {
+    try {
+      Field f = Unsafe.class.getDeclaredField("theUnsafe");
+      f.setAccessible(true);
+      return (Unsafe) f.get(null);
+    } catch (Exception e) {
+      throw new Error(e);
+    }
+  }
+
+  private static long getValueOffset() {
+    try {
+      return unsafe.objectFieldOffset(
+          InterpreterIntrinsicsBenchmark.class.getDeclaredField("value"));
+    } catch (Exception e) {
+      throw new Error(e);
+    }
+  }
+
+  public void timeStringEquals(int count) {
+    String s1 = string16;
+    String s2 = string16Last;
+    for (int i = 0; i < count; ++i) {
+      s1.equals(s2);
+    }
+  }
+
+  public void timeSystemArrayCopyChar(int count) {
+    char[] s = src;
+    char[] d = dst;
+    for (int i = 0; i < count; ++i) {
+      System.arraycopy(s, 0, d, 0, 16);
+    }
+  }
+
+  public void timeThreadCurrentThread(int count) {
+    for (int i = 0; i < count; ++i) {
+      Thread.currentThread();
+    }
+  }
+
+  public void timeUnsafeGetPutIntVolatile(int count) {
+    for (int i = 0; i < count; ++i) {
+      unsafe.putIntVolatile(this, valueOffset, unsafe.getIntVolatile(this, valueOffset) + 1);
+    }
+  }
+
+  public void timeFloatToIntBits(int count) {
+    float f = 1.5f;
+    for (int i = 0; i < count; ++i) {
+      Float.floatToIntBits(f);
+    }
+  }
+
+  public void timeMathMaxDouble(int count) {
+    double d = 1.5;
+    for (int i = 0; i < count; ++i) {
+      Math.max(d, 0.0);
+    }
+  }
+}
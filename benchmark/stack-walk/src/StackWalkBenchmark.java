@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class StackWalkBenchmark {
+  private static final int DEPTH = 64;
+
+  public StackWalkBenchmark() {
+    // Make sure to link methods before benchmark starts.
+    System.loadLibrary("artbenchmark");
+    timeWalkStack(1);
+    timeWalkStackSkipInlinedFrames(1);
+  }
+
+  public void timeWalkStack(int reps) {
+    recurse(DEPTH, reps, /* skipInlinedFrames */ false);
+  }
+
+  public void timeWalkStackSkipInlinedFrames(int reps) {
+    recurse(DEPTH, reps, /* skipInlinedFrames */ true);
+  }
+
+  private static int recurse(int depth, int reps, boolean skipInlinedFrames) {
+    if (depth == 0) {
+      return walkStack(reps, skipInlinedFrames);
+    }
+    // Small enough to be inlined, so that the frames of `recurse` have inline infos.
+    return inlined(depth - 1, reps, skipInlinedFrames) + 1;
+  }
+
+  private static int inlined(int depth, int reps, boolean skipInlinedFrames) {
+    return recurse(depth, reps, skipInlinedFrames);
+  }
+
+  // Walks the stack `reps` times, returns the number of frames of the last walk.
+  private static native int walkStack(int reps, boolean skipInlinedFrames);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jni.h"
+
+#include "art_method-inl.h"
+#include "scoped_thread_state_change-inl.h"
+#include "stack.h"
+#include "thread.h"
+
+namespace art {
+namespace {
+
+class DexPcVisitor : public StackVisitor {
+ public:
+  DexPcVisitor(Thread* thread, StackWalkKind walk_kind)
+      : StackVisitor(thread, /* context */ nullptr, walk_kind),
+        num_frames_(0u),
+        dex_pcs_(0u) {}
+
+  bool VisitFrame() OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_) {
+    ArtMethod* method = GetMethod();
+    if (method == nullptr || method->IsRuntimeMethod()) {
+      return true;
+    }
+    // The dex pc of a compiled frame is found with its stack map.
+    dex_pcs_ += GetDexPc(/* abort_on_failure */ false);
+    ++num_frames_;
+    return true;
+  }
+
+  size_t num_frames_;
+  uint32_t dex_pcs_;
+};
+
+extern "C" JNIEXPORT jint JNICALL Java_StackWalkBenchmark_walkStack(
+    JNIEnv* env, jclass, jint reps, jboolean skip_inlined_frames) {
+  ScopedObjectAccess soa(env);
+  const StackVisitor::StackWalkKind walk_kind = skip_inlined_frames
+      ? StackVisitor::StackWalkKind::kSkipInlinedFrames
+      : StackVisitor::StackWalkKind::kIncludeInlinedFrames;
+  size_t num_frames = 0u;
+  for (jint i = 0; i < reps; ++i) {
+    DexPcVisitor visitor(soa.Self(), walk_kind);
+    visitor.WalkStack();
+    num_frames = visitor.num_frames_;
+  }
+  return static_cast<jint>(num_frames);
+}
+
+}  // namespace
+}  // namespace art
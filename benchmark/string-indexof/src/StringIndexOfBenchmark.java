@@ -16,6 +16,11 @@
 
 public class StringIndexOfBenchmark {
     public static final String string36 = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";  // length = 36
+    // Differs from string36 in the last character only.
+    public static final String string36Last = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXY_";
+    // Not compressible, with a non-ASCII first character.
+    public static final String string36u = "\u01000123456789ABCDEFGHIJKLMNOPQRSTUVWXY";
+    public static final String string36uLast = "\u01000123456789ABCDEFGHIJKLMNOPQRSTUVWX_";
 
     public void timeIndexOf0(int count) {
         final char c = '0';
@@ -113,10 +118,74 @@ public class StringIndexOfBenchmark {
         }
     }
 
+    public void timeIndexOfString(int count) {
+        final String needle = "WXY";
+        String s = string36;
+        for (int i = 0; i < count; ++i) {
+            $noinline$indexOf(s, needle);
+        }
+    }
+
+    public void timeIndexOfStringNotFound(int count) {
+        final String needle = "XYZ_";
+        String s = string36;
+        for (int i = 0; i < count; ++i) {
+            $noinline$indexOf(s, needle);
+        }
+    }
+
+    // Equal contents in distinct objects, so that all the characters are compared.
+    public void timeEquals(int count) {
+        String s = string36;
+        String other = new String(string36);
+        for (int i = 0; i < count; ++i) {
+            $noinline$equals(s, other);
+        }
+    }
+
+    public void timeEqualsUncompressed(int count) {
+        String s = string36u;
+        String other = new String(string36u);
+        for (int i = 0; i < count; ++i) {
+            $noinline$equals(s, other);
+        }
+    }
+
+    public void timeCompareTo(int count) {
+        String s = string36;
+        String other = string36Last;
+        for (int i = 0; i < count; ++i) {
+            $noinline$compareTo(s, other);
+        }
+    }
+
+    public void timeCompareToUncompressed(int count) {
+        String s = string36u;
+        String other = string36uLast;
+        for (int i = 0; i < count; ++i) {
+            $noinline$compareTo(s, other);
+        }
+    }
+
     static int $noinline$indexOf(String s, char c) {
         if (doThrow) { throw new Error(); }
         return s.indexOf(c);
     }
 
+    static int $noinline$indexOf(String s, String needle) {
+        if (doThrow) { throw new Error(); }
+        return s.indexOf(needle);
+    }
+
+    static boolean $noinline$equals(String s, String other) {
+        if (doThrow) { throw new Error(); }
+        return s.equals(other);
+    }
+
+    static int $noinline$compareTo(String s, String other) {
+        if (doThrow) { throw new Error(); }
+        return s.compareTo(other);
+    }
+
     public static boolean doThrow = false;
 }
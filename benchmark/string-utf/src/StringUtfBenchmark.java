@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class StringUtfBenchmark {
+  // Long enough to exercise the vectorized ASCII paths of the UTF conversions.
+  private static final String ASCII =
+      "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.";
+  private static final String MIXED =
+      "The quick brown fox jumps over the lazy d\u00f6g. The quick brown fox jumps over the lazy dog.";
+
+  public StringUtfBenchmark() {
+    // Make sure to link methods before benchmark starts.
+    System.loadLibrary("artbenchmark");
+    timeNewStringUtfAscii(1);
+    timeNewStringUtfMixed(1);
+    timeGetStringUtfCharsAscii(1);
+    timeGetStringUtfCharsMixed(1);
+  }
+
+  public void timeNewStringUtfAscii(int reps) {
+    newStringUtf(ASCII, reps);
+  }
+
+  public void timeNewStringUtfMixed(int reps) {
+    newStringUtf(MIXED, reps);
+  }
+
+  public void timeGetStringUtfCharsAscii(int reps) {
+    getStringUtfChars(ASCII, reps);
+  }
+
+  public void timeGetStringUtfCharsMixed(int reps) {
+    getStringUtfChars(MIXED, reps);
+  }
+
+  // Creates 'reps' strings from the modified UTF-8 encoding of 's'.
+  private static native void newStringUtf(String s, int reps);
+  // Gets the modified UTF-8 encoding of 's' 'reps' times.
+  private static native void getStringUtfChars(String s, int reps);
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2018 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include "jni.h"
+
+#include "base/logging.h"
+
+namespace art {
+namespace {
+
+extern "C" JNIEXPORT void JNICALL Java_StringUtfBenchmark_newStringUtf(
+    JNIEnv* env, jclass, jstring s, jint reps) {
+  const char* chars = env->GetStringUTFChars(s, nullptr);
+  CHECK(chars != nullptr);
+  std::string utf(chars);
+  env->ReleaseStringUTFChars(s, chars);
+  for (jint i = 0; i < reps; ++i) {
+    jstring str = env->NewStringUTF(utf.c_str());
+    env->DeleteLocalRef(str);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_StringUtfBenchmark_getStringUtfChars(
+    JNIEnv* env, jclass, jstring s, jint reps) {
+  for (jint i = 0; i < reps; ++i) {
+    const char* chars = env->GetStringUTFChars(s, nullptr);
+    CHECK(chars != nullptr);
+    env->ReleaseStringUTFChars(s, chars);
+  }
+}
+
+}  // namespace
+}  // namespace art
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class ThrowCatchBenchmark {
+  private static final int SHALLOW = 4;
+  private static final int DEEP = 64;
+
+  static class ParseException extends Exception {
+    ParseException() {}
+
+    ParseException(boolean writableStackTrace) {
+      super(null, null, /* enableSuppression */ false, writableStackTrace);
+    }
+  }
+
+  public void timeThrowShallow(int reps) {
+    throwAndCatch(reps, SHALLOW, /* writableStackTrace */ true);
+  }
+
+  public void timeThrowDeep(int reps) {
+    throwAndCatch(reps, DEEP, /* writableStackTrace */ true);
+  }
+
+  public void timeThrowWithoutStackTraceDeep(int reps) {
+    throwAndCatch(reps, DEEP, /* writableStackTrace */ false);
+  }
+
+  public void timeGetStackTraceDeep(int reps) {
+    int frames = 0;
+    for (int i = 0; i < reps; ++i) {
+      try {
+        recurse(DEEP, /* writableStackTrace */ true);
+      } catch (ParseException e) {
+        frames += e.getStackTrace().length;
+      }
+    }
+    if (frames < reps * DEEP) {
+      throw new Error("Missing frames: " + frames);
+    }
+  }
+
+  private static void throwAndCatch(int reps, int depth, boolean writableStackTrace) {
+    int caught = 0;
+    for (int i = 0; i < reps; ++i) {
+      try {
+        recurse(depth, writableStackTrace);
+      } catch (ParseException e) {
+        ++caught;
+      }
+    }
+    if (caught != reps) {
+      throw new Error("Caught " + caught + " of " + reps);
+    }
+  }
+
+  private static int recurse(int depth, boolean writableStackTrace) throws ParseException {
+    if (depth == 0) {
+      throw writableStackTrace ? new ParseException() : new ParseException(false);
+    }
+    return recurse(depth - 1, writableStackTrace) + 1;
+  }
+}
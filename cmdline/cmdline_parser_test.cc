@@ -224,6 +224,22 @@ TEST_F(CmdlineParserTest, TestSimpleSuccesses) {
   EXPECT_SINGLE_PARSE_VALUE(false, "-XX:DisableHSpaceCompactForOOM", M::EnableHSpaceCompactForOOM);
   EXPECT_SINGLE_PARSE_VALUE(0.5, "-XX:HeapTargetUtilization=0.5", M::HeapTargetUtilization);
   EXPECT_SINGLE_PARSE_VALUE(5u, "-XX:ParallelGCThreads=5", M::ParallelGCThreads);
+  EXPECT_SINGLE_PARSE_VALUE(MillisecondsToNanoseconds::FromMilliseconds(4),
+                            "-XX:GcPauseTarget=4", M::GcPauseTarget);
+  EXPECT_SINGLE_PARSE_VALUE(10u, "-XX:GcCpuBudgetPercent=10", M::GcCpuBudgetPercent);
+  EXPECT_SINGLE_PARSE_VALUE(Memory<1>(512 * KB), "-XX:AllocSampleInterval=512k",
+                            M::AllocSampleInterval);
+  EXPECT_SINGLE_PARSE_EXISTS("-XX:TransparentHugePages", M::TransparentHugePages);
+  EXPECT_SINGLE_PARSE_EXISTS("-XX:NumaAwareHeap", M::NumaAwareHeap);
+  EXPECT_SINGLE_PARSE_VALUE("/data/misc/gc_metrics", "-XX:GcMetricsFile=/data/misc/gc_metrics",
+                            M::GcMetricsFile);
+  EXPECT_SINGLE_PARSE_VALUE("/data/misc/counters", "-XX:RuntimeCountersFile=/data/misc/counters",
+                            M::RuntimeCountersFile);
+  EXPECT_SINGLE_PARSE_VALUE("gc,jit", "-XX:TraceCategories=gc,jit", M::TraceCategories);
+  EXPECT_SINGLE_PARSE_VALUE("/data/misc/timings", "-XX:TimingTraceFile=/data/misc/timings",
+                            M::TimingTraceFile);
+  EXPECT_SINGLE_PARSE_VALUE(Memory<1>(4 * MB), "-XX:HeapTrimReleaseBudget=4m",
+                            M::HeapTrimReleaseBudget);
   EXPECT_SINGLE_PARSE_EXISTS("-Xno-dex-file-fallback", M::NoDexFileFallback);
 }  // TEST_F
 
@@ -238,6 +254,7 @@ TEST_F(CmdlineParserTest, TestSimpleFailures) {
   EXPECT_SINGLE_PARSE_FAIL("-XX:HeapTargetUtilization=0.0", CmdlineResult::kOutOfRange);  // toosmal
   EXPECT_SINGLE_PARSE_FAIL("-XX:HeapTargetUtilization=2.0", CmdlineResult::kOutOfRange);  // toolarg
   EXPECT_SINGLE_PARSE_FAIL("-XX:ParallelGCThreads=-5", CmdlineResult::kOutOfRange);  // too small
+  EXPECT_SINGLE_PARSE_FAIL("-XX:GcCpuBudgetPercent=100", CmdlineResult::kOutOfRange);  // too large
   EXPECT_SINGLE_PARSE_FAIL("-Xgc:blablabla", CmdlineResult::kUsage);  // not a valid suboption
 }  // TEST_F
 
@@ -328,12 +345,15 @@ TEST_F(CmdlineParserTest, DISABLED_TestXGcOption) {
     option_all_true.verify_pre_gc_rosalloc_ = true;
     option_all_true.verify_pre_sweeping_rosalloc_ = true;
     option_all_true.verify_post_gc_rosalloc_ = true;
+    option_all_true.generational_cc_ = true;
+    option_all_true.class_histogram_ = true;
+    option_all_true.measure_tlb_misses_ = true;
 
     const char * xgc_args_all_true = "-Xgc:concurrent,"
         "preverify,presweepingverify,postverify,"
         "preverify_rosalloc,presweepingverify_rosalloc,"
         "postverify_rosalloc,precise,"
-        "verifycardtable";
+        "verifycardtable,generational_cc,classhistogram,measuretlb";
 
     EXPECT_SINGLE_PARSE_VALUE(option_all_true, xgc_args_all_true, M::GcOption);
 
@@ -345,10 +365,14 @@ TEST_F(CmdlineParserTest, DISABLED_TestXGcOption) {
     option_all_false.verify_pre_gc_rosalloc_ = false;
     option_all_false.verify_pre_sweeping_rosalloc_ = false;
     option_all_false.verify_post_gc_rosalloc_ = false;
+    option_all_false.generational_cc_ = false;
+    option_all_false.class_histogram_ = false;
+    option_all_false.measure_tlb_misses_ = false;
 
     const char* xgc_args_all_false = "-Xgc:nonconcurrent,"
         "nopreverify,nopresweepingverify,nopostverify,nopreverify_rosalloc,"
-        "nopresweepingverify_rosalloc,nopostverify_rosalloc,noprecise,noverifycardtable";
+        "nopresweepingverify_rosalloc,nopostverify_rosalloc,noprecise,noverifycardtable,"
+        "nogenerational_cc,noclasshistogram,nomeasuretlb";
 
     EXPECT_SINGLE_PARSE_VALUE(option_all_false, xgc_args_all_false, M::GcOption);
 
@@ -474,6 +498,19 @@ TEST_F(CmdlineParserTest, TestJitOptions) {
   {
     EXPECT_SINGLE_PARSE_VALUE(12345u, "-Xjitthreshold:12345", M::JITCompileThreshold);
   }
+  {
+    EXPECT_SINGLE_PARSE_VALUE(4u, "-Xjitthreads:4", M::JITThreadPoolSize);
+  }
+  {
+    EXPECT_SINGLE_PARSE_VALUE(8u, "-Xjitsampleperiod:8", M::JITSamplePeriod);
+  }
+  {
+    EXPECT_SINGLE_PARSE_VALUE(
+        20000u, "-Xjitoptimizethreshold:20000", M::JITOptimizeThreshold);
+  }
+  {
+    EXPECT_SINGLE_PARSE_EXISTS("-Xjitprecompilehotmethods", M::JITPrecompileHotMethods);
+  }
 }  // TEST_F
 
 /*
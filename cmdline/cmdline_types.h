@@ -435,6 +435,12 @@ struct XGcOption {
   // Do no measurements for kUseTableLookupReadBarrier to avoid test timeouts. b/31679493
   bool measure_ = kIsDebugBuild && !kUseTableLookupReadBarrier;
   bool gcstress_ = false;
+  // Use the young-generation (sticky) mode of the concurrent copying collector.
+  bool generational_cc_ = false;
+  // Build a per-class live instance histogram during full concurrent copying collections.
+  bool class_histogram_ = false;
+  // Count the data TLB misses of the GC-running thread during collections.
+  bool measure_tlb_misses_ = false;
 };
 
 template <>
@@ -478,6 +484,18 @@ struct CmdlineType<XGcOption> : CmdlineTypeParser<XGcOption> {
         xgc.gcstress_ = false;
       } else if (gc_option == "measure") {
         xgc.measure_ = true;
+      } else if (gc_option == "generational_cc") {
+        xgc.generational_cc_ = true;
+      } else if (gc_option == "nogenerational_cc") {
+        xgc.generational_cc_ = false;
+      } else if (gc_option == "classhistogram") {
+        xgc.class_histogram_ = true;
+      } else if (gc_option == "noclasshistogram") {
+        xgc.class_histogram_ = false;
+      } else if (gc_option == "measuretlb") {
+        xgc.measure_tlb_misses_ = true;
+      } else if (gc_option == "nomeasuretlb") {
+        xgc.measure_tlb_misses_ = false;
       } else if ((gc_option == "precise") ||
                  (gc_option == "noprecise") ||
                  (gc_option == "verifycardtable") ||
@@ -54,14 +54,23 @@ class ElfDebugLineWriter {
   // Write line table for given set of methods.
   // Returns the number of bytes written.
   size_t WriteCompilationUnit(ElfCompilationUnit& compilation_unit) {
+    std::vector<uint8_t> buffer;
+    std::vector<uintptr_t> patches;
+    EncodeCompilationUnit(compilation_unit, &buffer, &patches);
+    return WriteEncodedCompilationUnit(compilation_unit, buffer, patches);
+  }
+
+  // Encode line table for given set of methods as if it was at the start of .debug_line.
+  // This only reads the builder, so line tables can be encoded on several threads.
+  void EncodeCompilationUnit(const ElfCompilationUnit& compilation_unit,
+                             /*out*/ std::vector<uint8_t>* buffer,
+                             /*out*/ std::vector<uintptr_t>* patches) const {
     const InstructionSet isa = builder_->GetIsa();
     const bool is64bit = Is64BitInstructionSet(isa);
     const Elf_Addr base_address = compilation_unit.is_code_address_text_relative
         ? builder_->GetText()->GetAddress()
         : 0;
 
-    compilation_unit.debug_line_offset = builder_->GetDebugLine()->GetPosition();
-
     std::vector<dwarf::FileEntry> files;
     std::unordered_map<std::string, size_t> files_map;
     std::vector<std::string> directories;
@@ -266,10 +275,20 @@ class ElfDebugLineWriter {
       opcodes.AdvancePC(method_address + mi->code_size);
       opcodes.EndSequence();
     }
-    std::vector<uint8_t> buffer;
-    buffer.reserve(opcodes.data()->size() + KB);
+    buffer->reserve(opcodes.data()->size() + KB);
+    WriteDebugLineTable(directories, files, opcodes, /* debug_line_offset */ 0, buffer, patches);
+  }
+
+  // Write line table encoded by EncodeCompilationUnit().
+  // Returns the number of bytes written.
+  size_t WriteEncodedCompilationUnit(ElfCompilationUnit& compilation_unit,
+                                     const std::vector<uint8_t>& buffer,
+                                     const std::vector<uintptr_t>& patches) {
     size_t offset = builder_->GetDebugLine()->GetPosition();
-    WriteDebugLineTable(directories, files, opcodes, offset, &buffer, &debug_line_patches_);
+    compilation_unit.debug_line_offset = offset;
+    for (uintptr_t patch_location : patches) {
+      debug_line_patches_.push_back(offset + patch_location);
+    }
     builder_->GetDebugLine()->WriteFully(buffer.data(), buffer.size());
     return buffer.size();
   }
@@ -16,6 +16,7 @@
 
 #include "elf_debug_writer.h"
 
+#include <memory>
 #include <vector>
 #include <unordered_map>
 
@@ -32,15 +33,52 @@
 #include "linker/elf_builder.h"
 #include "linker/vector_output_stream.h"
 #include "oat.h"
+#include "thread-current-inl.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace debug {
 
+// Encodes the line tables of every `stride`-th compilation unit, starting from `begin`.
+template <typename ElfTypes>
+class DebugLineEncodingTask : public Task {
+ public:
+  DebugLineEncodingTask(const ElfDebugLineWriter<ElfTypes>* line_writer,
+                        const std::vector<ElfCompilationUnit>* compilation_units,
+                        size_t begin,
+                        size_t stride,
+                        std::vector<std::vector<uint8_t>>* buffers,
+                        std::vector<std::vector<uintptr_t>>* patches)
+      : line_writer_(line_writer),
+        compilation_units_(compilation_units),
+        begin_(begin),
+        stride_(stride),
+        buffers_(buffers),
+        patches_(patches) {
+  }
+
+  void Run(Thread*) OVERRIDE {
+    for (size_t i = begin_; i < compilation_units_->size(); i += stride_) {
+      line_writer_->EncodeCompilationUnit(
+          (*compilation_units_)[i], &(*buffers_)[i], &(*patches_)[i]);
+    }
+  }
+
+ private:
+  const ElfDebugLineWriter<ElfTypes>* const line_writer_;
+  const std::vector<ElfCompilationUnit>* const compilation_units_;
+  const size_t begin_;
+  const size_t stride_;
+  std::vector<std::vector<uint8_t>>* const buffers_;
+  std::vector<std::vector<uintptr_t>>* const patches_;
+};
+
 template <typename ElfTypes>
 void WriteDebugInfo(linker::ElfBuilder<ElfTypes>* builder,
                     const ArrayRef<const MethodDebugInfo>& method_infos,
                     dwarf::CFIFormat cfi_format,
-                    bool write_oat_patches) {
+                    bool write_oat_patches,
+                    ThreadPool* thread_pool) {
   // Write .strtab and .symtab.
   WriteDebugSymbols(builder, method_infos, true /* with_signature */);
 
@@ -87,8 +125,29 @@ void WriteDebugInfo(linker::ElfBuilder<ElfTypes>* builder,
   if (!compilation_units.empty()) {
     ElfDebugLineWriter<ElfTypes> line_writer(builder);
     line_writer.Start();
-    for (auto& compilation_unit : compilation_units) {
-      line_writer.WriteCompilationUnit(compilation_unit);
+    if (thread_pool != nullptr && compilation_units.size() > 1u) {
+      // Encode the line tables in parallel, then write them in order for deterministic output.
+      size_t num_units = compilation_units.size();
+      std::vector<std::vector<uint8_t>> buffers(num_units);
+      std::vector<std::vector<uintptr_t>> patches(num_units);
+      size_t num_tasks = std::min(thread_pool->GetThreadCount() + 1u, num_units);
+      std::vector<std::unique_ptr<DebugLineEncodingTask<ElfTypes>>> tasks;
+      tasks.reserve(num_tasks);
+      Thread* self = Thread::Current();
+      for (size_t i = 0; i != num_tasks; ++i) {
+        tasks.emplace_back(new DebugLineEncodingTask<ElfTypes>(
+            &line_writer, &compilation_units, i, num_tasks, &buffers, &patches));
+        thread_pool->AddTask(self, tasks.back().get());
+      }
+      thread_pool->StartWorkers(self);
+      thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ false);
+      for (size_t i = 0; i != num_units; ++i) {
+        line_writer.WriteEncodedCompilationUnit(compilation_units[i], buffers[i], patches[i]);
+      }
+    } else {
+      for (auto& compilation_unit : compilation_units) {
+        line_writer.WriteCompilationUnit(compilation_unit);
+      }
     }
     line_writer.End(write_oat_patches);
   }
@@ -153,7 +212,8 @@ static std::vector<uint8_t> MakeElfFileForJITInternal(
     WriteDebugInfo(builder.get(),
                    method_infos,
                    dwarf::DW_DEBUG_FRAME_FORMAT,
-                   false /* write_oat_patches */);
+                   false /* write_oat_patches */,
+                   /* thread_pool */ nullptr);
   }
   builder->End();
   CHECK(builder->Good());
@@ -211,12 +271,14 @@ template void WriteDebugInfo<ElfTypes32>(
     linker::ElfBuilder<ElfTypes32>* builder,
     const ArrayRef<const MethodDebugInfo>& method_infos,
     dwarf::CFIFormat cfi_format,
-    bool write_oat_patches);
+    bool write_oat_patches,
+    ThreadPool* thread_pool);
 template void WriteDebugInfo<ElfTypes64>(
     linker::ElfBuilder<ElfTypes64>* builder,
     const ArrayRef<const MethodDebugInfo>& method_infos,
     dwarf::CFIFormat cfi_format,
-    bool write_oat_patches);
+    bool write_oat_patches,
+    ThreadPool* thread_pool);
 
 }  // namespace debug
 }  // namespace art
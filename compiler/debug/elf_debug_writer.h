@@ -27,18 +27,21 @@
 
 namespace art {
 class OatHeader;
+class ThreadPool;
 namespace mirror {
 class Class;
 }  // namespace mirror
 namespace debug {
 struct MethodDebugInfo;
 
+// If the thread pool is not null, parts of the debug info are generated on its workers.
 template <typename ElfTypes>
 void WriteDebugInfo(
     linker::ElfBuilder<ElfTypes>* builder,
     const ArrayRef<const MethodDebugInfo>& method_infos,
     dwarf::CFIFormat cfi_format,
-    bool write_oat_patches);
+    bool write_oat_patches,
+    ThreadPool* thread_pool);
 
 std::vector<uint8_t> MakeMiniDebugInfo(
     InstructionSet isa,
@@ -0,0 +1,587 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compiled_method_cache.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "base/array_ref.h"
+#include "base/logging.h"
+#include "base/unix_file/fd_file.h"
+#include "compiled_method.h"
+#include "compiler_driver.h"
+#include "dex_file-inl.h"
+#include "leb128.h"
+#include "linker/linker_patch.h"
+#include "os.h"
+
+namespace art {
+
+using linker::LinkerPatch;
+
+static constexpr uint8_t kCacheMagic[] = { 'c', 'm', 'c', '\n', '0', '0', '1', '\0' };
+
+// Dex file index written for the patches which don't refer to a dex file.
+static constexpr uint32_t kNoDexFile = 0u;
+
+static void WriteBytes(std::vector<uint8_t>* out, ArrayRef<const uint8_t> bytes) {
+  EncodeUnsignedLeb128(out, bytes.size());
+  out->insert(out->end(), bytes.begin(), bytes.end());
+}
+
+static void WriteString(std::vector<uint8_t>* out, const std::string& str) {
+  WriteBytes(out, ArrayRef<const uint8_t>(reinterpret_cast<const uint8_t*>(str.data()),
+                                          str.size()));
+}
+
+// Reads the entries of the cache, failing instead of reading past the end of truncated files.
+class CacheReader {
+ public:
+  CacheReader(const uint8_t* begin, const uint8_t* end) : ptr_(begin), end_(end) {}
+
+  bool ReadUint32(uint32_t* value) {
+    return DecodeUnsignedLeb128Checked(&ptr_, end_, value);
+  }
+
+  bool ReadBytes(ArrayRef<const uint8_t>* bytes) {
+    uint32_t size;
+    if (!ReadUint32(&size) || size > static_cast<size_t>(end_ - ptr_)) {
+      return false;
+    }
+    *bytes = ArrayRef<const uint8_t>(ptr_, size);
+    ptr_ += size;
+    return true;
+  }
+
+  bool ReadString(std::string* str) {
+    ArrayRef<const uint8_t> bytes;
+    if (!ReadBytes(&bytes)) {
+      return false;
+    }
+    str->assign(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return true;
+  }
+
+  const uint8_t* GetPosition() const {
+    return ptr_;
+  }
+
+ private:
+  const uint8_t* ptr_;
+  const uint8_t* const end_;
+};
+
+// Returns the index of the dex file of the patch plus one, or kNoDexFile, and the values
+// identifying its target. Returns false if the target is in a dex file not compiled with it.
+static bool EncodePatch(const LinkerPatch& patch,
+                        const SafeMap<const DexFile*, uint32_t>& dex_file_indexes,
+                        uint32_t* dex_file_index,
+                        uint32_t* value1,
+                        uint32_t* value2) {
+  const DexFile* dex_file = nullptr;
+  switch (patch.GetType()) {
+    case LinkerPatch::Type::kMethodRelative:
+    case LinkerPatch::Type::kMethodBssEntry:
+      dex_file = patch.TargetMethod().dex_file;
+      *value1 = patch.TargetMethod().index;
+      *value2 = patch.PcInsnOffset();
+      break;
+    case LinkerPatch::Type::kCall:
+    case LinkerPatch::Type::kCallRelative:
+      dex_file = patch.TargetMethod().dex_file;
+      *value1 = patch.TargetMethod().index;
+      *value2 = 0u;
+      break;
+    case LinkerPatch::Type::kTypeRelative:
+    case LinkerPatch::Type::kTypeClassTable:
+    case LinkerPatch::Type::kTypeBssEntry:
+      dex_file = patch.TargetTypeDexFile();
+      *value1 = patch.TargetTypeIndex().index_;
+      *value2 = patch.PcInsnOffset();
+      break;
+    case LinkerPatch::Type::kStringRelative:
+    case LinkerPatch::Type::kStringInternTable:
+    case LinkerPatch::Type::kStringBssEntry:
+      dex_file = patch.TargetStringDexFile();
+      *value1 = patch.TargetStringIndex().index_;
+      *value2 = patch.PcInsnOffset();
+      break;
+    case LinkerPatch::Type::kBakerReadBarrierBranch:
+      *dex_file_index = kNoDexFile;
+      *value1 = patch.GetBakerCustomValue1();
+      *value2 = patch.GetBakerCustomValue2();
+      return true;
+  }
+  auto it = dex_file_indexes.find(dex_file);
+  if (it == dex_file_indexes.end()) {
+    return false;
+  }
+  *dex_file_index = it->second + 1u;
+  return true;
+}
+
+static bool DecodePatch(uint32_t type,
+                        uint32_t literal_offset,
+                        const DexFile* dex_file,
+                        uint32_t value1,
+                        uint32_t value2,
+                        std::vector<LinkerPatch>* patches) {
+  if (type > static_cast<uint32_t>(LinkerPatch::Type::kBakerReadBarrierBranch) ||
+      !IsUint<24>(literal_offset)) {
+    return false;
+  }
+  if ((dex_file == nullptr) !=
+      (type == static_cast<uint32_t>(LinkerPatch::Type::kBakerReadBarrierBranch))) {
+    return false;
+  }
+  switch (static_cast<LinkerPatch::Type>(type)) {
+    case LinkerPatch::Type::kMethodRelative:
+      patches->push_back(
+          LinkerPatch::RelativeMethodPatch(literal_offset, dex_file, value2, value1));
+      return true;
+    case LinkerPatch::Type::kMethodBssEntry:
+      patches->push_back(
+          LinkerPatch::MethodBssEntryPatch(literal_offset, dex_file, value2, value1));
+      return true;
+    case LinkerPatch::Type::kCall:
+      patches->push_back(LinkerPatch::CodePatch(literal_offset, dex_file, value1));
+      return true;
+    case LinkerPatch::Type::kCallRelative:
+      patches->push_back(LinkerPatch::RelativeCodePatch(literal_offset, dex_file, value1));
+      return true;
+    case LinkerPatch::Type::kTypeRelative:
+      patches->push_back(LinkerPatch::RelativeTypePatch(literal_offset, dex_file, value2, value1));
+      return true;
+    case LinkerPatch::Type::kTypeClassTable:
+      patches->push_back(
+          LinkerPatch::TypeClassTablePatch(literal_offset, dex_file, value2, value1));
+      return true;
+    case LinkerPatch::Type::kTypeBssEntry:
+      patches->push_back(LinkerPatch::TypeBssEntryPatch(literal_offset, dex_file, value2, value1));
+      return true;
+    case LinkerPatch::Type::kStringRelative:
+      patches->push_back(
+          LinkerPatch::RelativeStringPatch(literal_offset, dex_file, value2, value1));
+      return true;
+    case LinkerPatch::Type::kStringInternTable:
+      patches->push_back(
+          LinkerPatch::StringInternTablePatch(literal_offset, dex_file, value2, value1));
+      return true;
+    case LinkerPatch::Type::kStringBssEntry:
+      patches->push_back(
+          LinkerPatch::StringBssEntryPatch(literal_offset, dex_file, value2, value1));
+      return true;
+    case LinkerPatch::Type::kBakerReadBarrierBranch:
+      patches->push_back(LinkerPatch::BakerReadBarrierBranchPatch(literal_offset, value1, value2));
+      return true;
+  }
+  return false;
+}
+
+std::vector<std::vector<uint32_t>> CompiledMethodCache::ComputeDependencies(
+    const std::vector<const DexFile*>& dex_files,
+    bool depends_on_all_dex_files) {
+  const size_t num_dex_files = dex_files.size();
+  std::vector<std::vector<uint32_t>> dependencies(num_dex_files);
+  if (depends_on_all_dex_files) {
+    for (std::vector<uint32_t>& dex_file_dependencies : dependencies) {
+      for (size_t i = 0; i != num_dex_files; ++i) {
+        dex_file_dependencies.push_back(i);
+      }
+    }
+    return dependencies;
+  }
+
+  // The class loader uses the first definition of a class.
+  std::unordered_map<std::string, uint32_t> defining_dex_files;
+  for (size_t i = 0; i != num_dex_files; ++i) {
+    const DexFile& dex_file = *dex_files[i];
+    for (size_t j = 0, num_class_defs = dex_file.NumClassDefs(); j != num_class_defs; ++j) {
+      defining_dex_files.emplace(dex_file.GetClassDescriptor(dex_file.GetClassDef(j)), i);
+    }
+  }
+
+  // Any reference to a class, field or method of another dex file goes through a type id.
+  std::vector<std::vector<uint32_t>> references(num_dex_files);
+  for (size_t i = 0; i != num_dex_files; ++i) {
+    const DexFile& dex_file = *dex_files[i];
+    std::vector<bool> referenced(num_dex_files, false);
+    for (size_t j = 0, num_type_ids = dex_file.NumTypeIds(); j != num_type_ids; ++j) {
+      const char* descriptor = dex_file.StringByTypeIdx(dex::TypeIndex(j));
+      while (*descriptor == '[') {
+        ++descriptor;
+      }
+      auto it = defining_dex_files.find(descriptor);
+      if (it != defining_dex_files.end() && it->second != i && !referenced[it->second]) {
+        referenced[it->second] = true;
+        references[i].push_back(it->second);
+      }
+    }
+  }
+
+  for (size_t i = 0; i != num_dex_files; ++i) {
+    std::vector<bool> visited(num_dex_files, false);
+    std::vector<uint32_t> worklist = { static_cast<uint32_t>(i) };
+    visited[i] = true;
+    while (!worklist.empty()) {
+      uint32_t index = worklist.back();
+      worklist.pop_back();
+      dependencies[i].push_back(index);
+      for (uint32_t reference : references[index]) {
+        if (!visited[reference]) {
+          visited[reference] = true;
+          worklist.push_back(reference);
+        }
+      }
+    }
+    std::sort(dependencies[i].begin(), dependencies[i].end());
+  }
+  return dependencies;
+}
+
+CompiledMethodCache::CompiledMethodCache(std::vector<uint8_t>&& data,
+                                         const std::vector<const DexFile*>& dex_files)
+    : data_(std::move(data)),
+      dex_files_(dex_files),
+      reusable_dex_files_(dex_files.size(), false) {}
+
+std::unique_ptr<CompiledMethodCache> CompiledMethodCache::Open(
+    const std::string& file_name,
+    const std::string& key,
+    const std::vector<const DexFile*>& dex_files,
+    bool depends_on_all_dex_files,
+    std::string* error_msg) {
+  std::unique_ptr<File> file(OS::OpenFileForReading(file_name.c_str()));
+  if (file == nullptr) {
+    *error_msg = "Could not open " + file_name;
+    return nullptr;
+  }
+  int64_t length = file->GetLength();
+  if (length < 0) {
+    *error_msg = "Could not get the length of " + file_name;
+    return nullptr;
+  }
+  std::vector<uint8_t> data(length);
+  if (!file->ReadFully(data.data(), data.size())) {
+    *error_msg = "Could not read " + file_name;
+    return nullptr;
+  }
+  std::unique_ptr<CompiledMethodCache> cache(new CompiledMethodCache(std::move(data), dex_files));
+  if (!cache->Parse(key, depends_on_all_dex_files, error_msg)) {
+    *error_msg = "Invalid compiled method cache " + file_name + ": " + *error_msg;
+    return nullptr;
+  }
+  return cache;
+}
+
+bool CompiledMethodCache::Parse(const std::string& key,
+                                bool depends_on_all_dex_files,
+                                std::string* error_msg) {
+  if (data_.size() < sizeof(kCacheMagic) ||
+      memcmp(data_.data(), kCacheMagic, sizeof(kCacheMagic)) != 0) {
+    *error_msg = "bad magic";
+    return false;
+  }
+  CacheReader reader(data_.data() + sizeof(kCacheMagic), data_.data() + data_.size());
+  std::string cache_key;
+  if (!reader.ReadString(&cache_key)) {
+    *error_msg = "truncated key";
+    return false;
+  }
+  if (cache_key != key) {
+    *error_msg = "written by a different compilation";
+    return false;
+  }
+
+  // A dex file is unchanged if it has the same location and checksum as in the previous
+  // compilation, at the same index.
+  uint32_t num_dex_files;
+  if (!reader.ReadUint32(&num_dex_files)) {
+    *error_msg = "truncated dex files";
+    return false;
+  }
+  std::vector<bool> unchanged_dex_files(dex_files_.size(), false);
+  std::vector<std::vector<uint32_t>> previous_dependencies(num_dex_files);
+  for (uint32_t i = 0; i != num_dex_files; ++i) {
+    std::string location;
+    uint32_t checksum;
+    uint32_t num_dependencies;
+    if (!reader.ReadString(&location) ||
+        !reader.ReadUint32(&checksum) ||
+        !reader.ReadUint32(&num_dependencies)) {
+      *error_msg = "truncated dex files";
+      return false;
+    }
+    for (uint32_t j = 0; j != num_dependencies; ++j) {
+      uint32_t dependency;
+      if (!reader.ReadUint32(&dependency) || dependency >= num_dex_files) {
+        *error_msg = "invalid dex file dependencies";
+        return false;
+      }
+      previous_dependencies[i].push_back(dependency);
+    }
+    if (i < dex_files_.size() &&
+        dex_files_[i]->GetLocation() == location &&
+        dex_files_[i]->GetLocationChecksum() == checksum) {
+      unchanged_dex_files[i] = true;
+    }
+  }
+
+  std::vector<std::vector<uint32_t>> dependencies =
+      ComputeDependencies(dex_files_, depends_on_all_dex_files);
+  for (size_t i = 0; i != dex_files_.size(); ++i) {
+    if (!unchanged_dex_files[i]) {
+      continue;
+    }
+    bool reusable = true;
+    for (uint32_t dependency : dependencies[i]) {
+      reusable = reusable && unchanged_dex_files[dependency];
+    }
+    for (uint32_t dependency : previous_dependencies[i]) {
+      reusable = reusable && dependency < dex_files_.size() && unchanged_dex_files[dependency];
+    }
+    reusable_dex_files_[i] = reusable;
+  }
+
+  uint32_t num_methods;
+  if (!reader.ReadUint32(&num_methods)) {
+    *error_msg = "truncated methods";
+    return false;
+  }
+  for (uint32_t i = 0; i != num_methods; ++i) {
+    size_t offset = reader.GetPosition() - data_.data();
+    uint32_t dex_file_index;
+    uint32_t method_index;
+    uint32_t values[5];  // Instruction set, intrinsic, frame size, core and fp spill masks.
+    ArrayRef<const uint8_t> arrays[4];  // Code, method info, vmap table and cfi.
+    uint32_t num_patches;
+    if (!reader.ReadUint32(&dex_file_index) || !reader.ReadUint32(&method_index)) {
+      *error_msg = "truncated methods";
+      return false;
+    }
+    for (uint32_t& value : values) {
+      if (!reader.ReadUint32(&value)) {
+        *error_msg = "truncated methods";
+        return false;
+      }
+    }
+    for (ArrayRef<const uint8_t>& array : arrays) {
+      if (!reader.ReadBytes(&array)) {
+        *error_msg = "truncated methods";
+        return false;
+      }
+    }
+    if (!reader.ReadUint32(&num_patches)) {
+      *error_msg = "truncated methods";
+      return false;
+    }
+    for (uint32_t j = 0; j != num_patches; ++j) {
+      uint32_t patch_values[5];  // Type, literal offset, dex file and two target values.
+      for (uint32_t& value : patch_values) {
+        if (!reader.ReadUint32(&value)) {
+          *error_msg = "truncated patches";
+          return false;
+        }
+      }
+    }
+    if (dex_file_index < dex_files_.size() &&
+        reusable_dex_files_[dex_file_index] &&
+        method_index < dex_files_[dex_file_index]->NumMethodIds()) {
+      method_offsets_.Put(MethodReference(dex_files_[dex_file_index], method_index), offset);
+    }
+  }
+  return true;
+}
+
+CompiledMethod* CompiledMethodCache::CreateCompiledMethod(
+    CompilerDriver* driver,
+    const MethodReference& method_ref) const {
+  auto it = method_offsets_.find(method_ref);
+  if (it == method_offsets_.end()) {
+    return nullptr;
+  }
+  // The entry was checked when opening the cache.
+  CacheReader reader(data_.data() + it->second, data_.data() + data_.size());
+  uint32_t dex_file_index;
+  uint32_t method_index;
+  uint32_t instruction_set;
+  uint32_t is_intrinsic;
+  uint32_t frame_size_in_bytes;
+  uint32_t core_spill_mask;
+  uint32_t fp_spill_mask;
+  ArrayRef<const uint8_t> quick_code;
+  ArrayRef<const uint8_t> method_info;
+  ArrayRef<const uint8_t> vmap_table;
+  ArrayRef<const uint8_t> cfi_info;
+  uint32_t num_patches;
+  CHECK(reader.ReadUint32(&dex_file_index));
+  CHECK(reader.ReadUint32(&method_index));
+  CHECK(reader.ReadUint32(&instruction_set));
+  CHECK(reader.ReadUint32(&is_intrinsic));
+  CHECK(reader.ReadUint32(&frame_size_in_bytes));
+  CHECK(reader.ReadUint32(&core_spill_mask));
+  CHECK(reader.ReadUint32(&fp_spill_mask));
+  CHECK(reader.ReadBytes(&quick_code));
+  CHECK(reader.ReadBytes(&method_info));
+  CHECK(reader.ReadBytes(&vmap_table));
+  CHECK(reader.ReadBytes(&cfi_info));
+  CHECK(reader.ReadUint32(&num_patches));
+  DCHECK(MethodReference(dex_files_[dex_file_index], method_index) == method_ref);
+
+  std::vector<LinkerPatch> patches;
+  patches.reserve(num_patches);
+  for (uint32_t i = 0; i != num_patches; ++i) {
+    uint32_t type;
+    uint32_t literal_offset;
+    uint32_t patch_dex_file_index;
+    uint32_t value1;
+    uint32_t value2;
+    CHECK(reader.ReadUint32(&type));
+    CHECK(reader.ReadUint32(&literal_offset));
+    CHECK(reader.ReadUint32(&patch_dex_file_index));
+    CHECK(reader.ReadUint32(&value1));
+    CHECK(reader.ReadUint32(&value2));
+    const DexFile* dex_file = nullptr;
+    if (patch_dex_file_index != kNoDexFile) {
+      if (patch_dex_file_index > dex_files_.size()) {
+        LOG(WARNING) << "Invalid cached patch in " << method_ref.PrettyMethod();
+        return nullptr;
+      }
+      dex_file = dex_files_[patch_dex_file_index - 1u];
+    }
+    if (!DecodePatch(type, literal_offset, dex_file, value1, value2, &patches)) {
+      LOG(WARNING) << "Invalid cached patch in " << method_ref.PrettyMethod();
+      return nullptr;
+    }
+  }
+  if (instruction_set != static_cast<uint32_t>(driver->GetInstructionSet())) {
+    LOG(WARNING) << "Invalid cached instruction set for " << method_ref.PrettyMethod();
+    return nullptr;
+  }
+
+  CompiledMethod* compiled_method = CompiledMethod::SwapAllocCompiledMethod(
+      driver,
+      static_cast<InstructionSet>(instruction_set),
+      quick_code,
+      frame_size_in_bytes,
+      core_spill_mask,
+      fp_spill_mask,
+      method_info,
+      vmap_table,
+      cfi_info,
+      ArrayRef<const LinkerPatch>(patches));
+  if (is_intrinsic != 0u) {
+    compiled_method->MarkAsIntrinsic();
+  }
+  return compiled_method;
+}
+
+bool CompiledMethodCache::Write(const std::string& file_name,
+                                const std::string& key,
+                                const std::vector<const DexFile*>& dex_files,
+                                bool depends_on_all_dex_files,
+                                const CompilerDriver& driver,
+                                std::string* error_msg) {
+  std::vector<uint8_t> data(kCacheMagic, kCacheMagic + sizeof(kCacheMagic));
+  WriteString(&data, key);
+
+  SafeMap<const DexFile*, uint32_t> dex_file_indexes;
+  std::vector<std::vector<uint32_t>> dependencies =
+      ComputeDependencies(dex_files, depends_on_all_dex_files);
+  EncodeUnsignedLeb128(&data, dex_files.size());
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    dex_file_indexes.Put(dex_files[i], i);
+    WriteString(&data, dex_files[i]->GetLocation());
+    EncodeUnsignedLeb128(&data, dex_files[i]->GetLocationChecksum());
+    EncodeUnsignedLeb128(&data, dependencies[i].size());
+    for (uint32_t dependency : dependencies[i]) {
+      EncodeUnsignedLeb128(&data, dependency);
+    }
+  }
+
+  std::vector<uint8_t> methods;
+  uint32_t num_methods = 0u;
+  std::vector<uint32_t> patch_values;
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    const DexFile& dex_file = *dex_files[i];
+    for (size_t method_index = 0; method_index != dex_file.NumMethodIds(); ++method_index) {
+      const CompiledMethod* compiled_method =
+          driver.GetCompiledMethod(MethodReference(&dex_file, method_index));
+      // Methods without code were quickened by the dex-to-dex compiler, which is not cached.
+      if (compiled_method == nullptr || compiled_method->GetQuickCode().empty()) {
+        continue;
+      }
+      patch_values.clear();
+      bool encodable = true;
+      for (const LinkerPatch& patch : compiled_method->GetPatches()) {
+        uint32_t patch_dex_file_index;
+        uint32_t value1;
+        uint32_t value2;
+        if (!EncodePatch(patch, dex_file_indexes, &patch_dex_file_index, &value1, &value2)) {
+          encodable = false;
+          break;
+        }
+        patch_values.push_back(static_cast<uint32_t>(patch.GetType()));
+        patch_values.push_back(patch.LiteralOffset());
+        patch_values.push_back(patch_dex_file_index);
+        patch_values.push_back(value1);
+        patch_values.push_back(value2);
+      }
+      if (!encodable) {
+        continue;
+      }
+      EncodeUnsignedLeb128(&methods, i);
+      EncodeUnsignedLeb128(&methods, method_index);
+      EncodeUnsignedLeb128(&methods, static_cast<uint32_t>(compiled_method->GetInstructionSet()));
+      EncodeUnsignedLeb128(&methods, compiled_method->IsIntrinsic() ? 1u : 0u);
+      EncodeUnsignedLeb128(&methods, compiled_method->GetFrameSizeInBytes());
+      EncodeUnsignedLeb128(&methods, compiled_method->GetCoreSpillMask());
+      EncodeUnsignedLeb128(&methods, compiled_method->GetFpSpillMask());
+      WriteBytes(&methods, compiled_method->GetQuickCode());
+      WriteBytes(&methods, compiled_method->GetMethodInfo());
+      WriteBytes(&methods, compiled_method->GetVmapTable());
+      WriteBytes(&methods, compiled_method->GetCFIInfo());
+      EncodeUnsignedLeb128(&methods, compiled_method->GetPatches().size());
+      for (uint32_t value : patch_values) {
+        EncodeUnsignedLeb128(&methods, value);
+      }
+      ++num_methods;
+    }
+  }
+  EncodeUnsignedLeb128(&data, num_methods);
+  data.insert(data.end(), methods.begin(), methods.end());
+
+  std::unique_ptr<File> file(OS::CreateEmptyFile(file_name.c_str()));
+  if (file == nullptr) {
+    *error_msg = "Could not create " + file_name;
+    return false;
+  }
+  if (!file->WriteFully(data.data(), data.size())) {
+    *error_msg = "Could not write " + file_name;
+    file->Erase();
+    return false;
+  }
+  if (file->FlushCloseOrErase() != 0) {
+    *error_msg = "Could not flush and close " + file_name;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace art
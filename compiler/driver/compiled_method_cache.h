@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DRIVER_COMPILED_METHOD_CACHE_H_
+#define ART_COMPILER_DRIVER_COMPILED_METHOD_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "method_reference.h"
+#include "safe_map.h"
+
+namespace art {
+
+class CompiledMethod;
+class CompilerDriver;
+class DexFile;
+
+// The compiled code of the methods of a previous compilation, so that an incremental
+// compilation reuses the code of the dex files which did not change since then.
+//
+// The code of a method refers to the strings, types and methods of its dex file by index, and
+// these indexes change with any class of the dex file. It also depends on the classes of the
+// other dex files it references, for instance through inlining or field offsets. So the code of
+// a dex file is only reused if neither the dex file nor any of the dex files it transitively
+// references changed, with the references of both the previous and the current compilation.
+// Everything else the code depends on, such as the compiler options, the boot image and the
+// class path, must be part of the key of the cache.
+class CompiledMethodCache {
+ public:
+  // Opens the cache written by a previous compilation of `dex_files`, or returns null and sets
+  // `error_msg` if the file cannot be read or was written with another `key`. If
+  // `depends_on_all_dex_files`, as with a profile whose inline caches may name the classes of
+  // any dex file, each dex file is only reused if none of the dex files changed.
+  static std::unique_ptr<CompiledMethodCache> Open(const std::string& file_name,
+                                                   const std::string& key,
+                                                   const std::vector<const DexFile*>& dex_files,
+                                                   bool depends_on_all_dex_files,
+                                                   std::string* error_msg);
+
+  // Writes the code compiled by `driver` for the methods of `dex_files`. Methods referring to
+  // dex files which are not part of the compilation are left out.
+  static bool Write(const std::string& file_name,
+                    const std::string& key,
+                    const std::vector<const DexFile*>& dex_files,
+                    bool depends_on_all_dex_files,
+                    const CompilerDriver& driver,
+                    std::string* error_msg);
+
+  // Returns, for each of `dex_files`, the sorted indexes of the dex files defining the classes
+  // it transitively references, including its own index.
+  static std::vector<std::vector<uint32_t>> ComputeDependencies(
+      const std::vector<const DexFile*>& dex_files,
+      bool depends_on_all_dex_files);
+
+  // Returns a new compiled method with the cached code of the method, or null if the method has
+  // no code in the cache or its dex file cannot be reused.
+  CompiledMethod* CreateCompiledMethod(CompilerDriver* driver,
+                                       const MethodReference& method_ref) const;
+
+  bool IsDexFileReusable(size_t dex_file_index) const {
+    return reusable_dex_files_[dex_file_index];
+  }
+
+  size_t GetNumberOfReusableMethods() const {
+    return method_offsets_.size();
+  }
+
+ private:
+  CompiledMethodCache(std::vector<uint8_t>&& data, const std::vector<const DexFile*>& dex_files);
+
+  bool Parse(const std::string& key, bool depends_on_all_dex_files, std::string* error_msg);
+
+  // The content of the file.
+  const std::vector<uint8_t> data_;
+  const std::vector<const DexFile*> dex_files_;
+  std::vector<bool> reusable_dex_files_;
+  // The offset in `data_` of the code of each method of the reusable dex files.
+  SafeMap<MethodReference, size_t> method_offsets_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompiledMethodCache);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DRIVER_COMPILED_METHOD_CACHE_H_
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compiled_method_cache.h"
+
+#include "common_runtime_test.h"
+#include "compiled_method-inl.h"
+#include "compiler_driver.h"
+#include "compiler_options.h"
+#include "dex/verification_results.h"
+#include "linker/linker_patch.h"
+
+namespace art {
+
+class CompiledMethodCacheTest : public CommonRuntimeTest {
+ protected:
+  void SetUp() OVERRIDE {
+    CommonRuntimeTest::SetUp();
+    // Main in the first dex file uses Second in the second one.
+    multi_dex_ = OpenTestDexFiles("MultiDex");
+    modified_multi_dex_ = OpenTestDexFiles("MultiDexModifiedSecondary");
+    ASSERT_EQ(2u, multi_dex_.size());
+    ASSERT_EQ(2u, modified_multi_dex_.size());
+    compiler_options_.reset(new CompilerOptions());
+    verification_results_.reset(new VerificationResults(compiler_options_.get()));
+    driver_.reset(new CompilerDriver(compiler_options_.get(),
+                                     verification_results_.get(),
+                                     Compiler::kOptimizing,
+                                     kRuntimeISA,
+                                     /* instruction_set_features */ nullptr,
+                                     /* image_classes */ nullptr,
+                                     /* compiled_classes */ nullptr,
+                                     /* compiled_methods */ nullptr,
+                                     /* thread_count */ 1u,
+                                     /* swap_fd */ -1,
+                                     /* profile_compilation_info */ nullptr));
+  }
+
+  void TearDown() OVERRIDE {
+    driver_.reset();
+    CommonRuntimeTest::TearDown();
+  }
+
+  // Adds a compiled method to the first method of each dex file, referring to the other ones.
+  void AddCompiledMethods(const std::vector<const DexFile*>& dex_files) {
+    const uint8_t raw_code[] = { 1u, 2u, 3u, 4u };
+    const uint8_t raw_vmap_table[] = { 5u, 6u };
+    for (const DexFile* dex_file : dex_files) {
+      driver_->compiled_methods_.AddDexFile(dex_file);
+    }
+    for (size_t i = 0; i != dex_files.size(); ++i) {
+      const DexFile* other_dex_file = dex_files[dex_files.size() - 1u - i];
+      const linker::LinkerPatch patches[] = {
+          linker::LinkerPatch::RelativeCodePatch(0u, other_dex_file, 0u),
+          linker::LinkerPatch::StringBssEntryPatch(4u, dex_files[i], 2u, 1u),
+          linker::LinkerPatch::BakerReadBarrierBranchPatch(8u, 3u, 4u),
+      };
+      CompiledMethod* compiled_method = CompiledMethod::SwapAllocCompiledMethod(
+          driver_.get(),
+          kRuntimeISA,
+          ArrayRef<const uint8_t>(raw_code),
+          /* frame_size_in_bytes */ 16u + i,
+          /* core_spill_mask */ 1u,
+          /* fp_spill_mask */ 2u,
+          ArrayRef<const uint8_t>(),
+          ArrayRef<const uint8_t>(raw_vmap_table),
+          ArrayRef<const uint8_t>(),
+          ArrayRef<const linker::LinkerPatch>(patches));
+      driver_->AddCompiledMethod(MethodReference(dex_files[i], 0u),
+                                 compiled_method,
+                                 /* non_relative_linker_patch_count */ 0u);
+    }
+  }
+
+  static std::vector<const DexFile*> GetDexFiles(const DexFile* first, const DexFile* second) {
+    return std::vector<const DexFile*> { first, second };
+  }
+
+  std::vector<std::unique_ptr<const DexFile>> multi_dex_;
+  std::vector<std::unique_ptr<const DexFile>> modified_multi_dex_;
+  std::unique_ptr<CompilerOptions> compiler_options_;
+  std::unique_ptr<VerificationResults> verification_results_;
+  std::unique_ptr<CompilerDriver> driver_;
+};
+
+TEST_F(CompiledMethodCacheTest, Dependencies) {
+  std::vector<const DexFile*> dex_files = GetDexFiles(multi_dex_[0].get(), multi_dex_[1].get());
+  std::vector<std::vector<uint32_t>> dependencies =
+      CompiledMethodCache::ComputeDependencies(dex_files, /* depends_on_all_dex_files */ false);
+  ASSERT_EQ(2u, dependencies.size());
+  EXPECT_EQ((std::vector<uint32_t> { 0u, 1u }), dependencies[0]);
+  EXPECT_EQ((std::vector<uint32_t> { 1u }), dependencies[1]);
+
+  dependencies =
+      CompiledMethodCache::ComputeDependencies(dex_files, /* depends_on_all_dex_files */ true);
+  ASSERT_EQ(2u, dependencies.size());
+  EXPECT_EQ((std::vector<uint32_t> { 0u, 1u }), dependencies[0]);
+  EXPECT_EQ((std::vector<uint32_t> { 0u, 1u }), dependencies[1]);
+}
+
+TEST_F(CompiledMethodCacheTest, ReuseUnchangedDexFiles) {
+  ScratchFile file;
+  std::vector<const DexFile*> dex_files = GetDexFiles(multi_dex_[0].get(), multi_dex_[1].get());
+  AddCompiledMethods(dex_files);
+  std::string error_msg;
+  ASSERT_TRUE(CompiledMethodCache::Write(file.GetFilename(),
+                                         "key",
+                                         dex_files,
+                                         /* depends_on_all_dex_files */ false,
+                                         *driver_,
+                                         &error_msg)) << error_msg;
+
+  std::unique_ptr<CompiledMethodCache> cache = CompiledMethodCache::Open(
+      file.GetFilename(), "key", dex_files, /* depends_on_all_dex_files */ false, &error_msg);
+  ASSERT_TRUE(cache != nullptr) << error_msg;
+  EXPECT_TRUE(cache->IsDexFileReusable(0u));
+  EXPECT_TRUE(cache->IsDexFileReusable(1u));
+  EXPECT_EQ(2u, cache->GetNumberOfReusableMethods());
+  for (const DexFile* dex_file : dex_files) {
+    const CompiledMethod* compiled_method =
+        driver_->GetCompiledMethod(MethodReference(dex_file, 0u));
+    CompiledMethod* cached_method =
+        cache->CreateCompiledMethod(driver_.get(), MethodReference(dex_file, 0u));
+    ASSERT_TRUE(cached_method != nullptr);
+    // The arrays are deduplicated with the ones of the compiled method.
+    EXPECT_EQ(compiled_method->GetQuickCode().data(), cached_method->GetQuickCode().data());
+    EXPECT_EQ(compiled_method->GetVmapTable().data(), cached_method->GetVmapTable().data());
+    EXPECT_EQ(compiled_method->GetFrameSizeInBytes(), cached_method->GetFrameSizeInBytes());
+    EXPECT_EQ(compiled_method->GetCoreSpillMask(), cached_method->GetCoreSpillMask());
+    EXPECT_EQ(compiled_method->GetFpSpillMask(), cached_method->GetFpSpillMask());
+    EXPECT_TRUE(compiled_method->GetPatches() == cached_method->GetPatches());
+    CompiledMethod::ReleaseSwapAllocatedCompiledMethod(driver_.get(), cached_method);
+  }
+  EXPECT_TRUE(cache->CreateCompiledMethod(driver_.get(), MethodReference(dex_files[0], 1u)) ==
+              nullptr);
+
+  // A different compilation doesn't reuse anything.
+  cache = CompiledMethodCache::Open(
+      file.GetFilename(), "other key", dex_files, /* depends_on_all_dex_files */ false, &error_msg);
+  EXPECT_TRUE(cache == nullptr);
+}
+
+TEST_F(CompiledMethodCacheTest, DontReuseDependentDexFiles) {
+  ScratchFile file;
+  std::vector<const DexFile*> dex_files = GetDexFiles(multi_dex_[0].get(), multi_dex_[1].get());
+  AddCompiledMethods(dex_files);
+  std::string error_msg;
+  ASSERT_TRUE(CompiledMethodCache::Write(file.GetFilename(),
+                                         "key",
+                                         dex_files,
+                                         /* depends_on_all_dex_files */ false,
+                                         *driver_,
+                                         &error_msg)) << error_msg;
+
+  // The second dex file doesn't depend on the changed first one.
+  std::vector<const DexFile*> changed_dex_files =
+      GetDexFiles(modified_multi_dex_[0].get(), multi_dex_[1].get());
+  std::unique_ptr<CompiledMethodCache> cache = CompiledMethodCache::Open(
+      file.GetFilename(),
+      "key",
+      changed_dex_files,
+      /* depends_on_all_dex_files */ false,
+      &error_msg);
+  ASSERT_TRUE(cache != nullptr) << error_msg;
+  EXPECT_FALSE(cache->IsDexFileReusable(0u));
+  EXPECT_TRUE(cache->IsDexFileReusable(1u));
+  EXPECT_EQ(1u, cache->GetNumberOfReusableMethods());
+  CompiledMethod* cached_method =
+      cache->CreateCompiledMethod(driver_.get(), MethodReference(changed_dex_files[1], 0u));
+  ASSERT_TRUE(cached_method != nullptr);
+  // The patches refer to the dex files of this compilation.
+  EXPECT_EQ(changed_dex_files[0], cached_method->GetPatches()[0].TargetMethod().dex_file);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(driver_.get(), cached_method);
+
+  // The first dex file depends on the changed second one.
+  changed_dex_files = GetDexFiles(multi_dex_[0].get(), modified_multi_dex_[1].get());
+  cache = CompiledMethodCache::Open(
+      file.GetFilename(),
+      "key",
+      changed_dex_files,
+      /* depends_on_all_dex_files */ false,
+      &error_msg);
+  ASSERT_TRUE(cache != nullptr) << error_msg;
+  EXPECT_FALSE(cache->IsDexFileReusable(0u));
+  EXPECT_FALSE(cache->IsDexFileReusable(1u));
+  EXPECT_EQ(0u, cache->GetNumberOfReusableMethods());
+
+  // With a profile, the second dex file depends on the first one too.
+  changed_dex_files = GetDexFiles(modified_multi_dex_[0].get(), multi_dex_[1].get());
+  cache = CompiledMethodCache::Open(
+      file.GetFilename(),
+      "key",
+      changed_dex_files,
+      /* depends_on_all_dex_files */ true,
+      &error_msg);
+  ASSERT_TRUE(cache != nullptr) << error_msg;
+  EXPECT_FALSE(cache->IsDexFileReusable(1u));
+}
+
+}  // namespace art
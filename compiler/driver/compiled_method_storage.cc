@@ -170,17 +170,31 @@ class CompiledMethodStorage::LengthPrefixedArrayAlloc {
   SwapSpace* const swap_space_;
 };
 
-CompiledMethodStorage::CompiledMethodStorage(int swap_fd)
+// Number of shards of each dedupe set; at least the number used with few threads, and twice the
+// number of threads so that two threads rarely contend for the same shard.
+static size_t NumberOfDedupeShards(size_t thread_count) {
+  static constexpr size_t kMinNumberOfDedupeShards = 4u;
+  return std::max(kMinNumberOfDedupeShards, 2u * thread_count);
+}
+
+CompiledMethodStorage::CompiledMethodStorage(int swap_fd, size_t thread_count)
     : swap_space_(swap_fd == -1 ? nullptr : new SwapSpace(swap_fd, 10 * MB)),
       dedupe_enabled_(true),
-      dedupe_code_("dedupe code", LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get())),
+      dedupe_code_("dedupe code",
+                   LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get()),
+                   NumberOfDedupeShards(thread_count)),
       dedupe_method_info_("dedupe method info",
-                          LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get())),
+                          LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get()),
+                          NumberOfDedupeShards(thread_count)),
       dedupe_vmap_table_("dedupe vmap table",
-                         LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get())),
-      dedupe_cfi_info_("dedupe cfi info", LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get())),
+                         LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get()),
+                         NumberOfDedupeShards(thread_count)),
+      dedupe_cfi_info_("dedupe cfi info",
+                       LengthPrefixedArrayAlloc<uint8_t>(swap_space_.get()),
+                       NumberOfDedupeShards(thread_count)),
       dedupe_linker_patches_("dedupe cfi info",
-                             LengthPrefixedArrayAlloc<linker::LinkerPatch>(swap_space_.get())) {
+                             LengthPrefixedArrayAlloc<linker::LinkerPatch>(swap_space_.get()),
+                             NumberOfDedupeShards(thread_count)) {
 }
 
 CompiledMethodStorage::~CompiledMethodStorage() {
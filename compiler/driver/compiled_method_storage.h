@@ -34,7 +34,8 @@ class LinkerPatch;
 
 class CompiledMethodStorage {
  public:
-  explicit CompiledMethodStorage(int swap_fd);
+  // The dedupe sets have more shards with more compiler threads, see `thread_count`.
+  explicit CompiledMethodStorage(int swap_fd, size_t thread_count = 1u);
   ~CompiledMethodStorage();
 
   void DumpMemoryUsage(std::ostream& os, bool extended) const;
@@ -87,8 +88,7 @@ class CompiledMethodStorage {
                                    LengthPrefixedArray<T>,
                                    LengthPrefixedArrayAlloc<T>,
                                    size_t,
-                                   DedupeHashFunc<const T>,
-                                   4>;
+                                   DedupeHashFunc<const T>>;
 
   // Swap pool and allocator used for native allocations. May be file-backed. Needs to be first
   // as other fields rely on this.
@@ -17,6 +17,8 @@
 #include "compiler_driver.h"
 
 #include <unistd.h>
+#include <algorithm>
+#include <numeric>
 #include <unordered_set>
 #include <vector>
 
@@ -49,6 +51,7 @@
 #include "dex_file-inl.h"
 #include "dex_file_annotations.h"
 #include "dex_instruction-inl.h"
+#include "driver/compiled_method_cache.h"
 #include "driver/compiler_options.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap.h"
@@ -70,6 +73,7 @@
 #include "runtime.h"
 #include "runtime_intrinsics.h"
 #include "scoped_thread_state_change-inl.h"
+#include "subtype_check.h"
 #include "thread.h"
 #include "thread_list.h"
 #include "thread_pool.h"
@@ -303,7 +307,8 @@ CompilerDriver::CompilerDriver(
       stats_(new AOTCompilationStats),
       compiler_context_(nullptr),
       support_boot_image_fixup_(true),
-      compiled_method_storage_(swap_fd),
+      compiled_method_storage_(swap_fd, thread_count),
+      compiled_method_cache_(nullptr),
       profile_compilation_info_(profile_compilation_info),
       max_arena_alloc_(0),
       dex_to_dex_references_lock_("dex-to-dex references lock"),
@@ -482,7 +487,14 @@ static void CompileMethod(Thread* self,
   uint64_t start_ns = kTimeCompileMethod ? NanoTime() : 0;
   MethodReference method_ref(&dex_file, method_idx);
 
-  if (driver->GetCurrentDexToDexMethods() != nullptr) {
+  const CompiledMethodCache* compiled_method_cache = driver->GetCompiledMethodCache();
+  if (driver->GetCurrentDexToDexMethods() == nullptr && compiled_method_cache != nullptr) {
+    compiled_method = compiled_method_cache->CreateCompiledMethod(driver, method_ref);
+  }
+
+  if (compiled_method != nullptr) {
+    // The method was compiled the same way by the compilation which wrote the cache.
+  } else if (driver->GetCurrentDexToDexMethods() != nullptr) {
     // This is the second pass when we dex-to-dex compile previously marked methods.
     // TODO: Refactor the compilation to avoid having to distinguish the two passes
     // here. That should be done on a higher level. http://b/29089975
@@ -780,6 +792,85 @@ static void ResolveConstStrings(CompilerDriver* driver,
   }
 }
 
+// Assign the type check bitstrings of the targets of check-cast and instance-of in the code.
+// Done single-threaded, in the order of the dex files, so that the image is deterministic.
+// The compiled code of the boot image relies on these bitstrings, see HSharpening.
+
+static void InitializeTypeCheckBitstrings(CompilerDriver* driver,
+                                          ClassLinker* class_linker,
+                                          Handle<mirror::DexCache> dex_cache,
+                                          const DexFile& dex_file,
+                                          const DexFile::CodeItem* code_item)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+  if (code_item == nullptr) {
+    // Abstract or native method.
+    return;
+  }
+
+  for (const DexInstructionPcPair& inst : code_item->Instructions()) {
+    switch (inst->Opcode()) {
+      case Instruction::CHECK_CAST:
+      case Instruction::INSTANCE_OF: {
+        dex::TypeIndex type_index(
+            (inst->Opcode() == Instruction::CHECK_CAST) ? inst->VRegB_21c() : inst->VRegC_22c());
+        const char* descriptor = dex_file.StringByTypeIdx(type_index);
+        // Only classes of the boot image keep their bitstring at runtime. Arrays and
+        // primitive types do not use the bitstring check.
+        if (descriptor[0] == 'L' && driver->IsImageClass(descriptor)) {
+          ObjPtr<mirror::Class> klass =
+              class_linker->LookupResolvedType(type_index, dex_cache.Get(), nullptr);
+          // Keep in sync with HSharpening::ComputeTypeCheckKind().
+          if (klass != nullptr && !klass->IsInterface() && !klass->IsFinal()) {
+            MutexLock subtype_check_lock(Thread::Current(), *Locks::subtype_check_lock_);
+            SubtypeCheck<ObjPtr<mirror::Class>>::EnsureAssigned(klass);
+          }
+        }
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+}
+
+static void InitializeTypeCheckBitstrings(CompilerDriver* driver,
+                                          const std::vector<const DexFile*>& dex_files,
+                                          TimingLogger* timings) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
+  MutableHandle<mirror::DexCache> dex_cache(hs.NewHandle<mirror::DexCache>(nullptr));
+
+  for (const DexFile* dex_file : dex_files) {
+    dex_cache.Assign(class_linker->FindDexCache(soa.Self(), *dex_file));
+    TimingLogger::ScopedTiming t("Initialize type check bitstrings", timings);
+
+    size_t class_def_count = dex_file->NumClassDefs();
+    for (size_t class_def_index = 0; class_def_index < class_def_count; ++class_def_index) {
+      const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_index);
+
+      const uint8_t* class_data = dex_file->GetClassData(class_def);
+      if (class_data == nullptr) {
+        // empty class, probably a marker interface
+        continue;
+      }
+
+      ClassDataItemIterator it(*dex_file, class_data);
+      it.SkipAllFields();
+
+      // Direct and virtual methods. The inliner may compile code of classes which are not
+      // to be compiled, so we do not skip them here.
+      while (it.HasNextMethod()) {
+        InitializeTypeCheckBitstrings(
+            driver, class_linker, dex_cache, *dex_file, it.GetMethodCodeItem());
+        it.Next();
+      }
+      DCHECK(!it.HasNext());
+    }
+  }
+}
+
 inline void CompilerDriver::CheckThreadPools() {
   DCHECK(parallel_thread_pool_ != nullptr);
   DCHECK(single_thread_pool_ != nullptr);
@@ -870,6 +961,13 @@ void CompilerDriver::PreCompile(jobject class_loader,
     }
     InitializeClasses(class_loader, dex_files, timings);
     VLOG(compiler) << "InitializeClasses: " << GetMemoryUsageString(false);
+
+    if (GetCompilerOptions().IsForceDeterminism() && GetCompilerOptions().IsBootImage()) {
+      // Assign the type check bitstrings used by the compiled code. Do this now to have a
+      // deterministic image.
+      InitializeTypeCheckBitstrings(this, dex_files, timings);
+      VLOG(compiler) << "InitializeTypeCheckBitstrings: " << GetMemoryUsageString(false);
+    }
   }
 
   UpdateImageClasses(timings);
@@ -1496,11 +1594,170 @@ class ParallelCompilationManager {
     thread_pool_->StopWorkers(self);
   }
 
+  // Like ForAll(), but the range is split evenly between the work units upfront and each of
+  // them visits the indices of its own part in order. A work unit which is done steals the
+  // upper half of the largest part left. This keeps each thread on consecutive indices while
+  // balancing indices of very uneven cost, such as methods.
+  void ForAllWithWorkStealing(size_t begin,
+                              size_t end,
+                              CompilationVisitor* visitor,
+                              size_t work_units)
+      REQUIRES(!*Locks::mutator_lock_) {
+    Thread* self = Thread::Current();
+    self->AssertNoPendingException();
+    CHECK_GT(work_units, 0U);
+    CHECK_LE(begin, end);
+    CHECK(IsUint<32>(end)) << end;
+
+    std::unique_ptr<WorkStealingRange[]> ranges(new WorkStealingRange[work_units]);
+    const size_t count = end - begin;
+    for (size_t i = 0; i < work_units; ++i) {
+      ranges[i].Set(begin + count * i / work_units, begin + count * (i + 1) / work_units);
+    }
+    for (size_t i = 0; i < work_units; ++i) {
+      thread_pool_->AddTask(self, new WorkStealingClosure(ranges.get(), work_units, i, visitor));
+    }
+    thread_pool_->StartWorkers(self);
+
+    // Ensure we're suspended while we're blocked waiting for the other threads to finish (worker
+    // thread destructor's called below perform join).
+    CHECK_NE(self->GetState(), kRunnable);
+
+    // Wait for all the worker threads to finish.
+    thread_pool_->Wait(self, true, false);
+
+    // And stop the workers accepting jobs.
+    thread_pool_->StopWorkers(self);
+  }
+
   size_t NextIndex() {
     return index_.FetchAndAddSequentiallyConsistent(1);
   }
 
  private:
+  // A range [begin, end) of indices encoded in a single word, so that its work unit can take
+  // the first index and another one steal the upper half with a compare-and-swap.
+  class WorkStealingRange {
+   public:
+    WorkStealingRange() : range_(0u) {}
+
+    // Only called before the work units start, or by the owner once its range is empty.
+    void Set(size_t begin, size_t end) {
+      range_.StoreRelaxed(Encode(begin, end));
+    }
+
+    size_t Size() const {
+      uint64_t range = range_.LoadRelaxed();
+      return End(range) - Begin(range);
+    }
+
+    bool TakeFirst(/*out*/ size_t* index) {
+      while (true) {
+        uint64_t range = range_.LoadRelaxed();
+        size_t begin = Begin(range);
+        size_t end = End(range);
+        if (begin == end) {
+          return false;
+        }
+        if (range_.CompareExchangeWeakRelaxed(range, Encode(begin + 1u, end))) {
+          *index = begin;
+          return true;
+        }
+      }
+    }
+
+    bool StealUpperHalf(/*out*/ size_t* stolen_begin, /*out*/ size_t* stolen_end) {
+      while (true) {
+        uint64_t range = range_.LoadRelaxed();
+        size_t begin = Begin(range);
+        size_t end = End(range);
+        if (begin == end) {
+          return false;
+        }
+        // Take the last index of a range of one, its owner may be busy with a long one.
+        size_t middle = begin + (end - begin) / 2u;
+        if (range_.CompareExchangeWeakRelaxed(range, Encode(begin, middle))) {
+          *stolen_begin = middle;
+          *stolen_end = end;
+          return true;
+        }
+      }
+    }
+
+   private:
+    static uint64_t Encode(size_t begin, size_t end) {
+      DCHECK_LE(begin, end);
+      return (static_cast<uint64_t>(end) << 32) | static_cast<uint32_t>(begin);
+    }
+    static size_t Begin(uint64_t range) {
+      return static_cast<uint32_t>(range);
+    }
+    static size_t End(uint64_t range) {
+      return static_cast<size_t>(range >> 32);
+    }
+
+    Atomic<uint64_t> range_;
+
+    DISALLOW_COPY_AND_ASSIGN(WorkStealingRange);
+  };
+
+  class WorkStealingClosure : public Task {
+   public:
+    WorkStealingClosure(WorkStealingRange* ranges,
+                        size_t num_ranges,
+                        size_t own_range,
+                        CompilationVisitor* visitor)
+        : ranges_(ranges),
+          num_ranges_(num_ranges),
+          own_range_(own_range),
+          visitor_(visitor) {}
+
+    virtual void Run(Thread* self) {
+      WorkStealingRange* own = &ranges_[own_range_];
+      do {
+        size_t index;
+        while (own->TakeFirst(&index)) {
+          visitor_->Visit(index);
+          self->AssertNoPendingException();
+        }
+      } while (Steal(own));
+    }
+
+    virtual void Finalize() {
+      delete this;
+    }
+
+   private:
+    // Moves the upper half of the largest range left to `own`, returns false if all are empty.
+    bool Steal(WorkStealingRange* own) {
+      while (true) {
+        size_t victim = num_ranges_;
+        size_t victim_size = 0u;
+        for (size_t i = 0; i < num_ranges_; ++i) {
+          size_t size = ranges_[i].Size();
+          if (size > victim_size) {
+            victim = i;
+            victim_size = size;
+          }
+        }
+        if (victim == num_ranges_) {
+          return false;
+        }
+        size_t begin;
+        size_t end;
+        if (ranges_[victim].StealUpperHalf(&begin, &end)) {
+          own->Set(begin, end);
+          return true;
+        }
+      }
+    }
+
+    WorkStealingRange* const ranges_;
+    const size_t num_ranges_;
+    const size_t own_range_;
+    CompilationVisitor* const visitor_;
+  };
+
   class ForAllClosure : public Task {
    public:
     ForAllClosure(ParallelCompilationManager* manager, size_t end, CompilationVisitor* visitor)
@@ -1952,17 +2209,81 @@ void CompilerDriver::Verify(jobject jclass_loader,
   }
 }
 
+// Returns the indexes of the class defs of `dex_file` ordered by their depth in the hierarchy of
+// the classes it defines, and by index for the same depth. Visited in this order, the classes
+// being verified at the same time mostly do not extend each other, so that a thread rarely waits
+// for the verification of a superclass by another thread.
+static std::vector<uint32_t> GetClassDefsInHierarchyOrder(const DexFile& dex_file) {
+  static constexpr uint32_t kUnknownDepth = static_cast<uint32_t>(-1);
+  const uint32_t num_class_defs = dex_file.NumClassDefs();
+  std::vector<uint32_t> depths(num_class_defs, kUnknownDepth);
+  std::vector<uint32_t> chain;
+  for (uint32_t i = 0; i != num_class_defs; ++i) {
+    // Walk up the superclasses defined in this dex file until one with a known depth.
+    uint32_t depth = 0u;
+    uint32_t index = i;
+    while (true) {
+      if (depths[index] != kUnknownDepth) {
+        depth = depths[index] + 1u;
+        break;
+      }
+      if (chain.size() == num_class_defs) {
+        // A circular hierarchy, which the verifier rejects.
+        break;
+      }
+      chain.push_back(index);
+      dex::TypeIndex super_class_idx = dex_file.GetClassDef(index).superclass_idx_;
+      const DexFile::ClassDef* super_class_def =
+          super_class_idx.IsValid() ? dex_file.FindClassDef(super_class_idx) : nullptr;
+      if (super_class_def == nullptr) {
+        break;
+      }
+      index = dex_file.GetIndexForClassDef(*super_class_def);
+    }
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+      depths[*it] = depth;
+      ++depth;
+    }
+    chain.clear();
+  }
+  std::vector<uint32_t> order(num_class_defs);
+  std::iota(order.begin(), order.end(), 0u);
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+    return depths[lhs] < depths[rhs];
+  });
+  return order;
+}
+
 class VerifyClassVisitor : public CompilationVisitor {
  public:
-  VerifyClassVisitor(const ParallelCompilationManager* manager, verifier::HardFailLogMode log_level)
-     : manager_(manager), log_level_(log_level) {}
-
-  virtual void Visit(size_t class_def_index) REQUIRES(!Locks::mutator_lock_) OVERRIDE {
+  VerifyClassVisitor(const ParallelCompilationManager* manager,
+                     verifier::HardFailLogMode log_level,
+                     const std::vector<uint32_t>& class_def_order)
+     : manager_(manager),
+       log_level_(log_level),
+       class_def_order_(class_def_order),
+       dump_timings_(manager->GetCompiler()->GetCompilerOptions().GetDumpTimings()) {}
+
+  virtual void Visit(size_t index) REQUIRES(!Locks::mutator_lock_) OVERRIDE {
     ScopedTrace trace(__FUNCTION__);
-    ScopedObjectAccess soa(Thread::Current());
+    const uint64_t start_ns = dump_timings_ ? NanoTime() : 0u;
+    const size_t class_def_index = class_def_order_[index];
     const DexFile& dex_file = *manager_->GetDexFile();
     const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
     const char* descriptor = dex_file.GetClassDescriptor(class_def);
+    VerifyClass(class_def_index, class_def, descriptor);
+    if (dump_timings_) {
+      LOG(INFO) << "Verification of " << PrettyDescriptor(descriptor) << " took "
+                << PrettyDuration(NanoTime() - start_ns);
+    }
+  }
+
+ private:
+  void VerifyClass(size_t class_def_index,
+                   const DexFile::ClassDef& class_def,
+                   const char* descriptor) REQUIRES(!Locks::mutator_lock_) {
+    ScopedObjectAccess soa(Thread::Current());
+    const DexFile& dex_file = *manager_->GetDexFile();
     ClassLinker* class_linker = manager_->GetClassLinker();
     jobject jclass_loader = manager_->GetClassLoader();
     StackHandleScope<3> hs(soa.Self());
@@ -2058,9 +2379,10 @@ class VerifyClassVisitor : public CompilationVisitor {
     soa.Self()->AssertNoPendingException();
   }
 
- private:
   const ParallelCompilationManager* const manager_;
   const verifier::HardFailLogMode log_level_;
+  const std::vector<uint32_t>& class_def_order_;
+  const bool dump_timings_;
 };
 
 void CompilerDriver::VerifyDexFile(jobject class_loader,
@@ -2078,7 +2400,8 @@ void CompilerDriver::VerifyDexFile(jobject class_loader,
   verifier::HardFailLogMode log_level = abort_on_verifier_failures
                               ? verifier::HardFailLogMode::kLogInternalFatal
                               : verifier::HardFailLogMode::kLogWarning;
-  VerifyClassVisitor visitor(&context, log_level);
+  std::vector<uint32_t> class_def_order = GetClassDefsInHierarchyOrder(dex_file);
+  VerifyClassVisitor visitor(&context, log_level, class_def_order);
   context.ForAll(0, dex_file.NumClassDefs(), &visitor, thread_count);
 }
 
@@ -2660,9 +2983,25 @@ void CompilerDriver::Compile(jobject class_loader,
   VLOG(compiler) << "Compile: " << GetMemoryUsageString(false);
 }
 
-class CompileClassVisitor : public CompilationVisitor {
+// A method of the dex file being compiled, with what CompileMethod() needs besides the handles.
+struct MethodToCompile {
+  const DexFile::CodeItem* code_item;
+  uint32_t access_flags;
+  InvokeType invoke_type;
+  uint16_t class_def_index;
+  uint32_t method_idx;
+  optimizer::DexToDexCompilationLevel dex_to_dex_compilation_level;
+  bool compilation_enabled;
+};
+
+// Collects the methods to compile of each class. This is cheap compared to the compilation of
+// the methods, which is parallelized separately so that large classes don't hold up a thread.
+class CollectMethodsToCompileVisitor : public CompilationVisitor {
  public:
-  explicit CompileClassVisitor(const ParallelCompilationManager* manager) : manager_(manager) {}
+  CollectMethodsToCompileVisitor(const ParallelCompilationManager* manager,
+                                 std::vector<std::vector<MethodToCompile>>* methods_by_class)
+      : manager_(manager),
+        methods_by_class_(methods_by_class) {}
 
   virtual void Visit(size_t class_def_index) REQUIRES(!Locks::mutator_lock_) OVERRIDE {
     ScopedTrace trace(__FUNCTION__);
@@ -2678,20 +3017,16 @@ class CompileClassVisitor : public CompilationVisitor {
     // Use a scoped object access to perform to the quick SkipClass check.
     const char* descriptor = dex_file.GetClassDescriptor(class_def);
     ScopedObjectAccess soa(Thread::Current());
-    StackHandleScope<3> hs(soa.Self());
+    StackHandleScope<2> hs(soa.Self());
     Handle<mirror::ClassLoader> class_loader(
         hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
     Handle<mirror::Class> klass(
         hs.NewHandle(class_linker->FindClass(soa.Self(), descriptor, class_loader)));
-    Handle<mirror::DexCache> dex_cache;
     if (klass == nullptr) {
       soa.Self()->AssertPendingException();
       soa.Self()->ClearException();
-      dex_cache = hs.NewHandle(class_linker->FindDexCache(soa.Self(), dex_file));
     } else if (SkipClass(jclass_loader, dex_file, klass.Get())) {
       return;
-    } else {
-      dex_cache = hs.NewHandle(klass->GetDexCache());
     }
 
     const uint8_t* class_data = dex_file.GetClassData(class_def);
@@ -2715,7 +3050,8 @@ class CompileClassVisitor : public CompilationVisitor {
     bool compilation_enabled = driver->IsClassToCompile(
         dex_file.StringByTypeIdx(class_def.class_idx_));
 
-    // Compile direct and virtual methods.
+    // Collect direct and virtual methods.
+    std::vector<MethodToCompile>* methods = &(*methods_by_class_)[class_def_index];
     int64_t previous_method_idx = -1;
     while (it.HasNextMethod()) {
       uint32_t method_idx = it.GetMemberIndex();
@@ -2726,18 +3062,18 @@ class CompileClassVisitor : public CompilationVisitor {
         continue;
       }
       previous_method_idx = method_idx;
-      CompileMethod(soa.Self(),
-                    driver,
-                    it.GetMethodCodeItem(),
-                    it.GetMethodAccessFlags(),
-                    it.GetMethodInvokeType(class_def),
-                    class_def_index,
-                    method_idx,
-                    class_loader,
-                    dex_file,
-                    dex_to_dex_compilation_level,
-                    compilation_enabled,
-                    dex_cache);
+      // In the dex-to-dex pass, only the marked methods are compiled.
+      const BitVector* dex_to_dex_methods = driver->GetCurrentDexToDexMethods();
+      if (dex_to_dex_methods == nullptr || dex_to_dex_methods->IsBitSet(method_idx)) {
+        methods->push_back(MethodToCompile {
+            it.GetMethodCodeItem(),
+            it.GetMethodAccessFlags(),
+            it.GetMethodInvokeType(class_def),
+            static_cast<uint16_t>(class_def_index),
+            method_idx,
+            dex_to_dex_compilation_level,
+            compilation_enabled });
+      }
       it.Next();
     }
     DCHECK(!it.HasNext());
@@ -2745,6 +3081,47 @@ class CompileClassVisitor : public CompilationVisitor {
 
  private:
   const ParallelCompilationManager* const manager_;
+  std::vector<std::vector<MethodToCompile>>* const methods_by_class_;
+};
+
+class CompileMethodVisitor : public CompilationVisitor {
+ public:
+  CompileMethodVisitor(const ParallelCompilationManager* manager,
+                       const std::vector<MethodToCompile>& methods)
+      : manager_(manager),
+        methods_(methods) {}
+
+  virtual void Visit(size_t index) REQUIRES(!Locks::mutator_lock_) OVERRIDE {
+    ScopedTrace trace(__FUNCTION__);
+    const MethodToCompile& method = methods_[index];
+    const DexFile& dex_file = *manager_->GetDexFile();
+    ScopedObjectAccess soa(Thread::Current());
+    StackHandleScope<2> hs(soa.Self());
+    Handle<mirror::ClassLoader> class_loader(
+        hs.NewHandle(soa.Decode<mirror::ClassLoader>(manager_->GetClassLoader())));
+    // Classes defined by another dex file were skipped, so this is the cache of their dex file.
+    Handle<mirror::DexCache> dex_cache(
+        hs.NewHandle(manager_->GetClassLinker()->FindDexCache(soa.Self(), dex_file)));
+
+    // Go to native so that we don't block GC during compilation.
+    ScopedThreadSuspension sts(soa.Self(), kNative);
+    CompileMethod(soa.Self(),
+                  manager_->GetCompiler(),
+                  method.code_item,
+                  method.access_flags,
+                  method.invoke_type,
+                  method.class_def_index,
+                  method.method_idx,
+                  class_loader,
+                  dex_file,
+                  method.dex_to_dex_compilation_level,
+                  method.compilation_enabled,
+                  dex_cache);
+  }
+
+ private:
+  const ParallelCompilationManager* const manager_;
+  const std::vector<MethodToCompile>& methods_;
 };
 
 void CompilerDriver::CompileDexFile(jobject class_loader,
@@ -2756,8 +3133,20 @@ void CompilerDriver::CompileDexFile(jobject class_loader,
   TimingLogger::ScopedTiming t("Compile Dex File", timings);
   ParallelCompilationManager context(Runtime::Current()->GetClassLinker(), class_loader, this,
                                      &dex_file, dex_files, thread_pool);
-  CompileClassVisitor visitor(&context);
-  context.ForAll(0, dex_file.NumClassDefs(), &visitor, thread_count);
+  std::vector<std::vector<MethodToCompile>> methods_by_class(dex_file.NumClassDefs());
+  CollectMethodsToCompileVisitor collect_visitor(&context, &methods_by_class);
+  context.ForAll(0, dex_file.NumClassDefs(), &collect_visitor, thread_count);
+
+  // Keep the methods in class def order, so that each thread compiles methods of the same
+  // classes and shares their resolved types and methods.
+  std::vector<MethodToCompile> methods;
+  for (std::vector<MethodToCompile>& class_methods : methods_by_class) {
+    methods.insert(methods.end(), class_methods.begin(), class_methods.end());
+    class_methods.clear();
+    class_methods.shrink_to_fit();
+  }
+  CompileMethodVisitor compile_visitor(&context, methods);
+  context.ForAllWithWorkStealing(0, methods.size(), &compile_visitor, thread_count);
 }
 
 void CompilerDriver::AddCompiledMethod(const MethodReference& method_ref,
@@ -2772,6 +3161,24 @@ void CompilerDriver::AddCompiledMethod(const MethodReference& method_ref,
   DCHECK(GetCompiledMethod(method_ref) != nullptr) << method_ref.PrettyMethod();
 }
 
+void CompilerDriver::FreeCompiledMethods(const std::vector<const DexFile*>& dex_files) {
+  for (const DexFile* dex_file : dex_files) {
+    for (uint32_t method_idx = 0, num_methods = dex_file->NumMethodIds();
+         method_idx != num_methods;
+         ++method_idx) {
+      MethodReference method_ref(dex_file, method_idx);
+      CompiledMethod* compiled_method = nullptr;
+      if (compiled_methods_.Get(method_ref, &compiled_method) && compiled_method != nullptr) {
+        MethodTable::InsertResult result = compiled_methods_.Insert(method_ref,
+                                                                    /*expected*/ compiled_method,
+                                                                    /*desired*/ nullptr);
+        CHECK(result == MethodTable::kInsertResultSuccess);
+        CompiledMethod::ReleaseSwapAllocatedCompiledMethod(this, compiled_method);
+      }
+    }
+  }
+}
+
 bool CompilerDriver::GetCompiledClass(const ClassReference& ref,
                                       mirror::Class::Status* status) const {
   DCHECK(status != nullptr);
@@ -57,6 +57,7 @@ class VerifierDepsTest;
 
 class BitVector;
 class CompiledMethod;
+class CompiledMethodCache;
 class CompilerOptions;
 class DexCompilationUnit;
 struct InlineIGetIPutData;
@@ -113,6 +114,15 @@ class CompilerDriver {
     return ArrayRef<const DexFile* const>(dex_files_for_oat_file_);
   }
 
+  // Set the code of a previous compilation, reused instead of compiling the unchanged methods.
+  void SetCompiledMethodCache(const CompiledMethodCache* compiled_method_cache) {
+    compiled_method_cache_ = compiled_method_cache;
+  }
+
+  const CompiledMethodCache* GetCompiledMethodCache() const {
+    return compiled_method_cache_;
+  }
+
   void CompileAll(jobject class_loader,
                   const std::vector<const DexFile*>& dex_files,
                   TimingLogger* timings)
@@ -161,6 +171,9 @@ class CompilerDriver {
   void AddCompiledMethod(const MethodReference& method_ref,
                          CompiledMethod* const compiled_method,
                          size_t non_relative_linker_patch_count);
+  // Free the compiled methods of the dex files, once their code is no longer needed. Not thread
+  // safe.
+  void FreeCompiledMethods(const std::vector<const DexFile*>& dex_files);
 
   void SetRequiresConstructorBarrier(Thread* self,
                                      const DexFile* dex_file,
@@ -530,6 +543,9 @@ class CompilerDriver {
 
   CompiledMethodStorage compiled_method_storage_;
 
+  // Code of a previous compilation for incremental compilation, or null.
+  const CompiledMethodCache* compiled_method_cache_;
+
   // Info for profile guided compilation.
   const ProfileCompilationInfo* const profile_compilation_info_;
 
@@ -544,7 +560,8 @@ class CompilerDriver {
   // indexes for dex-to-dex compilation in the current dex file.
   const BitVector* current_dex_to_dex_methods_;
 
-  friend class CompileClassVisitor;
+  friend class CollectMethodsToCompileVisitor;
+  friend class CompiledMethodCacheTest;
   friend class DexToDexDecompilerTest;
   friend class verifier::VerifierDepsTest;
   DISALLOW_COPY_AND_ASSIGN(CompilerDriver);
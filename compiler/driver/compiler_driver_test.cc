@@ -182,6 +182,31 @@ TEST_F(CompilerDriverTest, AbstractMethodErrorStub) {
   }
 }
 
+TEST_F(CompilerDriverTest, FreeCompiledMethods) {
+  jobject class_loader;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    class_loader = LoadDex("StaticLeafMethods");
+  }
+  ASSERT_NE(class_loader, nullptr);
+  CompileAll(class_loader);
+
+  auto count_compiled_methods = [&]() {
+    size_t count = 0u;
+    for (const DexFile* dex_file : dex_files_) {
+      for (uint32_t method_idx = 0; method_idx != dex_file->NumMethodIds(); ++method_idx) {
+        if (compiler_driver_->GetCompiledMethod(MethodReference(dex_file, method_idx)) != nullptr) {
+          ++count;
+        }
+      }
+    }
+    return count;
+  };
+  EXPECT_NE(0u, count_compiled_methods());
+  compiler_driver_->FreeCompiledMethods(dex_files_);
+  EXPECT_EQ(0u, count_compiled_methods());
+}
+
 class CompilerDriverMethodsTest : public CompilerDriverTest {
  protected:
   std::unordered_set<std::string>* GetCompiledMethods() OVERRIDE {
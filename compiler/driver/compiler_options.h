@@ -34,6 +34,7 @@ class VerifierDepsTest;
 }  // namespace verifier
 
 class DexFile;
+class PassCosts;
 
 class CompilerOptions FINAL {
  public:
@@ -274,6 +275,15 @@ class CompilerOptions FINAL {
     return dump_stats_;
   }
 
+  PassCosts* GetPassCosts() const {
+    return pass_costs_;
+  }
+
+  // Collect the cost of each pass of the methods compiled into pass_costs, if not null.
+  void SetPassCosts(PassCosts* pass_costs) {
+    pass_costs_ = pass_costs;
+  }
+
  private:
   bool ParseDumpInitFailures(const std::string& option, std::string* error_msg);
   void ParseDumpCfgPasses(const StringPiece& option, UsageFn Usage);
@@ -346,6 +356,9 @@ class CompilerOptions FINAL {
   // compiler-dependant behavior.
   const std::vector<std::string>* passes_to_run_;
 
+  // Not owned, null unless the cost of the passes is tracked.
+  PassCosts* pass_costs_;
+
   friend class Dex2Oat;
   friend class DexToDexDecompilerTest;
   friend class CommonCompilerTest;
@@ -35,8 +35,9 @@ class JitCompiler {
   static JitCompiler* Create();
   virtual ~JitCompiler();
 
-  // Compilation entrypoint. Returns whether the compilation succeeded.
-  bool CompileMethod(Thread* self, ArtMethod* method, bool osr)
+  // Compilation entrypoint. Returns whether the compilation succeeded. A baseline compilation
+  // skips most optimizations, and the code asks for an optimized compilation once hot enough.
+  bool CompileMethod(Thread* self, ArtMethod* method, bool osr, bool baseline)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   CompilerOptions* GetCompilerOptions() const {
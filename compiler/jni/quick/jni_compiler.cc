@@ -381,8 +381,31 @@ static JniCompiledMethod ArtJniCompileMethodInternal(CompilerDriver* driver,
   //    can occur. The result is the saved JNI local state that is restored by the exit call. We
   //    abuse the JNI calling convention here, that is guaranteed to support passing 2 pointer
   //    arguments.
+  //    A @FastNative method stays Runnable, so where the assembler supports it, the stub does
+  //    what JniMethodFastStart does itself: save the local reference cookie in the frame and
+  //    start a new local reference segment.
   FrameOffset locked_object_handle_scope_offset(0xBEEFDEAD);
-  if (LIKELY(!is_critical_native)) {
+  const bool inline_jni_start = is_fast_native && !is_synchronized &&
+      (instruction_set == kArm64 || instruction_set == kX86_64);
+  if (UNLIKELY(inline_jni_start)) {
+    main_jni_conv->ResetIterator(FrameOffset(main_out_arg_size));
+    ManagedRegister env_reg = main_jni_conv->CurrentParamRegister();
+    ManagedRegister scratch = main_jni_conv->InterproceduralScratchRegister();
+    const size_t pointer_size = static_cast<size_t>(kPointerSize);
+    const Offset cookie_offset = JNIEnvExt::LocalRefCookieOffset(pointer_size);
+    __ LoadRawPtrFromThread(env_reg, Thread::JniEnvOffset<kPointerSize>());
+    __ Copy(main_jni_conv->SavedLocalReferenceCookieOffset(),
+            env_reg,
+            cookie_offset,
+            scratch,
+            4 /* sizeof cookie */);
+    __ Copy(env_reg,
+            cookie_offset,
+            env_reg,
+            JNIEnvExt::SegmentStateOffset(pointer_size),
+            scratch,
+            4 /* sizeof cookie */);
+  } else if (LIKELY(!is_critical_native)) {
     // Skip this for @CriticalNative methods. They do not call JniMethodStart.
     ThreadOffset<kPointerSize> jni_start(
         GetJniEntrypointThreadOffset<kPointerSize>(JniEntrypoint::kStart,
@@ -427,7 +450,9 @@ static JniCompiledMethod ArtJniCompileMethodInternal(CompilerDriver* driver,
       FrameOffset(0xDEADBEEFu));  // @CriticalNative - use obviously bad value for debugging
   if (LIKELY(!is_critical_native)) {
     saved_cookie_offset = main_jni_conv->SavedLocalReferenceCookieOffset();
-    __ Store(saved_cookie_offset, main_jni_conv->IntReturnRegister(), 4 /* sizeof cookie */);
+    if (!inline_jni_start) {
+      __ Store(saved_cookie_offset, main_jni_conv->IntReturnRegister(), 4 /* sizeof cookie */);
+    }
   }
 
   // 7. Iterate over arguments placing values from managed calling convention in
@@ -23,6 +23,7 @@
 #include "induction_var_range.h"
 #include "nodes.h"
 #include "side_effects_analysis.h"
+#include "superblock_cloner.h"
 
 namespace art {
 
@@ -502,6 +503,9 @@ class BCEVisitor : public HGraphVisitor {
   static constexpr uint32_t kMaxLengthForAddingDeoptimize =
       std::numeric_limits<int32_t>::max() - 1024 * 1024;
 
+  // The most loops of a method that are copied for loop versioning.
+  static constexpr size_t kMaxVersionedLoops = 4;
+
   // Added blocks for loop body entry test.
   bool IsAddedBlock(HBasicBlock* block) const {
     return block->GetBlockId() >= initial_block_size_;
@@ -524,6 +528,7 @@ class BCEVisitor : public HGraphVisitor {
         taken_test_loop_(std::less<uint32_t>(),
                          allocator_.Adapter(kArenaAllocBoundsCheckElimination)),
         finite_loop_(allocator_.Adapter(kArenaAllocBoundsCheckElimination)),
+        versioning_candidates_(allocator_.Adapter(kArenaAllocBoundsCheckElimination)),
         has_dom_based_dynamic_bce_(false),
         initial_block_size_(graph->GetBlocks().size()),
         side_effects_(side_effects),
@@ -560,6 +565,9 @@ class BCEVisitor : public HGraphVisitor {
     // new taken-test structures (see TransformLoopForDeoptimizationIfNeeded()).
     InsertPhiNodes();
 
+    // Eliminate the remaining bounds checks that allow it in a copy of their loop.
+    VersionLoopsForDynamicBCE();
+
     // Clear the loop data structures.
     early_exit_loop_.clear();
     taken_test_loop_.clear();
@@ -894,6 +902,11 @@ class BCEVisitor : public HGraphVisitor {
         TransformLoopForDynamicBCE(loop, bounds_check);
         return;
       }
+      // Remember the bounds check for loop versioning, which is done at the end, when
+      // no other transformation of the loop can interfere with its copy.
+      if (IsLoopVersioningCandidate(loop, bounds_check)) {
+        versioning_candidates_.push_back(bounds_check);
+      }
       // Otherwise, prepare dominator-based dynamic elimination.
       if (first_index_bounds_check_map_.find(array_length->GetId()) ==
           first_index_bounds_check_map_.end()) {
@@ -1637,23 +1650,28 @@ class BCEVisitor : public HGraphVisitor {
       // Otherwise, allow dynamic bce if the index (which is necessarily an induction at
       // this point) is the direct loop index (viz. a[i]), since then the runtime tests
       // ensure upper bound cannot cause an infinite loop.
-      HInstruction* control = loop->GetHeader()->GetLastInstruction();
-      if (control->IsIf()) {
-        HInstruction* if_expr = control->AsIf()->InputAt(0);
-        if (if_expr->IsCondition()) {
-          HCondition* condition = if_expr->AsCondition();
-          if (index == condition->InputAt(0) ||
-              index == condition->InputAt(1)) {
-            finite_loop_.insert(loop_id);
-            return true;
-          }
-        }
+      if (IsLoopControl(loop, index)) {
+        finite_loop_.insert(loop_id);
+        return true;
       }
       return false;
     }
     return true;
   }
 
+  /** Returns true if the index is an operand of the condition of the loop header. */
+  static bool IsLoopControl(HLoopInformation* loop, HInstruction* index) {
+    HInstruction* control = loop->GetHeader()->GetLastInstruction();
+    if (control->IsIf()) {
+      HInstruction* if_expr = control->AsIf()->InputAt(0);
+      if (if_expr->IsCondition()) {
+        HCondition* condition = if_expr->AsCondition();
+        return index == condition->InputAt(0) || index == condition->InputAt(1);
+      }
+    }
+    return false;
+  }
+
   /**
    * Returns appropriate preheader for the loop, depending on whether the
    * instruction appears in the loop header or proper loop-body.
@@ -1867,6 +1885,218 @@ class BCEVisitor : public HGraphVisitor {
     return phi;
   }
 
+  /**
+   * Returns true if the bounds check can be eliminated in a copy of its loop that is only
+   * entered when a test before the loop shows the index is always within bounds. Since the
+   * original loop remains for the other cases, this also applies to loops with early exits
+   * and to bounds checks that are not executed in each iteration.
+   */
+  bool IsLoopVersioningCandidate(HLoopInformation* loop, HBoundsCheck* bounds_check) {
+    // As for deoptimization, the range test must dominate the whole loop, and the loop
+    // must not be entered from the middle by osr.
+    if (loop == nullptr || loop->IsIrreducible() || GetGraph()->IsCompilingOsr()) {
+      return false;
+    }
+    HInstruction* index = bounds_check->InputAt(0);
+    HInstruction* length = bounds_check->InputAt(1);
+    bool needs_finite_test = false;
+    bool needs_taken_test = false;
+    if (!induction_range_.CanGenerateRange(
+            bounds_check, index, &needs_finite_test, &needs_taken_test)) {
+      return false;
+    }
+    // A possibly infinite loop would exceed the tested range, unless the index is the
+    // loop control, which the test then bounds too. A loop that is not taken may fail
+    // the test and run the original loop, which is fine.
+    if (needs_finite_test && !IsLoopControl(loop, index)) {
+      return false;
+    }
+    return loop->IsDefinedOutOfTheLoop(length) || GetInvariantArray(loop, length) != nullptr;
+  }
+
+  /**
+   * Returns the array of a length loaded in the loop if the array is loop invariant,
+   * looking through a null check in the loop, or null otherwise.
+   */
+  static HInstruction* GetInvariantArray(HLoopInformation* loop, HInstruction* length) {
+    if (length->IsArrayLength() && length->GetBlock()->GetLoopInformation() == loop) {
+      HInstruction* array = length->InputAt(0);
+      if (array->IsNullCheck() && array->GetBlock()->GetLoopInformation() == loop) {
+        array = array->InputAt(0);
+      }
+      if (loop->IsDefinedOutOfTheLoop(array)) {
+        return array;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Performs loop versioning for the recorded candidates, one loop at a time, since the
+   * loop and induction information are rebuilt after each copy.
+   */
+  void VersionLoopsForDynamicBCE() {
+    ScopedArenaVector<HBoundsCheck*> bounds_checks(
+        allocator_.Adapter(kArenaAllocBoundsCheckElimination));
+    size_t number_of_versioned_loops = 0;
+    for (size_t i = 0, e = versioning_candidates_.size(); i != e; ++i) {
+      if (number_of_versioned_loops == kMaxVersionedLoops) {
+        break;
+      }
+      // Skip the candidates eliminated since, or whose loop has been handled.
+      HBoundsCheck* bounds_check = versioning_candidates_[i];
+      if (bounds_check == nullptr || !bounds_check->IsInBlock()) {
+        continue;
+      }
+      // Collect the candidates of the same loop that still allow versioning.
+      HLoopInformation* loop = bounds_check->GetBlock()->GetLoopInformation();
+      bounds_checks.clear();
+      for (size_t j = i; j != e; ++j) {
+        HBoundsCheck* other_bounds_check = versioning_candidates_[j];
+        if (other_bounds_check != nullptr &&
+            other_bounds_check->IsInBlock() &&
+            other_bounds_check->GetBlock()->GetLoopInformation() == loop) {
+          versioning_candidates_[j] = nullptr;
+          if (IsLoopVersioningCandidate(loop, other_bounds_check)) {
+            bounds_checks.push_back(other_bounds_check);
+          }
+        }
+      }
+      // A taken-test structure in the preheader is not handled.
+      if (bounds_checks.empty() ||
+          taken_test_loop_.find(loop->GetHeader()->GetBlockId()) != taken_test_loop_.end()) {
+        continue;
+      }
+      SuperblockCloner cloner(GetGraph(), loop, &allocator_);
+      if (cloner.IsLoopClonable()) {
+        TransformLoopForVersioning(loop, &cloner, bounds_checks);
+        RebuildLoopAndInductionInformation();
+        ++number_of_versioned_loops;
+      }
+    }
+    versioning_candidates_.clear();
+  }
+
+  /**
+   * Copies the loop and eliminates the bounds checks in the copy, which is only entered if
+   * the range of each index is within bounds. For example, this loop:
+   *
+   *   for (int i = lower; i < upper; i++) {
+   *     if (i == x) break;
+   *     array[i] = 0;
+   *   }
+   *
+   * will be transformed to:
+   *
+   *   if (array == null || lower > upper - 1 || upper - 1 >= array.length) {  // unsigned
+   *     // Original loop.
+   *   } else {
+   *     // Loop without the bounds check.
+   *   }
+   *
+   * where the null test is only needed for an array length loaded in the loop.
+   */
+  void TransformLoopForVersioning(HLoopInformation* loop,
+                                  SuperblockCloner* cloner,
+                                  const ScopedArenaVector<HBoundsCheck*>& bounds_checks) {
+    HGraph* graph = GetGraph();
+    ArenaAllocator* allocator = graph->GetAllocator();
+    HBasicBlock* preheader = loop->GetPreHeader();
+    ScopedArenaVector<HInstruction*> lowers(allocator_.Adapter(kArenaAllocBoundsCheckElimination));
+    ScopedArenaVector<HInstruction*> uppers(allocator_.Adapter(kArenaAllocBoundsCheckElimination));
+    ScopedArenaSafeMap<HInstruction*, HInstruction*> lengths(
+        std::less<HInstruction*>(), allocator_.Adapter(kArenaAllocBoundsCheckElimination));
+    // Generate the ranges and the null tests of the arrays in the preheader.
+    HInstruction* is_null = nullptr;
+    for (HBoundsCheck* bounds_check : bounds_checks) {
+      HInstruction* lower = nullptr;
+      HInstruction* upper = nullptr;
+      induction_range_.GenerateRange(
+          bounds_check, bounds_check->InputAt(0), graph, preheader, &lower, &upper);
+      lowers.push_back(lower);
+      uppers.push_back(upper);
+      HInstruction* length = bounds_check->InputAt(1);
+      HInstruction* array = GetInvariantArray(loop, length);
+      if (array != nullptr && lengths.find(length) == lengths.end()) {
+        lengths.Put(length, nullptr);
+        if (array->CanBeNull()) {
+          is_null = InsertOr(preheader, is_null, new (allocator) HEqual(
+              array, graph->GetNullConstant()));
+        }
+      }
+    }
+    cloner->VersionLoop();
+    // If needed, load the lengths after the null test, which selects the original loop.
+    HBasicBlock* block = preheader;
+    if (is_null != nullptr) {
+      block = new (allocator) HBasicBlock(graph, preheader->GetDexPc());
+      graph->AddBlock(block);
+      block->AddInstruction(new (allocator) HGoto());  // placeholder
+      preheader->RemoveInstruction(preheader->GetLastInstruction());
+      preheader->AddInstruction(new (allocator) HIf(is_null));
+      preheader->AddSuccessor(block);
+      block->AddSuccessor(cloner->GetOriginalPreHeader());
+    }
+    // Test the ranges, using unsigned comparisons as for deoptimization.
+    HInstruction* out_of_bounds = nullptr;
+    for (size_t i = 0, e = bounds_checks.size(); i != e; ++i) {
+      HInstruction* length = bounds_checks[i]->InputAt(1);
+      auto it = lengths.find(length);
+      if (it != lengths.end()) {
+        if (it->second == nullptr) {
+          HInstruction* new_length = length->Clone(allocator);
+          block->InsertInstructionBefore(new_length, block->GetLastInstruction());
+          new_length->ReplaceInput(GetInvariantArray(loop, length), 0);
+          it->second = new_length;
+        }
+        length = it->second;
+      }
+      if (lowers[i] != nullptr) {
+        out_of_bounds = InsertOr(block, out_of_bounds, new (allocator) HAbove(
+            lowers[i], uppers[i]));
+      }
+      out_of_bounds = InsertOr(block, out_of_bounds, new (allocator) HAboveOrEqual(
+          uppers[i], length));
+    }
+    block->RemoveInstruction(block->GetLastInstruction());
+    block->AddInstruction(new (allocator) HIf(out_of_bounds));
+    block->AddSuccessor(cloner->GetCopyPreHeader());
+    // Eliminate the bounds checks in the copy.
+    for (HBoundsCheck* bounds_check : bounds_checks) {
+      HInstruction* copy = cloner->GetInstructionCopy(bounds_check);
+      ReplaceInstruction(copy, copy->InputAt(0));
+    }
+  }
+
+  /**
+   * Inserts `condition` before the last instruction of the block, and returns its
+   * disjunction with `previous`, if any.
+   */
+  HInstruction* InsertOr(HBasicBlock* block, HInstruction* previous, HInstruction* condition) {
+    block->InsertInstructionBefore(condition, block->GetLastInstruction());
+    if (previous == nullptr) {
+      return condition;
+    }
+    HInstruction* disjunction = new (GetGraph()->GetAllocator()) HOr(
+        DataType::Type::kInt32, previous, condition);
+    block->InsertInstructionBefore(disjunction, block->GetLastInstruction());
+    return disjunction;
+  }
+
+  /** Rebuilds the loop and induction information after a loop has been copied. */
+  void RebuildLoopAndInductionInformation() {
+    HGraph* graph = GetGraph();
+    graph->ClearLoopInformation();
+    graph->ClearDominanceInformation();
+    graph->BuildDominatorTree();
+    // Reverse post order visits an outer loop before its inner loops.
+    for (HBasicBlock* block : graph->GetReversePostOrder()) {
+      if (block->IsLoopHeader() && !block->GetLoopInformation()->IsIrreducible()) {
+        induction_range_.ReVisit(block->GetLoopInformation());
+      }
+    }
+  }
+
   /** Helper method to replace an instruction with another instruction. */
   void ReplaceInstruction(HInstruction* instruction, HInstruction* replacement) {
     // Safe iteration.
@@ -1897,6 +2127,9 @@ class BCEVisitor : public HGraphVisitor {
   // Finite loop bookkeeping.
   ScopedArenaSet<uint32_t> finite_loop_;
 
+  // Bounds checks to eliminate by loop versioning, in visiting order.
+  ScopedArenaVector<HBoundsCheck*> versioning_candidates_;
+
   // Flag that denotes whether dominator-based dynamic elimination has occurred.
   bool has_dom_based_dynamic_bce_;
 
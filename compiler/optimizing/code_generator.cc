@@ -40,6 +40,7 @@
 #include "code_generator_mips64.h"
 #endif
 
+#include "art_method.h"
 #include "base/bit_utils.h"
 #include "base/bit_utils_iterator.h"
 #include "base/casts.h"
@@ -48,9 +49,11 @@
 #include "compiled_method.h"
 #include "dex/verified_method.h"
 #include "driver/compiler_driver.h"
+#include "gc/heap.h"
 #include "graph_visualizer.h"
 #include "intern_table.h"
 #include "intrinsics.h"
+#include "jit/profiling_info.h"
 #include "leb128.h"
 #include "mirror/array-inl.h"
 #include "mirror/object_array-inl.h"
@@ -61,6 +64,8 @@
 #include "scoped_thread_state_change-inl.h"
 #include "ssa_liveness_analysis.h"
 #include "stack_map_stream.h"
+#include "stack_reference.h"
+#include "string_builder_append.h"
 #include "thread-current-inl.h"
 #include "utils/assembler.h"
 
@@ -453,6 +458,11 @@ void CodeGenerator::InitializeCodeGeneration(size_t number_of_spill_slots,
   block_order_ = &block_order;
   DCHECK(!block_order.empty());
   DCHECK(block_order[0] == GetGraph()->GetEntryBlock());
+  if (GetGraph()->IsCompilingBaseline()) {
+    // The frame entry of baseline code may call the CompileOptimized entrypoint, which
+    // reads the current method from the frame.
+    MarkNotLeaf();
+  }
   ComputeSpillMask();
   first_register_slot_in_slow_path_ = RoundUp(
       (number_of_out_slots + number_of_spill_slots) * kVRegSize, GetPreferredSlotsAlignment());
@@ -562,10 +572,12 @@ void CodeGenerator::GenerateInvokeUnresolvedRuntimeCall(HInvokeUnresolved* invok
   InvokeRuntime(entrypoint, invoke, invoke->GetDexPc(), nullptr);
 }
 
-void CodeGenerator::GenerateInvokePolymorphicCall(HInvokePolymorphic* invoke) {
-  MoveConstant(invoke->GetLocations()->GetTemp(0), static_cast<int32_t>(invoke->GetType()));
+void CodeGenerator::GenerateInvokePolymorphicCall(HInvokePolymorphic* invoke,
+                                                  Location temp,
+                                                  SlowPathCode* slow_path) {
+  MoveConstant(temp, static_cast<int32_t>(invoke->GetType()));
   QuickEntrypointEnum entrypoint = kQuickInvokePolymorphic;
-  InvokeRuntime(entrypoint, invoke, invoke->GetDexPc(), nullptr);
+  InvokeRuntime(entrypoint, invoke, invoke->GetDexPc(), slow_path);
 }
 
 void CodeGenerator::CreateUnresolvedFieldLocationSummary(
@@ -721,6 +733,35 @@ void CodeGenerator::GenerateLoadClassRuntimeCall(HLoadClass* cls) {
   }
 }
 
+void CodeGenerator::CreateStringBuilderAppendLocations(HStringBuilderAppend* instruction,
+                                                       Location out) {
+  ArenaAllocator* allocator = GetGraph()->GetAllocator();
+  LocationSummary* locations =
+      new (allocator) LocationSummary(instruction, LocationSummary::kCallOnMainOnly);
+  locations->SetOut(out);
+  locations->SetInAt(instruction->FormatIndex(),
+                     Location::ConstantLocation(instruction->GetFormat()));
+
+  // The arguments are passed in the outgoing arguments area, like the stack arguments of a call.
+  uint32_t f = static_cast<uint32_t>(instruction->GetFormat()->GetValue());
+  PointerSize pointer_size = InstructionSetPointerSize(GetInstructionSet());
+  size_t stack_offset = static_cast<size_t>(pointer_size);  // Start after the ArtMethod*.
+  for (size_t i = 0, num_args = instruction->GetNumberOfArguments(); i != num_args; ++i) {
+    DCHECK_EQ(f & StringBuilderAppend::kArgMask,
+              static_cast<uint32_t>(StringBuilderAppend::Argument::kString));
+    static_assert(sizeof(StackReference<mirror::Object>) == sizeof(uint32_t), "Size check.");
+    locations->SetInAt(i, Location::StackSlot(stack_offset));
+    f >>= StringBuilderAppend::kBitsPerArg;
+    stack_offset += sizeof(uint32_t);
+  }
+  DCHECK_EQ(f, 0u);
+
+  size_t param_size = stack_offset - static_cast<size_t>(pointer_size);
+  DCHECK_ALIGNED(param_size, kVRegSize);
+  size_t num_vregs = param_size / kVRegSize;
+  graph_->UpdateMaximumNumberOfOutVRegs(num_vregs);
+}
+
 void CodeGenerator::BlockIfInRegister(Location location, bool is_out) const {
   // The DCHECKS below check that a register is not specified twice in
   // the summary. The out location can overlap with an input, so we need
@@ -1616,6 +1657,22 @@ void CodeGenerator::EmitJitRoots(uint8_t* code,
   EmitJitRootPatches(code, roots_data);
 }
 
+ProfilingInfo* CodeGenerator::GetBaselineProfilingInfo() const {
+  DCHECK(GetGraph()->IsCompilingBaseline());
+  // The JIT doesn't collect the profiling info of a method being compiled.
+  ScopedObjectAccess soa(Thread::Current());
+  ProfilingInfo* info = GetGraph()->GetArtMethod()->GetProfilingInfo(kRuntimePointerSize);
+  DCHECK(info != nullptr);
+  return info;
+}
+
+BranchCache* CodeGenerator::GetBaselineBranchCache(HIf* if_instr) const {
+  if (!GetGraph()->IsCompilingBaseline() || if_instr->GetDexPc() == kNoDexPc) {
+    return nullptr;
+  }
+  return GetBaselineProfilingInfo()->GetBranchCache(if_instr->GetDexPc());
+}
+
 QuickEntrypointEnum CodeGenerator::GetArrayAllocationEntrypoint(Handle<mirror::Class> array_klass) {
   ScopedObjectAccess soa(Thread::Current());
   if (array_klass == nullptr) {
@@ -1634,4 +1691,52 @@ QuickEntrypointEnum CodeGenerator::GetArrayAllocationEntrypoint(Handle<mirror::C
   return kQuickAllocArrayResolved;
 }
 
+bool CodeGenerator::CanInlineTlabAllocation(HInstruction* instruction) {
+  // Only the concurrent copying collector, which is the one using read barriers, allocates in
+  // thread-local buffers by default. With the other collectors the buffer is always empty and the
+  // inlined code would be dead weight before the call. The entrypoints poison the class reference.
+  if (!kEmitCompilerReadBarrier || kPoisonHeapReferences) {
+    return false;
+  }
+  if (instruction->IsNewArray()) {
+    return true;
+  }
+  // The other entrypoints resolve the class or check its access.
+  HNewInstance* new_instance = instruction->AsNewInstance();
+  return !new_instance->IsStringAlloc() &&
+      (new_instance->GetEntrypoint() == kQuickAllocObjectInitialized ||
+       new_instance->GetEntrypoint() == kQuickAllocObjectResolved);
+}
+
+size_t CodeGenerator::GetArrayAllocationComponentSizeShift(QuickEntrypointEnum entrypoint) {
+  switch (entrypoint) {
+    case kQuickAllocArrayResolved8: return 0u;
+    case kQuickAllocArrayResolved16: return 1u;
+    case kQuickAllocArrayResolved32: return 2u;
+    case kQuickAllocArrayResolved64: return 3u;
+    default:
+      LOG(FATAL) << "Unexpected array allocation entrypoint " << entrypoint;
+      UNREACHABLE();
+  }
+}
+
+uint32_t CodeGenerator::GetMaxTlabArrayLength(size_t component_size_shift) {
+  // Objects smaller than the minimum threshold are never allocated in the large object space.
+  // Leave room for the rounding up of the size to the object alignment.
+  const size_t data_offset =
+      mirror::Array::DataOffset(1u << component_size_shift).Uint32Value();
+  return dchecked_integral_cast<uint32_t>(
+      (gc::Heap::kMinLargeObjectThreshold - kObjectAlignment - data_offset) >>
+          component_size_shift);
+}
+
+bool CodeGenerator::IsReadBarrierElided(HInstruction* instruction) {
+  if (instruction->IsInstanceFieldGet()) {
+    return instruction->AsInstanceFieldGet()->IsReadBarrierElided();
+  } else if (instruction->IsArrayGet()) {
+    return instruction->AsArrayGet()->IsReadBarrierElided();
+  }
+  return false;
+}
+
 }  // namespace art
@@ -58,9 +58,11 @@ static constexpr ReadBarrierOption kCompilerReadBarrierOption =
     kEmitCompilerReadBarrier ? kWithReadBarrier : kWithoutReadBarrier;
 
 class Assembler;
+class BranchCache;
 class CodeGenerator;
 class CompilerDriver;
 class CompilerOptions;
+class ProfilingInfo;
 class StackMapStream;
 class ParallelMoveResolver;
 
@@ -374,6 +376,13 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
     return requires_current_method_;
   }
 
+  // The profiling info in which baseline code counts the invocations of the method.
+  ProfilingInfo* GetBaselineProfilingInfo() const;
+
+  // The branch counters that baseline code increments for `if_instr`, null if not compiling
+  // baseline code or if the IF instruction has none.
+  BranchCache* GetBaselineBranchCache(HIf* if_instr) const;
+
   // Clears the spill slots taken by loop phis in the `LocationSummary` of the
   // suspend check. This is called when the code generator generates code
   // for the suspend check at the back edge (instead of where the suspend check
@@ -435,6 +444,9 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
         // and the slow path shall re-check and simply return if the cast is actually OK.
         return !needs_read_barrier;
       }
+      case TypeCheckKind::kBitstringCheck:
+        // The subtype check bits of a class don't depend on which copy of it we read.
+        return true;
       case TypeCheckKind::kArrayCheck:
       case TypeCheckKind::kUnresolvedCheck:
         return false;
@@ -537,7 +549,14 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
       HInvokeStaticOrDirect* invoke, Location temp, SlowPathCode* slow_path);
   void GenerateInvokeUnresolvedRuntimeCall(HInvokeUnresolved* invoke);
 
-  void GenerateInvokePolymorphicCall(HInvokePolymorphic* invoke);
+  void GenerateInvokePolymorphicCall(HInvokePolymorphic* invoke) {
+    GenerateInvokePolymorphicCall(invoke, invoke->GetLocations()->GetTemp(0));
+  }
+  // Calls the runtime for `invoke` with the arguments already in the calling convention, and
+  // `temp` as the method register, which receives the return type.
+  void GenerateInvokePolymorphicCall(HInvokePolymorphic* invoke,
+                                     Location temp,
+                                     SlowPathCode* slow_path = nullptr);
 
   void CreateUnresolvedFieldLocationSummary(
       HInstruction* field_access,
@@ -558,6 +577,10 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
 
   static void CreateSystemArrayCopyLocationSummary(HInvoke* invoke);
 
+  // Passes the arguments of `instruction` in the outgoing arguments area, for the
+  // StringBuilderAppend entrypoint.
+  void CreateStringBuilderAppendLocations(HStringBuilderAppend* instruction, Location out);
+
   void SetDisassemblyInformation(DisassemblyInformation* info) { disasm_info_ = info; }
   DisassemblyInformation* GetDisassemblyInformation() const { return disasm_info_; }
 
@@ -616,6 +639,21 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
 
   static QuickEntrypointEnum GetArrayAllocationEntrypoint(Handle<mirror::Class> array_klass);
 
+  // Whether the code of `instruction`, an HNewInstance or an HNewArray, bumps the thread-local
+  // allocation buffer like the allocation entrypoints do, and only calls the entrypoint when the
+  // object doesn't fit.
+  static bool CanInlineTlabAllocation(HInstruction* instruction);
+  // The component size shift of the arrays allocated by `entrypoint`, one of the
+  // kQuickAllocArrayResolved* returned by GetArrayAllocationEntrypoint().
+  static size_t GetArrayAllocationComponentSizeShift(QuickEntrypointEnum entrypoint);
+  // The longest array of the component size shift that can be allocated in the thread-local
+  // allocation buffer. Longer arrays may belong in the large object space.
+  static uint32_t GetMaxTlabArrayLength(size_t component_size_shift);
+
+  // Whether `instruction` loads a reference without a read barrier, as ReadBarrierElimination
+  // proved it unnecessary. Only the instance field and array gets have their barrier elided.
+  static bool IsReadBarrierElided(HInstruction* instruction);
+
  protected:
   // Patch info used for recording locations of required linker patches and their targets,
   // i.e. target method, string, type or code identified by their dex file and index.
@@ -30,6 +30,7 @@
 #include "heap_poisoning.h"
 #include "intrinsics.h"
 #include "intrinsics_arm64.h"
+#include "jit/profiling_info.h"
 #include "linker/arm64/relative_patcher_arm64.h"
 #include "linker/linker_patch.h"
 #include "lock_word.h"
@@ -463,6 +464,30 @@ class SuspendCheckSlowPathARM64 : public SlowPathCodeARM64 {
   DISALLOW_COPY_AND_ASSIGN(SuspendCheckSlowPathARM64);
 };
 
+class CompileOptimizedSlowPathARM64 : public SlowPathCodeARM64 {
+ public:
+  CompileOptimizedSlowPathARM64() : SlowPathCodeARM64(/* instruction */ nullptr) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    uint32_t entrypoint_offset =
+        GetThreadOffset<kArm64PointerSize>(kQuickCompileOptimized).Int32Value();
+    __ Bind(GetEntryLabel());
+    __ Ldr(lr, MemOperand(tr, entrypoint_offset));
+    // Note: we don't record the call here (and therefore don't generate a stack
+    // map), as the entrypoint saves all registers and never suspends.
+    __ Blr(lr);
+    CheckEntrypointTypes<kQuickCompileOptimized, void, ArtMethod*, Thread*>();
+    __ B(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE {
+    return "CompileOptimizedSlowPathARM64";
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileOptimizedSlowPathARM64);
+};
+
 class TypeCheckSlowPathARM64 : public SlowPathCodeARM64 {
  public:
   TypeCheckSlowPathARM64(HInstruction* instruction, bool is_fatal)
@@ -582,6 +607,56 @@ class ArraySetSlowPathARM64 : public SlowPathCodeARM64 {
   DISALLOW_COPY_AND_ASSIGN(ArraySetSlowPathARM64);
 };
 
+// Calls the allocation entrypoint of an HNewInstance or HNewArray whose object doesn't fit in
+// the thread-local allocation buffer.
+class AllocationSlowPathARM64 : public SlowPathCodeARM64 {
+ public:
+  AllocationSlowPathARM64(HInstruction* instruction, QuickEntrypointEnum entrypoint)
+      : SlowPathCodeARM64(instruction), entrypoint_(entrypoint) {
+    DCHECK(instruction->IsNewInstance() || instruction->IsNewArray());
+  }
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    Location out = locations->Out();
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(out.reg()));
+    CodeGeneratorARM64* arm64_codegen = down_cast<CodeGeneratorARM64*>(codegen);
+
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    InvokeRuntimeCallingConvention calling_convention;
+    HParallelMove parallel_move(codegen->GetGraph()->GetAllocator());
+    parallel_move.AddMove(
+        locations->InAt(0),
+        LocationFrom(calling_convention.GetRegisterAt(0)),
+        DataType::Type::kReference,
+        nullptr);
+    if (instruction_->IsNewArray()) {
+      parallel_move.AddMove(
+          locations->InAt(1),
+          LocationFrom(calling_convention.GetRegisterAt(1)),
+          DataType::Type::kInt32,
+          nullptr);
+    }
+    codegen->GetMoveResolver()->EmitNativeCode(&parallel_move);
+    arm64_codegen->InvokeRuntime(entrypoint_, instruction_, instruction_->GetDexPc(), this);
+    arm64_codegen->MoveLocation(out,
+                                calling_convention.GetReturnLocation(DataType::Type::kReference),
+                                DataType::Type::kReference);
+
+    RestoreLiveRegisters(codegen, locations);
+    __ B(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE { return "AllocationSlowPathARM64"; }
+
+ private:
+  const QuickEntrypointEnum entrypoint_;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSlowPathARM64);
+};
+
 void JumpTableARM64::EmitTable(CodeGeneratorARM64* codegen) {
   uint32_t num_entries = switch_instr_->GetNumEntries();
   DCHECK_GE(num_entries, kPackedSwitchCompareJumpThreshold);
@@ -1535,9 +1610,35 @@ void CodeGeneratorARM64::GenerateFrameEntry() {
     }
   }
 
+  MaybeIncrementHotness();
   MaybeGenerateMarkingRegisterCheck(/* code */ __LINE__);
 }
 
+void CodeGeneratorARM64::MaybeIncrementHotness() {
+  if (!GetGraph()->IsCompilingBaseline()) {
+    return;
+  }
+  // InitializeCodeGeneration() made the method non-leaf so that the entrypoint finds
+  // the current method at sp[0].
+  DCHECK(RequiresCurrentMethod());
+  DCHECK(!HasEmptyFrame());
+  MacroAssembler* masm = GetVIXLAssembler();
+  uint64_t address = reinterpret_cast64<uint64_t>(GetBaselineProfilingInfo());
+  int32_t counter_offset = ProfilingInfo::BaselineHotnessCountOffset().Int32Value();
+  SlowPathCodeARM64* slow_path = new (GetScopedAllocator()) CompileOptimizedSlowPathARM64();
+  AddSlowPath(slow_path);
+  UseScratchRegisterScope temps(masm);
+  Register temp = temps.AcquireX();
+  Register counter = temps.AcquireW();
+  __ Mov(temp, address);
+  __ Ldrh(counter, MemOperand(temp, counter_offset));
+  __ Add(counter, counter, 1);
+  __ Strh(counter, MemOperand(temp, counter_offset));
+  __ Tst(counter, 0xffff);
+  __ B(eq, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
 void CodeGeneratorARM64::GenerateFrameExit() {
   GetAssembler()->cfi().RememberState();
   if (!HasEmptyFrame()) {
@@ -2197,7 +2298,9 @@ void LocationsBuilderARM64::HandleFieldGet(HInstruction* instruction,
   DCHECK(instruction->IsInstanceFieldGet() || instruction->IsStaticFieldGet());
 
   bool object_field_get_with_read_barrier =
-      kEmitCompilerReadBarrier && (instruction->GetType() == DataType::Type::kReference);
+      kEmitCompilerReadBarrier &&
+      (instruction->GetType() == DataType::Type::kReference) &&
+      !CodeGenerator::IsReadBarrierElided(instruction);
   LocationSummary* locations =
       new (GetGraph()->GetAllocator()) LocationSummary(instruction,
                                                        object_field_get_with_read_barrier
@@ -2244,7 +2347,8 @@ void InstructionCodeGeneratorARM64::HandleFieldGet(HInstruction* instruction,
   MemOperand field = HeapOperand(InputRegisterAt(instruction, 0), field_info.GetFieldOffset());
 
   if (kEmitCompilerReadBarrier && kUseBakerReadBarrier &&
-      load_type == DataType::Type::kReference) {
+      load_type == DataType::Type::kReference &&
+      !CodeGenerator::IsReadBarrierElided(instruction)) {
     // Object FieldGet with Baker's read barrier case.
     // /* HeapReference<Object> */ out = *(base + offset)
     Register base = RegisterFrom(base_loc, DataType::Type::kReference);
@@ -2275,10 +2379,14 @@ void InstructionCodeGeneratorARM64::HandleFieldGet(HInstruction* instruction,
       codegen_->MaybeRecordImplicitNullCheck(instruction);
     }
     if (load_type == DataType::Type::kReference) {
-      // If read barriers are enabled, emit read barriers other than
-      // Baker's using a slow path (and also unpoison the loaded
-      // reference, if heap poisoning is enabled).
-      codegen_->MaybeGenerateReadBarrierSlow(instruction, out, out, base_loc, offset);
+      if (CodeGenerator::IsReadBarrierElided(instruction)) {
+        GetAssembler()->MaybeUnpoisonHeapReference(WRegisterFrom(out));
+      } else {
+        // If read barriers are enabled, emit read barriers other than
+        // Baker's using a slow path (and also unpoison the loaded
+        // reference, if heap poisoning is enabled).
+        codegen_->MaybeGenerateReadBarrierSlow(instruction, out, out, base_loc, offset);
+      }
     }
   }
 }
@@ -2296,6 +2404,19 @@ void LocationsBuilderARM64::HandleFieldSet(HInstruction* instruction) {
   }
 }
 
+// Returns whether `constructor_fence` is right before the store publishing its only object.
+// The store is then a store-release, which orders the stores of the constructor before it,
+// instead of the fence.
+static bool IsFenceFoldedIntoStoreRelease(HConstructorFence* constructor_fence) {
+  HInstruction* next = constructor_fence->GetNext();
+  if (constructor_fence->InputCount() != 1u ||
+      next == nullptr ||
+      !(next->IsInstanceFieldSet() || next->IsStaticFieldSet())) {
+    return false;
+  }
+  return next->InputAt(1) == constructor_fence->InputAt(0);
+}
+
 void InstructionCodeGeneratorARM64::HandleFieldSet(HInstruction* instruction,
                                                    const FieldInfo& field_info,
                                                    bool value_can_be_null) {
@@ -2320,7 +2441,11 @@ void InstructionCodeGeneratorARM64::HandleFieldSet(HInstruction* instruction,
       source = temp;
     }
 
-    if (field_info.IsVolatile()) {
+    HInstruction* previous = instruction->GetPrevious();
+    bool is_publishing_store = previous != nullptr &&
+        previous->IsConstructorFence() &&
+        IsFenceFoldedIntoStoreRelease(previous->AsConstructorFence());
+    if (field_info.IsVolatile() || is_publishing_store) {
       codegen_->StoreRelease(
           instruction, field_type, source, HeapOperand(obj, offset), /* needs_null_check */ true);
     } else {
@@ -2664,7 +2789,9 @@ void InstructionCodeGeneratorARM64::VisitMultiplyAccumulate(HMultiplyAccumulate*
 
 void LocationsBuilderARM64::VisitArrayGet(HArrayGet* instruction) {
   bool object_array_get_with_read_barrier =
-      kEmitCompilerReadBarrier && (instruction->GetType() == DataType::Type::kReference);
+      kEmitCompilerReadBarrier &&
+      (instruction->GetType() == DataType::Type::kReference) &&
+      !instruction->IsReadBarrierElided();
   LocationSummary* locations =
       new (GetGraph()->GetAllocator()) LocationSummary(instruction,
                                                        object_array_get_with_read_barrier
@@ -2722,7 +2849,8 @@ void InstructionCodeGeneratorARM64::VisitArrayGet(HArrayGet* instruction) {
            instruction->GetArray()->IsIntermediateAddress() &&
            kEmitCompilerReadBarrier));
 
-  if (type == DataType::Type::kReference && kEmitCompilerReadBarrier && kUseBakerReadBarrier) {
+  if (type == DataType::Type::kReference && kEmitCompilerReadBarrier && kUseBakerReadBarrier &&
+      !instruction->IsReadBarrierElided()) {
     // Object ArrayGet with Baker's read barrier case.
     // Note that a potential implicit null check is handled in the
     // CodeGeneratorARM64::GenerateArrayLoadWithBakerReadBarrier call.
@@ -2826,7 +2954,9 @@ void InstructionCodeGeneratorARM64::VisitArrayGet(HArrayGet* instruction) {
           sizeof(mirror::HeapReference<mirror::Object>) == sizeof(int32_t),
           "art::mirror::HeapReference<art::mirror::Object> and int32_t have different sizes.");
       Location obj_loc = locations->InAt(0);
-      if (index.IsConstant()) {
+      if (instruction->IsReadBarrierElided()) {
+        GetAssembler()->MaybeUnpoisonHeapReference(WRegisterFrom(out));
+      } else if (index.IsConstant()) {
         codegen_->MaybeGenerateReadBarrierSlow(instruction, out, out, obj_loc, offset);
       } else {
         codegen_->MaybeGenerateReadBarrierSlow(instruction, out, out, obj_loc, offset, index);
@@ -3493,7 +3623,12 @@ void InstructionCodeGeneratorARM64::HandleGoto(HInstruction* got, HBasicBlock* s
   HInstruction* previous = got->GetPrevious();
   HLoopInformation* info = block->GetLoopInformation();
 
-  if (info != nullptr && info->IsBackEdge(*block) && info->HasSuspendCheck()) {
+  if (info != nullptr &&
+      info->IsBackEdge(*block) &&
+      info->HasSuspendCheck() &&
+      !info->GetSuspendCheck()->IsNoOp()) {
+    // Long running loops in baseline code also get the method optimized.
+    codegen_->MaybeIncrementHotness();
     GenerateSuspendCheck(info->GetSuspendCheck(), successor);
     return;
   }
@@ -3638,7 +3773,42 @@ void LocationsBuilderARM64::VisitIf(HIf* if_instr) {
   }
 }
 
+void InstructionCodeGeneratorARM64::GenerateBranchProfile(HIf* if_instr) {
+  BranchCache* cache = codegen_->GetBaselineBranchCache(if_instr);
+  if (cache == nullptr) {
+    return;
+  }
+  HInstruction* cond = if_instr->InputAt(0);
+  DCHECK(IsBooleanValueOrMaterializedCondition(cond));
+  MacroAssembler* masm = GetVIXLAssembler();
+  UseScratchRegisterScope temps(masm);
+  Register temp = temps.AcquireX();
+  Register counter = temps.AcquireW();
+  // The taken count follows the not taken count.
+  uint64_t not_taken_address =
+      reinterpret_cast64<uint64_t>(cache) + BranchCache::NotTakenCountOffset().Uint32Value();
+  bool taken_on_true = if_instr->IsTrueSuccessorBranchTarget();
+  if (cond->IsIntConstant()) {
+    bool taken = cond->AsIntConstant()->IsTrue() == taken_on_true;
+    __ Mov(temp, not_taken_address + (taken ? sizeof(uint16_t) : 0u));
+  } else if (taken_on_true) {
+    __ Mov(temp, not_taken_address);
+    __ Add(temp, temp, Operand(InputRegisterAt(if_instr, 0).W(), UXTW, 1));
+  } else {
+    __ Mov(temp, not_taken_address + sizeof(uint16_t));
+    __ Sub(temp, temp, Operand(InputRegisterAt(if_instr, 0).W(), UXTW, 1));
+  }
+  // Saturate the counter, the compiler only needs the ratio of the two counts.
+  vixl::aarch64::Label done;
+  __ Ldrh(counter, MemOperand(temp));
+  __ Add(counter, counter, 1);
+  __ Tbnz(counter, 16, &done);
+  __ Strh(counter, MemOperand(temp));
+  __ Bind(&done);
+}
+
 void InstructionCodeGeneratorARM64::VisitIf(HIf* if_instr) {
+  GenerateBranchProfile(if_instr);
   HBasicBlock* true_successor = if_instr->IfTrueSuccessor();
   HBasicBlock* false_successor = if_instr->IfFalseSuccessor();
   vixl::aarch64::Label* true_target = codegen_->GetLabelOf(true_successor);
@@ -3814,6 +3984,25 @@ static size_t NumberOfCheckCastTemps(TypeCheckKind type_check_kind) {
   return 1 + NumberOfInstanceOfTemps(type_check_kind);
 }
 
+void InstructionCodeGeneratorARM64::GenerateBitstringTypeCheckCompare(HInstruction* check,
+                                                                      Register temp) {
+  uint32_t path_to_root = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringPathToRoot()
+      : check->AsCheckCast()->GetBitstringPathToRoot();
+  uint32_t mask = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringMask()
+      : check->AsCheckCast()->GetBitstringMask();
+  // The bitstring is in the most significant bits of the status field, after the class status.
+  DCHECK(mask == 0u || IsPowerOfTwo(~mask + 1u)) << std::hex << mask;
+  DCHECK_EQ(path_to_root & ~mask, 0u);
+
+  // /* uint32_t */ temp = temp->status_
+  __ Ldr(temp, HeapOperand(temp, mirror::Class::StatusOffset()));
+  // Keep the bits of the bitstring of the target, and compare them.
+  __ And(temp, temp, mask);
+  __ Cmp(temp, path_to_root);
+}
+
 void LocationsBuilderARM64::VisitInstanceOf(HInstanceOf* instruction) {
   LocationSummary::CallKind call_kind = LocationSummary::kNoCall;
   TypeCheckKind type_check_kind = instruction->GetTypeCheckKind();
@@ -3833,6 +4022,8 @@ void LocationsBuilderARM64::VisitInstanceOf(HInstanceOf* instruction) {
     case TypeCheckKind::kInterfaceCheck:
       call_kind = LocationSummary::kCallOnSlowPath;
       break;
+    case TypeCheckKind::kBitstringCheck:
+      break;
   }
 
   LocationSummary* locations =
@@ -4010,6 +4201,22 @@ void InstructionCodeGeneratorARM64::VisitInstanceOf(HInstanceOf* instruction) {
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ out = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        out_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        maybe_temp_loc,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, out);
+      __ Cset(out, eq);
+      if (zero.IsLinked()) {
+        __ B(&done);
+      }
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck:
     case TypeCheckKind::kInterfaceCheck: {
       // Note that we indeed only call on slow path, but we always go
@@ -4209,6 +4416,19 @@ void InstructionCodeGeneratorARM64::VisitCheckCast(HCheckCast* instruction) {
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ temp = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        temp_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        maybe_temp2_loc,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, temp);
+      __ B(ne, type_check_slow_path->GetEntryLabel());
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck:
       // We always go into the type check slow path for the unresolved check cases.
       //
@@ -4519,10 +4739,20 @@ void CodeGeneratorARM64::GenerateVirtualCall(
 }
 
 void LocationsBuilderARM64::VisitInvokePolymorphic(HInvokePolymorphic* invoke) {
+  IntrinsicLocationsBuilderARM64 intrinsic(GetGraph()->GetAllocator(), codegen_);
+  if (intrinsic.TryDispatch(invoke)) {
+    return;
+  }
+
   HandleInvoke(invoke);
 }
 
 void InstructionCodeGeneratorARM64::VisitInvokePolymorphic(HInvokePolymorphic* invoke) {
+  if (TryGenerateIntrinsicCode(invoke, codegen_)) {
+    codegen_->MaybeGenerateMarkingRegisterCheck(/* code */ __LINE__);
+    return;
+  }
+
   codegen_->GenerateInvokePolymorphicCall(invoke);
   codegen_->MaybeGenerateMarkingRegisterCheck(/* code */ __LINE__);
 }
@@ -5198,6 +5428,16 @@ void InstructionCodeGeneratorARM64::VisitNeg(HNeg* neg) {
 }
 
 void LocationsBuilderARM64::VisitNewArray(HNewArray* instruction) {
+  if (CodeGenerator::CanInlineTlabAllocation(instruction)) {
+    LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
+        instruction, LocationSummary::kCallOnSlowPath);
+    locations->SetInAt(0, Location::RequiresRegister());
+    locations->SetInAt(1, Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+    return;
+  }
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
       instruction, LocationSummary::kCallOnMainOnly);
   InvokeRuntimeCallingConvention calling_convention;
@@ -5211,12 +5451,61 @@ void InstructionCodeGeneratorARM64::VisitNewArray(HNewArray* instruction) {
   // of poisoning the reference.
   QuickEntrypointEnum entrypoint =
       CodeGenerator::GetArrayAllocationEntrypoint(instruction->GetLoadClass()->GetClass());
-  codegen_->InvokeRuntime(entrypoint, instruction, instruction->GetDexPc());
+  if (CodeGenerator::CanInlineTlabAllocation(instruction)) {
+    GenerateTlabArrayAllocation(instruction, entrypoint);
+  } else {
+    codegen_->InvokeRuntime(entrypoint, instruction, instruction->GetDexPc());
+  }
   CheckEntrypointTypes<kQuickAllocArrayResolved, void*, mirror::Class*, int32_t>();
   codegen_->MaybeGenerateMarkingRegisterCheck(/* code */ __LINE__);
 }
 
+// Same as ALLOC_ARRAY_TLAB_FAST_PATH_RESOLVED_WITH_SIZE in quick_entrypoints_arm64.S.
+void InstructionCodeGeneratorARM64::GenerateTlabArrayAllocation(HNewArray* instruction,
+                                                                 QuickEntrypointEnum entrypoint) {
+  LocationSummary* locations = instruction->GetLocations();
+  Register out = XRegisterFrom(locations->Out());
+  Register cls = WRegisterFrom(locations->InAt(0));
+  Register length = WRegisterFrom(locations->InAt(1));
+  Register new_pos = XRegisterFrom(locations->GetTemp(0));
+  Register temp = XRegisterFrom(locations->GetTemp(1));
+  const size_t shift = CodeGenerator::GetArrayAllocationComponentSizeShift(entrypoint);
+  const uint32_t data_offset = mirror::Array::DataOffset(1u << shift).Uint32Value();
+  SlowPathCodeARM64* slow_path =
+      new (codegen_->GetScopedAllocator()) AllocationSlowPathARM64(instruction, entrypoint);
+  codegen_->AddSlowPath(slow_path);
+
+  // Negative lengths are large unsigned values and take the slow path too.
+  __ Cmp(length, CodeGenerator::GetMaxTlabArrayLength(shift));
+  __ B(hi, slow_path->GetEntryLabel());
+  __ Lsl(new_pos.W(), length, shift);
+  __ Add(new_pos, new_pos, data_offset + kObjectAlignment - 1u);
+  __ And(new_pos, new_pos, ~static_cast<uint64_t>(kObjectAlignment - 1u));
+  __ Ldr(out, MemOperand(tr, Thread::ThreadLocalPosOffset<kArm64PointerSize>().Int32Value()));
+  __ Ldr(temp, MemOperand(tr, Thread::ThreadLocalEndOffset<kArm64PointerSize>().Int32Value()));
+  __ Add(new_pos, out, new_pos);
+  __ Cmp(new_pos, temp);
+  __ B(hi, slow_path->GetEntryLabel());
+  __ Str(new_pos, MemOperand(tr, Thread::ThreadLocalPosOffset<kArm64PointerSize>().Int32Value()));
+  __ Ldr(temp, MemOperand(tr, Thread::ThreadLocalObjectsOffset<kArm64PointerSize>().Int32Value()));
+  __ Add(temp, temp, 1);
+  __ Str(temp, MemOperand(tr, Thread::ThreadLocalObjectsOffset<kArm64PointerSize>().Int32Value()));
+  // The buffer is zeroed, only the class and the length need to be stored.
+  __ Str(cls, HeapOperand(out.W(), mirror::Object::ClassOffset()));
+  __ Str(length, HeapOperand(out.W(), mirror::Array::LengthOffset()));
+  __ Bind(slow_path->GetExitLabel());
+}
+
 void LocationsBuilderARM64::VisitNewInstance(HNewInstance* instruction) {
+  if (CodeGenerator::CanInlineTlabAllocation(instruction)) {
+    LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
+        instruction, LocationSummary::kCallOnSlowPath);
+    locations->SetInAt(0, Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+    return;
+  }
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
       instruction, LocationSummary::kCallOnMainOnly);
   InvokeRuntimeCallingConvention calling_convention;
@@ -5246,6 +5535,9 @@ void InstructionCodeGeneratorARM64::VisitNewInstance(HNewInstance* instruction)
       __ blr(lr);
       codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
     }
+  } else if (CodeGenerator::CanInlineTlabAllocation(instruction)) {
+    GenerateTlabObjectAllocation(instruction);
+    CheckEntrypointTypes<kQuickAllocObjectWithChecks, void*, mirror::Class*>();
   } else {
     codegen_->InvokeRuntime(instruction->GetEntrypoint(), instruction, instruction->GetDexPc());
     CheckEntrypointTypes<kQuickAllocObjectWithChecks, void*, mirror::Class*>();
@@ -5253,6 +5545,38 @@ void InstructionCodeGeneratorARM64::VisitNewInstance(HNewInstance* instruction)
   codegen_->MaybeGenerateMarkingRegisterCheck(/* code */ __LINE__);
 }
 
+// Same as ALLOC_OBJECT_TLAB_FAST_PATH_RESOLVED in quick_entrypoints_arm64.S.
+void InstructionCodeGeneratorARM64::GenerateTlabObjectAllocation(HNewInstance* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Register out = XRegisterFrom(locations->Out());
+  Register cls = WRegisterFrom(locations->InAt(0));
+  Register new_pos = XRegisterFrom(locations->GetTemp(0));
+  Register temp = XRegisterFrom(locations->GetTemp(1));
+  SlowPathCodeARM64* slow_path = new (codegen_->GetScopedAllocator())
+      AllocationSlowPathARM64(instruction, instruction->GetEntrypoint());
+  codegen_->AddSlowPath(slow_path);
+
+  // The size is too large to fit if the class is not initialized or is finalizable, see
+  // InitializeClassVisitors in class-inl.h.
+  __ Ldr(new_pos.W(), HeapOperand(cls, mirror::Class::ObjectSizeAllocFastPathOffset()));
+  __ Ldr(out, MemOperand(tr, Thread::ThreadLocalPosOffset<kArm64PointerSize>().Int32Value()));
+  __ Ldr(temp, MemOperand(tr, Thread::ThreadLocalEndOffset<kArm64PointerSize>().Int32Value()));
+  __ Add(new_pos, out, new_pos);
+  __ Cmp(new_pos, temp);
+  __ B(hi, slow_path->GetEntryLabel());
+  __ Str(new_pos, MemOperand(tr, Thread::ThreadLocalPosOffset<kArm64PointerSize>().Int32Value()));
+  __ Ldr(temp, MemOperand(tr, Thread::ThreadLocalObjectsOffset<kArm64PointerSize>().Int32Value()));
+  __ Add(temp, temp, 1);
+  __ Str(temp, MemOperand(tr, Thread::ThreadLocalObjectsOffset<kArm64PointerSize>().Int32Value()));
+  __ Str(cls, HeapOperand(out.W(), mirror::Object::ClassOffset()));
+  if (instruction->GetEntrypoint() == kQuickAllocObjectResolved) {
+    // The class was initialized by an implicit check, order the later loads of its statics
+    // after it. This also stands for the constructor fence removed for this entrypoint.
+    __ Dmb(InnerShareable, BarrierAll);
+  }
+  __ Bind(slow_path->GetExitLabel());
+}
+
 void LocationsBuilderARM64::VisitNot(HNot* instruction) {
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(instruction);
   locations->SetInAt(0, Location::RequiresRegister());
@@ -5438,8 +5762,11 @@ void LocationsBuilderARM64::VisitConstructorFence(HConstructorFence* constructor
   constructor_fence->SetLocations(nullptr);
 }
 
-void InstructionCodeGeneratorARM64::VisitConstructorFence(
-    HConstructorFence* constructor_fence ATTRIBUTE_UNUSED) {
+void InstructionCodeGeneratorARM64::VisitConstructorFence(HConstructorFence* constructor_fence) {
+  if (IsFenceFoldedIntoStoreRelease(constructor_fence)) {
+    // The next instruction is emitted as a store-release instead, see HandleFieldSet().
+    return;
+  }
   codegen_->GenerateMemoryBarrier(MemBarrierKind::kStoreStore);
 }
 
@@ -5517,6 +5844,16 @@ void InstructionCodeGeneratorARM64::VisitStaticFieldSet(HStaticFieldSet* instruc
   HandleFieldSet(instruction, instruction->GetFieldInfo(), instruction->GetValueCanBeNull());
 }
 
+void LocationsBuilderARM64::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  codegen_->CreateStringBuilderAppendLocations(instruction, LocationFrom(x0));
+}
+
+void InstructionCodeGeneratorARM64::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  __ Mov(w0, instruction->GetFormat()->GetValue());
+  codegen_->InvokeRuntime(kQuickStringBuilderAppend, instruction, instruction->GetDexPc());
+  CheckEntrypointTypes<kQuickStringBuilderAppend, void*, uint32_t>();
+}
+
 void LocationsBuilderARM64::VisitUnresolvedInstanceFieldGet(
     HUnresolvedInstanceFieldGet* instruction) {
   FieldAccessCallingConventionARM64 calling_convention;
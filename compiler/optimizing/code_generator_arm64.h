@@ -265,6 +265,9 @@ class InstructionCodeGeneratorARM64 : public InstructionCodeGenerator {
   void GenerateClassInitializationCheck(SlowPathCodeARM64* slow_path,
                                         vixl::aarch64::Register class_reg);
   void GenerateSuspendCheck(HSuspendCheck* instruction, HBasicBlock* successor);
+  // Bump the thread-local allocation buffer, see CodeGenerator::CanInlineTlabAllocation().
+  void GenerateTlabObjectAllocation(HNewInstance* instruction);
+  void GenerateTlabArrayAllocation(HNewArray* instruction, QuickEntrypointEnum entrypoint);
   void HandleBinaryOp(HBinaryOperation* instr);
 
   void HandleFieldSet(HInstruction* instruction,
@@ -287,6 +290,11 @@ class InstructionCodeGeneratorARM64 : public InstructionCodeGenerator {
                                         uint32_t offset,
                                         Location maybe_temp,
                                         ReadBarrierOption read_barrier_option);
+  // Compare the subtype check bits of the class in `temp` with the bitstring of the
+  // target class of `check`, setting the flags for an eq or ne branch.
+  // Clobbers `temp`.
+  void GenerateBitstringTypeCheckCompare(HInstruction* check, vixl::aarch64::Register temp);
+
   // Generate a heap reference load using two different registers
   // `out` and `obj`:
   //
@@ -319,6 +327,8 @@ class InstructionCodeGeneratorARM64 : public InstructionCodeGenerator {
   void GenerateFcmp(HInstruction* instruction);
 
   void HandleShift(HBinaryOperation* instr);
+  // Counts the outcome of the branch in baseline code.
+  void GenerateBranchProfile(HIf* if_instr);
   void GenerateTestAndBranch(HInstruction* instruction,
                              size_t condition_input_index,
                              vixl::aarch64::Label* true_target,
@@ -411,6 +421,10 @@ class CodeGeneratorARM64 : public CodeGenerator {
   void GenerateFrameEntry() OVERRIDE;
   void GenerateFrameExit() OVERRIDE;
 
+  // Count the invocations and loop iterations of baseline code and request the optimized
+  // compilation when the counter wraps around.
+  void MaybeIncrementHotness();
+
   vixl::aarch64::CPURegList GetFramePreservedCoreRegisters() const;
   vixl::aarch64::CPURegList GetFramePreservedFPRegisters() const;
 
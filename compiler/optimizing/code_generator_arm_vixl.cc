@@ -2793,7 +2793,10 @@ void InstructionCodeGeneratorARMVIXL::HandleGoto(HInstruction* got, HBasicBlock*
   HInstruction* previous = got->GetPrevious();
   HLoopInformation* info = block->GetLoopInformation();
 
-  if (info != nullptr && info->IsBackEdge(*block) && info->HasSuspendCheck()) {
+  if (info != nullptr &&
+      info->IsBackEdge(*block) &&
+      info->HasSuspendCheck() &&
+      !info->GetSuspendCheck()->IsNoOp()) {
     GenerateSuspendCheck(info->GetSuspendCheck(), successor);
     return;
   }
@@ -5807,6 +5810,17 @@ void InstructionCodeGeneratorARMVIXL::VisitStaticFieldSet(HStaticFieldSet* instr
   HandleFieldSet(instruction, instruction->GetFieldInfo(), instruction->GetValueCanBeNull());
 }
 
+// The instruction simplifier only creates HStringBuilderAppend on arm64 and x86_64.
+void LocationsBuilderARMVIXL::VisitStringBuilderAppend(
+    HStringBuilderAppend* instruction ATTRIBUTE_UNUSED) {
+  LOG(FATAL) << "Unreachable";
+}
+
+void InstructionCodeGeneratorARMVIXL::VisitStringBuilderAppend(
+    HStringBuilderAppend* instruction ATTRIBUTE_UNUSED) {
+  LOG(FATAL) << "Unreachable";
+}
+
 void LocationsBuilderARMVIXL::VisitUnresolvedInstanceFieldGet(
     HUnresolvedInstanceFieldGet* instruction) {
   FieldAccessCallingConventionARMVIXL calling_convention;
@@ -7369,6 +7383,26 @@ static size_t NumberOfCheckCastTemps(TypeCheckKind type_check_kind) {
   return 1 + NumberOfInstanceOfTemps(type_check_kind);
 }
 
+void InstructionCodeGeneratorARMVIXL::GenerateBitstringTypeCheckCompare(HInstruction* check,
+                                                                        vixl32::Register temp) {
+  uint32_t path_to_root = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringPathToRoot()
+      : check->AsCheckCast()->GetBitstringPathToRoot();
+  uint32_t mask = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringMask()
+      : check->AsCheckCast()->GetBitstringMask();
+  // The bitstring is in the most significant bits of the status field, after the class status.
+  DCHECK(mask == 0u || IsPowerOfTwo(~mask + 1u)) << std::hex << mask;
+  DCHECK_EQ(path_to_root & ~mask, 0u);
+
+  // /* uint32_t */ temp = temp->status_
+  GetAssembler()->LoadFromOffset(
+      kLoadWord, temp, temp, mirror::Class::StatusOffset().Int32Value());
+  // Keep the bits of the bitstring of the target, and compare them.
+  __ And(temp, temp, mask);
+  __ Cmp(temp, path_to_root);
+}
+
 void LocationsBuilderARMVIXL::VisitInstanceOf(HInstanceOf* instruction) {
   LocationSummary::CallKind call_kind = LocationSummary::kNoCall;
   TypeCheckKind type_check_kind = instruction->GetTypeCheckKind();
@@ -7388,6 +7422,8 @@ void LocationsBuilderARMVIXL::VisitInstanceOf(HInstanceOf* instruction) {
     case TypeCheckKind::kInterfaceCheck:
       call_kind = LocationSummary::kCallOnSlowPath;
       break;
+    case TypeCheckKind::kBitstringCheck:
+      break;
   }
 
   LocationSummary* locations =
@@ -7624,6 +7660,33 @@ void InstructionCodeGeneratorARMVIXL::VisitInstanceOf(HInstanceOf* instruction)
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ out = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        out_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        maybe_temp_loc,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, out);
+      // We speculatively set the result to false without changing the condition
+      // flags, which allows us to avoid some branching later.
+      __ Mov(LeaveFlags, out, 0);
+      if (out.IsLow()) {
+        // We use the scope because of the IT block that follows.
+        ExactAssemblyScope guard(GetVIXLAssembler(),
+                                 2 * vixl32::k16BitT32InstructionSizeInBytes,
+                                 CodeBufferCheckScope::kExactSize);
+
+        __ it(eq);
+        __ mov(eq, out, 1);
+      } else {
+        __ B(ne, final_label, /* far_target */ false);
+        __ Mov(out, 1);
+      }
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck:
     case TypeCheckKind::kInterfaceCheck: {
       // Note that we indeed only call on slow path, but we always go
@@ -7814,6 +7877,19 @@ void InstructionCodeGeneratorARMVIXL::VisitCheckCast(HCheckCast* instruction) {
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ temp = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        temp_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        maybe_temp2_loc,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, temp);
+      __ B(ne, type_check_slow_path->GetEntryLabel());
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck:
       // We always go into the type check slow path for the unresolved check case.
       // We cannot directly call the CheckCast runtime entry point
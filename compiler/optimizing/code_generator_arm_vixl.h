@@ -364,6 +364,11 @@ class InstructionCodeGeneratorARMVIXL : public InstructionCodeGenerator {
                                         uint32_t offset,
                                         Location maybe_temp,
                                         ReadBarrierOption read_barrier_option);
+  // Compare the subtype check bits of the class in `temp` with the bitstring of the
+  // target class of `check`, setting the flags for an eq or ne branch.
+  // Clobbers `temp`.
+  void GenerateBitstringTypeCheckCompare(HInstruction* check, vixl::aarch32::Register temp);
+
   // Generate a heap reference load using two different registers
   // `out` and `obj`:
   //
@@ -3264,6 +3264,27 @@ static size_t NumberOfCheckCastTemps(TypeCheckKind type_check_kind) {
   return 1 + NumberOfInstanceOfTemps(type_check_kind);
 }
 
+void InstructionCodeGeneratorMIPS::GenerateBitstringTypeCheckCompare(HInstruction* check,
+                                                                     Register temp) {
+  uint32_t path_to_root = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringPathToRoot()
+      : check->AsCheckCast()->GetBitstringPathToRoot();
+  uint32_t mask = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringMask()
+      : check->AsCheckCast()->GetBitstringMask();
+  // The bitstring is in the most significant bits of the status field, after the class status.
+  DCHECK(mask == 0u || IsPowerOfTwo(~mask + 1u)) << std::hex << mask;
+  DCHECK_EQ(path_to_root & ~mask, 0u);
+
+  // /* uint32_t */ temp = temp->status_
+  __ LoadFromOffset(kLoadWord, temp, temp, mirror::Class::StatusOffset().Int32Value());
+  // Keep the bits of the bitstring of the target, and compare them.
+  __ LoadConst32(TMP, mask);
+  __ And(temp, temp, TMP);
+  __ LoadConst32(TMP, path_to_root);
+  __ Xor(temp, temp, TMP);
+}
+
 void LocationsBuilderMIPS::VisitCheckCast(HCheckCast* instruction) {
   LocationSummary::CallKind call_kind = LocationSummary::kNoCall;
   bool throws_into_catch = instruction->CanThrowIntoCatchBlock();
@@ -3278,6 +3299,11 @@ void LocationsBuilderMIPS::VisitCheckCast(HCheckCast* instruction) {
           ? LocationSummary::kCallOnSlowPath
           : LocationSummary::kNoCall;  // In fact, call on a fatal (non-returning) slow path.
       break;
+    case TypeCheckKind::kBitstringCheck:
+      call_kind = throws_into_catch
+          ? LocationSummary::kCallOnSlowPath
+          : LocationSummary::kNoCall;  // In fact, call on a fatal (non-returning) slow path.
+      break;
     case TypeCheckKind::kArrayCheck:
     case TypeCheckKind::kUnresolvedCheck:
     case TypeCheckKind::kInterfaceCheck:
@@ -3325,6 +3351,10 @@ void InstructionCodeGeneratorMIPS::VisitCheckCast(HCheckCast* instruction) {
          type_check_kind == TypeCheckKind::kArrayObjectCheck) &&
         !instruction->CanThrowIntoCatchBlock();
   }
+  // The subtype check bits of a class don't depend on which copy of it we read.
+  if (type_check_kind == TypeCheckKind::kBitstringCheck) {
+    is_type_check_slow_path_fatal = !instruction->CanThrowIntoCatchBlock();
+  }
   SlowPathCodeMIPS* slow_path =
       new (codegen_->GetScopedAllocator()) TypeCheckSlowPathMIPS(
           instruction, is_type_check_slow_path_fatal);
@@ -3429,6 +3459,19 @@ void InstructionCodeGeneratorMIPS::VisitCheckCast(HCheckCast* instruction) {
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ temp = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        temp_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        maybe_temp2_loc,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, temp);
+      __ Bnez(temp, slow_path->GetEntryLabel());
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck:
       // We always go into the type check slow path for the unresolved check case.
       // We cannot directly call the CheckCast runtime entry point
@@ -4029,7 +4072,10 @@ void InstructionCodeGeneratorMIPS::HandleGoto(HInstruction* got, HBasicBlock* su
   HInstruction* previous = got->GetPrevious();
   HLoopInformation* info = block->GetLoopInformation();
 
-  if (info != nullptr && info->IsBackEdge(*block) && info->HasSuspendCheck()) {
+  if (info != nullptr &&
+      info->IsBackEdge(*block) &&
+      info->HasSuspendCheck() &&
+      !info->GetSuspendCheck()->IsNoOp()) {
     GenerateSuspendCheck(info->GetSuspendCheck(), successor);
     return;
   }
@@ -7193,6 +7239,8 @@ void LocationsBuilderMIPS::VisitInstanceOf(HInstanceOf* instruction) {
     case TypeCheckKind::kInterfaceCheck:
       call_kind = LocationSummary::kCallOnSlowPath;
       break;
+    case TypeCheckKind::kBitstringCheck:
+      break;
   }
 
   LocationSummary* locations =
@@ -7346,6 +7394,19 @@ void InstructionCodeGeneratorMIPS::VisitInstanceOf(HInstanceOf* instruction) {
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ out = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        out_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        maybe_temp_loc,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, out);
+      __ Sltiu(out, out, 1);
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck:
     case TypeCheckKind::kInterfaceCheck: {
       // Note that we indeed only call on slow path, but we always go
@@ -8624,6 +8685,17 @@ void InstructionCodeGeneratorMIPS::VisitStaticFieldSet(HStaticFieldSet* instruct
                  instruction->GetValueCanBeNull());
 }
 
+// The instruction simplifier only creates HStringBuilderAppend on arm64 and x86_64.
+void LocationsBuilderMIPS::VisitStringBuilderAppend(
+    HStringBuilderAppend* instruction ATTRIBUTE_UNUSED) {
+  LOG(FATAL) << "Unreachable";
+}
+
+void InstructionCodeGeneratorMIPS::VisitStringBuilderAppend(
+    HStringBuilderAppend* instruction ATTRIBUTE_UNUSED) {
+  LOG(FATAL) << "Unreachable";
+}
+
 void LocationsBuilderMIPS::VisitUnresolvedInstanceFieldGet(
     HUnresolvedInstanceFieldGet* instruction) {
   FieldAccessCallingConventionMIPS calling_convention;
@@ -260,6 +260,10 @@ class InstructionCodeGeneratorMIPS : public InstructionCodeGenerator {
                                         uint32_t offset,
                                         Location maybe_temp,
                                         ReadBarrierOption read_barrier_option);
+  // Compare the subtype check bits of the class in `temp` with the bitstring of the
+  // target class of `check`, leaving zero in `temp` if they match.
+  void GenerateBitstringTypeCheckCompare(HInstruction* check, Register temp);
+
   // Generate a heap reference load using two different registers
   // `out` and `obj`:
   //
@@ -2819,6 +2819,27 @@ static size_t NumberOfCheckCastTemps(TypeCheckKind type_check_kind) {
   return 1 + NumberOfInstanceOfTemps(type_check_kind);
 }
 
+void InstructionCodeGeneratorMIPS64::GenerateBitstringTypeCheckCompare(HInstruction* check,
+                                                                       GpuRegister temp) {
+  uint32_t path_to_root = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringPathToRoot()
+      : check->AsCheckCast()->GetBitstringPathToRoot();
+  uint32_t mask = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringMask()
+      : check->AsCheckCast()->GetBitstringMask();
+  // The bitstring is in the most significant bits of the status field, after the class status.
+  DCHECK(mask == 0u || IsPowerOfTwo(~mask + 1u)) << std::hex << mask;
+  DCHECK_EQ(path_to_root & ~mask, 0u);
+
+  // /* uint32_t */ temp = temp->status_
+  __ LoadFromOffset(kLoadWord, temp, temp, mirror::Class::StatusOffset().Int32Value());
+  // Keep the bits of the bitstring of the target, and compare them.
+  __ LoadConst32(TMP, mask);
+  __ And(temp, temp, TMP);
+  __ LoadConst32(TMP, path_to_root);
+  __ Xor(temp, temp, TMP);
+}
+
 void LocationsBuilderMIPS64::VisitCheckCast(HCheckCast* instruction) {
   LocationSummary::CallKind call_kind = LocationSummary::kNoCall;
   bool throws_into_catch = instruction->CanThrowIntoCatchBlock();
@@ -2833,6 +2854,11 @@ void LocationsBuilderMIPS64::VisitCheckCast(HCheckCast* instruction) {
           ? LocationSummary::kCallOnSlowPath
           : LocationSummary::kNoCall;  // In fact, call on a fatal (non-returning) slow path.
       break;
+    case TypeCheckKind::kBitstringCheck:
+      call_kind = throws_into_catch
+          ? LocationSummary::kCallOnSlowPath
+          : LocationSummary::kNoCall;  // In fact, call on a fatal (non-returning) slow path.
+      break;
     case TypeCheckKind::kArrayCheck:
     case TypeCheckKind::kUnresolvedCheck:
     case TypeCheckKind::kInterfaceCheck:
@@ -2880,6 +2906,10 @@ void InstructionCodeGeneratorMIPS64::VisitCheckCast(HCheckCast* instruction) {
          type_check_kind == TypeCheckKind::kArrayObjectCheck) &&
         !instruction->CanThrowIntoCatchBlock();
   }
+  // The subtype check bits of a class don't depend on which copy of it we read.
+  if (type_check_kind == TypeCheckKind::kBitstringCheck) {
+    is_type_check_slow_path_fatal = !instruction->CanThrowIntoCatchBlock();
+  }
   SlowPathCodeMIPS64* slow_path =
       new (codegen_->GetScopedAllocator()) TypeCheckSlowPathMIPS64(
           instruction, is_type_check_slow_path_fatal);
@@ -2984,6 +3014,19 @@ void InstructionCodeGeneratorMIPS64::VisitCheckCast(HCheckCast* instruction) {
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ temp = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        temp_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        maybe_temp2_loc,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, temp);
+      __ Bnezc(temp, slow_path->GetEntryLabel());
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck:
       // We always go into the type check slow path for the unresolved check case.
       // We cannot directly call the CheckCast runtime entry point
@@ -3576,7 +3619,10 @@ void InstructionCodeGeneratorMIPS64::HandleGoto(HInstruction* got, HBasicBlock*
   HInstruction* previous = got->GetPrevious();
   HLoopInformation* info = block->GetLoopInformation();
 
-  if (info != nullptr && info->IsBackEdge(*block) && info->HasSuspendCheck()) {
+  if (info != nullptr &&
+      info->IsBackEdge(*block) &&
+      info->HasSuspendCheck() &&
+      !info->GetSuspendCheck()->IsNoOp()) {
     GenerateSuspendCheck(info->GetSuspendCheck(), successor);
     return;
   }
@@ -5529,6 +5575,8 @@ void LocationsBuilderMIPS64::VisitInstanceOf(HInstanceOf* instruction) {
     case TypeCheckKind::kInterfaceCheck:
       call_kind = LocationSummary::kCallOnSlowPath;
       break;
+    case TypeCheckKind::kBitstringCheck:
+      break;
   }
 
   LocationSummary* locations =
@@ -5682,6 +5730,19 @@ void InstructionCodeGeneratorMIPS64::VisitInstanceOf(HInstanceOf* instruction) {
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ out = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        out_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        maybe_temp_loc,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, out);
+      __ Sltiu(out, out, 1);
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck:
     case TypeCheckKind::kInterfaceCheck: {
       // Note that we indeed only call on slow path, but we always go
@@ -6754,6 +6815,17 @@ void InstructionCodeGeneratorMIPS64::VisitStaticFieldSet(HStaticFieldSet* instru
   HandleFieldSet(instruction, instruction->GetFieldInfo(), instruction->GetValueCanBeNull());
 }
 
+// The instruction simplifier only creates HStringBuilderAppend on arm64 and x86_64.
+void LocationsBuilderMIPS64::VisitStringBuilderAppend(
+    HStringBuilderAppend* instruction ATTRIBUTE_UNUSED) {
+  LOG(FATAL) << "Unreachable";
+}
+
+void InstructionCodeGeneratorMIPS64::VisitStringBuilderAppend(
+    HStringBuilderAppend* instruction ATTRIBUTE_UNUSED) {
+  LOG(FATAL) << "Unreachable";
+}
+
 void LocationsBuilderMIPS64::VisitUnresolvedInstanceFieldGet(
     HUnresolvedInstanceFieldGet* instruction) {
   FieldAccessCallingConventionMIPS64 calling_convention;
@@ -184,6 +184,28 @@ static void CreateVecUnOpLocations(ArenaAllocator* allocator, HVecUnaryOperation
   }
 }
 
+// Helper to compute the packed long min/max of dst and src into dst. There are no packed long
+// min/max instructions before AVX-512, so the result is selected with the SSE4.2 compare mask.
+static void GenerateVecLongMinMax(X86_64Assembler* assembler,
+                                  XmmRegister dst,
+                                  XmmRegister src,
+                                  XmmRegister mask,
+                                  bool is_min) {
+  DCHECK_NE(dst, src);
+  // Set the mask for the lanes where dst is the result.
+  if (is_min) {
+    assembler->movaps(mask, src);
+    assembler->pcmpgtq(mask, dst);
+  } else {
+    assembler->movaps(mask, dst);
+    assembler->pcmpgtq(mask, src);
+  }
+  // dst = src ^ ((dst ^ src) & mask)
+  assembler->pxor(dst, src);
+  assembler->pand(dst, mask);
+  assembler->pxor(dst, src);
+}
+
 void LocationsBuilderX86_64::VisitVecReduce(HVecReduce* instruction) {
   CreateVecUnOpLocations(GetGraph()->GetAllocator(), instruction);
   // Long reduction or min/max require a temporary.
@@ -192,6 +214,11 @@ void LocationsBuilderX86_64::VisitVecReduce(HVecReduce* instruction) {
       instruction->GetKind() == HVecReduce::kMax) {
     instruction->GetLocations()->AddTemp(Location::RequiresFpuRegister());
   }
+  // Long min/max also require a temporary for the compare mask.
+  if (instruction->GetPackedType() == DataType::Type::kInt64 &&
+      instruction->GetKind() != HVecReduce::kSum) {
+    instruction->GetLocations()->AddTemp(Location::RequiresFpuRegister());
+  }
 }
 
 void InstructionCodeGeneratorX86_64::VisitVecReduce(HVecReduce* instruction) {
@@ -240,8 +267,15 @@ void InstructionCodeGeneratorX86_64::VisitVecReduce(HVecReduce* instruction) {
           __ paddq(dst, tmp);
           break;
         case HVecReduce::kMin:
-        case HVecReduce::kMax:
-          LOG(FATAL) << "Unsupported SIMD type";
+        case HVecReduce::kMax: {
+          XmmRegister mask = locations->GetTemp(1).AsFpuRegister<XmmRegister>();
+          __ movaps(tmp, src);
+          __ movaps(dst, src);
+          __ punpckhqdq(tmp, tmp);
+          GenerateVecLongMinMax(
+              GetAssembler(), dst, tmp, mask, instruction->GetKind() == HVecReduce::kMin);
+          break;
+        }
       }
       break;
     }
@@ -599,6 +633,10 @@ void InstructionCodeGeneratorX86_64::VisitVecDiv(HVecDiv* instruction) {
 
 void LocationsBuilderX86_64::VisitVecMin(HVecMin* instruction) {
   CreateVecBinOpLocations(GetGraph()->GetAllocator(), instruction);
+  // Long min requires a temporary for the compare mask.
+  if (instruction->GetPackedType() == DataType::Type::kInt64) {
+    instruction->GetLocations()->AddTemp(Location::RequiresFpuRegister());
+  }
 }
 
 void InstructionCodeGeneratorX86_64::VisitVecMin(HVecMin* instruction) {
@@ -631,6 +669,13 @@ void InstructionCodeGeneratorX86_64::VisitVecMin(HVecMin* instruction) {
         __ pminsd(dst, src);
       }
       break;
+    case DataType::Type::kInt64: {
+      DCHECK_EQ(2u, instruction->GetVectorLength());
+      DCHECK(!instruction->IsUnsigned());
+      XmmRegister mask = locations->GetTemp(0).AsFpuRegister<XmmRegister>();
+      GenerateVecLongMinMax(GetAssembler(), dst, src, mask, /* is_min */ true);
+      break;
+    }
     // Next cases are sloppy wrt 0.0 vs -0.0.
     case DataType::Type::kFloat32:
       DCHECK_EQ(4u, instruction->GetVectorLength());
@@ -650,6 +695,10 @@ void InstructionCodeGeneratorX86_64::VisitVecMin(HVecMin* instruction) {
 
 void LocationsBuilderX86_64::VisitVecMax(HVecMax* instruction) {
   CreateVecBinOpLocations(GetGraph()->GetAllocator(), instruction);
+  // Long max requires a temporary for the compare mask.
+  if (instruction->GetPackedType() == DataType::Type::kInt64) {
+    instruction->GetLocations()->AddTemp(Location::RequiresFpuRegister());
+  }
 }
 
 void InstructionCodeGeneratorX86_64::VisitVecMax(HVecMax* instruction) {
@@ -682,6 +731,13 @@ void InstructionCodeGeneratorX86_64::VisitVecMax(HVecMax* instruction) {
         __ pmaxsd(dst, src);
       }
       break;
+    case DataType::Type::kInt64: {
+      DCHECK_EQ(2u, instruction->GetVectorLength());
+      DCHECK(!instruction->IsUnsigned());
+      XmmRegister mask = locations->GetTemp(0).AsFpuRegister<XmmRegister>();
+      GenerateVecLongMinMax(GetAssembler(), dst, src, mask, /* is_min */ false);
+      break;
+    }
     // Next cases are sloppy wrt 0.0 vs -0.0.
     case DataType::Type::kFloat32:
       DCHECK_EQ(4u, instruction->GetVectorLength());
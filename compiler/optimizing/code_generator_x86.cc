@@ -1353,7 +1353,10 @@ void InstructionCodeGeneratorX86::HandleGoto(HInstruction* got, HBasicBlock* suc
   HInstruction* previous = got->GetPrevious();
 
   HLoopInformation* info = block->GetLoopInformation();
-  if (info != nullptr && info->IsBackEdge(*block) && info->HasSuspendCheck()) {
+  if (info != nullptr &&
+      info->IsBackEdge(*block) &&
+      info->HasSuspendCheck() &&
+      !info->GetSuspendCheck()->IsNoOp()) {
     GenerateSuspendCheck(info->GetSuspendCheck(), successor);
     return;
   }
@@ -5039,6 +5042,17 @@ void InstructionCodeGeneratorX86::VisitStaticFieldSet(HStaticFieldSet* instructi
   HandleFieldSet(instruction, instruction->GetFieldInfo(), instruction->GetValueCanBeNull());
 }
 
+// The instruction simplifier only creates HStringBuilderAppend on arm64 and x86_64.
+void LocationsBuilderX86::VisitStringBuilderAppend(
+    HStringBuilderAppend* instruction ATTRIBUTE_UNUSED) {
+  LOG(FATAL) << "Unreachable";
+}
+
+void InstructionCodeGeneratorX86::VisitStringBuilderAppend(
+    HStringBuilderAppend* instruction ATTRIBUTE_UNUSED) {
+  LOG(FATAL) << "Unreachable";
+}
+
 void LocationsBuilderX86::VisitInstanceFieldSet(HInstanceFieldSet* instruction) {
   HandleFieldSet(instruction, instruction->GetFieldInfo());
 }
@@ -6399,6 +6413,25 @@ static size_t NumberOfCheckCastTemps(TypeCheckKind type_check_kind) {
   return 1 + NumberOfInstanceOfTemps(type_check_kind);
 }
 
+void InstructionCodeGeneratorX86::GenerateBitstringTypeCheckCompare(HInstruction* check,
+                                                                    Register temp) {
+  uint32_t path_to_root = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringPathToRoot()
+      : check->AsCheckCast()->GetBitstringPathToRoot();
+  uint32_t mask = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringMask()
+      : check->AsCheckCast()->GetBitstringMask();
+  // The bitstring is in the most significant bits of the status field, after the class status.
+  DCHECK(mask == 0u || IsPowerOfTwo(~mask + 1u)) << std::hex << mask;
+  DCHECK_EQ(path_to_root & ~mask, 0u);
+
+  // /* uint32_t */ temp = temp->status_
+  __ movl(temp, Address(temp, mirror::Class::StatusOffset().Int32Value()));
+  // Keep the bits of the bitstring of the target, and compare them.
+  __ andl(temp, Immediate(static_cast<int32_t>(mask)));
+  __ cmpl(temp, Immediate(static_cast<int32_t>(path_to_root)));
+}
+
 void LocationsBuilderX86::VisitInstanceOf(HInstanceOf* instruction) {
   LocationSummary::CallKind call_kind = LocationSummary::kNoCall;
   TypeCheckKind type_check_kind = instruction->GetTypeCheckKind();
@@ -6418,6 +6451,8 @@ void LocationsBuilderX86::VisitInstanceOf(HInstanceOf* instruction) {
     case TypeCheckKind::kInterfaceCheck:
       call_kind = LocationSummary::kCallOnSlowPath;
       break;
+    case TypeCheckKind::kBitstringCheck:
+      break;
   }
 
   LocationSummary* locations =
@@ -6617,6 +6652,20 @@ void InstructionCodeGeneratorX86::VisitInstanceOf(HInstanceOf* instruction) {
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ out = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        out_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, out);
+      __ j(kNotEqual, &zero);
+      __ movl(out, Immediate(1));
+      __ jmp(&done);
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck:
     case TypeCheckKind::kInterfaceCheck: {
       // Note that we indeed only call on slow path, but we always go
@@ -6843,6 +6892,18 @@ void InstructionCodeGeneratorX86::VisitCheckCast(HCheckCast* instruction) {
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ temp = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        temp_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, temp);
+      __ j(kNotEqual, type_check_slow_path->GetEntryLabel());
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck:
       // We always go into the type check slow path for the unresolved check case.
       // We cannot directly call the CheckCast runtime entry point
@@ -245,6 +245,11 @@ class InstructionCodeGeneratorX86 : public InstructionCodeGenerator {
                                         uint32_t offset,
                                         Location maybe_temp,
                                         ReadBarrierOption read_barrier_option);
+  // Compare the subtype check bits of the class in `temp` with the bitstring of the
+  // target class of `check`, setting the flags for a kEqual or kNotEqual jump.
+  // Clobbers `temp`.
+  void GenerateBitstringTypeCheckCompare(HInstruction* check, Register temp);
+
   // Generate a heap reference load using two different registers
   // `out` and `obj`:
   //
@@ -25,6 +25,7 @@
 #include "heap_poisoning.h"
 #include "intrinsics.h"
 #include "intrinsics_x86_64.h"
+#include "jit/profiling_info.h"
 #include "linker/linker_patch.h"
 #include "lock_word.h"
 #include "mirror/array-inl.h"
@@ -176,6 +177,28 @@ class SuspendCheckSlowPathX86_64 : public SlowPathCode {
   DISALLOW_COPY_AND_ASSIGN(SuspendCheckSlowPathX86_64);
 };
 
+class CompileOptimizedSlowPathX86_64 : public SlowPathCode {
+ public:
+  CompileOptimizedSlowPathX86_64() : SlowPathCode(/* instruction */ nullptr) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    __ Bind(GetEntryLabel());
+    // Note: we don't record the call here (and therefore don't generate a stack
+    // map), as the entrypoint saves all registers and never suspends.
+    __ gs()->call(Address::Absolute(
+        GetThreadOffset<kX86_64PointerSize>(kQuickCompileOptimized), /* no_rip */ true));
+    CheckEntrypointTypes<kQuickCompileOptimized, void, ArtMethod*, Thread*>();
+    __ jmp(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE {
+    return "CompileOptimizedSlowPathX86_64";
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileOptimizedSlowPathX86_64);
+};
+
 class BoundsCheckSlowPathX86_64 : public SlowPathCode {
  public:
   explicit BoundsCheckSlowPathX86_64(HBoundsCheck* instruction)
@@ -451,6 +474,54 @@ class ArraySetSlowPathX86_64 : public SlowPathCode {
   DISALLOW_COPY_AND_ASSIGN(ArraySetSlowPathX86_64);
 };
 
+// Calls the allocation entrypoint of an HNewInstance or HNewArray whose object doesn't fit in
+// the thread-local allocation buffer.
+class AllocationSlowPathX86_64 : public SlowPathCode {
+ public:
+  AllocationSlowPathX86_64(HInstruction* instruction, QuickEntrypointEnum entrypoint)
+      : SlowPathCode(instruction), entrypoint_(entrypoint) {
+    DCHECK(instruction->IsNewInstance() || instruction->IsNewArray());
+  }
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    Location out = locations->Out();
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(out.reg()));
+    CodeGeneratorX86_64* x86_64_codegen = down_cast<CodeGeneratorX86_64*>(codegen);
+
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    InvokeRuntimeCallingConvention calling_convention;
+    HParallelMove parallel_move(codegen->GetGraph()->GetAllocator());
+    parallel_move.AddMove(
+        locations->InAt(0),
+        Location::RegisterLocation(calling_convention.GetRegisterAt(0)),
+        DataType::Type::kReference,
+        nullptr);
+    if (instruction_->IsNewArray()) {
+      parallel_move.AddMove(
+          locations->InAt(1),
+          Location::RegisterLocation(calling_convention.GetRegisterAt(1)),
+          DataType::Type::kInt32,
+          nullptr);
+    }
+    codegen->GetMoveResolver()->EmitNativeCode(&parallel_move);
+    x86_64_codegen->InvokeRuntime(entrypoint_, instruction_, instruction_->GetDexPc(), this);
+    x86_64_codegen->Move(out, Location::RegisterLocation(RAX));
+
+    RestoreLiveRegisters(codegen, locations);
+    __ jmp(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE { return "AllocationSlowPathX86_64"; }
+
+ private:
+  const QuickEntrypointEnum entrypoint_;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSlowPathX86_64);
+};
+
 // Slow path marking an object reference `ref` during a read
 // barrier. The field `obj.field` in the object `obj` holding this
 // reference does not get updated by this slow path after marking (see
@@ -1313,6 +1384,26 @@ void CodeGeneratorX86_64::GenerateFrameEntry() {
     // Initialize should_deoptimize flag to 0.
     __ movl(Address(CpuRegister(RSP), GetStackOffsetOfShouldDeoptimizeFlag()), Immediate(0));
   }
+
+  MaybeIncrementHotness();
+}
+
+void CodeGeneratorX86_64::MaybeIncrementHotness() {
+  if (!GetGraph()->IsCompilingBaseline()) {
+    return;
+  }
+  // InitializeCodeGeneration() made the method non-leaf so that the entrypoint finds
+  // the current method at the bottom of the frame.
+  DCHECK(RequiresCurrentMethod());
+  DCHECK(!HasEmptyFrame());
+  uint64_t address = reinterpret_cast64<uint64_t>(GetBaselineProfilingInfo());
+  int32_t counter_offset = ProfilingInfo::BaselineHotnessCountOffset().Int32Value();
+  SlowPathCode* slow_path = new (GetScopedAllocator()) CompileOptimizedSlowPathX86_64();
+  AddSlowPath(slow_path);
+  __ movq(CpuRegister(TMP), Immediate(address));
+  __ addw(Address(CpuRegister(TMP), counter_offset), Immediate(1));
+  __ j(kZero, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
 }
 
 void CodeGeneratorX86_64::GenerateFrameExit() {
@@ -1455,7 +1546,12 @@ void InstructionCodeGeneratorX86_64::HandleGoto(HInstruction* got, HBasicBlock*
   HInstruction* previous = got->GetPrevious();
 
   HLoopInformation* info = block->GetLoopInformation();
-  if (info != nullptr && info->IsBackEdge(*block) && info->HasSuspendCheck()) {
+  if (info != nullptr &&
+      info->IsBackEdge(*block) &&
+      info->HasSuspendCheck() &&
+      !info->GetSuspendCheck()->IsNoOp()) {
+    // Long running loops in baseline code also get the method optimized.
+    codegen_->MaybeIncrementHotness();
     GenerateSuspendCheck(info->GetSuspendCheck(), successor);
     return;
   }
@@ -1644,7 +1740,10 @@ void InstructionCodeGeneratorX86_64::GenerateTestAndBranch(HInstruction* instruc
   //        - condition true => branch to true_target
   //        - branch to false_target
   if (IsBooleanValueOrMaterializedCondition(cond)) {
-    if (AreEflagsSetFrom(cond, instruction)) {
+    // The branch profile of baseline code clobbers the eflags.
+    bool eflags_set = AreEflagsSetFrom(cond, instruction) &&
+        !(instruction->IsIf() && codegen_->GetBaselineBranchCache(instruction->AsIf()) != nullptr);
+    if (eflags_set) {
       if (true_target == nullptr) {
         __ j(X86_64IntegerCondition(cond->AsCondition()->GetOppositeCondition()), false_target);
       } else {
@@ -1697,11 +1796,51 @@ void InstructionCodeGeneratorX86_64::GenerateTestAndBranch(HInstruction* instruc
 void LocationsBuilderX86_64::VisitIf(HIf* if_instr) {
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(if_instr);
   if (IsBooleanValueOrMaterializedCondition(if_instr->InputAt(0))) {
-    locations->SetInAt(0, Location::Any());
+    // Baseline code indexes the branch counters with the condition.
+    locations->SetInAt(0, codegen_->GetBaselineBranchCache(if_instr) != nullptr
+                              ? Location::RegisterOrConstant(if_instr->InputAt(0))
+                              : Location::Any());
+  }
+}
+
+void InstructionCodeGeneratorX86_64::GenerateBranchProfile(HIf* if_instr) {
+  BranchCache* cache = codegen_->GetBaselineBranchCache(if_instr);
+  if (cache == nullptr) {
+    return;
+  }
+  HInstruction* cond = if_instr->InputAt(0);
+  DCHECK(IsBooleanValueOrMaterializedCondition(cond));
+  // The taken count follows the not taken count.
+  uint64_t not_taken_address =
+      reinterpret_cast64<uint64_t>(cache) + BranchCache::NotTakenCountOffset().Uint32Value();
+  bool taken_on_true = if_instr->IsTrueSuccessorBranchTarget();
+  Address counter = Address(CpuRegister(TMP), 0);
+  CpuRegister cond_reg(kNoRegister);
+  if (cond->IsIntConstant()) {
+    bool taken = cond->AsIntConstant()->IsTrue() == taken_on_true;
+    __ movq(CpuRegister(TMP), Immediate(not_taken_address + (taken ? sizeof(uint16_t) : 0u)));
+  } else {
+    cond_reg = if_instr->GetLocations()->InAt(0).AsRegister<CpuRegister>();
+    if (!taken_on_true) {
+      // Restored below, GenerateTestAndBranch() tests the register again.
+      __ xorl(cond_reg, Immediate(1));
+    }
+    __ movq(CpuRegister(TMP), Immediate(not_taken_address));
+    counter = Address(CpuRegister(TMP), cond_reg, TIMES_2, 0);
+  }
+  // Saturate the counter, the compiler only needs the ratio of the two counts.
+  NearLabel done;
+  __ cmpw(counter, Immediate(-1));
+  __ j(kEqual, &done);
+  __ addw(counter, Immediate(1));
+  __ Bind(&done);
+  if (!cond->IsIntConstant() && !taken_on_true) {
+    __ xorl(cond_reg, Immediate(1));
   }
 }
 
 void InstructionCodeGeneratorX86_64::VisitIf(HIf* if_instr) {
+  GenerateBranchProfile(if_instr);
   HBasicBlock* true_successor = if_instr->IfTrueSuccessor();
   HBasicBlock* false_successor = if_instr->IfFalseSuccessor();
   Label* true_target = codegen_->GoesToNextBlock(if_instr->GetBlock(), true_successor) ?
@@ -2458,10 +2597,19 @@ void InstructionCodeGeneratorX86_64::VisitInvokeInterface(HInvokeInterface* invo
 }
 
 void LocationsBuilderX86_64::VisitInvokePolymorphic(HInvokePolymorphic* invoke) {
+  IntrinsicLocationsBuilderX86_64 intrinsic(codegen_);
+  if (intrinsic.TryDispatch(invoke)) {
+    return;
+  }
+
   HandleInvoke(invoke);
 }
 
 void InstructionCodeGeneratorX86_64::VisitInvokePolymorphic(HInvokePolymorphic* invoke) {
+  if (TryGenerateIntrinsicCode(invoke, codegen_)) {
+    return;
+  }
+
   codegen_->GenerateInvokePolymorphicCall(invoke);
 }
 
@@ -4010,6 +4158,14 @@ void InstructionCodeGeneratorX86_64::VisitUShr(HUShr* ushr) {
 }
 
 void LocationsBuilderX86_64::VisitNewInstance(HNewInstance* instruction) {
+  if (CodeGenerator::CanInlineTlabAllocation(instruction)) {
+    LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
+        instruction, LocationSummary::kCallOnSlowPath);
+    locations->SetInAt(0, Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+    return;
+  }
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
       instruction, LocationSummary::kCallOnMainOnly);
   InvokeRuntimeCallingConvention calling_convention;
@@ -4031,6 +4187,10 @@ void InstructionCodeGeneratorX86_64::VisitNewInstance(HNewInstance* instruction)
     __ gs()->movq(temp, Address::Absolute(QUICK_ENTRY_POINT(pNewEmptyString), /* no_rip */ true));
     __ call(Address(temp, code_offset.SizeValue()));
     codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
+  } else if (CodeGenerator::CanInlineTlabAllocation(instruction)) {
+    GenerateTlabObjectAllocation(instruction);
+    CheckEntrypointTypes<kQuickAllocObjectWithChecks, void*, mirror::Class*>();
+    DCHECK(!codegen_->IsLeafMethod());
   } else {
     codegen_->InvokeRuntime(instruction->GetEntrypoint(), instruction, instruction->GetDexPc());
     CheckEntrypointTypes<kQuickAllocObjectWithChecks, void*, mirror::Class*>();
@@ -4038,7 +4198,46 @@ void InstructionCodeGeneratorX86_64::VisitNewInstance(HNewInstance* instruction)
   }
 }
 
+// Same as ALLOC_OBJECT_INITIALIZED_TLAB_FAST_PATH in quick_entrypoints_x86_64.S.
+void InstructionCodeGeneratorX86_64::GenerateTlabObjectAllocation(HNewInstance* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+  CpuRegister cls = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister new_pos = locations->GetTemp(0).AsRegister<CpuRegister>();
+  SlowPathCode* slow_path = new (codegen_->GetScopedAllocator())
+      AllocationSlowPathX86_64(instruction, instruction->GetEntrypoint());
+  codegen_->AddSlowPath(slow_path);
+  const int32_t pos_offset = Thread::ThreadLocalPosOffset<kX86_64PointerSize>().Int32Value();
+  const int32_t end_offset = Thread::ThreadLocalEndOffset<kX86_64PointerSize>().Int32Value();
+  const int32_t objects_offset =
+      Thread::ThreadLocalObjectsOffset<kX86_64PointerSize>().Int32Value();
+
+  // The size is too large to fit if the class is not initialized or is finalizable, see
+  // InitializeClassVisitors in class-inl.h.
+  __ movl(new_pos, Address(cls, mirror::Class::ObjectSizeAllocFastPathOffset().Int32Value()));
+  __ gs()->movq(out, Address::Absolute(pos_offset, /* no_rip */ true));
+  __ addq(new_pos, out);
+  __ gs()->cmpq(new_pos, Address::Absolute(end_offset, /* no_rip */ true));
+  __ j(kAbove, slow_path->GetEntryLabel());
+  __ gs()->movq(Address::Absolute(pos_offset, /* no_rip */ true), new_pos);
+  __ gs()->movq(new_pos, Address::Absolute(objects_offset, /* no_rip */ true));
+  __ addq(new_pos, Immediate(1));
+  __ gs()->movq(Address::Absolute(objects_offset, /* no_rip */ true), new_pos);
+  // No fence needed for x86.
+  __ movl(Address(out, mirror::Object::ClassOffset().Int32Value()), cls);
+  __ Bind(slow_path->GetExitLabel());
+}
+
 void LocationsBuilderX86_64::VisitNewArray(HNewArray* instruction) {
+  if (CodeGenerator::CanInlineTlabAllocation(instruction)) {
+    LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
+        instruction, LocationSummary::kCallOnSlowPath);
+    locations->SetInAt(0, Location::RequiresRegister());
+    locations->SetInAt(1, Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+    return;
+  }
   LocationSummary* locations = new (GetGraph()->GetAllocator()) LocationSummary(
       instruction, LocationSummary::kCallOnMainOnly);
   InvokeRuntimeCallingConvention calling_convention;
@@ -4052,11 +4251,55 @@ void InstructionCodeGeneratorX86_64::VisitNewArray(HNewArray* instruction) {
   // of poisoning the reference.
   QuickEntrypointEnum entrypoint =
       CodeGenerator::GetArrayAllocationEntrypoint(instruction->GetLoadClass()->GetClass());
-  codegen_->InvokeRuntime(entrypoint, instruction, instruction->GetDexPc());
+  if (CodeGenerator::CanInlineTlabAllocation(instruction)) {
+    GenerateTlabArrayAllocation(instruction, entrypoint);
+  } else {
+    codegen_->InvokeRuntime(entrypoint, instruction, instruction->GetDexPc());
+  }
   CheckEntrypointTypes<kQuickAllocArrayResolved, void*, mirror::Class*, int32_t>();
   DCHECK(!codegen_->IsLeafMethod());
 }
 
+// Same as ALLOC_ARRAY_TLAB_FAST_PATH_RESOLVED_WITH_SIZE in quick_entrypoints_x86_64.S.
+void InstructionCodeGeneratorX86_64::GenerateTlabArrayAllocation(HNewArray* instruction,
+                                                                  QuickEntrypointEnum entrypoint) {
+  LocationSummary* locations = instruction->GetLocations();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+  CpuRegister cls = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister length = locations->InAt(1).AsRegister<CpuRegister>();
+  CpuRegister new_pos = locations->GetTemp(0).AsRegister<CpuRegister>();
+  const size_t shift = CodeGenerator::GetArrayAllocationComponentSizeShift(entrypoint);
+  const int32_t data_offset = mirror::Array::DataOffset(1u << shift).Int32Value();
+  SlowPathCode* slow_path = new (codegen_->GetScopedAllocator())
+      AllocationSlowPathX86_64(instruction, entrypoint);
+  codegen_->AddSlowPath(slow_path);
+  const int32_t pos_offset = Thread::ThreadLocalPosOffset<kX86_64PointerSize>().Int32Value();
+  const int32_t end_offset = Thread::ThreadLocalEndOffset<kX86_64PointerSize>().Int32Value();
+  const int32_t objects_offset =
+      Thread::ThreadLocalObjectsOffset<kX86_64PointerSize>().Int32Value();
+
+  // Negative lengths are large unsigned values and take the slow path too.
+  __ cmpl(length, Immediate(CodeGenerator::GetMaxTlabArrayLength(shift)));
+  __ j(kAbove, slow_path->GetEntryLabel());
+  __ movl(new_pos, length);  // Zero extends the length.
+  __ leaq(new_pos, Address(new_pos,
+                           static_cast<ScaleFactor>(shift),
+                           data_offset + static_cast<int32_t>(kObjectAlignment) - 1));
+  __ andq(new_pos, Immediate(-static_cast<int32_t>(kObjectAlignment)));
+  __ gs()->movq(out, Address::Absolute(pos_offset, /* no_rip */ true));
+  __ addq(new_pos, out);
+  __ gs()->cmpq(new_pos, Address::Absolute(end_offset, /* no_rip */ true));
+  __ j(kAbove, slow_path->GetEntryLabel());
+  __ gs()->movq(Address::Absolute(pos_offset, /* no_rip */ true), new_pos);
+  __ gs()->movq(new_pos, Address::Absolute(objects_offset, /* no_rip */ true));
+  __ addq(new_pos, Immediate(1));
+  __ gs()->movq(Address::Absolute(objects_offset, /* no_rip */ true), new_pos);
+  // The buffer is zeroed, only the class and the length need to be stored.
+  __ movl(Address(out, mirror::Object::ClassOffset().Int32Value()), cls);
+  __ movl(Address(out, mirror::Array::LengthOffset().Int32Value()), length);
+  __ Bind(slow_path->GetExitLabel());
+}
+
 void LocationsBuilderX86_64::VisitParameterValue(HParameterValue* instruction) {
   LocationSummary* locations =
       new (GetGraph()->GetAllocator()) LocationSummary(instruction, LocationSummary::kNoCall);
@@ -4192,7 +4435,9 @@ void LocationsBuilderX86_64::HandleFieldGet(HInstruction* instruction) {
   DCHECK(instruction->IsInstanceFieldGet() || instruction->IsStaticFieldGet());
 
   bool object_field_get_with_read_barrier =
-      kEmitCompilerReadBarrier && (instruction->GetType() == DataType::Type::kReference);
+      kEmitCompilerReadBarrier &&
+      (instruction->GetType() == DataType::Type::kReference) &&
+      !CodeGenerator::IsReadBarrierElided(instruction);
   LocationSummary* locations =
       new (GetGraph()->GetAllocator()) LocationSummary(instruction,
                                                        object_field_get_with_read_barrier
@@ -4256,7 +4501,8 @@ void InstructionCodeGeneratorX86_64::HandleFieldGet(HInstruction* instruction,
 
     case DataType::Type::kReference: {
       // /* HeapReference<Object> */ out = *(base + offset)
-      if (kEmitCompilerReadBarrier && kUseBakerReadBarrier) {
+      if (kEmitCompilerReadBarrier && kUseBakerReadBarrier &&
+          !CodeGenerator::IsReadBarrierElided(instruction)) {
         // Note that a potential implicit null check is handled in this
         // CodeGeneratorX86_64::GenerateFieldLoadWithBakerReadBarrier call.
         codegen_->GenerateFieldLoadWithBakerReadBarrier(
@@ -4270,10 +4516,14 @@ void InstructionCodeGeneratorX86_64::HandleFieldGet(HInstruction* instruction,
         if (is_volatile) {
           codegen_->GenerateMemoryBarrier(MemBarrierKind::kLoadAny);
         }
-        // If read barriers are enabled, emit read barriers other than
-        // Baker's using a slow path (and also unpoison the loaded
-        // reference, if heap poisoning is enabled).
-        codegen_->MaybeGenerateReadBarrierSlow(instruction, out, out, base_loc, offset);
+        if (CodeGenerator::IsReadBarrierElided(instruction)) {
+          __ MaybeUnpoisonHeapReference(out.AsRegister<CpuRegister>());
+        } else {
+          // If read barriers are enabled, emit read barriers other than
+          // Baker's using a slow path (and also unpoison the loaded
+          // reference, if heap poisoning is enabled).
+          codegen_->MaybeGenerateReadBarrierSlow(instruction, out, out, base_loc, offset);
+        }
       }
       break;
     }
@@ -4508,6 +4758,16 @@ void InstructionCodeGeneratorX86_64::VisitStaticFieldSet(HStaticFieldSet* instru
   HandleFieldSet(instruction, instruction->GetFieldInfo(), instruction->GetValueCanBeNull());
 }
 
+void LocationsBuilderX86_64::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  codegen_->CreateStringBuilderAppendLocations(instruction, Location::RegisterLocation(RAX));
+}
+
+void InstructionCodeGeneratorX86_64::VisitStringBuilderAppend(HStringBuilderAppend* instruction) {
+  __ movl(CpuRegister(RDI), Immediate(instruction->GetFormat()->GetValue()));
+  codegen_->InvokeRuntime(kQuickStringBuilderAppend, instruction, instruction->GetDexPc());
+  CheckEntrypointTypes<kQuickStringBuilderAppend, void*, uint32_t>();
+}
+
 void LocationsBuilderX86_64::VisitUnresolvedInstanceFieldGet(
     HUnresolvedInstanceFieldGet* instruction) {
   FieldAccessCallingConventionX86_64 calling_convention;
@@ -4621,7 +4881,9 @@ void InstructionCodeGeneratorX86_64::VisitNullCheck(HNullCheck* instruction) {
 
 void LocationsBuilderX86_64::VisitArrayGet(HArrayGet* instruction) {
   bool object_array_get_with_read_barrier =
-      kEmitCompilerReadBarrier && (instruction->GetType() == DataType::Type::kReference);
+      kEmitCompilerReadBarrier &&
+      (instruction->GetType() == DataType::Type::kReference) &&
+      !instruction->IsReadBarrierElided();
   LocationSummary* locations =
       new (GetGraph()->GetAllocator()) LocationSummary(instruction,
                                                        object_array_get_with_read_barrier
@@ -4707,7 +4969,7 @@ void InstructionCodeGeneratorX86_64::VisitArrayGet(HArrayGet* instruction) {
           "art::mirror::HeapReference<art::mirror::Object> and int32_t have different sizes.");
       // /* HeapReference<Object> */ out =
       //     *(obj + data_offset + index * sizeof(HeapReference<Object>))
-      if (kEmitCompilerReadBarrier && kUseBakerReadBarrier) {
+      if (kEmitCompilerReadBarrier && kUseBakerReadBarrier && !instruction->IsReadBarrierElided()) {
         // Note that a potential implicit null check is handled in this
         // CodeGeneratorX86_64::GenerateArrayLoadWithBakerReadBarrier call.
         codegen_->GenerateArrayLoadWithBakerReadBarrier(
@@ -4719,7 +4981,9 @@ void InstructionCodeGeneratorX86_64::VisitArrayGet(HArrayGet* instruction) {
         // If read barriers are enabled, emit read barriers other than
         // Baker's using a slow path (and also unpoison the loaded
         // reference, if heap poisoning is enabled).
-        if (index.IsConstant()) {
+        if (instruction->IsReadBarrierElided()) {
+          __ MaybeUnpoisonHeapReference(out);
+        } else if (index.IsConstant()) {
           uint32_t offset =
               (index.GetConstant()->AsIntConstant()->GetValue() << TIMES_4) + data_offset;
           codegen_->MaybeGenerateReadBarrierSlow(instruction, out_loc, out_loc, obj_loc, offset);
@@ -5785,6 +6049,25 @@ static bool InstanceOfTypeCheckNeedsATemporary(TypeCheckKind type_check_kind) {
        type_check_kind == TypeCheckKind::kArrayObjectCheck);
 }
 
+void InstructionCodeGeneratorX86_64::GenerateBitstringTypeCheckCompare(HInstruction* check,
+                                                                       CpuRegister temp) {
+  uint32_t path_to_root = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringPathToRoot()
+      : check->AsCheckCast()->GetBitstringPathToRoot();
+  uint32_t mask = check->IsInstanceOf()
+      ? check->AsInstanceOf()->GetBitstringMask()
+      : check->AsCheckCast()->GetBitstringMask();
+  // The bitstring is in the most significant bits of the status field, after the class status.
+  DCHECK(mask == 0u || IsPowerOfTwo(~mask + 1u)) << std::hex << mask;
+  DCHECK_EQ(path_to_root & ~mask, 0u);
+
+  // /* uint32_t */ temp = temp->status_
+  __ movl(temp, Address(temp, mirror::Class::StatusOffset().Int32Value()));
+  // Keep the bits of the bitstring of the target, and compare them.
+  __ andl(temp, Immediate(static_cast<int32_t>(mask)));
+  __ cmpl(temp, Immediate(static_cast<int32_t>(path_to_root)));
+}
+
 void LocationsBuilderX86_64::VisitInstanceOf(HInstanceOf* instruction) {
   LocationSummary::CallKind call_kind = LocationSummary::kNoCall;
   TypeCheckKind type_check_kind = instruction->GetTypeCheckKind();
@@ -5804,6 +6087,8 @@ void LocationsBuilderX86_64::VisitInstanceOf(HInstanceOf* instruction) {
     case TypeCheckKind::kInterfaceCheck:
       call_kind = LocationSummary::kCallOnSlowPath;
       break;
+    case TypeCheckKind::kBitstringCheck:
+      break;
   }
 
   LocationSummary* locations =
@@ -6011,6 +6296,26 @@ void InstructionCodeGeneratorX86_64::VisitInstanceOf(HInstanceOf* instruction) {
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ out = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        out_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, out);
+      if (zero.IsLinked()) {
+        __ j(kNotEqual, &zero);
+        __ movl(out, Immediate(1));
+        __ jmp(&done);
+      } else {
+        __ setcc(kEqual, out);
+        // setcc only sets the low byte.
+        __ andl(out, Immediate(1));
+      }
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck:
     case TypeCheckKind::kInterfaceCheck: {
       // Note that we indeed only call on slow path, but we always go
@@ -6239,6 +6544,18 @@ void InstructionCodeGeneratorX86_64::VisitCheckCast(HCheckCast* instruction) {
       break;
     }
 
+    case TypeCheckKind::kBitstringCheck: {
+      // /* HeapReference<Class> */ temp = obj->klass_
+      GenerateReferenceLoadTwoRegisters(instruction,
+                                        temp_loc,
+                                        obj_loc,
+                                        class_offset,
+                                        kWithoutReadBarrier);
+      GenerateBitstringTypeCheckCompare(instruction, temp);
+      __ j(kNotEqual, type_check_slow_path->GetEntryLabel());
+      break;
+    }
+
     case TypeCheckKind::kUnresolvedCheck: {
       // We always go into the type check slow path for the unresolved case.
       //
@@ -208,6 +208,9 @@ class InstructionCodeGeneratorX86_64 : public InstructionCodeGenerator {
   // the suspend call.
   void GenerateSuspendCheck(HSuspendCheck* instruction, HBasicBlock* successor);
   void GenerateClassInitializationCheck(SlowPathCode* slow_path, CpuRegister class_reg);
+  // Bump the thread-local allocation buffer, see CodeGenerator::CanInlineTlabAllocation().
+  void GenerateTlabObjectAllocation(HNewInstance* instruction);
+  void GenerateTlabArrayAllocation(HNewArray* instruction, QuickEntrypointEnum entrypoint);
   void HandleBitwiseOperation(HBinaryOperation* operation);
   void GenerateRemFP(HRem* rem);
   void DivRemOneOrMinusOne(HBinaryOperation* instruction);
@@ -236,6 +239,11 @@ class InstructionCodeGeneratorX86_64 : public InstructionCodeGenerator {
                                         uint32_t offset,
                                         Location maybe_temp,
                                         ReadBarrierOption read_barrier_option);
+  // Compare the subtype check bits of the class in `temp` with the bitstring of the
+  // target class of `check`, setting the flags for a kEqual or kNotEqual jump.
+  // Clobbers `temp`.
+  void GenerateBitstringTypeCheckCompare(HInstruction* check, CpuRegister temp);
+
   // Generate a heap reference load using two different registers
   // `out` and `obj`:
   //
@@ -265,6 +273,8 @@ class InstructionCodeGeneratorX86_64 : public InstructionCodeGenerator {
   void PushOntoFPStack(Location source, uint32_t temp_offset,
                        uint32_t stack_adjustment, bool is_float);
   void GenerateCompareTest(HCondition* condition);
+  // Counts the outcome of the branch in baseline code.
+  void GenerateBranchProfile(HIf* if_instr);
   template<class LabelType>
   void GenerateTestAndBranch(HInstruction* instruction,
                              size_t condition_input_index,
@@ -298,6 +308,11 @@ class CodeGeneratorX86_64 : public CodeGenerator {
 
   void GenerateFrameEntry() OVERRIDE;
   void GenerateFrameExit() OVERRIDE;
+
+  // Count the invocations and loop iterations of baseline code and request the optimized
+  // compilation when the counter wraps around.
+  void MaybeIncrementHotness();
+
   void Bind(HBasicBlock* block) OVERRIDE;
   void MoveConstant(Location destination, int32_t value) OVERRIDE;
   void MoveLocation(Location dst, Location src, DataType::Type dst_type) OVERRIDE;
@@ -35,12 +35,32 @@ class CFREVisitor : public HGraphVisitor {
         stats_(stats) {}
 
   void VisitBasicBlock(HBasicBlock* block) OVERRIDE {
+    // The fences left over from the previous block are only kept as candidates
+    // if this block continues it, see CanCarryFencesInto().
+    if (carried_from_ != nullptr &&
+        (block->GetPredecessors().size() != 1u || block->GetPredecessors()[0] != carried_from_)) {
+      MergeCandidateFences();
+    }
+    carried_from_ = nullptr;
+
     // Visit all instructions in block.
     HGraphVisitor::VisitBasicBlock(block);
 
-    // If there were any unmerged fences left, merge them together,
-    // the objects are considered 'published' at the end of the block.
+    if (CanCarryFencesInto(block)) {
+      // The fences of inlined constructors are often split from the next ones
+      // by the blocks of the inlined bodies, keep merging them in the successor.
+      carried_from_ = block;
+    } else {
+      // If there were any unmerged fences left, merge them together,
+      // the objects are considered 'published' at the end of the block.
+      MergeCandidateFences();
+    }
+  }
+
+  // Merges the fences left over by the last visited block.
+  void Finish() {
     MergeCandidateFences();
+    carried_from_ = nullptr;
   }
 
   void VisitConstructorFence(HConstructorFence* constructor_fence) OVERRIDE {
@@ -83,6 +103,20 @@ class CFREVisitor : public HGraphVisitor {
     MergeCandidateFences();
   }
 
+  void VisitMemoryBarrier(HMemoryBarrier* barrier) OVERRIDE {
+    switch (barrier->GetBarrierKind()) {
+      case MemBarrierKind::kAnyStore:
+      case MemBarrierKind::kStoreStore:
+      case MemBarrierKind::kAnyAny:
+        // The barrier orders the stores of the constructors before any
+        // later publishing store, the candidate fences are redundant.
+        RemoveCandidateFences();
+        break;
+      default:
+        break;
+    }
+  }
+
   void VisitInvokeStaticOrDirect(HInvokeStaticOrDirect* invoke) OVERRIDE {
     HandleInvoke(invoke);
   }
@@ -211,6 +245,29 @@ class CFREVisitor : public HGraphVisitor {
     candidate_fence_targets_.Clear();
   }
 
+  // Whether the candidate fences at the end of `block` can stay candidates in its
+  // successor: the successor must always run right after `block` and nothing else
+  // may flow into it. Try blocks are excluded, as a catch handler may see the objects.
+  bool CanCarryFencesInto(HBasicBlock* block) const {
+    if (block->GetSuccessors().size() != 1u || block->IsTryBlock()) {
+      return false;
+    }
+    HBasicBlock* successor = block->GetSuccessors()[0];
+    return successor->GetPredecessors().size() == 1u &&
+        !successor->IsExitBlock() &&
+        !successor->IsTryBlock();
+  }
+
+  // Removes all the candidate fences, when a later barrier already provides their ordering.
+  void RemoveCandidateFences() {
+    for (HConstructorFence* fence : candidate_fences_) {
+      fence->GetBlock()->RemoveInstruction(fence);
+      MaybeRecordStat(stats_, MethodCompilationStat::kConstructorFenceRemovedCFRE);
+    }
+    candidate_fences_.clear();
+    candidate_fence_targets_.Clear();
+  }
+
   // A publishing 'store' is only interesting if the value being stored
   // is one of the fence `targets` in `candidate_fences`.
   bool IsInterestingPublishTarget(HInstruction* store_input) const {
@@ -232,18 +289,22 @@ class CFREVisitor : public HGraphVisitor {
   // Phase-local heap memory allocator for CFRE optimizer.
   ScopedArenaAllocator scoped_allocator_;
 
-  // Set of constructor fences that we've seen in the current block.
+  // Set of constructor fences that we've seen in the current block,
+  // and in the blocks it continues.
   // Each constructor fences acts as a guard for one or more `targets`.
   // There exist no stores to any `targets` between any of these fences.
   //
   // Fences are in succession order (e.g. fence[i] succeeds fence[i-1]
-  // within the same basic block).
+  // within the same basic block or a later one).
   ScopedArenaVector<HConstructorFence*> candidate_fences_;
 
   // Stores a set of the fence targets, to allow faster lookup of whether
   // a detected publish is a target of one of the candidate fences.
   ScopedArenaHashSet<HInstruction*> candidate_fence_targets_;
 
+  // The block whose candidate fences are carried over into its successor, or null.
+  HBasicBlock* carried_from_ = nullptr;
+
   // Used to record stats about the optimization.
   OptimizingCompilerStats* const stats_;
 
@@ -253,10 +314,10 @@ class CFREVisitor : public HGraphVisitor {
 void ConstructorFenceRedundancyElimination::Run() {
   CFREVisitor cfre_visitor(graph_, stats_);
 
-  // Arbitrarily visit in reverse-post order.
-  // The exact block visit order does not matter, as the algorithm
-  // only operates on a single block at a time.
+  // Visit in reverse-post order, so that a block with a single predecessor
+  // is often visited right after it and continues its candidate fences.
   cfre_visitor.VisitReversePostOrder();
+  cfre_visitor.Finish();
 }
 
 }  // namespace art
@@ -417,6 +417,10 @@ class HGraphVisualizerPrinter : public HGraphDelegateVisitor {
   void VisitArrayGet(HArrayGet* array_get) OVERRIDE {
     StartAttributeStream("is_string_char_at") << std::boolalpha
         << array_get->IsStringCharAt() << std::noboolalpha;
+    if (array_get->GetType() == DataType::Type::kReference) {
+      StartAttributeStream("read_barrier_elided") << std::boolalpha
+          << array_get->IsReadBarrierElided() << std::noboolalpha;
+    }
   }
 
   void VisitArraySet(HArraySet* array_set) OVERRIDE {
@@ -469,6 +473,7 @@ class HGraphVisualizerPrinter : public HGraphDelegateVisitor {
   void VisitInvokePolymorphic(HInvokePolymorphic* invoke) OVERRIDE {
     VisitInvoke(invoke);
     StartAttributeStream("invoke_type") << "InvokePolymorphic";
+    StartAttributeStream("intrinsic") << invoke->GetIntrinsic();
   }
 
   void VisitInstanceFieldGet(HInstanceFieldGet* iget) OVERRIDE {
@@ -476,6 +481,10 @@ class HGraphVisualizerPrinter : public HGraphDelegateVisitor {
         iget->GetFieldInfo().GetDexFile().PrettyField(iget->GetFieldInfo().GetFieldIndex(),
                                                       /* with type */ false);
     StartAttributeStream("field_type") << iget->GetFieldType();
+    if (iget->GetType() == DataType::Type::kReference) {
+      StartAttributeStream("read_barrier_elided") << std::boolalpha
+          << iget->IsReadBarrierElided() << std::noboolalpha;
+    }
   }
 
   void VisitInstanceFieldSet(HInstanceFieldSet* iset) OVERRIDE {
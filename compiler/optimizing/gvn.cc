@@ -20,6 +20,7 @@
 #include "base/scoped_arena_allocator.h"
 #include "base/scoped_arena_containers.h"
 #include "base/bit_vector-inl.h"
+#include "load_store_analysis.h"
 #include "side_effects_analysis.h"
 #include "utils.h"
 
@@ -133,6 +134,17 @@ class ValueSet : public ArenaObject<kArenaAllocGvn> {
     });
   }
 
+  // Removes all instructions in the set affected by the given side effects, except for
+  // the ones on which 'may_be_written' returns false.
+  template<typename Functor>
+  void Kill(SideEffects side_effects, Functor may_be_written) {
+    DeleteAllImpureWhich([side_effects, &may_be_written](Node* node) {
+      HInstruction* instruction = node->GetInstruction();
+      return instruction->GetSideEffects().MayDependOn(side_effects) &&
+             may_be_written(instruction);
+    });
+  }
+
   void Clear() {
     num_entries_ = 0;
     for (size_t i = 0; i < num_buckets_; ++i) {
@@ -342,13 +354,19 @@ class ValueSet : public ArenaObject<kArenaAllocGvn> {
 class GlobalValueNumberer : public ValueObject {
  public:
   GlobalValueNumberer(HGraph* graph,
-                      const SideEffectsAnalysis& side_effects)
+                      const SideEffectsAnalysis& side_effects,
+                      const HeapLocationCollector& heap_location_collector)
       : graph_(graph),
         allocator_(graph->GetArenaStack()),
         side_effects_(side_effects),
+        heap_location_collector_(heap_location_collector),
         sets_(graph->GetBlocks().size(), nullptr, allocator_.Adapter(kArenaAllocGvn)),
         visited_blocks_(
-            &allocator_, graph->GetBlocks().size(), /* expandable */ false, kArenaAllocGvn) {
+            &allocator_, graph->GetBlocks().size(), /* expandable */ false, kArenaAllocGvn),
+        written_locations_(&allocator_,
+                           heap_location_collector.GetNumberOfHeapLocations(),
+                           /* expandable */ false,
+                           kArenaAllocGvn) {
     visited_blocks_.ClearAllBits();
   }
 
@@ -359,9 +377,25 @@ class GlobalValueNumberer : public ValueObject {
   // successor blocks.
   void VisitBasicBlock(HBasicBlock* block);
 
+  // Returns the heap location accessed by `instruction` if it is a field or array
+  // access that the heap location collector knows about, and
+  // HeapLocationCollector::kHeapLocationNotFound otherwise.
+  size_t FindHeapLocationOf(HInstruction* instruction) const;
+
+  // Returns whether `instruction` may read one of the heap locations set in `locations`.
+  bool MayReadHeapLocations(HInstruction* instruction, const BitVector& locations) const;
+
+  // Removes the instructions of `set` affected by `instruction`. A store to a known
+  // heap location only removes the loads of the heap locations that may alias it.
+  void KillFor(ValueSet* set, HInstruction* instruction);
+
+  // Removes the instructions of `set` affected by the loop whose header is `block`.
+  void KillForLoop(ValueSet* set, HBasicBlock* block);
+
   HGraph* graph_;
   ScopedArenaAllocator allocator_;
   const SideEffectsAnalysis& side_effects_;
+  const HeapLocationCollector& heap_location_collector_;
 
   ValueSet* FindSetFor(HBasicBlock* block) const {
     ValueSet* result = sets_[block->GetBlockId()];
@@ -394,6 +428,9 @@ class GlobalValueNumberer : public ValueObject {
   // visited/unvisited Boolean.
   ArenaBitVector visited_blocks_;
 
+  // Scratch set of the heap locations written by an instruction or a loop.
+  ArenaBitVector written_locations_;
+
   DISALLOW_COPY_AND_ASSIGN(GlobalValueNumberer);
 };
 
@@ -457,7 +494,7 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
         } else {
           DCHECK(!block->GetLoopInformation()->IsIrreducible());
           DCHECK_EQ(block->GetDominator(), block->GetLoopInformation()->GetPreHeader());
-          set->Kill(side_effects_.GetLoopEffects(block));
+          KillForLoop(set, block);
         }
       } else if (predecessors.size() > 1) {
         for (HBasicBlock* predecessor : predecessors) {
@@ -493,11 +530,11 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
         current->ReplaceWith(existing);
         current->GetBlock()->RemoveInstruction(current);
       } else {
-        set->Kill(current->GetSideEffects());
+        KillFor(set, current);
         set->Add(current);
       }
     } else {
-      set->Kill(current->GetSideEffects());
+      KillFor(set, current);
     }
     current = next;
   }
@@ -505,6 +542,104 @@ void GlobalValueNumberer::VisitBasicBlock(HBasicBlock* block) {
   visited_blocks_.SetBit(block->GetBlockId());
 }
 
+size_t GlobalValueNumberer::FindHeapLocationOf(HInstruction* instruction) const {
+  if (heap_location_collector_.GetNumberOfHeapLocations() == 0u) {
+    return HeapLocationCollector::kHeapLocationNotFound;
+  }
+  if (instruction->IsInstanceFieldGet()) {
+    return heap_location_collector_.GetFieldHeapLocation(
+        instruction->InputAt(0), &instruction->AsInstanceFieldGet()->GetFieldInfo());
+  } else if (instruction->IsInstanceFieldSet()) {
+    return heap_location_collector_.GetFieldHeapLocation(
+        instruction->InputAt(0), &instruction->AsInstanceFieldSet()->GetFieldInfo());
+  } else if (instruction->IsStaticFieldGet()) {
+    return heap_location_collector_.GetFieldHeapLocation(
+        instruction->InputAt(0), &instruction->AsStaticFieldGet()->GetFieldInfo());
+  } else if (instruction->IsStaticFieldSet()) {
+    return heap_location_collector_.GetFieldHeapLocation(
+        instruction->InputAt(0), &instruction->AsStaticFieldSet()->GetFieldInfo());
+  } else if (instruction->IsArrayGet() || instruction->IsArraySet()) {
+    return heap_location_collector_.GetArrayHeapLocation(instruction->InputAt(0),
+                                                         instruction->InputAt(1));
+  }
+  return HeapLocationCollector::kHeapLocationNotFound;
+}
+
+bool GlobalValueNumberer::MayReadHeapLocations(HInstruction* instruction,
+                                               const BitVector& locations) const {
+  if (!instruction->IsInstanceFieldGet() &&
+      !instruction->IsStaticFieldGet() &&
+      !instruction->IsArrayGet()) {
+    return true;
+  }
+  size_t read_location = FindHeapLocationOf(instruction);
+  if (read_location == HeapLocationCollector::kHeapLocationNotFound) {
+    return true;
+  }
+  for (uint32_t location : locations.Indexes()) {
+    if (location == read_location ||
+        heap_location_collector_.MayAlias(location, read_location)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void GlobalValueNumberer::KillFor(ValueSet* set, HInstruction* instruction) {
+  SideEffects side_effects = instruction->GetSideEffects();
+  if (!side_effects.DoesAnyWrite() ||
+      !(instruction->IsInstanceFieldSet() ||
+        instruction->IsStaticFieldSet() ||
+        instruction->IsArraySet())) {
+    set->Kill(side_effects);
+    return;
+  }
+  size_t location = FindHeapLocationOf(instruction);
+  if (location == HeapLocationCollector::kHeapLocationNotFound) {
+    set->Kill(side_effects);
+    return;
+  }
+  written_locations_.ClearAllBits();
+  written_locations_.SetBit(location);
+  set->Kill(side_effects, [this](HInstruction* existing) {
+    return MayReadHeapLocations(existing, written_locations_);
+  });
+}
+
+void GlobalValueNumberer::KillForLoop(ValueSet* set, HBasicBlock* block) {
+  if (heap_location_collector_.GetNumberOfHeapLocations() == 0u) {
+    set->Kill(side_effects_.GetLoopEffects(block));
+    return;
+  }
+  // Split the side effects of the loop between the stores to known heap locations,
+  // which only kill the loads that may alias them, and all the other instructions.
+  SideEffects store_effects = SideEffects::None();
+  SideEffects other_effects = SideEffects::None();
+  written_locations_.ClearAllBits();
+  for (HBlocksInLoopIterator it(*block->GetLoopInformation()); !it.Done(); it.Advance()) {
+    for (HInstructionIterator inst_it(it.Current()->GetInstructions());
+         !inst_it.Done();
+         inst_it.Advance()) {
+      HInstruction* instruction = inst_it.Current();
+      size_t location = (instruction->IsInstanceFieldSet() ||
+                         instruction->IsStaticFieldSet() ||
+                         instruction->IsArraySet())
+          ? FindHeapLocationOf(instruction)
+          : HeapLocationCollector::kHeapLocationNotFound;
+      if (location != HeapLocationCollector::kHeapLocationNotFound) {
+        store_effects = store_effects.Union(instruction->GetSideEffects());
+        written_locations_.SetBit(location);
+      } else {
+        other_effects = other_effects.Union(instruction->GetSideEffects());
+      }
+    }
+  }
+  set->Kill(other_effects);
+  set->Kill(store_effects, [this](HInstruction* existing) {
+    return MayReadHeapLocations(existing, written_locations_);
+  });
+}
+
 bool GlobalValueNumberer::WillBeReferencedAgain(HBasicBlock* block) const {
   DCHECK(visited_blocks_.IsBitSet(block->GetBlockId()));
 
@@ -558,7 +693,10 @@ HBasicBlock* GlobalValueNumberer::FindVisitedBlockWithRecyclableSet(
 }
 
 void GVNOptimization::Run() {
-  GlobalValueNumberer gvn(graph_, side_effects_);
+  // The heap locations let stores only kill the loads they may alias.
+  LoadStoreAnalysis lsa(graph_);
+  lsa.Run();
+  GlobalValueNumberer gvn(graph_, side_effects_, lsa.GetHeapLocationCollector());
   gvn.Run();
 }
 
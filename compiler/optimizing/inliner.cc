@@ -16,10 +16,12 @@
 
 #include "inliner.h"
 
+#include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "base/enums.h"
 #include "builder.h"
 #include "class_linker.h"
+#include "code_generator.h"
 #include "constant_folding.h"
 #include "data_type-inl.h"
 #include "dead_code_elimination.h"
@@ -35,6 +37,10 @@
 #include "jit/jit_code_cache.h"
 #include "mirror/class_loader.h"
 #include "mirror/dex_cache.h"
+#include "mirror/field-inl.h"
+#include "mirror/method_handle_impl.h"
+#include "mirror/method_type.h"
+#include "mirror/object_array-inl.h"
 #include "nodes.h"
 #include "optimizing_compiler.h"
 #include "reference_type_propagation.h"
@@ -63,9 +69,29 @@ static constexpr size_t kMaximumNumberOfCumulatedDexRegisters = 32;
 // much inlining compared to code locality.
 static constexpr size_t kMaximumNumberOfRecursiveCalls = 4;
 
+// The instruction and dex register limits for the call sites that the profile shows
+// are the hottest of the method, so that hot paths get deeper inlining.
+static constexpr size_t kMaximumNumberOfTotalInstructionsForHotCallSite = 1536;
+static constexpr size_t kMaximumNumberOfCumulatedDexRegistersForHotCallSite = 64;
+
+// A call site is hot if it runs at least 1/kHotCallSiteFrequencyRatio as often as
+// the most frequent call site of the method.
+static constexpr uint32_t kHotCallSiteFrequencyRatio = 8;
+
+// The frequency of a call site the profile has no data for.
+static constexpr uint32_t kUnknownCallSiteFrequency = static_cast<uint32_t>(-1);
+
 // Controls the use of inline caches in AOT mode.
 static constexpr bool kUseAOTInlineCaches = true;
 
+// Maximum number of receivers of a megamorphic call that we inline, the
+// other receivers go through the original invoke.
+static constexpr size_t kMaximumNumberOfMegamorphicTargets = 3;
+
+// Percentage of the calls from a megamorphic call site that the inlined
+// receivers must account for.
+static constexpr uint32_t kMinimumMegamorphicCoveragePercent = 90;
+
 // We check for line numbers to make sure the DepthString implementation
 // aligns the output nicely.
 #define LOG_INTERNAL(msg) \
@@ -114,13 +140,36 @@ static size_t CountNumberOfInstructions(HGraph* graph) {
 }
 
 void HInliner::UpdateInliningBudget() {
-  if (total_number_of_instructions_ >= kMaximumNumberOfTotalInstructions) {
+  const size_t maximum_number_of_total_instructions = (call_site_hotness_ == kCallSiteHot)
+      ? kMaximumNumberOfTotalInstructionsForHotCallSite
+      : kMaximumNumberOfTotalInstructions;
+  if (call_site_hotness_ == kCallSiteCold ||
+      total_number_of_instructions_ >= maximum_number_of_total_instructions) {
     // Always try to inline small methods.
     inlining_budget_ = kMaximumNumberOfInstructionsForSmallMethod;
   } else {
     inlining_budget_ = std::max(
         kMaximumNumberOfInstructionsForSmallMethod,
-        kMaximumNumberOfTotalInstructions - total_number_of_instructions_);
+        maximum_number_of_total_instructions - total_number_of_instructions_);
+  }
+}
+
+size_t HInliner::GetMaximumNumberOfCumulatedDexRegisters() const {
+  return (call_site_hotness_ == kCallSiteHot)
+      ? kMaximumNumberOfCumulatedDexRegistersForHotCallSite
+      : kMaximumNumberOfCumulatedDexRegisters;
+}
+
+// Whether `call` is a boxing intrinsic which no code generator implements, and which is
+// better inlined than left as a call.
+static bool IsInlinedBoxingIntrinsic(HInvoke* call) {
+  switch (call->GetIntrinsic()) {
+    case Intrinsics::kLongValueOf:
+    case Intrinsics::kShortValueOf:
+    case Intrinsics::kCharacterValueOf:
+      return true;
+    default:
+      return false;
   }
 }
 
@@ -152,35 +201,53 @@ void HInliner::Run() {
   const bool honor_inlining_directives =
       IsCompilingWithCoreImage() && Runtime::Current()->IsAotCompiler();
 
-  // Keep a copy of all blocks when starting the visit.
-  ArenaVector<HBasicBlock*> blocks = graph_->GetReversePostOrder();
-  DCHECK(!blocks.empty());
+  // Keep a copy of all calls when starting the visit.
   // Because we are changing the graph when inlining,
-  // we just iterate over the blocks of the outer method.
+  // we just iterate over the calls of the outer method.
   // This avoids doing the inlining work again on the inlined blocks.
-  for (HBasicBlock* block : blocks) {
-    for (HInstruction* instruction = block->GetFirstInstruction(); instruction != nullptr;) {
-      HInstruction* next = instruction->GetNext();
-      HInvoke* call = instruction->AsInvoke();
-      // As long as the call is not intrinsified, it is worth trying to inline.
-      if (call != nullptr && call->GetIntrinsic() == Intrinsics::kNone) {
-        if (honor_inlining_directives) {
-          // Debugging case: directives in method names control or assert on inlining.
-          std::string callee_name = outer_compilation_unit_.GetDexFile()->PrettyMethod(
-              call->GetDexMethodIndex(), /* with_signature */ false);
-          // Tests prevent inlining by having $noinline$ in their method names.
-          if (callee_name.find("$noinline$") == std::string::npos) {
-            if (!TryInline(call)) {
-              bool should_have_inlined = (callee_name.find("$inline$") != std::string::npos);
-              CHECK(!should_have_inlined) << "Could not inline " << callee_name;
-            }
-          }
-        } else {
-          // Normal case: try to inline.
-          TryInline(call);
+  std::vector<HInvoke*> calls;
+  DCHECK(!graph_->GetReversePostOrder().empty());
+  for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInvoke* call = it.Current()->AsInvoke();
+      // As long as the call is not intrinsified, it is worth trying to inline. The boxing
+      // intrinsics without code generation are only recognized for the elision of box-unbox
+      // pairs, which the simplifier has already done.
+      if (call != nullptr &&
+          (call->GetIntrinsic() == Intrinsics::kNone || IsInlinedBoxingIntrinsic(call))) {
+        calls.push_back(call);
+      }
+    }
+  }
+
+  // The call sites of inlined methods inherit the hotness of the call site they were
+  // inlined at, only the call sites of the outermost method are ordered by hotness.
+  std::vector<CallSiteHotness> hotness;
+  const bool is_outermost = (outermost_graph_ == graph_);
+  if (is_outermost) {
+    SortCallSitesByHotness(&calls, &hotness);
+  }
+
+  for (size_t i = 0; i < calls.size(); ++i) {
+    HInvoke* call = calls[i];
+    if (is_outermost) {
+      call_site_hotness_ = hotness[i];
+      UpdateInliningBudget();
+    }
+    if (honor_inlining_directives) {
+      // Debugging case: directives in method names control or assert on inlining.
+      std::string callee_name = outer_compilation_unit_.GetDexFile()->PrettyMethod(
+          call->GetDexMethodIndex(), /* with_signature */ false);
+      // Tests prevent inlining by having $noinline$ in their method names.
+      if (callee_name.find("$noinline$") == std::string::npos) {
+        if (!TryInline(call)) {
+          bool should_have_inlined = (callee_name.find("$inline$") != std::string::npos);
+          CHECK(!should_have_inlined) << "Could not inline " << callee_name;
         }
       }
-      instruction = next;
+    } else {
+      // Normal case: try to inline.
+      TryInline(call);
     }
   }
 }
@@ -332,6 +399,118 @@ class ScopedProfilingInfoInlineUse {
   ProfilingInfo* const profiling_info_;
 };
 
+uint32_t HInliner::GetCallSiteFrequency(
+    HInvoke* invoke,
+    const ProfileCompilationInfo::OfflineProfileMethodInfo* offline_profile) {
+  if (Runtime::Current()->UseJitCompilation()) {
+    // Only virtual and interface calls have an inline cache counting them.
+    if (!invoke->IsInvokeVirtual() && !invoke->IsInvokeInterface()) {
+      return kUnknownCallSiteFrequency;
+    }
+    ScopedProfilingInfoInlineUse spiis(graph_->GetArtMethod(), Thread::Current());
+    ProfilingInfo* profiling_info = spiis.GetProfilingInfo();
+    if (profiling_info == nullptr) {
+      return kUnknownCallSiteFrequency;
+    }
+    return profiling_info->GetInlineCache(invoke->GetDexPc())->GetTotalCount();
+  }
+
+  const ProfileCompilationInfo* pci = compiler_driver_->GetProfileCompilationInfo();
+  ArtMethod* resolved_method = invoke->GetResolvedMethod();
+  const DexFile& dex_file = *outer_compilation_unit_.GetDexFile();
+  // The profile may not cover the methods of other dex files, for example of the boot
+  // class path, so don't consider them cold.
+  if (pci == nullptr ||
+      resolved_method == nullptr ||
+      resolved_method->GetDexFile() != &dex_file) {
+    return kUnknownCallSiteFrequency;
+  }
+  ProfileCompilationInfo::MethodHotness hotness =
+      pci->GetMethodHotness(MethodReference(&dex_file, resolved_method->GetDexMethodIndex()));
+  if (!hotness.IsHot()) {
+    return 0u;
+  }
+  // The weights of the inline cache tell how often the call site ran, when it has one.
+  uint32_t frequency = 1u;
+  if (offline_profile != nullptr) {
+    const auto it = offline_profile->inline_caches->find(invoke->GetDexPc());
+    if (it != offline_profile->inline_caches->end()) {
+      for (const auto& entry : it->second.weights) {
+        frequency += entry.second;
+      }
+    }
+  }
+  return frequency;
+}
+
+void HInliner::SortCallSitesByHotness(/*inout*/std::vector<HInvoke*>* calls,
+                                      /*out*/std::vector<CallSiteHotness>* hotness) {
+  hotness->assign(calls->size(), kCallSiteWarm);
+  ScopedObjectAccess soa(Thread::Current());
+  std::unique_ptr<ProfileCompilationInfo::OfflineProfileMethodInfo> offline_profile;
+  const ProfileCompilationInfo* pci = compiler_driver_->GetProfileCompilationInfo();
+  if (Runtime::Current()->IsAotCompiler() && pci != nullptr) {
+    const DexFile& dex_file = *outer_compilation_unit_.GetDexFile();
+    offline_profile = pci->GetMethod(dex_file.GetLocation(),
+                                     dex_file.GetLocationChecksum(),
+                                     outer_compilation_unit_.GetDexMethodIndex());
+  }
+
+  std::vector<uint32_t> frequencies;
+  frequencies.reserve(calls->size());
+  uint32_t max_frequency = 0u;
+  bool has_frequencies = false;
+  for (HInvoke* call : *calls) {
+    uint32_t frequency = GetCallSiteFrequency(call, offline_profile.get());
+    frequencies.push_back(frequency);
+    if (frequency != kUnknownCallSiteFrequency) {
+      has_frequencies = true;
+      max_frequency = std::max(max_frequency, frequency);
+    }
+  }
+  if (!has_frequencies) {
+    return;
+  }
+
+  std::vector<size_t> order(calls->size());
+  for (size_t i = 0; i < calls->size(); ++i) {
+    order[i] = i;
+    if (frequencies[i] == 0u) {
+      (*hotness)[i] = kCallSiteCold;
+    } else if (frequencies[i] != kUnknownCallSiteFrequency &&
+               static_cast<uint64_t>(frequencies[i]) * kHotCallSiteFrequencyRatio >=
+                   max_frequency) {
+      (*hotness)[i] = kCallSiteHot;
+    } else {
+      frequencies[i] = 0u;  // Order the warm call sites as they appear in the method.
+    }
+  }
+  // Hottest first, the call sites with the same frequency keep the reverse post order.
+  std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    if ((*hotness)[lhs] != (*hotness)[rhs]) {
+      return (*hotness)[lhs] > (*hotness)[rhs];
+    }
+    return frequencies[lhs] > frequencies[rhs];
+  });
+
+  std::vector<HInvoke*> sorted_calls;
+  std::vector<CallSiteHotness> sorted_hotness;
+  sorted_calls.reserve(calls->size());
+  sorted_hotness.reserve(calls->size());
+  for (size_t i : order) {
+    sorted_calls.push_back((*calls)[i]);
+    sorted_hotness.push_back((*hotness)[i]);
+    if ((*hotness)[i] != kCallSiteWarm) {
+      MaybeRecordStat(stats_,
+                      ((*hotness)[i] == kCallSiteHot)
+                          ? MethodCompilationStat::kInlinerHotCallSite
+                          : MethodCompilationStat::kInlinerColdCallSite);
+    }
+  }
+  calls->swap(sorted_calls);
+  hotness->swap(sorted_hotness);
+}
+
 HInliner::InlineCacheType HInliner::GetInlineCacheType(
     const Handle<mirror::ObjectArray<mirror::Class>>& classes)
   REQUIRES_SHARED(Locks::mutator_lock_) {
@@ -353,6 +532,31 @@ HInliner::InlineCacheType HInliner::GetInlineCacheType(
   }
 }
 
+// Order the classes of the inline cache by decreasing number of times they were
+// seen, so that the most frequent receivers get checked first. The matching
+// `counts` are reordered too.
+static void SortInlineCacheByFrequency(Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                       /*inout*/ uint16_t* counts)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  std::vector<std::pair<uint16_t, ObjPtr<mirror::Class>>> entries;
+  for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
+    if (classes->Get(i) == nullptr) {
+      break;
+    }
+    entries.emplace_back(counts[i], classes->Get(i));
+  }
+  std::stable_sort(entries.begin(),
+                   entries.end(),
+                   [](const std::pair<uint16_t, ObjPtr<mirror::Class>>& lhs,
+                      const std::pair<uint16_t, ObjPtr<mirror::Class>>& rhs) {
+                     return lhs.first > rhs.first;
+                   });
+  for (size_t i = 0; i < entries.size(); ++i) {
+    counts[i] = entries[i].first;
+    classes->Set(i, entries[i].second);
+  }
+}
+
 static mirror::Class* GetMonomorphicType(Handle<mirror::ObjectArray<mirror::Class>> classes)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   DCHECK(classes->Get(0) != nullptr);
@@ -392,14 +596,327 @@ ArtMethod* HInliner::TryCHADevirtualization(ArtMethod* resolved_method) {
   return single_impl;
 }
 
+// Returns the object in the static final field read by `instruction`, null if there is none.
+// The field of an initialized class can only change through reflection or JNI, which we ignore
+// like for the other final fields.
+static ObjPtr<mirror::Object> GetConstantObject(HInstruction* instruction)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  if (instruction->IsNullCheck()) {
+    instruction = instruction->InputAt(0);
+  }
+  if (!instruction->IsStaticFieldGet()) {
+    return nullptr;
+  }
+  ArtField* field = instruction->AsStaticFieldGet()->GetFieldInfo().GetField();
+  if (field == nullptr || !field->IsFinal() || !field->GetDeclaringClass()->IsInitialized()) {
+    return nullptr;
+  }
+  return field->GetObject(field->GetDeclaringClass());
+}
+
+// Returns whether the type of the call site `invoke_instruction` is exactly `method_type`, the
+// only case where invoking the handle doesn't convert nor check the arguments.
+static bool IsExactCallSiteType(HInvokePolymorphic* invoke_instruction,
+                                const DexCompilationUnit& compilation_unit,
+                                ObjPtr<mirror::MethodType> method_type)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  const DexFile& dex_file = invoke_instruction->GetDexFile();
+  DCHECK_EQ(&dex_file, compilation_unit.GetDexFile());
+  ClassLinker* class_linker = compilation_unit.GetClassLinker();
+  ObjPtr<mirror::DexCache> dex_cache = compilation_unit.GetDexCache().Get();
+  ObjPtr<mirror::ClassLoader> class_loader = compilation_unit.GetClassLoader().Get();
+  const DexFile::ProtoId& proto_id = dex_file.GetProtoId(invoke_instruction->GetProtoIndex());
+  // The types not resolved yet can't be the ones of the method type.
+  if (class_linker->LookupResolvedType(proto_id.return_type_idx_, dex_cache, class_loader) !=
+          method_type->GetRType()) {
+    return false;
+  }
+  const DexFile::TypeList* parameters = dex_file.GetProtoParameters(proto_id);
+  ObjPtr<mirror::ObjectArray<mirror::Class>> parameter_types = method_type->GetPTypes();
+  const uint32_t number_of_parameters = (parameters != nullptr) ? parameters->Size() : 0u;
+  if (static_cast<int32_t>(number_of_parameters) != parameter_types->GetLength()) {
+    return false;
+  }
+  for (uint32_t i = 0; i != number_of_parameters; ++i) {
+    dex::TypeIndex type_idx = parameters->GetTypeItem(i).type_idx_;
+    if (class_linker->LookupResolvedType(type_idx, dex_cache, class_loader) !=
+            parameter_types->GetWithoutChecks(i)) {
+      return false;
+    }
+  }
+  // A call site taking an EmulatedStackFrame is a transformer, see MethodHandleInvokeExact().
+  return number_of_parameters != 1u ||
+      !parameter_types->GetWithoutChecks(0)->DescriptorEquals("Ldalvik/system/EmulatedStackFrame;");
+}
+
+bool HInliner::TryInlineMethodHandleInvoke(HInvokePolymorphic* invoke_instruction) {
+  // The handle is read from the heap at compile time, the AOT compiler can't do that.
+  if (!Runtime::Current()->UseJitCompilation()) {
+    return false;
+  }
+  ArtMethod* resolved_method = invoke_instruction->GetResolvedMethod();
+  if (resolved_method == nullptr || !resolved_method->IsIntrinsic()) {
+    return false;
+  }
+  Intrinsics intrinsic = static_cast<Intrinsics>(resolved_method->GetIntrinsic());
+  if (intrinsic != Intrinsics::kMethodHandleInvoke &&
+      intrinsic != Intrinsics::kMethodHandleInvokeExact) {
+    // A VarHandle accessor.
+    return false;
+  }
+  ObjPtr<mirror::Object> constant = GetConstantObject(invoke_instruction->InputAt(0));
+  if (constant == nullptr || !constant->InstanceOf(mirror::MethodHandle::StaticClass())) {
+    return false;
+  }
+  ObjPtr<mirror::MethodHandle> method_handle = ObjPtr<mirror::MethodHandle>::DownCast(constant);
+  // With a nominal type, from asType(), invokeExact() checks the call site against it and may
+  // have to convert the arguments to the type of the target.
+  if (method_handle->GetNominalType() != nullptr ||
+      !IsExactCallSiteType(invoke_instruction,
+                           caller_compilation_unit_,
+                           method_handle->GetMethodType())) {
+    LOG_FAIL_NO_STAT() << "Method handle invoke without the exact type of the handle";
+    return false;
+  }
+
+  // Only the handles invoking a method like the equivalent invoke instruction have a direct
+  // equivalent. The transforms, the super calls, and the field accessors stay in the runtime.
+  const mirror::MethodHandle::Kind handle_kind = method_handle->GetHandleKind();
+  ArtMethod* target_method = method_handle->GetTargetMethod();
+  InvokeType invoke_type;
+  switch (handle_kind) {
+    case mirror::MethodHandle::kInvokeStatic:
+      // The invoke can't initialize the class.
+      if (!target_method->GetDeclaringClass()->IsInitialized()) {
+        return false;
+      }
+      invoke_type = kStatic;
+      break;
+    case mirror::MethodHandle::kInvokeDirect:
+      // Constructor handles allocate the object, String.<init> ones use the StringFactory.
+      if (target_method->IsConstructor()) {
+        return false;
+      }
+      invoke_type = kDirect;
+      break;
+    case mirror::MethodHandle::kInvokeVirtual:
+      if (target_method->GetDeclaringClass()->IsInterface()) {
+        return false;
+      }
+      invoke_type = kVirtual;
+      break;
+    default:
+      return false;
+  }
+  if (target_method->IsProxyMethod()) {
+    return false;
+  }
+  // The compiled code embeds the target method, which must not be unloaded before it. The handle
+  // doesn't keep the class of a static target alive.
+  ObjPtr<mirror::ClassLoader> target_class_loader =
+      target_method->GetDeclaringClass()->GetClassLoader();
+  if (target_class_loader != nullptr &&
+      target_class_loader != caller_compilation_unit_.GetClassLoader().Get()) {
+    return false;
+  }
+
+  // Call the target directly, with the arguments of the invoke but the handle.
+  uint32_t dex_pc = invoke_instruction->GetDexPc();
+  size_t number_of_arguments = invoke_instruction->GetNumberOfArguments() - 1u;
+  HInvoke* new_invoke = nullptr;
+  if (invoke_type == kVirtual) {
+    new_invoke = new (graph_->GetAllocator()) HInvokeVirtual(
+        graph_->GetAllocator(),
+        number_of_arguments,
+        invoke_instruction->GetType(),
+        dex_pc,
+        invoke_instruction->GetDexMethodIndex(),  // Use the invoke's dex method index.
+        target_method,
+        target_method->GetMethodIndex());
+  } else {
+    // Like for CHA devirtualization, the JIT can embed the method address.
+    HInvokeStaticOrDirect::DispatchInfo dispatch_info = {
+        HInvokeStaticOrDirect::MethodLoadKind::kDirectAddress,
+        HInvokeStaticOrDirect::CodePtrLocation::kCallArtMethod,
+        reinterpret_cast<uintptr_t>(target_method)
+    };
+    HInvokeStaticOrDirect* invoke_static_or_direct =
+        new (graph_->GetAllocator()) HInvokeStaticOrDirect(
+            graph_->GetAllocator(),
+            number_of_arguments,
+            invoke_instruction->GetType(),
+            dex_pc,
+            invoke_instruction->GetDexMethodIndex(),  // Use the invoke's dex method index.
+            target_method,
+            dispatch_info,
+            invoke_type,
+            MethodReference(target_method->GetDexFile(), target_method->GetDexMethodIndex()),
+            HInvokeStaticOrDirect::ClinitCheckRequirement::kNone);
+    invoke_static_or_direct->SetDispatchInfo(
+        codegen_->GetSupportedInvokeStaticOrDirectDispatch(dispatch_info,
+                                                           invoke_static_or_direct));
+    new_invoke = invoke_static_or_direct;
+  }
+  for (size_t index = 0; index != number_of_arguments; ++index) {
+    new_invoke->SetArgumentAt(index, invoke_instruction->InputAt(index + 1u));
+  }
+  HBasicBlock* block = invoke_instruction->GetBlock();
+  if (invoke_type != kStatic && new_invoke->InputAt(0)->CanBeNull()) {
+    // The handle throws a NullPointerException for a null receiver, like the invoke.
+    HInstruction* receiver = new_invoke->InputAt(0);
+    HNullCheck* null_check = new (graph_->GetAllocator()) HNullCheck(receiver, dex_pc);
+    block->InsertInstructionBefore(null_check, invoke_instruction);
+    null_check->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+    null_check->SetReferenceTypeInfo(receiver->GetReferenceTypeInfo());
+    new_invoke->ReplaceInput(null_check, 0u);
+  }
+  block->InsertInstructionBefore(new_invoke, invoke_instruction);
+  new_invoke->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+  if (invoke_instruction->GetType() == DataType::Type::kReference) {
+    new_invoke->SetReferenceTypeInfo(invoke_instruction->GetReferenceTypeInfo());
+  }
+  HInstruction* handle = invoke_instruction->InputAt(0);
+  invoke_instruction->ReplaceWith(new_invoke);
+  block->RemoveInstruction(invoke_instruction);
+  // The handle is not null, its null check is dead.
+  if (handle->IsNullCheck() && !handle->HasUses()) {
+    handle->GetBlock()->RemoveInstruction(handle);
+  }
+  MaybeRecordStat(stats_, MethodCompilationStat::kMethodHandleInvokeDevirtualized);
+  LOG_NOTE() << "Method handle invoke replaced by an invoke of " << target_method->PrettyMethod();
+
+  // Then try to inline the target. The invoke has no inline cache, only the exact type of the
+  // receiver can find the target of a virtual call.
+  bool wrong_invoke_type = false;
+  if (IntrinsicsRecognizer::Recognize(new_invoke, target_method, &wrong_invoke_type)) {
+    MaybeRecordStat(stats_, MethodCompilationStat::kIntrinsicRecognized);
+    return true;
+  }
+  ArtMethod* actual_method = (invoke_type == kVirtual)
+      ? FindVirtualOrInterfaceTarget(new_invoke, target_method)
+      : target_method;
+  if (actual_method != nullptr) {
+    TryInlineAndReplace(new_invoke,
+                        actual_method,
+                        ReferenceTypeInfo::CreateInvalid(),
+                        /* do_rtp */ true,
+                        /* cha_devirtualize */ false);
+  }
+  // The direct call is still better than the runtime call even if the target is not inlined.
+  return true;
+}
+
+bool HInliner::TryInlineReflectiveFieldGet(HInvoke* invoke_instruction) {
+  // The Field is read from the heap at compile time, the AOT compiler can't do that.
+  if (!Runtime::Current()->UseJitCompilation()) {
+    return false;
+  }
+  // Field.getBoolean(Object) to Field.getShort(Object), the getters of the primitive values.
+  ArtMethod* resolved_method = invoke_instruction->GetResolvedMethod();
+  if (resolved_method->GetDeclaringClass() != mirror::Field::StaticClass() ||
+      !resolved_method->IsNative() ||
+      strncmp(resolved_method->GetName(), "get", 3) != 0 ||
+      invoke_instruction->GetNumberOfArguments() != 2u ||
+      invoke_instruction->InputAt(1)->GetType() != DataType::Type::kReference ||
+      invoke_instruction->GetType() == DataType::Type::kReference ||
+      invoke_instruction->GetType() == DataType::Type::kVoid) {
+    return false;
+  }
+  HInstruction* field_instruction = invoke_instruction->InputAt(0);
+  ObjPtr<mirror::Object> constant = GetConstantObject(field_instruction);
+  if (constant == nullptr || !constant->InstanceOf(mirror::Field::StaticClass())) {
+    return false;
+  }
+  ObjPtr<mirror::Field> field_object = ObjPtr<mirror::Field>::DownCast(constant);
+  ArtField* field = field_object->GetArtField();
+  // The static fields need the class to be initialized, and the widening getters a conversion.
+  const DataType::Type field_type = DataType::FromShorty(field->GetTypeDescriptor()[0]);
+  if (field->IsStatic() || field_type != invoke_instruction->GetType()) {
+    return false;
+  }
+  // Field.get*() throws an IllegalArgumentException for a receiver of another class.
+  HInstruction* receiver = invoke_instruction->InputAt(1);
+  ReferenceTypeInfo receiver_rti = receiver->GetReferenceTypeInfo();
+  if (!receiver_rti.IsValid() ||
+      !field->GetDeclaringClass()->IsAssignableFrom(receiver_rti.GetTypeHandle().Get())) {
+    LOG_FAIL_NO_STAT() << "Reflective get of " << field->PrettyField()
+                       << " with a receiver of unknown class";
+    return false;
+  }
+  // The access of the other fields is checked against the caller, unless the Field was made
+  // accessible, which can be undone: guard on the flag.
+  const bool needs_access_guard =
+      !field->IsPublic() || !field->GetDeclaringClass()->IsPublic();
+  if (needs_access_guard && !field_object->IsAccessible()) {
+    return false;
+  }
+
+  uint32_t dex_pc = invoke_instruction->GetDexPc();
+  HBasicBlock* block = invoke_instruction->GetBlock();
+  if (needs_access_guard) {
+    ArtField* flag_field = field_object->GetClass()->GetSuperClass()->GetInstanceField(0);
+    DCHECK_EQ(flag_field->GetOffset().Uint32Value(),
+              mirror::AccessibleObject::FlagOffset().Uint32Value());
+    // The Field is not null, read the flag from the static field rather than its null check.
+    HInstruction* field_value =
+        field_instruction->IsNullCheck() ? field_instruction->InputAt(0) : field_instruction;
+    HInstanceFieldGet* flag = new (graph_->GetAllocator()) HInstanceFieldGet(
+        field_value,
+        flag_field,
+        DataType::Type::kBool,
+        flag_field->GetOffset(),
+        flag_field->IsVolatile(),
+        flag_field->GetDexFieldIndex(),
+        flag_field->GetDeclaringClass()->GetDexClassDefIndex(),
+        *flag_field->GetDexFile(),
+        dex_pc);
+    HEqual* compare = new (graph_->GetAllocator()) HEqual(flag, graph_->GetIntConstant(0, dex_pc));
+    HDeoptimize* deoptimize = new (graph_->GetAllocator()) HDeoptimize(
+        graph_->GetAllocator(), compare, DeoptimizationKind::kJitReflectiveAccess, dex_pc);
+    block->InsertInstructionBefore(flag, invoke_instruction);
+    block->InsertInstructionBefore(compare, invoke_instruction);
+    block->InsertInstructionBefore(deoptimize, invoke_instruction);
+    deoptimize->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+  }
+  if (receiver->CanBeNull()) {
+    // Field.get*() throws a NullPointerException for a null receiver, like the field get.
+    HNullCheck* null_check = new (graph_->GetAllocator()) HNullCheck(receiver, dex_pc);
+    block->InsertInstructionBefore(null_check, invoke_instruction);
+    null_check->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+    null_check->SetReferenceTypeInfo(receiver_rti);
+    receiver = null_check;
+  }
+  HInstanceFieldGet* field_get = new (graph_->GetAllocator()) HInstanceFieldGet(
+      receiver,
+      field,
+      field_type,
+      field->GetOffset(),
+      field->IsVolatile(),
+      field->GetDexFieldIndex(),
+      field->GetDeclaringClass()->GetDexClassDefIndex(),
+      *field->GetDexFile(),
+      dex_pc);
+  block->InsertInstructionBefore(field_get, invoke_instruction);
+  invoke_instruction->ReplaceWith(field_get);
+  block->RemoveInstruction(invoke_instruction);
+  // The Field is not null, its null check is dead.
+  if (field_instruction->IsNullCheck() && !field_instruction->HasUses()) {
+    field_instruction->GetBlock()->RemoveInstruction(field_instruction);
+  }
+  MaybeRecordStat(stats_, MethodCompilationStat::kReflectiveFieldGetInlined);
+  LOG_NOTE() << "Reflective get replaced by a get of " << field->PrettyField();
+  return true;
+}
+
 bool HInliner::TryInline(HInvoke* invoke_instruction) {
-  if (invoke_instruction->IsInvokeUnresolved() ||
-      invoke_instruction->IsInvokePolymorphic()) {
-    return false;  // Don't bother to move further if we know the method is unresolved or an
-                   // invoke-polymorphic.
+  if (invoke_instruction->IsInvokeUnresolved()) {
+    return false;  // Don't bother to move further if we know the method is unresolved.
   }
 
   ScopedObjectAccess soa(Thread::Current());
+  if (invoke_instruction->IsInvokePolymorphic()) {
+    return TryInlineMethodHandleInvoke(invoke_instruction->AsInvokePolymorphic());
+  }
   uint32_t method_index = invoke_instruction->GetDexMethodIndex();
   const DexFile& caller_dex_file = *caller_compilation_unit_.GetDexFile();
   LOG_TRY() << caller_dex_file.PrettyMethod(method_index);
@@ -411,6 +928,9 @@ bool HInliner::TryInline(HInvoke* invoke_instruction) {
     LOG_FAIL_NO_STAT() << "Not inlining a String.<init> method";
     return false;
   }
+  if (resolved_method->IsNative() && TryInlineReflectiveFieldGet(invoke_instruction)) {
+    return true;
+  }
   ArtMethod* actual_method = nullptr;
 
   if (invoke_instruction->IsInvokeStaticOrDirect()) {
@@ -511,9 +1031,12 @@ bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
 
   StackHandleScope<1> hs(Thread::Current());
   Handle<mirror::ObjectArray<mirror::Class>> inline_cache;
+  // The number of times each receiver was seen, only known under JIT.
+  uint16_t counts[InlineCache::kIndividualCacheSize] = {};
+  uint16_t misses = 0u;
   InlineCacheType inline_cache_type = Runtime::Current()->IsAotCompiler()
       ? GetInlineCacheAOT(caller_dex_file, invoke_instruction, &hs, &inline_cache)
-      : GetInlineCacheJIT(invoke_instruction, &hs, &inline_cache);
+      : GetInlineCacheJIT(invoke_instruction, &hs, &inline_cache, counts, &misses);
 
   switch (inline_cache_type) {
     case kInlineCacheNoData: {
@@ -535,7 +1058,10 @@ bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
     case kInlineCacheMonomorphic: {
       MaybeRecordStat(stats_, MethodCompilationStat::kMonomorphicCall);
       if (UseOnlyPolymorphicInliningWithNoDeopt()) {
-        return TryInlinePolymorphicCall(invoke_instruction, resolved_method, inline_cache);
+        return TryInlinePolymorphicCall(invoke_instruction,
+                                        resolved_method,
+                                        inline_cache,
+                                        /* allow_deoptimization */ true);
       } else {
         return TryInlineMonomorphicCall(invoke_instruction, resolved_method, inline_cache);
       }
@@ -543,15 +1069,23 @@ bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
 
     case kInlineCachePolymorphic: {
       MaybeRecordStat(stats_, MethodCompilationStat::kPolymorphicCall);
-      return TryInlinePolymorphicCall(invoke_instruction, resolved_method, inline_cache);
+      return TryInlinePolymorphicCall(invoke_instruction,
+                                      resolved_method,
+                                      inline_cache,
+                                      /* allow_deoptimization */ true);
     }
 
     case kInlineCacheMegamorphic: {
+      MaybeRecordStat(stats_, MethodCompilationStat::kMegamorphicCall);
+      if (!Runtime::Current()->IsAotCompiler() &&
+          TryInlineMegamorphicCall(
+              invoke_instruction, resolved_method, inline_cache, counts, misses)) {
+        return true;
+      }
       LOG_FAIL_NO_STAT()
           << "Interface or virtual call to "
           << caller_dex_file.PrettyMethod(invoke_instruction->GetDexMethodIndex())
           << " is megamorphic and not inlined";
-      MaybeRecordStat(stats_, MethodCompilationStat::kMegamorphicCall);
       return false;
     }
 
@@ -569,7 +1103,9 @@ bool HInliner::TryInlineFromInlineCache(const DexFile& caller_dex_file,
 HInliner::InlineCacheType HInliner::GetInlineCacheJIT(
     HInvoke* invoke_instruction,
     StackHandleScope<1>* hs,
-    /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache)
+    /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache,
+    /*out*/uint16_t* counts,
+    /*out*/uint16_t* misses)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   DCHECK(Runtime::Current()->UseJitCompilation());
 
@@ -590,7 +1126,10 @@ HInliner::InlineCacheType HInliner::GetInlineCacheJIT(
   } else {
     Runtime::Current()->GetJit()->GetCodeCache()->CopyInlineCacheInto(
         *profiling_info->GetInlineCache(invoke_instruction->GetDexPc()),
-        *inline_cache);
+        *inline_cache,
+        counts,
+        misses);
+    SortInlineCacheByFrequency(*inline_cache, counts);
     return GetInlineCacheType(*inline_cache);
   }
 }
@@ -669,10 +1208,18 @@ HInliner::InlineCacheType HInliner::ExtractClassesFromOfflineProfile(
     }
   }
 
-  // Walk over the classes and resolve them. If we cannot find a type we return
-  // kInlineCacheMissingTypes.
+  // Walk over the classes, the most frequent first, and resolve them. If we cannot
+  // find a type we return kInlineCacheMissingTypes.
+  std::vector<ProfileCompilationInfo::ClassReference> class_refs(dex_pc_data.classes.begin(),
+                                                                 dex_pc_data.classes.end());
+  std::stable_sort(class_refs.begin(),
+                   class_refs.end(),
+                   [&dex_pc_data](const ProfileCompilationInfo::ClassReference& lhs,
+                                  const ProfileCompilationInfo::ClassReference& rhs) {
+                     return dex_pc_data.GetWeight(lhs) > dex_pc_data.GetWeight(rhs);
+                   });
   int ic_index = 0;
-  for (const ProfileCompilationInfo::ClassReference& class_ref : dex_pc_data.classes) {
+  for (const ProfileCompilationInfo::ClassReference& class_ref : class_refs) {
     ObjPtr<mirror::DexCache> dex_cache =
         dex_profile_index_to_dex_cache[class_ref.dex_profile_index];
     DCHECK(dex_cache != nullptr);
@@ -909,11 +1456,14 @@ HInstruction* HInliner::AddTypeGuard(HInstruction* receiver,
 
 bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
                                         ArtMethod* resolved_method,
-                                        Handle<mirror::ObjectArray<mirror::Class>> classes) {
+                                        Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                        bool allow_deoptimization) {
   DCHECK(invoke_instruction->IsInvokeVirtual() || invoke_instruction->IsInvokeInterface())
       << invoke_instruction->DebugName();
 
-  if (TryInlinePolymorphicCallToSameTarget(invoke_instruction, resolved_method, classes)) {
+  // Inlining a single target for all the receivers guards it with a deoptimization.
+  if (allow_deoptimization &&
+      TryInlinePolymorphicCallToSameTarget(invoke_instruction, resolved_method, classes)) {
     return true;
   }
 
@@ -960,7 +1510,8 @@ bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
 
       // If we have inlined all targets before, and this receiver is the last seen,
       // we deoptimize instead of keeping the original invoke instruction.
-      bool deoptimize = !UseOnlyPolymorphicInliningWithNoDeopt() &&
+      bool deoptimize = allow_deoptimization &&
+          !UseOnlyPolymorphicInliningWithNoDeopt() &&
           all_targets_inlined &&
           (i != InlineCache::kIndividualCacheSize - 1) &&
           (classes->Get(i + 1) == nullptr);
@@ -991,6 +1542,10 @@ bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
         << "Call to " << ArtMethod::PrettyMethod(resolved_method)
         << " from inline cache is not inlined because none"
         << " of its targets could be inlined";
+    if (!allow_deoptimization || UseOnlyPolymorphicInliningWithNoDeopt()) {
+      // The invoke is kept without a guard, still avoid the IMT for the monomorphic receiver.
+      return TryDevirtualizeMonomorphicInterfaceCall(invoke_instruction, resolved_method, classes);
+    }
     return false;
   }
 
@@ -1006,6 +1561,120 @@ bool HInliner::TryInlinePolymorphicCall(HInvoke* invoke_instruction,
   return true;
 }
 
+bool HInliner::TryDevirtualizeMonomorphicInterfaceCall(
+    HInvoke* invoke_instruction,
+    ArtMethod* resolved_method,
+    Handle<mirror::ObjectArray<mirror::Class>> classes) {
+  if (!invoke_instruction->IsInvokeInterface() ||
+      classes->Get(0) == nullptr ||
+      classes->Get(1) != nullptr) {
+    return false;
+  }
+  Handle<mirror::Class> monomorphic_type = handles_->NewHandle(GetMonomorphicType(classes));
+  dex::TypeIndex class_index = FindClassIndexIn(monomorphic_type.Get(), caller_compilation_unit_);
+  if (!class_index.IsValid()) {
+    return false;
+  }
+  PointerSize pointer_size = caller_compilation_unit_.GetClassLinker()->GetImagePointerSize();
+  ArtMethod* method = ResolveMethodFromInlineCache(
+      monomorphic_type, resolved_method, invoke_instruction, pointer_size);
+  if (method == nullptr || method->IsProxyMethod()) {
+    return false;
+  }
+  // Like in TryInlineAndReplace(), the method from the inline cache is in the vtable.
+  DCHECK(!method->IsDefault() || method->IsCopied());
+  uint32_t dex_method_index = FindMethodIndexIn(
+      method, *caller_compilation_unit_.GetDexFile(), invoke_instruction->GetDexMethodIndex());
+  if (dex_method_index == dex::kDexNoIndex) {
+    return false;
+  }
+
+  // if (receiver.getClass() == klass) invoke-virtual else invoke-interface. The invoke-virtual
+  // is a vtable load, the invoke-interface goes through the IMT and maybe its conflict table.
+  HInstruction* receiver = invoke_instruction->InputAt(0);
+  HInstruction* cursor = invoke_instruction->GetPrevious();
+  HBasicBlock* bb_cursor = invoke_instruction->GetBlock();
+  HInstruction* compare = AddTypeGuard(receiver,
+                                       cursor,
+                                       bb_cursor,
+                                       class_index,
+                                       monomorphic_type,
+                                       invoke_instruction,
+                                       /* with_deoptimization */ false);
+  HInvokeVirtual* new_invoke = new (graph_->GetAllocator()) HInvokeVirtual(
+      graph_->GetAllocator(),
+      invoke_instruction->GetNumberOfArguments(),
+      invoke_instruction->GetType(),
+      invoke_instruction->GetDexPc(),
+      dex_method_index,
+      method,
+      method->GetMethodIndex());
+  HInputsRef inputs = invoke_instruction->GetInputs();
+  for (size_t index = 0; index != inputs.size(); ++index) {
+    new_invoke->SetArgumentAt(index, inputs[index]);
+  }
+  invoke_instruction->GetBlock()->InsertInstructionBefore(new_invoke, invoke_instruction);
+  new_invoke->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+  if (invoke_instruction->GetType() == DataType::Type::kReference) {
+    new_invoke->SetReferenceTypeInfo(invoke_instruction->GetReferenceTypeInfo());
+  }
+  CreateDiamondPatternForPolymorphicInline(
+      compare,
+      invoke_instruction->GetType() == DataType::Type::kVoid ? nullptr : new_invoke,
+      invoke_instruction);
+  MaybeRecordStat(stats_, MethodCompilationStat::kInterfaceCallDevirtualized);
+  LOG_NOTE() << "Interface call guarded by a type check and devirtualized to "
+             << method->PrettyMethod();
+
+  // Run type propagation to get the guard typed.
+  ReferenceTypePropagation rtp_fixup(graph_,
+                                     outer_compilation_unit_.GetClassLoader(),
+                                     outer_compilation_unit_.GetDexCache(),
+                                     handles_,
+                                     /* is_first_run */ false);
+  rtp_fixup.Run();
+  return true;
+}
+
+bool HInliner::TryInlineMegamorphicCall(HInvoke* invoke_instruction,
+                                        ArtMethod* resolved_method,
+                                        Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                        const uint16_t* counts,
+                                        uint16_t misses) {
+  // The classes are sorted by frequency, find how many of the most frequent
+  // ones we need to cover most of the calls.
+  uint32_t total_count = misses;
+  for (size_t i = 0; i < InlineCache::kIndividualCacheSize; ++i) {
+    total_count += counts[i];
+  }
+  uint32_t covered_count = 0;
+  size_t number_of_targets = 0;
+  while (number_of_targets < kMaximumNumberOfMegamorphicTargets &&
+         covered_count * 100 < total_count * kMinimumMegamorphicCoveragePercent) {
+    covered_count += counts[number_of_targets++];
+  }
+  if (total_count == 0 ||
+      covered_count * 100 < total_count * kMinimumMegamorphicCoveragePercent) {
+    LOG_FAIL_NO_STAT()
+        << "Megamorphic call to " << ArtMethod::PrettyMethod(resolved_method)
+        << " has no dominant receivers";
+    return false;
+  }
+
+  // Only guard for the dominant receivers, the other ones will go through the
+  // original invoke. We never deoptimize: the receivers of a megamorphic call
+  // are expected to keep changing.
+  for (size_t i = number_of_targets; i < InlineCache::kIndividualCacheSize; ++i) {
+    classes->Set(i, nullptr);
+  }
+  if (!TryInlinePolymorphicCall(
+          invoke_instruction, resolved_method, classes, /* allow_deoptimization */ false)) {
+    return false;
+  }
+  MaybeRecordStat(stats_, MethodCompilationStat::kInlinedMegamorphicCall);
+  return true;
+}
+
 void HInliner::CreateDiamondPatternForPolymorphicInline(HInstruction* compare,
                                                         HInstruction* return_replacement,
                                                         HInstruction* invoke_instruction) {
@@ -1254,7 +1923,48 @@ bool HInliner::TryInlineAndReplace(HInvoke* invoke_instruction,
       // invoke_instruction is intrinsified and stays.
     }
   } else if (!TryBuildAndInline(invoke_instruction, method, receiver_type, &return_replacement)) {
-    if (invoke_instruction->IsInvokeInterface()) {
+    if (cha_devirtualize) {
+      // The CHA guard ensures that `method` is the only implementation, so call it
+      // directly instead of going through the IMT or the vtable. An invoke-interface
+      // with a single implementor would otherwise keep paying for the IMT lookup and
+      // possibly the conflict trampoline. This is also the only way to devirtualize
+      // to an original default method, which is in no vtable. CHA-based
+      // devirtualization is JIT only, so the method address can be embedded.
+      DCHECK(Runtime::Current()->UseJitCompilation());
+      DCHECK(!method->IsAbstract());
+      DCHECK(!method->IsProxyMethod());
+      HInvokeStaticOrDirect::DispatchInfo dispatch_info = {
+          HInvokeStaticOrDirect::MethodLoadKind::kDirectAddress,
+          HInvokeStaticOrDirect::CodePtrLocation::kCallArtMethod,
+          reinterpret_cast<uintptr_t>(method)
+      };
+      HInvokeStaticOrDirect* new_invoke = new (graph_->GetAllocator()) HInvokeStaticOrDirect(
+          graph_->GetAllocator(),
+          invoke_instruction->GetNumberOfArguments(),
+          invoke_instruction->GetType(),
+          invoke_instruction->GetDexPc(),
+          invoke_instruction->GetDexMethodIndex(),  // Use the invoked method's dex method index.
+          method,
+          dispatch_info,
+          kDirect,
+          MethodReference(method->GetDexFile(), method->GetDexMethodIndex()),
+          // The receiver is an instance of the declaring class, which is initialized.
+          HInvokeStaticOrDirect::ClinitCheckRequirement::kNone);
+      HInputsRef inputs = invoke_instruction->GetInputs();
+      for (size_t index = 0; index != inputs.size(); ++index) {
+        new_invoke->SetArgumentAt(index, inputs[index]);
+      }
+      invoke_instruction->GetBlock()->InsertInstructionBefore(new_invoke, invoke_instruction);
+      new_invoke->CopyEnvironmentFrom(invoke_instruction->GetEnvironment());
+      if (invoke_instruction->GetType() == DataType::Type::kReference) {
+        new_invoke->SetReferenceTypeInfo(invoke_instruction->GetReferenceTypeInfo());
+      }
+      new_invoke->SetDispatchInfo(
+          codegen_->GetSupportedInvokeStaticOrDirectDispatch(dispatch_info, new_invoke));
+      return_replacement = new_invoke;
+      // invoke_instruction is replaced with new_invoke.
+      should_remove_invoke_instruction = true;
+    } else if (invoke_instruction->IsInvokeInterface()) {
       DCHECK(!method->IsProxyMethod());
       // Turn an invoke-interface into an invoke-virtual. An invoke-virtual is always
       // better than an invoke-interface because:
@@ -1262,15 +1972,11 @@ bool HInliner::TryInlineAndReplace(HInvoke* invoke_instruction,
       // 2) We will not go to the conflict trampoline with an invoke-virtual.
       // TODO: Consider sharpening once it is not dependent on the compiler driver.
 
-      if (method->IsDefault() && !method->IsCopied()) {
-        // Changing to invoke-virtual cannot be done on an original default method
-        // since it's not in any vtable. Devirtualization by exact type/inline-cache
-        // always uses a method in the iftable which is never an original default
-        // method.
-        // On the other hand, inlining an original default method by CHA is fine.
-        DCHECK(cha_devirtualize);
-        return false;
-      }
+      // Changing to invoke-virtual cannot be done on an original default method
+      // since it's not in any vtable. Devirtualization by exact type/inline-cache
+      // always uses a method in the iftable which is never an original default
+      // method. CHA-based devirtualization is handled above.
+      DCHECK(!method->IsDefault() || method->IsCopied());
 
       const DexFile& caller_dex_file = *caller_compilation_unit_.GetDexFile();
       uint32_t dex_method_index = FindMethodIndexIn(
@@ -1442,6 +2148,7 @@ bool HInliner::TryBuildAndInline(HInvoke* invoke_instruction,
 
   LOG_SUCCESS() << method->PrettyMethod();
   MaybeRecordStat(stats_, MethodCompilationStat::kInlinedInvoke);
+  outermost_graph_->IncrementNumberOfInlinedInvokes();
   return true;
 }
 
@@ -1698,6 +2405,7 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
       invoke_type,
       graph_->IsDebuggable(),
       /* osr */ false,
+      /* baseline */ false,
       caller_instruction_counter);
   callee_graph->SetArtMethod(resolved_method);
 
@@ -1864,7 +2572,7 @@ bool HInliner::TryBuildAndInlineHelper(HInvoke* invoke_instruction,
       }
       HInstruction* current = instr_it.Current();
       if (current->NeedsEnvironment() &&
-          (total_number_of_dex_registers_ >= kMaximumNumberOfCumulatedDexRegisters)) {
+          (total_number_of_dex_registers_ >= GetMaximumNumberOfCumulatedDexRegisters())) {
         LOG_FAIL(stats_, MethodCompilationStat::kNotInlinedEnvironmentBudget)
             << "Method " << callee_dex_file.PrettyMethod(method_index)
             << " is not inlined because its caller has reached"
@@ -1952,7 +2660,7 @@ void HInliner::RunOptimizations(HGraph* callee_graph,
 
   // Bail early for pathological cases on the environment (for example recursive calls,
   // or too large environment).
-  if (total_number_of_dex_registers_ >= kMaximumNumberOfCumulatedDexRegisters) {
+  if (total_number_of_dex_registers_ >= GetMaximumNumberOfCumulatedDexRegisters()) {
     LOG_NOTE() << "Calls in " << callee_graph->GetArtMethod()->PrettyMethod()
              << " will not be inlined because the outer method has reached"
              << " its environment budget limit.";
@@ -57,6 +57,8 @@ class HInliner : public HOptimization {
         parent_(parent),
         depth_(depth),
         inlining_budget_(0),
+        // Calls in an inlined method are as hot as the call site they were inlined at.
+        call_site_hotness_(parent != nullptr ? parent->call_site_hotness_ : kCallSiteWarm),
         handles_(handles),
         inline_stats_(nullptr) {}
 
@@ -74,8 +76,42 @@ class HInliner : public HOptimization {
     kInlineCacheMissingTypes = 5
   };
 
+  // How often a call site of the outermost method runs compared to its other call sites,
+  // which decides how much of the inlining budget the call site can use.
+  enum CallSiteHotness {
+    kCallSiteCold = 0,  // Never ran according to the profile, only small methods are inlined.
+    kCallSiteWarm = 1,  // No profile data, or not frequent enough to be hot.
+    kCallSiteHot = 2    // Among the most frequent call sites, gets a larger budget.
+  };
+
+  // Compute the hotness of the call sites of the outermost method in `calls`, and order
+  // them hottest first so that they get the inlining budget before the colder ones.
+  // The order is left unchanged if there is no profile data for the call sites.
+  void SortCallSitesByHotness(/*inout*/std::vector<HInvoke*>* calls,
+                              /*out*/std::vector<CallSiteHotness>* hotness);
+
+  // Returns how many times `invoke` ran according to the inline caches in JIT mode, or
+  // to the hotness and inline cache weights of the profile in AOT mode. Returns
+  // kUnknownCallSiteFrequency if the profile doesn't cover the call site. `offline_profile`
+  // is the profile of the outermost method in AOT mode, or null.
+  uint32_t GetCallSiteFrequency(
+      HInvoke* invoke,
+      const ProfileCompilationInfo::OfflineProfileMethodInfo* offline_profile)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
   bool TryInline(HInvoke* invoke_instruction);
 
+  // Try to replace the invoke of a method handle held by a static final field, when the call
+  // site has the exact type of the handle, by an invoke of the target method, and then to inline
+  // it. Only for the handles of the static, direct, and virtual methods.
+  bool TryInlineMethodHandleInvoke(HInvokePolymorphic* invoke_instruction)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Try to replace a Field.get*() of a primitive instance field by a field get, when the Field is
+  // held by a static final field and the receiver is known to be an instance of its class.
+  bool TryInlineReflectiveFieldGet(HInvoke* invoke_instruction)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Try to inline `resolved_method` in place of `invoke_instruction`. `do_rtp` is whether
   // reference type propagation can run after the inlining. If the inlining is successful, this
   // method will replace and remove the `invoke_instruction`. If `cha_devirtualize` is true,
@@ -132,10 +168,15 @@ class HInliner : public HOptimization {
   // Try getting the inline cache from JIT code cache.
   // Return true if the inline cache was successfully allocated and the
   // invoke info was found in the profile info.
+  // The classes are sorted by decreasing number of times they were seen, which is
+  // stored in the matching elements of `counts`. `misses` is the number of receivers
+  // that did not fit in the inline cache.
   InlineCacheType GetInlineCacheJIT(
       HInvoke* invoke_instruction,
       StackHandleScope<1>* hs,
-      /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache)
+      /*out*/Handle<mirror::ObjectArray<mirror::Class>>* inline_cache,
+      /*out*/uint16_t* counts,
+      /*out*/uint16_t* misses)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Try getting the inline cache from AOT offline profile.
@@ -170,10 +211,35 @@ class HInliner : public HOptimization {
                                 Handle<mirror::ObjectArray<mirror::Class>> classes)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Try to inline targets of a polymorphic call.
+  // Try to inline targets of a polymorphic call. If `allow_deoptimization` is false,
+  // the original invoke is always kept for the receivers that are not in `classes`.
   bool TryInlinePolymorphicCall(HInvoke* invoke_instruction,
                                 ArtMethod* resolved_method,
-                                Handle<mirror::ObjectArray<mirror::Class>> classes)
+                                Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                bool allow_deoptimization)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Try to replace a monomorphic interface call whose target could not be inlined by a type
+  // guarded virtual call, keeping the interface call for the other receivers. The code in the
+  // graph will look like:
+  // if (receiver.getClass() == ic.GetMonomorphicType()) invoke-virtual
+  // else invoke-interface
+  bool TryDevirtualizeMonomorphicInterfaceCall(HInvoke* invoke_instruction,
+                                               ArtMethod* resolved_method,
+                                               Handle<mirror::ObjectArray<mirror::Class>> classes)
+    REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Try to inline the most frequent targets of a megamorphic call, if a few of them
+  // account for most of the calls. `classes` is sorted by decreasing `counts`. The
+  // code in the graph will look like:
+  // if (receiver.getClass() == classes[0]) ... // inlined code
+  // else if (receiver.getClass() == classes[1]) ... // inlined code
+  // else ... // original invoke
+  bool TryInlineMegamorphicCall(HInvoke* invoke_instruction,
+                                ArtMethod* resolved_method,
+                                Handle<mirror::ObjectArray<mirror::Class>> classes,
+                                const uint16_t* counts,
+                                uint16_t misses)
     REQUIRES_SHARED(Locks::mutator_lock_);
 
   bool TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
@@ -267,9 +333,13 @@ class HInliner : public HOptimization {
                                                 HInstruction* return_replacement,
                                                 HInstruction* invoke_instruction);
 
-  // Update the inlining budget based on `total_number_of_instructions_`.
+  // Update the inlining budget based on `total_number_of_instructions_` and
+  // `call_site_hotness_`.
   void UpdateInliningBudget();
 
+  // The limit on the dex registers accumulated while inlining at the current call site.
+  size_t GetMaximumNumberOfCumulatedDexRegisters() const;
+
   // Count the number of calls of `method` being inlined recursively.
   size_t CountRecursiveCallsOf(ArtMethod* method) const;
 
@@ -291,6 +361,9 @@ class HInliner : public HOptimization {
 
   // The budget left for inlining, in number of instructions.
   size_t inlining_budget_;
+
+  // The hotness of the call site of the outermost method being inlined.
+  CallSiteHotness call_site_hotness_;
   VariableSizedHandleScope* const handles_;
 
   // Used to record stats about optimizations on the inlined graph.
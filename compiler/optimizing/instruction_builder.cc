@@ -28,6 +28,7 @@
 #include "driver/dex_compilation_unit.h"
 #include "driver/compiler_options.h"
 #include "imtable-inl.h"
+#include "jit/profiling_info.h"
 #include "mirror/dex_cache.h"
 #include "oat_file.h"
 #include "optimizing_compiler_stats.h"
@@ -67,6 +68,8 @@ HInstructionBuilder::HInstructionBuilder(HGraph* graph,
       outer_compilation_unit_(outer_compilation_unit),
       quicken_info_(interpreter_metadata),
       compilation_stats_(compiler_stats),
+      profiling_info_(nullptr),
+      profile_branch_caches_(nullptr),
       local_allocator_(local_allocator),
       locals_for_(local_allocator->Adapter(kArenaAllocGraphBuilder)),
       current_block_(nullptr),
@@ -326,6 +329,29 @@ bool HInstructionBuilder::Build() {
     native_debug_info_locations = FindNativeDebugInfoLocations();
   }
 
+  if (outer_compilation_unit_ != nullptr &&
+      dex_compilation_unit_ == outer_compilation_unit_ &&
+      graph_->GetArtMethod() != nullptr &&
+      Runtime::Current()->UseJitCompilation()) {
+    ScopedObjectAccess soa(Thread::Current());
+    profiling_info_ = graph_->GetArtMethod()->GetProfilingInfo(kRuntimePointerSize);
+  }
+
+  if (outer_compilation_unit_ != nullptr &&
+      dex_compilation_unit_ == outer_compilation_unit_ &&
+      compiler_driver_ != nullptr &&
+      compiler_driver_->GetProfileCompilationInfo() != nullptr &&
+      Runtime::Current()->IsAotCompiler()) {
+    std::unique_ptr<ProfileCompilationInfo::OfflineProfileMethodInfo> offline_profile =
+        compiler_driver_->GetProfileCompilationInfo()->GetMethod(
+            dex_file_->GetLocation(),
+            dex_file_->GetLocationChecksum(),
+            dex_compilation_unit_->GetDexMethodIndex());
+    if (offline_profile != nullptr) {
+      profile_branch_caches_ = offline_profile->branch_caches;
+    }
+  }
+
   for (HBasicBlock* block : graph_->GetReversePostOrder()) {
     current_block_ = block;
     uint32_t block_dex_pc = current_block_->GetDexPc();
@@ -614,17 +640,32 @@ void HInstructionBuilder::If_22t(const Instruction& instruction, uint32_t dex_pc
   HInstruction* first = LoadLocal(instruction.VRegA(), DataType::Type::kInt32);
   HInstruction* second = LoadLocal(instruction.VRegB(), DataType::Type::kInt32);
   T* comparison = new (allocator_) T(first, second, dex_pc);
-  AppendInstruction(comparison);
-  AppendInstruction(new (allocator_) HIf(comparison, dex_pc));
-  current_block_ = nullptr;
+  BuildIf(comparison, dex_pc);
 }
 
 template<typename T>
 void HInstructionBuilder::If_21t(const Instruction& instruction, uint32_t dex_pc) {
   HInstruction* value = LoadLocal(instruction.VRegA(), DataType::Type::kInt32);
   T* comparison = new (allocator_) T(value, graph_->GetIntConstant(0, dex_pc), dex_pc);
+  BuildIf(comparison, dex_pc);
+}
+
+void HInstructionBuilder::BuildIf(HCondition* comparison, uint32_t dex_pc) {
   AppendInstruction(comparison);
-  AppendInstruction(new (allocator_) HIf(comparison, dex_pc));
+  HIf* if_instruction = new (allocator_) HIf(comparison, dex_pc);
+  if (profiling_info_ != nullptr) {
+    BranchCache* cache = profiling_info_->GetBranchCache(dex_pc);
+    if (cache != nullptr) {
+      // The true successor of the HIf is the target of the IF instruction.
+      if_instruction->SetBranchCounts(cache->GetTakenCount(), cache->GetNotTakenCount());
+    }
+  } else if (profile_branch_caches_ != nullptr) {
+    auto it = profile_branch_caches_->find(dex_pc);
+    if (it != profile_branch_caches_->end()) {
+      if_instruction->SetBranchCounts(it->second.taken, it->second.not_taken);
+    }
+  }
+  AppendInstruction(if_instruction);
   current_block_ = nullptr;
 }
 
@@ -1060,11 +1101,16 @@ bool HInstructionBuilder::BuildInvokePolymorphic(const Instruction& instruction
   DCHECK_EQ(1 + ArtMethod::NumArgRegisters(descriptor), number_of_vreg_arguments);
   DataType::Type return_type = DataType::FromShorty(descriptor[0]);
   size_t number_of_arguments = strlen(descriptor);
+  // The resolved method lets the intrinsics recognizer find the VarHandle accessors.
+  ArtMethod* resolved_method = ResolveMethod(method_idx, kVirtual);
   HInvoke* invoke = new (allocator_) HInvokePolymorphic(allocator_,
                                                         number_of_arguments,
                                                         return_type,
                                                         dex_pc,
-                                                        method_idx);
+                                                        method_idx,
+                                                        resolved_method,
+                                                        *dex_file_,
+                                                        proto_idx);
   return HandleInvoke(invoke,
                       number_of_vreg_arguments,
                       args,
@@ -1811,29 +1857,6 @@ void HInstructionBuilder::BuildFillWideArrayData(HInstruction* object,
   }
 }
 
-static TypeCheckKind ComputeTypeCheckKind(Handle<mirror::Class> cls)
-    REQUIRES_SHARED(Locks::mutator_lock_) {
-  if (cls == nullptr) {
-    return TypeCheckKind::kUnresolvedCheck;
-  } else if (cls->IsInterface()) {
-    return TypeCheckKind::kInterfaceCheck;
-  } else if (cls->IsArrayClass()) {
-    if (cls->GetComponentType()->IsObjectClass()) {
-      return TypeCheckKind::kArrayObjectCheck;
-    } else if (cls->CannotBeAssignedFromOtherTypes()) {
-      return TypeCheckKind::kExactCheck;
-    } else {
-      return TypeCheckKind::kArrayCheck;
-    }
-  } else if (cls->IsFinal()) {
-    return TypeCheckKind::kExactCheck;
-  } else if (cls->IsAbstract()) {
-    return TypeCheckKind::kAbstractClassCheck;
-  } else {
-    return TypeCheckKind::kClassHierarchyCheck;
-  }
-}
-
 void HInstructionBuilder::BuildLoadString(dex::StringIndex string_index, uint32_t dex_pc) {
   HLoadString* load_string =
       new (allocator_) HLoadString(graph_->GetCurrentMethod(), string_index, *dex_file_, dex_pc);
@@ -1917,16 +1940,27 @@ void HInstructionBuilder::BuildTypeCheck(const Instruction& instruction,
   HLoadClass* cls = BuildLoadClass(type_index, dex_pc);
 
   ScopedObjectAccess soa(Thread::Current());
-  TypeCheckKind check_kind = ComputeTypeCheckKind(cls->GetClass());
+  uint32_t bitstring_path_to_root = 0u;
+  uint32_t bitstring_mask = 0u;
+  TypeCheckKind check_kind = HSharpening::ComputeTypeCheckKind(cls->GetClass(),
+                                                               code_generator_,
+                                                               compiler_driver_,
+                                                               &bitstring_path_to_root,
+                                                               &bitstring_mask);
+  if (check_kind == TypeCheckKind::kBitstringCheck) {
+    MaybeRecordStat(compilation_stats_, MethodCompilationStat::kBitstringTypeCheck);
+  }
   if (instruction.Opcode() == Instruction::INSTANCE_OF) {
-    AppendInstruction(new (allocator_) HInstanceOf(object, cls, check_kind, dex_pc));
+    AppendInstruction(new (allocator_) HInstanceOf(
+        object, cls, check_kind, bitstring_path_to_root, bitstring_mask, dex_pc));
     UpdateLocal(destination, current_block_->GetLastInstruction());
   } else {
     DCHECK_EQ(instruction.Opcode(), Instruction::CHECK_CAST);
     // We emit a CheckCast followed by a BoundType. CheckCast is a statement
     // which may throw. If it succeeds BoundType sets the new type of `object`
     // for all subsequent uses.
-    AppendInstruction(new (allocator_) HCheckCast(object, cls, check_kind, dex_pc));
+    AppendInstruction(new (allocator_) HCheckCast(
+        object, cls, check_kind, bitstring_path_to_root, bitstring_mask, dex_pc));
     AppendInstruction(new (allocator_) HBoundType(object, dex_pc));
     UpdateLocal(reference, current_block_->GetLastInstruction());
   }
@@ -24,6 +24,7 @@
 #include "dex_file.h"
 #include "dex_file_types.h"
 #include "handle.h"
+#include "jit/profile_compilation_info.h"
 #include "nodes.h"
 #include "quicken_info.h"
 
@@ -38,6 +39,7 @@ class DexCompilationUnit;
 class HBasicBlockBuilder;
 class Instruction;
 class OptimizingCompilerStats;
+class ProfilingInfo;
 class SsaBuilder;
 class VariableSizedHandleScope;
 
@@ -128,6 +130,9 @@ class HInstructionBuilder : public ValueObject {
   template<typename T> void If_21t(const Instruction& instruction, uint32_t dex_pc);
   template<typename T> void If_22t(const Instruction& instruction, uint32_t dex_pc);
 
+  // Builds the HIf of the IF instruction at `dex_pc`, with its branch profile if any.
+  void BuildIf(HCondition* comparison, uint32_t dex_pc);
+
   void Conversion_12x(const Instruction& instruction,
                       DataType::Type input_type,
                       DataType::Type result_type,
@@ -333,6 +338,14 @@ class HInstructionBuilder : public ValueObject {
 
   OptimizingCompilerStats* const compilation_stats_;
 
+  // The profiling info of the method being JIT compiled, which the JIT keeps alive during
+  // the compilation. Null when compiling an inlined method or ahead of time.
+  ProfilingInfo* profiling_info_;
+
+  // The branch profile of the method being compiled ahead of time, owned by the profile of
+  // the compiler driver. Null when there is none.
+  const ProfileCompilationInfo::BranchCacheMap* profile_branch_caches_;
+
   ScopedArenaAllocator* const local_allocator_;
   ScopedArenaVector<ScopedArenaVector<HInstruction*>> locals_for_;
   HBasicBlock* current_block_;
@@ -16,6 +16,7 @@
 
 #include "instruction_simplifier.h"
 
+#include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "class_linker-inl.h"
 #include "data_type-inl.h"
@@ -24,6 +25,7 @@
 #include "mirror/class-inl.h"
 #include "scoped_thread_state_change-inl.h"
 #include "sharpening.h"
+#include "string_builder_append.h"
 
 namespace art {
 
@@ -119,6 +121,8 @@ class InstructionSimplifierVisitor : public HGraphDelegateVisitor {
   void SimplifyNPEOnArgN(HInvoke* invoke, size_t);
   void SimplifyReturnThis(HInvoke* invoke);
   void SimplifyAllocationIntrinsic(HInvoke* invoke);
+  void SimplifyUnboxing(HInvoke* invoke, Intrinsics box_intrinsic);
+  bool TryReplaceStringBuilderAppend(HInvoke* invoke);
   void SimplifyMemBarrier(HInvoke* invoke, MemBarrierKind barrier_kind);
 
   CodeGenerator* codegen_;
@@ -992,6 +996,7 @@ void InstructionSimplifierVisitor::VisitIf(HIf* instruction) {
     // Swap successors if input is negated.
     instruction->ReplaceInput(condition->InputAt(0), 0);
     instruction->GetBlock()->SwapSuccessors();
+    instruction->SwapBranchCounts();
     RecordSimplification();
   }
 }
@@ -2419,7 +2424,161 @@ void InstructionSimplifierVisitor::SimplifyAllocationIntrinsic(HInvoke* invoke)
       invoke->GetBlock()->RemoveInstruction(invoke);
       RecordSimplification();
     }
+  } else if (invoke->GetIntrinsic() == Intrinsics::kStringBuilderToString &&
+             TryReplaceStringBuilderAppend(invoke)) {
+    RecordSimplification();
+  }
+}
+
+// Replaces `new StringBuilder().append(s1)...append(sN).toString()`, where all the calls are in
+// the same block and the StringBuilder is not used otherwise, with a single HStringBuilderAppend
+// which allocates the result directly.
+bool InstructionSimplifierVisitor::TryReplaceStringBuilderAppend(HInvoke* invoke) {
+  DCHECK_EQ(invoke->GetIntrinsic(), Intrinsics::kStringBuilderToString);
+  InstructionSet isa = codegen_->GetInstructionSet();
+  if (isa != InstructionSet::kArm64 && isa != InstructionSet::kX86_64) {
+    return false;  // Only these have the StringBuilderAppend entrypoint.
+  }
+  // The StringBuilder disappears from the environments, which a debugger could see.
+  if (GetGraph()->IsDebuggable() || invoke->CanThrowIntoCatchBlock()) {
+    return false;
+  }
+  HBasicBlock* block = invoke->GetBlock();
+  HInstruction* sb = invoke->InputAt(0);
+  if (!sb->IsNewInstance() || sb->GetBlock() != block) {
+    return false;
+  }
+
+  // Check that the StringBuilder is only used by one constructor without arguments, its
+  // constructor fence, the appends (without uses, see SimplifyReturnThis) and this invoke.
+  size_t num_appends = 0u;
+  for (const HUseListNode<HInstruction*>& use : sb->GetUses()) {
+    HInstruction* user = use.GetUser();
+    if (user->GetBlock() != block) {
+      return false;
+    }
+    if (user == invoke || user->IsConstructorFence()) {
+      continue;
+    }
+    if (use.GetIndex() != 0u) {
+      return false;
+    }
+    if (user->IsInvokeStaticOrDirect()) {
+      ArtMethod* method = user->AsInvokeStaticOrDirect()->GetResolvedMethod();
+      if (method == nullptr ||
+          !method->IsConstructor() ||
+          user->AsInvokeStaticOrDirect()->GetNumberOfArguments() != 1u) {
+        return false;
+      }
+    } else if (user->IsInvokeVirtual() &&
+               user->AsInvokeVirtual()->GetIntrinsic() == Intrinsics::kStringBuilderAppend &&
+               !user->HasUses()) {
+      ++num_appends;
+    } else {
+      return false;
+    }
+  }
+  if (num_appends == 0u || num_appends > StringBuilderAppend::kMaxArgs) {
+    return false;
+  }
+  // The environment uses must all be removed with the StringBuilder, so they may only be in
+  // the calls on it.
+  for (const HUseListNode<HEnvironment*>& use : sb->GetEnvUses()) {
+    HInstruction* holder = use.GetUser()->GetHolder();
+    if (holder->GetBlock() != block || holder->InputCount() == 0u || holder->InputAt(0) != sb) {
+      return false;
+    }
+  }
+
+  // Collect the arguments in program order, after the constructor.
+  HInstruction* args[StringBuilderAppend::kMaxArgs];
+  bool seen_constructor = false;
+  size_t num_args = 0u;
+  uint32_t format = 0u;
+  for (HInstruction* current = sb->GetNext(); current != invoke; current = current->GetNext()) {
+    if (current->InputCount() == 0u || current->InputAt(0) != sb) {
+      continue;
+    }
+    if (current->IsInvokeStaticOrDirect()) {
+      seen_constructor = true;
+    } else if (current->IsInvokeVirtual()) {
+      if (!seen_constructor) {
+        return false;
+      }
+      DCHECK_LT(num_args, num_appends);
+      DCHECK_NE(current->InputAt(1), sb);
+      args[num_args] = current->InputAt(1);
+      format |= static_cast<uint32_t>(StringBuilderAppend::Argument::kString)
+          << (num_args * StringBuilderAppend::kBitsPerArg);
+      ++num_args;
+    }
   }
+  DCHECK_EQ(num_args, num_appends);
+
+  ArenaAllocator* allocator = GetGraph()->GetAllocator();
+  HIntConstant* format_constant = GetGraph()->GetIntConstant(static_cast<int32_t>(format));
+  HStringBuilderAppend* append = new (allocator) HStringBuilderAppend(
+      format_constant, num_args, allocator, invoke->GetDexPc());
+  for (size_t i = 0; i != num_args; ++i) {
+    append->SetArgumentAt(i, args[i]);
+  }
+  append->SetReferenceTypeInfo(invoke->GetReferenceTypeInfo());
+  block->InsertInstructionBefore(append, invoke);
+  DCHECK(!invoke->CanBeNull());
+  invoke->ReplaceWith(append);
+
+  // Copy the environment, without the StringBuilder.
+  for (HEnvironment* env = invoke->GetEnvironment(); env != nullptr; env = env->GetParent()) {
+    for (size_t i = 0, size = env->Size(); i != size; ++i) {
+      if (env->GetInstructionAt(i) == sb) {
+        env->RemoveAsUserOfInput(i);
+        env->SetRawEnvAt(i, /* instruction */ nullptr);
+      }
+    }
+  }
+  append->CopyEnvironmentFrom(invoke->GetEnvironment());
+  block->RemoveInstruction(invoke);
+
+  // Remove the constructor, the appends and the fence, then the StringBuilder.
+  while (sb->HasNonEnvironmentUses()) {
+    block->RemoveInstruction(sb->GetUses().front().GetUser());
+  }
+  DCHECK(!sb->HasEnvironmentUses());
+  block->RemoveInstruction(sb);
+  return true;
+}
+
+void InstructionSimplifierVisitor::SimplifyUnboxing(HInvoke* invoke, Intrinsics box_intrinsic) {
+  HInstruction* receiver = invoke->InputAt(0);
+  HInstruction* box = receiver->IsNullCheck() ? receiver->InputAt(0) : receiver;
+  if (box->IsInvoke() && box->AsInvoke()->GetIntrinsic() == box_intrinsic) {
+    // Unboxing the result of valueOf(), use the boxed value. The box is not null, so the null
+    // check is removed as well and the box is left to DCE if it has no other uses.
+    invoke->ReplaceWith(box->InputAt(0));
+    invoke->GetBlock()->RemoveInstruction(invoke);
+    if (receiver != box && !receiver->HasUses()) {
+      receiver->GetBlock()->RemoveInstruction(receiver);
+    }
+    RecordSimplification();
+    return;
+  }
+  // Otherwise read the final `value` field of the box, as the inlined method would.
+  ScopedObjectAccess soa(Thread::Current());
+  ArtMethod* method = invoke->GetResolvedMethod();
+  const char descriptor[] = { method->GetShorty()[0], '\0' };
+  ArtField* field = method->GetDeclaringClass()->FindDeclaredInstanceField("value", descriptor);
+  DCHECK(field != nullptr);
+  HInstanceFieldGet* value = new (GetGraph()->GetAllocator()) HInstanceFieldGet(
+      receiver,
+      field,
+      invoke->GetType(),
+      field->GetOffset(),
+      /* is_volatile */ false,
+      field->GetDexFieldIndex(),
+      field->GetDeclaringClass()->GetDexClassDefIndex(),
+      *field->GetDexFile(),
+      invoke->GetDexPc());
+  invoke->GetBlock()->ReplaceAndRemoveInstructionWith(invoke, value);
 }
 
 void InstructionSimplifierVisitor::SimplifyMemBarrier(HInvoke* invoke,
@@ -2489,6 +2648,18 @@ void InstructionSimplifierVisitor::VisitInvoke(HInvoke* instruction) {
     case Intrinsics::kStringBuilderToString:
       SimplifyAllocationIntrinsic(instruction);
       break;
+    case Intrinsics::kIntegerIntValue:
+      SimplifyUnboxing(instruction, Intrinsics::kIntegerValueOf);
+      break;
+    case Intrinsics::kLongLongValue:
+      SimplifyUnboxing(instruction, Intrinsics::kLongValueOf);
+      break;
+    case Intrinsics::kShortShortValue:
+      SimplifyUnboxing(instruction, Intrinsics::kShortValueOf);
+      break;
+    case Intrinsics::kCharacterCharValue:
+      SimplifyUnboxing(instruction, Intrinsics::kCharacterValueOf);
+      break;
     case Intrinsics::kUnsafeLoadFence:
       SimplifyMemBarrier(instruction, MemBarrierKind::kLoadAny);
       break;
@@ -23,6 +23,7 @@
 #include "driver/compiler_options.h"
 #include "invoke_type.h"
 #include "mirror/dex_cache-inl.h"
+#include "mirror/var_handle.h"
 #include "nodes.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
@@ -139,9 +140,11 @@ static bool CheckInvokeType(Intrinsics intrinsic, HInvoke* invoke)
       // Call might be devirtualized.
       return (invoke_type == kVirtual || invoke_type == kDirect || invoke_type == kInterface);
 
+    case kPolymorphic:
+      return invoke->IsInvokePolymorphic();
+
     case kSuper:
     case kInterface:
-    case kPolymorphic:
       return false;
   }
   LOG(FATAL) << "Unknown intrinsic invoke type: " << intrinsic_type;
@@ -159,13 +162,17 @@ bool IntrinsicsRecognizer::Recognize(HInvoke* invoke,
     return false;
   }
 
+  Intrinsics intrinsic = static_cast<Intrinsics>(art_method->GetIntrinsic());
+
   // TODO: b/65872996 The intent is that polymorphic signature methods should
-  // be compiler intrinsics. At present, they are only interpreter intrinsics.
-  if (art_method->IsPolymorphicSignature()) {
+  // be compiler intrinsics. At present, only the VarHandle accessors are, the
+  // MethodHandle invokes are only interpreter intrinsics.
+  if (art_method->IsPolymorphicSignature() &&
+      (intrinsic == Intrinsics::kMethodHandleInvokeExact ||
+       intrinsic == Intrinsics::kMethodHandleInvoke)) {
     return false;
   }
 
-  Intrinsics intrinsic = static_cast<Intrinsics>(art_method->GetIntrinsic());
   if (CheckInvokeType(intrinsic, invoke) == false) {
     *wrong_invoke_type = true;
     return false;
@@ -325,4 +332,100 @@ IntrinsicVisitor::IntegerValueOfInfo IntrinsicVisitor::ComputeIntegerValueOfInfo
   return info;
 }
 
+// Returns the access mode of the VarHandle accessor intrinsics lowered into direct accesses, the
+// number of values they take after the coordinates and the shorty of their return type, which is
+// 0 when they return the variable. Returns false for the other intrinsics.
+static bool GetVarHandleAccessMode(Intrinsics intrinsic,
+                                   /* out */ mirror::VarHandle::AccessMode* access_mode,
+                                   /* out */ size_t* number_of_values,
+                                   /* out */ char* return_type) {
+  using AccessMode = mirror::VarHandle::AccessMode;
+  switch (intrinsic) {
+#define VAR_HANDLE_ACCESS_MODE(Name, Values, ReturnType) \
+    case Intrinsics::kVarHandle ## Name:                 \
+      *access_mode = AccessMode::k ## Name;              \
+      *number_of_values = Values;                        \
+      *return_type = ReturnType;                         \
+      return true;
+    VAR_HANDLE_ACCESS_MODE(Get, 0u, 0)
+    VAR_HANDLE_ACCESS_MODE(GetOpaque, 0u, 0)
+    VAR_HANDLE_ACCESS_MODE(GetAcquire, 0u, 0)
+    VAR_HANDLE_ACCESS_MODE(GetVolatile, 0u, 0)
+    VAR_HANDLE_ACCESS_MODE(Set, 1u, 'V')
+    VAR_HANDLE_ACCESS_MODE(SetOpaque, 1u, 'V')
+    VAR_HANDLE_ACCESS_MODE(SetRelease, 1u, 'V')
+    VAR_HANDLE_ACCESS_MODE(SetVolatile, 1u, 'V')
+    VAR_HANDLE_ACCESS_MODE(CompareAndSet, 2u, 'Z')
+    VAR_HANDLE_ACCESS_MODE(GetAndAdd, 1u, 0)
+    VAR_HANDLE_ACCESS_MODE(GetAndAddAcquire, 1u, 0)
+    VAR_HANDLE_ACCESS_MODE(GetAndAddRelease, 1u, 0)
+#undef VAR_HANDLE_ACCESS_MODE
+    default:
+      return false;
+  }
+}
+
+bool IntrinsicVisitor::ComputeVarHandleAccessInfo(HInvoke* invoke,
+                                                  /* out */ VarHandleAccessInfo* info) {
+  if (!invoke->IsInvokePolymorphic()) {
+    return false;
+  }
+  mirror::VarHandle::AccessMode access_mode;
+  size_t number_of_values;
+  char expected_return_type;
+  if (!GetVarHandleAccessMode(
+          invoke->GetIntrinsic(), &access_mode, &number_of_values, &expected_return_type)) {
+    return false;
+  }
+
+  // The shorty of the call site, without the VarHandle: the coordinates, then the values.
+  HInvokePolymorphic* polymorphic = invoke->AsInvokePolymorphic();
+  const char* shorty = polymorphic->GetDexFile().GetShorty(polymorphic->GetProtoIndex());
+  const char return_type = shorty[0];
+  const char* parameters = shorty + 1;
+  size_t number_of_parameters = strlen(parameters);
+  if (number_of_parameters < number_of_values) {
+    return false;
+  }
+  size_t number_of_coordinates = number_of_parameters - number_of_values;
+  if (number_of_coordinates == 1u) {
+    // An instance field of the object.
+    if (parameters[0] != 'L') {
+      return false;
+    }
+  } else if (number_of_coordinates == 2u) {
+    // An element of the array, at the index.
+    if (parameters[0] != 'L' || parameters[1] != 'I') {
+      return false;
+    }
+  } else {
+    // Static fields, without coordinates, need a read barrier on their declaring class and an
+    // initialization check. Leave them, and the views of byte buffers, to the runtime.
+    return false;
+  }
+
+  // Only accessor types that match an int or long variable exactly are lowered, the others may
+  // need conversions or throw WrongMethodTypeException.
+  char var_type = (number_of_values == 0u) ? return_type : parameters[number_of_coordinates];
+  if (var_type != 'I' && var_type != 'J') {
+    return false;
+  }
+  for (size_t i = number_of_coordinates; i != number_of_parameters; ++i) {
+    if (parameters[i] != var_type) {
+      return false;
+    }
+  }
+  if (expected_return_type == 0) {
+    expected_return_type = var_type;
+  }
+  if (return_type != expected_return_type) {
+    return false;
+  }
+
+  info->var_type = DataType::FromShorty(var_type);
+  info->access_mode = static_cast<uint32_t>(access_mode);
+  info->number_of_coordinates = number_of_coordinates;
+  return true;
+}
+
 }  // namespace art
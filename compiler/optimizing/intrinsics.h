@@ -154,6 +154,28 @@ class IntrinsicVisitor : public ValueObject {
 
   static IntegerValueOfInfo ComputeIntegerValueOfInfo();
 
+  // The direct access that a VarHandle accessor intrinsic does for the accessor type of its
+  // call site. The VarHandle is the first argument, followed by the coordinates and the values.
+  struct VarHandleAccessInfo {
+    VarHandleAccessInfo()
+        : var_type(DataType::Type::kVoid),
+          access_mode(0u),
+          number_of_coordinates(0u) {}
+
+    // The type of the variable, kInt32 or kInt64.
+    DataType::Type var_type;
+    // The access mode, which is also its bit in VarHandle.accessModesBitMask.
+    uint32_t access_mode;
+    // 1 for an instance field of an object, 2 for an element of an array at an index.
+    size_t number_of_coordinates;
+  };
+
+  // Returns whether the VarHandle accessor intrinsic `invoke` can be lowered into a direct
+  // access, that is an int or long instance field or array element accessed with the exact
+  // type of the variable, and sets `info` if so. The generated code must still check at
+  // runtime that the VarHandle matches `info`, and fall back to the runtime call otherwise.
+  static bool ComputeVarHandleAccessInfo(HInvoke* invoke, /* out */ VarHandleAccessInfo* info);
+
  protected:
   IntrinsicVisitor() {}
 
@@ -291,37 +313,57 @@ UNREACHABLE_INTRINSIC(Arch, VarHandleLoadLoadFence)             \
 UNREACHABLE_INTRINSIC(Arch, VarHandleStoreStoreFence)           \
 UNREACHABLE_INTRINSIC(Arch, MethodHandleInvokeExact)            \
 UNREACHABLE_INTRINSIC(Arch, MethodHandleInvoke)                 \
-UNREACHABLE_INTRINSIC(Arch, VarHandleCompareAndExchange)        \
-UNREACHABLE_INTRINSIC(Arch, VarHandleCompareAndExchangeAcquire) \
-UNREACHABLE_INTRINSIC(Arch, VarHandleCompareAndExchangeRelease) \
-UNREACHABLE_INTRINSIC(Arch, VarHandleCompareAndSet)             \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGet)                       \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAcquire)                \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndAdd)                 \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndAddAcquire)          \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndAddRelease)          \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndBitwiseAnd)          \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndBitwiseAndAcquire)   \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndBitwiseAndRelease)   \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndBitwiseOr)           \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndBitwiseOrAcquire)    \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndBitwiseOrRelease)    \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndBitwiseXor)          \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndBitwiseXorAcquire)   \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndBitwiseXorRelease)   \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndSet)                 \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndSetAcquire)          \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetAndSetRelease)          \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetOpaque)                 \
-UNREACHABLE_INTRINSIC(Arch, VarHandleGetVolatile)               \
-UNREACHABLE_INTRINSIC(Arch, VarHandleSet)                       \
-UNREACHABLE_INTRINSIC(Arch, VarHandleSetOpaque)                 \
-UNREACHABLE_INTRINSIC(Arch, VarHandleSetRelease)                \
-UNREACHABLE_INTRINSIC(Arch, VarHandleSetVolatile)               \
-UNREACHABLE_INTRINSIC(Arch, VarHandleWeakCompareAndSet)         \
-UNREACHABLE_INTRINSIC(Arch, VarHandleWeakCompareAndSetAcquire)  \
-UNREACHABLE_INTRINSIC(Arch, VarHandleWeakCompareAndSetPlain)    \
-UNREACHABLE_INTRINSIC(Arch, VarHandleWeakCompareAndSetRelease)
+UNREACHABLE_INTRINSIC(Arch, IntegerIntValue)                    \
+UNREACHABLE_INTRINSIC(Arch, LongLongValue)                      \
+UNREACHABLE_INTRINSIC(Arch, ShortShortValue)                    \
+UNREACHABLE_INTRINSIC(Arch, CharacterCharValue)
+
+// Defines the boxing intrinsics other than Integer.valueOf(). They are only recognized for the
+// elision of box-unbox pairs, the inliner still inlines them.
+#define UNIMPLEMENTED_BOXING_INTRINSICS(Arch)   \
+UNIMPLEMENTED_INTRINSIC(Arch, LongValueOf)      \
+UNIMPLEMENTED_INTRINSIC(Arch, ShortValueOf)     \
+UNIMPLEMENTED_INTRINSIC(Arch, CharacterValueOf)
+
+// Defines the VarHandle accessor intrinsics that no architecture lowers yet. Their invokes
+// are HInvokePolymorphic, which only the ARM64 and X86-64 code generators dispatch to their
+// intrinsics code generator.
+#define UNIMPLEMENTED_VAR_HANDLE_INTRINSICS(Arch)                 \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleCompareAndExchange)        \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleCompareAndExchangeAcquire) \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleCompareAndExchangeRelease) \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndBitwiseAnd)          \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndBitwiseAndAcquire)   \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndBitwiseAndRelease)   \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndBitwiseOr)           \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndBitwiseOrAcquire)    \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndBitwiseOrRelease)    \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndBitwiseXor)          \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndBitwiseXorAcquire)   \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndBitwiseXorRelease)   \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndSet)                 \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndSetAcquire)          \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndSetRelease)          \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleWeakCompareAndSet)         \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleWeakCompareAndSetAcquire)  \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleWeakCompareAndSetPlain)    \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleWeakCompareAndSetRelease)
+
+// Defines the VarHandle accessor intrinsics lowered into direct accesses by the ARM64 and
+// X86-64 intrinsics code generators, for the other architectures.
+#define UNIMPLEMENTED_VAR_HANDLE_ACCESS_INTRINSICS(Arch) \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleCompareAndSet)    \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGet)              \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAcquire)       \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndAdd)        \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndAddAcquire) \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetAndAddRelease) \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetOpaque)        \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleGetVolatile)      \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleSet)              \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleSetOpaque)        \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleSetRelease)       \
+UNIMPLEMENTED_INTRINSIC(Arch, VarHandleSetVolatile)
 
 template <typename IntrinsicLocationsBuilder, typename Codegenerator>
 bool IsCallFreeIntrinsic(HInvoke* invoke, Codegenerator* codegen) {
@@ -17,6 +17,7 @@
 #include "intrinsics_arm64.h"
 
 #include "arch/arm64/instruction_set_features_arm64.h"
+#include "art_field.h"
 #include "art_method.h"
 #include "code_generator_arm64.h"
 #include "common_arm64.h"
@@ -28,6 +29,7 @@
 #include "mirror/object_array-inl.h"
 #include "mirror/reference.h"
 #include "mirror/string-inl.h"
+#include "mirror/var_handle.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
 #include "utils/arm64/assembler_arm64.h"
@@ -52,6 +54,7 @@ using helpers::LocationFrom;
 using helpers::OperandFrom;
 using helpers::RegisterFrom;
 using helpers::SRegisterFrom;
+using helpers::VRegisterFrom;
 using helpers::WRegisterFrom;
 using helpers::XRegisterFrom;
 using helpers::InputRegisterAt;
@@ -127,6 +130,9 @@ class IntrinsicSlowPathARM64 : public SlowPathCodeARM64 {
       if (invoke_->IsInvokeStaticOrDirect()) {
         codegen->GenerateStaticOrDirectCall(
             invoke_->AsInvokeStaticOrDirect(), LocationFrom(kArtMethodRegister), this);
+      } else if (invoke_->IsInvokePolymorphic()) {
+        codegen->GenerateInvokePolymorphicCall(
+            invoke_->AsInvokePolymorphic(), LocationFrom(kArtMethodRegister), this);
       } else {
         codegen->GenerateVirtualCall(
             invoke_->AsInvokeVirtual(), LocationFrom(kArtMethodRegister), this);
@@ -1286,6 +1292,508 @@ void IntrinsicCodeGeneratorARM64::VisitUnsafeCASObject(HInvoke* invoke) {
   GenCas(invoke, DataType::Type::kReference, codegen_);
 }
 
+static void CreateVarHandleLocations(ArenaAllocator* allocator, HInvoke* invoke) {
+  IntrinsicVisitor::VarHandleAccessInfo info;
+  if (!IntrinsicVisitor::ComputeVarHandleAccessInfo(invoke, &info)) {
+    // Leave the other accessor types to the runtime call.
+    return;
+  }
+
+  LocationSummary* locations =
+      new (allocator) LocationSummary(invoke, LocationSummary::kCallOnSlowPath, kIntrinsified);
+  for (size_t i = 0, e = invoke->GetNumberOfArguments(); i != e; ++i) {
+    locations->SetInAt(i, Location::RequiresRegister());
+  }
+  if (invoke->GetType() != DataType::Type::kVoid) {
+    // The atomics write the output while they still need the inputs.
+    locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+  }
+  // The address of the variable, and a temporary for the checks.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+}
+
+// Checks that the VarHandle of `invoke` supports the access described by `info` for the
+// coordinates, and jumps to the returned slow path, which makes the runtime call, if not.
+// Otherwise the address of the variable is left in the first temporary.
+static SlowPathCodeARM64* GenerateVarHandleChecks(
+    HInvoke* invoke,
+    CodeGeneratorARM64* codegen,
+    /* out */ IntrinsicVisitor::VarHandleAccessInfo* info) {
+  MacroAssembler* masm = codegen->GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+  bool success = IntrinsicVisitor::ComputeVarHandleAccessInfo(invoke, info);
+  DCHECK(success);
+
+  SlowPathCodeARM64* slow_path =
+      new (codegen->GetScopedAllocator()) IntrinsicSlowPathARM64(invoke);
+  codegen->AddSlowPath(slow_path);
+  vixl::aarch64::Label* slow_path_label = slow_path->GetEntryLabel();
+
+  Register varhandle = WRegisterFrom(locations->InAt(0));
+  Register object = WRegisterFrom(locations->InAt(1));
+  Register address = XRegisterFrom(locations->GetTemp(0));
+  Register var_type = WRegisterFrom(locations->GetTemp(1));
+  UseScratchRegisterScope temps(masm);
+  Register temp = temps.AcquireW();
+
+  // The runtime throws the NullPointerException.
+  __ Cbz(varhandle, slow_path_label);
+  __ Cbz(object, slow_path_label);
+
+  // The VarHandle must support the access mode.
+  __ Ldr(temp, HeapOperand(varhandle, mirror::VarHandle::AccessModesBitMaskOffset()));
+  __ Tbz(temp, info->access_mode, slow_path_label);
+
+  // The variable must have the type of the accessor. The primitive type of a class does not
+  // change if the class is moved, so we do not need a read barrier to compare it.
+  Primitive::Type primitive_type = (info->var_type == DataType::Type::kInt32)
+      ? Primitive::kPrimInt
+      : Primitive::kPrimLong;
+  __ Ldr(var_type, HeapOperand(varhandle, mirror::VarHandle::VarTypeOffset()));
+  codegen->GetAssembler()->MaybeUnpoisonHeapReference(var_type);
+  __ Ldrh(temp, HeapOperand(var_type, mirror::Class::PrimitiveTypeOffset()));
+  __ Cmp(temp, static_cast<uint16_t>(primitive_type));
+  __ B(slow_path_label, ne);
+
+  if (info->number_of_coordinates == 1u) {
+    // Only the VarHandles of instance fields have a single coordinate.
+    __ Ldr(temp, HeapOperand(varhandle, mirror::VarHandle::CoordinateType1Offset()));
+    __ Cbnz(temp, slow_path_label);
+  }
+
+  // The object must have the class of the coordinate. We compare the references without read
+  // barriers: the runtime handles the subclasses, and a class being moved by the GC.
+  __ Ldr(temp, HeapOperand(varhandle, mirror::VarHandle::CoordinateType0Offset()));
+  __ Ldr(address.W(), HeapOperand(object, mirror::Object::ClassOffset()));
+  __ Cmp(temp, address.W());
+  __ B(slow_path_label, ne);
+
+  if (info->number_of_coordinates == 2u) {
+    // The views of byte arrays also have an array coordinate, but a variable of another type
+    // than the component type.
+    codegen->GetAssembler()->MaybeUnpoisonHeapReference(temp);
+    __ Ldr(temp, HeapOperand(temp, mirror::Class::ComponentTypeOffset()));
+    codegen->GetAssembler()->MaybeUnpoisonHeapReference(temp);
+    __ Cmp(temp, var_type);
+    __ B(slow_path_label, ne);
+
+    // The runtime throws the ArrayIndexOutOfBoundsException.
+    Register index = WRegisterFrom(locations->InAt(2));
+    __ Ldr(temp, HeapOperand(object, mirror::Array::LengthOffset()));
+    __ Cmp(index, temp);
+    __ B(slow_path_label, hs);
+
+    size_t component_size = DataType::Size(info->var_type);
+    __ Add(address, object.X(), mirror::Array::DataOffset(component_size).Uint32Value());
+    __ Add(address, address, Operand(index, UXTW, DataType::SizeShift(info->var_type)));
+  } else {
+    // The offset of the field is in the ArtField of the FieldVarHandle.
+    __ Ldr(address,
+           MemOperand(varhandle.X(), mirror::FieldVarHandle::ArtFieldOffset().Int32Value()));
+    __ Ldr(temp, MemOperand(address, ArtField::OffsetOffset().Int32Value()));
+    __ Add(address, object.X(), Operand(temp, UXTW));
+  }
+
+  return slow_path;
+}
+
+static void GenerateVarHandleGet(HInvoke* invoke,
+                                 CodeGeneratorARM64* codegen,
+                                 bool use_load_acquire) {
+  IntrinsicVisitor::VarHandleAccessInfo info;
+  SlowPathCodeARM64* slow_path = GenerateVarHandleChecks(invoke, codegen, &info);
+  LocationSummary* locations = invoke->GetLocations();
+  MemOperand mem_op(XRegisterFrom(locations->GetTemp(0)));
+  Register out = RegisterFrom(locations->Out(), info.var_type);
+
+  if (use_load_acquire) {
+    codegen->LoadAcquire(invoke, out, mem_op, /* needs_null_check */ false);
+  } else {
+    codegen->Load(info.var_type, out, mem_op);
+  }
+  codegen->GetVIXLAssembler()->Bind(slow_path->GetExitLabel());
+}
+
+static void GenerateVarHandleSet(HInvoke* invoke,
+                                 CodeGeneratorARM64* codegen,
+                                 bool use_store_release) {
+  IntrinsicVisitor::VarHandleAccessInfo info;
+  SlowPathCodeARM64* slow_path = GenerateVarHandleChecks(invoke, codegen, &info);
+  LocationSummary* locations = invoke->GetLocations();
+  MemOperand mem_op(XRegisterFrom(locations->GetTemp(0)));
+  Register value = RegisterFrom(locations->InAt(invoke->GetNumberOfArguments() - 1u),
+                                info.var_type);
+
+  if (use_store_release) {
+    codegen->StoreRelease(invoke, info.var_type, value, mem_op, /* needs_null_check */ false);
+  } else {
+    codegen->Store(info.var_type, value, mem_op);
+  }
+  codegen->GetVIXLAssembler()->Bind(slow_path->GetExitLabel());
+}
+
+static void GenerateVarHandleCompareAndSet(HInvoke* invoke, CodeGeneratorARM64* codegen) {
+  MacroAssembler* masm = codegen->GetVIXLAssembler();
+  IntrinsicVisitor::VarHandleAccessInfo info;
+  SlowPathCodeARM64* slow_path = GenerateVarHandleChecks(invoke, codegen, &info);
+  LocationSummary* locations = invoke->GetLocations();
+  size_t number_of_arguments = invoke->GetNumberOfArguments();
+  Register address = XRegisterFrom(locations->GetTemp(0));
+  Register expected = RegisterFrom(locations->InAt(number_of_arguments - 2u), info.var_type);
+  Register value = RegisterFrom(locations->InAt(number_of_arguments - 1u), info.var_type);
+  Register out = WRegisterFrom(locations->Out());
+
+  UseScratchRegisterScope temps(masm);
+  Register tmp_value = temps.AcquireSameSizeAs(value);
+
+  // do {
+  //   tmp_value = [address] - expected;
+  // } while (tmp_value == 0 && failure([address] <- value));
+  // out = tmp_value == 0;
+  vixl::aarch64::Label loop_head, exit_loop;
+  __ Bind(&loop_head);
+  __ Ldaxr(tmp_value, MemOperand(address));
+  __ Cmp(tmp_value, expected);
+  __ B(&exit_loop, ne);
+  __ Stlxr(tmp_value.W(), value, MemOperand(address));
+  __ Cbnz(tmp_value.W(), &loop_head);
+  __ Bind(&exit_loop);
+  __ Cset(out, eq);
+  __ Bind(slow_path->GetExitLabel());
+}
+
+static void GenerateVarHandleGetAndAdd(HInvoke* invoke,
+                                       CodeGeneratorARM64* codegen,
+                                       bool use_load_acquire,
+                                       bool use_store_release) {
+  MacroAssembler* masm = codegen->GetVIXLAssembler();
+  IntrinsicVisitor::VarHandleAccessInfo info;
+  SlowPathCodeARM64* slow_path = GenerateVarHandleChecks(invoke, codegen, &info);
+  LocationSummary* locations = invoke->GetLocations();
+  MemOperand mem_op(XRegisterFrom(locations->GetTemp(0)));
+  Register value = RegisterFrom(locations->InAt(invoke->GetNumberOfArguments() - 1u),
+                                info.var_type);
+  Register out = RegisterFrom(locations->Out(), info.var_type);
+
+  UseScratchRegisterScope temps(masm);
+  Register new_value = temps.AcquireSameSizeAs(value);
+  Register status = temps.AcquireW();
+
+  vixl::aarch64::Label loop_head;
+  __ Bind(&loop_head);
+  if (use_load_acquire) {
+    __ Ldaxr(out, mem_op);
+  } else {
+    __ Ldxr(out, mem_op);
+  }
+  __ Add(new_value, out, value);
+  if (use_store_release) {
+    __ Stlxr(status, new_value, mem_op);
+  } else {
+    __ Stxr(status, new_value, mem_op);
+  }
+  __ Cbnz(status, &loop_head);
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void IntrinsicLocationsBuilderARM64::VisitVarHandleGet(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderARM64::VisitVarHandleGetOpaque(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderARM64::VisitVarHandleGetAcquire(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderARM64::VisitVarHandleGetVolatile(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderARM64::VisitVarHandleSet(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderARM64::VisitVarHandleSetOpaque(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderARM64::VisitVarHandleSetRelease(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderARM64::VisitVarHandleSetVolatile(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderARM64::VisitVarHandleCompareAndSet(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderARM64::VisitVarHandleGetAndAdd(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderARM64::VisitVarHandleGetAndAddAcquire(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderARM64::VisitVarHandleGetAndAddRelease(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitVarHandleGet(HInvoke* invoke) {
+  GenerateVarHandleGet(invoke, codegen_, /* use_load_acquire */ false);
+}
+void IntrinsicCodeGeneratorARM64::VisitVarHandleGetOpaque(HInvoke* invoke) {
+  GenerateVarHandleGet(invoke, codegen_, /* use_load_acquire */ false);
+}
+void IntrinsicCodeGeneratorARM64::VisitVarHandleGetAcquire(HInvoke* invoke) {
+  GenerateVarHandleGet(invoke, codegen_, /* use_load_acquire */ true);
+}
+void IntrinsicCodeGeneratorARM64::VisitVarHandleGetVolatile(HInvoke* invoke) {
+  GenerateVarHandleGet(invoke, codegen_, /* use_load_acquire */ true);
+}
+void IntrinsicCodeGeneratorARM64::VisitVarHandleSet(HInvoke* invoke) {
+  GenerateVarHandleSet(invoke, codegen_, /* use_store_release */ false);
+}
+void IntrinsicCodeGeneratorARM64::VisitVarHandleSetOpaque(HInvoke* invoke) {
+  GenerateVarHandleSet(invoke, codegen_, /* use_store_release */ false);
+}
+void IntrinsicCodeGeneratorARM64::VisitVarHandleSetRelease(HInvoke* invoke) {
+  GenerateVarHandleSet(invoke, codegen_, /* use_store_release */ true);
+}
+void IntrinsicCodeGeneratorARM64::VisitVarHandleSetVolatile(HInvoke* invoke) {
+  GenerateVarHandleSet(invoke, codegen_, /* use_store_release */ true);
+}
+void IntrinsicCodeGeneratorARM64::VisitVarHandleCompareAndSet(HInvoke* invoke) {
+  GenerateVarHandleCompareAndSet(invoke, codegen_);
+}
+void IntrinsicCodeGeneratorARM64::VisitVarHandleGetAndAdd(HInvoke* invoke) {
+  GenerateVarHandleGetAndAdd(
+      invoke, codegen_, /* use_load_acquire */ true, /* use_store_release */ true);
+}
+void IntrinsicCodeGeneratorARM64::VisitVarHandleGetAndAddAcquire(HInvoke* invoke) {
+  GenerateVarHandleGetAndAdd(
+      invoke, codegen_, /* use_load_acquire */ true, /* use_store_release */ false);
+}
+void IntrinsicCodeGeneratorARM64::VisitVarHandleGetAndAddRelease(HInvoke* invoke) {
+  GenerateVarHandleGetAndAdd(
+      invoke, codegen_, /* use_load_acquire */ false, /* use_store_release */ true);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitArraysFillByte(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kCallOnSlowPath, kIntrinsified);
+  // fill(byte[] a, byte val).
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // The address of the bytes left to fill and the 16 copies of the value.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+}
+
+void IntrinsicCodeGeneratorARM64::VisitArraysFillByte(HInvoke* invoke) {
+  MacroAssembler* masm = GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  Register array = WRegisterFrom(locations->InAt(0));
+  Register value = WRegisterFrom(locations->InAt(1));
+  Register address = XRegisterFrom(locations->GetTemp(0));
+  FPRegister values = VRegisterFrom(locations->GetTemp(1));
+  const int32_t length_offset = mirror::Array::LengthOffset().Int32Value();
+  const int32_t data_offset = mirror::Array::DataOffset(sizeof(int8_t)).Int32Value();
+
+  UseScratchRegisterScope temps(masm);
+  Register length = temps.AcquireW();
+
+  SlowPathCodeARM64* slow_path =
+      new (codegen_->GetScopedAllocator()) IntrinsicSlowPathARM64(invoke);
+  codegen_->AddSlowPath(slow_path);
+  if (invoke->InputAt(0)->CanBeNull()) {
+    // The original method throws the NullPointerException.
+    __ Cbz(array, slow_path->GetEntryLabel());
+  }
+
+  vixl::aarch64::Label loop, tail, tail_loop;
+  __ Ldr(length, MemOperand(array.X(), length_offset));
+  __ Add(address, array.X(), data_offset);
+  __ Dup(values.V16B(), value);
+
+  // Store 16 bytes at a time while there are that many left.
+  __ Bind(&loop);
+  __ Subs(length, length, 16);
+  __ B(&tail, lt);
+  __ Str(values.Q(), MemOperand(address, 16, PostIndex));
+  __ B(&loop);
+
+  // Store the remaining bytes one at a time.
+  __ Bind(&tail);
+  __ Adds(length, length, 16);
+  __ B(slow_path->GetExitLabel(), eq);
+  __ Bind(&tail_loop);
+  __ Strb(value, MemOperand(address, 1, PostIndex));
+  __ Subs(length, length, 1);
+  __ B(&tail_loop, ne);
+
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void IntrinsicLocationsBuilderARM64::VisitArraysEqualsByte(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kNoCall, kIntrinsified);
+  // equals(byte[] a, byte[] a2).
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // The addresses of the bytes left to compare, and three of the four registers
+  // for the 16 bytes compared in one iteration, the output being the fourth.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitArraysEqualsByte(HInvoke* invoke) {
+  MacroAssembler* masm = GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  Register array = WRegisterFrom(locations->InAt(0));
+  Register array2 = WRegisterFrom(locations->InAt(1));
+  Register address = XRegisterFrom(locations->GetTemp(0));
+  Register address2 = XRegisterFrom(locations->GetTemp(1));
+  Register temp = XRegisterFrom(locations->GetTemp(2));
+  Register temp2 = XRegisterFrom(locations->GetTemp(3));
+  Register temp3 = XRegisterFrom(locations->GetTemp(4));
+  Register out = XRegisterFrom(locations->Out());
+  const int32_t length_offset = mirror::Array::LengthOffset().Int32Value();
+  const int32_t data_offset = mirror::Array::DataOffset(sizeof(int8_t)).Int32Value();
+
+  UseScratchRegisterScope temps(masm);
+  Register length = temps.AcquireW();
+
+  vixl::aarch64::Label loop, tail, tail_loop, end, return_true, return_false;
+
+  // Arrays are equal if they are the same reference, including both null.
+  __ Cmp(array, array2);
+  __ B(&return_true, eq);
+  if (invoke->InputAt(0)->CanBeNull()) {
+    __ Cbz(array, &return_false);
+  }
+  if (invoke->InputAt(1)->CanBeNull()) {
+    __ Cbz(array2, &return_false);
+  }
+  __ Ldr(length, MemOperand(array.X(), length_offset));
+  __ Ldr(temp.W(), MemOperand(array2.X(), length_offset));
+  __ Cmp(length, temp.W());
+  __ B(&return_false, ne);
+  __ Add(address, array.X(), data_offset);
+  __ Add(address2, array2.X(), data_offset);
+
+  // Compare 16 bytes at a time while there are that many left. Unlike strings, the arrays are
+  // not padded to a multiple of 8 bytes after their data, so the loads cannot go any further.
+  __ Bind(&loop);
+  __ Subs(length, length, 16);
+  __ B(&tail, lt);
+  __ Ldp(out, temp, MemOperand(address, 16, PostIndex));
+  __ Ldp(temp2, temp3, MemOperand(address2, 16, PostIndex));
+  __ Cmp(out, temp2);
+  __ Ccmp(temp, temp3, NoFlag, eq);
+  __ B(&return_false, ne);
+  __ B(&loop);
+
+  // Compare the remaining bytes one at a time.
+  __ Bind(&tail);
+  __ Adds(length, length, 16);
+  __ B(&return_true, eq);
+  __ Bind(&tail_loop);
+  __ Ldrb(out.W(), MemOperand(address, 1, PostIndex));
+  __ Ldrb(temp.W(), MemOperand(address2, 1, PostIndex));
+  __ Cmp(out.W(), temp.W());
+  __ B(&return_false, ne);
+  __ Subs(length, length, 1);
+  __ B(&tail_loop, ne);
+
+  __ Bind(&return_true);
+  __ Mov(out, 1);
+  __ B(&end);
+
+  __ Bind(&return_false);
+  __ Mov(out, 0);
+  __ Bind(&end);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitArraysHashCodeByte(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kNoCall, kIntrinsified);
+  // hashCode(byte[] a).
+  locations->SetInAt(0, Location::RequiresRegister());
+  // The address of the bytes left to hash, the powers of 31 and a hashed byte.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitArraysHashCodeByte(HInvoke* invoke) {
+  MacroAssembler* masm = GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  Register array = WRegisterFrom(locations->InAt(0));
+  Register address = XRegisterFrom(locations->GetTemp(0));
+  Register pow2 = WRegisterFrom(locations->GetTemp(1));
+  Register pow3 = WRegisterFrom(locations->GetTemp(2));
+  Register pow4 = WRegisterFrom(locations->GetTemp(3));
+  Register temp = WRegisterFrom(locations->GetTemp(4));
+  Register out = WRegisterFrom(locations->Out());
+  const int32_t length_offset = mirror::Array::LengthOffset().Int32Value();
+  const int32_t data_offset = mirror::Array::DataOffset(sizeof(int8_t)).Int32Value();
+
+  UseScratchRegisterScope temps(masm);
+  Register length = temps.AcquireW();
+
+  vixl::aarch64::Label loop, tail, tail_loop, end;
+
+  // The hash code of null is 0.
+  if (invoke->InputAt(0)->CanBeNull()) {
+    __ Mov(out, 0);
+    __ Cbz(array, &end);
+  }
+  __ Mov(out, 1);
+  __ Ldr(length, MemOperand(array.X(), length_offset));
+  __ Add(address, array.X(), data_offset);
+  __ Mov(pow2, 31 * 31);
+  __ Mov(pow3, 31 * 31 * 31);
+  __ Mov(pow4, 31 * 31 * 31 * 31);
+
+  // Hash 4 bytes at a time while there are that many left, as
+  //   out = 31^4 * out + 31^3 * a[i] + 31^2 * a[i + 1] + 31 * a[i + 2] + a[i + 3],
+  // which breaks the dependency of each multiplication on the previous one.
+  __ Bind(&loop);
+  __ Subs(length, length, 4);
+  __ B(&tail, lt);
+  __ Mul(out, out, pow4);
+  __ Ldrsb(temp, MemOperand(address));
+  __ Madd(out, temp, pow3, out);
+  __ Ldrsb(temp, MemOperand(address, 1));
+  __ Madd(out, temp, pow2, out);
+  __ Ldrsb(temp, MemOperand(address, 2));
+  __ Add(out, out, Operand(temp, LSL, 5));
+  __ Sub(out, out, temp);
+  __ Ldrsb(temp, MemOperand(address, 3));
+  __ Add(out, out, temp);
+  __ Add(address, address, 4);
+  __ B(&loop);
+
+  // Hash the remaining bytes one at a time, as out = 31 * out + a[i].
+  __ Bind(&tail);
+  __ Adds(length, length, 4);
+  __ B(&end, eq);
+  __ Bind(&tail_loop);
+  __ Ldrsb(temp, MemOperand(address, 1, PostIndex));
+  __ Sub(temp, temp, out);
+  __ Add(out, temp, Operand(out, LSL, 5));
+  __ Subs(length, length, 1);
+  __ B(&tail_loop, ne);
+
+  __ Bind(&end);
+}
+
 void IntrinsicLocationsBuilderARM64::VisitStringCompareTo(HInvoke* invoke) {
   LocationSummary* locations =
       new (allocator_) LocationSummary(invoke,
@@ -1545,6 +2053,15 @@ void IntrinsicLocationsBuilderARM64::VisitStringEquals(HInvoke* invoke) {
   if (const_string == nullptr || const_string_length > (is_compressed ? 8u : 4u)) {
     locations->AddTemp(Location::RequiresRegister());
   }
+  if (const_string == nullptr ||
+      const_string_length > (is_compressed ? kShortConstStringEqualsCutoffInBytes
+                                           : kShortConstStringEqualsCutoffInBytes / 2u)) {
+    // The generic loop compares 16 bytes at a time, it needs two pointers and two more
+    // registers for the loaded data.
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+  }
 
   // TODO: If the String.equals() is used only for an immediately following HIf, we can
   // mark it as emitted-at-use-site and emit branches directly to the appropriate blocks.
@@ -1669,29 +2186,45 @@ void IntrinsicCodeGeneratorARM64::VisitStringEquals(HInvoke* invoke) {
                   "Expecting 0=compressed, 1=uncompressed");
     __ Cbz(temp, &return_true);
 
+    // Calculate the number of bytes to compare (not chars). This could in theory exceed
+    // INT32_MAX, so treat temp as unsigned, and use it as a 64-bit register from now on.
     if (mirror::kUseStringCompression) {
-      // For string compression, calculate the number of bytes to compare (not chars).
-      // This could in theory exceed INT32_MAX, so treat temp as unsigned.
       __ And(temp1, temp, Operand(1));    // Extract compression flag.
       __ Lsr(temp, temp, 1u);             // Extract length.
       __ Lsl(temp, temp, temp1);          // Calculate number of bytes to compare.
+    } else {
+      __ Lsl(temp, temp, 1u);
     }
+    Register remaining = temp.X();
 
-    // Store offset of string value in preparation for comparison loop
-    __ Mov(temp1, value_offset);
-
-    temp1 = temp1.X();
+    Register str_ptr = temp1.X();
     Register temp2 = XRegisterFrom(locations->GetTemp(0));
-    // Loop to compare strings 8 bytes at a time starting at the front of the string.
+    Register arg_ptr = XRegisterFrom(locations->GetTemp(1));
+    Register temp3 = XRegisterFrom(locations->GetTemp(2));
+    Register temp4 = XRegisterFrom(locations->GetTemp(3));
+    vixl::aarch64::Label compare_last_word;
+    __ Add(str_ptr, str.X(), value_offset);
+    __ Add(arg_ptr, arg.X(), value_offset);
+    // Loop to compare strings 16 bytes at a time starting at the front of the string, while
+    // more than 8 bytes are left. The last load pair may read up to 8 bytes of zero padding.
     __ Bind(&loop);
-    __ Ldr(out, MemOperand(str.X(), temp1));
-    __ Ldr(temp2, MemOperand(arg.X(), temp1));
-    __ Add(temp1, temp1, Operand(sizeof(uint64_t)));
+    __ Cmp(remaining, sizeof(uint64_t));
+    __ B(&compare_last_word, ls);
+    __ Ldp(out, temp2, MemOperand(str_ptr, 2u * sizeof(uint64_t), PostIndex));
+    __ Ldp(temp3, temp4, MemOperand(arg_ptr, 2u * sizeof(uint64_t), PostIndex));
+    __ Cmp(out, temp3);
+    __ Ccmp(temp2, temp4, NoFlag, eq);
+    __ B(&return_false, ne);
+    __ Subs(remaining, remaining, 2u * sizeof(uint64_t));
+    __ B(&loop, gt);
+    __ B(&return_true);
+
+    // Compare the last 1 to 8 bytes.
+    __ Bind(&compare_last_word);
+    __ Ldr(out, MemOperand(str_ptr));
+    __ Ldr(temp2, MemOperand(arg_ptr));
     __ Cmp(out, temp2);
     __ B(&return_false, ne);
-    // With string compression, we have compared 8 bytes, otherwise 4 chars.
-    __ Sub(temp, temp, Operand(mirror::kUseStringCompression ? 8 : 4), SetFlags);
-    __ B(&loop, hi);
   }
 
   // Return true and exit the function.
@@ -3056,6 +3589,8 @@ UNIMPLEMENTED_INTRINSIC(ARM64, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(ARM64, UnsafeGetAndSetObject)
 
 UNREACHABLE_INTRINSICS(ARM64)
+UNIMPLEMENTED_BOXING_INTRINSICS(ARM64)
+UNIMPLEMENTED_VAR_HANDLE_INTRINSICS(ARM64)
 
 #undef __
 
@@ -3335,6 +3335,10 @@ UNIMPLEMENTED_INTRINSIC(ARMVIXL, StringBuilderAppend);
 UNIMPLEMENTED_INTRINSIC(ARMVIXL, StringBuilderLength);
 UNIMPLEMENTED_INTRINSIC(ARMVIXL, StringBuilderToString);
 
+UNIMPLEMENTED_INTRINSIC(ARMVIXL, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(ARMVIXL, ArraysEqualsByte)
+UNIMPLEMENTED_INTRINSIC(ARMVIXL, ArraysHashCodeByte)
+
 // 1.8.
 UNIMPLEMENTED_INTRINSIC(ARMVIXL, UnsafeGetAndAddInt)
 UNIMPLEMENTED_INTRINSIC(ARMVIXL, UnsafeGetAndAddLong)
@@ -3343,6 +3347,9 @@ UNIMPLEMENTED_INTRINSIC(ARMVIXL, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(ARMVIXL, UnsafeGetAndSetObject)
 
 UNREACHABLE_INTRINSICS(ARMVIXL)
+UNIMPLEMENTED_BOXING_INTRINSICS(ARMVIXL)
+UNIMPLEMENTED_VAR_HANDLE_INTRINSICS(ARMVIXL)
+UNIMPLEMENTED_VAR_HANDLE_ACCESS_INTRINSICS(ARMVIXL)
 
 #undef __
 
@@ -3252,6 +3252,10 @@ UNIMPLEMENTED_INTRINSIC(MIPS, StringBuilderAppend);
 UNIMPLEMENTED_INTRINSIC(MIPS, StringBuilderLength);
 UNIMPLEMENTED_INTRINSIC(MIPS, StringBuilderToString);
 
+UNIMPLEMENTED_INTRINSIC(MIPS, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(MIPS, ArraysEqualsByte)
+UNIMPLEMENTED_INTRINSIC(MIPS, ArraysHashCodeByte)
+
 // 1.8.
 UNIMPLEMENTED_INTRINSIC(MIPS, UnsafeGetAndAddInt)
 UNIMPLEMENTED_INTRINSIC(MIPS, UnsafeGetAndAddLong)
@@ -3260,6 +3264,9 @@ UNIMPLEMENTED_INTRINSIC(MIPS, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(MIPS, UnsafeGetAndSetObject)
 
 UNREACHABLE_INTRINSICS(MIPS)
+UNIMPLEMENTED_BOXING_INTRINSICS(MIPS)
+UNIMPLEMENTED_VAR_HANDLE_INTRINSICS(MIPS)
+UNIMPLEMENTED_VAR_HANDLE_ACCESS_INTRINSICS(MIPS)
 
 #undef __
 
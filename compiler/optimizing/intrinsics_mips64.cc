@@ -2625,6 +2625,10 @@ UNIMPLEMENTED_INTRINSIC(MIPS64, StringBuilderAppend);
 UNIMPLEMENTED_INTRINSIC(MIPS64, StringBuilderLength);
 UNIMPLEMENTED_INTRINSIC(MIPS64, StringBuilderToString);
 
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysEqualsByte)
+UNIMPLEMENTED_INTRINSIC(MIPS64, ArraysHashCodeByte)
+
 // 1.8.
 UNIMPLEMENTED_INTRINSIC(MIPS64, UnsafeGetAndAddInt)
 UNIMPLEMENTED_INTRINSIC(MIPS64, UnsafeGetAndAddLong)
@@ -2633,6 +2637,9 @@ UNIMPLEMENTED_INTRINSIC(MIPS64, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(MIPS64, UnsafeGetAndSetObject)
 
 UNREACHABLE_INTRINSICS(MIPS64)
+UNIMPLEMENTED_BOXING_INTRINSICS(MIPS64)
+UNIMPLEMENTED_VAR_HANDLE_INTRINSICS(MIPS64)
+UNIMPLEMENTED_VAR_HANDLE_ACCESS_INTRINSICS(MIPS64)
 
 #undef __
 
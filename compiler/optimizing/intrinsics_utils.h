@@ -57,6 +57,8 @@ class IntrinsicSlowPath : public SlowPathCode {
 
     if (invoke_->IsInvokeStaticOrDirect()) {
       codegen->GenerateStaticOrDirectCall(invoke_->AsInvokeStaticOrDirect(), method_loc, this);
+    } else if (invoke_->IsInvokePolymorphic()) {
+      codegen->GenerateInvokePolymorphicCall(invoke_->AsInvokePolymorphic(), method_loc, this);
     } else {
       codegen->GenerateVirtualCall(invoke_->AsInvokeVirtual(), method_loc, this);
     }
@@ -3370,6 +3370,10 @@ UNIMPLEMENTED_INTRINSIC(X86, StringBuilderAppend);
 UNIMPLEMENTED_INTRINSIC(X86, StringBuilderLength);
 UNIMPLEMENTED_INTRINSIC(X86, StringBuilderToString);
 
+UNIMPLEMENTED_INTRINSIC(X86, ArraysFillByte)
+UNIMPLEMENTED_INTRINSIC(X86, ArraysEqualsByte)
+UNIMPLEMENTED_INTRINSIC(X86, ArraysHashCodeByte)
+
 // 1.8.
 UNIMPLEMENTED_INTRINSIC(X86, UnsafeGetAndAddInt)
 UNIMPLEMENTED_INTRINSIC(X86, UnsafeGetAndAddLong)
@@ -3378,6 +3382,9 @@ UNIMPLEMENTED_INTRINSIC(X86, UnsafeGetAndSetLong)
 UNIMPLEMENTED_INTRINSIC(X86, UnsafeGetAndSetObject)
 
 UNREACHABLE_INTRINSICS(X86)
+UNIMPLEMENTED_BOXING_INTRINSICS(X86)
+UNIMPLEMENTED_VAR_HANDLE_INTRINSICS(X86)
+UNIMPLEMENTED_VAR_HANDLE_ACCESS_INTRINSICS(X86)
 
 #undef __
 
@@ -19,6 +19,7 @@
 #include <limits>
 
 #include "arch/x86_64/instruction_set_features_x86_64.h"
+#include "art_field.h"
 #include "art_method.h"
 #include "base/bit_utils.h"
 #include "code_generator_x86_64.h"
@@ -31,6 +32,7 @@
 #include "mirror/object_array-inl.h"
 #include "mirror/reference.h"
 #include "mirror/string.h"
+#include "mirror/var_handle.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-current-inl.h"
 #include "utils/x86_64/assembler_x86_64.h"
@@ -1493,6 +1495,225 @@ void IntrinsicCodeGeneratorX86_64::VisitSystemArrayCopy(HInvoke* invoke) {
   __ Bind(intrinsic_slow_path->GetExitLabel());
 }
 
+void IntrinsicLocationsBuilderX86_64::VisitArraysFillByte(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kCallOnSlowPath, kIntrinsified);
+  // fill(byte[] a, byte val).
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // The number of bytes left to fill, their offset and the 16 copies of the value.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysFillByte(HInvoke* invoke) {
+  X86_64Assembler* assembler = GetAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  CpuRegister array = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister value = locations->InAt(1).AsRegister<CpuRegister>();
+  CpuRegister length = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister offset = locations->GetTemp(1).AsRegister<CpuRegister>();
+  XmmRegister values = locations->GetTemp(2).AsFpuRegister<XmmRegister>();
+  const uint32_t length_offset = mirror::Array::LengthOffset().Uint32Value();
+  const uint32_t data_offset = mirror::Array::DataOffset(sizeof(int8_t)).Uint32Value();
+
+  SlowPathCode* slow_path = new (codegen_->GetScopedAllocator()) IntrinsicSlowPathX86_64(invoke);
+  codegen_->AddSlowPath(slow_path);
+  if (invoke->InputAt(0)->CanBeNull()) {
+    // The original method throws the NullPointerException.
+    __ testl(array, array);
+    __ j(kEqual, slow_path->GetEntryLabel());
+  }
+
+  NearLabel loop, tail_loop;
+  __ movl(length, Address(array, length_offset));
+  __ xorl(offset, offset);
+  __ movd(values, value, /* is64bit */ false);
+  __ punpcklbw(values, values);
+  __ punpcklwd(values, values);
+  __ pshufd(values, values, Immediate(0));
+
+  // Store 16 bytes at a time while there are that many left.
+  __ Bind(&loop);
+  __ cmpl(length, Immediate(16));
+  __ j(kBelow, &tail_loop);
+  __ movdqu(Address(array, offset, TIMES_1, data_offset), values);
+  __ addl(offset, Immediate(16));
+  __ subl(length, Immediate(16));
+  __ jmp(&loop);
+
+  // Store the remaining bytes one at a time.
+  __ Bind(&tail_loop);
+  __ testl(length, length);
+  __ j(kEqual, slow_path->GetExitLabel());
+  __ movb(Address(array, offset, TIMES_1, data_offset), value);
+  __ addl(offset, Immediate(1));
+  __ subl(length, Immediate(1));
+  __ jmp(&tail_loop);
+
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysEqualsByte(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kNoCall, kIntrinsified);
+  // equals(byte[] a, byte[] a2).
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  // The number of bytes left to compare, the compared bytes or their mask of equal bytes,
+  // and the 16 bytes of each array compared in one iteration.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  // The output holds the offset of the compared bytes until the result is known.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysEqualsByte(HInvoke* invoke) {
+  X86_64Assembler* assembler = GetAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  CpuRegister array = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister array2 = locations->InAt(1).AsRegister<CpuRegister>();
+  CpuRegister length = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister temp = locations->GetTemp(1).AsRegister<CpuRegister>();
+  CpuRegister temp2 = locations->GetTemp(2).AsRegister<CpuRegister>();
+  XmmRegister bytes = locations->GetTemp(3).AsFpuRegister<XmmRegister>();
+  XmmRegister bytes2 = locations->GetTemp(4).AsFpuRegister<XmmRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+  const uint32_t length_offset = mirror::Array::LengthOffset().Uint32Value();
+  const uint32_t data_offset = mirror::Array::DataOffset(sizeof(int8_t)).Uint32Value();
+
+  NearLabel end, loop, tail_loop, return_true, return_false;
+
+  // Arrays are equal if they are the same reference, including both null.
+  __ cmpl(array, array2);
+  __ j(kEqual, &return_true);
+  if (invoke->InputAt(0)->CanBeNull()) {
+    __ testl(array, array);
+    __ j(kEqual, &return_false);
+  }
+  if (invoke->InputAt(1)->CanBeNull()) {
+    __ testl(array2, array2);
+    __ j(kEqual, &return_false);
+  }
+  __ movl(length, Address(array, length_offset));
+  __ cmpl(length, Address(array2, length_offset));
+  __ j(kNotEqual, &return_false);
+  __ xorl(out, out);
+
+  // Compare 16 bytes at a time while there are that many left. Unlike strings, the arrays are
+  // not padded to a multiple of 8 bytes after their data, so the loads cannot go any further.
+  __ Bind(&loop);
+  __ cmpl(length, Immediate(16));
+  __ j(kBelow, &tail_loop);
+  __ movdqu(bytes, Address(array, out, TIMES_1, data_offset));
+  __ movdqu(bytes2, Address(array2, out, TIMES_1, data_offset));
+  __ pcmpeqb(bytes, bytes2);
+  __ pmovmskb(temp, bytes);
+  __ cmpl(temp, Immediate(0xffff));
+  __ j(kNotEqual, &return_false);
+  __ addl(out, Immediate(16));
+  __ subl(length, Immediate(16));
+  __ jmp(&loop);
+
+  // Compare the remaining bytes one at a time.
+  __ Bind(&tail_loop);
+  __ testl(length, length);
+  __ j(kEqual, &return_true);
+  __ movzxb(temp, Address(array, out, TIMES_1, data_offset));
+  __ movzxb(temp2, Address(array2, out, TIMES_1, data_offset));
+  __ cmpl(temp, temp2);
+  __ j(kNotEqual, &return_false);
+  __ addl(out, Immediate(1));
+  __ subl(length, Immediate(1));
+  __ jmp(&tail_loop);
+
+  __ Bind(&return_true);
+  __ movl(out, Immediate(1));
+  __ jmp(&end);
+
+  __ Bind(&return_false);
+  __ xorl(out, out);
+  __ Bind(&end);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitArraysHashCodeByte(HInvoke* invoke) {
+  LocationSummary* locations =
+      new (allocator_) LocationSummary(invoke, LocationSummary::kNoCall, kIntrinsified);
+  // hashCode(byte[] a).
+  locations->SetInAt(0, Location::RequiresRegister());
+  // The number of bytes left to hash, their offset and a product.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitArraysHashCodeByte(HInvoke* invoke) {
+  X86_64Assembler* assembler = GetAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  CpuRegister array = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister length = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister offset = locations->GetTemp(1).AsRegister<CpuRegister>();
+  CpuRegister temp = locations->GetTemp(2).AsRegister<CpuRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+  const uint32_t length_offset = mirror::Array::LengthOffset().Uint32Value();
+  const uint32_t data_offset = mirror::Array::DataOffset(sizeof(int8_t)).Uint32Value();
+
+  NearLabel end, loop, tail_loop;
+
+  // The hash code of null is 0.
+  __ xorl(out, out);
+  if (invoke->InputAt(0)->CanBeNull()) {
+    __ testl(array, array);
+    __ j(kEqual, &end);
+  }
+  __ movl(out, Immediate(1));
+  __ movl(length, Address(array, length_offset));
+  __ xorl(offset, offset);
+
+  // Hash 4 bytes at a time while there are that many left, as
+  //   result = 31^4 * result + 31^3 * a[i] + 31^2 * a[i + 1] + 31 * a[i + 2] + a[i + 3],
+  // where the multiplications of the elements do not depend on each other.
+  __ Bind(&loop);
+  __ cmpl(length, Immediate(4));
+  __ j(kBelow, &tail_loop);
+  __ imull(out, out, Immediate(31 * 31 * 31 * 31));
+  __ movsxb(temp, Address(array, offset, TIMES_1, data_offset));
+  __ imull(temp, temp, Immediate(31 * 31 * 31));
+  __ addl(out, temp);
+  __ movsxb(temp, Address(array, offset, TIMES_1, data_offset + 1));
+  __ imull(temp, temp, Immediate(31 * 31));
+  __ addl(out, temp);
+  __ movsxb(temp, Address(array, offset, TIMES_1, data_offset + 2));
+  __ imull(temp, temp, Immediate(31));
+  __ addl(out, temp);
+  __ movsxb(temp, Address(array, offset, TIMES_1, data_offset + 3));
+  __ addl(out, temp);
+  __ addl(offset, Immediate(4));
+  __ subl(length, Immediate(4));
+  __ jmp(&loop);
+
+  // Hash the remaining bytes one at a time.
+  __ Bind(&tail_loop);
+  __ testl(length, length);
+  __ j(kEqual, &end);
+  __ imull(out, out, Immediate(31));
+  __ movsxb(temp, Address(array, offset, TIMES_1, data_offset));
+  __ addl(out, temp);
+  __ addl(offset, Immediate(1));
+  __ subl(length, Immediate(1));
+  __ jmp(&tail_loop);
+
+  __ Bind(&end);
+}
+
 void IntrinsicLocationsBuilderX86_64::VisitStringCompareTo(HInvoke* invoke) {
   LocationSummary* locations = new (allocator_) LocationSummary(
       invoke, LocationSummary::kCallOnMainAndSlowPath, kIntrinsified);
@@ -1532,12 +1753,16 @@ void IntrinsicLocationsBuilderX86_64::VisitStringEquals(HInvoke* invoke) {
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RequiresRegister());
 
-  // Request temporary registers, RCX and RDI needed for repe_cmpsq instruction.
+  // The count, then the number of 8-byte words left to compare, in RCX for jrcxz,
+  // and the mask of equal bytes.
   locations->AddTemp(Location::RegisterLocation(RCX));
-  locations->AddTemp(Location::RegisterLocation(RDI));
+  locations->AddTemp(Location::RequiresRegister());
+  // The 16 bytes of each string compared in one iteration.
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
 
-  // Set output, RSI needed for repe_cmpsq instruction anyways.
-  locations->SetOut(Location::RegisterLocation(RSI), Location::kOutputOverlap);
+  // The output holds the offset of the compared bytes until the result is known.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
 }
 
 void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
@@ -1546,11 +1771,14 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
 
   CpuRegister str = locations->InAt(0).AsRegister<CpuRegister>();
   CpuRegister arg = locations->InAt(1).AsRegister<CpuRegister>();
-  CpuRegister rcx = locations->GetTemp(0).AsRegister<CpuRegister>();
-  CpuRegister rdi = locations->GetTemp(1).AsRegister<CpuRegister>();
-  CpuRegister rsi = locations->Out().AsRegister<CpuRegister>();
+  CpuRegister count = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister mask = locations->GetTemp(1).AsRegister<CpuRegister>();
+  XmmRegister str_bytes = locations->GetTemp(2).AsFpuRegister<XmmRegister>();
+  XmmRegister arg_bytes = locations->GetTemp(3).AsFpuRegister<XmmRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+  DCHECK_EQ(count.AsRegister(), RCX);
 
-  NearLabel end, return_true, return_false;
+  NearLabel end, loop, compare_last_word, return_true, return_false;
 
   // Get offsets of count, value, and class fields within a string object.
   const uint32_t count_offset = mirror::String::CountOffset().Uint32Value();
@@ -1572,8 +1800,8 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
     // All string objects must have the same type since String cannot be subclassed.
     // Receiver must be a string object, so its class field is equal to all strings' class fields.
     // If the argument is a string object, its class field must be equal to receiver's class field.
-    __ movl(rcx, Address(str, class_offset));
-    __ cmpl(rcx, Address(arg, class_offset));
+    __ movl(count, Address(str, class_offset));
+    __ cmpl(count, Address(arg, class_offset));
     __ j(kNotEqual, &return_false);
   }
 
@@ -1582,11 +1810,11 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
   __ j(kEqual, &return_true);
 
   // Load length and compression flag of receiver string.
-  __ movl(rcx, Address(str, count_offset));
+  __ movl(count, Address(str, count_offset));
   // Check if lengths and compressiond flags are equal, return false if they're not.
   // Two identical strings will always have same compression style since
   // compression style is decided on alloc.
-  __ cmpl(rcx, Address(arg, count_offset));
+  __ cmpl(count, Address(arg, count_offset));
   __ j(kNotEqual, &return_false);
   // Return true if both strings are empty. Even with string compression `count == 0` means empty.
   static_assert(static_cast<uint32_t>(mirror::StringCompressionFlag::kCompressed) == 0u,
@@ -1597,41 +1825,56 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
     NearLabel string_uncompressed;
     // Extract length and differentiate between both compressed or both uncompressed.
     // Different compression style is cut above.
-    __ shrl(rcx, Immediate(1));
+    __ shrl(count, Immediate(1));
     __ j(kCarrySet, &string_uncompressed);
     // Divide string length by 2, rounding up, and continue as if uncompressed.
     // Merge clearing the compression flag with +1 for rounding.
-    __ addl(rcx, Immediate(1));
-    __ shrl(rcx, Immediate(1));
+    __ addl(count, Immediate(1));
+    __ shrl(count, Immediate(1));
     __ Bind(&string_uncompressed);
   }
-  // Load starting addresses of string values into RSI/RDI as required for repe_cmpsq instruction.
-  __ leal(rsi, Address(str, value_offset));
-  __ leal(rdi, Address(arg, value_offset));
 
   // Divide string length by 4 and adjust for lengths not divisible by 4.
-  __ addl(rcx, Immediate(3));
-  __ shrl(rcx, Immediate(2));
+  __ addl(count, Immediate(3));
+  __ shrl(count, Immediate(2));
 
   // Assertions that must hold in order to compare strings 4 characters (uncompressed)
   // or 8 characters (compressed) at a time.
   DCHECK_ALIGNED(value_offset, 8);
   static_assert(IsAligned<8>(kObjectAlignment), "String is not zero padded");
 
-  // Loop to compare strings four characters at a time starting at the beginning of the string.
-  __ repe_cmpsq();
-  // If strings are not equal, zero flag will be cleared.
+  // Loop to compare strings 16 bytes at a time starting at the beginning of the string,
+  // while at least two 8-byte words are left. The unaligned loads stay within the padding.
+  __ xorl(out, out);
+  __ Bind(&loop);
+  __ cmpl(count, Immediate(1));
+  __ j(kEqual, &compare_last_word);
+  __ movdqu(str_bytes, Address(str, out, TIMES_1, value_offset));
+  __ movdqu(arg_bytes, Address(arg, out, TIMES_1, value_offset));
+  __ pcmpeqb(str_bytes, arg_bytes);
+  __ pmovmskb(mask, str_bytes);
+  __ cmpl(mask, Immediate(0xffff));
+  __ j(kNotEqual, &return_false);
+  __ addl(out, Immediate(2 * sizeof(uint64_t)));
+  __ subl(count, Immediate(2));
+  __ j(kNotEqual, &loop);
+  __ jmp(&return_true);
+
+  // Compare the last 8-byte word of strings with an odd number of them.
+  __ Bind(&compare_last_word);
+  __ movq(mask, Address(str, out, TIMES_1, value_offset));
+  __ cmpq(mask, Address(arg, out, TIMES_1, value_offset));
   __ j(kNotEqual, &return_false);
 
   // Return true and exit the function.
   // If loop does not result in returning false, we return true.
   __ Bind(&return_true);
-  __ movl(rsi, Immediate(1));
+  __ movl(out, Immediate(1));
   __ jmp(&end);
 
   // Return false and exit the function.
   __ Bind(&return_false);
-  __ xorl(rsi, rsi);
+  __ xorl(out, out);
   __ Bind(&end);
 }
 
@@ -2521,6 +2764,420 @@ void IntrinsicCodeGeneratorX86_64::VisitUnsafeCASObject(HInvoke* invoke) {
   GenCAS(DataType::Type::kReference, invoke, codegen_);
 }
 
+static void CreateIntIntIntIntToInt(ArenaAllocator* allocator, HInvoke* invoke) {
+  bool can_call = kEmitCompilerReadBarrier &&
+      kUseBakerReadBarrier &&
+      (invoke->GetIntrinsic() == Intrinsics::kUnsafeGetAndSetObject);
+  LocationSummary* locations =
+      new (allocator) LocationSummary(invoke,
+                                      can_call
+                                          ? LocationSummary::kCallOnSlowPath
+                                          : LocationSummary::kNoCall,
+                                      kIntrinsified);
+  locations->SetInAt(0, Location::NoLocation());        // Unused receiver.
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->SetInAt(2, Location::RequiresRegister());
+  locations->SetInAt(3, Location::RequiresRegister());
+  // The output receives a copy of the new value, which LOCK XADD or XCHG swaps with the old
+  // value; it must not clobber the address before that.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+  if (invoke->GetType() == DataType::Type::kReference) {
+    // Need temporary registers for card-marking, and possibly for
+    // (Baker) read barrier.
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+  }
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitUnsafeGetAndAddInt(HInvoke* invoke) {
+  CreateIntIntIntIntToInt(allocator_, invoke);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitUnsafeGetAndAddLong(HInvoke* invoke) {
+  CreateIntIntIntIntToInt(allocator_, invoke);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitUnsafeGetAndSetInt(HInvoke* invoke) {
+  CreateIntIntIntIntToInt(allocator_, invoke);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitUnsafeGetAndSetLong(HInvoke* invoke) {
+  CreateIntIntIntIntToInt(allocator_, invoke);
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitUnsafeGetAndSetObject(HInvoke* invoke) {
+  // The only read barrier implementation supporting the
+  // UnsafeGetAndSetObject intrinsic is the Baker-style read barriers.
+  if (kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+    return;
+  }
+
+  CreateIntIntIntIntToInt(allocator_, invoke);
+}
+
+static void GenUnsafeGetAndUpdate(HInvoke* invoke,
+                                  DataType::Type type,
+                                  CodeGeneratorX86_64* codegen,
+                                  bool is_add) {
+  X86_64Assembler* assembler = down_cast<X86_64Assembler*>(codegen->GetAssembler());
+  LocationSummary* locations = invoke->GetLocations();
+
+  CpuRegister base = locations->InAt(1).AsRegister<CpuRegister>();
+  CpuRegister offset = locations->InAt(2).AsRegister<CpuRegister>();
+  CpuRegister value = locations->InAt(3).AsRegister<CpuRegister>();
+  Location out_loc = locations->Out();
+  CpuRegister out = out_loc.AsRegister<CpuRegister>();
+  // The address of the field within the holding object.
+  Address field_addr(base, offset, ScaleFactor::TIMES_1, 0);
+
+  // LOCK XADD and XCHG (which is implicitly locked) have full barrier semantics, and we
+  // don't need scheduling barriers at this time.
+  if (type == DataType::Type::kReference) {
+    DCHECK(!is_add);
+    // The only read barrier implementation supporting the
+    // UnsafeGetAndSetObject intrinsic is the Baker-style read barriers.
+    DCHECK(!kEmitCompilerReadBarrier || kUseBakerReadBarrier);
+
+    CpuRegister temp1 = locations->GetTemp(0).AsRegister<CpuRegister>();
+    CpuRegister temp2 = locations->GetTemp(1).AsRegister<CpuRegister>();
+
+    // Mark card for object assuming new value is stored.
+    bool value_can_be_null = true;  // TODO: Worth finding out this information?
+    codegen->MarkGCCard(temp1, temp2, base, value, value_can_be_null);
+
+    if (kEmitCompilerReadBarrier && kUseBakerReadBarrier) {
+      // Make sure the reference stored in the field is a to-space one, so that
+      // the old value returned by the exchange is one too.
+      codegen->GenerateReferenceLoadWithBakerReadBarrier(
+          invoke,
+          out_loc,  // Unused, used only as a "temporary" within the read barrier.
+          base,
+          field_addr,
+          /* needs_null_check */ false,
+          /* always_update_field */ true,
+          &temp1,
+          &temp2);
+    }
+
+    // Swap a copy of the new value, so that `value` is not poisoned.
+    __ movl(out, value);
+    __ MaybePoisonHeapReference(out);
+    __ xchgl(out, field_addr);
+    __ MaybeUnpoisonHeapReference(out);
+  } else if (type == DataType::Type::kInt32) {
+    __ movl(out, value);
+    if (is_add) {
+      __ LockXaddl(field_addr, out);
+    } else {
+      __ xchgl(out, field_addr);
+    }
+  } else {
+    DCHECK_EQ(type, DataType::Type::kInt64);
+    __ movq(out, value);
+    if (is_add) {
+      __ LockXaddq(field_addr, out);
+    } else {
+      __ xchgq(out, field_addr);
+    }
+  }
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitUnsafeGetAndAddInt(HInvoke* invoke) {
+  GenUnsafeGetAndUpdate(invoke, DataType::Type::kInt32, codegen_, /* is_add */ true);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitUnsafeGetAndAddLong(HInvoke* invoke) {
+  GenUnsafeGetAndUpdate(invoke, DataType::Type::kInt64, codegen_, /* is_add */ true);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitUnsafeGetAndSetInt(HInvoke* invoke) {
+  GenUnsafeGetAndUpdate(invoke, DataType::Type::kInt32, codegen_, /* is_add */ false);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitUnsafeGetAndSetLong(HInvoke* invoke) {
+  GenUnsafeGetAndUpdate(invoke, DataType::Type::kInt64, codegen_, /* is_add */ false);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitUnsafeGetAndSetObject(HInvoke* invoke) {
+  GenUnsafeGetAndUpdate(invoke, DataType::Type::kReference, codegen_, /* is_add */ false);
+}
+
+static void CreateVarHandleLocations(ArenaAllocator* allocator, HInvoke* invoke) {
+  IntrinsicVisitor::VarHandleAccessInfo info;
+  if (!IntrinsicVisitor::ComputeVarHandleAccessInfo(invoke, &info)) {
+    // Leave the other accessor types to the runtime call.
+    return;
+  }
+
+  LocationSummary* locations =
+      new (allocator) LocationSummary(invoke, LocationSummary::kCallOnSlowPath, kIntrinsified);
+  size_t number_of_arguments = invoke->GetNumberOfArguments();
+  for (size_t i = 0; i != number_of_arguments; ++i) {
+    locations->SetInAt(i, Location::RequiresRegister());
+  }
+  if (invoke->GetIntrinsic() == Intrinsics::kVarHandleCompareAndSet) {
+    // The expected value must be in EAX/RAX (required by the CMPXCHG instruction).
+    locations->SetInAt(number_of_arguments - 2u, Location::RegisterLocation(RAX));
+  }
+  if (invoke->GetType() != DataType::Type::kVoid) {
+    // The output is written while the inputs are still needed.
+    locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+  }
+  // The offset of a field, and a temporary for the checks.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+}
+
+// Checks that the VarHandle of `invoke` supports the access described by `info` for the
+// coordinates, and jumps to the returned slow path, which makes the runtime call, if not.
+// Otherwise returns in `address` the address of the variable.
+static SlowPathCode* GenerateVarHandleChecks(
+    HInvoke* invoke,
+    CodeGeneratorX86_64* codegen,
+    /* out */ IntrinsicVisitor::VarHandleAccessInfo* info,
+    /* out */ Address* address) {
+  X86_64Assembler* assembler = codegen->GetAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+  bool success = IntrinsicVisitor::ComputeVarHandleAccessInfo(invoke, info);
+  DCHECK(success);
+
+  SlowPathCode* slow_path = new (codegen->GetScopedAllocator()) IntrinsicSlowPathX86_64(invoke);
+  codegen->AddSlowPath(slow_path);
+  Label* slow_path_entry = slow_path->GetEntryLabel();
+
+  CpuRegister varhandle = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister object = locations->InAt(1).AsRegister<CpuRegister>();
+  CpuRegister temp = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister var_type = locations->GetTemp(1).AsRegister<CpuRegister>();
+
+  // The runtime throws the NullPointerException.
+  __ testl(varhandle, varhandle);
+  __ j(kEqual, slow_path_entry);
+  __ testl(object, object);
+  __ j(kEqual, slow_path_entry);
+
+  // The VarHandle must support the access mode.
+  __ testl(Address(varhandle, mirror::VarHandle::AccessModesBitMaskOffset().Int32Value()),
+           Immediate(1 << info->access_mode));
+  __ j(kZero, slow_path_entry);
+
+  // The variable must have the type of the accessor. The primitive type of a class does not
+  // change if the class is moved, so we do not need a read barrier to compare it.
+  Primitive::Type primitive_type = (info->var_type == DataType::Type::kInt32)
+      ? Primitive::kPrimInt
+      : Primitive::kPrimLong;
+  __ movl(var_type, Address(varhandle, mirror::VarHandle::VarTypeOffset().Int32Value()));
+  __ MaybeUnpoisonHeapReference(var_type);
+  __ cmpw(Address(var_type, mirror::Class::PrimitiveTypeOffset().Int32Value()),
+          Immediate(primitive_type));
+  __ j(kNotEqual, slow_path_entry);
+
+  if (info->number_of_coordinates == 1u) {
+    // Only the VarHandles of instance fields have a single coordinate.
+    __ cmpl(Address(varhandle, mirror::VarHandle::CoordinateType1Offset().Int32Value()),
+            Immediate(0));
+    __ j(kNotEqual, slow_path_entry);
+  }
+
+  // The object must have the class of the coordinate. We compare the references without read
+  // barriers: the runtime handles the subclasses, and a class being moved by the GC.
+  __ movl(temp, Address(varhandle, mirror::VarHandle::CoordinateType0Offset().Int32Value()));
+  __ cmpl(temp, Address(object, mirror::Object::ClassOffset().Int32Value()));
+  __ j(kNotEqual, slow_path_entry);
+
+  if (info->number_of_coordinates == 2u) {
+    // The views of byte arrays also have an array coordinate, but a variable of another type
+    // than the component type.
+    __ MaybeUnpoisonHeapReference(temp);
+    __ movl(temp, Address(temp, mirror::Class::ComponentTypeOffset().Int32Value()));
+    __ MaybeUnpoisonHeapReference(temp);
+    __ cmpl(temp, var_type);
+    __ j(kNotEqual, slow_path_entry);
+
+    // The runtime throws the ArrayIndexOutOfBoundsException.
+    Location index = locations->InAt(2);
+    __ cmpl(index.AsRegister<CpuRegister>(),
+            Address(object, mirror::Array::LengthOffset().Int32Value()));
+    __ j(kAboveEqual, slow_path_entry);
+
+    size_t component_size = DataType::Size(info->var_type);
+    *address = CodeGeneratorX86_64::ArrayAddress(
+        object,
+        index,
+        static_cast<ScaleFactor>(DataType::SizeShift(info->var_type)),
+        mirror::Array::DataOffset(component_size).Uint32Value());
+  } else {
+    // The offset of the field is in the ArtField of the FieldVarHandle.
+    __ movq(temp, Address(varhandle, mirror::FieldVarHandle::ArtFieldOffset().Int32Value()));
+    __ movl(temp, Address(temp, ArtField::OffsetOffset().Int32Value()));
+    *address = Address(object, temp, TIMES_1, 0);
+  }
+
+  return slow_path;
+}
+
+static void GenerateVarHandleGet(HInvoke* invoke, CodeGeneratorX86_64* codegen) {
+  X86_64Assembler* assembler = codegen->GetAssembler();
+  IntrinsicVisitor::VarHandleAccessInfo info;
+  Address address(CpuRegister(RSP), 0);
+  SlowPathCode* slow_path = GenerateVarHandleChecks(invoke, codegen, &info, &address);
+  CpuRegister out = invoke->GetLocations()->Out().AsRegister<CpuRegister>();
+
+  // All loads have acquire semantics in the x86 memory model.
+  if (info.var_type == DataType::Type::kInt64) {
+    __ movq(out, address);
+  } else {
+    __ movl(out, address);
+  }
+  __ Bind(slow_path->GetExitLabel());
+}
+
+static void GenerateVarHandleSet(HInvoke* invoke,
+                                 CodeGeneratorX86_64* codegen,
+                                 bool is_volatile) {
+  X86_64Assembler* assembler = codegen->GetAssembler();
+  IntrinsicVisitor::VarHandleAccessInfo info;
+  Address address(CpuRegister(RSP), 0);
+  SlowPathCode* slow_path = GenerateVarHandleChecks(invoke, codegen, &info, &address);
+  LocationSummary* locations = invoke->GetLocations();
+  CpuRegister value =
+      locations->InAt(invoke->GetNumberOfArguments() - 1u).AsRegister<CpuRegister>();
+
+  // All stores have release semantics in the x86 memory model, only a volatile store needs
+  // a barrier for the loads after it.
+  if (info.var_type == DataType::Type::kInt64) {
+    __ movq(address, value);
+  } else {
+    __ movl(address, value);
+  }
+  if (is_volatile) {
+    codegen->MemoryFence();
+  }
+  __ Bind(slow_path->GetExitLabel());
+}
+
+static void GenerateVarHandleCompareAndSet(HInvoke* invoke, CodeGeneratorX86_64* codegen) {
+  X86_64Assembler* assembler = codegen->GetAssembler();
+  IntrinsicVisitor::VarHandleAccessInfo info;
+  Address address(CpuRegister(RSP), 0);
+  SlowPathCode* slow_path = GenerateVarHandleChecks(invoke, codegen, &info, &address);
+  LocationSummary* locations = invoke->GetLocations();
+  size_t number_of_arguments = invoke->GetNumberOfArguments();
+  DCHECK_EQ(locations->InAt(number_of_arguments - 2u).AsRegister<Register>(), RAX);
+  CpuRegister value = locations->InAt(number_of_arguments - 1u).AsRegister<CpuRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+
+  if (info.var_type == DataType::Type::kInt64) {
+    __ LockCmpxchgq(address, value);
+  } else {
+    __ LockCmpxchgl(address, value);
+  }
+
+  // LOCK CMPXCHG has full barrier semantics, and we don't need
+  // scheduling barriers at this time.
+
+  // Convert ZF into the Boolean result.
+  __ setcc(kZero, out);
+  __ movzxb(out, out);
+  __ Bind(slow_path->GetExitLabel());
+}
+
+static void GenerateVarHandleGetAndAdd(HInvoke* invoke, CodeGeneratorX86_64* codegen) {
+  X86_64Assembler* assembler = codegen->GetAssembler();
+  IntrinsicVisitor::VarHandleAccessInfo info;
+  Address address(CpuRegister(RSP), 0);
+  SlowPathCode* slow_path = GenerateVarHandleChecks(invoke, codegen, &info, &address);
+  LocationSummary* locations = invoke->GetLocations();
+  CpuRegister value =
+      locations->InAt(invoke->GetNumberOfArguments() - 1u).AsRegister<CpuRegister>();
+  CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+
+  // LOCK XADD has full barrier semantics, which is enough for the acquire and release
+  // variants too.
+  if (info.var_type == DataType::Type::kInt64) {
+    __ movq(out, value);
+    __ LockXaddq(address, out);
+  } else {
+    __ movl(out, value);
+    __ LockXaddl(address, out);
+  }
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleGet(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleGetOpaque(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleGetAcquire(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleGetVolatile(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleSet(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleSetOpaque(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleSetRelease(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleSetVolatile(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleCompareAndSet(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleGetAndAdd(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleGetAndAddAcquire(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+void IntrinsicLocationsBuilderX86_64::VisitVarHandleGetAndAddRelease(HInvoke* invoke) {
+  CreateVarHandleLocations(allocator_, invoke);
+}
+
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleGet(HInvoke* invoke) {
+  GenerateVarHandleGet(invoke, codegen_);
+}
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleGetOpaque(HInvoke* invoke) {
+  GenerateVarHandleGet(invoke, codegen_);
+}
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleGetAcquire(HInvoke* invoke) {
+  GenerateVarHandleGet(invoke, codegen_);
+}
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleGetVolatile(HInvoke* invoke) {
+  GenerateVarHandleGet(invoke, codegen_);
+}
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleSet(HInvoke* invoke) {
+  GenerateVarHandleSet(invoke, codegen_, /* is_volatile */ false);
+}
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleSetOpaque(HInvoke* invoke) {
+  GenerateVarHandleSet(invoke, codegen_, /* is_volatile */ false);
+}
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleSetRelease(HInvoke* invoke) {
+  GenerateVarHandleSet(invoke, codegen_, /* is_volatile */ false);
+}
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleSetVolatile(HInvoke* invoke) {
+  GenerateVarHandleSet(invoke, codegen_, /* is_volatile */ true);
+}
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleCompareAndSet(HInvoke* invoke) {
+  GenerateVarHandleCompareAndSet(invoke, codegen_);
+}
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleGetAndAdd(HInvoke* invoke) {
+  GenerateVarHandleGetAndAdd(invoke, codegen_);
+}
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleGetAndAddAcquire(HInvoke* invoke) {
+  GenerateVarHandleGetAndAdd(invoke, codegen_);
+}
+void IntrinsicCodeGeneratorX86_64::VisitVarHandleGetAndAddRelease(HInvoke* invoke) {
+  GenerateVarHandleGetAndAdd(invoke, codegen_);
+}
+
 void IntrinsicLocationsBuilderX86_64::VisitIntegerReverse(HInvoke* invoke) {
   LocationSummary* locations =
       new (allocator_) LocationSummary(invoke, LocationSummary::kNoCall, kIntrinsified);
@@ -3041,13 +3698,10 @@ UNIMPLEMENTED_INTRINSIC(X86_64, StringBuilderLength);
 UNIMPLEMENTED_INTRINSIC(X86_64, StringBuilderToString);
 
 // 1.8.
-UNIMPLEMENTED_INTRINSIC(X86_64, UnsafeGetAndAddInt)
-UNIMPLEMENTED_INTRINSIC(X86_64, UnsafeGetAndAddLong)
-UNIMPLEMENTED_INTRINSIC(X86_64, UnsafeGetAndSetInt)
-UNIMPLEMENTED_INTRINSIC(X86_64, UnsafeGetAndSetLong)
-UNIMPLEMENTED_INTRINSIC(X86_64, UnsafeGetAndSetObject)
 
 UNREACHABLE_INTRINSICS(X86_64)
+UNIMPLEMENTED_BOXING_INTRINSICS(X86_64)
+UNIMPLEMENTED_VAR_HANDLE_INTRINSICS(X86_64)
 
 #undef __
 
@@ -36,15 +36,98 @@ static bool IsInnerLoop(HLoopInformation* outer, HLoopInformation* inner) {
       && inner->IsIn(*outer);
 }
 
+static bool IsSameOrInnerLoop(HLoopInformation* outer, HLoopInformation* inner) {
+  return (outer == nullptr)
+      || (inner == outer)
+      || IsInnerLoop(outer, inner);
+}
+
+// An edge is unlikely if the branch profile saw it taken less than once every
+// kUnlikelyBranchRatio executions of the branch, with enough executions to tell.
+static constexpr uint32_t kMinimumBranchProfileCount = 100;
+static constexpr uint32_t kUnlikelyBranchRatio = 100;
+
+static bool IsUnlikelyEdge(HBasicBlock* from, HBasicBlock* to) {
+  HInstruction* last = from->GetLastInstruction();
+  if (!last->IsIf()) {
+    return false;
+  }
+  HIf* if_instruction = last->AsIf();
+  uint32_t true_count = if_instruction->GetTrueCount();
+  uint32_t false_count = if_instruction->GetFalseCount();
+  uint32_t total = true_count + false_count;
+  if (total < kMinimumBranchProfileCount) {
+    return false;
+  }
+  uint32_t count = (if_instruction->IfTrueSuccessor() == to) ? true_count : false_count;
+  return count * kUnlikelyBranchRatio < total;
+}
+
+// Blocks that only run when an exception is thrown are cold whatever the profile says.
+static bool IsThrowingBlock(HBasicBlock* block) {
+  return block->IsCatchBlock() || block->GetLastInstruction()->IsThrow();
+}
+
+// Marks the blocks that are unlikely to execute: throwing blocks, the blocks only
+// reached through unlikely edges or other cold blocks, and the blocks that can only
+// continue to cold blocks.
+static void ComputeColdBlocks(const HGraph* graph, ScopedArenaVector<bool>* is_cold) {
+  if (graph->HasIrreducibleLoops()) {
+    // Keep the order of irreducible loops as is.
+    return;
+  }
+  for (HBasicBlock* block : graph->GetReversePostOrder()) {
+    bool cold = false;
+    if (block->IsEntryBlock()) {
+      cold = false;
+    } else if (IsThrowingBlock(block)) {
+      cold = true;
+    } else {
+      // Cold if no forward predecessor can likely branch to `block`.
+      cold = true;
+      for (HBasicBlock* predecessor : block->GetPredecessors()) {
+        if (block->IsLoopHeader() && block->GetLoopInformation()->IsBackEdge(*predecessor)) {
+          continue;
+        }
+        if (!(*is_cold)[predecessor->GetBlockId()] && !IsUnlikelyEdge(predecessor, block)) {
+          cold = false;
+          break;
+        }
+      }
+    }
+    (*is_cold)[block->GetBlockId()] = cold;
+  }
+  for (HBasicBlock* block : ReverseRange(graph->GetReversePostOrder())) {
+    if ((*is_cold)[block->GetBlockId()] || block->IsEntryBlock() || block->IsExitBlock()) {
+      continue;
+    }
+    bool cold = true;
+    for (HBasicBlock* successor : block->GetSuccessors()) {
+      if (!(*is_cold)[successor->GetBlockId()]) {
+        cold = false;
+        break;
+      }
+    }
+    (*is_cold)[block->GetBlockId()] = cold;
+  }
+}
+
 // Helper method to update work list for linear order.
 static void AddToListForLinearization(ScopedArenaVector<HBasicBlock*>* worklist,
-                                      HBasicBlock* block) {
+                                      HBasicBlock* block,
+                                      bool is_cold) {
   HLoopInformation* block_loop = block->GetLoopInformation();
   auto insert_pos = worklist->rbegin();  // insert_pos.base() will be the actual position.
   for (auto end = worklist->rend(); insert_pos != end; ++insert_pos) {
     HBasicBlock* current = *insert_pos;
     HLoopInformation* current_loop = current->GetLoopInformation();
-    if (InSameLoop(block_loop, current_loop)
+    if (is_cold) {
+      // Cold blocks are processed after all the other blocks of their loop, but before
+      // the blocks outside of it to keep the loop contiguous.
+      if (!IsSameOrInnerLoop(block_loop, current_loop)) {
+        break;
+      }
+    } else if (InSameLoop(block_loop, current_loop)
         || !IsLoop(current_loop)
         || IsInnerLoop(current_loop, block_loop)) {
       // The block can be processed immediately.
@@ -87,7 +170,9 @@ void LinearizeGraphInternal(const HGraph* graph, ArrayRef<HBasicBlock*> linear_o
   DCHECK_EQ(linear_order.size(), graph->GetReversePostOrder().size());
   // Create a reverse post ordering with the following properties:
   // - Blocks in a loop are consecutive,
-  // - Back-edge is the last block before loop exits.
+  // - Back-edge is the last block before loop exits,
+  // - Cold blocks come after the other blocks of their loop, or at the end of the
+  //   method when they are not in a loop.
   //
   // (1): Record the number of forward predecessors for each block. This is to
   //      ensure the resulting order is reverse post order. We could use the
@@ -104,6 +189,10 @@ void LinearizeGraphInternal(const HGraph* graph, ArrayRef<HBasicBlock*> linear_o
     }
     forward_predecessors[block->GetBlockId()] = number_of_forward_predecessors;
   }
+  ScopedArenaVector<bool> is_cold(graph->GetBlocks().size(),
+                                  false,
+                                  allocator.Adapter(kArenaAllocLinearOrder));
+  ComputeColdBlocks(graph, &is_cold);
   // (2): Following a worklist approach, first start with the entry block, and
   //      iterate over the successors. When all non-back edge predecessors of a
   //      successor block are visited, the successor block is added in the worklist
@@ -120,7 +209,7 @@ void LinearizeGraphInternal(const HGraph* graph, ArrayRef<HBasicBlock*> linear_o
       int block_id = successor->GetBlockId();
       size_t number_of_remaining_predecessors = forward_predecessors[block_id];
       if (number_of_remaining_predecessors == 1) {
-        AddToListForLinearization(&worklist, successor);
+        AddToListForLinearization(&worklist, successor, is_cold[block_id]);
       }
       forward_predecessors[block_id] = number_of_remaining_predecessors - 1;
     }
@@ -25,6 +25,7 @@
 #include "dex_instruction.h"
 #include "driver/compiler_options.h"
 #include "graph_visualizer.h"
+#include "linear_order.h"
 #include "nodes.h"
 #include "optimizing_unit_test.h"
 #include "pretty_printer.h"
@@ -245,4 +246,32 @@ TEST_F(LinearizeTest, CFG7) {
   TestCode(data, blocks);
 }
 
+TEST_F(LinearizeTest, ThrowingBlockLast) {
+  HGraph* graph = CreateGraph();
+  BuildIfGraph(graph, /* false_block_throws */ true);
+  // The false successor is visited first, unless it is cold.
+  CheckOrder(graph, {0, 1, 2, 4, 3, 5});
+}
+
+TEST_F(LinearizeTest, UnlikelyBranch) {
+  {
+    HGraph* graph = CreateGraph();
+    BuildIfGraph(graph, /* false_block_throws */ false);
+    CheckOrder(graph, {0, 1, 3, 2, 4, 5});
+  }
+  {
+    HGraph* graph = CreateGraph();
+    HIf* if_instruction = BuildIfGraph(graph, /* false_block_throws */ false);
+    if_instruction->SetBranchCounts(/* true_count */ 1000u, /* false_count */ 1u);
+    CheckOrder(graph, {0, 1, 2, 3, 4, 5});
+  }
+  {
+    // Not enough executions to trust the profile.
+    HGraph* graph = CreateGraph();
+    HIf* if_instruction = BuildIfGraph(graph, /* false_block_throws */ false);
+    if_instruction->SetBranchCounts(/* true_count */ 10u, /* false_count */ 0u);
+    CheckOrder(graph, {0, 1, 3, 2, 4, 5});
+  }
+}
+
 }  // namespace art
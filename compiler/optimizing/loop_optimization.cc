@@ -73,9 +73,16 @@ static inline void NormalizePackedType(/* inout */ DataType::Type* type,
 // Enables vectorization (SIMDization) in the loop optimizer.
 static constexpr bool kEnableVectorization = true;
 
+// Enables unrolling of the scalar loops that are not vectorized.
+static constexpr bool kEnableScalarUnrolling = true;
+
 // No loop unrolling factor (just one copy of the loop-body).
 static constexpr uint32_t kNoUnrollingFactor = 1;
 
+// Maximum number of instructions executed by a loop without calls for which the suspend
+// check on the back edge is elided (trip-count times the size of the loop).
+static constexpr int64_t kMaxInstructionsForSuspendCheckElision = 256;
+
 //
 // Static helpers.
 //
@@ -371,6 +378,48 @@ static bool IsAddConst(HInstruction* instruction,
   return false;
 }
 
+// Detect a select that computes the minimum or maximum of two integral values,
+// as generated by if-conversion of a simple diamond, e.g.
+//   x < y ? x : y  (min)
+//   x > y ? x : y  (max)
+static bool IsMinMaxSelect(HInstruction* instruction,
+                           /*out*/ HInstruction** a,
+                           /*out*/ HInstruction** b,
+                           /*out*/ bool* is_min) {
+  HSelect* select = instruction->AsSelect();
+  HInstruction* condition = select->GetCondition();
+  if (!condition->IsCondition() ||
+      !DataType::IsIntegralType(select->GetType()) ||
+      condition->GetBlock() != select->GetBlock() ||
+      !condition->GetUses().HasExactlyOneElement() ||  // only used by the select
+      condition->HasEnvironmentUses()) {
+    return false;
+  }
+  HInstruction* x = condition->InputAt(0);
+  HInstruction* y = condition->InputAt(1);
+  bool is_swapped = false;
+  if (select->GetTrueValue() == y && select->GetFalseValue() == x) {
+    is_swapped = true;
+  } else if (select->GetTrueValue() != x || select->GetFalseValue() != y) {
+    return false;
+  }
+  switch (condition->AsCondition()->GetCondition()) {
+    case kCondLT:
+    case kCondLE:
+      *is_min = !is_swapped;
+      break;
+    case kCondGT:
+    case kCondGE:
+      *is_min = is_swapped;
+      break;
+    default:
+      return false;
+  }
+  *a = x;
+  *b = y;
+  return true;
+}
+
 // Detect reductions of the following forms,
 //   x = x_phi + ..
 //   x = x_phi - ..
@@ -397,6 +446,12 @@ static bool HasReductionFormat(HInstruction* reduction, HInstruction* phi) {
       default:
         return false;
     }
+  } else if (reduction->IsSelect()) {
+    HInstruction* a = nullptr;
+    HInstruction* b = nullptr;
+    bool is_min = false;
+    return IsMinMaxSelect(reduction, &a, &b, &is_min) &&
+           ((a == phi && b != phi) || (a != phi && b == phi));
   }
   return false;
 }
@@ -427,6 +482,24 @@ static HInstruction* Insert(HBasicBlock* block, HInstruction* instruction) {
   return instruction;
 }
 
+// Replace the values of `env`, a copy of `original`, by their mapped value, if any.
+static void RemapEnvironment(HEnvironment* env,
+                             HEnvironment* original,
+                             const ScopedArenaSafeMap<HInstruction*, HInstruction*>& map) {
+  for (; env != nullptr; env = env->GetParent(), original = original->GetParent()) {
+    DCHECK(original != nullptr);
+    DCHECK_EQ(env->Size(), original->Size());
+    for (size_t i = 0, e = env->Size(); i < e; ++i) {
+      auto it = map.find(original->GetInstructionAt(i));
+      if (it != map.end()) {
+        env->RemoveAsUserOfInput(i);
+        env->SetRawEnvAt(i, it->second);
+        it->second->AddEnvUseAt(env, i);
+      }
+    }
+  }
+}
+
 // Check that instructions from the induction sets are fully removed: have no uses
 // and no other instructions use them.
 static bool CheckInductionSetFullyRemoved(ScopedArenaSet<HInstruction*>* iset) {
@@ -750,9 +823,51 @@ bool HLoopOptimization::OptimizeInnerLoop(LoopNode* node) {
     MaybeRecordStat(stats_, MethodCompilationStat::kLoopVectorized);
     return true;
   }
+  // Otherwise, unroll the scalar loop, if possible and profitable.
+  uint32_t unroll = kNoUnrollingFactor;
+  if (kEnableScalarUnrolling && ShouldUnrollScalarLoop(node, body, trip_count, &unroll)) {
+    UnrollScalarLoop(node, body, exit, trip_count, unroll);
+    MaybeRecordStat(stats_, MethodCompilationStat::kLoopScalarUnrolled);
+    return true;
+  }
+  // Otherwise, drop the suspend check of a short loop. This does not change the graph.
+  if (ShouldElideSuspendCheck(node, body, trip_count)) {
+    node->loop_info->GetSuspendCheck()->SetIsNoOp(true);
+    MaybeRecordStat(stats_, MethodCompilationStat::kLoopSuspendCheckElided);
+  }
   return false;
 }
 
+bool HLoopOptimization::ShouldElideSuspendCheck(LoopNode* node,
+                                                HBasicBlock* block,
+                                                int64_t trip_count) {
+  // The debugger must be able to suspend the thread at every back edge, and
+  // OSR entries are recorded at the loop suspend checks.
+  if (graph_->IsDebuggable() || graph_->IsCompilingOsr()) {
+    return false;
+  }
+  // The time-to-safepoint is only bounded for a known trip count.
+  if (trip_count <= 0) {
+    return false;
+  }
+  HSuspendCheck* suspend_check = node->loop_info->GetSuspendCheck();
+  if (suspend_check == nullptr || suspend_check->IsNoOp()) {
+    return false;
+  }
+  // A call may run for any amount of time and reaches its own safepoints anyway.
+  HBasicBlock* header = node->loop_info->GetHeader();
+  int64_t instruction_count = 0;
+  for (HBasicBlock* loop_block : { header, block }) {
+    for (HInstructionIterator it(loop_block->GetInstructions()); !it.Done(); it.Advance()) {
+      if (it.Current()->IsInvoke()) {
+        return false;
+      }
+      ++instruction_count;
+    }
+  }
+  return trip_count <= kMaxInstructionsForSuspendCheckElision / instruction_count;
+}
+
 //
 // Loop vectorization. The implementation is based on the book by Aart J.C. Bik:
 // "The Software Vectorization Handbook. Applying Multimedia Extensions for Maximum Performance."
@@ -1409,6 +1524,8 @@ bool HLoopOptimization::VectorizeUse(LoopNode* node,
       default:
         return false;
     }  // switch
+  } else if (instruction->IsSelect()) {
+    return VectorizeMinMaxSelectIdiom(node, instruction, generate_code, type, restrictions);
   }
   return false;
 }
@@ -1494,7 +1611,12 @@ bool HLoopOptimization::TrySetVectorType(DataType::Type type, uint64_t* restrict
             *restrictions |= kNoDiv | kNoSAD;
             return TrySetVectorLength(4);
           case DataType::Type::kInt64:
-            *restrictions |= kNoMul | kNoDiv | kNoShr | kNoAbs | kNoMinMax | kNoSAD;
+            *restrictions |= kNoMul | kNoDiv | kNoShr | kNoAbs | kNoSAD;
+            // Long min/max compare with pcmpgtq, which only the x86-64 code generator uses.
+            if (compiler_driver_->GetInstructionSet() != InstructionSet::kX86_64 ||
+                !features->AsX86InstructionSetFeatures()->HasSSE4_2()) {
+              *restrictions |= kNoMinMax;
+            }
             return TrySetVectorLength(2);
           case DataType::Type::kFloat32:
             *restrictions |= kNoMinMax | kNoReduction;  // minmax: -0.0 vs +0.0
@@ -2107,6 +2229,76 @@ bool HLoopOptimization::VectorizeSADIdiom(LoopNode* node,
   return false;
 }
 
+// Method recognizes the following idiom:
+//   x OP y ? x : y  for OP in <, <=, >, >=
+// which if-conversion produces from a simple min/max diamond. Vectorized code uses
+// a vector min/max operation. Sequential code uses the original condition and select.
+bool HLoopOptimization::VectorizeMinMaxSelectIdiom(LoopNode* node,
+                                                   HInstruction* instruction,
+                                                   bool generate_code,
+                                                   DataType::Type type,
+                                                   uint64_t restrictions) {
+  HInstruction* a = nullptr;
+  HInstruction* b = nullptr;
+  bool is_min = false;
+  if (!IsMinMaxSelect(instruction, &a, &b, &is_min)) {
+    return false;
+  }
+  // Deal with vector restrictions.
+  HInstruction* r = a;
+  HInstruction* s = b;
+  bool is_unsigned = false;
+  if (HasVectorRestrictions(restrictions, kNoMinMax)) {
+    return false;
+  } else if (HasVectorRestrictions(restrictions, kNoHiBits) &&
+             !IsNarrowerOperands(a, b, type, &r, &s, &is_unsigned)) {
+    return false;  // reject, unless all operands are same-extension narrower
+  }
+  // Accept min/max select for vectorizable operands.
+  DCHECK(r != nullptr);
+  DCHECK(s != nullptr);
+  if (generate_code && vector_mode_ != kVector) {  // de-idiom
+    r = a;
+    s = b;
+  }
+  if (VectorizeUse(node, r, generate_code, type, restrictions) &&
+      VectorizeUse(node, s, generate_code, type, restrictions)) {
+    if (generate_code) {
+      HInstruction* opa = vector_map_->Get(r);
+      HInstruction* opb = vector_map_->Get(s);
+      if (vector_mode_ == kVector) {
+        NormalizePackedType(&type, &is_unsigned);
+        HVecOperation* vector = nullptr;
+        if (is_min) {
+          vector = new (global_allocator_) HVecMin(
+              global_allocator_, opa, opb, type, vector_length_, is_unsigned, kNoDexPc);
+        } else {
+          vector = new (global_allocator_) HVecMax(
+              global_allocator_, opa, opb, type, vector_length_, is_unsigned, kNoDexPc);
+        }
+        vector_map_->Put(instruction, vector);
+        MaybeRecordStat(stats_, MethodCompilationStat::kLoopVectorizedIdiom);
+      } else {
+        HSelect* select = instruction->AsSelect();
+        HInstruction* condition = select->GetCondition();
+        // The clone only gets its uses once inserted in original program order.
+        HInstruction* new_condition = condition->Clone(global_allocator_);
+        new_condition->SetRawInputAt(0, opa);
+        new_condition->SetRawInputAt(1, opb);
+        bool is_swapped = select->GetTrueValue() != a;
+        HInstruction* new_select = new (global_allocator_) HSelect(new_condition,
+                                                                   is_swapped ? opb : opa,
+                                                                   is_swapped ? opa : opb,
+                                                                   select->GetDexPc());
+        vector_map_->Put(condition, new_condition);
+        vector_map_->Put(instruction, new_select);
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
 //
 // Vectorization heuristics.
 //
@@ -2201,6 +2393,265 @@ uint32_t HLoopOptimization::GetUnrollingFactor(HBasicBlock* block, int64_t trip_
   }
 }
 
+//
+// Scalar loop unrolling.
+//
+
+bool HLoopOptimization::ShouldUnrollScalarLoop(LoopNode* node,
+                                               HBasicBlock* block,
+                                               int64_t trip_count,
+                                               /*out*/ uint32_t* unroll) {
+  // The unrolled loop is controlled by the trip count.
+  if (trip_count < 0) {
+    return false;  // guard against non-taken/large
+  }
+  // Test for a typical loop header, where only the phis carry values into the loop-body:
+  //   s:  SuspendCheck
+  //   c:  Condition
+  //   i:  If(c)
+  HBasicBlock* header = node->loop_info->GetHeader();
+  HInstruction* s = header->GetFirstInstruction();
+  HInstruction* c = s->GetNext();
+  if (!s->IsSuspendCheck() ||
+      c == nullptr ||
+      !c->IsCondition() ||
+      !c->GetUses().HasExactlyOneElement() ||  // only used for termination
+      c->HasEnvironmentUses() ||
+      c->GetNext() == nullptr ||
+      !c->GetNext()->IsIf() ||
+      c->GetNext()->InputAt(0) != c) {
+    return false;
+  }
+  // Every instruction of the loop-body is copied. Calls don't gain from unrolling.
+  for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+    HInstruction* instruction = it.Current();
+    if (!instruction->IsClonable() || instruction->IsInvoke() || instruction->IsSuspendCheck()) {
+      return false;
+    }
+  }
+  *unroll = GetScalarUnrollingFactor(block, trip_count);
+  return *unroll != kNoUnrollingFactor;
+}
+
+void HLoopOptimization::UnrollScalarLoop(LoopNode* node,
+                                         HBasicBlock* block,
+                                         HBasicBlock* exit,
+                                         int64_t trip_count,
+                                         uint32_t unroll) {
+  HBasicBlock* header = node->loop_info->GetHeader();
+  HBasicBlock* preheader = node->loop_info->GetPreHeader();
+  DCHECK(IsPowerOfTwo(unroll));
+
+  // A remainder loop is needed for any unknown trip count or for a known
+  // trip count that is not a multiple of the unrolling factor.
+  bool needs_remainder = trip_count == 0 || (trip_count % unroll) != 0;
+
+  // Generate loop control:
+  // stc = <trip-count>;
+  // rem = stc % unroll;
+  // k = 0;
+  HInstruction* stc = induction_range_.GenerateTripCount(node->loop_info, graph_, preheader);
+  DCHECK(stc != nullptr);
+  DataType::Type induc_type = stc->GetType();
+  HInstruction* zero = graph_->GetConstant(induc_type, 0);
+  HInstruction* rem = nullptr;
+  if (needs_remainder) {
+    rem = Insert(preheader, new (global_allocator_) HAnd(
+        induc_type, stc, graph_->GetConstant(induc_type, unroll - 1)));
+  }
+
+  // The phis of the original loop start with their value on entry.
+  vector_permanent_map_->clear();
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    vector_permanent_map_->Put(it.Current(), it.Current()->InputAt(0));
+  }
+  vector_header_ = header;
+  vector_body_ = block;
+
+  // Generate remainder loop, if needed:
+  // for ( ; k < rem; k += 1)
+  //    <loop-body>
+  HInstruction* lo = zero;
+  if (needs_remainder) {
+    GenerateScalarLoop(header,
+                       block,
+                       graph_->TransformLoopForVectorization(vector_header_, vector_body_, exit),
+                       lo,
+                       rem,
+                       kNoUnrollingFactor);
+    lo = vector_index_;
+  }
+
+  // Generate unrolled loop:
+  // for ( ; k < stc; k += unroll)
+  //    <loop-body> x unroll
+  GenerateScalarLoop(header,
+                     block,
+                     graph_->TransformLoopForVectorization(vector_header_, vector_body_, exit),
+                     lo,
+                     stc,
+                     unroll);
+  HLoopInformation* uloop = vector_header_->GetLoopInformation();
+
+  // Remove the original loop by disconnecting the body block and removing all
+  // instructions from the header. The uses of its phis, which can now only be
+  // after the loop, see the final values of the unrolled loop.
+  block->DisconnectAndDelete();
+  while (!header->GetFirstInstruction()->IsGoto()) {
+    header->RemoveInstruction(header->GetFirstInstruction());
+  }
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    HPhi* phi = it.Current()->AsPhi();
+    phi->ReplaceWith(vector_permanent_map_->Get(phi));
+    header->RemovePhi(phi);
+  }
+
+  // Update loop hierarchy: the old header now resides in the same outer loop
+  // as the old preheader. As for vectorization, the remainder loop is not put
+  // back in the hierarchy.
+  header->SetLoopInformation(preheader->GetLoopInformation());  // outward
+  node->loop_info = uloop;
+}
+
+void HLoopOptimization::GenerateScalarLoop(HBasicBlock* header,
+                                           HBasicBlock* block,
+                                           HBasicBlock* new_preheader,
+                                           HInstruction* lo,
+                                           HInstruction* hi,
+                                           uint32_t unroll) {
+  DataType::Type induc_type = lo->GetType();
+  // Prepare new loop.
+  vector_preheader_ = new_preheader;
+  vector_header_ = vector_preheader_->GetSingleSuccessor();
+  vector_body_ = vector_header_->GetSuccessors()[1];
+  HPhi* phi = new (global_allocator_) HPhi(global_allocator_,
+                                           kNoRegNumber,
+                                           0,
+                                           HPhi::ToPhiType(induc_type));
+  // Generate header and prepare body.
+  // for (k = lo; k < hi; k += unroll)
+  //    <loop-body> x unroll
+  HInstruction* cond = new (global_allocator_) HAboveOrEqual(phi, hi);
+  vector_header_->AddPhi(phi);
+  vector_header_->AddInstruction(cond);
+  vector_header_->AddInstruction(new (global_allocator_) HIf(cond));
+
+  // Copy the phis of the original loop, which start with the values
+  // the previous loop left them with.
+  vector_map_->clear();
+  ScopedArenaVector<HPhi*> new_phis(loop_allocator_->Adapter(kArenaAllocLoopOptimization));
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+    HPhi* org = it.Current()->AsPhi();
+    HPhi* new_phi = new (global_allocator_) HPhi(global_allocator_,
+                                                 org->GetRegNumber(),
+                                                 0,
+                                                 org->GetType());
+    if (org->GetType() == DataType::Type::kReference) {
+      new_phi->SetReferenceTypeInfo(org->GetReferenceTypeInfo());
+    }
+    new_phi->SetCanBeNull(org->CanBeNull());
+    vector_header_->AddPhi(new_phi);
+    new_phi->AddInput(vector_permanent_map_->Get(org));
+    vector_permanent_map_->Overwrite(org, new_phi);
+    vector_map_->Put(org, new_phi);
+    new_phis.push_back(new_phi);
+  }
+  // The suspend check sees the copied phis.
+  RemapEnvironment(vector_header_->GetFirstInstruction()->GetEnvironment(),
+                   header->GetFirstInstruction()->GetEnvironment(),
+                   *vector_map_);
+
+  for (uint32_t u = 0; u < unroll; u++) {
+    // Map the phis of the original loop to their value in this copy of the loop-body.
+    vector_map_->clear();
+    for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+      vector_map_->Put(it.Current(), vector_permanent_map_->Get(it.Current()));
+    }
+    // Generate the copy of the loop-body, in original program order.
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* org = it.Current();
+      if (org->IsGoto()) {
+        continue;
+      }
+      HInstruction* clone = Insert(vector_body_, org->Clone(global_allocator_));
+      for (size_t i = 0, e = clone->InputCount(); i < e; ++i) {
+        auto input = vector_map_->find(clone->InputAt(i));
+        if (input != vector_map_->end()) {
+          clone->ReplaceInput(input->second, i);
+        }
+      }
+      if (org->HasEnvironment()) {
+        clone->CopyEnvironmentFrom(org->GetEnvironment());
+        RemapEnvironment(clone->GetEnvironment(), org->GetEnvironment(), *vector_map_);
+      }
+      vector_map_->Put(org, clone);
+    }
+    // The next copy sees the values of the back-edge of this copy.
+    for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance()) {
+      HInstruction* back_edge = it.Current()->InputAt(1);
+      auto value = vector_map_->find(back_edge);
+      vector_permanent_map_->Overwrite(
+          it.Current(), value != vector_map_->end() ? value->second : back_edge);
+    }
+  }
+  // Generate the induction.
+  vector_index_ = Insert(vector_body_, new (global_allocator_) HAdd(
+      induc_type, phi, graph_->GetConstant(induc_type, unroll)));
+
+  // Finalize phi inputs, the phis of the original loop now leave
+  // the loop with the values of the copied phis.
+  size_t index = 0;
+  for (HInstructionIterator it(header->GetPhis()); !it.Done(); it.Advance(), ++index) {
+    new_phis[index]->AddInput(vector_permanent_map_->Get(it.Current()));
+    vector_permanent_map_->Overwrite(it.Current(), new_phis[index]);
+  }
+  phi->AddInput(lo);
+  phi->AddInput(vector_index_);
+  vector_index_ = phi;
+}
+
+// Scalar unrolling heuristics, per instruction set: the maximum unrolling factor, and
+// the maximum number of instructions in the unrolled loop-body. The out-of-order x86-64
+// cores hide most of the loop overhead already, so unroll less there.
+static constexpr uint32_t ARM64_SCALAR_MAXIMUM_UNROLL_FACTOR = 4;
+static constexpr uint32_t ARM64_SCALAR_HEURISTIC_MAX_BODY_SIZE = 48;
+static constexpr uint32_t X86_64_SCALAR_MAXIMUM_UNROLL_FACTOR = 2;
+static constexpr uint32_t X86_64_SCALAR_HEURISTIC_MAX_BODY_SIZE = 32;
+
+uint32_t HLoopOptimization::GetScalarUnrollingFactor(HBasicBlock* block, int64_t trip_count) {
+  if (compiler_driver_ == nullptr) {
+    return kNoUnrollingFactor;
+  }
+  uint32_t max_unroll_factor = kNoUnrollingFactor;
+  uint32_t max_body_size = 0;
+  switch (compiler_driver_->GetInstructionSet()) {
+    case InstructionSet::kArm64:
+      max_unroll_factor = ARM64_SCALAR_MAXIMUM_UNROLL_FACTOR;
+      max_body_size = ARM64_SCALAR_HEURISTIC_MAX_BODY_SIZE;
+      break;
+    case InstructionSet::kX86_64:
+      max_unroll_factor = X86_64_SCALAR_MAXIMUM_UNROLL_FACTOR;
+      max_body_size = X86_64_SCALAR_HEURISTIC_MAX_BODY_SIZE;
+      break;
+    default:
+      return kNoUnrollingFactor;
+  }
+  // Don't unroll an empty or a large loop body (not counting the goto).
+  uint32_t instruction_count = block->GetInstructions().CountSize() - 1;
+  if (instruction_count == 0 || 2 * instruction_count > max_body_size) {
+    return kNoUnrollingFactor;
+  }
+  // Find a beneficial unroll factor with the following restrictions:
+  //  - For a known trip count, at least two iterations of the unrolled loop should be executed.
+  //  - The unrolled loop body shouldn't be "too big" (heuristic).
+  uint32_t unroll_factor = std::min(max_body_size / instruction_count, max_unroll_factor);
+  if (trip_count != 0) {
+    unroll_factor = std::min(unroll_factor, static_cast<uint32_t>(
+        std::min<int64_t>(trip_count / 2, max_unroll_factor)));
+  }
+  return (unroll_factor <= 1u) ? kNoUnrollingFactor : TruncToPowerOfTwo(unroll_factor);
+}
+
 //
 // Helpers.
 //
@@ -2260,9 +2711,13 @@ bool HLoopOptimization::TrySetPhiReduction(HPhi* phi) {
           // Reduction update only used by phi.
           reduction->GetUses().HasExactlyOneElement() &&
           !reduction->HasEnvironmentUses() &&
-          // Reduction update is only use of phi inside the loop.
+          // Reduction update is only use of phi inside the loop, besides the
+          // condition of a min/max select.
           IsOnlyUsedAfterLoop(loop_info, phi, /*collect_loop_uses*/ true, &use_count) &&
-          iset_->size() == 1;
+          (iset_->size() == 1 ||
+           (reduction->IsSelect() &&
+            iset_->size() == 2 &&
+            iset_->find(reduction->AsSelect()->GetCondition()) != iset_->end()));
       iset_->clear();  // leave the way you found it
       if (single_use_inside_loop) {
         // Link reduction back, and start recording feed value.
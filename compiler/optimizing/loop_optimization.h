@@ -187,6 +187,11 @@ class HLoopOptimization : public HOptimization {
                          bool generate_code,
                          DataType::Type type,
                          uint64_t restrictions);
+  bool VectorizeMinMaxSelectIdiom(LoopNode* node,
+                                  HInstruction* instruction,
+                                  bool generate_code,
+                                  DataType::Type type,
+                                  uint64_t restrictions);
 
   // Vectorization heuristics.
   Alignment ComputeAlignment(HInstruction* offset,
@@ -199,6 +204,32 @@ class HLoopOptimization : public HOptimization {
   bool IsVectorizationProfitable(int64_t trip_count);
   uint32_t GetUnrollingFactor(HBasicBlock* block, int64_t trip_count);
 
+  //
+  // Scalar loop unrolling, for the loops that are not vectorized. The loop is replaced
+  // by a remainder loop, if needed, followed by the unrolled loop.
+  //
+
+  bool ShouldUnrollScalarLoop(LoopNode* node,
+                              HBasicBlock* block,
+                              int64_t trip_count,
+                              /*out*/ uint32_t* unroll);
+  void UnrollScalarLoop(LoopNode* node,
+                        HBasicBlock* block,
+                        HBasicBlock* exit,
+                        int64_t trip_count,
+                        uint32_t unroll);
+  void GenerateScalarLoop(HBasicBlock* header,
+                          HBasicBlock* block,
+                          HBasicBlock* new_preheader,
+                          HInstruction* lo,
+                          HInstruction* hi,
+                          uint32_t unroll);
+  uint32_t GetScalarUnrollingFactor(HBasicBlock* block, int64_t trip_count);
+
+  // Returns true if the suspend check of a loop with a known, small trip count and
+  // no calls can be elided while keeping the time-to-safepoint bounded.
+  bool ShouldElideSuspendCheck(LoopNode* node, HBasicBlock* block, int64_t trip_count);
+
   //
   // Helpers.
   //
@@ -314,6 +314,7 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
          InvokeType invoke_type = kInvalidInvokeType,
          bool debuggable = false,
          bool osr = false,
+         bool baseline = false,
          int start_instruction_id = 0)
       : allocator_(allocator),
         arena_stack_(arena_stack),
@@ -338,6 +339,7 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
         invoke_type_(invoke_type),
         in_ssa_form_(false),
         number_of_cha_guards_(0),
+        number_of_inlined_invokes_(0),
         instruction_set_(instruction_set),
         cached_null_constant_(nullptr),
         cached_int_constants_(std::less<int32_t>(), allocator->Adapter(kArenaAllocConstantsMap)),
@@ -348,6 +350,7 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
         art_method_(nullptr),
         inexact_object_rti_(ReferenceTypeInfo::CreateInvalid()),
         osr_(osr),
+        baseline_(baseline),
         cha_single_implementation_list_(allocator->Adapter(kArenaAllocCHA)) {
     blocks_.reserve(kDefaultNumberOfBlocks);
   }
@@ -572,6 +575,8 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
 
   bool IsCompilingOsr() const { return osr_; }
 
+  bool IsCompilingBaseline() const { return baseline_; }
+
   ArenaSet<ArtMethod*>& GetCHASingleImplementationList() {
     return cha_single_implementation_list_;
   }
@@ -610,6 +615,9 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
   void SetNumberOfCHAGuards(uint32_t num) { number_of_cha_guards_ = num; }
   void IncrementNumberOfCHAGuards() { number_of_cha_guards_++; }
 
+  uint32_t GetNumberOfInlinedInvokes() const { return number_of_inlined_invokes_; }
+  void IncrementNumberOfInlinedInvokes() { number_of_inlined_invokes_++; }
+
  private:
   void RemoveInstructionsAsUsersFromDeadBlocks(const ArenaBitVector& visited) const;
   void RemoveDeadBlocks(const ArenaBitVector& visited);
@@ -725,6 +733,9 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
   // CHA guard optimization pass when there is no CHA guard left.
   uint32_t number_of_cha_guards_;
 
+  // Number of invokes inlined in the graph, including the ones in inlined methods.
+  uint32_t number_of_inlined_invokes_;
+
   const InstructionSet instruction_set_;
 
   // Cached constants.
@@ -750,6 +761,10 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
   // compiled code entries which the interpreter can directly jump to.
   const bool osr_;
 
+  // Whether we are compiling baseline JIT code: most optimizations are skipped, and the code
+  // counts its invocations in the ProfilingInfo to trigger an optimized compilation.
+  const bool baseline_;
+
   // List of methods that are assumed to have single implementation.
   ArenaSet<ArtMethod*> cha_single_implementation_list_;
 
@@ -1384,6 +1399,7 @@ class HLoopInformationOutwardIterator : public ValueObject {
   M(Shr, BinaryOperation)                                               \
   M(StaticFieldGet, Instruction)                                        \
   M(StaticFieldSet, Instruction)                                        \
+  M(StringBuilderAppend, Instruction)                                   \
   M(UnresolvedInstanceFieldGet, Instruction)                            \
   M(UnresolvedInstanceFieldSet, Instruction)                            \
   M(UnresolvedStaticFieldGet, Instruction)                              \
@@ -3029,7 +3045,10 @@ class HDoubleConstant FINAL : public HConstant {
 class HIf FINAL : public HTemplateInstruction<1> {
  public:
   explicit HIf(HInstruction* input, uint32_t dex_pc = kNoDexPc)
-      : HTemplateInstruction(SideEffects::None(), dex_pc) {
+      : HTemplateInstruction(SideEffects::None(), dex_pc),
+        true_count_(0u),
+        false_count_(0u),
+        successors_swapped_(false) {
     SetRawInputAt(0, input);
   }
 
@@ -3044,10 +3063,35 @@ class HIf FINAL : public HTemplateInstruction<1> {
     return GetBlock()->GetSuccessors()[1];
   }
 
+  // The number of times each successor was taken in the branch profile, zero when
+  // there is no profile.
+  uint16_t GetTrueCount() const { return true_count_; }
+  uint16_t GetFalseCount() const { return false_count_; }
+
+  void SetBranchCounts(uint16_t true_count, uint16_t false_count) {
+    true_count_ = true_count;
+    false_count_ = false_count;
+  }
+
+  // Keeps the counts attached to their successors when the successors are swapped.
+  void SwapBranchCounts() {
+    std::swap(true_count_, false_count_);
+    successors_swapped_ = !successors_swapped_;
+  }
+
+  // Whether the true successor is the target of the dex IF instruction, rather than the
+  // instruction following it.
+  bool IsTrueSuccessorBranchTarget() const { return !successors_swapped_; }
+
   DECLARE_INSTRUCTION(If);
 
  protected:
   DEFAULT_COPY_CONSTRUCTOR(If);
+
+ private:
+  uint16_t true_count_;
+  uint16_t false_count_;
+  bool successors_swapped_;
 };
 
 
@@ -4271,22 +4315,36 @@ class HInvokePolymorphic FINAL : public HInvoke {
                      uint32_t number_of_arguments,
                      DataType::Type return_type,
                      uint32_t dex_pc,
-                     uint32_t dex_method_index)
+                     uint32_t dex_method_index,
+                     ArtMethod* resolved_method,
+                     const DexFile& dex_file,
+                     uint32_t proto_idx)
       : HInvoke(allocator,
                 number_of_arguments,
                 0u /* number_of_other_inputs */,
                 return_type,
                 dex_pc,
                 dex_method_index,
-                nullptr,
-                kVirtual) {}
+                resolved_method,
+                kVirtual),
+        dex_file_(dex_file),
+        proto_idx_(proto_idx) {}
 
   bool IsClonable() const OVERRIDE { return true; }
 
+  // The dex file and the index of the prototype of the call site, which gives the
+  // accessor type of VarHandle accessors.
+  const DexFile& GetDexFile() const { return dex_file_; }
+  uint32_t GetProtoIndex() const { return proto_idx_; }
+
   DECLARE_INSTRUCTION(InvokePolymorphic);
 
  protected:
   DEFAULT_COPY_CONSTRUCTOR(InvokePolymorphic);
+
+ private:
+  const DexFile& dex_file_;
+  const uint32_t proto_idx_;
 };
 
 class HInvokeStaticOrDirect FINAL : public HInvoke {
@@ -4905,6 +4963,7 @@ class HDivZeroCheck FINAL : public HExpression<1> {
 
   DataType::Type GetType() const OVERRIDE { return InputAt(0)->GetType(); }
 
+  bool IsClonable() const OVERRIDE { return true; }
   bool CanBeMoved() const OVERRIDE { return true; }
 
   bool InstructionDataEquals(const HInstruction* other ATTRIBUTE_UNUSED) const OVERRIDE {
@@ -5351,6 +5410,7 @@ class HTypeConversion FINAL : public HExpression<1> {
   DataType::Type GetInputType() const { return GetInput()->GetType(); }
   DataType::Type GetResultType() const { return GetType(); }
 
+  bool IsClonable() const OVERRIDE { return true; }
   bool CanBeMoved() const OVERRIDE { return true; }
   bool InstructionDataEquals(const HInstruction* other ATTRIBUTE_UNUSED) const OVERRIDE {
     return true;
@@ -5475,6 +5535,13 @@ class HInstanceFieldGet FINAL : public HExpression<1> {
   DataType::Type GetFieldType() const { return field_info_.GetFieldType(); }
   bool IsVolatile() const { return field_info_.IsVolatile(); }
 
+  // Whether the read barrier of a reference load is not needed, see ReadBarrierElimination.
+  bool IsReadBarrierElided() const { return GetPackedFlag<kFlagReadBarrierElided>(); }
+  void SetReadBarrierElided() {
+    DCHECK_EQ(GetType(), DataType::Type::kReference);
+    SetPackedFlag<kFlagReadBarrierElided>(true);
+  }
+
   void SetType(DataType::Type new_type) {
     DCHECK(DataType::IsIntegralType(GetType()));
     DCHECK(DataType::IsIntegralType(new_type));
@@ -5488,6 +5555,11 @@ class HInstanceFieldGet FINAL : public HExpression<1> {
   DEFAULT_COPY_CONSTRUCTOR(InstanceFieldGet);
 
  private:
+  static constexpr size_t kFlagReadBarrierElided = kNumberOfExpressionPackedBits;
+  static constexpr size_t kNumberOfInstanceFieldGetPackedBits = kFlagReadBarrierElided + 1;
+  static_assert(kNumberOfInstanceFieldGetPackedBits <= HInstruction::kMaxNumberOfPackedBits,
+                "Too many packed fields.");
+
   const FieldInfo field_info_;
 };
 
@@ -5607,6 +5679,13 @@ class HArrayGet FINAL : public HExpression<2> {
 
   bool IsStringCharAt() const { return GetPackedFlag<kFlagIsStringCharAt>(); }
 
+  // Whether the read barrier of a reference load is not needed, see ReadBarrierElimination.
+  bool IsReadBarrierElided() const { return GetPackedFlag<kFlagReadBarrierElided>(); }
+  void SetReadBarrierElided() {
+    DCHECK_EQ(GetType(), DataType::Type::kReference);
+    SetPackedFlag<kFlagReadBarrierElided>(true);
+  }
+
   HInstruction* GetArray() const { return InputAt(0); }
   HInstruction* GetIndex() const { return InputAt(1); }
 
@@ -5629,7 +5708,8 @@ class HArrayGet FINAL : public HExpression<2> {
   // of the input but that requires holding the mutator lock, so we prefer to use
   // a flag, so that code generators don't need to do the locking.
   static constexpr size_t kFlagIsStringCharAt = kNumberOfExpressionPackedBits;
-  static constexpr size_t kNumberOfArrayGetPackedBits = kFlagIsStringCharAt + 1;
+  static constexpr size_t kFlagReadBarrierElided = kFlagIsStringCharAt + 1;
+  static constexpr size_t kNumberOfArrayGetPackedBits = kFlagReadBarrierElided + 1;
   static_assert(kNumberOfArrayGetPackedBits <= HInstruction::kMaxNumberOfPackedBits,
                 "Too many packed fields.");
 };
@@ -5831,7 +5911,9 @@ class HBoundsCheck FINAL : public HExpression<2> {
 class HSuspendCheck FINAL : public HTemplateInstruction<0> {
  public:
   explicit HSuspendCheck(uint32_t dex_pc = kNoDexPc)
-      : HTemplateInstruction(SideEffects::CanTriggerGC(), dex_pc), slow_path_(nullptr) {}
+      : HTemplateInstruction(SideEffects::CanTriggerGC(), dex_pc),
+        slow_path_(nullptr),
+        is_no_op_(false) {}
 
   bool IsClonable() const OVERRIDE { return true; }
 
@@ -5842,6 +5924,11 @@ class HSuspendCheck FINAL : public HTemplateInstruction<0> {
   void SetSlowPath(SlowPathCode* slow_path) { slow_path_ = slow_path; }
   SlowPathCode* GetSlowPath() const { return slow_path_; }
 
+  // A loop suspend check that is a no-op is not generated on the back edges. This is only
+  // valid for loops that are known to reach the next safepoint in a bounded amount of time.
+  void SetIsNoOp(bool is_no_op) { is_no_op_ = is_no_op; }
+  bool IsNoOp() const { return is_no_op_; }
+
   DECLARE_INSTRUCTION(SuspendCheck);
 
  protected:
@@ -5851,6 +5938,8 @@ class HSuspendCheck FINAL : public HTemplateInstruction<0> {
   // Only used for code generation, in order to share the same slow path between back edges
   // of a same loop.
   SlowPathCode* slow_path_;
+
+  bool is_no_op_;
 };
 
 // Pseudo-instruction which provides the native debugger with mapping information.
@@ -6262,6 +6351,62 @@ inline void HLoadString::AddSpecialInput(HInstruction* special_input) {
   special_input->AddUseAt(this, 0);
 }
 
+/**
+ * Allocates the string of a `new StringBuilder().append(...)...toString()` chain and fills in
+ * the appended arguments. The inputs are the arguments, followed by the HIntConstant format
+ * which describes them, see StringBuilderAppend::Argument.
+ */
+class HStringBuilderAppend FINAL : public HVariableInputSizeInstruction {
+ public:
+  HStringBuilderAppend(HIntConstant* format,
+                       uint32_t number_of_arguments,
+                       ArenaAllocator* allocator,
+                       uint32_t dex_pc)
+      : HVariableInputSizeInstruction(
+            // The runtime call may read memory from inputs. It never writes outside
+            // of the newly allocated result object (or newly allocated helper objects).
+            SideEffects::AllReads().Union(SideEffects::CanTriggerGC()),
+            dex_pc,
+            allocator,
+            number_of_arguments + /* format */ 1u,
+            kArenaAllocInvokeInputs) {
+    DCHECK_GE(number_of_arguments, 1u);  // There must be something to append.
+    SetRawInputAt(FormatIndex(), format);
+  }
+
+  void SetArgumentAt(size_t index, HInstruction* argument) {
+    DCHECK_LT(index, GetNumberOfArguments());
+    SetRawInputAt(index, argument);
+  }
+
+  // Return the number of arguments, excluding the format.
+  size_t GetNumberOfArguments() const {
+    DCHECK_GE(InputCount(), 1u);
+    return InputCount() - 1u;
+  }
+
+  size_t FormatIndex() const {
+    return GetNumberOfArguments();
+  }
+
+  HIntConstant* GetFormat() {
+    return InputAt(FormatIndex())->AsIntConstant();
+  }
+
+  DataType::Type GetType() const OVERRIDE { return DataType::Type::kReference; }
+
+  bool NeedsEnvironment() const OVERRIDE { return true; }
+
+  bool CanThrow() const OVERRIDE { return true; }
+
+  bool CanBeNull() const OVERRIDE { return false; }
+
+  DECLARE_INSTRUCTION(StringBuilderAppend);
+
+ protected:
+  DEFAULT_COPY_CONSTRUCTOR(StringBuilderAppend);
+};
+
 /**
  * Performs an initialization check on its Class object input.
  */
@@ -6593,7 +6738,8 @@ enum class TypeCheckKind {
   kInterfaceCheck,        // No optimization yet when checking against an interface.
   kArrayObjectCheck,      // Can just check if the array is not primitive.
   kArrayCheck,            // No optimization yet when checking against a generic array.
-  kLast = kArrayCheck
+  kBitstringCheck,        // Compare the type check bitstring.
+  kLast = kBitstringCheck
 };
 
 std::ostream& operator<<(std::ostream& os, TypeCheckKind rhs);
@@ -6603,10 +6749,16 @@ class HInstanceOf FINAL : public HExpression<2> {
   HInstanceOf(HInstruction* object,
               HLoadClass* target_class,
               TypeCheckKind check_kind,
+              uint32_t bitstring_path_to_root,
+              uint32_t bitstring_mask,
               uint32_t dex_pc)
       : HExpression(DataType::Type::kBool,
                     SideEffectsForArchRuntimeCalls(check_kind),
-                    dex_pc) {
+                    dex_pc),
+        bitstring_path_to_root_(bitstring_path_to_root),
+        bitstring_mask_(bitstring_mask) {
+    DCHECK(check_kind == TypeCheckKind::kBitstringCheck ||
+           (bitstring_path_to_root == 0u && bitstring_mask == 0u));
     SetPackedField<TypeCheckKindField>(check_kind);
     SetPackedFlag<kFlagMustDoNullCheck>(true);
     SetRawInputAt(0, object);
@@ -6636,9 +6788,21 @@ class HInstanceOf FINAL : public HExpression<2> {
   TypeCheckKind GetTypeCheckKind() const { return GetPackedField<TypeCheckKindField>(); }
   bool IsExactCheck() const { return GetTypeCheckKind() == TypeCheckKind::kExactCheck; }
 
+  // The bitstring of the target class and its mask, for kBitstringCheck. The check
+  // succeeds if the subtype check bits of the object's class, masked, equal the bitstring.
+  uint32_t GetBitstringPathToRoot() const {
+    DCHECK_EQ(GetTypeCheckKind(), TypeCheckKind::kBitstringCheck);
+    return bitstring_path_to_root_;
+  }
+  uint32_t GetBitstringMask() const {
+    DCHECK_EQ(GetTypeCheckKind(), TypeCheckKind::kBitstringCheck);
+    return bitstring_mask_;
+  }
+
   static bool CanCallRuntime(TypeCheckKind check_kind) {
     // Mips currently does runtime calls for any other checks.
-    return check_kind != TypeCheckKind::kExactCheck;
+    return check_kind != TypeCheckKind::kExactCheck &&
+        check_kind != TypeCheckKind::kBitstringCheck;
   }
 
   static SideEffects SideEffectsForArchRuntimeCalls(TypeCheckKind check_kind) {
@@ -6658,6 +6822,9 @@ class HInstanceOf FINAL : public HExpression<2> {
   static constexpr size_t kNumberOfInstanceOfPackedBits = kFlagMustDoNullCheck + 1;
   static_assert(kNumberOfInstanceOfPackedBits <= kMaxNumberOfPackedBits, "Too many packed fields.");
   using TypeCheckKindField = BitField<TypeCheckKind, kFieldTypeCheckKind, kFieldTypeCheckKindSize>;
+
+  const uint32_t bitstring_path_to_root_;
+  const uint32_t bitstring_mask_;
 };
 
 class HBoundType FINAL : public HExpression<1> {
@@ -6712,8 +6879,14 @@ class HCheckCast FINAL : public HTemplateInstruction<2> {
   HCheckCast(HInstruction* object,
              HLoadClass* target_class,
              TypeCheckKind check_kind,
+             uint32_t bitstring_path_to_root,
+             uint32_t bitstring_mask,
              uint32_t dex_pc)
-      : HTemplateInstruction(SideEffects::CanTriggerGC(), dex_pc) {
+      : HTemplateInstruction(SideEffects::CanTriggerGC(), dex_pc),
+        bitstring_path_to_root_(bitstring_path_to_root),
+        bitstring_mask_(bitstring_mask) {
+    DCHECK(check_kind == TypeCheckKind::kBitstringCheck ||
+           (bitstring_path_to_root == 0u && bitstring_mask == 0u));
     SetPackedField<TypeCheckKindField>(check_kind);
     SetPackedFlag<kFlagMustDoNullCheck>(true);
     SetRawInputAt(0, object);
@@ -6745,6 +6918,16 @@ class HCheckCast FINAL : public HTemplateInstruction<2> {
   TypeCheckKind GetTypeCheckKind() const { return GetPackedField<TypeCheckKindField>(); }
   bool IsExactCheck() const { return GetTypeCheckKind() == TypeCheckKind::kExactCheck; }
 
+  // The bitstring of the target class and its mask, for kBitstringCheck.
+  uint32_t GetBitstringPathToRoot() const {
+    DCHECK_EQ(GetTypeCheckKind(), TypeCheckKind::kBitstringCheck);
+    return bitstring_path_to_root_;
+  }
+  uint32_t GetBitstringMask() const {
+    DCHECK_EQ(GetTypeCheckKind(), TypeCheckKind::kBitstringCheck);
+    return bitstring_mask_;
+  }
+
   DECLARE_INSTRUCTION(CheckCast);
 
  protected:
@@ -6758,6 +6941,9 @@ class HCheckCast FINAL : public HTemplateInstruction<2> {
   static constexpr size_t kNumberOfCheckCastPackedBits = kFlagMustDoNullCheck + 1;
   static_assert(kNumberOfCheckCastPackedBits <= kMaxNumberOfPackedBits, "Too many packed fields.");
   using TypeCheckKindField = BitField<TypeCheckKind, kFieldTypeCheckKind, kFieldTypeCheckKindSize>;
+
+  const uint32_t bitstring_path_to_root_;
+  const uint32_t bitstring_mask_;
 };
 
 /**
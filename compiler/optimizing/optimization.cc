@@ -50,6 +50,8 @@
 #include "load_store_analysis.h"
 #include "load_store_elimination.h"
 #include "loop_optimization.h"
+#include "partial_escape_analysis.h"
+#include "read_barrier_elimination.h"
 #include "scheduler.h"
 #include "select_generator.h"
 #include "sharpening.h"
@@ -77,6 +79,10 @@ const char* OptimizationPassName(OptimizationPass pass) {
       return BoundsCheckElimination::kBoundsCheckEliminationPassName;
     case OptimizationPass::kLoadStoreElimination:
       return LoadStoreElimination::kLoadStoreEliminationPassName;
+    case OptimizationPass::kPartialEscapeAnalysis:
+      return PartialEscapeAnalysis::kPartialEscapeAnalysisPassName;
+    case OptimizationPass::kReadBarrierElimination:
+      return ReadBarrierElimination::kReadBarrierEliminationPassName;
     case OptimizationPass::kConstantFolding:
       return HConstantFolding::kConstantFoldingPassName;
     case OptimizationPass::kDeadCodeElimination:
@@ -142,6 +148,8 @@ OptimizationPass OptimizationPassByName(const std::string& name) {
   X(OptimizationPass::kLoadStoreAnalysis);
   X(OptimizationPass::kLoadStoreElimination);
   X(OptimizationPass::kLoopOptimization);
+  X(OptimizationPass::kPartialEscapeAnalysis);
+  X(OptimizationPass::kReadBarrierElimination);
   X(OptimizationPass::kScheduling);
   X(OptimizationPass::kSelectGenerator);
   X(OptimizationPass::kSharpening);
@@ -277,6 +285,12 @@ ArenaVector<HOptimization*> ConstructOptimizations(
       case OptimizationPass::kCodeSinking:
         opt = new (allocator) CodeSinking(graph, stats, name);
         break;
+      case OptimizationPass::kPartialEscapeAnalysis:
+        opt = new (allocator) PartialEscapeAnalysis(graph, stats, name);
+        break;
+      case OptimizationPass::kReadBarrierElimination:
+        opt = new (allocator) ReadBarrierElimination(graph, stats, name);
+        break;
       case OptimizationPass::kConstructorFenceRedundancyElimination:
         opt = new (allocator) ConstructorFenceRedundancyElimination(graph, stats, name);
         break;
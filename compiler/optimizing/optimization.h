@@ -81,6 +81,8 @@ enum class OptimizationPass {
   kLoadStoreAnalysis,
   kLoadStoreElimination,
   kLoopOptimization,
+  kPartialEscapeAnalysis,
+  kReadBarrierElimination,
   kScheduling,
   kSelectGenerator,
   kSharpening,
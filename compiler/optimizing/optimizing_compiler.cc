@@ -29,6 +29,7 @@
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "base/scoped_arena_allocator.h"
+#include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "builder.h"
 #include "code_generator.h"
@@ -53,6 +54,7 @@
 #include "linker/linker_patch.h"
 #include "nodes.h"
 #include "oat_quick_method_header.h"
+#include "pass_costs.h"
 #include "prepare_for_register_allocation.h"
 #include "reference_type_propagation.h"
 #include "register_allocator_linear_scan.h"
@@ -69,6 +71,9 @@ static constexpr size_t kArenaAllocatorMemoryReportThreshold = 8 * MB;
 
 static constexpr const char* kPassNameSeparator = "$";
 
+// Number of HIR instructions above which the JIT allocates registers with the fast strategy.
+static constexpr size_t kFastRegisterAllocationThreshold = 2000;
+
 /**
  * Used by the code generator, to allocate the code in a vector.
  */
@@ -109,7 +114,8 @@ class PassObserver : public ValueObject {
                CodeGenerator* codegen,
                std::ostream* visualizer_output,
                CompilerDriver* compiler_driver,
-               Mutex& dump_mutex)
+               Mutex& dump_mutex,
+               jit::JitCompilationRecord* compilation_record)
       : graph_(graph),
         cached_method_name_(),
         timing_logger_enabled_(compiler_driver->GetCompilerOptions().GetDumpTimings()),
@@ -120,6 +126,10 @@ class PassObserver : public ValueObject {
         visualizer_enabled_(!compiler_driver->GetCompilerOptions().GetDumpCfgFileName().empty()),
         visualizer_(&visualizer_oss_, graph, *codegen),
         visualizer_dump_mutex_(dump_mutex),
+        compilation_record_(compilation_record),
+        pass_costs_(compiler_driver->GetCompilerOptions().GetPassCosts()),
+        pass_start_ns_(0u),
+        pass_start_arena_bytes_(0u),
         graph_in_bad_state_(false) {
     if (timing_logger_enabled_ || visualizer_enabled_) {
       if (!IsVerboseMethod(compiler_driver, GetMethodName())) {
@@ -168,6 +178,12 @@ class PassObserver : public ValueObject {
     if (timing_logger_enabled_) {
       timing_logger_.StartTiming(pass_name);
     }
+    if (compilation_record_ != nullptr || pass_costs_ != nullptr) {
+      pass_start_ns_ = ThreadCpuNanoTime();
+    }
+    if (pass_costs_ != nullptr) {
+      pass_start_arena_bytes_ = graph_->GetAllocator()->BytesUsed();
+    }
   }
 
   void FlushVisualizer() REQUIRES(!visualizer_dump_mutex_) {
@@ -183,6 +199,17 @@ class PassObserver : public ValueObject {
     if (timing_logger_enabled_) {
       timing_logger_.EndTiming();
     }
+    if (compilation_record_ != nullptr || pass_costs_ != nullptr) {
+      const uint64_t pass_time_ns = ThreadCpuNanoTime() - pass_start_ns_;
+      if (compilation_record_ != nullptr) {
+        compilation_record_->pass_times_ns.emplace_back(pass_name, pass_time_ns);
+      }
+      if (pass_costs_ != nullptr) {
+        pass_costs_->AddPass(pass_name,
+                             pass_time_ns,
+                             graph_->GetAllocator()->BytesUsed() - pass_start_arena_bytes_);
+      }
+    }
     if (visualizer_enabled_) {
       visualizer_.DumpGraph(pass_name, /* is_after_pass */ true, graph_in_bad_state_);
       FlushVisualizer();
@@ -232,6 +259,13 @@ class PassObserver : public ValueObject {
   HGraphVisualizer visualizer_;
   Mutex& visualizer_dump_mutex_;
 
+  // Record of a JIT compilation that gets the time of each pass, or null.
+  jit::JitCompilationRecord* const compilation_record_;
+  // The costs of the passes of all compilations, see CompilerOptions::SetPassCosts(), or null.
+  PassCosts* const pass_costs_;
+  uint64_t pass_start_ns_;
+  size_t pass_start_arena_bytes_;
+
   // Flag to be set by the compiler if the pass failed and the graph is not
   // expected to validate.
   bool graph_in_bad_state_;
@@ -293,6 +327,7 @@ class OptimizingCompiler FINAL : public Compiler {
                   jit::JitCodeCache* code_cache,
                   ArtMethod* method,
                   bool osr,
+                  bool baseline,
                   jit::JitLogger* jit_logger)
       OVERRIDE
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -341,6 +376,13 @@ class OptimizingCompiler FINAL : public Compiler {
                         PassObserver* pass_observer,
                         VariableSizedHandleScope* handles) const;
 
+  // Run the few passes of a baseline compilation.
+  void RunBaselineOptimizations(HGraph* graph,
+                                CodeGenerator* codegen,
+                                const DexCompilationUnit& dex_compilation_unit,
+                                PassObserver* pass_observer,
+                                VariableSizedHandleScope* handles) const;
+
  private:
   // Create a 'CompiledMethod' for an optimized graph.
   CompiledMethod* Emit(ArenaAllocator* allocator,
@@ -353,15 +395,19 @@ class OptimizingCompiler FINAL : public Compiler {
   // This method:
   // 1) Builds the graph. Returns null if it failed to build it.
   // 2) Transforms the graph to SSA. Returns null if it failed.
-  // 3) Runs optimizations on the graph, including register allocator.
+  // 3) Runs optimizations on the graph, including register allocator. A `baseline`
+  //    compilation only runs the cheap passes.
   // 4) Generates code with the `code_allocator` provided.
+  // The time of each pass goes to `compilation_record` if not null.
   CodeGenerator* TryCompile(ArenaAllocator* allocator,
                             ArenaStack* arena_stack,
                             CodeVectorAllocator* code_allocator,
                             const DexCompilationUnit& dex_compilation_unit,
                             ArtMethod* method,
                             bool osr,
-                            VariableSizedHandleScope* handles) const;
+                            bool baseline,
+                            VariableSizedHandleScope* handles,
+                            jit::JitCompilationRecord* compilation_record) const;
 
   CodeGenerator* TryCompileIntrinsic(ArenaAllocator* allocator,
                                      ArenaStack* arena_stack,
@@ -436,6 +482,13 @@ static bool IsInstructionSetSupported(InstructionSet instruction_set) {
       || instruction_set == InstructionSet::kX86_64;
 }
 
+// Baseline code needs the code generator to count invocations and call the
+// CompileOptimized entrypoint. Other instruction sets get optimized code directly.
+static bool IsBaselineSupported(InstructionSet instruction_set) {
+  return instruction_set == InstructionSet::kArm64
+      || instruction_set == InstructionSet::kX86_64;
+}
+
 void OptimizingCompiler::MaybeRunInliner(HGraph* graph,
                                          CodeGenerator* codegen,
                                          const DexCompilationUnit& dex_compilation_unit,
@@ -487,7 +540,9 @@ void OptimizingCompiler::RunArchOptimizations(HGraph* graph,
         OptDef(OptimizationPass::kInstructionSimplifierArm64),
         OptDef(OptimizationPass::kSideEffectsAnalysis),
         OptDef(OptimizationPass::kGlobalValueNumbering, "GVN$after_arch"),
-        OptDef(OptimizationPass::kScheduling)
+        OptDef(OptimizationPass::kScheduling),
+        // Last, once the loads don't move anymore.
+        OptDef(OptimizationPass::kReadBarrierElimination)
       };
       RunOptimizations(graph,
                        codegen,
@@ -552,7 +607,10 @@ void OptimizingCompiler::RunArchOptimizations(HGraph* graph,
       OptimizationDef x86_64_optimizations[] = {
         OptDef(OptimizationPass::kSideEffectsAnalysis),
         OptDef(OptimizationPass::kGlobalValueNumbering, "GVN$after_arch"),
-        OptDef(OptimizationPass::kX86MemoryOperandGeneration)
+        OptDef(OptimizationPass::kX86MemoryOperandGeneration),
+        OptDef(OptimizationPass::kScheduling),
+        // Last, once the loads don't move anymore.
+        OptDef(OptimizationPass::kReadBarrierElimination)
       };
       RunOptimizations(graph,
                        codegen,
@@ -660,6 +718,9 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
     // Evaluates code generated by dynamic bce.
     OptDef(OptimizationPass::kConstantFolding,       "constant_folding$after_bce"),
     OptDef(OptimizationPass::kInstructionSimplifier, "instruction_simplifier$after_bce"),
+    // Gives a copy of the allocations to the uses on uncommon branches, for LSE to remove
+    // the allocations from the common paths.
+    OptDef(OptimizationPass::kPartialEscapeAnalysis),
     OptDef(OptimizationPass::kSideEffectsAnalysis,   "side_effects$before_lse"),
     OptDef(OptimizationPass::kLoadStoreAnalysis),
     OptDef(OptimizationPass::kLoadStoreElimination),
@@ -684,6 +745,58 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
   RunArchOptimizations(graph, codegen, dex_compilation_unit, pass_observer, handles);
 }
 
+// There is no OSR from compiled code, so a frame of baseline code looping for a long time would
+// never reach the optimized code. Each loop header checks the should_deoptimize flag, which the
+// JIT sets in the frames of the baseline code once the optimized code is installed. The frame then
+// continues in the interpreter, which enters the OSR code of the loop.
+static void AddTierUpGuards(HGraph* graph) {
+  ArenaAllocator* allocator = graph->GetAllocator();
+  for (HBasicBlock* block : graph->GetReversePostOrder()) {
+    if (!block->IsLoopHeader() ||
+        block->IsTryBlock() ||
+        !block->GetLoopInformation()->HasSuspendCheck()) {
+      continue;
+    }
+    HSuspendCheck* suspend_check = block->GetLoopInformation()->GetSuspendCheck();
+    uint32_t dex_pc = suspend_check->GetDexPc();
+    HShouldDeoptimizeFlag* deopt_flag =
+        new (allocator) HShouldDeoptimizeFlag(allocator, dex_pc);
+    HInstruction* compare =
+        new (allocator) HNotEqual(deopt_flag, graph->GetIntConstant(0, dex_pc));
+    HDeoptimize* deopt =
+        new (allocator) HDeoptimize(allocator, compare, DeoptimizationKind::kTierUp, dex_pc);
+    block->InsertInstructionAfter(deopt_flag, suspend_check);
+    block->InsertInstructionAfter(compare, deopt_flag);
+    block->InsertInstructionAfter(deopt, compare);
+    deopt->CopyEnvironmentFrom(suspend_check->GetEnvironment());
+    graph->IncrementNumberOfCHAGuards();
+  }
+}
+
+void OptimizingCompiler::RunBaselineOptimizations(HGraph* graph,
+                                                  CodeGenerator* codegen,
+                                                  const DexCompilationUnit& dex_compilation_unit,
+                                                  PassObserver* pass_observer,
+                                                  VariableSizedHandleScope* handles) const {
+  // Only local passes that pay for themselves in a single compilation. The inliner and the
+  // loop optimizations wait for the optimized compilation, which also gets the inline caches
+  // filled while the method was warm.
+  OptimizationDef optimizations[] = {
+    OptDef(OptimizationPass::kIntrinsicsRecognizer),
+    OptDef(OptimizationPass::kSharpening),
+    // The codegen has a few assumptions that only the instruction simplifier
+    // can satisfy.
+    OptDef(OptimizationPass::kInstructionSimplifier)
+  };
+  RunOptimizations(graph,
+                   codegen,
+                   dex_compilation_unit,
+                   pass_observer,
+                   handles,
+                   optimizations);
+  AddTierUpGuards(graph);
+}
+
 static ArenaVector<linker::LinkerPatch> EmitAndSortLinkerPatches(CodeGenerator* codegen) {
   ArenaVector<linker::LinkerPatch> linker_patches(codegen->GetGraph()->GetAllocator()->Adapter());
   codegen->EmitLinkerPatches(&linker_patches);
@@ -737,7 +850,9 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
                                               const DexCompilationUnit& dex_compilation_unit,
                                               ArtMethod* method,
                                               bool osr,
-                                              VariableSizedHandleScope* handles) const {
+                                              bool baseline,
+                                              VariableSizedHandleScope* handles,
+                                              jit::JitCompilationRecord* compilation_record) const {
   MaybeRecordStat(compilation_stats_.get(), MethodCompilationStat::kAttemptBytecodeCompilation);
   CompilerDriver* compiler_driver = GetCompilerDriver();
   InstructionSet instruction_set = compiler_driver->GetInstructionSet();
@@ -781,7 +896,8 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
       compiler_driver->GetInstructionSet(),
       kInvalidInvokeType,
       compiler_driver->GetCompilerOptions().GetDebuggable(),
-      osr);
+      osr,
+      baseline);
 
   const uint8_t* interpreter_metadata = nullptr;
   // For AOT compilation, we may not get a method, for example if its class is erroneous.
@@ -810,7 +926,8 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
                              codegen.get(),
                              visualizer_output_.get(),
                              compiler_driver,
-                             dump_mutex_);
+                             dump_mutex_,
+                             compilation_record);
 
   {
     VLOG(compiler) << "Building " << pass_observer.GetMethodName();
@@ -855,14 +972,29 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* allocator,
     }
   }
 
-  RunOptimizations(graph,
-                   codegen.get(),
-                   dex_compilation_unit,
-                   &pass_observer,
-                   handles);
+  if (baseline) {
+    RunBaselineOptimizations(graph,
+                             codegen.get(),
+                             dex_compilation_unit,
+                             &pass_observer,
+                             handles);
+  } else {
+    RunOptimizations(graph,
+                     codegen.get(),
+                     dex_compilation_unit,
+                     &pass_observer,
+                     handles);
+  }
 
   RegisterAllocator::Strategy regalloc_strategy =
     compiler_options.GetRegisterAllocationStrategy();
+  // The JIT trades some code quality for compile time on baseline code and large methods,
+  // unless another strategy was requested explicitly.
+  if (regalloc_strategy == RegisterAllocator::kRegisterAllocatorDefault &&
+      !Runtime::Current()->IsAotCompiler() &&
+      (baseline || graph->GetCurrentInstructionId() > kFastRegisterAllocationThreshold)) {
+    regalloc_strategy = RegisterAllocator::kRegisterAllocatorLinearScanFast;
+  }
   AllocateRegisters(graph,
                     codegen.get(),
                     &pass_observer,
@@ -928,7 +1060,8 @@ CodeGenerator* OptimizingCompiler::TryCompileIntrinsic(
                              codegen.get(),
                              visualizer_output_.get(),
                              compiler_driver,
-                             dump_mutex_);
+                             dump_mutex_,
+                             /* compilation_record */ nullptr);
 
   {
     VLOG(compiler) << "Building intrinsic graph " << pass_observer.GetMethodName();
@@ -1040,7 +1173,9 @@ CompiledMethod* OptimizingCompiler::Compile(const DexFile::CodeItem* code_item,
                        dex_compilation_unit,
                        method,
                        /* osr */ false,
-                       &handles));
+                       /* baseline */ false,
+                       &handles,
+                       /* compilation_record */ nullptr));
       }
     }
     if (codegen.get() != nullptr) {
@@ -1052,6 +1187,16 @@ CompiledMethod* OptimizingCompiler::Compile(const DexFile::CodeItem* code_item,
         compiled_method->MarkAsIntrinsic();
       }
 
+      PassCosts* pass_costs = compiler_driver->GetCompilerOptions().GetPassCosts();
+      if (pass_costs != nullptr && !compiled_intrinsic) {
+        size_t dex_instructions = 0u;
+        for (const DexInstructionPcPair& inst : code_item->Instructions()) {
+          UNUSED(inst);
+          ++dex_instructions;
+        }
+        pass_costs->AddMethod(dex_instructions);
+      }
+
       if (kArenaAllocatorCountAllocations) {
         codegen.reset();  // Release codegen's ScopedArenaAllocator for memory accounting.
         size_t total_allocated = allocator.BytesAllocated() + arena_stack.PeakBytesAllocated();
@@ -1183,6 +1328,7 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                                     jit::JitCodeCache* code_cache,
                                     ArtMethod* method,
                                     bool osr,
+                                    bool baseline,
                                     jit::JitLogger* jit_logger) {
   StackHandleScope<3> hs(self);
   Handle<mirror::ClassLoader> class_loader(hs.NewHandle(
@@ -1198,6 +1344,8 @@ bool OptimizingCompiler::JitCompile(Thread* self,
 
   Runtime* runtime = Runtime::Current();
   ArenaAllocator allocator(runtime->GetJitArenaPool());
+  jit::JitCompilationRecord compilation_record;
+  const uint64_t start_ns = ThreadCpuNanoTime();
 
   if (UNLIKELY(method->IsNative())) {
     JniCompiledMethod jni_compiled_method = ArtQuickJniCompileMethod(
@@ -1218,6 +1366,7 @@ bool OptimizingCompiler::JitCompile(Thread* self,
         jni_compiled_method.GetCode().size(),
         /* data_size */ 0u,
         osr,
+        /* baseline */ false,
         roots,
         /* has_should_deoptimize_flag */ false,
         cha_single_implementation_list);
@@ -1260,6 +1409,12 @@ bool OptimizingCompiler::JitCompile(Thread* self,
     if (jit_logger != nullptr) {
       jit_logger->WriteLog(code, jni_compiled_method.GetCode().size(), method);
     }
+    compilation_record.method = method->PrettyMethod();
+    compilation_record.osr = osr;
+    compilation_record.compile_time_ns = ThreadCpuNanoTime() - start_ns;
+    compilation_record.arena_bytes = allocator.BytesUsed();
+    compilation_record.code_size = jni_compiled_method.GetCode().size();
+    runtime->GetJit()->AddCompilationRecord(std::move(compilation_record));
     return true;
   }
 
@@ -1289,7 +1444,9 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                    dex_compilation_unit,
                    method,
                    osr,
-                   &handles));
+                   baseline && IsBaselineSupported(GetCompilerDriver()->GetInstructionSet()),
+                   &handles,
+                   &compilation_record));
     if (codegen.get() == nullptr) {
       return false;
     }
@@ -1346,6 +1503,7 @@ bool OptimizingCompiler::JitCompile(Thread* self,
       code_allocator.GetSize(),
       data_size,
       osr,
+      codegen->GetGraph()->IsCompilingBaseline(),
       roots,
       codegen->GetGraph()->HasShouldDeoptimizeFlag(),
       codegen->GetGraph()->GetCHASingleImplementationList());
@@ -1391,6 +1549,14 @@ bool OptimizingCompiler::JitCompile(Thread* self,
   if (jit_logger != nullptr) {
     jit_logger->WriteLog(code, code_allocator.GetSize(), method);
   }
+  compilation_record.method = method->PrettyMethod();
+  compilation_record.osr = osr;
+  compilation_record.baseline = codegen->GetGraph()->IsCompilingBaseline();
+  compilation_record.compile_time_ns = ThreadCpuNanoTime() - start_ns;
+  compilation_record.arena_bytes = allocator.BytesUsed();
+  compilation_record.code_size = code_allocator.GetSize();
+  compilation_record.inlined_invokes = codegen->GetGraph()->GetNumberOfInlinedInvokes();
+  runtime->GetJit()->AddCompilationRecord(std::move(compilation_record));
 
   if (kArenaAllocatorCountAllocations) {
     codegen.reset();  // Release codegen's ScopedArenaAllocator for memory accounting.
@@ -61,16 +61,23 @@ enum class MethodCompilationStat {
   kNotCompiledVerifyAtRuntime,
   kInlinedMonomorphicCall,
   kInlinedPolymorphicCall,
+  kInlinedMegamorphicCall,
+  kInterfaceCallDevirtualized,
   kMonomorphicCall,
   kPolymorphicCall,
   kMegamorphicCall,
+  kInlinerHotCallSite,
+  kInlinerColdCallSite,
   kBooleanSimplified,
   kIntrinsicRecognized,
   kLoopInvariantMoved,
   kLoopVectorized,
   kLoopVectorizedIdiom,
+  kLoopScalarUnrolled,
+  kLoopSuspendCheckElided,
   kSelectGenerated,
   kRemovedInstanceOf,
+  kBitstringTypeCheck,
   kInlinedInvokeVirtualOrInterface,
   kImplicitNullCheckGenerated,
   kExplicitNullCheckGenerated,
@@ -96,8 +103,12 @@ enum class MethodCompilationStat {
   kConstructorFenceGeneratedNew,
   kConstructorFenceGeneratedFinal,
   kConstructorFenceRemovedLSE,
+  kPartialEscapeMaterialized,
   kConstructorFenceRemovedPFRA,
   kConstructorFenceRemovedCFRE,
+  kReadBarrierElided,
+  kMethodHandleInvokeDevirtualized,
+  kReflectiveFieldGetInlined,
   kJitOutOfMemoryForCommit,
   kLastStat
 };
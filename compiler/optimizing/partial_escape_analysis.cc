@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "partial_escape_analysis.h"
+
+#include <algorithm>
+
+#include "base/arena_bit_vector.h"
+#include "base/bit_vector-inl.h"
+#include "base/scoped_arena_allocator.h"
+#include "base/stl_util.h"
+
+namespace art {
+
+// Returns whether `user` only accesses the fields of `allocation`, which it can do
+// just as well on a copy of the allocation holding the same values.
+static bool IsFieldAccessOf(HInstruction* allocation, HInstruction* user) {
+  if (user->IsInstanceFieldGet()) {
+    return !user->AsInstanceFieldGet()->IsVolatile();
+  } else if (user->IsInstanceFieldSet()) {
+    return (user->InputAt(1) != allocation) && !user->AsInstanceFieldSet()->IsVolatile();
+  }
+  return user->IsConstructorFence();
+}
+
+void PartialEscapeAnalysis::Run() {
+  if (graph_->IsDebuggable() || graph_->HasTryCatch()) {
+    // Load/store elimination won't run, it is the one removing the original allocation.
+    return;
+  }
+  HBasicBlock* exit = graph_->GetExitBlock();
+  if (exit == nullptr) {
+    // Infinite loop, just bail.
+    return;
+  }
+
+  // Local allocator to discard data structures created below at the end of this optimization.
+  ScopedArenaAllocator allocator(graph_->GetArenaStack());
+
+  // Find the blocks that can reach a return. The other ones always end up throwing,
+  // we consider them as uncommon branches.
+  ArenaBitVector can_return(&allocator, graph_->GetBlocks().size(), /* expandable */ false);
+  can_return.ClearAllBits();
+  ScopedArenaVector<HBasicBlock*> worklist(allocator.Adapter(kArenaAllocMisc));
+  for (HBasicBlock* exit_predecessor : exit->GetPredecessors()) {
+    if (!exit_predecessor->GetLastInstruction()->IsThrow()) {
+      can_return.SetBit(exit_predecessor->GetBlockId());
+      worklist.push_back(exit_predecessor);
+    }
+  }
+  while (!worklist.empty()) {
+    HBasicBlock* block = worklist.back();
+    worklist.pop_back();
+    for (HBasicBlock* predecessor : block->GetPredecessors()) {
+      if (!can_return.IsBitSet(predecessor->GetBlockId())) {
+        can_return.SetBit(predecessor->GetBlockId());
+        worklist.push_back(predecessor);
+      }
+    }
+  }
+
+  // Collect the allocations first, as materializing adds instructions to the graph.
+  ScopedArenaVector<HNewInstance*> allocations(allocator.Adapter(kArenaAllocMisc));
+  for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+    if (!can_return.IsBitSet(block->GetBlockId())) {
+      continue;
+    }
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      if (it.Current()->IsNewInstance()) {
+        allocations.push_back(it.Current()->AsNewInstance());
+      }
+    }
+  }
+  for (HNewInstance* allocation : allocations) {
+    TryMaterializeOnUncommonBranches(allocation, can_return);
+  }
+}
+
+void PartialEscapeAnalysis::TryMaterializeOnUncommonBranches(HNewInstance* allocation,
+                                                             const ArenaBitVector& can_return) {
+  // Load/store elimination only removes allocations meeting these conditions.
+  if (allocation->IsFinalizable() || allocation->NeedsChecks()) {
+    return;
+  }
+
+  ScopedArenaAllocator allocator(graph_->GetArenaStack());
+  ScopedArenaVector<HInstruction*> escapes(allocator.Adapter(kArenaAllocMisc));
+  // The fields that may not hold their default value, and need to be copied.
+  ScopedArenaVector<const FieldInfo*> fields(allocator.Adapter(kArenaAllocMisc));
+  for (const HUseListNode<HInstruction*>& use : allocation->GetUses()) {
+    HInstruction* user = use.GetUser();
+    if (IsFieldAccessOf(allocation, user)) {
+      if (user->IsInstanceFieldSet()) {
+        const FieldInfo& field = user->AsInstanceFieldSet()->GetFieldInfo();
+        if (std::none_of(fields.begin(), fields.end(), [&field](const FieldInfo* other) {
+              return other->GetFieldOffset().Uint32Value() == field.GetFieldOffset().Uint32Value();
+            })) {
+          fields.push_back(&field);
+        }
+      }
+    } else if (can_return.IsBitSet(user->GetBlock()->GetBlockId()) || user->IsPhi()) {
+      // The allocation escapes on a common path, or in a way we can't redirect.
+      return;
+    } else {
+      escapes.push_back(user);
+    }
+  }
+  if (escapes.empty()) {
+    // Either the allocation does not escape, or only through its environment uses.
+    return;
+  }
+  for (const HUseListNode<HEnvironment*>& use : allocation->GetEnvUses()) {
+    if (use.GetUser()->GetHolder()->IsDeoptimize()) {
+      // The interpreter needs the allocation, load/store elimination won't remove it.
+      return;
+    }
+  }
+
+  // Materialize the allocation before each escaping use not dominated by another one.
+  // All the escaping uses are then dominated by a materialization, and there is no path
+  // from an uncommon branch back to the code using the original allocation.
+  ScopedArenaVector<HInstruction*> materialization_points(allocator.Adapter(kArenaAllocMisc));
+  for (HInstruction* escape : escapes) {
+    if (ContainsElement(materialization_points, escape) ||
+        std::any_of(escapes.begin(), escapes.end(), [escape](HInstruction* other) {
+          return other->StrictlyDominates(escape);
+        })) {
+      continue;
+    }
+    if (!escape->HasEnvironment() || escape->GetBlock()->IsInLoop()) {
+      // We need an environment for the new allocation, and it should only happen once.
+      return;
+    }
+    materialization_points.push_back(escape);
+  }
+
+  for (HInstruction* escape : materialization_points) {
+    Materialize(allocation, fields, escape);
+  }
+  MaybeRecordStat(stats_, MethodCompilationStat::kPartialEscapeMaterialized);
+}
+
+void PartialEscapeAnalysis::Materialize(HNewInstance* allocation,
+                                        const ScopedArenaVector<const FieldInfo*>& fields,
+                                        HInstruction* escape) {
+  ArenaAllocator* arena = graph_->GetAllocator();
+  HBasicBlock* block = escape->GetBlock();
+  uint32_t dex_pc = escape->GetDexPc();
+
+  HNewInstance* copy = new (arena) HNewInstance(allocation->InputAt(0),
+                                                dex_pc,
+                                                allocation->GetTypeIndex(),
+                                                allocation->GetDexFile(),
+                                                /* finalizable */ false,
+                                                allocation->GetEntrypoint());
+  block->InsertInstructionBefore(copy, escape);
+  copy->CopyEnvironmentFrom(escape->GetEnvironment());
+  copy->SetReferenceTypeInfo(allocation->GetReferenceTypeInfo());
+
+  // Copy the values of the fields at this point. The loads will be eliminated, as the
+  // original allocation is a singleton once its escaping uses are replaced.
+  for (const FieldInfo* field : fields) {
+    HInstanceFieldGet* value = new (arena) HInstanceFieldGet(allocation,
+                                                             field->GetField(),
+                                                             field->GetFieldType(),
+                                                             field->GetFieldOffset(),
+                                                             /* is_volatile */ false,
+                                                             field->GetFieldIndex(),
+                                                             field->GetDeclaringClassDefIndex(),
+                                                             field->GetDexFile(),
+                                                             dex_pc);
+    if (value->GetType() == DataType::Type::kReference) {
+      value->SetReferenceTypeInfo(graph_->GetInexactObjectRti());
+    }
+    HInstanceFieldSet* store = new (arena) HInstanceFieldSet(copy,
+                                                             value,
+                                                             field->GetField(),
+                                                             field->GetFieldType(),
+                                                             field->GetFieldOffset(),
+                                                             /* is_volatile */ false,
+                                                             field->GetFieldIndex(),
+                                                             field->GetDeclaringClassDefIndex(),
+                                                             field->GetDexFile(),
+                                                             dex_pc);
+    block->InsertInstructionBefore(value, escape);
+    block->InsertInstructionBefore(store, escape);
+  }
+  // The copy is published by the escaping use, like the original allocation would have been.
+  HConstructorFence* fence = new (arena) HConstructorFence(copy, dex_pc, arena);
+  block->InsertInstructionBefore(fence, escape);
+
+  allocation->ReplaceUsesDominatedBy(fence, copy);
+  ScopedArenaAllocator allocator(graph_->GetArenaStack());
+  ScopedArenaVector<std::pair<HEnvironment*, size_t>> env_uses(
+      allocator.Adapter(kArenaAllocMisc));
+  for (const HUseListNode<HEnvironment*>& use : allocation->GetEnvUses()) {
+    if (fence->StrictlyDominates(use.GetUser()->GetHolder())) {
+      env_uses.emplace_back(use.GetUser(), use.GetIndex());
+    }
+  }
+  for (const std::pair<HEnvironment*, size_t>& use : env_uses) {
+    use.first->RemoveAsUserOfInput(use.second);
+    use.first->SetRawEnvAt(use.second, copy);
+    copy->AddEnvUseAt(use.first, use.second);
+  }
+}
+
+}  // namespace art
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_PARTIAL_ESCAPE_ANALYSIS_H_
+#define ART_COMPILER_OPTIMIZING_PARTIAL_ESCAPE_ANALYSIS_H_
+
+#include "base/scoped_arena_containers.h"
+#include "nodes.h"
+#include "optimization.h"
+
+namespace art {
+
+class ArenaBitVector;
+
+/**
+ * Optimization pass for allocations that only escape on branches ending with
+ * a throw. The escaping uses are given a copy of the allocation, materialized
+ * on these branches, so that load/store elimination can scalar replace the
+ * fields of the original allocation and remove it:
+ *
+ *   o = new Foo()                  o = new Foo()
+ *   o.f = x                        o.f = x
+ *   if (cond) {                    if (cond) {
+ *                           =>       o' = new Foo()
+ *                                    o'.f = o.f
+ *     throw new Error(o)             throw new Error(o')
+ *   }                              }
+ *   return o.f                     return o.f
+ *
+ * Must run before load store analysis.
+ */
+class PartialEscapeAnalysis : public HOptimization {
+ public:
+  PartialEscapeAnalysis(HGraph* graph,
+                        OptimizingCompilerStats* stats,
+                        const char* name = kPartialEscapeAnalysisPassName)
+      : HOptimization(graph, name, stats) {}
+
+  void Run() OVERRIDE;
+
+  static constexpr const char* kPartialEscapeAnalysisPassName = "partial_escape_analysis";
+
+ private:
+  // Try to give the uses of `allocation` outside of the `can_return` blocks a copy of it.
+  void TryMaterializeOnUncommonBranches(HNewInstance* allocation,
+                                        const ArenaBitVector& can_return);
+
+  // Insert a copy of `allocation` before `escape`, and replace the uses of `allocation`
+  // dominated by it with the copy.
+  void Materialize(HNewInstance* allocation,
+                   const ScopedArenaVector<const FieldInfo*>& fields,
+                   HInstruction* escape);
+
+  DISALLOW_COPY_AND_ASSIGN(PartialEscapeAnalysis);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_PARTIAL_ESCAPE_ANALYSIS_H_
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pass_costs.h"
+
+#include <ostream>
+
+#include "base/mutex-inl.h"
+#include "thread-current-inl.h"
+
+namespace art {
+
+void PassCosts::AddPass(const char* pass_name, uint64_t time_ns, size_t arena_bytes) {
+  MutexLock mu(Thread::Current(), lock_);
+  Cost& cost = costs_[pass_name];
+  ++cost.runs;
+  cost.time_ns += time_ns;
+  cost.arena_bytes += arena_bytes;
+}
+
+void PassCosts::AddMethod(size_t dex_instructions) {
+  MutexLock mu(Thread::Current(), lock_);
+  ++methods_;
+  dex_instructions_ += dex_instructions;
+}
+
+std::map<std::string, PassCosts::Cost> PassCosts::GetPassCosts() const {
+  MutexLock mu(Thread::Current(), lock_);
+  return costs_;
+}
+
+uint64_t PassCosts::GetMethods() const {
+  MutexLock mu(Thread::Current(), lock_);
+  return methods_;
+}
+
+uint64_t PassCosts::GetDexInstructions() const {
+  MutexLock mu(Thread::Current(), lock_);
+  return dex_instructions_;
+}
+
+void PassCosts::Dump(std::ostream& os) const {
+  MutexLock mu(Thread::Current(), lock_);
+  os << "methods=" << methods_ << " dex_insns=" << dex_instructions_ << "\n";
+  for (const auto& entry : costs_) {
+    const Cost& cost = entry.second;
+    os << "pass=" << entry.first
+       << " runs=" << cost.runs
+       << " time_ns=" << cost.time_ns
+       << " ns_per_dex_insn=" << (dex_instructions_ != 0u ? cost.time_ns / dex_instructions_ : 0u)
+       << " arena_bytes=" << cost.arena_bytes << "\n";
+  }
+}
+
+}  // namespace art
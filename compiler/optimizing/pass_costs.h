@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_PASS_COSTS_H_
+#define ART_COMPILER_OPTIMIZING_PASS_COSTS_H_
+
+#include <stdint.h>
+#include <iosfwd>
+#include <map>
+#include <string>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+// The cost of each pass of the Optimizing compiler, summed over the methods compiled while it is
+// set in the CompilerOptions, to track the compile time of the passes. The compiler threads add
+// to it concurrently.
+class PassCosts {
+ public:
+  struct Cost {
+    uint64_t runs = 0u;
+    // Thread CPU time.
+    uint64_t time_ns = 0u;
+    // Bytes the pass added to the arena allocator of the graph. The scoped arena allocations
+    // of the pass are released when it ends and not counted.
+    uint64_t arena_bytes = 0u;
+  };
+
+  PassCosts() : lock_("pass costs lock") {}
+
+  void AddPass(const char* pass_name, uint64_t time_ns, size_t arena_bytes) REQUIRES(!lock_);
+  // A method compiled successfully, with the given number of dex instructions.
+  void AddMethod(size_t dex_instructions) REQUIRES(!lock_);
+
+  std::map<std::string, Cost> GetPassCosts() const REQUIRES(!lock_);
+  uint64_t GetMethods() const REQUIRES(!lock_);
+  uint64_t GetDexInstructions() const REQUIRES(!lock_);
+
+  // Dumps one line per pass, "pass=<name> runs=<n> time_ns=<ns> ns_per_dex_insn=<ns>
+  // arena_bytes=<bytes>", preceded by a "methods=<n> dex_insns=<n>" line, to be compared by
+  // scripts.
+  void Dump(std::ostream& os) const REQUIRES(!lock_);
+
+ private:
+  mutable Mutex lock_;
+  std::map<std::string, Cost> costs_ GUARDED_BY(lock_);
+  uint64_t methods_ GUARDED_BY(lock_) = 0u;
+  uint64_t dex_instructions_ GUARDED_BY(lock_) = 0u;
+
+  DISALLOW_COPY_AND_ASSIGN(PassCosts);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_PASS_COSTS_H_
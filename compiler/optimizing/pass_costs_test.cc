@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "pass_costs.h"
+
+#include <iostream>
+#include <sstream>
+
+#include "base/timing_logger.h"
+#include "common_compiler_test.h"
+#include "driver/compiler_driver.h"
+#include "driver/compiler_options.h"
+#include "load_store_elimination.h"
+#include "loop_optimization.h"
+#include "register_allocator.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+// Compiles the CompileTimeCorpus dex file in process and prints the cost of each pass, so that
+// the compile time of the passes can be compared between builds:
+//
+//   art_compiler_tests --gtest_filter=PassCostsTest.* | grep '^pass-costs '
+class PassCostsTest : public CommonCompilerTest {
+ protected:
+  void CompileCorpus() REQUIRES(!Locks::mutator_lock_) {
+    jobject class_loader;
+    {
+      ScopedObjectAccess soa(Thread::Current());
+      class_loader = LoadDex("CompileTimeCorpus");
+    }
+    std::vector<const DexFile*> dex_files = GetDexFiles(class_loader);
+    TimingLogger timings("PassCostsTest::CompileCorpus", false, false);
+    compiler_options_->SetPassCosts(&pass_costs_);
+    compiler_driver_->SetDexFilesForOatFile(dex_files);
+    compiler_driver_->CompileAll(class_loader, dex_files, &timings);
+    compiler_options_->SetPassCosts(nullptr);
+  }
+
+  PassCosts pass_costs_;
+};
+
+TEST_F(PassCostsTest, CompileCorpus) {
+  CompileCorpus();
+
+  ASSERT_NE(0u, pass_costs_.GetMethods());
+  ASSERT_NE(0u, pass_costs_.GetDexInstructions());
+  std::map<std::string, PassCosts::Cost> costs = pass_costs_.GetPassCosts();
+  for (const char* pass_name : { LoadStoreElimination::kLoadStoreEliminationPassName,
+                                 HLoopOptimization::kLoopOptimizationPassName,
+                                 RegisterAllocator::kRegisterAllocatorPassName }) {
+    auto it = costs.find(pass_name);
+    ASSERT_TRUE(it != costs.end()) << pass_name;
+    EXPECT_NE(0u, it->second.runs) << pass_name;
+  }
+
+  std::ostringstream oss;
+  pass_costs_.Dump(oss);
+  std::istringstream lines(oss.str());
+  for (std::string line; std::getline(lines, line); ) {
+    std::cout << "pass-costs " << line << std::endl;
+  }
+}
+
+}  // namespace art
@@ -151,7 +151,12 @@ bool PrepareForRegisterAllocation::CanEmitConditionAt(HCondition* condition,
     return false;
   }
 
-  if (user->IsIf() || user->IsDeoptimize()) {
+  if (user->IsIf()) {
+    // Baseline code counts the outcome of the branch, from the condition in a register.
+    return !GetGraph()->IsCompilingBaseline();
+  }
+
+  if (user->IsDeoptimize()) {
     return true;
   }
 
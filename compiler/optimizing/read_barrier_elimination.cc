@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "read_barrier_elimination.h"
+
+#include "nodes.h"
+
+namespace art {
+
+// Returns whether the thread may be suspended at `instruction`, and then flipped by the GC.
+static bool MaySuspend(HInstruction* instruction) {
+  if (instruction->IsNullCheck() ||
+      instruction->IsBoundsCheck() ||
+      instruction->IsDivZeroCheck()) {
+    // These only call the runtime to throw, the instructions after them are not executed.
+    return false;
+  }
+  // The runtime calls that may suspend need an environment for the stack maps.
+  return instruction->IsInvoke() ||
+         instruction->NeedsEnvironment() ||
+         instruction->GetSideEffects().Includes(SideEffects::CanTriggerGC());
+}
+
+// Returns whether no instruction between `allocation` and `load` may suspend the thread.
+// The allocation dominates the load, it is found walking back through single predecessors
+// unless the path merges with another one.
+static bool IsFreshAllocation(HInstruction* allocation, HInstruction* load) {
+  HBasicBlock* block = load->GetBlock();
+  HInstruction* instruction = load->GetPrevious();
+  while (true) {
+    for (; instruction != nullptr; instruction = instruction->GetPrevious()) {
+      if (instruction == allocation) {
+        return true;
+      } else if (MaySuspend(instruction)) {
+        return false;
+      }
+    }
+    // A catch block is entered with an exception thrown, so after a runtime call.
+    if (block->IsCatchBlock() || block->GetPredecessors().size() != 1u) {
+      return false;
+    }
+    block = block->GetSinglePredecessor();
+    instruction = block->GetLastInstruction();
+  }
+}
+
+static bool IsAllocation(HInstruction* instruction) {
+  // A string allocation is replaced by the result of the StringFactory call.
+  return instruction->IsNewArray() ||
+         (instruction->IsNewInstance() && !instruction->AsNewInstance()->IsStringAlloc());
+}
+
+void ReadBarrierElimination::Run() {
+  if (!kEmitCompilerReadBarrier || !kUseBakerReadBarrier) {
+    return;
+  }
+  for (HBasicBlock* block : graph_->GetReversePostOrder()) {
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instruction = it.Current();
+      if (instruction->GetType() != DataType::Type::kReference) {
+        continue;
+      }
+      if (instruction->IsInstanceFieldGet()) {
+        HInstanceFieldGet* field_get = instruction->AsInstanceFieldGet();
+        if (IsAllocation(field_get->InputAt(0)) &&
+            IsFreshAllocation(field_get->InputAt(0), field_get)) {
+          field_get->SetReadBarrierElided();
+          MaybeRecordStat(stats_, MethodCompilationStat::kReadBarrierElided);
+        }
+      } else if (instruction->IsArrayGet()) {
+        HArrayGet* array_get = instruction->AsArrayGet();
+        if (IsAllocation(array_get->GetArray()) &&
+            IsFreshAllocation(array_get->GetArray(), array_get)) {
+          array_get->SetReadBarrierElided();
+          MaybeRecordStat(stats_, MethodCompilationStat::kReadBarrierElided);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace art
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_READ_BARRIER_ELIMINATION_H_
+#define ART_COMPILER_OPTIMIZING_READ_BARRIER_ELIMINATION_H_
+
+#include "optimization.h"
+
+namespace art {
+
+/**
+ * Optimization pass eliding the Baker read barriers of the reference loads from
+ * an object allocated by the compiled code, when the thread cannot be suspended
+ * between the allocation and the load:
+ *
+ *   o = new Object[n]
+ *   o[i] = x
+ *   y = o[j]          // No read barrier.
+ *   foo()             // May suspend.
+ *   z = o[j]          // Read barrier.
+ *
+ * The concurrent copying collector only flips the threads to the to-space and
+ * grays objects at suspend points. An object allocated since the last one is
+ * never gray, so the barrier would always take its fast path.
+ *
+ * Must run last, as the passes moving instructions don't keep the loads away
+ * from the suspend points.
+ */
+class ReadBarrierElimination : public HOptimization {
+ public:
+  ReadBarrierElimination(HGraph* graph,
+                         OptimizingCompilerStats* stats,
+                         const char* name = kReadBarrierEliminationPassName)
+      : HOptimization(graph, name, stats) {}
+
+  void Run() OVERRIDE;
+
+  static constexpr const char* kReadBarrierEliminationPassName = "read_barrier_elimination";
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ReadBarrierElimination);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_READ_BARRIER_ELIMINATION_H_
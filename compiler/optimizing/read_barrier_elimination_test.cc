@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "read_barrier_elimination.h"
+
+#include "nodes.h"
+#include "optimizing_unit_test.h"
+
+#include "gtest/gtest.h"
+
+namespace art {
+
+class ReadBarrierEliminationTest : public OptimizingUnitTest {};
+
+TEST_F(ReadBarrierEliminationTest, FreshArray) {
+  HGraph* graph = CreateGraph();
+  HBasicBlock* entry = new (GetAllocator()) HBasicBlock(graph);
+  graph->AddBlock(entry);
+  graph->SetEntryBlock(entry);
+  HBasicBlock* block1 = new (GetAllocator()) HBasicBlock(graph);
+  graph->AddBlock(block1);
+  HBasicBlock* block2 = new (GetAllocator()) HBasicBlock(graph);
+  graph->AddBlock(block2);
+  HBasicBlock* exit = new (GetAllocator()) HBasicBlock(graph);
+  graph->AddBlock(exit);
+  graph->SetExitBlock(exit);
+  entry->AddSuccessor(block1);
+  block1->AddSuccessor(block2);
+  block2->AddSuccessor(exit);
+
+  // entry:
+  // cls           ParameterValue
+  // length        ParameterValue
+  // param         ParameterValue
+  // block1:
+  // new_array     NewArray [cls, length]
+  // get1          ArrayGet [new_array, c0]
+  // block2:
+  // get2          ArrayGet [new_array, c0]
+  // get_param     ArrayGet [param, c0]
+  // suspend       SuspendCheck
+  // get3          ArrayGet [new_array, c0]
+  HInstruction* cls = new (GetAllocator()) HParameterValue(
+      graph->GetDexFile(), dex::TypeIndex(0), 0, DataType::Type::kReference);
+  HInstruction* length = new (GetAllocator()) HParameterValue(
+      graph->GetDexFile(), dex::TypeIndex(1), 1, DataType::Type::kInt32);
+  HInstruction* param = new (GetAllocator()) HParameterValue(
+      graph->GetDexFile(), dex::TypeIndex(0), 2, DataType::Type::kReference);
+  HInstruction* c0 = graph->GetIntConstant(0);
+  entry->AddInstruction(cls);
+  entry->AddInstruction(length);
+  entry->AddInstruction(param);
+  entry->AddInstruction(new (GetAllocator()) HGoto());
+
+  HInstruction* new_array = new (GetAllocator()) HNewArray(cls, length, 0);
+  HArrayGet* get1 = new (GetAllocator()) HArrayGet(new_array, c0, DataType::Type::kReference, 0);
+  block1->AddInstruction(new_array);
+  block1->AddInstruction(get1);
+  block1->AddInstruction(new (GetAllocator()) HGoto());
+
+  HArrayGet* get2 = new (GetAllocator()) HArrayGet(new_array, c0, DataType::Type::kReference, 0);
+  HArrayGet* get_param = new (GetAllocator()) HArrayGet(param, c0, DataType::Type::kReference, 0);
+  HArrayGet* get3 = new (GetAllocator()) HArrayGet(new_array, c0, DataType::Type::kReference, 0);
+  block2->AddInstruction(get2);
+  block2->AddInstruction(get_param);
+  block2->AddInstruction(new (GetAllocator()) HSuspendCheck());
+  block2->AddInstruction(get3);
+  block2->AddInstruction(new (GetAllocator()) HReturnVoid());
+
+  exit->AddInstruction(new (GetAllocator()) HExit());
+
+  graph->BuildDominatorTree();
+  ReadBarrierElimination(graph, /* stats */ nullptr).Run();
+
+  // The barriers are only elided when the compiled code emits Baker read barriers.
+  const bool elided = kEmitCompilerReadBarrier && kUseBakerReadBarrier;
+  EXPECT_EQ(get1->IsReadBarrierElided(), elided);
+  EXPECT_EQ(get2->IsReadBarrierElided(), elided);
+  // Not an allocation.
+  EXPECT_FALSE(get_param->IsReadBarrierElided());
+  // The thread may be suspended since the allocation.
+  EXPECT_FALSE(get3->IsReadBarrierElided());
+}
+
+}  // namespace art
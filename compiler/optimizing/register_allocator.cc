@@ -47,6 +47,9 @@ std::unique_ptr<RegisterAllocator> RegisterAllocator::Create(ScopedArenaAllocato
     case kRegisterAllocatorGraphColor:
       return std::unique_ptr<RegisterAllocator>(
           new (allocator) RegisterAllocatorGraphColor(allocator, codegen, analysis));
+    case kRegisterAllocatorLinearScanFast:
+      return std::unique_ptr<RegisterAllocator>(new (allocator) RegisterAllocatorLinearScan(
+          allocator, codegen, analysis, /* spill_blocked_intervals */ true));
     default:
       LOG(FATAL) << "Invalid register allocation strategy: " << strategy;
       UNREACHABLE();
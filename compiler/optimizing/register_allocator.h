@@ -40,7 +40,11 @@ class RegisterAllocator : public DeletableArenaObject<kArenaAllocRegisterAllocat
  public:
   enum Strategy {
     kRegisterAllocatorLinearScan,
-    kRegisterAllocatorGraphColor
+    kRegisterAllocatorGraphColor,
+    // Linear scan that spills the interval being allocated instead of evicting the
+    // active and inactive intervals when no register is free. It trades some code
+    // quality for allocation time, for the JIT's baseline code and large methods.
+    kRegisterAllocatorLinearScanFast
   };
 
   static constexpr Strategy kRegisterAllocatorDefault = kRegisterAllocatorLinearScan;
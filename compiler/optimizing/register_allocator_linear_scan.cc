@@ -42,7 +42,8 @@ static bool IsLowOfUnalignedPairInterval(LiveInterval* low) {
 
 RegisterAllocatorLinearScan::RegisterAllocatorLinearScan(ScopedArenaAllocator* allocator,
                                                          CodeGenerator* codegen,
-                                                         const SsaLivenessAnalysis& liveness)
+                                                         const SsaLivenessAnalysis& liveness,
+                                                         bool spill_blocked_intervals)
       : RegisterAllocator(allocator, codegen, liveness),
         unhandled_core_intervals_(allocator->Adapter(kArenaAllocRegisterAllocator)),
         unhandled_fp_intervals_(allocator->Adapter(kArenaAllocRegisterAllocator)),
@@ -64,7 +65,8 @@ RegisterAllocatorLinearScan::RegisterAllocatorLinearScan(ScopedArenaAllocator* a
         registers_array_(nullptr),
         blocked_core_registers_(codegen->GetBlockedCoreRegisters()),
         blocked_fp_registers_(codegen->GetBlockedFloatingPointRegisters()),
-        reserved_out_slots_(0) {
+        reserved_out_slots_(0),
+        spill_blocked_intervals_(spill_blocked_intervals) {
   temp_intervals_.reserve(4);
   int_spill_slots_.reserve(kDefaultNumberOfSpillSlots);
   long_spill_slots_.reserve(kDefaultNumberOfSpillSlots);
@@ -883,6 +885,14 @@ bool RegisterAllocatorLinearScan::AllocateBlockedReg(LiveInterval* current) {
   } else if (first_register_use == kNoLifetime) {
     AllocateSpillSlotFor(current);
     return false;
+  } else if (spill_blocked_intervals_ && current->GetStart() < (first_register_use - 1)) {
+    // Spill until just before the first register use, without looking at whether
+    // another interval would be a better candidate.
+    AllocateSpillSlotFor(current);
+    LiveInterval* split = SplitBetween(current, current->GetStart(), first_register_use - 1);
+    DCHECK(current != split);
+    AddSorted(unhandled_, split);
+    return false;
   }
 
   // First set all registers as not being used.
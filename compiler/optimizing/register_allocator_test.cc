@@ -77,6 +77,9 @@ TEST_F(RegisterAllocatorTest, test_name##_LinearScan) {\
 }\
 TEST_F(RegisterAllocatorTest, test_name##_GraphColor) {\
   test_name(Strategy::kRegisterAllocatorGraphColor);\
+}\
+TEST_F(RegisterAllocatorTest, test_name##_LinearScanFast) {\
+  test_name(Strategy::kRegisterAllocatorLinearScanFast);\
 }
 
 bool RegisterAllocatorTest::Check(const uint16_t* data, Strategy strategy) {
@@ -32,6 +32,7 @@
 #include "nodes.h"
 #include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
+#include "subtype_check.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
 
 namespace art {
@@ -236,6 +237,77 @@ HLoadClass::LoadKind HSharpening::ComputeLoadClassKind(
   return load_kind;
 }
 
+static bool TryGetTypeCheckBitstring(Handle<mirror::Class> klass,
+                                     CodeGenerator* codegen,
+                                     CompilerDriver* compiler_driver,
+                                     /*out*/ uint32_t* bitstring_path_to_root,
+                                     /*out*/ uint32_t* bitstring_mask)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  DCHECK(!klass->IsProxyClass());
+  DCHECK(!klass->IsArrayClass());
+
+  if (Runtime::Current()->UseJitCompilation()) {
+    // The bitstring of the runtime is the one the compiled code sees, assign it if needed.
+  } else if (codegen->GetCompilerOptions().IsBootImage()) {
+    // The bitstring of a boot image class is written to the image. Other classes get
+    // their bitstring at runtime, if they get one at all.
+    if (!compiler_driver->GetSupportBootImageFixup()) {
+      // compiler_driver_test.
+      return false;
+    }
+    const char* descriptor = klass->GetDexFile().StringByTypeIdx(klass->GetDexTypeIndex());
+    if (!compiler_driver->IsImageClass(descriptor)) {
+      return false;
+    }
+    // With --force-determinism, the driver assigned the bitstrings before compiling.
+  } else {
+    // TODO: Use the bitstring of a boot image class for app compilation. The bitstrings in
+    // the memory of dex2oat may have been assigned after the image was written.
+    return false;
+  }
+
+  // Once assigned, the bitstring of a class does not change. It may not get assigned if
+  // the class hierarchy is too deep or too wide.
+  MutexLock subtype_check_lock(Thread::Current(), *Locks::subtype_check_lock_);
+  ObjPtr<mirror::Class> target = klass.Get();
+  if (SubtypeCheck<ObjPtr<mirror::Class>>::EnsureAssigned(target) != SubtypeCheckInfo::kAssigned) {
+    return false;
+  }
+  *bitstring_path_to_root =
+      SubtypeCheck<ObjPtr<mirror::Class>>::GetEncodedPathToRootForTarget(target);
+  *bitstring_mask = SubtypeCheck<ObjPtr<mirror::Class>>::GetEncodedPathToRootMask(target);
+  return true;
+}
+
+TypeCheckKind HSharpening::ComputeTypeCheckKind(Handle<mirror::Class> klass,
+                                                CodeGenerator* codegen,
+                                                CompilerDriver* compiler_driver,
+                                                /*out*/ uint32_t* bitstring_path_to_root,
+                                                /*out*/ uint32_t* bitstring_mask) {
+  if (klass == nullptr) {
+    return TypeCheckKind::kUnresolvedCheck;
+  } else if (klass->IsInterface()) {
+    return TypeCheckKind::kInterfaceCheck;
+  } else if (klass->IsArrayClass()) {
+    if (klass->GetComponentType()->IsObjectClass()) {
+      return TypeCheckKind::kArrayObjectCheck;
+    } else if (klass->CannotBeAssignedFromOtherTypes()) {
+      return TypeCheckKind::kExactCheck;
+    } else {
+      return TypeCheckKind::kArrayCheck;
+    }
+  } else if (klass->IsFinal()) {
+    return TypeCheckKind::kExactCheck;
+  } else if (TryGetTypeCheckBitstring(
+                 klass, codegen, compiler_driver, bitstring_path_to_root, bitstring_mask)) {
+    return TypeCheckKind::kBitstringCheck;
+  } else if (klass->IsAbstract()) {
+    return TypeCheckKind::kAbstractClassCheck;
+  } else {
+    return TypeCheckKind::kClassHierarchyCheck;
+  }
+}
+
 void HSharpening::ProcessLoadString(
     HLoadString* load_string,
     CodeGenerator* codegen,
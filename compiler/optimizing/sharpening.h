@@ -58,6 +58,15 @@ class HSharpening : public HOptimization {
                                                    const DexCompilationUnit& dex_compilation_unit)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Used by the builder. For kBitstringCheck, also returns the bitstring of `klass`
+  // and its mask.
+  static TypeCheckKind ComputeTypeCheckKind(Handle<mirror::Class> klass,
+                                            CodeGenerator* codegen,
+                                            CompilerDriver* compiler_driver,
+                                            /*out*/ uint32_t* bitstring_path_to_root,
+                                            /*out*/ uint32_t* bitstring_mask)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Used by Sharpening and InstructionSimplifier.
   static void SharpenInvokeStaticOrDirect(HInvokeStaticOrDirect* invoke,
                                           CodeGenerator* codegen,
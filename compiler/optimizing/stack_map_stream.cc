@@ -38,6 +38,7 @@ void StackMapStream::BeginStackMapEntry(uint32_t dex_pc,
   current_entry_.sp_mask = sp_mask;
   current_entry_.inlining_depth = inlining_depth;
   current_entry_.inline_infos_start_index = inline_infos_.size();
+  current_entry_.inline_info_index = StackMap::kNoInlineInfo;
   current_entry_.stack_mask_index = 0;
   current_entry_.dex_method_index = dex::kDexNoIndex;
   current_entry_.dex_register_entry.num_dex_registers = num_dex_registers;
@@ -160,7 +161,7 @@ size_t StackMapStream::PrepareForFillIn() {
   encoding.dex_register_map.num_bytes = ComputeDexRegisterMapsSize();
   encoding.location_catalog.num_entries = location_catalog_entries_.size();
   encoding.location_catalog.num_bytes = ComputeDexRegisterLocationCatalogSize();
-  encoding.inline_info.num_entries = inline_infos_.size();
+  encoding.inline_info.num_entries = PrepareInlineInfos();
   // Must be done before calling ComputeInlineInfoEncoding since ComputeInlineInfoEncoding requires
   // dex_method_index_idx to be filled in.
   PrepareMethodIndices();
@@ -381,11 +382,14 @@ void StackMapStream::FillInCodeInfo(MemoryRegion region) {
 
     // Set the inlining info.
     if (entry.inlining_depth != 0) {
-      InlineInfo inline_info = code_info.GetInlineInfo(next_inline_info_index, encoding);
-
       // Fill in the index.
-      stack_map.SetInlineInfoIndex(encoding.stack_map.encoding, next_inline_info_index);
-      DCHECK_EQ(next_inline_info_index, entry.inline_infos_start_index);
+      stack_map.SetInlineInfoIndex(encoding.stack_map.encoding, entry.inline_info_index);
+      if (entry.inline_info_index != next_inline_info_index) {
+        // Shared with a previous stack map, already filled in.
+        DCHECK_LT(entry.inline_info_index, next_inline_info_index);
+        continue;
+      }
+      InlineInfo inline_info = code_info.GetInlineInfo(next_inline_info_index, encoding);
       next_inline_info_index += entry.inlining_depth;
 
       inline_info.SetDepth(encoding.inline_info.encoding, entry.inlining_depth);
@@ -421,6 +425,7 @@ void StackMapStream::FillInCodeInfo(MemoryRegion region) {
       stack_map.SetInlineInfoIndex(encoding.stack_map.encoding, StackMap::kNoInlineInfo);
     }
   }
+  DCHECK_EQ(next_inline_info_index, encoding.inline_info.num_entries);
 
   // Write stack masks table.
   const size_t stack_mask_bits = encoding.stack_mask.encoding.BitSize();
@@ -585,6 +590,66 @@ void StackMapStream::PrepareMethodIndices() {
   method_indices_.resize(dedupe.size());
 }
 
+size_t StackMapStream::PrepareInlineInfos() {
+  // Several stack maps of the same inlined instruction, for example for an implicit null check
+  // and the call, have the same inlined frames and can share their inline infos. Like for the
+  // dex register maps, the candidates are bucketed by a hash and compared in full.
+  ScopedArenaSafeMap<size_t, ScopedArenaVector<size_t>> hash_to_stack_map_indices(
+      std::less<size_t>(), allocator_->Adapter(kArenaAllocStackMapStream));
+  size_t num_inline_infos = 0u;
+  for (size_t i = 0, e = stack_maps_.size(); i < e; ++i) {
+    StackMapEntry& entry = stack_maps_[i];
+    if (entry.inlining_depth == 0) {
+      continue;
+    }
+    size_t hash = entry.inlining_depth;
+    for (size_t d = 0; d < entry.inlining_depth; ++d) {
+      const InlineInfoEntry& inline_entry = inline_infos_[entry.inline_infos_start_index + d];
+      hash = hash * 31u + inline_entry.dex_pc;
+      hash = hash * 31u + inline_entry.dex_register_map_index;
+      hash = hash * 31u + ((inline_entry.method != nullptr)
+          ? reinterpret_cast<uintptr_t>(inline_entry.method)
+          : inline_entry.method_index);
+    }
+    auto it = hash_to_stack_map_indices.find(hash);
+    if (it == hash_to_stack_map_indices.end()) {
+      it = hash_to_stack_map_indices.Put(
+          hash, ScopedArenaVector<size_t>(allocator_->Adapter(kArenaAllocStackMapStream)));
+    }
+    auto same = std::find_if(it->second.begin(),
+                             it->second.end(),
+                             [&](size_t other) {
+                               return HaveTheSameInlineInfos(stack_maps_[other], entry);
+                             });
+    if (same != it->second.end()) {
+      entry.inline_info_index = stack_maps_[*same].inline_info_index;
+    } else {
+      entry.inline_info_index = num_inline_infos;
+      num_inline_infos += entry.inlining_depth;
+      it->second.push_back(i);
+    }
+  }
+  return num_inline_infos;
+}
+
+bool StackMapStream::HaveTheSameInlineInfos(const StackMapEntry& a,
+                                            const StackMapEntry& b) const {
+  if (a.inlining_depth != b.inlining_depth) {
+    return false;
+  }
+  for (size_t d = 0; d < a.inlining_depth; ++d) {
+    const InlineInfoEntry& a_entry = inline_infos_[a.inline_infos_start_index + d];
+    const InlineInfoEntry& b_entry = inline_infos_[b.inline_infos_start_index + d];
+    // The dex register maps are deduplicated, so equal maps have the same index.
+    if (a_entry.dex_pc != b_entry.dex_pc ||
+        a_entry.method != b_entry.method ||
+        (a_entry.method == nullptr && a_entry.method_index != b_entry.method_index) ||
+        a_entry.dex_register_map_index != b_entry.dex_register_map_index) {
+      return false;
+    }
+  }
+  return true;
+}
 
 size_t StackMapStream::PrepareStackMasks(size_t entry_size_in_bits) {
   // Preallocate memory since we do not want it to move (the dedup map will point into it).
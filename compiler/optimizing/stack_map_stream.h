@@ -115,6 +115,7 @@ class StackMapStream : public ValueObject {
     BitVector* sp_mask;
     uint8_t inlining_depth;
     size_t inline_infos_start_index;
+    uint32_t inline_info_index;  // Index into the encoded inline info table.
     uint32_t stack_mask_index;
     uint32_t register_mask_index;
     DexRegisterMapEntry dex_register_entry;
@@ -189,6 +190,11 @@ class StackMapStream : public ValueObject {
   // Prepare and deduplicate method indices.
   void PrepareMethodIndices();
 
+  // Deduplicates the inline infos of stack maps with the same inlined frames, and returns the
+  // number of inline info entries to encode.
+  size_t PrepareInlineInfos();
+  bool HaveTheSameInlineInfos(const StackMapEntry& a, const StackMapEntry& b) const;
+
   // Deduplicate entry if possible and return the corresponding index into dex_register_entries_
   // array. If entry is not a duplicate, a new entry is added to dex_register_entries_.
   size_t AddDexRegisterMapEntry(const DexRegisterMapEntry& entry);
@@ -977,6 +977,70 @@ TEST(StackMapTest, TestDeduplicateStackMask) {
             stack_map2.GetStackMaskIndex(encoding.stack_map.encoding));
 }
 
+TEST(StackMapTest, TestDeduplicateInlineInfo) {
+  ArenaPool pool;
+  ArenaStack arena_stack(&pool);
+  ScopedArenaAllocator allocator(&arena_stack);
+  StackMapStream stream(&allocator, kRuntimeISA);
+  ArtMethod art_method;
+
+  ArenaBitVector sp_mask(&allocator, 0, true);
+  // Same inlined frames, different dex registers of the outer method.
+  stream.BeginStackMapEntry(0, 4, 0x3, &sp_mask, 1, 2);
+  stream.AddDexRegisterEntry(Kind::kInStack, 0);
+  stream.BeginInlineInfoEntry(&art_method, 2, 1);
+  stream.AddDexRegisterEntry(Kind::kInRegister, 3);
+  stream.EndInlineInfoEntry();
+  stream.BeginInlineInfoEntry(&art_method, 5, 0);
+  stream.EndInlineInfoEntry();
+  stream.EndStackMapEntry();
+  stream.BeginStackMapEntry(0, 8, 0x3, &sp_mask, 1, 2);
+  stream.AddDexRegisterEntry(Kind::kConstant, 7);
+  stream.BeginInlineInfoEntry(&art_method, 2, 1);
+  stream.AddDexRegisterEntry(Kind::kInRegister, 3);
+  stream.EndInlineInfoEntry();
+  stream.BeginInlineInfoEntry(&art_method, 5, 0);
+  stream.EndInlineInfoEntry();
+  stream.EndStackMapEntry();
+  // Different dex register map in the inlined frame.
+  stream.BeginStackMapEntry(0, 12, 0x3, &sp_mask, 1, 2);
+  stream.AddDexRegisterEntry(Kind::kInStack, 0);
+  stream.BeginInlineInfoEntry(&art_method, 2, 1);
+  stream.AddDexRegisterEntry(Kind::kInRegister, 4);
+  stream.EndInlineInfoEntry();
+  stream.BeginInlineInfoEntry(&art_method, 5, 0);
+  stream.EndInlineInfoEntry();
+  stream.EndStackMapEntry();
+
+  size_t size = stream.PrepareForFillIn();
+  void* memory = allocator.Alloc(size, kArenaAllocMisc);
+  MemoryRegion region(memory, size);
+  stream.FillInCodeInfo(region);
+
+  CodeInfo code_info(region);
+  CodeInfoEncoding encoding = code_info.ExtractEncoding();
+  ASSERT_EQ(3u, code_info.GetNumberOfStackMaps(encoding));
+  ASSERT_EQ(4u, encoding.inline_info.num_entries);
+
+  StackMap stack_map1 = code_info.GetStackMapForNativePcOffset(4, encoding);
+  StackMap stack_map2 = code_info.GetStackMapForNativePcOffset(8, encoding);
+  StackMap stack_map3 = code_info.GetStackMapForNativePcOffset(12, encoding);
+  EXPECT_EQ(stack_map1.GetInlineInfoIndex(encoding.stack_map.encoding),
+            stack_map2.GetInlineInfoIndex(encoding.stack_map.encoding));
+  EXPECT_NE(stack_map1.GetInlineInfoIndex(encoding.stack_map.encoding),
+            stack_map3.GetInlineInfoIndex(encoding.stack_map.encoding));
+
+  InlineInfo inline_info = code_info.GetInlineInfoOf(stack_map2, encoding);
+  ASSERT_EQ(2u, inline_info.GetDepth(encoding.inline_info.encoding));
+  EXPECT_EQ(2u, inline_info.GetDexPcAtDepth(encoding.inline_info.encoding, 0));
+  EXPECT_EQ(5u, inline_info.GetDexPcAtDepth(encoding.inline_info.encoding, 1));
+  DexRegisterMap dex_registers =
+      code_info.GetDexRegisterMapAtDepth(0, inline_info, encoding, 1);
+  EXPECT_EQ(3, dex_registers.GetMachineRegister(0, 1, code_info, encoding));
+  DexRegisterMap outer_dex_registers = code_info.GetDexRegisterMapOf(stack_map2, encoding, 1);
+  EXPECT_EQ(7, outer_dex_registers.GetConstant(0, 1, code_info, encoding));
+}
+
 TEST(StackMapTest, TestInvokeInfo) {
   ArenaPool pool;
   ArenaStack arena_stack(&pool);
@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "superblock_cloner.h"
+
+#include "base/stl_util.h"
+
+namespace art {
+
+// Replace the values of `env`, a copy of `original`, by their mapped value, if any.
+static void RemapEnvironment(HEnvironment* env,
+                             HEnvironment* original,
+                             const ScopedArenaSafeMap<HInstruction*, HInstruction*>& map) {
+  for (; env != nullptr; env = env->GetParent(), original = original->GetParent()) {
+    DCHECK(original != nullptr);
+    DCHECK_EQ(env->Size(), original->Size());
+    for (size_t i = 0, e = env->Size(); i < e; ++i) {
+      auto it = map.find(original->GetInstructionAt(i));
+      if (it != map.end()) {
+        env->RemoveAsUserOfInput(i);
+        env->SetRawEnvAt(i, it->second);
+        it->second->AddEnvUseAt(env, i);
+      }
+    }
+  }
+}
+
+SuperblockCloner::SuperblockCloner(HGraph* graph,
+                                   HLoopInformation* loop,
+                                   ScopedArenaAllocator* allocator)
+    : graph_(graph),
+      loop_(loop),
+      allocator_(allocator),
+      blocks_(allocator->Adapter(kArenaAllocSuperblockCloner)),
+      exits_(allocator->Adapter(kArenaAllocSuperblockCloner)),
+      originals_(allocator->Adapter(kArenaAllocSuperblockCloner)),
+      block_map_(std::less<HBasicBlock*>(), allocator->Adapter(kArenaAllocSuperblockCloner)),
+      instruction_map_(std::less<HInstruction*>(),
+                       allocator->Adapter(kArenaAllocSuperblockCloner)),
+      first_copy_block_id_(0u),
+      original_preheader_(nullptr),
+      copy_preheader_(nullptr) {
+  for (HBlocksInLoopIterator it(*loop); !it.Done(); it.Advance()) {
+    HBasicBlock* block = it.Current();
+    blocks_.push_back(block);
+    for (HBasicBlock* successor : block->GetSuccessors()) {
+      if (!loop->Contains(*successor) && !ContainsElement(exits_, successor)) {
+        exits_.push_back(successor);
+      }
+    }
+  }
+}
+
+HBasicBlock* SuperblockCloner::GetUseLocation(HInstruction* user, size_t index) {
+  return user->IsPhi() ? user->GetBlock()->GetPredecessors()[index] : user->GetBlock();
+}
+
+HBasicBlock* SuperblockCloner::FindDominatingExit(HBasicBlock* block) const {
+  for (HBasicBlock* exit : exits_) {
+    if (exit->Dominates(block)) {
+      return exit;
+    }
+  }
+  return nullptr;
+}
+
+bool SuperblockCloner::IsInOriginalOrCopy(HBasicBlock* block) const {
+  // The copies are the last blocks added to the graph.
+  DCHECK_NE(first_copy_block_id_, 0u);
+  return loop_->Contains(*block) || block->GetBlockId() >= first_copy_block_id_;
+}
+
+HInstruction* SuperblockCloner::GetCopyOrSelf(HInstruction* instruction) const {
+  auto it = instruction_map_.find(instruction);
+  return (it != instruction_map_.end()) ? it->second : instruction;
+}
+
+bool SuperblockCloner::IsLoopClonable() const {
+  if (loop_->IsIrreducible() || !loop_->GetPreHeader()->GetLastInstruction()->IsGoto()) {
+    return false;
+  }
+  size_t number_of_instructions = 0;
+  for (HBasicBlock* block : blocks_) {
+    // Inner loops and exceptional control flow are not handled. The HIf of a copy keeps its
+    // successors in order with SwapSuccessors(), so switches are not handled either.
+    if (block->GetLoopInformation() != loop_ ||
+        block->IsTryBlock() ||
+        block->IsCatchBlock() ||
+        block->GetSuccessors().size() > 2u) {
+      return false;
+    }
+    for (HInstructionIterator it(block->GetPhis()); !it.Done(); it.Advance()) {
+      ++number_of_instructions;
+    }
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      if (!it.Current()->IsClonable()) {
+        return false;
+      }
+      ++number_of_instructions;
+    }
+  }
+  if (number_of_instructions > kMaxNumberOfInstructions) {
+    return false;
+  }
+  // The merge of a value with its copy is placed in an exit, which must have the
+  // loop as its only predecessor for now.
+  for (HBasicBlock* exit : exits_) {
+    if (exit->GetPredecessors().size() != 1u) {
+      return false;
+    }
+  }
+  // Each use after the loop must be dominated by one of the merges.
+  for (HBasicBlock* block : blocks_) {
+    for (HInstructionIterator it(block->GetPhis()); !it.Done(); it.Advance()) {
+      if (!AreUsesAfterLoopDominatedByExits(it.Current())) {
+        return false;
+      }
+    }
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      if (!AreUsesAfterLoopDominatedByExits(it.Current())) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool SuperblockCloner::AreUsesAfterLoopDominatedByExits(HInstruction* instruction) const {
+  for (const HUseListNode<HInstruction*>& use : instruction->GetUses()) {
+    HBasicBlock* location = GetUseLocation(use.GetUser(), use.GetIndex());
+    if (!loop_->Contains(*location) && FindDominatingExit(location) == nullptr) {
+      return false;
+    }
+  }
+  for (const HUseListNode<HEnvironment*>& use : instruction->GetEnvUses()) {
+    HBasicBlock* location = use.GetUser()->GetHolder()->GetBlock();
+    if (!loop_->Contains(*location) && FindDominatingExit(location) == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void SuperblockCloner::VersionLoop() {
+  DCHECK(IsLoopClonable());
+  ArenaAllocator* allocator = graph_->GetAllocator();
+  HBasicBlock* header = loop_->GetHeader();
+  original_preheader_ = graph_->SplitEdge(loop_->GetPreHeader(), header);
+  original_preheader_->AddInstruction(new (allocator) HGoto(header->GetDexPc()));
+  copy_preheader_ = new (allocator) HBasicBlock(graph_, header->GetDexPc());
+  graph_->AddBlock(copy_preheader_);
+  copy_preheader_->AddInstruction(new (allocator) HGoto(header->GetDexPc()));
+  CopyBlocks();
+  CopyEdges();
+  RemapCopies();
+  MergeLiveOuts();
+}
+
+void SuperblockCloner::CopyBlocks() {
+  ArenaAllocator* allocator = graph_->GetAllocator();
+  first_copy_block_id_ = graph_->GetBlocks().size();
+  for (HBasicBlock* block : blocks_) {
+    HBasicBlock* copy = new (allocator) HBasicBlock(graph_, block->GetDexPc());
+    graph_->AddBlock(copy);
+    block_map_.Put(block, copy);
+    // The copies start out with the inputs of the original, see RemapCopies().
+    for (HInstructionIterator it(block->GetPhis()); !it.Done(); it.Advance()) {
+      HInstruction* phi_copy = it.Current()->Clone(allocator);
+      copy->AddPhi(phi_copy->AsPhi());
+      instruction_map_.Put(it.Current(), phi_copy);
+      originals_.push_back(it.Current());
+    }
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instruction_copy = it.Current()->Clone(allocator);
+      copy->AddInstruction(instruction_copy);
+      instruction_map_.Put(it.Current(), instruction_copy);
+      originals_.push_back(it.Current());
+    }
+  }
+}
+
+void SuperblockCloner::CopyEdges() {
+  // Add the predecessors in the original order, which the phis rely on.
+  for (HBasicBlock* block : blocks_) {
+    HBasicBlock* copy = GetBlockCopy(block);
+    for (HBasicBlock* predecessor : block->GetPredecessors()) {
+      if (loop_->Contains(*predecessor)) {
+        copy->AddPredecessor(GetBlockCopy(predecessor));
+      } else {
+        DCHECK_EQ(block, loop_->GetHeader());
+        DCHECK_EQ(predecessor, original_preheader_);
+        copy->AddPredecessor(copy_preheader_);
+      }
+    }
+  }
+  // Add the exits, and fix the order of the successors, which the HIf relies on.
+  for (HBasicBlock* block : blocks_) {
+    HBasicBlock* copy = GetBlockCopy(block);
+    for (HBasicBlock* successor : block->GetSuccessors()) {
+      if (!loop_->Contains(*successor)) {
+        size_t index = successor->GetPredecessorIndexOf(block);
+        copy->AddSuccessor(successor);
+        for (HInstructionIterator it(successor->GetPhis()); !it.Done(); it.Advance()) {
+          HPhi* phi = it.Current()->AsPhi();
+          phi->AddInput(GetCopyOrSelf(phi->InputAt(index)));
+        }
+      }
+    }
+    if (copy->GetSuccessors().size() == 2u) {
+      HBasicBlock* first = block->GetSuccessors()[0];
+      if (copy->GetSuccessors()[0] != (loop_->Contains(*first) ? GetBlockCopy(first) : first)) {
+        copy->SwapSuccessors();
+      }
+    }
+  }
+}
+
+void SuperblockCloner::RemapCopies() {
+  for (HInstruction* original : originals_) {
+    HInstruction* copy = GetInstructionCopy(original);
+    for (size_t i = 0, e = copy->InputCount(); i < e; ++i) {
+      auto it = instruction_map_.find(copy->InputAt(i));
+      if (it != instruction_map_.end()) {
+        copy->ReplaceInput(it->second, i);
+      }
+    }
+    if (original->HasEnvironment()) {
+      copy->CopyEnvironmentFrom(original->GetEnvironment());
+      RemapEnvironment(copy->GetEnvironment(), original->GetEnvironment(), instruction_map_);
+    }
+  }
+}
+
+void SuperblockCloner::MergeLiveOuts() {
+  ArenaAllocator* allocator = graph_->GetAllocator();
+  // Exits to the merge of the current value.
+  ScopedArenaSafeMap<HBasicBlock*, HPhi*> merges(
+      std::less<HBasicBlock*>(), allocator_->Adapter(kArenaAllocSuperblockCloner));
+  for (HInstruction* original : originals_) {
+    HInstruction* copy = GetInstructionCopy(original);
+    merges.clear();
+    auto get_merge = [&](HBasicBlock* location) {
+      HBasicBlock* exit = FindDominatingExit(location);
+      DCHECK(exit != nullptr);  // Pre-checked by IsLoopClonable().
+      auto it = merges.find(exit);
+      if (it != merges.end()) {
+        return it->second;
+      }
+      DCHECK_EQ(exit->GetPredecessors().size(), 2u);
+      HPhi* phi = new (allocator) HPhi(allocator, kNoRegNumber, 0, original->GetType());
+      if (original->GetType() == DataType::Type::kReference) {
+        phi->SetReferenceTypeInfo(original->GetReferenceTypeInfo());
+      }
+      phi->SetCanBeNull(original->CanBeNull());
+      exit->AddPhi(phi);
+      phi->AddInput(original);
+      phi->AddInput(copy);
+      merges.Put(exit, phi);
+      return phi;
+    };
+    const HUseList<HInstruction*>& uses = original->GetUses();
+    for (auto it = uses.begin(), end = uses.end(); it != end; /* ++it below */) {
+      HInstruction* user = it->GetUser();
+      size_t index = it->GetIndex();
+      ++it;  // increment before replacing
+      HBasicBlock* location = GetUseLocation(user, index);
+      if (!IsInOriginalOrCopy(location)) {
+        user->ReplaceInput(get_merge(location), index);
+      }
+    }
+    const HUseList<HEnvironment*>& env_uses = original->GetEnvUses();
+    for (auto it = env_uses.begin(), end = env_uses.end(); it != end; /* ++it below */) {
+      HEnvironment* user = it->GetUser();
+      size_t index = it->GetIndex();
+      ++it;  // increment before replacing
+      if (!IsInOriginalOrCopy(user->GetHolder()->GetBlock())) {
+        HPhi* merge = get_merge(user->GetHolder()->GetBlock());
+        user->RemoveAsUserOfInput(index);
+        user->SetRawEnvAt(index, merge);
+        merge->AddEnvUseAt(user, index);
+      }
+    }
+  }
+}
+
+}  // namespace art
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_SUPERBLOCK_CLONER_H_
+#define ART_COMPILER_OPTIMIZING_SUPERBLOCK_CLONER_H_
+
+#include "base/scoped_arena_allocator.h"
+#include "base/scoped_arena_containers.h"
+#include "nodes.h"
+
+namespace art {
+
+/**
+ * Copies the blocks of a loop, so that an optimization can specialize one of two versions
+ * of the loop and pick one of them at runtime (loop versioning).
+ *
+ * The original preheader is split: it still falls through to the original loop, through
+ * GetOriginalPreHeader(), while the copy is entered through GetCopyPreHeader(), which has no
+ * predecessor yet. The caller selects the version, typically by ending the preheader with an
+ * HIf to both of these blocks. Values of the loop used after it are merged with their copy by
+ * new phis in the loop exits. The dominance and loop information of the graph are stale after
+ * VersionLoop() and must be rebuilt.
+ *
+ *          preheader                   preheader     <- caller adds the selection
+ *              |               =>       /     \
+ *            loop            original_pre   copy_pre
+ *              |                  |            |
+ *            exits              loop         loop'
+ *                                   \        /
+ *                                     exits        <- phi(value, value')
+ */
+class SuperblockCloner : public ValueObject {
+ public:
+  // Loops with more instructions and phis than this are not copied.
+  static constexpr size_t kMaxNumberOfInstructions = 128;
+
+  SuperblockCloner(HGraph* graph, HLoopInformation* loop, ScopedArenaAllocator* allocator);
+
+  // Returns whether the loop can be copied: an innermost and reducible loop outside of any
+  // try block, with only clonable instructions, and with each use after the loop dominated by
+  // one of its exits. Requires valid dominance information.
+  bool IsLoopClonable() const;
+
+  // Copies the loop, must only be called if IsLoopClonable().
+  void VersionLoop();
+
+  HBasicBlock* GetOriginalPreHeader() const { return original_preheader_; }
+  HBasicBlock* GetCopyPreHeader() const { return copy_preheader_; }
+
+  // Returns the copy of a block or an instruction of the loop, after VersionLoop().
+  HBasicBlock* GetBlockCopy(HBasicBlock* block) const { return block_map_.Get(block); }
+  HInstruction* GetInstructionCopy(HInstruction* instruction) const {
+    return instruction_map_.Get(instruction);
+  }
+
+ private:
+  // Returns the block in which a use of a loop value is located, which for a phi is the
+  // predecessor the value flows from.
+  static HBasicBlock* GetUseLocation(HInstruction* user, size_t index);
+
+  // Returns the exit of the loop which dominates `block`, or null if there is none.
+  HBasicBlock* FindDominatingExit(HBasicBlock* block) const;
+
+  // Returns whether each use of `instruction` outside of the loop is dominated by an exit.
+  bool AreUsesAfterLoopDominatedByExits(HInstruction* instruction) const;
+
+  bool IsInOriginalOrCopy(HBasicBlock* block) const;
+
+  // Returns the copy of `instruction`, or `instruction` if it is not part of the loop.
+  HInstruction* GetCopyOrSelf(HInstruction* instruction) const;
+
+  // Copies the blocks with their phis and instructions, then the edges between them.
+  void CopyBlocks();
+  void CopyEdges();
+
+  // Makes the copies use the copied values, in their inputs and environments.
+  void RemapCopies();
+
+  // Replaces the uses after the loop of each value by the merge with its copy.
+  void MergeLiveOuts();
+
+  HGraph* const graph_;
+  HLoopInformation* const loop_;
+  ScopedArenaAllocator* const allocator_;
+
+  // The blocks of the loop, in block id order, and their successors outside of the loop.
+  ScopedArenaVector<HBasicBlock*> blocks_;
+  ScopedArenaVector<HBasicBlock*> exits_;
+
+  // The phis and instructions of the loop in block id order, and the originals to their copy.
+  ScopedArenaVector<HInstruction*> originals_;
+  ScopedArenaSafeMap<HBasicBlock*, HBasicBlock*> block_map_;
+  ScopedArenaSafeMap<HInstruction*, HInstruction*> instruction_map_;
+
+  // The copies of the blocks have the ids from this one on.
+  size_t first_copy_block_id_;
+
+  HBasicBlock* original_preheader_;
+  HBasicBlock* copy_preheader_;
+
+  DISALLOW_COPY_AND_ASSIGN(SuperblockCloner);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_SUPERBLOCK_CLONER_H_
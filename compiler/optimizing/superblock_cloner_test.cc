@@ -17,6 +17,7 @@
 #include "graph_checker.h"
 #include "nodes.h"
 #include "optimizing_unit_test.h"
+#include "superblock_cloner.h"
 
 #include "gtest/gtest.h"
 
@@ -182,4 +183,54 @@ TEST_F(SuperblockClonerTest, IndividualInstrCloner) {
   EXPECT_NE(new_suspend_check, nullptr);
 }
 
+TEST_F(SuperblockClonerTest, LoopVersioning) {
+  HBasicBlock* header = nullptr;
+  HBasicBlock* loop_body = nullptr;
+
+  CreateBasicLoopControlFlow(&header, &loop_body);
+  CreateBasicLoopDataFlow(header, loop_body);
+  HBasicBlock* preheader = header->GetPredecessors()[0];
+  HBasicBlock* loop_exit = header->GetSuccessors()[0];
+  preheader->AddInstruction(new (GetAllocator()) HGoto());
+  // Use the induction after the loop.
+  HPhi* phi = header->GetFirstPhi()->AsPhi();
+  HInstruction* use_after_loop =
+      new (GetAllocator()) HAdd(DataType::Type::kInt32, phi, graph_->GetIntConstant(1));
+  loop_exit->InsertInstructionBefore(use_after_loop, loop_exit->GetLastInstruction());
+  graph_->BuildDominatorTree();
+  ASSERT_TRUE(CheckGraph());
+
+  ScopedArenaAllocator allocator(graph_->GetArenaStack());
+  SuperblockCloner cloner(graph_, header->GetLoopInformation(), &allocator);
+  ASSERT_TRUE(cloner.IsLoopClonable());
+  cloner.VersionLoop();
+  // Select a version with the parameter.
+  preheader->RemoveInstruction(preheader->GetLastInstruction());
+  preheader->AddInstruction(new (GetAllocator()) HIf(parameter_));
+  preheader->AddSuccessor(cloner.GetCopyPreHeader());
+  graph_->ClearLoopInformation();
+  graph_->ClearDominanceInformation();
+  graph_->BuildDominatorTree();
+  EXPECT_TRUE(CheckGraph());
+
+  HBasicBlock* header_copy = cloner.GetBlockCopy(header);
+  ASSERT_TRUE(header->IsLoopHeader());
+  ASSERT_TRUE(header_copy->IsLoopHeader());
+  HLoopInformation* loop_info = header->GetLoopInformation();
+  HLoopInformation* loop_info_copy = header_copy->GetLoopInformation();
+  EXPECT_NE(loop_info, loop_info_copy);
+  EXPECT_EQ(loop_info->GetPreHeader(), cloner.GetOriginalPreHeader());
+  EXPECT_EQ(loop_info_copy->GetPreHeader(), cloner.GetCopyPreHeader());
+  EXPECT_TRUE(loop_info_copy->Contains(*cloner.GetBlockCopy(loop_body)));
+  EXPECT_NE(loop_info_copy->GetSuspendCheck(), nullptr);
+  EXPECT_NE(loop_info_copy->GetSuspendCheck(), loop_info->GetSuspendCheck());
+
+  // The use after the loop sees the merge of the induction with its copy.
+  HInstruction* merge = use_after_loop->InputAt(0);
+  ASSERT_TRUE(merge->IsPhi());
+  EXPECT_EQ(merge->GetBlock(), loop_exit);
+  EXPECT_EQ(merge->InputAt(0), phi);
+  EXPECT_EQ(merge->InputAt(1), cloner.GetInstructionCopy(phi));
+}
+
 }  // namespace art
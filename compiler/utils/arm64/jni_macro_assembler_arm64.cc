@@ -413,9 +413,10 @@ void Arm64JNIMacroAssembler::Copy(FrameOffset dest,
   CHECK(scratch.IsXRegister() || scratch.IsWRegister()) << scratch;
   CHECK(size == 4 || size == 8) << size;
   if (size == 4) {
-    LoadWFromOffset(kLoadWord, scratch.AsWRegister(), base.AsXRegister(),
-                   src_offset.Int32Value());
-    StoreWToOffset(kStoreWord, scratch.AsWRegister(), SP, dest.Int32Value());
+    WRegister scratch_w =
+        scratch.IsWRegister() ? scratch.AsWRegister() : scratch.AsOverlappingWRegister();
+    LoadWFromOffset(kLoadWord, scratch_w, base.AsXRegister(), src_offset.Int32Value());
+    StoreWToOffset(kStoreWord, scratch_w, SP, dest.Int32Value());
   } else if (size == 8) {
     LoadFromOffset(scratch.AsXRegister(), base.AsXRegister(), src_offset.Int32Value());
     StoreToOffset(scratch.AsXRegister(), SP, dest.Int32Value());
@@ -37,9 +37,8 @@ template <typename InKey,
           typename StoreKey,
           typename Alloc,
           typename HashType,
-          typename HashFunc,
-          HashType kShard>
-struct DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Stats {
+          typename HashFunc>
+struct DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc>::Stats {
   size_t collision_sum = 0u;
   size_t collision_max = 0u;
   size_t total_probe_distance = 0u;
@@ -50,9 +49,8 @@ template <typename InKey,
           typename StoreKey,
           typename Alloc,
           typename HashType,
-          typename HashFunc,
-          HashType kShard>
-class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
+          typename HashFunc>
+class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc>::Shard {
  public:
   Shard(const Alloc& alloc, const std::string& lock_name)
       : alloc_(alloc),
@@ -69,8 +67,18 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
   }
 
   const StoreKey* Add(Thread* self, size_t hash, const InKey& in_key) REQUIRES(!lock_) {
-    MutexLock lock(self, lock_);
     HashedKey<InKey> hashed_in_key(hash, &in_key);
+    {
+      // Most of the keys are duplicates, look for them without blocking the other readers.
+      ReaderMutexLock lock(self, lock_);
+      auto it = keys_.Find(hashed_in_key);
+      if (it != keys_.end()) {
+        DCHECK(it->Key() != nullptr);
+        return it->Key();
+      }
+    }
+    WriterMutexLock lock(self, lock_);
+    // Another thread may have added the key since we released the lock.
     auto it = keys_.Find(hashed_in_key);
     if (it != keys_.end()) {
       DCHECK(it->Key() != nullptr);
@@ -86,7 +94,7 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
     // for bookkeeping while collecting the stats.
     std::unordered_map<HashType, size_t> stats;
     {
-      MutexLock lock(self, lock_);
+      ReaderMutexLock lock(self, lock_);
       // Note: The total_probe_distance will be updated with the current state.
       // It may have been higher before a re-hash.
       global_stats->total_probe_distance += keys_.TotalProbeDistance();
@@ -176,7 +184,7 @@ class DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Shard {
 
   Alloc alloc_;
   const std::string lock_name_;
-  Mutex lock_;
+  ReaderWriterMutex lock_;
   HashSet<HashedKey<StoreKey>, ShardEmptyFn, ShardHashFn, ShardPred> keys_ GUARDED_BY(lock_);
 };
 
@@ -184,9 +192,8 @@ template <typename InKey,
           typename StoreKey,
           typename Alloc,
           typename HashType,
-          typename HashFunc,
-          HashType kShard>
-const StoreKey* DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::Add(
+          typename HashFunc>
+const StoreKey* DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc>::Add(
     Thread* self, const InKey& key) {
   uint64_t hash_start;
   if (kIsDebugBuild) {
@@ -197,8 +204,9 @@ const StoreKey* DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::A
     uint64_t hash_end = NanoTime();
     hash_time_ += hash_end - hash_start;
   }
-  HashType shard_hash = raw_hash / kShard;
-  HashType shard_bin = raw_hash % kShard;
+  HashType num_shards = static_cast<HashType>(shards_.size());
+  HashType shard_hash = raw_hash / num_shards;
+  HashType shard_bin = raw_hash % num_shards;
   return shards_[shard_bin]->Add(self, shard_hash, key);
 }
 
@@ -206,12 +214,14 @@ template <typename InKey,
           typename StoreKey,
           typename Alloc,
           typename HashType,
-          typename HashFunc,
-          HashType kShard>
-DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::DedupeSet(const char* set_name,
-                                                                         const Alloc& alloc)
-    : hash_time_(0) {
-  for (HashType i = 0; i < kShard; ++i) {
+          typename HashFunc>
+DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc>::DedupeSet(const char* set_name,
+                                                                  const Alloc& alloc,
+                                                                  size_t num_shards)
+    : shards_(num_shards),
+      hash_time_(0) {
+  DCHECK_NE(num_shards, 0u);
+  for (size_t i = 0; i < num_shards; ++i) {
     std::ostringstream oss;
     oss << set_name << " lock " << i;
     shards_[i].reset(new Shard(alloc, oss.str()));
@@ -222,9 +232,8 @@ template <typename InKey,
           typename StoreKey,
           typename Alloc,
           typename HashType,
-          typename HashFunc,
-          HashType kShard>
-DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::~DedupeSet() {
+          typename HashFunc>
+DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc>::~DedupeSet() {
   // Everything done by member destructors.
 }
 
@@ -232,13 +241,12 @@ template <typename InKey,
           typename StoreKey,
           typename Alloc,
           typename HashType,
-          typename HashFunc,
-          HashType kShard>
-std::string DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc, kShard>::DumpStats(
+          typename HashFunc>
+std::string DedupeSet<InKey, StoreKey, Alloc, HashType, HashFunc>::DumpStats(
     Thread* self) const {
   Stats stats;
-  for (HashType shard = 0; shard < kShard; ++shard) {
-    shards_[shard]->UpdateStats(self, &stats);
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    shard->UpdateStats(self, &stats);
   }
   return android::base::StringPrintf("%zu collisions, %zu max hash collisions, "
                                      "%zu/%zu probe distance, %" PRIu64 " ns hash time",
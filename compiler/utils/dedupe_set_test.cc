@@ -88,4 +88,27 @@ TEST(DedupeSetTest, Test) {
   }
 }
 
+TEST(DedupeSetTest, Shards) {
+  Thread* self = Thread::Current();
+  DedupeSetTestAlloc alloc;
+  DedupeSet<ArrayRef<const uint8_t>,
+            std::vector<uint8_t>,
+            DedupeSetTestAlloc,
+            size_t,
+            DedupeSetTestHashFunc> deduplicator("test", alloc, /* num_shards */ 7u);
+  // Add keys landing in different shards, then check each is deduplicated with itself only.
+  std::vector<const std::vector<uint8_t>*> arrays;
+  for (uint8_t i = 0u; i != 32u; ++i) {
+    uint8_t raw_test[] = { i, 20u, 30u };
+    const std::vector<uint8_t>* array = deduplicator.Add(self, ArrayRef<const uint8_t>(raw_test));
+    ASSERT_NE(array, nullptr);
+    ASSERT_TRUE(std::find(arrays.begin(), arrays.end(), array) == arrays.end());
+    arrays.push_back(array);
+  }
+  for (uint8_t i = 0u; i != 32u; ++i) {
+    uint8_t raw_test[] = { i, 20u, 30u };
+    ASSERT_EQ(arrays[i], deduplicator.Add(self, ArrayRef<const uint8_t>(raw_test)));
+  }
+}
+
 }  // namespace art
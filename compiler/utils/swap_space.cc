@@ -28,8 +28,10 @@
 
 namespace art {
 
-// The chunk size by which the swap file is increased and mapped.
+// The chunk size by which the swap file is increased and mapped. The file grows by half of its
+// size, up to the maximum, so that a large swap space needs few mappings.
 static constexpr size_t kMininumMapSize = 16 * MB;
+static constexpr size_t kMaximumMapSize = 256 * MB;
 
 static constexpr bool kCheckFreeMaps = false;
 
@@ -62,6 +64,7 @@ inline void SwapSpace::InsertChunk(const SpaceChunk& chunk) {
 SwapSpace::SwapSpace(int fd, size_t initial_size)
     : fd_(fd),
       size_(0),
+      small_free_lists_(),
       lock_("SwapSpace lock", static_cast<LockLevel>(LockLevel::kDefaultMutexLevel - 1)) {
   // Assume that the file is unlinked.
 
@@ -69,6 +72,18 @@ SwapSpace::SwapSpace(int fd, size_t initial_size)
 }
 
 SwapSpace::~SwapSpace() {
+  {
+    // Merge the small blocks back into the free chunks.
+    MutexLock lock(Thread::Current(), lock_);
+    for (size_t i = 0; i != kNumberOfSmallSizes; ++i) {
+      size_t size = (i + 1u) * kSmallSizeGranularity;
+      while (small_free_lists_[i] != nullptr) {
+        SmallBlock* block = small_free_lists_[i];
+        small_free_lists_[i] = block->next;
+        FreeLarge(block, size);
+      }
+    }
+  }
   // Unmap all mmapped chunks. Nothing should be allocated anymore at
   // this point, so there should be only full size chunks in free_by_start_.
   for (const SpaceChunk& chunk : free_by_start_) {
@@ -108,7 +123,30 @@ static size_t CollectFree(const FreeByStartSet& free_by_start, const FreeBySizeS
 void* SwapSpace::Alloc(size_t size) {
   MutexLock lock(Thread::Current(), lock_);
   size = RoundUp(size, 8U);
+  if (size != 0u && size <= kMaxSmallSize) {
+    return AllocSmall(size);
+  }
+  return AllocLarge(size);
+}
 
+void* SwapSpace::AllocSmall(size_t size) {
+  SmallBlock** free_list = &small_free_lists_[SmallSizeIndex(size)];
+  if (*free_list == nullptr) {
+    // Carve several blocks at once; all but the returned one go to the free list.
+    uint8_t* blocks = reinterpret_cast<uint8_t*>(AllocLarge(size * kSmallBlocksPerRefill));
+    for (size_t i = kSmallBlocksPerRefill - 1u; i != 0u; --i) {
+      SmallBlock* block = reinterpret_cast<SmallBlock*>(blocks + i * size);
+      block->next = *free_list;
+      *free_list = block;
+    }
+    return blocks;
+  }
+  SmallBlock* block = *free_list;
+  *free_list = block->next;
+  return block;
+}
+
+void* SwapSpace::AllocLarge(size_t size) {
   // Check the free list for something that fits.
   // TODO: Smarter implementation. Global biggest chunk, ...
   auto it = free_by_start_.empty()
@@ -161,7 +199,8 @@ void* SwapSpace::Alloc(size_t size) {
 
 SwapSpace::SpaceChunk SwapSpace::NewFileChunk(size_t min_size) {
 #if !defined(__APPLE__)
-  size_t next_part = std::max(RoundUp(min_size, kPageSize), RoundUp(kMininumMapSize, kPageSize));
+  size_t map_size = std::max(kMininumMapSize, std::min(size_ / 2, kMaximumMapSize));
+  size_t next_part = std::max(RoundUp(min_size, kPageSize), RoundUp(map_size, kPageSize));
   int result = TEMP_FAILURE_RETRY(ftruncate64(fd_, size_ + next_part));
   if (result != 0) {
     PLOG(FATAL) << "Unable to increase swap file.";
@@ -180,17 +219,27 @@ SwapSpace::SpaceChunk SwapSpace::NewFileChunk(size_t min_size) {
   SpaceChunk new_chunk = {ptr, next_part};
   return new_chunk;
 #else
-  UNUSED(min_size, kMininumMapSize);
+  UNUSED(min_size, kMininumMapSize, kMaximumMapSize);
   LOG(FATAL) << "No swap file support on the Mac.";
   UNREACHABLE();
 #endif
 }
 
-// TODO: Full coalescing.
 void SwapSpace::Free(void* ptr, size_t size) {
   MutexLock lock(Thread::Current(), lock_);
   size = RoundUp(size, 8U);
+  if (size != 0u && size <= kMaxSmallSize) {
+    SmallBlock* block = reinterpret_cast<SmallBlock*>(ptr);
+    SmallBlock** free_list = &small_free_lists_[SmallSizeIndex(size)];
+    block->next = *free_list;
+    *free_list = block;
+    return;
+  }
+  FreeLarge(ptr, size);
+}
 
+// TODO: Full coalescing.
+void SwapSpace::FreeLarge(void* ptr, size_t size) {
   size_t free_before = 0;
   if (kCheckFreeMaps) {
     free_before = CollectFree(free_by_start_, free_by_size_);
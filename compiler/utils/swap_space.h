@@ -43,7 +43,28 @@ class SwapSpace {
     return size_;
   }
 
+  // Allocations up to this size are served by free lists segregated by size.
+  static constexpr size_t kMaxSmallSize = 256u;
+
  private:
+  // Small blocks are kept in a singly linked list per size, linked through their first word,
+  // and are not merged with their neighbours until the swap space is destroyed.
+  static constexpr size_t kSmallSizeGranularity = 8u;
+  static constexpr size_t kNumberOfSmallSizes = kMaxSmallSize / kSmallSizeGranularity;
+  // Number of small blocks carved at once from the free chunks when a free list is empty.
+  static constexpr size_t kSmallBlocksPerRefill = 32u;
+
+  struct SmallBlock {
+    SmallBlock* next;
+  };
+
+  static size_t SmallSizeIndex(size_t size) {
+    DCHECK_NE(size, 0u);
+    DCHECK_LE(size, kMaxSmallSize);
+    DCHECK_ALIGNED(size, kSmallSizeGranularity);
+    return size / kSmallSizeGranularity - 1u;
+  }
+
   // Chunk of space.
   struct SpaceChunk {
     // We need mutable members as we keep these objects in a std::set<> (providing only const
@@ -91,6 +112,10 @@ class SwapSpace {
 
   SpaceChunk NewFileChunk(size_t min_size) REQUIRES(lock_);
 
+  void* AllocLarge(size_t size) REQUIRES(lock_);
+  void FreeLarge(void* ptr, size_t size) REQUIRES(lock_);
+  void* AllocSmall(size_t size) REQUIRES(lock_);
+
   void RemoveChunk(FreeBySizeSet::const_iterator free_by_size_pos) REQUIRES(lock_);
   void InsertChunk(const SpaceChunk& chunk) REQUIRES(lock_);
 
@@ -103,6 +128,8 @@ class SwapSpace {
   FreeByStartSet free_by_start_ GUARDED_BY(lock_);
   // Free chunks ordered by size.
   FreeBySizeSet free_by_size_ GUARDED_BY(lock_);
+  // Free small blocks by size.
+  SmallBlock* small_free_lists_[kNumberOfSmallSizes] GUARDED_BY(lock_);
 
   mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   DISALLOW_COPY_AND_ASSIGN(SwapSpace);
@@ -21,6 +21,7 @@
 #include <sys/types.h>
 
 #include <cstdio>
+#include <cstring>
 
 #include "gtest/gtest.h"
 
@@ -72,6 +73,34 @@ static void SwapTest(bool use_file) {
   scratch.Close();
 }
 
+TEST_F(SwapSpaceTest, SmallBlocks) {
+  ScratchFile scratch;
+  int fd = scratch.GetFd();
+  unlink(scratch.GetFilename().c_str());
+
+  SwapSpace pool(fd, 1 * MB);
+  // Blocks of the same rounded size are reused, the last freed first.
+  void* small1 = pool.Alloc(20u);
+  void* small2 = pool.Alloc(24u);
+  EXPECT_NE(small1, small2);
+  pool.Free(small1, 20u);
+  pool.Free(small2, 24u);
+  EXPECT_EQ(small2, pool.Alloc(17u));
+  EXPECT_EQ(small1, pool.Alloc(24u));
+  // Other sizes do not use them.
+  void* other = pool.Alloc(SwapSpace::kMaxSmallSize);
+  EXPECT_NE(small1, other);
+  EXPECT_NE(small2, other);
+  void* large = pool.Alloc(SwapSpace::kMaxSmallSize + 1u);
+  memset(large, 0xff, SwapSpace::kMaxSmallSize + 1u);
+  pool.Free(large, SwapSpace::kMaxSmallSize + 1u);
+  pool.Free(other, SwapSpace::kMaxSmallSize);
+  pool.Free(small1, 24u);
+  pool.Free(small2, 24u);
+
+  scratch.Close();
+}
+
 TEST_F(SwapSpaceTest, Memory) {
   SwapTest(false);
 }
@@ -927,6 +927,14 @@ TEST_F(AssemblerX86_64Test, Xchgl) {
   // DriverStr(Repeatrr(&x86_64::X86_64Assembler::xchgl, "xchgl %{reg2}, %{reg1}"), "xchgl");
 }
 
+TEST_F(AssemblerX86_64Test, XchglMem) {
+  DriverStr(RepeatrA(&x86_64::X86_64Assembler::xchgl, "xchgl {mem}, %{reg}"), "xchgl_m");
+}
+
+TEST_F(AssemblerX86_64Test, XchgqMem) {
+  DriverStr(RepeatRA(&x86_64::X86_64Assembler::xchgq, "xchgq {mem}, %{reg}"), "xchgq_m");
+}
+
 TEST_F(AssemblerX86_64Test, LockCmpxchgl) {
   DriverStr(RepeatAr(&x86_64::X86_64Assembler::LockCmpxchgl,
                      "lock cmpxchgl %{reg}, {mem}"), "lock_cmpxchgl");
@@ -937,6 +945,16 @@ TEST_F(AssemblerX86_64Test, LockCmpxchgq) {
                      "lock cmpxchg %{reg}, {mem}"), "lock_cmpxchg");
 }
 
+TEST_F(AssemblerX86_64Test, LockXaddl) {
+  DriverStr(RepeatAr(&x86_64::X86_64Assembler::LockXaddl,
+                     "lock xaddl %{reg}, {mem}"), "lock_xaddl");
+}
+
+TEST_F(AssemblerX86_64Test, LockXaddq) {
+  DriverStr(RepeatAR(&x86_64::X86_64Assembler::LockXaddq,
+                     "lock xaddq %{reg}, {mem}"), "lock_xaddq");
+}
+
 TEST_F(AssemblerX86_64Test, MovqStore) {
   DriverStr(RepeatAR(&x86_64::X86_64Assembler::movq, "movq %{reg}, {mem}"), "movq_s");
 }
@@ -967,6 +985,12 @@ TEST_F(AssemblerX86_64Test, Cmpw) {
                      "cmpw ${imm}, {mem}"), "cmpw");  // TODO: only imm8?
 }
 
+TEST_F(AssemblerX86_64Test, Addw) {
+  DriverStr(RepeatAI(&x86_64::X86_64Assembler::addw,
+                     /*imm_bytes*/ 1U,
+                     "addw ${imm}, {mem}"), "addw");
+}
+
 TEST_F(AssemblerX86_64Test, MovqAddrImm) {
   DriverStr(RepeatAI(&x86_64::X86_64Assembler::movq,
                      /*imm_bytes*/ 4U,
@@ -1530,6 +1554,10 @@ TEST_F(AssemblerX86_64Test, PCmpeqq) {
   DriverStr(RepeatFF(&x86_64::X86_64Assembler::pcmpeqq, "pcmpeqq %{reg2}, %{reg1}"), "pcmpeqq");
 }
 
+TEST_F(AssemblerX86_64Test, PMovmskb) {
+  DriverStr(RepeatrF(&x86_64::X86_64Assembler::pmovmskb, "pmovmskb %{reg2}, %{reg1}"), "pmovmskb");
+}
+
 TEST_F(AssemblerX86_64Test, PCmpgtb) {
   DriverStr(RepeatFF(&x86_64::X86_64Assembler::pcmpgtb, "pcmpgtb %{reg2}, %{reg1}"), "pcmpgtb");
 }
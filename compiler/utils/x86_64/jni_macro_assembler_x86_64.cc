@@ -411,12 +411,15 @@ void X86_64JNIMacroAssembler::Copy(FrameOffset dest,
   }
 }
 
-void X86_64JNIMacroAssembler::Copy(FrameOffset /*dst*/,
-                                   ManagedRegister /*src_base*/,
-                                   Offset /*src_offset*/,
-                                   ManagedRegister /*scratch*/,
-                                   size_t /*size*/) {
-  UNIMPLEMENTED(FATAL);
+void X86_64JNIMacroAssembler::Copy(FrameOffset dest,
+                                   ManagedRegister src_base,
+                                   Offset src_offset,
+                                   ManagedRegister mscratch,
+                                   size_t size) {
+  CpuRegister scratch = mscratch.AsX86_64().AsCpuRegister();
+  CHECK_EQ(size, 4u);
+  __ movl(scratch, Address(src_base.AsX86_64().AsCpuRegister(), src_offset));
+  __ movl(Address(CpuRegister(RSP), dest), scratch);
 }
 
 void X86_64JNIMacroAssembler::Copy(ManagedRegister dest_base,
@@ -449,9 +452,15 @@ void X86_64JNIMacroAssembler::Copy(ManagedRegister dest,
                                    ManagedRegister scratch,
                                    size_t size) {
   CHECK_EQ(size, 4u);
-  CHECK(scratch.IsNoRegister());
-  __ pushq(Address(src.AsX86_64().AsCpuRegister(), src_offset));
-  __ popq(Address(dest.AsX86_64().AsCpuRegister(), dest_offset));
+  if (scratch.IsNoRegister()) {
+    __ pushq(Address(src.AsX86_64().AsCpuRegister(), src_offset));
+    __ popq(Address(dest.AsX86_64().AsCpuRegister(), dest_offset));
+  } else {
+    // Only copy the 4 bytes, the ones after the source and destination may differ.
+    CpuRegister scratch_reg = scratch.AsX86_64().AsCpuRegister();
+    __ movl(scratch_reg, Address(src.AsX86_64().AsCpuRegister(), src_offset));
+    __ movl(Address(dest.AsX86_64().AsCpuRegister(), dest_offset), scratch_reg);
+  }
 }
 
 void X86_64JNIMacroAssembler::Copy(FrameOffset dest,
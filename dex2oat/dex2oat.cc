@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include "base/memory_tool.h"
 
 #include <forward_list>
@@ -35,6 +36,7 @@
 #include <sys/utsname.h>
 #endif
 
+#include "android-base/file.h"
 #include "android-base/stringprintf.h"
 #include "android-base/strings.h"
 
@@ -64,6 +66,8 @@
 #include "dex2oat_options.h"
 #include "dex2oat_return_codes.h"
 #include "dex_file-inl.h"
+#include "dex_file_loader.h"
+#include "driver/compiled_method_cache.h"
 #include "driver/compiler_driver.h"
 #include "driver/compiler_options.h"
 #include "driver/compiler_options_map-inl.h"
@@ -248,6 +252,13 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("      descriptor.");
   UsageError("      Example: --output-vdex-fd=6");
   UsageError("");
+  UsageError("  --incremental-cache=<file>: reuses the code compiled for the dex files which");
+  UsageError("      did not change since the compilation which wrote <file>, if any, and writes");
+  UsageError("      the code of this compilation to it. Only the dex files, the profile, the");
+  UsageError("      boot image, the class path and the compiler options are checked, the cache");
+  UsageError("      must be deleted when dex2oat itself changes.");
+  UsageError("      Example: --incremental-cache=/tmp/Calculator.cache");
+  UsageError("");
   UsageError("  --oat-location=<oat-name>: specifies a symbolic name for the file corresponding");
   UsageError("      to the file descriptor specified by --oat-fd.");
   UsageError("      Example: --oat-location=/data/dalvik-cache/system@app@Calculator.apk.oat");
@@ -806,6 +817,14 @@ class Dex2Oat FINAL {
       Usage("--compiled-classes-zip should be used with --compiled-classes");
     }
 
+    if (!incremental_cache_.empty() && IsBootImage()) {
+      Usage("--incremental-cache should not be used with --image");
+    }
+
+    if (!incremental_cache_.empty() && compiled_methods_filename_ != nullptr) {
+      Usage("--incremental-cache should not be used with --compiled-methods");
+    }
+
     if (dex_filenames_.empty() && zip_fd_ == -1) {
       Usage("Input must be supplied with either --dex-file or --zip-fd");
     }
@@ -1102,6 +1121,61 @@ class Dex2Oat FINAL {
         CompilerFilter::NameOfFilter(compiler_options_->GetCompilerFilter()));
     key_value_store_->Put(OatHeader::kConcurrentCopying,
                           kUseReadBarrier ? OatHeader::kTrueValue : OatHeader::kFalseValue);
+
+    // Keep the options which may change the compiled code for the key of the incremental cache.
+    // The ones naming the input and output files and the diagnostic ones don't.
+    static const char* const kOptionsIgnoredByCache[] = {
+        "--dex-file=", "--dex-location=", "--zip-fd=", "--zip-location=", "--oat-file=",
+        "--oat-symbols=", "--oat-fd=", "--oat-location=", "--input-vdex-fd=", "--input-vdex=",
+        "--output-vdex-fd=", "--output-vdex=", "--app-image-file=", "--app-image-fd=",
+        "--swap-file=", "--swap-fd=", "--profile-file=", "--profile-file-fd=",
+        "--incremental-cache=", "--class-loader-context=", "--classpath-dir=", "--dump-timing",
+        "--dump-stats", "--dump-passes", "--watchdog", "--no-watchdog", "--watchdog-timeout=",
+        "-j",
+    };
+    for (int i = 1; i < argc; ++i) {
+      bool ignored = false;
+      for (const char* option : kOptionsIgnoredByCache) {
+        ignored = ignored || android::base::StartsWith(argv[i], option);
+      }
+      if (!ignored) {
+        compile_options_for_cache_ += ' ';
+        compile_options_for_cache_ += argv[i];
+      }
+    }
+  }
+
+  // Returns what the compiled code depends on besides the dex files, so that the incremental
+  // cache is only used by the same compilation of other versions of the dex files.
+  std::string GetIncrementalCacheKey() const {
+    std::ostringstream oss;
+    oss << reinterpret_cast<const char*>(OatHeader::kOatVersion) << ' ' << instruction_set_ << ' '
+        << instruction_set_features_->GetFeatureString() << ' '
+        << image_file_location_oat_checksum_ << ' ' << profile_checksum_;
+    // The class path includes the checksums of its dex files.
+    for (const auto& entry : *key_value_store_) {
+      if (entry.first != OatHeader::kDex2OatCmdLineKey) {
+        oss << ' ' << entry.first << '=' << entry.second;
+      }
+    }
+    oss << compile_options_for_cache_;
+    return oss.str();
+  }
+
+  void WriteIncrementalCache() {
+    if (incremental_cache_.empty()) {
+      return;
+    }
+    TimingLogger::ScopedTiming t("Write incremental cache", timings_);
+    std::string error_msg;
+    if (!CompiledMethodCache::Write(incremental_cache_,
+                                    GetIncrementalCacheKey(),
+                                    dex_files_,
+                                    /* depends_on_all_dex_files */ UseProfile(),
+                                    *driver_,
+                                    &error_msg)) {
+      LOG(WARNING) << "Failed to write the incremental cache: " << error_msg;
+    }
   }
 
   // This simple forward is here so the string specializations below don't look out of place.
@@ -1176,6 +1250,7 @@ class Dex2Oat FINAL {
     AssignIfExists(args, M::OutputVdexFd, &output_vdex_fd_);
     AssignIfExists(args, M::InputVdex, &input_vdex_);
     AssignIfExists(args, M::OutputVdex, &output_vdex_);
+    AssignIfExists(args, M::IncrementalCache, &incremental_cache_);
     AssignIfExists(args, M::OatFd, &oat_fd_);
     AssignIfExists(args, M::OatLocation, &oat_location_);
     AssignIfExists(args, M::Watchdog, &parser_options->watch_dog_enabled);
@@ -1530,7 +1605,9 @@ class Dex2Oat FINAL {
       // (because the encoding adds the dex checksum...)
       // TODO(calin): consider redesigning this so we don't have to open the dex files before
       // creating the actual class loader.
-      if (!class_loader_context_->OpenDexFiles(runtime_->GetInstructionSet(), classpath_dir_)) {
+      const bool opened_dex_files =
+          class_loader_context_->OpenDexFiles(runtime_->GetInstructionSet(), classpath_dir_);
+      if (!opened_dex_files) {
         // Do not abort if we couldn't open files from the classpath. They might be
         // apks without dex files and right now are opening flow will fail them.
         LOG(WARNING) << "Failed to open classpath dex files";
@@ -1539,6 +1616,11 @@ class Dex2Oat FINAL {
       // Store the class loader context in the oat header.
       key_value_store_->Put(OatHeader::kClassPathKey,
                             class_loader_context_->EncodeContextForOatFile(classpath_dir_));
+      if (opened_dex_files) {
+        // Lets the runtime accept a matching context without parsing the one above.
+        key_value_store_->Put(OatHeader::kClassPathFingerprintKey,
+                              class_loader_context_->GetFingerprint());
+      }
     }
 
     // Now that we have finalized key_value_store_, start writing the oat file.
@@ -1784,6 +1866,25 @@ class Dex2Oat FINAL {
       driver_->SetClasspathDexFiles(class_loader_context_->FlattenOpenedDexFiles());
     }
 
+    if (!incremental_cache_.empty() && OS::FileExists(incremental_cache_.c_str())) {
+      TimingLogger::ScopedTiming t_cache("Open incremental cache", timings_);
+      std::string error_msg;
+      // The inline caches of the profile may name classes of any of the dex files.
+      compiled_method_cache_ = CompiledMethodCache::Open(
+          incremental_cache_,
+          GetIncrementalCacheKey(),
+          dex_files_,
+          /* depends_on_all_dex_files */ UseProfile(),
+          &error_msg);
+      if (compiled_method_cache_ == nullptr) {
+        LOG(INFO) << "Not reusing compiled code: " << error_msg;
+      } else {
+        LOG(INFO) << "Reusing the compiled code of "
+                  << compiled_method_cache_->GetNumberOfReusableMethods() << " methods";
+        driver_->SetCompiledMethodCache(compiled_method_cache_.get());
+      }
+    }
+
     const bool compile_individually = ShouldCompileDexFilesIndividually();
     if (compile_individually) {
       // Set the compiler driver in the callbacks so that we can avoid re-verification. This not
@@ -2092,6 +2193,12 @@ class Dex2Oat FINAL {
 
         oat_writer.reset();
         elf_writer.reset();
+
+        // The code of this oat file is in the output now. Unless the incremental cache still
+        // needs it, free it before writing the next oat files and the image.
+        if (incremental_cache_.empty()) {
+          driver_->FreeCompiledMethods(dex_files_per_oat_file_[i]);
+        }
       }
     }
 
@@ -2263,7 +2370,32 @@ class Dex2Oat FINAL {
       return false;
     }
 
-    if (!profile_compilation_info_->Load(profile_file->Fd())) {
+    if (!incremental_cache_.empty()) {
+      // The compiled code depends on the profile, which the incremental cache must check.
+      std::string profile_data;
+      if (!android::base::ReadFdToString(profile_file->Fd(), &profile_data) ||
+          lseek(profile_file->Fd(), 0, SEEK_SET) != 0) {
+        PLOG(ERROR) << "Cannot read profile for the incremental cache";
+        return false;
+      }
+      profile_checksum_ = FNVHash<std::string>()(profile_data) ^ profile_data.size();
+    }
+
+    // Only decode the data of the dex files to compile. The profile may also have the data of
+    // other dex files, such as the shared libraries of an app.
+    std::unordered_set<std::string> profile_keys;
+    for (const char* dex_location : dex_locations_) {
+      profile_keys.insert(ProfileCompilationInfo::GetProfileDexFileKey(dex_location));
+    }
+    if (!zip_location_.empty()) {
+      profile_keys.insert(ProfileCompilationInfo::GetProfileDexFileKey(zip_location_));
+    }
+    auto filter_fn = [&profile_keys](const std::string& profile_key,
+                                     uint32_t checksum ATTRIBUTE_UNUSED) {
+      return profile_keys.empty() ||
+          profile_keys.find(DexFileLoader::GetBaseLocation(profile_key)) != profile_keys.end();
+    };
+    if (!profile_compilation_info_->Load(profile_file->Fd(), /* merge_classes */ true, filter_fn)) {
       profile_compilation_info_.reset(nullptr);
       return false;
     }
@@ -2445,6 +2577,7 @@ class Dex2Oat FINAL {
       elf_writers_.emplace_back(linker::CreateElfWriterQuick(instruction_set_,
                                                              instruction_set_features_.get(),
                                                              compiler_options_.get(),
+                                                             thread_count_,
                                                              oat_file.get()));
       elf_writers_.back()->Start();
       const bool do_oat_writer_layout = DoDexLayoutOptimizations() || DoOatLayoutOptimizations();
@@ -2788,6 +2921,11 @@ class Dex2Oat FINAL {
   std::string input_vdex_;
   std::string output_vdex_;
   std::unique_ptr<VdexFile> input_vdex_file_;
+  std::string incremental_cache_;
+  std::unique_ptr<CompiledMethodCache> compiled_method_cache_;
+  // The options which may change the compiled code, for the key of the incremental cache.
+  std::string compile_options_for_cache_;
+  size_t profile_checksum_ = 0u;
   std::vector<const char*> dex_filenames_;
   std::vector<const char*> dex_locations_;
   int zip_fd_;
@@ -2956,6 +3094,8 @@ static dex2oat::ReturnCode CompileApp(Dex2Oat& dex2oat) {
     return dex2oat::ReturnCode::kOther;
   }
 
+  dex2oat.WriteIncrementalCache();
+
   // Do not close the oat files here. We might have gotten the output file by file descriptor,
   // which we would lose.
 
@@ -86,6 +86,9 @@ static void AddGeneratedArtifactMappings(Builder& builder) {
       .Define("--output-vdex=_")
           .WithType<std::string>()
           .IntoKey(M::OutputVdex)
+      .Define("--incremental-cache=_")
+          .WithType<std::string>()
+          .IntoKey(M::IncrementalCache)
       .Define("--oat-file=_")
           .WithType<std::vector<std::string>>().AppendValues()
           .IntoKey(M::OatFiles)
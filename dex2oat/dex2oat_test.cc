@@ -14,7 +14,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <regex>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -1403,6 +1405,84 @@ TEST_F(Dex2oatTest, LayoutSections) {
   }
 }
 
+// Test that the compiled code of the startup methods of the profile comes first in the oat file.
+TEST_F(Dex2oatTest, LayoutCode) {
+  using Hotness = ProfileCompilationInfo::MethodHotness;
+  std::unique_ptr<const DexFile> dex(OpenTestDexFile("ManyMethods"));
+  const DexFile::TypeId* type_id = dex->FindTypeId("LManyMethods;");
+  ASSERT_TRUE(type_id != nullptr);
+  const DexFile::ClassDef* class_def = dex->FindClassDef(dex->GetIndexForTypeId(*type_id));
+  ASSERT_TRUE(class_def != nullptr);
+  std::vector<uint16_t> methods;
+  {
+    ClassDataItemIterator it(*dex, dex->GetClassData(*class_def));
+    it.SkipAllFields();
+    for (; it.HasNextMethod(); it.Next()) {
+      methods.push_back(it.GetMemberIndex());
+    }
+  }
+  ASSERT_GE(methods.size(), 8u);
+  // The last methods of the class are the startup ones.
+  std::vector<uint16_t> startup_methods = {methods[methods.size() - 2u], methods.back()};
+  std::vector<uint16_t> hot_methods = {methods[methods.size() - 3u]};
+  ProfileCompilationInfo info;
+  info.AddMethodsForDex(Hotness::kFlagStartup,
+                        dex.get(),
+                        startup_methods.begin(),
+                        startup_methods.end());
+  info.AddMethodsForDex(static_cast<Hotness::Flag>(Hotness::kFlagHot | Hotness::kFlagPostStartup),
+                        dex.get(),
+                        hot_methods.begin(),
+                        hot_methods.end());
+  ScratchFile profile_file;
+  ASSERT_TRUE(info.Save(profile_file.GetFd()));
+  const std::string oat_filename = GetScratchDir() + "/base.oat";
+  std::string error_msg;
+  const int res = GenerateOdexForTestWithStatus(
+      {dex->GetLocation()},
+      oat_filename,
+      CompilerFilter::Filter::kSpeed,
+      &error_msg,
+      {"--profile-file=" + profile_file.GetFilename()});
+  ASSERT_EQ(res, 0);
+
+  std::unique_ptr<OatFile> odex_file(OatFile::Open(oat_filename.c_str(),
+                                                   oat_filename.c_str(),
+                                                   nullptr,
+                                                   nullptr,
+                                                   false,
+                                                   /*low_4gb*/false,
+                                                   dex->GetLocation().c_str(),
+                                                   &error_msg));
+  ASSERT_TRUE(odex_file != nullptr) << error_msg;
+  std::vector<const OatDexFile*> oat_dex_files = odex_file->GetOatDexFiles();
+  ASSERT_EQ(oat_dex_files.size(), 1u);
+  OatFile::OatClass oat_class = oat_dex_files[0]->GetOatClass(dex->GetIndexForClassDef(*class_def));
+  auto code_offset = [&](uint16_t method_idx) {
+    size_t class_def_method_index =
+        std::find(methods.begin(), methods.end(), method_idx) - methods.begin();
+    return oat_class.GetOatMethod(class_def_method_index).GetCodeOffset();
+  };
+  // Identical code is deduplicated, other methods may share the code of a startup method.
+  std::set<uint32_t> startup_offsets;
+  for (uint16_t method_idx : startup_methods) {
+    ASSERT_NE(code_offset(method_idx), 0u);
+    startup_offsets.insert(code_offset(method_idx));
+  }
+  uint32_t hot_offset = code_offset(hot_methods[0]);
+  ASSERT_NE(hot_offset, 0u);
+  if (!ContainsElement(startup_offsets, hot_offset)) {
+    EXPECT_LT(*startup_offsets.rbegin(), hot_offset);
+  }
+  for (uint16_t method_idx : methods) {
+    uint32_t offset = code_offset(method_idx);
+    if (offset != 0u && !ContainsElement(startup_offsets, offset) && offset != hot_offset) {
+      EXPECT_LT(*startup_offsets.rbegin(), offset);
+      EXPECT_LT(hot_offset, offset);
+    }
+  }
+}
+
 // Test that generating compact dex works.
 TEST_F(Dex2oatTest, GenerateCompactDex) {
   std::unique_ptr<const DexFile> dex(OpenTestDexFile("ManyMethods"));
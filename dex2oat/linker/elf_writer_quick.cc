@@ -91,6 +91,7 @@ class ElfWriterQuick FINAL : public ElfWriter {
   ElfWriterQuick(InstructionSet instruction_set,
                  const InstructionSetFeatures* features,
                  const CompilerOptions* compiler_options,
+                 size_t thread_count,
                  File* elf_file);
   ~ElfWriterQuick();
 
@@ -119,6 +120,7 @@ class ElfWriterQuick FINAL : public ElfWriter {
  private:
   const InstructionSetFeatures* instruction_set_features_;
   const CompilerOptions* const compiler_options_;
+  const size_t thread_count_;
   File* const elf_file_;
   size_t rodata_size_;
   size_t text_size_;
@@ -136,16 +138,19 @@ class ElfWriterQuick FINAL : public ElfWriter {
 std::unique_ptr<ElfWriter> CreateElfWriterQuick(InstructionSet instruction_set,
                                                 const InstructionSetFeatures* features,
                                                 const CompilerOptions* compiler_options,
+                                                size_t thread_count,
                                                 File* elf_file) {
   if (Is64BitInstructionSet(instruction_set)) {
     return std::make_unique<ElfWriterQuick<ElfTypes64>>(instruction_set,
                                                         features,
                                                         compiler_options,
+                                                        thread_count,
                                                         elf_file);
   } else {
     return std::make_unique<ElfWriterQuick<ElfTypes32>>(instruction_set,
                                                         features,
                                                         compiler_options,
+                                                        thread_count,
                                                         elf_file);
   }
 }
@@ -154,10 +159,12 @@ template <typename ElfTypes>
 ElfWriterQuick<ElfTypes>::ElfWriterQuick(InstructionSet instruction_set,
                                          const InstructionSetFeatures* features,
                                          const CompilerOptions* compiler_options,
+                                         size_t thread_count,
                                          File* elf_file)
     : ElfWriter(),
       instruction_set_features_(features),
       compiler_options_(compiler_options),
+      thread_count_(thread_count),
       elf_file_(elf_file),
       rodata_size_(0u),
       text_size_(0u),
@@ -257,8 +264,16 @@ void ElfWriterQuick<ElfTypes>::WriteDebugInfo(
     const ArrayRef<const debug::MethodDebugInfo>& method_infos) {
   if (!method_infos.empty()) {
     if (compiler_options_->GetGenerateDebugInfo()) {
-      // Generate all the debug information we can.
-      debug::WriteDebugInfo(builder_.get(), method_infos, kCFIFormat, true /* write_oat_patches */);
+      // Generate all the debug information we can. The calling thread also does work.
+      std::unique_ptr<ThreadPool> thread_pool;
+      if (thread_count_ > 1u) {
+        thread_pool.reset(new ThreadPool("Debug info writer", thread_count_ - 1u));
+      }
+      debug::WriteDebugInfo(builder_.get(),
+                            method_infos,
+                            kCFIFormat,
+                            true /* write_oat_patches */,
+                            thread_pool.get());
     }
     if (compiler_options_->GetGenerateMiniDebugInfo()) {
       // Wait for the mini-debug-info generation to finish and write it to disk.
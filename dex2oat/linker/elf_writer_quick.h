@@ -33,6 +33,7 @@ namespace linker {
 std::unique_ptr<ElfWriter> CreateElfWriterQuick(InstructionSet instruction_set,
                                                 const InstructionSetFeatures* features,
                                                 const CompilerOptions* compiler_options,
+                                                size_t thread_count,
                                                 File* elf_file);
 
 }  // namespace linker
@@ -244,6 +244,7 @@ inline void CompilationHelper::Compile(CompilerDriver* driver,
         elf_writers.emplace_back(CreateElfWriterQuick(driver->GetInstructionSet(),
                                                       driver->GetInstructionSetFeatures(),
                                                       &driver->GetCompilerOptions(),
+                                                      driver->GetThreadCount(),
                                                       oat_file.GetFile()));
         elf_writers.back()->Start();
         oat_writers.emplace_back(new OatWriter(/*compiling_boot_image*/true,
@@ -20,6 +20,7 @@
 #include <lz4hc.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <unordered_set>
@@ -32,9 +33,11 @@
 #include "base/logging.h"  // For VLOG.
 #include "base/unix_file/fd_file.h"
 #include "class_linker-inl.h"
+#include "code_item_accessors-inl.h"
 #include "compiled_method.h"
 #include "dex_file-inl.h"
 #include "dex_file_types.h"
+#include "dex_instruction-inl.h"
 #include "driver/compiler_driver.h"
 #include "elf_file.h"
 #include "elf_utils.h"
@@ -51,7 +54,9 @@
 #include "handle_scope-inl.h"
 #include "image.h"
 #include "imt_conflict_table.h"
+#include "jit/profile_compilation_info.h"
 #include "subtype_check.h"
+#include "thread_pool.h"
 #include "jni_internal.h"
 #include "linear_alloc.h"
 #include "lock_word.h"
@@ -1664,6 +1669,89 @@ void ImageWriter::ProcessWorkStack(WorkStack* work_stack) {
   }
 }
 
+class ImageWriter::CollectStartupClassesVisitor : public ClassVisitor {
+ public:
+  CollectStartupClassesVisitor(const ImageWriter* image_writer,
+                               const ProfileCompilationInfo& profile,
+                               std::vector<mirror::Class*>* classes)
+      : image_writer_(image_writer), profile_(profile), classes_(classes) {}
+
+  bool operator()(ObjPtr<Class> klass) OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (klass->IsArrayClass() || klass->IsPrimitive() || klass->IsProxyClass() ||
+        image_writer_->IsInBootImage(klass.Ptr())) {
+      return true;
+    }
+    const DexFile& dex_file = klass->GetDexFile();
+    if (image_writer_->dex_file_oat_index_map_.find(&dex_file) !=
+            image_writer_->dex_file_oat_index_map_.end() &&
+        profile_.ContainsClass(dex_file, klass->GetDexTypeIndex())) {
+      classes_->push_back(klass.Ptr());
+    }
+    return true;
+  }
+
+ private:
+  const ImageWriter* const image_writer_;
+  const ProfileCompilationInfo& profile_;
+  std::vector<mirror::Class*>* const classes_;
+};
+
+void ImageWriter::AssignStartupBinSlots(const ProfileCompilationInfo& profile,
+                                        WorkStack* work_stack) {
+  Thread* const self = Thread::Current();
+  std::vector<mirror::Class*> classes;
+  {
+    CollectStartupClassesVisitor visitor(this, profile, &classes);
+    Runtime::Current()->GetClassLinker()->VisitClasses(&visitor);
+  }
+  // Visit the classes in dex file and class def order, the class table order is not stable.
+  const std::vector<const DexFile*>& dex_files = compiler_driver_.GetDexFilesForOatFile();
+  auto dex_file_position = [&dex_files](const DexFile* dex_file) {
+    return std::find(dex_files.begin(), dex_files.end(), dex_file) - dex_files.begin();
+  };
+  std::sort(classes.begin(),
+            classes.end(),
+            [&dex_file_position](mirror::Class* lhs, mirror::Class* rhs)
+                REQUIRES_SHARED(Locks::mutator_lock_) {
+    auto lhs_position = dex_file_position(&lhs->GetDexFile());
+    auto rhs_position = dex_file_position(&rhs->GetDexFile());
+    return (lhs_position != rhs_position)
+        ? lhs_position < rhs_position
+        : lhs->GetDexClassDefIndex() < rhs->GetDexClassDefIndex();
+  });
+  // Assigning the slot of a class assigns the slots of its fields and methods too.
+  for (mirror::Class* klass : classes) {
+    TryAssignBinSlot(*work_stack, klass, GetOatIndexForDexFile(&klass->GetDexFile()));
+  }
+  // Then the strings loaded by the startup methods of these classes.
+  InternTable* const intern_table = Runtime::Current()->GetInternTable();
+  for (mirror::Class* klass : classes) {
+    const DexFile& dex_file = klass->GetDexFile();
+    const size_t oat_index = GetOatIndexForDexFile(&dex_file);
+    for (ArtMethod& method : klass->GetMethods(target_ptr_size_)) {
+      if (method.GetCodeItem() == nullptr ||
+          !profile.GetMethodHotness(MethodReference(&dex_file, method.GetDexMethodIndex()))
+              .IsStartup()) {
+        continue;
+      }
+      for (const DexInstructionPcPair& inst : method.DexInstructions()) {
+        if (inst->Opcode() != Instruction::CONST_STRING &&
+            inst->Opcode() != Instruction::CONST_STRING_JUMBO) {
+          continue;
+        }
+        dex::StringIndex string_index((inst->Opcode() == Instruction::CONST_STRING)
+            ? inst->VRegB_21c()
+            : inst->VRegB_31c());
+        uint32_t utf16_length;
+        const char* utf8_data = dex_file.StringDataAndUtf16LengthByIdx(string_index,
+                                                                       &utf16_length);
+        mirror::String* string = intern_table->LookupStrong(self, utf16_length, utf8_data).Ptr();
+        TryAssignBinSlot(*work_stack, string, oat_index);
+      }
+    }
+  }
+}
+
 void ImageWriter::CalculateNewObjectOffsets() {
   Thread* const self = Thread::Current();
   VariableSizedHandleScope handles(self);
@@ -1719,6 +1807,14 @@ void ImageWriter::CalculateNewObjectOffsets() {
   // assigned a bin slot.
   WorkStack work_stack;
 
+  // For an app image compiled with a profile, lay out the classes used during startup first, with
+  // their fields, methods and the strings of their startup methods, so that startup touches fewer
+  // pages of each bin.
+  const ProfileCompilationInfo* profile = compiler_driver_.GetProfileCompilationInfo();
+  if (compile_app_image_ && profile != nullptr) {
+    AssignStartupBinSlots(*profile, &work_stack);
+  }
+
   // Special case interned strings to put them in the image they are likely to be resolved from.
   for (const DexFile* dex_file : compiler_driver_.GetDexFilesForOatFile()) {
     auto it = dex_file_oat_index_map_.find(dex_file);
@@ -2165,12 +2261,62 @@ void ImageWriter::CopyAndFixupNativeData(size_t oat_index) {
   }
 }
 
+// Copies and fixes up a range of the objects written to the image.
+class ImageWriter::CopyAndFixupObjectsTask : public Task {
+ public:
+  CopyAndFixupObjectsTask(ImageWriter* image_writer, Object* const* begin, Object* const* end)
+      : image_writer_(image_writer), begin_(begin), end_(end) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    for (Object* const* it = begin_; it != end_; ++it) {
+      image_writer_->CopyAndFixupObject(*it);
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ImageWriter* const image_writer_;
+  Object* const* const begin_;
+  Object* const* const end_;
+};
+
 void ImageWriter::CopyAndFixupObjects() {
+  std::vector<Object*> objects;
   auto visitor = [&](Object* obj) REQUIRES_SHARED(Locks::mutator_lock_) {
     DCHECK(obj != nullptr);
-    CopyAndFixupObject(obj);
+    if (!IsInBootImage(obj)) {
+      objects.push_back(obj);
+    }
   };
   Runtime::Current()->GetHeap()->VisitObjects(visitor);
+  // Each object is copied to the offset assigned by CalculateNewObjectOffsets() and its fixups
+  // only read the original objects and the relocations, so the objects can be copied in any
+  // order and by several threads, and the image is the same as with a single thread.
+  const size_t thread_count = compiler_driver_.GetThreadCount();
+  if (thread_count <= 1u || objects.size() <= kCopyAndFixupObjectsChunkSize) {
+    for (Object* obj : objects) {
+      CopyAndFixupObject(obj);
+    }
+  } else {
+    Thread* self = Thread::Current();
+    // The tasks access the objects with their own ScopedObjectAccess.
+    ScopedThreadSuspension sts(self, kNative);
+    // The calling thread works on the chunks too, while waiting for the workers.
+    ThreadPool thread_pool("Image writer thread pool", thread_count - 1u);
+    for (size_t begin = 0; begin < objects.size(); begin += kCopyAndFixupObjectsChunkSize) {
+      size_t end = std::min(begin + kCopyAndFixupObjectsChunkSize, objects.size());
+      thread_pool.AddTask(
+          self, new CopyAndFixupObjectsTask(this, objects.data() + begin, objects.data() + end));
+    }
+    thread_pool.StartWorkers(self);
+    thread_pool.Wait(self, /* do_work */ true, /* may_hold_locks */ false);
+  }
+  // The pointer arrays are all fixed up.
+  pointer_arrays_.clear();
   // Fix up the object previously had hash codes.
   for (const auto& hash_pair : saved_hashcode_map_) {
     Object* obj = hash_pair.first;
@@ -2225,7 +2371,8 @@ void ImageWriter::CopyAndFixupObject(Object* obj) {
   DCHECK_LT(offset, image_info.image_end_);
   const auto* src = reinterpret_cast<const uint8_t*>(obj);
 
-  image_info.image_bitmap_->Set(dst);  // Mark the obj as live.
+  // Mark the obj as live. Objects of the same bitmap word may be copied by other threads.
+  image_info.image_bitmap_->AtomicTestAndSet(dst);
 
   const size_t n = obj->SizeOf();
   DCHECK_LE(offset + n, image_info.image_->Size());
@@ -2400,9 +2547,8 @@ void ImageWriter::FixupObject(Object* orig, Object* copy) {
     // Is this a native pointer array?
     auto it = pointer_arrays_.find(down_cast<mirror::PointerArray*>(orig));
     if (it != pointer_arrays_.end()) {
-      // Should only need to fixup every pointer array exactly once.
+      // Every pointer array is fixed up exactly once, as it is copied once.
       FixupPointerArray(copy, down_cast<mirror::PointerArray*>(orig), klass, it->second);
-      pointer_arrays_.erase(it);
       return;
     }
   }
@@ -63,6 +63,7 @@ class ClassLoader;
 
 class ClassLoaderVisitor;
 class ImtConflictTable;
+class ProfileCompilationInfo;
 
 static constexpr int kInvalidFd = -1;
 
@@ -238,6 +239,9 @@ class ImageWriter FINAL {
   // Number of stub types.
   static constexpr size_t kNumberOfStubTypes = static_cast<size_t>(StubType::kLast) + 1u;
 
+  // Number of objects copied and fixed up by each task of CopyAndFixupObjects().
+  static constexpr size_t kCopyAndFixupObjectsChunkSize = 1024u;
+
   // We use the lock word to store the bin # and bin index of the object in the image.
   //
   // The struct size must be exactly sizeof(LockWord), currently 32-bits, since this will end up
@@ -444,6 +448,10 @@ class ImageWriter FINAL {
   // Lays out where the image objects will be at runtime.
   void CalculateNewObjectOffsets()
       REQUIRES_SHARED(Locks::mutator_lock_);
+  // Assigns the bin slots of the classes which the profile marks as used during startup, with
+  // the strings loaded by their startup methods, before any other object.
+  void AssignStartupBinSlots(const ProfileCompilationInfo& profile, WorkStack* work_stack)
+      REQUIRES_SHARED(Locks::mutator_lock_);
   void ProcessWorkStack(WorkStack* work_stack)
       REQUIRES_SHARED(Locks::mutator_lock_);
   void CreateHeader(size_t oat_index)
@@ -457,6 +465,7 @@ class ImageWriter FINAL {
 
   // Creates the contiguous image in memory and adjusts pointers.
   void CopyAndFixupNativeData(size_t oat_index) REQUIRES_SHARED(Locks::mutator_lock_);
+  // Copies the objects to the image and fixes them up, with the threads of the compiler driver.
   void CopyAndFixupObjects() REQUIRES_SHARED(Locks::mutator_lock_);
   void CopyAndFixupObject(mirror::Object* obj) REQUIRES_SHARED(Locks::mutator_lock_);
   void CopyAndFixupMethod(ArtMethod* orig, ArtMethod* copy, const ImageInfo& image_info)
@@ -642,7 +651,9 @@ class ImageWriter FINAL {
   // Set of objects known to be dirty in the image. Can be nullptr if there are none.
   const std::unordered_set<std::string>* dirty_image_objects_;
 
+  class CollectStartupClassesVisitor;
   class ComputeLazyFieldsForClassesVisitor;
+  class CopyAndFixupObjectsTask;
   class FixupClassVisitor;
   class FixupRootVisitor;
   class FixupVisitor;
@@ -990,17 +990,18 @@ struct OatWriter::OrderedMethodData {
 
   // Bin each method according to the profile flags.
   //
-  // Groups by e.g.
-  //  -- not hot at all
-  //  -- hot
-  //  -- hot and startup
-  //  -- hot and post-startup
-  //  -- hot and startup and poststartup
-  //  -- startup
+  // Groups in this order:
+  //  -- startup and hot and post-startup
+  //  -- startup and hot
   //  -- startup and post-startup
+  //  -- startup
+  //  -- hot and post-startup
+  //  -- hot
   //  -- post-startup
+  //  -- not hot at all
   //
-  // (See MethodHotness enum definition for up-to-date binning order.)
+  // so that the code executed during startup is contiguous at the beginning of .text, followed
+  // by the rest of the hot code.
   bool operator<(const OrderedMethodData& other) const {
     if (kOatWriterForceOatCodeLayout) {
       // Development flag: Override default behavior by sorting by name.
@@ -1023,20 +1024,21 @@ struct OatWriter::OrderedMethodData {
   // Used to determine relative order for OAT code layout when determining
   // binning.
   size_t GetMethodHotnessOrder() const {
+    // From the least significant bit, in increasing order of precedence.
     bool hotness[] = {
+      method_hotness.IsPostStartup(),
       method_hotness.IsHot(),
-      method_hotness.IsStartup(),
-      method_hotness.IsPostStartup()
+      method_hotness.IsStartup()
     };
 
+    // Note: Among the bins which are not used during startup, the order matters less. If the
+    // kernel does or does not read-ahead any memory, it only goes into the buffer cache and does
+    // not grow the PSS until the first time that memory is referenced in the process.
 
-    // Note: Bin-to-bin order does not matter. If the kernel does or does not read-ahead
-    // any memory, it only goes into the buffer cache and does not grow the PSS until the first
-    // time that memory is referenced in the process.
-
+    // A set flag sorts the method first.
     size_t hotness_bits = 0;
     for (size_t i = 0; i < arraysize(hotness); ++i) {
-      if (hotness[i]) {
+      if (!hotness[i]) {
         hotness_bits |= (1 << i);
       }
     }
@@ -1189,10 +1191,10 @@ class OatWriter::LayoutCodeMethodVisitor : public OatDexMethodVisitor {
       // we preserve the original insertion order within the same sort order.
       std::stable_sort(ordered_methods_.begin(), ordered_methods_.end());
     } else {
-      // The profile-less behavior is as if every method had 0 hotness
+      // The profile-less behavior is as if every method had no hotness
       // associated with it.
       //
-      // Since sorting all methods with hotness=0 should give back the same
+      // Since sorting all methods with no hotness should give back the same
       // order as before, don't do anything.
       DCHECK(std::is_sorted(ordered_methods_.begin(), ordered_methods_.end()));
     }
@@ -3394,8 +3396,13 @@ bool OatWriter::LayoutAndWriteDexFile(OutputStream* out, OatDexFile* oat_dex_fil
   std::unique_ptr<const DexFile> dex_file;
   if (oat_dex_file->source_.IsZipEntry()) {
     ZipEntry* zip_entry = oat_dex_file->source_.GetZipEntry();
-    std::unique_ptr<MemMap> mem_map(
-        zip_entry->ExtractToMemMap(location.c_str(), "classes.dex", &error_msg));
+    // The input is only read, avoid copying it when it is stored uncompressed.
+    std::string extract_reason;
+    std::unique_ptr<MemMap> mem_map(zip_entry->MapDirectlyOrExtract(location.c_str(),
+                                                                    "classes.dex",
+                                                                    alignof(DexFile::Header),
+                                                                    &extract_reason,
+                                                                    &error_msg));
     if (mem_map == nullptr) {
       LOG(ERROR) << "Failed to extract dex file to mem map for layout: " << error_msg;
       return false;
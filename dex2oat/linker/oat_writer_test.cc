@@ -184,6 +184,7 @@ class OatTest : public CommonCompilerTest {
         compiler_driver_->GetInstructionSet(),
         compiler_driver_->GetInstructionSetFeatures(),
         &compiler_driver_->GetCompilerOptions(),
+        compiler_driver_->GetThreadCount(),
         oat_file);
     elf_writer->Start();
     OutputStream* oat_rodata = elf_writer->StartRoData();
@@ -37,9 +37,11 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 #include "android-base/stringprintf.h"
@@ -1402,6 +1404,66 @@ static void dumpCfg(const DexFile* dex_file, int idx) {
   }
 }
 
+/*
+ * Dumps how many times each pair of opcodes occurs in consecutive instructions of
+ * the dex file, when the first instruction may continue to the second one. These
+ * are the candidates for a handler which executes both instructions. Branches and
+ * switches into the second instruction are not taken into account.
+ */
+static void dumpOpcodePairs(const DexFile* pDexFile) {
+  constexpr size_t kNumOpcodes = kNumPackedOpcodes;
+  std::vector<u4> counts(kNumOpcodes * kNumOpcodes, 0u);
+  const u4 classDefsSize = pDexFile->GetHeader().class_defs_size_;
+  for (u4 i = 0; i < classDefsSize; i++) {
+    const u1* classData = pDexFile->GetClassData(pDexFile->GetClassDef(i));
+    if (classData == nullptr) {
+      continue;
+    }
+    ClassDataItemIterator it(*pDexFile, classData);
+    it.SkipAllFields();
+    for (; it.HasNextMethod(); it.Next()) {
+      if (it.GetMethodCodeItem() == nullptr) {
+        continue;
+      }
+      const Instruction* previous = nullptr;
+      CodeItemInstructionAccessor accessor(pDexFile, it.GetMethodCodeItem());
+      for (const DexInstructionPcPair& pair : accessor) {
+        const Instruction* instruction = &pair.Inst();
+        if (instruction->SizeInCodeUnits() == 0) {
+          break;
+        }
+        // Payloads of switches and arrays, and padding, are NOPs.
+        if (instruction->Opcode() == Instruction::NOP) {
+          previous = nullptr;
+          continue;
+        }
+        if (previous != nullptr && previous->CanFlowThrough()) {
+          counts[previous->Opcode() * kNumOpcodes + instruction->Opcode()]++;
+        }
+        previous = instruction;
+      }  // for
+    }  // for
+  }  // for
+
+  std::vector<std::pair<u4, size_t>> pairs;
+  for (size_t i = 0; i < counts.size(); i++) {
+    if (counts[i] != 0u) {
+      pairs.emplace_back(counts[i], i);
+    }
+  }  // for
+  std::sort(pairs.begin(), pairs.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second < rhs.second;
+  });
+  fprintf(gOutFile, "Opcode pairs      -
+");
+  for (const std::pair<u4, size_t>& pair : pairs) {
+    fprintf(gOutFile, "  %10u : %s, %s\n",
+            pair.first,
+            Instruction::Name(static_cast<Instruction::Code>(pair.second / kNumOpcodes)),
+            Instruction::Name(static_cast<Instruction::Code>(pair.second % kNumOpcodes)));
+  }  // for
+}
+
 /*
  * Dumps the class.
  *
@@ -1833,6 +1895,12 @@ static void processDexFile(const char* fileName,
     dumpFileHeader(pDexFile);
   }
 
+  // Opcode pairs instead of the classes.
+  if (gOptions.showOpcodePairs) {
+    dumpOpcodePairs(pDexFile);
+    return;
+  }
+
   // Open XML context.
   if (gOptions.outputFormat == OUTPUT_XML) {
     fprintf(gOutFile, "<api>\n");
@@ -45,6 +45,7 @@ struct Options {
   bool showAnnotations;
   bool showCfg;
   bool showFileHeaders;
+  bool showOpcodePairs;
   bool showSectionHeaders;
   bool verbose;
   OutputFormat outputFormat;
@@ -43,7 +43,7 @@ static const char* gProgName = "dexdump";
  */
 static void usage(void) {
   fprintf(stderr, "Copyright (C) 2007 The Android Open Source Project\n\n");
-  fprintf(stderr, "%s: [-a] [-c] [-d] [-e] [-f] [-h] [-i] [-l layout] [-o outfile]"
+  fprintf(stderr, "%s: [-a] [-c] [-d] [-e] [-f] [-h] [-i] [-l layout] [-o outfile] [-p]"
                   " dexfile...\n\n", gProgName);
   fprintf(stderr, " -a : display annotations\n");
   fprintf(stderr, " -c : verify checksum and exit\n");
@@ -55,6 +55,7 @@ static void usage(void) {
   fprintf(stderr, " -i : ignore checksum failures\n");
   fprintf(stderr, " -l : output layout, either 'plain' or 'xml'\n");
   fprintf(stderr, " -o : output file name (defaults to stdout)\n");
+  fprintf(stderr, " -p : display counts of consecutive opcode pairs\n");
 }
 
 /*
@@ -72,7 +73,7 @@ int dexdumpDriver(int argc, char** argv) {
 
   // Parse all arguments.
   while (1) {
-    const int ic = getopt(argc, argv, "acdefghil:o:");
+    const int ic = getopt(argc, argv, "acdefghil:o:p");
     if (ic < 0) {
       break;  // done
     }
@@ -114,6 +115,9 @@ int dexdumpDriver(int argc, char** argv) {
       case 'o':  // output file
         gOptions.outputFileName = optarg;
         break;
+      case 'p':  // display opcode pairs
+        gOptions.showOpcodePairs = true;
+        break;
       default:
         wantUsage = true;
         break;
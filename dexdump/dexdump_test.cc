@@ -72,6 +72,11 @@ TEST_F(DexDumpTest, FullPlainOutput) {
     dex_file_}, &error_msg)) << error_msg;
 }
 
+TEST_F(DexDumpTest, OpcodePairs) {
+  std::string error_msg;
+  ASSERT_TRUE(Exec({"-p", "-o", "/dev/null", dex_file_}, &error_msg)) << error_msg;
+}
+
 TEST_F(DexDumpTest, XMLOutput) {
   std::string error_msg;
   ASSERT_TRUE(Exec({"-l", "xml", "-o", "/dev/null",
@@ -16,10 +16,24 @@
 
 #include "compact_dex_writer.h"
 
+#include <algorithm>
+#include <map>
+
+#include "base/array_ref.h"
 #include "cdex/compact_dex_file.h"
 
 namespace art {
 
+namespace {
+
+struct ByteArrayLess {
+  bool operator()(const ArrayRef<const uint8_t>& lhs, const ArrayRef<const uint8_t>& rhs) const {
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+};
+
+}  // anonymous namespace
+
 void CompactDexWriter::WriteHeader() {
   CompactDexFile::Header header;
   CompactDexFile::WriteMagic(&header.magic_[0]);
@@ -50,4 +64,30 @@ void CompactDexWriter::WriteHeader() {
   UNUSED(Write(reinterpret_cast<uint8_t*>(&header), sizeof(header), 0u));
 }
 
+uint32_t CompactDexWriter::WriteDebugInfoItems(uint32_t offset) {
+  DCHECK(compute_offsets_);
+  const uint32_t start = offset;
+  // Many methods have the same debug info, for instance the constructors and accessors declared
+  // on the same line or the methods of generated code.
+  std::map<ArrayRef<const uint8_t>, uint32_t, ByteArrayLess> written_debug_infos;
+  for (std::unique_ptr<dex_ir::DebugInfoItem>& debug_info :
+      header_->GetCollections().DebugInfoItems()) {
+    ArrayRef<const uint8_t> data(debug_info->GetDebugInfo(), debug_info->GetDebugInfoSize());
+    auto it = written_debug_infos.find(data);
+    if (it != written_debug_infos.end()) {
+      debug_info->SetOffset(it->second);
+      continue;
+    }
+    // Debug infos are byte aligned.
+    ProcessOffset(&offset, debug_info.get());
+    written_debug_infos.emplace(data, offset);
+    offset += Write(debug_info->GetDebugInfo(), debug_info->GetDebugInfoSize(), offset);
+    ++num_debug_info_items_;
+  }
+  if (start != offset) {
+    header_->GetCollections().SetDebugInfoItemsOffset(start);
+  }
+  return offset - start;
+}
+
 }  // namespace art
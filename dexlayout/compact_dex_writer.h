@@ -35,6 +35,9 @@ class CompactDexWriter : public DexWriter {
  protected:
   void WriteHeader() OVERRIDE;
 
+  // Writes the debug infos with the same content only once.
+  uint32_t WriteDebugInfoItems(uint32_t offset) OVERRIDE;
+
   const CompactDexLevel compact_dex_level_;
 
  private:
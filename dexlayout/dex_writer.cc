@@ -519,6 +519,7 @@ uint32_t DexWriter::WriteDebugInfoItems(uint32_t offset) {
     offset = RoundUp(offset, SectionAlignment(DexFile::kDexTypeDebugInfoItem));
     ProcessOffset(&offset, debug_info.get());
     offset += Write(debug_info->GetDebugInfo(), debug_info->GetDebugInfoSize(), offset);
+    ++num_debug_info_items_;
   }
   if (compute_offsets_ && start != offset) {
     header_->GetCollections().SetDebugInfoItemsOffset(start);
@@ -756,7 +757,7 @@ uint32_t DexWriter::GenerateAndWriteMapItems(uint32_t offset) {
                               collection.StringDatasSize(),
                               collection.StringDatasOffset()));
   queue.AddIfNotEmpty(MapItem(DexFile::kDexTypeDebugInfoItem,
-                              collection.DebugInfoItemsSize(),
+                              num_debug_info_items_,
                               collection.DebugInfoItemsOffset()));
   queue.AddIfNotEmpty(MapItem(DexFile::kDexTypeAnnotationItem,
                               collection.AnnotationItemsSize(),
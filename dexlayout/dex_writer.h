@@ -66,7 +66,8 @@ class DexWriter {
       : header_(header),
         mem_map_(mem_map),
         dex_layout_(dex_layout),
-        compute_offsets_(compute_offsets) {}
+        compute_offsets_(compute_offsets),
+        num_debug_info_items_(0u) {}
 
   static void Output(dex_ir::Header* header,
                      MemMap* mem_map,
@@ -108,7 +109,7 @@ class DexWriter {
   uint32_t WriteAnnotationsDirectories(uint32_t offset);
 
   // Data section.
-  uint32_t WriteDebugInfoItems(uint32_t offset);
+  virtual uint32_t WriteDebugInfoItems(uint32_t offset);
   uint32_t WriteCodeItems(uint32_t offset, bool reserve_only);
   uint32_t WriteTypeLists(uint32_t offset);
   uint32_t WriteStringDatas(uint32_t offset);
@@ -132,6 +133,9 @@ class DexWriter {
   MemMap* const mem_map_;
   DexLayout* const dex_layout_;
   bool compute_offsets_;
+  // Number of debug info items written, which may be less than in the collection if identical
+  // ones are shared.
+  uint32_t num_debug_info_items_;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(DexWriter);
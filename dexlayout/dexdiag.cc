@@ -28,10 +28,14 @@
 
 #include "base/logging.h"  // For InitLogging.
 #include "base/stringpiece.h"
+#include "base/unix_file/fd_file.h"
 
 #include "dex_file.h"
+#include "dex_file_loader.h"
 #include "dex_ir.h"
 #include "dex_ir_builder.h"
+#include "jit/profile_compilation_info.h"
+#include "os.h"
 #ifdef ART_TARGET_ANDROID
 #include "pagemap/pagemap.h"
 #endif
@@ -196,8 +200,10 @@ static void ProcessPageMap(uint64_t* pagemap,
                            size_t start,
                            size_t end,
                            const std::vector<dex_ir::DexFileSection>& sections,
-                           PageCount* page_counts) {
+                           PageCount* page_counts,
+                           size_t* resident_runs) {
   static constexpr size_t kLineLength = 32;
+  *resident_runs = 0;
   for (size_t page = start; page < end; ++page) {
     char type_char = '.';
     if (PM_PAGEMAP_PRESENT(pagemap[page])) {
@@ -205,6 +211,9 @@ static void ProcessPageMap(uint64_t* pagemap,
       uint16_t type = FindSectionTypeForPage(dex_page_offset, sections);
       page_counts->Increment(type);
       type_char = PageTypeChar(type);
+      if (page == start || !PM_PAGEMAP_PRESENT(pagemap[page - 1])) {
+        ++*resident_runs;
+      }
     }
     if (g_verbose) {
       std::cout << type_char;
@@ -223,6 +232,7 @@ static void ProcessPageMap(uint64_t* pagemap,
 static void DisplayDexStatistics(size_t start,
                                  size_t end,
                                  const PageCount& resident_pages,
+                                 size_t resident_runs,
                                  const std::vector<dex_ir::DexFileSection>& sections,
                                  Printer* printer) {
   // Compute the total possible sizes for sections.
@@ -260,13 +270,73 @@ static void DisplayDexStatistics(size_t start,
                     total_mapped_pages,
                     percent_of_total,
                     percent_of_total);
+  // Each run of resident pages was read by at least one page fault, more if the runs are longer
+  // than the read-ahead. Laying out the hot data together lowers this estimate.
+  std::cout << "Page faults estimate: " << resident_runs
+            << " (runs of resident pages)" << std::endl;
   printer->PrintSkipLine();
 }
 
+// Adds the methods with code on a resident page, and their classes, to the profile.
+static void AddResidentMethodsToProfile(uint64_t* pagemap,
+                                        uint64_t dex_file_offset,
+                                        dex_ir::Header* header,
+                                        const DexFile* dex_file,
+                                        const std::string& dex_location,
+                                        ProfileCompilationInfo* profile) {
+  using Hotness = ProfileCompilationInfo::MethodHotness;
+  size_t method_count = 0;
+  for (const std::unique_ptr<dex_ir::ClassDef>& class_def : header->GetCollections().ClassDefs()) {
+    dex_ir::ClassData* class_data = class_def->GetClassData();
+    if (class_data == nullptr) {
+      continue;
+    }
+    bool is_class_resident = false;
+    for (size_t i = 0; i < 2; ++i) {
+      for (auto& method : *(i == 0 ? class_data->DirectMethods() : class_data->VirtualMethods())) {
+        const dex_ir::CodeItem* code_item = method->GetCodeItem();
+        if (code_item == nullptr) {
+          continue;
+        }
+        const uint64_t begin = dex_file_offset + code_item->GetOffset();
+        const uint64_t end = begin + std::max(code_item->GetSize(), 1u);
+        bool is_resident = false;
+        for (uint64_t page = begin / kPageSize; page <= (end - 1) / kPageSize; ++page) {
+          if (PM_PAGEMAP_PRESENT(pagemap[page])) {
+            is_resident = true;
+            break;
+          }
+        }
+        if (is_resident) {
+          // The method was run at least once, but that does not make it hot.
+          profile->AddMethodIndex(Hotness::kFlagPostStartup,
+                                  dex_location,
+                                  dex_file->GetLocationChecksum(),
+                                  method->GetMethodId()->GetIndex(),
+                                  dex_file->NumMethodIds());
+          is_class_resident = true;
+          ++method_count;
+        }
+      }
+    }
+    if (is_class_resident) {
+      profile->AddClassIndex(dex_location,
+                             dex_file->GetLocationChecksum(),
+                             dex::TypeIndex(class_def->ClassType()->GetIndex()),
+                             dex_file->NumMethodIds());
+    }
+  }
+  if (g_verbose) {
+    std::cout << "Methods with resident code: " << method_count << std::endl;
+  }
+}
+
 static void ProcessOneDexMapping(uint64_t* pagemap,
                                  uint64_t map_start,
                                  const DexFile* dex_file,
                                  uint64_t vdex_start,
+                                 const std::string& dex_location,
+                                 ProfileCompilationInfo* profile,
                                  Printer* printer) {
   uint64_t dex_file_start = reinterpret_cast<uint64_t>(dex_file->Begin());
   size_t dex_file_size = dex_file->Size();
@@ -288,16 +358,28 @@ static void ProcessOneDexMapping(uint64_t* pagemap,
                             map_start + end_page * kPageSize)
             << std::endl;
   // Build a list of the dex file section types, sorted from highest offset to lowest.
-  std::vector<dex_ir::DexFileSection> sections;
-  {
-    std::unique_ptr<dex_ir::Header> header(dex_ir::DexIrBuilder(*dex_file,
-                                                                /*eagerly_assign_offsets*/ true));
-    sections = dex_ir::GetSortedDexFileSections(header.get(),
-                                                dex_ir::SortDirection::kSortDescending);
-  }
+  std::unique_ptr<dex_ir::Header> header(dex_ir::DexIrBuilder(*dex_file,
+                                                              /*eagerly_assign_offsets*/ true));
+  std::vector<dex_ir::DexFileSection> sections =
+      dex_ir::GetSortedDexFileSections(header.get(), dex_ir::SortDirection::kSortDescending);
+  if (profile != nullptr) {
+    AddResidentMethodsToProfile(pagemap,
+                                dex_file_start - vdex_start,
+                                header.get(),
+                                dex_file,
+                                dex_location,
+                                profile);
+  }
+  header.reset();
   PageCount section_resident_pages;
-  ProcessPageMap(pagemap, start_page, end_page, sections, &section_resident_pages);
-  DisplayDexStatistics(start_page, end_page, section_resident_pages, sections, printer);
+  size_t resident_runs;
+  ProcessPageMap(pagemap, start_page, end_page, sections, &section_resident_pages, &resident_runs);
+  DisplayDexStatistics(start_page,
+                       end_page,
+                       section_resident_pages,
+                       resident_runs,
+                       sections,
+                       printer);
 }
 
 static bool IsVdexFileMapping(const std::string& mapped_name) {
@@ -312,7 +394,15 @@ static bool IsVdexFileMapping(const std::string& mapped_name) {
   return false;
 }
 
-static bool DisplayMappingIfFromVdexFile(pm_map_t* map, Printer* printer) {
+// The dex files of an app vdex file come from the apk with the same name, for instance base.apk
+// for base.vdex, which also gives their profile key.
+static std::string GetDexLocationForVdex(const std::string& vdex_name) {
+  return vdex_name.substr(0, vdex_name.length() - strlen(".vdex")) + ".apk";
+}
+
+static bool DisplayMappingIfFromVdexFile(pm_map_t* map,
+                                         ProfileCompilationInfo* profile,
+                                         Printer* printer) {
   std::string vdex_name = pm_map_name(map);
   // Extract all the dex files from the vdex file.
   std::string error_msg;
@@ -351,11 +441,14 @@ static bool DisplayMappingIfFromVdexFile(pm_map_t* map, Printer* printer) {
             << pm_map_name(map)
             << StringPrintf(": %" PRIx64 "-%" PRIx64, pm_map_start(map), pm_map_end(map))
             << std::endl;
-  for (const auto& dex_file : dex_files) {
+  const std::string dex_location = GetDexLocationForVdex(vdex_name);
+  for (size_t i = 0; i < dex_files.size(); ++i) {
     ProcessOneDexMapping(pagemap,
                          pm_map_start(map),
-                         dex_file.get(),
+                         dex_files[i].get(),
                          reinterpret_cast<uint64_t>(vdex->Begin()),
+                         DexFileLoader::GetMultiDexLocation(i, dex_location.c_str()),
+                         profile,
                          printer);
   }
   free(pagemap);
@@ -438,6 +531,13 @@ static void Usage(const char* cmd) {
   std::cout << "Usage: " << cmd << " [options] pid" << std::endl
             << "    --contains=<string>:  Display sections containing string." << std::endl
             << "    --help:               Shows this message." << std::endl
+            << "    --profile-output=<file>: Adds the methods with resident code in vdex files"
+            << std::endl
+            << "                          to the profile in file, keyed by the apk with the name"
+            << std::endl
+            << "                          of the vdex file. Running it repeatedly accumulates"
+            << std::endl
+            << "                          the residency over time." << std::endl
             << "    --verbose:            Makes displays verbose." << std::endl;
   PrintLetterKey();
 }
@@ -449,6 +549,7 @@ static int DexDiagMain(int argc, char* argv[]) {
   }
 
   std::vector<std::string> name_filters;
+  std::string profile_output;
   // TODO: add option to track usage by class name, etc.
   for (int i = 1; i < argc - 1; ++i) {
     const StringPiece option(argv[i]);
@@ -460,6 +561,8 @@ static int DexDiagMain(int argc, char* argv[]) {
     } else if (option.starts_with("--contains=")) {
       std::string contains(option.substr(strlen("--contains=")).data());
       name_filters.push_back(contains);
+    } else if (option.starts_with("--profile-output=")) {
+      profile_output = option.substr(strlen("--profile-output=")).ToString();
     } else {
       Usage(argv[0]);
       return EXIT_FAILURE;
@@ -504,6 +607,19 @@ static int DexDiagMain(int argc, char* argv[]) {
     return EXIT_FAILURE;
   }
 
+  // Merge with the methods found by the previous runs.
+  std::unique_ptr<ProfileCompilationInfo> profile;
+  if (!profile_output.empty()) {
+    profile.reset(new ProfileCompilationInfo());
+    if (OS::FileExists(profile_output.c_str())) {
+      std::unique_ptr<File> file(OS::OpenFileForReading(profile_output.c_str()));
+      if (file == nullptr || !profile->Load(file->Fd())) {
+        std::cerr << "Could not load profile " << profile_output << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
   bool match_found = false;
   // Process the mappings that are due to vdex or oat files.
   Printer printer;
@@ -514,7 +630,7 @@ static int DexDiagMain(int argc, char* argv[]) {
       continue;
     }
     if (IsVdexFileMapping(mapped_file_name)) {
-      if (!DisplayMappingIfFromVdexFile(maps[i], &printer)) {
+      if (!DisplayMappingIfFromVdexFile(maps[i], profile.get(), &printer)) {
         return EXIT_FAILURE;
       }
       match_found = true;
@@ -529,6 +645,13 @@ static int DexDiagMain(int argc, char* argv[]) {
     std::cerr << "No relevant memory maps were found." << std::endl;
     return EXIT_FAILURE;
   }
+  if (profile != nullptr) {
+    std::unique_ptr<File> file(OS::CreateEmptyFile(profile_output.c_str()));
+    if (file == nullptr || !profile->Save(file->Fd()) || file->FlushCloseOrErase() != 0) {
+      std::cerr << "Could not save profile " << profile_output << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
 #endif
 
   return EXIT_SUCCESS;
@@ -1806,10 +1806,40 @@ void DexLayout::LayoutCodeItems(const DexFile* dex_file) {
   });
 }
 
+// Orders debug info items according to the code item ordering. The debug info of executed
+// methods is read for stack traces and exceptions, apart from the rest which is never read.
+void DexLayout::LayoutDebugInfoItems() {
+  dex_ir::CollectionVector<dex_ir::DebugInfoItem>::Vector& debug_infos =
+      header_->GetCollections().DebugInfoItems();
+  std::unordered_set<dex_ir::DebugInfoItem*> visited_debug_info;
+  std::vector<dex_ir::DebugInfoItem*> new_debug_info_order;
+  for (const std::unique_ptr<dex_ir::CodeItem>& code_item :
+       header_->GetCollections().CodeItems()) {
+    dex_ir::DebugInfoItem* debug_info = code_item->DebugInfo();
+    if (debug_info != nullptr && visited_debug_info.insert(debug_info).second) {
+      new_debug_info_order.push_back(debug_info);
+    }
+  }
+  // Keep the debug info items not referenced by any code item at the end.
+  for (const std::unique_ptr<dex_ir::DebugInfoItem>& debug_info : debug_infos) {
+    if (visited_debug_info.find(debug_info.get()) == visited_debug_info.end()) {
+      new_debug_info_order.push_back(debug_info.get());
+    }
+  }
+  CHECK_EQ(new_debug_info_order.size(), debug_infos.size());
+  for (size_t i = 0; i < debug_infos.size(); ++i) {
+    // Overwrite the existing vector with the new ordering, note that the sets of objects are
+    // equivalent, but the order changes. This is why this is not a memory leak.
+    debug_infos[i].release();
+    debug_infos[i].reset(new_debug_info_order[i]);
+  }
+}
+
 void DexLayout::LayoutOutputFile(const DexFile* dex_file) {
   LayoutStringData(dex_file);
   LayoutClassDefsAndClassData(dex_file);
   LayoutCodeItems(dex_file);
+  LayoutDebugInfoItems();
 }
 
 void DexLayout::OutputDexFile(const DexFile* dex_file, bool compute_offsets) {
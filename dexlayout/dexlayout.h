@@ -143,10 +143,11 @@ class DexLayout {
 
   void LayoutClassDefsAndClassData(const DexFile* dex_file);
   void LayoutCodeItems(const DexFile* dex_file);
+  void LayoutDebugInfoItems();
   void LayoutStringData(const DexFile* dex_file);
 
   // Creates a new layout for the dex file based on profile info.
-  // Currently reorders ClassDefs, ClassDataItems, and CodeItems.
+  // Currently reorders ClassDefs, ClassDataItems, CodeItems, StringDatas and DebugInfoItems.
   void LayoutOutputFile(const DexFile* dex_file);
   void OutputDexFile(const DexFile* dex_file, bool compute_offsets);
 
@@ -1115,6 +1115,11 @@ DISASSEMBLER_ENTRY(cmp,
         has_modrm = true;
         load = true;
         break;
+      case 0xC1:
+        opcode1 = "xadd";
+        has_modrm = true;
+        store = true;
+        break;
       case 0xC3:
         opcode1 = "movnti";
         store = true;
@@ -1194,6 +1199,17 @@ DISASSEMBLER_ENTRY(cmp,
           opcode1 = opcode_tmp.c_str();
         }
         break;
+      case 0xD7:
+        if (prefix[2] == 0x66) {
+          src_reg_file = SSE;
+          prefix[2] = 0;
+        } else {
+          src_reg_file = MMX;
+        }
+        opcode1 = "pmovmskb";
+        has_modrm = true;
+        load = true;
+        break;
       case 0xDA:
       case 0xDE:
       case 0xE0:
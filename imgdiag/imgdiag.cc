@@ -14,13 +14,17 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <map>
+#include <numeric>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -1094,6 +1098,36 @@ class RegionData : public RegionSpecializedBase<T> {
   DISALLOW_COPY_AND_ASSIGN(RegionData);
 };
 
+// Finds the mapping of the image with the given file name, e.g. "boot.art", in the maps of a
+// process. In actuality there's more than 1 map, but the others are read-only. The read-only maps
+// are guaranteed to be identical, so its not interesting to compare them.
+bool FindWritableImageMap(BacktraceMap* proc_maps,
+                          const std::string& image_base_name,
+                          backtrace_map_t* image_map) {
+  for (const backtrace_map_t* map : *proc_maps) {
+    const std::string& name = map->name;
+    if (name.size() >= image_base_name.size() &&
+        name.compare(name.size() - image_base_name.size(),
+                     image_base_name.size(),
+                     image_base_name) == 0 &&
+        (map->flags & PROT_WRITE) != 0) {
+      *image_map = *map;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Return suffix of the file path after the last /. (e.g. /foo/bar -> bar, bar -> bar)
+std::string BaseName(const std::string& str) {
+  size_t idx = str.rfind('/');
+  if (idx == std::string::npos) {
+    return str;
+  }
+
+  return str.substr(idx + 1);
+}
+
 }  // namespace
 
 
@@ -1148,23 +1182,8 @@ class ImgDiagDumper {
       return false;
     }
 
-    bool found_boot_map = false;
     // Find the memory map only for boot.art
-    for (const backtrace_map_t* map : *tmp_proc_maps) {
-      if (EndsWith(map->name, GetImageLocationBaseName())) {
-        if ((map->flags & PROT_WRITE) != 0) {
-          boot_map_ = *map;
-          found_boot_map = true;
-          break;
-        }
-        // In actuality there's more than 1 map, but the second one is read-only.
-        // The one we care about is the write-able map.
-        // The readonly maps are guaranteed to be identical, so its not interesting to compare
-        // them.
-      }
-    }
-
-    if (!found_boot_map) {
+    if (!FindWritableImageMap(tmp_proc_maps.get(), GetImageLocationBaseName(), &boot_map_)) {
       os << "Could not find map for " << GetImageLocationBaseName();
       return false;
     }
@@ -1579,21 +1598,6 @@ class ImgDiagDumper {
     }
   }
 
-  static bool EndsWith(const std::string& str, const std::string& suffix) {
-    return str.size() >= suffix.size() &&
-           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
-  }
-
-  // Return suffix of the file path after the last /. (e.g. /foo/bar -> bar, bar -> bar)
-  static std::string BaseName(const std::string& str) {
-    size_t idx = str.rfind('/');
-    if (idx == std::string::npos) {
-      return str;
-    }
-
-    return str.substr(idx + 1);
-  }
-
   // Return the image location, stripped of any directories, e.g. "boot.art" or "core.art"
   std::string GetImageLocationBaseName() const {
     return BaseName(std::string(image_location_));
@@ -1629,6 +1633,168 @@ class ImgDiagDumper {
   DISALLOW_COPY_AND_ASSIGN(ImgDiagDumper);
 };
 
+// Tracks the pages of an image dirtied by a process over time with the soft-dirty bits of
+// /proc/<pid>/pagemap, which only needs one read of the pagemap per sample rather than reading
+// and diffing /proc/<pid>/mem. The soft-dirty bits are cleared by the caller through
+// /proc/<pid>/clear_refs before each sample. The dirty pages are then attributed to the objects
+// on them, and to their classes.
+class SoftDirtyTracker {
+ public:
+  SoftDirtyTracker(std::ostream* os,
+                   const ImageHeader& image_header,
+                   const std::string& image_location,
+                   pid_t pid)
+      : os_(os),
+        image_header_(image_header),
+        image_location_(image_location),
+        pid_(pid),
+        num_samples_(0u) {}
+
+  bool Init() {
+    std::ostream& os = *os_;
+    std::unique_ptr<BacktraceMap> proc_maps(BacktraceMap::Create(pid_));
+    if (proc_maps == nullptr) {
+      os << "Could not read backtrace maps";
+      return false;
+    }
+    if (!FindWritableImageMap(proc_maps.get(), BaseName(image_location_), &image_map_)) {
+      os << "Could not find map for " << BaseName(image_location_);
+      return false;
+    }
+    // The objects are attributed with the image of this process, which must be at the same
+    // address.
+    const uintptr_t image_begin = reinterpret_cast<uintptr_t>(image_header_.GetImageBegin());
+    const uintptr_t image_end = image_begin + image_header_.GetImageSize();
+    if (AlignDown(image_begin, kPageSize) > image_map_.start ||
+        AlignUp(image_end, kPageSize) < image_map_.end) {
+      os << "Remote image map [" << reinterpret_cast<const void*>(image_map_.start) << ", "
+         << reinterpret_cast<const void*>(image_map_.end) << ") is out of range of local image "
+         << "[" << reinterpret_cast<const void*>(image_begin) << ", "
+         << reinterpret_cast<const void*>(image_end) << ")";
+      return false;
+    }
+    std::string pagemap_file_name =
+        StringPrintf("/proc/%ld/pagemap", static_cast<long>(pid_));  // NOLINT [runtime/int]
+    std::unique_ptr<File> pagemap_file(OS::OpenFileForReading(pagemap_file_name.c_str()));
+    if (pagemap_file == nullptr) {
+      os << "Failed to open " << pagemap_file_name << " for reading: " << strerror(errno);
+      return false;
+    }
+    pagemap_file_ = std::move(*pagemap_file.release());
+    page_dirty_counts_.resize((image_map_.end - image_map_.start) / kPageSize, 0u);
+    return true;
+  }
+
+  // Adds the pages soft-dirtied since the soft-dirty bits were last cleared.
+  bool Sample() {
+    constexpr uint64_t kPageSoftDirtyMask = (1ULL << 55);  // bit 55 [in /proc/$pid/pagemap]
+    std::vector<uint64_t> entries(page_dirty_counts_.size());
+    if (!pagemap_file_.PreadFully(entries.data(),
+                                  entries.size() * sizeof(uint64_t),
+                                  (image_map_.start / kPageSize) * sizeof(uint64_t))) {
+      *os_ << "Failed to read the page map entries from " << pagemap_file_.GetPath();
+      return false;
+    }
+    for (size_t i = 0; i != entries.size(); ++i) {
+      if ((entries[i] & kPageSoftDirtyMask) != 0) {
+        ++page_dirty_counts_[i];
+      }
+    }
+    ++num_samples_;
+    return true;
+  }
+
+  // Dumps the dirtied pages and the classes of the objects on them, and adds the classes which
+  // are themselves on dirty pages to dirty_classes with the number of samples they were dirty in.
+  void Dump(std::map<std::string, size_t>* dirty_classes) REQUIRES_SHARED(Locks::mutator_lock_) {
+    std::ostream& os = *os_;
+    const size_t ever_dirty_pages = std::count_if(page_dirty_counts_.begin(),
+                                                  page_dirty_counts_.end(),
+                                                  [](size_t count) { return count != 0u; });
+    const size_t dirty_page_samples = std::accumulate(page_dirty_counts_.begin(),
+                                                      page_dirty_counts_.end(),
+                                                      0u);
+    os << "IMAGE LOCATION: " << image_location_ << "\n"
+       << "Mapping at [" << reinterpret_cast<void*>(image_map_.start) << ", "
+       << reinterpret_cast<void*>(image_map_.end) << ") had over " << num_samples_
+       << " samples:\n  "
+       << ever_dirty_pages << " of " << page_dirty_counts_.size() << " pages dirtied,\n  "
+       << (num_samples_ != 0u ? dirty_page_samples * 1.0f / num_samples_ : 0.0f)
+       << " pages dirtied per sample\n\n";
+
+    // Attribute the dirty pages to the objects on them. An object dirties each sample any of its
+    // pages was dirtied in, which is an upper bound of how often it was written.
+    struct ClassDirtyData {
+      size_t dirty_objects = 0u;
+      size_t dirty_object_samples = 0u;
+    };
+    std::map<mirror::Class*, ClassDirtyData> class_data;
+    const uint8_t* image_begin = AlignDown(image_header_.GetImageBegin(), kPageSize);
+    ImgObjectVisitor visitor(
+        [&](mirror::Object* object,
+            const uint8_t* begin_image_ptr ATTRIBUTE_UNUSED,
+            const std::set<size_t>& dirty_pages ATTRIBUTE_UNUSED)
+            REQUIRES_SHARED(Locks::mutator_lock_) {
+          const size_t samples = GetDirtySamples(reinterpret_cast<uintptr_t>(object),
+                                                 object->SizeOf<kVerifyNone>());
+          if (samples == 0u) {
+            return;
+          }
+          mirror::Class* klass = object->GetClass();
+          ClassDirtyData& data = class_data[klass];
+          ++data.dirty_objects;
+          data.dirty_object_samples += samples;
+          if (object->IsClass()) {
+            size_t& class_samples = (*dirty_classes)[object->AsClass()->PrettyDescriptor()];
+            class_samples = std::max(class_samples, samples);
+          }
+        },
+        image_begin,
+        empty_dirty_pages_);
+    PointerSize pointer_size = InstructionSetPointerSize(Runtime::Current()->GetInstructionSet());
+    image_header_.VisitObjects(&visitor, const_cast<uint8_t*>(image_begin), pointer_size);
+
+    std::vector<std::pair<size_t, mirror::Class*>> sorted_classes;
+    for (const auto& entry : class_data) {
+      sorted_classes.emplace_back(entry.second.dirty_object_samples, entry.first);
+    }
+    std::sort(sorted_classes.rbegin(), sorted_classes.rend());
+    os << "  Objects on dirty pages by class (dirty object samples, objects):\n";
+    for (const auto& entry : sorted_classes) {
+      os << "    " << mirror::Class::PrettyClass(entry.second) << " (" << entry.first << ", "
+         << class_data[entry.second].dirty_objects << ")\n";
+    }
+    os << "\n";
+  }
+
+ private:
+  // Returns the number of samples any page of [begin, begin + size) was dirty in.
+  size_t GetDirtySamples(uintptr_t begin, size_t size) const {
+    if (size == 0u || begin < image_map_.start || begin + size > image_map_.end) {
+      return 0u;
+    }
+    const size_t first_page = (begin - image_map_.start) / kPageSize;
+    const size_t last_page = (begin + size - 1u - image_map_.start) / kPageSize;
+    return *std::max_element(page_dirty_counts_.begin() + first_page,
+                             page_dirty_counts_.begin() + last_page + 1u);
+  }
+
+  std::ostream* os_;
+  const ImageHeader& image_header_;
+  const std::string image_location_;
+  const pid_t pid_;
+  backtrace_map_t image_map_{};
+  // A File for reading /proc/<pid_>/pagemap.
+  File pagemap_file_;
+  // The number of samples each page of image_map_ was soft-dirty in.
+  std::vector<size_t> page_dirty_counts_;
+  size_t num_samples_;
+  // The object visitor wants dirty pages, the tracker uses page_dirty_counts_ instead.
+  const std::set<size_t> empty_dirty_pages_;
+
+  DISALLOW_COPY_AND_ASSIGN(SoftDirtyTracker);
+};
+
 static int DumpImage(Runtime* runtime,
                      std::ostream* os,
                      pid_t image_diff_pid,
@@ -1661,6 +1827,93 @@ static int DumpImage(Runtime* runtime,
   return EXIT_SUCCESS;
 }
 
+// Clears the soft-dirty bits of all the pages of a process.
+static bool ClearSoftDirtyBits(pid_t pid, std::ostream* os) {
+  std::string clear_refs_file_name =
+      StringPrintf("/proc/%ld/clear_refs", static_cast<long>(pid));  // NOLINT [runtime/int]
+  std::unique_ptr<File> clear_refs_file(
+      OS::OpenFileWithFlags(clear_refs_file_name.c_str(), O_WRONLY, /* auto_flush */ false));
+  if (clear_refs_file == nullptr) {
+    *os << "Failed to open " << clear_refs_file_name << " for writing: " << strerror(errno);
+    return false;
+  }
+  // See https://www.kernel.org/doc/Documentation/vm/soft-dirty.txt
+  static const char kClearSoftDirty[] = "4";
+  bool success = clear_refs_file->WriteFully(kClearSoftDirty, sizeof(kClearSoftDirty) - 1u);
+  if (!success) {
+    *os << "Failed to write to " << clear_refs_file_name << ": " << strerror(errno);
+  }
+  clear_refs_file->Close();
+  return success;
+}
+
+// Samples the boot image pages dirtied by a process num_samples times, each over interval_ms,
+// and writes the classes on dirty pages in the format of the dex2oat --dirty-image-objects option
+// to dirty_image_objects_filename, or to os if it is empty.
+static int TrackDirtyImages(Runtime* runtime,
+                            std::ostream* os,
+                            pid_t pid,
+                            size_t num_samples,
+                            size_t interval_ms,
+                            const std::string& dirty_image_objects_filename) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::vector<std::unique_ptr<SoftDirtyTracker>> trackers;
+  for (gc::space::ImageSpace* image_space : runtime->GetHeap()->GetBootImageSpaces()) {
+    trackers.emplace_back(new SoftDirtyTracker(os,
+                                               image_space->GetImageHeader(),
+                                               image_space->GetImageLocation(),
+                                               pid));
+    if (!trackers.back()->Init()) {
+      return EXIT_FAILURE;
+    }
+  }
+  CHECK(!trackers.empty());
+  {
+    // Do not hold the mutator lock while sleeping.
+    ScopedThreadSuspension sts(soa.Self(), kNative);
+    for (size_t i = 0; i != num_samples; ++i) {
+      if (!ClearSoftDirtyBits(pid, os)) {
+        return EXIT_FAILURE;
+      }
+      usleep(interval_ms * 1000);
+      for (const std::unique_ptr<SoftDirtyTracker>& tracker : trackers) {
+        if (!tracker->Sample()) {
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+  std::map<std::string, size_t> dirty_classes;
+  for (const std::unique_ptr<SoftDirtyTracker>& tracker : trackers) {
+    tracker->Dump(&dirty_classes);
+  }
+
+  // Most often dirtied first.
+  std::vector<std::pair<size_t, std::string>> sorted_classes;
+  for (const auto& entry : dirty_classes) {
+    sorted_classes.emplace_back(entry.second, entry.first);
+  }
+  std::sort(sorted_classes.rbegin(), sorted_classes.rend());
+  std::ofstream dirty_image_objects_file;
+  if (!dirty_image_objects_filename.empty()) {
+    dirty_image_objects_file.open(dirty_image_objects_filename);
+    if (!dirty_image_objects_file.good()) {
+      *os << "Failed to open " << dirty_image_objects_filename << " for writing";
+      return EXIT_FAILURE;
+    }
+  } else {
+    *os << "Dirty image objects:\n";
+  }
+  std::ostream& out = dirty_image_objects_filename.empty() ? *os : dirty_image_objects_file;
+  out << "# Classes on pages dirtied in " << num_samples << " samples of " << interval_ms
+      << "ms, most often dirtied first.\n";
+  for (const auto& entry : sorted_classes) {
+    out << entry.second << "\n";
+  }
+  out << std::flush;
+  return out.good() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 struct ImgDiagArgs : public CmdlineArgs {
  protected:
   using Base = CmdlineArgs;
@@ -1690,6 +1943,29 @@ struct ImgDiagArgs : public CmdlineArgs {
       }
     } else if (option == "--dump-dirty-objects") {
       dump_dirty_objects_ = true;
+    } else if (option.starts_with("--track-dirty-pid=")) {
+      const char* track_dirty_pid = option.substr(strlen("--track-dirty-pid=")).data();
+
+      if (!ParseInt(track_dirty_pid, &track_dirty_pid_)) {
+        *error_msg = "Track dirty pid out of range";
+        return kParseError;
+      }
+    } else if (option.starts_with("--track-dirty-samples=")) {
+      const char* samples = option.substr(strlen("--track-dirty-samples=")).data();
+
+      if (!ParseUint(samples, &track_dirty_samples_) || track_dirty_samples_ == 0u) {
+        *error_msg = "Invalid number of track dirty samples";
+        return kParseError;
+      }
+    } else if (option.starts_with("--track-dirty-interval-ms=")) {
+      const char* interval_ms = option.substr(strlen("--track-dirty-interval-ms=")).data();
+
+      if (!ParseUint(interval_ms, &track_dirty_interval_ms_)) {
+        *error_msg = "Invalid track dirty interval";
+        return kParseError;
+      }
+    } else if (option.starts_with("--dirty-image-objects-output=")) {
+      dirty_image_objects_output_ = option.substr(strlen("--dirty-image-objects-output=")).data();
     } else {
       return kParseUnknownArgument;
     }
@@ -1706,7 +1982,8 @@ struct ImgDiagArgs : public CmdlineArgs {
 
     // Perform our own checks.
 
-    if (kill(image_diff_pid_,
+    const pid_t pid = (track_dirty_pid_ >= 0) ? track_dirty_pid_ : image_diff_pid_;
+    if (kill(pid,
              /*sig*/0) != 0) {  // No signal is sent, perform error-checking only.
       // Check if the pid exists before proceeding.
       if (errno == ESRCH) {
@@ -1743,6 +2020,14 @@ struct ImgDiagArgs : public CmdlineArgs {
         "against.\n"
         "      Example: --zygote-diff-pid=$(pid zygote)\n"
         "  --dump-dirty-objects: additionally output dirty objects of interest.\n"
+        "  --track-dirty-pid=<pid>: instead of diffing, sample the boot image pages dirtied by a\n"
+        "      process with the soft-dirty bits of its page map, and output the classes on dirty\n"
+        "      pages in the format of the dex2oat --dirty-image-objects option.\n"
+        "      Example: --track-dirty-pid=$(pid system_server)\n"
+        "  --track-dirty-samples=<n>: the number of samples to take. Defaults to 10.\n"
+        "  --track-dirty-interval-ms=<ms>: the duration of each sample. Defaults to 1000.\n"
+        "  --dirty-image-objects-output=<file-path>: write the dirty classes to a file rather\n"
+        "      than to the output.\n"
         "\n";
 
     return usage;
@@ -1752,12 +2037,24 @@ struct ImgDiagArgs : public CmdlineArgs {
   pid_t image_diff_pid_ = -1;
   pid_t zygote_diff_pid_ = -1;
   bool dump_dirty_objects_ = false;
+  pid_t track_dirty_pid_ = -1;
+  unsigned int track_dirty_samples_ = 10u;
+  unsigned int track_dirty_interval_ms_ = 1000u;
+  std::string dirty_image_objects_output_;
 };
 
 struct ImgDiagMain : public CmdlineMain<ImgDiagArgs> {
   virtual bool ExecuteWithRuntime(Runtime* runtime) {
     CHECK(args_ != nullptr);
 
+    if (args_->track_dirty_pid_ >= 0) {
+      return TrackDirtyImages(runtime,
+                              args_->os_,
+                              args_->track_dirty_pid_,
+                              args_->track_dirty_samples_,
+                              args_->track_dirty_interval_ms_,
+                              args_->dirty_image_objects_output_) == EXIT_SUCCESS;
+    }
     return DumpImage(runtime,
                      args_->os_,
                      args_->image_diff_pid_,
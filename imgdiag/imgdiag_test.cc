@@ -155,4 +155,17 @@ TEST_F(ImgDiagTest, ImageDiffBadPid) {
   UNUSED(error_msg);
 }
 
+TEST_F(ImgDiagTest, TrackDirtyBadPid) {
+  // Invoke 'img_diag' to track the dirty pages of a non-existing process. This should fail.
+  std::string error_msg;
+  std::vector<std::string> exec_argv = {
+      GetImgDiagFilePath(),
+      android::base::StringPrintf("--track-dirty-pid=%d", kImgDiagGuaranteedBadPid),
+      "--track-dirty-samples=1",
+      "--track-dirty-interval-ms=0",
+      "--boot-image=" + GetCoreArtLocation()
+  };
+  ASSERT_FALSE(::art::Exec(exec_argv, &error_msg)) << "Incorrectly executed";
+}
+
 }  // namespace art
@@ -54,6 +54,7 @@
 #include "subtype_check.h"
 #include "index_bss_mapping.h"
 #include "interpreter/unstarted_runtime.h"
+#include "jit/profile_compilation_info.h"
 #include "linker/buffered_output_stream.h"
 #include "linker/elf_builder.h"
 #include "linker/file_output_stream.h"
@@ -204,7 +205,8 @@ class OatSymbolizer FINAL {
     debug::WriteDebugInfo(builder_.get(),
                           ArrayRef<const debug::MethodDebugInfo>(method_debug_infos_),
                           dwarf::DW_DEBUG_FRAME_FORMAT,
-                          true /* write_oat_patches */);
+                          true /* write_oat_patches */,
+                          /* thread_pool */ nullptr);
 
     builder_->End();
 
@@ -340,9 +342,11 @@ class OatDumperOptions {
                    bool list_classes,
                    bool list_methods,
                    bool dump_header_only,
+                   bool stats_only,
                    const char* export_dex_location,
                    const char* app_image,
                    const char* app_oat,
+                   const char* profile_file,
                    uint32_t addr2instr)
     : dump_vmap_(dump_vmap),
       dump_code_info_stack_maps_(dump_code_info_stack_maps),
@@ -353,9 +357,11 @@ class OatDumperOptions {
       list_classes_(list_classes),
       list_methods_(list_methods),
       dump_header_only_(dump_header_only),
+      stats_only_(stats_only),
       export_dex_location_(export_dex_location),
       app_image_(app_image),
       app_oat_(app_oat),
+      profile_file_(profile_file),
       addr2instr_(addr2instr),
       class_loader_(nullptr) {}
 
@@ -368,9 +374,11 @@ class OatDumperOptions {
   const bool list_classes_;
   const bool list_methods_;
   const bool dump_header_only_;
+  const bool stats_only_;
   const char* const export_dex_location_;
   const char* const app_image_;
   const char* const app_oat_;
+  const char* const profile_file_;
   uint32_t addr2instr_;
   Handle<mirror::ClassLoader>* class_loader_;
 };
@@ -556,7 +564,11 @@ class OatDumper {
     cumulative.Dump(os);
     os << "\n";
 
-    if (!options_.dump_header_only_) {
+    if (options_.stats_only_) {
+      if (!DumpMethodSizes(os)) {
+        success = false;
+      }
+    } else if (!options_.dump_header_only_) {
       VariableIndentationOutputStream vios(&os);
       VdexFile::Header vdex_header = oat_file_.GetVdexFile()->GetHeader();
       if (vdex_header.IsValid()) {
@@ -753,6 +765,12 @@ class OatDumper {
       kByteKindInlineInfoLast = kByteKindInlineInfoIsLast,
     };
     int64_t bits[kByteKindCount] = {};
+    // Number of entries of the deduplicated CodeInfo tables, and of their uses by stack maps.
+    int64_t num_stack_maps = 0;
+    int64_t num_register_masks = 0;
+    int64_t num_stack_masks = 0;
+    int64_t num_inline_infos = 0;
+    int64_t num_inline_info_uses = 0;
     // Since code has deduplication, seen tracks already seen pointers to avoid double counting
     // deduplicated code and tables.
     std::unordered_set<const void*> seen;
@@ -835,7 +853,7 @@ class OatDumper {
                "inline info");
           Dump(os,
                "InlineInfoDexPc               ",
-               bits[kByteKindStackMapDexPc],
+               bits[kByteKindInlineInfoDexPc],
                inline_info_bits,
                "inline info");
           Dump(os,
@@ -854,6 +872,13 @@ class OatDumper {
                inline_info_bits,
                "inline info");
         }
+        os.Stream() << "CodeInfo entries shared by stack maps\n";
+        {
+          ScopedIndentation indent1(&os);
+          DumpSharing(os, "RegisterMasks", num_register_masks, num_stack_maps);
+          DumpSharing(os, "StackMasks   ", num_stack_masks, num_stack_maps);
+          DumpSharing(os, "InlineInfos  ", num_inline_infos, num_inline_info_uses);
+        }
       }
       os.Stream() << "\n" << std::flush;
     }
@@ -871,6 +896,19 @@ class OatDumper {
                                   percent,
                                   sum_of);
     }
+
+    void DumpSharing(VariableIndentationOutputStream& os,
+                     const char* name,
+                     int64_t num_entries,
+                     int64_t num_uses) {
+      const double ratio =
+          (num_entries != 0) ? static_cast<double>(num_uses) / static_cast<double>(num_entries) : 0;
+      os.Stream() << StringPrintf("%s = %8" PRId64 " for %8" PRId64 " uses (%.2f uses each)\n",
+                                  name,
+                                  num_entries,
+                                  num_uses,
+                                  ratio);
+    }
   };
 
  private:
@@ -1113,6 +1151,118 @@ class OatDumper {
     return success;
   }
 
+  struct MethodSizes {
+    size_t methods = 0u;
+    size_t code_bytes = 0u;
+    size_t stack_map_bytes = 0u;
+    size_t code_info_bytes = 0u;
+
+    void Add(const MethodSizes& other) {
+      methods += other.methods;
+      code_bytes += other.code_bytes;
+      stack_map_bytes += other.stack_map_bytes;
+      code_info_bytes += other.code_info_bytes;
+    }
+
+    void Dump(std::ostream& os, const std::string& name) const {
+      os << StringPrintf("%8zu methods %10zu code bytes %10zu stack map bytes %10zu code info bytes"
+                         "  %s\n",
+                         methods,
+                         code_bytes,
+                         stack_map_bytes,
+                         code_info_bytes,
+                         name.c_str());
+    }
+  };
+
+  // Dumps the sizes of the compiled code and of the code info of each method, then for each
+  // package, without disassembling or decoding the stack maps. Code and code info shared by
+  // several methods are only counted once in the totals.
+  bool DumpMethodSizes(std::ostream& os) {
+    bool success = true;
+    std::map<std::string, MethodSizes> package_sizes;
+    std::unordered_set<const void*> seen_code;
+    std::unordered_set<const void*> seen_code_info;
+    os << "METHOD SIZES:\n";
+    for (const OatFile::OatDexFile* oat_dex_file : oat_dex_files_) {
+      std::string error_msg;
+      const DexFile* const dex_file = OpenDexFile(oat_dex_file, &error_msg);
+      if (dex_file == nullptr) {
+        os << "NOT FOUND: " << error_msg << "\n";
+        success = false;
+        continue;
+      }
+      for (size_t class_def_index = 0;
+           class_def_index < dex_file->NumClassDefs();
+           class_def_index++) {
+        const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_index);
+        const uint8_t* class_data = dex_file->GetClassData(class_def);
+        if (class_data == nullptr) {
+          continue;
+        }
+        std::string class_name = DescriptorToDot(dex_file->GetClassDescriptor(class_def));
+        // TODO: Support regex
+        if (class_name.find(options_.class_filter_) == std::string::npos) {
+          continue;
+        }
+        size_t package_end = class_name.rfind('.');
+        std::string package =
+            (package_end == std::string::npos) ? "<default>" : class_name.substr(0, package_end);
+        MethodSizes& package_size = package_sizes[package];
+        const OatFile::OatClass oat_class = oat_dex_file->GetOatClass(class_def_index);
+        ClassDataItemIterator it(*dex_file, class_data);
+        it.SkipAllFields();
+        for (uint32_t class_method_index = 0; it.HasNextMethod(); ++class_method_index, it.Next()) {
+          const uint32_t dex_method_idx = it.GetMemberIndex();
+          std::string method_name = dex_file->GetMethodName(dex_file->GetMethodId(dex_method_idx));
+          if (method_name.find(options_.method_filter_) == std::string::npos) {
+            continue;
+          }
+          const OatFile::OatMethod oat_method = oat_class.GetOatMethod(class_method_index);
+          const void* code = oat_method.GetQuickCode();
+          if (code == nullptr) {
+            continue;
+          }
+          MethodSizes method_size;
+          method_size.methods = 1u;
+          method_size.code_bytes = oat_method.GetQuickCodeSize();
+          CodeItemDataAccessor code_item_accessor(dex_file, it.GetMethodCodeItem());
+          if (IsMethodGeneratedByOptimizingCompiler(oat_method, code_item_accessor)) {
+            // The optimizing compiler outputs its CodeInfo data in the vmap table.
+            CodeInfo code_info(oat_method.GetVmapTable());
+            CodeInfoEncoding encoding = code_info.ExtractEncoding();
+            method_size.stack_map_bytes =
+                RoundUp(code_info.GetStackMapsSizeInBits(encoding), kBitsPerByte) / kBitsPerByte;
+            method_size.code_info_bytes = encoding.HeaderSize() + encoding.NonHeaderSize();
+          }
+          method_size.Dump(os, dex_file->PrettyMethod(dex_method_idx, true));
+          // Deduplicated code and code info count for the first method using them.
+          if (!seen_code.insert(code).second) {
+            method_size.code_bytes = 0u;
+          }
+          if (method_size.code_info_bytes != 0u &&
+              !seen_code_info.insert(oat_method.GetVmapTable()).second) {
+            method_size.stack_map_bytes = 0u;
+            method_size.code_info_bytes = 0u;
+          }
+          package_size.Add(method_size);
+        }
+      }
+    }
+    os << "\nPACKAGE SIZES:\n";
+    MethodSizes total;
+    for (const auto& entry : package_sizes) {
+      if (entry.second.methods != 0u) {
+        entry.second.Dump(os, entry.first);
+        total.Add(entry.second);
+      }
+    }
+    os << "\nTOTAL:\n";
+    total.Dump(os, oat_file_.GetLocation());
+    os << std::flush;
+    return success;
+  }
+
   // Backwards compatible Dex file export. If dex_file is nullptr (valid Vdex file not present) the
   // Dex resource is extracted from the oat_dex_file and its checksum is repaired since it's not
   // unquickened. Otherwise the dex_file has been fully unquickened and is expected to verify the
@@ -1854,6 +2004,19 @@ class OatDumper {
                     num_inline_infos);
             stats_.AddBits(Stats::kByteKindInlineInfoIsLast, num_inline_infos);
           }
+
+          // Sharing of the deduplicated tables.
+          stats_.num_stack_maps += num_stack_maps;
+          stats_.num_register_masks += encoding.register_mask.num_entries;
+          stats_.num_stack_masks += encoding.stack_mask.num_entries;
+          stats_.num_inline_infos += num_inline_infos;
+          for (size_t i = 0; i < num_stack_maps; ++i) {
+            StackMap stack_map = helper.GetCodeInfo().GetStackMapAt(i, encoding);
+            if (stack_map.HasInlineInfo(stack_map_encoding)) {
+              InlineInfo inline_info = helper.GetCodeInfo().GetInlineInfoOf(stack_map, encoding);
+              stats_.num_inline_info_uses += inline_info.GetDepth(encoding.inline_info.encoding);
+            }
+          }
         }
       }
       const uint8_t* quick_native_pc = reinterpret_cast<const uint8_t*>(quick_code);
@@ -2057,6 +2220,14 @@ class ImageDumper {
 
     stats_.oat_file_bytes = oat_file->Size();
 
+    if (oat_dumper_options_->profile_file_ != nullptr) {
+      profile_.reset(new ProfileCompilationInfo());
+      if (!profile_->Load(oat_dumper_options_->profile_file_, /*clear_if_invalid*/ false)) {
+        os << "FAILED TO LOAD PROFILE: " << oat_dumper_options_->profile_file_ << "\n\n";
+        profile_.reset();
+      }
+    }
+
     oat_dumper_.reset(new OatDumper(*oat_file, *oat_dumper_options_));
 
     for (const OatFile::OatDexFile* oat_dex_file : oat_file->GetOatDexFiles()) {
@@ -2181,6 +2352,23 @@ class ImageDumper {
     stats_.class_table_bytes += class_table_section.Size();
     stats_.Dump(os, indent_os);
     os << "\n";
+    if (profile_ != nullptr) {
+      // The pages of the image which the classes and methods used during startup touch.
+      size_t image_pages = RoundUp(image_header_.GetImageSize(), kPageSize) / kPageSize;
+      os << StringPrintf("startup_classes = %zd, startup_methods = %zd\n"
+                         "startup_object_pages = %zd\n"
+                         "startup_art_field_pages = %zd\n"
+                         "startup_art_method_pages = %zd\n"
+                         "startup_pages = %zd (%2.0f%% of %zd image pages)\n\n",
+                         stats_.startup_classes,
+                         stats_.startup_methods,
+                         stats_.startup_object_pages.size(),
+                         stats_.startup_art_field_pages.size(),
+                         stats_.startup_art_method_pages.size(),
+                         stats_.startup_pages.size(),
+                         static_cast<double>(stats_.startup_pages.size()) * 100 / image_pages,
+                         image_pages);
+    }
 
     os << std::flush;
 
@@ -2193,6 +2381,7 @@ class ImageDumper {
     explicit DumpArtMethodVisitor(ImageDumper* image_dumper) : image_dumper_(image_dumper) {}
 
     virtual void Visit(ArtMethod* method) OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_) {
+      image_dumper_->RecordStartupMethod(method);
       std::ostream& indent_os = image_dumper_->vios_.Stream();
       indent_os << method << " " << " ArtMethod: " << ArtMethod::PrettyMethod(method) << "\n";
       image_dumper_->DumpMethod(method, indent_os);
@@ -2291,6 +2480,53 @@ class ImageDumper {
     return image_space_.Contains(object);
   }
 
+  // Adds the pages of the image which [begin, begin + size) spans to `pages`.
+  void AddPages(const void* begin, size_t size, std::set<size_t>* pages) {
+    size_t offset = reinterpret_cast<const uint8_t*>(begin) - image_space_.Begin();
+    for (size_t page = offset / kPageSize, end = (offset + size - 1u) / kPageSize;
+         page <= end;
+         ++page) {
+      pages->insert(page);
+      stats_.startup_pages.insert(page);
+    }
+  }
+
+  // Records the pages of a class used during startup, with the pages of its fields.
+  void RecordStartupClass(mirror::Class* klass, size_t object_bytes)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (profile_ == nullptr || klass->IsArrayClass() || klass->IsPrimitive() ||
+        klass->IsProxyClass() || !profile_->ContainsClass(klass->GetDexFile(),
+                                                          klass->GetDexTypeIndex())) {
+      return;
+    }
+    ++stats_.startup_classes;
+    AddPages(klass, object_bytes, &stats_.startup_object_pages);
+    LengthPrefixedArray<ArtField>* fields_arrays[] = {
+        klass->GetSFieldsPtr(), klass->GetIFieldsPtr(),
+    };
+    for (LengthPrefixedArray<ArtField>* fields : fields_arrays) {
+      if (fields != nullptr && fields->size() != 0u) {
+        size_t fields_bytes = LengthPrefixedArray<ArtField>::ComputeSize(fields->size());
+        AddPages(fields, fields_bytes, &stats_.startup_art_field_pages);
+      }
+    }
+  }
+
+  // Records the pages of a method used during startup.
+  void RecordStartupMethod(ArtMethod* method) REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (profile_ == nullptr || method->IsRuntimeMethod() || method->IsProxyMethod()) {
+      return;
+    }
+    MethodReference method_ref(method->GetDexFile(), method->GetDexMethodIndex());
+    if (!profile_->GetMethodHotness(method_ref).IsStartup()) {
+      return;
+    }
+    ++stats_.startup_methods;
+    AddPages(method,
+             ArtMethod::Size(image_header_.GetPointerSize()),
+             &stats_.startup_art_method_pages);
+  }
+
   const void* GetQuickOatCodeBegin(ArtMethod* m) REQUIRES_SHARED(Locks::mutator_lock_) {
     const void* quick_code = m->GetEntryPointFromQuickCompiledCodePtrSize(
         image_header_.GetPointerSize());
@@ -2340,6 +2576,7 @@ class ImageDumper {
                          obj->AsArray()->GetLength());
     } else if (obj->IsClass()) {
       mirror::Class* klass = obj->AsClass();
+      RecordStartupClass(klass, object_bytes);
       os << StringPrintf("%p: java.lang.Class \"%s\" (", obj,
                          mirror::Class::PrettyDescriptor(klass).c_str())
          << klass->GetStatus() << ")\n";
@@ -2617,6 +2854,15 @@ class ImageDumper {
 
     size_t dex_instruction_bytes;
 
+    // The classes and methods used during startup according to the profile, if any, and the
+    // pages of the image they touch.
+    size_t startup_classes;
+    size_t startup_methods;
+    std::set<size_t> startup_object_pages;
+    std::set<size_t> startup_art_field_pages;
+    std::set<size_t> startup_art_method_pages;
+    std::set<size_t> startup_pages;
+
     std::vector<ArtMethod*> method_outlier;
     std::vector<size_t> method_outlier_size;
     std::vector<double> method_outlier_expansion;
@@ -2641,7 +2887,9 @@ class ImageDumper {
           large_initializer_code_bytes(0),
           large_method_code_bytes(0),
           vmap_table_bytes(0),
-          dex_instruction_bytes(0) {}
+          dex_instruction_bytes(0),
+          startup_classes(0),
+          startup_methods(0) {}
 
     struct SizeAndCount {
       SizeAndCount(size_t bytes_in, size_t count_in) : bytes(bytes_in), count(count_in) {}
@@ -2892,6 +3140,7 @@ class ImageDumper {
   std::unique_ptr<OatDumper> oat_dumper_;
   OatDumperOptions* oat_dumper_options_;
   std::set<mirror::Object*> dex_caches_;
+  std::unique_ptr<ProfileCompilationInfo> profile_;
 
   DISALLOW_COPY_AND_ASSIGN(ImageDumper);
 };
@@ -3557,6 +3806,8 @@ struct OatdumpArgs : public CmdlineArgs {
       disassemble_code_ = false;
     } else if (option =="--header-only") {
       dump_header_only_ = true;
+    } else if (option == "--stats-only") {
+      stats_only_ = true;
     } else if (option.starts_with("--symbolize=")) {
       oat_filename_ = option.substr(strlen("--symbolize=")).data();
       symbolize_ = true;
@@ -3581,6 +3832,8 @@ struct OatdumpArgs : public CmdlineArgs {
       app_image_ = option.substr(strlen("--app-image=")).data();
     } else if (option.starts_with("--app-oat=")) {
       app_oat_ = option.substr(strlen("--app-oat=")).data();
+    } else if (option.starts_with("--profile-file=")) {
+      profile_file_ = option.substr(strlen("--profile-file=")).data();
     } else if (option.starts_with("--dump-imt=")) {
       imt_dump_ = option.substr(strlen("--dump-imt=")).data();
     } else if (option == "--dump-imt-stats") {
@@ -3637,6 +3890,10 @@ struct OatdumpArgs : public CmdlineArgs {
         "\n"
         "  --app-oat=<file.odex>: specifies an input app oat.\n"
         "      Example: --app-oat=app.odex\n"
+        "\n"
+        "  --profile-file=<file.prof>: reports the image pages which the startup classes and\n"
+        "      methods of the profile touch in the stats of an image.\n"
+        "      Example: --profile-file=primary.prof\n"
         "\n";
 
     usage += Base::GetUsage();
@@ -3654,6 +3911,10 @@ struct OatdumpArgs : public CmdlineArgs {
         "  --header-only may be used to print only the oat header.\n"
         "      Example: --header-only\n"
         "\n"
+        "  --stats-only may be used to print, after the oat header, the code and code info\n"
+        "      sizes of each method and package without disassembling (can be used with filters).\n"
+        "      Example: --stats-only\n"
+        "\n"
         "  --list-classes may be used to list target file classes (can be used with filters).\n"
         "      Example: --list-classes\n"
         "      Example: --list-classes --class-filter=com.example.foo\n"
@@ -3711,11 +3972,13 @@ struct OatdumpArgs : public CmdlineArgs {
   bool list_classes_ = false;
   bool list_methods_ = false;
   bool dump_header_only_ = false;
+  bool stats_only_ = false;
   bool imt_stat_dump_ = false;
   uint32_t addr2instr_ = 0;
   const char* export_dex_location_ = nullptr;
   const char* app_image_ = nullptr;
   const char* app_oat_ = nullptr;
+  const char* profile_file_ = nullptr;
 };
 
 struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
@@ -3735,9 +3998,11 @@ struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
         args_->list_classes_,
         args_->list_methods_,
         args_->dump_header_only_,
+        args_->stats_only_,
         args_->export_dex_location_,
         args_->app_image_,
         args_->app_oat_,
+        args_->profile_file_,
         args_->addr2instr_));
 
     return (args_->boot_image_location_ != nullptr ||
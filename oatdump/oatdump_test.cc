@@ -61,6 +61,16 @@ TEST_F(OatDumpTest, TestListMethodsStatic) {
   ASSERT_TRUE(Exec(kStatic, kModeArt, {"--list-methods"}, kListOnly, &error_msg)) << error_msg;
 }
 
+TEST_F(OatDumpTest, TestStatsOnly) {
+  std::string error_msg;
+  ASSERT_TRUE(Exec(kDynamic, kModeOat, {"--stats-only"}, kListOnly, &error_msg)) << error_msg;
+}
+TEST_F(OatDumpTest, TestStatsOnlyStatic) {
+  TEST_DISABLED_FOR_NON_STATIC_HOST_BUILDS();
+  std::string error_msg;
+  ASSERT_TRUE(Exec(kStatic, kModeOat, {"--stats-only"}, kListOnly, &error_msg)) << error_msg;
+}
+
 TEST_F(OatDumpTest, TestSymbolize) {
   std::string error_msg;
   ASSERT_TRUE(Exec(kDynamic, kModeSymbolize, {}, kListOnly, &error_msg)) << error_msg;
@@ -1497,6 +1497,7 @@ extern const jvmtiInterface_1 gJvmtiInterface;
 
 ArtJvmTiEnv::ArtJvmTiEnv(art::JavaVMExt* runtime, EventHandler* event_handler)
     : art_vm(runtime),
+      event_handler(event_handler),
       local_data(nullptr),
       capabilities(),
       event_info_mutex_("jvmtiEnv_EventInfoMutex") {
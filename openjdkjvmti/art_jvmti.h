@@ -65,6 +65,7 @@ class ObjectTagTable;
 // A structure that is a jvmtiEnv with additional information for the runtime.
 struct ArtJvmTiEnv : public jvmtiEnv {
   art::JavaVMExt* art_vm;
+  EventHandler* event_handler;
   void* local_data;
   jvmtiCapabilities capabilities;
 
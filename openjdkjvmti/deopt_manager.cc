@@ -30,14 +30,21 @@
  */
 
 #include <functional>
+#include <string.h>
+#include <unordered_set>
 
 #include "deopt_manager.h"
 
+#include "art_field-inl.h"
 #include "art_jvmti.h"
 #include "art_method-inl.h"
 #include "base/enums.h"
 #include "base/mutex-inl.h"
+#include "class_linker.h"
+#include "code_item_accessors-inl.h"
+#include "dex_file-inl.h"
 #include "dex_file_annotations.h"
+#include "dex_instruction-inl.h"
 #include "events-inl.h"
 #include "jni_internal.h"
 #include "mirror/class-inl.h"
@@ -64,9 +71,75 @@ bool JvmtiMethodInspectionCallback::IsMethodBeingInspected(
 }
 
 bool JvmtiMethodInspectionCallback::IsMethodSafeToJit(art::ArtMethod* method) {
-  return !manager_->MethodHasBreakpoints(method);
+  // Breakpoints are recorded on the canonical method, which covers the copies of default methods.
+  return !manager_->MethodHasBreakpoints(method->GetCanonicalMethod()) &&
+      !manager_->MethodAccessesWatchedFields(method);
 }
 
+// Finds the methods which may access a field. Field references are compared by name and type
+// rather than resolved, so that the references which are not resolved yet match too.
+class FieldAccessMatcher {
+ public:
+  explicit FieldAccessMatcher(art::ArtField* field) REQUIRES_SHARED(art::Locks::mutator_lock_)
+      : name_(field->GetName()),
+        type_(field->GetTypeDescriptor()),
+        is_static_(field->IsStatic()),
+        offset_(field->GetOffset().Uint32Value()) {}
+
+  bool MethodAccessesField(art::ArtMethod* method) REQUIRES_SHARED(art::Locks::mutator_lock_) {
+    if (!method->IsInvokable() || method->IsNative() || method->IsProxyMethod()) {
+      return false;
+    }
+    const std::unordered_set<uint32_t>& field_indices = GetFieldIndices(method->GetDexFile());
+    for (const art::DexInstructionPcPair& inst : method->DexInstructions()) {
+      art::Instruction::Code opcode = inst->Opcode();
+      switch (art::Instruction::IndexTypeOf(opcode)) {
+        case art::Instruction::kIndexFieldRef: {
+          bool is_static = art::Instruction::FormatOf(opcode) == art::Instruction::k21c;
+          uint32_t field_index = is_static ? inst->VRegB_21c() : inst->VRegC_22c();
+          if (is_static == is_static_ && field_indices.count(field_index) != 0u) {
+            return true;
+          }
+          break;
+        }
+        case art::Instruction::kIndexFieldOffset:
+          // Quickened instance field accesses only keep the field offset.
+          if (!is_static_ && inst->VRegC_22c() == offset_) {
+            return true;
+          }
+          break;
+        default:
+          break;
+      }
+    }
+    return false;
+  }
+
+ private:
+  const std::unordered_set<uint32_t>& GetFieldIndices(const art::DexFile* dex_file) {
+    auto it = field_indices_.find(dex_file);
+    if (it == field_indices_.end()) {
+      std::unordered_set<uint32_t> field_indices;
+      for (uint32_t i = 0; i != dex_file->NumFieldIds(); ++i) {
+        const art::DexFile::FieldId& field_id = dex_file->GetFieldId(i);
+        if (strcmp(dex_file->GetFieldName(field_id), name_) == 0 &&
+            strcmp(dex_file->GetFieldTypeDescriptor(field_id), type_) == 0) {
+          field_indices.insert(i);
+        }
+      }
+      it = field_indices_.emplace(dex_file, std::move(field_indices)).first;
+    }
+    return it->second;
+  }
+
+  const char* const name_;
+  const char* const type_;
+  const bool is_static_;
+  const uint32_t offset_;
+  // The indices of the matching field references of each dex file.
+  std::unordered_map<const art::DexFile*, std::unordered_set<uint32_t>> field_indices_;
+};
+
 DeoptManager::DeoptManager()
   : deoptimization_status_lock_("JVMTI_DeoptimizationStatusLock"),
     deoptimization_condition_("JVMTI_DeoptimizationCondition", deoptimization_status_lock_),
@@ -104,6 +177,174 @@ bool DeoptManager::MethodHasBreakpointsLocked(art::ArtMethod* method) {
   return elem != breakpoint_status_.end() && elem->second != 0;
 }
 
+bool DeoptManager::MethodHasFieldWatchesLocked(art::ArtMethod* method) {
+  auto elem = field_watch_status_.find(method);
+  return elem != field_watch_status_.end() && elem->second != 0;
+}
+
+bool DeoptManager::MethodAccessesWatchedFields(art::ArtMethod* method) {
+  std::vector<art::ArtField*> fields;
+  {
+    art::MutexLock lk(art::Thread::Current(), deoptimization_status_lock_);
+    if (field_watches_.empty()) {
+      return false;
+    }
+    for (const auto& entry : field_watches_) {
+      fields.push_back(entry.first);
+    }
+  }
+  for (art::ArtField* field : fields) {
+    if (FieldAccessMatcher(field).MethodAccessesField(method)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<art::ArtMethod*> DeoptManager::FindDefaultMethodCopies(art::ArtMethod* method) {
+  class FindCopiesClassVisitor : public art::ClassVisitor {
+   public:
+    explicit FindCopiesClassVisitor(art::ArtMethod* method) : method_(method) {}
+
+    bool operator()(art::ObjPtr<art::mirror::Class> klass)
+        OVERRIDE REQUIRES_SHARED(art::Locks::mutator_lock_) {
+      if (!klass->IsLoaded() || klass->IsInterface() || klass->IsProxyClass()) {
+        return true;
+      }
+      for (art::ArtMethod& m : klass->GetCopiedMethods(art::kRuntimePointerSize)) {
+        if (m.IsInvokable() && m.GetCanonicalMethod() == method_) {
+          copies_.push_back(&m);
+        }
+      }
+      return true;
+    }
+
+    art::ArtMethod* method_;
+    std::vector<art::ArtMethod*> copies_;
+  };
+  FindCopiesClassVisitor visitor(method);
+  art::Runtime::Current()->GetClassLinker()->VisitClasses(&visitor);
+  return std::move(visitor.copies_);
+}
+
+void DeoptManager::AddFieldWatch(art::ArtField* field) {
+  if (!art::Runtime::Current()->IsJavaDebuggable()) {
+    // The field events deoptimize everything.
+    return;
+  }
+  AddDeoptimizationRequester();
+
+  // Find the methods which may access the field. The methods of classes loaded later will not be
+  // compiled, see IsMethodSafeToJit.
+  class FindAccessorsClassVisitor : public art::ClassVisitor {
+   public:
+    explicit FindAccessorsClassVisitor(art::ArtField* field) : matcher_(field) {}
+
+    bool operator()(art::ObjPtr<art::mirror::Class> klass)
+        OVERRIDE REQUIRES_SHARED(art::Locks::mutator_lock_) {
+      if (!klass->IsLoaded() || klass->IsProxyClass()) {
+        return true;
+      }
+      for (art::ArtMethod& m : klass->GetMethods(art::kRuntimePointerSize)) {
+        // Copied methods share the code of the method they were copied from.
+        if (!m.IsCopied() && matcher_.MethodAccessesField(&m)) {
+          accessors_.push_back(&m);
+        }
+      }
+      return true;
+    }
+
+    FieldAccessMatcher matcher_;
+    std::vector<art::ArtMethod*> accessors_;
+  };
+  FindAccessorsClassVisitor visitor(field);
+  art::Runtime::Current()->GetClassLinker()->VisitClasses(&visitor);
+
+  art::Thread* self = art::Thread::Current();
+  art::ScopedThreadSuspension sts(self, art::kSuspended);
+  deoptimization_status_lock_.ExclusiveLock(self);
+  FieldWatch& watch = field_watches_[field];
+  if (watch.count++ != 0u) {
+    // The accessors are already deoptimized, or being deoptimized by another thread.
+    WaitForDeoptimizationToFinish(self);
+    return;
+  }
+  watch.deoptimizes_all = false;
+  if (art::Runtime::Current()->GetInstrumentation()->IsForcedInterpretOnly()) {
+    // We are already interpreting everything so no need to do anything.
+    deoptimization_status_lock_.ExclusiveUnlock(self);
+    return;
+  }
+  std::vector<art::ArtMethod*> to_deoptimize;
+  for (art::ArtMethod* method : visitor.accessors_) {
+    if (method->IsDefault()) {
+      // Like breakpoints, deoptimize everything for the copies of the method.
+      watch.deoptimizes_all = true;
+    } else {
+      watch.methods.push_back(method);
+      if (field_watch_status_[method]++ == 0u && !MethodHasBreakpointsLocked(method)) {
+        to_deoptimize.push_back(method);
+      }
+    }
+  }
+  bool deoptimize_all = watch.deoptimizes_all && global_deopt_count_++ == 0u;
+  if (to_deoptimize.empty() && !deoptimize_all) {
+    WaitForDeoptimizationToFinish(self);
+    return;
+  }
+  ScopedDeoptimizationContext sdc(self, this);
+  art::instrumentation::Instrumentation* instrumentation =
+      art::Runtime::Current()->GetInstrumentation();
+  if (deoptimize_all) {
+    instrumentation->DeoptimizeEverything(kDeoptManagerInstrumentationKey);
+  }
+  for (art::ArtMethod* method : to_deoptimize) {
+    instrumentation->Deoptimize(method);
+  }
+}
+
+void DeoptManager::RemoveFieldWatch(art::ArtField* field) {
+  if (!art::Runtime::Current()->IsJavaDebuggable()) {
+    return;
+  }
+  art::Thread* self = art::Thread::Current();
+  {
+    art::ScopedThreadSuspension sts(self, art::kSuspended);
+    deoptimization_status_lock_.ExclusiveLock(self);
+    auto it = field_watches_.find(field);
+    DCHECK(it != field_watches_.end()) << "Watch on a field was removed without watches present!";
+    if (--it->second.count != 0u) {
+      WaitForDeoptimizationToFinish(self);
+    } else {
+      std::vector<art::ArtMethod*> to_undeoptimize;
+      for (art::ArtMethod* method : it->second.methods) {
+        if (--field_watch_status_[method] == 0u) {
+          field_watch_status_.erase(method);
+          if (!MethodHasBreakpointsLocked(method)) {
+            to_undeoptimize.push_back(method);
+          }
+        }
+      }
+      bool undeoptimize_all = it->second.deoptimizes_all && --global_deopt_count_ == 0u;
+      field_watches_.erase(it);
+      if (to_undeoptimize.empty() && !undeoptimize_all) {
+        WaitForDeoptimizationToFinish(self);
+      } else {
+        ScopedDeoptimizationContext sdc(self, this);
+        art::instrumentation::Instrumentation* instrumentation =
+            art::Runtime::Current()->GetInstrumentation();
+        for (art::ArtMethod* method : to_undeoptimize) {
+          instrumentation->Undeoptimize(method);
+        }
+        if (undeoptimize_all) {
+          instrumentation->UndeoptimizeEverything(kDeoptManagerInstrumentationKey);
+        }
+      }
+    }
+  }
+  RemoveDeoptimizationRequester();
+}
+
 void DeoptManager::RemoveDeoptimizeAllMethods() {
   art::Thread* self = art::Thread::Current();
   art::ScopedThreadSuspension sts(self, art::kSuspended);
@@ -126,6 +367,14 @@ void DeoptManager::AddMethodBreakpoint(art::ArtMethod* method) {
   art::Thread* self = art::Thread::Current();
   method = method->GetCanonicalMethod();
   bool is_default = method->IsDefault();
+  // With a debuggable runtime only the existing copies of a default method need to be deoptimized
+  // along with it. New copies are not linked to oat code and IsMethodSafeToJit keeps them from
+  // being compiled. Otherwise we have to deoptimize everything.
+  bool deoptimize_copies = is_default && art::Runtime::Current()->IsJavaDebuggable();
+  std::vector<art::ArtMethod*> copies;
+  if (deoptimize_copies) {
+    copies = FindDefaultMethodCopies(method);
+  }
 
   art::ScopedThreadSuspension sts(self, art::kSuspended);
   deoptimization_status_lock_.ExclusiveLock(self);
@@ -146,9 +395,15 @@ void DeoptManager::AddMethodBreakpoint(art::ArtMethod* method) {
     // We are already interpreting everything so no need to do anything.
     deoptimization_status_lock_.ExclusiveUnlock(self);
     return;
-  } else if (is_default) {
+  } else if (is_default && !deoptimize_copies) {
     AddDeoptimizeAllMethodsLocked(self);
+  } else if (MethodHasFieldWatchesLocked(method)) {
+    // The method is already deoptimized for the watched fields it accesses.
+    WaitForDeoptimizationToFinish(self);
   } else {
+    if (deoptimize_copies) {
+      default_method_copies_[method] = std::move(copies);
+    }
     PerformLimitedDeoptimization(self, method);
   }
 }
@@ -161,6 +416,7 @@ void DeoptManager::RemoveMethodBreakpoint(art::ArtMethod* method) {
   art::Thread* self = art::Thread::Current();
   method = method->GetCanonicalMethod();
   bool is_default = method->IsDefault();
+  bool deoptimized_copies = is_default && art::Runtime::Current()->IsJavaDebuggable();
 
   art::ScopedThreadSuspension sts(self, art::kSuspended);
   // Ideally we should do a ScopedSuspendAll right here to get the full mutator_lock_ that we might
@@ -178,8 +434,11 @@ void DeoptManager::RemoveMethodBreakpoint(art::ArtMethod* method) {
     deoptimization_status_lock_.ExclusiveUnlock(self);
     return;
   } else if (breakpoint_status_[method] == 0) {
-    if (UNLIKELY(is_default)) {
+    if (UNLIKELY(is_default && !deoptimized_copies)) {
       RemoveDeoptimizeAllMethodsLocked(self);
+    } else if (MethodHasFieldWatchesLocked(method)) {
+      // The method stays deoptimized for the watched fields it accesses.
+      WaitForDeoptimizationToFinish(self);
     } else {
       PerformLimitedUndeoptimization(self, method);
     }
@@ -258,13 +517,34 @@ void DeoptManager::RemoveDeoptimizeAllMethodsLocked(art::Thread* self) {
 }
 
 void DeoptManager::PerformLimitedDeoptimization(art::Thread* self, art::ArtMethod* method) {
+  std::vector<art::ArtMethod*> copies;
+  auto it = default_method_copies_.find(method);
+  if (it != default_method_copies_.end()) {
+    copies = it->second;
+  }
   ScopedDeoptimizationContext sdc(self, this);
-  art::Runtime::Current()->GetInstrumentation()->Deoptimize(method);
+  art::instrumentation::Instrumentation* instrumentation =
+      art::Runtime::Current()->GetInstrumentation();
+  instrumentation->Deoptimize(method);
+  for (art::ArtMethod* copy : copies) {
+    instrumentation->Deoptimize(copy);
+  }
 }
 
 void DeoptManager::PerformLimitedUndeoptimization(art::Thread* self, art::ArtMethod* method) {
+  std::vector<art::ArtMethod*> copies;
+  auto it = default_method_copies_.find(method);
+  if (it != default_method_copies_.end()) {
+    copies = std::move(it->second);
+    default_method_copies_.erase(it);
+  }
   ScopedDeoptimizationContext sdc(self, this);
-  art::Runtime::Current()->GetInstrumentation()->Undeoptimize(method);
+  art::instrumentation::Instrumentation* instrumentation =
+      art::Runtime::Current()->GetInstrumentation();
+  for (art::ArtMethod* copy : copies) {
+    instrumentation->Undeoptimize(copy);
+  }
+  instrumentation->Undeoptimize(method);
 }
 
 void DeoptManager::PerformGlobalDeoptimization(art::Thread* self) {
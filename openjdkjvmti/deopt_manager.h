@@ -33,6 +33,7 @@
 #define ART_OPENJDKJVMTI_DEOPT_MANAGER_H_
 
 #include <unordered_map>
+#include <vector>
 
 #include "jni.h"
 #include "jvmti.h"
@@ -42,6 +43,7 @@
 #include "ti_breakpoint.h"
 
 namespace art {
+class ArtField;
 class ArtMethod;
 namespace mirror {
 class Class;
@@ -90,6 +92,21 @@ class DeoptManager {
       REQUIRES(!deoptimization_status_lock_, !art::Roles::uninterruptible_)
       REQUIRES_SHARED(art::Locks::mutator_lock_);
 
+  // Deoptimize the methods which may access the field, so that the interpreter reports the field
+  // events. Only needed with a debuggable runtime, which doesn't link new methods to oat code and
+  // consults IsMethodSafeToJit before compiling them.
+  void AddFieldWatch(art::ArtField* field)
+      REQUIRES(!deoptimization_status_lock_, !art::Roles::uninterruptible_)
+      REQUIRES_SHARED(art::Locks::mutator_lock_);
+
+  void RemoveFieldWatch(art::ArtField* field)
+      REQUIRES(!deoptimization_status_lock_, !art::Roles::uninterruptible_)
+      REQUIRES_SHARED(art::Locks::mutator_lock_);
+
+  bool MethodAccessesWatchedFields(art::ArtMethod* method)
+      REQUIRES(!deoptimization_status_lock_)
+      REQUIRES_SHARED(art::Locks::mutator_lock_);
+
   void AddDeoptimizeAllMethods()
       REQUIRES(!deoptimization_status_lock_, !art::Roles::uninterruptible_)
       REQUIRES_SHARED(art::Locks::mutator_lock_);
@@ -107,6 +124,13 @@ class DeoptManager {
   bool MethodHasBreakpointsLocked(art::ArtMethod* method)
       REQUIRES(deoptimization_status_lock_);
 
+  bool MethodHasFieldWatchesLocked(art::ArtMethod* method)
+      REQUIRES(deoptimization_status_lock_);
+
+  // Finds the copies of the default method in the classes implementing its interface.
+  static std::vector<art::ArtMethod*> FindDefaultMethodCopies(art::ArtMethod* method)
+      REQUIRES_SHARED(art::Locks::mutator_lock_);
+
   // Wait until nothing is currently in the middle of deoptimizing/undeoptimizing something. This is
   // needed to ensure that everything is synchronized since threads need to drop the
   // deoptimization_status_lock_ while deoptimizing methods.
@@ -157,6 +181,27 @@ class DeoptManager {
   std::unordered_map<art::ArtMethod*, uint32_t> breakpoint_status_
       GUARDED_BY(deoptimization_status_lock_);
 
+  // A map from default methods with breakpoints to their copies which were deoptimized with them.
+  std::unordered_map<art::ArtMethod*, std::vector<art::ArtMethod*>> default_method_copies_
+      GUARDED_BY(deoptimization_status_lock_);
+
+  struct FieldWatch {
+    // Number of watches on the field from all envs.
+    uint32_t count;
+    // The methods deoptimized for the field.
+    std::vector<art::ArtMethod*> methods;
+    // Whether a default method accesses the field, which deoptimizes everything.
+    bool deoptimizes_all;
+  };
+
+  // A map from watched fields to their watches.
+  std::unordered_map<art::ArtField*, FieldWatch> field_watches_
+      GUARDED_BY(deoptimization_status_lock_);
+
+  // A map from methods to the number of watched fields they access.
+  std::unordered_map<art::ArtMethod*, uint32_t> field_watch_status_
+      GUARDED_BY(deoptimization_status_lock_);
+
   // The MethodInspectionCallback we use to tell the runtime if we care about particular methods.
   JvmtiMethodInspectionCallback inspection_callback_;
 
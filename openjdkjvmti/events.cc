@@ -39,6 +39,7 @@
 #include "deopt_manager.h"
 #include "dex_file_types.h"
 #include "gc/allocation_listener.h"
+#include "gc/allocation_sampler.h"
 #include "gc/gc_pause_listener.h"
 #include "gc/heap.h"
 #include "gc/scoped_gc_critical_section.h"
@@ -77,6 +78,9 @@ jvmtiError ArtJvmtiEventCallbacks::Set(jint index, jvmtiExtensionEvent cb) {
     case static_cast<jint>(ArtJvmtiEvent::kDdmPublishChunk):
       DdmPublishChunk = reinterpret_cast<ArtJvmtiEventDdmPublishChunk>(cb);
       return OK;
+    case static_cast<jint>(ArtJvmtiEvent::kSampledObjectAlloc):
+      SampledObjectAlloc = reinterpret_cast<ArtJvmtiEventSampledObjectAlloc>(cb);
+      return OK;
     default:
       return ERR(ILLEGAL_ARGUMENT);
   }
@@ -92,6 +96,7 @@ bool IsExtensionEvent(jint e) {
 bool IsExtensionEvent(ArtJvmtiEvent e) {
   switch (e) {
     case ArtJvmtiEvent::kDdmPublishChunk:
+    case ArtJvmtiEvent::kSampledObjectAlloc:
       return true;
     default:
       return false;
@@ -291,7 +296,8 @@ class JvmtiAllocationListener : public art::gc::AllocationListener {
       OVERRIDE REQUIRES_SHARED(art::Locks::mutator_lock_) {
     DCHECK_EQ(self, art::Thread::Current());
 
-    if (handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kVmObjectAlloc)) {
+    if (handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kVmObjectAlloc) &&
+        !handler_->IsVmObjectAllocSampled()) {
       art::StackHandleScope<1> hs(self);
       auto h = hs.NewHandleWrapper(obj);
       // jvmtiEventVMObjectAlloc parameters:
@@ -332,6 +338,67 @@ static void SetupObjectAllocationTracking(art::gc::AllocationListener* listener,
   }
 }
 
+// Reports the allocations picked by the heap's allocation sampler, as SampledObjectAlloc events
+// and as VMObjectAlloc events if those are sampled. Unlike the VMObjectAlloc listener this does
+// not need instrumented allocation entrypoints.
+class JvmtiSampledAllocationListener : public art::gc::AllocationListener {
+ public:
+  explicit JvmtiSampledAllocationListener(EventHandler* handler) : handler_(handler) {}
+
+  void ObjectAllocated(art::Thread* self, art::ObjPtr<art::mirror::Object>* obj, size_t byte_count)
+      OVERRIDE REQUIRES_SHARED(art::Locks::mutator_lock_) {
+    DCHECK_EQ(self, art::Thread::Current());
+
+    bool report_sampled = handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kSampledObjectAlloc);
+    bool report_vm_object_alloc =
+        handler_->IsEventEnabledAnywhere(ArtJvmtiEvent::kVmObjectAlloc) &&
+        handler_->IsVmObjectAllocSampled();
+    if (report_sampled || report_vm_object_alloc) {
+      art::StackHandleScope<1> hs(self);
+      auto h = hs.NewHandleWrapper(obj);
+      art::JNIEnvExt* jni_env = self->GetJniEnv();
+      ScopedLocalRef<jobject> object(
+          jni_env, jni_env->AddLocalReference<jobject>(*obj));
+      ScopedLocalRef<jclass> klass(
+          jni_env, jni_env->AddLocalReference<jclass>(obj->Ptr()->GetClass()));
+
+      if (report_sampled) {
+        RunEventCallback<ArtJvmtiEvent::kSampledObjectAlloc>(handler_,
+                                                             self,
+                                                             jni_env,
+                                                             object.get(),
+                                                             klass.get(),
+                                                             static_cast<jlong>(byte_count));
+      }
+      if (report_vm_object_alloc) {
+        RunEventCallback<ArtJvmtiEvent::kVmObjectAlloc>(handler_,
+                                                        self,
+                                                        jni_env,
+                                                        object.get(),
+                                                        klass.get(),
+                                                        static_cast<jlong>(byte_count));
+      }
+    }
+  }
+
+ private:
+  EventHandler* handler_;
+};
+
+static void SetupSampledAllocationTracking(art::gc::AllocationListener* listener, bool enable) {
+  art::gc::AllocationSampler* sampler = art::Runtime::Current()->GetHeap()->GetAllocationSampler();
+  if (enable) {
+    sampler->SetListener(listener);
+    // Start sampling at the default rate unless a rate was already chosen by the runtime
+    // options or the set_heap_sampling_interval extension.
+    if (!sampler->IsEnabled()) {
+      sampler->SetSamplingInterval(art::gc::AllocationSampler::kDefaultSamplingInterval);
+    }
+  } else {
+    sampler->RemoveListener();
+  }
+}
+
 class JvmtiMonitorListener : public art::MonitorCallback {
  public:
   explicit JvmtiMonitorListener(EventHandler* handler) : handler_(handler) {}
@@ -881,18 +948,44 @@ static uint32_t GetInstrumentationEventsFor(ArtJvmtiEvent event) {
   }
 }
 
+// The keys of the instrumentation entry and exit stubs installed for the method entry and exit
+// events.
+static constexpr const char* kMethodEntryInstrumentationKey = "JVMTI_MethodEntry";
+static constexpr const char* kMethodExitInstrumentationKey = "JVMTI_MethodExit";
+
+// Returns the key of the instrumentation stubs reporting the event from compiled code, or null if
+// the event needs the interpreter. The stubs only see the methods which are not inlined, which is
+// all of them with debuggable code.
+static const char* GetInstrumentationStubsKeyFor(ArtJvmtiEvent event) {
+  if (!art::Runtime::Current()->IsJavaDebuggable()) {
+    return nullptr;
+  }
+  switch (event) {
+    case ArtJvmtiEvent::kMethodEntry:
+      return kMethodEntryInstrumentationKey;
+    case ArtJvmtiEvent::kMethodExit:
+      return kMethodExitInstrumentationKey;
+    default:
+      return nullptr;
+  }
+}
+
 static bool EventNeedsFullDeopt(ArtJvmtiEvent event) {
   switch (event) {
     case ArtJvmtiEvent::kBreakpoint:
     case ArtJvmtiEvent::kException:
       return false;
-    // TODO We should support more of these or at least do something to make them discriminate by
-    // thread.
     case ArtJvmtiEvent::kMethodEntry:
-    case ArtJvmtiEvent::kExceptionCatch:
     case ArtJvmtiEvent::kMethodExit:
+      return GetInstrumentationStubsKeyFor(event) == nullptr;
+    // With a debuggable runtime, the DeoptManager deoptimizes the methods accessing the watched
+    // fields.
     case ArtJvmtiEvent::kFieldModification:
     case ArtJvmtiEvent::kFieldAccess:
+      return !art::Runtime::Current()->IsJavaDebuggable();
+    // TODO We should support more of these or at least do something to make them discriminate by
+    // thread.
+    case ArtJvmtiEvent::kExceptionCatch:
     case ArtJvmtiEvent::kSingleStep:
     case ArtJvmtiEvent::kFramePop:
       return true;
@@ -944,9 +1037,16 @@ void EventHandler::SetupTraceListener(JvmtiMethodTraceListener* listener,
                                        art::gc::kGcCauseInstrumentation,
                                        art::gc::kCollectorTypeInstrumentation);
   art::ScopedSuspendAll ssa("jvmti method tracing installation");
+  const char* stubs_key = GetInstrumentationStubsKeyFor(event);
   if (enable) {
     instr->AddListener(listener, new_events);
+    if (stubs_key != nullptr) {
+      instr->EnableMethodTracing(stubs_key, /* needs_interpreter */ false);
+    }
   } else {
+    if (stubs_key != nullptr) {
+      instr->DisableMethodTracing(stubs_key);
+    }
     instr->RemoveListener(listener, new_events);
   }
 }
@@ -1011,7 +1111,8 @@ void EventHandler::HandleEventType(ArtJvmtiEvent event, bool enable) {
       SetupDdmTracking(ddm_listener_.get(), enable);
       return;
     case ArtJvmtiEvent::kVmObjectAlloc:
-      SetupObjectAllocationTracking(alloc_listener_.get(), enable);
+    case ArtJvmtiEvent::kSampledObjectAlloc:
+      UpdateAllocationTracking();
       return;
 
     case ArtJvmtiEvent::kGarbageCollectionStart:
@@ -1167,6 +1268,36 @@ jvmtiError EventHandler::SetEvent(ArtJvmTiEnv* env,
   return ERR(NONE);
 }
 
+void EventHandler::UpdateAllocationTracking() {
+  bool vm_object_alloc = IsEventEnabledAnywhere(ArtJvmtiEvent::kVmObjectAlloc);
+  bool sampled = IsVmObjectAllocSampled();
+  bool needs_alloc_listener = vm_object_alloc && !sampled;
+  bool needs_sampled_alloc_listener =
+      IsEventEnabledAnywhere(ArtJvmtiEvent::kSampledObjectAlloc) || (vm_object_alloc && sampled);
+  // Install the new listener before removing the old one so that no allocation goes unreported
+  // when switching between them.
+  if (needs_sampled_alloc_listener && !sampled_alloc_listener_installed_) {
+    SetupSampledAllocationTracking(sampled_alloc_listener_.get(), true);
+    sampled_alloc_listener_installed_ = true;
+  }
+  if (needs_alloc_listener != alloc_listener_installed_) {
+    SetupObjectAllocationTracking(alloc_listener_.get(), needs_alloc_listener);
+    alloc_listener_installed_ = needs_alloc_listener;
+  }
+  if (!needs_sampled_alloc_listener && sampled_alloc_listener_installed_) {
+    SetupSampledAllocationTracking(sampled_alloc_listener_.get(), false);
+    sampled_alloc_listener_installed_ = false;
+  }
+}
+
+void EventHandler::SetVmObjectAllocSamplingInterval(size_t interval) {
+  vm_object_alloc_sampling_interval_.store(interval, std::memory_order_relaxed);
+  if (interval != 0u) {
+    art::Runtime::Current()->GetHeap()->GetAllocationSampler()->SetSamplingInterval(interval);
+  }
+  UpdateAllocationTracking();
+}
+
 void EventHandler::HandleBreakpointEventsChanged(bool added) {
   if (added) {
     DeoptManager::Get()->AddDeoptimizationRequester();
@@ -1186,13 +1317,17 @@ void EventHandler::Shutdown() {
   art::Runtime::Current()->GetInstrumentation()->RemoveListener(method_trace_listener_.get(), ~0);
 }
 
-EventHandler::EventHandler() : envs_lock_("JVMTI Environment List Lock",
-                                          art::LockLevel::kTopLockLevel) {
+EventHandler::EventHandler()
+    : envs_lock_("JVMTI Environment List Lock", art::LockLevel::kTopLockLevel),
+      vm_object_alloc_sampling_interval_(0u),
+      alloc_listener_installed_(false),
+      sampled_alloc_listener_installed_(false) {
   alloc_listener_.reset(new JvmtiAllocationListener(this));
   ddm_listener_.reset(new JvmtiDdmChunkListener(this));
   gc_pause_listener_.reset(new JvmtiGcPauseListener(this));
   method_trace_listener_.reset(new JvmtiMethodTraceListener(this));
   monitor_listener_.reset(new JvmtiMonitorListener(this));
+  sampled_alloc_listener_.reset(new JvmtiSampledAllocationListener(this));
 }
 
 EventHandler::~EventHandler() {
@@ -17,6 +17,7 @@
 #ifndef ART_OPENJDKJVMTI_EVENTS_H_
 #define ART_OPENJDKJVMTI_EVENTS_H_
 
+#include <atomic>
 #include <bitset>
 #include <vector>
 
@@ -35,6 +36,7 @@ class JvmtiDdmChunkListener;
 class JvmtiGcPauseListener;
 class JvmtiMethodTraceListener;
 class JvmtiMonitorListener;
+class JvmtiSampledAllocationListener;
 
 // an enum for ArtEvents. This differs from the JVMTI events only in that we distinguish between
 // retransformation capable and incapable loading
@@ -73,7 +75,8 @@ enum class ArtJvmtiEvent : jint {
     kVmObjectAlloc = JVMTI_EVENT_VM_OBJECT_ALLOC,
     kClassFileLoadHookRetransformable = JVMTI_MAX_EVENT_TYPE_VAL + 1,
     kDdmPublishChunk = JVMTI_MAX_EVENT_TYPE_VAL + 2,
-    kMaxEventTypeVal = kDdmPublishChunk,
+    kSampledObjectAlloc = JVMTI_MAX_EVENT_TYPE_VAL + 3,
+    kMaxEventTypeVal = kSampledObjectAlloc,
 };
 
 using ArtJvmtiEventDdmPublishChunk = void (*)(jvmtiEnv *jvmti_env,
@@ -82,8 +85,16 @@ using ArtJvmtiEventDdmPublishChunk = void (*)(jvmtiEnv *jvmti_env,
                                               jint data_len,
                                               const jbyte* data);
 
+// Same parameters as jvmtiEventVMObjectAlloc.
+using ArtJvmtiEventSampledObjectAlloc = void (*)(jvmtiEnv *jvmti_env,
+                                                 JNIEnv* jni_env,
+                                                 jthread thread,
+                                                 jobject object,
+                                                 jclass object_klass,
+                                                 jlong size);
+
 struct ArtJvmtiEventCallbacks : jvmtiEventCallbacks {
-  ArtJvmtiEventCallbacks() : DdmPublishChunk(nullptr) {
+  ArtJvmtiEventCallbacks() : DdmPublishChunk(nullptr), SampledObjectAlloc(nullptr) {
     memset(this, 0, sizeof(jvmtiEventCallbacks));
   }
 
@@ -94,6 +105,7 @@ struct ArtJvmtiEventCallbacks : jvmtiEventCallbacks {
   jvmtiError Set(jint index, jvmtiExtensionEvent cb);
 
   ArtJvmtiEventDdmPublishChunk DdmPublishChunk;
+  ArtJvmtiEventSampledObjectAlloc SampledObjectAlloc;
 };
 
 bool IsExtensionEvent(jint e);
@@ -202,6 +214,15 @@ class EventHandler {
                       jvmtiEventMode mode)
       REQUIRES(!envs_lock_);
 
+  // Sets the mean number of allocated bytes between two VMObjectAlloc events. Zero reports every
+  // allocation. Sampled events are taken by the heap's allocation sampler, so that allocations
+  // keep using the uninstrumented entrypoints.
+  void SetVmObjectAllocSamplingInterval(size_t interval);
+
+  bool IsVmObjectAllocSampled() const {
+    return vm_object_alloc_sampling_interval_.load(std::memory_order_relaxed) != 0u;
+  }
+
   // Dispatch event to all registered environments. Since this one doesn't have a JNIEnv* it doesn't
   // matter if it has the mutator_lock.
   template <ArtJvmtiEvent kEvent, typename ...Args>
@@ -299,6 +320,8 @@ class EventHandler {
       REQUIRES(!envs_lock_);
 
   void HandleEventType(ArtJvmtiEvent event, bool enable);
+  // Installs or removes the allocation listeners needed by the enabled allocation events.
+  void UpdateAllocationTracking();
   void HandleLocalAccessCapabilityAdded();
   void HandleBreakpointEventsChanged(bool enable);
 
@@ -320,6 +343,13 @@ class EventHandler {
   std::unique_ptr<JvmtiGcPauseListener> gc_pause_listener_;
   std::unique_ptr<JvmtiMethodTraceListener> method_trace_listener_;
   std::unique_ptr<JvmtiMonitorListener> monitor_listener_;
+  std::unique_ptr<JvmtiSampledAllocationListener> sampled_alloc_listener_;
+
+  // The VMObjectAlloc sampling interval, zero if every allocation is reported.
+  std::atomic<size_t> vm_object_alloc_sampling_interval_;
+  // Whether the heap allocation listener and the allocation sampler listener are installed.
+  bool alloc_listener_installed_;
+  bool sampled_alloc_listener_installed_;
 
   // True if frame pop has ever been enabled. Since we store pointers to stack frames we need to
   // continue to listen to this event even if it has been disabled.
@@ -34,8 +34,6 @@
 
 #include "jvmti_weak_table.h"
 
-#include <limits>
-
 #include <android-base/logging.h>
 
 #include "art_jvmti.h"
@@ -105,12 +103,12 @@ bool JvmtiWeakTable<T>::RemoveLocked(art::mirror::Object* obj, T* tag) {
 
 template <typename T>
 bool JvmtiWeakTable<T>::RemoveLocked(art::Thread* self, art::mirror::Object* obj, T* tag) {
-  auto it = tagged_objects_.find(art::GcRoot<art::mirror::Object>(obj));
+  auto it = tagged_objects_.Find(obj);
   if (it != tagged_objects_.end()) {
     if (tag != nullptr) {
-      *tag = it->second;
+      *tag = it->tag;
     }
-    tagged_objects_.erase(it);
+    tagged_objects_.Erase(it);
     return true;
   }
 
@@ -150,9 +148,9 @@ bool JvmtiWeakTable<T>::SetLocked(art::mirror::Object* obj, T new_tag) {
 
 template <typename T>
 bool JvmtiWeakTable<T>::SetLocked(art::Thread* self, art::mirror::Object* obj, T new_tag) {
-  auto it = tagged_objects_.find(art::GcRoot<art::mirror::Object>(obj));
+  auto it = tagged_objects_.Find(obj);
   if (it != tagged_objects_.end()) {
-    it->second = new_tag;
+    it->tag = new_tag;
     return true;
   }
 
@@ -170,8 +168,7 @@ bool JvmtiWeakTable<T>::SetLocked(art::Thread* self, art::mirror::Object* obj, T
   }
 
   // New element.
-  auto insert_it = tagged_objects_.emplace(art::GcRoot<art::mirror::Object>(obj), new_tag);
-  DCHECK(insert_it.second);
+  tagged_objects_.Insert(TagEntry(obj, new_tag));
   return false;
 }
 
@@ -210,38 +207,39 @@ void JvmtiWeakTable<T>::SweepImpl(art::IsMarkedVisitor* visitor) {
 template <typename T>
 template <typename Updater, typename JvmtiWeakTable<T>::TableUpdateNullTarget kTargetNull>
 ALWAYS_INLINE inline void JvmtiWeakTable<T>::UpdateTableWith(Updater& updater) {
-  // We optimistically hope that elements will still be well-distributed when re-inserting them.
-  // So play with the map mechanics, and postpone rehashing. This avoids the need of a side
-  // vector and two passes.
-  float original_max_load_factor = tagged_objects_.max_load_factor();
-  tagged_objects_.max_load_factor(std::numeric_limits<float>::max());
-  // For checking that a max load-factor actually does what we expect.
-  size_t original_bucket_count = tagged_objects_.bucket_count();
-
-  for (auto it = tagged_objects_.begin(); it != tagged_objects_.end();) {
-    DCHECK(!it->first.IsNull());
-    art::mirror::Object* original_obj = it->first.template Read<art::kWithoutReadBarrier>();
-    art::mirror::Object* target_obj = updater(it->first, original_obj);
-    if (original_obj != target_obj) {
-      if (kTargetNull == kIgnoreNull && target_obj == nullptr) {
-        // Ignore null target, don't do anything.
-      } else {
-        T tag = it->second;
-        it = tagged_objects_.erase(it);
-        if (target_obj != nullptr) {
-          tagged_objects_.emplace(art::GcRoot<art::mirror::Object>(target_obj), tag);
-          DCHECK_EQ(original_bucket_count, tagged_objects_.bucket_count());
-        } else if (kTargetNull == kCallHandleNull) {
-          HandleNullSweep(tag);
-        }
-        continue;  // Iterator was implicitly updated by erase.
+  // The entries are hashed by address, so the moved ones cannot be updated in place. Once the
+  // first entry changes, rebuild the table into a new one in the same pass: each entry is visited
+  // once and there is a single allocation, however many objects moved or died.
+  TagTable new_table(tagged_objects_.get_allocator());
+  bool rebuilding = false;
+  for (auto it = tagged_objects_.begin(); it != tagged_objects_.end(); ++it) {
+    DCHECK(!it->root.IsNull());
+    art::mirror::Object* original_obj = it->root.template Read<art::kWithoutReadBarrier>();
+    art::mirror::Object* target_obj = updater(it->root, original_obj);
+    if (kTargetNull == kIgnoreNull && target_obj == nullptr) {
+      // Ignore null target, keep the entry.
+      target_obj = original_obj;
+    }
+    if (!rebuilding && original_obj != target_obj) {
+      rebuilding = true;
+      new_table.Reserve(tagged_objects_.Size());
+      // The entries visited so far are unchanged.
+      for (auto kept_it = tagged_objects_.begin(); kept_it != it; ++kept_it) {
+        new_table.Insert(*kept_it);
+      }
+    }
+    if (target_obj == nullptr) {
+      if (kTargetNull == kCallHandleNull) {
+        HandleNullSweep(it->tag);
       }
+    } else if (rebuilding) {
+      new_table.Insert(TagEntry(target_obj, it->tag));
     }
-    it++;
   }
 
-  tagged_objects_.max_load_factor(original_max_load_factor);
-  // TODO: consider rehash here.
+  if (rebuilding) {
+    tagged_objects_.swap(new_table);
+  }
 }
 
 template <typename T>
@@ -336,8 +334,8 @@ jvmtiError JvmtiWeakTable<T>::GetTaggedObjects(jvmtiEnv* jvmti_env,
   size_t initial_object_size;
   size_t initial_tag_size;
   if (tag_count == 0) {
-    initial_object_size = (object_result_ptr != nullptr) ? tagged_objects_.size() : 0;
-    initial_tag_size = (tag_result_ptr != nullptr) ? tagged_objects_.size() : 0;
+    initial_object_size = (object_result_ptr != nullptr) ? tagged_objects_.Size() : 0;
+    initial_tag_size = (tag_result_ptr != nullptr) ? tagged_objects_.Size() : 0;
   } else {
     initial_object_size = initial_tag_size = kDefaultSize;
   }
@@ -347,12 +345,12 @@ jvmtiError JvmtiWeakTable<T>::GetTaggedObjects(jvmtiEnv* jvmti_env,
   ReleasableContainer<T, JvmtiAllocator<T>> selected_tags(allocator, initial_tag_size);
 
   size_t count = 0;
-  for (auto& pair : tagged_objects_) {
+  for (auto& entry : tagged_objects_) {
     bool select;
     if (tag_count > 0) {
       select = false;
       for (size_t i = 0; i != static_cast<size_t>(tag_count); ++i) {
-        if (tags[i] == pair.second) {
+        if (tags[i] == entry.tag) {
           select = true;
           break;
         }
@@ -362,14 +360,14 @@ jvmtiError JvmtiWeakTable<T>::GetTaggedObjects(jvmtiEnv* jvmti_env,
     }
 
     if (select) {
-      art::mirror::Object* obj = pair.first.template Read<art::kWithReadBarrier>();
+      art::mirror::Object* obj = entry.root.template Read<art::kWithReadBarrier>();
       if (obj != nullptr) {
         count++;
         if (object_result_ptr != nullptr) {
           selected_objects.Pushback(jni_env->AddLocalReference<jobject>(obj));
         }
         if (tag_result_ptr != nullptr) {
-          selected_tags.Pushback(pair.second);
+          selected_tags.Pushback(entry.tag);
         }
       }
     }
@@ -385,15 +383,30 @@ jvmtiError JvmtiWeakTable<T>::GetTaggedObjects(jvmtiEnv* jvmti_env,
   return ERR(NONE);
 }
 
+template <typename T>
+void JvmtiWeakTable<T>::GetObjects(std::vector<art::mirror::Object*>* objects) {
+  art::Thread* self = art::Thread::Current();
+  art::MutexLock mu(self, allow_disallow_lock_);
+  Wait(self);
+
+  objects->reserve(objects->size() + tagged_objects_.Size());
+  for (auto& entry : tagged_objects_) {
+    art::mirror::Object* obj = entry.root.template Read<art::kWithReadBarrier>();
+    if (obj != nullptr) {
+      objects->push_back(obj);
+    }
+  }
+}
+
 template <typename T>
 art::mirror::Object* JvmtiWeakTable<T>::Find(T tag) {
   art::Thread* self = art::Thread::Current();
   art::MutexLock mu(self, allow_disallow_lock_);
   Wait(self);
 
-  for (auto& pair : tagged_objects_) {
-    if (tag == pair.second) {
-      art::mirror::Object* obj = pair.first.template Read<art::kWithReadBarrier>();
+  for (auto& entry : tagged_objects_) {
+    if (tag == entry.tag) {
+      art::mirror::Object* obj = entry.root.template Read<art::kWithReadBarrier>();
       if (obj != nullptr) {
         return obj;
       }
@@ -32,8 +32,9 @@
 #ifndef ART_OPENJDKJVMTI_JVMTI_WEAK_TABLE_H_
 #define ART_OPENJDKJVMTI_JVMTI_WEAK_TABLE_H_
 
-#include <unordered_map>
+#include <vector>
 
+#include "base/hash_set.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "gc/system_weak.h"
@@ -50,6 +51,10 @@ class EventHandler;
 
 // A system-weak container mapping objects to elements of the template type. This corresponds
 // to a weak hash map. For historical reasons the stored value is called "tag."
+//
+// The tags are stored next to their object in a flat open-addressing table keyed by address, so
+// that agents tagging millions of objects neither allocate a node per tag nor pay for one when
+// the GC moves objects: a sweep rebuilds the table in a single pass.
 template <typename T>
 class JvmtiWeakTable : public art::gc::SystemWeakHolder {
  public:
@@ -113,6 +118,11 @@ class JvmtiWeakTable : public art::gc::SystemWeakHolder {
       REQUIRES_SHARED(art::Locks::mutator_lock_)
       REQUIRES(!allow_disallow_lock_);
 
+  // Append all objects that have a value mapping to `objects`.
+  ALWAYS_INLINE void GetObjects(/* out */ std::vector<art::mirror::Object*>* objects)
+      REQUIRES_SHARED(art::Locks::mutator_lock_)
+      REQUIRES(!allow_disallow_lock_);
+
   // Locking functions, to allow coarse-grained locking and amortization.
   ALWAYS_INLINE  void Lock() ACQUIRE(allow_disallow_lock_);
   ALWAYS_INLINE void Unlock() RELEASE(allow_disallow_lock_);
@@ -144,9 +154,9 @@ class JvmtiWeakTable : public art::gc::SystemWeakHolder {
   bool GetTagLocked(art::Thread* self, art::mirror::Object* obj, /* out */ T* result)
       REQUIRES_SHARED(art::Locks::mutator_lock_)
       REQUIRES(allow_disallow_lock_) {
-    auto it = tagged_objects_.find(art::GcRoot<art::mirror::Object>(obj));
+    auto it = tagged_objects_.Find(obj);
     if (it != tagged_objects_.end()) {
-      *result = it->second;
+      *result = it->tag;
       return true;
     }
 
@@ -195,27 +205,49 @@ class JvmtiWeakTable : public art::gc::SystemWeakHolder {
   template <typename Storage, class Allocator = JvmtiAllocator<T>>
   struct ReleasableContainer;
 
-  struct HashGcRoot {
-    size_t operator()(const art::GcRoot<art::mirror::Object>& r) const
-        REQUIRES_SHARED(art::Locks::mutator_lock_) {
-      return reinterpret_cast<uintptr_t>(r.Read<art::kWithoutReadBarrier>());
+  struct TagEntry {
+    TagEntry() : tag() {}
+    TagEntry(art::mirror::Object* obj, T t) REQUIRES_SHARED(art::Locks::mutator_lock_)
+        : root(obj), tag(t) {}
+
+    art::GcRoot<art::mirror::Object> root;
+    T tag;
+  };
+
+  struct TagEntryEmptyFn {
+    void MakeEmpty(TagEntry& item) const {
+      item = TagEntry();
+    }
+    bool IsEmpty(const TagEntry& item) const {
+      return item.root.IsNull();
+    }
+  };
+
+  // The objects are only compared by address, without read barriers.
+  struct HashTagEntry {
+    size_t operator()(const TagEntry& entry) const NO_THREAD_SAFETY_ANALYSIS {
+      return (*this)(entry.root.Read<art::kWithoutReadBarrier>());
+    }
+    size_t operator()(art::mirror::Object* obj) const {
+      return reinterpret_cast<uintptr_t>(obj) >> art::kObjectAlignmentShift;
     }
   };
 
-  struct EqGcRoot {
-    bool operator()(const art::GcRoot<art::mirror::Object>& r1,
-                    const art::GcRoot<art::mirror::Object>& r2) const
-        REQUIRES_SHARED(art::Locks::mutator_lock_) {
-      return r1.Read<art::kWithoutReadBarrier>() == r2.Read<art::kWithoutReadBarrier>();
+  struct EqTagEntry {
+    bool operator()(const TagEntry& a, const TagEntry& b) const NO_THREAD_SAFETY_ANALYSIS {
+      return a.root.Read<art::kWithoutReadBarrier>() == b.root.Read<art::kWithoutReadBarrier>();
+    }
+    bool operator()(const TagEntry& a, art::mirror::Object* obj) const NO_THREAD_SAFETY_ANALYSIS {
+      return a.root.Read<art::kWithoutReadBarrier>() == obj;
     }
   };
 
-  using TagAllocator = JvmtiAllocator<std::pair<const art::GcRoot<art::mirror::Object>, T>>;
-  std::unordered_map<art::GcRoot<art::mirror::Object>,
-                     T,
-                     HashGcRoot,
-                     EqGcRoot,
-                     TagAllocator> tagged_objects_
+  using TagTable = art::HashSet<TagEntry,
+                                TagEntryEmptyFn,
+                                HashTagEntry,
+                                EqTagEntry,
+                                JvmtiAllocator<TagEntry>>;
+  TagTable tagged_objects_
       GUARDED_BY(allow_disallow_lock_)
       GUARDED_BY(art::Locks::mutator_lock_);
   // To avoid repeatedly scanning the whole table, remember if we did that since the last sweep.
@@ -63,24 +63,32 @@ jvmtiError DDMSUtil::HandleChunk(jvmtiEnv* env,
   art::ScopedThreadStateChange(self, art::ThreadState::kNative);
 
   art::ArrayRef<const jbyte> data_arr(data_in, length_in);
-  std::vector<uint8_t> out_data;
+  // The reply is copied straight from the reply array into the jvmti allocated buffer.
+  jvmtiError error = OK;
+  JvmtiUniquePtr<jbyte[]> reply;
+  size_t reply_length = 0;
+  auto alloc_reply = [&](size_t length) -> uint8_t* {
+    reply_length = length;
+    if (length == 0) {
+      return nullptr;
+    }
+    reply = AllocJvmtiUniquePtr<jbyte[]>(env, length, &error);
+    return reinterpret_cast<uint8_t*>(reply.get());
+  };
   if (!art::Dbg::DdmHandleChunk(self->GetJniEnv(),
                                 type_in,
                                 data_arr,
                                 /*out*/reinterpret_cast<uint32_t*>(type_out),
-                                /*out*/&out_data)) {
+                                alloc_reply)) {
+    if (error != OK) {
+      return error;
+    }
     LOG(WARNING) << "Something went wrong with handling the ddm chunk.";
     return ERR(INTERNAL);
   } else {
-    jvmtiError error = OK;
-    if (!out_data.empty()) {
-      JvmtiUniquePtr<jbyte[]> ret = AllocJvmtiUniquePtr<jbyte[]>(env, out_data.size(), &error);
-      if (error != OK) {
-        return error;
-      }
-      memcpy(ret.get(), out_data.data(), out_data.size());
-      *data_out = ret.release();
-      *data_length_out = static_cast<jint>(out_data.size());
+    if (reply_length != 0) {
+      *data_out = reply.release();
+      *data_length_out = static_cast<jint>(reply_length);
     }
     return OK;
   }
@@ -38,6 +38,7 @@
 #include "ti_allocator.h"
 #include "ti_ddms.h"
 #include "ti_heap.h"
+#include "ti_stack.h"
 #include "thread-inl.h"
 
 namespace openjdkjvmti {
@@ -190,6 +191,60 @@ jvmtiError ExtensionUtil::GetExtensionFunctions(jvmtiEnv* env,
     return error;
   }
 
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::IterateThroughHeapParallel),
+      "com.android.art.heap.iterate_through_heap_parallel",
+      "Iterate through the heap like the standard IterateThroughHeap function, calling the"
+      " heap_iteration_callback from up to 'thread_count' native threads at once. The heap and"
+      " class filters are applied while the world is stopped, and the callback is then called"
+      " concurrently in contiguous chunks of the filtered objects. Only the heap_iteration_callback"
+      " may be set. The callback must not call back into JNI or JVMTI.",
+      {
+          { "heap_filter", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+          { "klass", JVMTI_KIND_IN, JVMTI_TYPE_JCLASS, true},
+          { "callbacks", JVMTI_KIND_IN_PTR, JVMTI_TYPE_CVOID, false},
+          { "user_data", JVMTI_KIND_IN_PTR, JVMTI_TYPE_CVOID, true},
+          { "thread_count", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false}
+      },
+      {
+          ERR(MUST_POSSESS_CAPABILITY),
+          ERR(ILLEGAL_ARGUMENT),
+          ERR(NULL_POINTER),
+      });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::SetHeapSamplingInterval),
+      "com.android.art.heap.set_heap_sampling_interval",
+      "Set the mean number of bytes each thread allocates between two allocations reported by the"
+      " com.android.art.heap.sampled_object_alloc event. Allocations are sampled as a Poisson"
+      " process over the allocated bytes. A 'sampling_interval' of 0 stops sampling.",
+      {
+          { "sampling_interval", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+      },
+      { ERR(ILLEGAL_ARGUMENT) });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(HeapExtensions::SetVmObjectAllocSamplingInterval),
+      "com.android.art.heap.set_vm_object_alloc_sampling_interval",
+      "Only report a sample of the allocations through the VMObjectAlloc event, on average one"
+      " every 'sampling_interval' allocated bytes per thread. Sampled allocations keep using the"
+      " uninstrumented allocation entrypoints. The interval is shared with the"
+      " com.android.art.heap.sampled_object_alloc event. A 'sampling_interval' of 0 reports every"
+      " allocation again.",
+      {
+          { "sampling_interval", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+      },
+      { ERR(ILLEGAL_ARGUMENT) });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
   error = add_extension(
       reinterpret_cast<jvmtiExtensionFunction>(AllocUtil::GetGlobalJvmtiAllocationState),
       "com.android.art.alloc.get_global_jvmti_allocation_state",
@@ -205,6 +260,31 @@ jvmtiError ExtensionUtil::GetExtensionFunctions(jvmtiEnv* env,
     return error;
   }
 
+  // Stack extensions.
+  error = add_extension(
+      reinterpret_cast<jvmtiExtensionFunction>(StackUtil::GetThreadListStackTracesCompact),
+      "com.android.art.stack.get_thread_list_stack_traces_compact",
+      "Retrieve the stack traces of the given threads with a single checkpoint, like the standard"
+      " GetThreadListStackTraces function, but into caller provided buffers. 'frame_buffer' must"
+      " hold 'thread_count * max_frame_count' jvmtiFrameInfo entries, and the frames of the i-th"
+      " thread start at index 'i * max_frame_count'. 'frame_counts' receives the number of frames"
+      " of each thread, or -1 if the thread is not alive.",
+      {
+          { "thread_count", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+          { "thread_list", JVMTI_KIND_IN_BUF, JVMTI_TYPE_JTHREAD, false},
+          { "max_frame_count", JVMTI_KIND_IN, JVMTI_TYPE_JINT, false},
+          { "frame_buffer", JVMTI_KIND_OUT_BUF, JVMTI_TYPE_CVOID, false},
+          { "frame_counts", JVMTI_KIND_OUT_BUF, JVMTI_TYPE_JINT, false}
+      },
+      {
+          ERR(ILLEGAL_ARGUMENT),
+          ERR(INVALID_THREAD),
+          ERR(NULL_POINTER),
+      });
+  if (error != ERR(NONE)) {
+    return error;
+  }
+
   // DDMS extension
   error = add_extension(
       reinterpret_cast<jvmtiExtensionFunction>(DDMSUtil::HandleChunk),
@@ -332,6 +412,25 @@ jvmtiError ExtensionUtil::GetExtensionEvents(jvmtiEnv* env,
     return error;
   }
 
+  error = add_extension(
+      ArtJvmtiEvent::kSampledObjectAlloc,
+      "com.android.art.heap.sampled_object_alloc",
+      "Called for allocations picked by the runtime's allocation sampler, on the allocating thread"
+      " and after the object is initialized. This has the same parameters as the VMObjectAlloc"
+      " event but does not slow down all allocations. Enabling the event starts sampling at a"
+      " mean interval of 512KB unless one was set with"
+      " com.android.art.heap.set_heap_sampling_interval.",
+      {
+        { "jni_env", JVMTI_KIND_IN_PTR, JVMTI_TYPE_JNIENV, false },
+        { "thread", JVMTI_KIND_IN, JVMTI_TYPE_JTHREAD, false },
+        { "object", JVMTI_KIND_IN, JVMTI_TYPE_JOBJECT, false },
+        { "klass", JVMTI_KIND_IN, JVMTI_TYPE_JCLASS, false },
+        { "size", JVMTI_KIND_IN, JVMTI_TYPE_JLONG, false },
+      });
+  if (error != OK) {
+    return error;
+  }
+
   // Copy into output buffer.
 
   *extension_count_ptr = ext_vector.size();
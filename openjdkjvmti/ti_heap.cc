@@ -16,11 +16,17 @@
 
 #include "ti_heap.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "art_field-inl.h"
 #include "art_jvmti.h"
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "class_linker.h"
+#include "gc/allocation_sampler.h"
 #include "gc/heap-visit-objects-inl.h"
 #include "gc/heap.h"
 #include "gc_root-inl.h"
@@ -623,17 +629,17 @@ struct HeapFilter {
     if (!any_filter) {
       return true;
     }
+    return ShouldReportByTag(tag) && ShouldReportByClassTag(class_tag);
+  }
 
-    if ((tag == 0 && filter_out_untagged) || (tag != 0 && filter_out_tagged)) {
-      return false;
-    }
-
-    if ((class_tag == 0 && filter_out_class_untagged) ||
-        (class_tag != 0 && filter_out_class_tagged)) {
-      return false;
-    }
+  // The two halves of the filter, so that an object can be rejected with a single tag lookup.
+  bool ShouldReportByTag(jlong tag) const {
+    return !((tag == 0 && filter_out_untagged) || (tag != 0 && filter_out_tagged));
+  }
 
-    return true;
+  bool ShouldReportByClassTag(jlong class_tag) const {
+    return !((class_tag == 0 && filter_out_class_untagged) ||
+             (class_tag != 0 && filter_out_class_tagged));
   }
 
   const bool filter_out_tagged;
@@ -679,24 +685,26 @@ static jvmtiError DoIterateThroughHeap(T fn,
 
     art::ScopedAssertNoThreadSuspension no_suspension("IterateThroughHeapCallback");
 
+    // Apply the cheapest filters first: the class filter needs no tag lookup, and the tag filter
+    // needs a single one.
+    art::ObjPtr<art::mirror::Class> klass = obj->GetClass();
+    if (filter_klass != nullptr && filter_klass != klass) {
+      return;
+    }
+
+    // For simplicity, even if we find a tag = 0, assume 0 = not tagged.
     jlong tag = 0;
     tag_table->GetTag(obj, &tag);
+    if (!heap_filter.ShouldReportByTag(tag)) {
+      return;
+    }
 
     jlong class_tag = 0;
-    art::ObjPtr<art::mirror::Class> klass = obj->GetClass();
     tag_table->GetTag(klass.Ptr(), &class_tag);
-    // For simplicity, even if we find a tag = 0, assume 0 = not tagged.
-
-    if (!heap_filter.ShouldReportByHeapFilter(tag, class_tag)) {
+    if (!heap_filter.ShouldReportByClassTag(class_tag)) {
       return;
     }
 
-    if (filter_klass != nullptr) {
-      if (filter_klass != klass) {
-        return;
-      }
-    }
-
     jlong size = obj->SizeOf();
 
     jint length = -1;
@@ -727,7 +735,19 @@ static jvmtiError DoIterateThroughHeap(T fn,
       stop_reports = ReportPrimitiveField::Report(obj, tag_table, callbacks, user_data);
     }
   };
-  art::Runtime::Current()->GetHeap()->VisitObjects(visitor);
+
+  if (heap_filter.filter_out_untagged) {
+    // Only tagged objects are reported, visit the tag table instead of the whole heap. The objects
+    // cannot move while this thread doesn't suspend, as with the walk of a non-moving heap.
+    art::ScopedAssertNoThreadSuspension no_suspension("IterateThroughTaggedObjects");
+    std::vector<art::mirror::Object*> tagged_objects;
+    tag_table->GetObjects(&tagged_objects);
+    for (art::mirror::Object* obj : tagged_objects) {
+      visitor(obj);
+    }
+  } else {
+    art::Runtime::Current()->GetHeap()->VisitObjects(visitor);
+  }
 
   return ERR(NONE);
 }
@@ -1519,4 +1539,142 @@ jvmtiError HeapExtensions::IterateThroughHeapExt(jvmtiEnv* env,
                               user_data);
 }
 
+jvmtiError HeapExtensions::IterateThroughHeapParallel(jvmtiEnv* env,
+                                                      jint heap_filter_int,
+                                                      jclass klass,
+                                                      const jvmtiHeapCallbacks* callbacks,
+                                                      const void* user_data,
+                                                      jint thread_count) {
+  if (ArtJvmTiEnv::AsArtJvmTiEnv(env)->capabilities.can_tag_objects != 1) {
+    return ERR(MUST_POSSESS_CAPABILITY);
+  }
+  if (callbacks == nullptr) {
+    return ERR(NULL_POINTER);
+  }
+  // Only the object callback can be called concurrently, the others report into a single object.
+  if (callbacks->heap_iteration_callback == nullptr ||
+      callbacks->string_primitive_value_callback != nullptr ||
+      callbacks->array_primitive_value_callback != nullptr ||
+      callbacks->primitive_field_callback != nullptr ||
+      thread_count <= 0) {
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+
+  // The filtered objects, with the arguments of their callback.
+  struct ObjectRecord {
+    art::mirror::Object* obj;
+    jlong class_tag;
+    jlong size;
+    jlong tag;
+    jint length;
+  };
+
+  art::Thread* self = art::Thread::Current();
+  ObjectTagTable* tag_table = ArtJvmTiEnv::AsArtJvmTiEnv(env)->object_tag_table.get();
+  art::gc::Heap* heap = art::Runtime::Current()->GetHeap();
+  if (heap->IsGcConcurrentAndMoving()) {
+    // See the comment in Heap::VisitObjects().
+    heap->IncrementDisableMovingGC(self);
+  }
+  {
+    art::ScopedObjectAccess soa(self);
+    art::ScopedThreadSuspension sts(self, art::kWaitingForVisitObjects);
+    art::ScopedSuspendAll ssa("IterateThroughHeapParallel");
+
+    // Apply the filters in a single-threaded walk of the paused heap, with the tag table locked
+    // once rather than for each object.
+    const HeapFilter heap_filter(heap_filter_int);
+    art::ObjPtr<art::mirror::Class> filter_klass = klass == nullptr
+        ? nullptr
+        : art::ObjPtr<art::mirror::Class>::DownCast(self->DecodeJObject(klass));
+    std::vector<ObjectRecord> records;
+    tag_table->Lock();
+    auto visitor = [&](art::mirror::Object* obj) REQUIRES_SHARED(art::Locks::mutator_lock_) {
+      art::ObjPtr<art::mirror::Class> obj_klass = obj->GetClass();
+      if (filter_klass != nullptr && filter_klass != obj_klass) {
+        return;
+      }
+      jlong tag = 0;
+      tag_table->GetTagLocked(obj, &tag);
+      if (!heap_filter.ShouldReportByTag(tag)) {
+        return;
+      }
+      jlong class_tag = 0;
+      tag_table->GetTagLocked(obj_klass.Ptr(), &class_tag);
+      if (!heap_filter.ShouldReportByClassTag(class_tag)) {
+        return;
+      }
+      jint length = obj->IsArrayInstance() ? obj->AsArray()->GetLength() : -1;
+      records.push_back(
+          ObjectRecord { obj, class_tag, static_cast<jlong>(obj->SizeOf()), tag, length });
+    };
+    heap->VisitObjectsPaused(visitor);
+    tag_table->Unlock();
+
+    // Call the agent in contiguous chunks, one per thread. The threads are not attached to the
+    // runtime and only see the copied arguments, the objects stay paused until all are done.
+    std::vector<jlong> saved_tags;
+    saved_tags.reserve(records.size());
+    for (const ObjectRecord& record : records) {
+      saved_tags.push_back(record.tag);
+    }
+    std::atomic<bool> stop_reports(false);
+    auto report = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i != end && !stop_reports.load(std::memory_order_relaxed); ++i) {
+        ObjectRecord& record = records[i];
+        jint ret = callbacks->heap_iteration_callback(record.class_tag,
+                                                      record.size,
+                                                      &record.tag,
+                                                      record.length,
+                                                      const_cast<void*>(user_data));
+        if ((ret & JVMTI_VISIT_ABORT) != 0) {
+          stop_reports.store(true, std::memory_order_relaxed);
+        }
+      }
+    };
+    size_t num_threads = std::min(static_cast<size_t>(thread_count), records.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_threads; ++i) {
+      threads.emplace_back(report,
+                           records.size() * i / num_threads,
+                           records.size() * (i + 1) / num_threads);
+    }
+    report(0u, num_threads != 0u ? records.size() / num_threads : 0u);
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    for (size_t i = 0; i != records.size(); ++i) {
+      if (records[i].tag != saved_tags[i]) {
+        tag_table->Set(records[i].obj, records[i].tag);
+      }
+    }
+  }
+  if (heap->IsGcConcurrentAndMoving()) {
+    heap->DecrementDisableMovingGC(self);
+  }
+
+  return ERR(NONE);
+}
+
+jvmtiError HeapExtensions::SetHeapSamplingInterval(jvmtiEnv* env ATTRIBUTE_UNUSED,
+                                                   jint sampling_interval) {
+  if (sampling_interval < 0) {
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  art::Runtime::Current()->GetHeap()->GetAllocationSampler()->SetSamplingInterval(
+      static_cast<size_t>(sampling_interval));
+  return ERR(NONE);
+}
+
+jvmtiError HeapExtensions::SetVmObjectAllocSamplingInterval(jvmtiEnv* env,
+                                                            jint sampling_interval) {
+  if (sampling_interval < 0) {
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  ArtJvmTiEnv::AsArtJvmTiEnv(env)->event_handler->SetVmObjectAllocSamplingInterval(
+      static_cast<size_t>(sampling_interval));
+  return ERR(NONE);
+}
+
 }  // namespace openjdkjvmti
@@ -66,6 +66,18 @@ class HeapExtensions {
                                                   jclass klass,
                                                   const jvmtiHeapCallbacks* callbacks,
                                                   const void* user_data);
+
+  static jvmtiError JNICALL IterateThroughHeapParallel(jvmtiEnv* env,
+                                                       jint heap_filter,
+                                                       jclass klass,
+                                                       const jvmtiHeapCallbacks* callbacks,
+                                                       const void* user_data,
+                                                       jint thread_count);
+
+  static jvmtiError JNICALL SetHeapSamplingInterval(jvmtiEnv* env, jint sampling_interval);
+
+  static jvmtiError JNICALL SetVmObjectAllocSamplingInterval(jvmtiEnv* env,
+                                                             jint sampling_interval);
 };
 
 }  // namespace openjdkjvmti
@@ -139,18 +139,18 @@ class ObsoleteMap {
 // This visitor walks thread stacks and allocates and sets up the obsolete methods. It also does
 // some basic sanity checks that the obsolete method is sane.
 class ObsoleteMethodStackVisitor : public art::StackVisitor {
+ public:
+  // The obsolete map and the allocator of the class of a method which could be obsoleted.
+  using ObsoleteMethodInfo = std::pair<ObsoleteMap*, art::LinearAlloc*>;
+
  protected:
   ObsoleteMethodStackVisitor(
       art::Thread* thread,
-      art::LinearAlloc* allocator,
-      const std::unordered_set<art::ArtMethod*>& obsoleted_methods,
-      ObsoleteMap* obsolete_maps)
+      const std::unordered_map<art::ArtMethod*, ObsoleteMethodInfo>& obsoleted_methods)
         : StackVisitor(thread,
                        /*context*/nullptr,
                        StackVisitor::StackWalkKind::kIncludeInlinedFrames),
-          allocator_(allocator),
-          obsoleted_methods_(obsoleted_methods),
-          obsolete_maps_(obsolete_maps) { }
+          obsoleted_methods_(obsoleted_methods) { }
 
   ~ObsoleteMethodStackVisitor() OVERRIDE {}
 
@@ -160,32 +160,30 @@ class ObsoleteMethodStackVisitor : public art::StackVisitor {
   // The stack is cleaned up when we fail.
   static void UpdateObsoleteFrames(
       art::Thread* thread,
-      art::LinearAlloc* allocator,
-      const std::unordered_set<art::ArtMethod*>& obsoleted_methods,
-      ObsoleteMap* obsolete_maps)
+      const std::unordered_map<art::ArtMethod*, ObsoleteMethodInfo>& obsoleted_methods)
         REQUIRES(art::Locks::mutator_lock_) {
-    ObsoleteMethodStackVisitor visitor(thread,
-                                       allocator,
-                                       obsoleted_methods,
-                                       obsolete_maps);
+    ObsoleteMethodStackVisitor visitor(thread, obsoleted_methods);
     visitor.WalkStack();
   }
 
   bool VisitFrame() OVERRIDE REQUIRES(art::Locks::mutator_lock_) {
     art::ScopedAssertNoThreadSuspension snts("Fixing up the stack for obsolete methods.");
     art::ArtMethod* old_method = GetMethod();
-    if (obsoleted_methods_.find(old_method) != obsoleted_methods_.end()) {
+    auto it = obsoleted_methods_.find(old_method);
+    if (it != obsoleted_methods_.end()) {
       // We cannot ensure that the right dex file is used in inlined frames so we don't support
       // redefining them.
       DCHECK(!IsInInlinedFrame()) << "Inlined frames are not supported when using redefinition";
-      art::ArtMethod* new_obsolete_method = obsolete_maps_->FindObsoleteVersion(old_method);
+      ObsoleteMap* obsolete_maps = it->second.first;
+      art::LinearAlloc* allocator = it->second.second;
+      art::ArtMethod* new_obsolete_method = obsolete_maps->FindObsoleteVersion(old_method);
       if (new_obsolete_method == nullptr) {
         // Create a new Obsolete Method and put it in the list.
         art::Runtime* runtime = art::Runtime::Current();
         art::ClassLinker* cl = runtime->GetClassLinker();
         auto ptr_size = cl->GetImagePointerSize();
         const size_t method_size = art::ArtMethod::Size(ptr_size);
-        auto* method_storage = allocator_->Alloc(art::Thread::Current(), method_size);
+        auto* method_storage = allocator->Alloc(art::Thread::Current(), method_size);
         CHECK(method_storage != nullptr) << "Unable to allocate storage for obsolete version of '"
                                          << old_method->PrettyMethod() << "'";
         new_obsolete_method = new (method_storage) art::ArtMethod();
@@ -194,7 +192,7 @@ class ObsoleteMethodStackVisitor : public art::StackVisitor {
         new_obsolete_method->SetIsObsolete();
         new_obsolete_method->SetDontCompile();
         cl->SetEntryPointsForObsoleteMethod(new_obsolete_method);
-        obsolete_maps_->RecordObsolete(old_method, new_obsolete_method);
+        obsolete_maps->RecordObsolete(old_method, new_obsolete_method);
         // Update JIT Data structures to point to the new method.
         art::jit::Jit* jit = art::Runtime::Current()->GetJit();
         if (jit != nullptr) {
@@ -210,14 +208,11 @@ class ObsoleteMethodStackVisitor : public art::StackVisitor {
   }
 
  private:
-  // The linear allocator we should use to make new methods.
-  art::LinearAlloc* allocator_;
-  // The set of all methods which could be obsoleted.
-  const std::unordered_set<art::ArtMethod*>& obsoleted_methods_;
-  // A map from the original to the newly allocated obsolete method for frames on this thread. The
-  // values in this map are added to the obsolete_methods_ (and obsolete_dex_caches_) fields of
+  // All the methods which could be obsoleted, with the linear allocator to make their obsolete
+  // versions and the map from the original to the newly allocated obsolete method of their class.
+  // The values in this map are added to the obsolete_methods_ (and obsolete_dex_caches_) fields of
   // the redefined classes ClassExt as it is filled.
-  ObsoleteMap* obsolete_maps_;
+  const std::unordered_map<art::ArtMethod*, ObsoleteMethodInfo>& obsoleted_methods_;
 };
 
 jvmtiError Redefiner::IsModifiableClass(jvmtiEnv* env ATTRIBUTE_UNUSED,
@@ -521,33 +516,28 @@ art::mirror::Object* Redefiner::ClassRedefinition::AllocateOrGetOriginalDexFile(
 }
 
 struct CallbackCtx {
-  ObsoleteMap* obsolete_map;
-  art::LinearAlloc* allocator;
-  std::unordered_set<art::ArtMethod*> obsolete_methods;
-
-  explicit CallbackCtx(ObsoleteMap* map, art::LinearAlloc* alloc)
-      : obsolete_map(map), allocator(alloc) {}
+  // The obsolete maps of the redefined classes.
+  std::vector<std::unique_ptr<ObsoleteMap>> obsolete_maps;
+  std::unordered_map<art::ArtMethod*, ObsoleteMethodStackVisitor::ObsoleteMethodInfo>
+      obsolete_methods;
 };
 
 void DoAllocateObsoleteMethodsCallback(art::Thread* t, void* vdata) NO_THREAD_SAFETY_ANALYSIS {
   CallbackCtx* data = reinterpret_cast<CallbackCtx*>(vdata);
-  ObsoleteMethodStackVisitor::UpdateObsoleteFrames(t,
-                                                   data->allocator,
-                                                   data->obsolete_methods,
-                                                   data->obsolete_map);
+  ObsoleteMethodStackVisitor::UpdateObsoleteFrames(t, data->obsolete_methods);
 }
 
-// This creates any ArtMethod* structures needed for obsolete methods and ensures that the stack is
-// updated so they will be run.
-// TODO Rewrite so we can do this only once regardless of how many redefinitions there are.
-void Redefiner::ClassRedefinition::FindAndAllocateObsoleteMethods(art::mirror::Class* art_klass) {
-  art::ScopedAssertNoThreadSuspension ns("No thread suspension during thread stack walking");
+void Redefiner::ClassRedefinition::CollectObsoleteMethods(art::mirror::Class* art_klass,
+                                                          /*out*/CallbackCtx* ctx) {
   art::mirror::ClassExt* ext = art_klass->GetExtData();
   CHECK(ext->GetObsoleteMethods() != nullptr);
   art::ClassLinker* linker = driver_->runtime_->GetClassLinker();
   // This holds pointers to the obsolete methods map fields which are updated as needed.
-  ObsoleteMap map(ext->GetObsoleteMethods(), ext->GetObsoleteDexCaches(), art_klass->GetDexCache());
-  CallbackCtx ctx(&map, linker->GetAllocatorForClassLoader(art_klass->GetClassLoader()));
+  ctx->obsolete_maps.emplace_back(new ObsoleteMap(
+      ext->GetObsoleteMethods(), ext->GetObsoleteDexCaches(), art_klass->GetDexCache()));
+  ObsoleteMethodStackVisitor::ObsoleteMethodInfo info(
+      ctx->obsolete_maps.back().get(),
+      linker->GetAllocatorForClassLoader(art_klass->GetClassLoader()));
   // Add all the declared methods to the map
   for (auto& m : art_klass->GetDeclaredMethods(art::kRuntimePointerSize)) {
     if (m.IsIntrinsic()) {
@@ -562,13 +552,39 @@ void Redefiner::ClassRedefinition::FindAndAllocateObsoleteMethods(art::mirror::C
     // from (for example about stack-frame size). Furthermore we would be unable to get some useful
     // error checking from the interpreter which ensure we don't try to start executing obsolete
     // methods.
-    ctx.obsolete_methods.insert(&m);
+    ctx->obsolete_methods.emplace(&m, info);
   }
-  {
-    art::MutexLock mu(driver_->self_, *art::Locks::thread_list_lock_);
-    art::ThreadList* list = art::Runtime::Current()->GetThreadList();
-    list->ForEach(DoAllocateObsoleteMethodsCallback, static_cast<void*>(&ctx));
+}
+
+// This creates any ArtMethod* structures needed for obsolete methods and ensures that the stack is
+// updated so they will be run.
+void Redefiner::FindAndAllocateObsoleteMethods(RedefinitionDataHolder& holder) {
+  art::ScopedAssertNoThreadSuspension ns("No thread suspension during thread stack walking");
+  CallbackCtx ctx;
+  for (RedefinitionDataIter data = holder.begin(); data != holder.end(); ++data) {
+    data.GetRedefinition().CollectObsoleteMethods(data.GetMirrorClass(), &ctx);
+  }
+  art::MutexLock mu(self_, *art::Locks::thread_list_lock_);
+  runtime_->GetThreadList()->ForEach(DoAllocateObsoleteMethodsCallback, static_cast<void*>(&ctx));
+}
+
+void Redefiner::NotifyJitOfRedefinedMethods(RedefinitionDataHolder& holder) {
+  art::jit::Jit* jit = runtime_->GetJit();
+  if (jit == nullptr) {
+    return;
   }
+  // Non-invokable methods don't have any JIT data associated with them so we don't need to tell
+  // the jit about them.
+  std::unordered_set<art::ArtMethod*> methods;
+  for (RedefinitionDataIter data = holder.begin(); data != holder.end(); ++data) {
+    for (art::ArtMethod& method :
+             data.GetMirrorClass()->GetDeclaredMethods(art::kRuntimePointerSize)) {
+      if (method.IsInvokable()) {
+        methods.insert(&method);
+      }
+    }
+  }
+  jit->GetCodeCache()->NotifyMethodsRedefined(methods);
 }
 
 // Try and get the declared method. First try to get a virtual method then a direct method if that's
@@ -1345,6 +1361,8 @@ jvmtiError Redefiner::Run() {
   // TODO This isn't right. We need to change state without any chance of suspend ideally!
   art::ScopedThreadSuspension sts(self_, art::ThreadState::kNative);
   art::ScopedSuspendAll ssa("Final installation of redefined Classes!", /*long_suspend*/true);
+  // Allocate the obsolete methods of all the classes before updating any of them.
+  FindAndAllocateObsoleteMethods(holder);
   for (RedefinitionDataIter data = holder.begin(); data != holder.end(); ++data) {
     art::ScopedAssertNoThreadSuspension nts("Updating runtime objects for redefinition");
     ClassRedefinition& redef = data.GetRedefinition();
@@ -1352,11 +1370,10 @@ jvmtiError Redefiner::Run() {
       ClassLoaderHelper::UpdateJavaDexFile(data.GetJavaDexFile(), data.GetNewDexFileCookie());
     }
     art::mirror::Class* klass = data.GetMirrorClass();
-    // TODO Rewrite so we don't do a stack walk for each and every class.
-    redef.FindAndAllocateObsoleteMethods(klass);
     redef.UpdateClass(klass, data.GetNewDexCache(), data.GetOriginalDexFile());
     redef.UnregisterJvmtiBreakpoints();
   }
+  NotifyJitOfRedefinedMethods(holder);
   RestoreObsoleteMethodMapsIfUnneeded(holder);
   // TODO We should check for if any of the redefined methods are intrinsic methods here and, if any
   // are, force a full-world deoptimization before finishing redefinition. If we don't do this then
@@ -1402,13 +1419,6 @@ void Redefiner::ClassRedefinition::UpdateMethods(art::ObjPtr<art::mirror::Class>
     method.SetCodeItemOffset(dex_file_->FindCodeItemOffset(class_def, dex_method_idx));
     // Clear all the intrinsics related flags.
     method.SetNotIntrinsic();
-    // Notify the jit that this method is redefined.
-    art::jit::Jit* jit = driver_->runtime_->GetJit();
-    // Non-invokable methods don't have any JIT data associated with them so we don't need to tell
-    // the jit about them.
-    if (jit != nullptr && method.IsInvokable()) {
-      jit->GetCodeCache()->NotifyMethodRedefined(&method);
-    }
   }
 }
 
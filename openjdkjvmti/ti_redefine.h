@@ -65,6 +65,7 @@
 
 namespace openjdkjvmti {
 
+struct CallbackCtx;
 class RedefinitionDataHolder;
 class RedefinitionDataIter;
 
@@ -148,7 +149,8 @@ class Redefiner {
         /*out*/RedefinitionDataIter* cur_data)
           REQUIRES_SHARED(art::Locks::mutator_lock_);
 
-    void FindAndAllocateObsoleteMethods(art::mirror::Class* art_klass)
+    // Adds the methods of the class which could become obsolete to `ctx`.
+    void CollectObsoleteMethods(art::mirror::Class* art_klass, /*out*/CallbackCtx* ctx)
         REQUIRES(art::Locks::mutator_lock_);
 
     // Checks that the dex file contains only the single expected class and that the top-level class
@@ -245,6 +247,13 @@ class Redefiner {
       REQUIRES_SHARED(art::Locks::mutator_lock_);
   bool FinishAllRemainingAllocations(RedefinitionDataHolder& holder)
       REQUIRES_SHARED(art::Locks::mutator_lock_);
+  // Creates the obsolete methods for the frames of redefined methods on thread stacks, with a
+  // single walk of the stacks for all the redefined classes.
+  void FindAndAllocateObsoleteMethods(RedefinitionDataHolder& holder)
+      REQUIRES(art::Locks::mutator_lock_);
+  // Removes the JIT code of the methods of all the redefined classes.
+  void NotifyJitOfRedefinedMethods(RedefinitionDataHolder& holder)
+      REQUIRES(art::Locks::mutator_lock_);
   void ReleaseAllDexFiles() REQUIRES_SHARED(art::Locks::mutator_lock_);
   void UnregisterAllBreakpoints() REQUIRES_SHARED(art::Locks::mutator_lock_);
   // Restores the old obsolete methods maps if it turns out they weren't needed (ie there were no
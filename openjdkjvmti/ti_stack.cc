@@ -321,16 +321,21 @@ struct GetAllStackTracesVectorClosure : public art::Closure {
   Data* data;
 };
 
-template <typename Data>
-static void RunCheckpointAndWait(Data* data, size_t max_frame_count) {
-  GetAllStackTracesVectorClosure<Data> closure(max_frame_count, data);
-  size_t barrier_count = art::Runtime::Current()->GetThreadList()->RunCheckpoint(&closure, nullptr);
+template <typename Closure>
+static void RunCheckpointClosureAndWait(Closure* closure) {
+  size_t barrier_count = art::Runtime::Current()->GetThreadList()->RunCheckpoint(closure, nullptr);
   if (barrier_count == 0) {
     return;
   }
   art::Thread* self = art::Thread::Current();
   art::ScopedThreadStateChange tsc(self, art::ThreadState::kWaitingForCheckPointsToRun);
-  closure.barrier.Increment(self, barrier_count);
+  closure->barrier.Increment(self, barrier_count);
+}
+
+template <typename Data>
+static void RunCheckpointAndWait(Data* data, size_t max_frame_count) {
+  GetAllStackTracesVectorClosure<Data> closure(max_frame_count, data);
+  RunCheckpointClosureAndWait(&closure);
 }
 
 jvmtiError StackUtil::GetAllStackTraces(jvmtiEnv* env,
@@ -651,6 +656,97 @@ jvmtiError StackUtil::GetThreadListStackTraces(jvmtiEnv* env,
   return ERR(NONE);
 }
 
+// Collects the stack traces of the selected threads straight into the caller's buffer. Every
+// thread writes only to the slots of the list entries it matches, so no locking is needed.
+struct GetCompactStackTracesClosure : public art::Closure {
+  GetCompactStackTracesClosure(const std::vector<art::Handle<art::mirror::Object>>& handles_in,
+                               size_t stop,
+                               jvmtiFrameInfo* frame_buffer_in,
+                               jint* frame_counts_in)
+      : barrier(0),
+        handles(handles_in),
+        stop_input(stop),
+        frame_buffer(frame_buffer_in),
+        frame_counts(frame_counts_in) {}
+
+  void Run(art::Thread* thread) OVERRIDE REQUIRES_SHARED(art::Locks::mutator_lock_) {
+    art::Thread* self = art::Thread::Current();
+    Work(thread);
+    barrier.Pass(self);
+  }
+
+  void Work(art::Thread* thread) REQUIRES_SHARED(art::Locks::mutator_lock_) {
+    // Skip threads that are still starting.
+    if (thread->IsStillStarting()) {
+      return;
+    }
+    art::ObjPtr<art::mirror::Object> peer = thread->GetPeerFromOtherThread();
+    for (size_t index = 0; index != handles.size(); ++index) {
+      if (peer != handles[index].Get()) {
+        continue;
+      }
+      jvmtiFrameInfo* thread_frames = frame_buffer + index * stop_input;
+      size_t count = 0;
+      auto frames_fn = [&](jvmtiFrameInfo info) {
+        thread_frames[count] = info;
+        ++count;
+      };
+      auto visitor = MakeStackTraceVisitor(thread, 0u, stop_input, frames_fn);
+      visitor.WalkStack(/* include_transitions */ false);
+      frame_counts[index] = static_cast<jint>(count);
+    }
+  }
+
+  art::Barrier barrier;
+  const std::vector<art::Handle<art::mirror::Object>>& handles;
+  const size_t stop_input;
+  jvmtiFrameInfo* frame_buffer;
+  jint* frame_counts;
+};
+
+jvmtiError StackUtil::GetThreadListStackTracesCompact(jvmtiEnv* env ATTRIBUTE_UNUSED,
+                                                      jint thread_count,
+                                                      const jthread* thread_list,
+                                                      jint max_frame_count,
+                                                      jvmtiFrameInfo* frame_buffer,
+                                                      jint* frame_counts) {
+  if (max_frame_count <= 0 || thread_count < 0) {
+    return ERR(ILLEGAL_ARGUMENT);
+  }
+  if (thread_count == 0) {
+    return ERR(NONE);
+  }
+  if (thread_list == nullptr || frame_buffer == nullptr || frame_counts == nullptr) {
+    return ERR(NULL_POINTER);
+  }
+
+  art::Thread* current = art::Thread::Current();
+  art::ScopedObjectAccess soa(current);      // Now we know we have the shared lock.
+
+  // Decode all threads to raw pointers. Put them into a handle scope to avoid any moving GC bugs.
+  art::VariableSizedHandleScope hs(current);
+  std::vector<art::Handle<art::mirror::Object>> handles;
+  handles.reserve(static_cast<size_t>(thread_count));
+  for (jint i = 0; i != thread_count; ++i) {
+    if (thread_list[i] == nullptr) {
+      return ERR(INVALID_THREAD);
+    }
+    if (!soa.Env()->IsInstanceOf(thread_list[i], art::WellKnownClasses::java_lang_Thread)) {
+      return ERR(INVALID_THREAD);
+    }
+    handles.push_back(hs.NewHandle(soa.Decode<art::mirror::Object>(thread_list[i])));
+    // Threads which are not alive keep a count of -1.
+    frame_counts[i] = -1;
+  }
+
+  GetCompactStackTracesClosure closure(handles,
+                                       static_cast<size_t>(max_frame_count),
+                                       frame_buffer,
+                                       frame_counts);
+  RunCheckpointClosureAndWait(&closure);
+  return ERR(NONE);
+}
+
 // Walks up the stack counting Java frames. This is not StackVisitor::ComputeNumFrames, as
 // runtime methods and transitions must not be counted.
 struct GetFrameCountVisitor : public art::StackVisitor {
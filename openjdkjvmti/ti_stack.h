@@ -70,6 +70,17 @@ class StackUtil {
                                              jint max_frame_count,
                                              jvmtiStackInfo** stack_info_ptr);
 
+  // Extension which collects the stack traces of the given threads with a single checkpoint into
+  // the caller provided 'frame_buffer' of 'thread_count * max_frame_count' frames. The frames of
+  // thread i start at 'frame_buffer + i * max_frame_count' and their number is stored in
+  // 'frame_counts[i]', which is -1 if the thread is not alive.
+  static jvmtiError GetThreadListStackTracesCompact(jvmtiEnv* env,
+                                                    jint thread_count,
+                                                    const jthread* thread_list,
+                                                    jint max_frame_count,
+                                                    jvmtiFrameInfo* frame_buffer,
+                                                    jint* frame_counts);
+
   static jvmtiError GetOwnedMonitorStackDepthInfo(jvmtiEnv* env,
                                                   jthread thread,
                                                   jint* info_cnt_ptr,
@@ -26,19 +26,55 @@ namespace art {
 
 using Hotness = ProfileCompilationInfo::MethodHotness;
 
-void GenerateBootImageProfile(
+BootImageProfileGenerator::BootImageProfileGenerator(
     const std::vector<std::unique_ptr<const DexFile>>& dex_files,
-    const std::vector<std::unique_ptr<const ProfileCompilationInfo>>& profiles,
     const BootImageOptions& options,
-    bool verbose,
-    ProfileCompilationInfo* out_profile) {
-  for (const std::unique_ptr<const ProfileCompilationInfo>& profile : profiles) {
-    // Avoid merging classes since we may want to only add classes that fit a certain criteria.
-    // If we merged the classes, every single class in each profile would be in the out_profile,
-    // but we want to only included classes that are in at least a few profiles.
-    out_profile->MergeWith(*profile, /*merge_classes*/ false);
+    ProfileCompilationInfo* out_profile)
+    : dex_files_(dex_files),
+      options_(options),
+      out_profile_(out_profile) {
+  for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+    method_counts_.emplace_back(dex_file->NumMethodIds(), 0u);
+    class_counts_.emplace_back(dex_file->NumTypeIds(), 0u);
   }
+}
+
+void BootImageProfileGenerator::AddProfile(const ProfileCompilationInfo& profile) {
+  // Avoid merging classes since we may want to only add classes that fit a certain criteria.
+  // If we merged the classes, every single class in each profile would be in the out_profile,
+  // but we want to only included classes that are in at least a few profiles.
+  out_profile_->MergeWith(profile, /*merge_classes*/ false);
 
+  for (size_t i = 0; i < dex_files_.size(); ++i) {
+    const DexFile* dex_file = dex_files_[i].get();
+    std::set<dex::TypeIndex> classes;
+    std::set<uint16_t> methods;
+    std::set<uint16_t> startup_methods;
+    std::set<uint16_t> post_startup_methods;
+    // Only visit what the profile contains rather than all the methods of the dex file.
+    if (!profile.GetClassesAndMethods(*dex_file,
+                                      &classes,
+                                      &methods,
+                                      &startup_methods,
+                                      &post_startup_methods)) {
+      continue;
+    }
+    methods.insert(startup_methods.begin(), startup_methods.end());
+    methods.insert(post_startup_methods.begin(), post_startup_methods.end());
+    for (uint16_t method_index : methods) {
+      MethodReference ref(dex_file, method_index);
+      ++method_counts_[i][method_index];
+      out_profile_->AddMethodHotness(ref, profile.GetMethodHotness(ref));
+      // Classes are inferred from the method samples too.
+      classes.insert(dex_file->GetMethodId(method_index).class_idx_);
+    }
+    for (dex::TypeIndex type_index : classes) {
+      ++class_counts_[i][type_index.index_];
+    }
+  }
+}
+
+void BootImageProfileGenerator::Finish(bool verbose) {
   // Image classes that were added because they are commonly used.
   size_t class_count = 0;
   // Image classes that were only added because they were clean.
@@ -48,34 +84,22 @@ void GenerateBootImageProfile(
   // Total dirty classes.
   size_t dirty_count = 0;
 
-  for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
-    // Inferred classes are classes inferred from method samples.
-    std::set<std::pair<const ProfileCompilationInfo*, dex::TypeIndex>> inferred_classes;
+  for (size_t dex_index = 0; dex_index < dex_files_.size(); ++dex_index) {
+    const DexFile* dex_file = dex_files_[dex_index].get();
     for (size_t i = 0; i < dex_file->NumMethodIds(); ++i) {
-      MethodReference ref(dex_file.get(), i);
-      // This counter is how many profiles contain the method as sampled or hot.
-      size_t counter = 0;
-      for (const std::unique_ptr<const ProfileCompilationInfo>& profile : profiles) {
-        Hotness hotness = profile->GetMethodHotness(ref);
-        if (hotness.IsInProfile()) {
-          ++counter;
-          out_profile->AddMethodHotness(ref, hotness);
-          inferred_classes.emplace(profile.get(), ref.GetMethodId().class_idx_);
-        }
-      }
       // If the counter is greater or equal to the compile threshold, mark the method as hot.
       // Note that all hot methods are also marked as hot in the out profile during the merging
       // process.
-      if (counter >= options.compiled_method_threshold) {
+      if (method_counts_[dex_index][i] >= options_.compiled_method_threshold) {
         Hotness hotness;
         hotness.AddFlag(Hotness::kFlagHot);
-        out_profile->AddMethodHotness(ref, hotness);
+        out_profile_->AddMethodHotness(MethodReference(dex_file, i), hotness);
       }
     }
     // Walk all of the classes and add them to the profile if they meet the requirements.
     for (size_t i = 0; i < dex_file->NumClassDefs(); ++i) {
       const DexFile::ClassDef& class_def = dex_file->GetClassDef(i);
-      TypeReference ref(dex_file.get(), class_def.class_idx_);
+      TypeReference ref(dex_file, class_def.class_idx_);
       bool is_clean = true;
       const uint8_t* class_data = dex_file->GetClassData(class_def);
       if (class_data != nullptr) {
@@ -107,23 +131,16 @@ void GenerateBootImageProfile(
       }
       ++(is_clean ? clean_count : dirty_count);
       // This counter is how many profiles contain the class.
-      size_t counter = 0;
-      for (const std::unique_ptr<const ProfileCompilationInfo>& profile : profiles) {
-        auto it = inferred_classes.find(std::make_pair(profile.get(), ref.TypeIndex()));
-        if (it != inferred_classes.end() ||
-            profile->ContainsClass(*ref.dex_file, ref.TypeIndex())) {
-          ++counter;
-        }
-      }
+      uint32_t counter = class_counts_[dex_index][ref.TypeIndex().index_];
       if (counter == 0) {
         continue;
       }
-      if (counter >= options.image_class_theshold) {
+      if (counter >= options_.image_class_theshold) {
         ++class_count;
-        out_profile->AddClassForDex(ref);
-      } else if (is_clean && counter >= options.image_class_clean_theshold) {
+        out_profile_->AddClassForDex(ref);
+      } else if (is_clean && counter >= options_.image_class_clean_theshold) {
         ++clean_class_count;
-        out_profile->AddClassForDex(ref);
+        out_profile_->AddClassForDex(ref);
       }
     }
   }
@@ -134,4 +151,17 @@ void GenerateBootImageProfile(
   }
 }
 
+void GenerateBootImageProfile(
+    const std::vector<std::unique_ptr<const DexFile>>& dex_files,
+    const std::vector<std::unique_ptr<const ProfileCompilationInfo>>& profiles,
+    const BootImageOptions& options,
+    bool verbose,
+    ProfileCompilationInfo* out_profile) {
+  BootImageProfileGenerator generator(dex_files, options, out_profile);
+  for (const std::unique_ptr<const ProfileCompilationInfo>& profile : profiles) {
+    generator.AddProfile(*profile);
+  }
+  generator.Finish(verbose);
+}
+
 }  // namespace art
@@ -41,6 +41,33 @@ struct BootImageOptions {
   uint32_t compiled_method_threshold = std::numeric_limits<uint32_t>::max();
 };
 
+// Generates a boot profile from profiles added one at a time, so that they do not need to be
+// loaded together. Only the occurrence counts of the methods and classes of the dex files are
+// kept, with exact counters whose size only depends on the dex files.
+class BootImageProfileGenerator {
+ public:
+  BootImageProfileGenerator(const std::vector<std::unique_ptr<const DexFile>>& dex_files,
+                            const BootImageOptions& options,
+                            ProfileCompilationInfo* out_profile);
+
+  // Merges the methods of `profile` into the out profile and counts its methods and classes.
+  // The profile is not referenced afterwards.
+  void AddProfile(const ProfileCompilationInfo& profile);
+
+  // Adds the methods and classes which meet the options to the out profile.
+  void Finish(bool verbose);
+
+ private:
+  const std::vector<std::unique_ptr<const DexFile>>& dex_files_;
+  const BootImageOptions& options_;
+  ProfileCompilationInfo* const out_profile_;
+
+  // For each dex file, how many profiles contain each method as sampled or hot, and how many
+  // contain each type as a class or through one of its methods.
+  std::vector<std::vector<uint32_t>> method_counts_;
+  std::vector<std::vector<uint32_t>> class_counts_;
+};
+
 // Merge a bunch of profiles together to generate a boot profile. Classes and methods are added
 // to the out_profile if they meet the options.
 void GenerateBootImageProfile(
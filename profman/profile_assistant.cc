@@ -16,6 +16,9 @@
 
 #include "profile_assistant.h"
 
+#include <memory>
+#include <thread>
+
 #include "base/unix_file/fd_file.h"
 #include "os.h"
 
@@ -29,9 +32,89 @@ static constexpr const uint32_t kMinNewClassesForCompilation = 50;
 static constexpr const uint32_t kMinNewClassesPercentChangeForCompilation = 2;
 
 
+bool ProfileAssistant::MergeProfiles(const std::vector<ScopedFlock>& profile_files,
+                                     size_t begin,
+                                     size_t end,
+                                     ProfileCompilationInfo* info) {
+  // Only keep one of the profiles loaded at a time, besides the merge.
+  for (size_t i = begin; i < end; i++) {
+    ProfileCompilationInfo cur_info;
+    if (!cur_info.Load(profile_files[i]->Fd())) {
+      LOG(WARNING) << "Could not load profile file at index " << i;
+      return false;
+    }
+    if (!info->MergeWith(cur_info)) {
+      LOG(WARNING) << "Could not merge profile file at index " << i;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ProfileAssistant::MergeProfilesInParallel(const std::vector<ScopedFlock>& profile_files,
+                                               uint32_t merge_threads,
+                                               ProfileCompilationInfo* info) {
+  size_t number_of_partials = std::min<size_t>(merge_threads, profile_files.size());
+  if (number_of_partials <= 1u) {
+    return MergeProfiles(profile_files, 0u, profile_files.size(), info);
+  }
+
+  // Each thread merges a contiguous range of the profiles, and the partial merges are then
+  // combined in a tree, each merge absorbing the following one. Keeping the order of the
+  // profiles gives the dex files the same indexes as the sequential merge.
+  std::vector<std::unique_ptr<ProfileCompilationInfo>> partials(number_of_partials);
+  std::unique_ptr<bool[]> success(new bool[number_of_partials]);
+  std::vector<std::thread> threads;
+  threads.reserve(number_of_partials);
+  for (size_t i = 0; i != number_of_partials; ++i) {
+    partials[i].reset(new ProfileCompilationInfo());
+    size_t begin = (profile_files.size() * i) / number_of_partials;
+    size_t end = (profile_files.size() * (i + 1u)) / number_of_partials;
+    threads.emplace_back([&profile_files, &partials, &success, i, begin, end]() {
+      success[i] = MergeProfiles(profile_files, begin, end, partials[i].get());
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  for (size_t i = 0; i != number_of_partials; ++i) {
+    if (!success[i]) {
+      return false;
+    }
+  }
+
+  for (size_t stride = 1u; stride < number_of_partials; stride *= 2u) {
+    for (size_t i = 0; i + stride < number_of_partials; i += 2u * stride) {
+      threads.emplace_back([&partials, &success, i, stride]() {
+        success[i] = partials[i]->MergeWith(*partials[i + stride]);
+        // The absorbed partial merge is no longer needed.
+        partials[i + stride].reset();
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    threads.clear();
+    for (size_t i = 0; i + stride < number_of_partials; i += 2u * stride) {
+      if (!success[i]) {
+        LOG(WARNING) << "Could not merge the partial merges of the profiles";
+        return false;
+      }
+    }
+  }
+
+  if (!info->MergeWith(*partials[0])) {
+    LOG(WARNING) << "Could not merge the profiles with the reference profile";
+    return false;
+  }
+  return true;
+}
+
 ProfileAssistant::ProcessingResult ProfileAssistant::ProcessProfilesInternal(
         const std::vector<ScopedFlock>& profile_files,
-        const ScopedFlock& reference_profile_file) {
+        const ScopedFlock& reference_profile_file,
+        uint32_t merge_threads) {
   DCHECK(!profile_files.empty());
 
   ProfileCompilationInfo info;
@@ -46,16 +129,8 @@ ProfileAssistant::ProcessingResult ProfileAssistant::ProcessProfilesInternal(
   uint32_t number_of_classes = info.GetNumberOfResolvedClasses();
 
   // Merge all current profiles.
-  for (size_t i = 0; i < profile_files.size(); i++) {
-    ProfileCompilationInfo cur_info;
-    if (!cur_info.Load(profile_files[i]->Fd())) {
-      LOG(WARNING) << "Could not load profile file at index " << i;
-      return kErrorBadProfiles;
-    }
-    if (!info.MergeWith(cur_info)) {
-      LOG(WARNING) << "Could not merge profile file at index " << i;
-      return kErrorBadProfiles;
-    }
+  if (!MergeProfilesInParallel(profile_files, merge_threads, &info)) {
+    return kErrorBadProfiles;
   }
 
   uint32_t min_change_in_methods_for_compilation = std::max(
@@ -122,7 +197,8 @@ class ScopedFlockList {
 
 ProfileAssistant::ProcessingResult ProfileAssistant::ProcessProfiles(
         const std::vector<int>& profile_files_fd,
-        int reference_profile_file_fd) {
+        int reference_profile_file_fd,
+        uint32_t merge_threads) {
   DCHECK_GE(reference_profile_file_fd, 0);
 
   std::string error;
@@ -143,12 +219,13 @@ ProfileAssistant::ProcessingResult ProfileAssistant::ProcessProfiles(
     return kErrorCannotLock;
   }
 
-  return ProcessProfilesInternal(profile_files.Get(), reference_profile_file);
+  return ProcessProfilesInternal(profile_files.Get(), reference_profile_file, merge_threads);
 }
 
 ProfileAssistant::ProcessingResult ProfileAssistant::ProcessProfiles(
         const std::vector<std::string>& profile_files,
-        const std::string& reference_profile_file) {
+        const std::string& reference_profile_file,
+        uint32_t merge_threads) {
   std::string error;
 
   ScopedFlockList profile_files_list(profile_files.size());
@@ -164,7 +241,9 @@ ProfileAssistant::ProcessingResult ProfileAssistant::ProcessProfiles(
     return kErrorCannotLock;
   }
 
-  return ProcessProfilesInternal(profile_files_list.Get(), locked_reference_profile_file);
+  return ProcessProfilesInternal(profile_files_list.Get(),
+                                 locked_reference_profile_file,
+                                 merge_threads);
 }
 
 }  // namespace art
@@ -51,18 +51,37 @@ class ProfileAssistant {
   // merge of the current profiles and the reference one is insignificant. In
   // this case no file will be updated.
   //
+  // With more than one `merge_threads`, the current profiles are split among that many threads,
+  // each loading its profiles one at a time into a partial merge, and the partial merges are
+  // then combined pairwise. The result is the same as with the sequential merge.
+  //
   static ProcessingResult ProcessProfiles(
       const std::vector<std::string>& profile_files,
-      const std::string& reference_profile_file);
+      const std::string& reference_profile_file,
+      uint32_t merge_threads = 1u);
 
   static ProcessingResult ProcessProfiles(
       const std::vector<int>& profile_files_fd_,
-      int reference_profile_file_fd);
+      int reference_profile_file_fd,
+      uint32_t merge_threads = 1u);
 
  private:
   static ProcessingResult ProcessProfilesInternal(
       const std::vector<ScopedFlock>& profile_files,
-      const ScopedFlock& reference_profile_file);
+      const ScopedFlock& reference_profile_file,
+      uint32_t merge_threads);
+
+  // Merges the profiles in [begin, end) into `info`. Returns false if one of them cannot be
+  // loaded or merged.
+  static bool MergeProfiles(const std::vector<ScopedFlock>& profile_files,
+                            size_t begin,
+                            size_t end,
+                            ProfileCompilationInfo* info);
+
+  // Merges all the profiles into `info` with `merge_threads` threads.
+  static bool MergeProfilesInParallel(const std::vector<ScopedFlock>& profile_files,
+                                      uint32_t merge_threads,
+                                      ProfileCompilationInfo* info);
 
   DISALLOW_COPY_AND_ASSIGN(ProfileAssistant);
 };
@@ -173,7 +173,9 @@ class ProfileAssistantTest : public CommonRuntimeTest {
   }
 
   // Runs test with given arguments.
-  int ProcessProfiles(const std::vector<int>& profiles_fd, int reference_profile_fd) {
+  int ProcessProfiles(const std::vector<int>& profiles_fd,
+                      int reference_profile_fd,
+                      uint32_t merge_threads = 1u) {
     std::string profman_cmd = GetProfmanCmd();
     std::vector<std::string> argv_str;
     argv_str.push_back(profman_cmd);
@@ -181,6 +183,7 @@ class ProfileAssistantTest : public CommonRuntimeTest {
       argv_str.push_back("--profile-file-fd=" + std::to_string(profiles_fd[k]));
     }
     argv_str.push_back("--reference-profile-file-fd=" + std::to_string(reference_profile_fd));
+    argv_str.push_back("--merge-threads=" + std::to_string(merge_threads));
 
     std::string error;
     return ExecAndReturnCode(argv_str, &error);
@@ -991,6 +994,58 @@ TEST_F(ProfileAssistantTest, MergeProfilesWithDifferentDexOrder) {
   CheckProfileInfo(profile1, info1);
 }
 
+TEST_F(ProfileAssistantTest, MergeProfilesWithThreads) {
+  static constexpr size_t kNumberOfProfiles = 5;
+  ScratchFile profiles[kNumberOfProfiles];
+  ScratchFile reference_profile;
+
+  std::vector<int> profile_fds;
+  ProfileCompilationInfo infos[kNumberOfProfiles];
+  for (size_t i = 0; i != kNumberOfProfiles; ++i) {
+    profile_fds.push_back(GetFd(profiles[i]));
+    // Every other profile shares its dex files with the previous one.
+    SetupProfile("p" + std::to_string(i / 2),
+                 i / 2 + 1,
+                 /* number_of_methods */ 60,
+                 /* number_of_classes */ 10,
+                 profiles[i],
+                 &infos[i],
+                 /* start_method_index */ 30 * i,
+                 /* reverse_dex_write_order */ (i % 2) != 0);
+  }
+  int reference_profile_fd = GetFd(reference_profile);
+
+  // More threads than profiles only use one thread per profile.
+  ASSERT_EQ(ProfileAssistant::kCompile,
+            ProcessProfiles(profile_fds, reference_profile_fd, /* merge_threads */ 8u));
+
+  // The result is the sequential merge of the inputs, with the same dex file order.
+  ProfileCompilationInfo result;
+  ASSERT_TRUE(reference_profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(result.Load(reference_profile_fd));
+  ProfileCompilationInfo expected;
+  for (size_t i = 0; i != kNumberOfProfiles; ++i) {
+    ASSERT_TRUE(expected.MergeWith(infos[i]));
+  }
+  ASSERT_TRUE(expected.Equals(result));
+
+  // Fewer threads than profiles, on top of the previous result.
+  for (size_t i = 0; i != kNumberOfProfiles; ++i) {
+    ASSERT_TRUE(profiles[i].GetFile()->ResetOffset());
+  }
+  ASSERT_TRUE(reference_profile.GetFile()->ResetOffset());
+  ASSERT_EQ(ProfileAssistant::kSkipCompilation,
+            ProcessProfiles(profile_fds, reference_profile_fd, /* merge_threads */ 2u));
+  ProfileCompilationInfo unchanged_result;
+  ASSERT_TRUE(reference_profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(unchanged_result.Load(reference_profile_fd));
+  ASSERT_TRUE(expected.Equals(unchanged_result));
+
+  for (size_t i = 0; i != kNumberOfProfiles; ++i) {
+    CheckProfileInfo(profiles[i], infos[i]);
+  }
+}
+
 TEST_F(ProfileAssistantTest, TestProfileCreateWithInvalidData) {
   // Create the profile content.
   std::vector<std::string> profile_methods = {
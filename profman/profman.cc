@@ -116,6 +116,10 @@ NO_RETURN static void Usage(const char *fmt, ...) {
   UsageError("      accepts a file descriptor. Cannot be used together with");
   UsageError("      --reference-profile-file.");
   UsageError("");
+  UsageError("  --merge-threads=<number>: number of threads merging the profile files.");
+  UsageError("      Each thread loads its share of the profiles one at a time, so that only the");
+  UsageError("      partial merges are kept in memory. Default is 1.");
+  UsageError("");
   UsageError("  --generate-test-profile=<filename>: generates a random profile file for testing.");
   UsageError("  --generate-test-profile-num-dex=<number>: number of dex files that should be");
   UsageError("      included in the generated profile. Defaults to 20.");
@@ -180,6 +184,7 @@ class ProfMan FINAL {
       dump_classes_and_methods_(false),
       generate_boot_image_profile_(false),
       dump_output_to_fd_(kInvalidFd),
+      merge_threads_(1u),
       test_profile_num_dex_(kDefaultTestProfileNumDex),
       test_profile_method_percerntage_(kDefaultTestProfileMethodPercentage),
       test_profile_class_percentage_(kDefaultTestProfileClassPercentage),
@@ -243,6 +248,11 @@ class ProfMan FINAL {
         reference_profile_file_ = option.substr(strlen("--reference-profile-file=")).ToString();
       } else if (option.starts_with("--reference-profile-file-fd=")) {
         ParseUintOption(option, "--reference-profile-file-fd", &reference_profile_file_fd_, Usage);
+      } else if (option.starts_with("--merge-threads=")) {
+        ParseUintOption(option, "--merge-threads", &merge_threads_, Usage);
+        if (merge_threads_ == 0u) {
+          Usage("--merge-threads should be at least 1");
+        }
       } else if (option.starts_with("--dex-location=")) {
         dex_locations_.push_back(option.substr(strlen("--dex-location=")).ToString());
       } else if (option.starts_with("--apk-fd=")) {
@@ -304,10 +314,14 @@ class ProfMan FINAL {
       // The file doesn't need to be flushed here (ProcessProfiles will do it)
       // so don't check the usage.
       File file(reference_profile_file_fd_, false);
-      result = ProfileAssistant::ProcessProfiles(profile_files_fd_, reference_profile_file_fd_);
+      result = ProfileAssistant::ProcessProfiles(profile_files_fd_,
+                                                 reference_profile_file_fd_,
+                                                 merge_threads_);
       CloseAllFds(profile_files_fd_, "profile_files_fd_");
     } else {
-      result = ProfileAssistant::ProcessProfiles(profile_files_, reference_profile_file_);
+      result = ProfileAssistant::ProcessProfiles(profile_files_,
+                                                 reference_profile_file_,
+                                                 merge_threads_);
     }
     return result;
   }
@@ -981,15 +995,16 @@ class ProfMan FINAL {
       PLOG(ERROR) << "Expected dex files for creating boot profile";
       return -2;
     }
-    // Open the input profiles.
-    std::vector<std::unique_ptr<const ProfileCompilationInfo>> profiles;
+    // Load the input profiles one at a time, only their counts are needed afterwards.
+    ProfileCompilationInfo out_profile;
+    BootImageProfileGenerator generator(dex_files, boot_image_options_, &out_profile);
     if (!profile_files_fd_.empty()) {
       for (int profile_file_fd : profile_files_fd_) {
         std::unique_ptr<const ProfileCompilationInfo> profile(LoadProfile("", profile_file_fd));
         if (profile == nullptr) {
           return -3;
         }
-        profiles.emplace_back(std::move(profile));
+        generator.AddProfile(*profile);
       }
     }
     if (!profile_files_.empty()) {
@@ -998,15 +1013,10 @@ class ProfMan FINAL {
         if (profile == nullptr) {
           return -4;
         }
-        profiles.emplace_back(std::move(profile));
+        generator.AddProfile(*profile);
       }
     }
-    ProfileCompilationInfo out_profile;
-    GenerateBootImageProfile(dex_files,
-                             profiles,
-                             boot_image_options_,
-                             VLOG_IS_ON(profiler),
-                             &out_profile);
+    generator.Finish(VLOG_IS_ON(profiler));
     out_profile.Save(reference_fd);
     close(reference_fd);
     return 0;
@@ -1104,6 +1114,7 @@ class ProfMan FINAL {
   bool generate_boot_image_profile_;
   int dump_output_to_fd_;
   BootImageOptions boot_image_options_;
+  uint32_t merge_threads_;
   std::string test_profile_;
   std::string create_profile_from_file_;
   uint16_t test_profile_num_dex_;
@@ -34,6 +34,12 @@ namespace art {
 // Cast entrypoints.
 extern "C" size_t artInstanceOfFromCode(mirror::Object* obj, mirror::Class* ref_class);
 
+// JIT entrypoints.
+extern "C" void art_quick_compile_optimized(ArtMethod*, Thread*);
+
+// String entrypoints.
+extern "C" void* art_quick_string_builder_append(uint32_t format);
+
 // Read barrier entrypoints.
 // art_quick_read_barrier_mark_regX uses an non-standard calling
 // convention: it expects its input in register X and returns its
@@ -192,6 +198,12 @@ void InitEntryPoints(JniEntryPoints* jpoints, QuickEntryPoints* qpoints) {
   UpdateReadBarrierEntrypoints(qpoints, /*is_active*/ false);
   qpoints->pReadBarrierSlow = artReadBarrierSlow;
   qpoints->pReadBarrierForRootSlow = artReadBarrierForRootSlow;
+
+  // JIT.
+  qpoints->pCompileOptimized = art_quick_compile_optimized;
+
+  // String.
+  qpoints->pStringBuilderAppend = art_quick_string_builder_append;
 }
 
 }  // namespace art
@@ -65,6 +65,8 @@ class X86InstructionSetFeatures : public InstructionSetFeatures {
 
   bool HasSSE4_1() const { return has_SSE4_1_; }
 
+  bool HasSSE4_2() const { return has_SSE4_2_; }
+
   bool HasPopCnt() const { return has_POPCNT_; }
 
  protected:
@@ -32,6 +32,12 @@ namespace art {
 // Cast entrypoints.
 extern "C" size_t art_quick_instance_of(mirror::Object* obj, mirror::Class* ref_class);
 
+// JIT entrypoints.
+extern "C" void art_quick_compile_optimized(ArtMethod*, Thread*);
+
+// String entrypoints.
+extern "C" void* art_quick_string_builder_append(uint32_t format);
+
 // Read barrier entrypoints.
 // art_quick_read_barrier_mark_regX uses an non-standard calling
 // convention: it expects its input in register X and returns its
@@ -138,6 +144,12 @@ void InitEntryPoints(JniEntryPoints* jpoints, QuickEntryPoints* qpoints) {
   qpoints->pReadBarrierMarkReg29 = nullptr;
   qpoints->pReadBarrierSlow = art_quick_read_barrier_slow;
   qpoints->pReadBarrierForRootSlow = art_quick_read_barrier_for_root_slow;
+
+  // JIT.
+  qpoints->pCompileOptimized = art_quick_compile_optimized;
+
+  // String.
+  qpoints->pStringBuilderAppend = art_quick_string_builder_append;
 #endif  // __APPLE__
 }
 
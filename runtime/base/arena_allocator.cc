@@ -95,18 +95,21 @@ const char* const ArenaAllocatorStatsImpl<kCount>::kAllocNames[] = {
   "CHA          ",
   "Scheduler    ",
   "Profile      ",
+  "SBCloner     ",
 };
 
 template <bool kCount>
 ArenaAllocatorStatsImpl<kCount>::ArenaAllocatorStatsImpl()
     : num_allocations_(0u),
-      alloc_stats_(kNumArenaAllocKinds, 0u) {
+      alloc_stats_(kNumArenaAllocKinds, 0u),
+      reuse_stats_(kNumArenaAllocKinds, 0u) {
 }
 
 template <bool kCount>
 void ArenaAllocatorStatsImpl<kCount>::Copy(const ArenaAllocatorStatsImpl& other) {
   num_allocations_ = other.num_allocations_;
   std::copy_n(other.alloc_stats_.begin(), kNumArenaAllocKinds, alloc_stats_.begin());
+  std::copy_n(other.reuse_stats_.begin(), kNumArenaAllocKinds, reuse_stats_.begin());
 }
 
 template <bool kCount>
@@ -115,6 +118,11 @@ void ArenaAllocatorStatsImpl<kCount>::RecordAlloc(size_t bytes, ArenaAllocKind k
   ++num_allocations_;
 }
 
+template <bool kCount>
+void ArenaAllocatorStatsImpl<kCount>::RecordReuse(size_t bytes, ArenaAllocKind kind) {
+  reuse_stats_[kind] += bytes;
+}
+
 template <bool kCount>
 size_t ArenaAllocatorStatsImpl<kCount>::NumAllocations() const {
   return num_allocations_;
@@ -126,6 +134,12 @@ size_t ArenaAllocatorStatsImpl<kCount>::BytesAllocated() const {
   return std::accumulate(alloc_stats_.begin(), alloc_stats_.end(), init);
 }
 
+template <bool kCount>
+size_t ArenaAllocatorStatsImpl<kCount>::BytesReused() const {
+  const size_t init = 0u;  // Initial value of the correct type.
+  return std::accumulate(reuse_stats_.begin(), reuse_stats_.end(), init);
+}
+
 template <bool kCount>
 void ArenaAllocatorStatsImpl<kCount>::Dump(std::ostream& os, const Arena* first,
                                            ssize_t lost_bytes_adjustment) const {
@@ -142,7 +156,7 @@ void ArenaAllocatorStatsImpl<kCount>::Dump(std::ostream& os, const Arena* first,
   lost_bytes += lost_bytes_adjustment;
   const size_t bytes_allocated = BytesAllocated();
   os << " MEM: used: " << bytes_allocated << ", allocated: " << malloc_bytes
-     << ", lost: " << lost_bytes << "\n";
+     << ", lost: " << lost_bytes << ", reused: " << BytesReused() << "\n";
   size_t num_allocations = NumAllocations();
   if (num_allocations != 0) {
     os << "Number of arenas allocated: " << num_arenas << ", Number of allocations: "
@@ -152,8 +166,12 @@ void ArenaAllocatorStatsImpl<kCount>::Dump(std::ostream& os, const Arena* first,
   static_assert(arraysize(kAllocNames) == kNumArenaAllocKinds, "arraysize of kAllocNames");
   for (int i = 0; i < kNumArenaAllocKinds; i++) {
     // Reduce output by listing only allocation kinds that actually have allocations.
-    if (alloc_stats_[i] != 0u) {
-      os << kAllocNames[i] << std::setw(10) << alloc_stats_[i] << "\n";
+    if (alloc_stats_[i] != 0u || reuse_stats_[i] != 0u) {
+      os << kAllocNames[i] << std::setw(10) << alloc_stats_[i];
+      if (reuse_stats_[i] != 0u) {
+        os << ", reused: " << reuse_stats_[i];
+      }
+      os << "\n";
     }
   }
 }
@@ -250,8 +268,8 @@ MemMapArena::MemMapArena(size_t size, bool low_4gb, const char* name) {
   // and we want to be able to use all memory that we actually allocate.
   size = RoundUp(size, kPageSize);
   std::string error_msg;
-  map_.reset(MemMap::MapAnonymous(
-      name, nullptr, size, PROT_READ | PROT_WRITE, low_4gb, false, &error_msg));
+  map_.reset(MemMap::MapAnonymousRecyclable(
+      name, size, PROT_READ | PROT_WRITE, low_4gb, &error_msg));
   CHECK(map_.get() != nullptr) << error_msg;
   memory_ = map_->Begin();
   static_assert(ArenaAllocator::kArenaAlignment <= kPageSize,
@@ -281,9 +299,13 @@ void Arena::Reset() {
 ArenaPool::ArenaPool(bool use_malloc, bool low_4gb, const char* name)
     : use_malloc_(use_malloc),
       lock_("Arena pool lock", kArenaPoolLock),
-      free_arenas_(nullptr),
+      free_arenas_(),
+      thread_caches_bytes_allocated_(0u),
       low_4gb_(low_4gb),
       name_(name) {
+  for (Atomic<Arena*>& cache : thread_caches_) {
+    cache.StoreRelaxed(nullptr);
+  }
   if (low_4gb) {
     CHECK(!use_malloc) << "low4gb must use map implementation";
   }
@@ -296,11 +318,82 @@ ArenaPool::~ArenaPool() {
   ReclaimMemory();
 }
 
+Atomic<Arena*>* ArenaPool::GetThreadCache(Thread* self) {
+  if (self == nullptr || self->GetThreadId() >= kMaxThreadCaches) {
+    return nullptr;
+  }
+  return &thread_caches_[self->GetThreadId()];
+}
+
+Arena* ArenaPool::TakeThreadCache(Atomic<Arena*>* cache) {
+  Arena* first = cache->ExchangeRelaxed(nullptr);
+  // Pairs with the release store of the thread which filled the cache.
+  QuasiAtomic::ThreadFenceAcquire();
+  for (Arena* arena = first; arena != nullptr; arena = arena->next_) {
+    thread_caches_bytes_allocated_.FetchAndSubSequentiallyConsistent(arena->GetBytesAllocated());
+  }
+  return first;
+}
+
+size_t ArenaPool::FreeArenaBucket(size_t size) {
+  const size_t multiple = size / arena_allocator::kArenaDefaultSize;
+  if (multiple <= 1u) {
+    return 0u;
+  }
+  return std::min(static_cast<size_t>(MostSignificantBit(multiple)), kNumFreeArenaBuckets - 1u);
+}
+
+void ArenaPool::AddFreeArenasLocked(Arena* first) {
+  while (first != nullptr) {
+    Arena* next = first->next_;
+    Arena** bucket = &free_arenas_[FreeArenaBucket(first->Size())];
+    first->next_ = *bucket;
+    *bucket = first;
+    first = next;
+  }
+}
+
+Arena* ArenaPool::TakeFreeArenaLocked(size_t size) {
+  // The bucket of `size` may have a fitting arena, all the arenas of the next ones fit.
+  size_t index = FreeArenaBucket(size);
+  for (; index != kNumFreeArenaBuckets; ++index) {
+    Arena* arena = free_arenas_[index];
+    if (arena != nullptr && LIKELY(arena->Size() >= size)) {
+      free_arenas_[index] = arena->next_;
+      return arena;
+    }
+  }
+  return nullptr;
+}
+
+Arena* ArenaPool::TakeFreeArenaFromThreadCachesLocked(size_t size, Atomic<Arena*>* own_cache) {
+  for (Atomic<Arena*>& cache : thread_caches_) {
+    if (&cache != own_cache && cache.LoadRelaxed() != nullptr) {
+      AddFreeArenasLocked(TakeThreadCache(&cache));
+      Arena* arena = TakeFreeArenaLocked(size);
+      if (arena != nullptr) {
+        return arena;
+      }
+    }
+  }
+  return nullptr;
+}
+
 void ArenaPool::ReclaimMemory() {
-  while (free_arenas_ != nullptr) {
-    Arena* arena = free_arenas_;
-    free_arenas_ = free_arenas_->next_;
-    delete arena;
+  for (Atomic<Arena*>& cache : thread_caches_) {
+    Arena* arena = TakeThreadCache(&cache);
+    while (arena != nullptr) {
+      Arena* next = arena->next_;
+      delete arena;
+      arena = next;
+    }
+  }
+  for (Arena*& bucket : free_arenas_) {
+    while (bucket != nullptr) {
+      Arena* arena = bucket;
+      bucket = bucket->next_;
+      delete arena;
+    }
   }
 }
 
@@ -312,11 +405,27 @@ void ArenaPool::LockReclaimMemory() {
 Arena* ArenaPool::AllocArena(size_t size) {
   Thread* self = Thread::Current();
   Arena* ret = nullptr;
-  {
+  Atomic<Arena*>* cache = GetThreadCache(self);
+  if (cache != nullptr) {
+    Arena* cached = TakeThreadCache(cache);
+    if (cached != nullptr && LIKELY(cached->Size() >= size)) {
+      ret = cached;
+      cached = cached->next_;
+    }
+    if (cached != nullptr) {
+      for (Arena* arena = cached; arena != nullptr; arena = arena->next_) {
+        thread_caches_bytes_allocated_.FetchAndAddSequentiallyConsistent(
+            arena->GetBytesAllocated());
+      }
+      cache->StoreRelease(cached);
+    }
+  }
+  if (ret == nullptr) {
     MutexLock lock(self, lock_);
-    if (free_arenas_ != nullptr && LIKELY(free_arenas_->Size() >= size)) {
-      ret = free_arenas_;
-      free_arenas_ = free_arenas_->next_;
+    ret = TakeFreeArenaLocked(size);
+    if (ret == nullptr) {
+      // Rather than creating a new arena, rebalance the ones idle in other threads' caches.
+      ret = TakeFreeArenaFromThreadCachesLocked(size, cache);
     }
   }
   if (ret == nullptr) {
@@ -331,18 +440,31 @@ void ArenaPool::TrimMaps() {
   if (!use_malloc_) {
     ScopedTrace trace(__PRETTY_FUNCTION__);
     // Doesn't work for malloc.
-    MutexLock lock(Thread::Current(), lock_);
-    for (Arena* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
-      arena->Release();
+    Thread* self = Thread::Current();
+    Atomic<Arena*>* own_cache = GetThreadCache(self);
+    MutexLock lock(self, lock_);
+    // The arenas cached by the other threads are trimmed with the free arenas.
+    for (Atomic<Arena*>& cache : thread_caches_) {
+      if (&cache == own_cache) {
+        continue;
+      }
+      AddFreeArenasLocked(TakeThreadCache(&cache));
+    }
+    for (Arena* bucket : free_arenas_) {
+      for (Arena* arena = bucket; arena != nullptr; arena = arena->next_) {
+        arena->Release();
+      }
     }
   }
 }
 
 size_t ArenaPool::GetBytesAllocated() const {
-  size_t total = 0;
+  size_t total = thread_caches_bytes_allocated_.LoadSequentiallyConsistent();
   MutexLock lock(Thread::Current(), lock_);
-  for (Arena* arena = free_arenas_; arena != nullptr; arena = arena->next_) {
-    total += arena->GetBytesAllocated();
+  for (Arena* bucket : free_arenas_) {
+    for (Arena* arena = bucket; arena != nullptr; arena = arena->next_) {
+      total += arena->GetBytesAllocated();
+    }
   }
   return total;
 }
@@ -364,15 +486,34 @@ void ArenaPool::FreeArenaChain(Arena* first) {
     return;
   }
 
-  if (first != nullptr) {
-    Arena* last = first;
-    while (last->next_ != nullptr) {
-      last = last->next_;
+  Thread* self = Thread::Current();
+  Atomic<Arena*>* cache = GetThreadCache(self);
+  if (first != nullptr && cache != nullptr) {
+    // Keep the arenas which fit in the cache of this thread, with the ones already there.
+    Arena* cached = TakeThreadCache(cache);
+    size_t cached_bytes = 0u;
+    for (Arena* arena = cached; arena != nullptr; arena = arena->next_) {
+      cached_bytes += arena->Size();
     }
-    Thread* self = Thread::Current();
+    while (first != nullptr && cached_bytes + first->Size() <= kMaxThreadCacheBytes) {
+      Arena* next = first->next_;
+      first->next_ = cached;
+      cached = first;
+      cached_bytes += cached->Size();
+      first = next;
+    }
+    if (cached != nullptr) {
+      for (Arena* arena = cached; arena != nullptr; arena = arena->next_) {
+        thread_caches_bytes_allocated_.FetchAndAddSequentiallyConsistent(
+            arena->GetBytesAllocated());
+      }
+      cache->StoreRelease(cached);
+    }
+  }
+
+  if (first != nullptr) {
     MutexLock lock(self, lock_);
-    last->next_ = free_arenas_;
-    free_arenas_ = first;
+    AddFreeArenasLocked(first);
   }
 }
 
@@ -396,7 +537,8 @@ ArenaAllocator::ArenaAllocator(ArenaPool* pool)
     begin_(nullptr),
     end_(nullptr),
     ptr_(nullptr),
-    arena_head_(nullptr) {
+    arena_head_(nullptr),
+    free_blocks_() {
 }
 
 void ArenaAllocator::UpdateBytesAllocated() {
@@ -20,9 +20,11 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "atomic.h"
 #include "bit_utils.h"
 #include "dchecked_vector.h"
 #include "debug_stack.h"
+#include "globals.h"
 #include "macros.h"
 #include "memory_tool.h"
 #include "mutex.h"
@@ -101,6 +103,7 @@ enum ArenaAllocKind {
   kArenaAllocCHA,
   kArenaAllocScheduler,
   kArenaAllocProfile,
+  kArenaAllocSuperblockCloner,
   kNumArenaAllocKinds
 };
 
@@ -116,8 +119,10 @@ class ArenaAllocatorStatsImpl<false> {
 
   void Copy(const ArenaAllocatorStatsImpl& other ATTRIBUTE_UNUSED) {}
   void RecordAlloc(size_t bytes ATTRIBUTE_UNUSED, ArenaAllocKind kind ATTRIBUTE_UNUSED) {}
+  void RecordReuse(size_t bytes ATTRIBUTE_UNUSED, ArenaAllocKind kind ATTRIBUTE_UNUSED) {}
   size_t NumAllocations() const { return 0u; }
   size_t BytesAllocated() const { return 0u; }
+  size_t BytesReused() const { return 0u; }
   void Dump(std::ostream& os ATTRIBUTE_UNUSED,
             const Arena* first ATTRIBUTE_UNUSED,
             ssize_t lost_bytes_adjustment ATTRIBUTE_UNUSED) const {}
@@ -132,13 +137,16 @@ class ArenaAllocatorStatsImpl {
 
   void Copy(const ArenaAllocatorStatsImpl& other);
   void RecordAlloc(size_t bytes, ArenaAllocKind kind);
+  void RecordReuse(size_t bytes, ArenaAllocKind kind);
   size_t NumAllocations() const;
   size_t BytesAllocated() const;
+  size_t BytesReused() const;
   void Dump(std::ostream& os, const Arena* first, ssize_t lost_bytes_adjustment) const;
 
  private:
   size_t num_allocations_;
   dchecked_vector<size_t> alloc_stats_;  // Bytes used by various allocation kinds.
+  dchecked_vector<size_t> reuse_stats_;  // Bytes reused from freed blocks by allocation kinds.
 
   static const char* const kAllocNames[];
 };
@@ -248,6 +256,20 @@ class Arena {
 
 class ArenaPool {
  public:
+  // Arenas freed by a thread are first kept in a cache of that thread, up to
+  // kMaxThreadCacheBytes, and reused by its next allocations. This keeps a warm set of arenas
+  // for each compiler thread across methods: they only move to other threads when no free arena
+  // is left, TrimMaps() called by their thread does not release them, and like the other free
+  // arenas only their dirty bytes are zeroed when they are reused. Only the threads with an id
+  // below kMaxThreadCaches have one.
+  static constexpr size_t kMaxThreadCaches = 64;
+  static constexpr size_t kMaxThreadCacheBytes = 2 * MB;
+  // The other free arenas are kept in buckets by size: bucket i holds the arenas of at least
+  // kArenaDefaultSize << i bytes, the last bucket all the larger ones. When none of them fits an
+  // allocation, the arenas cached by the other threads are moved to the buckets before a new
+  // arena is created.
+  static constexpr size_t kNumFreeArenaBuckets = 4;
+
   explicit ArenaPool(bool use_malloc = true,
                      bool low_4gb = false,
                      const char* name = "LinearAlloc");
@@ -258,13 +280,32 @@ class ArenaPool {
   void ReclaimMemory() NO_THREAD_SAFETY_ANALYSIS;
   void LockReclaimMemory() REQUIRES(!lock_);
   // Trim the maps in arenas by madvising, used by JIT to reduce memory usage. This only works
-  // use_malloc is false.
+  // use_malloc is false. The arenas cached by the calling thread are kept.
   void TrimMaps() REQUIRES(!lock_);
 
  private:
+  // Returns the arena cache of `self`, or null if it has none.
+  Atomic<Arena*>* GetThreadCache(Thread* self);
+  // Takes all the arenas out of `cache`, returns the first one of the chain.
+  Arena* TakeThreadCache(Atomic<Arena*>* cache);
+  // Returns the bucket for free arenas of `size` bytes.
+  static size_t FreeArenaBucket(size_t size);
+  // Adds the chain of arenas starting at `first` to the free arena buckets.
+  void AddFreeArenasLocked(Arena* first) REQUIRES(lock_);
+  // Takes a free arena of at least `size` bytes out of the buckets, or returns null.
+  Arena* TakeFreeArenaLocked(size_t size) REQUIRES(lock_);
+  // Moves the arenas cached by the threads other than the one of `own_cache` to the buckets,
+  // until one fits `size` bytes. Returns that arena, or null.
+  Arena* TakeFreeArenaFromThreadCachesLocked(size_t size, Atomic<Arena*>* own_cache)
+      REQUIRES(lock_);
+
   const bool use_malloc_;
   mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
-  Arena* free_arenas_ GUARDED_BY(lock_);
+  Arena* free_arenas_[kNumFreeArenaBuckets] GUARDED_BY(lock_);
+  // A chain of arenas per thread id. A cache is only filled by its own thread, the other threads
+  // only take all of its arenas, so that its thread can take and put back arenas without a lock.
+  Atomic<Arena*> thread_caches_[kMaxThreadCaches];
+  Atomic<size_t> thread_caches_bytes_allocated_;
   const bool low_4gb_;
   const char* name_;
   DISALLOW_COPY_AND_ASSIGN(ArenaPool);
@@ -357,6 +398,51 @@ class ArenaAllocator
     return new_ptr;
   }
 
+  // Returns memory for container storage, reusing a block released with Free() if there is one
+  // in the size class for `bytes`. Unlike Alloc(), the returned memory is not zeroed.
+  void* AllocRecyclable(size_t bytes, ArenaAllocKind kind = kArenaAllocMisc) ALWAYS_INLINE {
+    void* block = AllocFreed(bytes, kind);
+    return (block != nullptr) ? block : Alloc(bytes, kind);
+  }
+
+  // Returns a block released with Free() in the size class for `bytes`, or null if there is
+  // none. The returned memory is not zeroed.
+  void* AllocFreed(size_t bytes, ArenaAllocKind kind = kArenaAllocMisc) ALWAYS_INLINE {
+    bytes = RoundUp(bytes, kAlignment);
+    if (bytes >= kMinRecycledBytes && LIKELY(!IsRunningOnMemoryTool())) {
+      // Round up to a power of two, every block in that size class is at least that large.
+      const size_t size_class = MinimumBitsToStore(bytes - 1u) - kMinRecycledBytesShift;
+      if (size_class < kNumRecycledSizeClasses && free_blocks_[size_class] != nullptr) {
+        FreeBlock* block = free_blocks_[size_class];
+        free_blocks_[size_class] = block->next;
+        ArenaAllocatorStats::RecordReuse(bytes, kind);
+        return block;
+      }
+    }
+    return nullptr;
+  }
+
+  // Releases `bytes` bytes at `ptr`, allocated by this allocator, for reuse by AllocRecyclable().
+  // Blocks smaller than kMinRecycledBytes are simply abandoned.
+  void Free(void* ptr, size_t bytes) ALWAYS_INLINE {
+    if (UNLIKELY(IsRunningOnMemoryTool())) {
+      MakeInaccessible(ptr, bytes);
+      return;
+    }
+    // The allocation was rounded up as well.
+    bytes = RoundUp(bytes, kAlignment);
+    if (bytes >= kMinRecycledBytes) {
+      // Round down to a power of two, the largest size class gets all larger blocks.
+      size_t size_class = static_cast<size_t>(MostSignificantBit(bytes)) - kMinRecycledBytesShift;
+      if (size_class >= kNumRecycledSizeClasses) {
+        size_class = kNumRecycledSizeClasses - 1u;
+      }
+      FreeBlock* block = reinterpret_cast<FreeBlock*>(ptr);
+      block->next = free_blocks_[size_class];
+      free_blocks_[size_class] = block;
+    }
+  }
+
   template <typename T>
   T* Alloc(ArenaAllocKind kind = kArenaAllocMisc) {
     return AllocArray<T>(1, kind);
@@ -387,6 +473,12 @@ class ArenaAllocator
   // The alignment required for the whole Arena rather than individual allocations.
   static constexpr size_t kArenaAlignment = 16u;
 
+  // Blocks released with Free() are kept in free lists by power of two size classes, from
+  // kMinRecycledBytes up. Smaller blocks are not worth tracking.
+  static constexpr size_t kMinRecycledBytesShift = 5u;
+  static constexpr size_t kMinRecycledBytes = 1u << kMinRecycledBytesShift;
+  static constexpr size_t kNumRecycledSizeClasses = 20u;
+
  private:
   void* AllocWithMemoryTool(size_t bytes, ArenaAllocKind kind);
   void* AllocWithMemoryToolAlign16(size_t bytes, ArenaAllocKind kind);
@@ -395,11 +487,19 @@ class ArenaAllocator
 
   void UpdateBytesAllocated();
 
+  // A block released with Free(), linked through its first word.
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
   ArenaPool* pool_;
   uint8_t* begin_;
   uint8_t* end_;
   uint8_t* ptr_;
   Arena* arena_head_;
+  // Free lists of released blocks. The blocks of size class i are at least
+  // kMinRecycledBytes << i bytes large.
+  FreeBlock* free_blocks_[kNumRecycledSizeClasses];
 
   template <typename U>
   friend class ArenaAllocatorAdapter;
@@ -16,6 +16,7 @@
 
 #include "base/arena_allocator-inl.h"
 #include "base/arena_bit_vector.h"
+#include "base/arena_containers.h"
 #include "base/memory_tool.h"
 #include "gtest/gtest.h"
 
@@ -350,5 +351,52 @@ TEST_F(ArenaAllocatorTest, ReallocAlignment) {
   }
 }
 
+TEST_F(ArenaAllocatorTest, FreeAndAllocRecyclable) {
+  // Free() does not recycle blocks when running under sanitization.
+  if (RUNNING_ON_MEMORY_TOOL != 0) {
+    printf("WARNING: TEST DISABLED FOR MEMORY_TOOL\n");
+    return;
+  }
+
+  ArenaPool pool;
+  ArenaAllocator allocator(&pool);
+
+  // Small blocks are not recycled.
+  void* small_allocation = allocator.Alloc(ArenaAllocator::kMinRecycledBytes / 2);
+  allocator.Free(small_allocation, ArenaAllocator::kMinRecycledBytes / 2);
+  EXPECT_NE(small_allocation, allocator.AllocRecyclable(ArenaAllocator::kMinRecycledBytes / 2));
+
+  // A freed block is reused for allocations up to the power of two below its size.
+  void* allocation = allocator.Alloc(100);
+  allocator.Free(allocation, 100);
+  EXPECT_NE(allocation, allocator.AllocRecyclable(65));
+  EXPECT_EQ(allocation, allocator.AllocRecyclable(64));
+  // It is reused only once.
+  EXPECT_NE(allocation, allocator.AllocRecyclable(64));
+
+  // Blocks come back in the reverse order of Free().
+  void* first = allocator.Alloc(256);
+  void* second = allocator.Alloc(300);
+  allocator.Free(first, 256);
+  allocator.Free(second, 300);
+  EXPECT_EQ(second, allocator.AllocRecyclable(200));
+  EXPECT_EQ(first, allocator.AllocRecyclable(256));
+
+  // AllocFreed() only returns released blocks.
+  EXPECT_TRUE(allocator.AllocFreed(64) == nullptr);
+  void* block = allocator.Alloc(64);
+  allocator.Free(block, 64);
+  EXPECT_EQ(block, allocator.AllocFreed(64));
+  EXPECT_TRUE(allocator.AllocFreed(64) == nullptr);
+
+  // Containers recycle the storage they reallocate.
+  ArenaVector<uint32_t> vector(allocator.Adapter(kArenaAllocSTL));
+  vector.resize(64u);
+  const uint32_t* old_data = vector.data();
+  vector.resize(128u);
+  ArenaVector<uint32_t> other_vector(allocator.Adapter(kArenaAllocSTL));
+  other_vector.reserve(64u);
+  EXPECT_EQ(old_data, other_vector.data());
+}
 
 }  // namespace art
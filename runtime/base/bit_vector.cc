@@ -19,11 +19,96 @@
 #include <limits>
 #include <sstream>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include "allocator.h"
 #include "bit_vector-inl.h"
 
 namespace art {
 
+// Word-parallel kernels of the bulk operations. They process four words at a time with SIMD
+// where available, and the remaining words one at a time. The kernels that can change bits
+// report whether any bit of `dst` changed, so that dataflow fixpoints such as the liveness
+// analysis need no separate comparison pass.
+
+// dst[i] |= src[i] & ~not_in[i], or dst[i] |= src[i] if `not_in` is null.
+template <bool kHasNotIn>
+static inline bool UnionWords(uint32_t* dst,
+                              const uint32_t* src,
+                              const uint32_t* not_in,
+                              uint32_t num_words) {
+  uint32_t idx = 0u;
+  uint32_t changed = 0u;
+#if defined(__SSE2__)
+  __m128i changed_vec = _mm_setzero_si128();
+  for (; idx + 4u <= num_words; idx += 4u) {
+    __m128i existing = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + idx));
+    __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + idx));
+    if (kHasNotIn) {
+      // _mm_andnot_si128(a, b) computes ~a & b.
+      bits = _mm_andnot_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(not_in + idx)),
+                              bits);
+    }
+    __m128i update = _mm_or_si128(existing, bits);
+    changed_vec = _mm_or_si128(changed_vec, _mm_xor_si128(existing, update));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + idx), update);
+  }
+  changed = (_mm_movemask_epi8(_mm_cmpeq_epi8(changed_vec, _mm_setzero_si128())) != 0xffff)
+      ? 1u : 0u;
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+  uint32x4_t changed_vec = vdupq_n_u32(0u);
+  for (; idx + 4u <= num_words; idx += 4u) {
+    uint32x4_t existing = vld1q_u32(dst + idx);
+    uint32x4_t bits = vld1q_u32(src + idx);
+    if (kHasNotIn) {
+      // vbicq_u32(a, b) computes a & ~b.
+      bits = vbicq_u32(bits, vld1q_u32(not_in + idx));
+    }
+    uint32x4_t update = vorrq_u32(existing, bits);
+    changed_vec = vorrq_u32(changed_vec, veorq_u32(existing, update));
+    vst1q_u32(dst + idx, update);
+  }
+  uint32x2_t changed_half = vorr_u32(vget_low_u32(changed_vec), vget_high_u32(changed_vec));
+  changed = vget_lane_u32(changed_half, 0) | vget_lane_u32(changed_half, 1);
+#endif
+  for (; idx < num_words; ++idx) {
+    uint32_t existing = dst[idx];
+    uint32_t update = existing | (kHasNotIn ? (src[idx] & ~not_in[idx]) : src[idx]);
+    changed |= existing ^ update;
+    dst[idx] = update;
+  }
+  return changed != 0u;
+}
+
+// dst[i] &= src[i], or dst[i] &= ~src[i] if `kComplementSrc`.
+template <bool kComplementSrc>
+static inline void IntersectWords(uint32_t* dst, const uint32_t* src, uint32_t num_words) {
+  uint32_t idx = 0u;
+#if defined(__SSE2__)
+  for (; idx + 4u <= num_words; idx += 4u) {
+    __m128i existing = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + idx));
+    __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + idx));
+    __m128i update = kComplementSrc ? _mm_andnot_si128(bits, existing)
+                                    : _mm_and_si128(existing, bits);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + idx), update);
+  }
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+  for (; idx + 4u <= num_words; idx += 4u) {
+    uint32x4_t existing = vld1q_u32(dst + idx);
+    uint32x4_t bits = vld1q_u32(src + idx);
+    uint32x4_t update = kComplementSrc ? vbicq_u32(existing, bits) : vandq_u32(existing, bits);
+    vst1q_u32(dst + idx, update);
+  }
+#endif
+  for (; idx < num_words; ++idx) {
+    dst[idx] &= kComplementSrc ? ~src[idx] : src[idx];
+  }
+}
+
 BitVector::BitVector(bool expandable,
                      Allocator* allocator,
                      uint32_t storage_size,
@@ -121,51 +206,48 @@ void BitVector::Intersect(const BitVector* src) {
   // Get the minimum size between us and source.
   uint32_t min_size = (storage_size_ < src_storage_size) ? storage_size_ : src_storage_size;
 
-  uint32_t idx;
-  for (idx = 0; idx < min_size; idx++) {
-    storage_[idx] &= src->GetRawStorageWord(idx);
-  }
+  IntersectWords</* kComplementSrc */ false>(storage_, src->GetRawStorage(), min_size);
 
   // Now, due to this being an intersection, there are two possibilities:
   //   - Either src was larger than us: we don't care, all upper bits would thus be 0.
   //   - Either we are larger than src: we don't care, all upper bits would have been 0 too.
   // So all we need to do is set all remaining bits to 0.
-  for (; idx < storage_size_; idx++) {
-    storage_[idx] = 0;
+  if (min_size < storage_size_) {
+    memset(storage_ + min_size, 0, (storage_size_ - min_size) * kWordBytes);
   }
 }
 
 bool BitVector::Union(const BitVector* src) {
-  // Get the highest bit to determine how much we need to expand.
-  int highest_bit = src->GetHighestBitSet();
+  uint32_t src_size = src->storage_size_;
   bool changed = false;
 
-  // If src has no bit set, we are done: there is no need for a union with src.
-  if (highest_bit == -1) {
-    return changed;
-  }
-
-  // Update src_size to how many cells we actually care about: where the bit is + 1.
-  uint32_t src_size = BitsToWords(highest_bit + 1);
-
-  // Is the storage size smaller than src's?
+  // If we can hold all of src, OR all of its words without looking for its highest bit.
   if (storage_size_ < src_size) {
-    changed = true;
+    // Get the highest bit to determine how much we need to expand.
+    int highest_bit = src->GetHighestBitSet();
 
-    EnsureSize(highest_bit);
+    // If src has no bit set, we are done: there is no need for a union with src.
+    if (highest_bit == -1) {
+      return changed;
+    }
 
-    // Paranoid: storage size should be big enough to hold this bit now.
-    DCHECK_LT(static_cast<uint32_t> (highest_bit), storage_size_ * kWordBits);
-  }
+    // Update src_size to how many cells we actually care about: where the bit is + 1.
+    src_size = BitsToWords(highest_bit + 1);
 
-  for (uint32_t idx = 0; idx < src_size; idx++) {
-    uint32_t existing = storage_[idx];
-    uint32_t update = existing | src->GetRawStorageWord(idx);
-    if (existing != update) {
+    // Is the storage size smaller than src's?
+    if (storage_size_ < src_size) {
       changed = true;
-      storage_[idx] = update;
+
+      EnsureSize(highest_bit);
+
+      // Paranoid: storage size should be big enough to hold this bit now.
+      DCHECK_LT(static_cast<uint32_t> (highest_bit), storage_size_ * kWordBits);
     }
   }
+
+  if (UnionWords</* kHasNotIn */ false>(storage_, src->GetRawStorage(), nullptr, src_size)) {
+    changed = true;
+  }
   return changed;
 }
 
@@ -192,24 +274,18 @@ bool BitVector::UnionIfNotIn(const BitVector* union_with, const BitVector* not_i
 
   uint32_t not_in_size = not_in->GetStorageSize();
 
-  uint32_t idx = 0;
-  for (; idx < std::min(not_in_size, union_with_size); idx++) {
-    uint32_t existing = storage_[idx];
-    uint32_t update = existing |
-        (union_with->GetRawStorageWord(idx) & ~not_in->GetRawStorageWord(idx));
-    if (existing != update) {
-      changed = true;
-      storage_[idx] = update;
-    }
+  uint32_t common_size = std::min(not_in_size, union_with_size);
+  if (UnionWords</* kHasNotIn */ true>(storage_,
+                                       union_with->GetRawStorage(),
+                                       not_in->GetRawStorage(),
+                                       common_size)) {
+    changed = true;
   }
-
-  for (; idx < union_with_size; idx++) {
-    uint32_t existing = storage_[idx];
-    uint32_t update = existing | union_with->GetRawStorageWord(idx);
-    if (existing != update) {
-      changed = true;
-      storage_[idx] = update;
-    }
+  if (UnionWords</* kHasNotIn */ false>(storage_ + common_size,
+                                        union_with->GetRawStorage() + common_size,
+                                        nullptr,
+                                        union_with_size - common_size)) {
+    changed = true;
   }
   return changed;
 }
@@ -224,9 +300,7 @@ void BitVector::Subtract(const BitVector *src) {
   //   There is no need to do more:
   //     If we are bigger than src, the upper bits are unchanged.
   //     If we are smaller than src, the non-existant upper bits are 0 and thus can't get subtracted.
-  for (uint32_t idx = 0; idx < min_size; idx++) {
-    storage_[idx] &= (~(src->GetRawStorageWord(idx)));
-  }
+  IntersectWords</* kComplementSrc */ true>(storage_, src->GetRawStorage(), min_size);
 }
 
 uint32_t BitVector::NumSetBits() const {
@@ -167,6 +167,60 @@ TEST(BitVector, UnionIfNotIn) {
   }
 }
 
+TEST(BitVector, BulkOperations) {
+  // Cover both the vectorized part and the word-at-a-time tail of the bulk operations.
+  const size_t kBits = 16 * 32 + 3 * 32 + 7;
+  BitVector first(kBits, true, Allocator::GetMallocAllocator());
+  BitVector second(kBits, true, Allocator::GetMallocAllocator());
+  BitVector third(kBits, true, Allocator::GetMallocAllocator());
+  for (size_t i = 0; i < kBits; ++i) {
+    if (i % 3 == 0) {
+      first.SetBit(i);
+    }
+    if (i % 5 == 0) {
+      second.SetBit(i);
+    }
+    if (i % 7 == 0) {
+      third.SetBit(i);
+    }
+  }
+
+  BitVector result(first, true, Allocator::GetMallocAllocator());
+  EXPECT_TRUE(result.Union(&second));
+  EXPECT_FALSE(result.Union(&second));
+  for (size_t i = 0; i < kBits; ++i) {
+    EXPECT_EQ(i % 3 == 0 || i % 5 == 0, result.IsBitSet(i)) << i;
+  }
+
+  result.Copy(&first);
+  EXPECT_TRUE(result.UnionIfNotIn(&second, &third));
+  EXPECT_FALSE(result.UnionIfNotIn(&second, &third));
+  for (size_t i = 0; i < kBits; ++i) {
+    EXPECT_EQ(i % 3 == 0 || (i % 5 == 0 && i % 7 != 0), result.IsBitSet(i)) << i;
+  }
+
+  result.Copy(&first);
+  result.Intersect(&second);
+  for (size_t i = 0; i < kBits; ++i) {
+    EXPECT_EQ(i % 3 == 0 && i % 5 == 0, result.IsBitSet(i)) << i;
+  }
+
+  result.Copy(&first);
+  result.Subtract(&second);
+  for (size_t i = 0; i < kBits; ++i) {
+    EXPECT_EQ(i % 3 == 0 && i % 5 != 0, result.IsBitSet(i)) << i;
+  }
+
+  // A union with a smaller vector changes only when it adds a bit.
+  BitVector small(32, true, Allocator::GetMallocAllocator());
+  small.SetBit(3);
+  result.Copy(&first);
+  EXPECT_FALSE(result.Union(&small));
+  small.SetBit(4);
+  EXPECT_TRUE(result.Union(&small));
+  EXPECT_TRUE(result.IsBitSet(4));
+}
+
 TEST(BitVector, Subset) {
   {
     BitVector first(2, true, Allocator::GetMallocAllocator());
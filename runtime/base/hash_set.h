@@ -18,6 +18,13 @@
 #define ART_RUNTIME_BASE_HASH_SET_H_
 
 #include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 #include <functional>
 #include <iterator>
@@ -60,8 +67,14 @@ class DefaultEmptyFn<T*> {
 // EmptyFn needs to implement two functions MakeEmpty(T& item) and IsEmpty(const T& item).
 // TODO: We could get rid of this requirement by using a bitmap, though maybe this would be slower
 // and more complicated.
+//
+// If kUseControlBytes is true, the set also keeps one control byte per bucket holding 7 bits of
+// the element's hash, or kEmptyControlByte for an empty bucket. Lookups then compare a group of
+// kControlGroupSize control bytes at once and only call Pred for the buckets with matching hash
+// bits. This costs one byte per bucket and pays off when Pred is expensive, e.g. when it needs to
+// dereference the element. The probe sequence is the same linear probe in both modes.
 template <class T, class EmptyFn = DefaultEmptyFn<T>, class HashFn = std::hash<T>,
-    class Pred = std::equal_to<T>, class Alloc = std::allocator<T>>
+    class Pred = std::equal_to<T>, class Alloc = std::allocator<T>, bool kUseControlBytes = false>
 class HashSet {
   template <class Elem, class HashSetType>
   class BaseIterator : std::iterator<std::forward_iterator_tag, Elem> {
@@ -135,6 +148,16 @@ class HashSet {
   static constexpr double kDefaultMaxLoadFactor = 0.7;
   static constexpr size_t kMinBuckets = 1000;
 
+  // Number of control bytes compared at once. The first kControlGroupSize - 1 control bytes are
+  // mirrored after the last bucket so that a group can be loaded at any index without wrapping.
+  static constexpr size_t kControlGroupSize = 16u;
+  static constexpr uint8_t kEmptyControlByte = 0x80u;
+
+  // Versions of the WriteToMemory() format. kFormatControlBytes appends the control bytes after
+  // the elements.
+  static constexpr uint64_t kFormatElements = 1u;
+  static constexpr uint64_t kFormatControlBytes = 2u;
+
   // If we don't own the data, this will create a new array which owns the data.
   void Clear() {
     DeallocateStorage();
@@ -150,6 +173,7 @@ class HashSet {
         elements_until_expand_(0u),
         owns_data_(false),
         data_(nullptr),
+        ctrl_(nullptr),
         min_load_factor_(min_load_factor),
         max_load_factor_(max_load_factor) {
     DCHECK_GT(min_load_factor, 0.0);
@@ -166,6 +190,7 @@ class HashSet {
         elements_until_expand_(0u),
         owns_data_(false),
         data_(nullptr),
+        ctrl_(nullptr),
         min_load_factor_(kDefaultMinLoadFactor),
         max_load_factor_(kDefaultMaxLoadFactor) {
   }
@@ -180,12 +205,16 @@ class HashSet {
         elements_until_expand_(other.elements_until_expand_),
         owns_data_(false),
         data_(nullptr),
+        ctrl_(nullptr),
         min_load_factor_(other.min_load_factor_),
         max_load_factor_(other.max_load_factor_) {
     AllocateStorage(other.NumBuckets());
     for (size_t i = 0; i < num_buckets_; ++i) {
       ElementForIndex(i) = other.data_[i];
     }
+    if (ctrl_ != nullptr) {
+      memcpy(ctrl_, other.ctrl_, NumControlBytes());
+    }
   }
 
   // noexcept required so that the move constructor is used instead of copy constructor.
@@ -200,6 +229,7 @@ class HashSet {
         elements_until_expand_(other.elements_until_expand_),
         owns_data_(other.owns_data_),
         data_(other.data_),
+        ctrl_(other.ctrl_),
         min_load_factor_(other.min_load_factor_),
         max_load_factor_(other.max_load_factor_) {
     other.num_elements_ = 0u;
@@ -207,15 +237,20 @@ class HashSet {
     other.elements_until_expand_ = 0u;
     other.owns_data_ = false;
     other.data_ = nullptr;
+    other.ctrl_ = nullptr;
   }
 
   // Construct from existing data.
   // Read from a block of memory, if make_copy_of_data is false, then data_ points to within the
-  // passed in ptr_.
+  // passed in ptr_. A set using control bytes always copies data written without them, since the
+  // control bytes need to be rebuilt from the elements.
   HashSet(const uint8_t* ptr, bool make_copy_of_data, size_t* read_count) noexcept {
     uint64_t temp;
     size_t offset = 0;
     offset = ReadFromBytes(ptr, offset, &temp);
+    CHECK(temp == kFormatElements || temp == kFormatControlBytes) << "Unknown format " << temp;
+    const bool has_control_bytes = (temp == kFormatControlBytes);
+    offset = ReadFromBytes(ptr, offset, &temp);
     num_elements_ = static_cast<uint64_t>(temp);
     offset = ReadFromBytes(ptr, offset, &temp);
     num_buckets_ = static_cast<uint64_t>(temp);
@@ -224,10 +259,14 @@ class HashSet {
     elements_until_expand_ = static_cast<uint64_t>(temp);
     offset = ReadFromBytes(ptr, offset, &min_load_factor_);
     offset = ReadFromBytes(ptr, offset, &max_load_factor_);
+    if (kUseControlBytes && !has_control_bytes) {
+      make_copy_of_data = true;
+    }
     if (!make_copy_of_data) {
       owns_data_ = false;
       data_ = const_cast<T*>(reinterpret_cast<const T*>(ptr + offset));
       offset += sizeof(*data_) * num_buckets_;
+      ctrl_ = kUseControlBytes ? const_cast<uint8_t*>(ptr + offset) : nullptr;
     } else {
       AllocateStorage(num_buckets_);
       // Write elements, not that this may not be safe for cross compilation if the elements are
@@ -235,6 +274,20 @@ class HashSet {
       for (size_t i = 0; i < num_buckets_; ++i) {
         offset = ReadFromBytes(ptr, offset, &data_[i]);
       }
+      if (kUseControlBytes && has_control_bytes) {
+        if (ctrl_ != nullptr) {
+          memcpy(ctrl_, ptr + offset, NumControlBytes());
+        }
+      } else if (kUseControlBytes) {
+        for (size_t i = 0; i < num_buckets_; ++i) {
+          if (!emptyfn_.IsEmpty(data_[i])) {
+            SetControlByte(i, ControlByteForHash(hashfn_(data_[i])));
+          }
+        }
+      }
+    }
+    if (has_control_bytes) {
+      offset += ControlBytesSize(num_buckets_);
     }
     // Caller responsible for aligning.
     *read_count = offset;
@@ -244,6 +297,7 @@ class HashSet {
   // but the size is still returned. Target must be 8 byte aligned.
   size_t WriteToMemory(uint8_t* ptr) const {
     size_t offset = 0;
+    offset = WriteToBytes(ptr, offset, kUseControlBytes ? kFormatControlBytes : kFormatElements);
     offset = WriteToBytes(ptr, offset, static_cast<uint64_t>(num_elements_));
     offset = WriteToBytes(ptr, offset, static_cast<uint64_t>(num_buckets_));
     offset = WriteToBytes(ptr, offset, static_cast<uint64_t>(elements_until_expand_));
@@ -254,10 +308,48 @@ class HashSet {
     for (size_t i = 0; i < num_buckets_; ++i) {
       offset = WriteToBytes(ptr, offset, data_[i]);
     }
+    if (kUseControlBytes) {
+      if (ptr != nullptr && ctrl_ != nullptr) {
+        memcpy(ptr + offset, ctrl_, NumControlBytes());
+      }
+      offset += NumControlBytes();
+    }
     // Caller responsible for aligning.
     return offset;
   }
 
+  // Visits the non-empty elements of a set written by WriteToMemory() in place, without reading
+  // it into a set. The visitor may update the elements as long as their hashes do not change, e.g.
+  // to relocate the pointers of an image. Returns how many bytes were read.
+  template <typename Visitor>
+  static size_t VisitElementsInMemory(uint8_t* ptr, const Visitor& visitor) {
+    uint64_t format;
+    uint64_t num_buckets;
+    uint64_t temp;
+    double load_factor;
+    size_t offset = 0;
+    offset = ReadFromBytes(ptr, offset, &format);
+    CHECK(format == kFormatElements || format == kFormatControlBytes)
+        << "Unknown format " << format;
+    offset = ReadFromBytes(ptr, offset, &temp);  // num_elements_
+    offset = ReadFromBytes(ptr, offset, &num_buckets);
+    offset = ReadFromBytes(ptr, offset, &temp);  // elements_until_expand_
+    offset = ReadFromBytes(ptr, offset, &load_factor);  // min_load_factor_
+    offset = ReadFromBytes(ptr, offset, &load_factor);  // max_load_factor_
+    EmptyFn emptyfn;
+    T* const data = reinterpret_cast<T*>(ptr + offset);
+    for (size_t i = 0; i < num_buckets; ++i) {
+      if (!emptyfn.IsEmpty(data[i])) {
+        visitor(data[i]);
+      }
+    }
+    offset += sizeof(T) * num_buckets;
+    if (format == kFormatControlBytes) {
+      offset += ControlBytesSize(num_buckets);
+    }
+    return offset;
+  }
+
   ~HashSet() {
     DeallocateStorage();
   }
@@ -329,6 +421,9 @@ class HashSet {
       // If the next element is empty, we are done. Make sure to clear the current empty index.
       if (emptyfn_.IsEmpty(next_element)) {
         emptyfn_.MakeEmpty(ElementForIndex(empty_index));
+        if (kUseControlBytes) {
+          SetControlByte(empty_index, kEmptyControlByte);
+        }
         break;
       }
       // Otherwise try to see if the next element can fill the current empty index.
@@ -351,6 +446,9 @@ class HashSet {
         // If the target index isn't within our current range it must have been probed from before
         // the empty index.
         ElementForIndex(empty_index) = std::move(next_element);
+        if (kUseControlBytes) {
+          SetControlByte(empty_index, ctrl_[next_index]);
+        }
         filled = true;  // TODO: Optimize
         empty_index = next_index;
       }
@@ -402,6 +500,9 @@ class HashSet {
     }
     const size_t index = FirstAvailableSlot(IndexForHash(hash));
     data_[index] = std::forward<U>(element);
+    if (kUseControlBytes) {
+      SetControlByte(index, ControlByteForHash(hash));
+    }
     ++num_elements_;
   }
 
@@ -417,6 +518,7 @@ class HashSet {
     swap(emptyfn_, other.emptyfn_);
     swap(pred_, other.pred_);
     std::swap(data_, other.data_);
+    std::swap(ctrl_, other.ctrl_);
     std::swap(num_buckets_, other.num_buckets_);
     std::swap(num_elements_, other.num_elements_);
     std::swap(elements_until_expand_, other.elements_until_expand_);
@@ -478,12 +580,23 @@ class HashSet {
         T temp;
         emptyfn_.MakeEmpty(temp);
         std::swap(temp, element);
-        size_t first_slot = FirstAvailableSlot(IndexForHash(hashfn_(temp)));
+        const size_t hash = hashfn_(temp);
+        if (kUseControlBytes) {
+          if (ctrl_[i] != ControlByteForHash(hash)) {
+            LOG(ERROR) << "Element " << i << " has a wrong control byte";
+            ++errors;
+          }
+          SetControlByte(i, kEmptyControlByte);
+        }
+        size_t first_slot = FirstAvailableSlot(IndexForHash(hash));
         if (i != first_slot) {
           LOG(ERROR) << "Element " << i << " should be in slot " << first_slot;
           ++errors;
         }
         std::swap(temp, element);
+        if (kUseControlBytes) {
+          SetControlByte(i, ControlByteForHash(hash));
+        }
       }
     }
     return errors;
@@ -561,6 +674,9 @@ class HashSet {
       return 0;
     }
     DCHECK_EQ(hashfn_(element), hash);
+    if (kUseControlBytes) {
+      return FindIndexWithControlBytes(element, hash);
+    }
     size_t index = IndexForHash(hash);
     while (true) {
       const T& slot = ElementForIndex(index);
@@ -574,10 +690,104 @@ class HashSet {
     }
   }
 
+  // Same as FindIndex() but skips the buckets whose control byte does not match the hash.
+  template <typename K>
+  size_t FindIndexWithControlBytes(const K& element, size_t hash) const {
+    const uint8_t control_byte = ControlByteForHash(hash);
+    size_t index = IndexForHash(hash);
+    while (true) {
+      uint64_t matches = MatchControlBytes(ctrl_ + index, control_byte);
+      const uint64_t empties = MatchControlBytes(ctrl_ + index, kEmptyControlByte);
+      // Buckets after the first empty one are not part of the probe sequence.
+      if (empties != 0u) {
+        matches &= LowestOneBitValue(empties) - 1u;
+      }
+      for (; matches != 0u; matches &= matches - 1u) {
+        size_t match_index = index + (CTZ(matches) >> kControlMatchShift);
+        if (match_index >= num_buckets_) {
+          match_index -= num_buckets_;
+        }
+        if (pred_(ElementForIndex(match_index), element)) {
+          return match_index;
+        }
+      }
+      if (empties != 0u) {
+        return NumBuckets();
+      }
+      index = NextGroupIndex(index);
+    }
+  }
+
   bool IsFreeSlot(size_t index) const {
+    if (kUseControlBytes) {
+      DCHECK_LT(index, NumBuckets());
+      return ctrl_[index] == kEmptyControlByte;
+    }
     return emptyfn_.IsEmpty(ElementForIndex(index));
   }
 
+  static size_t ControlBytesSize(size_t num_buckets) {
+    return (num_buckets != 0u) ? num_buckets + kControlGroupSize - 1u : 0u;
+  }
+
+  size_t NumControlBytes() const {
+    return kUseControlBytes ? ControlBytesSize(num_buckets_) : 0u;
+  }
+
+  // The control byte of a full bucket holds 7 bits of a multiplicative hash of the hash, so that
+  // they do not depend on the bits which select the bucket and stay well distributed for weak
+  // hash functions.
+  static uint8_t ControlByteForHash(size_t hash) {
+    static constexpr size_t kMultiplier = static_cast<size_t>(UINT64_C(0x9e3779b97f4a7c15));
+    return static_cast<uint8_t>((hash * kMultiplier) >> (BitSizeOf<size_t>() - 7u));
+  }
+
+  void SetControlByte(size_t index, uint8_t control_byte) {
+    DCHECK_LT(index, NumBuckets());
+    ctrl_[index] = control_byte;
+    if (index < kControlGroupSize - 1u) {
+      ctrl_[num_buckets_ + index] = control_byte;
+    }
+  }
+
+  size_t NextGroupIndex(size_t index) const {
+    index += kControlGroupSize;
+    if (index >= num_buckets_) {
+      index -= num_buckets_;
+      DCHECK_LT(index, NumBuckets());
+    }
+    return index;
+  }
+
+  // Returns a mask with a bit set for each of the kControlGroupSize control bytes starting at
+  // `group` that are equal to `value`. The bit for group[i] is the lowest bit set in
+  // i << kControlMatchShift.
+#if defined(__ARM_NEON__) || defined(__aarch64__)
+  static constexpr size_t kControlMatchShift = 2u;
+#else
+  static constexpr size_t kControlMatchShift = 0u;
+#endif
+  static uint64_t MatchControlBytes(const uint8_t* group, uint8_t value) {
+#if defined(__SSE2__)
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    const __m128i matches = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(value)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(matches));
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+    const uint8x16_t matches = vceqq_u8(vld1q_u8(group), vdupq_n_u8(value));
+    // Narrow each 0x00/0xff byte to a nibble and keep the top bit of each nibble.
+    const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(matches), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & UINT64_C(0x8888888888888888);
+#else
+    uint64_t mask = 0u;
+    for (size_t i = 0; i < kControlGroupSize; ++i) {
+      mask |= static_cast<uint64_t>(group[i] == value) << i;
+    }
+    return mask;
+#endif
+  }
+
+  using ControlByteAllocator = typename std::allocator_traits<Alloc>::template rebind_alloc<uint8_t>;
+
   // Allocate a number of buckets.
   void AllocateStorage(size_t num_buckets) {
     num_buckets_ = num_buckets;
@@ -587,6 +797,11 @@ class HashSet {
       allocfn_.construct(allocfn_.address(data_[i]));
       emptyfn_.MakeEmpty(data_[i]);
     }
+    ctrl_ = nullptr;
+    if (NumControlBytes() != 0u) {
+      ctrl_ = ControlByteAllocator(allocfn_).allocate(NumControlBytes());
+      memset(ctrl_, kEmptyControlByte, NumControlBytes());
+    }
   }
 
   void DeallocateStorage() {
@@ -597,9 +812,13 @@ class HashSet {
       if (data_ != nullptr) {
         allocfn_.deallocate(data_, NumBuckets());
       }
+      if (ctrl_ != nullptr) {
+        ControlByteAllocator(allocfn_).deallocate(ctrl_, NumControlBytes());
+      }
       owns_data_ = false;
     }
     data_ = nullptr;
+    ctrl_ = nullptr;
     num_buckets_ = 0;
   }
 
@@ -617,14 +836,21 @@ class HashSet {
     }
     DCHECK_GE(new_size, Size());
     T* const old_data = data_;
+    uint8_t* const old_ctrl = ctrl_;
     size_t old_num_buckets = num_buckets_;
+    size_t old_num_control_bytes = NumControlBytes();
     // Reinsert all of the old elements.
     const bool owned_data = owns_data_;
     AllocateStorage(new_size);
     for (size_t i = 0; i < old_num_buckets; ++i) {
       T& element = old_data[i];
       if (!emptyfn_.IsEmpty(element)) {
-        data_[FirstAvailableSlot(IndexForHash(hashfn_(element)))] = std::move(element);
+        const size_t hash = hashfn_(element);
+        const size_t index = FirstAvailableSlot(IndexForHash(hash));
+        data_[index] = std::move(element);
+        if (kUseControlBytes) {
+          SetControlByte(index, ControlByteForHash(hash));
+        }
       }
       if (owned_data) {
         allocfn_.destroy(allocfn_.address(element));
@@ -632,6 +858,9 @@ class HashSet {
     }
     if (owned_data) {
       allocfn_.deallocate(old_data, old_num_buckets);
+      if (old_ctrl != nullptr) {
+        ControlByteAllocator(allocfn_).deallocate(old_ctrl, old_num_control_bytes);
+      }
     }
 
     // When we hit elements_until_expand_, we are at the max load factor and must expand again.
@@ -640,6 +869,14 @@ class HashSet {
 
   ALWAYS_INLINE size_t FirstAvailableSlot(size_t index) const {
     DCHECK_LT(index, NumBuckets());  // Don't try to get a slot out of range.
+    if (kUseControlBytes) {
+      uint64_t empties;
+      while ((empties = MatchControlBytes(ctrl_ + index, kEmptyControlByte)) == 0u) {
+        index = NextGroupIndex(index);
+      }
+      index += CTZ(empties) >> kControlMatchShift;
+      return (index >= num_buckets_) ? index - num_buckets_ : index;
+    }
     size_t non_empty_count = 0;
     while (!emptyfn_.IsEmpty(data_[index])) {
       index = NextIndex(index);
@@ -674,17 +911,18 @@ class HashSet {
   size_t num_elements_;  // Number of inserted elements.
   size_t num_buckets_;  // Number of hash table buckets.
   size_t elements_until_expand_;  // Maximum number of elements until we expand the table.
-  bool owns_data_;  // If we own data_ and are responsible for freeing it.
+  bool owns_data_;  // If we own data_ and ctrl_ and are responsible for freeing them.
   T* data_;  // Backing storage.
+  uint8_t* ctrl_;  // Control bytes if kUseControlBytes, null otherwise.
   double min_load_factor_;
   double max_load_factor_;
 
   ART_FRIEND_TEST(InternTableTest, CrossHash);
 };
 
-template <class T, class EmptyFn, class HashFn, class Pred, class Alloc>
-void swap(HashSet<T, EmptyFn, HashFn, Pred, Alloc>& lhs,
-          HashSet<T, EmptyFn, HashFn, Pred, Alloc>& rhs) {
+template <class T, class EmptyFn, class HashFn, class Pred, class Alloc, bool kUseControlBytes>
+void swap(HashSet<T, EmptyFn, HashFn, Pred, Alloc, kUseControlBytes>& lhs,
+          HashSet<T, EmptyFn, HashFn, Pred, Alloc, kUseControlBytes>& rhs) {
   lhs.swap(rhs);
 }
 
@@ -58,6 +58,9 @@ class HashSetTest : public testing::Test {
     return seed_;
   }
 
+  template <typename StringSet>
+  void StressTest();
+
  private:
   size_t seed_;
   size_t unique_number_;
@@ -214,8 +217,9 @@ TEST_F(HashSetTest, TestLoadFactor) {
   EXPECT_LE(hash_set.CalculateLoadFactor() - kEpsilon, hash_set.GetMaxLoadFactor());
 }
 
-TEST_F(HashSetTest, TestStress) {
-  HashSet<std::string, IsEmptyFnString> hash_set;
+template <typename StringSet>
+void HashSetTest::StressTest() {
+  StringSet hash_set;
   std::unordered_multiset<std::string> std_set;
   std::vector<std::string> strings;
   static constexpr size_t string_count = 2000;
@@ -254,9 +258,25 @@ TEST_F(HashSetTest, TestStress) {
         std_set.erase(it2);
       }
     }
+    if (i % 10000 == 0) {
+      ASSERT_EQ(hash_set.Verify(), 0u);
+    }
   }
 }
 
+TEST_F(HashSetTest, TestStress) {
+  StressTest<HashSet<std::string, IsEmptyFnString>>();
+}
+
+TEST_F(HashSetTest, TestStressControlBytes) {
+  StressTest<HashSet<std::string,
+                     IsEmptyFnString,
+                     std::hash<std::string>,
+                     std::equal_to<std::string>,
+                     std::allocator<std::string>,
+                     /* kUseControlBytes */ true>>();
+}
+
 struct IsEmptyStringPair {
   void MakeEmpty(std::pair<std::string, int>& pair) const {
     pair.first.clear();
@@ -354,4 +374,51 @@ TEST_F(HashSetTest, TestReserve) {
   CHECK_GE(hash_set.ElementsUntilExpand(), size);
 }
 
+TEST_F(HashSetTest, TestWriteAndReadControlBytes) {
+  using ElementSet = HashSet<uint32_t>;
+  using ControlByteSet = HashSet<uint32_t,
+                                 DefaultEmptyFn<uint32_t>,
+                                 std::hash<uint32_t>,
+                                 std::equal_to<uint32_t>,
+                                 std::allocator<uint32_t>,
+                                 /* kUseControlBytes */ true>;
+  static constexpr uint32_t kCount = 3000u;
+  ElementSet element_set;
+  ControlByteSet control_byte_set;
+  for (uint32_t i = 1u; i <= kCount; ++i) {
+    element_set.Insert(i * 7u);
+    control_byte_set.Insert(i * 7u);
+  }
+  ASSERT_EQ(control_byte_set.Verify(), 0u);
+
+  // Sets with control bytes are read in place.
+  std::vector<uint64_t> buffer(RoundUp(control_byte_set.WriteToMemory(nullptr), sizeof(uint64_t)) /
+                               sizeof(uint64_t));
+  uint8_t* data = reinterpret_cast<uint8_t*>(buffer.data());
+  const size_t written = control_byte_set.WriteToMemory(data);
+  size_t read_count = 0u;
+  ControlByteSet read_set(data, /* make_copy_of_data */ false, &read_count);
+  EXPECT_EQ(written, read_count);
+  EXPECT_FALSE(read_set.OwnsData());
+  // Sets without control bytes skip them.
+  ElementSet read_element_set(data, /* make_copy_of_data */ false, &read_count);
+  EXPECT_EQ(written, read_count);
+  // Sets with control bytes rebuild them when reading data written without them.
+  std::vector<uint64_t> element_buffer(
+      RoundUp(element_set.WriteToMemory(nullptr), sizeof(uint64_t)) / sizeof(uint64_t));
+  uint8_t* element_data = reinterpret_cast<uint8_t*>(element_buffer.data());
+  const size_t element_written = element_set.WriteToMemory(element_data);
+  ControlByteSet rebuilt_set(element_data, /* make_copy_of_data */ false, &read_count);
+  EXPECT_EQ(element_written, read_count);
+  EXPECT_TRUE(rebuilt_set.OwnsData());
+  EXPECT_EQ(rebuilt_set.Verify(), 0u);
+
+  for (uint32_t i = 1u; i <= kCount * 7u; ++i) {
+    const bool expected = (i % 7u) == 0u;
+    EXPECT_EQ(expected, read_set.Find(i) != read_set.end()) << i;
+    EXPECT_EQ(expected, read_element_set.Find(i) != read_element_set.end()) << i;
+    EXPECT_EQ(expected, rebuilt_set.Find(i) != rebuilt_set.end()) << i;
+  }
+}
+
 }  // namespace art
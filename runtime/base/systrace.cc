@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "systrace.h"
+
+#include "android-base/strings.h"
+
+#include "base/macros.h"
+
+namespace art {
+
+uint32_t gEnabledTraceCategories = kAllTraceCategories;
+
+static const char* const kTraceCategoryNames[] = {
+  "gc",
+  "jit",
+  "class-linking",
+  "verification",
+  "monitor-contention",
+};
+static_assert(arraysize(kTraceCategoryNames) == static_cast<size_t>(TraceCategory::kLast) + 1u,
+              "Missing trace category name");
+
+bool ParseTraceCategories(const std::string& categories, uint32_t* mask, std::string* error_msg) {
+  uint32_t result = 0u;
+  for (const std::string& name : android::base::Split(categories, ",")) {
+    if (name.empty()) {
+      continue;
+    }
+    if (name == "all") {
+      result |= kAllTraceCategories;
+      continue;
+    }
+    size_t i = 0;
+    while (i != arraysize(kTraceCategoryNames) && name != kTraceCategoryNames[i]) {
+      ++i;
+    }
+    if (i == arraysize(kTraceCategoryNames)) {
+      *error_msg = "Unknown trace category '" + name + "'";
+      return false;
+    }
+    result |= 1u << i;
+  }
+  *mask = result;
+  return true;
+}
+
+}  // namespace art
@@ -20,6 +20,8 @@
 #define ATRACE_TAG ATRACE_TAG_DALVIK
 #include <cutils/trace.h>
 
+#include <stdint.h>
+
 #include <sstream>
 #include <string>
 
@@ -27,42 +29,102 @@
 
 namespace art {
 
+// Groups of trace markers that can be enabled separately with -XX:TraceCategories, so that the
+// cheap ones can be left on while tracing in the field. Markers without a category are only
+// subject to the ATRACE_TAG_DALVIK tag.
+enum class TraceCategory : uint32_t {
+  kGc,
+  kJit,
+  kClassLinking,
+  kVerification,
+  kMonitorContention,
+  kLast = kMonitorContention,
+};
+
+static constexpr uint32_t kAllTraceCategories =
+    (1u << (static_cast<uint32_t>(TraceCategory::kLast) + 1u)) - 1u;
+
+// The mask of the enabled categories, all of them by default. Only written during startup.
+extern uint32_t gEnabledTraceCategories;
+
+// Parses a comma separated list of category names, e.g. "gc,jit", into a mask. Returns false and
+// sets error_msg if a name is unknown.
+bool ParseTraceCategories(const std::string& categories, uint32_t* mask, std::string* error_msg);
+
+// A load and a test of the mask before the cached check of the trace tag, cheap enough for hot
+// paths.
+static inline bool IsTraceCategoryEnabled(TraceCategory category) {
+  return (gEnabledTraceCategories & (1u << static_cast<uint32_t>(category))) != 0u &&
+      ATRACE_ENABLED();
+}
+
+// Sets the value of the counter track `name`. Callers of values that are expensive to compute
+// should check IsTraceCategoryEnabled() first.
+static inline void TraceCounter(TraceCategory category, const char* name, int64_t value) {
+  if (IsTraceCategoryEnabled(category)) {
+    ATRACE_INT64(name, value);
+  }
+}
+
 class ScopedTrace {
  public:
-  explicit ScopedTrace(const char* name) {
+  explicit ScopedTrace(const char* name) : started_(true) {
     ATRACE_BEGIN(name);
   }
   template <typename Fn>
-  explicit ScopedTrace(Fn fn) {
-    if (ATRACE_ENABLED()) {
+  explicit ScopedTrace(Fn fn) : started_(ATRACE_ENABLED()) {
+    if (started_) {
       ATRACE_BEGIN(fn().c_str());
     }
   }
 
   explicit ScopedTrace(const std::string& name) : ScopedTrace(name.c_str()) {}
 
+  ScopedTrace(TraceCategory category, const char* name)
+      : started_(IsTraceCategoryEnabled(category)) {
+    if (started_) {
+      ATRACE_BEGIN(name);
+    }
+  }
+  // The name is only built if the category is traced.
+  template <typename Fn>
+  ScopedTrace(TraceCategory category, Fn fn) : started_(IsTraceCategoryEnabled(category)) {
+    if (started_) {
+      ATRACE_BEGIN(fn().c_str());
+    }
+  }
+
   ~ScopedTrace() {
-    ATRACE_END();
+    if (started_) {
+      ATRACE_END();
+    }
   }
+
+ private:
+  // Whether there is a begin marker to end, the tag or category may be enabled in between.
+  const bool started_;
 };
 
-// Helper for the SCOPED_TRACE macro. Do not use directly.
+// Helper for the SCOPED_TRACE macros. Do not use directly.
 class ScopedTraceNoStart {
  public:
-  ScopedTraceNoStart() {
+  ScopedTraceNoStart() : started_(false) {
   }
 
   ~ScopedTraceNoStart() {
-    ATRACE_END();
+    if (started_) {
+      ATRACE_END();
+    }
   }
 
   // Message helper for the macro. Do not use directly.
   class ScopedTraceMessageHelper {
    public:
-    ScopedTraceMessageHelper() {
+    explicit ScopedTraceMessageHelper(ScopedTraceNoStart* trace) : trace_(trace) {
     }
     ~ScopedTraceMessageHelper() {
       ATRACE_BEGIN(buffer_.str().c_str());
+      trace_->started_ = true;
     }
 
     std::ostream& stream() {
@@ -70,13 +132,24 @@ class ScopedTraceNoStart {
     }
 
    private:
+    ScopedTraceNoStart* const trace_;
     std::ostringstream buffer_;
   };
+
+ private:
+  bool started_;
 };
 
 #define SCOPED_TRACE \
   ::art::ScopedTraceNoStart trace ## __LINE__; \
-  (ATRACE_ENABLED()) && ::art::ScopedTraceNoStart::ScopedTraceMessageHelper().stream()
+  (ATRACE_ENABLED()) && \
+      ::art::ScopedTraceNoStart::ScopedTraceMessageHelper(&trace ## __LINE__).stream()
+
+// Like SCOPED_TRACE, for markers of the given TraceCategory.
+#define SCOPED_TRACE_CATEGORY(category) \
+  ::art::ScopedTraceNoStart trace ## __LINE__; \
+  (::art::IsTraceCategoryEnabled(category)) && \
+      ::art::ScopedTraceNoStart::ScopedTraceMessageHelper(&trace ## __LINE__).stream()
 
 }  // namespace art
 
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "systrace.h"
+
+#include "gtest/gtest.h"
+
+namespace art {
+
+static uint32_t Bit(TraceCategory category) {
+  return 1u << static_cast<uint32_t>(category);
+}
+
+TEST(Systrace, ParseTraceCategories) {
+  uint32_t mask = 0u;
+  std::string error_msg;
+  ASSERT_TRUE(ParseTraceCategories("gc,jit", &mask, &error_msg)) << error_msg;
+  EXPECT_EQ(Bit(TraceCategory::kGc) | Bit(TraceCategory::kJit), mask);
+
+  ASSERT_TRUE(ParseTraceCategories("class-linking,,monitor-contention", &mask, &error_msg))
+      << error_msg;
+  EXPECT_EQ(Bit(TraceCategory::kClassLinking) | Bit(TraceCategory::kMonitorContention), mask);
+
+  ASSERT_TRUE(ParseTraceCategories("all", &mask, &error_msg)) << error_msg;
+  EXPECT_EQ(kAllTraceCategories, mask);
+
+  ASSERT_TRUE(ParseTraceCategories("", &mask, &error_msg)) << error_msg;
+  EXPECT_EQ(0u, mask);
+
+  // The mask is left unchanged on errors.
+  mask = Bit(TraceCategory::kVerification);
+  EXPECT_FALSE(ParseTraceCategories("gc,locks", &mask, &error_msg));
+  EXPECT_NE(std::string::npos, error_msg.find("locks"));
+  EXPECT_EQ(Bit(TraceCategory::kVerification), mask);
+}
+
+}  // namespace art
@@ -27,6 +27,7 @@
 #include "gc/heap.h"
 #include "runtime.h"
 #include "thread-current-inl.h"
+#include "timing_trace.h"
 
 #include <cmath>
 #include <iomanip>
@@ -140,15 +141,34 @@ void TimingLogger::Reset() {
   timings_.clear();
 }
 
+// Looked up for each split, as loggers such as the dex2oat ones are created before the runtime.
+static TimingTrace* GetTimingTrace() {
+  Runtime* runtime = Runtime::Current();
+  return (runtime != nullptr) ? runtime->GetTimingTrace() : nullptr;
+}
+
+uint64_t TimingLogger::GetTraceTime() const {
+  // The trace is on the monotonic clock, to be comparable with the other processes.
+  return (kind_ == TimingKind::kMonotonic) ? timings_.back().GetTime() : NanoTime();
+}
+
 void TimingLogger::StartTiming(const char* label) {
   DCHECK(label != nullptr);
   timings_.push_back(Timing(kind_, label));
   ATRACE_BEGIN(label);
+  TimingTrace* trace = GetTimingTrace();
+  if (trace != nullptr) {
+    trace->Begin(label, GetTraceTime());
+  }
 }
 
 void TimingLogger::EndTiming() {
   timings_.push_back(Timing(kind_, nullptr));
   ATRACE_END();
+  TimingTrace* trace = GetTimingTrace();
+  if (trace != nullptr) {
+    trace->End(GetTraceTime());
+  }
 }
 
 uint64_t TimingLogger::GetTotalNs() const {
@@ -212,6 +212,9 @@ class TimingLogger {
   std::vector<Timing> timings_;
 
  private:
+  // The time of the last timing for the TimingTrace.
+  uint64_t GetTraceTime() const;
+
   DISALLOW_COPY_AND_ASSIGN(TimingLogger);
 };
 
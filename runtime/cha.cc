@@ -575,11 +575,17 @@ void ClassHierarchyAnalysis::InvalidateSingleImplementationMethods(
       return;
     }
     // Deoptimze compiled code on stack that should have been invalidated.
-    CHACheckpoint checkpoint(dependent_method_headers);
-    size_t threads_running_checkpoint = runtime->GetThreadList()->RunCheckpoint(&checkpoint);
-    if (threads_running_checkpoint != 0) {
-      checkpoint.WaitForThreadsToRunThroughCheckpoint(threads_running_checkpoint);
-    }
+    DeoptimizeFramesRunning(dependent_method_headers);
+  }
+}
+
+void ClassHierarchyAnalysis::DeoptimizeFramesRunning(
+    const std::unordered_set<OatQuickMethodHeader*>& method_headers) {
+  CHACheckpoint checkpoint(method_headers);
+  size_t threads_running_checkpoint =
+      Runtime::Current()->GetThreadList()->RunCheckpoint(&checkpoint);
+  if (threads_running_checkpoint != 0) {
+    checkpoint.WaitForThreadsToRunThroughCheckpoint(threads_running_checkpoint);
   }
 }
 
@@ -118,6 +118,12 @@ class ClassHierarchyAnalysis {
   void RemoveDependenciesForLinearAlloc(const LinearAlloc* linear_alloc)
       REQUIRES(!Locks::cha_lock_);
 
+  // Set the should_deoptimize flag of the frames running the compiled code of `method_headers`,
+  // on all threads. These frames deoptimize at their next check of the flag.
+  static void DeoptimizeFramesRunning(
+      const std::unordered_set<OatQuickMethodHeader*>& method_headers)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
  private:
   void InitSingleImplementationFlag(Handle<mirror::Class> klass,
                                     ArtMethod* method,
@@ -47,6 +47,7 @@
 #include "cha.h"
 #include "class_linker-inl.h"
 #include "class_loader_utils.h"
+#include "class_path_index.h"
 #include "class_table-inl.h"
 #include "compiler_callbacks.h"
 #include "debugger.h"
@@ -111,6 +112,7 @@
 #include "os.h"
 #include "runtime.h"
 #include "runtime_callbacks.h"
+#include "runtime_counters.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
 #include "thread_list.h"
@@ -822,6 +824,9 @@ bool ClassLinker::InitWithoutImage(std::vector<std::unique_ptr<const DexFile>> b
 void ClassLinker::FinishInit(Thread* self) {
   VLOG(startup) << "ClassLinker::FinishInit entering";
 
+  // The boot class path is complete, index it so that each lookup is a single probe.
+  boot_class_path_index_.reset(new ClassPathIndex(boot_class_path_));
+
   // Let the heap know some key offsets into java.lang.ref instances
   // Note: we hard code the field indexes here rather than using FindInstanceField
   // as the types of the field can't be resolved prior to the runtime being
@@ -2169,9 +2174,18 @@ ClassLinker::~ClassLinker() {
     DeleteClassLoader(self, data);
   }
   class_loaders_.clear();
+  for (const ClassLoaderData& data : unloaded_class_loaders_) {
+    FreeClassLoader(data);
+  }
+  unloaded_class_loaders_.clear();
 }
 
 void ClassLinker::DeleteClassLoader(Thread* self, const ClassLoaderData& data) {
+  UnlinkClassLoader(self, data);
+  FreeClassLoader(data);
+}
+
+void ClassLinker::UnlinkClassLoader(Thread* self, const ClassLoaderData& data) {
   Runtime* const runtime = Runtime::Current();
   JavaVMExt* const vm = runtime->GetJavaVM();
   vm->DeleteWeakGlobalRef(self, data.weak_root);
@@ -2186,6 +2200,9 @@ void ClassLinker::DeleteClassLoader(Thread* self, const ClassLoaderData& data) {
     // If we don't have a JIT, we need to manually remove the CHA dependencies manually.
     cha_->RemoveDependenciesForLinearAlloc(data.allocator);
   }
+}
+
+void ClassLinker::FreeClassLoader(const ClassLoaderData& data) {
   delete data.allocator;
   delete data.class_table;
 }
@@ -2353,6 +2370,24 @@ ClassPathEntry FindInClassPath(const char* descriptor,
   return ClassPathEntry(nullptr, nullptr);
 }
 
+ClassPathEntry ClassLinker::FindInBootClassPath(const char* descriptor, size_t hash) {
+  if (boot_class_path_index_ == nullptr) {
+    return FindInClassPath(descriptor, hash, boot_class_path_);
+  }
+  ClassPathEntry pair = boot_class_path_index_->Find(descriptor, hash);
+  // Search the dex files appended after the index was built, e.g. by agents, one by one.
+  for (size_t i = boot_class_path_index_->NumDexFiles();
+       pair.second == nullptr && i < boot_class_path_.size();
+       ++i) {
+    const DexFile* dex_file = boot_class_path_[i];
+    const DexFile::ClassDef* dex_class_def = OatDexFile::FindClassDef(*dex_file, descriptor, hash);
+    if (dex_class_def != nullptr) {
+      pair = ClassPathEntry(dex_file, dex_class_def);
+    }
+  }
+  return pair;
+}
+
 bool ClassLinker::FindClassInBaseDexClassLoader(ScopedObjectAccessAlreadyRunnable& soa,
                                                 Thread* self,
                                                 const char* descriptor,
@@ -2417,7 +2452,7 @@ ObjPtr<mirror::Class> ClassLinker::FindClassInBootClassLoaderClassPath(Thread* s
                                                                        const char* descriptor,
                                                                        size_t hash) {
   ObjPtr<mirror::Class> result = nullptr;
-  ClassPathEntry pair = FindInClassPath(descriptor, hash, boot_class_path_);
+  ClassPathEntry pair = FindInBootClassPath(descriptor, hash);
   if (pair.second != nullptr) {
     ObjPtr<mirror::Class> klass = LookupClass(self, descriptor, hash, nullptr);
     if (klass != nullptr) {
@@ -2447,67 +2482,31 @@ ObjPtr<mirror::Class> ClassLinker::FindClassInBaseDexClassLoaderClassPath(
       << "Unexpected class loader for descriptor " << descriptor;
 
   Thread* self = soa.Self();
-  ArtField* const cookie_field =
-      jni::DecodeArtField(WellKnownClasses::dalvik_system_DexFile_cookie);
-  ArtField* const dex_file_field =
-      jni::DecodeArtField(WellKnownClasses::dalvik_system_DexPathList__Element_dexFile);
-  ObjPtr<mirror::Object> dex_path_list =
-      jni::DecodeArtField(WellKnownClasses::dalvik_system_BaseDexClassLoader_pathList)->
-          GetObject(class_loader.Get());
-  if (dex_path_list != nullptr && dex_file_field != nullptr && cookie_field != nullptr) {
-    // DexPathList has an array dexElements of Elements[] which each contain a dex file.
-    ObjPtr<mirror::Object> dex_elements_obj =
-        jni::DecodeArtField(WellKnownClasses::dalvik_system_DexPathList_dexElements)->
-            GetObject(dex_path_list);
-    // Loop through each dalvik.system.DexPathList$Element's dalvik.system.DexFile and look
-    // at the mCookie which is a DexFile vector.
-    if (dex_elements_obj != nullptr) {
-      StackHandleScope<1> hs(self);
-      Handle<mirror::ObjectArray<mirror::Object>> dex_elements =
-          hs.NewHandle(dex_elements_obj->AsObjectArray<mirror::Object>());
-      for (int32_t i = 0; i < dex_elements->GetLength(); ++i) {
-        ObjPtr<mirror::Object> element = dex_elements->GetWithoutChecks(i);
-        if (element == nullptr) {
-          // Should never happen, fall back to java code to throw a NPE.
-          break;
-        }
-        ObjPtr<mirror::Object> dex_file = dex_file_field->GetObject(element);
-        if (dex_file != nullptr) {
-          ObjPtr<mirror::LongArray> long_array = cookie_field->GetObject(dex_file)->AsLongArray();
-          if (long_array == nullptr) {
-            // This should never happen so log a warning.
-            LOG(WARNING) << "Null DexFile::mCookie for " << descriptor;
-            break;
-          }
-          int32_t long_array_size = long_array->GetLength();
-          // First element is the oat file.
-          for (int32_t j = kDexFileIndexStart; j < long_array_size; ++j) {
-            const DexFile* cp_dex_file = reinterpret_cast<const DexFile*>(static_cast<uintptr_t>(
-                long_array->GetWithoutChecks(j)));
-            const DexFile::ClassDef* dex_class_def =
-                OatDexFile::FindClassDef(*cp_dex_file, descriptor, hash);
-            if (dex_class_def != nullptr) {
-              ObjPtr<mirror::Class> klass = DefineClass(self,
-                                                        descriptor,
-                                                        hash,
-                                                        class_loader,
-                                                        *cp_dex_file,
-                                                        *dex_class_def);
-              if (klass == nullptr) {
-                CHECK(self->IsExceptionPending()) << descriptor;
-                self->ClearException();
-                // TODO: Is it really right to break here, and not check the other dex files?
-                return nullptr;
-              }
-              return klass;
-            }
-          }
-        }
+  ObjPtr<mirror::Class> ret = nullptr;
+  VisitClassLoaderDexFiles(soa, class_loader, [&](const DexFile* cp_dex_file)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    const DexFile::ClassDef* dex_class_def =
+        OatDexFile::FindClassDef(*cp_dex_file, descriptor, hash);
+    if (dex_class_def != nullptr) {
+      ObjPtr<mirror::Class> klass = DefineClass(self,
+                                                descriptor,
+                                                hash,
+                                                class_loader,
+                                                *cp_dex_file,
+                                                *dex_class_def);
+      if (klass == nullptr) {
+        CHECK(self->IsExceptionPending()) << descriptor;
+        self->ClearException();
+        // TODO: Is it really right to stop here, and not check the other dex files?
+        return false;
       }
+      ret = klass;
+      return false;
     }
-    self->AssertNoPendingException();
-  }
-  return nullptr;
+    return true;
+  });
+  self->AssertNoPendingException();
+  return ret;
 }
 
 mirror::Class* ClassLinker::FindClass(Thread* self,
@@ -2531,7 +2530,7 @@ mirror::Class* ClassLinker::FindClass(Thread* self,
   // Class is not yet loaded.
   if (descriptor[0] != '[' && class_loader == nullptr) {
     // Non-array class and the boot class loader, search the boot class path.
-    ClassPathEntry pair = FindInClassPath(descriptor, hash, boot_class_path_);
+    ClassPathEntry pair = FindInBootClassPath(descriptor, hash);
     if (pair.second != nullptr) {
       return DefineClass(self,
                          descriptor,
@@ -2687,6 +2686,10 @@ mirror::Class* ClassLinker::DefineClass(Thread* self,
                                         Handle<mirror::ClassLoader> class_loader,
                                         const DexFile& dex_file,
                                         const DexFile::ClassDef& dex_class_def) {
+  ScopedTrace trace(TraceCategory::kClassLinking, [&]() {
+    return std::string("DefineClass ") + descriptor;
+  });
+  const uint64_t start_time = NanoTime();
   StackHandleScope<3> hs(self);
   auto klass = hs.NewHandle<mirror::Class>(nullptr);
 
@@ -2839,6 +2842,9 @@ mirror::Class* ClassLinker::DefineClass(Thread* self,
   // Notify native debugger of the new class and its layout.
   jit::Jit::NewTypeLoadedIfUsingJit(h_new_class.Get());
 
+  RuntimeCounters* counters = Runtime::Current()->GetRuntimeCounters();
+  counters->Increment(self, kCounterClassesDefined);
+  counters->AddTiming(self, kTimingClassDefine, NsToUs(NanoTime() - start_time));
   return h_new_class.Get();
 }
 
@@ -2982,6 +2988,10 @@ void ClassLinker::FixupStaticTrampolines(ObjPtr<mirror::Class> klass) {
     if (runtime->IsAotCompiler() || runtime->GetHeap()->HasBootImageSpace()) {
       return;  // OAT file unavailable.
     }
+  } else if (klass->NumDirectMethods() > kMaxEagerlyLinkedDirectMethods) {
+    // The resolution trampoline links each static method on its first invoke, see
+    // LinkStaticMethodCode().
+    return;
   }
 
   const DexFile& dex_file = klass->GetDexFile();
@@ -3020,6 +3030,23 @@ void ClassLinker::FixupStaticTrampolines(ObjPtr<mirror::Class> klass) {
   // Ignore virtual methods on the iterator.
 }
 
+const void* ClassLinker::LinkStaticMethodCode(ArtMethod* method) {
+  DCHECK(method->IsStatic());
+  DCHECK(method->GetDeclaringClass()->IsInitialized()) << method->PrettyMethod();
+  // Another thread may have already linked the method.
+  if (IsQuickResolutionStub(method->GetEntryPointFromQuickCompiledCode())) {
+    const void* quick_code = method->GetOatMethodQuickCode(image_pointer_size_);
+    // Same as FixupStaticTrampolines(), for a single method.
+    if (quick_code == nullptr && method->IsNative()) {
+      quick_code = GetQuickGenericJniStub();
+    } else if (ShouldUseInterpreterEntrypoint(method, quick_code)) {
+      quick_code = GetQuickToInterpreterBridge();
+    }
+    Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(method, quick_code);
+  }
+  return method->GetEntryPointFromQuickCompiledCode();
+}
+
 // Does anything needed to make sure that the compiler will not generate a direct invoke to this
 // method. Should only be called on non-invokable methods.
 inline void EnsureThrowsInvocationError(ClassLinker* class_linker, ArtMethod* method) {
@@ -4471,6 +4498,15 @@ mirror::Class* ClassLinker::CreateProxyClass(ScopedObjectAccessAlreadyRunnable&
 
   Runtime::Current()->GetRuntimeCallbacks()->ClassPrepare(temp_klass, klass);
 
+  // SubtypeCheckInfo::Initialized must happen-before any new-instance for that type. The proxy
+  // class does not go through EnsureInitialized(), and compiled code checks an instance of it
+  // against the bitstring of java.lang.reflect.Proxy.
+  {
+    MutexLock subtype_check_lock(self, *Locks::subtype_check_lock_);
+    ObjPtr<mirror::Class> klass_ptr(klass.Get());
+    SubtypeCheck<ObjPtr<mirror::Class>>::EnsureInitialized(klass_ptr);
+  }
+
   {
     // Lock on klass is released. Lock new class object.
     ObjectLock<mirror::Class> initialization_lock(self, klass);
@@ -4908,6 +4944,10 @@ bool ClassLinker::InitializeClass(Thread* self, Handle<mirror::Class> klass,
       FixupStaticTrampolines(klass.Get());
     }
   }
+  if (success) {
+    // Static methods can only be JIT compiled once the class is initialized.
+    jit::Jit::NewTypeInitializedIfUsingJit(klass.Get());
+  }
   return success;
 }
 
@@ -6805,23 +6845,27 @@ class ClassLinker::LinkInterfaceMethodsHelper {
     }
   }
 
-  void ClobberOldMethods(LengthPrefixedArray<ArtMethod>* old_methods,
-                         LengthPrefixedArray<ArtMethod>* methods) {
-    if (kIsDebugBuild) {
-      CHECK(methods != nullptr);
-      // Put some random garbage in old methods to help find stale pointers.
-      if (methods != old_methods && old_methods != nullptr) {
-        // Need to make sure the GC is not running since it could be scanning the methods we are
-        // about to overwrite.
-        ScopedThreadStateChange tsc(self_, kSuspended);
-        gc::ScopedGCCriticalSection gcs(self_,
-                                        gc::kGcCauseClassLinker,
-                                        gc::kCollectorTypeClassLinker);
-        const size_t old_size = LengthPrefixedArray<ArtMethod>::ComputeSize(old_methods->size(),
-                                                                            method_size_,
-                                                                            method_alignment_);
+  // Releases the old methods moved by ReallocMethods() for reuse by the linear alloc.
+  void FreeOldMethods(LengthPrefixedArray<ArtMethod>* old_methods,
+                      LengthPrefixedArray<ArtMethod>* methods)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    DCHECK(methods != nullptr);
+    if (methods != old_methods && old_methods != nullptr) {
+      LinearAlloc* allocator = class_linker_->GetAllocatorForClassLoader(klass_->GetClassLoader());
+      const size_t old_size = LengthPrefixedArray<ArtMethod>::ComputeSize(old_methods->size(),
+                                                                          method_size_,
+                                                                          method_alignment_);
+      // Need to make sure the GC is not running since it could be scanning the methods we are
+      // about to overwrite or let the linear alloc reuse.
+      ScopedThreadStateChange tsc(self_, kSuspended);
+      gc::ScopedGCCriticalSection gcs(self_,
+                                      gc::kGcCauseClassLinker,
+                                      gc::kCollectorTypeClassLinker);
+      if (kIsDebugBuild) {
+        // Put some random garbage in old methods to help find stale pointers.
         memset(old_methods, 0xFEu, old_size);
       }
+      allocator->Free(self_, old_methods, old_size);
     }
   }
 
@@ -7438,9 +7482,9 @@ bool ClassLinker::LinkInterfaceMethods(
   }  // For each interface.
   // TODO don't extend virtuals of interface unless necessary (when is it?).
   if (helper.HasNewVirtuals()) {
-    LengthPrefixedArray<ArtMethod>* old_methods = kIsDebugBuild ? klass->GetMethodsPtr() : nullptr;
+    LengthPrefixedArray<ArtMethod>* old_methods = klass->GetMethodsPtr();
     helper.ReallocMethods();  // No return value to check. Native allocation failure aborts.
-    LengthPrefixedArray<ArtMethod>* methods = kIsDebugBuild ? klass->GetMethodsPtr() : nullptr;
+    LengthPrefixedArray<ArtMethod>* methods = klass->GetMethodsPtr();
 
     // Done copying methods, they are all roots in the class now, so we can end the no thread
     // suspension assert.
@@ -7457,7 +7501,7 @@ bool ClassLinker::LinkInterfaceMethods(
     }
 
     helper.CheckNoStaleMethodsInDexCache();
-    helper.ClobberOldMethods(old_methods, methods);
+    helper.FreeOldMethods(old_methods, methods);
   } else {
     self->EndAssertNoThreadSuspension(old_cause);
   }
@@ -7801,6 +7845,7 @@ ObjPtr<mirror::Class> ClassLinker::DoResolveType(dex::TypeIndex type_idx,
     //       boot class loader. This was to permit different classes with the
     //       same name to be loaded simultaneously by different loaders
     dex_cache->SetResolvedType(type_idx, resolved);
+    Runtime::Current()->GetRuntimeCounters()->Increment(self, kCounterTypesResolved);
   } else {
     CHECK(self->IsExceptionPending())
         << "Expected pending exception for failed resolution of: " << descriptor;
@@ -7983,6 +8028,8 @@ ArtMethod* ClassLinker::ResolveMethod(uint32_t method_idx,
     if (resolved != nullptr) {
       // Be a good citizen and update the dex cache to speed subsequent calls.
       dex_cache->SetResolvedMethod(method_idx, resolved, pointer_size);
+      Runtime::Current()->GetRuntimeCounters()->Increment(Thread::Current(),
+                                                          kCounterMethodsResolved);
     }
   }
 
@@ -8132,6 +8179,7 @@ ArtField* ClassLinker::ResolveField(uint32_t field_idx,
     }
   }
   dex_cache->SetResolvedField(field_idx, resolved, image_pointer_size_);
+  Runtime::Current()->GetRuntimeCounters()->Increment(self, kCounterFieldsResolved);
   return resolved;
 }
 
@@ -8593,6 +8641,7 @@ void ClassLinker::DumpForSigQuit(std::ostream& os) {
   ReaderMutexLock mu(soa.Self(), *Locks::classlinker_classes_lock_);
   os << "Zygote loaded classes=" << NumZygoteClasses() << " post zygote classes="
      << NumNonZygoteClasses() << "\n";
+  mirror::DexCache::DumpConflictCounts(os);
 }
 
 class CountClassesVisitor : public ClassLoaderVisitor {
@@ -8878,8 +8927,36 @@ void ClassLinker::CleanupClassLoaders() {
       }
     }
   }
+  if (to_delete.empty()) {
+    return;
+  }
+  // The JIT code and the CHA dependencies refer to the methods of the class loaders, whose
+  // declaring classes are dead, so they are removed now. Nothing refers to the class tables and
+  // the linear allocs once unlinked, and freeing them, which can take a while for large class
+  // loaders, is left to the heap task thread.
   for (ClassLoaderData& data : to_delete) {
-    DeleteClassLoader(self, data);
+    UnlinkClassLoader(self, data);
+  }
+  {
+    WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
+    unloaded_class_loaders_.insert(unloaded_class_loaders_.end(),
+                                   to_delete.begin(),
+                                   to_delete.end());
+  }
+  if (!Runtime::Current()->GetHeap()->RequestFreeUnloadedClassLoaders(self)) {
+    FreeUnloadedClassLoaders(self);
+  }
+}
+
+void ClassLinker::FreeUnloadedClassLoaders(Thread* self) {
+  std::vector<ClassLoaderData> to_free;
+  {
+    WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
+    to_free.swap(unloaded_class_loaders_);
+  }
+  ScopedTrace trace("Free unloaded class loaders");
+  for (const ClassLoaderData& data : to_free) {
+    FreeClassLoader(data);
   }
 }
 
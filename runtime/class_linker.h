@@ -68,6 +68,7 @@ using MethodDexCacheType = std::atomic<MethodDexCachePair>;
 }  // namespace mirror
 
 class ClassHierarchyAnalysis;
+class ClassPathIndex;
 class ClassTable;
 template<class T> class Handle;
 class ImtConflictTable;
@@ -502,6 +503,16 @@ class ClassLinker {
   const void* GetQuickOatCodeFor(ArtMethod* method)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Classes with more direct methods than this keep the resolution trampoline of their static
+  // methods once initialized, each method is linked on its first invoke instead. This way
+  // initializing a large class only dirties the methods which actually run.
+  static constexpr size_t kMaxEagerlyLinkedDirectMethods = 64u;
+
+  // Links the code of a static method of an initialized class, which is still entered through
+  // the resolution trampoline. Returns the new entrypoint of the method.
+  const void* LinkStaticMethodCode(ArtMethod* method)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   pid_t GetClassesLockOwner();  // For SignalCatcher.
   pid_t GetDexLockOwner();  // For SignalCatcher.
 
@@ -598,11 +609,18 @@ class ClassLinker {
   // entries are roots, but potentially not image classes.
   void DropFindArrayClassCache() REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Clean up class loaders, this needs to happen after JNI weak globals are cleared.
+  // Clean up class loaders, this needs to happen after JNI weak globals are cleared. The dead
+  // class loaders are unlinked from the runtime and the JIT, and their class tables and linear
+  // allocs are freed later by FreeUnloadedClassLoaders(), on the heap task thread when possible,
+  // so that the GC does not wait for it.
   void CleanupClassLoaders()
       REQUIRES(!Locks::classlinker_classes_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Free the class tables and linear allocs of the class loaders unlinked by
+  // CleanupClassLoaders().
+  void FreeUnloadedClassLoaders(Thread* self) REQUIRES(!Locks::classlinker_classes_lock_);
+
   // Unlike GetOrCreateAllocatorForClassLoader, GetAllocatorForClassLoader asserts that the
   // allocator for this class loader is already created.
   LinearAlloc* GetAllocatorForClassLoader(ObjPtr<mirror::ClassLoader> class_loader)
@@ -747,6 +765,13 @@ class ClassLinker {
 
   void DeleteClassLoader(Thread* self, const ClassLoaderData& data)
       REQUIRES_SHARED(Locks::mutator_lock_);
+  // Removes the references of the runtime to a dead class loader and its methods, the first step
+  // of DeleteClassLoader().
+  void UnlinkClassLoader(Thread* self, const ClassLoaderData& data)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+  // Frees the class table and the linear alloc of an unlinked class loader, the second step of
+  // DeleteClassLoader().
+  static void FreeClassLoader(const ClassLoaderData& data);
 
   void VisitClassesInternal(ClassVisitor* visitor)
       REQUIRES_SHARED(Locks::classlinker_classes_lock_, Locks::mutator_lock_);
@@ -873,6 +898,11 @@ class ClassLinker {
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::dex_lock_);
 
+  // Finds the first dex file of the boot class path defining the descriptor and its class def,
+  // or returns nulls if there is none. Does not load the class.
+  std::pair<const DexFile*, const DexFile::ClassDef*> FindInBootClassPath(const char* descriptor,
+                                                                          size_t hash);
+
   // Finds the class in the boot class loader.
   // If the class is found the method returns the resolved class. Otherwise it returns null.
   ObjPtr<mirror::Class> FindClassInBootClassLoaderClassPath(Thread* self,
@@ -1251,6 +1281,8 @@ class ClassLinker {
 
   std::vector<const DexFile*> boot_class_path_;
   std::vector<std::unique_ptr<const DexFile>> boot_dex_files_;
+  // Index of the boot class path, built once it is complete in FinishInit().
+  std::unique_ptr<const ClassPathIndex> boot_class_path_index_;
 
   // JNI weak globals and side data to allow dex caches to get unloaded. We lazily delete weak
   // globals when we register new dex files.
@@ -1261,6 +1293,10 @@ class ClassLinker {
   std::list<ClassLoaderData> class_loaders_
       GUARDED_BY(Locks::classlinker_classes_lock_);
 
+  // The class loaders unlinked by CleanupClassLoaders() and not yet freed.
+  std::vector<ClassLoaderData> unloaded_class_loaders_
+      GUARDED_BY(Locks::classlinker_classes_lock_);
+
   // Boot class path table. Since the class loader for this is null.
   std::unique_ptr<ClassTable> boot_class_table_ GUARDED_BY(Locks::classlinker_classes_lock_);
 
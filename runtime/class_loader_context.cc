@@ -16,6 +16,10 @@
 
 #include "class_loader_context.h"
 
+#include <inttypes.h>
+
+#include "android-base/stringprintf.h"
+
 #include "art_field-inl.h"
 #include "base/dchecked_vector.h"
 #include "base/stl_util.h"
@@ -34,6 +38,8 @@
 
 namespace art {
 
+using android::base::StringPrintf;
+
 static constexpr char kPathClassLoaderString[] = "PCL";
 static constexpr char kDelegateLastClassLoaderString[] = "DLC";
 static constexpr char kClassLoaderOpeningMark = '[';
@@ -356,6 +362,37 @@ std::string ClassLoaderContext::EncodeContext(const std::string& base_dir,
   return out.str();
 }
 
+std::string ClassLoaderContext::GetFingerprint() const {
+  CheckDexFilesOpened("GetFingerprint");
+  if (!fingerprint_.empty()) {
+    return fingerprint_;
+  }
+  // 64-bit FNV-1a, which does not depend on the host like std::hash, since the fingerprint is
+  // computed by dex2oat and compared by the runtime.
+  uint64_t hash = UINT64_C(14695981039346656037);
+  auto add = [&hash](const void* data, size_t size) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    for (size_t i = 0; i != size; ++i) {
+      hash = (hash ^ bytes[i]) * UINT64_C(1099511628211);
+    }
+  };
+  for (const ClassLoaderInfo& info : class_loader_chain_) {
+    const char* type_name = GetClassLoaderTypeName(info.type);
+    add(type_name, strlen(type_name) + 1u);
+    const uint32_t num_dex_files = info.opened_dex_files.size();
+    add(&num_dex_files, sizeof(num_dex_files));
+    for (const std::unique_ptr<const DexFile>& dex_file : info.opened_dex_files) {
+      const std::string& location = dex_file->GetLocation();
+      const size_t name_begin = location.rfind('/') + 1u;  // 0 if there is no '/'.
+      add(location.c_str() + name_begin, location.size() - name_begin + 1u);
+      const uint32_t checksum = dex_file->GetLocationChecksum();
+      add(&checksum, sizeof(checksum));
+    }
+  }
+  fingerprint_ = StringPrintf("%016" PRIx64, hash);
+  return fingerprint_;
+}
+
 jobject ClassLoaderContext::CreateClassLoader(
     const std::vector<const DexFile*>& compilation_sources) const {
   CheckDexFilesOpened("CreateClassLoader");
@@ -647,10 +684,17 @@ static bool IsAbsoluteLocation(const std::string& location) {
   return !location.empty() && location[0] == '/';
 }
 
-bool ClassLoaderContext::VerifyClassLoaderContextMatch(const std::string& context_spec) const {
+bool ClassLoaderContext::VerifyClassLoaderContextMatch(const std::string& context_spec,
+                                                       const char* fingerprint) const {
   DCHECK(dex_files_open_attempted_);
   DCHECK(dex_files_open_result_);
 
+  // Same class loaders with the same dex files, no need to parse the spec and resolve the
+  // locations. Special shared library contexts have no fingerprint.
+  if (fingerprint != nullptr && !special_shared_library_ && GetFingerprint() == fingerprint) {
+    return true;
+  }
+
   ClassLoaderContext expected_context;
   if (!expected_context.Parse(context_spec, /*parse_checksums*/ true)) {
     LOG(WARNING) << "Invalid class loader context: " << context_spec;
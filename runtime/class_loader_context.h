@@ -94,6 +94,13 @@ class ClassLoaderContext {
   // Should only be called if OpenDexFiles() returned true.
   std::string EncodeContextForDex2oat(const std::string& base_dir) const;
 
+  // Returns a hash of the types of the class loaders and of the names and checksums of their dex
+  // files, stored in oat files next to the encoded context. It does not depend on the directories
+  // of the dex files, so that it can be compared regardless of how the locations are encoded.
+  // Computed on the first call.
+  // Should only be called if OpenDexFiles() returned true.
+  std::string GetFingerprint() const;
+
   // Flattens the opened dex files into the given vector.
   // Should only be called if OpenDexFiles() returned true.
   std::vector<const DexFile*> FlattenOpenedDexFiles() const;
@@ -103,8 +110,11 @@ class ClassLoaderContext {
   //    - the number and type of the class loaders from the chain matches
   //    - the class loader from the same position have the same classpath
   //      (the order and checksum of the dex files matches)
+  // If `fingerprint` is not null and matches GetFingerprint(), the context is identical without
+  // parsing and comparing `context_spec`.
   // This should be called after OpenDexFiles().
-  bool VerifyClassLoaderContextMatch(const std::string& context_spec) const;
+  bool VerifyClassLoaderContextMatch(const std::string& context_spec,
+                                     const char* fingerprint = nullptr) const;
 
   // Creates the class loader context from the given string.
   // The format: ClassLoaderType1[ClasspathElem1:ClasspathElem2...];ClassLoaderType2[...]...
@@ -236,6 +246,9 @@ class ClassLoaderContext {
   // which will release their ownership in the destructor based on this flag.
   const bool owns_the_dex_files_;
 
+  // The result of GetFingerprint(), empty until it is first called.
+  mutable std::string fingerprint_;
+
   friend class ClassLoaderContextTest;
 
   DISALLOW_COPY_AND_ASSIGN(ClassLoaderContext);
@@ -654,4 +654,27 @@ TEST_F(ClassLoaderContextTest, VerifyClassLoaderContextMatchAfterEncodingMultide
   ASSERT_TRUE(context->VerifyClassLoaderContextMatch(context->EncodeContextForOatFile("")));
 }
 
+TEST_F(ClassLoaderContextTest, VerifyClassLoaderContextMatchWithFingerprint) {
+  jobject class_loader_a = LoadDexInPathClassLoader("ForClassLoaderA", nullptr);
+  jobject class_loader_b = LoadDexInDelegateLastClassLoader("ForClassLoaderB", class_loader_a);
+
+  std::unique_ptr<ClassLoaderContext> context = CreateContextForClassLoader(class_loader_b);
+  std::unique_ptr<ClassLoaderContext> same_context = CreateContextForClassLoader(class_loader_b);
+  std::unique_ptr<ClassLoaderContext> parent_context = CreateContextForClassLoader(class_loader_a);
+
+  std::string fingerprint = context->GetFingerprint();
+  ASSERT_EQ(fingerprint, same_context->GetFingerprint());
+  ASSERT_NE(fingerprint, parent_context->GetFingerprint());
+
+  // A matching fingerprint does not need the spec.
+  std::string context_spec = context->EncodeContextForOatFile("");
+  ASSERT_TRUE(context->VerifyClassLoaderContextMatch(context_spec, fingerprint.c_str()));
+  ASSERT_TRUE(context->VerifyClassLoaderContextMatch("PCL[]", fingerprint.c_str()));
+
+  // Otherwise the spec is verified.
+  ASSERT_TRUE(context->VerifyClassLoaderContextMatch(context_spec, "0000000000000000"));
+  ASSERT_FALSE(context->VerifyClassLoaderContextMatch("PCL[]", "0000000000000000"));
+  ASSERT_FALSE(parent_context->VerifyClassLoaderContextMatch(context_spec, fingerprint.c_str()));
+}
+
 }  // namespace art
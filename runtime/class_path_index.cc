@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_path_index.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/bit_utils.h"
+#include "base/casts.h"
+#include "dex_file-inl.h"
+#include "utf.h"
+
+namespace art {
+
+ClassPathIndex::ClassPathIndex(const std::vector<const DexFile*>& class_path)
+    : class_path_(class_path.begin(),
+                  class_path.begin() + std::min<size_t>(class_path.size(), kEmptyDexFileIndex)) {
+  size_t num_class_defs = 0u;
+  for (const DexFile* dex_file : class_path_) {
+    num_class_defs += dex_file->NumClassDefs();
+  }
+  // Keep the load factor under 3/4, so that the probe sequences stay short.
+  const size_t num_entries = RoundUpToPowerOfTwo(std::max<size_t>(num_class_defs * 4u / 3u, 1u) +
+                                                 1u);
+  entries_.resize(num_entries, Entry { 0u, kEmptyDexFileIndex, 0u });
+  mask_ = num_entries - 1u;
+  for (size_t i = 0; i != class_path_.size(); ++i) {
+    const DexFile* dex_file = class_path_[i];
+    for (size_t class_def_index = 0; class_def_index != dex_file->NumClassDefs();
+         ++class_def_index) {
+      const char* descriptor =
+          dex_file->GetClassDescriptor(dex_file->GetClassDef(class_def_index));
+      const uint32_t hash = ComputeModifiedUtf8Hash(descriptor);
+      Entry& entry = entries_[FindIndex(descriptor, hash)];
+      // The first dex file defining a class hides the other definitions.
+      if (entry.IsEmpty()) {
+        entry = Entry { hash,
+                        dchecked_integral_cast<uint16_t>(i),
+                        dchecked_integral_cast<uint16_t>(class_def_index) };
+      }
+    }
+  }
+}
+
+size_t ClassPathIndex::FindIndex(const char* descriptor, uint32_t hash) const {
+  size_t index = hash & mask_;
+  while (!entries_[index].IsEmpty()) {
+    const Entry& entry = entries_[index];
+    if (entry.hash == hash && strcmp(GetDescriptor(entry), descriptor) == 0) {
+      break;
+    }
+    index = (index + 1u) & mask_;
+  }
+  return index;
+}
+
+std::pair<const DexFile*, const DexFile::ClassDef*> ClassPathIndex::Find(const char* descriptor,
+                                                                         size_t hash) const {
+  DCHECK_EQ(hash, ComputeModifiedUtf8Hash(descriptor));
+  const Entry& entry = entries_[FindIndex(descriptor, static_cast<uint32_t>(hash))];
+  if (entry.IsEmpty()) {
+    return std::make_pair(nullptr, nullptr);
+  }
+  const DexFile* dex_file = class_path_[entry.dex_file_index];
+  return std::make_pair(dex_file, &dex_file->GetClassDef(entry.class_def_index));
+}
+
+}  // namespace art
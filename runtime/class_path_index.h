@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_CLASS_PATH_INDEX_H_
+#define ART_RUNTIME_CLASS_PATH_INDEX_H_
+
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "dex_file.h"
+
+namespace art {
+
+// An index of the class defs of all the dex files of a class path, so that finding the first dex
+// file defining a descriptor takes a single hash table probe rather than one per dex file, for
+// the classes it doesn't define too. The index doesn't see dex files added to the class path
+// after it was built; NumDexFiles() tells which dex files the caller must still search.
+class ClassPathIndex {
+ public:
+  explicit ClassPathIndex(const std::vector<const DexFile*>& class_path);
+
+  // Returns the first dex file of the class path defining the descriptor and the class def,
+  // or nulls if none of the indexed dex files defines it. The hash is
+  // ComputeModifiedUtf8Hash(descriptor).
+  std::pair<const DexFile*, const DexFile::ClassDef*> Find(const char* descriptor,
+                                                           size_t hash) const;
+
+  // Returns the number of dex files at the start of the class path which are indexed.
+  size_t NumDexFiles() const {
+    return class_path_.size();
+  }
+
+ private:
+  struct Entry {
+    uint32_t hash;
+    uint16_t dex_file_index;
+    uint16_t class_def_index;
+
+    bool IsEmpty() const {
+      return dex_file_index == kEmptyDexFileIndex;
+    }
+  };
+
+  static constexpr uint16_t kEmptyDexFileIndex = 0xffffu;
+
+  // Returns the index in `entries_` of the entry for the descriptor, or of the empty entry where
+  // to insert it.
+  size_t FindIndex(const char* descriptor, uint32_t hash) const;
+
+  const char* GetDescriptor(const Entry& entry) const {
+    const DexFile* dex_file = class_path_[entry.dex_file_index];
+    return dex_file->GetClassDescriptor(dex_file->GetClassDef(entry.class_def_index));
+  }
+
+  const std::vector<const DexFile*> class_path_;
+  // The open addressing hash table, with linear probing.
+  std::vector<Entry> entries_;
+  size_t mask_;
+
+  DISALLOW_COPY_AND_ASSIGN(ClassPathIndex);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_CLASS_PATH_INDEX_H_
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_path_index.h"
+
+#include "common_runtime_test.h"
+#include "dex_file-inl.h"
+#include "utf.h"
+
+namespace art {
+
+class ClassPathIndexTest : public CommonRuntimeTest {
+ protected:
+  static std::pair<const DexFile*, const DexFile::ClassDef*> Find(const ClassPathIndex& index,
+                                                                  const char* descriptor) {
+    return index.Find(descriptor, ComputeModifiedUtf8Hash(descriptor));
+  }
+};
+
+TEST_F(ClassPathIndexTest, BootClassPath) {
+  const std::vector<const DexFile*>& boot_class_path = class_linker_->GetBootClassPath();
+  ClassPathIndex index(boot_class_path);
+  EXPECT_EQ(boot_class_path.size(), index.NumDexFiles());
+  for (const DexFile* dex_file : boot_class_path) {
+    for (size_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+      const DexFile::ClassDef& class_def = dex_file->GetClassDef(i);
+      const char* descriptor = dex_file->GetClassDescriptor(class_def);
+      std::pair<const DexFile*, const DexFile::ClassDef*> pair = Find(index, descriptor);
+      ASSERT_TRUE(pair.second != nullptr) << descriptor;
+      EXPECT_STREQ(descriptor, pair.first->GetClassDescriptor(*pair.second));
+    }
+  }
+  std::pair<const DexFile*, const DexFile::ClassDef*> pair = Find(index, "Ljava/lang/Object;");
+  ASSERT_TRUE(pair.first != nullptr);
+  EXPECT_STREQ("Ljava/lang/Object;", pair.first->GetClassDescriptor(*pair.second));
+  pair = Find(index, "LNotInTheBootClassPath;");
+  EXPECT_TRUE(pair.first == nullptr);
+  EXPECT_TRUE(pair.second == nullptr);
+}
+
+TEST_F(ClassPathIndexTest, FirstDefinitionWins) {
+  std::vector<std::unique_ptr<const DexFile>> first = OpenTestDexFiles("MultiDex");
+  std::vector<std::unique_ptr<const DexFile>> second = OpenTestDexFiles("MultiDex");
+  ASSERT_EQ(2u, first.size());
+  ASSERT_EQ(2u, second.size());
+  std::vector<const DexFile*> class_path =
+      { second[1].get(), first[0].get(), first[1].get(), second[0].get() };
+  ClassPathIndex index(class_path);
+  for (size_t i = 0; i != class_path.size(); ++i) {
+    const DexFile* dex_file = class_path[i];
+    for (size_t j = 0; j != dex_file->NumClassDefs(); ++j) {
+      const DexFile::ClassDef& class_def = dex_file->GetClassDef(j);
+      const char* descriptor = dex_file->GetClassDescriptor(class_def);
+      std::pair<const DexFile*, const DexFile::ClassDef*> pair = Find(index, descriptor);
+      // The second half of the class path defines the same classes as the first half.
+      EXPECT_EQ(i < 2u ? dex_file : class_path[i - 2u], pair.first) << descriptor;
+    }
+  }
+
+  ClassPathIndex empty_index(std::vector<const DexFile*>{});
+  EXPECT_EQ(0u, empty_index.NumDexFiles());
+  EXPECT_TRUE(Find(empty_index, "LMain;").first == nullptr);
+}
+
+}  // namespace art
@@ -22,15 +22,36 @@
 
 namespace art {
 
-ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
+ClassTable::ClassTable()
+    : lock_("Class loader classes", kClassLoaderClassesLock),
+      frozen_class_sets_(nullptr),
+      num_frozen_removals_(0u) {
   Runtime* const runtime = Runtime::Current();
   classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
                               runtime->GetHashTableMaxLoadFactor()));
 }
 
+ClassTable::~ClassTable() {
+  delete frozen_class_sets_.LoadRelaxed();
+}
+
 void ClassTable::FreezeSnapshot() {
   WriterMutexLock mu(Thread::Current(), lock_);
   classes_.push_back(ClassSet());
+  PublishFrozenClassSets();
+}
+
+void ClassTable::PublishFrozenClassSets() {
+  std::unique_ptr<FrozenClassSets> frozen(new FrozenClassSets());
+  for (size_t i = 0; i < classes_.size() - 1; ++i) {
+    frozen->push_back(&classes_[i]);
+  }
+  const FrozenClassSets* old_frozen = frozen_class_sets_.LoadRelaxed();
+  if (old_frozen != nullptr) {
+    retired_frozen_class_sets_.emplace_back(old_frozen);
+  }
+  // Release the content of the sets along with the list.
+  frozen_class_sets_.StoreRelease(frozen.release());
 }
 
 bool ClassTable::Contains(ObjPtr<mirror::Class> klass) {
@@ -131,8 +152,27 @@ size_t ClassTable::NumReferencedNonZygoteClasses() const {
 
 mirror::Class* ClassTable::Lookup(const char* descriptor, size_t hash) {
   DescriptorHashPair pair(descriptor, hash);
+  // The frozen sets are never resized, and their slots are updated atomically, so we can look
+  // them up without the lock. A class found there is the same the locked lookup would find.
+  const uint32_t num_frozen_removals = num_frozen_removals_.LoadAcquire();
+  const FrozenClassSets* frozen = frozen_class_sets_.LoadAcquire();
+  if (frozen != nullptr) {
+    for (const ClassSet* class_set : *frozen) {
+      auto it = class_set->FindWithHash(pair, hash);
+      if (it != class_set->end()) {
+        return it->Read();
+      }
+    }
+  }
   ReaderMutexLock mu(Thread::Current(), lock_);
+  // Skip the sets we already looked up, unless a Remove() from one of them moved other classes
+  // within the set in the meantime.
+  const bool skip_frozen =
+      frozen != nullptr && num_frozen_removals == num_frozen_removals_.LoadRelaxed();
   for (ClassSet& class_set : classes_) {
+    if (skip_frozen && ContainsElement(*frozen, &class_set)) {
+      continue;
+    }
     auto it = class_set.FindWithHash(pair, hash);
     if (it != class_set.end()) {
       return it->Read();
@@ -190,6 +230,11 @@ bool ClassTable::Remove(const char* descriptor) {
     auto it = class_set.Find(pair);
     if (it != class_set.end()) {
       class_set.Erase(it);
+      if (&class_set != &classes_.back()) {
+        // Erasing moved the following classes of the probe sequence, tell the lookups which did
+        // not lock during the erase to look again.
+        num_frozen_removals_.StoreRelease(num_frozen_removals_.LoadRelaxed() + 1u);
+      }
       return true;
     }
   }
@@ -289,7 +334,8 @@ size_t ClassTable::ReadFromMemory(uint8_t* ptr) {
 
 void ClassTable::AddClassSet(ClassSet&& set) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.insert(classes_.begin(), std::move(set));
+  classes_.push_front(std::move(set));
+  PublishFrozenClassSets();
 }
 
 void ClassTable::ClearStrongRoots() {
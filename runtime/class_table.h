@@ -17,10 +17,13 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <deque>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "atomic.h"
 #include "base/allocator.h"
 #include "base/hash_set.h"
 #include "base/macros.h"
@@ -139,6 +142,7 @@ class ClassTable {
                   TrackingAllocator<TableSlot, kAllocatorTagClassTable>> ClassSet;
 
   ClassTable();
+  ~ClassTable();
 
   // Used by image writer for checking.
   bool Contains(ObjPtr<mirror::Class> klass)
@@ -199,7 +203,8 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Return the first class that matches the descriptor. Returns null if there are none.
+  // Return the first class that matches the descriptor. Returns null if there are none. Only
+  // locks if the class is not in one of the frozen snapshots.
   mirror::Class* Lookup(const char* descriptor, size_t hash)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -283,10 +288,25 @@ class ClassTable {
       REQUIRES(lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Publishes the class sets added or frozen since the last call for the lookups without lock.
+  void PublishFrozenClassSets() REQUIRES(lock_);
+
+  // The class sets which are no longer inserted into, all of `classes_` but the last one.
+  using FrozenClassSets = std::vector<const ClassSet*>;
+
   // Lock to guard inserting and removing.
   mutable ReaderWriterMutex lock_;
-  // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
-  std::vector<ClassSet> classes_ GUARDED_BY(lock_);
+  // We have several sets to help prevent dirty pages after the zygote forks by calling
+  // FreezeSnapshot. A deque doesn't move the sets when adding one at either end, so that the
+  // frozen ones can be read without the lock.
+  std::deque<ClassSet> classes_ GUARDED_BY(lock_);
+  // The frozen class sets, which never resize, so that Lookup() reads them without the lock.
+  // Each update publishes a new list, the previous ones are kept in `retired_frozen_class_sets_`
+  // until the table is deleted since a concurrent lookup may still read them.
+  Atomic<const FrozenClassSets*> frozen_class_sets_;
+  std::vector<std::unique_ptr<const FrozenClassSets>> retired_frozen_class_sets_ GUARDED_BY(lock_);
+  // Incremented by each Remove() from a frozen set, written with the lock held.
+  Atomic<uint32_t> num_frozen_removals_;
   // Extra strong roots that can be either dex files or dex caches. Dex files used by the class
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "class_table-inl.h"
+
+#include "class_linker-inl.h"
+#include "common_runtime_benchmark.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "scoped_thread_state_change-inl.h"
+#include "utf.h"
+
+namespace art {
+
+class ClassTableBenchmark : public CommonRuntimeBenchmark {
+ protected:
+  static constexpr size_t kLookups = 100000u;
+
+  // Boot classes which the table of a class loader holds, loaded by the benchmarks.
+  static constexpr const char* kDescriptors[] = {
+    "Ljava/lang/Object;",
+    "Ljava/lang/String;",
+    "Ljava/lang/Integer;",
+    "Ljava/lang/Long;",
+    "Ljava/lang/Math;",
+    "Ljava/lang/StringBuilder;",
+    "Ljava/lang/Thread;",
+    "Ljava/lang/Throwable;",
+    "Ljava/lang/Exception;",
+    "Ljava/lang/RuntimeException;",
+    "Ljava/util/ArrayList;",
+    "Ljava/util/HashMap;",
+    "Ljava/util/LinkedList;",
+    "Ljava/util/List;",
+    "Ljava/util/Map;",
+    "[I",
+  };
+
+  void InsertClasses(ClassTable* table) REQUIRES_SHARED(Locks::mutator_lock_) {
+    for (const char* descriptor : kDescriptors) {
+      ObjPtr<mirror::Class> klass = class_linker_->FindSystemClass(Thread::Current(), descriptor);
+      ASSERT_TRUE(klass != nullptr) << descriptor;
+      table->Insert(klass);
+      hashes_.push_back(ComputeModifiedUtf8Hash(descriptor));
+    }
+  }
+
+  void BenchmarkLookups(const char* name, ClassTable* table)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    const size_t num_classes = arraysize(kDescriptors);
+    size_t found = 0u;
+    Benchmark(name, kLookups, [&](size_t i) REQUIRES_SHARED(Locks::mutator_lock_) {
+      size_t index = i % num_classes;
+      found += (table->Lookup(kDescriptors[index], hashes_[index]) != nullptr) ? 1u : 0u;
+    });
+    EXPECT_EQ((kWarmUpRounds + kRounds) * kLookups, found);
+  }
+
+  std::vector<uint32_t> hashes_;
+};
+
+constexpr const char* ClassTableBenchmark::kDescriptors[];
+
+TEST_F(ClassTableBenchmark, Lookup) {
+  ScopedObjectAccess soa(Thread::Current());
+  ClassTable table;
+  InsertClasses(&table);
+  BenchmarkLookups("ClassTable::Lookup", &table);
+}
+
+// The classes of the zygote are in a frozen set, read without the lock.
+TEST_F(ClassTableBenchmark, LookupFrozen) {
+  ScopedObjectAccess soa(Thread::Current());
+  ClassTable table;
+  InsertClasses(&table);
+  table.FreezeSnapshot();
+  BenchmarkLookups("ClassTable::Lookup/frozen", &table);
+}
+
+TEST_F(ClassTableBenchmark, LookupMiss) {
+  ScopedObjectAccess soa(Thread::Current());
+  ClassTable table;
+  InsertClasses(&table);
+  const char* descriptor = "Lno/such/Class;";
+  const uint32_t hash = ComputeModifiedUtf8Hash(descriptor);
+  size_t found = 0u;
+  Benchmark("ClassTable::Lookup/miss", kLookups, [&](size_t i ATTRIBUTE_UNUSED)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    found += (table.Lookup(descriptor, hash) != nullptr) ? 1u : 0u;
+  });
+  EXPECT_EQ(0u, found);
+}
+
+}  // namespace art
@@ -97,6 +97,9 @@ TEST_F(ClassTableTest, ClassTable) {
   table.FreezeSnapshot();
   EXPECT_EQ(table.NumZygoteClasses(class_loader.Get()), 1u);
   EXPECT_EQ(table.NumNonZygoteClasses(class_loader.Get()), 0u);
+  // Lookups find the classes of the frozen snapshot without locking.
+  EXPECT_EQ(table.Lookup(descriptor_x, ComputeModifiedUtf8Hash(descriptor_x)), h_X.Get());
+  EXPECT_EQ(table.Lookup(descriptor_y, ComputeModifiedUtf8Hash(descriptor_y)), nullptr);
 
   // Test inserting and related lookup functions.
   EXPECT_EQ(table.LookupByDescriptor(h_Y.Get()), nullptr);
@@ -106,6 +109,7 @@ TEST_F(ClassTableTest, ClassTable) {
   EXPECT_EQ(table.LookupByDescriptor(h_Y.Get()), h_Y.Get());
   EXPECT_TRUE(table.Contains(h_X.Get()));
   EXPECT_TRUE(table.Contains(h_Y.Get()));
+  EXPECT_EQ(table.Lookup(descriptor_y, ComputeModifiedUtf8Hash(descriptor_y)), h_Y.Get());
 
   EXPECT_EQ(table.NumZygoteClasses(class_loader.Get()), 1u);
   EXPECT_EQ(table.NumNonZygoteClasses(class_loader.Get()), 1u);
@@ -143,6 +147,8 @@ TEST_F(ClassTableTest, ClassTable) {
   // Test remove.
   table.Remove(descriptor_x);
   EXPECT_FALSE(table.Contains(h_X.Get()));
+  EXPECT_EQ(table.Lookup(descriptor_x, ComputeModifiedUtf8Hash(descriptor_x)), nullptr);
+  EXPECT_EQ(table.Lookup(descriptor_y, ComputeModifiedUtf8Hash(descriptor_y)), h_Y.Get());
 
   // Test that WriteToMemory and ReadFromMemory work.
   table.Insert(h_X.Get());
@@ -155,6 +161,9 @@ TEST_F(ClassTableTest, ClassTable) {
   // Strong roots are not serialized, only classes.
   EXPECT_TRUE(table2.Contains(h_X.Get()));
   EXPECT_TRUE(table2.Contains(h_Y.Get()));
+  // The set read from memory is frozen.
+  EXPECT_EQ(table2.Lookup(descriptor_x, ComputeModifiedUtf8Hash(descriptor_x)), h_X.Get());
+  EXPECT_EQ(table2.NumReferencedZygoteClasses(), 2u);
 
   // TODO: Add tests for UpdateClass, InsertOatFile.
 }
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ART_RUNTIME_COMMON_RUNTIME_BENCHMARK_H_
+#define ART_RUNTIME_COMMON_RUNTIME_BENCHMARK_H_
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "base/time_utils.h"
+#include "common_runtime_test.h"
+
+namespace art {
+
+// Microbenchmarks of the runtime primitives, built as the art_runtime_benchmarks gtests. They are
+// not run by test-art, as their timings are only meaningful on a quiet machine, and they run
+// with the debug runtime like the other gtests, so only compare them with each other.
+//
+// Each benchmark prints a line for scripts:
+//
+//   benchmark <name> ns_per_op=<median> min_ns_per_op=<minimum> ops=<ops per round>
+class CommonRuntimeBenchmark : public CommonRuntimeTest {
+ protected:
+  static constexpr size_t kWarmUpRounds = 2u;
+  static constexpr size_t kRounds = 11u;
+
+  // Times rounds of `ops` calls of `op(i)`, for i in [0, ops), and prints the median and
+  // minimum time per call of the rounds after the warm-up. The callers hold the locks that
+  // `op` requires.
+  template <typename Op>
+  static void Benchmark(const char* name, size_t ops, const Op& op) NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<uint64_t> round_ns;
+    for (size_t round = 0; round != kWarmUpRounds + kRounds; ++round) {
+      uint64_t start_ns = NanoTime();
+      for (size_t i = 0; i != ops; ++i) {
+        op(i);
+      }
+      uint64_t end_ns = NanoTime();
+      if (round >= kWarmUpRounds) {
+        round_ns.push_back(end_ns - start_ns);
+      }
+    }
+    std::sort(round_ns.begin(), round_ns.end());
+    std::cout << "benchmark " << name << std::fixed << std::setprecision(2)
+              << " ns_per_op=" << static_cast<double>(round_ns[kRounds / 2]) / ops
+              << " min_ns_per_op=" << static_cast<double>(round_ns[0]) / ops
+              << " ops=" << ops << std::endl;
+  }
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_COMMON_RUNTIME_BENCHMARK_H_
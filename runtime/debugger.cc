@@ -4334,7 +4334,7 @@ bool Dbg::DdmHandleChunk(JNIEnv* env,
                          uint32_t type,
                          const ArrayRef<const jbyte>& data,
                          /*out*/uint32_t* out_type,
-                         /*out*/std::vector<uint8_t>* out_data) {
+                         const std::function<uint8_t*(size_t)>& alloc_reply) {
   ScopedLocalRef<jbyteArray> dataArray(env, env->NewByteArray(data.size()));
   if (dataArray.get() == nullptr) {
     LOG(WARNING) << "byte[] allocation failed: " << data.size();
@@ -4364,16 +4364,10 @@ bool Dbg::DdmHandleChunk(JNIEnv* env,
   }
 
   /*
-   * Pull the pieces out of the chunk.  We copy the results into a
-   * newly-allocated buffer that the caller can free.  We don't want to
-   * continue using the Chunk object because nothing has a reference to it.
-   *
-   * We could avoid this by returning type/data/offset/length and having
-   * the caller be aware of the object lifetime issues, but that
-   * integrates the JDWP code more tightly into the rest of the runtime, and doesn't work
-   * if we have responses for multiple chunks.
-   *
-   * So we're pretty much stuck with copying data around multiple times.
+   * Pull the pieces out of the chunk.  We copy the results into a buffer
+   * provided by the caller, so that the data only needs to be copied out of
+   * the Java heap once.  We don't want to continue using the Chunk object
+   * because nothing has a reference to it.
    */
   ScopedLocalRef<jbyteArray> replyData(
       env,
@@ -4392,11 +4386,19 @@ bool Dbg::DdmHandleChunk(JNIEnv* env,
                              replyData.get(),
                              offset,
                              length);
-  out_data->resize(length);
+  if (length < 0) {
+    LOG(WARNING) << StringPrintf("Bad reply length %d from dispatcher 0x%08x", length, type);
+    return false;
+  }
+  uint8_t* out_data = alloc_reply(static_cast<size_t>(length));
+  if (out_data == nullptr && length != 0) {
+    LOG(WARNING) << "Reply allocation failed: " << length;
+    return false;
+  }
   env->GetByteArrayRegion(replyData.get(),
                           offset,
                           length,
-                          reinterpret_cast<jbyte*>(out_data->data()));
+                          reinterpret_cast<jbyte*>(out_data));
 
   if (env->ExceptionCheck()) {
     LOG(INFO) << StringPrintf("Exception thrown when reading response data from dispatcher 0x%08x",
@@ -4436,22 +4438,28 @@ bool Dbg::DdmHandlePacket(JDWP::Request* request, uint8_t** pReplyBuf, int* pRep
   }
 
   ArrayRef<const jbyte> data(reinterpret_cast<const jbyte*>(request->data()), request_length);
-  std::vector<uint8_t> out_data;
   uint32_t out_type = 0;
   request->Skip(request_length);
-  if (!DdmHandleChunk(env, type, data, &out_type, &out_data) || out_data.empty()) {
+  // Have the reply data copied directly behind the chunk header of the reply buffer.
+  const uint32_t kDdmHeaderSize = 8;
+  std::unique_ptr<uint8_t[]> reply;
+  size_t out_length = 0;
+  auto alloc_reply = [&](size_t length) {
+    out_length = length;
+    reply.reset(new uint8_t[length + kDdmHeaderSize]);
+    return reply.get() + kDdmHeaderSize;
+  };
+  if (!DdmHandleChunk(env, type, data, &out_type, alloc_reply) || out_length == 0) {
     return false;
   }
-  const uint32_t kDdmHeaderSize = 8;
-  *pReplyLen = out_data.size() + kDdmHeaderSize;
-  *pReplyBuf = new uint8_t[out_data.size() + kDdmHeaderSize];
-  memcpy((*pReplyBuf) + kDdmHeaderSize, out_data.data(), out_data.size());
+  *pReplyLen = out_length + kDdmHeaderSize;
+  *pReplyBuf = reply.release();
   JDWP::Set4BE(*pReplyBuf, out_type);
-  JDWP::Set4BE((*pReplyBuf) + 4, static_cast<uint32_t>(out_data.size()));
+  JDWP::Set4BE((*pReplyBuf) + 4, static_cast<uint32_t>(out_length));
   VLOG(jdwp)
       << StringPrintf("dvmHandleDdm returning type=%.4s", reinterpret_cast<char*>(*pReplyBuf))
       << "0x" << std::hex << reinterpret_cast<uintptr_t>(*pReplyBuf) << std::dec
-      << " len= " << out_data.size();
+      << " len= " << out_length;
   return true;
 }
 
@@ -658,12 +658,15 @@ class Dbg {
       REQUIRES_SHARED(Locks::mutator_lock_);
   static void DdmSetThreadNotification(bool enable)
       REQUIRES(!Locks::thread_list_lock_);
+  // Dispatches a chunk to the DdmServer. The reply data is copied straight out of the reply array
+  // into the buffer returned by 'alloc_reply', which is called with the length of the reply data
+  // and may return null to signal an allocation failure.
   static bool DdmHandleChunk(
       JNIEnv* env,
       uint32_t type,
       const ArrayRef<const jbyte>& data,
       /*out*/uint32_t* out_type,
-      /*out*/std::vector<uint8_t>* out_data);
+      const std::function<uint8_t*(size_t)>& alloc_reply);
   static bool DdmHandlePacket(JDWP::Request* request, uint8_t** pReplyBuf, int* pReplyLen);
   static void DdmConnected() REQUIRES_SHARED(Locks::mutator_lock_);
   static void DdmDisconnected() REQUIRES_SHARED(Locks::mutator_lock_);
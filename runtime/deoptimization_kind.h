@@ -23,10 +23,12 @@ enum class DeoptimizationKind {
   kAotInlineCache = 0,
   kJitInlineCache,
   kJitSameTarget,
+  kJitReflectiveAccess,
   kLoopBoundsBCE,
   kLoopNullBCE,
   kBlockBCE,
   kCHA,
+  kTierUp,
   kFullFrame,
   kLast = kFullFrame
 };
@@ -36,10 +38,12 @@ inline const char* GetDeoptimizationKindName(DeoptimizationKind kind) {
     case DeoptimizationKind::kAotInlineCache: return "AOT inline cache";
     case DeoptimizationKind::kJitInlineCache: return "JIT inline cache";
     case DeoptimizationKind::kJitSameTarget: return "JIT same target";
+    case DeoptimizationKind::kJitReflectiveAccess: return "JIT reflective access";
     case DeoptimizationKind::kLoopBoundsBCE: return "loop bounds check elimination";
     case DeoptimizationKind::kLoopNullBCE: return "loop bounds check elimination on null";
     case DeoptimizationKind::kBlockBCE: return "block bounds check elimination";
     case DeoptimizationKind::kCHA: return "class hierarchy analysis";
+    case DeoptimizationKind::kTierUp: return "baseline code got optimized";
     case DeoptimizationKind::kFullFrame: return "full frame";
   }
   LOG(FATAL) << "Unexpected kind " << static_cast<size_t>(kind);
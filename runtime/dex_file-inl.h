@@ -431,11 +431,10 @@ bool DexFile::DecodeDebugPositionInfo(const uint8_t* stream,
   }
 
   PositionInfo entry = PositionInfo();
-  entry.line_ = DecodeUnsignedLeb128(&stream);
-  uint32_t parameters_size = DecodeUnsignedLeb128(&stream);
-  for (uint32_t i = 0; i < parameters_size; ++i) {
-    DecodeUnsignedLeb128P1(&stream);  // Parameter name.
-  }
+  uint32_t header[2];  // line_start, parameters_size.
+  DecodeUnsignedLeb128s(&stream, header, arraysize(header));
+  entry.line_ = header[0];
+  SkipLeb128s(&stream, header[1]);  // Parameter names.
 
   for (;;)  {
     uint8_t opcode = *stream++;
@@ -449,19 +448,14 @@ bool DexFile::DecodeDebugPositionInfo(const uint8_t* stream,
         entry.line_ += DecodeSignedLeb128(&stream);
         break;
       case DBG_START_LOCAL:
-        DecodeUnsignedLeb128(&stream);  // reg.
-        DecodeUnsignedLeb128P1(&stream);  // name.
-        DecodeUnsignedLeb128P1(&stream);  // descriptor.
+        SkipLeb128s(&stream, 3u);  // reg, name, descriptor.
         break;
       case DBG_START_LOCAL_EXTENDED:
-        DecodeUnsignedLeb128(&stream);  // reg.
-        DecodeUnsignedLeb128P1(&stream);  // name.
-        DecodeUnsignedLeb128P1(&stream);  // descriptor.
-        DecodeUnsignedLeb128P1(&stream);  // signature.
+        SkipLeb128s(&stream, 4u);  // reg, name, descriptor, signature.
         break;
       case DBG_END_LOCAL:
       case DBG_RESTART_LOCAL:
-        DecodeUnsignedLeb128(&stream);  // reg.
+        SkipLeb128s(&stream, 1u);  // reg.
         break;
       case DBG_SET_PROLOGUE_END:
         entry.prologue_end_ = true;
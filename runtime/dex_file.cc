@@ -705,23 +705,29 @@ std::ostream& operator<<(std::ostream& os, const Signature& sig) {
 // Decodes the header section from the class data bytes.
 void ClassDataItemIterator::ReadClassDataHeader() {
   CHECK(ptr_pos_ != nullptr);
-  header_.static_fields_size_ = DecodeUnsignedLeb128(&ptr_pos_);
-  header_.instance_fields_size_ = DecodeUnsignedLeb128(&ptr_pos_);
-  header_.direct_methods_size_ = DecodeUnsignedLeb128(&ptr_pos_);
-  header_.virtual_methods_size_ = DecodeUnsignedLeb128(&ptr_pos_);
+  uint32_t sizes[4];
+  DecodeUnsignedLeb128s(&ptr_pos_, sizes, arraysize(sizes));
+  header_.static_fields_size_ = sizes[0];
+  header_.instance_fields_size_ = sizes[1];
+  header_.direct_methods_size_ = sizes[2];
+  header_.virtual_methods_size_ = sizes[3];
 }
 
 void ClassDataItemIterator::ReadClassDataField() {
-  field_.field_idx_delta_ = DecodeUnsignedLeb128(&ptr_pos_);
-  field_.access_flags_ = DecodeUnsignedLeb128(&ptr_pos_);
+  uint32_t values[2];
+  DecodeUnsignedLeb128s(&ptr_pos_, values, arraysize(values));
+  field_.field_idx_delta_ = values[0];
+  field_.access_flags_ = values[1];
   // The user of the iterator is responsible for checking if there
   // are unordered or duplicate indexes.
 }
 
 void ClassDataItemIterator::ReadClassDataMethod() {
-  method_.method_idx_delta_ = DecodeUnsignedLeb128(&ptr_pos_);
-  method_.access_flags_ = DecodeUnsignedLeb128(&ptr_pos_);
-  method_.code_off_ = DecodeUnsignedLeb128(&ptr_pos_);
+  uint32_t values[3];
+  DecodeUnsignedLeb128s(&ptr_pos_, values, arraysize(values));
+  method_.method_idx_delta_ = values[0];
+  method_.access_flags_ = values[1];
+  method_.code_off_ = values[2];
   if (last_idx_ != 0 && method_.method_idx_delta_ == 0) {
     LOG(WARNING) << "Duplicate method in " << dex_file_.GetLocation();
   }
@@ -377,31 +377,25 @@ std::unique_ptr<const DexFile> DexFileLoader::OpenOneDexFileFromZip(
     return nullptr;
   }
 
-  std::unique_ptr<MemMap> map;
-  if (zip_entry->IsUncompressed()) {
-    if (!zip_entry->IsAlignedTo(alignof(DexFile::Header))) {
-      // Do not mmap unaligned ZIP entries because
-      // doing so would fail dex verification which requires 4 byte alignment.
-      LOG(WARNING) << "Can't mmap dex file " << location << "!" << entry_name << " directly; "
-                   << "please zipalign to " << alignof(DexFile::Header) << " bytes. "
-                   << "Falling back to extracting file.";
+  // Map uncompressed files within zip as file-backed to avoid a dirty copy. Do not mmap unaligned
+  // ZIP entries because doing so would fail dex verification which requires 4 byte alignment.
+  std::string extract_reason;
+  std::unique_ptr<MemMap> map(zip_entry->MapDirectlyOrExtract(location.c_str(),
+                                                              entry_name,
+                                                              alignof(DexFile::Header),
+                                                              &extract_reason,
+                                                              error_msg));
+  if (!extract_reason.empty()) {
+    if (zip_entry->IsUncompressed()) {
+      // The entry was stored to be mapped, tell why it wasn't.
+      LOG(WARNING) << "Can't mmap dex file " << location << "!" << entry_name << " directly ("
+                   << extract_reason << "). Falling back to extracting file.";
     } else {
-      // Map uncompressed files within zip as file-backed to avoid a dirty copy.
-      map.reset(zip_entry->MapDirectlyFromFile(location.c_str(), /*out*/error_msg));
-      if (map == nullptr) {
-        LOG(WARNING) << "Can't mmap dex file " << location << "!" << entry_name << " directly; "
-                     << "is your ZIP file corrupted? Falling back to extraction.";
-        // Try again with Extraction which still has a chance of recovery.
-      }
+      VLOG(class_linker) << "Extracting dex file " << location << "!" << entry_name
+                         << " to anonymous memory: " << extract_reason;
     }
   }
 
-  if (map == nullptr) {
-    // Default path for compressed ZIP entries,
-    // and fallback for stored ZIP entries.
-    map.reset(zip_entry->ExtractToMemMap(location.c_str(), entry_name, error_msg));
-  }
-
   if (map == nullptr) {
     *error_msg = StringPrintf("Failed to extract '%s' from '%s': %s", entry_name, location.c_str(),
                               error_msg->c_str());
@@ -66,6 +66,10 @@ bool EntrypointRequiresStackMap(QuickEntrypointEnum trampoline) {
     case kQuickA64Store:
       return false;
 
+    /* Called by baseline JIT code at method entry, never suspends. */
+    case kQuickCompileOptimized:
+      return false;
+
     default:
       return true;
   }
@@ -117,6 +121,10 @@ bool EntrypointCanTriggerGC(QuickEntrypointEnum entrypoint) {
     case kQuickA64Store:
       return false;
 
+    /* Called by baseline JIT code at method entry, never suspends. */
+    case kQuickCompileOptimized:
+      return false;
+
     default:
       return true;
   }
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/callee_save_type.h"
+#include "callee_save_frame.h"
+#include "mirror/string-inl.h"
+#include "string_builder_append.h"
+#include "thread-inl.h"
+
+namespace art {
+
+extern "C" mirror::String* artStringBuilderAppend(uint32_t format,
+                                                  const uint32_t* args,
+                                                  Thread* self)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  // The arguments are in the outgoing arguments area of the caller's frame, which the GC does
+  // not visit. AppendF() reads them into handles before the allocation can suspend.
+  ScopedQuickEntrypointChecks sqec(self);
+  return StringBuilderAppend::AppendF(format, args, self);
+}
+
+}  // namespace art
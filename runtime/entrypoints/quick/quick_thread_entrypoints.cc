@@ -15,6 +15,8 @@
  */
 
 #include "callee_save_frame.h"
+#include "jit/jit.h"
+#include "runtime.h"
 #include "thread-inl.h"
 
 namespace art {
@@ -25,4 +27,15 @@ extern "C" void artTestSuspendFromCode(Thread* self) REQUIRES_SHARED(Locks::muta
   self->CheckSuspend();
 }
 
+extern "C" void artCompileOptimized(ArtMethod* method, Thread* self)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  // Called by baseline JIT code when the hotness count of the method in its ProfilingInfo wraps
+  // around. The call happens at method entry without a stack map, so it must not suspend.
+  ScopedAssertNoThreadSuspension sants("Enqueuing optimized compilation");
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit != nullptr) {
+    jit->EnqueueOptimizedCompilation(method, self);
+  }
+}
+
 }  // namespace art
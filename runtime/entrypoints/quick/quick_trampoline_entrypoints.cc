@@ -1286,6 +1286,11 @@ extern "C" const void* artQuickResolutionTrampoline(
         code = GetQuickInstrumentationEntryPoint();
       } else {
         code = called->GetEntryPointFromQuickCompiledCode();
+        if (invoke_type == kStatic && linker->IsQuickResolutionStub(code)) {
+          // The static methods of large classes keep the trampoline after initialization, link
+          // the method now. See ClassLinker::FixupStaticTrampolines.
+          code = linker->LinkStaticMethodCode(called);
+        }
       }
     } else if (called_class->IsInitializing()) {
       if (UNLIKELY(Dbg::IsForcedInterpreterNeededForResolution(self, called))) {
@@ -2161,7 +2166,7 @@ extern "C" TwoWordReturn artQuickGenericJniTrampoline(Thread* self, ArtMethod**
   Runtime* runtime = Runtime::Current();
   jit::Jit* jit = runtime->GetJit();
   if (jit != nullptr) {
-    jit->AddSamples(self, called, 1u, /*with_backedges*/ false);
+    jit->AddInvocationSample(self, called);
   }
   uint32_t shorty_len = 0;
   const char* shorty = called->GetShorty(&shorty_len);
@@ -19,6 +19,14 @@
 
 #include "card_table.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include <android-base/logging.h>
 
 #include "atomic.h"
@@ -51,6 +59,47 @@ static inline bool byte_cas(uint8_t old_value, uint8_t new_value, uint8_t* addre
 #endif
 }
 
+// Number of cards that the clean card skipping below tests at a time.
+#if defined(__AVX2__)
+static constexpr size_t kCardVectorSize = 32;
+#else
+static constexpr size_t kCardVectorSize = 16;
+#endif
+
+// Returns true if all the kCardVectorSize cards starting at card, which must be aligned to
+// kCardVectorSize, are clean.
+static inline bool CardVectorIsClean(const uint8_t* card) {
+  DCHECK_ALIGNED(card, kCardVectorSize);
+#if defined(__AVX2__)
+  const __m256i cards = _mm256_load_si256(reinterpret_cast<const __m256i*>(card));
+  return _mm256_testz_si256(cards, cards) != 0;
+#elif defined(__SSE2__)
+  const __m128i cards = _mm_load_si128(reinterpret_cast<const __m128i*>(card));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(cards, _mm_setzero_si128())) == 0xFFFF;
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+  const uint64x2_t cards = vreinterpretq_u64_u8(vld1q_u8(card));
+  return (vgetq_lane_u64(cards, 0) | vgetq_lane_u64(cards, 1)) == 0;
+#else
+  const uintptr_t* words = reinterpret_cast<const uintptr_t*>(card);
+  uintptr_t bits = 0;
+  for (size_t i = 0; i < kCardVectorSize / sizeof(uintptr_t); ++i) {
+    bits |= words[i];
+  }
+  return bits == 0;
+#endif
+}
+
+// Returns the first card in [card, card_end) that could be non clean, skipping whole
+// kCardVectorSize blocks of clean cards. card must be aligned to kCardVectorSize. The
+// returned card is either card_end or aligned to kCardVectorSize. This keeps the scan of the
+// mostly clean card tables of sticky and partial collections from going a word at a time.
+static inline uint8_t* SkipCleanCardVectors(uint8_t* card, uint8_t* card_end) {
+  while (card + kCardVectorSize <= card_end && CardVectorIsClean(card)) {
+    card += kCardVectorSize;
+  }
+  return card;
+}
+
 template <bool kClearCard, typename Visitor>
 inline size_t CardTable::Scan(ContinuousSpaceBitmap* bitmap,
                               uint8_t* const scan_begin,
@@ -85,6 +134,10 @@ inline size_t CardTable::Scan(ContinuousSpaceBitmap* bitmap,
       ++word_cur) {
     while (LIKELY(*word_cur == 0)) {
       ++word_cur;
+      if (IsAligned<kCardVectorSize>(word_cur)) {
+        word_cur = reinterpret_cast<uintptr_t*>(
+            SkipCleanCardVectors(reinterpret_cast<uint8_t*>(word_cur), aligned_end));
+      }
       if (UNLIKELY(word_cur >= word_end)) {
         goto exit_for;
       }
@@ -186,6 +239,13 @@ inline void CardTable::ModifyCardsAtomic(uint8_t* scan_begin,
 
   // TODO: Parallelize.
   while (word_cur < word_end) {
+    if (IsAligned<kCardVectorSize>(word_cur)) {
+      word_cur = reinterpret_cast<uintptr_t*>(
+          SkipCleanCardVectors(reinterpret_cast<uint8_t*>(word_cur), card_end));
+      if (word_cur >= word_end) {
+        break;
+      }
+    }
     while (true) {
       expected_word = *word_cur;
       if (LIKELY(expected_word == 0)) {
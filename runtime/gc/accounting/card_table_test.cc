@@ -19,11 +19,13 @@
 #include <string>
 
 #include "atomic.h"
+#include "base/time_utils.h"
 #include "common_runtime_test.h"
 #include "handle_scope-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/string-inl.h"  // Strings are easiest to allocate
 #include "scoped_thread_state_change-inl.h"
+#include "space_bitmap-inl.h"
 #include "thread_pool.h"
 #include "utils.h"
 
@@ -144,7 +146,99 @@ TEST_F(CardTableTest, TestModifyCardsAtomic) {
   }
 }
 
-// TODO: Add test for CardTable::Scan.
+class CountingVisitor {
+ public:
+  explicit CountingVisitor(size_t* count) : count_(count) {}
+  void operator()(mirror::Object* /*obj*/) const {
+    ++*count_;
+  }
+
+ private:
+  size_t* const count_;
+};
+
+// Marks one object at the start of every card and dirties or ages every card whose index is a
+// multiple of dirty_stride or aged_stride respectively.
+static std::unique_ptr<ContinuousSpaceBitmap> SetUpScan(CardTable* card_table,
+                                                        uint8_t* heap_begin,
+                                                        uint8_t* heap_limit,
+                                                        size_t dirty_stride,
+                                                        size_t aged_stride) {
+  std::unique_ptr<ContinuousSpaceBitmap> bitmap(
+      ContinuousSpaceBitmap::Create("card table scan test bitmap", heap_begin,
+                                    heap_limit - heap_begin));
+  EXPECT_TRUE(bitmap != nullptr);
+  size_t index = 0;
+  for (uint8_t* addr = heap_begin; addr < heap_limit; addr += CardTable::kCardSize, ++index) {
+    bitmap->Set(reinterpret_cast<mirror::Object*>(addr));
+    uint8_t* card = card_table->CardFromAddr(addr);
+    if (index % dirty_stride == 0) {
+      *card = CardTable::kCardDirty;
+    } else if (index % aged_stride == 0) {
+      *card = CardTable::kCardDirty - 1;
+    }
+  }
+  return bitmap;
+}
+
+TEST_F(CardTableTest, TestScan) {
+  CommonSetup();
+  // Strides chosen so that dirty cards are split across word and vector boundaries.
+  static constexpr size_t kDirtyStride = 37;
+  static constexpr size_t kAgedStride = 5;
+  std::unique_ptr<ContinuousSpaceBitmap> bitmap =
+      SetUpScan(card_table_.get(), HeapBegin(), HeapLimit(), kDirtyStride, kAgedStride);
+  ScopedObjectAccess soa(Thread::Current());
+  WriterMutexLock mu(soa.Self(), *Locks::heap_bitmap_lock_);
+  const size_t delta = 80 * CardTable::kCardSize;
+  for (uint8_t* start = HeapBegin(); start < HeapBegin() + delta; start += CardTable::kCardSize) {
+    for (uint8_t* end = HeapLimit() - delta; end <= HeapLimit(); end += 7 * CardTable::kCardSize) {
+      size_t expected_dirty = 0;
+      size_t expected_aged = 0;
+      for (uint8_t* addr = start; addr < end; addr += CardTable::kCardSize) {
+        size_t index = (addr - HeapBegin()) / CardTable::kCardSize;
+        if (index % kDirtyStride == 0) {
+          ++expected_dirty;
+        } else if (index % kAgedStride == 0) {
+          ++expected_aged;
+        }
+      }
+      size_t visited = 0;
+      CountingVisitor visitor(&visited);
+      EXPECT_EQ(expected_dirty, card_table_->Scan<false>(bitmap.get(), start, end, visitor));
+      EXPECT_EQ(expected_dirty, visited);
+      visited = 0;
+      EXPECT_EQ(expected_dirty + expected_aged,
+                card_table_->Scan<false>(bitmap.get(), start, end, visitor,
+                                         CardTable::kCardDirty - 1));
+      EXPECT_EQ(expected_dirty + expected_aged, visited);
+    }
+  }
+}
+
+// Not a correctness test. Reports how long scanning a mostly clean card table takes, which is what
+// sticky and partial collections do for the spaces they do not collect.
+TEST_F(CardTableTest, ScanSparseCardsBenchmark) {
+  CommonSetup();
+  static constexpr size_t kDirtyStride = 4096;
+  static constexpr size_t kIterations = 1000;
+  std::unique_ptr<ContinuousSpaceBitmap> bitmap =
+      SetUpScan(card_table_.get(), HeapBegin(), HeapLimit(), kDirtyStride, kDirtyStride);
+  ScopedObjectAccess soa(Thread::Current());
+  WriterMutexLock mu(soa.Self(), *Locks::heap_bitmap_lock_);
+  size_t visited = 0;
+  CountingVisitor visitor(&visited);
+  size_t cards_scanned = 0;
+  const uint64_t start_time = NanoTime();
+  for (size_t i = 0; i < kIterations; ++i) {
+    cards_scanned += card_table_->Scan<false>(bitmap.get(), HeapBegin(), HeapLimit(), visitor);
+  }
+  const uint64_t duration = NanoTime() - start_time;
+  EXPECT_EQ(cards_scanned, visited);
+  LOG(INFO) << "Scanned " << PrettySize(HeapLimit() - HeapBegin()) << " of sparse cards in "
+            << PrettyDuration(duration / kIterations) << " per iteration";
+}
+
 }  // namespace accounting
 }  // namespace gc
 }  // namespace art
@@ -16,7 +16,10 @@
 
 #include "mod_union_table.h"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <set>
 
 #include "base/logging.h"  // For VLOG
 #include "base/stl_util.h"
@@ -31,6 +34,7 @@
 #include "object_callbacks.h"
 #include "space_bitmap-inl.h"
 #include "thread-current-inl.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace gc {
@@ -45,7 +49,7 @@ class ModUnionAddToCardSetVisitor {
                          uint8_t expected_value,
                          uint8_t new_value ATTRIBUTE_UNUSED) const {
     if (expected_value == CardTable::kCardDirty) {
-      cleared_cards_->insert(card);
+      cleared_cards_->push_back(card);
     }
   }
 
@@ -53,6 +57,113 @@ class ModUnionAddToCardSetVisitor {
   ModUnionTable::CardSet* const cleared_cards_;
 };
 
+// Restores the sorted and duplicate free order of a card set after cards were appended to it.
+static void NormalizeCardSet(ModUnionTable::CardSet* cards) {
+  std::sort(cards->begin(), cards->end());
+  cards->erase(std::unique(cards->begin(), cards->end()), cards->end());
+}
+
+// If true, the cards of UpdateAndMarkReferences are scanned by the heap thread pool workers. The
+// marking itself stays on the calling thread since mark visitors are not thread safe.
+static constexpr bool kParallelModUnionTables = true;
+// Number of cards a thread scans at a time.
+static constexpr size_t kModUnionCardsPerChunk = 256;
+
+// Runs fn(chunk_index) for every chunk index below num_chunks. The heap thread pool workers help
+// the calling thread when there is more than one chunk.
+class ModUnionScanChunkTask : public Task {
+ public:
+  ModUnionScanChunkTask(const std::function<void(size_t)>* fn,
+                        Atomic<size_t>* next_chunk,
+                        size_t num_chunks)
+      : fn_(fn), next_chunk_(next_chunk), num_chunks_(num_chunks) {}
+
+  // No thread safety analysis since multiple threads will use this task. The GC-running thread
+  // holds the mutator lock and the heap bitmap lock on behalf of the workers until it has waited
+  // for all the tasks.
+  virtual void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    while (true) {
+      const size_t chunk = next_chunk_->FetchAndAddSequentiallyConsistent(1);
+      if (chunk >= num_chunks_) {
+        break;
+      }
+      (*fn_)(chunk);
+    }
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  const std::function<void(size_t)>* const fn_;
+  Atomic<size_t>* const next_chunk_;
+  const size_t num_chunks_;
+};
+
+static void RunScanChunks(Heap* heap, size_t num_chunks, const std::function<void(size_t)>& fn) {
+  ThreadPool* thread_pool = heap->GetThreadPool();
+  size_t thread_count = 1;
+  if (kParallelModUnionTables && thread_pool != nullptr) {
+    thread_count = std::min(num_chunks,
+                            std::min(heap->GetParallelGCThreadCount(),
+                                     thread_pool->GetThreadCount()) + 1);
+  }
+  if (thread_count <= 1) {
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+      fn(chunk);
+    }
+    return;
+  }
+  Thread* self = Thread::Current();
+  Atomic<size_t> next_chunk(0);
+  for (size_t i = 0; i < thread_count; ++i) {
+    thread_pool->AddTask(self, new ModUnionScanChunkTask(&fn, &next_chunk, num_chunks));
+  }
+  // The GC-running thread also runs tasks while waiting.
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+  thread_pool->StopWorkers(self);
+}
+
+size_t CardReferenceArray::Find(const uint8_t* card) const {
+  auto it = std::lower_bound(cards_.begin(), cards_.end(), card);
+  if (it == cards_.end() || *it != card) {
+    return Size();
+  }
+  return it - cards_.begin();
+}
+
+void CardReferenceArray::Append(const uint8_t* card, const Reference* begin, const Reference* end) {
+  DCHECK(cards_.empty() || cards_.back() < card);
+  cards_.push_back(card);
+  references_.insert(references_.end(), begin, end);
+  ends_.push_back(references_.size());
+}
+
+void CardReferenceArray::AppendReference(const uint8_t* card, Reference ref) {
+  if (cards_.empty() || cards_.back() != card) {
+    DCHECK(cards_.empty() || cards_.back() < card);
+    cards_.push_back(card);
+    ends_.push_back(references_.size());
+  }
+  references_.push_back(ref);
+  ++ends_.back();
+}
+
+void CardReferenceArray::Clear() {
+  cards_.clear();
+  ends_.clear();
+  references_.clear();
+}
+
+void CardReferenceArray::Swap(CardReferenceArray* other) {
+  cards_.swap(other->cards_);
+  ends_.swap(other->ends_);
+  references_.swap(other->references_);
+}
+
 class ModUnionAddToCardBitmapVisitor {
  public:
   ModUnionAddToCardBitmapVisitor(ModUnionTable::CardBitmap* bitmap, CardTable* card_table)
@@ -115,7 +226,6 @@ class ModUnionUpdateObjectReferencesVisitor {
     MarkReference(root);
   }
 
- private:
   template<typename CompressedReferenceType>
   void MarkReference(CompressedReferenceType* obj_ptr) const
       REQUIRES_SHARED(Locks::mutator_lock_) {
@@ -130,6 +240,7 @@ class ModUnionUpdateObjectReferencesVisitor {
     }
   }
 
+ private:
   MarkObjectVisitor* const visitor_;
   // Space which we are scanning
   space::ContinuousSpace* const from_space_;
@@ -171,27 +282,98 @@ class ModUnionScanImageRootVisitor {
   bool* const contains_reference_to_other_space_;
 };
 
+// What scanning a chunk of the set cards of a ModUnionTableCardCache found.
+struct ModUnionCardCacheScanResult {
+  size_t NumReferences() const {
+    return references.size() + roots.size();
+  }
+
+  // References to other spaces, marked by the thread running UpdateAndMarkReferences.
+  std::vector<mirror::HeapReference<mirror::Object>*> references;
+  std::vector<mirror::CompressedReference<mirror::Object>*> roots;
+  // Bits of the cards without references to other spaces.
+  std::vector<size_t> clean_bits;
+};
+
+// Collects the references to other spaces of the objects it visits, the same references that
+// ModUnionScanImageRootVisitor marks.
+class ModUnionCollectReferencesVisitor {
+ public:
+  ModUnionCollectReferencesVisitor(space::ContinuousSpace* from_space,
+                                   space::ContinuousSpace* immune_space,
+                                   ModUnionCardCacheScanResult* result)
+      : from_space_(from_space), immune_space_(immune_space), result_(result) {}
+
+  void operator()(mirror::Object* root) const
+      REQUIRES(Locks::heap_bitmap_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    DCHECK(root != nullptr);
+    root->VisitReferences(*this, VoidFunctor());
+  }
+
+  void operator()(mirror::Object* obj, MemberOffset offset, bool is_static ATTRIBUTE_UNUSED) const
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    mirror::HeapReference<mirror::Object>* ref_ptr = obj->GetFieldObjectReferenceAddr(offset);
+    if (IsReferenceToOtherSpace(ref_ptr->AsMirrorPtr())) {
+      result_->references.push_back(ref_ptr);
+    }
+  }
+
+  void VisitRootIfNonNull(mirror::CompressedReference<mirror::Object>* root) const
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    VisitRoot(root);
+  }
+
+  void VisitRoot(mirror::CompressedReference<mirror::Object>* root) const
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (IsReferenceToOtherSpace(root->AsMirrorPtr())) {
+      result_->roots.push_back(root);
+    }
+  }
+
+ private:
+  bool IsReferenceToOtherSpace(mirror::Object* ref) const {
+    return ref != nullptr && !from_space_->HasAddress(ref) && !immune_space_->HasAddress(ref);
+  }
+
+  space::ContinuousSpace* const from_space_;
+  space::ContinuousSpace* const immune_space_;
+  ModUnionCardCacheScanResult* const result_;
+};
+
 void ModUnionTableReferenceCache::ProcessCards() {
   CardTable* card_table = GetHeap()->GetCardTable();
   ModUnionAddToCardSetVisitor visitor(&cleared_cards_);
   // Clear dirty cards in the this space and update the corresponding mod-union bits.
   card_table->ModifyCardsAtomic(space_->Begin(), space_->End(), AgeCardVisitor(), visitor);
+  NormalizeCardSet(&cleared_cards_);
 }
 
 void ModUnionTableReferenceCache::ClearTable() {
   cleared_cards_.clear();
-  references_.clear();
+  references_.Clear();
 }
 
+// What scanning a chunk of the cleared cards of a ModUnionTableReferenceCache found.
+struct ModUnionCardScanResult {
+  // The references of the cards, in card order.
+  CardReferenceArray references;
+  // GcRoot compressed references which match the ShouldAddReference criteria. They are not cached
+  // and get marked by the thread running UpdateAndMarkReferences.
+  std::vector<mirror::CompressedReference<mirror::Object>*> roots;
+  // Cards holding such roots, which are kept for the next update.
+  std::vector<uint8_t*> kept_cards;
+};
+
 class AddToReferenceArrayVisitor {
  public:
   AddToReferenceArrayVisitor(ModUnionTableReferenceCache* mod_union_table,
-                             MarkObjectVisitor* visitor,
-                             std::vector<mirror::HeapReference<mirror::Object>*>* references,
+                             const uint8_t* card,
+                             ModUnionCardScanResult* result,
                              bool* has_target_reference)
       : mod_union_table_(mod_union_table),
-        visitor_(visitor),
-        references_(references),
+        card_(card),
+        result_(result),
         has_target_reference_(has_target_reference) {}
 
   // Extra parameters are required since we use this same visitor signature for checking objects.
@@ -202,7 +384,7 @@ class AddToReferenceArrayVisitor {
     // Only add the reference if it is non null and fits our criteria.
     if (ref != nullptr && mod_union_table_->ShouldAddReference(ref)) {
       // Push the adddress of the reference.
-      references_->push_back(ref_ptr);
+      result_->references.AppendReference(card_, ref_ptr);
     }
   }
 
@@ -218,30 +400,26 @@ class AddToReferenceArrayVisitor {
     if (mod_union_table_->ShouldAddReference(root->AsMirrorPtr())) {
       *has_target_reference_ = true;
       // TODO: Add MarkCompressedReference callback here.
-      mirror::Object* old_ref = root->AsMirrorPtr();
-      mirror::Object* new_ref = visitor_->MarkObject(old_ref);
-      if (old_ref != new_ref) {
-        root->Assign(new_ref);
-      }
+      result_->roots.push_back(root);
     }
   }
 
  private:
   ModUnionTableReferenceCache* const mod_union_table_;
-  MarkObjectVisitor* const visitor_;
-  std::vector<mirror::HeapReference<mirror::Object>*>* const references_;
+  const uint8_t* const card_;
+  ModUnionCardScanResult* const result_;
   bool* const has_target_reference_;
 };
 
 class ModUnionReferenceVisitor {
  public:
   ModUnionReferenceVisitor(ModUnionTableReferenceCache* const mod_union_table,
-                           MarkObjectVisitor* visitor,
-                           std::vector<mirror::HeapReference<mirror::Object>*>* references,
+                           const uint8_t* card,
+                           ModUnionCardScanResult* result,
                            bool* has_target_reference)
       : mod_union_table_(mod_union_table),
-        visitor_(visitor),
-        references_(references),
+        card_(card),
+        result_(result),
         has_target_reference_(has_target_reference) {}
 
   void operator()(mirror::Object* obj) const
@@ -249,16 +427,16 @@ class ModUnionReferenceVisitor {
     // We don't have an early exit since we use the visitor pattern, an early
     // exit should significantly speed this up.
     AddToReferenceArrayVisitor visitor(mod_union_table_,
-                                       visitor_,
-                                       references_,
+                                       card_,
+                                       result_,
                                        has_target_reference_);
     obj->VisitReferences(visitor, VoidFunctor());
   }
 
  private:
   ModUnionTableReferenceCache* const mod_union_table_;
-  MarkObjectVisitor* const visitor_;
-  std::vector<mirror::HeapReference<mirror::Object>*>* const references_;
+  const uint8_t* const card_;
+  ModUnionCardScanResult* const result_;
   bool* const has_target_reference_;
 };
 
@@ -341,21 +519,25 @@ void ModUnionTable::FilterCards() {
 
 void ModUnionTableReferenceCache::Verify() {
   // Start by checking that everything in the mod union table is marked.
-  for (const auto& ref_pair : references_) {
-    for (mirror::HeapReference<mirror::Object>* ref : ref_pair.second) {
-      CHECK(heap_->IsLiveObjectLocked(ref->AsMirrorPtr()));
+  for (size_t i = 0; i < references_.Size(); ++i) {
+    for (const CardReferenceArray::Reference* it = references_.ReferencesBegin(i);
+         it != references_.ReferencesEnd(i);
+         ++it) {
+      CHECK(heap_->IsLiveObjectLocked((*it)->AsMirrorPtr()));
     }
   }
 
   // Check the references of each clean card which is also in the mod union table.
   CardTable* card_table = heap_->GetCardTable();
   ContinuousSpaceBitmap* live_bitmap = space_->GetLiveBitmap();
-  for (const auto& ref_pair : references_) {
-    const uint8_t* card = ref_pair.first;
+  for (size_t i = 0; i < references_.Size(); ++i) {
+    const uint8_t* card = references_.Card(i);
     if (*card == CardTable::kCardClean) {
       std::set<mirror::Object*> reference_set;
-      for (mirror::HeapReference<mirror::Object>* obj_ptr : ref_pair.second) {
-        reference_set.insert(obj_ptr->AsMirrorPtr());
+      for (const CardReferenceArray::Reference* it = references_.ReferencesBegin(i);
+           it != references_.ReferencesEnd(i);
+           ++it) {
+        reference_set.insert((*it)->AsMirrorPtr());
       }
       ModUnionCheckReferences visitor(this, reference_set);
       uintptr_t start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(card));
@@ -373,13 +555,15 @@ void ModUnionTableReferenceCache::Dump(std::ostream& os) {
     os << reinterpret_cast<void*>(start) << "-" << reinterpret_cast<void*>(end) << ",";
   }
   os << "]\nModUnionTable references: [";
-  for (const auto& ref_pair : references_) {
-    const uint8_t* card_addr = ref_pair.first;
+  for (size_t i = 0; i < references_.Size(); ++i) {
+    const uint8_t* card_addr = references_.Card(i);
     uintptr_t start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(card_addr));
     uintptr_t end = start + CardTable::kCardSize;
     os << reinterpret_cast<void*>(start) << "-" << reinterpret_cast<void*>(end) << "->{";
-    for (mirror::HeapReference<mirror::Object>* ref : ref_pair.second) {
-      os << reinterpret_cast<const void*>(ref->AsMirrorPtr()) << ",";
+    for (const CardReferenceArray::Reference* it = references_.ReferencesBegin(i);
+         it != references_.ReferencesEnd(i);
+         ++it) {
+      os << reinterpret_cast<const void*>((*it)->AsMirrorPtr()) << ",";
     }
     os << "},";
   }
@@ -398,8 +582,8 @@ void ModUnionTableReferenceCache::VisitObjects(ObjectCallback callback, void* ar
     });
   }
   // This may visit the same card twice, TODO avoid this.
-  for (const auto& pair : references_) {
-    const uint8_t* card = pair.first;
+  for (size_t i = 0; i < references_.Size(); ++i) {
+    const uint8_t* card = references_.Card(i);
     uintptr_t start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(card));
     uintptr_t end = start + CardTable::kCardSize;
     live_bitmap->VisitMarkedRange(start,
@@ -410,69 +594,115 @@ void ModUnionTableReferenceCache::VisitObjects(ObjectCallback callback, void* ar
   }
 }
 
-void ModUnionTableReferenceCache::UpdateAndMarkReferences(MarkObjectVisitor* visitor) {
-  CardTable* const card_table = heap_->GetCardTable();
-  std::vector<mirror::HeapReference<mirror::Object>*> cards_references;
-  // If has_target_reference is true then there was a GcRoot compressed reference which wasn't
-  // added. In this case we need to keep the card dirty.
-  // We don't know if the GcRoot addresses will remain constant, for example, classloaders have a
-  // hash set of GcRoot which may be resized or modified.
-  bool has_target_reference;
-  ModUnionReferenceVisitor add_visitor(this, visitor, &cards_references, &has_target_reference);
-  CardSet new_cleared_cards;
-  for (uint8_t* card : cleared_cards_) {
-    // Clear and re-compute alloc space references associated with this card.
-    cards_references.clear();
-    has_target_reference = false;
+// Recomputes the references of cleared_cards_[begin, end).
+static void ScanClearedCards(ModUnionTableReferenceCache* table,
+                             const ModUnionTable::CardSet& cleared_cards,
+                             size_t begin,
+                             size_t end,
+                             ModUnionCardScanResult* result)
+    REQUIRES_SHARED(Locks::heap_bitmap_lock_, Locks::mutator_lock_) {
+  Heap* const heap = table->GetHeap();
+  CardTable* const card_table = heap->GetCardTable();
+  for (size_t i = begin; i < end; ++i) {
+    uint8_t* card = cleared_cards[i];
+    // If has_target_reference is true then there was a GcRoot compressed reference which wasn't
+    // added. In this case we need to keep the card dirty.
+    // We don't know if the GcRoot addresses will remain constant, for example, classloaders have a
+    // hash set of GcRoot which may be resized or modified.
+    bool has_target_reference = false;
+    ModUnionReferenceVisitor add_visitor(table, card, result, &has_target_reference);
     uintptr_t start = reinterpret_cast<uintptr_t>(card_table->AddrFromCard(card));
-    uintptr_t end = start + CardTable::kCardSize;
+    uintptr_t card_end = start + CardTable::kCardSize;
     space::ContinuousSpace* space =
-        heap_->FindContinuousSpaceFromObject(reinterpret_cast<mirror::Object*>(start), false);
+        heap->FindContinuousSpaceFromObject(reinterpret_cast<mirror::Object*>(start), false);
     DCHECK(space != nullptr);
     ContinuousSpaceBitmap* live_bitmap = space->GetLiveBitmap();
-    live_bitmap->VisitMarkedRange(start, end, add_visitor);
-    // Update the corresponding references for the card.
-    auto found = references_.find(card);
-    if (found == references_.end()) {
-      // Don't add card for an empty reference array.
-      if (!cards_references.empty()) {
-        references_.Put(card, cards_references);
-      }
-    } else {
-      if (cards_references.empty()) {
-        references_.erase(found);
-      } else {
-        found->second = cards_references;
-      }
-    }
+    live_bitmap->VisitMarkedRange(start, card_end, add_visitor);
     if (has_target_reference) {
       // Keep this card for next time since it contains a GcRoot which matches the
       // ShouldAddReference criteria. This usually occurs for class loaders.
-      new_cleared_cards.insert(card);
+      result->kept_cards.push_back(card);
     }
   }
-  cleared_cards_ = std::move(new_cleared_cards);
+}
+
+void ModUnionTableReferenceCache::UpdateAndMarkReferences(MarkObjectVisitor* visitor) {
+  // Clear and re-compute the alloc space references associated with the cleared cards. The cards
+  // are split into chunks that the GC worker threads scan into separate results, so that the
+  // results are still in card order once concatenated.
+  const size_t num_chunks =
+      (cleared_cards_.size() + kModUnionCardsPerChunk - 1) / kModUnionCardsPerChunk;
+  std::vector<ModUnionCardScanResult> results(num_chunks);
+  RunScanChunks(heap_, num_chunks, [this, &results](size_t chunk) NO_THREAD_SAFETY_ANALYSIS {
+    const size_t begin = chunk * kModUnionCardsPerChunk;
+    const size_t end = std::min(begin + kModUnionCardsPerChunk, cleared_cards_.size());
+    ScanClearedCards(this, cleared_cards_, begin, end, &results[chunk]);
+  });
+  CardSet new_cleared_cards;
+  for (ModUnionCardScanResult& result : results) {
+    for (mirror::CompressedReference<mirror::Object>* root : result.roots) {
+      mirror::Object* old_ref = root->AsMirrorPtr();
+      mirror::Object* new_ref = visitor->MarkObject(old_ref);
+      if (old_ref != new_ref) {
+        root->Assign(new_ref);
+      }
+    }
+    new_cleared_cards.insert(new_cleared_cards.end(),
+                             result.kept_cards.begin(),
+                             result.kept_cards.end());
+  }
+  // Merge the recomputed references with the cached references of the cards which were not
+  // cleared, and mark them. Since there is no card mark for setting a reference to null, we check
+  // each reference. If all of the references of a card are null then we can remove that card.
+  // This is racy with the mutators, but handled by rescanning dirty cards.
+  CardReferenceArray new_references;
   size_t count = 0;
-  for (auto it = references_.begin(); it != references_.end();) {
-    std::vector<mirror::HeapReference<mirror::Object>*>& references = it->second;
-    // Since there is no card mark for setting a reference to null, we check each reference.
-    // If all of the references of a card are null then we can remove that card. This is racy
-    // with the mutators, but handled by rescanning dirty cards.
+  auto mark_and_add = [visitor, &new_references, &count](const uint8_t* card,
+                                                         const CardReferenceArray::Reference* begin,
+                                                         const CardReferenceArray::Reference* end)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
     bool all_null = true;
-    for (mirror::HeapReference<mirror::Object>* obj_ptr : references) {
-      if (obj_ptr->AsMirrorPtr() != nullptr) {
+    for (const CardReferenceArray::Reference* it = begin; it != end; ++it) {
+      if ((*it)->AsMirrorPtr() != nullptr) {
         all_null = false;
-        visitor->MarkHeapReference(obj_ptr, /*do_atomic_update*/ false);
+        visitor->MarkHeapReference(*it, /*do_atomic_update*/ false);
       }
     }
-    count += references.size();
+    count += end - begin;
     if (!all_null) {
-      ++it;
-    } else {
-      // All null references, erase the array from the set.
-      it = references_.erase(it);
+      new_references.Append(card, begin, end);
+    }
+  };
+  size_t old_index = 0;
+  size_t cleared_index = 0;
+  // Adds the old entries with cards before limit, or all of them if limit is null. The entries of
+  // cleared cards are dropped, the scan results replace them.
+  auto add_old_references = [&](const uint8_t* limit) REQUIRES_SHARED(Locks::mutator_lock_) {
+    for (; old_index < references_.Size() &&
+           (limit == nullptr || references_.Card(old_index) < limit);
+         ++old_index) {
+      const uint8_t* card = references_.Card(old_index);
+      while (cleared_index < cleared_cards_.size() && cleared_cards_[cleared_index] < card) {
+        ++cleared_index;
+      }
+      if (cleared_index < cleared_cards_.size() && cleared_cards_[cleared_index] == card) {
+        continue;
+      }
+      mark_and_add(card,
+                   references_.ReferencesBegin(old_index),
+                   references_.ReferencesEnd(old_index));
+    }
+  };
+  for (const ModUnionCardScanResult& result : results) {
+    const CardReferenceArray& scanned = result.references;
+    for (size_t i = 0; i < scanned.Size(); ++i) {
+      add_old_references(scanned.Card(i));
+      mark_and_add(scanned.Card(i), scanned.ReferencesBegin(i), scanned.ReferencesEnd(i));
     }
   }
+  add_old_references(nullptr);
+  references_.Swap(&new_references);
+  cleared_cards_ = std::move(new_cleared_cards);
   if (VLOG_IS_ON(heap)) {
     VLOG(gc) << "Marked " << count << " references in mod union table";
   }
@@ -546,10 +776,58 @@ void ModUnionTableCardCache::UpdateAndMarkReferences(MarkObjectVisitor* visitor)
       heap_->GetBootImageSpaces().empty() ? nullptr : heap_->GetBootImageSpaces()[0];
   // If we don't have an image space, just pass in space_ as the immune space. Pass in the same
   // space_ instead of image_space to avoid a null check in ModUnionUpdateObjectReferencesVisitor.
-  CardBitVisitor bit_visitor(visitor, space_, image_space != nullptr ? image_space : space_,
-      card_bitmap_.get());
-  card_bitmap_->VisitSetBits(
-      0, RoundUp(space_->Size(), CardTable::kCardSize) / CardTable::kCardSize, bit_visitor);
+  space::ContinuousSpace* const immune_space = image_space != nullptr ? image_space : space_;
+  const size_t num_bits = RoundUp(space_->Size(), CardTable::kCardSize) / CardTable::kCardSize;
+  if (!kParallelModUnionTables || heap_->GetThreadPool() == nullptr) {
+    CardBitVisitor bit_visitor(visitor, space_, immune_space, card_bitmap_.get());
+    card_bitmap_->VisitSetBits(0, num_bits, bit_visitor);
+    return;
+  }
+  // Find the references of the set cards with the GC worker threads, then mark them on this
+  // thread.
+  std::vector<size_t> bits;
+  card_bitmap_->VisitSetBits(0, num_bits, [&bits](size_t bit_index) {
+    bits.push_back(bit_index);
+  });
+  const size_t num_chunks = (bits.size() + kModUnionCardsPerChunk - 1) / kModUnionCardsPerChunk;
+  std::vector<ModUnionCardCacheScanResult> results(num_chunks);
+  RunScanChunks(heap_,
+                num_chunks,
+                [this, immune_space, &bits, &results](size_t chunk) NO_THREAD_SAFETY_ANALYSIS {
+    const size_t begin = chunk * kModUnionCardsPerChunk;
+    const size_t end = std::min(begin + kModUnionCardsPerChunk, bits.size());
+    ModUnionCollectReferencesVisitor collect_visitor(space_, immune_space, &results[chunk]);
+    ContinuousSpaceBitmap* live_bitmap = space_->GetLiveBitmap();
+    for (size_t i = begin; i < end; ++i) {
+      const uintptr_t start = card_bitmap_->AddrFromBitIndex(bits[i]);
+      DCHECK(space_->HasAddress(reinterpret_cast<mirror::Object*>(start)))
+          << start << " " << *space_;
+      const size_t num_references = results[chunk].NumReferences();
+      live_bitmap->VisitMarkedRange(start, start + CardTable::kCardSize, collect_visitor);
+      if (results[chunk].NumReferences() == num_references) {
+        results[chunk].clean_bits.push_back(bits[i]);
+      }
+    }
+  });
+  bool unused_contains_reference_to_other_space;
+  ModUnionUpdateObjectReferencesVisitor mark_visitor(visitor,
+                                                     space_,
+                                                     immune_space,
+                                                     &unused_contains_reference_to_other_space);
+  for (const ModUnionCardCacheScanResult& result : results) {
+    for (size_t bit_index : result.clean_bits) {
+      // No non null reference to another space, clear the bit.
+      card_bitmap_->ClearBit(bit_index);
+    }
+    // The references are read again since mutators may have changed them after the scan, in
+    // which case their card got dirtied and will be processed by the next update.
+    for (mirror::HeapReference<mirror::Object>* ref : result.references) {
+      mark_visitor.MarkReference(ref);
+    }
+    for (mirror::CompressedReference<mirror::Object>* root : result.roots) {
+      mark_visitor.MarkReference(root);
+    }
+  }
 }
 
 void ModUnionTableCardCache::VisitObjects(ObjectCallback callback, void* arg) {
@@ -596,14 +874,15 @@ bool ModUnionTableCardCache::ContainsCardFor(uintptr_t addr) {
 void ModUnionTableReferenceCache::SetCards() {
   for (uint8_t* addr = space_->Begin(); addr < AlignUp(space_->End(), CardTable::kCardSize);
        addr += CardTable::kCardSize) {
-    cleared_cards_.insert(heap_->GetCardTable()->CardFromAddr(reinterpret_cast<void*>(addr)));
+    cleared_cards_.push_back(heap_->GetCardTable()->CardFromAddr(reinterpret_cast<void*>(addr)));
   }
+  NormalizeCardSet(&cleared_cards_);
 }
 
 bool ModUnionTableReferenceCache::ContainsCardFor(uintptr_t addr) {
   auto* card_ptr = heap_->GetCardTable()->CardFromAddr(reinterpret_cast<void*>(addr));
-  return cleared_cards_.find(card_ptr) != cleared_cards_.end() ||
-      references_.find(card_ptr) != references_.end();
+  return std::binary_search(cleared_cards_.begin(), cleared_cards_.end(), card_ptr) ||
+      references_.Find(card_ptr) != references_.Size();
 }
 
 }  // namespace accounting
@@ -22,9 +22,7 @@
 #include "card_table.h"
 #include "globals.h"
 #include "mirror/object_reference.h"
-#include "safe_map.h"
 
-#include <set>
 #include <vector>
 
 namespace art {
@@ -51,8 +49,8 @@ class ModUnionTable {
   // A callback for visiting an object in the heap.
   using ObjectCallback = void (*)(mirror::Object*, void*);
 
-  typedef std::set<uint8_t*, std::less<uint8_t*>,
-                   TrackingAllocator<uint8_t*, kAllocatorTagModUnionCardSet>> CardSet;
+  // Sorted by address and without duplicates.
+  typedef std::vector<uint8_t*, TrackingAllocator<uint8_t*, kAllocatorTagModUnionCardSet>> CardSet;
   typedef MemoryRangeBitmap<CardTable::kCardSize> CardBitmap;
 
   explicit ModUnionTable(const std::string& name, Heap* heap, space::ContinuousSpace* space)
@@ -114,6 +112,51 @@ class ModUnionTable {
   space::ContinuousSpace* const space_;
 };
 
+// Compact storage of the references cached for each card of a ModUnionTableReferenceCache. The
+// entries are sorted by card and all the references are kept in a single array, the entry of a
+// card only records where its references end.
+class CardReferenceArray {
+ public:
+  typedef mirror::HeapReference<mirror::Object>* Reference;
+
+  size_t Size() const {
+    return cards_.size();
+  }
+  bool IsEmpty() const {
+    return cards_.empty();
+  }
+  size_t NumReferences() const {
+    return references_.size();
+  }
+  const uint8_t* Card(size_t index) const {
+    return cards_[index];
+  }
+  const Reference* ReferencesBegin(size_t index) const {
+    return references_.data() + (index == 0 ? 0 : ends_[index - 1]);
+  }
+  const Reference* ReferencesEnd(size_t index) const {
+    return references_.data() + ends_[index];
+  }
+
+  // Returns the index of the entry of card, or Size() if there is none.
+  size_t Find(const uint8_t* card) const;
+
+  // Adds an entry, card must be after the card of the last entry.
+  void Append(const uint8_t* card, const Reference* begin, const Reference* end);
+  // Adds a reference to the last entry, or to a new entry if card is after its card.
+  void AppendReference(const uint8_t* card, Reference ref);
+
+  void Clear();
+  void Swap(CardReferenceArray* other);
+
+ private:
+  std::vector<const uint8_t*,
+              TrackingAllocator<const uint8_t*, kAllocatorTagModUnionReferenceArray>> cards_;
+  std::vector<size_t, TrackingAllocator<size_t, kAllocatorTagModUnionReferenceArray>> ends_;
+  std::vector<Reference, TrackingAllocator<Reference, kAllocatorTagModUnionReferenceArray>>
+      references_;
+};
+
 // Reference caching implementation. Caches references pointing to alloc space(s) for each card.
 class ModUnionTableReferenceCache : public ModUnionTable {
  public:
@@ -156,9 +199,8 @@ class ModUnionTableReferenceCache : public ModUnionTable {
   // Cleared card array, used to update the mod-union table.
   ModUnionTable::CardSet cleared_cards_;
 
-  // Maps from dirty cards to their corresponding alloc space references.
-  AllocationTrackingSafeMap<const uint8_t*, std::vector<mirror::HeapReference<mirror::Object>*>,
-                            kAllocatorTagModUnionReferenceArray> references_;
+  // Dirty cards and their corresponding alloc space references.
+  CardReferenceArray references_;
 };
 
 // Card caching implementation. Keeps track of which cards we cleared and only this information.
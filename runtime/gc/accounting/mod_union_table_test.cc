@@ -16,6 +16,8 @@
 
 #include "mod_union_table-inl.h"
 
+#include <set>
+
 #include "class_linker-inl.h"
 #include "common_runtime_test.h"
 #include "gc/space/space-inl.h"
@@ -174,6 +176,33 @@ TEST_F(ModUnionTableTest, TestReferenceCache) {
   RunTest(ModUnionTableFactory::kTableTypeReferenceCache);
 }
 
+TEST_F(ModUnionTableTest, TestCardReferenceArray) {
+  uint8_t cards[3];
+  mirror::HeapReference<mirror::Object> refs[4];
+  CardReferenceArray::Reference ptrs[] = { &refs[0], &refs[1], &refs[2], &refs[3] };
+  CardReferenceArray array;
+  EXPECT_TRUE(array.IsEmpty());
+  array.Append(&cards[0], &ptrs[0], &ptrs[2]);
+  array.AppendReference(&cards[2], ptrs[2]);
+  array.AppendReference(&cards[2], ptrs[3]);
+  ASSERT_EQ(2u, array.Size());
+  EXPECT_EQ(4u, array.NumReferences());
+  EXPECT_EQ(0u, array.Find(&cards[0]));
+  EXPECT_EQ(array.Size(), array.Find(&cards[1]));
+  EXPECT_EQ(1u, array.Find(&cards[2]));
+  EXPECT_EQ(2, array.ReferencesEnd(0) - array.ReferencesBegin(0));
+  EXPECT_EQ(ptrs[1], array.ReferencesBegin(0)[1]);
+  EXPECT_EQ(2, array.ReferencesEnd(1) - array.ReferencesBegin(1));
+  EXPECT_EQ(ptrs[3], array.ReferencesBegin(1)[1]);
+  CardReferenceArray other;
+  other.Swap(&array);
+  EXPECT_TRUE(array.IsEmpty());
+  EXPECT_EQ(2u, other.Size());
+  other.Clear();
+  EXPECT_TRUE(other.IsEmpty());
+  EXPECT_EQ(0u, other.NumReferences());
+}
+
 void ModUnionTableTest::RunTest(ModUnionTableFactory::TableType type) {
   Thread* const self = Thread::Current();
   ScopedObjectAccess soa(self);
@@ -19,6 +19,7 @@
 
 #include "space_bitmap.h"
 
+#include <algorithm>
 #include <memory>
 
 #include <android-base/logging.h>
@@ -30,6 +31,38 @@ namespace art {
 namespace gc {
 namespace accounting {
 
+// How many objects ahead of the one being visited VisitSetBits prefetches the header of.
+static constexpr size_t kVisitPrefetchDistance = 4;
+
+// Visits, in address order, the objects of the set bits of a bitmap word whose first bit
+// corresponds to ptr_base. All the object addresses are extracted before the first visit, the same
+// as if the word was read once, which lets the header of the object kVisitPrefetchDistance ahead be
+// prefetched while the visitor works on the current one.
+template<size_t kAlignment, typename Visitor>
+static ALWAYS_INLINE void VisitSetBits(uintptr_t ptr_base, uintptr_t word, Visitor&& visitor) {
+  DCHECK_NE(word, 0u);
+  if ((word & (word - 1)) == 0) {
+    // A single object, the common case for sparse bitmaps.
+    visitor(reinterpret_cast<mirror::Object*>(ptr_base + CTZ(word) * kAlignment));
+    return;
+  }
+  mirror::Object* objs[kBitsPerIntPtrT];
+  size_t count = 0;
+  do {
+    objs[count++] = reinterpret_cast<mirror::Object*>(ptr_base + CTZ(word) * kAlignment);
+    word &= word - 1;
+  } while (word != 0);
+  for (size_t i = 0; i < std::min(count, kVisitPrefetchDistance); ++i) {
+    __builtin_prefetch(objs[i]);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (i + kVisitPrefetchDistance < count) {
+      __builtin_prefetch(objs[i + kVisitPrefetchDistance]);
+    }
+    visitor(objs[i]);
+  }
+}
+
 template<size_t kAlignment>
 inline bool SpaceBitmap<kAlignment>::AtomicTestAndSet(const mirror::Object* obj) {
   uintptr_t addr = reinterpret_cast<uintptr_t>(obj);
@@ -108,12 +141,7 @@ inline void SpaceBitmap<kAlignment>::VisitMarkedRange(uintptr_t visit_begin,
     // Traverse left edge.
     if (left_edge != 0) {
       const uintptr_t ptr_base = IndexToOffset(index_start) + heap_begin_;
-      do {
-        const size_t shift = CTZ(left_edge);
-        mirror::Object* obj = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
-        visitor(obj);
-        left_edge ^= (static_cast<uintptr_t>(1)) << shift;
-      } while (left_edge != 0);
+      VisitSetBits<kAlignment>(ptr_base, left_edge, visitor);
     }
 
     // Traverse the middle, full part.
@@ -121,12 +149,7 @@ inline void SpaceBitmap<kAlignment>::VisitMarkedRange(uintptr_t visit_begin,
       uintptr_t w = bitmap_begin_[i].LoadRelaxed();
       if (w != 0) {
         const uintptr_t ptr_base = IndexToOffset(i) + heap_begin_;
-        do {
-          const size_t shift = CTZ(w);
-          mirror::Object* obj = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
-          visitor(obj);
-          w ^= (static_cast<uintptr_t>(1)) << shift;
-        } while (w != 0);
+        VisitSetBits<kAlignment>(ptr_base, w, visitor);
       }
     }
 
@@ -147,12 +170,7 @@ inline void SpaceBitmap<kAlignment>::VisitMarkedRange(uintptr_t visit_begin,
   right_edge &= ((static_cast<uintptr_t>(1) << bit_end) - 1);
   if (right_edge != 0) {
     const uintptr_t ptr_base = IndexToOffset(index_end) + heap_begin_;
-    do {
-      const size_t shift = CTZ(right_edge);
-      mirror::Object* obj = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
-      visitor(obj);
-      right_edge ^= (static_cast<uintptr_t>(1)) << shift;
-    } while (right_edge != 0);
+    VisitSetBits<kAlignment>(ptr_base, right_edge, visitor);
   }
 #endif
 }
@@ -167,12 +185,7 @@ void SpaceBitmap<kAlignment>::Walk(Visitor&& visitor) {
     uintptr_t w = bitmap_begin[i].LoadRelaxed();
     if (w != 0) {
       uintptr_t ptr_base = IndexToOffset(i) + heap_begin_;
-      do {
-        const size_t shift = CTZ(w);
-        mirror::Object* obj = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
-        visitor(obj);
-        w ^= (static_cast<uintptr_t>(1)) << shift;
-      } while (w != 0);
+      VisitSetBits<kAlignment>(ptr_base, w, visitor);
     }
   }
 }
@@ -31,6 +31,9 @@ namespace accounting {
 
 using android::base::StringPrintf;
 
+// Number of bitmap words SweepWalk checks for garbage at once.
+static constexpr size_t kSweepBlockWords = 4;
+
 template<size_t kAlignment>
 size_t SpaceBitmap<kAlignment>::ComputeBitmapSize(uint64_t capacity) {
   const uint64_t kBytesCoveredPerWord = kAlignment * kBitsPerIntPtrT;
@@ -177,13 +180,31 @@ void SpaceBitmap<kAlignment>::SweepWalk(const SpaceBitmap<kAlignment>& live_bitm
   Atomic<uintptr_t>* live = live_bitmap.bitmap_begin_;
   Atomic<uintptr_t>* mark = mark_bitmap.bitmap_begin_;
   for (size_t i = start; i <= end; i++) {
+    // Most of a swept range is either all live or all free, skip blocks of words without garbage
+    // with a single branch.
+    while (i + kSweepBlockWords <= end + 1) {
+      uintptr_t block_garbage = 0;
+      for (size_t j = i; j < i + kSweepBlockWords; ++j) {
+        block_garbage |= live[j].LoadRelaxed() & ~mark[j].LoadRelaxed();
+      }
+      if (block_garbage != 0) {
+        break;
+      }
+      i += kSweepBlockWords;
+    }
+    if (i > end) {
+      break;
+    }
     uintptr_t garbage = live[i].LoadRelaxed() & ~mark[i].LoadRelaxed();
     if (UNLIKELY(garbage != 0)) {
       uintptr_t ptr_base = IndexToOffset(i) + live_bitmap.heap_begin_;
       do {
         const size_t shift = CTZ(garbage);
-        garbage ^= (static_cast<uintptr_t>(1)) << shift;
-        *pb++ = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
+        garbage &= garbage - 1;
+        mirror::Object* obj = reinterpret_cast<mirror::Object*>(ptr_base + shift * kAlignment);
+        // The sweep callbacks read the header of every object to size it.
+        __builtin_prefetch(obj);
+        *pb++ = obj;
       } while (garbage != 0);
       // Make sure that there are always enough slots available for an
       // entire word of one bits.
@@ -18,6 +18,7 @@
 
 #include <stdint.h>
 #include <memory>
+#include <vector>
 
 #include "base/mutex.h"
 #include "common_runtime_test.h"
@@ -257,6 +258,77 @@ TEST_F(SpaceBitmapTest, OrderPageAlignment) {
   RunTestOrder<kPageSize>();
 }
 
+// Sets runs of consecutive bits so that whole bitmap words have many objects.
+TEST_F(SpaceBitmapTest, VisitDenseRange) {
+  uint8_t* heap_begin = reinterpret_cast<uint8_t*>(0x10000000);
+  size_t heap_capacity = 1 * MB;
+  std::unique_ptr<ContinuousSpaceBitmap> space_bitmap(
+      ContinuousSpaceBitmap::Create("test bitmap", heap_begin, heap_capacity));
+  ASSERT_TRUE(space_bitmap.get() != nullptr);
+  std::vector<mirror::Object*> expected;
+  for (size_t offset = 0; offset < heap_capacity; offset += kObjectAlignment) {
+    // Runs of 100 set bits followed by 28 clear bits, crossing word boundaries.
+    if ((offset / kObjectAlignment) % 128 < 100) {
+      mirror::Object* obj = reinterpret_cast<mirror::Object*>(heap_begin + offset);
+      space_bitmap->Set(obj);
+      expected.push_back(obj);
+    }
+  }
+  std::vector<mirror::Object*> visited;
+  space_bitmap->VisitMarkedRange(reinterpret_cast<uintptr_t>(heap_begin),
+                                 reinterpret_cast<uintptr_t>(heap_begin) + heap_capacity,
+                                 [&visited](mirror::Object* obj) { visited.push_back(obj); });
+  EXPECT_EQ(expected, visited);
+}
+
+static void SweepTestCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg) {
+  std::vector<mirror::Object*>* swept = reinterpret_cast<std::vector<mirror::Object*>*>(arg);
+  swept->insert(swept->end(), ptrs, ptrs + num_ptrs);
+}
+
+TEST_F(SpaceBitmapTest, SweepWalk) {
+  uint8_t* heap_begin = reinterpret_cast<uint8_t*>(0x10000000);
+  size_t heap_capacity = 1 * MB;
+  std::unique_ptr<ContinuousSpaceBitmap> live_bitmap(
+      ContinuousSpaceBitmap::Create("live bitmap", heap_begin, heap_capacity));
+  std::unique_ptr<ContinuousSpaceBitmap> mark_bitmap(
+      ContinuousSpaceBitmap::Create("mark bitmap", heap_begin, heap_capacity));
+  ASSERT_TRUE(live_bitmap.get() != nullptr);
+  ASSERT_TRUE(mark_bitmap.get() != nullptr);
+  RandGen r(0x1234);
+  std::vector<mirror::Object*> garbage;
+  for (size_t offset = 0; offset < heap_capacity; offset += kObjectAlignment) {
+    // Alternate between mostly live, mostly garbage and empty 64KB stretches.
+    const size_t stretch = (offset / (64 * KB)) % 3;
+    if (stretch == 2) {
+      continue;
+    }
+    mirror::Object* obj = reinterpret_cast<mirror::Object*>(heap_begin + offset);
+    live_bitmap->Set(obj);
+    if (r.next() % 16 >= (stretch == 0 ? 1u : 15u)) {
+      mark_bitmap->Set(obj);
+    } else {
+      garbage.push_back(obj);
+    }
+  }
+  // SweepWalk works on whole bitmap words, so keep sweep_begin word aligned.
+  const size_t word_offset = kBitsPerIntPtrT * kObjectAlignment;
+  for (size_t begin_offset : { static_cast<size_t>(0), 40 * KB + word_offset }) {
+    const uintptr_t sweep_begin = reinterpret_cast<uintptr_t>(heap_begin) + begin_offset;
+    const uintptr_t sweep_end = reinterpret_cast<uintptr_t>(heap_begin) + heap_capacity;
+    std::vector<mirror::Object*> expected;
+    for (mirror::Object* obj : garbage) {
+      if (reinterpret_cast<uintptr_t>(obj) >= sweep_begin) {
+        expected.push_back(obj);
+      }
+    }
+    std::vector<mirror::Object*> swept;
+    ContinuousSpaceBitmap::SweepWalk(*live_bitmap, *mark_bitmap, sweep_begin, sweep_end,
+                                     &SweepTestCallback, &swept);
+    EXPECT_EQ(expected, swept);
+  }
+}
+
 }  // namespace accounting
 }  // namespace gc
 }  // namespace art
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "art_method-inl.h"
+#include "base/enums.h"
+#include "base/logging.h"
+#include "base/time_utils.h"
+#include "gc/allocation_listener.h"
+#include "gc_root-inl.h"
+#include "handle_scope-inl.h"
+#include "obj_ptr-inl.h"
+#include "stack.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+
+class AllocationSampleStackVisitor : public StackVisitor {
+ public:
+  AllocationSampleStackVisitor(Thread* thread, AllocRecordStackTrace* trace_out)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
+        trace_(trace_out) {}
+
+  bool VisitFrame() OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    if (trace_->GetDepth() >= AllocationSampler::kMaxStackDepth) {
+      return false;
+    }
+    ArtMethod* m = GetMethod();
+    // m may be null if we have inlined methods of unresolved classes. b/27858645
+    if (m != nullptr && !m->IsRuntimeMethod()) {
+      m = m->GetInterfaceMethodIfProxy(kRuntimePointerSize);
+      trace_->AddStackElement(AllocRecordStackTraceElement(m, GetDexPc()));
+    }
+    return true;
+  }
+
+ private:
+  AllocRecordStackTrace* const trace_;
+};
+
+AllocationSampler::AllocationSampler(size_t sampling_interval)
+    : sampling_interval_(sampling_interval),
+      listener_(nullptr),
+      lock_("allocation sampler lock", kDefaultMutexLevel),
+      total_samples_(0),
+      dropped_samples_(0) {}
+
+void AllocationSampler::SetSamplingInterval(size_t interval) {
+  size_t old_interval = sampling_interval_.ExchangeRelaxed(interval);
+  if (old_interval != interval) {
+    LOG(INFO) << "Allocation sampling interval " << PrettySize(old_interval) << " -> "
+              << PrettySize(interval);
+  }
+}
+
+size_t AllocationSampler::NextSampleDistance(uint64_t* random_state, size_t mean) {
+  // xorshift64* is plenty for picking sample points and keeps the state in a single word.
+  uint64_t x = *random_state;
+  x ^= x >> 12;
+  x ^= x << 25;
+  x ^= x >> 27;
+  *random_state = x;
+  const uint64_t bits = x * UINT64_C(2685821657736338717);
+  // Uniform in (0, 1] from the top 53 bits, so that the logarithm is finite.
+  const double uniform = (static_cast<double>(bits >> 11) + 1.0) / static_cast<double>(1ull << 53);
+  // The distance between the events of a Poisson process is exponentially distributed.
+  return static_cast<size_t>(-std::log(uniform) * static_cast<double>(mean)) + 1u;
+}
+
+bool AllocationSampler::ShouldSample(Thread* self, size_t bulk_bytes) {
+  const size_t interval = sampling_interval_.LoadRelaxed();
+  if (interval == 0) {
+    return false;
+  }
+  uint64_t* random_state = self->GetAllocSampleRandomState();
+  if (UNLIKELY(*random_state == 0)) {
+    // First slow path allocation of this thread since sampling was enabled. Pick the first sample
+    // point instead of sampling right away, so that thread start doesn't bias the samples.
+    *random_state = ((static_cast<uint64_t>(self->GetTid()) << 32) ^ NanoTime()) | 1u;
+    self->SetAllocSampleBytesLeft(NextSampleDistance(random_state, interval));
+  }
+  const int64_t bytes_left = self->GetAllocSampleBytesLeft() - static_cast<int64_t>(bulk_bytes);
+  if (LIKELY(bytes_left > 0)) {
+    self->SetAllocSampleBytesLeft(bytes_left);
+    return false;
+  }
+  // The sample point falls into the bytes just obtained. If they span several sample points,
+  // e.g. for a large object, only one sample is taken.
+  self->SetAllocSampleBytesLeft(NextSampleDistance(random_state, interval));
+  return true;
+}
+
+void AllocationSampler::SampleAllocation(Thread* self,
+                                         ObjPtr<mirror::Object>* obj,
+                                         size_t byte_count) {
+  // Get the stack trace outside of the lock, as for the allocation tracker.
+  AllocRecordStackTrace trace;
+  AllocationSampleStackVisitor visitor(self, &trace);
+  {
+    StackHandleScope<1> hs(self);
+    auto obj_wrapper = hs.NewHandleWrapper(obj);
+    visitor.WalkStack();
+  }
+  const uint64_t estimated_bytes = std::max(GetSamplingInterval(), byte_count);
+  {
+    MutexLock mu(self, lock_);
+    ++total_samples_;
+    auto it = call_sites_.find(trace);
+    if (it == call_sites_.end()) {
+      if (call_sites_.size() >= kMaxCallSites) {
+        ++dropped_samples_;
+      } else {
+        it = call_sites_.emplace(std::move(trace), CallSiteStats()).first;
+      }
+    }
+    if (it != call_sites_.end()) {
+      CallSiteStats& stats = it->second;
+      ++stats.samples;
+      stats.sampled_bytes += byte_count;
+      stats.estimated_bytes += estimated_bytes;
+    }
+  }
+  AllocationListener* l = listener_.LoadSequentiallyConsistent();
+  if (l != nullptr) {
+    l->ObjectAllocated(self, obj, byte_count);
+  }
+}
+
+void AllocationSampler::SetListener(AllocationListener* l) {
+  listener_.StoreSequentiallyConsistent(l);
+}
+
+void AllocationSampler::RemoveListener() {
+  listener_.StoreSequentiallyConsistent(nullptr);
+}
+
+void AllocationSampler::VisitRoots(RootVisitor* visitor) {
+  BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(visitor, RootInfo(kRootDebugger));
+  MutexLock mu(Thread::Current(), lock_);
+  for (const auto& entry : call_sites_) {
+    const AllocRecordStackTrace& trace = entry.first;
+    for (size_t i = 0, depth = trace.GetDepth(); i < depth; ++i) {
+      const AllocRecordStackTraceElement& element = trace.GetStackElement(i);
+      DCHECK(element.GetMethod() != nullptr);
+      element.GetMethod()->VisitRoots(buffered_visitor, kRuntimePointerSize);
+    }
+  }
+}
+
+void AllocationSampler::Clear() {
+  MutexLock mu(Thread::Current(), lock_);
+  call_sites_.clear();
+  total_samples_ = 0;
+  dropped_samples_ = 0;
+}
+
+size_t AllocationSampler::NumCallSites() {
+  MutexLock mu(Thread::Current(), lock_);
+  return call_sites_.size();
+}
+
+uint64_t AllocationSampler::GetTotalSamples() {
+  MutexLock mu(Thread::Current(), lock_);
+  return total_samples_;
+}
+
+uint64_t AllocationSampler::GetDroppedSamples() {
+  MutexLock mu(Thread::Current(), lock_);
+  return dropped_samples_;
+}
+
+void AllocationSampler::Dump(std::ostream& os, size_t max_call_sites) {
+  MutexLock mu(Thread::Current(), lock_);
+  os << "Allocation sampling interval " << PrettySize(GetSamplingInterval()) << ": "
+     << total_samples_ << " samples (" << dropped_samples_ << " dropped) from "
+     << call_sites_.size() << " call sites\n";
+  std::vector<CallSiteMap::const_iterator> sorted;
+  sorted.reserve(call_sites_.size());
+  for (auto it = call_sites_.begin(); it != call_sites_.end(); ++it) {
+    sorted.push_back(it);
+  }
+  const size_t count = std::min(max_call_sites, sorted.size());
+  std::partial_sort(sorted.begin(),
+                    sorted.begin() + count,
+                    sorted.end(),
+                    [](CallSiteMap::const_iterator a, CallSiteMap::const_iterator b) {
+                      return a->second.estimated_bytes > b->second.estimated_bytes;
+                    });
+  for (size_t i = 0; i < count; ++i) {
+    const AllocRecordStackTrace& trace = sorted[i]->first;
+    const CallSiteStats& stats = sorted[i]->second;
+    os << "  ~" << PrettySize(stats.estimated_bytes) << " in " << stats.samples << " samples ("
+       << PrettySize(stats.sampled_bytes) << " sampled)\n";
+    for (size_t j = 0, depth = trace.GetDepth(); j < depth; ++j) {
+      const AllocRecordStackTraceElement& element = trace.GetStackElement(j);
+      os << "    at " << element.GetMethod()->PrettyMethod() << ":"
+         << element.ComputeLineNumber() << "\n";
+    }
+  }
+}
+
+}  // namespace gc
+}  // namespace art
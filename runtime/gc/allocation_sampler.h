@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+#define ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
+
+#include <iosfwd>
+#include <unordered_map>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "gc/allocation_record.h"
+#include "globals.h"
+#include "obj_ptr.h"
+
+namespace art {
+
+class RootVisitor;
+class Thread;
+
+namespace mirror {
+class Object;
+}  // namespace mirror
+
+namespace gc {
+
+class AllocationListener;
+
+// Low overhead allocation profiler. Allocations are sampled as a Poisson process over the
+// allocated bytes, each thread takes on average one sample per sampling interval bytes. The
+// check is only done on the allocation slow path, when a thread obtains a new TLAB or
+// thread-local run or allocates outside of them, so the fast paths are unaffected. The sample is
+// attributed to the allocation that hit the slow path.
+//
+// Sampled stacks are aggregated into a table of call sites which is bounded both in the number
+// of call sites and in their depth, samples from new call sites are dropped once it is full.
+class AllocationSampler {
+ public:
+  static constexpr size_t kDefaultSamplingInterval = 512 * KB;
+  static constexpr size_t kMaxStackDepth = 16;
+  static constexpr size_t kMaxCallSites = 4096;
+
+  struct CallSiteStats {
+    uint64_t samples = 0;
+    // Sum of the sizes of the sampled objects.
+    uint64_t sampled_bytes = 0;
+    // Estimate of the bytes allocated from the call site, each sample accounts for one interval.
+    uint64_t estimated_bytes = 0;
+  };
+
+  explicit AllocationSampler(size_t sampling_interval);
+
+  bool IsEnabled() const {
+    return sampling_interval_.LoadRelaxed() != 0;
+  }
+
+  size_t GetSamplingInterval() const {
+    return sampling_interval_.LoadRelaxed();
+  }
+
+  // Sets the mean number of bytes between samples. Zero disables sampling, the collected call
+  // sites are kept until Clear() is called.
+  void SetSamplingInterval(size_t interval);
+
+  // Called on the allocation slow path with the number of bytes the thread just obtained.
+  // Returns true if the allocation being done should be sampled.
+  bool ShouldSample(Thread* self, size_t bulk_bytes);
+
+  // Records the stack of the sampled allocation and reports it to the listener, if any.
+  void SampleAllocation(Thread* self, ObjPtr<mirror::Object>* obj, size_t byte_count)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Install a listener for sampled allocations. As for Heap::SetAllocationListener() the
+  // listener must stay valid after it is removed.
+  void SetListener(AllocationListener* l);
+  void RemoveListener();
+
+  // Keep the classes of the methods in the call site table from being unloaded.
+  void VisitRoots(RootVisitor* visitor)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  void Clear() REQUIRES(!lock_);
+
+  // Dump the call sites with the most estimated bytes.
+  void Dump(std::ostream& os, size_t max_call_sites)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  size_t NumCallSites() REQUIRES(!lock_);
+  uint64_t GetTotalSamples() REQUIRES(!lock_);
+  uint64_t GetDroppedSamples() REQUIRES(!lock_);
+
+  // Returns an exponentially distributed distance to the next sample with the given mean and
+  // advances the random state.
+  static size_t NextSampleDistance(uint64_t* random_state, size_t mean);
+
+ private:
+  using CallSiteMap =
+      std::unordered_map<AllocRecordStackTrace, CallSiteStats, HashAllocRecordTypes>;
+
+  Atomic<size_t> sampling_interval_;
+  Atomic<AllocationListener*> listener_;
+
+  Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  CallSiteMap call_sites_ GUARDED_BY(lock_);
+  uint64_t total_samples_ GUARDED_BY(lock_);
+  uint64_t dropped_samples_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSampler);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ALLOCATION_SAMPLER_H_
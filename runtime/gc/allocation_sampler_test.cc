@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_sampler.h"
+
+#include <sstream>
+
+#include "common_runtime_test.h"
+#include "handle_scope-inl.h"
+#include "mirror/object-inl.h"
+#include "mirror/string.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+namespace gc {
+
+class AllocationSamplerTest : public CommonRuntimeTest {};
+
+TEST_F(AllocationSamplerTest, SampleDistanceMean) {
+  static constexpr size_t kMean = 64 * KB;
+  static constexpr size_t kDraws = 100000;
+  uint64_t random_state = 0x2545f4914f6cdd1dull;
+  uint64_t sum = 0;
+  for (size_t i = 0; i < kDraws; ++i) {
+    size_t distance = AllocationSampler::NextSampleDistance(&random_state, kMean);
+    ASSERT_GT(distance, 0u);
+    sum += distance;
+  }
+  const double mean = static_cast<double>(sum) / kDraws;
+  EXPECT_GT(mean, kMean * 0.97);
+  EXPECT_LT(mean, kMean * 1.03);
+}
+
+TEST_F(AllocationSamplerTest, ShouldSampleRate) {
+  static constexpr size_t kInterval = 64 * KB;
+  static constexpr size_t kBulkBytes = 4 * KB;
+  static constexpr size_t kRefills = 10000;
+  Thread* self = Thread::Current();
+  AllocationSampler sampler(0u);
+  EXPECT_FALSE(sampler.IsEnabled());
+  EXPECT_FALSE(sampler.ShouldSample(self, kBulkBytes));
+  sampler.SetSamplingInterval(kInterval);
+  EXPECT_TRUE(sampler.IsEnabled());
+  size_t samples = 0;
+  for (size_t i = 0; i < kRefills; ++i) {
+    if (sampler.ShouldSample(self, kBulkBytes)) {
+      ++samples;
+    }
+  }
+  // 40MB at one sample per 64KB on average.
+  const size_t expected = kRefills * kBulkBytes / kInterval;
+  EXPECT_GT(samples, expected * 8 / 10);
+  EXPECT_LT(samples, expected * 12 / 10);
+  sampler.SetSamplingInterval(0u);
+  EXPECT_FALSE(sampler.ShouldSample(self, kInterval * 100));
+}
+
+TEST_F(AllocationSamplerTest, AggregateCallSites) {
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  StackHandleScope<1> hs(self);
+  Handle<mirror::String> str(hs.NewHandle(mirror::String::AllocFromModifiedUtf8(self, "sample")));
+  ASSERT_TRUE(str != nullptr);
+  AllocationSampler sampler(AllocationSampler::kDefaultSamplingInterval);
+  ObjPtr<mirror::Object> obj = str.Get();
+  const size_t size = obj->SizeOf();
+  sampler.SampleAllocation(self, &obj, size);
+  sampler.SampleAllocation(self, &obj, size);
+  // Both samples come from the same (native) stack.
+  EXPECT_EQ(sampler.NumCallSites(), 1u);
+  EXPECT_EQ(sampler.GetTotalSamples(), 2u);
+  EXPECT_EQ(sampler.GetDroppedSamples(), 0u);
+  std::ostringstream oss;
+  sampler.Dump(oss, 10u);
+  EXPECT_NE(oss.str().find("2 samples"), std::string::npos) << oss.str();
+  sampler.Clear();
+  EXPECT_EQ(sampler.NumCallSites(), 0u);
+  EXPECT_EQ(sampler.GetTotalSamples(), 0u);
+}
+
+}  // namespace gc
+}  // namespace art
@@ -16,6 +16,8 @@
 
 #include "rosalloc.h"
 
+#include <algorithm>
+#include <limits>
 #include <list>
 #include <map>
 #include <sstream>
@@ -62,7 +64,8 @@ RosAlloc::RosAlloc(void* base, size_t capacity, size_t max_capacity,
       bulk_free_lock_("rosalloc bulk free lock", kRosAllocBulkFreeLock),
       page_release_mode_(page_release_mode),
       page_release_size_threshold_(page_release_size_threshold),
-      is_running_on_memory_tool_(running_on_memory_tool) {
+      is_running_on_memory_tool_(running_on_memory_tool),
+      release_cursor_(0) {
   DCHECK_ALIGNED(base, kPageSize);
   DCHECK_EQ(RoundUp(capacity, kPageSize), capacity);
   DCHECK_EQ(RoundUp(max_capacity, kPageSize), max_capacity);
@@ -577,22 +580,79 @@ RosAlloc::Run* RosAlloc::AllocRun(Thread* self, size_t idx) {
   return new_run;
 }
 
-RosAlloc::Run* RosAlloc::RefillRun(Thread* self, size_t idx) {
+RosAlloc::Run* RosAlloc::TakeNonFullRun(size_t idx) {
   // Get the lowest address non-full run from the binary tree.
   auto* const bt = &non_full_runs_[idx];
-  if (!bt->empty()) {
-    // If there's one, use it as the current run.
-    auto it = bt->begin();
-    Run* non_full_run = *it;
-    DCHECK(non_full_run != nullptr);
-    DCHECK(!non_full_run->IsThreadLocal());
-    bt->erase(it);
+  if (bt->empty()) {
+    return nullptr;
+  }
+  auto it = bt->begin();
+  Run* non_full_run = *it;
+  DCHECK(non_full_run != nullptr);
+  DCHECK(!non_full_run->IsThreadLocal());
+  bt->erase(it);
+  return non_full_run;
+}
+
+RosAlloc::Run* RosAlloc::RefillRun(Thread* self, size_t idx) {
+  // If there's a non-full run, use it as the current run.
+  Run* non_full_run = TakeNonFullRun(idx);
+  if (non_full_run != nullptr) {
     return non_full_run;
   }
   // If there's none, allocate a new run and use it as the current run.
   return AllocRun(self, idx);
 }
 
+RosAlloc::Run* RosAlloc::RefillThreadLocalRun(Thread* self, size_t idx, Run* thread_local_run) {
+  DCHECK(thread_local_run->IsFull());
+  {
+    MutexLock mu(self, *size_bracket_locks_[idx]);
+    bool is_all_free_after_merge;
+    // This is safe to do for the dedicated_full_run_ since the bitmaps are empty.
+    if (thread_local_run->MergeThreadLocalFreeListToFreeList(&is_all_free_after_merge)) {
+      DCHECK_NE(thread_local_run, dedicated_full_run_);
+      // Some slot got freed. Keep it.
+      DCHECK(!thread_local_run->IsFull());
+      DCHECK_EQ(is_all_free_after_merge, thread_local_run->IsAllFree());
+      return thread_local_run;
+    }
+    // No slots got freed. Hand the full run back to the bracket.
+    DCHECK(thread_local_run->IsFull());
+    if (thread_local_run != dedicated_full_run_) {
+      thread_local_run->SetIsThreadLocal(false);
+      if (kIsDebugBuild) {
+        full_runs_[idx].insert(thread_local_run);
+        if (kTraceRosAlloc) {
+          LOG(INFO) << "RosAlloc::RefillThreadLocalRun() : Inserted run 0x" << std::hex
+                    << reinterpret_cast<intptr_t>(thread_local_run)
+                    << " into full_runs_[" << std::dec << idx << "]";
+        }
+      }
+      DCHECK(non_full_runs_[idx].find(thread_local_run) == non_full_runs_[idx].end());
+      DCHECK(full_runs_[idx].find(thread_local_run) != full_runs_[idx].end());
+      // The full run is no longer ours, don't leave it reachable from this thread while the new
+      // run is being allocated.
+      self->SetRosAllocRun(idx, dedicated_full_run_);
+    }
+    Run* non_full_run = TakeNonFullRun(idx);
+    if (non_full_run != nullptr) {
+      DCHECK(full_runs_[idx].find(non_full_run) == full_runs_[idx].end());
+      non_full_run->SetIsThreadLocal(true);
+      return non_full_run;
+    }
+  }
+  // There's no run to reuse. Allocate a new one without holding the bracket lock so that the page
+  // allocation (which takes lock_) does not serialize the other threads of this bracket. No other
+  // thread can reach the new run until this thread has allocated objects from it.
+  Run* new_run = AllocRun(self, idx);
+  if (UNLIKELY(new_run == nullptr)) {
+    return nullptr;
+  }
+  new_run->SetIsThreadLocal(true);
+  return new_run;
+}
+
 inline void* RosAlloc::AllocFromCurrentRunUnlocked(Thread* self, size_t idx) {
   Run* current_run = current_runs_[idx];
   DCHECK(current_run != nullptr);
@@ -675,43 +735,15 @@ void* RosAlloc::AllocFromRun(Thread* self, size_t size, size_t* bytes_allocated,
     DCHECK(thread_local_run != dedicated_full_run_ || slot_addr == nullptr)
         << "allocated from an invalid run";
     if (UNLIKELY(slot_addr == nullptr)) {
-      // The run got full. Try to free slots.
-      DCHECK(thread_local_run->IsFull());
-      MutexLock mu(self, *size_bracket_locks_[idx]);
-      bool is_all_free_after_merge;
-      // This is safe to do for the dedicated_full_run_ since the bitmaps are empty.
-      if (thread_local_run->MergeThreadLocalFreeListToFreeList(&is_all_free_after_merge)) {
-        DCHECK_NE(thread_local_run, dedicated_full_run_);
-        // Some slot got freed. Keep it.
-        DCHECK(!thread_local_run->IsFull());
-        DCHECK_EQ(is_all_free_after_merge, thread_local_run->IsAllFree());
-      } else {
-        // No slots got freed. Try to refill the thread-local run.
-        DCHECK(thread_local_run->IsFull());
-        if (thread_local_run != dedicated_full_run_) {
-          thread_local_run->SetIsThreadLocal(false);
-          if (kIsDebugBuild) {
-            full_runs_[idx].insert(thread_local_run);
-            if (kTraceRosAlloc) {
-              LOG(INFO) << "RosAlloc::AllocFromRun() : Inserted run 0x" << std::hex
-                        << reinterpret_cast<intptr_t>(thread_local_run)
-                        << " into full_runs_[" << std::dec << idx << "]";
-            }
-          }
-          DCHECK(non_full_runs_[idx].find(thread_local_run) == non_full_runs_[idx].end());
-          DCHECK(full_runs_[idx].find(thread_local_run) != full_runs_[idx].end());
-        }
-
-        thread_local_run = RefillRun(self, idx);
-        if (UNLIKELY(thread_local_run == nullptr)) {
-          self->SetRosAllocRun(idx, dedicated_full_run_);
-          return nullptr;
-        }
-        DCHECK(non_full_runs_[idx].find(thread_local_run) == non_full_runs_[idx].end());
-        DCHECK(full_runs_[idx].find(thread_local_run) == full_runs_[idx].end());
-        thread_local_run->SetIsThreadLocal(true);
+      // The run got full. Try to free slots or refill the thread-local run.
+      Run* refilled_run = RefillThreadLocalRun(self, idx, thread_local_run);
+      if (UNLIKELY(refilled_run == nullptr)) {
+        self->SetRosAllocRun(idx, dedicated_full_run_);
+        return nullptr;
+      }
+      if (refilled_run != thread_local_run) {
+        thread_local_run = refilled_run;
         self->SetRosAllocRun(idx, thread_local_run);
-        DCHECK(!thread_local_run->IsFull());
       }
       DCHECK(thread_local_run != nullptr);
       DCHECK(!thread_local_run->IsFull());
@@ -1981,11 +2013,28 @@ void RosAlloc::Run::Verify(Thread* self, RosAlloc* rosalloc, bool running_on_mem
 size_t RosAlloc::ReleasePages() {
   VLOG(heap) << "RosAlloc::ReleasePages()";
   DCHECK(!DoesReleaseAllPages());
+  size_t page_idx = 0;
+  size_t budget = std::numeric_limits<size_t>::max();
+  return ReleaseEmptyPages(&page_idx, &budget, /* lazy */ false);
+}
+
+size_t RosAlloc::ReleasePagesIncremental(size_t* budget, bool* done) {
+  DCHECK(!DoesReleaseAllPages());
+  size_t reclaimed_bytes = ReleaseEmptyPages(&release_cursor_, budget, /* lazy */ true);
+  // Reading the page map size without a lock is benign, see ReleaseEmptyPages().
+  *done = release_cursor_ >= page_map_size_;
+  if (*done) {
+    release_cursor_ = 0;
+  }
+  return reclaimed_bytes;
+}
+
+size_t RosAlloc::ReleaseEmptyPages(size_t* page_idx, size_t* budget, bool lazy) {
   Thread* self = Thread::Current();
   size_t reclaimed_bytes = 0;
-  size_t i = 0;
+  size_t i = *page_idx;
   // Check the page map size which might have changed due to grow/shrink.
-  while (i < page_map_size_) {
+  while (i < page_map_size_ && *budget != 0) {
     // Reading the page map without a lock is racy but the race is benign since it should only
     // result in occasionally not releasing pages which we could release.
     uint8_t pm = page_map_[i];
@@ -2009,11 +2058,30 @@ size_t RosAlloc::ReleasePages() {
           if (free_page_runs_.find(fpr) != free_page_runs_.end()) {
             size_t fpr_size = fpr->ByteSize(this);
             DCHECK_ALIGNED(fpr_size, kPageSize);
-            uint8_t* start = reinterpret_cast<uint8_t*>(fpr);
-            reclaimed_bytes += ReleasePageRange(start, start + fpr_size);
             size_t pages = fpr_size / kPageSize;
             CHECK_GT(pages, 0U) << "Infinite loop probable";
-            i += pages;
+            const size_t run_end_idx = i + pages;
+            // Skip the pages released before, e.g. by an earlier call that ran out of budget in
+            // this run. The first page is never released in debug builds, see ReleasePageRange().
+            const size_t skipped_head_pages = kIsDebugBuild ? 1u : 0u;
+            size_t first_idx = i + skipped_head_pages;
+            while (first_idx < run_end_idx && page_map_[first_idx] == kPageMapReleased) {
+              ++first_idx;
+            }
+            size_t end_idx = run_end_idx;
+            if (first_idx < end_idx) {
+              const size_t budget_pages = std::max<size_t>(*budget / kPageSize, 1u);
+              end_idx = std::min(run_end_idx, first_idx + budget_pages);
+              reclaimed_bytes += ReleasePageRange(
+                  base_ + (first_idx - skipped_head_pages) * kPageSize,
+                  base_ + end_idx * kPageSize,
+                  lazy);
+              *budget -= std::min(*budget, (end_idx - first_idx) * kPageSize);
+            }
+            // Come back to the head of the run if it is only partially released.
+            if (end_idx == run_end_idx) {
+              i = run_end_idx;
+            }
             DCHECK_LE(i, page_map_size_);
             break;
           }
@@ -2031,10 +2099,11 @@ size_t RosAlloc::ReleasePages() {
         break;
     }
   }
+  *page_idx = i;
   return reclaimed_bytes;
 }
 
-size_t RosAlloc::ReleasePageRange(uint8_t* start, uint8_t* end) {
+size_t RosAlloc::ReleasePageRange(uint8_t* start, uint8_t* end, bool lazy) {
   DCHECK_ALIGNED(start, kPageSize);
   DCHECK_ALIGNED(end, kPageSize);
   DCHECK_LT(start, end);
@@ -2052,7 +2121,12 @@ size_t RosAlloc::ReleasePageRange(uint8_t* start, uint8_t* end) {
     // TODO: Do this when we resurrect the page instead.
     memset(start, 0, end - start);
   }
-  CHECK_EQ(madvise(start, end - start, MADV_DONTNEED), 0);
+  if (lazy) {
+    // The free pages are already zero, so it doesn't matter whether the kernel drops them.
+    LazyReleasePages(start, end - start);
+  } else {
+    CHECK_EQ(madvise(start, end - start, MADV_DONTNEED), 0);
+  }
   size_t pm_idx = ToPageMapIndex(start);
   size_t reclaimed_bytes = 0;
   // Calculate reclaimed bytes and upate page map.
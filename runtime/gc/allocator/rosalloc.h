@@ -771,6 +771,9 @@ class RosAlloc {
   // Whether this allocator is running under Valgrind.
   bool is_running_on_memory_tool_;
 
+  // The page map index ReleasePagesIncremental() resumes at.
+  size_t release_cursor_;
+
   // The base address of the memory region that's managed by this allocator.
   uint8_t* Begin() { return base_; }
   // The end address of the memory region that's managed by this allocator.
@@ -804,6 +807,15 @@ class RosAlloc {
   // thread-local or current run gets full.
   Run* RefillRun(Thread* self, size_t idx) REQUIRES(!lock_);
 
+  // Takes the lowest address non-full run of a size bracket, or returns null if there is none.
+  // The caller must hold the bracket lock.
+  Run* TakeNonFullRun(size_t idx);
+
+  // Slow path of AllocFromRun() for a thread-local size bracket whose thread-local run is full.
+  // Only the merge of the thread-local free list and the handoff of the full run happen under the
+  // bracket lock; a fresh run is allocated after the bracket lock is released.
+  Run* RefillThreadLocalRun(Thread* self, size_t idx, Run* thread_local_run) REQUIRES(!lock_);
+
   // The internal of non-bulk Free().
   size_t FreeInternal(Thread* self, void* ptr) REQUIRES(!lock_);
 
@@ -818,8 +830,12 @@ class RosAlloc {
   // Revoke the current runs which share an index with the thread local runs.
   void RevokeThreadUnsafeCurrentRuns() REQUIRES(!lock_);
 
-  // Release a range of pages.
-  size_t ReleasePageRange(uint8_t* start, uint8_t* end) REQUIRES(lock_);
+  // Release a range of pages. If lazy is true, the kernel may keep them until it needs memory.
+  size_t ReleasePageRange(uint8_t* start, uint8_t* end, bool lazy = false) REQUIRES(lock_);
+
+  // Release the empty pages from page map index *page_idx on until *budget bytes have been
+  // advised. Updates *page_idx to where to resume.
+  size_t ReleaseEmptyPages(size_t* page_idx, size_t* budget, bool lazy) REQUIRES(!lock_);
 
   // Dumps the page map for debugging.
   std::string DumpPageMap() REQUIRES(lock_);
@@ -887,6 +903,11 @@ class RosAlloc {
 
   // Release empty pages.
   size_t ReleasePages() REQUIRES(!lock_);
+  // Release empty pages until *budget bytes have been advised, resuming where the previous call
+  // stopped, and decrement *budget accordingly. The pages are released with LazyReleasePages().
+  // Returns the released bytes and sets *done once the whole space has been visited. Only called
+  // by one thread at a time.
+  size_t ReleasePagesIncremental(size_t* budget, bool* done) REQUIRES(!lock_);
   // Returns the current footprint.
   size_t Footprint() REQUIRES(!lock_);
   // Returns the current capacity, maximum footprint.
@@ -41,6 +41,8 @@
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
+#include "utils.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -58,16 +60,26 @@ static constexpr bool kDisallowReadBarrierDuringScan = kIsDebugBuild;
 // Slow path mark stack size, increase this if the stack is getting full and it is causing
 // performance problems.
 static constexpr size_t kReadBarrierMarkStackSize = 512 * KB;
+// Process the revoked thread-local mark stacks with the heap thread pool.
+static constexpr bool kParallelProcessMarkStacks = true;
+// Minimum number of revoked mark stacks worth handing to the thread pool.
+static constexpr size_t kMinimumParallelMarkStacks = 2;
+// Number of objects freed at once by SweepArray.
+static constexpr size_t kSweepArrayChunkFreeSize = 1024;
 // Verify that there are no missing card marks.
 static constexpr bool kVerifyNoMissingCardMarks = kIsDebugBuild;
 
 ConcurrentCopying::ConcurrentCopying(Heap* heap,
+                                     bool young_gen,
                                      const std::string& name_prefix,
                                      bool measure_read_barrier_slow_path)
     : GarbageCollector(heap,
                        name_prefix + (name_prefix.empty() ? "" : " ") +
                        "concurrent copying"),
-      region_space_(nullptr), gc_barrier_(new Barrier(0)),
+      region_space_(nullptr),
+      young_gen_(young_gen),
+      use_generational_cc_(heap->GetUseGenerationalCC()),
+      gc_barrier_(new Barrier(0)),
       gc_mark_stack_(accounting::ObjectStack::Create("concurrent copying gc mark stack",
                                                      kDefaultGcMarkStackSize,
                                                      kDefaultGcMarkStackSize)),
@@ -77,6 +89,7 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap,
       rb_mark_bit_stack_full_(false),
       mark_stack_lock_("concurrent copying mark stack lock", kMarkSweepMarkStackLock),
       thread_running_gc_(nullptr),
+      processing_mark_stacks_in_parallel_(false),
       is_marking_(false),
       is_using_read_barrier_entrypoints_(false),
       is_active_(false),
@@ -102,9 +115,14 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap,
       force_evacuate_all_(false),
       gc_grays_immune_objects_(false),
       immune_gray_stack_lock_("concurrent copying immune gray stack lock",
-                              kMarkSweepMarkStackLock) {
+                              kMarkSweepMarkStackLock),
+      collect_class_histogram_(false),
+      class_histogram_lock_("concurrent copying class histogram lock") {
   static_assert(space::RegionSpace::kRegionSize == accounting::ReadBarrierTable::kRegionSize,
                 "The region space size and the read barrier table region size must match");
+  // The generational mode relies on graying the old objects on dirty cards.
+  CHECK(!use_generational_cc_ || (kUseBakerReadBarrier && kGrayDirtyImmuneObjects));
+  CHECK(!young_gen_ || use_generational_cc_);
   Thread* self = Thread::Current();
   {
     ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
@@ -165,17 +183,28 @@ void ConcurrentCopying::RunPhases() {
     ReaderMutexLock mu(self, *Locks::mutator_lock_);
     InitializePhase();
   }
-  if (kUseBakerReadBarrier && kGrayDirtyImmuneObjects) {
-    // Switch to read barrier mark entrypoints before we gray the objects. This is required in case
-    // a mutator sees a gray bit and dispatches on the entrypoint. (b/37876887).
-    ActivateReadBarrierEntrypoints();
-    // Gray dirty immune objects concurrently to reduce GC pause times. We re-process gray cards in
-    // the pause.
-    ReaderMutexLock mu(self, *Locks::mutator_lock_);
-    GrayAllDirtyImmuneObjects();
+  {
+    // Graying the dirty objects and flipping the roots, the copying only starts with the
+    // marking phase.
+    ScopedPhaseMetric phase(this, kGcMetricMarkTime);
+    if (kUseBakerReadBarrier && kGrayDirtyImmuneObjects) {
+      // Switch to read barrier mark entrypoints before we gray the objects. This is required in
+      // case a mutator sees a gray bit and dispatches on the entrypoint. (b/37876887).
+      ActivateReadBarrierEntrypoints();
+      // Gray dirty immune objects concurrently to reduce GC pause times. We re-process gray cards
+      // in the pause.
+      ReaderMutexLock mu(self, *Locks::mutator_lock_);
+      GrayAllDirtyImmuneObjects();
+      if (young_gen_) {
+        // Likewise gray the old objects which may point to newly allocated objects.
+        GrayAllDirtyOldObjects();
+      }
+    }
+    FlipThreadRoots();
   }
-  FlipThreadRoots();
   {
+    // Marks the live objects by copying them to the to-space.
+    ScopedPhaseMetric phase(this, kGcMetricCopyTime);
     ReaderMutexLock mu(self, *Locks::mutator_lock_);
     MarkingPhase();
   }
@@ -194,6 +223,7 @@ void ConcurrentCopying::RunPhases() {
     CheckEmptyMarkStack();
   }
   {
+    ScopedPhaseMetric phase(this, kGcMetricSweepTime);
     ReaderMutexLock mu(self, *Locks::mutator_lock_);
     ReclaimPhase();
   }
@@ -266,10 +296,25 @@ void ConcurrentCopying::BindBitmaps() {
       CHECK(space->IsZygoteSpace() || space->IsImageSpace());
       immune_spaces_.AddSpace(space);
     } else if (space == region_space_) {
-      // It is OK to clear the bitmap with mutators running since the only place it is read is
-      // VisitObjects which has exclusion with CC.
       region_space_bitmap_ = region_space_->GetMarkBitmap();
-      region_space_bitmap_->Clear();
+      if (!young_gen_) {
+        // It is OK to clear the bitmap with mutators running since the only place it is read is
+        // VisitObjects which has exclusion with CC. The young-generation collector keeps the
+        // bitmap since it records the objects which survived the previous collections.
+        region_space_bitmap_->Clear();
+      }
+    } else if (young_gen_ &&
+               space->IsContinuousMemMapAllocSpace() &&
+               space->GetGcRetentionPolicy() == space::kGcRetentionPolicyAlwaysCollect) {
+      // As in the sticky mark sweep, binding the live and mark bitmaps makes the old non-moving
+      // objects implicitly marked and marks the survivors live.
+      space->AsContinuousMemMapAllocSpace()->BindLiveToMarkBitmap();
+    }
+  }
+  if (young_gen_) {
+    for (const auto& space : heap_->GetDiscontinuousSpaces()) {
+      CHECK(space->IsLargeObjectSpace());
+      space->AsLargeObjectSpace()->CopyLiveToMarked();
     }
   }
 }
@@ -287,6 +332,7 @@ void ConcurrentCopying::InitializePhase() {
     CHECK(false_gray_stack_.empty());
   }
 
+  DCHECK(old_gray_stack_.empty());
   rb_mark_bit_stack_full_ = false;
   mark_from_read_barrier_measurements_ = measure_read_barrier_slow_path_;
   if (measure_read_barrier_slow_path_) {
@@ -298,12 +344,15 @@ void ConcurrentCopying::InitializePhase() {
   immune_spaces_.Reset();
   bytes_moved_.StoreRelaxed(0);
   objects_moved_.StoreRelaxed(0);
+  collect_class_histogram_ = heap_->IsGcClassHistogramEnabled() && !young_gen_;
+  DCHECK(class_counts_.empty());
   GcCause gc_cause = GetCurrentIteration()->GetGcCause();
   if (gc_cause == kGcCauseExplicit ||
       gc_cause == kGcCauseForNativeAllocBlocking ||
       gc_cause == kGcCauseCollectorTransition ||
       GetCurrentIteration()->GetClearSoftReferences()) {
-    force_evacuate_all_ = true;
+    // The young-generation collector never evacuates old regions.
+    force_evacuate_all_ = !young_gen_;
   } else {
     force_evacuate_all_ = false;
   }
@@ -420,7 +469,18 @@ class ConcurrentCopying::FlipCallback : public Closure {
     Locks::mutator_lock_->AssertExclusiveHeld(self);
     {
       TimingLogger::ScopedTiming split2("(Paused)SetFromSpace", cc->GetTimings());
-      cc->region_space_->SetFromSpace(cc->rb_table_, cc->force_evacuate_all_);
+      space::RegionSpace::EvacMode evac_mode =
+          space::RegionSpace::kEvacModeLivePercentNewlyAllocated;
+      if (cc->young_gen_) {
+        evac_mode = space::RegionSpace::kEvacModeNewlyAllocated;
+      } else if (cc->force_evacuate_all_) {
+        evac_mode = space::RegionSpace::kEvacModeForceAll;
+      }
+      // The young-generation collector keeps the live bytes of the old regions since it does not
+      // recompute them.
+      cc->region_space_->SetFromSpace(cc->rb_table_,
+                                      evac_mode,
+                                      /*clear_live_bytes*/ !cc->young_gen_);
     }
     cc->SwapStacks();
     if (ConcurrentCopying::kEnableFromSpaceAccountingCheck) {
@@ -430,7 +490,7 @@ class ConcurrentCopying::FlipCallback : public Closure {
     }
     cc->is_marking_ = true;
     cc->mark_stack_mode_.StoreRelaxed(ConcurrentCopying::kMarkStackModeThreadLocal);
-    if (kIsDebugBuild) {
+    if (kIsDebugBuild && !cc->young_gen_) {
       cc->region_space_->AssertAllRegionLiveBytesZeroOrCleared();
     }
     if (UNLIKELY(Runtime::Current()->IsActiveTransaction())) {
@@ -445,6 +505,13 @@ class ConcurrentCopying::FlipCallback : public Closure {
         cc->VerifyGrayImmuneObjects();
       }
     }
+    if (cc->use_generational_cc_) {
+      if (cc->young_gen_) {
+        cc->GrayAllNewlyDirtyOldObjects();
+      }
+      // Age the cards so that the ones dirtied from now on are preserved for the next GC.
+      cc->AgeOldSpaceCards();
+    }
     // May be null during runtime creation, in this case leave java_lang_Object null.
     // This is safe since single threaded behavior should mean FillDummyObject does not
     // happen when java_lang_Object_ is null.
@@ -617,7 +684,8 @@ void ConcurrentCopying::FlipThreadRoots() {
   FlipCallback flip_callback(this);
 
   size_t barrier_count = Runtime::Current()->GetThreadList()->FlipThreadRoots(
-      &thread_flip_visitor, &flip_callback, this, GetHeap()->GetGcPauseListener());
+      &thread_flip_visitor, &flip_callback, this, GetHeap()->GetGcPauseListener(),
+      GetThreadCount());
 
   {
     ScopedThreadStateChange tsc(self, kWaitingForCheckPointsToRun);
@@ -730,6 +798,142 @@ void ConcurrentCopying::GrayAllNewlyDirtyImmuneObjects() {
   updated_all_immune_objects_.StoreRelaxed(true);
 }
 
+// Grays the old objects on dirty cards and records them so that the young-generation collector
+// scans them in the marking phase.
+template <bool kConcurrent>
+class ConcurrentCopying::GrayOldObjectVisitor {
+ public:
+  GrayOldObjectVisitor(ConcurrentCopying* cc, Thread* self) : collector_(cc), self_(self) {}
+
+  ALWAYS_INLINE void operator()(mirror::Object* obj) const REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (obj->GetReadBarrierState() != ReadBarrier::WhiteState()) {
+      return;
+    }
+    if (kConcurrent) {
+      Locks::mutator_lock_->AssertSharedHeld(self_);
+      if (!obj->AtomicSetReadBarrierState(ReadBarrier::WhiteState(), ReadBarrier::GrayState())) {
+        return;
+      }
+    } else {
+      Locks::mutator_lock_->AssertExclusiveHeld(self_);
+      obj->SetReadBarrierState(ReadBarrier::GrayState());
+    }
+    // Only the GC-running thread grays old objects, no need for a lock.
+    collector_->old_gray_stack_.push_back(obj);
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+  Thread* const self_;
+};
+
+std::vector<space::ContinuousSpace*> ConcurrentCopying::GetOldSpaces() const {
+  std::vector<space::ContinuousSpace*> old_spaces;
+  old_spaces.push_back(region_space_);
+  if (heap_->GetNonMovingSpace() != nullptr) {
+    old_spaces.push_back(heap_->GetNonMovingSpace());
+  }
+  return old_spaces;
+}
+
+void ConcurrentCopying::GrayAllDirtyOldObjects() {
+  TimingLogger::ScopedTiming split("GrayAllDirtyOldObjects", GetTimings());
+  DCHECK(young_gen_);
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  Thread* const self = Thread::Current();
+  using VisitorType = GrayOldObjectVisitor</* kIsConcurrent */ true>;
+  VisitorType visitor(this, self);
+  WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
+  for (space::ContinuousSpace* space : GetOldSpaces()) {
+    // Age the dirty cards first so that the pause only has to re-process the cards dirtied after
+    // this point. The mark bitmaps hold the objects which survived the previous GCs.
+    card_table->ModifyCardsAtomic(
+        space->Begin(),
+        space->End(),
+        [](uint8_t card) {
+          return (card == gc::accounting::CardTable::kCardDirty)
+              ? gc::accounting::CardTable::kCardAged
+              : card;
+        },
+        /* card modified visitor */ VoidFunctor());
+    card_table->Scan</* kClearCard */ false>(space->GetMarkBitmap(),
+                                             space->Begin(),
+                                             space->End(),
+                                             visitor,
+                                             gc::accounting::CardTable::kCardAged);
+  }
+}
+
+void ConcurrentCopying::GrayAllNewlyDirtyOldObjects() {
+  TimingLogger::ScopedTiming split("(Paused)GrayAllNewlyDirtyOldObjects", GetTimings());
+  DCHECK(young_gen_);
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  using VisitorType = GrayOldObjectVisitor</* kIsConcurrent */ false>;
+  Thread* const self = Thread::Current();
+  VisitorType visitor(this, self);
+  WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
+  for (space::ContinuousSpace* space : GetOldSpaces()) {
+    // Aged cards were processed before the pause.
+    card_table->Scan</* kClearCard */ false>(space->GetMarkBitmap(),
+                                             space->Begin(),
+                                             space->End(),
+                                             visitor,
+                                             gc::accounting::CardTable::kCardDirty);
+  }
+}
+
+void ConcurrentCopying::AgeOldSpaceCards() {
+  TimingLogger::ScopedTiming split("(Paused)AgeOldSpaceCards", GetTimings());
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  for (space::ContinuousSpace* space : GetOldSpaces()) {
+    card_table->ModifyCardsAtomic(
+        space->Begin(),
+        space->End(),
+        [](uint8_t card) {
+          return (card == gc::accounting::CardTable::kCardDirty)
+              ? gc::accounting::CardTable::kCardAged
+              : card;
+        },
+        /* card modified visitor */ VoidFunctor());
+  }
+}
+
+void ConcurrentCopying::ScanOldGrayObjects() {
+  TimingLogger::ScopedTiming split("ScanOldGrayObjects", GetTimings());
+  DCHECK(young_gen_);
+  if (kVerboseMode) {
+    LOG(INFO) << "old gray stack size=" << old_gray_stack_.size();
+  }
+  for (mirror::Object* obj : old_gray_stack_) {
+    DCHECK(obj->GetReadBarrierState() == ReadBarrier::GrayState());
+    Scan(obj);
+    // Done scanning the object, go back to white.
+    bool success = obj->AtomicSetReadBarrierState(ReadBarrier::GrayState(),
+                                                  ReadBarrier::WhiteState());
+    CHECK(success)
+        << Runtime::Current()->GetHeap()->GetVerification()->DumpObjectInfo(obj, "failed CAS");
+  }
+  old_gray_stack_.clear();
+}
+
+void ConcurrentCopying::ClearAgedOldSpaceCards() {
+  TimingLogger::ScopedTiming split("ClearAgedOldSpaceCards", GetTimings());
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  for (space::ContinuousSpace* space : GetOldSpaces()) {
+    // The objects on aged cards have been processed by this GC. Keep the cards dirtied by the
+    // mutators after the pause for the next GC.
+    card_table->ModifyCardsAtomic(
+        space->Begin(),
+        space->End(),
+        [](uint8_t card) {
+          return (card == gc::accounting::CardTable::kCardAged)
+              ? gc::accounting::CardTable::kCardClean
+              : card;
+        },
+        /* card modified visitor */ VoidFunctor());
+  }
+}
+
 void ConcurrentCopying::SwapStacks() {
   heap_->SwapStacks();
 }
@@ -835,6 +1039,11 @@ void ConcurrentCopying::MarkingPhase() {
     }
     immune_gray_stack_.clear();
   }
+  if (young_gen_) {
+    // Scan the old objects which may point to newly allocated objects. This replaces tracing
+    // through the old generation.
+    ScanOldGrayObjects();
+  }
 
   {
     TimingLogger::ScopedTiming split2("VisitConcurrentRoots", GetTimings());
@@ -1482,28 +1691,143 @@ size_t ConcurrentCopying::ProcessThreadLocalMarkStacks(bool disable_weak_ref_acc
     mark_stacks = revoked_mark_stacks_;
     revoked_mark_stacks_.clear();
   }
+  const size_t thread_count = GetThreadCount();
+  if (kParallelProcessMarkStacks &&
+      !disable_weak_ref_access &&
+      thread_count > 1 &&
+      mark_stacks.size() >= kMinimumParallelMarkStacks) {
+    return ProcessMarkStacksParallel(mark_stacks, thread_count);
+  }
   for (accounting::AtomicStack<mirror::Object>* mark_stack : mark_stacks) {
     for (StackReference<mirror::Object>* p = mark_stack->Begin(); p != mark_stack->End(); ++p) {
       mirror::Object* to_ref = p->AsMirrorPtr();
       ProcessMarkStackRef(to_ref);
       ++count;
     }
-    {
-      MutexLock mu(Thread::Current(), mark_stack_lock_);
-      if (pooled_mark_stacks_.size() >= kMarkStackPoolSize) {
-        // The pool has enough. Delete it.
-        delete mark_stack;
-      } else {
-        // Otherwise, put it into the pool for later reuse.
-        mark_stack->Reset();
-        pooled_mark_stacks_.push_back(mark_stack);
-      }
-    }
+    RecycleMarkStack(mark_stack);
   }
   return count;
 }
 
-inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
+void ConcurrentCopying::RecycleMarkStack(accounting::AtomicStack<mirror::Object>* mark_stack) {
+  MutexLock mu(Thread::Current(), mark_stack_lock_);
+  if (pooled_mark_stacks_.size() >= kMarkStackPoolSize) {
+    // The pool has enough. Delete it.
+    delete mark_stack;
+  } else {
+    // Otherwise, put it into the pool for later reuse.
+    mark_stack->Reset();
+    pooled_mark_stacks_.push_back(mark_stack);
+  }
+}
+
+size_t ConcurrentCopying::GetThreadCount() const {
+  // Use less threads if we are in a background state (non jank perceptible) since we want to leave
+  // more CPU time for the foreground apps.
+  if (heap_->GetThreadPool() == nullptr || !Runtime::Current()->InJankPerceptibleProcessState()) {
+    return 1;
+  }
+  return heap_->GetConcGCThreadCount() + 1;
+}
+
+// Processes revoked thread-local mark stacks on a heap thread pool worker. The workers take whole
+// stacks from a shared list until it is exhausted, so that a worker that finishes early steals the
+// remaining stacks from the others. Objects grayed by a worker go to the worker's own thread-local
+// mark stack, which is revoked at the end of the task for the next round of ProcessMarkStackOnce.
+class ConcurrentCopying::ProcessMarkStacksTask : public Task {
+ public:
+  ProcessMarkStacksTask(
+      ConcurrentCopying* cc,
+      const std::vector<accounting::AtomicStack<mirror::Object>*>* mark_stacks,
+      Atomic<size_t>* next_stack_index,
+      Atomic<size_t>* processed_count,
+      ClassCountMap* class_counts)
+      : collector_(cc),
+        mark_stacks_(mark_stacks),
+        next_stack_index_(next_stack_index),
+        processed_count_(processed_count),
+        class_counts_(class_counts) {}
+
+  // No thread safety analysis since multiple threads will use this task. The GC-running thread
+  // holds the mutator lock on behalf of the workers until it has waited for all the tasks.
+  virtual void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    size_t count = 0;
+    while (true) {
+      const size_t index = next_stack_index_->FetchAndAddSequentiallyConsistent(1);
+      if (index >= mark_stacks_->size()) {
+        break;
+      }
+      accounting::AtomicStack<mirror::Object>* mark_stack = (*mark_stacks_)[index];
+      for (StackReference<mirror::Object>* p = mark_stack->Begin(); p != mark_stack->End(); ++p) {
+        collector_->ProcessMarkStackRef</*kParallel*/ true>(p->AsMirrorPtr(), class_counts_);
+        ++count;
+      }
+      collector_->RecycleMarkStack(mark_stack);
+    }
+    // Hand the objects this thread grayed over to the GC-running thread.
+    if (self != collector_->thread_running_gc_) {
+      collector_->RevokeThreadLocalMarkStack(self);
+    }
+    processed_count_->FetchAndAddSequentiallyConsistent(count);
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+  const std::vector<accounting::AtomicStack<mirror::Object>*>* const mark_stacks_;
+  Atomic<size_t>* const next_stack_index_;
+  Atomic<size_t>* const processed_count_;
+  // Class histogram counts of this task, merged by the GC-running thread.
+  ClassCountMap* const class_counts_;
+};
+
+size_t ConcurrentCopying::ProcessMarkStacksParallel(
+    const std::vector<accounting::AtomicStack<mirror::Object>*>& mark_stacks,
+    size_t thread_count) {
+  TimingLogger::ScopedTiming split("ProcessMarkStacksParallel", GetTimings());
+  Thread* self = Thread::Current();
+  DCHECK_EQ(self, thread_running_gc_);
+  DCHECK_EQ(static_cast<uint32_t>(mark_stack_mode_.LoadRelaxed()),
+            static_cast<uint32_t>(kMarkStackModeThreadLocal));
+  ThreadPool* thread_pool = heap_->GetThreadPool();
+  const size_t num_tasks = std::min(thread_count, mark_stacks.size());
+  Atomic<size_t> next_stack_index(0);
+  Atomic<size_t> processed_count(0);
+  // Per-task class histogram counts, so that counting needs no synchronization.
+  std::vector<ClassCountMap> class_counts(collect_class_histogram_ ? num_tasks : 0u);
+  for (size_t i = 0; i < num_tasks; ++i) {
+    thread_pool->AddTask(self,
+                         new ProcessMarkStacksTask(this,
+                                                   &mark_stacks,
+                                                   &next_stack_index,
+                                                   &processed_count,
+                                                   collect_class_histogram_
+                                                       ? &class_counts[i]
+                                                       : nullptr));
+  }
+  processing_mark_stacks_in_parallel_ = true;
+  // The GC-running thread also runs tasks while waiting.
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+  thread_pool->StopWorkers(self);
+  processing_mark_stacks_in_parallel_ = false;
+  for (const ClassCountMap& task_counts : class_counts) {
+    for (const auto& entry : task_counts) {
+      LiveClassCounts& counts = class_counts_[entry.first];
+      counts.count += entry.second.count;
+      counts.bytes += entry.second.bytes;
+    }
+  }
+  return processed_count.LoadSequentiallyConsistent();
+}
+
+template <bool kParallel>
+inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref,
+                                                   ClassCountMap* class_counts) {
   DCHECK(!region_space_->IsInFromSpace(to_ref));
   if (kUseBakerReadBarrier) {
     DCHECK(to_ref->GetReadBarrierState() == ReadBarrier::GrayState())
@@ -1511,17 +1835,35 @@ inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
         << " is_marked=" << IsMarked(to_ref);
   }
   bool add_to_live_bytes = false;
+  bool scanned = true;
   if (region_space_->IsInUnevacFromSpace(to_ref)) {
-    // Mark the bitmap only in the GC thread here so that we don't need a CAS.
-    if (!kUseBakerReadBarrier || !region_space_bitmap_->Set(to_ref)) {
+    // Mark the bitmap only in the GC thread here so that we don't need a CAS. The parallel workers
+    // need one.
+    if (!kUseBakerReadBarrier ||
+        !(kParallel ? region_space_bitmap_->AtomicTestAndSet(to_ref)
+                    : region_space_bitmap_->Set(to_ref))) {
       // It may be already marked if we accidentally pushed the same object twice due to the racy
       // bitmap read in MarkUnevacFromSpaceRegion.
       Scan(to_ref);
       // Only add to the live bytes if the object was not already marked.
       add_to_live_bytes = true;
+    } else {
+      scanned = false;
     }
   } else {
     Scan(to_ref);
+    if (use_generational_cc_ && region_space_->IsInToSpace(to_ref)) {
+      // Record the evacuated object as live so that the next young-generation collection treats
+      // it as old. Only the GC threads set these bits, so no CAS is needed unless in parallel.
+      if (kParallel) {
+        region_space_bitmap_->AtomicTestAndSet(to_ref);
+      } else {
+        region_space_bitmap_->Set(to_ref);
+      }
+    }
+  }
+  if (UNLIKELY(collect_class_histogram_) && scanned) {
+    CountLiveObject(to_ref, kParallel ? class_counts : &class_counts_);
   }
   if (kUseBakerReadBarrier) {
     DCHECK(to_ref->GetReadBarrierState() == ReadBarrier::GrayState())
@@ -1553,12 +1895,12 @@ inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
 #endif
 
   if (add_to_live_bytes) {
-    // Add to the live bytes per unevacuated from space. Note this code is always run by the
-    // GC-running thread (no synchronization required).
+    // Add to the live bytes per unevacuated from space. Note this code is run by the GC-running
+    // thread (no synchronization required) unless the mark stacks are processed in parallel.
     DCHECK(region_space_bitmap_->Test(to_ref));
     size_t obj_size = to_ref->SizeOf<kDefaultVerifyFlags>();
     size_t alloc_size = RoundUp(obj_size, space::RegionSpace::kAlignment);
-    region_space_->AddLiveBytes(to_ref, alloc_size);
+    region_space_->AddLiveBytes</*kAtomic*/ kParallel>(to_ref, alloc_size);
   }
   if (ReadBarrier::kEnableToSpaceInvariantChecks) {
     CHECK(to_ref != nullptr);
@@ -1659,10 +2001,20 @@ void ConcurrentCopying::CheckEmptyMarkStack() {
 void ConcurrentCopying::SweepSystemWeaks(Thread* self) {
   TimingLogger::ScopedTiming split("SweepSystemWeaks", GetTimings());
   ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
-  Runtime::Current()->SweepSystemWeaks(this);
+  Runtime::Current()->SweepSystemWeaks(this, GetThreadCount());
 }
 
 void ConcurrentCopying::Sweep(bool swap_bitmaps) {
+  if (young_gen_) {
+    // Only the objects allocated since the last GC may be freed. The old objects are kept since
+    // the live and mark bitmaps are bound.
+    if (kEnableFromSpaceAccountingCheck) {
+      CHECK_GE(live_stack_freeze_size_, heap_->GetLiveStack()->Size());
+    }
+    CheckEmptyMarkStack();
+    SweepArray(heap_->GetLiveStack(), swap_bitmaps);
+    return;
+  }
   {
     TimingLogger::ScopedTiming t("MarkStackAsLive", GetTimings());
     accounting::ObjectStack* live_stack = heap_->GetLiveStack();
@@ -1688,6 +2040,96 @@ void ConcurrentCopying::Sweep(bool swap_bitmaps) {
   SweepLargeObjects(swap_bitmaps);
 }
 
+void ConcurrentCopying::SweepArray(accounting::ObjectStack* allocations, bool swap_bitmaps) {
+  TimingLogger::ScopedTiming t("SweepArray", GetTimings());
+  Thread* self = Thread::Current();
+  std::vector<mirror::Object*> chunk_free_buffer;
+  chunk_free_buffer.reserve(kSweepArrayChunkFreeSize);
+  ObjectBytePair freed;
+  ObjectBytePair freed_los;
+  // How many objects are left in the array, modified after each space is swept.
+  StackReference<mirror::Object>* objects = allocations->Begin();
+  size_t count = allocations->Size();
+  // Objects allocated in the region space are not on the allocation stack, so this only sweeps
+  // the non-moving space and the large object space.
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    if (!space->IsAllocSpace() ||
+        space == region_space_ ||
+        immune_spaces_.ContainsSpace(space) ||
+        space->GetLiveBitmap() == nullptr) {
+      continue;
+    }
+    space::AllocSpace* alloc_space = space->AsAllocSpace();
+    accounting::ContinuousSpaceBitmap* live_bitmap = space->GetLiveBitmap();
+    accounting::ContinuousSpaceBitmap* mark_bitmap = space->GetMarkBitmap();
+    if (swap_bitmaps) {
+      std::swap(live_bitmap, mark_bitmap);
+    }
+    StackReference<mirror::Object>* out = objects;
+    for (size_t i = 0; i < count; ++i) {
+      mirror::Object* const obj = objects[i].AsMirrorPtr();
+      if (kUseThreadLocalAllocationStack && obj == nullptr) {
+        continue;
+      }
+      if (space->HasAddress(obj)) {
+        // This object is in the space, remove it from the array and add it to the sweep buffer
+        // if needed.
+        if (!mark_bitmap->Test(obj)) {
+          if (chunk_free_buffer.size() >= kSweepArrayChunkFreeSize) {
+            TimingLogger::ScopedTiming t2("FreeList", GetTimings());
+            freed.objects += chunk_free_buffer.size();
+            freed.bytes += alloc_space->FreeList(self,
+                                                 chunk_free_buffer.size(),
+                                                 chunk_free_buffer.data());
+            chunk_free_buffer.clear();
+          }
+          chunk_free_buffer.push_back(obj);
+        }
+      } else {
+        (out++)->Assign(obj);
+      }
+    }
+    if (!chunk_free_buffer.empty()) {
+      TimingLogger::ScopedTiming t2("FreeList", GetTimings());
+      freed.objects += chunk_free_buffer.size();
+      freed.bytes += alloc_space->FreeList(self,
+                                           chunk_free_buffer.size(),
+                                           chunk_free_buffer.data());
+      chunk_free_buffer.clear();
+    }
+    // All of the references which space contained are no longer in the allocation stack, update
+    // the count.
+    count = out - objects;
+  }
+  // Handle the large object space.
+  space::LargeObjectSpace* large_object_space = heap_->GetLargeObjectsSpace();
+  if (large_object_space != nullptr) {
+    accounting::LargeObjectBitmap* large_live_objects = large_object_space->GetLiveBitmap();
+    accounting::LargeObjectBitmap* large_mark_objects = large_object_space->GetMarkBitmap();
+    if (swap_bitmaps) {
+      std::swap(large_live_objects, large_mark_objects);
+    }
+    for (size_t i = 0; i < count; ++i) {
+      mirror::Object* const obj = objects[i].AsMirrorPtr();
+      // Handle large objects.
+      if (kUseThreadLocalAllocationStack && obj == nullptr) {
+        continue;
+      }
+      if (!large_mark_objects->Test(obj)) {
+        ++freed_los.objects;
+        freed_los.bytes += large_object_space->Free(self, obj);
+      }
+    }
+  }
+  {
+    TimingLogger::ScopedTiming t2("RecordFree", GetTimings());
+    RecordFree(freed);
+    RecordFreeLOS(freed_los);
+    t2.NewTiming("ResetStack");
+    allocations->Reset();
+  }
+}
+
 void ConcurrentCopying::MarkZygoteLargeObjects() {
   TimingLogger::ScopedTiming split(__FUNCTION__, GetTimings());
   Thread* const self = Thread::Current();
@@ -1724,6 +2166,9 @@ void ConcurrentCopying::ReclaimPhase() {
     LOG(INFO) << "GC ReclaimPhase";
   }
   Thread* self = Thread::Current();
+  if (collect_class_histogram_) {
+    PublishClassHistogram();
+  }
 
   {
     // Double-check that the mark stack is empty.
@@ -1766,7 +2211,12 @@ void ConcurrentCopying::ReclaimPhase() {
     uint64_t cleared_objects;
     {
       TimingLogger::ScopedTiming split4("ClearFromSpace", GetTimings());
-      region_space_->ClearFromSpace(&cleared_bytes, &cleared_objects);
+      // The generational mode keeps the mark bitmap of the surviving regions for the next young
+      // collection.
+      region_space_->ClearFromSpace(&cleared_bytes,
+                                    &cleared_objects,
+                                    /*clear_bitmap*/ !use_generational_cc_,
+                                    GetThreadCount() > 1 ? heap_->GetThreadPool() : nullptr);
       CHECK_GE(cleared_bytes, from_bytes);
       CHECK_GE(cleared_objects, from_objects);
     }
@@ -1795,7 +2245,7 @@ void ConcurrentCopying::ReclaimPhase() {
     SwapBitmaps();
     heap_->UnBindBitmaps();
 
-    // The bitmap was cleared at the start of the GC, there is nothing we need to do here.
+    // The bitmap was cleared at the start of the full GC, there is nothing we need to do here.
     DCHECK(region_space_bitmap_ != nullptr);
     region_space_bitmap_ = nullptr;
   }
@@ -2023,7 +2473,7 @@ inline void ConcurrentCopying::Scan(mirror::Object* to_ref) {
     Thread::Current()->ModifyDebugDisallowReadBarrier(1);
   }
   DCHECK(!region_space_->IsInFromSpace(to_ref));
-  DCHECK_EQ(Thread::Current(), thread_running_gc_);
+  DCHECK(Thread::Current() == thread_running_gc_ || processing_mark_stacks_in_parallel_);
   RefFieldsVisitor visitor(this);
   // Disable the read barrier for a performance reason.
   to_ref->VisitReferences</*kVisitNativeRoots*/true, kDefaultVerifyFlags, kWithoutReadBarrier>(
@@ -2035,7 +2485,7 @@ inline void ConcurrentCopying::Scan(mirror::Object* to_ref) {
 
 // Process a field.
 inline void ConcurrentCopying::Process(mirror::Object* obj, MemberOffset offset) {
-  DCHECK_EQ(Thread::Current(), thread_running_gc_);
+  DCHECK(Thread::Current() == thread_running_gc_ || processing_mark_stacks_in_parallel_);
   mirror::Object* ref = obj->GetFieldObject<
       mirror::Object, kVerifyNone, kWithoutReadBarrier, false>(offset);
   mirror::Object* to_ref = Mark</*kGrayImmuneObject*/false, /*kFromGCThread*/true>(
@@ -2266,8 +2716,11 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref,
   size_t non_moving_space_bytes_allocated = 0U;
   size_t bytes_allocated = 0U;
   size_t dummy;
+  // Keep the copy on the NUMA node of the region it was allocated in. That is the node of the
+  // thread that allocated it which is likely to access it again.
   mirror::Object* to_ref = region_space_->AllocNonvirtual<true>(
-      region_space_alloc_size, &region_space_bytes_allocated, nullptr, &dummy);
+      region_space_alloc_size, &region_space_bytes_allocated, nullptr, &dummy,
+      region_space_->NumaNodeOf(from_ref));
   bytes_allocated = region_space_bytes_allocated;
   if (to_ref != nullptr) {
     DCHECK_EQ(region_space_alloc_size, region_space_bytes_allocated);
@@ -2565,9 +3018,12 @@ void ConcurrentCopying::FinishPhase() {
     MutexLock mu(self, mark_stack_lock_);
     CHECK_EQ(pooled_mark_stacks_.size(), kMarkStackPoolSize);
   }
-  // kVerifyNoMissingCardMarks relies on the region space cards not being cleared to avoid false
-  // positives.
-  if (!kVerifyNoMissingCardMarks) {
+  if (use_generational_cc_) {
+    // The cards dirtied after the pause record the old-to-young references for the next GC.
+    ClearAgedOldSpaceCards();
+  } else if (!kVerifyNoMissingCardMarks) {
+    // kVerifyNoMissingCardMarks relies on the region space cards not being cleared to avoid false
+    // positives.
     TimingLogger::ScopedTiming split("ClearRegionSpaceCards", GetTimings());
     // We do not currently use the region space cards at all, madvise them away to save ram.
     heap_->GetCardTable()->ClearCardRange(region_space_->Begin(), region_space_->Limit());
@@ -2675,6 +3131,55 @@ mirror::Object* ConcurrentCopying::MarkFromReadBarrierWithMeasurements(mirror::O
   return ret;
 }
 
+inline void ConcurrentCopying::CountLiveObject(mirror::Object* to_ref,
+                                               ClassCountMap* class_counts) {
+  DCHECK(class_counts != nullptr);
+  // Scan() has already updated the class field to the to-space class.
+  mirror::Class* klass = to_ref->GetClass<kVerifyNone, kWithoutReadBarrier>();
+  LiveClassCounts& counts = (*class_counts)[klass];
+  ++counts.count;
+  counts.bytes += to_ref->SizeOf<kVerifyNone>();
+}
+
+void ConcurrentCopying::PublishClassHistogram() {
+  TimingLogger::ScopedTiming split("PublishClassHistogram", GetTimings());
+  std::vector<ClassHistogramEntry> histogram;
+  histogram.reserve(class_counts_.size());
+  for (const auto& entry : class_counts_) {
+    histogram.push_back(ClassHistogramEntry {
+        mirror::Class::PrettyDescriptor(entry.first), entry.second.count, entry.second.bytes });
+  }
+  class_counts_.clear();
+  std::sort(histogram.begin(),
+            histogram.end(),
+            [](const ClassHistogramEntry& a, const ClassHistogramEntry& b) {
+              return a.bytes > b.bytes;
+            });
+  MutexLock mu(Thread::Current(), class_histogram_lock_);
+  class_histogram_.swap(histogram);
+}
+
+void ConcurrentCopying::DumpClassHistogram(std::ostream& os, size_t max_entries) {
+  MutexLock mu(Thread::Current(), class_histogram_lock_);
+  if (class_histogram_.empty()) {
+    return;
+  }
+  uint64_t total_count = 0;
+  uint64_t total_bytes = 0;
+  for (const ClassHistogramEntry& entry : class_histogram_) {
+    total_count += entry.count;
+    total_bytes += entry.bytes;
+  }
+  os << "Live objects at last full GC: " << total_count << " objects, "
+     << PrettySize(total_bytes) << " in " << class_histogram_.size() << " classes\n";
+  const size_t count = std::min(max_entries, class_histogram_.size());
+  for (size_t i = 0; i < count; ++i) {
+    const ClassHistogramEntry& entry = class_histogram_[i];
+    os << "  " << entry.descriptor << ": " << entry.count << " objects, "
+       << PrettySize(entry.bytes) << "\n";
+  }
+}
+
 void ConcurrentCopying::DumpPerformanceInfo(std::ostream& os) {
   GarbageCollector::DumpPerformanceInfo(os);
   MutexLock mu(Thread::Current(), rb_slow_path_histogram_lock_);
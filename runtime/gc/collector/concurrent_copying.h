@@ -25,6 +25,7 @@
 #include "offsets.h"
 #include "safe_map.h"
 
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -33,6 +34,7 @@ class Closure;
 class RootInfo;
 
 namespace mirror {
+class Class;
 class Object;
 }  // namespace mirror
 
@@ -65,13 +67,24 @@ class ConcurrentCopying : public GarbageCollector {
   // pages.
   static constexpr bool kGrayDirtyImmuneObjects = true;
 
-  explicit ConcurrentCopying(Heap* heap,
-                             const std::string& name_prefix = "",
-                             bool measure_read_barrier_slow_path = false);
+  // One class of the live instance histogram, see DumpClassHistogram().
+  struct ClassHistogramEntry {
+    std::string descriptor;
+    uint64_t count;
+    uint64_t bytes;
+  };
+
+  // If young_gen is true, this collector only evacuates the regions allocated since the previous
+  // GC and treats the objects surviving earlier collections as live (sticky-bit generational CC).
+  ConcurrentCopying(Heap* heap,
+                    bool young_gen,
+                    const std::string& name_prefix = "",
+                    bool measure_read_barrier_slow_path = false);
   ~ConcurrentCopying();
 
   virtual void RunPhases() OVERRIDE
-      REQUIRES(!immune_gray_stack_lock_,
+      REQUIRES(!class_histogram_lock_,
+               !immune_gray_stack_lock_,
                !mark_stack_lock_,
                !rb_slow_path_histogram_lock_,
                !skipped_blocks_lock_);
@@ -79,7 +92,8 @@ class ConcurrentCopying : public GarbageCollector {
       REQUIRES(!mark_stack_lock_, !immune_gray_stack_lock_);
   void MarkingPhase() REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_, !skipped_blocks_lock_, !immune_gray_stack_lock_);
-  void ReclaimPhase() REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  void ReclaimPhase() REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_, !class_histogram_lock_);
   void FinishPhase() REQUIRES(!mark_stack_lock_,
                               !rb_slow_path_histogram_lock_,
                               !skipped_blocks_lock_);
@@ -87,7 +101,7 @@ class ConcurrentCopying : public GarbageCollector {
   void BindBitmaps() REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::heap_bitmap_lock_);
   virtual GcType GetGcType() const OVERRIDE {
-    return kGcTypePartial;
+    return young_gen_ ? kGcTypeSticky : kGcTypePartial;
   }
   virtual CollectorType GetCollectorType() const OVERRIDE {
     return kCollectorTypeCC;
@@ -140,7 +154,18 @@ class ConcurrentCopying : public GarbageCollector {
   virtual mirror::Object* IsMarked(mirror::Object* from_ref) OVERRIDE
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Dump the live instance count and bytes of the max_entries classes with the most live bytes,
+  // as of the last full collection with Heap::IsGcClassHistogramEnabled(). Objects in the immune
+  // spaces and objects allocated during that collection are not included.
+  void DumpClassHistogram(std::ostream& os, size_t max_entries) REQUIRES(!class_histogram_lock_);
+
  private:
+  struct LiveClassCounts {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+  };
+  using ClassCountMap = std::unordered_map<mirror::Class*, LiveClassCounts>;
+
   void PushOntoMarkStack(mirror::Object* obj) REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
   mirror::Object* Copy(mirror::Object* from_ref,
@@ -170,14 +195,50 @@ class ConcurrentCopying : public GarbageCollector {
   virtual void ProcessMarkStack() OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
   bool ProcessMarkStackOnce() REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
-  void ProcessMarkStackRef(mirror::Object* to_ref) REQUIRES_SHARED(Locks::mutator_lock_)
+  // If kParallel is true, to_ref may be processed concurrently with other GC worker threads.
+  // If kParallel is true, live objects are counted into class_counts rather than class_counts_.
+  template <bool kParallel = false>
+  void ProcessMarkStackRef(mirror::Object* to_ref, ClassCountMap* class_counts = nullptr)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // Add a newly scanned object to the class histogram counts.
+  void CountLiveObject(mirror::Object* to_ref, ClassCountMap* class_counts)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+  // Turn class_counts_ into the class histogram returned by DumpClassHistogram().
+  void PublishClassHistogram() REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!class_histogram_lock_);
+  // Process the given revoked mark stacks with the heap thread pool. Returns the number of
+  // processed objects.
+  size_t ProcessMarkStacksParallel(
+      const std::vector<accounting::AtomicStack<mirror::Object>*>& mark_stacks,
+      size_t thread_count)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // Return a processed mark stack to the pool.
+  void RecycleMarkStack(accounting::AtomicStack<mirror::Object>* mark_stack)
       REQUIRES(!mark_stack_lock_);
+  // Number of threads, including the GC-running thread, used to process mark stacks.
+  size_t GetThreadCount() const;
   void GrayAllDirtyImmuneObjects()
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
   void GrayAllNewlyDirtyImmuneObjects()
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
+  // Age the dirty cards of the region space and the non-moving space and gray the old objects on
+  // them. Only used by the young-generation collector.
+  void GrayAllDirtyOldObjects()
+      REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  void GrayAllNewlyDirtyOldObjects()
+      REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  // Age the dirty cards of the spaces holding old objects.
+  void AgeOldSpaceCards() REQUIRES_SHARED(Locks::mutator_lock_);
+  // Scan the old objects grayed by the two functions above and whiten them.
+  void ScanOldGrayObjects() REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // Clean the cards which were aged in the pause and whose objects have all been processed.
+  void ClearAgedOldSpaceCards();
+  // The region space and the non-moving space, whose cards track the old-to-young references.
+  std::vector<space::ContinuousSpace*> GetOldSpaces() const;
   void VerifyGrayImmuneObjects()
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
@@ -211,6 +272,9 @@ class ConcurrentCopying : public GarbageCollector {
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!Locks::heap_bitmap_lock_);
   void Sweep(bool swap_bitmaps)
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_, !mark_stack_lock_);
+  // Sweep only the objects allocated since the last GC, as recorded by the given stack.
+  void SweepArray(accounting::ObjectStack* allocations, bool swap_bitmaps)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_, !mark_stack_lock_);
   void SweepLargeObjects(bool swap_bitmaps)
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_);
   void MarkZygoteLargeObjects()
@@ -264,6 +328,11 @@ class ConcurrentCopying : public GarbageCollector {
   void ActivateReadBarrierEntrypoints();
 
   space::RegionSpace* region_space_;      // The underlying region space.
+  // True if this is a young-generation (sticky) collector.
+  const bool young_gen_;
+  // True if the heap runs generational CC, i.e. both this and the young-generation collector
+  // maintain the region space mark bitmap and the old-space cards across collections.
+  const bool use_generational_cc_;
   std::unique_ptr<Barrier> gc_barrier_;
   std::unique_ptr<accounting::ObjectStack> gc_mark_stack_;
   std::unique_ptr<accounting::ObjectStack> rb_mark_bit_stack_;
@@ -277,6 +346,8 @@ class ConcurrentCopying : public GarbageCollector {
   std::vector<accounting::ObjectStack*> pooled_mark_stacks_
       GUARDED_BY(mark_stack_lock_);
   Thread* thread_running_gc_;
+  // True while heap thread pool workers process mark stacks on behalf of thread_running_gc_.
+  bool processing_mark_stacks_in_parallel_;
   bool is_marking_;                       // True while marking is ongoing.
   // True while we might dispatch on the read barrier entrypoints.
   bool is_using_read_barrier_entrypoints_;
@@ -336,12 +407,25 @@ class ConcurrentCopying : public GarbageCollector {
   bool gc_grays_immune_objects_;
   Mutex immune_gray_stack_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   std::vector<mirror::Object*> immune_gray_stack_ GUARDED_BY(immune_gray_stack_lock_);
+  // Old objects grayed on dirty cards by the young-generation collector. Only accessed by the
+  // GC-running thread.
+  std::vector<mirror::Object*> old_gray_stack_;
 
   // Class of java.lang.Object. Filled in from WellKnownClasses in FlipCallback. Must
   // be filled in before flipping thread roots so that FillDummyObject can run. Not
   // ObjPtr since the GC may transition to suspended and runnable between phases.
   mirror::Class* java_lang_Object_;
 
+  // True if this collection builds the class histogram. Only for full collections, since the
+  // young-generation collector does not visit the old objects.
+  bool collect_class_histogram_;
+  // Live objects per class counted by the GC-running thread, merged with the counts of the
+  // parallel mark stack workers. Class pointers are to-space references.
+  ClassCountMap class_counts_;
+  Mutex class_histogram_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // Sorted by decreasing bytes.
+  std::vector<ClassHistogramEntry> class_histogram_ GUARDED_BY(class_histogram_lock_);
+
   class ActivateReadBarrierEntrypointsCallback;
   class ActivateReadBarrierEntrypointsCheckpoint;
   class AssertToSpaceInvariantFieldVisitor;
@@ -353,8 +437,10 @@ class ConcurrentCopying : public GarbageCollector {
   class DisableWeakRefAccessCallback;
   class FlipCallback;
   template <bool kConcurrent> class GrayImmuneObjectVisitor;
+  template <bool kConcurrent> class GrayOldObjectVisitor;
   class ImmuneSpaceScanObjVisitor;
   class LostCopyVisitor;
+  class ProcessMarkStacksTask;
   class RefFieldsVisitor;
   class RevokeThreadLocalMarkStackCheckpoint;
   class ScopedGcGraysImmuneObjects;
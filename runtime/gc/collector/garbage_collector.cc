@@ -15,9 +15,17 @@
  */
 
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
 
 #include "garbage_collector.h"
 
+#include <algorithm>
+
 #include "android-base/stringprintf.h"
 
 #include "base/dumpable.h"
@@ -61,13 +69,44 @@ uint64_t Iteration::GetEstimatedThroughput() const {
   return (static_cast<uint64_t>(freed_.bytes) * 1000) / (NsToMs(GetDurationNs()) + 1);
 }
 
+// Opens a counter of the user space data TLB load misses of the calling thread. Returns -1 if
+// perf events are not available, e.g. because of the perf_event_paranoid setting.
+static int OpenDtlbMissCounter() {
+#ifdef __linux__
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_DTLB |
+      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+  return -1;
+#endif
+}
+
+// Reads and closes a counter opened by OpenDtlbMissCounter().
+static uint64_t ReadAndCloseCounter(int fd) {
+  uint64_t value = 0;
+  if (read(fd, &value, sizeof(value)) != sizeof(value)) {
+    value = 0;
+  }
+  close(fd);
+  return value;
+}
+
 GarbageCollector::GarbageCollector(Heap* heap, const std::string& name)
     : heap_(heap),
       name_(name),
       pause_histogram_((name_ + " paused").c_str(), kPauseBucketSize, kPauseBucketCount),
       cumulative_timings_(name),
       pause_histogram_lock_("pause histogram lock", kDefaultMutexLevel, true),
-      is_transaction_active_(false) {
+      is_transaction_active_(false),
+      metrics_(nullptr) {
+  std::fill_n(phase_times_ns_, kGcMetricCount, 0u);
   ResetCumulativeStatistics();
 }
 
@@ -80,12 +119,15 @@ void GarbageCollector::ResetCumulativeStatistics() {
   total_time_ns_ = 0;
   total_freed_objects_ = 0;
   total_freed_bytes_ = 0;
+  total_dtlb_misses_ = 0;
   MutexLock mu(Thread::Current(), pause_histogram_lock_);
   pause_histogram_.Reset();
 }
 
 void GarbageCollector::Run(GcCause gc_cause, bool clear_soft_references) {
-  ScopedTrace trace(android::base::StringPrintf("%s %s GC", PrettyCause(gc_cause), GetName()));
+  ScopedTrace trace(TraceCategory::kGc, [&]() {
+    return android::base::StringPrintf("%s %s GC", PrettyCause(gc_cause), GetName());
+  });
   Thread* self = Thread::Current();
   uint64_t start_time = NanoTime();
   Iteration* current_iteration = GetCurrentIteration();
@@ -93,7 +135,14 @@ void GarbageCollector::Run(GcCause gc_cause, bool clear_soft_references) {
   // Note transaction mode is single-threaded and there's no asynchronous GC and this flag doesn't
   // change in the middle of a GC.
   is_transaction_active_ = Runtime::Current()->IsActiveTransaction();
+  // Only the GC-running thread is counted, not the thread pool workers or the mutators. Compare
+  // the mutators with and without huge pages with a profiler like simpleperf.
+  const int dtlb_miss_counter = heap_->MeasureGcTlbMisses() ? OpenDtlbMissCounter() : -1;
+  std::fill_n(phase_times_ns_, kGcMetricCount, 0u);
   RunPhases();  // Run all the GC phases.
+  if (dtlb_miss_counter != -1) {
+    total_dtlb_misses_ += ReadAndCloseCounter(dtlb_miss_counter);
+  }
   // Add the current timings to the cumulative timings.
   cumulative_timings_.AddLogger(*GetTimings());
   // Update cumulative statistics with how many bytes the GC iteration freed.
@@ -114,9 +163,34 @@ void GarbageCollector::Run(GcCause gc_cause, bool clear_soft_references) {
     MutexLock mu(self, pause_histogram_lock_);
     pause_histogram_.AdjustAndAddValue(pause_time);
   }
+  if (metrics_ != nullptr) {
+    UpdateMetrics(*current_iteration);
+  }
   is_transaction_active_ = false;
 }
 
+void GarbageCollector::UpdateMetrics(const Iteration& iteration) {
+  const uint64_t freed_bytes = static_cast<uint64_t>(
+      std::max<int64_t>(iteration.GetFreedBytes() + iteration.GetFreedLargeObjectBytes(), 0));
+  GcMetrics::BeginUpdate(metrics_);
+  ++metrics_->iterations;
+  metrics_->total_time_us += NsToUs(iteration.GetDurationNs());
+  for (uint64_t pause_time : iteration.GetPauseTimes()) {
+    metrics_->histograms[kGcMetricPauseTime].AddValue(NsToUs(pause_time));
+  }
+  for (GcMetric metric : { kGcMetricMarkTime, kGcMetricCopyTime, kGcMetricSweepTime }) {
+    // Not all collectors have all the phases, e.g. mark sweep doesn't copy.
+    if (phase_times_ns_[metric] != 0u) {
+      metrics_->histograms[metric].AddValue(NsToUs(phase_times_ns_[metric]));
+    }
+  }
+  metrics_->histograms[kGcMetricFreedBytes].AddValue(freed_bytes);
+  // Add 1us to prevent possible division by 0.
+  metrics_->histograms[kGcMetricThroughput].AddValue(
+      freed_bytes * 1000u / (NsToUs(iteration.GetDurationNs()) + 1u));
+  GcMetrics::EndUpdate(metrics_);
+}
+
 void GarbageCollector::SwapBitmaps() {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
   // Swap the live and mark bitmaps for each alloc space. This is needed since sweep re-swaps
@@ -235,6 +309,25 @@ void GarbageCollector::DumpPerformanceInfo(std::ostream& os) {
      << " objects with total size " << PrettySize(freed_bytes) << "\n"
      << GetName() << " throughput: " << freed_objects / seconds << "/s / "
      << PrettySize(freed_bytes / seconds) << "/s\n";
+  if (total_dtlb_misses_ != 0) {
+    os << GetName() << " dTLB load misses: " << total_dtlb_misses_
+       << " mean: " << total_dtlb_misses_ / iterations << " per GC\n";
+  }
+}
+
+void GarbageCollector::DumpPausePercentiles(std::ostream& os) {
+  MutexLock mu(Thread::Current(), pause_histogram_lock_);
+  if (pause_histogram_.SampleSize() == 0) {
+    return;
+  }
+  // The pause histogram is kept in microseconds.
+  Histogram<uint64_t>::CumulativeData cumulative_data;
+  pause_histogram_.CreateHistogram(&cumulative_data);
+  os << GetName() << " pauses: " << pause_histogram_.SampleSize()
+     << " p50: " << static_cast<uint64_t>(pause_histogram_.Percentile(0.5, cumulative_data))
+     << " p90: " << static_cast<uint64_t>(pause_histogram_.Percentile(0.9, cumulative_data))
+     << " p99: " << static_cast<uint64_t>(pause_histogram_.Percentile(0.99, cumulative_data))
+     << " max: " << pause_histogram_.Max() << "\n";
 }
 
 }  // namespace collector
@@ -22,9 +22,11 @@
 
 #include "base/histogram.h"
 #include "base/mutex.h"
+#include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "gc/collector_type.h"
 #include "gc/gc_cause.h"
+#include "gc/gc_metrics.h"
 #include "gc_root.h"
 #include "gc_type.h"
 #include "iteration.h"
@@ -59,6 +61,21 @@ class GarbageCollector : public RootVisitor, public IsMarkedVisitor, public Mark
     bool with_reporting_;
   };
 
+  // Adds the time of a phase of the current collection to the exported metrics, see GcMetrics.
+  class ScopedPhaseMetric {
+   public:
+    ScopedPhaseMetric(GarbageCollector* collector, GcMetric metric)
+        : start_time_(NanoTime()), collector_(collector), metric_(metric) {}
+    ~ScopedPhaseMetric() {
+      collector_->phase_times_ns_[metric_] += NanoTime() - start_time_;
+    }
+
+   private:
+    const uint64_t start_time_;
+    GarbageCollector* const collector_;
+    const GcMetric metric_;
+  };
+
   GarbageCollector(Heap* heap, const std::string& name);
   virtual ~GarbageCollector() { }
   const char* GetName() const {
@@ -88,6 +105,10 @@ class GarbageCollector : public RootVisitor, public IsMarkedVisitor, public Mark
   uint64_t GetTotalFreedObjects() const {
     return total_freed_objects_;
   }
+  // Data TLB load misses of the GC-running thread over the collections, if measured.
+  uint64_t GetTotalDtlbMisses() const {
+    return total_dtlb_misses_;
+  }
   // Reset the cumulative timings and pause histogram.
   void ResetMeasurements() REQUIRES(!pause_histogram_lock_);
   // Returns the estimated throughput in bytes / second.
@@ -107,6 +128,9 @@ class GarbageCollector : public RootVisitor, public IsMarkedVisitor, public Mark
   // Record a free of large objects.
   void RecordFreeLOS(const ObjectBytePair& freed);
   virtual void DumpPerformanceInfo(std::ostream& os) REQUIRES(!pause_histogram_lock_);
+  // Dump the count and the 50th, 90th and 99th percentiles and maximum of the pauses, in
+  // microseconds, as one line. Nothing is dumped if there was no pause.
+  void DumpPausePercentiles(std::ostream& os) REQUIRES(!pause_histogram_lock_);
 
   // Helper functions for querying if objects are marked. These are used for processing references,
   // and will be used for reading system weaks while the GC is running.
@@ -133,6 +157,11 @@ class GarbageCollector : public RootVisitor, public IsMarkedVisitor, public Mark
     return is_transaction_active_;
   }
 
+  // Set the entry the collector exports its metrics to, may be null.
+  void SetMetrics(GcCollectorMetrics* metrics) {
+    metrics_ = metrics;
+  }
+
  protected:
   // Run all of the GC phases.
   virtual void RunPhases() = 0;
@@ -149,11 +178,17 @@ class GarbageCollector : public RootVisitor, public IsMarkedVisitor, public Mark
   uint64_t total_time_ns_;
   uint64_t total_freed_objects_;
   int64_t total_freed_bytes_;
+  uint64_t total_dtlb_misses_;
   CumulativeLogger cumulative_timings_;
   mutable Mutex pause_histogram_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   bool is_transaction_active_;
+  GcCollectorMetrics* metrics_;
+  // The time spent in the phases of the current collection, indexed by GcMetric.
+  uint64_t phase_times_ns_[kGcMetricCount];
 
  private:
+  void UpdateMetrics(const Iteration& iteration);
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(GarbageCollector);
 };
 
@@ -149,23 +149,35 @@ void MarkSweep::RunPhases() {
   if (IsConcurrent()) {
     GetHeap()->PreGcVerification(this);
     {
+      ScopedPhaseMetric phase(this, kGcMetricMarkTime);
       ReaderMutexLock mu(self, *Locks::mutator_lock_);
       MarkingPhase();
     }
     ScopedPause pause(this);
     GetHeap()->PrePauseRosAllocVerification(this);
-    PausePhase();
+    {
+      // Remarking the dirty objects.
+      ScopedPhaseMetric phase(this, kGcMetricMarkTime);
+      PausePhase();
+    }
     RevokeAllThreadLocalBuffers();
   } else {
     ScopedPause pause(this);
     GetHeap()->PreGcVerificationPaused(this);
-    MarkingPhase();
+    {
+      ScopedPhaseMetric phase(this, kGcMetricMarkTime);
+      MarkingPhase();
+    }
     GetHeap()->PrePauseRosAllocVerification(this);
-    PausePhase();
+    {
+      ScopedPhaseMetric phase(this, kGcMetricMarkTime);
+      PausePhase();
+    }
     RevokeAllThreadLocalBuffers();
   }
   {
     // Sweeping always done concurrently, even for non concurrent mark sweep.
+    ScopedPhaseMetric phase(this, kGcMetricSweepTime);
     ReaderMutexLock mu(self, *Locks::mutator_lock_);
     ReclaimPhase();
   }
@@ -1077,7 +1089,7 @@ void MarkSweep::ReMarkRoots() {
 void MarkSweep::SweepSystemWeaks(Thread* self) {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
   ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
-  Runtime::Current()->SweepSystemWeaks(this);
+  Runtime::Current()->SweepSystemWeaks(this, GetThreadCount(/* paused */ false));
 }
 
 class MarkSweep::VerifySystemWeakVisitor : public IsMarkedVisitor {
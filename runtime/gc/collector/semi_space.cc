@@ -122,8 +122,14 @@ void SemiSpace::RunPhases() {
   if (Locks::mutator_lock_->IsExclusiveHeld(self)) {
     GetHeap()->PreGcVerificationPaused(this);
     GetHeap()->PrePauseRosAllocVerification(this);
-    MarkingPhase();
-    ReclaimPhase();
+    {
+      ScopedPhaseMetric phase(this, kGcMetricCopyTime);
+      MarkingPhase();
+    }
+    {
+      ScopedPhaseMetric phase(this, kGcMetricSweepTime);
+      ReclaimPhase();
+    }
     GetHeap()->PostGcVerificationPaused(this);
   } else {
     Locks::mutator_lock_->AssertNotHeld(self);
@@ -131,9 +137,11 @@ void SemiSpace::RunPhases() {
       ScopedPause pause(this);
       GetHeap()->PreGcVerificationPaused(this);
       GetHeap()->PrePauseRosAllocVerification(this);
+      ScopedPhaseMetric phase(this, kGcMetricCopyTime);
       MarkingPhase();
     }
     {
+      ScopedPhaseMetric phase(this, kGcMetricSweepTime);
       ReaderMutexLock mu(self, *Locks::mutator_lock_);
       ReclaimPhase();
     }
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gc_metrics.h"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "android-base/unique_fd.h"
+
+#include "base/bit_utils.h"
+#include "base/logging.h"
+#include "base/strlcpy.h"
+#include "globals.h"
+#include "mem_map.h"
+
+namespace art {
+namespace gc {
+
+using android::base::unique_fd;
+
+constexpr uint32_t GcMetrics::kMagic;
+constexpr uint32_t GcMetrics::kVersion;
+constexpr size_t GcMetrics::kMaxCollectors;
+
+static constexpr size_t kCollectorsOffset =
+    RoundUp(sizeof(GcMetricsHeader), alignof(GcCollectorMetrics));
+static constexpr size_t kMetricsSize =
+    kCollectorsOffset + GcMetrics::kMaxCollectors * sizeof(GcCollectorMetrics);
+
+void GcMetricsHistogram::AddValue(uint64_t value) {
+  const size_t bucket = (value == 0u)
+      ? 0u
+      : std::min(static_cast<size_t>(MinimumBitsToStore(value)), kNumBuckets - 1u);
+  ++buckets[bucket];
+  ++count;
+  sum += value;
+  max = std::max(max, value);
+}
+
+static MemMap* MapMetricsFile(const std::string& file_name, size_t size, std::string* error_msg) {
+  // Readable by the monitoring agents, the metrics don't contain anything about the app's data.
+  unique_fd fd(TEMP_FAILURE_RETRY(open(file_name.c_str(),
+                                       O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                       0644)));
+  if (fd.get() == -1) {
+    *error_msg = "Failed to open: " + std::string(strerror(errno));
+    return nullptr;
+  }
+  if (TEMP_FAILURE_RETRY(ftruncate(fd.get(), size)) != 0) {
+    *error_msg = "Failed to resize: " + std::string(strerror(errno));
+    return nullptr;
+  }
+  return MemMap::MapFile(size,
+                         PROT_READ | PROT_WRITE,
+                         MAP_SHARED,
+                         fd.get(),
+                         /* start */ 0,
+                         /* low_4gb */ false,
+                         file_name.c_str(),
+                         error_msg);
+}
+
+GcMetrics* GcMetrics::Create(const std::string& file_name) {
+  const size_t size = RoundUp(kMetricsSize, kPageSize);
+  std::string error_msg;
+  MemMap* mem_map = nullptr;
+  if (!file_name.empty()) {
+    mem_map = MapMetricsFile(file_name, size, &error_msg);
+    if (mem_map == nullptr) {
+      LOG(WARNING) << "Failed to map GC metrics file " << file_name << ": " << error_msg;
+    }
+  }
+  const bool file_backed = mem_map != nullptr;
+  if (!file_backed) {
+    mem_map = MemMap::MapAnonymous("GC metrics",
+                                   nullptr,
+                                   size,
+                                   PROT_READ | PROT_WRITE,
+                                   /* low_4gb */ false,
+                                   /* reuse */ false,
+                                   &error_msg);
+    CHECK(mem_map != nullptr) << "Failed to map GC metrics: " << error_msg;
+  }
+  return new GcMetrics(mem_map, file_backed ? file_name : "");
+}
+
+GcMetrics::GcMetrics(MemMap* mem_map, const std::string& file_name)
+    : mem_map_(mem_map), file_name_(file_name) {
+  // The file was truncated and the anonymous mapping is zeroed, so the entries start out empty.
+  GcMetricsHeader* header = GetHeader();
+  header->version = kVersion;
+  header->num_collectors = 0u;
+  header->collector_size = sizeof(GcCollectorMetrics);
+  // Write the magic last so that a reader knows the rest of the header is valid once it sees it.
+  QuasiAtomic::ThreadFenceRelease();
+  header->magic = kMagic;
+}
+
+GcMetrics::~GcMetrics() {}
+
+GcMetricsHeader* GcMetrics::GetHeader() const {
+  return reinterpret_cast<GcMetricsHeader*>(mem_map_->Begin());
+}
+
+GcCollectorMetrics* GcMetrics::GetCollector(size_t index) const {
+  DCHECK_LT(index, kMaxCollectors);
+  return reinterpret_cast<GcCollectorMetrics*>(mem_map_->Begin() + kCollectorsOffset) + index;
+}
+
+GcCollectorMetrics* GcMetrics::AddCollector(const char* name, CollectorType collector_type) {
+  GcMetricsHeader* header = GetHeader();
+  if (header->num_collectors == kMaxCollectors) {
+    LOG(WARNING) << "No GC metrics for collector " << name;
+    return nullptr;
+  }
+  GcCollectorMetrics* metrics = GetCollector(header->num_collectors);
+  metrics->collector_type = static_cast<uint32_t>(collector_type);
+  strlcpy(metrics->name, name, sizeof(metrics->name));
+  QuasiAtomic::ThreadFenceRelease();
+  ++header->num_collectors;
+  return metrics;
+}
+
+void GcMetrics::BeginUpdate(GcCollectorMetrics* metrics) {
+  const uint32_t sequence = metrics->sequence.LoadRelaxed();
+  DCHECK_EQ(sequence % 2u, 0u);
+  metrics->sequence.StoreRelaxed(sequence + 1u);
+  // Keep the stores to the entry from moving before the odd sequence number.
+  QuasiAtomic::ThreadFenceRelease();
+}
+
+void GcMetrics::EndUpdate(GcCollectorMetrics* metrics) {
+  const uint32_t sequence = metrics->sequence.LoadRelaxed();
+  DCHECK_EQ(sequence % 2u, 1u);
+  metrics->sequence.StoreRelease(sequence + 1u);
+}
+
+void GcMetrics::Snapshot(std::vector<uint8_t>* out) const {
+  const GcMetricsHeader* header = GetHeader();
+  const size_t num_collectors = header->num_collectors;
+  out->resize(kCollectorsOffset + num_collectors * sizeof(GcCollectorMetrics));
+  memcpy(out->data(), header, sizeof(GcMetricsHeader));
+  for (size_t i = 0; i < num_collectors; ++i) {
+    const GcCollectorMetrics* metrics = GetCollector(i);
+    uint8_t* dest = out->data() + kCollectorsOffset + i * sizeof(GcCollectorMetrics);
+    while (true) {
+      const uint32_t before = metrics->sequence.LoadAcquire();
+      if (before % 2u == 0u) {
+        memcpy(dest, metrics, sizeof(GcCollectorMetrics));
+        QuasiAtomic::ThreadFenceAcquire();
+        if (metrics->sequence.LoadRelaxed() == before) {
+          break;
+        }
+      }
+      // The collector is updating the entry, which only takes a few stores.
+      sched_yield();
+    }
+  }
+}
+
+}  // namespace gc
+}  // namespace art
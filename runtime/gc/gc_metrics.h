@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_GC_METRICS_H_
+#define ART_RUNTIME_GC_GC_METRICS_H_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "gc/collector_type.h"
+
+namespace art {
+
+class MemMap;
+
+namespace gc {
+
+// The metrics recorded for each collection. The values are part of the exported layout, only
+// append to this list.
+enum GcMetric : uint32_t {
+  kGcMetricPauseTime,   // Each pause of the mutators, in microseconds.
+  kGcMetricMarkTime,    // Tracing the live objects, in microseconds.
+  kGcMetricCopyTime,    // Moving the live objects, in microseconds.
+  kGcMetricSweepTime,   // Reclaiming the memory of the dead objects, in microseconds.
+  kGcMetricFreedBytes,  // Bytes freed by a collection.
+  kGcMetricThroughput,  // Bytes freed per second of a collection, in KB/s.
+  kGcMetricCount,
+};
+
+// A histogram with power of two buckets, bucket 0 counts the zeros and bucket i > 0 the values in
+// [2^(i-1), 2^i). The last bucket also counts all the larger values.
+struct GcMetricsHistogram {
+  static constexpr size_t kNumBuckets = 32;
+
+  void AddValue(uint64_t value);
+
+  uint64_t count;
+  uint64_t sum;
+  uint64_t max;
+  uint64_t buckets[kNumBuckets];
+};
+
+// The metrics of one collector. Only the thread running the collection updates them, the readers
+// use the sequence number to get a consistent copy without taking a lock.
+struct GcCollectorMetrics {
+  static constexpr size_t kMaxNameLength = 48;
+
+  // Odd while the entry is being updated.
+  Atomic<uint32_t> sequence;
+  uint32_t collector_type;  // The CollectorType.
+  char name[kMaxNameLength];
+  uint64_t iterations;
+  uint64_t total_time_us;
+  GcMetricsHistogram histograms[kGcMetricCount];
+};
+
+// The start of the exported metrics, followed by num_collectors entries of collector_size bytes.
+struct GcMetricsHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t num_collectors;
+  uint32_t collector_size;
+};
+
+// Structured GC metrics that don't require parsing the SIGQUIT dump. They are kept in a mapping
+// that may be backed by a file, so that another process can read them with mmap() while the
+// runtime is live. Snapshot() copies them into a buffer with the same layout.
+class GcMetrics {
+ public:
+  static constexpr uint32_t kMagic = 0x6d636761;  // "agcm" in little endian.
+  static constexpr uint32_t kVersion = 1;
+  static constexpr size_t kMaxCollectors = 16;
+
+  // Maps the metrics as a MAP_SHARED mapping of file_name if not empty, anonymously otherwise.
+  // Falls back to an anonymous mapping if the file can't be mapped.
+  static GcMetrics* Create(const std::string& file_name);
+  ~GcMetrics();
+
+  // Returns the entry of a new collector, or null if there are kMaxCollectors already. Called
+  // before any collection runs.
+  GcCollectorMetrics* AddCollector(const char* name, CollectorType collector_type);
+
+  // Bracket the changes to an entry.
+  static void BeginUpdate(GcCollectorMetrics* metrics);
+  static void EndUpdate(GcCollectorMetrics* metrics);
+
+  // Copies the header and a consistent view of each collector entry into out.
+  void Snapshot(std::vector<uint8_t>* out) const;
+
+  // The metrics file, empty if the metrics are not backed by a file.
+  const std::string& GetFileName() const {
+    return file_name_;
+  }
+
+ private:
+  GcMetrics(MemMap* mem_map, const std::string& file_name);
+
+  GcMetricsHeader* GetHeader() const;
+  GcCollectorMetrics* GetCollector(size_t index) const;
+
+  std::unique_ptr<MemMap> mem_map_;
+  const std::string file_name_;
+
+  DISALLOW_COPY_AND_ASSIGN(GcMetrics);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_GC_METRICS_H_
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gc_metrics.h"
+
+#include <string.h>
+
+#include "common_runtime_test.h"
+#include "os.h"
+
+namespace art {
+namespace gc {
+
+class GcMetricsTest : public CommonRuntimeTest {};
+
+TEST_F(GcMetricsTest, HistogramBuckets) {
+  GcMetricsHistogram histogram;
+  memset(&histogram, 0, sizeof(histogram));
+  histogram.AddValue(0u);
+  histogram.AddValue(1u);
+  histogram.AddValue(3u);
+  histogram.AddValue(4u);
+  histogram.AddValue(UINT64_C(1) << 40);
+  EXPECT_EQ(histogram.count, 5u);
+  EXPECT_EQ(histogram.sum, 8u + (UINT64_C(1) << 40));
+  EXPECT_EQ(histogram.max, UINT64_C(1) << 40);
+  EXPECT_EQ(histogram.buckets[0], 1u);
+  EXPECT_EQ(histogram.buckets[1], 1u);
+  EXPECT_EQ(histogram.buckets[2], 1u);
+  EXPECT_EQ(histogram.buckets[3], 1u);
+  EXPECT_EQ(histogram.buckets[GcMetricsHistogram::kNumBuckets - 1], 1u);
+}
+
+TEST_F(GcMetricsTest, Snapshot) {
+  std::unique_ptr<GcMetrics> metrics(GcMetrics::Create(""));
+  ASSERT_TRUE(metrics != nullptr);
+  EXPECT_TRUE(metrics->GetFileName().empty());
+  GcCollectorMetrics* collector = metrics->AddCollector("test collector", kCollectorTypeCC);
+  ASSERT_TRUE(collector != nullptr);
+  GcMetrics::BeginUpdate(collector);
+  ++collector->iterations;
+  collector->histograms[kGcMetricPauseTime].AddValue(100u);
+  GcMetrics::EndUpdate(collector);
+
+  std::vector<uint8_t> snapshot;
+  metrics->Snapshot(&snapshot);
+  ASSERT_GE(snapshot.size(), sizeof(GcMetricsHeader));
+  GcMetricsHeader header;
+  memcpy(&header, snapshot.data(), sizeof(header));
+  EXPECT_EQ(header.magic, GcMetrics::kMagic);
+  EXPECT_EQ(header.version, GcMetrics::kVersion);
+  ASSERT_EQ(header.num_collectors, 1u);
+  ASSERT_EQ(header.collector_size, sizeof(GcCollectorMetrics));
+  ASSERT_EQ(snapshot.size() % alignof(GcCollectorMetrics), 0u);
+  const GcCollectorMetrics* copy = reinterpret_cast<const GcCollectorMetrics*>(
+      snapshot.data() + snapshot.size() - sizeof(GcCollectorMetrics));
+  EXPECT_STREQ(copy->name, "test collector");
+  EXPECT_EQ(copy->collector_type, static_cast<uint32_t>(kCollectorTypeCC));
+  EXPECT_EQ(copy->sequence.LoadRelaxed(), 2u);
+  EXPECT_EQ(copy->iterations, 1u);
+  EXPECT_EQ(copy->histograms[kGcMetricPauseTime].count, 1u);
+  EXPECT_EQ(copy->histograms[kGcMetricPauseTime].sum, 100u);
+}
+
+TEST_F(GcMetricsTest, FileBacked) {
+  ScratchFile file;
+  std::unique_ptr<GcMetrics> metrics(GcMetrics::Create(file.GetFilename()));
+  ASSERT_TRUE(metrics != nullptr);
+  EXPECT_EQ(metrics->GetFileName(), file.GetFilename());
+  ASSERT_TRUE(metrics->AddCollector("test collector", kCollectorTypeCMS) != nullptr);
+  // Another process sees the header through the file.
+  std::unique_ptr<File> reader(OS::OpenFileForReading(file.GetFilename().c_str()));
+  ASSERT_TRUE(reader != nullptr);
+  GcMetricsHeader header;
+  ASSERT_TRUE(reader->PreadFully(&header, sizeof(header), 0));
+  EXPECT_EQ(header.magic, GcMetrics::kMagic);
+  EXPECT_EQ(header.num_collectors, 1u);
+}
+
+}  // namespace gc
+}  // namespace art
@@ -24,6 +24,7 @@
 #include "gc/accounting/atomic_stack.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/allocation_record.h"
+#include "gc/allocation_sampler.h"
 #include "gc/collector/semi_space.h"
 #include "gc/space/bump_pointer_space-inl.h"
 #include "gc/space/dlmalloc_space-inl.h"
@@ -78,6 +79,7 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self,
   size_t bytes_allocated;
   size_t usable_size;
   size_t new_num_bytes_allocated = 0;
+  bool sample_allocation = false;
   if (IsTLABAllocator(allocator)) {
     byte_count = RoundUp(byte_count, space::BumpPointerSpace::kAlignment);
   }
@@ -160,6 +162,11 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self,
       // Only trace when we get an increase in the number of bytes allocated. This happens when
       // obtaining a new TLAB and isn't often enough to hurt performance according to golem.
       TraceHeapSize(new_num_bytes_allocated + bytes_tl_bulk_allocated);
+      // The allocation sampler is driven by the same bulk allocations so that it costs nothing
+      // on the thread-local fast paths.
+      if (UNLIKELY(allocation_sampler_->IsEnabled())) {
+        sample_allocation = allocation_sampler_->ShouldSample(self, bytes_tl_bulk_allocated);
+      }
     }
   }
   if (kIsDebugBuild && Runtime::Current()->IsStarted()) {
@@ -194,6 +201,9 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self,
   } else {
     DCHECK(!IsAllocTrackingEnabled());
   }
+  if (UNLIKELY(sample_allocation)) {
+    allocation_sampler_->SampleAllocation(self, &obj, bytes_allocated);
+  }
   if (AllocatorHasAllocationStack(allocator)) {
     PushOnAllocationStack(self, &obj);
   }
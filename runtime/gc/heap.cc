@@ -46,12 +46,14 @@
 #include "gc/accounting/read_barrier_table.h"
 #include "gc/accounting/remembered_set.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "gc/allocation_sampler.h"
 #include "gc/collector/concurrent_copying.h"
 #include "gc/collector/mark_compact.h"
 #include "gc/collector/mark_sweep.h"
 #include "gc/collector/partial_mark_sweep.h"
 #include "gc/collector/semi_space.h"
 #include "gc/collector/sticky_mark_sweep.h"
+#include "gc/gc_metrics.h"
 #include "gc/reference_processor.h"
 #include "gc/scoped_gc_critical_section.h"
 #include "gc/space/bump_pointer_space.h"
@@ -85,6 +87,7 @@
 #include "reflection.h"
 #include "runtime.h"
 #include "scoped_thread_state_change-inl.h"
+#include "startup_timeline.h"
 #include "thread_list.h"
 #include "verify_object-inl.h"
 #include "well_known_classes.h"
@@ -105,6 +108,9 @@ static constexpr size_t kMaxConcurrentRemainingBytes = 512 * KB;
 // relative to partial/full GC. This may be desirable since sticky GCs interfere less with mutator
 // threads (lower pauses, use less memory bandwidth).
 static constexpr double kStickyGcThroughputAdjustment = 1.0;
+// Bounds of the concurrent GC start margin of the pause-goal policy, in percent.
+static constexpr size_t kMinConcurrentStartMarginPercent = 100;
+static constexpr size_t kMaxConcurrentStartMarginPercent = 800;
 // Whether or not we compact the zygote in PreZygoteFork.
 static constexpr bool kCompactZygote = kMovingCollector;
 // How many reserve entries are at the end of the allocation stack, these are only needed if the
@@ -137,6 +143,11 @@ static constexpr uint32_t kAllocSpaceBeginForDeterministicAoT = 0x40000000;
 // Dump the rosalloc stats on SIGQUIT.
 static constexpr bool kDumpRosAllocStatsOnSigQuit = false;
 
+// Number of allocation sampler call sites included in the SIGQUIT dump.
+static constexpr size_t kSigQuitAllocationCallSites = 20;
+// Number of live class histogram entries included in the SIGQUIT dump.
+static constexpr size_t kSigQuitClassHistogramEntries = 20;
+
 static const char* kRegionSpaceName = "main space (region space)";
 
 // If true, we log all GCs in the both the foreground and background. Used for debugging.
@@ -146,6 +157,15 @@ static constexpr bool kLogAllGCs = false;
 static constexpr size_t kPartialTlabSize = 16 * KB;
 static constexpr bool kUsePartialTlabs = true;
 
+// If true, size each TLAB refill or expansion from the allocating thread's recent allocation
+// rate: the refill size tracks the bytes the thread allocates per kTlabRefillIntervalNs.
+static constexpr bool kUseAdaptiveTlabs = true;
+static constexpr uint64_t kTlabRefillIntervalNs = MsToNs(10);
+static constexpr size_t kMaxBumpPointerTlabSize = 256 * KB;
+// Threads whose refill size drops below this allocate from the shared region instead of pinning a
+// new region for a TLAB they would barely use.
+static constexpr size_t kIdleTlabRefillSize = 1 * KB;
+
 #if defined(__LP64__) || !defined(ADDRESS_SANITIZER)
 // 300 MB (0x12c00000) - (default non-moving space capacity).
 static uint8_t* const kPreferredAllocSpaceBegin =
@@ -183,6 +203,12 @@ Heap::Heap(size_t initial_size,
            bool low_memory_mode,
            size_t long_pause_log_threshold,
            size_t long_gc_log_threshold,
+           uint64_t gc_pause_target_ns,
+           uint32_t gc_cpu_budget_percent,
+           size_t alloc_sample_interval,
+           size_t heap_trim_release_budget,
+           bool numa_aware_region_space,
+           const std::string& gc_metrics_file,
            bool ignore_max_footprint,
            bool use_tlab,
            bool verify_pre_gc_heap,
@@ -193,6 +219,9 @@ Heap::Heap(size_t initial_size,
            bool verify_post_gc_rosalloc,
            bool gc_stress_mode,
            bool measure_gc_performance,
+           bool use_generational_cc,
+           bool gc_class_histogram,
+           bool measure_gc_tlb_misses,
            bool use_homogeneous_space_compaction_for_oom,
            uint64_t min_interval_homogeneous_space_compaction_by_oom)
     : non_moving_space_(nullptr),
@@ -209,6 +238,11 @@ Heap::Heap(size_t initial_size,
       low_memory_mode_(low_memory_mode),
       long_pause_log_threshold_(long_pause_log_threshold),
       long_gc_log_threshold_(long_gc_log_threshold),
+      gc_pause_target_ns_(gc_pause_target_ns),
+      gc_cpu_budget_percent_(gc_cpu_budget_percent),
+      concurrent_start_margin_percent_(100U),
+      last_gc_end_time_ns_(0U),
+      bytes_allocated_after_last_gc_(0U),
       ignore_max_footprint_(ignore_max_footprint),
       zygote_creation_lock_("zygote creation lock", kZygoteCreationLock),
       zygote_space_(nullptr),
@@ -263,14 +297,22 @@ Heap::Heap(size_t initial_size,
       semi_space_collector_(nullptr),
       mark_compact_collector_(nullptr),
       concurrent_copying_collector_(nullptr),
+      young_concurrent_copying_collector_(nullptr),
+      active_concurrent_copying_collector_(nullptr),
       is_running_on_memory_tool_(Runtime::Current()->IsRunningOnMemoryTool()),
       use_tlab_(use_tlab),
+      use_generational_cc_(use_generational_cc),
+      gc_class_histogram_(gc_class_histogram),
+      measure_gc_tlb_misses_(measure_gc_tlb_misses),
       main_space_backup_(nullptr),
       min_interval_homogeneous_space_compaction_by_oom_(
           min_interval_homogeneous_space_compaction_by_oom),
       last_time_homogeneous_space_compaction_by_oom_(NanoTime()),
       pending_collector_transition_(nullptr),
       pending_heap_trim_(nullptr),
+      pending_page_release_(nullptr),
+      pending_class_loader_free_(nullptr),
+      heap_trim_release_budget_(RoundUp(heap_trim_release_budget, kPageSize)),
       use_homogeneous_space_compaction_for_oom_(use_homogeneous_space_compaction_for_oom),
       running_collection_is_blocking_(false),
       blocking_gc_count_(0U),
@@ -283,6 +325,8 @@ Heap::Heap(size_t initial_size,
       blocking_gc_count_rate_histogram_("blocking gc count rate histogram", 1U,
                                         kGcCountRateMaxBucketCount),
       alloc_tracking_enabled_(false),
+      allocation_sampler_(new AllocationSampler(alloc_sample_interval)),
+      gc_metrics_(GcMetrics::Create(gc_metrics_file)),
       backtrace_lock_(nullptr),
       seen_backtrace_count_(0u),
       unique_backtrace_count_(0u),
@@ -320,10 +364,15 @@ Heap::Heap(size_t initial_size,
   }
 
   // Load image space(s).
-  if (space::ImageSpace::LoadBootImage(image_file_name,
-                                       image_instruction_set,
-                                       &boot_image_spaces_,
-                                       &requested_alloc_space_begin)) {
+  bool loaded_boot_image;
+  {
+    ScopedStartupPhase phase(Runtime::Current()->GetStartupTimeline(), "LoadBootImage");
+    loaded_boot_image = space::ImageSpace::LoadBootImage(image_file_name,
+                                                         image_instruction_set,
+                                                         &boot_image_spaces_,
+                                                         &requested_alloc_space_begin);
+  }
+  if (loaded_boot_image) {
     for (auto space : boot_image_spaces_) {
       AddSpace(space);
     }
@@ -441,7 +490,9 @@ Heap::Heap(size_t initial_size,
                                                                     capacity_ * 2,
                                                                     request_begin);
     CHECK(region_space_mem_map != nullptr) << "No region space mem map";
-    region_space_ = space::RegionSpace::Create(kRegionSpaceName, region_space_mem_map);
+    region_space_ = space::RegionSpace::Create(kRegionSpaceName,
+                                               region_space_mem_map,
+                                               numa_aware_region_space);
     AddSpace(region_space_);
   } else if (IsMovingGc(foreground_collector_type_) &&
       foreground_collector_type_ != kCollectorTypeGSS) {
@@ -601,17 +652,32 @@ Heap::Heap(size_t initial_size,
     }
     if (MayUseCollector(kCollectorTypeCC)) {
       concurrent_copying_collector_ = new collector::ConcurrentCopying(this,
+                                                                       /*young_gen*/ false,
                                                                        "",
                                                                        measure_gc_performance);
       DCHECK(region_space_ != nullptr);
       concurrent_copying_collector_->SetRegionSpace(region_space_);
       garbage_collectors_.push_back(concurrent_copying_collector_);
+      if (use_generational_cc_) {
+        young_concurrent_copying_collector_ = new collector::ConcurrentCopying(
+            this,
+            /*young_gen*/ true,
+            "young",
+            measure_gc_performance);
+        young_concurrent_copying_collector_->SetRegionSpace(region_space_);
+        garbage_collectors_.push_back(young_concurrent_copying_collector_);
+      }
+      active_concurrent_copying_collector_ = concurrent_copying_collector_;
     }
     if (MayUseCollector(kCollectorTypeMC)) {
       mark_compact_collector_ = new collector::MarkCompact(this);
       garbage_collectors_.push_back(mark_compact_collector_);
     }
   }
+  for (collector::GarbageCollector* collector : garbage_collectors_) {
+    collector->SetMetrics(
+        gc_metrics_->AddCollector(collector->GetName(), collector->GetCollectorType()));
+  }
   if (!GetBootImageSpaces().empty() && non_moving_space_ != nullptr &&
       (is_zygote || separate_non_moving_space || foreground_collector_type_ == kCollectorTypeGSS)) {
     // Check that there's no gap between the image space and the non moving space so that the
@@ -1059,6 +1125,7 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
   os << "Registered native bytes allocated: "
      << old_native_bytes_allocated_.LoadRelaxed() + new_native_bytes_allocated_.LoadRelaxed()
      << "\n";
+  reference_processor_->DumpFinalizerStats(os);
 
   BaseMutex::DumpAll(os);
 }
@@ -1121,6 +1188,24 @@ void Heap::DumpBlockingGcCountRateHistogram(std::ostream& os) const {
   }
 }
 
+void Heap::DumpRegionFragmentationHistogram(std::ostream& os) const {
+  if (region_space_ != nullptr) {
+    region_space_->DumpFragmentationHistogram(os);
+  }
+}
+
+void Heap::DumpPausePercentiles(std::ostream& os) const {
+  for (collector::GarbageCollector* collector : garbage_collectors_) {
+    collector->DumpPausePercentiles(os);
+  }
+}
+
+void Heap::DumpClassHistogram(std::ostream& os, size_t max_entries) const {
+  if (gc_class_histogram_ && concurrent_copying_collector_ != nullptr) {
+    concurrent_copying_collector_->DumpClassHistogram(os, max_entries);
+  }
+}
+
 ALWAYS_INLINE
 static inline AllocationListener* GetAndOverwriteAllocationListener(
     Atomic<AllocationListener*>* storage, AllocationListener* new_value) {
@@ -1276,9 +1361,9 @@ void Heap::DoPendingCollectorTransition() {
 
 void Heap::Trim(Thread* self) {
   Runtime* const runtime = Runtime::Current();
-  if (!CareAboutPauseTimes()) {
+  if (!CareAboutPauseTimes() || runtime->GetMonitorList()->ShouldDeflateMonitorsInForeground()) {
     // Deflate the monitors, this can cause a pause but shouldn't matter since we don't care
-    // about pauses.
+    // about pauses, or since the monitors to sweep in each GC grew too many.
     ScopedTrace trace("Deflating monitors");
     // Avoid race conditions on the lock word for CC.
     ScopedGCCriticalSection gcs(self, kGcCauseTrim, kCollectorTypeHeapTrim);
@@ -1347,12 +1432,19 @@ void Heap::TrimSpaces(Thread* self) {
   uint64_t total_alloc_space_allocated = 0;
   uint64_t total_alloc_space_size = 0;
   uint64_t managed_reclaimed = 0;
+  bool release_pages_later = false;
   {
     ScopedObjectAccess soa(self);
     for (const auto& space : continuous_spaces_) {
       if (space->IsMallocSpace()) {
         gc::space::MallocSpace* malloc_space = space->AsMallocSpace();
-        if (malloc_space->IsRosAllocSpace() || !CareAboutPauseTimes()) {
+        if (heap_trim_release_budget_ != 0 &&
+            malloc_space->IsRosAllocSpace() &&
+            !malloc_space->AsRosAllocSpace()->GetRosAlloc()->DoesReleaseAllPages()) {
+          // Leave the empty pages to ReleasePagesStep().
+          malloc_space->AsRosAllocSpace()->TrimEnd();
+          release_pages_later = true;
+        } else if (malloc_space->IsRosAllocSpace() || !CareAboutPauseTimes()) {
           // Don't trim dlmalloc spaces if we care about pauses since this can hold the space lock
           // for a long period of time.
           managed_reclaimed += malloc_space->Trim();
@@ -1376,12 +1468,46 @@ void Heap::TrimSpaces(Thread* self) {
   uint64_t gc_heap_end_ns = NanoTime();
   // We never move things in the native heap, so we can finish the GC at this point.
   FinishGC(self, collector::kGcTypeNone);
+  if (release_pages_later) {
+    RequestPageRelease(self, 0u);
+  }
 
   VLOG(heap) << "Heap trim of managed (duration=" << PrettyDuration(gc_heap_end_ns - start_ns)
       << ", advised=" << PrettySize(managed_reclaimed) << ") heap. Managed heap utilization of "
       << static_cast<int>(100 * managed_utilization) << "%.";
 }
 
+bool Heap::ReleasePagesStep(Thread* self) {
+  // As for TrimSpaces(), keep background compaction from deleting the spaces.
+  StartGC(self, kGcCauseTrim, kCollectorTypeHeapTrim);
+  ScopedTrace trace(__PRETTY_FUNCTION__);
+  const uint64_t start_ns = NanoTime();
+  size_t budget = heap_trim_release_budget_;
+  size_t reclaimed = 0;
+  bool done = true;
+  {
+    ScopedObjectAccess soa(self);
+    for (const auto& space : continuous_spaces_) {
+      if (budget == 0) {
+        done = false;
+        break;
+      }
+      if (space->IsRosAllocSpace()) {
+        allocator::RosAlloc* rosalloc = space->AsRosAllocSpace()->GetRosAlloc();
+        if (!rosalloc->DoesReleaseAllPages()) {
+          bool space_done = false;
+          reclaimed += rosalloc->ReleasePagesIncremental(&budget, &space_done);
+          done = done && space_done;
+        }
+      }
+    }
+  }
+  FinishGC(self, collector::kGcTypeNone);
+  VLOG(heap) << "Heap trim page release (duration=" << PrettyDuration(NanoTime() - start_ns)
+      << ", advised=" << PrettySize(reclaimed) << ")" << (done ? " done" : "");
+  return !done;
+}
+
 bool Heap::IsValidObjectAddress(const void* addr) const {
   if (addr == nullptr) {
     return true;
@@ -2132,6 +2258,9 @@ void Heap::ChangeCollector(CollectorType collector_type) {
     gc_plan_.clear();
     switch (collector_type_) {
       case kCollectorTypeCC: {
+        if (use_generational_cc_) {
+          gc_plan_.push_back(collector::kGcTypeSticky);
+        }
         gc_plan_.push_back(collector::kGcTypeFull);
         if (use_tlab_) {
           ChangeAllocator(kAllocatorTypeRegionTLAB);
@@ -2283,6 +2412,8 @@ void Heap::UnBindBitmaps() {
 }
 
 void Heap::PreZygoteFork() {
+  ScopedTrace trace(__FUNCTION__);
+  const uint64_t start_ns = NanoTime();
   if (!HasZygoteSpace()) {
     // We still want to GC in case there is some unreachable non moving objects that could cause a
     // suboptimal bin packing when we compact the zygote space.
@@ -2299,7 +2430,8 @@ void Heap::PreZygoteFork() {
   }
   Runtime::Current()->GetInternTable()->AddNewTable();
   Runtime::Current()->GetClassLinker()->MoveClassTableToPreZygote();
-  VLOG(heap) << "Starting PreZygoteFork";
+  VLOG(heap) << "Starting PreZygoteFork after "
+             << PrettyDuration(NanoTime() - start_ns) << " of pre-fork GC";
   // The end of the non-moving space may be protected, unprotect it so that we can copy the zygote
   // there.
   non_moving_space_->GetMemMap()->Protect(PROT_READ | PROT_WRITE);
@@ -2359,7 +2491,9 @@ void Heap::PreZygoteFork() {
     // Update the end and write out image.
     non_moving_space_->SetEnd(target_space.End());
     non_moving_space_->SetLimit(target_space.Limit());
-    VLOG(heap) << "Create zygote space with size=" << non_moving_space_->Size() << " bytes";
+    VLOG(heap) << "Create zygote space with size=" << non_moving_space_->Size() << " bytes, "
+               << "compacted " << PrettySize(target_space.Size()) << " in "
+               << PrettyDuration(NanoTime() - start_ns) << " since the start of PreZygoteFork";
   }
   // Change the collector to the post zygote one.
   ChangeCollector(foreground_collector_type_);
@@ -2443,6 +2577,7 @@ void Heap::PreZygoteFork() {
         << "Failed to create post-zygote non-moving space remembered set";
     AddRememberedSet(post_zygote_non_moving_space_rem_set);
   }
+  VLOG(heap) << "PreZygoteFork took " << PrettyDuration(NanoTime() - start_ns);
 }
 
 void Heap::FlushAllocStack() {
@@ -2499,7 +2634,7 @@ collector::GarbageCollector* Heap::Compact(space::ContinuousMemMapAllocSpace* ta
 }
 
 void Heap::TraceHeapSize(size_t heap_size) {
-  ATRACE_INT("Heap size (KB)", heap_size / KB);
+  TraceCounter(TraceCategory::kGc, "Heap size (KB)", heap_size / KB);
 }
 
 collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
@@ -2582,7 +2717,13 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
         collector = semi_space_collector_;
         break;
       case kCollectorTypeCC:
-        collector = concurrent_copying_collector_;
+        // Read barriers dispatch on the active collector, switch it before the collection starts.
+        if (use_generational_cc_ && gc_type == collector::kGcTypeSticky) {
+          active_concurrent_copying_collector_ = young_concurrent_copying_collector_;
+        } else {
+          active_concurrent_copying_collector_ = concurrent_copying_collector_;
+        }
+        collector = active_concurrent_copying_collector_;
         break;
       case kCollectorTypeMC:
         mark_compact_collector_->SetSpace(bump_pointer_space_);
@@ -2591,7 +2732,7 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
       default:
         LOG(FATAL) << "Invalid collector type " << static_cast<size_t>(collector_type_);
     }
-    if (collector != mark_compact_collector_ && collector != concurrent_copying_collector_) {
+    if (collector != mark_compact_collector_ && collector != active_concurrent_copying_collector_) {
       temp_space_->GetMemMap()->Protect(PROT_READ | PROT_WRITE);
       if (kIsDebugBuild) {
         // Try to read each page of the memory map in case mprotect didn't work properly b/19894268.
@@ -2599,7 +2740,10 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
       }
       CHECK(temp_space_->IsEmpty());
     }
-    gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    // The young concurrent copying collection keeps its sticky GC type.
+    if (collector != young_concurrent_copying_collector_) {
+      gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    }
   } else if (current_allocator_ == kAllocatorTypeRosAlloc ||
       current_allocator_ == kAllocatorTypeDlMalloc) {
     collector = FindCollectorByGcType(gc_type);
@@ -3398,6 +3542,11 @@ void Heap::DumpForSigQuit(std::ostream& os) {
   os << "Heap: " << GetPercentFree() << "% free, " << PrettySize(GetBytesAllocated()) << "/"
      << PrettySize(GetTotalMemory()) << "; " << GetObjectsAllocated() << " objects\n";
   DumpGcPerformanceInfo(os);
+  if (allocation_sampler_->IsEnabled()) {
+    ScopedObjectAccess soa(Thread::Current());
+    allocation_sampler_->Dump(os, kSigQuitAllocationCallSites);
+  }
+  DumpClassHistogram(os, kSigQuitClassHistogramEntries);
 }
 
 size_t Heap::GetPercentFree() {
@@ -3467,6 +3616,11 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
     collector::GcType non_sticky_gc_type = NonStickyGcType();
     // Find what the next non sticky collector will be.
     collector::GarbageCollector* non_sticky_collector = FindCollectorByGcType(non_sticky_gc_type);
+    if (use_generational_cc_ && non_sticky_collector == nullptr) {
+      // The full concurrent copying collector reports itself as a partial collection.
+      non_sticky_collector = FindCollectorByGcType(collector::kGcTypePartial);
+    }
+    CHECK(non_sticky_collector != nullptr);
     // If the throughput of the current sticky GC >= throughput of the non sticky collector, then
     // do another sticky collection next.
     // We also check that the bytes allocated aren't over the footprint limit in order to prevent a
@@ -3487,6 +3641,9 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
       target_size = std::max(bytes_allocated, static_cast<uint64_t>(max_allowed_footprint_));
     }
   }
+  if (HasPauseGoals()) {
+    AdjustForPauseGoals(gc_type, bytes_allocated, bytes_allocated_before_gc, &target_size);
+  }
   if (!ignore_max_footprint_) {
     SetIdealFootprint(target_size);
     if (IsGcConcurrent()) {
@@ -3505,6 +3662,8 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
       size_t remaining_bytes = bytes_allocated_during_gc * gc_duration_seconds;
       remaining_bytes = std::min(remaining_bytes, kMaxConcurrentRemainingBytes);
       remaining_bytes = std::max(remaining_bytes, kMinConcurrentRemainingBytes);
+      // Start earlier if mutators recently blocked for longer than the pause target.
+      remaining_bytes = remaining_bytes * concurrent_start_margin_percent_ / 100;
       if (UNLIKELY(remaining_bytes > max_allowed_footprint_)) {
         // A never going to happen situation that from the estimated allocation rate we will exceed
         // the applications entire footprint with the given estimated allocation rate. Schedule
@@ -3522,6 +3681,88 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
   }
 }
 
+static void UpdateGcGoalAverage(uint64_t* average, uint64_t sample) {
+  // Weight the new sample by 1/4, the first sample seeds the average.
+  *average = (*average == 0) ? sample : (*average * 3 + sample) / 4;
+}
+
+void Heap::AdjustForPauseGoals(collector::GcType gc_type,
+                               uint64_t bytes_allocated,
+                               uint64_t bytes_allocated_before_gc,
+                               uint64_t* target_size) {
+  const uint64_t now_ns = NanoTime();
+  const uint64_t duration_ns = std::max<uint64_t>(current_gc_iteration_.GetDurationNs(), 1U);
+  uint64_t max_pause_ns = 0;
+  for (uint64_t pause_ns : current_gc_iteration_.GetPauseTimes()) {
+    max_pause_ns = std::max(max_pause_ns, pause_ns);
+  }
+  // A collection for an allocation made the allocating thread wait for all of it.
+  const bool mutator_blocked = current_gc_iteration_.GetGcCause() == kGcCauseForAlloc;
+  if (mutator_blocked) {
+    max_pause_ns = std::max(max_pause_ns, duration_ns);
+  }
+  GcGoalStats* const stats =
+      gc_type == collector::kGcTypeSticky ? &young_gc_goal_stats_ : &full_gc_goal_stats_;
+  UpdateGcGoalAverage(&stats->max_pause_ns, max_pause_ns);
+  UpdateGcGoalAverage(&stats->bytes_per_second,
+                      static_cast<uint64_t>(bytes_allocated_before_gc * (1e9 / duration_ns)));
+
+  if (gc_pause_target_ns_ != 0) {
+    // Pick the kind of collection predicted to stay within the pause target, when the throughput
+    // heuristic chose the other one.
+    const bool has_sticky_gc =
+        std::find(gc_plan_.begin(), gc_plan_.end(), collector::kGcTypeSticky) != gc_plan_.end();
+    const uint64_t young_pause_ns = young_gc_goal_stats_.max_pause_ns;
+    const uint64_t full_pause_ns = full_gc_goal_stats_.max_pause_ns;
+    if (next_gc_type_ != collector::kGcTypeSticky) {
+      if (has_sticky_gc && full_pause_ns > gc_pause_target_ns_ && young_pause_ns != 0 &&
+          young_pause_ns <= gc_pause_target_ns_ && bytes_allocated <= max_allowed_footprint_) {
+        next_gc_type_ = collector::kGcTypeSticky;
+      }
+    } else if (young_pause_ns > gc_pause_target_ns_ && full_pause_ns != 0 &&
+               full_pause_ns <= gc_pause_target_ns_) {
+      next_gc_type_ = NonStickyGcType();
+    }
+    // Blocking on a collection is the pause we can avoid by starting concurrent GCs earlier.
+    if (mutator_blocked && duration_ns > gc_pause_target_ns_) {
+      concurrent_start_margin_percent_ =
+          std::min(concurrent_start_margin_percent_ * 2, kMaxConcurrentStartMarginPercent);
+    } else {
+      concurrent_start_margin_percent_ -=
+          (concurrent_start_margin_percent_ - kMinConcurrentStartMarginPercent) / 4;
+    }
+  }
+
+  if (gc_cpu_budget_percent_ != 0 && last_gc_end_time_ns_ != 0) {
+    // Give the mutators enough headroom that the next collection runs for at most the budget:
+    // gc / (gc + mutator) <= budget, i.e. mutator >= gc * (100 - budget) / budget.
+    const uint64_t gc_start_ns = now_ns - duration_ns;
+    const uint64_t mutator_ns = gc_start_ns > last_gc_end_time_ns_
+        ? gc_start_ns - last_gc_end_time_ns_
+        : 1U;
+    const uint64_t allocated_bytes = bytes_allocated_before_gc > bytes_allocated_after_last_gc_
+        ? bytes_allocated_before_gc - bytes_allocated_after_last_gc_
+        : 0U;
+    const GcGoalStats& next_stats = next_gc_type_ == collector::kGcTypeSticky
+        ? young_gc_goal_stats_
+        : full_gc_goal_stats_;
+    const double next_duration_ns = next_stats.bytes_per_second != 0
+        ? bytes_allocated * 1e9 / next_stats.bytes_per_second
+        : static_cast<double>(duration_ns);
+    const double min_mutator_ns =
+        next_duration_ns * (100 - gc_cpu_budget_percent_) / gc_cpu_budget_percent_;
+    const double min_free_bytes = std::min(
+        static_cast<double>(allocated_bytes) / mutator_ns * min_mutator_ns,
+        static_cast<double>(GetMaxMemory()));
+    *target_size = std::max(*target_size, bytes_allocated + static_cast<uint64_t>(min_free_bytes));
+  }
+  VLOG(heap) << "Pause goals: " << gc_type << " max pause " << PrettyDuration(max_pause_ns)
+             << " next " << next_gc_type_ << " target " << PrettySize(*target_size)
+             << " concurrent start margin " << concurrent_start_margin_percent_ << "%";
+  last_gc_end_time_ns_ = now_ns;
+  bytes_allocated_after_last_gc_ = bytes_allocated;
+}
+
 void Heap::ClampGrowthLimit() {
   // Use heap bitmap lock to guard against races with BindLiveToMarkBitmap.
   ScopedObjectAccess soa(Thread::Current());
@@ -3690,6 +3931,75 @@ void Heap::ClearPendingTrim(Thread* self) {
   pending_heap_trim_ = nullptr;
 }
 
+class Heap::PageReleaseTask : public HeapTask {
+ public:
+  explicit PageReleaseTask(uint64_t delta_time) : HeapTask(NanoTime() + delta_time) { }
+  virtual void Run(Thread* self) OVERRIDE {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    const bool more = heap->ReleasePagesStep(self);
+    heap->ClearPendingPageRelease(self);
+    if (more) {
+      heap->RequestPageRelease(self, kPageReleaseInterval);
+    }
+  }
+};
+
+void Heap::ClearPendingPageRelease(Thread* self) {
+  MutexLock mu(self, *pending_task_lock_);
+  pending_page_release_ = nullptr;
+}
+
+void Heap::RequestPageRelease(Thread* self, uint64_t delta_time) {
+  if (!CanAddHeapTask(self)) {
+    return;
+  }
+  PageReleaseTask* added_task = nullptr;
+  {
+    MutexLock mu(self, *pending_task_lock_);
+    if (pending_page_release_ != nullptr) {
+      // A release is already in progress, it continues from where it is.
+      return;
+    }
+    added_task = new PageReleaseTask(delta_time);
+    pending_page_release_ = added_task;
+  }
+  task_processor_->AddTask(self, added_task);
+}
+
+class Heap::FreeUnloadedClassLoadersTask : public HeapTask {
+ public:
+  FreeUnloadedClassLoadersTask() : HeapTask(NanoTime()) { }
+  virtual void Run(Thread* self) OVERRIDE {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    // Clear the request first, class loaders unloaded while freeing get a new task.
+    heap->ClearPendingClassLoaderFree(self);
+    Runtime::Current()->GetClassLinker()->FreeUnloadedClassLoaders(self);
+  }
+};
+
+void Heap::ClearPendingClassLoaderFree(Thread* self) {
+  MutexLock mu(self, *pending_task_lock_);
+  pending_class_loader_free_ = nullptr;
+}
+
+bool Heap::RequestFreeUnloadedClassLoaders(Thread* self) {
+  if (!CanAddHeapTask(self) || !task_processor_->IsRunning()) {
+    return false;
+  }
+  FreeUnloadedClassLoadersTask* added_task = nullptr;
+  {
+    MutexLock mu(self, *pending_task_lock_);
+    if (pending_class_loader_free_ != nullptr) {
+      // The pending task frees all of the unloaded class loaders.
+      return true;
+    }
+    added_task = new FreeUnloadedClassLoadersTask();
+    pending_class_loader_free_ = added_task;
+  }
+  task_processor_->AddTask(self, added_task);
+  return true;
+}
+
 void Heap::RequestTrim(Thread* self) {
   if (!CanAddHeapTask(self)) {
     return;
@@ -4068,6 +4378,23 @@ void Heap::RemoveGcPauseListener() {
   gc_pause_listener_.StoreRelaxed(nullptr);
 }
 
+size_t Heap::ComputeTlabRefillSize(Thread* self,
+                                   uint64_t now_ns,
+                                   size_t default_size,
+                                   size_t max_size) {
+  const size_t last_refill_size = self->GetTlabRefillSize();
+  if (last_refill_size == 0) {
+    // First refill of this thread.
+    return default_size;
+  }
+  const uint64_t interval_ns = std::max<uint64_t>(now_ns - self->GetLastTlabRefillTimeNs(), 1U);
+  // The bytes the thread would allocate in a refill interval at the rate it used up the last one.
+  const uint64_t rate_size = std::min<uint64_t>(
+      self->GetLastTlabRefillBytes() * kTlabRefillIntervalNs / interval_ns, max_size);
+  // Smooth over the previous refills so that a single burst or pause doesn't swing the size.
+  return RoundUp((last_refill_size + rate_size) / 2, kObjectAlignment);
+}
+
 mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
                                        size_t alloc_size,
                                        bool grow,
@@ -4075,23 +4402,34 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
                                        size_t* usable_size,
                                        size_t* bytes_tl_bulk_allocated) {
   const AllocatorType allocator_type = GetCurrentAllocator();
+  const uint64_t now_ns = kUseAdaptiveTlabs ? NanoTime() : 0U;
   if (kUsePartialTlabs && alloc_size <= self->TlabRemainingCapacity()) {
     DCHECK_GT(alloc_size, self->TlabSize());
+    const size_t refill_size = kUseAdaptiveTlabs
+        ? ComputeTlabRefillSize(self, now_ns, kPartialTlabSize, space::RegionSpace::kRegionSize)
+        : kPartialTlabSize;
     // There is enough space if we grow the TLAB. Lets do that. This increases the
     // TLAB bytes.
     const size_t min_expand_size = alloc_size - self->TlabSize();
     const size_t expand_bytes = std::max(
         min_expand_size,
-        std::min(self->TlabRemainingCapacity() - self->TlabSize(), kPartialTlabSize));
+        std::min(self->TlabRemainingCapacity() - self->TlabSize(),
+                 std::max(refill_size, kPartialTlabSize)));
     if (UNLIKELY(IsOutOfMemoryOnAllocation(allocator_type, expand_bytes, grow))) {
       return nullptr;
     }
     *bytes_tl_bulk_allocated = expand_bytes;
     self->ExpandTlab(expand_bytes);
     DCHECK_LE(alloc_size, self->TlabSize());
+    if (kUseAdaptiveTlabs) {
+      self->RecordTlabRefill(refill_size, expand_bytes, now_ns, /*is_tlab*/ true);
+    }
   } else if (allocator_type == kAllocatorTypeTLAB) {
     DCHECK(bump_pointer_space_ != nullptr);
-    const size_t new_tlab_size = alloc_size + kDefaultTLABSize;
+    const size_t refill_size = kUseAdaptiveTlabs
+        ? ComputeTlabRefillSize(self, now_ns, kDefaultTLABSize, kMaxBumpPointerTlabSize)
+        : kDefaultTLABSize;
+    const size_t new_tlab_size = alloc_size + std::max(refill_size, kPartialTlabSize);
     if (UNLIKELY(IsOutOfMemoryOnAllocation(allocator_type, new_tlab_size, grow))) {
       return nullptr;
     }
@@ -4101,16 +4439,42 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
       return nullptr;
     }
     *bytes_tl_bulk_allocated = new_tlab_size;
+    if (kUseAdaptiveTlabs) {
+      self->RecordTlabRefill(refill_size, new_tlab_size, now_ns, /*is_tlab*/ true);
+    }
   } else {
     DCHECK(allocator_type == kAllocatorTypeRegionTLAB);
     DCHECK(region_space_ != nullptr);
-    if (space::RegionSpace::kRegionSize >= alloc_size) {
+    // The compiled code allocates in the TLABs without the instrumented entrypoints, so there are
+    // none while the allocations are instrumented.
+    const bool use_tlab =
+        !Runtime::Current()->GetInstrumentation()->AllocEntrypointsInstrumented();
+    if (space::RegionSpace::kRegionSize >= alloc_size && LIKELY(use_tlab)) {
+      const size_t refill_size = kUseAdaptiveTlabs
+          ? ComputeTlabRefillSize(self, now_ns, kPartialTlabSize, space::RegionSpace::kRegionSize)
+          : kPartialTlabSize;
+      if (kUseAdaptiveTlabs && kUsePartialTlabs && refill_size < kIdleTlabRefillSize) {
+        // The thread allocates too slowly to make use of a region of its own. Allocate from the
+        // shared region instead, the measured rate brings the TLAB back once it picks up.
+        if (UNLIKELY(IsOutOfMemoryOnAllocation(allocator_type, alloc_size, grow))) {
+          return nullptr;
+        }
+        mirror::Object* obj = region_space_->AllocNonvirtual<false>(alloc_size,
+                                                                    bytes_allocated,
+                                                                    usable_size,
+                                                                    bytes_tl_bulk_allocated);
+        if (obj != nullptr) {
+          self->RecordTlabRefill(refill_size, alloc_size, now_ns, /*is_tlab*/ false);
+          return obj;
+        }
+        // Fall back to a TLAB.
+      }
       // Non-large. Check OOME for a tlab.
       if (LIKELY(!IsOutOfMemoryOnAllocation(allocator_type,
                                             space::RegionSpace::kRegionSize,
                                             grow))) {
         const size_t new_tlab_size = kUsePartialTlabs
-            ? std::max(alloc_size, kPartialTlabSize)
+            ? std::max(alloc_size, std::max(refill_size, kPartialTlabSize))
             : gc::space::RegionSpace::kRegionSize;
         // Try to allocate a tlab.
         if (!region_space_->AllocNewTlab(self, new_tlab_size)) {
@@ -4121,6 +4485,9 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
                                                        bytes_tl_bulk_allocated);
         }
         *bytes_tl_bulk_allocated = new_tlab_size;
+        if (kUseAdaptiveTlabs) {
+          self->RecordTlabRefill(refill_size, new_tlab_size, now_ns, /*is_tlab*/ true);
+        }
         // Fall-through to using the TLAB below.
       } else {
         // Check OOME for a non-tlab allocation.
@@ -4134,7 +4501,7 @@ mirror::Object* Heap::AllocWithNewTLAB(Thread* self,
         return nullptr;
       }
     } else {
-      // Large. Check OOME.
+      // Large, or instrumented. Check OOME.
       if (LIKELY(!IsOutOfMemoryOnAllocation(allocator_type, alloc_size, grow))) {
         return region_space_->AllocNonvirtual<false>(alloc_size,
                                                      bytes_allocated,
@@ -65,7 +65,9 @@ class Object;
 namespace gc {
 
 class AllocationListener;
+class AllocationSampler;
 class AllocRecordObjectMap;
+class GcMetrics;
 class GcPauseListener;
 class ReferenceProcessor;
 class TaskProcessor;
@@ -157,6 +159,8 @@ class Heap {
 
   // How often we allow heap trimming to happen (nanoseconds).
   static constexpr uint64_t kHeapTrimWait = MsToNs(5000);
+  // How long a heap trim waits between two releases of at most its release budget (nanoseconds).
+  static constexpr uint64_t kPageReleaseInterval = MsToNs(20);
   // How long we wait after a transition request to perform a collector transition (nanoseconds).
   static constexpr uint64_t kCollectorTransitionWait = MsToNs(5000);
   // Whether the transition-wait applies or not. Zero wait will stress the
@@ -185,6 +189,12 @@ class Heap {
        bool low_memory_mode,
        size_t long_pause_threshold,
        size_t long_gc_threshold,
+       uint64_t gc_pause_target_ns,
+       uint32_t gc_cpu_budget_percent,
+       size_t alloc_sample_interval,
+       size_t heap_trim_release_budget,
+       bool numa_aware_region_space,
+       const std::string& gc_metrics_file,
        bool ignore_max_footprint,
        bool use_tlab,
        bool verify_pre_gc_heap,
@@ -195,6 +205,9 @@ class Heap {
        bool verify_post_gc_rosalloc,
        bool gc_stress_mode,
        bool measure_gc_performance,
+       bool use_generational_cc,
+       bool gc_class_histogram,
+       bool measure_gc_tlb_misses,
        bool use_homogeneous_space_compaction,
        uint64_t min_interval_homogeneous_space_compaction_by_oom);
 
@@ -726,8 +739,22 @@ class Heap {
     return zygote_space_ != nullptr;
   }
 
+  // Returns the concurrent copying collector that is currently running, or the one that ran
+  // last. With the generational mode this alternates between the full and young collectors.
   collector::ConcurrentCopying* ConcurrentCopyingCollector() {
-    return concurrent_copying_collector_;
+    return active_concurrent_copying_collector_;
+  }
+
+  bool GetUseGenerationalCC() const {
+    return use_generational_cc_;
+  }
+
+  bool IsGcClassHistogramEnabled() const {
+    return gc_class_histogram_;
+  }
+
+  bool MeasureGcTlbMisses() const {
+    return measure_gc_tlb_misses_;
   }
 
   CollectorType CurrentCollectorType() {
@@ -755,6 +782,11 @@ class Heap {
   void RequestConcurrentGC(Thread* self, GcCause cause, bool force_full)
       REQUIRES(!*pending_task_lock_);
 
+  // Request the asynchronous free of the class loaders unloaded by the last GC, see
+  // ClassLinker::CleanupClassLoaders(). Returns false if the task processor cannot run it, in
+  // which case the caller frees them.
+  bool RequestFreeUnloadedClassLoaders(Thread* self) REQUIRES(!*pending_task_lock_);
+
   // Whether or not we may use a garbage collector, used so that we only create collectors we need.
   bool MayUseCollector(CollectorType type) const;
 
@@ -770,6 +802,11 @@ class Heap {
   uint64_t GetBlockingGcTime() const;
   void DumpGcCountRateHistogram(std::ostream& os) const REQUIRES(!*gc_complete_lock_);
   void DumpBlockingGcCountRateHistogram(std::ostream& os) const REQUIRES(!*gc_complete_lock_);
+  void DumpRegionFragmentationHistogram(std::ostream& os) const;
+  // The pause percentiles of each collector which paused, one line per collector.
+  void DumpPausePercentiles(std::ostream& os) const;
+  // Per-class live instances of the last full concurrent copying collection, if enabled.
+  void DumpClassHistogram(std::ostream& os, size_t max_entries) const;
 
   // Allocation tracking support
   // Callers to this function use double-checked locking to ensure safety on allocation_records_
@@ -808,6 +845,16 @@ class Heap {
   void BroadcastForNewAllocationRecords() const
       REQUIRES(!Locks::alloc_tracker_lock_);
 
+  // Sampling allocation profiler, see AllocationSampler. Never null.
+  AllocationSampler* GetAllocationSampler() const {
+    return allocation_sampler_.get();
+  }
+
+  // The metrics of the collectors, see GcMetrics. Never null.
+  GcMetrics* GetGcMetrics() const {
+    return gc_metrics_.get();
+  }
+
   void DisableGCForShutdown() REQUIRES(!*gc_complete_lock_);
 
   // Create a new alloc space and compact default alloc space to it.
@@ -836,6 +883,8 @@ class Heap {
   class ConcurrentGCTask;
   class CollectorTransitionTask;
   class HeapTrimTask;
+  class PageReleaseTask;
+  class FreeUnloadedClassLoadersTask;
 
   // Compact source space to target space. Returns the collector used.
   collector::GarbageCollector* Compact(space::ContinuousMemMapAllocSpace* target_space,
@@ -946,6 +995,13 @@ class Heap {
                                    size_t* bytes_tl_bulk_allocated)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Returns the size of the next TLAB refill or expansion of self, estimated from the rate at
+  // which the thread used up its previous refill. Not bounded below; callers apply the minimum.
+  static size_t ComputeTlabRefillSize(Thread* self,
+                                      uint64_t now_ns,
+                                      size_t default_size,
+                                      size_t max_size);
+
   void ThrowOutOfMemoryError(Thread* self, size_t byte_count, AllocatorType allocator_type)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -1014,6 +1070,17 @@ class Heap {
   void GrowForUtilization(collector::GarbageCollector* collector_ran,
                           uint64_t bytes_allocated_before_gc = 0);
 
+  bool HasPauseGoals() const {
+    return gc_pause_target_ns_ != 0 || gc_cpu_budget_percent_ != 0;
+  }
+
+  // Records the pause and processing rate of the collection that just ran, then moves next_gc_type_
+  // and target_size towards the pause target and the GC CPU budget.
+  void AdjustForPauseGoals(collector::GcType gc_type,
+                           uint64_t bytes_allocated,
+                           uint64_t bytes_allocated_before_gc,
+                           uint64_t* target_size);
+
   size_t GetPercentFree();
 
   // Swap the allocation stack with the live stack.
@@ -1041,6 +1108,12 @@ class Heap {
 
   void ClearConcurrentGCRequest();
   void ClearPendingTrim(Thread* self) REQUIRES(!*pending_task_lock_);
+  void ClearPendingPageRelease(Thread* self) REQUIRES(!*pending_task_lock_);
+  void ClearPendingClassLoaderFree(Thread* self) REQUIRES(!*pending_task_lock_);
+  // Release the empty pages left by a heap trim in steps of heap_trim_release_budget_ bytes.
+  void RequestPageRelease(Thread* self, uint64_t delta_time) REQUIRES(!*pending_task_lock_);
+  // Returns true if there are more pages to release.
+  bool ReleasePagesStep(Thread* self) REQUIRES(!*gc_complete_lock_);
   void ClearPendingCollectorTransition(Thread* self) REQUIRES(!*pending_task_lock_);
 
   // What kind of concurrency behavior is the runtime after? Currently true for concurrent mark
@@ -1169,6 +1242,30 @@ class Heap {
   // If we get a GC longer than long GC log threshold, then we print out the GC after it finishes.
   const size_t long_gc_log_threshold_;
 
+  // Pause-goal GC policy. The longest pause a collection should impose, counting the time a
+  // mutator blocks on a collection for an allocation, and the percentage of time the GC may run.
+  // Zero disables the corresponding goal.
+  const uint64_t gc_pause_target_ns_;
+  const uint32_t gc_cpu_budget_percent_;
+
+  // Running averages of a kind of collection, used to predict the next one.
+  struct GcGoalStats {
+    uint64_t max_pause_ns = 0;
+    // Heap bytes at the start of the collection over its duration.
+    uint64_t bytes_per_second = 0;
+  };
+  GcGoalStats young_gc_goal_stats_;
+  GcGoalStats full_gc_goal_stats_;
+
+  // Scales the distance from the footprint limit at which a concurrent GC starts. Raised when a
+  // mutator blocked on a collection for longer than the pause target.
+  size_t concurrent_start_margin_percent_;
+
+  // When the previous collection finished and the bytes allocated at that point, to measure the
+  // mutator allocation rate.
+  uint64_t last_gc_end_time_ns_;
+  uint64_t bytes_allocated_after_last_gc_;
+
   // If we ignore the max footprint it lets the heap grow until it hits the heap capacity, this is
   // useful for benchmarking since it reduces time spent in GC to a low %.
   const bool ignore_max_footprint_;
@@ -1379,9 +1476,23 @@ class Heap {
   collector::SemiSpace* semi_space_collector_;
   collector::MarkCompact* mark_compact_collector_;
   collector::ConcurrentCopying* concurrent_copying_collector_;
+  // The young-generation (sticky) concurrent copying collector. Only created when
+  // use_generational_cc_ is true.
+  collector::ConcurrentCopying* young_concurrent_copying_collector_;
+  // The concurrent copying collector read barriers dispatch to. Only changed by the GC-running
+  // thread before a collection starts.
+  collector::ConcurrentCopying* active_concurrent_copying_collector_;
 
   const bool is_running_on_memory_tool_;
   const bool use_tlab_;
+  // If true, the concurrent copying collector alternates between young-generation collections,
+  // which only evacuate regions allocated since the previous GC and use the card table as a
+  // remembered set, and full collections.
+  const bool use_generational_cc_;
+  // If true, full concurrent copying collections count the live instances of each class.
+  const bool gc_class_histogram_;
+  // If true, the collectors count the data TLB misses of the GC-running thread.
+  const bool measure_gc_tlb_misses_;
 
   // Pointer to the space which becomes the new main space when we do homogeneous space compaction.
   // Use unique_ptr since the space is only added during the homogeneous compaction phase.
@@ -1411,6 +1522,12 @@ class Heap {
   // Active tasks which we can modify (change target time, desired collector type, etc..).
   CollectorTransitionTask* pending_collector_transition_ GUARDED_BY(pending_task_lock_);
   HeapTrimTask* pending_heap_trim_ GUARDED_BY(pending_task_lock_);
+  PageReleaseTask* pending_page_release_ GUARDED_BY(pending_task_lock_);
+  FreeUnloadedClassLoadersTask* pending_class_loader_free_ GUARDED_BY(pending_task_lock_);
+
+  // The most bytes of empty pages a heap trim advises at once, 0 to advise them all at once.
+  // Limits how long the trim holds the allocator locks and the mmap semaphore of the process.
+  const size_t heap_trim_release_budget_;
 
   // Whether or not we use homogeneous space compaction to avoid OOM errors.
   bool use_homogeneous_space_compaction_for_oom_;
@@ -1441,6 +1558,12 @@ class Heap {
   Atomic<bool> alloc_tracking_enabled_;
   std::unique_ptr<AllocRecordObjectMap> allocation_records_;
 
+  // Allocation sampling, checked on the slow path of TLAB and thread-local run refills.
+  std::unique_ptr<AllocationSampler> allocation_sampler_;
+
+  // The exported pause, phase and throughput metrics of each collector.
+  std::unique_ptr<GcMetrics> gc_metrics_;
+
   // GC stress related data structures.
   Mutex* backtrace_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   // Debugging variables, seen backtraces vs unique backtraces.
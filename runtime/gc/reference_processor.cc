@@ -18,6 +18,7 @@
 
 #include "base/time_utils.h"
 #include "collector/garbage_collector.h"
+#include "heap.h"
 #include "java_vm_ext.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
@@ -35,6 +36,9 @@ namespace art {
 namespace gc {
 
 static constexpr bool kAsyncReferenceQueueAdd = false;
+// If true, clear the white referents of the soft, weak and phantom reference queues with the GC
+// worker threads.
+static constexpr bool kParallelClearWhiteReferences = true;
 
 ReferenceProcessor::ReferenceProcessor()
     : collector_(nullptr),
@@ -44,7 +48,11 @@ ReferenceProcessor::ReferenceProcessor()
       weak_reference_queue_(Locks::reference_queue_weak_references_lock_),
       finalizer_reference_queue_(Locks::reference_queue_finalizer_references_lock_),
       phantom_reference_queue_(Locks::reference_queue_phantom_references_lock_),
-      cleared_references_(Locks::reference_queue_cleared_references_lock_) {
+      cleared_references_(Locks::reference_queue_cleared_references_lock_),
+      pending_finalizer_references_(0),
+      finalizer_references_enqueued_(0),
+      last_finalizer_batch_size_(0),
+      max_finalizer_batch_size_(0) {
 }
 
 void ReferenceProcessor::EnableSlowPath() {
@@ -165,8 +173,16 @@ void ReferenceProcessor::ProcessReferences(bool concurrent,
     }
   }
   // Clear all remaining soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  ClearWhiteReferences(&soft_reference_queue_,
+                       concurrent ? "ClearWhiteSoftReferences" : "(Paused)ClearWhiteSoftReferences",
+                       timings,
+                       concurrent,
+                       collector);
+  ClearWhiteReferences(&weak_reference_queue_,
+                       concurrent ? "ClearWhiteWeakReferences" : "(Paused)ClearWhiteWeakReferences",
+                       timings,
+                       concurrent,
+                       collector);
   {
     TimingLogger::ScopedTiming t2(concurrent ? "EnqueueFinalizerReferences" :
         "(Paused)EnqueueFinalizerReferences", timings);
@@ -174,17 +190,36 @@ void ReferenceProcessor::ProcessReferences(bool concurrent,
       StartPreservingReferences(self);
     }
     // Preserve all white objects with finalize methods and schedule them for finalization.
-    finalizer_reference_queue_.EnqueueFinalizerReferences(&cleared_references_, collector);
+    const size_t finalizer_batch_size =
+        finalizer_reference_queue_.EnqueueFinalizerReferences(&cleared_references_, collector);
+    pending_finalizer_references_.FetchAndAddRelaxed(finalizer_batch_size);
+    last_finalizer_batch_size_.StoreRelaxed(finalizer_batch_size);
+    if (finalizer_batch_size > max_finalizer_batch_size_.LoadRelaxed()) {
+      max_finalizer_batch_size_.StoreRelaxed(finalizer_batch_size);
+    }
     collector->ProcessMarkStack();
     if (concurrent) {
       StopPreservingReferences(self);
     }
   }
   // Clear all finalizer referent reachable soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  ClearWhiteReferences(&soft_reference_queue_,
+                       concurrent ? "ClearWhiteSoftReferences" : "(Paused)ClearWhiteSoftReferences",
+                       timings,
+                       concurrent,
+                       collector);
+  ClearWhiteReferences(&weak_reference_queue_,
+                       concurrent ? "ClearWhiteWeakReferences" : "(Paused)ClearWhiteWeakReferences",
+                       timings,
+                       concurrent,
+                       collector);
   // Clear all phantom references with white referents.
-  phantom_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  ClearWhiteReferences(&phantom_reference_queue_,
+                       concurrent ? "ClearWhitePhantomReferences" :
+                           "(Paused)ClearWhitePhantomReferences",
+                       timings,
+                       concurrent,
+                       collector);
   // At this point all reference queues other than the cleared references should be empty.
   DCHECK(soft_reference_queue_.IsEmpty());
   DCHECK(weak_reference_queue_.IsEmpty());
@@ -204,6 +239,32 @@ void ReferenceProcessor::ProcessReferences(bool concurrent,
   }
 }
 
+void ReferenceProcessor::ClearWhiteReferences(ReferenceQueue* queue,
+                                              const char* split_name,
+                                              TimingLogger* timings,
+                                              bool concurrent,
+                                              collector::GarbageCollector* collector) {
+  if (queue->IsEmpty()) {
+    return;
+  }
+  TimingLogger::ScopedTiming split(split_name, timings);
+  Heap* heap = collector->GetHeap();
+  ThreadPool* thread_pool = heap->GetThreadPool();
+  // Transaction mode records the cleared referents in the transaction log, which is not thread
+  // safe. Use less threads if we are in a background state (non jank perceptible) since we want
+  // to leave more CPU time for the foreground apps.
+  if (!kParallelClearWhiteReferences ||
+      thread_pool == nullptr ||
+      collector->IsTransactionActive() ||
+      !Runtime::Current()->InJankPerceptibleProcessState()) {
+    queue->ClearWhiteReferences(&cleared_references_, collector);
+    return;
+  }
+  const size_t thread_count =
+      (concurrent ? heap->GetConcGCThreadCount() : heap->GetParallelGCThreadCount()) + 1;
+  queue->ClearWhiteReferencesParallel(&cleared_references_, collector, thread_pool, thread_count);
+}
+
 // Process the "referent" field in a java.lang.ref.Reference.  If the referent has not yet been
 // marked, put it on the appropriate list in the heap for later processing.
 void ReferenceProcessor::DelayReferenceReferent(ObjPtr<mirror::Class> klass,
@@ -285,11 +346,23 @@ void ReferenceProcessor::EnqueueClearedReferences(Thread* self) {
         ClearedReferenceTask task(cleared_references);
         task.Run(self);
       }
+      // The whole list, finalizer references included, went out with a single
+      // ReferenceQueue.add call.
+      finalizer_references_enqueued_.FetchAndAddRelaxed(
+          pending_finalizer_references_.LoadRelaxed());
     }
     cleared_references_.Clear();
+    pending_finalizer_references_.StoreRelaxed(0);
   }
 }
 
+void ReferenceProcessor::DumpFinalizerStats(std::ostream& os) const {
+  os << "Finalizer references enqueued: " << GetFinalizerReferencesEnqueued()
+     << " last batch: " << GetLastFinalizerBatchSize()
+     << " max batch: " << GetMaxFinalizerBatchSize()
+     << " pending handoff: " << pending_finalizer_references_.LoadRelaxed() << "\n";
+}
+
 void ReferenceProcessor::ClearReferent(ObjPtr<mirror::Reference> ref) {
   Thread* self = Thread::Current();
   MutexLock mu(self, *Locks::reference_processor_lock_);
@@ -77,8 +77,32 @@ class ReferenceProcessor {
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::reference_processor_lock_);
 
+  // Finalizer statistics, used to detect bursts of objects waiting for the finalizer daemon.
+  // Number of finalizer references handed to the java.lang.ref.ReferenceQueue since startup.
+  uint64_t GetFinalizerReferencesEnqueued() const {
+    return finalizer_references_enqueued_.LoadRelaxed();
+  }
+  // Number of finalizer references found by the last reference processing.
+  size_t GetLastFinalizerBatchSize() const {
+    return last_finalizer_batch_size_.LoadRelaxed();
+  }
+  // Largest number of finalizer references found by a single reference processing.
+  size_t GetMaxFinalizerBatchSize() const {
+    return max_finalizer_batch_size_.LoadRelaxed();
+  }
+  void DumpFinalizerStats(std::ostream& os) const;
+
  private:
   bool SlowPathEnabled() REQUIRES_SHARED(Locks::mutator_lock_);
+  // Called by ProcessReferences. Clears the white referents of queue under a timing split of the
+  // given name, in parallel on the heap thread pool when there is one.
+  void ClearWhiteReferences(ReferenceQueue* queue,
+                            const char* split_name,
+                            TimingLogger* timings,
+                            bool concurrent,
+                            collector::GarbageCollector* collector)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!Locks::reference_queue_cleared_references_lock_);
   // Called by ProcessReferences.
   void DisableSlowPath(Thread* self) REQUIRES(Locks::reference_processor_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -106,6 +130,12 @@ class ReferenceProcessor {
   ReferenceQueue finalizer_reference_queue_;
   ReferenceQueue phantom_reference_queue_;
   ReferenceQueue cleared_references_;
+  // Finalizer references in cleared_references_ that have not been handed to the
+  // java.lang.ref.ReferenceQueue yet.
+  Atomic<size_t> pending_finalizer_references_;
+  Atomic<uint64_t> finalizer_references_enqueued_;
+  Atomic<size_t> last_finalizer_batch_size_;
+  Atomic<size_t> max_finalizer_batch_size_;
 
   DISALLOW_COPY_AND_ASSIGN(ReferenceProcessor);
 };
@@ -16,6 +16,8 @@
 
 #include "reference_queue.h"
 
+#include <algorithm>
+
 #include "accounting/card_table-inl.h"
 #include "collector/concurrent_copying.h"
 #include "heap.h"
@@ -23,6 +25,8 @@
 #include "mirror/object-inl.h"
 #include "mirror/reference-inl.h"
 #include "object_callbacks.h"
+#include "runtime.h"
+#include "thread-current-inl.h"
 
 namespace art {
 namespace gc {
@@ -129,30 +133,152 @@ size_t ReferenceQueue::GetLength() const {
   return count;
 }
 
+void ReferenceQueue::EnqueueQueue(ReferenceQueue* other) {
+  if (other->IsEmpty()) {
+    return;
+  }
+  if (IsEmpty()) {
+    list_ = other->list_;
+  } else {
+    // Link the tail of each cycle to the head of the other one.
+    ObjPtr<mirror::Reference> head = list_->GetPendingNext<kWithoutReadBarrier>();
+    DCHECK(head != nullptr);
+    list_->SetPendingNext(other->list_->GetPendingNext<kWithoutReadBarrier>());
+    other->list_->SetPendingNext(head);
+  }
+  other->list_ = nullptr;
+}
+
+inline void ReferenceQueue::ClearWhiteReference(ObjPtr<mirror::Reference> ref,
+                                                ReferenceQueue* cleared_references,
+                                                collector::GarbageCollector* collector) {
+  mirror::HeapReference<mirror::Object>* referent_addr = ref->GetReferentReferenceAddr();
+  // do_atomic_update is false because this happens during the reference processing phase where
+  // Reference.clear() would block.
+  if (!collector->IsNullOrMarkedHeapReference(referent_addr, /*do_atomic_update*/false)) {
+    // Referent is white, clear it.
+    if (Runtime::Current()->IsActiveTransaction()) {
+      ref->ClearReferent<true>();
+    } else {
+      ref->ClearReferent<false>();
+    }
+    cleared_references->EnqueueReference(ref);
+  }
+  // Delay disabling the read barrier until here so that the ClearReferent call above in
+  // transaction mode will trigger the read barrier.
+  DisableReadBarrierForReference(ref);
+}
+
 void ReferenceQueue::ClearWhiteReferences(ReferenceQueue* cleared_references,
                                           collector::GarbageCollector* collector) {
   while (!IsEmpty()) {
-    ObjPtr<mirror::Reference> ref = DequeuePendingReference();
-    mirror::HeapReference<mirror::Object>* referent_addr = ref->GetReferentReferenceAddr();
-    // do_atomic_update is false because this happens during the reference processing phase where
-    // Reference.clear() would block.
-    if (!collector->IsNullOrMarkedHeapReference(referent_addr, /*do_atomic_update*/false)) {
-      // Referent is white, clear it.
-      if (Runtime::Current()->IsActiveTransaction()) {
-        ref->ClearReferent<true>();
-      } else {
-        ref->ClearReferent<false>();
+    ClearWhiteReference(DequeuePendingReference(), cleared_references, collector);
+  }
+}
+
+// Clears the white referents of a detached reference list on a heap thread pool worker. The
+// workers claim fixed-size chunks of the list until it is exhausted. Cleared references are
+// collected in a local queue which is spliced into the shared cleared references queue once, so
+// that the lock is not taken per reference.
+class ReferenceQueue::ClearWhiteReferencesTask : public Task {
+ public:
+  ClearWhiteReferencesTask(ReferenceQueue* queue,
+                           const std::vector<mirror::Reference*>* refs,
+                           Atomic<size_t>* next_index,
+                           ReferenceQueue* cleared_references,
+                           collector::GarbageCollector* collector)
+      : queue_(queue),
+        refs_(refs),
+        next_index_(next_index),
+        cleared_references_(cleared_references),
+        collector_(collector) {}
+
+  // No thread safety analysis since multiple threads will use this task. The GC-running thread
+  // holds the mutator lock on behalf of the workers until it has waited for all the tasks.
+  virtual void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    ReferenceQueue cleared(nullptr);
+    const size_t num_refs = refs_->size();
+    while (true) {
+      const size_t begin =
+          next_index_->FetchAndAddSequentiallyConsistent(kClearWhiteReferencesChunkSize);
+      if (begin >= num_refs) {
+        break;
+      }
+      const size_t end = std::min(begin + kClearWhiteReferencesChunkSize, num_refs);
+      for (size_t i = begin; i < end; ++i) {
+        queue_->ClearWhiteReference((*refs_)[i], &cleared, collector_);
       }
-      cleared_references->EnqueueReference(ref);
     }
-    // Delay disabling the read barrier until here so that the ClearReferent call above in
-    // transaction mode will trigger the read barrier.
-    DisableReadBarrierForReference(ref);
+    if (!cleared.IsEmpty()) {
+      MutexLock mu(self, *cleared_references_->lock_);
+      cleared_references_->EnqueueQueue(&cleared);
+    }
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ReferenceQueue* const queue_;
+  const std::vector<mirror::Reference*>* const refs_;
+  Atomic<size_t>* const next_index_;
+  ReferenceQueue* const cleared_references_;
+  collector::GarbageCollector* const collector_;
+};
+
+void ReferenceQueue::ClearWhiteReferencesParallel(ReferenceQueue* cleared_references,
+                                                  collector::GarbageCollector* collector,
+                                                  ThreadPool* thread_pool,
+                                                  size_t thread_count) {
+  DCHECK(!Runtime::Current()->IsActiveTransaction());
+  if (thread_count <= 1 || thread_pool == nullptr || IsEmpty()) {
+    ClearWhiteReferences(cleared_references, collector);
+    return;
+  }
+  // Detach the whole list, in dequeue order. This is a single pointer chase over the references;
+  // the referent checks, which are the expensive part, are what gets split among the threads.
+  std::vector<mirror::Reference*> refs;
+  ObjPtr<mirror::Reference> ref = list_->GetPendingNext<kWithoutReadBarrier>();
+  while (true) {
+    ObjPtr<mirror::Reference> next = ref->GetPendingNext<kWithoutReadBarrier>();
+    ref->SetPendingNext(nullptr);
+    refs.push_back(ref.Ptr());
+    if (ref == list_) {
+      break;
+    }
+    ref = next;
+  }
+  list_ = nullptr;
+  Thread* self = Thread::Current();
+  const size_t num_chunks =
+      (refs.size() + kClearWhiteReferencesChunkSize - 1) / kClearWhiteReferencesChunkSize;
+  const size_t num_tasks = std::min(std::min(thread_count, thread_pool->GetThreadCount() + 1),
+                                    num_chunks);
+  Atomic<size_t> next_index(0);
+  if (num_tasks <= 1) {
+    ClearWhiteReferencesTask task(this, &refs, &next_index, cleared_references, collector);
+    task.Run(self);
+    return;
+  }
+  for (size_t i = 0; i < num_tasks; ++i) {
+    thread_pool->AddTask(self, new ClearWhiteReferencesTask(this,
+                                                            &refs,
+                                                            &next_index,
+                                                            cleared_references,
+                                                            collector));
   }
+  // The GC-running thread also runs tasks while waiting.
+  thread_pool->SetMaxActiveWorkers(num_tasks - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+  thread_pool->StopWorkers(self);
 }
 
-void ReferenceQueue::EnqueueFinalizerReferences(ReferenceQueue* cleared_references,
-                                                collector::GarbageCollector* collector) {
+size_t ReferenceQueue::EnqueueFinalizerReferences(ReferenceQueue* cleared_references,
+                                                  collector::GarbageCollector* collector) {
+  ReferenceQueue finalizable(nullptr);
+  size_t count = 0;
   while (!IsEmpty()) {
     ObjPtr<mirror::FinalizerReference> ref = DequeuePendingReference()->AsFinalizerReference();
     mirror::HeapReference<mirror::Object>* referent_addr = ref->GetReferentReferenceAddr();
@@ -168,12 +294,15 @@ void ReferenceQueue::EnqueueFinalizerReferences(ReferenceQueue* cleared_referenc
         ref->SetZombie<false>(forward_address);
         ref->ClearReferent<false>();
       }
-      cleared_references->EnqueueReference(ref);
+      finalizable.EnqueueReference(ref);
+      ++count;
     }
     // Delay disabling the read barrier until here so that the ClearReferent call above in
     // transaction mode will trigger the read barrier.
     DisableReadBarrierForReference(ref->AsReference());
   }
+  cleared_references->EnqueueQueue(&finalizable);
+  return count;
 }
 
 void ReferenceQueue::ForwardSoftReferences(MarkObjectVisitor* visitor) {
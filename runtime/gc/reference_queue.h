@@ -75,8 +75,10 @@ class ReferenceQueue {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Enqueues finalizer references with white referents.  White referents are blackened, moved to
-  // the zombie field, and the referent field is cleared.
-  void EnqueueFinalizerReferences(ReferenceQueue* cleared_references,
+  // the zombie field, and the referent field is cleared. The references are gathered in a local
+  // list which is appended to cleared_references as a single batch. Returns the number of
+  // references enqueued.
+  size_t EnqueueFinalizerReferences(ReferenceQueue* cleared_references,
                                   collector::GarbageCollector* collector)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -92,6 +94,15 @@ class ReferenceQueue {
                             collector::GarbageCollector* collector)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Same as ClearWhiteReferences, but the list is split into chunks that are processed by up to
+  // thread_count threads, the calling thread included, using thread_pool. Falls back to
+  // ClearWhiteReferences for short lists. Not for use in transaction mode.
+  void ClearWhiteReferencesParallel(ReferenceQueue* cleared_references,
+                                    collector::GarbageCollector* collector,
+                                    ThreadPool* thread_pool,
+                                    size_t thread_count)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*cleared_references->lock_);
+
   void Dump(std::ostream& os) const REQUIRES_SHARED(Locks::mutator_lock_);
   size_t GetLength() const REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -110,6 +121,22 @@ class ReferenceQueue {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
  private:
+  class ClearWhiteReferencesTask;
+
+  // Number of references a thread claims at a time in ClearWhiteReferencesParallel.
+  static constexpr size_t kClearWhiteReferencesChunkSize = 256;
+
+  // Clears the referent of a dequeued reference if it is white, in which case the reference is
+  // enqueued on cleared_references.
+  ALWAYS_INLINE void ClearWhiteReference(ObjPtr<mirror::Reference> ref,
+                                         ReferenceQueue* cleared_references,
+                                         collector::GarbageCollector* collector)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Moves all the references of other to this queue by splicing the two cycles.
+  // Not thread safe, the caller must hold lock_ if other threads may use this queue.
+  void EnqueueQueue(ReferenceQueue* other) REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Lock, used for parallel GC reference enqueuing. It allows for multiple threads simultaneously
   // calling AtomicEnqueueIfNotEnqueued.
   Mutex* const lock_;
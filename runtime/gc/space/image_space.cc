@@ -17,10 +17,12 @@
 #include "image_space.h"
 
 #include <lz4.h>
+#include <pthread.h>
 #include <sys/statvfs.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <random>
 
 #include "android-base/stringprintf.h"
@@ -41,6 +43,7 @@
 #include "gc/accounting/space_bitmap-inl.h"
 #include "image-inl.h"
 #include "image_space_fs.h"
+#include "intern_table.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/object-refvisitor-inl.h"
@@ -317,6 +320,16 @@ ImageHeader* ImageSpace::ReadImageHeader(const char* image_location,
         }
         return cache_hdr.release();
       } else if (!has_cache) {
+        // A PIC image is relocated in process rather than into the cache, the relocated image
+        // has the same checksums as the one in /system.
+        if (has_system) {
+          std::unique_ptr<ImageHeader> sys_hdr(new ImageHeader);
+          if (ReadSpecificImageHeader(system_filename.c_str(), sys_hdr.get()) &&
+              sys_hdr->IsPic() &&
+              sys_hdr->CompilePic()) {
+            return sys_hdr.release();
+          }
+        }
         *error_msg = StringPrintf("Unable to find a relocated version of image file %s",
                                   image_location);
         return nullptr;
@@ -483,6 +496,7 @@ class ImageSpaceLoader {
                                           bool is_zygote,
                                           bool is_global_cache,
                                           bool validate_oat_file,
+                                          ImageSpace::BootImageRelocation* relocation,
                                           std::string* error_msg)
       REQUIRES_SHARED(Locks::mutator_lock_) {
     // Should this be a RDWR lock? This is only a defensive measure, as at
@@ -513,17 +527,22 @@ class ImageSpaceLoader {
                 image_location,
                 validate_oat_file,
                 /* oat_file */nullptr,
+                relocation,
                 error_msg);
   }
 
+  // Loads the boot image if oat_file is null, in which case relocation must not be null, and an
+  // app image otherwise.
   static std::unique_ptr<ImageSpace> Init(const char* image_filename,
                                           const char* image_location,
                                           bool validate_oat_file,
                                           const OatFile* oat_file,
+                                          ImageSpace::BootImageRelocation* relocation,
                                           std::string* error_msg)
       REQUIRES_SHARED(Locks::mutator_lock_) {
     CHECK(image_filename != nullptr);
     CHECK(image_location != nullptr);
+    CHECK_EQ(oat_file == nullptr, relocation != nullptr);
 
     TimingLogger logger(__PRETTY_FUNCTION__, true, VLOG_IS_ON(image));
     VLOG(image) << "ImageSpace::Init entering image_filename=" << image_filename;
@@ -596,20 +615,37 @@ class ImageSpaceLoader {
 
     std::unique_ptr<MemMap> map;
 
-    // GetImageBegin is the preferred address to map the image. If we manage to map the
-    // image at the image begin, the amount of fixup work required is minimized.
+    // The secondary boot images must move with the primary one, the other images can be relocated
+    // to wherever they are mapped.
+    const bool follows_relocation = (relocation != nullptr) && (relocation->images_begin != 0u);
+    const bool can_map_anywhere = image_header->IsPic() && !follows_relocation;
+    if (follows_relocation) {
+      // A secondary image from /system cannot follow a primary image patched into the cache.
+      const uintptr_t image_begin = reinterpret_cast<uintptr_t>(image_header->GetImageBegin());
+      if (image_begin - relocation->images_begin >=
+          relocation->oat_files_begin - relocation->images_begin) {
+        *error_msg = StringPrintf("Image %s at %p is not within the primary boot image images",
+                                  image_filename,
+                                  image_header->GetImageBegin());
+        return nullptr;
+      }
+    }
+    // GetImageBegin is the preferred address to map the image, moved by the boot image relocation
+    // delta if any. If we manage to map the image at that address, the amount of fixup work
+    // required is minimized.
     // If it is pic we will retry with error_msg for the failure case. Pass a null error_msg to
     // avoid reading proc maps for a mapping failure and slowing everything down.
+    const int32_t requested_delta = (relocation != nullptr) ? relocation->delta : 0;
     map.reset(LoadImageFile(image_filename,
                             image_location,
                             *image_header,
-                            image_header->GetImageBegin(),
+                            image_header->GetImageBegin() + requested_delta,
                             file->Fd(),
                             logger,
-                            image_header->IsPic() ? nullptr : error_msg));
+                            can_map_anywhere ? nullptr : error_msg));
     // If the header specifies PIC mode, we can also map at a random low_4gb address since we can
     // relocate in-place.
-    if (map == nullptr && image_header->IsPic()) {
+    if (map == nullptr && can_map_anywhere) {
       map.reset(LoadImageFile(image_filename,
                               image_location,
                               *image_header,
@@ -641,6 +677,10 @@ class ImageSpaceLoader {
     // Loaded the map, use the image header from the file now in case we patch it with
     // RelocateInPlace.
     image_header = reinterpret_cast<ImageHeader*>(map->Begin());
+    const uintptr_t unrelocated_image_begin =
+        reinterpret_cast<uintptr_t>(image_header->GetImageBegin());
+    const uintptr_t unrelocated_oat_file_begin =
+        reinterpret_cast<uintptr_t>(image_header->GetOatFileBegin());
     const uint32_t bitmap_index = ImageSpace::bitmap_index_.FetchAndAddSequentiallyConsistent(1);
     std::string bitmap_name(StringPrintf("imagespace %s live-bitmap %u",
                                          image_filename,
@@ -670,6 +710,7 @@ class ImageSpaceLoader {
                            map->Begin(),
                            bitmap.get(),
                            oat_file,
+                           relocation,
                            error_msg)) {
         return nullptr;
       }
@@ -757,6 +798,15 @@ class ImageSpaceLoader {
           CalleeSaveType::kSaveEverythingForSuspendCheck);
     }
 
+    if (relocation != nullptr && !follows_relocation) {
+      // The primary boot image, the secondary ones are mapped and relocated like it.
+      relocation->delta =
+          static_cast<int32_t>(reinterpret_cast<uintptr_t>(space->Begin()) -
+                               unrelocated_image_begin);
+      relocation->images_begin = unrelocated_image_begin;
+      relocation->oat_files_begin = unrelocated_oat_file_begin;
+    }
+
     VLOG(image) << "ImageSpace::Init exiting " << *space.get();
     if (VLOG_IS_ON(image)) {
       logger.Dump(LOG_STREAM(INFO));
@@ -961,9 +1011,14 @@ class ImageSpaceLoader {
         // Space is not yet added to the heap, don't do a read barrier.
         mirror::Object* ref = obj->GetFieldObject<mirror::Object, kVerifyNone, kWithoutReadBarrier>(
             offset);
-        // Use SetFieldObjectWithoutWriteBarrier to avoid card marking since we are writing to the
-        // image.
-        obj->SetFieldObjectWithoutWriteBarrier<false, true, kVerifyNone>(offset, ForwardObject(ref));
+        mirror::Object* new_ref = ForwardObject(ref);
+        // Only write the references which moved, so that the pages of objects referring to null
+        // or to an image mapped at its preferred address stay clean and shared.
+        if (ref != new_ref) {
+          // Use SetFieldObjectWithoutWriteBarrier to avoid card marking since we are writing to
+          // the image.
+          obj->SetFieldObjectWithoutWriteBarrier<false, true, kVerifyNone>(offset, new_ref);
+        }
       }
     }
 
@@ -992,9 +1047,12 @@ class ImageSpaceLoader {
                     ObjPtr<mirror::Reference> ref) const
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_) {
       mirror::Object* obj = ref->GetReferent<kWithoutReadBarrier>();
-      ref->SetFieldObjectWithoutWriteBarrier<false, true, kVerifyNone>(
-          mirror::Reference::ReferentOffset(),
-          ForwardObject(obj));
+      mirror::Object* new_obj = ForwardObject(obj);
+      if (obj != new_obj) {
+        ref->SetFieldObjectWithoutWriteBarrier<false, true, kVerifyNone>(
+            mirror::Reference::ReferentOffset(),
+            new_obj);
+      }
     }
 
     void operator()(mirror::Object* obj) const
@@ -1154,11 +1212,13 @@ class ImageSpaceLoader {
   // Relocate an image space mapped at target_base which possibly used to be at a different base
   // address. Only needs a single image space, not one for both source and destination.
   // In place means modifying a single ImageSpace in place rather than relocating from one ImageSpace
-  // to another.
+  // to another. A boot image (null app_oat_file) moves with its oat file as described by
+  // relocation, an app image only moves by itself.
   static bool RelocateInPlace(ImageHeader& image_header,
                               uint8_t* target_base,
                               accounting::ContinuousSpaceBitmap* bitmap,
                               const OatFile* app_oat_file,
+                              const ImageSpace::BootImageRelocation* relocation,
                               std::string* error_msg) {
     DCHECK(error_msg != nullptr);
     if (!image_header.IsPic()) {
@@ -1170,53 +1230,84 @@ class ImageSpaceLoader {
       return false;
     }
     // Set up sections.
-    uint32_t boot_image_begin = 0;
-    uint32_t boot_image_end = 0;
-    uint32_t boot_oat_begin = 0;
-    uint32_t boot_oat_end = 0;
     const PointerSize pointer_size = image_header.GetPointerSize();
-    gc::Heap* const heap = Runtime::Current()->GetHeap();
-    heap->GetBootImagesSize(&boot_image_begin, &boot_image_end, &boot_oat_begin, &boot_oat_end);
-    if (boot_image_begin == boot_image_end) {
-      *error_msg = "Can not relocate app image without boot image space";
-      return false;
-    }
-    if (boot_oat_begin == boot_oat_end) {
-      *error_msg = "Can not relocate app image without boot oat file";
-      return false;
-    }
-    const uint32_t boot_image_size = boot_image_end - boot_image_begin;
-    const uint32_t boot_oat_size = boot_oat_end - boot_oat_begin;
-    const uint32_t image_header_boot_image_size = image_header.GetBootImageSize();
-    const uint32_t image_header_boot_oat_size = image_header.GetBootOatSize();
-    if (boot_image_size != image_header_boot_image_size) {
-      *error_msg = StringPrintf("Boot image size %" PRIu64 " does not match expected size %"
-                                    PRIu64,
-                                static_cast<uint64_t>(boot_image_size),
-                                static_cast<uint64_t>(image_header_boot_image_size));
-      return false;
-    }
-    if (boot_oat_size != image_header_boot_oat_size) {
-      *error_msg = StringPrintf("Boot oat size %" PRIu64 " does not match expected size %"
-                                    PRIu64,
-                                static_cast<uint64_t>(boot_oat_size),
-                                static_cast<uint64_t>(image_header_boot_oat_size));
-      return false;
+    const bool is_boot_image = (app_oat_file == nullptr);
+    uintptr_t boot_image_source;
+    uintptr_t boot_image_dest;
+    uintptr_t boot_image_size;
+    uintptr_t boot_oat_source;
+    uintptr_t boot_oat_dest;
+    uintptr_t boot_oat_size;
+    uintptr_t oat_data_dest;
+    if (is_boot_image) {
+      DCHECK(relocation != nullptr);
+      // All the images and oat files of the boot image move by the delta of this image. The
+      // primary image describes them with its own header, the secondary images use the ranges
+      // recorded by the primary image.
+      const uintptr_t image_begin = reinterpret_cast<uintptr_t>(image_header.GetImageBegin());
+      const uintptr_t delta = reinterpret_cast<uintptr_t>(target_base) - image_begin;
+      const bool is_primary = (relocation->images_begin == 0u);
+      const uintptr_t images_begin = is_primary ? image_begin : relocation->images_begin;
+      const uintptr_t oat_files_begin = is_primary
+          ? reinterpret_cast<uintptr_t>(image_header.GetOatFileBegin())
+          : relocation->oat_files_begin;
+      boot_image_source = images_begin;
+      boot_image_dest = images_begin + delta;
+      boot_image_size = oat_files_begin - images_begin;
+      // The code of an image is in its own oat file or in the oat files before it.
+      boot_oat_source = oat_files_begin;
+      boot_oat_dest = oat_files_begin + delta;
+      boot_oat_size = reinterpret_cast<uintptr_t>(image_header.GetOatFileEnd()) - oat_files_begin;
+      oat_data_dest = reinterpret_cast<uintptr_t>(image_header.GetOatDataBegin()) + delta;
+    } else {
+      uint32_t boot_image_begin = 0;
+      uint32_t boot_image_end = 0;
+      uint32_t boot_oat_begin = 0;
+      uint32_t boot_oat_end = 0;
+      gc::Heap* const heap = Runtime::Current()->GetHeap();
+      heap->GetBootImagesSize(&boot_image_begin, &boot_image_end, &boot_oat_begin, &boot_oat_end);
+      if (boot_image_begin == boot_image_end) {
+        *error_msg = "Can not relocate app image without boot image space";
+        return false;
+      }
+      if (boot_oat_begin == boot_oat_end) {
+        *error_msg = "Can not relocate app image without boot oat file";
+        return false;
+      }
+      const uint32_t image_header_boot_image_size = image_header.GetBootImageSize();
+      const uint32_t image_header_boot_oat_size = image_header.GetBootOatSize();
+      if (boot_image_end - boot_image_begin != image_header_boot_image_size) {
+        *error_msg = StringPrintf("Boot image size %" PRIu64 " does not match expected size %"
+                                      PRIu64,
+                                  static_cast<uint64_t>(boot_image_end - boot_image_begin),
+                                  static_cast<uint64_t>(image_header_boot_image_size));
+        return false;
+      }
+      if (boot_oat_end - boot_oat_begin != image_header_boot_oat_size) {
+        *error_msg = StringPrintf("Boot oat size %" PRIu64 " does not match expected size %"
+                                      PRIu64,
+                                  static_cast<uint64_t>(boot_oat_end - boot_oat_begin),
+                                  static_cast<uint64_t>(image_header_boot_oat_size));
+        return false;
+      }
+      boot_image_source = image_header.GetBootImageBegin();
+      boot_image_dest = boot_image_begin;
+      boot_image_size = image_header_boot_image_size;
+      boot_oat_source = image_header.GetBootOatBegin();
+      boot_oat_dest = boot_oat_begin;
+      boot_oat_size = image_header_boot_oat_size;
+      // Not necessarily in low 4GB.
+      oat_data_dest = reinterpret_cast<uintptr_t>(app_oat_file->Begin());
     }
     TimingLogger logger(__FUNCTION__, true, false);
-    RelocationRange boot_image(image_header.GetBootImageBegin(),
-                               boot_image_begin,
-                               boot_image_size);
-    RelocationRange boot_oat(image_header.GetBootOatBegin(),
-                             boot_oat_begin,
-                             boot_oat_size);
+    RelocationRange boot_image(boot_image_source, boot_image_dest, boot_image_size);
+    RelocationRange boot_oat(boot_oat_source, boot_oat_dest, boot_oat_size);
     RelocationRange app_image(reinterpret_cast<uintptr_t>(image_header.GetImageBegin()),
                               reinterpret_cast<uintptr_t>(target_base),
                               image_header.GetImageSize());
     // Use the oat data section since this is where the OatFile::Begin is.
     RelocationRange app_oat(reinterpret_cast<uintptr_t>(image_header.GetOatDataBegin()),
-                            // Not necessarily in low 4GB.
-                            reinterpret_cast<uintptr_t>(app_oat_file->Begin()),
+                            oat_data_dest,
                             image_header.GetOatDataEnd() - image_header.GetOatDataBegin());
     VLOG(image) << "App image " << app_image;
     VLOG(image) << "App oat " << app_oat;
@@ -1229,7 +1320,10 @@ class ImageSpaceLoader {
       // Nothing to fix up.
       return true;
     }
-    ScopedDebugDisallowReadBarriers sddrb(Thread::Current());
+    // The boot image is relocated while the heap is created, before the main thread is attached.
+    Thread* const self = Thread::Current();
+    DCHECK(self != nullptr || is_boot_image);
+    ScopedDebugDisallowReadBarriers sddrb(self);
     // Need to update the image to be at the target base.
     const ImageSection& objects_section = image_header.GetObjectsSection();
     uintptr_t objects_begin = reinterpret_cast<uintptr_t>(target_base + objects_section.Offset());
@@ -1251,13 +1345,19 @@ class ImageSpaceLoader {
       TimingLogger::ScopedTiming timing("Fixup classes", &logger);
       // Fixup objects may read fields in the boot image, use the mutator lock here for sanity. Though
       // its probably not required.
-      ScopedObjectAccess soa(Thread::Current());
+      std::unique_ptr<ScopedObjectAccess> soa(
+          (self != nullptr) ? new ScopedObjectAccess(self) : nullptr);
       timing.NewTiming("Fixup objects");
       bitmap->VisitMarkedRange(objects_begin, objects_end, fixup_object_visitor);
       // Fixup image roots.
       CHECK(app_image.InSource(reinterpret_cast<uintptr_t>(
           image_header.GetImageRoots<kWithoutReadBarrier>())));
-      image_header.RelocateImageObjects(app_image.Delta());
+      if (is_boot_image) {
+        // Also moves the oat file addresses, so that the oat file is opened at the new address.
+        image_header.RelocateImage(app_image.Delta());
+      } else {
+        image_header.RelocateImageObjects(app_image.Delta());
+      }
       CHECK_EQ(image_header.GetImageBegin(), target_base);
       // Fix up dex cache DexFile pointers.
       auto* dex_caches = image_header.GetImageRoot<kWithoutReadBarrier>(ImageHeader::kDexCaches)->
@@ -1358,20 +1458,37 @@ class ImageSpaceLoader {
         TimingLogger::ScopedTiming timing("Fixup conflict tables", &logger);
         image_header.VisitPackedImtConflictTables(fixup_adapter, target_base, pointer_size);
       }
-      // In the app image case, the image methods are actually in the boot image.
-      image_header.RelocateImageMethods(boot_image.Delta());
+      if (!is_boot_image) {
+        // In the app image case, the image methods are actually in the boot image.
+        image_header.RelocateImageMethods(boot_image.Delta());
+      }
       const auto& class_table_section = image_header.GetClassTableSection();
       if (class_table_section.Size() > 0u) {
         // Note that we require that ReadFromMemory does not make an internal copy of the elements.
         // This also relies on visit roots not doing any verification which could fail after we update
         // the roots to be the image addresses.
-        ScopedObjectAccess soa(Thread::Current());
-        WriterMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
+        std::unique_ptr<ScopedObjectAccess> soa(
+            (self != nullptr) ? new ScopedObjectAccess(self) : nullptr);
+        WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
         ClassTable temp_table;
         temp_table.ReadFromMemory(target_base + class_table_section.Offset());
         FixupRootVisitor root_visitor(boot_image, boot_oat, app_image, app_oat);
         temp_table.VisitRoots(root_visitor);
       }
+      const auto& interned_strings_section = image_header.GetInternedStringsSection();
+      if (interned_strings_section.Size() > 0u) {
+        // Like the class table, the interned strings are fixed up in the image without a copy.
+        TimingLogger::ScopedTiming timing("Fixup intern table", &logger);
+        InternTable::VisitRootsInMemory(
+            target_base + interned_strings_section.Offset(),
+            [&](GcRoot<mirror::String>& root) NO_THREAD_SAFETY_ANALYSIS {
+              mirror::String* ref = root.Read<kWithoutReadBarrier>();
+              mirror::String* new_ref = fixup_adapter.ForwardObject(ref);
+              if (ref != new_ref) {
+                root = GcRoot<mirror::String>(new_ref);
+              }
+            });
+      }
     }
     if (VLOG_IS_ON(image)) {
       logger.Dump(LOG_STREAM(INFO));
@@ -1428,6 +1545,83 @@ class ImageSpaceLoader {
   }
 };
 
+// The secondary components of a multi-image boot image are loaded by at most this many threads,
+// including the caller.
+static constexpr size_t kMaxBootImageLoadThreads = 4u;
+
+// Opens, maps and validates the components of a multi-image boot image after the primary one in
+// parallel. Each component has its own files and maps at its own address, so only the order in
+// which the spaces are added to the heap needs to be kept. The heap is being created, so the
+// loading threads are plain pthreads not attached to the runtime, like the calling thread.
+class SecondaryBootImageLoader {
+ public:
+  SecondaryBootImageLoader(const std::vector<std::string>& image_file_names,
+                           InstructionSet image_isa,
+                           ImageSpace::BootImageRelocation* relocation)
+      : image_file_names_(image_file_names),
+        image_isa_(image_isa),
+        relocation_(relocation),
+        next_index_(1u),
+        spaces_(image_file_names.size()),
+        error_msgs_(image_file_names.size()) {}
+
+  void Load() {
+    DCHECK_GT(image_file_names_.size(), 1u);
+    const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    // An image relocated in process reads the classes of the images before it, which must be
+    // relocated first.
+    const size_t max_threads = (relocation_->delta != 0) ? 1u : kMaxBootImageLoadThreads;
+    const size_t num_threads = std::min({image_file_names_.size() - 1u,
+                                         max_threads,
+                                         static_cast<size_t>(std::max(num_cpus, 1L))});
+    std::vector<pthread_t> threads(num_threads - 1u);
+    for (pthread_t& thread : threads) {
+      CHECK_PTHREAD_CALL(pthread_create, (&thread, nullptr, &Run, this), "boot image loader");
+    }
+    Run(this);
+    for (pthread_t thread : threads) {
+      CHECK_PTHREAD_CALL(pthread_join, (thread, nullptr), "boot image loader");
+    }
+  }
+
+  std::unique_ptr<ImageSpace> ReleaseSpace(size_t index) {
+    return std::move(spaces_[index]);
+  }
+
+  const std::string& GetErrorMsg(size_t index) const {
+    return error_msgs_[index];
+  }
+
+ private:
+  static void* Run(void* arg) NO_THREAD_SAFETY_ANALYSIS {
+    SecondaryBootImageLoader* loader = reinterpret_cast<SecondaryBootImageLoader*>(arg);
+    while (true) {
+      const size_t index = loader->next_index_.FetchAndAddRelaxed(1u);
+      if (index >= loader->image_file_names_.size()) {
+        break;
+      }
+      loader->spaces_[index] = ImageSpace::CreateBootImage(
+          loader->image_file_names_[index].c_str(),
+          loader->image_isa_,
+          /* secondary_image */ true,
+          loader->relocation_,
+          &loader->error_msgs_[index]);
+    }
+    return nullptr;
+  }
+
+  const std::vector<std::string>& image_file_names_;
+  const InstructionSet image_isa_;
+  // Only read by the loading threads, set up by the primary image.
+  ImageSpace::BootImageRelocation* const relocation_;
+  Atomic<size_t> next_index_;
+  // Written by the loading threads, read after they are joined.
+  std::vector<std::unique_ptr<ImageSpace>> spaces_;
+  std::vector<std::string> error_msgs_;
+
+  DISALLOW_COPY_AND_ASSIGN(SecondaryBootImageLoader);
+};
+
 static constexpr uint64_t kLowSpaceValue = 50 * MB;
 static constexpr uint64_t kTmpFsSentinelValue = 384 * MB;
 
@@ -1466,6 +1660,7 @@ static bool CheckSpace(const std::string& cache_filename, std::string* error_msg
 std::unique_ptr<ImageSpace> ImageSpace::CreateBootImage(const char* image_location,
                                                         const InstructionSet image_isa,
                                                         bool secondary_image,
+                                                        BootImageRelocation* relocation,
                                                         std::string* error_msg) {
   ScopedTrace trace(__FUNCTION__);
 
@@ -1536,6 +1731,7 @@ std::unique_ptr<ImageSpace> ImageSpace::CreateBootImage(const char* image_locati
                                  is_zygote,
                                  is_global_cache,
                                  /* validate_oat_file */ false,
+                                 relocation,
                                  &local_error_msg);
       if (relocated_space != nullptr) {
         return relocated_space;
@@ -1553,6 +1749,7 @@ std::unique_ptr<ImageSpace> ImageSpace::CreateBootImage(const char* image_locati
                                is_zygote,
                                is_global_cache,
                                /* validate_oat_file */ true,
+                               relocation,
                                &local_error_msg);
     if (cache_space != nullptr) {
       return cache_space;
@@ -1573,6 +1770,7 @@ std::unique_ptr<ImageSpace> ImageSpace::CreateBootImage(const char* image_locati
                                is_zygote,
                                is_global_cache,
                                /* validate_oat_file */ false,
+                               relocation,
                                &local_error_msg);
     if (system_space != nullptr) {
       return system_space;
@@ -1580,10 +1778,37 @@ std::unique_ptr<ImageSpace> ImageSpace::CreateBootImage(const char* image_locati
     error_msgs.push_back(local_error_msg);
   }
 
-  // Step 2.b: We require a relocated image. Then we must patch it. This step fails if this is a
-  //           secondary image.
+  // Step 2.b: We require a relocated image. A PIC image is relocated in process, by the delta of
+  //           the primary image for a secondary image. Otherwise we must patch it, which fails if
+  //           this is a secondary image.
   if (found_image && has_system && relocate) {
     std::string local_error_msg;
+    ImageHeader system_header;
+    if (ReadSpecificImageHeader(system_filename.c_str(), &system_header) &&
+        system_header.IsPic() &&
+        system_header.CompilePic()) {
+      if (!secondary_image && relocation->delta == 0) {
+        relocation->delta = ChooseRelocationOffsetDelta();
+      }
+      std::unique_ptr<ImageSpace> relocated_space =
+          ImageSpaceLoader::Load(image_location,
+                                 system_filename,
+                                 is_zygote,
+                                 is_global_cache,
+                                 /* validate_oat_file */ false,
+                                 relocation,
+                                 &local_error_msg);
+      if (relocated_space != nullptr) {
+        return relocated_space;
+      }
+      error_msgs.push_back(StringPrintf("Cannot relocate image %s in process: %s",
+                                        system_filename.c_str(),
+                                        local_error_msg.c_str()));
+      local_error_msg.clear();
+      if (!secondary_image) {
+        relocation->delta = 0;
+      }
+    }
     if (!Runtime::Current()->IsImageDex2OatEnabled()) {
       local_error_msg = "Patching disabled.";
     } else if (secondary_image) {
@@ -1600,6 +1825,7 @@ std::unique_ptr<ImageSpace> ImageSpace::CreateBootImage(const char* image_locati
                                    is_zygote,
                                    is_global_cache,
                                    /* validate_oat_file */ false,
+                                   relocation,
                                    &local_error_msg);
         if (patched_space != nullptr) {
           return patched_space;
@@ -1629,6 +1855,7 @@ std::unique_ptr<ImageSpace> ImageSpace::CreateBootImage(const char* image_locati
                                    is_zygote,
                                    is_global_cache,
                                    /* validate_oat_file */ false,
+                                   relocation,
                                    &local_error_msg);
         if (compiled_space != nullptr) {
           return compiled_space;
@@ -1670,21 +1897,45 @@ bool ImageSpace::LoadBootImage(const std::string& image_file_name,
     return false;
   }
 
-  // For code reuse, handle this like a work queue.
+  // The primary image names the other components, load it first.
   std::vector<std::string> image_file_names;
   image_file_names.push_back(image_file_name);
+  std::string primary_error_msg;
+  // The secondary images are mapped and relocated like the primary one.
+  BootImageRelocation relocation;
+  std::unique_ptr<space::ImageSpace> primary_space = CreateBootImage(image_file_name.c_str(),
+                                                                     image_instruction_set,
+                                                                     /* secondary_image */ false,
+                                                                     &relocation,
+                                                                     &primary_error_msg);
+  if (primary_space != nullptr) {
+    const OatFile* boot_oat_file = primary_space->GetOatFile();
+    const char* boot_classpath = (boot_oat_file != nullptr)
+        ? boot_oat_file->GetOatHeader().GetStoreValueByKey(OatHeader::kBootClassPathKey)
+        : nullptr;
+    if (boot_classpath != nullptr) {
+      ExtractMultiImageLocations(image_file_name, boot_classpath, &image_file_names);
+    }
+  }
+  std::unique_ptr<SecondaryBootImageLoader> secondary_loader;
+  if (primary_space != nullptr && image_file_names.size() > 1u) {
+    ScopedTrace trace("Load secondary boot images");
+    secondary_loader.reset(new SecondaryBootImageLoader(image_file_names,
+                                                          image_instruction_set,
+                                                          &relocation));
+    secondary_loader->Load();
+  }
 
   bool error = false;
   uint8_t* oat_file_end_tmp = *oat_file_end;
 
   for (size_t index = 0; index < image_file_names.size(); ++index) {
     std::string& image_name = image_file_names[index];
-    std::string error_msg;
-    std::unique_ptr<space::ImageSpace> boot_image_space_uptr = CreateBootImage(
-        image_name.c_str(),
-        image_instruction_set,
-        index > 0,
-        &error_msg);
+    std::unique_ptr<space::ImageSpace> boot_image_space_uptr = (index == 0u)
+        ? std::move(primary_space)
+        : secondary_loader->ReleaseSpace(index);
+    const std::string& error_msg =
+        (index == 0u) ? primary_error_msg : secondary_loader->GetErrorMsg(index);
     if (boot_image_space_uptr != nullptr) {
       space::ImageSpace* boot_image_space = boot_image_space_uptr.release();
       boot_image_spaces->push_back(boot_image_space);
@@ -1693,23 +1944,6 @@ bool ImageSpace::LoadBootImage(const std::string& image_file_name,
       uint8_t* oat_file_end_addr = boot_image_space->GetImageHeader().GetOatFileEnd();
       CHECK_GT(oat_file_end_addr, boot_image_space->End());
       oat_file_end_tmp = AlignUp(oat_file_end_addr, kPageSize);
-
-      if (index == 0) {
-        // If this was the first space, check whether there are more images to load.
-        const OatFile* boot_oat_file = boot_image_space->GetOatFile();
-        if (boot_oat_file == nullptr) {
-          continue;
-        }
-
-        const OatHeader& boot_oat_header = boot_oat_file->GetOatHeader();
-        const char* boot_classpath =
-            boot_oat_header.GetStoreValueByKey(OatHeader::kBootClassPathKey);
-        if (boot_classpath == nullptr) {
-          continue;
-        }
-
-        ExtractMultiImageLocations(image_file_name, boot_classpath, &image_file_names);
-      }
     } else {
       error = true;
       LOG(ERROR) << "Could not create image space with image file '" << image_file_name << "'. "
@@ -1762,6 +1996,7 @@ std::unique_ptr<ImageSpace> ImageSpace::CreateFromAppImage(const char* image,
                                 image,
                                 /*validate_oat_file*/false,
                                 oat_file,
+                                /*relocation*/nullptr,
                                 /*out*/error_msg);
 }
 
@@ -198,9 +198,24 @@ class ImageSpace : public MemMapSpace {
   const std::string image_location_;
 
   friend class ImageSpaceLoader;
+  friend class SecondaryBootImageLoader;
   friend class Space;
 
  private:
+  // The in-process relocation of a boot image. The images of a boot image are laid out first,
+  // followed by their oat files, and all of them move by the same delta. The primary image sets it
+  // up and the secondary images follow it.
+  struct BootImageRelocation {
+    BootImageRelocation() : delta(0), images_begin(0u), oat_files_begin(0u) {}
+
+    // The delta added to the addresses of the images and oat files.
+    int32_t delta;
+    // The unrelocated begin of the images and of the oat files, 0 until the primary image is
+    // loaded.
+    uintptr_t images_begin;
+    uintptr_t oat_files_begin;
+  };
+
   // Create a boot image space from an image file for a specified instruction
   // set. Cannot be used for future allocation or collected.
   //
@@ -209,9 +224,13 @@ class ImageSpace : public MemMapSpace {
   // creation of the alloc space. The ReleaseOatFile will later be
   // used to transfer ownership of the OatFile to the ClassLinker when
   // it is initialized.
+  //
+  // A PIC image which needs to be relocated is relocated in process, as described by relocation,
+  // rather than patched into the dalvik cache by patchoat.
   static std::unique_ptr<ImageSpace> CreateBootImage(const char* image,
                                      InstructionSet image_isa,
                                      bool secondary_image,
+                                     BootImageRelocation* relocation,
                                      std::string* error_msg)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
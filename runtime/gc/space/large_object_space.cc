@@ -39,9 +39,15 @@ namespace art {
 namespace gc {
 namespace space {
 
+// Bounds of the cache of freed LargeObjectMapSpace mappings. Larger mappings are always unmapped.
+static constexpr size_t kMaxCachedMapSize = 1 * MB;
+static constexpr size_t kMaxCachedMapsBytes = 4 * MB;
+static constexpr size_t kMaxCachedMaps = 16;
+
 class MemoryToolLargeObjectMapSpace FINAL : public LargeObjectMapSpace {
  public:
   explicit MemoryToolLargeObjectMapSpace(const std::string& name) : LargeObjectMapSpace(name) {
+    cache_freed_maps_ = false;
   }
 
   ~MemoryToolLargeObjectMapSpace() OVERRIDE {
@@ -85,6 +91,11 @@ class MemoryToolLargeObjectMapSpace FINAL : public LargeObjectMapSpace {
     return LargeObjectMapSpace::Free(self, object_with_rdz);
   }
 
+  size_t FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) OVERRIDE {
+    // Go through Free() for each object to strip the redzones.
+    return LargeObjectSpace::FreeList(self, num_ptrs, ptrs);
+  }
+
   bool Contains(const mirror::Object* obj) const OVERRIDE {
     return LargeObjectMapSpace::Contains(ObjectWithRedzone(obj));
   }
@@ -124,7 +135,14 @@ void LargeObjectSpace::CopyLiveToMarked() {
 
 LargeObjectMapSpace::LargeObjectMapSpace(const std::string& name)
     : LargeObjectSpace(name, nullptr, nullptr),
-      lock_("large object map space lock", kAllocSpaceLock) {}
+      lock_("large object map space lock", kAllocSpaceLock),
+      cache_freed_maps_(true),
+      cached_maps_bytes_(0) {}
+
+LargeObjectMapSpace::~LargeObjectMapSpace() {
+  MutexLock mu(Thread::Current(), lock_);
+  STLDeleteElements(&cached_maps_);
+}
 
 LargeObjectMapSpace* LargeObjectMapSpace::Create(const std::string& name) {
   if (Runtime::Current()->IsRunningOnMemoryTool()) {
@@ -137,12 +155,15 @@ LargeObjectMapSpace* LargeObjectMapSpace::Create(const std::string& name) {
 mirror::Object* LargeObjectMapSpace::Alloc(Thread* self, size_t num_bytes,
                                            size_t* bytes_allocated, size_t* usable_size,
                                            size_t* bytes_tl_bulk_allocated) {
-  std::string error_msg;
-  MemMap* mem_map = MemMap::MapAnonymous("large object space allocation", nullptr, num_bytes,
-                                         PROT_READ | PROT_WRITE, true, false, &error_msg);
-  if (UNLIKELY(mem_map == nullptr)) {
-    LOG(WARNING) << "Large object allocation failed: " << error_msg;
-    return nullptr;
+  MemMap* mem_map = TakeCachedMemMap(self, num_bytes);
+  if (mem_map == nullptr) {
+    std::string error_msg;
+    mem_map = MemMap::MapAnonymous("large object space allocation", nullptr, num_bytes,
+                                   PROT_READ | PROT_WRITE, true, false, &error_msg);
+    if (UNLIKELY(mem_map == nullptr)) {
+      LOG(WARNING) << "Large object allocation failed: " << error_msg;
+      return nullptr;
+    }
   }
   mirror::Object* const obj = reinterpret_cast<mirror::Object*>(mem_map->Begin());
   MutexLock mu(self, lock_);
@@ -182,8 +203,7 @@ void LargeObjectMapSpace::SetAllLargeObjectsAsZygoteObjects(Thread* self) {
   }
 }
 
-size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
-  MutexLock mu(self, lock_);
+MemMap* LargeObjectMapSpace::RemoveLargeObjectLocked(Thread* self, mirror::Object* ptr) {
   auto it = large_objects_.find(ptr);
   if (UNLIKELY(it == large_objects_.end())) {
     ScopedObjectAccess soa(self);
@@ -193,14 +213,87 @@ size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
   MemMap* mem_map = it->second.mem_map;
   const size_t map_size = mem_map->BaseSize();
   DCHECK_GE(num_bytes_allocated_, map_size);
-  size_t allocation_size = map_size;
-  num_bytes_allocated_ -= allocation_size;
+  num_bytes_allocated_ -= map_size;
   --num_objects_allocated_;
-  delete mem_map;
   large_objects_.erase(it);
+  return mem_map;
+}
+
+size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
+  MemMap* mem_map;
+  {
+    MutexLock mu(self, lock_);
+    mem_map = RemoveLargeObjectLocked(self, ptr);
+  }
+  const size_t allocation_size = mem_map->BaseSize();
+  ReleaseMemMaps(self, &mem_map, 1);
   return allocation_size;
 }
 
+size_t LargeObjectMapSpace::FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) {
+  std::vector<MemMap*> mem_maps(num_ptrs);
+  {
+    MutexLock mu(self, lock_);
+    for (size_t i = 0; i < num_ptrs; ++i) {
+      mem_maps[i] = RemoveLargeObjectLocked(self, ptrs[i]);
+    }
+  }
+  size_t total = 0;
+  for (MemMap* mem_map : mem_maps) {
+    total += mem_map->BaseSize();
+  }
+  ReleaseMemMaps(self, mem_maps.data(), num_ptrs);
+  return total;
+}
+
+void LargeObjectMapSpace::ReleaseMemMaps(Thread* self, MemMap** mem_maps, size_t num_mem_maps) {
+  std::vector<MemMap*> unmapped;
+  if (cache_freed_maps_) {
+    for (size_t i = 0; i < num_mem_maps; ++i) {
+      MemMap* mem_map = mem_maps[i];
+      if (mem_map->BaseSize() <= kMaxCachedMapSize) {
+        // Release the pages now, so that the cached mapping neither holds memory nor needs to be
+        // zeroed when it is reused.
+        mem_map->MadviseDontNeedAndZero();
+      }
+    }
+    MutexLock mu(self, lock_);
+    for (size_t i = 0; i < num_mem_maps; ++i) {
+      MemMap* mem_map = mem_maps[i];
+      if (mem_map->BaseSize() <= kMaxCachedMapSize) {
+        cached_maps_.push_back(mem_map);
+        cached_maps_bytes_ += mem_map->BaseSize();
+      } else {
+        unmapped.push_back(mem_map);
+      }
+    }
+    while (cached_maps_bytes_ > kMaxCachedMapsBytes || cached_maps_.size() > kMaxCachedMaps) {
+      MemMap* oldest = cached_maps_.front();
+      cached_maps_.pop_front();
+      cached_maps_bytes_ -= oldest->BaseSize();
+      unmapped.push_back(oldest);
+    }
+  } else {
+    unmapped.assign(mem_maps, mem_maps + num_mem_maps);
+  }
+  // Unmap outside of lock_.
+  STLDeleteElements(&unmapped);
+}
+
+MemMap* LargeObjectMapSpace::TakeCachedMemMap(Thread* self, size_t num_bytes) {
+  MutexLock mu(self, lock_);
+  // Prefer the most recently freed mapping.
+  for (auto it = cached_maps_.rbegin(); it != cached_maps_.rend(); ++it) {
+    MemMap* mem_map = *it;
+    if (mem_map->Size() == num_bytes) {
+      cached_maps_.erase(std::next(it).base());
+      cached_maps_bytes_ -= mem_map->BaseSize();
+      return mem_map;
+    }
+  }
+  return nullptr;
+}
+
 size_t LargeObjectMapSpace::AllocationSize(mirror::Object* obj, size_t* usable_size) {
   MutexLock mu(Thread::Current(), lock_);
   auto it = large_objects_.find(obj);
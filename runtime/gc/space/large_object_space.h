@@ -22,6 +22,7 @@
 #include "safe_map.h"
 #include "space.h"
 
+#include <deque>
 #include <set>
 #include <vector>
 
@@ -139,6 +140,9 @@ class LargeObjectMapSpace : public LargeObjectSpace {
                         size_t* usable_size, size_t* bytes_tl_bulk_allocated)
       REQUIRES(!lock_);
   size_t Free(Thread* self, mirror::Object* ptr) REQUIRES(!lock_);
+  // Frees a batch of objects under a single acquisition of lock_. The mappings are released or
+  // cached for reuse after lock_ is dropped.
+  size_t FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) OVERRIDE REQUIRES(!lock_);
   void Walk(DlMallocSpace::WalkCallback, void* arg) OVERRIDE REQUIRES(!lock_);
   // TODO: disabling thread safety analysis as this may be called when we already hold lock_.
   bool Contains(const mirror::Object* obj) const NO_THREAD_SAFETY_ANALYSIS;
@@ -151,15 +155,34 @@ class LargeObjectMapSpace : public LargeObjectSpace {
     bool is_zygote;
   };
   explicit LargeObjectMapSpace(const std::string& name);
-  virtual ~LargeObjectMapSpace() {}
+  virtual ~LargeObjectMapSpace();
 
   bool IsZygoteLargeObject(Thread* self, mirror::Object* obj) const OVERRIDE REQUIRES(!lock_);
   void SetAllLargeObjectsAsZygoteObjects(Thread* self) OVERRIDE REQUIRES(!lock_);
 
+  // Removes ptr from the space and returns its mapping, which the caller releases with
+  // ReleaseMemMaps() once lock_ is no longer held.
+  MemMap* RemoveLargeObjectLocked(Thread* self, mirror::Object* ptr) REQUIRES(lock_);
+
+  // Keeps the given mappings of freed objects for reuse, or unmaps them if they don't fit in the
+  // cache.
+  void ReleaseMemMaps(Thread* self, MemMap** mem_maps, size_t num_mem_maps) REQUIRES(!lock_);
+
+  // Returns a cached, zeroed mapping of exactly num_bytes, or null if there is none.
+  MemMap* TakeCachedMemMap(Thread* self, size_t num_bytes) REQUIRES(!lock_);
+
   // Used to ensure mutual exclusion when the allocation spaces data structures are being modified.
   mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   AllocationTrackingSafeMap<mirror::Object*, LargeObject, kAllocatorTagLOSMaps> large_objects_
       GUARDED_BY(lock_);
+
+  // Whether the mappings of freed objects may be reused. Disabled for memory tools so that each
+  // object keeps its own mapping.
+  bool cache_freed_maps_;
+  // Recently freed mappings, oldest first. Their pages are released but their address ranges are
+  // kept to avoid the munmap/mmap pair when a same sized object is allocated again.
+  std::deque<MemMap*> cached_maps_ GUARDED_BY(lock_);
+  size_t cached_maps_bytes_ GUARDED_BY(lock_);
 };
 
 // A continuous large object space with a free-list to handle holes.
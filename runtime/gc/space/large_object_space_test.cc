@@ -27,6 +27,8 @@ class LargeObjectSpaceTest : public SpaceTest<CommonRuntimeTest> {
  public:
   void LargeObjectTest();
 
+  void MapReuseTest();
+
   static constexpr size_t kNumThreads = 10;
   static constexpr size_t kNumIterations = 1000;
   void RaceTest();
@@ -123,6 +125,35 @@ void LargeObjectSpaceTest::LargeObjectTest() {
   }
 }
 
+void LargeObjectSpaceTest::MapReuseTest() {
+  Thread* const self = Thread::Current();
+  std::unique_ptr<LargeObjectSpace> los(space::LargeObjectMapSpace::Create("large object space"));
+  static constexpr size_t kRequestSize = 64 * KB;
+  size_t allocation_size = 0;
+  size_t bytes_tl_bulk_allocated;
+  mirror::Object* objs[2];
+  for (size_t i = 0; i < arraysize(objs); ++i) {
+    objs[i] = los->Alloc(self, kRequestSize, &allocation_size, nullptr, &bytes_tl_bulk_allocated);
+    ASSERT_TRUE(objs[i] != nullptr);
+    memset(objs[i], 0xAB, kRequestSize);
+  }
+  EXPECT_EQ(2 * allocation_size, los->FreeList(self, arraysize(objs), objs));
+  EXPECT_EQ(0U, los->GetBytesAllocated());
+  EXPECT_EQ(0U, los->GetObjectsAllocated());
+  for (size_t i = 0; i < arraysize(objs); ++i) {
+    // Reused mappings must come back zeroed.
+    mirror::Object* obj = los->Alloc(self, kRequestSize, &allocation_size, nullptr,
+                                     &bytes_tl_bulk_allocated);
+    ASSERT_TRUE(obj != nullptr);
+    ASSERT_EQ(allocation_size, los->AllocationSize(obj, nullptr));
+    for (size_t k = 0; k < kRequestSize; ++k) {
+      ASSERT_EQ(reinterpret_cast<const uint8_t*>(obj)[k], 0U);
+    }
+    los->Free(self, obj);
+  }
+  EXPECT_EQ(0U, los->GetBytesAllocated());
+}
+
 class AllocRaceTask : public Task {
  public:
   AllocRaceTask(size_t id, size_t iterations, size_t size, LargeObjectSpace* los) :
@@ -182,6 +213,10 @@ TEST_F(LargeObjectSpaceTest, RaceTest) {
   RaceTest();
 }
 
+TEST_F(LargeObjectSpaceTest, MapReuseTest) {
+  MapReuseTest();
+}
+
 }  // namespace space
 }  // namespace gc
 }  // namespace art
@@ -43,35 +43,37 @@ inline mirror::Object* RegionSpace::AllocThreadUnsafe(Thread* self, size_t num_b
 template<bool kForEvac>
 inline mirror::Object* RegionSpace::AllocNonvirtual(size_t num_bytes, size_t* bytes_allocated,
                                                     size_t* usable_size,
-                                                    size_t* bytes_tl_bulk_allocated) {
+                                                    size_t* bytes_tl_bulk_allocated,
+                                                    size_t numa_node) {
   DCHECK_ALIGNED(num_bytes, kAlignment);
+  DCHECK_LT(numa_node, num_numa_nodes_);
   mirror::Object* obj;
   if (LIKELY(num_bytes <= kRegionSize)) {
     // Non-large object.
-    obj = (kForEvac ? evac_region_ : current_region_)->Alloc(num_bytes,
-                                                             bytes_allocated,
-                                                             usable_size,
-                                                             bytes_tl_bulk_allocated);
+    obj = (kForEvac ? evac_regions_[numa_node] : current_region_)->Alloc(num_bytes,
+                                                                         bytes_allocated,
+                                                                         usable_size,
+                                                                         bytes_tl_bulk_allocated);
     if (LIKELY(obj != nullptr)) {
       return obj;
     }
     MutexLock mu(Thread::Current(), region_lock_);
     // Retry with current region since another thread may have updated it.
-    obj = (kForEvac ? evac_region_ : current_region_)->Alloc(num_bytes,
-                                                             bytes_allocated,
-                                                             usable_size,
-                                                             bytes_tl_bulk_allocated);
+    obj = (kForEvac ? evac_regions_[numa_node] : current_region_)->Alloc(num_bytes,
+                                                                         bytes_allocated,
+                                                                         usable_size,
+                                                                         bytes_tl_bulk_allocated);
     if (LIKELY(obj != nullptr)) {
       return obj;
     }
-    Region* r = AllocateRegion(kForEvac);
+    Region* r = AllocateRegion(kForEvac, kForEvac ? numa_node : CurrentNumaNode());
     if (LIKELY(r != nullptr)) {
       obj = r->Alloc(num_bytes, bytes_allocated, usable_size, bytes_tl_bulk_allocated);
       CHECK(obj != nullptr);
       // Do our allocation before setting the region, this makes sure no threads race ahead
       // and fill in the region before we allocate the object. b/63153464
       if (kForEvac) {
-        evac_region_ = r;
+        evac_regions_[numa_node] = r;
       } else {
         current_region_ = r;
       }
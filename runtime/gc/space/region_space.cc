@@ -14,12 +14,20 @@
  * limitations under the License.
  */
 
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "base/file_utils.h"
 #include "bump_pointer_space-inl.h"
 #include "bump_pointer_space.h"
 #include "gc/accounting/read_barrier_table.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace gc {
@@ -29,10 +37,27 @@ namespace space {
 // value of the region size, evaculate the region.
 static constexpr uint kEvaculateLivePercentThreshold = 75U;
 
+// Regions that survived at least this many collections are treated as old. Their live objects are
+// likely to stay live, so they are only evacuated below a lower live percent threshold.
+static constexpr uint32_t kOldRegionAge = 4U;
+static constexpr uint kEvacuateOldLivePercentThreshold = 50U;
+
+// The percent of the free region bytes that a collection may spend copying live objects out of
+// fragmented regions. Newly allocated regions are always evacuated and are charged first.
+static constexpr uint kEvacuateCopyBudgetPercent = 50U;
+
+// The width, in live percent, of a bucket of the region fragmentation histogram.
+static constexpr uint kFragmentationHistogramBucketPercent = 10U;
+
 // If we protect the cleared regions.
 // Only protect for target builds to prevent flaky test failures (b/63131961).
 static constexpr bool kProtectClearedRegions = kIsTargetBuild;
 
+// Changing the protection of a single region splits the huge page it is in.
+static bool ProtectClearedRegions() {
+  return kProtectClearedRegions && !MemMap::TransparentHugePagesEnabled();
+}
+
 MemMap* RegionSpace::CreateMemMap(const std::string& name, size_t capacity,
                                   uint8_t* requested_begin) {
   CHECK_ALIGNED(capacity, kRegionSize);
@@ -47,7 +72,9 @@ MemMap* RegionSpace::CreateMemMap(const std::string& name, size_t capacity,
                                        PROT_READ | PROT_WRITE,
                                        true,
                                        false,
-                                       &error_msg));
+                                       &error_msg,
+                                       /* use_ashmem */ true,
+                                       /* huge_pages */ true));
     if (mem_map.get() != nullptr || requested_begin == nullptr) {
       break;
     }
@@ -77,11 +104,45 @@ MemMap* RegionSpace::CreateMemMap(const std::string& name, size_t capacity,
   return mem_map.release();
 }
 
-RegionSpace* RegionSpace::Create(const std::string& name, MemMap* mem_map) {
-  return new RegionSpace(name, mem_map);
+RegionSpace* RegionSpace::Create(const std::string& name, MemMap* mem_map, bool numa_aware) {
+  return new RegionSpace(name, mem_map, numa_aware);
 }
 
-RegionSpace::RegionSpace(const std::string& name, MemMap* mem_map)
+// Returns the number of online NUMA nodes, 1 if it is unknown.
+static size_t GetNumaNodeCount() {
+  std::string online;
+  if (!ReadFileToString("/sys/devices/system/node/online", &online)) {
+    return 1u;
+  }
+  // The nodes are listed as ranges, e.g. "0" or "0-1". Only a single range starting at node 0 is
+  // supported, the regions are not split for anything else.
+  if (online.find(',') != std::string::npos || online.compare(0, 1, "0") != 0) {
+    LOG(WARNING) << "Unsupported NUMA node list " << online;
+    return 1u;
+  }
+  size_t dash = online.find('-');
+  if (dash == std::string::npos) {
+    return 1u;
+  }
+  return strtoul(online.c_str() + dash + 1, nullptr, 10) + 1u;
+}
+
+// Ask the kernel to allocate the pages of [begin, begin + size) on the given node. The policy is
+// only a preference, the kernel falls back to other nodes when the node runs out of memory.
+static void BindToNumaNode(uint8_t* begin, size_t size, size_t node) {
+#if defined(__linux__)
+  unsigned long node_mask = 1ul << node;  // NOLINT(runtime/int)
+  if (syscall(__NR_mbind, begin, size, MPOL_PREFERRED, &node_mask, sizeof(node_mask) * 8, 0)
+      != 0) {
+    PLOG(WARNING) << "Failed to bind " << reinterpret_cast<void*>(begin) << "+" << size
+                  << " to NUMA node " << node;
+  }
+#else
+  UNUSED(begin, size, node);
+#endif
+}
+
+RegionSpace::RegionSpace(const std::string& name, MemMap* mem_map, bool numa_aware)
     : ContinuousMemMapAllocSpace(name, mem_map, mem_map->Begin(), mem_map->End(), mem_map->End(),
                                  kGcRetentionPolicyAlwaysCollect),
       region_lock_("Region lock", kRegionSpaceRegionLock), time_(1U) {
@@ -92,10 +153,29 @@ RegionSpace::RegionSpace(const std::string& name, MemMap* mem_map)
   num_non_free_regions_ = 0U;
   DCHECK_GT(num_regions_, 0U);
   non_free_region_index_limit_ = 0U;
+  num_numa_nodes_ = 1u;
+  if (numa_aware) {
+    num_numa_nodes_ = std::min(GetNumaNodeCount(), static_cast<size_t>(kMaxNumaNodes));
+    num_numa_nodes_ = std::min(num_numa_nodes_, num_regions_);
+  }
+  regions_per_numa_node_ = num_regions_ / num_numa_nodes_;
   regions_.reset(new Region[num_regions_]);
   uint8_t* region_addr = mem_map->Begin();
   for (size_t i = 0; i < num_regions_; ++i, region_addr += kRegionSize) {
     regions_[i].Init(i, region_addr, region_addr + kRegionSize);
+    regions_[i].SetNumaNode(std::min(i / regions_per_numa_node_, num_numa_nodes_ - 1u));
+  }
+  if (num_numa_nodes_ > 1u) {
+    // Give each node a contiguous part of the space so that large objects, which span several
+    // regions, mostly stay on one node.
+    for (size_t node = 0; node < num_numa_nodes_; ++node) {
+      uint8_t* begin = regions_[node * regions_per_numa_node_].Begin();
+      uint8_t* end = (node + 1u == num_numa_nodes_)
+          ? Limit()
+          : regions_[(node + 1u) * regions_per_numa_node_].Begin();
+      BindToNumaNode(begin, end - begin, node);
+    }
+    LOG(INFO) << "Region space split among " << num_numa_nodes_ << " NUMA nodes";
   }
   mark_bitmap_.reset(
       accounting::ContinuousSpaceBitmap::Create("region space live bitmap", Begin(), Capacity()));
@@ -113,7 +193,7 @@ RegionSpace::RegionSpace(const std::string& name, MemMap* mem_map)
   DCHECK(!full_region_.IsFree());
   DCHECK(full_region_.IsAllocated());
   current_region_ = &full_region_;
-  evac_region_ = nullptr;
+  std::fill_n(evac_regions_, kMaxNumaNodes, nullptr);
   size_t ignored;
   DCHECK(full_region_.Alloc(kAlignment, &ignored, nullptr, &ignored) == nullptr);
 }
@@ -154,14 +234,19 @@ size_t RegionSpace::ToSpaceSize() {
   return num_regions * kRegionSize;
 }
 
-inline bool RegionSpace::Region::ShouldBeEvacuated() {
+inline bool RegionSpace::Region::ShouldBeEvacuated(EvacMode evac_mode) {
   DCHECK((IsAllocated() || IsLarge()) && IsInToSpace());
-  // if the region was allocated after the start of the
+  // if the evacuation is forced, the region was allocated after the start of the
   // previous GC or the live ratio is below threshold, evacuate
   // it.
   bool result;
-  if (is_newly_allocated_) {
+  if (UNLIKELY(evac_mode == kEvacModeForceAll)) {
     result = true;
+  } else if (is_newly_allocated_) {
+    result = true;
+  } else if (evac_mode == kEvacModeNewlyAllocated) {
+    // Young-generation collections leave old regions in place.
+    result = false;
   } else {
     bool is_live_percent_valid = live_bytes_ != static_cast<size_t>(-1);
     if (is_live_percent_valid) {
@@ -175,7 +260,8 @@ inline bool RegionSpace::Region::ShouldBeEvacuated() {
         // Side node: live_percent == 0 does not necessarily mean
         // there's no live objects due to rounding (there may be a
         // few).
-        result = live_bytes_ * 100U < kEvaculateLivePercentThreshold * bytes_allocated;
+        result = !is_evacuation_deferred_ &&
+            live_bytes_ * 100U < kEvaculateLivePercentThreshold * bytes_allocated;
       } else {
         DCHECK(IsLarge());
         result = live_bytes_ == 0U;
@@ -187,9 +273,62 @@ inline bool RegionSpace::Region::ShouldBeEvacuated() {
   return result;
 }
 
+void RegionSpace::SelectEvacuationCandidatesLocked(size_t iter_limit) {
+  struct Candidate {
+    Region* region;
+    uint64_t score;
+  };
+  std::vector<Candidate> candidates;
+  size_t newly_allocated_bytes = 0;
+  for (size_t i = 0; i < iter_limit; ++i) {
+    Region* r = &regions_[i];
+    if (!r->IsAllocated()) {
+      continue;
+    }
+    DCHECK(r->IsInToSpace());
+    const size_t bytes_allocated = RoundUp(r->BytesAllocated(), kRegionSize);
+    if (r->IsNewlyAllocated()) {
+      newly_allocated_bytes += bytes_allocated;
+      continue;
+    }
+    const size_t live_bytes = r->LiveBytes();
+    if (live_bytes == static_cast<size_t>(-1) ||
+        live_bytes * 100U >= kEvaculateLivePercentThreshold * bytes_allocated) {
+      continue;
+    }
+    const uint32_t age = r->Age(time_);
+    if (age >= kOldRegionAge &&
+        live_bytes * 100U >= kEvacuateOldLivePercentThreshold * bytes_allocated) {
+      r->SetEvacuationDeferred(true);
+      continue;
+    }
+    // Cost-benefit: the reclaimed bytes weighted by the age of the region, over the cost of
+    // reading the region and copying out its live bytes.
+    const uint64_t reclaimed = bytes_allocated - live_bytes;
+    const uint64_t score = (reclaimed << 10) * (1U + age) / (bytes_allocated + live_bytes);
+    candidates.push_back({r, score});
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+  const size_t free_bytes = (num_regions_ - num_non_free_regions_) * kRegionSize;
+  size_t budget = free_bytes / 100U * kEvacuateCopyBudgetPercent;
+  budget = budget > newly_allocated_bytes ? budget - newly_allocated_bytes : 0U;
+  size_t copied_bytes = 0;
+  for (const Candidate& candidate : candidates) {
+    const size_t live_bytes = candidate.region->LiveBytes();
+    if (copied_bytes + live_bytes > budget) {
+      candidate.region->SetEvacuationDeferred(true);
+    } else {
+      copied_bytes += live_bytes;
+    }
+  }
+}
+
 // Determine which regions to evacuate and mark them as
 // from-space. Mark the rest as unevacuated from-space.
-void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all) {
+void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table,
+                               EvacMode evac_mode,
+                               bool clear_live_bytes) {
   ++time_;
   if (kUseTableLookupReadBarrier) {
     DCHECK(rb_table->IsAllCleared());
@@ -202,6 +341,9 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
   const size_t iter_limit = kUseTableLookupReadBarrier
       ? num_regions_
       : std::min(num_regions_, non_free_region_index_limit_);
+  if (evac_mode == kEvacModeLivePercentNewlyAllocated) {
+    SelectEvacuationCandidatesLocked(iter_limit);
+  }
   for (size_t i = 0; i < iter_limit; ++i) {
     Region* r = &regions_[i];
     RegionState state = r->State();
@@ -212,12 +354,13 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
         DCHECK((state == RegionState::kRegionStateAllocated ||
                 state == RegionState::kRegionStateLarge) &&
                type == RegionType::kRegionTypeToSpace);
-        bool should_evacuate = force_evacuate_all || r->ShouldBeEvacuated();
+        bool should_evacuate = r->ShouldBeEvacuated(evac_mode);
+        r->SetEvacuationDeferred(false);
         if (should_evacuate) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
         } else {
-          r->SetAsUnevacFromSpace();
+          r->SetAsUnevacFromSpace(clear_live_bytes);
           DCHECK(r->IsInUnevacFromSpace());
         }
         if (UNLIKELY(state == RegionState::kRegionStateLarge &&
@@ -233,7 +376,7 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
         } else {
-          r->SetAsUnevacFromSpace();
+          r->SetAsUnevacFromSpace(clear_live_bytes);
           DCHECK(r->IsInUnevacFromSpace());
         }
         --num_expected_large_tails;
@@ -248,17 +391,101 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
   }
   DCHECK_EQ(num_expected_large_tails, 0U);
   current_region_ = &full_region_;
-  evac_region_ = &full_region_;
+  SetEvacRegions(&full_region_);
 }
 
 static void ZeroAndProtectRegion(uint8_t* begin, uint8_t* end) {
+  if (MemMap::TransparentHugePagesEnabled()) {
+    // Releasing part of a huge page splits it into small pages. Only release the huge pages that
+    // the block covers and zero the partial ones at its ends in place, since the rest of them may
+    // still be in use.
+    uint8_t* huge_begin = AlignUp(begin, kHugePageSize);
+    uint8_t* huge_end = AlignDown(end, kHugePageSize);
+    if (huge_begin < huge_end) {
+      std::fill(begin, huge_begin, 0);
+      ZeroAndReleasePages(huge_begin, huge_end - huge_begin);
+      std::fill(huge_end, end, 0);
+    } else {
+      std::fill(begin, end, 0);
+    }
+    return;
+  }
   ZeroAndReleasePages(begin, end - begin);
   if (kProtectClearedRegions) {
     CheckedCall(mprotect, __FUNCTION__, begin, end - begin, PROT_NONE);
   }
 }
 
-void RegionSpace::ClearFromSpace(uint64_t* cleared_bytes, uint64_t* cleared_objects) {
+// Zeroes and releases chunks of freed regions on a thread pool worker. Each worker takes the next
+// chunk from a shared index until all chunks are done.
+class ZeroAndProtectRegionsTask : public Task {
+ public:
+  ZeroAndProtectRegionsTask(const std::vector<std::pair<uint8_t*, uint8_t*>>* chunks,
+                            Atomic<size_t>* next_chunk_index)
+      : chunks_(chunks), next_chunk_index_(next_chunk_index) {}
+
+  virtual void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE {
+    while (true) {
+      const size_t index = next_chunk_index_->FetchAndAddSequentiallyConsistent(1);
+      if (index >= chunks_->size()) {
+        break;
+      }
+      ZeroAndProtectRegion((*chunks_)[index].first, (*chunks_)[index].second);
+    }
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  const std::vector<std::pair<uint8_t*, uint8_t*>>* const chunks_;
+  Atomic<size_t>* const next_chunk_index_;
+};
+
+// Zero and release the given blocks of freed regions, in parallel if thread_pool is not null and
+// there are enough pages to amortize waking up its workers.
+static void ZeroAndProtectRegions(const std::vector<std::pair<uint8_t*, uint8_t*>>& blocks,
+                                  ThreadPool* thread_pool) {
+  // Split the blocks so that the workers get balanced amounts of work while still releasing
+  // several regions per madvise call. b/62194020
+  static constexpr size_t kChunkSize = 16 * RegionSpace::kRegionSize;
+  static constexpr size_t kMinParallelBytes = 4 * kChunkSize;
+  size_t total_bytes = 0;
+  for (const std::pair<uint8_t*, uint8_t*>& block : blocks) {
+    total_bytes += block.second - block.first;
+  }
+  if (thread_pool == nullptr ||
+      thread_pool->GetThreadCount() == 0 ||
+      total_bytes < kMinParallelBytes) {
+    for (const std::pair<uint8_t*, uint8_t*>& block : blocks) {
+      ZeroAndProtectRegion(block.first, block.second);
+    }
+    return;
+  }
+  std::vector<std::pair<uint8_t*, uint8_t*>> chunks;
+  for (const std::pair<uint8_t*, uint8_t*>& block : blocks) {
+    for (uint8_t* begin = block.first; begin < block.second; begin += kChunkSize) {
+      chunks.emplace_back(begin, std::min(begin + kChunkSize, block.second));
+    }
+  }
+  Thread* self = Thread::Current();
+  Atomic<size_t> next_chunk_index(0);
+  const size_t num_workers = std::min(thread_pool->GetThreadCount(), chunks.size());
+  // One task per thread, including the calling thread which also works while waiting.
+  for (size_t i = 0; i <= num_workers; ++i) {
+    thread_pool->AddTask(self, new ZeroAndProtectRegionsTask(&chunks, &next_chunk_index));
+  }
+  thread_pool->SetMaxActiveWorkers(num_workers);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+  thread_pool->StopWorkers(self);
+}
+
+void RegionSpace::ClearFromSpace(uint64_t* cleared_bytes,
+                                 uint64_t* cleared_objects,
+                                 bool clear_bitmap,
+                                 ThreadPool* thread_pool) {
   DCHECK(cleared_bytes != nullptr);
   DCHECK(cleared_objects != nullptr);
   *cleared_bytes = 0;
@@ -269,17 +496,16 @@ void RegionSpace::ClearFromSpace(uint64_t* cleared_bytes, uint64_t* cleared_obje
 
   // Combine zeroing and releasing pages to reduce how often madvise is called. This helps
   // reduce contention on the mmap semaphore. b/62194020
-  // clear_region adds a region to the current block. If the region is not adjacent, the
-  // clear block is zeroed, released, and a new block begins.
-  uint8_t* clear_block_begin = nullptr;
-  uint8_t* clear_block_end = nullptr;
-  auto clear_region = [&clear_block_begin, &clear_block_end](Region* r) {
+  // clear_region adds a region to the current block. If the region is not adjacent, a new
+  // block begins. The blocks are zeroed and released once all the regions have been visited.
+  std::vector<std::pair<uint8_t*, uint8_t*>> clear_blocks;
+  auto clear_region = [&clear_blocks](Region* r) {
     r->Clear(/*zero_and_release_pages*/false);
-    if (clear_block_end != r->Begin()) {
-      ZeroAndProtectRegion(clear_block_begin, clear_block_end);
-      clear_block_begin = r->Begin();
+    if (clear_blocks.empty() || clear_blocks.back().second != r->Begin()) {
+      clear_blocks.emplace_back(r->Begin(), r->End());
+    } else {
+      clear_blocks.back().second = r->End();
     }
-    clear_block_end = r->End();
   };
   for (size_t i = 0; i < std::min(num_regions_, non_free_region_index_limit_); ++i) {
     Region* r = &regions_[i];
@@ -314,7 +540,7 @@ void RegionSpace::ClearFromSpace(uint64_t* cleared_bytes, uint64_t* cleared_obje
         continue;
       }
       r->SetUnevacFromSpaceAsToSpace();
-      if (r->AllAllocatedBytesAreLive()) {
+      if (clear_bitmap && r->AllAllocatedBytesAreLive()) {
         // Try to optimize the number of ClearRange calls by checking whether the next regions
         // can also be cleared.
         size_t regions_to_clear_bitmap = 1;
@@ -345,11 +571,12 @@ void RegionSpace::ClearFromSpace(uint64_t* cleared_bytes, uint64_t* cleared_obje
                                                  last_checked_region->Idx() + 1);
     }
   }
-  // Clear pages for the last block since clearing happens when a new block opens.
-  ZeroAndReleasePages(clear_block_begin, clear_block_end - clear_block_begin);
+  // The freed regions may only be handed out again once their pages are cleared, so keep holding
+  // region_lock_ while the blocks are zeroed.
+  ZeroAndProtectRegions(clear_blocks, thread_pool);
   // Update non_free_region_index_limit_.
   SetNonFreeRegionLimit(new_non_free_region_index_limit);
-  evac_region_ = nullptr;
+  SetEvacRegions(nullptr);
 }
 
 void RegionSpace::LogFragmentationAllocFailure(std::ostream& os,
@@ -403,7 +630,7 @@ void RegionSpace::Clear() {
   }
   SetNonFreeRegionLimit(0);
   current_region_ = &full_region_;
-  evac_region_ = &full_region_;
+  SetEvacRegions(&full_region_);
 }
 
 void RegionSpace::Dump(std::ostream& os) const {
@@ -440,6 +667,56 @@ void RegionSpace::DumpRegions(std::ostream& os) {
   for (size_t i = 0; i < num_regions_; ++i) {
     regions_[i].Dump(os);
   }
+  DumpFragmentationHistogramLocked(os);
+}
+
+void RegionSpace::DumpFragmentationHistogram(std::ostream& os) {
+  MutexLock mu(Thread::Current(), region_lock_);
+  DumpFragmentationHistogramLocked(os);
+}
+
+void RegionSpace::DumpFragmentationHistogramLocked(std::ostream& os) {
+  static constexpr size_t kNumBuckets = 100U / kFragmentationHistogramBucketPercent;
+  size_t bucket_regions[kNumBuckets] = {};
+  size_t bucket_wasted_bytes[kNumBuckets] = {};
+  size_t unknown_regions = 0;
+  size_t num_large_regions = 0;
+  for (size_t i = 0; i < num_regions_; ++i) {
+    Region* r = &regions_[i];
+    if (r->IsFree() || r->IsLargeTail()) {
+      continue;
+    }
+    if (r->IsLarge()) {
+      // Large regions are never partially live.
+      ++num_large_regions;
+      continue;
+    }
+    const size_t live_bytes = r->LiveBytes();
+    if (live_bytes == static_cast<size_t>(-1)) {
+      ++unknown_regions;
+      continue;
+    }
+    const size_t bytes_allocated = RoundUp(r->BytesAllocated(), kRegionSize);
+    const size_t live_percent = std::min<size_t>(live_bytes * 100U / bytes_allocated, 100U);
+    // Fully live regions go to the last bucket.
+    const size_t bucket =
+        std::min(live_percent / kFragmentationHistogramBucketPercent, kNumBuckets - 1U);
+    ++bucket_regions[bucket];
+    bucket_wasted_bytes[bucket] += bytes_allocated - std::min(live_bytes, bytes_allocated);
+  }
+  os << GetName() << " region live percent histogram: ";
+  size_t total_wasted_bytes = 0;
+  for (size_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+    if (bucket_regions[bucket] == 0) {
+      continue;
+    }
+    const size_t low = bucket * kFragmentationHistogramBucketPercent;
+    os << "[" << low << "-" << low + kFragmentationHistogramBucketPercent << "%):"
+       << bucket_regions[bucket] << " (" << PrettySize(bucket_wasted_bytes[bucket]) << ") ";
+    total_wasted_bytes += bucket_wasted_bytes[bucket];
+  }
+  os << "unknown:" << unknown_regions << " large:" << num_large_regions
+     << " reclaimable: " << PrettySize(total_wasted_bytes) << "\n";
 }
 
 void RegionSpace::DumpNonFreeRegions(std::ostream& os) {
@@ -463,7 +740,7 @@ bool RegionSpace::AllocNewTlab(Thread* self, size_t min_bytes) {
   RevokeThreadLocalBuffersLocked(self);
   // Retain sufficient free regions for full evacuation.
 
-  Region* r = AllocateRegion(/*for_evac*/ false);
+  Region* r = AllocateRegion(/*for_evac*/ false, CurrentNumaNode());
   if (r != nullptr) {
     r->is_a_tlab_ = true;
     r->thread_ = self;
@@ -532,7 +809,9 @@ void RegionSpace::Region::Dump(std::ostream& os) const {
      << " state=" << static_cast<uint>(state_) << " type=" << static_cast<uint>(type_)
      << " objects_allocated=" << objects_allocated_
      << " alloc_time=" << alloc_time_ << " live_bytes=" << live_bytes_
-     << " is_newly_allocated=" << is_newly_allocated_ << " is_a_tlab=" << is_a_tlab_ << " thread=" << thread_ << "\n";
+     << " is_newly_allocated=" << is_newly_allocated_
+     << " is_evacuation_deferred=" << is_evacuation_deferred_
+     << " is_a_tlab=" << is_a_tlab_ << " thread=" << thread_ << "\n";
 }
 
 size_t RegionSpace::AllocationSizeNonvirtual(mirror::Object* obj, size_t* usable_size) {
@@ -560,15 +839,47 @@ void RegionSpace::Region::Clear(bool zero_and_release_pages) {
     ZeroAndProtectRegion(begin_, end_);
   }
   is_newly_allocated_ = false;
+  is_evacuation_deferred_ = false;
   is_a_tlab_ = false;
   thread_ = nullptr;
 }
 
-RegionSpace::Region* RegionSpace::AllocateRegion(bool for_evac) {
+size_t RegionSpace::CurrentNumaNode() const {
+  if (num_numa_nodes_ == 1u) {
+    return 0u;
+  }
+#if defined(__linux__)
+  // Only called when a region is handed out, so the system call is cheap enough. The thread may
+  // be migrated right after but the scheduler tends to keep it on the same node.
+  unsigned cpu;
+  unsigned node;
+  if (syscall(__NR_getcpu, &cpu, &node, nullptr) == 0 && node < num_numa_nodes_) {
+    return node;
+  }
+#endif
+  return 0u;
+}
+
+RegionSpace::Region* RegionSpace::AllocateRegion(bool for_evac, size_t numa_node) {
   if (!for_evac && (num_non_free_regions_ + 1) * 2 > num_regions_) {
     return nullptr;
   }
-  for (size_t i = 0; i < num_regions_; ++i) {
+  if (num_numa_nodes_ > 1u) {
+    DCHECK_LT(numa_node, num_numa_nodes_);
+    size_t begin = numa_node * regions_per_numa_node_;
+    size_t end = (numa_node + 1u == num_numa_nodes_)
+        ? num_regions_
+        : begin + regions_per_numa_node_;
+    Region* r = AllocateRegionInRange(for_evac, begin, end);
+    if (r != nullptr) {
+      return r;
+    }
+  }
+  return AllocateRegionInRange(for_evac, 0u, num_regions_);
+}
+
+RegionSpace::Region* RegionSpace::AllocateRegionInRange(bool for_evac, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; ++i) {
     Region* r = &regions_[i];
     if (r->IsFree()) {
       r->Unfree(this, time_);
@@ -588,7 +899,7 @@ void RegionSpace::Region::MarkAsAllocated(RegionSpace* region_space, uint32_t al
   alloc_time_ = alloc_time;
   region_space->AdjustNonFreeRegionLimit(idx_);
   type_ = RegionType::kRegionTypeToSpace;
-  if (kProtectClearedRegions) {
+  if (ProtectClearedRegions()) {
     CheckedCall(mprotect, __FUNCTION__, Begin(), kRegionSize, PROT_READ | PROT_WRITE);
   }
 }
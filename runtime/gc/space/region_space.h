@@ -23,6 +23,9 @@
 #include "thread.h"
 
 namespace art {
+
+class ThreadPool;
+
 namespace gc {
 
 namespace accounting {
@@ -36,6 +39,15 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
  public:
   typedef void(*WalkCallback)(void *start, void *end, size_t num_bytes, void* callback_arg);
 
+  // The most NUMA nodes the regions are split among, the others are ignored.
+  static constexpr size_t kMaxNumaNodes = 8;
+
+  enum EvacMode {
+    kEvacModeNewlyAllocated,             // Only evacuate regions allocated since the last GC.
+    kEvacModeLivePercentNewlyAllocated,  // Also evacuate regions below the live percent threshold.
+    kEvacModeForceAll,                   // Evacuate all regions.
+  };
+
   SpaceType GetType() const OVERRIDE {
     return kSpaceTypeRegionSpace;
   }
@@ -44,7 +56,9 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   // guaranteed to be granted, if it is required, the caller should call Begin on the returned
   // space to confirm the request was granted.
   static MemMap* CreateMemMap(const std::string& name, size_t capacity, uint8_t* requested_begin);
-  static RegionSpace* Create(const std::string& name, MemMap* mem_map);
+  // If numa_aware is set, the regions are split evenly between the NUMA nodes of the machine and
+  // each part is bound to its node, see AllocateRegion().
+  static RegionSpace* Create(const std::string& name, MemMap* mem_map, bool numa_aware = false);
 
   // Allocate num_bytes, returns null if the space is full.
   mirror::Object* Alloc(Thread* self, size_t num_bytes, size_t* bytes_allocated,
@@ -54,11 +68,13 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   mirror::Object* AllocThreadUnsafe(Thread* self, size_t num_bytes, size_t* bytes_allocated,
                                     size_t* usable_size, size_t* bytes_tl_bulk_allocated)
       OVERRIDE REQUIRES(Locks::mutator_lock_) REQUIRES(!region_lock_);
-  // The main allocation routine.
+  // The main allocation routine. Evacuation allocates in a region of the given NUMA node, if
+  // there is a free one.
   template<bool kForEvac>
   ALWAYS_INLINE mirror::Object* AllocNonvirtual(size_t num_bytes, size_t* bytes_allocated,
                                                 size_t* usable_size,
-                                                size_t* bytes_tl_bulk_allocated)
+                                                size_t* bytes_tl_bulk_allocated,
+                                                size_t numa_node = 0u)
       REQUIRES(!region_lock_);
   // Allocate/free large objects (objects that are larger than the region size.)
   template<bool kForEvac>
@@ -94,6 +110,9 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   void Dump(std::ostream& os) const;
   void DumpRegions(std::ostream& os) REQUIRES(!region_lock_);
   void DumpNonFreeRegions(std::ostream& os) REQUIRES(!region_lock_);
+  // Dump a histogram of the live percent of the non-free regions, along with the bytes that an
+  // evacuation of those regions would reclaim.
+  void DumpFragmentationHistogram(std::ostream& os) REQUIRES(!region_lock_);
 
   size_t RevokeThreadLocalBuffers(Thread* thread) REQUIRES(!region_lock_);
   void RevokeThreadLocalBuffersLocked(Thread* thread) REQUIRES(region_lock_);
@@ -214,17 +233,32 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     return RegionType::kRegionTypeNone;
   }
 
-  void SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all)
+  // Determine which regions to evacuate and mark them as from-space. Mark the rest as unevacuated
+  // from-space. If clear_live_bytes is false, the unevacuated regions keep the live bytes computed
+  // by the previous collection (used by young-generation collections which do not trace them).
+  void SetFromSpace(accounting::ReadBarrierTable* rb_table,
+                    EvacMode evac_mode,
+                    bool clear_live_bytes)
       REQUIRES(!region_lock_);
 
   size_t FromSpaceSize() REQUIRES(!region_lock_);
   size_t UnevacFromSpaceSize() REQUIRES(!region_lock_);
   size_t ToSpaceSize() REQUIRES(!region_lock_);
-  void ClearFromSpace(uint64_t* cleared_bytes, uint64_t* cleared_objects) REQUIRES(!region_lock_);
+  // Free the from-space regions and turn the unevacuated regions back into to-space. If
+  // clear_bitmap is false, the mark bitmap of the surviving regions is kept so that it can be used
+  // as the live bitmap of the next young-generation collection. If thread_pool is not null, the
+  // pages of the freed regions are zeroed and released by its workers.
+  void ClearFromSpace(uint64_t* cleared_bytes,
+                      uint64_t* cleared_objects,
+                      bool clear_bitmap,
+                      ThreadPool* thread_pool = nullptr)
+      REQUIRES(!region_lock_);
 
+  // If kAtomic is true, the live bytes may be added concurrently by several GC threads.
+  template <bool kAtomic = false>
   void AddLiveBytes(mirror::Object* ref, size_t alloc_size) {
     Region* reg = RefToRegionUnlocked(ref);
-    reg->AddLiveBytes(alloc_size);
+    reg->AddLiveBytes<kAtomic>(alloc_size);
   }
 
   void AssertAllRegionLiveBytesZeroOrCleared() REQUIRES(!region_lock_) {
@@ -245,8 +279,17 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     return time_;
   }
 
+  size_t NumNumaNodes() const {
+    return num_numa_nodes_;
+  }
+
+  // The NUMA node the region of ref is bound to, 0 if the space is not NUMA aware.
+  size_t NumaNodeOf(mirror::Object* ref) {
+    return num_numa_nodes_ > 1u ? RefToRegionUnlocked(ref)->NumaNode() : 0u;
+  }
+
  private:
-  RegionSpace(const std::string& name, MemMap* mem_map);
+  RegionSpace(const std::string& name, MemMap* mem_map, bool numa_aware);
 
   template<bool kToSpaceOnly, typename Visitor>
   ALWAYS_INLINE void WalkInternal(Visitor&& visitor) NO_THREAD_SAFETY_ANALYSIS;
@@ -258,7 +301,8 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
           begin_(nullptr), top_(nullptr), end_(nullptr),
           state_(RegionState::kRegionStateAllocated), type_(RegionType::kRegionTypeToSpace),
           objects_allocated_(0), alloc_time_(0), live_bytes_(static_cast<size_t>(-1)),
-          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr) {}
+          is_newly_allocated_(false), is_evacuation_deferred_(false), is_a_tlab_(false),
+          numa_node_(0u), thread_(nullptr) {}
 
     void Init(size_t idx, uint8_t* begin, uint8_t* end) {
       idx_ = idx;
@@ -271,6 +315,7 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       alloc_time_ = 0;
       live_bytes_ = static_cast<size_t>(-1);
       is_newly_allocated_ = false;
+      is_evacuation_deferred_ = false;
       is_a_tlab_ = false;
       thread_ = nullptr;
       DCHECK_LT(begin, end);
@@ -349,6 +394,27 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       return is_newly_allocated_;
     }
 
+    size_t NumaNode() const {
+      return numa_node_;
+    }
+
+    void SetNumaNode(size_t numa_node) {
+      DCHECK_LT(numa_node, static_cast<size_t>(kMaxNumaNodes));
+      numa_node_ = static_cast<uint8_t>(numa_node);
+    }
+
+    // The number of collections this region has survived since it was allocated.
+    uint32_t Age(uint32_t time) const {
+      DCHECK_LE(alloc_time_, time);
+      return time - alloc_time_;
+    }
+
+    // Keep this otherwise evacuable region in place for the coming collection because it ranked
+    // below the copy budget. Reset by SetFromSpace() once the region has been classified.
+    void SetEvacuationDeferred(bool deferred) {
+      is_evacuation_deferred_ = deferred;
+    }
+
     bool IsInFromSpace() const {
       return type_ == RegionType::kRegionTypeFromSpace;
     }
@@ -371,10 +437,12 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       live_bytes_ = static_cast<size_t>(-1);
     }
 
-    void SetAsUnevacFromSpace() {
+    void SetAsUnevacFromSpace(bool clear_live_bytes) {
       DCHECK(!IsFree() && IsInToSpace());
       type_ = RegionType::kRegionTypeUnevacFromSpace;
-      live_bytes_ = 0U;
+      if (clear_live_bytes) {
+        live_bytes_ = 0U;
+      }
     }
 
     void SetUnevacFromSpaceAsToSpace() {
@@ -382,16 +450,22 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       type_ = RegionType::kRegionTypeToSpace;
     }
 
-    ALWAYS_INLINE bool ShouldBeEvacuated();
+    ALWAYS_INLINE bool ShouldBeEvacuated(EvacMode evac_mode);
 
+    template <bool kAtomic>
     void AddLiveBytes(size_t live_bytes) {
       DCHECK(IsInUnevacFromSpace());
       DCHECK(!IsLargeTail());
       DCHECK_NE(live_bytes_, static_cast<size_t>(-1));
       // For large allocations, we always consider all bytes in the
       // regions live.
-      live_bytes_ += IsLarge() ? Top() - begin_ : live_bytes;
-      DCHECK_LE(live_bytes_, BytesAllocated());
+      const size_t delta = IsLarge() ? Top() - begin_ : live_bytes;
+      if (kAtomic) {
+        reinterpret_cast<Atomic<size_t>*>(&live_bytes_)->FetchAndAddRelaxed(delta);
+      } else {
+        live_bytes_ += delta;
+        DCHECK_LE(live_bytes_, BytesAllocated());
+      }
     }
 
     bool AllAllocatedBytesAreLive() const {
@@ -461,7 +535,9 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     uint32_t alloc_time_;               // The allocation time of the region.
     size_t live_bytes_;                 // The live bytes. Used to compute the live percent.
     bool is_newly_allocated_;           // True if it's allocated after the last collection.
+    bool is_evacuation_deferred_;       // True if evacuation is deferred to a later collection.
     bool is_a_tlab_;                    // True if it's a tlab.
+    uint8_t numa_node_;                 // The NUMA node the region's memory is bound to.
     Thread* thread_;                    // The owning thread if it's a tlab.
 
     friend class RegionSpace;
@@ -518,13 +594,30 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     }
   }
 
-  Region* AllocateRegion(bool for_evac) REQUIRES(region_lock_);
+  // The NUMA node the calling thread runs on, 0 if the space is not NUMA aware.
+  size_t CurrentNumaNode() const;
+
+  // Prefers the free regions bound to numa_node and falls back to those of the other nodes.
+  Region* AllocateRegion(bool for_evac, size_t numa_node) REQUIRES(region_lock_);
+  Region* AllocateRegionInRange(bool for_evac, size_t begin, size_t end) REQUIRES(region_lock_);
+
+  void SetEvacRegions(Region* r) REQUIRES(region_lock_) {
+    std::fill_n(evac_regions_, kMaxNumaNodes, r);
+  }
+
+  // Rank the regions that pass the live percent threshold and defer the evacuation of those that
+  // do not fit in the copy budget derived from the free regions.
+  void SelectEvacuationCandidatesLocked(size_t iter_limit) REQUIRES(region_lock_);
+
+  void DumpFragmentationHistogramLocked(std::ostream& os) REQUIRES(region_lock_);
 
   Mutex region_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
   uint32_t time_;                  // The time as the number of collections since the startup.
   size_t num_regions_;             // The number of regions in this space.
   size_t num_non_free_regions_;    // The number of non-free regions in this space.
+  size_t num_numa_nodes_;          // The number of NUMA nodes the regions are split among.
+  size_t regions_per_numa_node_;   // The number of regions of each node, the last one has the rest.
   std::unique_ptr<Region[]> regions_ GUARDED_BY(region_lock_);
                                    // The pointer to the region array.
   // The upper-bound index of the non-free regions. Used to avoid scanning all regions in
@@ -532,7 +625,8 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   // true.
   size_t non_free_region_index_limit_ GUARDED_BY(region_lock_);
   Region* current_region_;         // The region that's being allocated currently.
-  Region* evac_region_;            // The region that's being evacuated to currently.
+  // The regions that are being evacuated to currently, one per NUMA node.
+  Region* evac_regions_[kMaxNumaNodes];
   Region full_region_;             // The dummy/sentinel region that looks full.
 
   // Mark bitmap used by the GC.
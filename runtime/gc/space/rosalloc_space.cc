@@ -243,16 +243,18 @@ size_t RosAllocSpace::FreeList(Thread* self, size_t num_ptrs, mirror::Object** p
   return bytes_freed;
 }
 
+void RosAllocSpace::TrimEnd() {
+  Thread* const self = Thread::Current();
+  // SOA required for Rosalloc::Trim() -> ArtRosAllocMoreCore() -> Heap::GetRosAllocSpace.
+  ScopedObjectAccess soa(self);
+  MutexLock mu(self, lock_);
+  // Trim to release memory at the end of the space.
+  rosalloc_->Trim();
+}
+
 size_t RosAllocSpace::Trim() {
   VLOG(heap) << "RosAllocSpace::Trim() ";
-  {
-    Thread* const self = Thread::Current();
-    // SOA required for Rosalloc::Trim() -> ArtRosAllocMoreCore() -> Heap::GetRosAllocSpace.
-    ScopedObjectAccess soa(self);
-    MutexLock mu(self, lock_);
-    // Trim to release memory at the end of the space.
-    rosalloc_->Trim();
-  }
+  TrimEnd();
   // Attempt to release pages if it does not release all empty pages.
   if (!rosalloc_->DoesReleaseAllPages()) {
     return rosalloc_->ReleasePages();
@@ -104,6 +104,9 @@ class RosAllocSpace : public MallocSpace {
   }
 
   size_t Trim() OVERRIDE;
+  // Release the free pages at the end of the space only. Trim() also releases the other empty
+  // pages, unless the allocator releases them as they are freed.
+  void TrimEnd();
   void Walk(WalkCallback callback, void* arg) OVERRIDE REQUIRES(!lock_);
   size_t GetFootprint() OVERRIDE;
   size_t GetFootprintLimit() OVERRIDE;
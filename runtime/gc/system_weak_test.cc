@@ -210,5 +210,39 @@ TEST_F(SystemWeakTest, Remove) {
   EXPECT_EQ(1U, cswh.sweep_count_);
 }
 
+// Keeps all the objects alive, and may be used by several threads.
+class KeepAllVisitor : public IsMarkedVisitor {
+ public:
+  mirror::Object* IsMarked(mirror::Object* obj) OVERRIDE {
+    return obj;
+  }
+};
+
+TEST_F(SystemWeakTest, ParallelSweep) {
+  // More holders than GC threads, so that the threads sweep several of them.
+  static constexpr size_t kNumHolders = 8u;
+  CountingSystemWeakHolder holders[kNumHolders];
+  for (CountingSystemWeakHolder& holder : holders) {
+    Runtime::Current()->AddSystemWeakHolder(&holder);
+  }
+
+  ScopedObjectAccess soa(Thread::Current());
+
+  StackHandleScope<1> hs(soa.Self());
+
+  Handle<mirror::String> s(hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "ABC")));
+  holders[kNumHolders - 1].Set(GcRoot<mirror::Object>(s.Get()));
+
+  KeepAllVisitor visitor;
+  Runtime::Current()->SweepSystemWeaks(&visitor, /* thread_count */ 4u);
+
+  // Expect each holder to have been swept exactly once, whichever thread did it.
+  for (CountingSystemWeakHolder& holder : holders) {
+    EXPECT_EQ(1U, holder.sweep_count_);
+    Runtime::Current()->RemoveSystemWeakHolder(&holder);
+  }
+  ASSERT_EQ(holders[kNumHolders - 1].Get().Read(), s.Get());
+}
+
 }  // namespace gc
 }  // namespace art
@@ -38,6 +38,10 @@ static constexpr size_t kStackAlignment = 16;
 // compile-time constant so the compiler can generate better code.
 static constexpr int kPageSize = 4096;
 
+// Size of the transparent huge pages the kernel may back anonymous memory with, i.e. the size
+// mapped by a PMD entry with 4KB pages on both x86-64 and arm64.
+static constexpr size_t kHugePageSize = 2 * MB;
+
 // Returns whether the given memory offset can be used for generating
 // an implicit null check.
 static inline bool CanDoImplicitNullCheckOn(uintptr_t offset) {
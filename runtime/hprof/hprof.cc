@@ -33,11 +33,13 @@
 #include <sys/uio.h>
 #include <time.h>
 #include <unistd.h>
+#include <zlib.h>
 
 #include <set>
 
 #include <android-base/logging.h>
 #include <android-base/stringprintf.h>
+#include <android-base/strings.h>
 
 #include "art_field-inl.h"
 #include "art_method-inl.h"
@@ -67,6 +69,10 @@
 #include "scoped_thread_state_change-inl.h"
 #include "thread_list.h"
 
+#ifdef ART_TARGET_ANDROID
+#include "cutils/properties.h"
+#endif
+
 namespace art {
 
 namespace hprof {
@@ -79,6 +85,9 @@ static constexpr uint32_t kHprofNullThread = 0;
 static constexpr size_t kMaxObjectsPerSegment = 128;
 static constexpr size_t kMaxBytesPerSegment = 4096;
 
+// Records are written to files in chunks of this size instead of one write per record.
+static constexpr size_t kFileChunkSize = 1 * MB;
+
 // The static field-name for the synthetic object generated to account for class static overhead.
 static constexpr const char* kClassOverheadName = "$classOverhead";
 
@@ -389,27 +398,90 @@ class EndianOutputBuffered : public EndianOutput {
 
 class FileEndianOutput FINAL : public EndianOutputBuffered {
  public:
-  FileEndianOutput(File* fp, size_t reserved_size)
-      : EndianOutputBuffered(reserved_size), fp_(fp), errors_(false) {
+  FileEndianOutput(File* fp, size_t reserved_size, bool compress)
+      : EndianOutputBuffered(reserved_size), fp_(fp), errors_(false), compress_(compress) {
     DCHECK(fp != nullptr);
+    chunk_.reserve(kFileChunkSize);
+    if (compress_) {
+      memset(&stream_, 0, sizeof(stream_));
+      // Adding 16 to the window bits makes zlib emit a gzip header and trailer.
+      errors_ = deflateInit2(&stream_,
+                             Z_BEST_SPEED,
+                             Z_DEFLATED,
+                             /* windowBits */ 15 + 16,
+                             /* memLevel */ 8,
+                             Z_DEFAULT_STRATEGY) != Z_OK;
+      stream_initialized_ = !errors_;
+      compressed_.resize(kFileChunkSize);
+    }
   }
   ~FileEndianOutput() {
+    if (stream_initialized_) {
+      deflateEnd(&stream_);
+    }
   }
 
-  bool Errors() {
-    return errors_;
+  // Write out the partially filled chunk and terminate the compressed stream. Must be called
+  // once all records have been emitted. Returns false if any write failed.
+  bool Finish() {
+    WriteChunk(/* finish */ true);
+    return !errors_;
   }
 
  protected:
   void HandleFlush(const uint8_t* buffer, size_t length) OVERRIDE {
-    if (!errors_) {
-      errors_ = !fp_->WriteFully(buffer, length);
+    // Records are small compared to the chunk size, so accumulate them and only write whole
+    // chunks to the file. Large records (big primitive arrays) are split over several chunks.
+    while (length != 0 && !errors_) {
+      size_t count = std::min(length, kFileChunkSize - chunk_.size());
+      chunk_.insert(chunk_.end(), buffer, buffer + count);
+      buffer += count;
+      length -= count;
+      if (chunk_.size() == kFileChunkSize) {
+        WriteChunk(/* finish */ false);
+      }
     }
   }
 
  private:
+  void WriteChunk(bool finish) {
+    if (errors_) {
+      return;
+    }
+    if (!compress_) {
+      errors_ = !fp_->WriteFully(chunk_.data(), chunk_.size());
+      chunk_.clear();
+      return;
+    }
+    stream_.next_in = chunk_.data();
+    stream_.avail_in = chunk_.size();
+    int result;
+    do {
+      stream_.next_out = compressed_.data();
+      stream_.avail_out = compressed_.size();
+      result = deflate(&stream_, finish ? Z_FINISH : Z_NO_FLUSH);
+      if (result == Z_STREAM_ERROR) {
+        errors_ = true;
+        break;
+      }
+      size_t produced = compressed_.size() - stream_.avail_out;
+      if (produced != 0 && !fp_->WriteFully(compressed_.data(), produced)) {
+        errors_ = true;
+        break;
+      }
+    } while (stream_.avail_out == 0);
+    DCHECK(errors_ || stream_.avail_in == 0u);
+    DCHECK(errors_ || !finish || result == Z_STREAM_END);
+    chunk_.clear();
+  }
+
   File* fp_;
   bool errors_;
+  const bool compress_;
+  bool stream_initialized_ = false;
+  z_stream stream_;
+  std::vector<uint8_t> chunk_;
+  std::vector<uint8_t> compressed_;
 };
 
 class NetStateEndianOutput FINAL : public EndianOutputBuffered {
@@ -437,11 +509,14 @@ class NetStateEndianOutput FINAL : public EndianOutputBuffered {
 
 class Hprof : public SingleRootVisitor {
  public:
-  Hprof(const char* output_filename, int fd, bool direct_to_ddms)
+  Hprof(const char* output_filename, int fd, bool direct_to_ddms, const HprofOptions& options)
       : filename_(output_filename),
         fd_(fd),
-        direct_to_ddms_(direct_to_ddms) {
-    LOG(INFO) << "hprof: heap dump \"" << filename_ << "\" starting...";
+        direct_to_ddms_(direct_to_ddms),
+        options_(options) {
+    LOG(INFO) << "hprof: heap dump \"" << filename_ << "\" starting..."
+              << (options_.compress && !direct_to_ddms_ ? " (compressed)" : "")
+              << (options_.skip_primitive_array_contents ? " (no primitive arrays)" : "");
   }
 
   void Dump()
@@ -781,10 +856,10 @@ class Hprof : public SingleRootVisitor {
     std::unique_ptr<File> file(new File(out_fd, filename_, true));
     bool okay;
     {
-      FileEndianOutput file_output(file.get(), max_length);
+      FileEndianOutput file_output(file.get(), max_length, options_.compress);
       output_ = &file_output;
       ProcessHeap(true);
-      okay = !file_output.Errors();
+      okay = file_output.Finish();
 
       if (okay) {
         // Check for expected size. Output is expected to be less-or-equal than first phase, see
@@ -887,6 +962,7 @@ class Hprof : public SingleRootVisitor {
   std::string filename_;
   int fd_;
   bool direct_to_ddms_;
+  const HprofOptions options_;
 
   uint64_t start_ns_ = NanoTime();
 
@@ -1454,6 +1530,11 @@ void Hprof::DumpHeapArray(mirror::Array* obj, mirror::Class* klass) {
     size_t size;
     HprofBasicType t = SignatureToBasicTypeAndSize(
         Primitive::Descriptor(klass->GetComponentType()->GetPrimitiveType()), &size);
+    if (options_.skip_primitive_array_contents) {
+      // Dump the array as empty. This is done in both passes, so the size computed by the
+      // counting pass stays an upper bound of the output.
+      length = 0;
+    }
 
     // obj is a primitive array.
     __ AddU1(HPROF_PRIMITIVE_ARRAY_DUMP);
@@ -1605,11 +1686,25 @@ void Hprof::VisitRoot(mirror::Object* obj, const RootInfo& info) {
   MarkRootObject(obj, 0, xlate[info.GetType()], info.GetThreadId());
 }
 
+HprofOptions GetHprofOptions(const char* filename) {
+  HprofOptions options;
+  options.compress = android::base::EndsWith(filename, ".gz");
+#ifdef ART_TARGET_ANDROID
+  // System properties allow enabling the cheaper dump modes without changing the callers.
+  if (property_get_bool("dalvik.vm.hprof.compress", false)) {
+    options.compress = true;
+  }
+  options.skip_primitive_array_contents =
+      property_get_bool("dalvik.vm.hprof.skipPrimitiveArrays", false);
+#endif  // ART_TARGET_ANDROID
+  return options;
+}
+
 // If "direct_to_ddms" is true, the other arguments are ignored, and data is
 // sent directly to DDMS.
 // If "fd" is >= 0, the output will be written to that file descriptor.
 // Otherwise, "filename" is used to create an output file.
-void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
+void DumpHeap(const char* filename, int fd, bool direct_to_ddms, const HprofOptions& options) {
   CHECK(filename != nullptr);
   Thread* self = Thread::Current();
   // Need to take a heap dump while GC isn't running. See the comment in Heap::VisitObjects().
@@ -1618,9 +1713,14 @@ void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
                                   gc::kGcCauseHprof,
                                   gc::kCollectorTypeHprof);
   ScopedSuspendAll ssa(__FUNCTION__, true /* long suspend */);
-  Hprof hprof(filename, fd, direct_to_ddms);
+  Hprof hprof(filename, fd, direct_to_ddms, options);
   hprof.Dump();
 }
 
+void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
+  CHECK(filename != nullptr);
+  DumpHeap(filename, fd, direct_to_ddms, GetHprofOptions(filename));
+}
+
 }  // namespace hprof
 }  // namespace art
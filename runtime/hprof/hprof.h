@@ -21,6 +21,19 @@ namespace art {
 
 namespace hprof {
 
+struct HprofOptions {
+  // Compress the file output with gzip while it is being written. Ignored for DDMS dumps.
+  bool compress = false;
+  // Dump primitive arrays (other than string values) as empty arrays. This makes the dump much
+  // smaller and faster to write, at the cost of losing the array contents and retained sizes.
+  bool skip_primitive_array_contents = false;
+};
+
+// Returns the default options for a dump to "filename": the output is compressed if the name
+// ends in ".gz", and on target the dalvik.vm.hprof.* system properties can enable either option.
+HprofOptions GetHprofOptions(const char* filename);
+
+void DumpHeap(const char* filename, int fd, bool direct_to_ddms, const HprofOptions& options);
 void DumpHeap(const char* filename, int fd, bool direct_to_ddms);
 
 }  // namespace hprof
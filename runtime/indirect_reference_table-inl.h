@@ -106,6 +106,30 @@ inline void IndirectReferenceTable::Update(IndirectRef iref, ObjPtr<mirror::Obje
   table_[idx].SetReference(obj);
 }
 
+inline IndirectRef IndirectReferenceTable::TryAddFast(IRTSegmentState previous_state,
+                                                      ObjPtr<mirror::Object> obj) {
+  const uint32_t top_index = segment_state_.top_index;
+  if (UNLIKELY(top_index == max_entries_)) {
+    return nullptr;
+  }
+  if (top_index == previous_state.top_index) {
+    // An empty segment has no holes. This is what RecoverHoles() would find.
+    current_num_holes_ = 0;
+    last_known_previous_state_ = previous_state;
+  } else if (UNLIKELY(current_num_holes_ != 0 ||
+                      last_known_previous_state_.top_index >= top_index ||
+                      last_known_previous_state_.top_index < previous_state.top_index)) {
+    // There may be holes to fill, or the segment changed since the hole count was taken.
+    return nullptr;
+  }
+  DCHECK(obj != nullptr);
+  VerifyObject(obj);
+  DCHECK(table_ != nullptr);
+  table_[top_index].Add(obj);
+  segment_state_.top_index = top_index + 1u;
+  return ToIndirectRef(top_index);
+}
+
 inline void IrtEntry::Add(ObjPtr<mirror::Object> obj) {
   ++serial_;
   if (serial_ == kIRTPrevCount) {
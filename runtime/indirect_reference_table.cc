@@ -16,6 +16,7 @@
 
 #include "indirect_reference_table-inl.h"
 
+#include "atomic.h"
 #include "base/dumpable-inl.h"
 #include "base/systrace.h"
 #include "java_vm_ext.h"
@@ -78,8 +79,8 @@ IndirectReferenceTable::IndirectReferenceTable(size_t max_count,
   CHECK_LE(max_count, kMaxTableSizeInBytes / sizeof(IrtEntry));
 
   const size_t table_bytes = max_count * sizeof(IrtEntry);
-  table_mem_map_.reset(MemMap::MapAnonymous("indirect ref table", nullptr, table_bytes,
-                                            PROT_READ | PROT_WRITE, false, false, error_msg));
+  table_mem_map_.reset(MemMap::MapAnonymousRecyclable("indirect ref table", table_bytes,
+                                                      PROT_READ | PROT_WRITE, false, error_msg));
   if (table_mem_map_.get() == nullptr && error_msg->empty()) {
     *error_msg = "Unable to map memory for indirect ref table";
   }
@@ -217,18 +218,21 @@ bool IndirectReferenceTable::Resize(size_t new_size, std::string* error_msg) {
   // Note: the above check also ensures that there is no overflow below.
 
   const size_t table_bytes = new_size * sizeof(IrtEntry);
-  std::unique_ptr<MemMap> new_map(MemMap::MapAnonymous("indirect ref table",
-                                                       nullptr,
-                                                       table_bytes,
-                                                       PROT_READ | PROT_WRITE,
-                                                       false,
-                                                       false,
-                                                       error_msg));
+  std::unique_ptr<MemMap> new_map(MemMap::MapAnonymousRecyclable("indirect ref table",
+                                                                 table_bytes,
+                                                                 PROT_READ | PROT_WRITE,
+                                                                 false,
+                                                                 error_msg));
   if (new_map == nullptr) {
     return false;
   }
 
   memcpy(new_map->Begin(), table_mem_map_->Begin(), table_mem_map_->Size());
+  if (kind_ != kLocal) {
+    // Publish the copied entries before the new table, for the readers which do not lock.
+    QuasiAtomic::ThreadFenceRelease();
+    retired_table_mem_maps_.push_back(std::move(table_mem_map_));
+  }
   table_mem_map_ = std::move(new_map);
   table_ = reinterpret_cast<IrtEntry*>(table_mem_map_->Begin());
   max_entries_ = new_size;
@@ -295,15 +299,18 @@ IndirectRef IndirectReferenceTable::Add(IRTSegmentState previous_state,
   size_t index;
   if (current_num_holes_ > 0) {
     DCHECK_GT(top_index, 1U);
-    // Find the first hole; likely to be near the end of the list.
-    IrtEntry* p_scan = &table_[top_index - 1];
-    DCHECK(!p_scan->GetReference()->IsNull());
-    --p_scan;
-    while (!p_scan->GetReference()->IsNull()) {
-      DCHECK_GE(p_scan, table_ + previous_state.top_index);
+    index = UsesFreeList(previous_state) ? TakeFreeListHole() : top_index;
+    if (index == top_index) {
+      // Find the first hole; likely to be near the end of the list.
+      IrtEntry* p_scan = &table_[top_index - 1];
+      DCHECK(!p_scan->GetReference()->IsNull());
       --p_scan;
+      while (!p_scan->GetReference()->IsNull()) {
+        DCHECK_GE(p_scan, table_ + previous_state.top_index);
+        --p_scan;
+      }
+      index = p_scan - table_;
     }
-    index = p_scan - table_;
     current_num_holes_--;
   } else {
     // Add to the end.
@@ -321,6 +328,19 @@ IndirectRef IndirectReferenceTable::Add(IRTSegmentState previous_state,
   return result;
 }
 
+size_t IndirectReferenceTable::TakeFreeListHole() {
+  const uint32_t top_index = segment_state_.top_index;
+  while (!free_list_.empty()) {
+    uint32_t index = free_list_.back();
+    free_list_.pop_back();
+    if (index < top_index && table_[index].GetReference()->IsNull()) {
+      return index;
+    }
+  }
+  // The holes were left by another segment.
+  return top_index;
+}
+
 void IndirectReferenceTable::AssertEmpty() {
   for (size_t i = 0; i < Capacity(); ++i) {
     if (!table_[i].GetReference()->IsNull()) {
@@ -410,6 +430,10 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
         current_num_holes_--;
       }
       segment_state_.top_index = collapse_top_index;
+      if (current_num_holes_ == 0u && UsesFreeList(previous_state)) {
+        // Only stale indexes are left.
+        free_list_.clear();
+      }
 
       CheckHoleCount(table_, current_num_holes_, previous_state, segment_state_);
     } else {
@@ -431,6 +455,9 @@ bool IndirectReferenceTable::Remove(IRTSegmentState previous_state, IndirectRef
 
     *table_[idx].GetReference() = GcRoot<mirror::Object>(nullptr);
     current_num_holes_++;
+    if (UsesFreeList(previous_state)) {
+      free_list_.push_back(idx);
+    }
     CheckHoleCount(table_, current_num_holes_, previous_state, segment_state_);
     if (kDebugIRT) {
       LOG(INFO) << "+++ left hole at " << idx << ", holes=" << current_num_holes_;
@@ -21,7 +21,9 @@
 
 #include <iosfwd>
 #include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <android-base/logging.h>
 
@@ -134,12 +136,13 @@ const char* GetIndirectRefKindString(const IndirectRefKind& kind);
 // detect stale references aren't possible (though we may be able to get similar benefits with other
 // approaches).
 //
-// TODO: consider a "lastDeleteIndex" for quick hole-filling when an add immediately follows a
-// delete; must invalidate after segment pop might be worth only using it for JNI globals.
+// Global and weak global tables only use their first segment and may have many holes, so the
+// holes of the first segment of these tables are also kept in a free list, and filled without
+// hunting. The free list is not updated when holes are eaten by the removal of the top-most
+// entry; its stale indexes are skipped when they are popped.
 //
-// TODO: may want completely different add/remove algorithms for global and local refs to improve
-// performance.  A large circular buffer might reduce the amortized cost of adding global
-// references.
+// Global and weak global references are read without a lock, so when such a table is resized,
+// the previous backing tables are kept mapped, as a racing reader may still be using them.
 
 // The state of the current segment. We only store the index. Splitting it for index and hole
 // count restricts the range too much.
@@ -252,6 +255,12 @@ class IndirectReferenceTable {
                   std::string* error_msg)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Add a new entry at the top in the common case of a segment which is known to have no holes
+  // and a table with room left, such as the first local reference of a native call. Returns null
+  // in the other cases, which are left to Add().
+  IndirectRef TryAddFast(IRTSegmentState previous_state, ObjPtr<mirror::Object> obj)
+      REQUIRES_SHARED(Locks::mutator_lock_) ALWAYS_INLINE;
+
   // Given an IndirectRef in the table, return the Object it refers to.
   //
   // This function may abort under error conditions.
@@ -383,6 +392,13 @@ class IndirectReferenceTable {
   // Resize the backing table. Currently must be larger than the current size.
   bool Resize(size_t new_size, std::string* error_msg);
 
+  bool UsesFreeList(IRTSegmentState previous_state) const {
+    return kind_ != kLocal && previous_state.top_index == kIRTFirstSegment.top_index;
+  }
+
+  // Returns the index of a hole from the free list, or the top index if it has none.
+  size_t TakeFreeListHole();
+
   void RecoverHoles(IRTSegmentState from);
 
   // Abort if check_jni is not enabled. Otherwise, just log as an error.
@@ -408,10 +424,16 @@ class IndirectReferenceTable {
 
   // Some values to retain old behavior with holes. Description of the algorithm is in the .cc
   // file.
-  // TODO: Consider other data structures for compact tables, e.g., free lists.
   size_t current_num_holes_;
   IRTSegmentState last_known_previous_state_;
 
+  // For global and weak global tables, the indexes of the holes of the first segment, and maybe
+  // of slots which are no longer holes. See the description of the table above.
+  std::vector<uint32_t> free_list_;
+
+  // For global and weak global tables, the backing tables replaced by a resize.
+  std::vector<std::unique_ptr<MemMap>> retired_table_mem_maps_;
+
   // Whether the table's capacity may be resized. As there are no locks used, it is the caller's
   // responsibility to ensure thread-safety.
   ResizableCapacity resizable_;
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "indirect_reference_table-inl.h"
+
+#include "class_linker-inl.h"
+#include "common_runtime_benchmark.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/object-inl.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+class IndirectReferenceTableBenchmark : public CommonRuntimeBenchmark {
+ protected:
+  static constexpr size_t kTableMax = 512u;
+  static constexpr size_t kOps = 100000u;
+};
+
+// Adds and removes the top local reference, as a native method creating a local reference.
+TEST_F(IndirectReferenceTableBenchmark, AddRemove) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::string error_msg;
+  IndirectReferenceTable irt(kTableMax,
+                             kLocal,
+                             IndirectReferenceTable::ResizableCapacity::kNo,
+                             &error_msg);
+  ASSERT_TRUE(irt.IsValid()) << error_msg;
+  ObjPtr<mirror::Class> c = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::Object> obj = hs.NewHandle(c->AllocObject(soa.Self()));
+  ASSERT_TRUE(obj != nullptr);
+
+  const IRTSegmentState cookie = kIRTFirstSegment;
+  size_t removed = 0u;
+  Benchmark("IndirectReferenceTable::Add+Remove", kOps, [&](size_t i ATTRIBUTE_UNUSED)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    IndirectRef iref = irt.Add(cookie, obj.Get(), &error_msg);
+    removed += irt.Remove(cookie, iref) ? 1u : 0u;
+  });
+  EXPECT_EQ((kWarmUpRounds + kRounds) * kOps, removed);
+  EXPECT_EQ(0u, irt.Capacity());
+}
+
+// Decodes references of a half full table.
+TEST_F(IndirectReferenceTableBenchmark, Get) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::string error_msg;
+  IndirectReferenceTable irt(kTableMax,
+                             kLocal,
+                             IndirectReferenceTable::ResizableCapacity::kNo,
+                             &error_msg);
+  ASSERT_TRUE(irt.IsValid()) << error_msg;
+  ObjPtr<mirror::Class> c = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::Object> obj = hs.NewHandle(c->AllocObject(soa.Self()));
+  ASSERT_TRUE(obj != nullptr);
+
+  const IRTSegmentState cookie = kIRTFirstSegment;
+  std::vector<IndirectRef> irefs;
+  for (size_t i = 0; i != kTableMax / 2; ++i) {
+    irefs.push_back(irt.Add(cookie, obj.Get(), &error_msg));
+    ASSERT_TRUE(irefs.back() != nullptr) << error_msg;
+  }
+  size_t found = 0u;
+  Benchmark("IndirectReferenceTable::Get", kOps, [&](size_t i)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    found += (irt.Get(irefs[i % irefs.size()]) == obj.Get()) ? 1u : 0u;
+  });
+  EXPECT_EQ((kWarmUpRounds + kRounds) * kOps, found);
+}
+
+}  // namespace art
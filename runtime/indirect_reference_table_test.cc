@@ -510,4 +510,115 @@ TEST_F(IndirectReferenceTableTest, Resize) {
   EXPECT_EQ(irt.Capacity(), kTableMax + 1);
 }
 
+TEST_F(IndirectReferenceTableTest, TryAddFast) {
+  ScopedObjectAccess soa(Thread::Current());
+  static const size_t kTableMax = 4;
+
+  mirror::Class* c = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  StackHandleScope<1> hs(soa.Self());
+  ASSERT_TRUE(c != nullptr);
+  Handle<mirror::Object> obj0 = hs.NewHandle(c->AllocObject(soa.Self()));
+  ASSERT_TRUE(obj0 != nullptr);
+
+  std::string error_msg;
+  IndirectReferenceTable irt(kTableMax,
+                             kLocal,
+                             IndirectReferenceTable::ResizableCapacity::kNo,
+                             &error_msg);
+  ASSERT_TRUE(irt.IsValid()) << error_msg;
+  const IRTSegmentState cookie0 = kIRTFirstSegment;
+
+  IndirectRef iref0 = irt.TryAddFast(cookie0, obj0.Get());
+  ASSERT_TRUE(iref0 != nullptr);
+  IndirectRef iref1 = irt.TryAddFast(cookie0, obj0.Get());
+  ASSERT_TRUE(iref1 != nullptr);
+  EXPECT_EQ(2u, irt.Capacity());
+  EXPECT_OBJ_PTR_EQ(obj0.Get(), irt.Get(iref0));
+  EXPECT_OBJ_PTR_EQ(obj0.Get(), irt.Get(iref1));
+
+  // A hole is left to Add().
+  EXPECT_TRUE(irt.Remove(cookie0, iref0));
+  EXPECT_TRUE(irt.TryAddFast(cookie0, obj0.Get()) == nullptr);
+  iref0 = irt.Add(cookie0, obj0.Get(), &error_msg);
+  ASSERT_TRUE(iref0 != nullptr) << error_msg;
+  EXPECT_EQ(2u, irt.Capacity());
+
+  // A new segment is empty, so it has no holes.
+  EXPECT_TRUE(irt.Remove(cookie0, iref0));
+  const IRTSegmentState cookie1 = irt.GetSegmentState();
+  IndirectRef iref2 = irt.TryAddFast(cookie1, obj0.Get());
+  ASSERT_TRUE(iref2 != nullptr);
+  EXPECT_EQ(3u, irt.Capacity());
+  EXPECT_TRUE(irt.Remove(cookie1, iref2));
+  irt.SetSegmentState(cookie1);
+
+  // Back in the first segment, its hole is found again.
+  EXPECT_TRUE(irt.TryAddFast(cookie0, obj0.Get()) == nullptr);
+  EXPECT_TRUE(irt.Add(cookie0, obj0.Get(), &error_msg) != nullptr) << error_msg;
+  EXPECT_EQ(2u, irt.Capacity());
+
+  // A full table is left to Add().
+  EXPECT_TRUE(irt.TryAddFast(cookie0, obj0.Get()) != nullptr);
+  EXPECT_TRUE(irt.TryAddFast(cookie0, obj0.Get()) != nullptr);
+  EXPECT_TRUE(irt.TryAddFast(cookie0, obj0.Get()) == nullptr);
+}
+
+TEST_F(IndirectReferenceTableTest, GlobalHolesAndResize) {
+  ScopedObjectAccess soa(Thread::Current());
+  static const size_t kTableMax = 4;
+  static const size_t kNumRefs = 3 * kTableMax;
+
+  mirror::Class* c = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  StackHandleScope<2> hs(soa.Self());
+  ASSERT_TRUE(c != nullptr);
+  Handle<mirror::Object> obj0 = hs.NewHandle(c->AllocObject(soa.Self()));
+  ASSERT_TRUE(obj0 != nullptr);
+  Handle<mirror::Object> obj1 = hs.NewHandle(c->AllocObject(soa.Self()));
+  ASSERT_TRUE(obj1 != nullptr);
+
+  std::string error_msg;
+  IndirectReferenceTable irt(kTableMax,
+                             kGlobal,
+                             IndirectReferenceTable::ResizableCapacity::kYes,
+                             &error_msg);
+  ASSERT_TRUE(irt.IsValid()) << error_msg;
+  const IRTSegmentState cookie = kIRTFirstSegment;
+
+  // The table grows past its initial capacity.
+  std::vector<IndirectRef> refs;
+  for (size_t i = 0; i != kNumRefs; ++i) {
+    refs.push_back(irt.Add(cookie, obj0.Get(), &error_msg));
+    ASSERT_TRUE(refs.back() != nullptr) << error_msg;
+  }
+  EXPECT_EQ(kNumRefs, irt.Capacity());
+  for (IndirectRef ref : refs) {
+    EXPECT_OBJ_PTR_EQ(obj0.Get(), irt.Get(ref));
+  }
+
+  // Leave holes, then eat some of them with the top-most entries.
+  for (size_t i = 1; i < kNumRefs - 1; i += 2) {
+    EXPECT_TRUE(irt.Remove(cookie, refs[i]));
+  }
+  EXPECT_EQ(kNumRefs, irt.Capacity());
+  EXPECT_TRUE(irt.Remove(cookie, refs[kNumRefs - 1]));
+  EXPECT_TRUE(irt.Remove(cookie, refs[kNumRefs - 2]));
+  EXPECT_EQ(kNumRefs - 3, irt.Capacity());
+
+  // The remaining holes are filled before the table grows again.
+  std::vector<IndirectRef> new_refs;
+  for (size_t i = 1; i < kNumRefs - 3; i += 2) {
+    new_refs.push_back(irt.Add(cookie, obj1.Get(), &error_msg));
+    ASSERT_TRUE(new_refs.back() != nullptr) << error_msg;
+  }
+  EXPECT_EQ(kNumRefs - 3, irt.Capacity());
+  for (IndirectRef ref : new_refs) {
+    EXPECT_OBJ_PTR_EQ(obj1.Get(), irt.Get(ref));
+  }
+  for (size_t i = 0; i < kNumRefs - 3; i += 2) {
+    EXPECT_OBJ_PTR_EQ(obj0.Get(), irt.Get(refs[i]));
+  }
+  EXPECT_TRUE(irt.Add(cookie, obj1.Get(), &error_msg) != nullptr) << error_msg;
+  EXPECT_EQ(kNumRefs - 2, irt.Capacity());
+}
+
 }  // namespace art
@@ -31,11 +31,13 @@
 #include "entrypoints/quick/quick_alloc_entrypoints.h"
 #include "entrypoints/quick/quick_entrypoints.h"
 #include "entrypoints/runtime_asm_entrypoints.h"
+#include "gc/heap.h"
 #include "gc_root-inl.h"
 #include "interpreter/interpreter.h"
 #include "interpreter/interpreter_common.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
+#include "jit/profiling_info.h"
 #include "jvalue-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/dex_cache.h"
@@ -145,6 +147,43 @@ bool Instrumentation::NeedDebugVersionFor(ArtMethod* method) const
          Runtime::Current()->GetRuntimeCallbacks()->IsMethodBeingInspected(method);
 }
 
+// The instrumentation entry stub replacing the JIT compiled code `quick_code` as the entry point
+// of `method` keeps calling that code rather than the interpreter. The JIT code cache keeps the
+// code alive for as long as the stub is the entry point.
+// Returns whether the code was saved.
+static bool SaveJitCodeForEntryStub(ArtMethod* method, const void* quick_code)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit != nullptr && jit->GetCodeCache()->ContainsPc(quick_code)) {
+    ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+    if (info != nullptr) {
+      info->SetInstrumentedEntryPoint(quick_code);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns the JIT compiled code called by the instrumentation entry stub of `method`, or null.
+static const void* GetJitCodeForEntryStub(ArtMethod* method)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  if (Runtime::Current()->GetJit() == nullptr) {
+    return nullptr;
+  }
+  ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+  return (info != nullptr) ? info->GetInstrumentedEntryPoint() : nullptr;
+}
+
+// Returns whether the instrumentation entry stub of `method` can call its JIT compiled code, saving
+// the code if it is the current entry point.
+static bool KeepJitCodeForEntryStub(ArtMethod* method) REQUIRES_SHARED(Locks::mutator_lock_) {
+  const void* quick_code = method->GetEntryPointFromQuickCompiledCode();
+  if (quick_code == GetQuickInstrumentationEntryPoint()) {
+    return GetJitCodeForEntryStub(method) != nullptr;
+  }
+  return SaveJitCodeForEntryStub(method, quick_code);
+}
+
 void Instrumentation::InstallStubsForMethod(ArtMethod* method) {
   if (!method->IsInvokable() || method->IsProxyMethod()) {
     // Do not change stubs for these methods.
@@ -164,7 +203,13 @@ void Instrumentation::InstallStubsForMethod(ArtMethod* method) {
     if ((forced_interpret_only_ || IsDeoptimized(method)) && !method->IsNative()) {
       new_quick_code = GetQuickToInterpreterBridge();
     } else if (is_class_initialized || !method->IsStatic() || method->IsConstructor()) {
-      if (NeedDebugVersionFor(method)) {
+      if (method->GetEntryPointFromQuickCompiledCode() == GetQuickInstrumentationEntryPoint() &&
+          GetJitCodeForEntryStub(method) != nullptr) {
+        // Put back the JIT compiled code that the entry stub was calling. It is debuggable code
+        // on a debuggable runtime, so it stays usable if the method is being inspected.
+        new_quick_code = GetJitCodeForEntryStub(method);
+        method->GetProfilingInfo(kRuntimePointerSize)->SetInstrumentedEntryPoint(nullptr);
+      } else if (NeedDebugVersionFor(method)) {
         new_quick_code = GetQuickToInterpreterBridge();
       } else {
         new_quick_code = class_linker->GetQuickOatCodeFor(method);
@@ -181,7 +226,11 @@ void Instrumentation::InstallStubsForMethod(ArtMethod* method) {
       // class, all its static methods code will be set to the instrumentation entry point.
       // For more details, see ClassLinker::FixupStaticTrampolines.
       if (is_class_initialized || !method->IsStatic() || method->IsConstructor()) {
-        if (NeedDebugVersionFor(method)) {
+        if (entry_exit_stubs_installed_ && KeepJitCodeForEntryStub(method)) {
+          // The JIT code is debuggable code on a debuggable runtime, the entry stub can call it
+          // even if the method is being inspected.
+          new_quick_code = GetQuickInstrumentationEntryPoint();
+        } else if (NeedDebugVersionFor(method)) {
           // Oat code should not be used. Don't install instrumentation stub and
           // use interpreter for instrumentation.
           new_quick_code = GetQuickToInterpreterBridge();
@@ -703,6 +752,11 @@ void Instrumentation::SetEntrypointsInstrumented(bool instrumented) {
     SetQuickAllocEntryPointsInstrumented(instrumented);
     ResetQuickAllocEntryPoints();
     alloc_entrypoints_instrumented_ = instrumented;
+    if (instrumented) {
+      // Compiled code bumps the thread-local buffers without calling the entrypoints. Take the
+      // buffers away, the heap doesn't hand out new ones while the allocations are instrumented.
+      runtime->GetHeap()->RevokeAllThreadLocalBuffers();
+    }
   } else {
     MutexLock mu(self, *Locks::runtime_shutdown_lock_);
     SetQuickAllocEntryPointsInstrumented(instrumented);
@@ -767,6 +821,7 @@ void Instrumentation::UpdateMethodsCodeImpl(ArtMethod* method, const void* quick
           class_linker->IsQuickToInterpreterBridge(quick_code)) {
         new_quick_code = quick_code;
       } else if (entry_exit_stubs_installed_) {
+        SaveJitCodeForEntryStub(method, quick_code);
         new_quick_code = GetQuickInstrumentationEntryPoint();
       } else {
         new_quick_code = quick_code;
@@ -970,6 +1025,12 @@ const void* Instrumentation::GetQuickCodeFor(ArtMethod* method, PointerSize poin
                !class_linker->IsQuickToInterpreterBridge(code)) {
       return code;
     }
+  } else if (entry_exit_stubs_installed_ && !interpreter_stubs_installed_) {
+    // Methods compiled by the JIT have no oat code, call their JIT code from the entry stub.
+    const void* code = GetJitCodeForEntryStub(method);
+    if (code != nullptr) {
+      return code;
+    }
   }
   return class_linker->GetQuickOatCodeFor(method);
 }
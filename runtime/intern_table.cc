@@ -18,6 +18,7 @@
 
 #include <memory>
 
+#include "base/stl_util.h"
 #include "gc/collector/garbage_collector.h"
 #include "gc/space/image_space.h"
 #include "gc/weak_root_state.h"
@@ -94,8 +95,13 @@ ObjPtr<mirror::String> InternTable::LookupWeak(Thread* self, ObjPtr<mirror::Stri
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self, ObjPtr<mirror::String> s) {
+  Table::FrozenLookup frozen_lookup;
+  ObjPtr<mirror::String> strong = strong_interns_.FindFrozen(s, &frozen_lookup);
+  if (strong != nullptr) {
+    return strong;
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupStrongLocked(s);
+  return strong_interns_.Find(s, &frozen_lookup);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
@@ -105,8 +111,13 @@ ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
   Utf8String string(utf16_length,
                     utf8_data,
                     ComputeUtf16HashFromModifiedUtf8(utf8_data, utf16_length));
+  Table::FrozenLookup frozen_lookup;
+  ObjPtr<mirror::String> strong = strong_interns_.FindFrozen(string, &frozen_lookup);
+  if (strong != nullptr) {
+    return strong;
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(string);
+  return strong_interns_.Find(string, &frozen_lookup);
 }
 
 ObjPtr<mirror::String> InternTable::LookupWeakLocked(ObjPtr<mirror::String> s) {
@@ -214,6 +225,13 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
   if (s == nullptr) {
     return nullptr;
   }
+  // Most strings interned again, such as the literals of the boot image, are in the frozen
+  // strong tables, which we look up without the lock.
+  Table::FrozenLookup frozen_lookup;
+  ObjPtr<mirror::String> frozen_strong = strong_interns_.FindFrozen(s, &frozen_lookup);
+  if (frozen_strong != nullptr) {
+    return frozen_strong;
+  }
   Thread* const self = Thread::Current();
   MutexLock mu(self, *Locks::intern_table_lock_);
   if (kDebugLocking && !holding_locks) {
@@ -229,7 +247,7 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
       }
     }
     // Check the strong table for a match.
-    ObjPtr<mirror::String> strong = LookupStrongLocked(s);
+    ObjPtr<mirror::String> strong = strong_interns_.Find(s, &frozen_lookup);
     if (strong != nullptr) {
       return strong;
     }
@@ -378,7 +396,8 @@ size_t InternTable::Table::AddTableFromMemory(const uint8_t* ptr) {
     }
   }
   // Insert at the front since we add new interns into the back.
-  tables_.insert(tables_.begin(), std::move(set));
+  tables_.push_front(std::move(set));
+  PublishFrozenTables();
   return read_count;
 }
 
@@ -406,27 +425,58 @@ void InternTable::Table::Remove(ObjPtr<mirror::String> s) {
     auto it = table.Find(GcRoot<mirror::String>(s));
     if (it != table.end()) {
       table.Erase(it);
+      if (&table != &tables_.back()) {
+        // Erasing moved the following strings of the probe sequence, tell the lookups which did
+        // not lock during the erase to look again.
+        num_frozen_removals_.StoreRelease(num_frozen_removals_.LoadRelaxed() + 1u);
+      }
       return;
     }
   }
   LOG(FATAL) << "Attempting to remove non-interned string " << s->ToModifiedUtf8();
 }
 
-ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
-  for (UnorderedSet& table : tables_) {
-    auto it = table.Find(GcRoot<mirror::String>(s));
-    if (it != table.end()) {
-      return it->Read();
+template <typename Key>
+ObjPtr<mirror::String> InternTable::Table::FindFrozenImpl(const Key& key,
+                                                          FrozenLookup* lookup) const {
+  // The frozen tables are never resized, and their roots are updated atomically, so we can look
+  // them up without the lock. A string found there is the same the locked lookup would find.
+  lookup->num_removals = num_frozen_removals_.LoadAcquire();
+  lookup->tables = frozen_tables_.LoadAcquire();
+  if (lookup->tables != nullptr) {
+    for (const UnorderedSet* table : *lookup->tables) {
+      auto it = table->Find(key);
+      if (it != table->end()) {
+        return it->Read();
+      }
     }
   }
   return nullptr;
 }
 
-ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string) {
+ObjPtr<mirror::String> InternTable::Table::FindFrozen(ObjPtr<mirror::String> s,
+                                                      FrozenLookup* lookup) const {
+  return FindFrozenImpl(GcRoot<mirror::String>(s), lookup);
+}
+
+ObjPtr<mirror::String> InternTable::Table::FindFrozen(const Utf8String& string,
+                                                      FrozenLookup* lookup) const {
+  return FindFrozenImpl(string, lookup);
+}
+
+template <typename Key>
+ObjPtr<mirror::String> InternTable::Table::FindImpl(const Key& key, const FrozenLookup* lookup) {
   Locks::intern_table_lock_->AssertHeld(Thread::Current());
+  // Skip the tables we already looked up, unless a Remove() from one of them moved other strings
+  // within the table in the meantime.
+  const bool skip_frozen = lookup != nullptr &&
+      lookup->tables != nullptr &&
+      lookup->num_removals == num_frozen_removals_.LoadRelaxed();
   for (UnorderedSet& table : tables_) {
-    auto it = table.Find(string);
+    if (skip_frozen && ContainsElement(*lookup->tables, &table)) {
+      continue;
+    }
+    auto it = table.Find(key);
     if (it != table.end()) {
       return it->Read();
     }
@@ -434,8 +484,32 @@ ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string) {
   return nullptr;
 }
 
+ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s,
+                                                const FrozenLookup* lookup) {
+  return FindImpl(GcRoot<mirror::String>(s), lookup);
+}
+
+ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string,
+                                                const FrozenLookup* lookup) {
+  return FindImpl(string, lookup);
+}
+
 void InternTable::Table::AddNewTable() {
   tables_.push_back(UnorderedSet());
+  PublishFrozenTables();
+}
+
+void InternTable::Table::PublishFrozenTables() {
+  std::unique_ptr<FrozenTables> frozen(new FrozenTables());
+  for (size_t i = 0; i < tables_.size() - 1; ++i) {
+    frozen->push_back(&tables_[i]);
+  }
+  const FrozenTables* old_frozen = frozen_tables_.LoadRelaxed();
+  if (old_frozen != nullptr) {
+    retired_frozen_tables_.emplace_back(old_frozen);
+  }
+  // Release the content of the tables along with the list.
+  frozen_tables_.StoreRelease(frozen.release());
 }
 
 void InternTable::Table::Insert(ObjPtr<mirror::String> s) {
@@ -497,7 +571,7 @@ void InternTable::ChangeWeakRootStateLocked(gc::WeakRootState new_state) {
   }
 }
 
-InternTable::Table::Table() {
+InternTable::Table::Table() : frozen_tables_(nullptr), num_frozen_removals_(0u) {
   Runtime* const runtime = Runtime::Current();
   // Initial table.
   tables_.push_back(UnorderedSet());
@@ -505,4 +579,8 @@ InternTable::Table::Table() {
                                runtime->GetHashTableMaxLoadFactor());
 }
 
+InternTable::Table::~Table() {
+  delete frozen_tables_.LoadRelaxed();
+}
+
 }  // namespace art
@@ -17,7 +17,10 @@
 #ifndef ART_RUNTIME_INTERN_TABLE_H_
 #define ART_RUNTIME_INTERN_TABLE_H_
 
+#include <deque>
+#include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "atomic.h"
 #include "base/allocator.h"
@@ -140,6 +143,14 @@ class InternTable {
   size_t WriteToMemory(uint8_t* ptr) REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::intern_table_lock_);
 
+  // Visits the strings of an intern table written by WriteToMemory() in place, without adding it
+  // to an intern table. Used to relocate the interned strings of an image. Returns how many bytes
+  // were read.
+  template <typename Visitor>
+  static size_t VisitRootsInMemory(uint8_t* ptr, const Visitor& visitor) {
+    return Table::VisitRootsInMemory(ptr, visitor);
+  }
+
   // Change the weak root state. May broadcast to waiters.
   void ChangeWeakRootState(gc::WeakRootState new_state)
       REQUIRES(!Locks::intern_table_lock_);
@@ -190,11 +201,22 @@ class InternTable {
   // weak interns and strong interns.
   class Table {
    public:
+    // The frozen tables searched by FindFrozen(), for a following Find() to skip them.
+    struct FrozenLookup;
+
     Table();
-    ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    ObjPtr<mirror::String> Find(const Utf8String& string) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
+    ~Table();
+    // Looks up the frozen tables, which are no longer inserted into, without the lock. Only used
+    // for the strong interns, the frozen weak tables are swept. Returns null if not found.
+    ObjPtr<mirror::String> FindFrozen(ObjPtr<mirror::String> s, FrozenLookup* lookup) const
+        REQUIRES_SHARED(Locks::mutator_lock_);
+    ObjPtr<mirror::String> FindFrozen(const Utf8String& string, FrozenLookup* lookup) const
+        REQUIRES_SHARED(Locks::mutator_lock_);
+    // Looks up all tables but the ones `lookup` already searched, if any.
+    ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s, const FrozenLookup* lookup = nullptr)
+        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+    ObjPtr<mirror::String> Find(const Utf8String& string, const FrozenLookup* lookup = nullptr)
+        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
     void Insert(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_)
         REQUIRES(Locks::intern_table_lock_);
     void Remove(ObjPtr<mirror::String> s)
@@ -215,17 +237,51 @@ class InternTable {
     // one. Returns how many bytes were written.
     size_t WriteToMemory(uint8_t* ptr)
         REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
+    // Visits the strings of a table written by WriteToMemory() without reading it.
+    template <typename Visitor>
+    static size_t VisitRootsInMemory(uint8_t* ptr, const Visitor& visitor) {
+      return UnorderedSet::VisitElementsInMemory(ptr, visitor);
+    }
 
    private:
+    // Uses control bytes since comparing an element needs to read the string's hash code.
     typedef HashSet<GcRoot<mirror::String>, GcRootEmptyFn, StringHashEquals, StringHashEquals,
-        TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>> UnorderedSet;
+        TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>,
+        /* kUseControlBytes */ true> UnorderedSet;
 
     void SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
 
+    template <typename Key>
+    ObjPtr<mirror::String> FindFrozenImpl(const Key& key, FrozenLookup* lookup) const
+        REQUIRES_SHARED(Locks::mutator_lock_);
+    template <typename Key>
+    ObjPtr<mirror::String> FindImpl(const Key& key, const FrozenLookup* lookup)
+        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+
+    // Publishes the tables added or frozen since the last call for the lookups without lock.
+    void PublishFrozenTables() REQUIRES(Locks::intern_table_lock_);
+
+    // The tables which are no longer inserted into, all of `tables_` but the last one.
+    using FrozenTables = std::vector<const UnorderedSet*>;
+
     // We call AddNewTable when we create the zygote to reduce private dirty pages caused by
     // modifying the zygote intern table. The back of table is modified when strings are interned.
-    std::vector<UnorderedSet> tables_;
+    // A deque doesn't move the tables when adding one at either end, so that the frozen ones can
+    // be read without the lock.
+    std::deque<UnorderedSet> tables_;
+    // The frozen tables, which never resize. Each update publishes a new list, the previous ones
+    // are kept in `retired_frozen_tables_` since a concurrent lookup may still read them.
+    Atomic<const FrozenTables*> frozen_tables_;
+    std::vector<std::unique_ptr<const FrozenTables>> retired_frozen_tables_;
+    // Incremented by each Remove() from a frozen table, written with the lock held.
+    Atomic<uint32_t> num_frozen_removals_;
+
+   public:
+    struct FrozenLookup {
+      const FrozenTables* tables = nullptr;
+      uint32_t num_removals = 0u;
+    };
 
     friend class linker::OatWriter;  // for boot image string table slot address lookup.
     ART_FRIEND_TEST(InternTableTest, CrossHash);
@@ -276,8 +332,10 @@ class InternTable {
   // Since this contains (strong) roots, they need a read barrier to
   // enable concurrent intern table (strong) root scan. Do not
   // directly access the strings in it. Use functions that contain
-  // read barriers.
-  Table strong_interns_ GUARDED_BY(Locks::intern_table_lock_);
+  // read barriers. Not GUARDED_BY the lock since its frozen tables are
+  // looked up without it, the methods of the table declare what they
+  // require.
+  Table strong_interns_;
   std::vector<GcRoot<mirror::String>> new_strong_intern_roots_
       GUARDED_BY(Locks::intern_table_lock_);
   // Since this contains (weak) roots, they need a read barrier. Do
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "intern_table.h"
+
+#include <string>
+#include <vector>
+
+#include "common_runtime_benchmark.h"
+#include "mirror/string.h"
+#include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+class InternTableBenchmark : public CommonRuntimeBenchmark {
+ protected:
+  static constexpr size_t kStrings = 1000u;
+  static constexpr size_t kLookups = 100000u;
+};
+
+// Looks up strings interned in the runtime intern table, which also holds the strings of the
+// boot image and keeps the new ones alive.
+TEST_F(InternTableBenchmark, LookupStrong) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable* intern_table = Runtime::Current()->GetInternTable();
+  std::vector<std::string> strings;
+  for (size_t i = 0; i != kStrings; ++i) {
+    strings.push_back("intern_table_benchmark_" + std::to_string(i));
+    ASSERT_TRUE(intern_table->InternStrong(strings.back().c_str()) != nullptr);
+  }
+  size_t found = 0u;
+  Benchmark("InternTable::LookupStrong", kLookups, [&](size_t i)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    const std::string& s = strings[i % kStrings];
+    found += (intern_table->LookupStrong(soa.Self(), s.length(), s.c_str()) != nullptr) ? 1u : 0u;
+  });
+  EXPECT_EQ((kWarmUpRounds + kRounds) * kLookups, found);
+}
+
+TEST_F(InternTableBenchmark, LookupStrongMiss) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable* intern_table = Runtime::Current()->GetInternTable();
+  const std::string s = "intern_table_benchmark_not_interned";
+  size_t found = 0u;
+  Benchmark("InternTable::LookupStrong/miss", kLookups, [&](size_t i ATTRIBUTE_UNUSED)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    found += (intern_table->LookupStrong(soa.Self(), s.length(), s.c_str()) != nullptr) ? 1u : 0u;
+  });
+  EXPECT_EQ(0u, found);
+}
+
+}  // namespace art
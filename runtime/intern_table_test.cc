@@ -65,6 +65,39 @@ TEST_F(InternTableTest, Size) {
   EXPECT_EQ(2U, t.Size());
 }
 
+TEST_F(InternTableTest, FrozenTables) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable t;
+  StackHandleScope<4> hs(soa.Self());
+  Handle<mirror::String> foo(hs.NewHandle(t.InternStrong(3, "foo")));
+  Handle<mirror::String> bar(
+      hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), "bar")));
+  t.InternWeak(bar.Get());
+  // The strings interned so far are in the frozen tables, looked up without the lock.
+  t.AddNewTable();
+  EXPECT_EQ(foo.Get(), t.LookupStrong(soa.Self(), 3, "foo"));
+  EXPECT_EQ(foo.Get(), t.InternStrong(3, "foo"));
+  EXPECT_EQ(nullptr, t.LookupStrong(soa.Self(), 3, "bar"));
+  // Promoting a weak intern removes it from the frozen weak table.
+  EXPECT_EQ(bar.Get(), t.InternStrong(bar.Get()));
+  EXPECT_EQ(bar.Get(), t.LookupStrong(soa.Self(), bar.Get()));
+  Handle<mirror::String> baz(hs.NewHandle(t.InternStrong(3, "baz")));
+  EXPECT_EQ(baz.Get(), t.LookupStrong(soa.Self(), 3, "baz"));
+  EXPECT_EQ(3U, t.StrongSize());
+  EXPECT_EQ(0U, t.WeakSize());
+
+  // A table read from memory is frozen too.
+  std::vector<uint8_t> data(t.WriteToMemory(nullptr));
+  ASSERT_EQ(data.size(), t.WriteToMemory(data.data()));
+  InternTable t2;
+  EXPECT_EQ(data.size(), t2.AddTableFromMemory(data.data()));
+  EXPECT_EQ(foo.Get(), t2.LookupStrong(soa.Self(), 3, "foo"));
+  EXPECT_EQ(baz.Get(), t2.InternStrong(3, "baz"));
+  Handle<mirror::String> qux(hs.NewHandle(t2.InternStrong(3, "qux")));
+  EXPECT_EQ(qux.Get(), t2.LookupStrong(soa.Self(), 3, "qux"));
+  EXPECT_EQ(4U, t2.StrongSize());
+}
+
 // Check if table indexes match on 64 and 32 bit machines.
 // This is done by ensuring hash values are the same on every machine and limited to 32-bit wide.
 // Otherwise cross compilation can cause a table to be filled on host using one indexing algorithm
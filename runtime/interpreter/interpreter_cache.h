@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
+#define ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
+
+#include <array>
+#include <utility>
+
+#include "atomic.h"
+#include "base/bit_utils.h"
+#include "base/logging.h"
+#include "base/macros.h"
+
+namespace art {
+
+// Small direct-mapped cache of the interpreter, from the address of a dex instruction to data
+// resolved for it, such as the offset of the field accessed by an iget. It serves the purpose of
+// the quickened instructions without writing to the dex code, so that the dex pages stay clean
+// and shared between processes.
+//
+// Each thread has its own cache, which is only accessed by that thread, so no synchronization
+// is needed. The instruction addresses are only unique while their dex file is mapped, so all
+// caches are invalidated with InvalidateAll() before a dex file is freed; each cache clears
+// itself on its next lookup.
+class InterpreterCache {
+ public:
+  // The number of entries, a power of two. Each thread uses 16 bytes per entry on 64-bit.
+  static constexpr size_t kSize = 256;
+
+  InterpreterCache() : generation_(global_generation_.LoadRelaxed()) {
+    Clear();
+  }
+
+  ALWAYS_INLINE bool Get(const void* key, /* out */ size_t* value) {
+    uint32_t generation = global_generation_.LoadRelaxed();
+    if (UNLIKELY(generation != generation_)) {
+      Clear();
+      generation_ = generation;
+      return false;
+    }
+    const Entry& entry = data_[IndexOf(key)];
+    if (LIKELY(entry.first == key)) {
+      *value = entry.second;
+      return true;
+    }
+    return false;
+  }
+
+  ALWAYS_INLINE void Set(const void* key, size_t value) {
+    DCHECK(key != nullptr);
+    data_[IndexOf(key)] = Entry{key, value};
+  }
+
+  void Clear() {
+    data_.fill(Entry{nullptr, 0u});
+  }
+
+  // Invalidates the caches of all threads. Must be called before freeing dex code which may have
+  // been executed.
+  static void InvalidateAll() {
+    global_generation_.FetchAndAddSequentiallyConsistent(1u);
+  }
+
+ private:
+  using Entry = std::pair<const void*, size_t>;
+
+  static size_t IndexOf(const void* key) {
+    static_assert(IsPowerOfTwo(kSize), "Size must be a power of two");
+    // Dex instructions are at least two bytes long, and the cached ones at least four.
+    return (reinterpret_cast<uintptr_t>(key) >> 2) & (kSize - 1);
+  }
+
+  static Atomic<uint32_t> global_generation_;
+
+  std::array<Entry, kSize> data_;
+  // The value of `global_generation_` when the entries were last cleared.
+  uint32_t generation_;
+
+  DISALLOW_COPY_AND_ASSIGN(InterpreterCache);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_INTERPRETER_INTERPRETER_CACHE_H_
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "interpreter_cache.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace art {
+
+TEST(InterpreterCache, GetAndSet) {
+  std::unique_ptr<InterpreterCache> cache(new InterpreterCache());
+  uint16_t code[2 * InterpreterCache::kSize + 2];
+  size_t value = 0u;
+  EXPECT_FALSE(cache->Get(&code[0], &value));
+
+  cache->Set(&code[0], 12u);
+  cache->Set(&code[2], 16u);
+  ASSERT_TRUE(cache->Get(&code[0], &value));
+  EXPECT_EQ(12u, value);
+  ASSERT_TRUE(cache->Get(&code[2], &value));
+  EXPECT_EQ(16u, value);
+
+  // An instruction mapped to the same entry replaces the previous one.
+  cache->Set(&code[2 * InterpreterCache::kSize], 20u);
+  EXPECT_FALSE(cache->Get(&code[0], &value));
+  ASSERT_TRUE(cache->Get(&code[2 * InterpreterCache::kSize], &value));
+  EXPECT_EQ(20u, value);
+
+  cache->Clear();
+  EXPECT_FALSE(cache->Get(&code[2], &value));
+}
+
+TEST(InterpreterCache, InvalidateAll) {
+  std::unique_ptr<InterpreterCache> cache(new InterpreterCache());
+  std::unique_ptr<InterpreterCache> other_cache(new InterpreterCache());
+  uint16_t code[2];
+  cache->Set(&code[0], 8u);
+  other_cache->Set(&code[0], 8u);
+
+  InterpreterCache::InvalidateAll();
+  size_t value = 0u;
+  EXPECT_FALSE(cache->Get(&code[0], &value));
+  EXPECT_FALSE(other_cache->Get(&code[0], &value));
+
+  // The caches can be used again after the invalidation.
+  cache->Set(&code[0], 8u);
+  ASSERT_TRUE(cache->Get(&code[0], &value));
+  EXPECT_EQ(8u, value);
+}
+
+}  // namespace art
@@ -1288,11 +1288,7 @@ inline void CopyRegisters(ShadowFrame& caller_frame,
                           const size_t first_dest_reg,
                           const size_t num_regs) {
   if (is_range) {
-    const size_t dest_reg_bound = first_dest_reg + num_regs;
-    for (size_t src_reg = first_src_reg, dest_reg = first_dest_reg; dest_reg < dest_reg_bound;
-        ++dest_reg, ++src_reg) {
-      AssignRegister(callee_frame, caller_frame, dest_reg, src_reg);
-    }
+    callee_frame->CopyVRegs(caller_frame, first_src_reg, first_dest_reg, num_regs);
   } else {
     DCHECK_LE(num_regs, arraysize(arg));
 
@@ -16,9 +16,14 @@
 
 #include "interpreter/interpreter_intrinsics.h"
 
+#include <cmath>
+#include <limits>
+
+#include "base/casts.h"
 #include "dex_instruction.h"
 #include "intrinsics_enum.h"
 #include "interpreter/interpreter_common.h"
+#include "mirror/array-inl.h"
 
 namespace art {
 namespace interpreter {
@@ -45,6 +50,12 @@ static ALWAYS_INLINE bool name(ShadowFrame* shadow_frame,           \
 #define BINARY_JI_INTRINSIC(name, op, set) \
     BINARY_INTRINSIC(name, op, GetVRegLong(arg[0]), GetVReg(arg[2]), set)
 
+#define BINARY_FF_INTRINSIC(name, op, set) \
+    BINARY_INTRINSIC(name, op, GetVRegFloat(arg[0]), GetVRegFloat(arg[1]), set)
+
+#define BINARY_DD_INTRINSIC(name, op, set) \
+    BINARY_INTRINSIC(name, op, GetVRegDouble(arg[0]), GetVRegDouble(arg[2]), set)
+
 #define UNARY_INTRINSIC(name, op, get, set)                  \
 static ALWAYS_INLINE bool name(ShadowFrame* shadow_frame,    \
                                const Instruction* inst,      \
@@ -57,6 +68,69 @@ static ALWAYS_INLINE bool name(ShadowFrame* shadow_frame,    \
   return true;                                               \
 }
 
+// The Java semantics of Float.floatToIntBits() and Double.doubleToLongBits(), which collapse
+// all NaNs to the canonical one.
+static ALWAYS_INLINE int32_t FloatToIntBits(float value) {
+  return std::isnan(value) ? 0x7fc00000 : bit_cast<int32_t, float>(value);
+}
+
+static ALWAYS_INLINE int64_t DoubleToLongBits(double value) {
+  return std::isnan(value) ? INT64_C(0x7ff8000000000000) : bit_cast<int64_t, double>(value);
+}
+
+// The Java semantics of Math.min() and Math.max() for floating point values: a NaN input
+// yields NaN and -0.0 is smaller than 0.0, unlike with std::min() and std::max().
+template <typename T>
+static ALWAYS_INLINE T JavaMin(T a, T b) {
+  if (std::isnan(a) || std::isnan(b)) {
+    return std::numeric_limits<T>::quiet_NaN();
+  }
+  if (a == b) {
+    return std::signbit(a) ? a : b;
+  }
+  return (a < b) ? a : b;
+}
+
+template <typename T>
+static ALWAYS_INLINE T JavaMax(T a, T b) {
+  if (std::isnan(a) || std::isnan(b)) {
+    return std::numeric_limits<T>::quiet_NaN();
+  }
+  if (a == b) {
+    return std::signbit(a) ? b : a;
+  }
+  return (a > b) ? a : b;
+}
+
+// java.lang.Double.doubleToRawLongBits(D)J
+UNARY_INTRINSIC(MterpDoubleDoubleToRawLongBits, (bit_cast<int64_t, double>), GetVRegDouble, SetJ);
+
+// java.lang.Double.doubleToLongBits(D)J
+UNARY_INTRINSIC(MterpDoubleDoubleToLongBits, DoubleToLongBits, GetVRegDouble, SetJ);
+
+// java.lang.Double.isInfinite(D)Z
+UNARY_INTRINSIC(MterpDoubleIsInfinite, std::isinf, GetVRegDouble, SetZ);
+
+// java.lang.Double.isNaN(D)Z
+UNARY_INTRINSIC(MterpDoubleIsNaN, std::isnan, GetVRegDouble, SetZ);
+
+// java.lang.Double.longBitsToDouble(J)D
+UNARY_INTRINSIC(MterpDoubleLongBitsToDouble, (bit_cast<double, int64_t>), GetVRegLong, SetD);
+
+// java.lang.Float.floatToRawIntBits(F)I
+UNARY_INTRINSIC(MterpFloatFloatToRawIntBits, (bit_cast<int32_t, float>), GetVRegFloat, SetI);
+
+// java.lang.Float.floatToIntBits(F)I
+UNARY_INTRINSIC(MterpFloatFloatToIntBits, FloatToIntBits, GetVRegFloat, SetI);
+
+// java.lang.Float.isInfinite(F)Z
+UNARY_INTRINSIC(MterpFloatIsInfinite, std::isinf, GetVRegFloat, SetZ);
+
+// java.lang.Float.isNaN(F)Z
+UNARY_INTRINSIC(MterpFloatIsNaN, std::isnan, GetVRegFloat, SetZ);
+
+// java.lang.Float.intBitsToFloat(I)F
+UNARY_INTRINSIC(MterpFloatIntBitsToFloat, (bit_cast<float, int32_t>), GetVReg, SetF);
 
 // java.lang.Integer.reverse(I)I
 UNARY_INTRINSIC(MterpIntegerReverse, ReverseBits32, GetVReg, SetI);
@@ -139,6 +213,18 @@ BINARY_II_INTRINSIC(MterpMathMaxIntInt, std::max, SetI);
 // java.lang.Math.max(JJ)J
 BINARY_JJ_INTRINSIC(MterpMathMaxLongLong, std::max, SetJ);
 
+// java.lang.Math.min(FF)F
+BINARY_FF_INTRINSIC(MterpMathMinFloatFloat, JavaMin<float>, SetF);
+
+// java.lang.Math.min(DD)D
+BINARY_DD_INTRINSIC(MterpMathMinDoubleDouble, JavaMin<double>, SetD);
+
+// java.lang.Math.max(FF)F
+BINARY_FF_INTRINSIC(MterpMathMaxFloatFloat, JavaMax<float>, SetF);
+
+// java.lang.Math.max(DD)D
+BINARY_DD_INTRINSIC(MterpMathMaxDoubleDouble, JavaMax<double>, SetD);
+
 // java.lang.Math.abs(I)I
 UNARY_INTRINSIC(MterpMathAbsInt, std::abs, GetVReg, SetI);
 
@@ -178,6 +264,145 @@ UNARY_INTRINSIC(MterpMathAcos, std::acos, GetVRegDouble, SetD);
 // java.lang.Math.atan(D)D
 UNARY_INTRINSIC(MterpMathAtan, std::atan, GetVRegDouble, SetD);
 
+// java.lang.Math.atan2(DD)D
+BINARY_DD_INTRINSIC(MterpMathAtan2, std::atan2, SetD);
+
+// java.lang.Math.cbrt(D)D
+UNARY_INTRINSIC(MterpMathCbrt, std::cbrt, GetVRegDouble, SetD);
+
+// java.lang.Math.cosh(D)D
+UNARY_INTRINSIC(MterpMathCosh, std::cosh, GetVRegDouble, SetD);
+
+// java.lang.Math.exp(D)D
+UNARY_INTRINSIC(MterpMathExp, std::exp, GetVRegDouble, SetD);
+
+// java.lang.Math.expm1(D)D
+UNARY_INTRINSIC(MterpMathExpm1, std::expm1, GetVRegDouble, SetD);
+
+// java.lang.Math.hypot(DD)D
+BINARY_DD_INTRINSIC(MterpMathHypot, std::hypot, SetD);
+
+// java.lang.Math.log(D)D
+UNARY_INTRINSIC(MterpMathLog, std::log, GetVRegDouble, SetD);
+
+// java.lang.Math.log10(D)D
+UNARY_INTRINSIC(MterpMathLog10, std::log10, GetVRegDouble, SetD);
+
+// java.lang.Math.nextAfter(DD)D
+BINARY_DD_INTRINSIC(MterpMathNextAfter, std::nextafter, SetD);
+
+// java.lang.Math.sinh(D)D
+UNARY_INTRINSIC(MterpMathSinh, std::sinh, GetVRegDouble, SetD);
+
+// java.lang.Math.tanh(D)D
+UNARY_INTRINSIC(MterpMathTanh, std::tanh, GetVRegDouble, SetD);
+
+// java.lang.Math.rint(D)D
+UNARY_INTRINSIC(MterpMathRint, std::rint, GetVRegDouble, SetD);
+
+// java.lang.System.arraycopy([CI[CII)V
+static ALWAYS_INLINE bool MterpSystemArrayCopyChar(ShadowFrame* shadow_frame,
+                                                   const Instruction* inst,
+                                                   uint16_t inst_data,
+                                                   JValue* result_register ATTRIBUTE_UNUSED)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  uint32_t arg[Instruction::kMaxVarArgRegs] = {};
+  inst->GetVarArgs(arg, inst_data);
+  mirror::Object* src = shadow_frame->GetVRegReference(arg[0]);
+  mirror::Object* dst = shadow_frame->GetVRegReference(arg[2]);
+  if (src == nullptr || dst == nullptr) {
+    return false;  // Punt and let non-intrinsic version deal with the throw.
+  }
+  mirror::CharArray* src_array = src->AsCharArray();
+  mirror::CharArray* dst_array = dst->AsCharArray();
+  int32_t src_pos = shadow_frame->GetVReg(arg[1]);
+  int32_t dst_pos = shadow_frame->GetVReg(arg[3]);
+  int32_t length = shadow_frame->GetVReg(arg[4]);
+  if (UNLIKELY(src_pos < 0) ||
+      UNLIKELY(dst_pos < 0) ||
+      UNLIKELY(length < 0) ||
+      UNLIKELY(src_pos > src_array->GetLength() - length) ||
+      UNLIKELY(dst_pos > dst_array->GetLength() - length)) {
+    return false;  // Punt and let non-intrinsic version deal with the throw.
+  }
+  dst_array->Memmove(dst_pos, src_array, src_pos, length);
+  return true;
+}
+
+// java.lang.Thread.currentThread()Ljava/lang/Thread;
+static ALWAYS_INLINE bool MterpThreadCurrentThread(ShadowFrame* shadow_frame ATTRIBUTE_UNUSED,
+                                                   const Instruction* inst ATTRIBUTE_UNUSED,
+                                                   uint16_t inst_data ATTRIBUTE_UNUSED,
+                                                   JValue* result_register)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  result_register->SetL(Thread::Current()->GetPeer());
+  return true;
+}
+
+// java.lang.Thread.interrupted()Z
+static ALWAYS_INLINE bool MterpThreadInterrupted(ShadowFrame* shadow_frame ATTRIBUTE_UNUSED,
+                                                 const Instruction* inst ATTRIBUTE_UNUSED,
+                                                 uint16_t inst_data ATTRIBUTE_UNUSED,
+                                                 JValue* result_register)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  result_register->SetZ(Thread::Current()->Interrupted());
+  return true;
+}
+
+// The libcore.io.Memory methods access native memory, which may not be aligned.
+#define MEMORY_PEEK_INTRINSIC(name, type, set)                   \
+static ALWAYS_INLINE bool Mterp##name(ShadowFrame* shadow_frame, \
+                                      const Instruction* inst,   \
+                                      uint16_t inst_data,        \
+                                      JValue* result_register)   \
+    REQUIRES_SHARED(Locks::mutator_lock_) {                      \
+  uint32_t arg[Instruction::kMaxVarArgRegs] = {};                \
+  inst->GetVarArgs(arg, inst_data);                              \
+  uintptr_t address = static_cast<uintptr_t>(shadow_frame->GetVRegLong(arg[0])); \
+  type value;                                                    \
+  memcpy(&value, reinterpret_cast<const void*>(address), sizeof(type)); \
+  result_register->set(value);                                   \
+  return true;                                                   \
+}
+
+#define MEMORY_POKE_INTRINSIC(name, type, get)                   \
+static ALWAYS_INLINE bool Mterp##name(ShadowFrame* shadow_frame, \
+                                      const Instruction* inst,   \
+                                      uint16_t inst_data,        \
+                                      JValue* result_register ATTRIBUTE_UNUSED) \
+    REQUIRES_SHARED(Locks::mutator_lock_) {                      \
+  uint32_t arg[Instruction::kMaxVarArgRegs] = {};                \
+  inst->GetVarArgs(arg, inst_data);                              \
+  uintptr_t address = static_cast<uintptr_t>(shadow_frame->GetVRegLong(arg[0])); \
+  type value = static_cast<type>(shadow_frame->get(arg[2]));     \
+  memcpy(reinterpret_cast<void*>(address), &value, sizeof(type)); \
+  return true;                                                   \
+}
+
+// libcore.io.Memory.peekByte(J)B
+MEMORY_PEEK_INTRINSIC(MemoryPeekByte, int8_t, SetB)
+
+// libcore.io.Memory.peekIntNative(J)I
+MEMORY_PEEK_INTRINSIC(MemoryPeekIntNative, int32_t, SetI)
+
+// libcore.io.Memory.peekLongNative(J)J
+MEMORY_PEEK_INTRINSIC(MemoryPeekLongNative, int64_t, SetJ)
+
+// libcore.io.Memory.peekShortNative(J)S
+MEMORY_PEEK_INTRINSIC(MemoryPeekShortNative, int16_t, SetS)
+
+// libcore.io.Memory.pokeByte(JB)V
+MEMORY_POKE_INTRINSIC(MemoryPokeByte, int8_t, GetVReg)
+
+// libcore.io.Memory.pokeIntNative(JI)V
+MEMORY_POKE_INTRINSIC(MemoryPokeIntNative, int32_t, GetVReg)
+
+// libcore.io.Memory.pokeLongNative(JJ)V
+MEMORY_POKE_INTRINSIC(MemoryPokeLongNative, int64_t, GetVRegLong)
+
+// libcore.io.Memory.pokeShortNative(JS)V
+MEMORY_POKE_INTRINSIC(MemoryPokeShortNative, int16_t, GetVReg)
+
 // java.lang.String.charAt(I)C
 static ALWAYS_INLINE bool MterpStringCharAt(ShadowFrame* shadow_frame,
                                             const Instruction* inst,
@@ -342,6 +567,63 @@ VARHANDLE_FENCE_INTRINSIC(MterpVarHandleReleaseFence, std::memory_order_release)
 VARHANDLE_FENCE_INTRINSIC(MterpVarHandleLoadLoadFence, std::memory_order_acquire)
 VARHANDLE_FENCE_INTRINSIC(MterpVarHandleStoreStoreFence, std::memory_order_release)
 
+// The sun.misc.Unsafe fences, with the same strength as the VarHandle ones.
+VARHANDLE_FENCE_INTRINSIC(MterpUnsafeLoadFence, std::memory_order_acquire)
+VARHANDLE_FENCE_INTRINSIC(MterpUnsafeStoreFence, std::memory_order_release)
+VARHANDLE_FENCE_INTRINSIC(MterpUnsafeFullFence, std::memory_order_seq_cst)
+
+// The sun.misc.Unsafe accessors are instance methods: arg[0] is the Unsafe, arg[1] the object
+// and arg[2] the offset of the field. Mterp is never used in transactions.
+#define UNSAFE_GET_INTRINSIC(name, get, set)                     \
+static ALWAYS_INLINE bool Mterp##name(ShadowFrame* shadow_frame, \
+                                      const Instruction* inst,   \
+                                      uint16_t inst_data,        \
+                                      JValue* result_register)   \
+    REQUIRES_SHARED(Locks::mutator_lock_) {                      \
+  uint32_t arg[Instruction::kMaxVarArgRegs] = {};                \
+  inst->GetVarArgs(arg, inst_data);                              \
+  mirror::Object* obj = shadow_frame->GetVRegReference(arg[1]);  \
+  if (obj == nullptr) {                                          \
+    return false;                                                \
+  }                                                              \
+  MemberOffset offset(shadow_frame->GetVRegLong(arg[2]));        \
+  result_register->set(obj->get(offset));                        \
+  return true;                                                   \
+}
+
+#define UNSAFE_PUT_INTRINSIC(name, ordered, set, get)            \
+static ALWAYS_INLINE bool Mterp##name(ShadowFrame* shadow_frame, \
+                                      const Instruction* inst,   \
+                                      uint16_t inst_data,        \
+                                      JValue* result_register ATTRIBUTE_UNUSED) \
+    REQUIRES_SHARED(Locks::mutator_lock_) {                      \
+  uint32_t arg[Instruction::kMaxVarArgRegs] = {};                \
+  inst->GetVarArgs(arg, inst_data);                              \
+  mirror::Object* obj = shadow_frame->GetVRegReference(arg[1]);  \
+  if (obj == nullptr) {                                          \
+    return false;                                                \
+  }                                                              \
+  MemberOffset offset(shadow_frame->GetVRegLong(arg[2]));        \
+  if (ordered) {                                                 \
+    QuasiAtomic::ThreadFenceRelease();                           \
+  }                                                              \
+  obj->set<false>(offset, shadow_frame->get(arg[4]));            \
+  return true;                                                   \
+}
+
+UNSAFE_GET_INTRINSIC(UnsafeGet, GetField32, SetI)
+UNSAFE_GET_INTRINSIC(UnsafeGetVolatile, GetField32Volatile, SetI)
+UNSAFE_GET_INTRINSIC(UnsafeGetObject, GetFieldObject<mirror::Object>, SetL)
+UNSAFE_GET_INTRINSIC(UnsafeGetObjectVolatile, GetFieldObjectVolatile<mirror::Object>, SetL)
+UNSAFE_GET_INTRINSIC(UnsafeGetLong, GetField64, SetJ)
+UNSAFE_GET_INTRINSIC(UnsafeGetLongVolatile, GetField64Volatile, SetJ)
+UNSAFE_PUT_INTRINSIC(UnsafePut, false, SetField32, GetVReg)
+UNSAFE_PUT_INTRINSIC(UnsafePutOrdered, true, SetField32, GetVReg)
+UNSAFE_PUT_INTRINSIC(UnsafePutVolatile, false, SetField32Volatile, GetVReg)
+UNSAFE_PUT_INTRINSIC(UnsafePutObject, false, SetFieldObject, GetVRegReference)
+UNSAFE_PUT_INTRINSIC(UnsafePutObjectOrdered, true, SetFieldObject, GetVRegReference)
+UNSAFE_PUT_INTRINSIC(UnsafePutObjectVolatile, false, SetFieldObjectVolatile, GetVRegReference)
+
 #define METHOD_HANDLE_INVOKE_INTRINSIC(name)                                                      \
 static ALWAYS_INLINE bool Mterp##name(ShadowFrame* shadow_frame,                                  \
                                const Instruction* inst,                                           \
@@ -419,16 +701,16 @@ bool MterpHandleIntrinsic(ShadowFrame* shadow_frame,
   Intrinsics intrinsic = static_cast<Intrinsics>(called_method->GetIntrinsic());
   bool res = false;  // Assume failure
   switch (intrinsic) {
-    UNIMPLEMENTED_CASE(DoubleDoubleToRawLongBits /* (D)J */)
-    UNIMPLEMENTED_CASE(DoubleDoubleToLongBits /* (D)J */)
-    UNIMPLEMENTED_CASE(DoubleIsInfinite /* (D)Z */)
-    UNIMPLEMENTED_CASE(DoubleIsNaN /* (D)Z */)
-    UNIMPLEMENTED_CASE(DoubleLongBitsToDouble /* (J)D */)
-    UNIMPLEMENTED_CASE(FloatFloatToRawIntBits /* (F)I */)
-    UNIMPLEMENTED_CASE(FloatFloatToIntBits /* (F)I */)
-    UNIMPLEMENTED_CASE(FloatIsInfinite /* (F)Z */)
-    UNIMPLEMENTED_CASE(FloatIsNaN /* (F)Z */)
-    UNIMPLEMENTED_CASE(FloatIntBitsToFloat /* (I)F */)
+    INTRINSIC_CASE(DoubleDoubleToRawLongBits)
+    INTRINSIC_CASE(DoubleDoubleToLongBits)
+    INTRINSIC_CASE(DoubleIsInfinite)
+    INTRINSIC_CASE(DoubleIsNaN)
+    INTRINSIC_CASE(DoubleLongBitsToDouble)
+    INTRINSIC_CASE(FloatFloatToRawIntBits)
+    INTRINSIC_CASE(FloatFloatToIntBits)
+    INTRINSIC_CASE(FloatIsInfinite)
+    INTRINSIC_CASE(FloatIsNaN)
+    INTRINSIC_CASE(FloatIntBitsToFloat)
     INTRINSIC_CASE(IntegerReverse)
     INTRINSIC_CASE(IntegerReverseBytes)
     INTRINSIC_CASE(IntegerBitCount)
@@ -456,12 +738,12 @@ bool MterpHandleIntrinsic(ShadowFrame* shadow_frame,
     INTRINSIC_CASE(MathAbsFloat)
     INTRINSIC_CASE(MathAbsLong)
     INTRINSIC_CASE(MathAbsInt)
-    UNIMPLEMENTED_CASE(MathMinDoubleDouble /* (DD)D */)
-    UNIMPLEMENTED_CASE(MathMinFloatFloat /* (FF)F */)
+    INTRINSIC_CASE(MathMinDoubleDouble)
+    INTRINSIC_CASE(MathMinFloatFloat)
     INTRINSIC_CASE(MathMinLongLong)
     INTRINSIC_CASE(MathMinIntInt)
-    UNIMPLEMENTED_CASE(MathMaxDoubleDouble /* (DD)D */)
-    UNIMPLEMENTED_CASE(MathMaxFloatFloat /* (FF)F */)
+    INTRINSIC_CASE(MathMaxDoubleDouble)
+    INTRINSIC_CASE(MathMaxFloatFloat)
     INTRINSIC_CASE(MathMaxLongLong)
     INTRINSIC_CASE(MathMaxIntInt)
     INTRINSIC_CASE(MathCos)
@@ -469,35 +751,35 @@ bool MterpHandleIntrinsic(ShadowFrame* shadow_frame,
     INTRINSIC_CASE(MathAcos)
     INTRINSIC_CASE(MathAsin)
     INTRINSIC_CASE(MathAtan)
-    UNIMPLEMENTED_CASE(MathAtan2 /* (DD)D */)
-    UNIMPLEMENTED_CASE(MathCbrt /* (D)D */)
-    UNIMPLEMENTED_CASE(MathCosh /* (D)D */)
-    UNIMPLEMENTED_CASE(MathExp /* (D)D */)
-    UNIMPLEMENTED_CASE(MathExpm1 /* (D)D */)
-    UNIMPLEMENTED_CASE(MathHypot /* (DD)D */)
-    UNIMPLEMENTED_CASE(MathLog /* (D)D */)
-    UNIMPLEMENTED_CASE(MathLog10 /* (D)D */)
-    UNIMPLEMENTED_CASE(MathNextAfter /* (DD)D */)
-    UNIMPLEMENTED_CASE(MathSinh /* (D)D */)
+    INTRINSIC_CASE(MathAtan2)
+    INTRINSIC_CASE(MathCbrt)
+    INTRINSIC_CASE(MathCosh)
+    INTRINSIC_CASE(MathExp)
+    INTRINSIC_CASE(MathExpm1)
+    INTRINSIC_CASE(MathHypot)
+    INTRINSIC_CASE(MathLog)
+    INTRINSIC_CASE(MathLog10)
+    INTRINSIC_CASE(MathNextAfter)
+    INTRINSIC_CASE(MathSinh)
     INTRINSIC_CASE(MathTan)
-    UNIMPLEMENTED_CASE(MathTanh /* (D)D */)
+    INTRINSIC_CASE(MathTanh)
     INTRINSIC_CASE(MathSqrt)
     INTRINSIC_CASE(MathCeil)
     INTRINSIC_CASE(MathFloor)
-    UNIMPLEMENTED_CASE(MathRint /* (D)D */)
+    INTRINSIC_CASE(MathRint)
     UNIMPLEMENTED_CASE(MathRoundDouble /* (D)J */)
     UNIMPLEMENTED_CASE(MathRoundFloat /* (F)I */)
-    UNIMPLEMENTED_CASE(SystemArrayCopyChar /* ([CI[CII)V */)
+    INTRINSIC_CASE(SystemArrayCopyChar)
     UNIMPLEMENTED_CASE(SystemArrayCopy /* (Ljava/lang/Object;ILjava/lang/Object;II)V */)
-    UNIMPLEMENTED_CASE(ThreadCurrentThread /* ()Ljava/lang/Thread; */)
-    UNIMPLEMENTED_CASE(MemoryPeekByte /* (J)B */)
-    UNIMPLEMENTED_CASE(MemoryPeekIntNative /* (J)I */)
-    UNIMPLEMENTED_CASE(MemoryPeekLongNative /* (J)J */)
-    UNIMPLEMENTED_CASE(MemoryPeekShortNative /* (J)S */)
-    UNIMPLEMENTED_CASE(MemoryPokeByte /* (JB)V */)
-    UNIMPLEMENTED_CASE(MemoryPokeIntNative /* (JI)V */)
-    UNIMPLEMENTED_CASE(MemoryPokeLongNative /* (JJ)V */)
-    UNIMPLEMENTED_CASE(MemoryPokeShortNative /* (JS)V */)
+    INTRINSIC_CASE(ThreadCurrentThread)
+    INTRINSIC_CASE(MemoryPeekByte)
+    INTRINSIC_CASE(MemoryPeekIntNative)
+    INTRINSIC_CASE(MemoryPeekLongNative)
+    INTRINSIC_CASE(MemoryPeekShortNative)
+    INTRINSIC_CASE(MemoryPokeByte)
+    INTRINSIC_CASE(MemoryPokeIntNative)
+    INTRINSIC_CASE(MemoryPokeLongNative)
+    INTRINSIC_CASE(MemoryPokeShortNative)
     INTRINSIC_CASE(StringCharAt)
     INTRINSIC_CASE(StringCompareTo)
     INTRINSIC_CASE(StringEquals)
@@ -520,18 +802,18 @@ bool MterpHandleIntrinsic(ShadowFrame* shadow_frame,
     UNIMPLEMENTED_CASE(UnsafeCASInt /* (Ljava/lang/Object;JII)Z */)
     UNIMPLEMENTED_CASE(UnsafeCASLong /* (Ljava/lang/Object;JJJ)Z */)
     UNIMPLEMENTED_CASE(UnsafeCASObject /* (Ljava/lang/Object;JLjava/lang/Object;Ljava/lang/Object;)Z */)
-    UNIMPLEMENTED_CASE(UnsafeGet /* (Ljava/lang/Object;J)I */)
-    UNIMPLEMENTED_CASE(UnsafeGetVolatile /* (Ljava/lang/Object;J)I */)
-    UNIMPLEMENTED_CASE(UnsafeGetObject /* (Ljava/lang/Object;J)Ljava/lang/Object; */)
-    UNIMPLEMENTED_CASE(UnsafeGetObjectVolatile /* (Ljava/lang/Object;J)Ljava/lang/Object; */)
-    UNIMPLEMENTED_CASE(UnsafeGetLong /* (Ljava/lang/Object;J)J */)
-    UNIMPLEMENTED_CASE(UnsafeGetLongVolatile /* (Ljava/lang/Object;J)J */)
-    UNIMPLEMENTED_CASE(UnsafePut /* (Ljava/lang/Object;JI)V */)
-    UNIMPLEMENTED_CASE(UnsafePutOrdered /* (Ljava/lang/Object;JI)V */)
-    UNIMPLEMENTED_CASE(UnsafePutVolatile /* (Ljava/lang/Object;JI)V */)
-    UNIMPLEMENTED_CASE(UnsafePutObject /* (Ljava/lang/Object;JLjava/lang/Object;)V */)
-    UNIMPLEMENTED_CASE(UnsafePutObjectOrdered /* (Ljava/lang/Object;JLjava/lang/Object;)V */)
-    UNIMPLEMENTED_CASE(UnsafePutObjectVolatile /* (Ljava/lang/Object;JLjava/lang/Object;)V */)
+    INTRINSIC_CASE(UnsafeGet)
+    INTRINSIC_CASE(UnsafeGetVolatile)
+    INTRINSIC_CASE(UnsafeGetObject)
+    INTRINSIC_CASE(UnsafeGetObjectVolatile)
+    INTRINSIC_CASE(UnsafeGetLong)
+    INTRINSIC_CASE(UnsafeGetLongVolatile)
+    INTRINSIC_CASE(UnsafePut)
+    INTRINSIC_CASE(UnsafePutOrdered)
+    INTRINSIC_CASE(UnsafePutVolatile)
+    INTRINSIC_CASE(UnsafePutObject)
+    INTRINSIC_CASE(UnsafePutObjectOrdered)
+    INTRINSIC_CASE(UnsafePutObjectVolatile)
     UNIMPLEMENTED_CASE(UnsafePutLong /* (Ljava/lang/Object;JJ)V */)
     UNIMPLEMENTED_CASE(UnsafePutLongOrdered /* (Ljava/lang/Object;JJ)V */)
     UNIMPLEMENTED_CASE(UnsafePutLongVolatile /* (Ljava/lang/Object;JJ)V */)
@@ -540,12 +822,19 @@ bool MterpHandleIntrinsic(ShadowFrame* shadow_frame,
     UNIMPLEMENTED_CASE(UnsafeGetAndSetInt /* (Ljava/lang/Object;JI)I */)
     UNIMPLEMENTED_CASE(UnsafeGetAndSetLong /* (Ljava/lang/Object;JJ)J */)
     UNIMPLEMENTED_CASE(UnsafeGetAndSetObject /* (Ljava/lang/Object;JLjava/lang/Object;)Ljava/lang/Object; */)
-    UNIMPLEMENTED_CASE(UnsafeLoadFence /* ()V */)
-    UNIMPLEMENTED_CASE(UnsafeStoreFence /* ()V */)
-    UNIMPLEMENTED_CASE(UnsafeFullFence /* ()V */)
+    INTRINSIC_CASE(UnsafeLoadFence)
+    INTRINSIC_CASE(UnsafeStoreFence)
+    INTRINSIC_CASE(UnsafeFullFence)
     UNIMPLEMENTED_CASE(ReferenceGetReferent /* ()Ljava/lang/Object; */)
     UNIMPLEMENTED_CASE(IntegerValueOf /* (I)Ljava/lang/Integer; */)
-    UNIMPLEMENTED_CASE(ThreadInterrupted /* ()Z */)
+    UNIMPLEMENTED_CASE(LongValueOf /* (J)Ljava/lang/Long; */)
+    UNIMPLEMENTED_CASE(ShortValueOf /* (S)Ljava/lang/Short; */)
+    UNIMPLEMENTED_CASE(CharacterValueOf /* (C)Ljava/lang/Character; */)
+    UNIMPLEMENTED_CASE(IntegerIntValue /* ()I */)
+    UNIMPLEMENTED_CASE(LongLongValue /* ()J */)
+    UNIMPLEMENTED_CASE(ShortShortValue /* ()S */)
+    UNIMPLEMENTED_CASE(CharacterCharValue /* ()C */)
+    INTRINSIC_CASE(ThreadInterrupted)
     INTRINSIC_CASE(VarHandleFullFence)
     INTRINSIC_CASE(VarHandleAcquireFence)
     INTRINSIC_CASE(VarHandleReleaseFence)
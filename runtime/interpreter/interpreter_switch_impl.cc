@@ -102,6 +102,13 @@ namespace interpreter {
     }                                                                                          \
   } while (false)
 
+#define BRANCH_PROFILE(taken)                                                                  \
+  do {                                                                                         \
+    if (jit != nullptr) {                                                                      \
+      jit->Branch(method, dex_pc, taken);                                                      \
+    }                                                                                          \
+  } while (false)
+
 #define HANDLE_ASYNC_EXCEPTION()                                                               \
   if (UNLIKELY(self->ObserveAsyncException())) {                                               \
     HANDLE_PENDING_EXCEPTION();                                                                \
@@ -872,10 +879,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) ==
             shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -886,10 +895,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) !=
             shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -900,10 +911,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) <
             shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -914,10 +927,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) >=
             shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -928,10 +943,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) >
         shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -942,10 +959,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         if (shadow_frame.GetVReg(inst->VRegA_22t(inst_data)) <=
             shadow_frame.GetVReg(inst->VRegB_22t(inst_data))) {
           int16_t offset = inst->VRegC_22t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -955,10 +974,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) == 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -968,10 +989,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) != 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -981,10 +1004,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) < 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -994,10 +1019,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) >= 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -1007,10 +1034,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) > 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
@@ -1020,10 +1049,12 @@ JValue ExecuteSwitchImpl(Thread* self, const CodeItemDataAccessor& accessor,
         PREAMBLE();
         if (shadow_frame.GetVReg(inst->VRegA_21t(inst_data)) <= 0) {
           int16_t offset = inst->VRegB_21t();
+          BRANCH_PROFILE(true);
           BRANCH_INSTRUMENTATION(offset);
           inst = inst->RelativeAt(offset);
           HANDLE_BACKWARD_BRANCH(offset);
         } else {
+          BRANCH_PROFILE(false);
           BRANCH_INSTRUMENTATION(2);
           inst = inst->Next_2xx();
         }
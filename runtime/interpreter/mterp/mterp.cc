@@ -20,6 +20,7 @@
 #include "mterp.h"
 #include "debugger.h"
 #include "entrypoints/entrypoint_utils-inl.h"
+#include "interpreter/interpreter_cache.h"
 #include "interpreter/interpreter_common.h"
 #include "interpreter/interpreter_intrinsics.h"
 
@@ -143,11 +144,25 @@ extern "C" ssize_t MterpDoPackedSwitch(const uint16_t* switchData, int32_t testV
   return entries[index];
 }
 
+// Returns whether listeners which mterp does not report to are installed. The exception thrown,
+// exception handled and method unwind events are reported by MterpHandleException() through
+// MoveToExceptionHandler(), like the switch interpreter does, and the method entry events by the
+// caller.
+static bool HasListenersUnsupportedByMterp(const instrumentation::Instrumentation* instrumentation)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  return instrumentation->HasDexPcListeners() ||
+      instrumentation->HasMethodExitListeners() ||
+      instrumentation->HasFieldReadListeners() ||
+      instrumentation->HasFieldWriteListeners() ||
+      instrumentation->HasBranchListeners() ||
+      instrumentation->HasWatchedFramePopListeners();
+}
+
 extern "C" size_t MterpShouldSwitchInterpreters()
     REQUIRES_SHARED(Locks::mutator_lock_) {
   const Runtime* const runtime = Runtime::Current();
   const instrumentation::Instrumentation* const instrumentation = runtime->GetInstrumentation();
-  return instrumentation->NonJitProfilingActive() ||
+  return HasListenersUnsupportedByMterp(instrumentation) ||
       Dbg::IsDebuggerActive() ||
       // An async exception has been thrown. We need to go to the switch interpreter. MTerp doesn't
       // know how to deal with these so we could end up never dealing with it if we are in an
@@ -677,11 +692,82 @@ extern "C" size_t MterpSuspendCheck(Thread* self)
   return MterpShouldSwitchInterpreters();
 }
 
+// Finds the offset of the instance field accessed by the current instruction of mterp, first in
+// the interpreter cache of the thread, which plays the role of the quickened instructions
+// without writing to the dex code. Returns false if the access must go through the slow path,
+// as for unresolved or volatile fields.
+template <FindFieldType kType, size_t kSize>
+ALWAYS_INLINE static bool MterpFindInstanceFieldOffset(uint32_t field_idx,
+                                                       ArtMethod* referrer,
+                                                       Thread* self,
+                                                       /* out */ MemberOffset* offset)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  // Mterp exports the dex pc before calling the field access helpers.
+  ShadowFrame* shadow_frame = self->GetManagedStack()->GetTopShadowFrame();
+  DCHECK_EQ(shadow_frame->GetMethod(), referrer);
+  const uint16_t* dex_pc_ptr = shadow_frame->GetDexPCPtr();
+  DCHECK(dex_pc_ptr != nullptr);
+  InterpreterCache* cache = self->GetInterpreterCache();
+  size_t value;
+  if (LIKELY(cache->Get(dex_pc_ptr, &value))) {
+    *offset = MemberOffset(value);
+    return true;
+  }
+  ArtField* field = FindFieldFast(field_idx, referrer, kType, kSize);
+  if (field == nullptr || field->IsVolatile()) {
+    return false;
+  }
+  *offset = field->GetOffset();
+  cache->Set(dex_pc_ptr, offset->SizeValue());
+  return true;
+}
+
+#define ART_GET_FIELD_FROM_MTERP(Kind, PrimitiveType, RetType, PrimitiveOrObject, Getter)     \
+  extern "C" RetType artGet ## Kind ## InstanceFromCode(uint32_t field_idx,                  \
+                                                        mirror::Object* obj,                 \
+                                                        ArtMethod* referrer,                 \
+                                                        Thread* self);                       \
+                                                                                             \
+  extern "C" RetType artGet ## Kind ## InstanceFromMterp(uint32_t field_idx,                 \
+                                                         mirror::Object* obj,                \
+                                                         ArtMethod* referrer,                \
+                                                         Thread* self)                       \
+      REQUIRES_SHARED(Locks::mutator_lock_) {                                                \
+    MemberOffset offset(0u);                                                                 \
+    if (LIKELY(obj != nullptr) &&                                                            \
+        MterpFindInstanceFieldOffset<Instance ## PrimitiveOrObject ## Read,                  \
+                                     sizeof(PrimitiveType)>(field_idx, referrer, self,       \
+                                                            &offset)) {                      \
+      return obj->Getter(offset);                                                            \
+    }                                                                                        \
+    /* Resolves the field or throws. */                                                      \
+    return artGet ## Kind ## InstanceFromCode(field_idx, obj, referrer, self);               \
+  }
+
+ART_GET_FIELD_FROM_MTERP(Byte, int8_t, ssize_t, Primitive, GetFieldByte)
+ART_GET_FIELD_FROM_MTERP(Boolean, int8_t, size_t, Primitive, GetFieldBoolean)
+ART_GET_FIELD_FROM_MTERP(Short, int16_t, ssize_t, Primitive, GetFieldShort)
+ART_GET_FIELD_FROM_MTERP(Char, int16_t, size_t, Primitive, GetFieldChar)
+ART_GET_FIELD_FROM_MTERP(32, int32_t, size_t, Primitive, GetField32)
+ART_GET_FIELD_FROM_MTERP(64, int64_t, uint64_t, Primitive, GetField64)
+ART_GET_FIELD_FROM_MTERP(Obj, mirror::HeapReference<mirror::Object>, mirror::Object*, Object,
+                         GetFieldObject<mirror::Object>)
+
+#undef ART_GET_FIELD_FROM_MTERP
+
 extern "C" ssize_t artSet8InstanceFromMterp(uint32_t field_idx,
                                             mirror::Object* obj,
                                             uint8_t new_value,
                                             ArtMethod* referrer)
     REQUIRES_SHARED(Locks::mutator_lock_) {
+  MemberOffset offset(0u);
+  if (LIKELY(obj != nullptr) &&
+      MterpFindInstanceFieldOffset<InstancePrimitiveWrite, sizeof(int8_t)>(
+          field_idx, referrer, Thread::Current(), &offset)) {
+    // Booleans and bytes are stored the same way.
+    obj->SetFieldBoolean<false>(offset, new_value);
+    return 0;  // success
+  }
   ArtField* field = FindFieldFast(field_idx, referrer, InstancePrimitiveWrite, sizeof(int8_t));
   if (LIKELY(field != nullptr && obj != nullptr)) {
     Primitive::Type type = field->GetTypeAsPrimitiveType();
@@ -701,6 +787,14 @@ extern "C" ssize_t artSet16InstanceFromMterp(uint32_t field_idx,
                                              uint16_t new_value,
                                              ArtMethod* referrer)
     REQUIRES_SHARED(Locks::mutator_lock_) {
+  MemberOffset offset(0u);
+  if (LIKELY(obj != nullptr) &&
+      MterpFindInstanceFieldOffset<InstancePrimitiveWrite, sizeof(int16_t)>(
+          field_idx, referrer, Thread::Current(), &offset)) {
+    // Chars and shorts are stored the same way.
+    obj->SetFieldChar<false>(offset, new_value);
+    return 0;  // success
+  }
   ArtField* field = FindFieldFast(field_idx, referrer, InstancePrimitiveWrite,
                                           sizeof(int16_t));
   if (LIKELY(field != nullptr && obj != nullptr)) {
@@ -721,6 +815,13 @@ extern "C" ssize_t artSet32InstanceFromMterp(uint32_t field_idx,
                                              uint32_t new_value,
                                              ArtMethod* referrer)
     REQUIRES_SHARED(Locks::mutator_lock_) {
+  MemberOffset offset(0u);
+  if (LIKELY(obj != nullptr) &&
+      MterpFindInstanceFieldOffset<InstancePrimitiveWrite, sizeof(int32_t)>(
+          field_idx, referrer, Thread::Current(), &offset)) {
+    obj->SetField32<false>(offset, new_value);
+    return 0;  // success
+  }
   ArtField* field = FindFieldFast(field_idx, referrer, InstancePrimitiveWrite,
                                           sizeof(int32_t));
   if (LIKELY(field != nullptr && obj != nullptr)) {
@@ -735,6 +836,13 @@ extern "C" ssize_t artSet64InstanceFromMterp(uint32_t field_idx,
                                              uint64_t* new_value,
                                              ArtMethod* referrer)
     REQUIRES_SHARED(Locks::mutator_lock_) {
+  MemberOffset offset(0u);
+  if (LIKELY(obj != nullptr) &&
+      MterpFindInstanceFieldOffset<InstancePrimitiveWrite, sizeof(int64_t)>(
+          field_idx, referrer, Thread::Current(), &offset)) {
+    obj->SetField64<false>(offset, *new_value);
+    return 0;  // success
+  }
   ArtField* field = FindFieldFast(field_idx, referrer, InstancePrimitiveWrite,
                                           sizeof(int64_t));
   if (LIKELY(field != nullptr  && obj != nullptr)) {
@@ -258,6 +258,21 @@ class ShadowFrame {
     }
   }
 
+  // Copies `count` consecutive vregs of `src`, with their references, as for the arguments of a
+  // range invoke. Stale references left by non-moving collectors are copied too, which is fine as
+  // they are roots of `src` anyway.
+  void CopyVRegs(const ShadowFrame& src, size_t src_reg, size_t dest_reg, size_t count)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    DCHECK(HasReferenceArray());
+    DCHECK(src.HasReferenceArray());
+    DCHECK_LE(src_reg + count, src.NumberOfVRegs());
+    DCHECK_LE(dest_reg + count, NumberOfVRegs());
+    memcpy(&vregs_[dest_reg], &src.vregs_[src_reg], count * sizeof(uint32_t));
+    memcpy(References() + dest_reg,
+           src.References() + src_reg,
+           count * sizeof(StackReference<mirror::Object>));
+  }
+
   void SetMethod(ArtMethod* method) REQUIRES(Locks::mutator_lock_) {
     DCHECK(method != nullptr);
     DCHECK(method_ != nullptr);
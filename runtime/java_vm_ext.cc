@@ -54,9 +54,11 @@ namespace art {
 using android::base::StringAppendF;
 using android::base::StringAppendV;
 
-static constexpr size_t kGlobalsMax = 51200;  // Arbitrary sanity check. (Must fit in 16 bits.)
+// The initial capacity of the global reference tables. They grow when full, up to the maximum
+// size of an indirect reference table, which still catches the leaks of an app.
+static constexpr size_t kGlobalsInitial = 51200;
 
-static constexpr size_t kWeakGlobalsMax = 51200;  // Arbitrary sanity check. (Must fit in 16 bits.)
+static constexpr size_t kWeakGlobalsInitial = 51200;
 
 bool JavaVMExt::IsBadJniVersion(int version) {
   // We don't support JNI_VERSION_1_1. These are the only other valid versions.
@@ -459,12 +461,15 @@ JavaVMExt::JavaVMExt(Runtime* runtime,
       tracing_enabled_(runtime_options.Exists(RuntimeArgumentMap::JniTrace)
                        || VLOG_IS_ON(third_party_jni)),
       trace_(runtime_options.GetOrDefault(RuntimeArgumentMap::JniTrace)),
-      globals_(kGlobalsMax, kGlobal, IndirectReferenceTable::ResizableCapacity::kNo, error_msg),
+      globals_(kGlobalsInitial,
+               kGlobal,
+               IndirectReferenceTable::ResizableCapacity::kYes,
+               error_msg),
       libraries_(new Libraries),
       unchecked_functions_(&gJniInvokeInterface),
-      weak_globals_(kWeakGlobalsMax,
+      weak_globals_(kWeakGlobalsInitial,
                     kWeakGlobal,
-                    IndirectReferenceTable::ResizableCapacity::kNo,
+                    IndirectReferenceTable::ResizableCapacity::kYes,
                     error_msg),
       allow_accessing_weak_globals_(true),
       weak_globals_add_condition_("weak globals add condition",
@@ -118,7 +118,7 @@ JDWP::ObjectId ObjectRegistry::InternalAdd(Handle<T> obj_h) {
     entry->reference_count = 1;
     entry->id = next_id_++;
 
-    id_to_entry_.Put(entry->id, entry);
+    id_to_entry_.emplace(entry->id, entry);
 
     env->DeleteLocalRef(local_reference);
   }
@@ -130,8 +130,8 @@ bool ObjectRegistry::ContainsLocked(Thread* self,
                                     int32_t identity_hash_code,
                                     ObjectRegistryEntry** out_entry) {
   DCHECK(o != nullptr);
-  for (auto it = object_to_entry_.lower_bound(identity_hash_code), end = object_to_entry_.end();
-       it != end && it->first == identity_hash_code; ++it) {
+  auto range = object_to_entry_.equal_range(identity_hash_code);
+  for (auto it = range.first; it != range.second; ++it) {
     ObjectRegistryEntry* entry = it->second;
     if (o == self->DecodeJObject(entry->jni_reference)) {
       if (out_entry != nullptr) {
@@ -267,8 +267,8 @@ void ObjectRegistry::DisposeObject(JDWP::ObjectId id, uint32_t reference_count)
     // Erase the object from the maps. Note object may be null if it's
     // a weak ref and the GC has cleared it.
     int32_t hash_code = entry->identity_hash_code;
-    for (auto inner_it = object_to_entry_.lower_bound(hash_code), end = object_to_entry_.end();
-         inner_it != end && inner_it->first == hash_code; ++inner_it) {
+    auto range = object_to_entry_.equal_range(hash_code);
+    for (auto inner_it = range.first; inner_it != range.second; ++inner_it) {
       if (entry == inner_it->second) {
         object_to_entry_.erase(inner_it);
         break;
@@ -279,7 +279,7 @@ void ObjectRegistry::DisposeObject(JDWP::ObjectId id, uint32_t reference_count)
     } else {
       env->DeleteGlobalRef(entry->jni_reference);
     }
-    id_to_entry_.erase(id);
+    id_to_entry_.erase(it);
     delete entry;
   }
 }
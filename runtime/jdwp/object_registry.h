@@ -20,13 +20,12 @@
 #include <jni.h>
 #include <stdint.h>
 
-#include <map>
+#include <unordered_map>
 
 #include "base/casts.h"
 #include "handle.h"
 #include "jdwp/jdwp.h"
 #include "obj_ptr.h"
-#include "safe_map.h"
 
 namespace art {
 
@@ -130,8 +129,10 @@ class ObjectRegistry {
       REQUIRES(lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
   Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
-  std::multimap<int32_t, ObjectRegistryEntry*> object_to_entry_ GUARDED_BY(lock_);
-  SafeMap<JDWP::ObjectId, ObjectRegistryEntry*> id_to_entry_ GUARDED_BY(lock_);
+  // Both maps are hashed so that lookups stay constant time when the debugger references a large
+  // number of objects. Ordering is never needed.
+  std::unordered_multimap<int32_t, ObjectRegistryEntry*> object_to_entry_ GUARDED_BY(lock_);
+  std::unordered_map<JDWP::ObjectId, ObjectRegistryEntry*> id_to_entry_ GUARDED_BY(lock_);
 
   size_t next_id_ GUARDED_BY(lock_);
 };
@@ -18,6 +18,7 @@
 
 #include <android-base/logging.h>
 
+#include "atomic.h"
 #include "base/mutex.h"
 #include "thread-current-inl.h"
 #include "thread.h"
@@ -71,11 +72,10 @@ extern "C" {
 
 static Mutex g_jit_debug_mutex("JIT debug interface lock", kJitDebugInterfaceLock);
 
-static JITCodeEntry* CreateJITCodeEntryInternal(std::vector<uint8_t> symfile)
-    REQUIRES(g_jit_debug_mutex) {
+// Makes a copy of the buffer, since we want to shrink it anyway. This is done before taking
+// g_jit_debug_mutex so that other threads registering or removing code do not wait for it.
+static JITCodeEntry* AllocateJITCodeEntry(const std::vector<uint8_t>& symfile) {
   DCHECK_NE(symfile.size(), 0u);
-
-  // Make a copy of the buffer. We want to shrink it anyway.
   uint8_t* symfile_copy = new uint8_t[symfile.size()];
   CHECK(symfile_copy != nullptr);
   memcpy(symfile_copy, symfile.data(), symfile.size());
@@ -84,6 +84,11 @@ static JITCodeEntry* CreateJITCodeEntryInternal(std::vector<uint8_t> symfile)
   CHECK(entry != nullptr);
   entry->symfile_addr_ = symfile_copy;
   entry->symfile_size_ = symfile.size();
+  return entry;
+}
+
+static JITCodeEntry* RegisterJITCodeEntryInternal(JITCodeEntry* entry)
+    REQUIRES(g_jit_debug_mutex) {
   entry->prev_ = nullptr;
 
   entry->next_ = __jit_debug_descriptor.first_entry_;
@@ -117,9 +122,10 @@ static void DeleteJITCodeEntryInternal(JITCodeEntry* entry) REQUIRES(g_jit_debug
 }
 
 JITCodeEntry* CreateJITCodeEntry(std::vector<uint8_t> symfile) {
+  JITCodeEntry* entry = AllocateJITCodeEntry(symfile);
   Thread* self = Thread::Current();
   MutexLock mu(self, g_jit_debug_mutex);
-  return CreateJITCodeEntryInternal(std::move(symfile));
+  return RegisterJITCodeEntryInternal(entry);
 }
 
 void DeleteJITCodeEntry(JITCodeEntry* entry) {
@@ -132,16 +138,25 @@ void DeleteJITCodeEntry(JITCodeEntry* entry) {
 // so that the user of the JIT interface does not have to store them.
 static std::unordered_map<uintptr_t, JITCodeEntry*> g_jit_code_entries;
 
+// Size of g_jit_code_entries. The JIT code cache removes the entry of every method it frees,
+// so this lets it skip the lock when no debug info was generated, which is the common case.
+static Atomic<size_t> g_jit_num_code_entries(0u);
+
 void CreateJITCodeEntryForAddress(uintptr_t address, std::vector<uint8_t> symfile) {
+  JITCodeEntry* entry = AllocateJITCodeEntry(symfile);
   Thread* self = Thread::Current();
   MutexLock mu(self, g_jit_debug_mutex);
   DCHECK_NE(address, 0u);
   DCHECK(g_jit_code_entries.find(address) == g_jit_code_entries.end());
-  JITCodeEntry* entry = CreateJITCodeEntryInternal(std::move(symfile));
+  RegisterJITCodeEntryInternal(entry);
   g_jit_code_entries.emplace(address, entry);
+  g_jit_num_code_entries.StoreRelaxed(g_jit_code_entries.size());
 }
 
 bool DeleteJITCodeEntryForAddress(uintptr_t address) {
+  if (g_jit_num_code_entries.LoadRelaxed() == 0u) {
+    return false;
+  }
   Thread* self = Thread::Current();
   MutexLock mu(self, g_jit_debug_mutex);
   const auto it = g_jit_code_entries.find(address);
@@ -150,6 +165,7 @@ bool DeleteJITCodeEntryForAddress(uintptr_t address) {
   }
   DeleteJITCodeEntryInternal(it->second);
   g_jit_code_entries.erase(it);
+  g_jit_num_code_entries.StoreRelaxed(g_jit_code_entries.size());
   return true;
 }
 
@@ -23,8 +23,12 @@
 #include "base/logging.h"  // For VLOG.
 #include "base/memory_tool.h"
 #include "base/runtime_debug.h"
+#include "base/systrace.h"
+#include "base/time_utils.h"
+#include "cha.h"
 #include "debugger.h"
 #include "entrypoints/runtime_asm_entrypoints.h"
+#include "handle_scope-inl.h"
 #include "interpreter/interpreter.h"
 #include "java_vm_ext.h"
 #include "jit_code_cache.h"
@@ -33,6 +37,7 @@
 #include "profile_compilation_info.h"
 #include "profile_saver.h"
 #include "runtime.h"
+#include "runtime_counters.h"
 #include "runtime_options.h"
 #include "stack.h"
 #include "stack_map.h"
@@ -57,7 +62,7 @@ void* Jit::jit_library_handle_ = nullptr;
 void* Jit::jit_compiler_handle_ = nullptr;
 void* (*Jit::jit_load_)(bool*) = nullptr;
 void (*Jit::jit_unload_)(void*) = nullptr;
-bool (*Jit::jit_compile_method_)(void*, ArtMethod*, Thread*, bool) = nullptr;
+bool (*Jit::jit_compile_method_)(void*, ArtMethod*, Thread*, bool, bool) = nullptr;
 void (*Jit::jit_types_loaded_)(void*, mirror::Class**, size_t count) = nullptr;
 bool Jit::generate_debug_info_ = false;
 
@@ -76,6 +81,8 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
       options.GetOrDefault(RuntimeArgumentMap::JITCodeCacheMaxCapacity);
   jit_options->dump_info_on_shutdown_ =
       options.Exists(RuntimeArgumentMap::DumpJITInfoOnShutdown);
+  jit_options->precompile_hot_methods_ =
+      options.Exists(RuntimeArgumentMap::JITPrecompileHotMethods);
   jit_options->profile_saver_options_ =
       options.GetOrDefault(RuntimeArgumentMap::ProfileSaverOpts);
 
@@ -142,6 +149,31 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
         static_cast<size_t>(1));
   }
 
+  if (options.Exists(RuntimeArgumentMap::JITSamplePeriod)) {
+    jit_options->sample_period_ = *options.Get(RuntimeArgumentMap::JITSamplePeriod);
+    if (jit_options->sample_period_ > jit_options->warmup_threshold_) {
+      LOG(FATAL) << "JIT sample period is above the warmup threshold.";
+    } else if (jit_options->sample_period_ == 0) {
+      LOG(FATAL) << "JIT sample period cannot be 0.";
+    }
+  } else {
+    jit_options->sample_period_ = std::min(
+        std::max(jit_options->warmup_threshold_ / Jit::kDefaultSamplePeriodRatio,
+                 static_cast<size_t>(1)),
+        Jit::kMaxDefaultSamplePeriod);
+  }
+
+  jit_options->thread_pool_size_ = options.GetOrDefault(RuntimeArgumentMap::JITThreadPoolSize);
+  if (jit_options->thread_pool_size_ == 0) {
+    LOG(FATAL) << "JIT thread pool size cannot be 0.";
+  }
+
+  jit_options->optimize_threshold_ =
+      options.GetOrDefault(RuntimeArgumentMap::JITOptimizeThreshold);
+  if (jit_options->optimize_threshold_ > std::numeric_limits<uint16_t>::max()) {
+    LOG(FATAL) << "Method optimization threshold is above its internal limit.";
+  }
+
   return jit_options;
 }
 
@@ -152,6 +184,7 @@ bool Jit::ShouldUsePriorityThreadWeight(Thread* self) {
 void Jit::DumpInfo(std::ostream& os) {
   code_cache_->Dump(os);
   cumulative_timings_.Dump(os);
+  os << "JIT cancelled compilations=" << cancelled_compile_tasks_.LoadRelaxed() << "\n";
   MutexLock mu(Thread::Current(), lock_);
   memory_use_.PrintMemoryUse(os);
 }
@@ -174,7 +207,13 @@ Jit::Jit() : dump_info_on_shutdown_(false),
              warm_method_threshold_(0),
              osr_method_threshold_(0),
              priority_thread_weight_(0),
-             invoke_transition_weight_(0) {}
+             invoke_transition_weight_(0),
+             sample_period_(1),
+             optimize_threshold_(0),
+             thread_pool_size_(1),
+             cancelled_compile_tasks_(0u),
+             precompile_hot_methods_(false),
+             precompile_lock_("JIT precompile lock") {}
 
 Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   DCHECK(options->UseJitCompilation() || options->GetProfileSaverOptions().IsEnabled());
@@ -187,6 +226,7 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
       options->GetCodeCacheInitialCapacity(),
       options->GetCodeCacheMaxCapacity(),
       jit->generate_debug_info_,
+      /* baseline_code_segment */ options->GetOptimizeThreshold() != 0u,
       error_msg));
   if (jit->GetCodeCache() == nullptr) {
     return nullptr;
@@ -205,6 +245,10 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   jit->osr_method_threshold_ = options->GetOsrThreshold();
   jit->priority_thread_weight_ = options->GetPriorityThreadWeight();
   jit->invoke_transition_weight_ = options->GetInvokeTransitionWeight();
+  jit->sample_period_ = options->GetSamplePeriod();
+  jit->optimize_threshold_ = options->GetOptimizeThreshold();
+  jit->thread_pool_size_ = options->GetThreadPoolSize();
+  jit->precompile_hot_methods_ = options->PrecompileHotMethods() && jit->use_jit_compilation_;
 
   jit->CreateThreadPool();
 
@@ -235,7 +279,7 @@ bool Jit::LoadCompilerLibrary(std::string* error_msg) {
     *error_msg = "JIT couldn't find jit_unload entry point";
     return false;
   }
-  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*, bool)>(
+  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*, bool, bool)>(
       dlsym(jit_library_handle_, "jit_compile_method"));
   if (jit_compile_method_ == nullptr) {
     dlclose(jit_library_handle_);
@@ -269,9 +313,10 @@ bool Jit::LoadCompiler(std::string* error_msg) {
   return true;
 }
 
-bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
+bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr, bool baseline) {
   DCHECK(Runtime::Current()->UseJitCompilation());
   DCHECK(!method->IsRuntimeMethod());
+  DCHECK(!osr || !baseline);
 
   RuntimeCallbacks* cb = Runtime::Current()->GetRuntimeCallbacks();
   // Don't compile the method if it has breakpoints.
@@ -292,19 +337,51 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
   // If we get a request to compile a proxy method, we pass the actual Java method
   // of that proxy method, as the compiler does not expect a proxy method.
   ArtMethod* method_to_compile = method->GetInterfaceMethodIfProxy(kRuntimePointerSize);
-  if (!code_cache_->NotifyCompilationOf(method_to_compile, self, osr)) {
+  // Native methods only have a stub to compile, and baseline code counts its invocations in
+  // the profiling info, which may have failed to allocate.
+  baseline = baseline &&
+      !method_to_compile->IsNative() &&
+      method_to_compile->GetProfilingInfo(kRuntimePointerSize) != nullptr;
+  if (!code_cache_->NotifyCompilationOf(method_to_compile, self, osr, baseline)) {
     return false;
   }
+  // The optimized code replaces baseline code, whose frames looping at the time keep running it.
+  OatQuickMethodHeader* baseline_method_header = nullptr;
+  if (!osr && !baseline && code_cache_->IsBaselineCompiled(method_to_compile)) {
+    baseline_method_header = OatQuickMethodHeader::FromEntryPoint(
+        method_to_compile->GetEntryPointFromQuickCompiledCode());
+  }
+  if (baseline) {
+    // The baseline code requests the optimized compilation when the count wraps around.
+    ProfilingInfo* info = method_to_compile->GetProfilingInfo(kRuntimePointerSize);
+    info->SetBaselineHotnessCount(
+        static_cast<uint16_t>(std::numeric_limits<uint16_t>::max() - optimize_threshold_ + 1u));
+  }
 
   VLOG(jit) << "Compiling method "
             << ArtMethod::PrettyMethod(method_to_compile)
-            << " osr=" << std::boolalpha << osr;
-  bool success = jit_compile_method_(jit_compiler_handle_, method_to_compile, self, osr);
+            << " osr=" << std::boolalpha << osr
+            << " baseline=" << baseline;
+  ScopedTrace trace(TraceCategory::kJit, [&]() {
+    return "JIT compiling " + ArtMethod::PrettyMethod(method_to_compile);
+  });
+  const uint64_t start_time = NanoTime();
+  bool success =
+      jit_compile_method_(jit_compiler_handle_, method_to_compile, self, osr, baseline);
+  RuntimeCounters* counters = Runtime::Current()->GetRuntimeCounters();
+  counters->Increment(self, success ? kCounterJitCompilations : kCounterJitFailures);
+  counters->AddTiming(self, kTimingJitCompile, NsToUs(NanoTime() - start_time));
   code_cache_->DoneCompiling(method_to_compile, self, osr);
   if (!success) {
     VLOG(jit) << "Failed to compile method "
               << ArtMethod::PrettyMethod(method_to_compile)
               << " osr=" << std::boolalpha << osr;
+  } else if (baseline_method_header != nullptr &&
+             baseline_method_header->HasShouldDeoptimizeFlag()) {
+    // Have these frames deoptimize at their next loop header. The interpreter then gets them
+    // into the OSR code of the loop.
+    std::unordered_set<OatQuickMethodHeader*> method_headers = { baseline_method_header };
+    ClassHierarchyAnalysis::DeoptimizeFramesRunning(method_headers);
   }
   if (kIsDebugBuild) {
     if (self->IsExceptionPending()) {
@@ -318,18 +395,50 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
   return success;
 }
 
+// The tasks of the JIT thread pool.
+class JitTask : public Task {
+ public:
+  // Higher values run first.
+  virtual int32_t GetPriority() const = 0;
+};
+
+// A thread pool that runs the most urgent JitTask first instead of the oldest one. The
+// priority is read when a worker takes a task, as the hotness of a queued method keeps changing.
+// The queue is short compared to the time of a compilation, so it is simply scanned.
+class JitThreadPool FINAL : public ThreadPool {
+ public:
+  // The workers are created without waiting for them to attach, see
+  // Jit::WaitForWorkersToBeCreated().
+  JitThreadPool(const char* name, size_t num_threads, bool create_peers)
+      : ThreadPool(name, num_threads, create_peers, /* create_threads */ false) {
+    CreateThreads(num_threads, /* wait_for_workers */ false);
+  }
+
+ protected:
+  Task* TryGetTaskLocked() OVERRIDE REQUIRES(task_queue_lock_);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(JitThreadPool);
+};
+
 void Jit::CreateThreadPool() {
   // There is a DCHECK in the 'AddSamples' method to ensure the tread pool
   // is not null when we instrument.
 
   // We need peers as we may report the JIT thread, e.g., in the debugger.
   constexpr bool kJitPoolNeedsPeers = true;
-  thread_pool_.reset(new ThreadPool("Jit thread pool", 1, kJitPoolNeedsPeers));
+  thread_pool_.reset(new JitThreadPool("Jit thread pool", thread_pool_size_, kJitPoolNeedsPeers));
 
   thread_pool_->SetPthreadPriority(kJitPoolThreadPthreadPriority);
   Start();
 }
 
+void Jit::WaitForWorkersToBeCreated() {
+  if (thread_pool_ != nullptr) {
+    thread_pool_->WaitForWorkersToBeCreated();
+  }
+}
+
 void Jit::DeleteThreadPool() {
   Thread* self = Thread::Current();
   DCHECK(Runtime::Current()->IsShuttingDown(self));
@@ -356,6 +465,11 @@ void Jit::DeleteThreadPool() {
 
 void Jit::StartProfileSaver(const std::string& filename,
                             const std::vector<std::string>& code_paths) {
+  if (precompile_hot_methods_ && thread_pool_ != nullptr) {
+    // Don't delay the startup of the app with reading the profile. The profile is locked while
+    // it is read, which keeps the saver from writing to it at the same time.
+    thread_pool_->AddTask(Thread::Current(), new JitLoadPrecompileProfileTask(filename));
+  }
   if (profile_saver_options_.IsEnabled()) {
     ProfileSaver::Start(profile_saver_options_,
                         filename,
@@ -364,6 +478,101 @@ void Jit::StartProfileSaver(const std::string& filename,
   }
 }
 
+bool Jit::LoadPrecompileProfile(const std::string& filename) {
+  std::unique_ptr<ProfileCompilationInfo> profile(new ProfileCompilationInfo());
+  if (!profile->Load(filename, /* clear_if_invalid */ false)) {
+    // Load() logged why. The methods get hot again as the app runs.
+    return false;
+  }
+  VLOG(jit) << "Precompiling the hot methods of " << filename;
+  MutexLock mu(Thread::Current(), precompile_lock_);
+  precompile_profile_ = std::move(profile);
+  precompile_methods_.clear();
+  return true;
+}
+
+void Jit::PrecompileInitializedClasses(Thread* self) {
+  struct CollectInitializedClasses : public ClassVisitor {
+    bool operator()(ObjPtr<mirror::Class> klass) OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_) {
+      if (klass->IsInitialized()) {
+        classes_.push_back(klass.Ptr());
+      }
+      return true;
+    }
+    std::vector<mirror::Class*> classes_;
+  };
+
+  // The classes initialized while the profile was read didn't find it.
+  CollectInitializedClasses visitor;
+  Runtime::Current()->GetClassLinker()->VisitClasses(&visitor);
+  VariableSizedHandleScope hs(self);
+  std::vector<Handle<mirror::Class>> classes;
+  classes.reserve(visitor.classes_.size());
+  for (mirror::Class* klass : visitor.classes_) {
+    classes.push_back(hs.NewHandle(klass));
+  }
+  for (Handle<mirror::Class> klass : classes) {
+    PrecompileHotMethods(self, klass.Get());
+  }
+}
+
+void Jit::AddPrecompileInlineCaches(Thread* self, ArtMethod* method) {
+  const DexFile* dex_file = method->GetDexFile();
+  // The receiver types seen at each invoke and their weights, when they are in the dex file
+  // of the method.
+  std::vector<std::pair<uint16_t, std::vector<std::pair<dex::TypeIndex, uint16_t>>>>
+      receiver_types;
+  {
+    MutexLock mu(self, precompile_lock_);
+    if (precompile_profile_ == nullptr) {
+      return;
+    }
+    std::unique_ptr<ProfileCompilationInfo::OfflineProfileMethodInfo> info =
+        precompile_profile_->GetMethod(dex_file->GetLocation(),
+                                       dex_file->GetLocationChecksum(),
+                                       method->GetDexMethodIndex());
+    if (info == nullptr) {
+      return;
+    }
+    for (const auto& inline_cache : *info->inline_caches) {
+      std::vector<std::pair<dex::TypeIndex, uint16_t>> types;
+      for (const ProfileCompilationInfo::ClassReference& ref : inline_cache.second.classes) {
+        if (info->dex_references[ref.dex_profile_index].MatchesDex(dex_file)) {
+          types.emplace_back(ref.type_index, inline_cache.second.GetWeight(ref));
+        }
+      }
+      if (!types.empty()) {
+        receiver_types.emplace_back(inline_cache.first, std::move(types));
+      }
+    }
+  }
+  if (receiver_types.empty() ||
+      (method->GetProfilingInfo(kRuntimePointerSize) == nullptr &&
+       !ProfilingInfo::Create(self, method, /* retry_allocation */ false))) {
+    return;
+  }
+  ProfilingInfo* profiling_info = method->GetProfilingInfo(kRuntimePointerSize);
+  if (profiling_info == nullptr) {
+    // The method has no virtual or interface invokes.
+    return;
+  }
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  ScopedAssertNoThreadSuspension sants("Adding precompile inline caches");
+  for (const auto& pair : receiver_types) {
+    if (!profiling_info->HasInlineCache(pair.first)) {
+      continue;
+    }
+    for (const std::pair<dex::TypeIndex, uint16_t>& type : pair.second) {
+      // Only the classes loaded already, the compiler doesn't inline for the others anyway.
+      ObjPtr<mirror::Class> klass = class_linker->LookupResolvedType(type.first, method);
+      if (klass != nullptr) {
+        // Profiles without weights still count the class once.
+        profiling_info->AddInvokeInfo(pair.first, klass.Ptr(), std::max<uint16_t>(type.second, 1u));
+      }
+    }
+  }
+}
+
 void Jit::StopProfileSaver() {
   if (profile_saver_options_.IsEnabled() && ProfileSaver::IsStarted()) {
     ProfileSaver::Stop(dump_info_on_shutdown_);
@@ -407,6 +616,14 @@ void Jit::NewTypeLoadedIfUsingJit(mirror::Class* type) {
   }
 }
 
+void Jit::NewTypeInitializedIfUsingJit(mirror::Class* klass) {
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit == nullptr || !jit->precompile_hot_methods_) {
+    return;
+  }
+  jit->PrecompileHotMethods(Thread::Current(), klass);
+}
+
 void Jit::DumpTypeInfoForLoadedTypes(ClassLinker* linker) {
   struct CollectClasses : public ClassVisitor {
     bool operator()(ObjPtr<mirror::Class> klass) OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_) {
@@ -591,12 +808,44 @@ void Jit::AddMemoryUsage(ArtMethod* method, size_t bytes) {
   memory_use_.AddValue(bytes);
 }
 
-class JitCompileTask FINAL : public Task {
+void Jit::AddCompilationRecord(JitCompilationRecord&& record) {
+  MutexLock mu(Thread::Current(), lock_);
+  if (compilation_records_.size() == kMaxCompilationRecords) {
+    compilation_records_.pop_front();
+  }
+  compilation_records_.push_back(std::move(record));
+}
+
+std::vector<JitCompilationRecord> Jit::GetCompilationRecords() {
+  MutexLock mu(Thread::Current(), lock_);
+  return std::vector<JitCompilationRecord>(compilation_records_.begin(),
+                                           compilation_records_.end());
+}
+
+void Jit::DumpCompilationRecords(std::ostream& os) {
+  for (const JitCompilationRecord& record : GetCompilationRecords()) {
+    os << record.method
+       << " osr=" << record.osr
+       << " baseline=" << record.baseline
+       << " time=" << PrettyDuration(record.compile_time_ns)
+       << " arena=" << PrettySize(record.arena_bytes)
+       << " code=" << PrettySize(record.code_size)
+       << " inlined=" << record.inlined_invokes;
+    for (const std::pair<std::string, uint64_t>& pass : record.pass_times_ns) {
+      os << " " << pass.first << "=" << PrettyDuration(pass.second);
+    }
+    os << "\n";
+  }
+}
+
+class JitCompileTask FINAL : public JitTask {
  public:
   enum TaskKind {
     kAllocateProfile,
     kCompile,
-    kCompileOsr
+    kCompileOsr,
+    kCompileOptimized,
+    kPrecompile
   };
 
   JitCompileTask(ArtMethod* method, TaskKind kind) : method_(method), kind_(kind) {
@@ -611,9 +860,52 @@ class JitCompileTask FINAL : public Task {
     soa.Vm()->DeleteGlobalRef(soa.Self(), klass_);
   }
 
+  // Higher values run first. Allocating a ProfilingInfo is cheap and lets the method get hot.
+  // An OSR request means a thread is looping in the interpreter right now. Otherwise the hotter
+  // method runs first, the hotness counter keeps counting back edges while the task is queued.
+  // A method that was hot in a previous run hasn't been executed yet in this one. A method
+  // waiting for its optimized code already runs baseline code, so it goes last.
+  int32_t GetPriority() const OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    switch (kind_) {
+      case kAllocateProfile:
+        return std::numeric_limits<int32_t>::max();
+      case kCompileOsr:
+        return std::numeric_limits<uint16_t>::max() + static_cast<int32_t>(method_->GetCounter());
+      case kCompile:
+        return method_->GetCounter();
+      case kPrecompile:
+        return 0;
+      case kCompileOptimized:
+        return -1;
+    }
+    LOG(FATAL) << "Unreachable";
+    UNREACHABLE();
+  }
+
   void Run(Thread* self) OVERRIDE {
     ScopedObjectAccess soa(self);
+    if (IsTraceCategoryEnabled(TraceCategory::kJit)) {
+      // The pool is detached from the JIT, with all threads suspended, before its workers are
+      // stopped.
+      ThreadPool* thread_pool = Runtime::Current()->GetJit()->GetThreadPool();
+      if (thread_pool != nullptr) {
+        TraceCounter(TraceCategory::kJit, "JIT queue depth", thread_pool->GetTaskCount(self));
+      }
+    }
+    if (IsStale()) {
+      VLOG(jit) << "Cancelled compilation of " << method_->PrettyMethod()
+                << " osr=" << std::boolalpha << (kind_ == kCompileOsr);
+      Runtime::Current()->GetJit()->NotifyCompileTaskCancelled();
+      return;
+    }
     if (kind_ == kCompile) {
+      Jit* jit = Runtime::Current()->GetJit();
+      jit->CompileMethod(method_, self, /* osr */ false, jit->UseTieredCompilation());
+    } else if (kind_ == kPrecompile) {
+      Jit* jit = Runtime::Current()->GetJit();
+      jit->AddPrecompileInlineCaches(self, method_);
+      jit->CompileMethod(method_, self, /* osr */ false);
+    } else if (kind_ == kCompileOptimized) {
       Runtime::Current()->GetJit()->CompileMethod(method_, self, /* osr */ false);
     } else if (kind_ == kCompileOsr) {
       Runtime::Current()->GetJit()->CompileMethod(method_, self, /* osr */ true);
@@ -631,6 +923,26 @@ class JitCompileTask FINAL : public Task {
   }
 
  private:
+  // Returns true if the compilation is not needed anymore since it was queued: the method was
+  // compiled already, or its hotness counter was reset by a code cache collection.
+  bool IsStale() const REQUIRES_SHARED(Locks::mutator_lock_) {
+    Jit* jit = Runtime::Current()->GetJit();
+    JitCodeCache* code_cache = jit->GetCodeCache();
+    if (kind_ == kCompileOptimized) {
+      // The baseline code asks again every 64K invocations while the task is queued.
+      return !code_cache->IsBaselineCompiled(method_);
+    } else if (kind_ == kPrecompile) {
+      return code_cache->ContainsPc(method_->GetEntryPointFromQuickCompiledCode());
+    } else if (kind_ == kCompile) {
+      return code_cache->ContainsPc(method_->GetEntryPointFromQuickCompiledCode()) ||
+          method_->GetCounter() < jit->HotMethodThreshold();
+    } else if (kind_ == kCompileOsr) {
+      return code_cache->IsOsrCompiled(method_) ||
+          method_->GetCounter() < jit->OSRMethodThreshold();
+    }
+    return false;
+  }
+
   ArtMethod* const method_;
   const TaskKind kind_;
   jobject klass_;
@@ -638,6 +950,106 @@ class JitCompileTask FINAL : public Task {
   DISALLOW_IMPLICIT_CONSTRUCTORS(JitCompileTask);
 };
 
+// Reads the profile of the previous runs while the app starts up.
+class JitLoadPrecompileProfileTask FINAL : public JitTask {
+ public:
+  explicit JitLoadPrecompileProfileTask(const std::string& filename) : filename_(filename) {}
+
+  // The precompiled methods are about to run.
+  int32_t GetPriority() const OVERRIDE {
+    return std::numeric_limits<int32_t>::max();
+  }
+
+  void Run(Thread* self) OVERRIDE {
+    Jit* jit = Runtime::Current()->GetJit();
+    if (jit->LoadPrecompileProfile(filename_)) {
+      ScopedObjectAccess soa(self);
+      jit->PrecompileInitializedClasses(self);
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  const std::string filename_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(JitLoadPrecompileProfileTask);
+};
+
+Task* JitThreadPool::TryGetTaskLocked() {
+  if (!HasOutstandingTasks()) {
+    return nullptr;
+  }
+  // Only JitTasks are added to the JIT thread pool. Ties go to the oldest task.
+  auto best = tasks_.begin();
+  int32_t best_priority = static_cast<JitTask*>(*best)->GetPriority();
+  for (auto it = best + 1; it != tasks_.end(); ++it) {
+    int32_t priority = static_cast<JitTask*>(*it)->GetPriority();
+    if (priority > best_priority) {
+      best = it;
+      best_priority = priority;
+    }
+  }
+  Task* task = *best;
+  tasks_.erase(best);
+  return task;
+}
+
+void Jit::EnqueueOptimizedCompilation(ArtMethod* method, Thread* self) {
+  if (thread_pool_ == nullptr) {
+    // Should only see this when shutting down.
+    DCHECK(Runtime::Current()->IsShuttingDown(self));
+    return;
+  }
+  VLOG(jit) << "Enqueuing optimized compilation of " << method->PrettyMethod();
+  thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompileOptimized));
+}
+
+void Jit::PrecompileHotMethods(Thread* self, mirror::Class* klass) {
+  if (thread_pool_ == nullptr || klass->IsProxyClass() || klass->GetDexCache() == nullptr) {
+    return;
+  }
+  const DexFile& dex_file = klass->GetDexFile();
+  std::vector<ArtMethod*> methods;
+  {
+    MutexLock mu(self, precompile_lock_);
+    if (precompile_profile_ == nullptr) {
+      return;
+    }
+    auto it = precompile_methods_.find(dex_file.GetLocation());
+    if (it == precompile_methods_.end()) {
+      std::set<dex::TypeIndex> classes;
+      std::set<uint16_t> hot_methods;
+      std::set<uint16_t> startup_methods;
+      std::set<uint16_t> post_startup_methods;
+      // Fails if the dex file changed since the profile was saved.
+      if (!precompile_profile_->GetClassesAndMethods(
+              dex_file, &classes, &hot_methods, &startup_methods, &post_startup_methods)) {
+        hot_methods.clear();
+      }
+      it = precompile_methods_.Put(dex_file.GetLocation(), std::move(hot_methods));
+    }
+    if (it->second.empty()) {
+      return;
+    }
+    for (ArtMethod& method : klass->GetDeclaredMethods(kRuntimePointerSize)) {
+      if (it->second.find(method.GetDexMethodIndex()) != it->second.end()) {
+        methods.push_back(&method);
+      }
+    }
+  }
+  for (ArtMethod* method : methods) {
+    // Methods compiled by dex2oat, for example with the same profile, don't need the JIT.
+    if (!method->IsInvokable() || method->GetOatMethodQuickCode(kRuntimePointerSize) != nullptr) {
+      continue;
+    }
+    VLOG(jit) << "Enqueuing precompilation of " << method->PrettyMethod();
+    thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kPrecompile));
+  }
+}
+
 void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_backedges) {
   if (thread_pool_ == nullptr) {
     // Should only see this when shutting down.
@@ -714,6 +1126,30 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
   method->SetCounter(new_count);
 }
 
+void Jit::AddInvocationSample(Thread* self, ArtMethod* method) {
+  if (sample_period_ > 1u) {
+    int32_t countdown = self->GetJitSampleCountdown() - 1;
+    if (LIKELY(countdown > 0)) {
+      self->SetJitSampleCountdown(countdown);
+      return;
+    }
+    // Random distances between the samples, uniform in [1, 2 * sample_period_ - 1], so that
+    // a method invoked in a fixed pattern with others gets its share of them.
+    uint64_t* random_state = self->GetJitSampleRandomState();
+    if (UNLIKELY(*random_state == 0)) {
+      *random_state = ((static_cast<uint64_t>(self->GetTid()) << 32) ^ NanoTime()) | 1u;
+    }
+    uint64_t x = *random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *random_state = x;
+    uint64_t bits = x * UINT64_C(2685821657736338717);
+    self->SetJitSampleCountdown(1 + static_cast<int32_t>((bits >> 32) % (2 * sample_period_ - 1)));
+  }
+  AddSamples(self, method, sample_period_, /* with_backedges */ false);
+}
+
 void Jit::MethodEntered(Thread* thread, ArtMethod* method) {
   Runtime* runtime = Runtime::Current();
   if (UNLIKELY(runtime->UseJitCompilation() && runtime->GetJit()->JitAtFirstUse())) {
@@ -731,7 +1167,7 @@ void Jit::MethodEntered(Thread* thread, ArtMethod* method) {
     Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
         method, profiling_info->GetSavedEntryPoint());
   } else {
-    AddSamples(thread, method, 1, /* with_backedges */false);
+    AddInvocationSample(thread, method);
   }
 }
 
@@ -747,6 +1183,14 @@ void Jit::InvokeVirtualOrInterface(ObjPtr<mirror::Object> this_object,
   }
 }
 
+void Jit::Branch(ArtMethod* method, uint32_t dex_pc, bool taken) {
+  ScopedAssertNoThreadSuspension ants(__FUNCTION__);
+  ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+  if (info != nullptr) {
+    info->AddBranchInfo(dex_pc, taken);
+  }
+}
+
 void Jit::WaitForCompilationToFinish(Thread* self) {
   if (thread_pool_ != nullptr) {
     thread_pool_->Wait(self, false, false);
@@ -17,6 +17,11 @@
 #ifndef ART_RUNTIME_JIT_JIT_H_
 #define ART_RUNTIME_JIT_JIT_H_
 
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "base/histogram-inl.h"
 #include "base/macros.h"
 #include "base/mutex.h"
@@ -24,6 +29,7 @@
 #include "jit/profile_saver_options.h"
 #include "obj_ptr.h"
 #include "profile_compilation_info.h"
+#include "safe_map.h"
 #include "thread_pool.h"
 
 namespace art {
@@ -46,18 +52,45 @@ class JitOptions;
 static constexpr int16_t kJitCheckForOSR = -1;
 static constexpr int16_t kJitHotnessDisabled = -2;
 
+// What a successful compilation of one method cost, kept to find the methods that take most of
+// the JIT time and code cache space.
+struct JitCompilationRecord {
+  std::string method;
+  bool osr = false;
+  bool baseline = false;
+  // Thread CPU time of the whole compilation and of each pass, in nanoseconds.
+  uint64_t compile_time_ns = 0u;
+  std::vector<std::pair<std::string, uint64_t>> pass_times_ns;
+  // Bytes used by the compiler arena.
+  size_t arena_bytes = 0u;
+  size_t code_size = 0u;
+  size_t inlined_invokes = 0u;
+};
+
 class Jit {
  public:
   static constexpr size_t kDefaultPriorityThreadWeightRatio = 1000;
   static constexpr size_t kDefaultInvokeTransitionWeightRatio = 500;
+  // The default sample period is small compared to the warmup threshold, so that sampling
+  // barely changes when methods get warm.
+  static constexpr size_t kDefaultSamplePeriodRatio = 64;
+  static constexpr size_t kMaxDefaultSamplePeriod = 16;
   // How frequently should the interpreter check to see if OSR compilation is ready.
   static constexpr int16_t kJitRecheckOSRThreshold = 100;
+  static constexpr size_t kMaxCompilationRecords = 256;
 
   virtual ~Jit();
   static Jit* Create(JitOptions* options, std::string* error_msg);
-  bool CompileMethod(ArtMethod* method, Thread* self, bool osr)
+  // A `baseline` compilation is quick and its code asks for an optimized compilation once the
+  // method is invoked OptimizeThreshold() more times.
+  bool CompileMethod(ArtMethod* method, Thread* self, bool osr, bool baseline = false)
       REQUIRES_SHARED(Locks::mutator_lock_);
+  // Creates the thread pool. Its workers attach to the runtime, creating their peers, in the
+  // background so that the caller can go on with the startup.
   void CreateThreadPool();
+  // Waits for the workers of the thread pool to attach. Must be called before the runtime may
+  // shut down.
+  void WaitForWorkersToBeCreated();
 
   const JitCodeCache* GetCodeCache() const {
     return code_cache_.get();
@@ -74,10 +107,20 @@ class Jit {
   // Add a timing logger to cumulative_timings_.
   void AddTimingLogger(const TimingLogger& logger);
 
+  void NotifyCompileTaskCancelled() {
+    cancelled_compile_tasks_.FetchAndAddRelaxed(1u);
+  }
+
   void AddMemoryUsage(ArtMethod* method, size_t bytes)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Keep the record of the latest kMaxCompilationRecords compilations.
+  void AddCompilationRecord(JitCompilationRecord&& record) REQUIRES(!lock_);
+  std::vector<JitCompilationRecord> GetCompilationRecords() REQUIRES(!lock_);
+  // One line per compilation, the oldest first.
+  void DumpCompilationRecords(std::ostream& os) REQUIRES(!lock_);
+
   size_t OSRMethodThreshold() const {
     return osr_method_threshold_;
   }
@@ -90,6 +133,19 @@ class Jit {
     return warm_method_threshold_;
   }
 
+  size_t OptimizeThreshold() const {
+    return optimize_threshold_;
+  }
+
+  // Whether hot methods are first compiled baseline, then optimized.
+  bool UseTieredCompilation() const {
+    return optimize_threshold_ != 0;
+  }
+
+  // Called by baseline compiled code that got hot. Must not suspend.
+  void EnqueueOptimizedCompilation(ArtMethod* method, Thread* self)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   uint16_t PriorityThreadWeight() const {
     return priority_thread_weight_;
   }
@@ -113,12 +169,26 @@ class Jit {
   void AddSamples(Thread* self, ArtMethod* method, uint16_t samples, bool with_backedges)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Counts one invocation of `method`. To keep the threads invoking the same methods from
+  // writing to the same cache lines, each thread only adds SamplePeriod() samples to the method
+  // it invokes at random points, once every SamplePeriod() invocations on average.
+  void AddInvocationSample(Thread* self, ArtMethod* method)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  size_t SamplePeriod() const {
+    return sample_period_;
+  }
+
   void InvokeVirtualOrInterface(ObjPtr<mirror::Object> this_object,
                                 ArtMethod* caller,
                                 uint32_t dex_pc,
                                 ArtMethod* callee)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Record the direction taken by the IF instruction at `dex_pc`.
+  void Branch(ArtMethod* method, uint32_t dex_pc, bool taken)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void NotifyInterpreterToCompiledCodeTransition(Thread* self, ArtMethod* caller)
       REQUIRES_SHARED(Locks::mutator_lock_) {
     AddSamples(self, caller, invoke_transition_weight_, false);
@@ -141,6 +211,11 @@ class Jit {
   static void NewTypeLoadedIfUsingJit(mirror::Class* type)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // With -Xjitprecompilehotmethods, queues the compilation of the methods of `klass` that the
+  // profile of the previous runs found hot.
+  static void NewTypeInitializedIfUsingJit(mirror::Class* klass)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // If debug info generation is turned on then write the type information for types already loaded
   // into the specified class linker to the jit debug interface,
   void DumpTypeInfoForLoadedTypes(ClassLinker* linker);
@@ -177,23 +252,43 @@ class Jit {
   // Start JIT threads.
   void Start();
 
+  // Reads the hot methods of the previous runs from the profile for NewTypeInitializedIfUsingJit.
+  // Returns whether the profile could be read.
+  bool LoadPrecompileProfile(const std::string& filename) REQUIRES(!precompile_lock_);
+
+  // Enqueues the hot methods of the classes initialized before the profile was read.
+  void PrecompileInitializedClasses(Thread* self)
+      REQUIRES(!precompile_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Fills the inline caches of `method` with the receiver types of the previous runs that are
+  // loaded already, so that its precompiled code inlines like the code compiled once hot.
+  void AddPrecompileInlineCaches(Thread* self, ArtMethod* method)
+      REQUIRES(!precompile_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
  private:
   Jit();
 
   static bool LoadCompiler(std::string* error_msg);
 
+  void PrecompileHotMethods(Thread* self, mirror::Class* klass)
+      REQUIRES(!precompile_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // JIT compiler
   static void* jit_library_handle_;
   static void* jit_compiler_handle_;
   static void* (*jit_load_)(bool*);
   static void (*jit_unload_)(void*);
-  static bool (*jit_compile_method_)(void*, ArtMethod*, Thread*, bool);
+  static bool (*jit_compile_method_)(void*, ArtMethod*, Thread*, bool, bool);
   static void (*jit_types_loaded_)(void*, mirror::Class**, size_t count);
 
   // Performance monitoring.
   bool dump_info_on_shutdown_;
   CumulativeLogger cumulative_timings_;
   Histogram<uint64_t> memory_use_ GUARDED_BY(lock_);
+  std::deque<JitCompilationRecord> compilation_records_ GUARDED_BY(lock_);
   Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
   std::unique_ptr<jit::JitCodeCache> code_cache_;
@@ -206,7 +301,20 @@ class Jit {
   uint16_t osr_method_threshold_;
   uint16_t priority_thread_weight_;
   uint16_t invoke_transition_weight_;
+  uint16_t sample_period_;
+  uint16_t optimize_threshold_;
+  size_t thread_pool_size_;
   std::unique_ptr<ThreadPool> thread_pool_;
+  // Compile tasks dropped because the method was compiled or went cold while queued.
+  Atomic<uint32_t> cancelled_compile_tasks_;
+
+  bool precompile_hot_methods_;
+  Mutex precompile_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // The profile saved by the previous runs, null until the app registers its code paths.
+  std::unique_ptr<ProfileCompilationInfo> precompile_profile_ GUARDED_BY(precompile_lock_);
+  // The hot methods of each dex location seen so far. Empty if the dex file doesn't match the
+  // profile.
+  SafeMap<std::string, std::set<uint16_t>> precompile_methods_ GUARDED_BY(precompile_lock_);
 
   DISALLOW_COPY_AND_ASSIGN(Jit);
 };
@@ -229,6 +337,15 @@ class JitOptions {
   size_t GetInvokeTransitionWeight() const {
     return invoke_transition_weight_;
   }
+  size_t GetSamplePeriod() const {
+    return sample_period_;
+  }
+  size_t GetThreadPoolSize() const {
+    return thread_pool_size_;
+  }
+  size_t GetOptimizeThreshold() const {
+    return optimize_threshold_;
+  }
   size_t GetCodeCacheInitialCapacity() const {
     return code_cache_initial_capacity_;
   }
@@ -238,6 +355,9 @@ class JitOptions {
   bool DumpJitInfoOnShutdown() const {
     return dump_info_on_shutdown_;
   }
+  bool PrecompileHotMethods() const {
+    return precompile_hot_methods_;
+  }
   const ProfileSaverOptions& GetProfileSaverOptions() const {
     return profile_saver_options_;
   }
@@ -267,7 +387,11 @@ class JitOptions {
   size_t osr_threshold_;
   uint16_t priority_thread_weight_;
   size_t invoke_transition_weight_;
+  size_t sample_period_;
+  size_t thread_pool_size_;
+  size_t optimize_threshold_;
   bool dump_info_on_shutdown_;
+  bool precompile_hot_methods_;
   ProfileSaverOptions profile_saver_options_;
 
   JitOptions()
@@ -279,7 +403,11 @@ class JitOptions {
         osr_threshold_(0),
         priority_thread_weight_(0),
         invoke_transition_weight_(0),
-        dump_info_on_shutdown_(false) {}
+        sample_period_(1),
+        thread_pool_size_(1),
+        optimize_threshold_(0),
+        dump_info_on_shutdown_(false),
+        precompile_hot_methods_(false) {}
 
   DISALLOW_COPY_AND_ASSIGN(JitOptions);
 };
@@ -16,6 +16,9 @@
 
 #include "jit_code_cache.h"
 
+#include <sched.h>
+
+#include <set>
 #include <sstream>
 
 #include "arch/context.h"
@@ -157,9 +160,22 @@ class JitCodeCache::JniStubData {
   std::vector<ArtMethod*> methods_;
 };
 
+// The split of a code capacity between the code segments when baseline code has its own, at
+// least a page each.
+static size_t BaselineCodeCapacity(size_t code_capacity) {
+  return std::max(
+      kPageSize,
+      RoundDown(code_capacity / JitCodeCache::kBaselineCodeCapacityDivisor, kPageSize));
+}
+
+static size_t OtherCodeCapacity(size_t code_capacity) {
+  return std::max(kPageSize, code_capacity - BaselineCodeCapacity(code_capacity));
+}
+
 JitCodeCache* JitCodeCache::Create(size_t initial_capacity,
                                    size_t max_capacity,
                                    bool generate_debug_info,
+                                   bool baseline_code_segment,
                                    std::string* error_msg) {
   ScopedTrace trace(__PRETTY_FUNCTION__);
   CHECK_GE(max_capacity, initial_capacity);
@@ -168,6 +184,9 @@ JitCodeCache* JitCodeCache::Create(size_t initial_capacity,
   // host which does not work with ashmem.
   // Also, target linux does not support ashmem.
   bool use_ashmem = !generate_debug_info && !kIsTargetLinux;
+  // Huge pages need private anonymous memory.
+  const bool huge_pages = MemMap::TransparentHugePagesEnabled();
+  use_ashmem = use_ashmem && !huge_pages;
 
   // With 'perf', we want a 1-1 mapping between an address and a method.
   bool garbage_collect_code = !generate_debug_info;
@@ -196,7 +215,8 @@ JitCodeCache* JitCodeCache::Create(size_t initial_capacity,
       /* low_4gb */ true,
       /* reuse */ false,
       &error_str,
-      use_ashmem));
+      use_ashmem,
+      huge_pages));
   if (data_map == nullptr) {
     std::ostringstream oss;
     oss << "Failed to create read write cache: " << error_str << " size=" << max_capacity;
@@ -224,11 +244,20 @@ JitCodeCache* JitCodeCache::Create(size_t initial_capacity,
     return nullptr;
   }
   DCHECK_EQ(code_map->Begin(), divider);
+  if (huge_pages) {
+    // RemapAtEnd() maps the code half anew, without the advice.
+    code_map->AdviseHugePages();
+  }
   data_size = initial_capacity / 2;
   code_size = initial_capacity - data_size;
   DCHECK_EQ(code_size + data_size, initial_capacity);
-  return new JitCodeCache(
-      code_map, data_map.release(), code_size, data_size, max_capacity, garbage_collect_code);
+  return new JitCodeCache(code_map,
+                          data_map.release(),
+                          code_size,
+                          data_size,
+                          max_capacity,
+                          garbage_collect_code,
+                          baseline_code_segment);
 }
 
 JitCodeCache::JitCodeCache(MemMap* code_map,
@@ -236,21 +265,28 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
                            size_t initial_code_capacity,
                            size_t initial_data_capacity,
                            size_t max_capacity,
-                           bool garbage_collect_code)
+                           bool garbage_collect_code,
+                           bool baseline_code_segment)
     : lock_("Jit code cache", kJitCodeCacheLock),
       lock_cond_("Jit code cache condition variable", lock_),
       collection_in_progress_(false),
       code_map_(code_map),
       data_map_(data_map),
+      baseline_code_mspace_(nullptr),
+      baseline_code_begin_(0),
+      code_index_sequence_(0u),
+      code_index_size_(0u),
       max_capacity_(max_capacity),
       current_capacity_(initial_code_capacity + initial_data_capacity),
       code_end_(initial_code_capacity),
+      baseline_code_end_(0),
       data_end_(initial_data_capacity),
       last_collection_increased_code_cache_(false),
       last_update_time_ns_(0),
       garbage_collect_code_(garbage_collect_code),
       used_memory_for_data_(0),
       used_memory_for_code_(0),
+      used_memory_for_baseline_code_(0),
       number_of_compilations_(0),
       number_of_osr_compilations_(0),
       number_of_collections_(0),
@@ -261,7 +297,31 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
       inline_cache_cond_("Jit inline cache condition variable", lock_) {
 
   DCHECK_GE(max_capacity, initial_code_capacity + initial_data_capacity);
+  if (baseline_code_segment && code_map_->Size() >= 2 * kPageSize) {
+    // The baseline code segment takes the end of the code map, so that both code mspaces can
+    // grow up to their share of the maximum capacity.
+    baseline_code_begin_ = code_map_->Size() - BaselineCodeCapacity(code_map_->Size());
+    code_end_ = OtherCodeCapacity(initial_code_capacity);
+    baseline_code_end_ = BaselineCodeCapacity(initial_code_capacity);
+    DCHECK_LE(code_end_, baseline_code_begin_);
+    baseline_code_mspace_ = create_mspace_with_base(
+        code_map_->Begin() + baseline_code_begin_, baseline_code_end_, false /*locked*/);
+    if (baseline_code_mspace_ == nullptr) {
+      PLOG(FATAL) << "create_mspace_with_base failed";
+    }
+  }
   code_mspace_ = create_mspace_with_base(code_map_->Begin(), code_end_, false /*locked*/);
+
+  std::string error_str;
+  code_index_map_.reset(MemMap::MapAnonymous(
+      "jit-code-index",
+      nullptr,
+      RoundUp(code_map_->Size() / kJitCodeAlignment * sizeof(Atomic<const void*>), kPageSize),
+      PROT_READ | PROT_WRITE,
+      /* low_4gb */ false,
+      /* reuse */ false,
+      &error_str));
+  CHECK(code_index_map_ != nullptr) << "Failed to map the JIT code index: " << error_str;
   data_mspace_ = create_mspace_with_base(data_map_->Begin(), data_end_, false /*locked*/);
 
   if (code_mspace_ == nullptr || data_mspace_ == nullptr) {
@@ -369,6 +429,7 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                   size_t code_size,
                                   size_t data_size,
                                   bool osr,
+                                  bool baseline,
                                   Handle<mirror::ObjectArray<mirror::Object>> roots,
                                   bool has_should_deoptimize_flag,
                                   const ArenaSet<ArtMethod*>& cha_single_implementation_list) {
@@ -384,6 +445,7 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                        code_size,
                                        data_size,
                                        osr,
+                                       baseline,
                                        roots,
                                        has_should_deoptimize_flag,
                                        cha_single_implementation_list);
@@ -402,6 +464,7 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                 code_size,
                                 data_size,
                                 osr,
+                                baseline,
                                 roots,
                                 has_should_deoptimize_flag,
                                 cha_single_implementation_list);
@@ -602,11 +665,13 @@ void JitCodeCache::RemoveMethodsIn(Thread* self, const LinearAlloc& alloc) {
       for (auto it = method_code_map_.begin(); it != method_code_map_.end();) {
         if (alloc.ContainsUnsafe(it->second)) {
           method_headers.insert(OatQuickMethodHeader::FromCodePointer(it->first));
+          baseline_code_map_.erase(it->first);
           it = method_code_map_.erase(it);
         } else {
           ++it;
         }
       }
+      UpdateCodeIndex();
     }
     for (auto it = osr_code_map_.begin(); it != osr_code_map_.end();) {
       if (alloc.ContainsUnsafe(it->first)) {
@@ -666,7 +731,9 @@ void JitCodeCache::DisallowInlineCacheAccess() {
 }
 
 void JitCodeCache::CopyInlineCacheInto(const InlineCache& ic,
-                                       Handle<mirror::ObjectArray<mirror::Class>> array) {
+                                       Handle<mirror::ObjectArray<mirror::Class>> array,
+                                       uint16_t* counts,
+                                       uint16_t* misses) {
   WaitUntilInlineCacheAccessible(Thread::Current());
   // Note that we don't need to lock `lock_` here, the compiler calling
   // this method has already ensured the inline cache will not be deleted.
@@ -675,9 +742,11 @@ void JitCodeCache::CopyInlineCacheInto(const InlineCache& ic,
        ++in_cache) {
     mirror::Class* object = ic.classes_[in_cache].Read();
     if (object != nullptr) {
+      counts[in_array] = ic.counts_[in_cache];
       array->Set(in_array++, object);
     }
   }
+  *misses = ic.misses_;
 }
 
 static void ClearMethodCounter(ArtMethod* method, bool was_warm) {
@@ -704,12 +773,14 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
                                           size_t code_size,
                                           size_t data_size,
                                           bool osr,
+                                          bool baseline,
                                           Handle<mirror::ObjectArray<mirror::Object>> roots,
                                           bool has_should_deoptimize_flag,
                                           const ArenaSet<ArtMethod*>&
                                               cha_single_implementation_list) {
   DCHECK_NE(stack_map != nullptr, method->IsNative());
   DCHECK(!method->IsNative() || !osr);
+  DCHECK(!baseline || (!method->IsNative() && !osr));
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
   // Ensure the header ends up at expected instruction alignment.
   size_t header_size = RoundUp(sizeof(OatQuickMethodHeader), alignment);
@@ -724,7 +795,7 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
     WaitForPotentialCollectionToComplete(self);
     {
       ScopedCodeCacheWrite scc(code_map_.get());
-      memory = AllocateCode(total_size);
+      memory = AllocateCode(total_size, baseline);
       if (memory == nullptr) {
         return nullptr;
       }
@@ -816,10 +887,18 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
                        reinterpret_cast<char*>(roots_data + data_size));
       }
       method_code_map_.Put(code_ptr, method);
+      UpdateCodeIndex();
       if (osr) {
         number_of_osr_compilations_++;
         osr_code_map_.Put(method, code_ptr);
       } else {
+        if (baseline) {
+          // The code counts its invocations in the ProfilingInfo, which cannot be collected
+          // while the code is alive.
+          ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+          DCHECK(info != nullptr);
+          baseline_code_map_.Put(code_ptr, info);
+        }
         Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
             method, method_header->GetEntryPoint());
       }
@@ -839,6 +918,7 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
         << reinterpret_cast<const void*>(method_header->GetEntryPoint() +
                                          method_header->GetCodeSize());
     histogram_code_memory_use_.AddValue(code_size);
+    TraceCounter(TraceCategory::kJit, "JIT code cache size (KB)", CodeCacheSizeLocked() / KB);
     if (code_size > kCodeSizeLogThreshold) {
       LOG(INFO) << "JIT allocated "
                 << PrettySize(code_size)
@@ -880,46 +960,62 @@ bool JitCodeCache::RemoveMethod(ArtMethod* method, bool release_memory) {
 }
 
 bool JitCodeCache::RemoveMethodLocked(ArtMethod* method, bool release_memory) {
-  if (LIKELY(!method->IsNative())) {
-    ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
-    if (info != nullptr) {
-      RemoveElement(profiling_infos_, info);
-    }
-    method->SetProfilingInfo(nullptr);
-  }
+  return RemoveMethodsLocked(std::unordered_set<ArtMethod*>({ method }), release_memory);
+}
 
+bool JitCodeCache::RemoveMethodsLocked(const std::unordered_set<ArtMethod*>& methods,
+                                       bool release_memory) {
   bool in_cache = false;
   ScopedCodeCacheWrite ccw(code_map_.get());
-  if (UNLIKELY(method->IsNative())) {
-    auto it = jni_stubs_map_.find(JniStubKey(method));
-    if (it != jni_stubs_map_.end() && it->second.RemoveMethod(method)) {
-      in_cache = true;
-      if (it->second.GetMethods().empty()) {
-        if (release_memory) {
-          FreeCode(it->second.GetCode());
+  std::unordered_set<ProfilingInfo*> removed_infos;
+  bool has_non_native_methods = false;
+  for (ArtMethod* method : methods) {
+    if (UNLIKELY(method->IsNative())) {
+      auto it = jni_stubs_map_.find(JniStubKey(method));
+      if (it != jni_stubs_map_.end() && it->second.RemoveMethod(method)) {
+        in_cache = true;
+        if (it->second.GetMethods().empty()) {
+          if (release_memory) {
+            FreeCode(it->second.GetCode());
+          }
+          jni_stubs_map_.erase(it);
+        } else {
+          it->first.UpdateShorty(it->second.GetMethods().front());
         }
-        jni_stubs_map_.erase(it);
-      } else {
-        it->first.UpdateShorty(it->second.GetMethods().front());
+      }
+    } else {
+      has_non_native_methods = true;
+      ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+      if (info != nullptr) {
+        removed_infos.insert(info);
+      }
+      method->SetProfilingInfo(nullptr);
+      auto osr_it = osr_code_map_.find(method);
+      if (osr_it != osr_code_map_.end()) {
+        osr_code_map_.erase(osr_it);
       }
     }
-  } else {
+  }
+
+  if (has_non_native_methods) {
+    profiling_infos_.erase(
+        std::remove_if(profiling_infos_.begin(),
+                       profiling_infos_.end(),
+                       [&](ProfilingInfo* info) { return removed_infos.count(info) != 0u; }),
+        profiling_infos_.end());
     for (auto it = method_code_map_.begin(); it != method_code_map_.end();) {
-      if (it->second == method) {
+      if (methods.find(it->second) != methods.end()) {
         in_cache = true;
         if (release_memory) {
           FreeCode(it->first);
         }
+        baseline_code_map_.erase(it->first);
         it = method_code_map_.erase(it);
       } else {
         ++it;
       }
     }
-
-    auto osr_it = osr_code_map_.find(method);
-    if (osr_it != osr_code_map_.end()) {
-      osr_code_map_.erase(osr_it);
-    }
+    UpdateCodeIndex();
   }
 
   return in_cache;
@@ -933,6 +1029,11 @@ void JitCodeCache::NotifyMethodRedefined(ArtMethod* method) {
   RemoveMethodLocked(method, /* release_memory */ true);
 }
 
+void JitCodeCache::NotifyMethodsRedefined(const std::unordered_set<ArtMethod*>& methods) {
+  MutexLock mu(Thread::Current(), lock_);
+  RemoveMethodsLocked(methods, /* release_memory */ true);
+}
+
 // This invalidates old_method. Once this function returns one can no longer use old_method to
 // execute code unless it is fixed up. This fixup will happen later in the process of installing a
 // class redefinition.
@@ -1117,7 +1218,12 @@ void JitCodeCache::SetFootprintLimit(size_t new_footprint) {
   mspace_set_footprint_limit(data_mspace_, per_space_footprint);
   {
     ScopedCodeCacheWrite scc(code_map_.get());
-    mspace_set_footprint_limit(code_mspace_, per_space_footprint);
+    if (baseline_code_mspace_ != nullptr) {
+      mspace_set_footprint_limit(code_mspace_, OtherCodeCapacity(per_space_footprint));
+      mspace_set_footprint_limit(baseline_code_mspace_, BaselineCodeCapacity(per_space_footprint));
+    } else {
+      mspace_set_footprint_limit(code_mspace_, per_space_footprint);
+    }
   }
 }
 
@@ -1190,10 +1296,14 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
       return;
     } else {
       number_of_collections_++;
+      // The baseline code segment is at the end of the code map.
+      uint8_t* code_end = (baseline_code_mspace_ != nullptr)
+          ? code_map_->End()
+          : code_map_->Begin() + current_capacity_ / 2;
       live_bitmap_.reset(CodeCacheBitmap::Create(
           "code-cache-bitmap",
           reinterpret_cast<uintptr_t>(code_map_->Begin()),
-          reinterpret_cast<uintptr_t>(code_map_->Begin() + current_capacity_ / 2)));
+          reinterpret_cast<uintptr_t>(code_end)));
       collection_in_progress_ = true;
     }
   }
@@ -1222,6 +1332,7 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
 
     {
       MutexLock mu(self, lock_);
+      TraceCounter(TraceCategory::kJit, "JIT code cache size (KB)", CodeCacheSizeLocked() / KB);
 
       // Increase the code cache only when we do partial collections.
       // TODO: base this strategy on how full the code cache is?
@@ -1302,9 +1413,11 @@ void JitCodeCache::RemoveUnmarkedCode(Thread* self) {
         ++it;
       } else {
         method_headers.insert(OatQuickMethodHeader::FromCodePointer(code_ptr));
+        baseline_code_map_.erase(code_ptr);
         it = method_code_map_.erase(it);
       }
     }
+    UpdateCodeIndex();
   }
   FreeAllMethodHeaders(method_headers);
 }
@@ -1313,12 +1426,28 @@ void JitCodeCache::DoCollection(Thread* self, bool collect_profiling_info) {
   ScopedTrace trace(__FUNCTION__);
   {
     MutexLock mu(self, lock_);
+    // Compiled code called by the instrumentation entry stub of its method is live, although it
+    // is not the entry point.
+    auto is_instrumented_code_live = [](ProfilingInfo* info) REQUIRES_SHARED(Locks::mutator_lock_) {
+      return info->GetInstrumentedEntryPoint() != nullptr &&
+          info->GetMethod()->GetEntryPointFromQuickCompiledCode() ==
+              GetQuickInstrumentationEntryPoint();
+    };
     if (collect_profiling_info) {
+      // Baseline code that is still in the cache may run again, from a thread stack or when
+      // a method gets its saved entry point back, so keep the ProfilingInfo it updates.
+      std::set<ProfilingInfo*> baseline_infos;
+      for (const auto& entry : baseline_code_map_) {
+        baseline_infos.insert(entry.second);
+      }
       // Clear the profiling info of methods that do not have compiled code as entrypoint.
       // Also remove the saved entry point from the ProfilingInfo objects.
       for (ProfilingInfo* info : profiling_infos_) {
         const void* ptr = info->GetMethod()->GetEntryPointFromQuickCompiledCode();
-        if (!ContainsPc(ptr) && !info->IsInUseByCompiler()) {
+        if (!ContainsPc(ptr) &&
+            !info->IsInUseByCompiler() &&
+            !is_instrumented_code_live(info) &&
+            baseline_infos.find(info) == baseline_infos.end()) {
           info->GetMethod()->SetProfilingInfo(nullptr);
         }
 
@@ -1359,6 +1488,16 @@ void JitCodeCache::DoCollection(Thread* self, bool collect_profiling_info) {
         GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(code_ptr));
       }
     }
+    for (ProfilingInfo* info : profiling_infos_) {
+      if (is_instrumented_code_live(info)) {
+        const OatQuickMethodHeader* method_header =
+            OatQuickMethodHeader::FromEntryPoint(info->GetInstrumentedEntryPoint());
+        GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(method_header->GetCode()));
+      } else {
+        // The stub is gone, the method will get compiled again if it is still hot.
+        info->SetInstrumentedEntryPoint(nullptr);
+      }
+    }
 
     // Empty osr method map, as osr compiled code will be deleted (except the ones
     // on thread stacks).
@@ -1435,10 +1574,37 @@ OatQuickMethodHeader* JitCodeCache::LookupMethodHeader(uintptr_t pc, ArtMethod*
     CHECK(method != nullptr);
   }
 
+  if (method != nullptr && LIKELY(!method->IsNative())) {
+    const void* code_ptr = LookupCodeIndex(pc);
+    if (code_ptr == nullptr) {
+      return nullptr;
+    }
+    if (kIsDebugBuild) {
+      MutexLock mu(Thread::Current(), lock_);
+      auto it = method_code_map_.find(code_ptr);
+      // When we are walking the stack to redefine classes and creating obsolete methods it is
+      // possible that we might have updated the method_code_map by making this method obsolete
+      // in a previous frame. Therefore we should just check that the non-obsolete version of
+      // this method is the one we expect. We change to the non-obsolete versions in the error
+      // message since the obsolete version of the method might not be fully initialized yet.
+      // This situation can only occur when we are in the process of allocating and setting up
+      // obsolete methods. Otherwise method and it->second should be identical. (See
+      // openjdkjvmti/ti_redefine.cc for more information.) The code may also have been removed
+      // since the lookup, if it is not on the stack of the caller.
+      if (it != method_code_map_.end()) {
+        DCHECK_EQ(it->second->GetNonObsoleteMethod(), method->GetNonObsoleteMethod())
+            << ArtMethod::PrettyMethod(method->GetNonObsoleteMethod()) << " "
+            << ArtMethod::PrettyMethod(it->second->GetNonObsoleteMethod()) << " "
+            << std::hex << pc;
+      }
+    }
+    return OatQuickMethodHeader::FromCodePointer(code_ptr);
+  }
+
   MutexLock mu(Thread::Current(), lock_);
   OatQuickMethodHeader* method_header = nullptr;
-  ArtMethod* found_method = nullptr;  // Only for DCHECK(), not for JNI stubs.
-  if (method != nullptr && UNLIKELY(method->IsNative())) {
+  if (method != nullptr) {
+    DCHECK(method->IsNative());
     auto it = jni_stubs_map_.find(JniStubKey(method));
     if (it == jni_stubs_map_.end() || !ContainsElement(it->second.GetMethods(), method)) {
       return nullptr;
@@ -1455,10 +1621,9 @@ OatQuickMethodHeader* JitCodeCache::LookupMethodHeader(uintptr_t pc, ArtMethod*
       const void* code_ptr = it->first;
       if (OatQuickMethodHeader::FromCodePointer(code_ptr)->Contains(pc)) {
         method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
-        found_method = it->second;
       }
     }
-    if (method_header == nullptr && method == nullptr) {
+    if (method_header == nullptr) {
       // Scan all compiled JNI stubs as well. This slow search is used only
       // for checks in debug build, for release builds the `method` is not null.
       for (auto&& entry : jni_stubs_map_) {
@@ -1469,26 +1634,60 @@ OatQuickMethodHeader* JitCodeCache::LookupMethodHeader(uintptr_t pc, ArtMethod*
         }
       }
     }
-    if (method_header == nullptr) {
-      return nullptr;
-    }
   }
+  return method_header;
+}
 
-  if (kIsDebugBuild && method != nullptr && !method->IsNative()) {
-    // When we are walking the stack to redefine classes and creating obsolete methods it is
-    // possible that we might have updated the method_code_map by making this method obsolete in a
-    // previous frame. Therefore we should just check that the non-obsolete version of this method
-    // is the one we expect. We change to the non-obsolete versions in the error message since the
-    // obsolete version of the method might not be fully initialized yet. This situation can only
-    // occur when we are in the process of allocating and setting up obsolete methods. Otherwise
-    // method and it->second should be identical. (See openjdkjvmti/ti_redefine.cc for more
-    // information.)
-    DCHECK_EQ(found_method->GetNonObsoleteMethod(), method->GetNonObsoleteMethod())
-        << ArtMethod::PrettyMethod(method->GetNonObsoleteMethod()) << " "
-        << ArtMethod::PrettyMethod(found_method->GetNonObsoleteMethod()) << " "
-        << std::hex << pc;
+void JitCodeCache::UpdateCodeIndex() {
+  Atomic<const void*>* index = GetCodeIndex();
+  const size_t capacity = code_index_map_->Size() / sizeof(Atomic<const void*>);
+  CHECK_LE(method_code_map_.size(), capacity);
+  const uint32_t sequence = code_index_sequence_.LoadRelaxed();
+  DCHECK_EQ(sequence % 2u, 0u);
+  code_index_sequence_.StoreRelaxed(sequence + 1u);
+  // Keep the stores to the index from moving before the odd sequence number.
+  QuasiAtomic::ThreadFenceRelease();
+  size_t size = 0u;
+  for (const auto& entry : method_code_map_) {
+    index[size++].StoreRelaxed(entry.first);
+  }
+  code_index_size_.StoreRelaxed(size);
+  code_index_sequence_.StoreRelease(sequence + 2u);
+}
+
+const void* JitCodeCache::LookupCodeIndex(uintptr_t pc) const {
+  const Atomic<const void*>* index = GetCodeIndex();
+  const size_t capacity = code_index_map_->Size() / sizeof(Atomic<const void*>);
+  while (true) {
+    const uint32_t sequence = code_index_sequence_.LoadAcquire();
+    if (sequence % 2u == 0u) {
+      // Find the last code starting before `pc`. A concurrent update may mix old and new
+      // entries, the search only needs to stay within the index until the sequence number is
+      // checked.
+      size_t low = 0u;
+      size_t high = std::min(code_index_size_.LoadRelaxed(), capacity);
+      while (low < high) {
+        size_t mid = low + (high - low) / 2u;
+        if (reinterpret_cast<uintptr_t>(index[mid].LoadRelaxed()) < pc) {
+          low = mid + 1u;
+        } else {
+          high = mid;
+        }
+      }
+      const void* code_ptr = (low != 0u) ? index[low - 1u].LoadRelaxed() : nullptr;
+      // Reading the header is safe even if the code was freed meanwhile, the code map stays
+      // mapped readable.
+      bool found = code_ptr != nullptr &&
+          ContainsPc(code_ptr) &&
+          OatQuickMethodHeader::FromCodePointer(code_ptr)->Contains(pc);
+      QuasiAtomic::ThreadFenceAcquire();
+      if (code_index_sequence_.LoadRelaxed() == sequence) {
+        return found ? code_ptr : nullptr;
+      }
+    }
+    // A compilation or a collection is updating the index, which only takes a copy.
+    sched_yield();
   }
-  return method_header;
 }
 
 OatQuickMethodHeader* JitCodeCache::LookupOsrMethodHeader(ArtMethod* method) {
@@ -1503,6 +1702,7 @@ OatQuickMethodHeader* JitCodeCache::LookupOsrMethodHeader(ArtMethod* method) {
 ProfilingInfo* JitCodeCache::AddProfilingInfo(Thread* self,
                                               ArtMethod* method,
                                               const std::vector<uint32_t>& entries,
+                                              const std::vector<uint32_t>& branch_entries,
                                               bool retry_allocation)
     // No thread safety analysis as we are using TryLock/Unlock explicitly.
     NO_THREAD_SAFETY_ANALYSIS {
@@ -1511,19 +1711,19 @@ ProfilingInfo* JitCodeCache::AddProfilingInfo(Thread* self,
     // If we are allocating for the interpreter, just try to lock, to avoid
     // lock contention with the JIT.
     if (lock_.ExclusiveTryLock(self)) {
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_entries);
       lock_.ExclusiveUnlock(self);
     }
   } else {
     {
       MutexLock mu(self, lock_);
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_entries);
     }
 
     if (info == nullptr) {
       GarbageCollectCache(self);
       MutexLock mu(self, lock_);
-      info = AddProfilingInfoInternal(self, method, entries);
+      info = AddProfilingInfoInternal(self, method, entries, branch_entries);
     }
   }
   return info;
@@ -1531,9 +1731,12 @@ ProfilingInfo* JitCodeCache::AddProfilingInfo(Thread* self,
 
 ProfilingInfo* JitCodeCache::AddProfilingInfoInternal(Thread* self ATTRIBUTE_UNUSED,
                                                       ArtMethod* method,
-                                                      const std::vector<uint32_t>& entries) {
+                                                      const std::vector<uint32_t>& entries,
+                                                      const std::vector<uint32_t>& branch_entries) {
   size_t profile_info_size = RoundUp(
-      sizeof(ProfilingInfo) + sizeof(InlineCache) * entries.size(),
+      sizeof(ProfilingInfo) +
+          sizeof(InlineCache) * entries.size() +
+          sizeof(BranchCache) * branch_entries.size(),
       sizeof(void*));
 
   // Check whether some other thread has concurrently created it.
@@ -1546,7 +1749,7 @@ ProfilingInfo* JitCodeCache::AddProfilingInfoInternal(Thread* self ATTRIBUTE_UNU
   if (data == nullptr) {
     return nullptr;
   }
-  info = new (data) ProfilingInfo(method, entries);
+  info = new (data) ProfilingInfo(method, entries, branch_entries);
 
   // Make sure other threads see the data in the profiling info object before the
   // store in the ArtMethod's ProfilingInfo pointer.
@@ -1565,6 +1768,10 @@ void* JitCodeCache::MoreCore(const void* mspace, intptr_t increment) NO_THREAD_S
     size_t result = code_end_;
     code_end_ += increment;
     return reinterpret_cast<void*>(result + code_map_->Begin());
+  } else if (baseline_code_mspace_ == mspace) {
+    size_t result = baseline_code_end_;
+    baseline_code_end_ += increment;
+    return reinterpret_cast<void*>(result + baseline_code_begin_ + code_map_->Begin());
   } else {
     DCHECK_EQ(data_mspace_, mspace);
     size_t result = data_end_;
@@ -1599,6 +1806,7 @@ void JitCodeCache::GetProfiledMethods(const std::set<std::string>& dex_base_loca
 
     for (size_t i = 0; i < info->number_of_inline_caches_; ++i) {
       std::vector<TypeReference> profile_classes;
+      std::vector<uint16_t> profile_weights;
       const InlineCache& cache = info->cache_[i];
       ArtMethod* caller = info->GetMethod();
       bool is_missing_types = false;
@@ -1641,17 +1849,28 @@ void JitCodeCache::GetProfiledMethods(const std::set<std::string>& dex_base_loca
           // Only consider classes from the same apk (including multidex).
           profile_classes.emplace_back(/*ProfileMethodInfo::ProfileClassReference*/
               class_dex_file, type_index);
+          profile_weights.push_back(cache.counts_[k]);
         } else {
           is_missing_types = true;
         }
       }
       if (!profile_classes.empty()) {
         inline_caches.emplace_back(/*ProfileMethodInfo::ProfileInlineCache*/
-            cache.dex_pc_, is_missing_types, profile_classes);
+            cache.dex_pc_, is_missing_types, profile_classes, profile_weights);
+      }
+    }
+
+    std::vector<ProfileMethodInfo::ProfileBranchCache> branch_caches;
+    const BranchCache* branch_cache_entries = info->GetBranchCaches();
+    for (size_t i = 0; i < info->number_of_branch_caches_; ++i) {
+      const BranchCache& cache = branch_cache_entries[i];
+      if (cache.GetTakenCount() != 0u || cache.GetNotTakenCount() != 0u) {
+        branch_caches.emplace_back(/*ProfileMethodInfo::ProfileBranchCache*/
+            cache.GetDexPc(), cache.GetTakenCount(), cache.GetNotTakenCount());
       }
     }
     methods.emplace_back(/*ProfileMethodInfo*/
-        MethodReference(dex_file, method->GetDexMethodIndex()), inline_caches);
+        MethodReference(dex_file, method->GetDexMethodIndex()), inline_caches, branch_caches);
   }
 }
 
@@ -1664,8 +1883,21 @@ bool JitCodeCache::IsOsrCompiled(ArtMethod* method) {
   return osr_code_map_.find(method) != osr_code_map_.end();
 }
 
-bool JitCodeCache::NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr) {
-  if (!osr && ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+bool JitCodeCache::IsBaselineCompiled(ArtMethod* method) {
+  const void* entry_point = method->GetEntryPointFromQuickCompiledCode();
+  if (!ContainsPc(entry_point)) {
+    return false;
+  }
+  MutexLock mu(Thread::Current(), lock_);
+  const void* code_ptr = OatQuickMethodHeader::FromEntryPoint(entry_point)->GetCode();
+  return baseline_code_map_.find(code_ptr) != baseline_code_map_.end();
+}
+
+bool JitCodeCache::NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr, bool baseline) {
+  // Compiled code is only replaced when it is baseline code and the new code is optimized.
+  if (!osr &&
+      ContainsPc(method->GetEntryPointFromQuickCompiledCode()) &&
+      (baseline || !IsBaselineCompiled(method))) {
     return false;
   }
 
@@ -1773,6 +2005,11 @@ void JitCodeCache::InvalidateCompiledCodeFor(ArtMethod* method,
     // Prevent future uses of the compiled code.
     profiling_info->SetSavedEntryPoint(nullptr);
   }
+  if ((profiling_info != nullptr) &&
+      (profiling_info->GetInstrumentedEntryPoint() == header->GetEntryPoint())) {
+    // Make the instrumentation entry stub call the interpreter instead.
+    profiling_info->SetInstrumentedEntryPoint(nullptr);
+  }
 
   if (method->GetEntryPointFromQuickCompiledCode() == header->GetEntryPoint()) {
     // The entrypoint is the one to invalidate, so we just update it to the interpreter entry point
@@ -1790,20 +2027,39 @@ void JitCodeCache::InvalidateCompiledCodeFor(ArtMethod* method,
   }
 }
 
-uint8_t* JitCodeCache::AllocateCode(size_t code_size) {
+uint8_t* JitCodeCache::AllocateCode(size_t code_size, bool baseline) {
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
-  uint8_t* result = reinterpret_cast<uint8_t*>(
-      mspace_memalign(code_mspace_, alignment, code_size));
+  // Baseline code doesn't fall back to the other segment when its own is full: the collection
+  // frees the baseline code that was replaced by optimized code.
+  void* mspace = (baseline && baseline_code_mspace_ != nullptr) ? baseline_code_mspace_
+                                                                 : code_mspace_;
+  uint8_t* result = reinterpret_cast<uint8_t*>(mspace_memalign(mspace, alignment, code_size));
   size_t header_size = RoundUp(sizeof(OatQuickMethodHeader), alignment);
   // Ensure the header ends up at expected instruction alignment.
   DCHECK_ALIGNED_PARAM(reinterpret_cast<uintptr_t>(result + header_size), alignment);
-  used_memory_for_code_ += mspace_usable_size(result);
+  size_t usable_size = mspace_usable_size(result);
+  used_memory_for_code_ += usable_size;
+  if (mspace == baseline_code_mspace_) {
+    used_memory_for_baseline_code_ += usable_size;
+  }
   return result;
 }
 
+bool JitCodeCache::IsInBaselineCodeSegment(const void* ptr) const {
+  return baseline_code_mspace_ != nullptr &&
+      ptr >= code_map_->Begin() + baseline_code_begin_ &&
+      ptr < code_map_->End();
+}
+
 void JitCodeCache::FreeCode(uint8_t* code) {
-  used_memory_for_code_ -= mspace_usable_size(code);
-  mspace_free(code_mspace_, code);
+  size_t usable_size = mspace_usable_size(code);
+  used_memory_for_code_ -= usable_size;
+  if (IsInBaselineCodeSegment(code)) {
+    used_memory_for_baseline_code_ -= usable_size;
+    mspace_free(baseline_code_mspace_, code);
+  } else {
+    mspace_free(code_mspace_, code);
+  }
 }
 
 uint8_t* JitCodeCache::AllocateData(size_t data_size) {
@@ -1820,10 +2076,13 @@ void JitCodeCache::FreeData(uint8_t* data) {
 void JitCodeCache::Dump(std::ostream& os) {
   MutexLock mu(Thread::Current(), lock_);
   os << "Current JIT code cache size: " << PrettySize(used_memory_for_code_) << "\n"
+     << "Current JIT baseline code segment size: "
+        << PrettySize(used_memory_for_baseline_code_) << "\n"
      << "Current JIT data cache size: " << PrettySize(used_memory_for_data_) << "\n"
      << "Current JIT capacity: " << PrettySize(current_capacity_) << "\n"
      << "Current number of JIT JNI stub entries: " << jni_stubs_map_.size() << "\n"
      << "Current number of JIT code cache entries: " << method_code_map_.size() << "\n"
+     << "Current number of JIT baseline code entries: " << baseline_code_map_.size() << "\n"
      << "Total number of JIT compilations: " << number_of_compilations_ << "\n"
      << "Total number of JIT compilations for on stack replacement: "
         << number_of_osr_compilations_ << "\n"
@@ -83,11 +83,17 @@ class JitCodeCache {
   // By default, do not GC until reaching 256KB.
   static constexpr size_t kReservedCapacity = kInitialCapacity * 4;
 
+  // The fraction of the code capacity given to baseline code, when it has its own segment.
+  static constexpr size_t kBaselineCodeCapacityDivisor = 4;
+
   // Create the code cache with a code + data capacity equal to "capacity", error message is passed
-  // in the out arg error_msg.
+  // in the out arg error_msg. With `baseline_code_segment`, baseline code is allocated apart from
+  // the rest of the code: it is replaced by optimized code soon, and would otherwise leave holes
+  // between the long lived methods.
   static JitCodeCache* Create(size_t initial_capacity,
                               size_t max_capacity,
                               bool generate_debug_info,
+                              bool baseline_code_segment,
                               std::string* error_msg);
   ~JitCodeCache();
 
@@ -97,7 +103,12 @@ class JitCodeCache {
   // Number of bytes allocated in the data cache.
   size_t DataCacheSize() REQUIRES(!lock_);
 
-  bool NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr)
+  bool NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr, bool baseline)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
+  // Return whether the entry point of `method` is baseline compiled code.
+  bool IsBaselineCompiled(ArtMethod* method)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!lock_);
 
@@ -105,6 +116,11 @@ class JitCodeCache {
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!lock_);
 
+  // Same as NotifyMethodRedefined for several methods, with a single walk of the compiled code.
+  void NotifyMethodsRedefined(const std::unordered_set<ArtMethod*>& methods)
+      REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!lock_);
+
   // Notify to the code cache that the compiler wants to use the
   // profiling info of `method` to drive optimizations,
   // and therefore ensure the returned profiling info object is not
@@ -139,6 +155,7 @@ class JitCodeCache {
                       size_t code_size,
                       size_t data_size,
                       bool osr,
+                      bool baseline,
                       Handle<mirror::ObjectArray<mirror::Object>> roots,
                       bool has_should_deoptimize_flag,
                       const ArenaSet<ArtMethod*>& cha_single_implementation_list)
@@ -184,7 +201,7 @@ class JitCodeCache {
 
   // Given the 'pc', try to find the JIT compiled code associated with it.
   // Return null if 'pc' is not in the code cache. 'method' is passed for
-  // sanity check.
+  // sanity check. Doesn't take the lock for methods that are not native.
   OatQuickMethodHeader* LookupMethodHeader(uintptr_t pc, ArtMethod* method)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -205,7 +222,13 @@ class JitCodeCache {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  void CopyInlineCacheInto(const InlineCache& ic, Handle<mirror::ObjectArray<mirror::Class>> array)
+  // Copy the classes of `ic` into `array`, and the number of times each was seen into the
+  // matching elements of `counts`. `misses` is set to the number of receivers that did not
+  // fit in the inline cache.
+  void CopyInlineCacheInto(const InlineCache& ic,
+                           Handle<mirror::ObjectArray<mirror::Class>> array,
+                           /*out*/ uint16_t* counts,
+                           /*out*/ uint16_t* misses)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -214,12 +237,15 @@ class JitCodeCache {
   ProfilingInfo* AddProfilingInfo(Thread* self,
                                   ArtMethod* method,
                                   const std::vector<uint32_t>& entries,
+                                  const std::vector<uint32_t>& branch_entries,
                                   bool retry_allocation)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   bool OwnsSpace(const void* mspace) const NO_THREAD_SAFETY_ANALYSIS {
-    return mspace == code_mspace_ || mspace == data_mspace_;
+    return mspace == code_mspace_ ||
+        mspace == data_mspace_ ||
+        (mspace != nullptr && mspace == baseline_code_mspace_);
   }
 
   void* MoreCore(const void* mspace, intptr_t increment);
@@ -270,7 +296,8 @@ class JitCodeCache {
                size_t initial_code_capacity,
                size_t initial_data_capacity,
                size_t max_capacity,
-               bool garbage_collect_code);
+               bool garbage_collect_code,
+               bool baseline_code_segment);
 
   // Internal version of 'CommitCode' that will not retry if the
   // allocation fails. Return null if the allocation fails.
@@ -286,6 +313,7 @@ class JitCodeCache {
                               size_t code_size,
                               size_t data_size,
                               bool osr,
+                              bool baseline,
                               Handle<mirror::ObjectArray<mirror::Object>> roots,
                               bool has_should_deoptimize_flag,
                               const ArenaSet<ArtMethod*>& cha_single_implementation_list)
@@ -294,7 +322,8 @@ class JitCodeCache {
 
   ProfilingInfo* AddProfilingInfoInternal(Thread* self,
                                           ArtMethod* method,
-                                          const std::vector<uint32_t>& entries)
+                                          const std::vector<uint32_t>& entries,
+                                          const std::vector<uint32_t>& branch_entries)
       REQUIRES(lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -314,6 +343,11 @@ class JitCodeCache {
       REQUIRES(lock_)
       REQUIRES(Locks::mutator_lock_);
 
+  // Same as RemoveMethodLocked for several methods. Returns whether any was in the cache.
+  bool RemoveMethodsLocked(const std::unordered_set<ArtMethod*>& methods, bool release_memory)
+      REQUIRES(lock_)
+      REQUIRES(Locks::mutator_lock_);
+
   // Free in the mspace allocations for `code_ptr`.
   void FreeCode(const void* code_ptr) REQUIRES(lock_);
 
@@ -355,7 +389,16 @@ class JitCodeCache {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   void FreeCode(uint8_t* code) REQUIRES(lock_);
-  uint8_t* AllocateCode(size_t code_size) REQUIRES(lock_);
+  uint8_t* AllocateCode(size_t code_size, bool baseline) REQUIRES(lock_);
+  bool IsInBaselineCodeSegment(const void* ptr) const REQUIRES(lock_);
+
+  // Copies the keys of method_code_map_ to the code index. Called after each change of the map.
+  void UpdateCodeIndex() REQUIRES(lock_);
+  // Returns the code in method_code_map_ containing `pc`, or null, without taking the lock.
+  const void* LookupCodeIndex(uintptr_t pc) const;
+  Atomic<const void*>* GetCodeIndex() const {
+    return reinterpret_cast<Atomic<const void*>*>(code_index_map_->Begin());
+  }
   void FreeData(uint8_t* data) REQUIRES(lock_);
   uint8_t* AllocateData(size_t data_size) REQUIRES(lock_);
 
@@ -379,6 +422,11 @@ class JitCodeCache {
   std::unique_ptr<MemMap> data_map_;
   // The opaque mspace for allocating code.
   void* code_mspace_ GUARDED_BY(lock_);
+  // The opaque mspace for allocating baseline code at the end of the code map, null if baseline
+  // code is allocated in code_mspace_.
+  void* baseline_code_mspace_ GUARDED_BY(lock_);
+  // The offset of the baseline code segment in the code map.
+  size_t baseline_code_begin_ GUARDED_BY(lock_);
   // The opaque mspace for allocating data.
   void* data_mspace_ GUARDED_BY(lock_);
   // Bitmap for collecting code and data.
@@ -387,8 +435,16 @@ class JitCodeCache {
   SafeMap<JniStubKey, JniStubData> jni_stubs_map_ GUARDED_BY(lock_);
   // Holds compiled code associated to the ArtMethod.
   SafeMap<const void*, ArtMethod*> method_code_map_ GUARDED_BY(lock_);
+  // The sorted code pointers of method_code_map_ for lookups without the lock. There is room
+  // for one entry per kJitCodeAlignment bytes of code. Writers hold the lock and keep the
+  // sequence number odd while they update the index, readers retry if it changed.
+  std::unique_ptr<MemMap> code_index_map_;
+  Atomic<uint32_t> code_index_sequence_;
+  Atomic<size_t> code_index_size_;
   // Holds osr compiled code associated to the ArtMethod.
   SafeMap<ArtMethod*, const void*> osr_code_map_ GUARDED_BY(lock_);
+  // Holds baseline compiled code associated to the ProfilingInfo it updates.
+  SafeMap<const void*, ProfilingInfo*> baseline_code_map_ GUARDED_BY(lock_);
   // ProfilingInfo objects we have allocated.
   std::vector<ProfilingInfo*> profiling_infos_ GUARDED_BY(lock_);
 
@@ -401,6 +457,9 @@ class JitCodeCache {
   // The current footprint in bytes of the code portion of the code cache.
   size_t code_end_ GUARDED_BY(lock_);
 
+  // The current footprint in bytes of the baseline code segment.
+  size_t baseline_code_end_ GUARDED_BY(lock_);
+
   // The current footprint in bytes of the data portion of the code cache.
   size_t data_end_ GUARDED_BY(lock_);
 
@@ -420,6 +479,9 @@ class JitCodeCache {
   // The size in bytes of used memory for the code portion of the code cache.
   size_t used_memory_for_code_ GUARDED_BY(lock_);
 
+  // The part of used_memory_for_code_ in the baseline code segment.
+  size_t used_memory_for_baseline_code_ GUARDED_BY(lock_);
+
   // Number of compilations done throughout the lifetime of the JIT.
   size_t number_of_compilations_ GUARDED_BY(lock_);
 
@@ -23,6 +23,7 @@
 #include <unistd.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <climits>
 #include <cstdlib>
@@ -54,7 +55,8 @@ const uint8_t ProfileCompilationInfo::kProfileMagic[] = { 'p', 'r', 'o', '\0' };
 // Last profile version: merge profiles directly from the file without creating
 // profile_compilation_info object. All the profile line headers are now placed together
 // before corresponding method_encodings and class_ids.
-const uint8_t ProfileCompilationInfo::kProfileVersion[] = { '0', '1', '0', '\0' };
+// Last profile version: Add the branch profiles of the hot methods.
+const uint8_t ProfileCompilationInfo::kProfileVersion[] = { '0', '1', '2', '\0' };
 
 static constexpr uint16_t kMaxDexFileKeyLength = PATH_MAX;
 
@@ -119,6 +121,7 @@ void ProfileCompilationInfo::DexPcData::AddClass(uint16_t dex_profile_idx,
   if (classes.size() + 1 >= InlineCache::kIndividualCacheSize) {
     is_megamorphic = true;
     classes.clear();
+    weights.clear();
     return;
   }
 
@@ -126,6 +129,21 @@ void ProfileCompilationInfo::DexPcData::AddClass(uint16_t dex_profile_idx,
   classes.insert(ref);
 }
 
+void ProfileCompilationInfo::DexPcData::AddWeight(uint16_t dex_profile_idx,
+                                                  const dex::TypeIndex& type_idx,
+                                                  uint16_t weight) {
+  ClassReference ref(dex_profile_idx, type_idx);
+  if (weight == 0u || classes.find(ref) == classes.end()) {
+    return;
+  }
+  auto it = weights.find(ref);
+  if (it == weights.end()) {
+    weights.Put(ref, weight);
+  } else {
+    it->second = std::max(it->second, weight);
+  }
+}
+
 // Transform the actual dex location into relative paths.
 // Note: this is OK because we don't store profiles of different apps into the same file.
 // Apps with split apks don't cause trouble because each split has a different name and will not
@@ -328,16 +346,20 @@ static constexpr size_t kLineHeaderSize =
  * profile_line_data:
  *   method_encoding_1,method_encoding_2...,class_id1,class_id2...,startup/post startup bitmap
  * The method_encoding is:
- *    method_id,number_of_inline_caches,inline_cache1,inline_cache2...
+ *    method_id,number_of_inline_caches,inline_cache1,inline_cache2...,
+ *    number_of_branch_caches,branch_cache1,branch_cache2...
  * The inline_cache is:
  *    dex_pc,[M|dex_map_size], dex_profile_index,class_id1,class_id2...,dex_profile_index2,...
  *    dex_map_size is the number of dex_indeces that follows.
  *       Classes are grouped per their dex files and the line
  *       `dex_profile_index,class_id1,class_id2...,dex_profile_index2,...` encodes the
  *       mapping from `dex_profile_index` to the set of classes `class_id1,class_id2...`
+ *       Each class_id is followed by the number of times the class was seen, 0 if unknown.
  *    M stands for megamorphic or missing types and it's encoded as either
  *    the byte kIsMegamorphicEncoding or kIsMissingTypesEncoding.
  *    When present, there will be no class ids following.
+ * The branch_cache is:
+ *    dex_pc,taken_count,not_taken_count
  **/
 bool ProfileCompilationInfo::Save(int fd) {
   uint64_t start = NanoTime();
@@ -414,14 +436,17 @@ bool ProfileCompilationInfo::Save(int fd) {
     // inline caches can refer valid dex files.
 
     uint16_t last_method_index = 0;
-    for (const auto& method_it : dex_data.method_map) {
-      // Store the difference between the method indices. The SafeMap is ordered by
-      // method_id, so the difference will always be non negative.
-      DCHECK_GE(method_it.first, last_method_index);
-      uint16_t diff_with_last_method_index = method_it.first - last_method_index;
-      last_method_index = method_it.first;
+    for (uint32_t method_index = 0; method_index < dex_data.num_method_ids; ++method_index) {
+      if (!dex_data.IsHotMethod(method_index)) {
+        continue;
+      }
+      // Store the difference between the method indices. The hot methods are visited in
+      // order, so the difference will always be non negative.
+      uint16_t diff_with_last_method_index = method_index - last_method_index;
+      last_method_index = method_index;
       AddUintToBuffer(&buffer, diff_with_last_method_index);
-      AddInlineCacheToBuffer(&buffer, method_it.second);
+      AddInlineCacheToBuffer(&buffer, dex_data.GetInlineCaches(method_index));
+      AddBranchCachesToBuffer(&buffer, dex_data, method_index);
     }
 
     uint16_t last_class_index = 0;
@@ -518,14 +543,39 @@ void ProfileCompilationInfo::AddInlineCacheToBuffer(std::vector<uint8_t>* buffer
       for (size_t i = 0; i < dex_classes.size(); i++) {
         // Add the type index of the classes.
         AddUintToBuffer(buffer, dex_classes[i].index_);
+        // Add the weight of the class.
+        AddUintToBuffer(
+            buffer, dex_pc_data.GetWeight(ClassReference(dex_profile_index, dex_classes[i])));
       }
     }
   }
 }
 
+void ProfileCompilationInfo::AddBranchCachesToBuffer(std::vector<uint8_t>* buffer,
+                                                     const DexFileData& dex_data,
+                                                     uint16_t method_index) {
+  auto it = dex_data.branch_map.find(method_index);
+  if (it == dex_data.branch_map.end()) {
+    AddUintToBuffer(buffer, static_cast<uint16_t>(0u));
+    return;
+  }
+  const BranchCacheMap& branch_caches = it->second;
+  AddUintToBuffer(buffer, static_cast<uint16_t>(branch_caches.size()));
+  for (const auto& branch_it : branch_caches) {
+    AddUintToBuffer(buffer, branch_it.first);  // dex_pc
+    AddUintToBuffer(buffer, branch_it.second.taken);
+    AddUintToBuffer(buffer, branch_it.second.not_taken);
+  }
+}
+
 uint32_t ProfileCompilationInfo::GetMethodsRegionSize(const DexFileData& dex_data) {
-  // ((uint16_t)method index + (uint16_t)inline cache size) * number of methods
-  uint32_t size = 2 * sizeof(uint16_t) * dex_data.method_map.size();
+  // ((uint16_t)method index + (uint16_t)inline cache size + (uint16_t)branch cache size) *
+  // number of methods
+  uint32_t size = 3 * sizeof(uint16_t) * dex_data.GetNumberOfHotMethods();
+  for (const auto& branch_it : dex_data.branch_map) {
+    DCHECK(dex_data.IsHotMethod(branch_it.first));
+    size += 3 * sizeof(uint16_t) * branch_it.second.size();  // dex_pc, taken, not_taken
+  }
   for (const auto& method_it : dex_data.method_map) {
     const InlineCacheMap& inline_cache = method_it.second;
     size += sizeof(uint16_t) * inline_cache.size();  // dex_pc
@@ -539,6 +589,7 @@ uint32_t ProfileCompilationInfo::GetMethodsRegionSize(const DexFileData& dex_dat
         size += sizeof(uint8_t);  // number of classes
         const std::vector<dex::TypeIndex>& dex_classes = dex_it.second;
         size += sizeof(uint16_t) * dex_classes.size();  // the actual classes
+        size += sizeof(uint16_t) * dex_classes.size();  // the weights of the classes
       }
     }
   }
@@ -647,12 +698,22 @@ bool ProfileCompilationInfo::AddMethod(const std::string& dex_location,
     return false;
   }
   // Add the method.
-  InlineCacheMap* inline_cache = data->FindOrAddMethod(method_index);
+  if (!data->AddMethod(MethodHotness::kFlagHot, method_index)) {
+    return false;
+  }
 
-  if (pmi.inline_caches == nullptr) {
+  if (pmi.branch_caches != nullptr && !pmi.branch_caches->empty()) {
+    BranchCacheMap* branch_caches = data->FindOrAddBranches(method_index);
+    for (const auto& branch_it : *pmi.branch_caches) {
+      branch_caches->FindOrAdd(branch_it.first)->second.Merge(branch_it.second);
+    }
+  }
+
+  if (pmi.inline_caches == nullptr || pmi.inline_caches->empty()) {
     // If we don't have inline caches return success right away.
     return true;
   }
+  InlineCacheMap* inline_cache = data->FindOrAddMethod(method_index);
   for (const auto& pmi_inline_cache_it : *pmi.inline_caches) {
     uint16_t pmi_ic_dex_pc = pmi_inline_cache_it.first;
     const DexPcData& pmi_ic_dex_pc_data = pmi_inline_cache_it.second;
@@ -681,6 +742,9 @@ bool ProfileCompilationInfo::AddMethod(const std::string& dex_location,
         return false;
       }
       dex_pc_data->AddClass(class_dex_data->profile_index, class_ref.type_index);
+      dex_pc_data->AddWeight(class_dex_data->profile_index,
+                             class_ref.type_index,
+                             pmi_ic_dex_pc_data.GetWeight(class_ref));
     }
   }
   return true;
@@ -691,14 +755,29 @@ bool ProfileCompilationInfo::AddMethod(const ProfileMethodInfo& pmi) {
   if (data == nullptr) {  // checksum mismatch
     return false;
   }
-  InlineCacheMap* inline_cache = data->FindOrAddMethod(pmi.ref.index);
+  if (!data->AddMethod(MethodHotness::kFlagHot, pmi.ref.index)) {
+    return false;
+  }
+
+  if (!pmi.branch_caches.empty()) {
+    BranchCacheMap* branch_caches = data->FindOrAddBranches(pmi.ref.index);
+    for (const ProfileMethodInfo::ProfileBranchCache& cache : pmi.branch_caches) {
+      branch_caches->FindOrAdd(cache.dex_pc)->second.Merge(
+          BranchCounts(cache.taken, cache.not_taken));
+    }
+  }
 
+  if (pmi.inline_caches.empty()) {
+    return true;
+  }
+  InlineCacheMap* inline_cache = data->FindOrAddMethod(pmi.ref.index);
   for (const ProfileMethodInfo::ProfileInlineCache& cache : pmi.inline_caches) {
     if (cache.is_missing_types) {
       FindOrAddDexPc(inline_cache, cache.dex_pc)->SetIsMissingTypes();
       continue;
     }
-    for (const TypeReference& class_ref : cache.classes) {
+    for (size_t i = 0; i < cache.classes.size(); ++i) {
+      const TypeReference& class_ref = cache.classes[i];
       DexFileData* class_dex_data = GetOrAddDexFileData(class_ref.dex_file);
       if (class_dex_data == nullptr) {  // checksum mismatch
         return false;
@@ -709,6 +788,10 @@ bool ProfileCompilationInfo::AddMethod(const ProfileMethodInfo& pmi) {
         break;
       }
       dex_pc_data->AddClass(class_dex_data->profile_index, class_ref.TypeIndex());
+      if (!cache.weights.empty()) {
+        dex_pc_data->AddWeight(
+            class_dex_data->profile_index, class_ref.TypeIndex(), cache.weights[i]);
+      }
     }
   }
   return true;
@@ -739,10 +822,15 @@ bool ProfileCompilationInfo::ReadInlineCache(
     SafeBuffer& buffer,
     uint8_t number_of_dex_files,
     const SafeMap<uint8_t, uint8_t>& dex_profile_index_remap,
-    /*out*/ InlineCacheMap* inline_cache,
+    uint16_t method_index,
+    /*out*/ DexFileData* data,
     /*out*/ std::string* error) {
   uint16_t inline_cache_size;
   READ_UINT(uint16_t, buffer, inline_cache_size, error);
+  if (inline_cache_size == 0) {
+    return true;
+  }
+  InlineCacheMap* inline_cache = data->FindOrAddMethod(method_index);
   for (; inline_cache_size > 0; inline_cache_size--) {
     uint16_t dex_pc;
     uint8_t dex_to_classes_map_size;
@@ -769,15 +857,41 @@ bool ProfileCompilationInfo::ReadInlineCache(
       }
       for (; dex_classes_size > 0; dex_classes_size--) {
         uint16_t type_index;
+        uint16_t weight;
         READ_UINT(uint16_t, buffer, type_index, error);
+        READ_UINT(uint16_t, buffer, weight, error);
         dex_pc_data->AddClass(dex_profile_index_remap.Get(dex_profile_index),
                               dex::TypeIndex(type_index));
+        dex_pc_data->AddWeight(dex_profile_index_remap.Get(dex_profile_index),
+                               dex::TypeIndex(type_index),
+                               weight);
       }
     }
   }
   return true;
 }
 
+bool ProfileCompilationInfo::ReadBranchCaches(SafeBuffer& buffer,
+                                              uint16_t method_index,
+                                              /*out*/ DexFileData* data,
+                                              /*out*/ std::string* error) {
+  uint16_t branch_caches_size;
+  READ_UINT(uint16_t, buffer, branch_caches_size, error);
+  if (branch_caches_size == 0) {
+    return true;
+  }
+  BranchCacheMap* branch_caches = data->FindOrAddBranches(method_index);
+  for (; branch_caches_size > 0; branch_caches_size--) {
+    uint16_t dex_pc;
+    BranchCounts counts;
+    READ_UINT(uint16_t, buffer, dex_pc, error);
+    READ_UINT(uint16_t, buffer, counts.taken, error);
+    READ_UINT(uint16_t, buffer, counts.not_taken, error);
+    branch_caches->FindOrAdd(dex_pc)->second.Merge(counts);
+  }
+  return true;
+}
+
 bool ProfileCompilationInfo::ReadMethods(SafeBuffer& buffer,
                                          uint8_t number_of_dex_files,
                                          const ProfileLineHeader& line_header,
@@ -799,14 +913,21 @@ bool ProfileCompilationInfo::ReadMethods(SafeBuffer& buffer,
     READ_UINT(uint16_t, buffer, diff_with_last_method_index, error);
     uint16_t method_index = last_method_index + diff_with_last_method_index;
     last_method_index = method_index;
-    InlineCacheMap* inline_cache = data->FindOrAddMethod(method_index);
+    if (!data->AddMethod(MethodHotness::kFlagHot, method_index)) {
+      *error += "Invalid method index in ReadMethods";
+      return false;
+    }
     if (!ReadInlineCache(buffer,
                          number_of_dex_files,
                          dex_profile_index_remap,
-                         inline_cache,
+                         method_index,
+                         data,
                          error)) {
       return false;
     }
+    if (!ReadBranchCaches(buffer, method_index, data, error)) {
+      return false;
+    }
   }
   uint32_t total_bytes_read = unread_bytes_before_operation - buffer.CountUnreadBytes();
   if (total_bytes_read != line_header.method_region_size_bytes) {
@@ -1009,6 +1130,7 @@ ProfileCompilationInfo::ProfileLoadSatus ProfileCompilationInfo::ReadProfileLine
       const ProfileLineHeader& line_header,
       const SafeMap<uint8_t, uint8_t>& dex_profile_index_remap,
       bool merge_classes,
+      const ProfileLoadFilterFn& filter_fn,
       /*out*/std::string* error) {
   DexFileData* data = GetOrAddDexFileData(line_header.dex_location,
                                           line_header.checksum,
@@ -1019,6 +1141,19 @@ ProfileCompilationInfo::ProfileLoadSatus ProfileCompilationInfo::ReadProfileLine
     return kProfileLoadBadData;
   }
 
+  const size_t classes_bytes = line_header.class_set_size * sizeof(uint16_t);
+  if (!filter_fn(line_header.dex_location, line_header.checksum)) {
+    // Skip the methods, the classes and the method bitmap of the line.
+    const size_t bytes =
+        line_header.method_region_size_bytes + classes_bytes + data->bitmap_storage.size();
+    if (buffer.CountUnreadBytes() < bytes) {
+      *error += "Profile EOF reached prematurely for ReadProfileLine";
+      return kProfileLoadBadData;
+    }
+    buffer.Advance(bytes);
+    return kProfileLoadSuccess;
+  }
+
   if (!ReadMethods(buffer, number_of_dex_files, line_header, dex_profile_index_remap, error)) {
     return kProfileLoadBadData;
   }
@@ -1027,6 +1162,12 @@ ProfileCompilationInfo::ProfileLoadSatus ProfileCompilationInfo::ReadProfileLine
     if (!ReadClasses(buffer, line_header, error)) {
       return kProfileLoadBadData;
     }
+  } else {
+    if (buffer.CountUnreadBytes() < classes_bytes) {
+      *error += "Profile EOF reached prematurely for ReadClasses";
+      return kProfileLoadBadData;
+    }
+    buffer.Advance(classes_bytes);
   }
 
   const size_t bytes = data->bitmap_storage.size();
@@ -1043,10 +1184,18 @@ ProfileCompilationInfo::ProfileLoadSatus ProfileCompilationInfo::ReadProfileLine
 
 // TODO(calin): Fix this API. ProfileCompilationInfo::Load should be static and
 // return a unique pointer to a ProfileCompilationInfo upon success.
-bool ProfileCompilationInfo::Load(int fd, bool merge_classes) {
+bool ProfileCompilationInfo::ProfileFilterFnAcceptAll(
+    const std::string& dex_location ATTRIBUTE_UNUSED,
+    uint32_t checksum ATTRIBUTE_UNUSED) {
+  return true;
+}
+
+bool ProfileCompilationInfo::Load(int fd,
+                                  bool merge_classes,
+                                  const ProfileLoadFilterFn& filter_fn) {
   std::string error;
 
-  ProfileLoadSatus status = LoadInternal(fd, &error, merge_classes);
+  ProfileLoadSatus status = LoadInternal(fd, &error, merge_classes, filter_fn);
 
   if (status == kProfileLoadSuccess) {
     return true;
@@ -1150,7 +1299,7 @@ bool ProfileCompilationInfo::VerifyProfileData(const std::vector<const DexFile*>
 
 // TODO(calin): fail fast if the dex checksums don't match.
 ProfileCompilationInfo::ProfileLoadSatus ProfileCompilationInfo::LoadInternal(
-      int fd, std::string* error, bool merge_classes) {
+      int fd, std::string* error, bool merge_classes, const ProfileLoadFilterFn& filter_fn) {
   ScopedTrace trace(__PRETTY_FUNCTION__);
   DCHECK_GE(fd, 0);
 
@@ -1242,6 +1391,7 @@ ProfileCompilationInfo::ProfileLoadSatus ProfileCompilationInfo::LoadInternal(
                              profile_line_headers[k],
                              dex_profile_index_remap,
                              merge_classes,
+                             filter_fn,
                              error);
     if (status != kProfileLoadSuccess) {
       return status;
@@ -1395,11 +1545,14 @@ bool ProfileCompilationInfo::MergeWith(const ProfileCompilationInfo& other,
                                  other_dex_data->class_set.end());
     }
 
-    // Merge the methods and the inline caches.
+    // Merge the inline caches. The hot methods are merged with the method bitmaps below.
     for (const auto& other_method_it : other_dex_data->method_map) {
+      const auto& other_inline_cache = other_method_it.second;
+      if (other_inline_cache.empty()) {
+        continue;
+      }
       uint16_t other_method_index = other_method_it.first;
       InlineCacheMap* inline_cache = dex_data->FindOrAddMethod(other_method_index);
-      const auto& other_inline_cache = other_method_it.second;
       for (const auto& other_ic_it : other_inline_cache) {
         uint16_t other_dex_pc = other_ic_it.first;
         const ClassSet& other_class_set = other_ic_it.second.classes;
@@ -1412,11 +1565,22 @@ bool ProfileCompilationInfo::MergeWith(const ProfileCompilationInfo& other,
           for (const auto& class_it : other_class_set) {
             dex_pc_data->AddClass(dex_profile_index_remap.Get(
                 class_it.dex_profile_index), class_it.type_index);
+            dex_pc_data->AddWeight(dex_profile_index_remap.Get(class_it.dex_profile_index),
+                                   class_it.type_index,
+                                   other_ic_it.second.GetWeight(class_it));
           }
         }
       }
     }
 
+    // Merge the branch profiles.
+    for (const auto& other_branch_it : other_dex_data->branch_map) {
+      BranchCacheMap* branch_caches = dex_data->FindOrAddBranches(other_branch_it.first);
+      for (const auto& other_counts_it : other_branch_it.second) {
+        branch_caches->FindOrAdd(other_counts_it.first)->second.Merge(other_counts_it.second);
+      }
+    }
+
     // Merge the method bitmaps.
     dex_data->MergeBitmap(*other_dex_data);
   }
@@ -1467,7 +1631,16 @@ std::unique_ptr<ProfileCompilationInfo::OfflineProfileMethodInfo> ProfileCompila
   }
   const InlineCacheMap* inline_caches = hotness.GetInlineCacheMap();
   DCHECK(inline_caches != nullptr);
-  std::unique_ptr<OfflineProfileMethodInfo> pmi(new OfflineProfileMethodInfo(inline_caches));
+  const BranchCacheMap* branch_caches = nullptr;
+  const DexFileData* method_dex_data =
+      FindDexData(GetProfileDexFileKey(dex_location), dex_checksum);
+  DCHECK(method_dex_data != nullptr);
+  auto branch_it = method_dex_data->branch_map.find(dex_method_index);
+  if (branch_it != method_dex_data->branch_map.end()) {
+    branch_caches = &branch_it->second;
+  }
+  std::unique_ptr<OfflineProfileMethodInfo> pmi(
+      new OfflineProfileMethodInfo(inline_caches, branch_caches));
 
   pmi->dex_references.resize(info_.size());
   for (const DexFileData* dex_data : info_) {
@@ -1492,7 +1665,7 @@ bool ProfileCompilationInfo::ContainsClass(const DexFile& dex_file, dex::TypeInd
 uint32_t ProfileCompilationInfo::GetNumberOfMethods() const {
   uint32_t total = 0;
   for (const DexFileData* dex_data : info_) {
-    total += dex_data->method_map.size();
+    total += dex_data->GetNumberOfHotMethods();
   }
   return total;
 }
@@ -1553,15 +1726,18 @@ std::string ProfileCompilationInfo::DumpInfo(const std::vector<const DexFile*>*
       }
     }
     os << "\n\thot methods: ";
-    for (const auto& method_it : dex_data->method_map) {
+    for (uint32_t method_idx = 0; method_idx < dex_data->num_method_ids; ++method_idx) {
+      if (!dex_data->IsHotMethod(method_idx)) {
+        continue;
+      }
       if (dex_file != nullptr) {
-        os << "\n\t\t" << dex_file->PrettyMethod(method_it.first, true);
+        os << "\n\t\t" << dex_file->PrettyMethod(method_idx, true);
       } else {
-        os << method_it.first;
+        os << method_idx;
       }
 
       os << "[";
-      for (const auto& inline_cache_it : method_it.second) {
+      for (const auto& inline_cache_it : dex_data->GetInlineCaches(method_idx)) {
         os << "{" << std::hex << inline_cache_it.first << std::dec << ":";
         if (inline_cache_it.second.is_missing_types) {
           os << "MT";
@@ -1575,6 +1751,13 @@ std::string ProfileCompilationInfo::DumpInfo(const std::vector<const DexFile*>*
         }
         os << "}";
       }
+      auto branch_it = dex_data->branch_map.find(method_idx);
+      if (branch_it != dex_data->branch_map.end()) {
+        for (const auto& counts_it : branch_it->second) {
+          os << "{" << std::hex << counts_it.first << std::dec << ":B("
+             << counts_it.second.taken << "," << counts_it.second.not_taken << ")}";
+        }
+      }
       os << "], ";
     }
     bool startup = true;
@@ -1618,11 +1801,11 @@ bool ProfileCompilationInfo::GetClassesAndMethods(
   if (dex_data == nullptr) {
     return false;
   }
-  for (const auto& it : dex_data->method_map) {
-    hot_method_set->insert(it.first);
-  }
   for (uint32_t method_idx = 0; method_idx < dex_data->num_method_ids; ++method_idx) {
     MethodHotness hotness = dex_data->GetHotnessInfo(method_idx);
+    if (hotness.IsHot()) {
+      hot_method_set->insert(method_idx);
+    }
     if (hotness.IsStartup()) {
       startup_method_set->insert(method_idx);
     }
@@ -1790,6 +1973,13 @@ bool ProfileCompilationInfo::OfflineProfileMethodInfo::operator==(
   if (inline_caches->size() != other.inline_caches->size()) {
     return false;
   }
+  bool has_branch_caches = (branch_caches != nullptr) && !branch_caches->empty();
+  bool other_has_branch_caches =
+      (other.branch_caches != nullptr) && !other.branch_caches->empty();
+  if (has_branch_caches != other_has_branch_caches ||
+      (has_branch_caches && *branch_caches != *other.branch_caches)) {
+    return false;
+  }
 
   // We can't use a simple equality test because we need to match the dex files
   // of the inline caches which might have different profile indexes.
@@ -1833,11 +2023,20 @@ bool ProfileCompilationInfo::IsEmpty() const {
 
 ProfileCompilationInfo::InlineCacheMap*
 ProfileCompilationInfo::DexFileData::FindOrAddMethod(uint16_t method_index) {
+  DCHECK_LT(method_index, num_method_ids);
+  hot_method_bitmap.StoreBit(method_index, /*value*/ true);
   return &(method_map.FindOrAdd(
       method_index,
       InlineCacheMap(std::less<uint16_t>(), allocator_->Adapter(kArenaAllocProfile)))->second);
 }
 
+ProfileCompilationInfo::BranchCacheMap*
+ProfileCompilationInfo::DexFileData::FindOrAddBranches(uint16_t method_index) {
+  return &(branch_map.FindOrAdd(
+      method_index,
+      BranchCacheMap(std::less<uint16_t>(), allocator_->Adapter(kArenaAllocProfile)))->second);
+}
+
 // Mark a method as executed at least once.
 bool ProfileCompilationInfo::DexFileData::AddMethod(MethodHotness::Flag flags, size_t index) {
   if (index >= num_method_ids) {
@@ -1852,13 +2051,49 @@ bool ProfileCompilationInfo::DexFileData::AddMethod(MethodHotness::Flag flags, s
     method_bitmap.StoreBit(MethodBitIndex(/*startup*/ false, index), /*value*/ true);
   }
   if ((flags & MethodHotness::kFlagHot) != 0) {
-    method_map.FindOrAdd(
-        index,
-        InlineCacheMap(std::less<uint16_t>(), allocator_->Adapter(kArenaAllocProfile)));
+    hot_method_bitmap.StoreBit(index, /*value*/ true);
   }
   return true;
 }
 
+uint32_t ProfileCompilationInfo::DexFileData::GetNumberOfHotMethods() const {
+  // The bits past `num_method_ids` are never set.
+  uint32_t count = 0;
+  for (uint8_t byte : hot_bitmap_storage) {
+    count += POPCOUNT(byte);
+  }
+  return count;
+}
+
+const ProfileCompilationInfo::InlineCacheMap&
+ProfileCompilationInfo::DexFileData::GetInlineCaches(uint16_t method_index) const {
+  DCHECK(IsHotMethod(method_index));
+  auto it = method_map.find(method_index);
+  return (it != method_map.end()) ? it->second : empty_inline_cache_map;
+}
+
+bool ProfileCompilationInfo::DexFileData::SameInlineCaches(const DexFileData& other) const {
+  auto it = method_map.begin();
+  auto other_it = other.method_map.begin();
+  while (true) {
+    // Skip the entries without inline caches, which are the same as no entry.
+    while (it != method_map.end() && it->second.empty()) {
+      ++it;
+    }
+    while (other_it != other.method_map.end() && other_it->second.empty()) {
+      ++other_it;
+    }
+    if (it == method_map.end() || other_it == other.method_map.end()) {
+      return it == method_map.end() && other_it == other.method_map.end();
+    }
+    if (it->first != other_it->first || it->second != other_it->second) {
+      return false;
+    }
+    ++it;
+    ++other_it;
+  }
+}
+
 ProfileCompilationInfo::MethodHotness ProfileCompilationInfo::DexFileData::GetHotnessInfo(
     uint32_t dex_method_index) const {
   MethodHotness ret;
@@ -1868,9 +2103,8 @@ ProfileCompilationInfo::MethodHotness ProfileCompilationInfo::DexFileData::GetHo
   if (method_bitmap.LoadBit(MethodBitIndex(/*startup*/ false, dex_method_index))) {
     ret.AddFlag(MethodHotness::kFlagPostStartup);
   }
-  auto it = method_map.find(dex_method_index);
-  if (it != method_map.end()) {
-    ret.SetInlineCacheMap(&it->second);
+  if (IsHotMethod(dex_method_index)) {
+    ret.SetInlineCacheMap(&GetInlineCaches(dex_method_index));
     ret.AddFlag(MethodHotness::kFlagHot);
   }
   return ret;
@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_JIT_PROFILE_COMPILATION_INFO_H_
 #define ART_RUNTIME_JIT_PROFILE_COMPILATION_INFO_H_
 
+#include <algorithm>
+#include <functional>
 #include <set>
 #include <vector>
 
@@ -44,9 +46,32 @@ struct ProfileMethodInfo {
                        const std::vector<TypeReference>& profile_classes)
         : dex_pc(pc), is_missing_types(missing_types), classes(profile_classes) {}
 
+    ProfileInlineCache(uint32_t pc,
+                       bool missing_types,
+                       const std::vector<TypeReference>& profile_classes,
+                       const std::vector<uint16_t>& profile_weights)
+        : dex_pc(pc),
+          is_missing_types(missing_types),
+          classes(profile_classes),
+          weights(profile_weights) {
+      DCHECK_EQ(classes.size(), weights.size());
+    }
+
     const uint32_t dex_pc;
     const bool is_missing_types;
     const std::vector<TypeReference> classes;
+    // The number of times each of the classes was seen, empty if unknown.
+    const std::vector<uint16_t> weights;
+  };
+
+  struct ProfileBranchCache {
+    ProfileBranchCache(uint32_t pc, uint16_t taken_count, uint16_t not_taken_count)
+        : dex_pc(pc), taken(taken_count), not_taken(not_taken_count) {}
+
+    const uint32_t dex_pc;
+    // The number of times the IF instruction at `dex_pc` jumped to its target, and fell through.
+    const uint16_t taken;
+    const uint16_t not_taken;
   };
 
   explicit ProfileMethodInfo(MethodReference reference) : ref(reference) {}
@@ -55,8 +80,16 @@ struct ProfileMethodInfo {
       : ref(reference),
         inline_caches(caches) {}
 
+  ProfileMethodInfo(MethodReference reference,
+                    const std::vector<ProfileInlineCache>& caches,
+                    const std::vector<ProfileBranchCache>& branches)
+      : ref(reference),
+        inline_caches(caches),
+        branch_caches(branches) {}
+
   MethodReference ref;
   std::vector<ProfileInlineCache> inline_caches;
+  std::vector<ProfileBranchCache> branch_caches;
 };
 
 /**
@@ -129,6 +162,9 @@ class ProfileCompilationInfo {
   // The set of classes that can be found at a given dex pc.
   using ClassSet = ArenaSet<ClassReference>;
 
+  // The number of times each class of an inline cache was seen.
+  using ClassWeights = ArenaSafeMap<ClassReference, uint16_t>;
+
   // Encodes the actual inline cache for a given dex pc (whether or not the receiver is
   // megamorphic and its possible types).
   // If the receiver is megamorphic or is missing types the set of classes will be empty.
@@ -136,22 +172,33 @@ class ProfileCompilationInfo {
     explicit DexPcData(ArenaAllocator* allocator)
         : is_missing_types(false),
           is_megamorphic(false),
-          classes(std::less<ClassReference>(), allocator->Adapter(kArenaAllocProfile)) {}
+          classes(std::less<ClassReference>(), allocator->Adapter(kArenaAllocProfile)),
+          weights(std::less<ClassReference>(), allocator->Adapter(kArenaAllocProfile)) {}
     void AddClass(uint16_t dex_profile_idx, const dex::TypeIndex& type_idx);
+    // Record that the class was seen `weight` times, if it is part of the inline cache. The
+    // largest weight recorded is kept, so that merging the same profile again has no effect.
+    void AddWeight(uint16_t dex_profile_idx, const dex::TypeIndex& type_idx, uint16_t weight);
+    uint16_t GetWeight(const ClassReference& class_ref) const {
+      auto it = weights.find(class_ref);
+      return (it != weights.end()) ? it->second : 0u;
+    }
     void SetIsMegamorphic() {
       if (is_missing_types) return;
       is_megamorphic = true;
       classes.clear();
+      weights.clear();
     }
     void SetIsMissingTypes() {
       is_megamorphic = false;
       is_missing_types = true;
       classes.clear();
+      weights.clear();
     }
     bool operator==(const DexPcData& other) const {
       return is_megamorphic == other.is_megamorphic &&
           is_missing_types == other.is_missing_types &&
-          classes == other.classes;
+          classes == other.classes &&
+          weights == other.weights;
     }
 
     // Not all runtime types can be encoded in the profile. For example if the receiver
@@ -160,6 +207,8 @@ class ProfileCompilationInfo {
     bool is_missing_types;
     bool is_megamorphic;
     ClassSet classes;
+    // Only has entries for the classes with a known, non zero, weight.
+    ClassWeights weights;
   };
 
   // The inline cache map: DexPc -> DexPcData.
@@ -168,6 +217,32 @@ class ProfileCompilationInfo {
   // Maps a method dex index to its inline cache.
   using MethodMap = ArenaSafeMap<uint16_t, InlineCacheMap>;
 
+  // The number of times an IF instruction jumped to its target, and fell through.
+  struct BranchCounts {
+    BranchCounts() : taken(0u), not_taken(0u) {}
+    BranchCounts(uint16_t taken_count, uint16_t not_taken_count)
+        : taken(taken_count), not_taken(not_taken_count) {}
+
+    // The largest counts are kept, so that merging the same profile again has no effect.
+    void Merge(const BranchCounts& other) {
+      taken = std::max(taken, other.taken);
+      not_taken = std::max(not_taken, other.not_taken);
+    }
+
+    bool operator==(const BranchCounts& other) const {
+      return taken == other.taken && not_taken == other.not_taken;
+    }
+
+    uint16_t taken;
+    uint16_t not_taken;
+  };
+
+  // The branch profile of a method: DexPc -> BranchCounts.
+  using BranchCacheMap = ArenaSafeMap<uint16_t, BranchCounts>;
+
+  // Maps a method dex index to its branch profile.
+  using MethodBranchMap = ArenaSafeMap<uint16_t, BranchCacheMap>;
+
   // Profile method hotness information for a single method. Also includes a pointer to the inline
   // cache map.
   class MethodHotness {
@@ -222,12 +297,15 @@ class ProfileCompilationInfo {
   // i.e. the dex file of any ClassReference present in the inline caches can be found at
   // dex_references[ClassReference::dex_profile_index].
   struct OfflineProfileMethodInfo {
-    explicit OfflineProfileMethodInfo(const InlineCacheMap* inline_cache_map)
-        : inline_caches(inline_cache_map) {}
+    explicit OfflineProfileMethodInfo(const InlineCacheMap* inline_cache_map,
+                                      const BranchCacheMap* branch_cache_map = nullptr)
+        : inline_caches(inline_cache_map), branch_caches(branch_cache_map) {}
 
     bool operator==(const OfflineProfileMethodInfo& other) const;
 
     const InlineCacheMap* const inline_caches;
+    // Null if the method has no branch profile.
+    const BranchCacheMap* const branch_caches;
     std::vector<DexReference> dex_references;
   };
 
@@ -300,10 +378,21 @@ class ProfileCompilationInfo {
   // Add hotness flags for a simple method.
   bool AddMethodHotness(const MethodReference& method_ref, const MethodHotness& hotness);
 
+  // Filter of the dex files to load from a profile, given their profile key and checksum.
+  using ProfileLoadFilterFn = std::function<bool(const std::string&, uint32_t)>;
+
+  // The default filter, which loads all the dex files.
+  static bool ProfileFilterFnAcceptAll(const std::string& dex_location, uint32_t checksum);
+
   // Load or Merge profile information from the given file descriptor.
   // If the current profile is non-empty the load will fail.
   // If merge_classes is set to false, classes will not be merged/loaded.
-  bool Load(int fd, bool merge_classes = true);
+  // The methods and classes of the dex files rejected by filter_fn are skipped without being
+  // decoded. These dex files are still known to the profile, without any method or class, so
+  // that the inline caches can refer to them.
+  bool Load(int fd,
+            bool merge_classes = true,
+            const ProfileLoadFilterFn& filter_fn = ProfileFilterFnAcceptAll);
 
   // Verify integrity of the profile file with the provided dex files.
   // If there exists a DexData object which maps to a dex_file, then it verifies that:
@@ -439,19 +528,30 @@ class ProfileCompilationInfo {
           profile_index(index),
           checksum(location_checksum),
           method_map(std::less<uint16_t>(), allocator->Adapter(kArenaAllocProfile)),
+          branch_map(std::less<uint16_t>(), allocator->Adapter(kArenaAllocProfile)),
           class_set(std::less<dex::TypeIndex>(), allocator->Adapter(kArenaAllocProfile)),
           num_method_ids(num_methods),
-          bitmap_storage(allocator->Adapter(kArenaAllocProfile)) {
+          bitmap_storage(allocator->Adapter(kArenaAllocProfile)),
+          hot_bitmap_storage(allocator->Adapter(kArenaAllocProfile)),
+          empty_inline_cache_map(std::less<uint16_t>(), allocator->Adapter(kArenaAllocProfile)) {
       const size_t num_bits = num_method_ids * kBitmapIndexCount;
       bitmap_storage.resize(RoundUp(num_bits, kBitsPerByte) / kBitsPerByte);
       if (!bitmap_storage.empty()) {
         method_bitmap =
             BitMemoryRegion(MemoryRegion(&bitmap_storage[0], bitmap_storage.size()), 0, num_bits);
       }
+      hot_bitmap_storage.resize(RoundUp(num_method_ids, kBitsPerByte) / kBitsPerByte);
+      if (!hot_bitmap_storage.empty()) {
+        hot_method_bitmap = BitMemoryRegion(
+            MemoryRegion(&hot_bitmap_storage[0], hot_bitmap_storage.size()), 0, num_method_ids);
+      }
     }
 
     bool operator==(const DexFileData& other) const {
-      return checksum == other.checksum && method_map == other.method_map;
+      return checksum == other.checksum &&
+          hot_bitmap_storage == other.hot_bitmap_storage &&
+          SameInlineCaches(other) &&
+          branch_map == other.branch_map;
     }
 
     // Mark a method as executed at least once.
@@ -462,8 +562,22 @@ class ProfileCompilationInfo {
       for (size_t i = 0; i < bitmap_storage.size(); ++i) {
         bitmap_storage[i] |= other.bitmap_storage[i];
       }
+      DCHECK_EQ(hot_bitmap_storage.size(), other.hot_bitmap_storage.size());
+      for (size_t i = 0; i < hot_bitmap_storage.size(); ++i) {
+        hot_bitmap_storage[i] |= other.hot_bitmap_storage[i];
+      }
     }
 
+    bool IsHotMethod(uint32_t dex_method_index) const {
+      DCHECK_LT(dex_method_index, num_method_ids);
+      return hot_method_bitmap.LoadBit(dex_method_index);
+    }
+
+    uint32_t GetNumberOfHotMethods() const;
+
+    // Return the inline caches of a hot method, which are empty if `method_map` has no entry.
+    const InlineCacheMap& GetInlineCaches(uint16_t method_index) const;
+
     MethodHotness GetHotnessInfo(uint32_t dex_method_index) const;
 
     // The allocator used to allocate new inline cache maps.
@@ -474,20 +588,36 @@ class ProfileCompilationInfo {
     uint8_t profile_index;
     // The dex checksum.
     uint32_t checksum;
-    // The methonds' profile information.
+    // The inline caches of the hot methods which have some. The other hot methods are only
+    // recorded in `hot_method_bitmap`, which saves a map entry per method.
     MethodMap method_map;
+    // The branch profiles of the methods in `method_map` which have one.
+    MethodBranchMap branch_map;
     // The classes which have been profiled. Note that these don't necessarily include
     // all the classes that can be found in the inline caches reference.
     ArenaSet<dex::TypeIndex> class_set;
-    // Find the inline caches of the the given method index. Add an empty entry if
-    // no previous data is found.
+    // Find the inline caches of the the given method index and mark the method as hot.
+    // Add an empty entry if no previous data is found.
     InlineCacheMap* FindOrAddMethod(uint16_t method_index);
+    // Find the branch profile of the given method index. Add an empty entry if
+    // no previous data is found.
+    BranchCacheMap* FindOrAddBranches(uint16_t method_index);
     // Num method ids.
     uint32_t num_method_ids;
     ArenaVector<uint8_t> bitmap_storage;
     BitMemoryRegion method_bitmap;
+    // One bit per method index for the hot methods. Unlike `method_bitmap`, it is not
+    // serialized, as the methods region of the profile lists the hot methods.
+    ArenaVector<uint8_t> hot_bitmap_storage;
+    BitMemoryRegion hot_method_bitmap;
+    // The inline caches returned for the hot methods without an entry in `method_map`.
+    const InlineCacheMap empty_inline_cache_map;
 
    private:
+    // Compare the inline caches of the hot methods, with no entry in `method_map` being the same
+    // as an empty one.
+    bool SameInlineCaches(const DexFileData& other) const;
+
     enum BitmapIndex {
       kBitmapIndexStartup,
       kBitmapIndexPostStartup,
@@ -621,7 +751,10 @@ class ProfileCompilationInfo {
   };
 
   // Entry point for profile loding functionality.
-  ProfileLoadSatus LoadInternal(int fd, std::string* error, bool merge_classes = true);
+  ProfileLoadSatus LoadInternal(int fd,
+                                std::string* error,
+                                bool merge_classes = true,
+                                const ProfileLoadFilterFn& filter_fn = ProfileFilterFnAcceptAll);
 
   // Read the profile header from the given fd and store the number of profile
   // lines into number_of_dex_files.
@@ -648,6 +781,7 @@ class ProfileCompilationInfo {
                                    const ProfileLineHeader& line_header,
                                    const SafeMap<uint8_t, uint8_t>& dex_profile_index_remap,
                                    bool merge_classes,
+                                   const ProfileLoadFilterFn& filter_fn,
                                    /*out*/std::string* error);
 
   // Read all the classes from the buffer into the profile `info_` structure.
@@ -667,17 +801,29 @@ class ProfileCompilationInfo {
   bool RemapProfileIndex(const std::vector<ProfileLineHeader>& profile_line_headers,
                          /*out*/SafeMap<uint8_t, uint8_t>* dex_profile_index_remap);
 
-  // Read the inline cache encoding from line_bufer into inline_cache.
+  // Read the inline cache encoding of a method from line_bufer into data.
   bool ReadInlineCache(SafeBuffer& buffer,
                        uint8_t number_of_dex_files,
                        const SafeMap<uint8_t, uint8_t>& dex_profile_index_remap,
-                       /*out*/InlineCacheMap* inline_cache,
+                       uint16_t method_index,
+                       /*out*/DexFileData* data,
                        /*out*/std::string* error);
 
+  // Read the branch profile of a method from the buffer. Returns true on success.
+  bool ReadBranchCaches(SafeBuffer& buffer,
+                        uint16_t method_index,
+                        /*out*/DexFileData* data,
+                        /*out*/std::string* error);
+
   // Encode the inline cache into the given buffer.
   void AddInlineCacheToBuffer(std::vector<uint8_t>* buffer,
                               const InlineCacheMap& inline_cache);
 
+  // Encode the branch profile of the method into the given buffer.
+  void AddBranchCachesToBuffer(std::vector<uint8_t>* buffer,
+                               const DexFileData& dex_data,
+                               uint16_t method_index);
+
   // Return the number of bytes needed to encode the profile information
   // for the methods in dex_data.
   uint32_t GetMethodsRegionSize(const DexFileData& dex_data);
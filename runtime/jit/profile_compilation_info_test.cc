@@ -820,6 +820,88 @@ TEST_F(ProfileCompilationInfoTest, MegamorphicInlineCachesMerge) {
   ASSERT_TRUE(info_no_inline_cache.Save(GetFd(profile)));
 }
 
+TEST_F(ProfileCompilationInfoTest, InlineCacheWeights) {
+  ScratchFile profile;
+
+  auto create_info = [&](uint16_t weight0, uint16_t weight1, ProfileCompilationInfo* info) {
+    ProfileCompilationInfo::InlineCacheMap* ic_map = CreateInlineCacheMap();
+    ProfileCompilationInfo::OfflineProfileMethodInfo pmi(ic_map);
+    pmi.dex_references.emplace_back("dex_location1", /* checksum */ 1, kMaxMethodIds);
+    pmi.dex_references.emplace_back("dex_location2", /* checksum */ 2, kMaxMethodIds);
+    ProfileCompilationInfo::DexPcData dex_pc_data(allocator_.get());
+    dex_pc_data.AddClass(0, dex::TypeIndex(0));
+    dex_pc_data.AddClass(1, dex::TypeIndex(1));
+    dex_pc_data.AddWeight(0, dex::TypeIndex(0), weight0);
+    dex_pc_data.AddWeight(1, dex::TypeIndex(1), weight1);
+    // Weights of classes which are not in the inline cache are ignored.
+    dex_pc_data.AddWeight(0, dex::TypeIndex(2), 42u);
+    ic_map->Put(/* dex_pc */ 0, dex_pc_data);
+    return AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ 0, pmi, info);
+  };
+
+  ProfileCompilationInfo saved_info;
+  ASSERT_TRUE(create_info(10u, 3u, &saved_info));
+  ASSERT_TRUE(saved_info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+
+  // Check that the weights are saved.
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile)));
+  ASSERT_TRUE(loaded_info.Equals(saved_info));
+
+  // Merging keeps the largest weight of each class.
+  ProfileCompilationInfo other_info;
+  ASSERT_TRUE(create_info(5u, 7u, &other_info));
+  ASSERT_TRUE(loaded_info.MergeWith(other_info));
+  std::unique_ptr<ProfileCompilationInfo::OfflineProfileMethodInfo> loaded_pmi =
+      loaded_info.GetMethod("dex_location1", /* checksum */ 1, /* method_idx */ 0);
+  ASSERT_TRUE(loaded_pmi != nullptr);
+  const ProfileCompilationInfo::DexPcData& dex_pc_data = loaded_pmi->inline_caches->Get(0);
+  EXPECT_EQ(2u, dex_pc_data.weights.size());
+  EXPECT_EQ(10u, dex_pc_data.GetWeight(
+      ProfileCompilationInfo::ClassReference(0, dex::TypeIndex(0))));
+  EXPECT_EQ(7u, dex_pc_data.GetWeight(
+      ProfileCompilationInfo::ClassReference(1, dex::TypeIndex(1))));
+}
+
+TEST_F(ProfileCompilationInfoTest, BranchCaches) {
+  ScratchFile profile;
+
+  auto create_info = [&](uint16_t taken, uint16_t not_taken, ProfileCompilationInfo* info) {
+    ProfileCompilationInfo::BranchCacheMap branch_map(std::less<uint16_t>(),
+                                                      allocator_->Adapter(kArenaAllocProfile));
+    branch_map.Put(/* dex_pc */ 3, ProfileCompilationInfo::BranchCounts(taken, not_taken));
+    branch_map.Put(/* dex_pc */ 7, ProfileCompilationInfo::BranchCounts(1u, 0u));
+    ProfileCompilationInfo::OfflineProfileMethodInfo pmi(CreateInlineCacheMap(), &branch_map);
+    pmi.dex_references.emplace_back("dex_location1", /* checksum */ 1, kMaxMethodIds);
+    return AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ 0, pmi, info);
+  };
+
+  ProfileCompilationInfo saved_info;
+  ASSERT_TRUE(create_info(100u, 3u, &saved_info));
+  ASSERT_TRUE(saved_info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+
+  // Check that the branch counts are saved.
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile)));
+  ASSERT_TRUE(loaded_info.Equals(saved_info));
+
+  // Merging keeps the largest count of each direction.
+  ProfileCompilationInfo other_info;
+  ASSERT_TRUE(create_info(50u, 9u, &other_info));
+  ASSERT_TRUE(loaded_info.MergeWith(other_info));
+  std::unique_ptr<ProfileCompilationInfo::OfflineProfileMethodInfo> loaded_pmi =
+      loaded_info.GetMethod("dex_location1", /* checksum */ 1, /* method_idx */ 0);
+  ASSERT_TRUE(loaded_pmi != nullptr);
+  ASSERT_TRUE(loaded_pmi->branch_caches != nullptr);
+  EXPECT_EQ(2u, loaded_pmi->branch_caches->size());
+  EXPECT_TRUE(loaded_pmi->branch_caches->Get(3) == ProfileCompilationInfo::BranchCounts(100u, 9u));
+  EXPECT_TRUE(loaded_pmi->branch_caches->Get(7) == ProfileCompilationInfo::BranchCounts(1u, 0u));
+}
+
 TEST_F(ProfileCompilationInfoTest, MissingTypesInlineCachesMerge) {
   // Create an inline cache with missing types
   ProfileCompilationInfo::InlineCacheMap* ic_map = CreateInlineCacheMap();
@@ -934,4 +1016,90 @@ TEST_F(ProfileCompilationInfoTest, SampledMethodsTest) {
   }
 }
 
+TEST_F(ProfileCompilationInfoTest, HotMethodsWithoutInlineCaches) {
+  ScratchFile profile;
+
+  // Method 1 has an inline cache, methods 0 and 2 don't.
+  ProfileCompilationInfo::InlineCacheMap* ic_map = CreateInlineCacheMap();
+  ProfileCompilationInfo::DexPcData dex_pc_data(allocator_.get());
+  dex_pc_data.SetIsMegamorphic();
+  ic_map->Put(/*dex_pc*/ 3, dex_pc_data);
+  ProfileCompilationInfo::OfflineProfileMethodInfo pmi(ic_map);
+  pmi.dex_references.emplace_back("dex_location1", /* checksum */ 1, kMaxMethodIds);
+  ProfileCompilationInfo::OfflineProfileMethodInfo empty_pmi(CreateInlineCacheMap());
+  empty_pmi.dex_references.emplace_back("dex_location1", /* checksum */ 1, kMaxMethodIds);
+
+  ProfileCompilationInfo saved_info;
+  ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ 0, &saved_info));
+  ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ 1, pmi, &saved_info));
+  ASSERT_TRUE(
+      AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ 2, empty_pmi, &saved_info));
+  ASSERT_EQ(3u, saved_info.GetNumberOfMethods());
+  ASSERT_TRUE(saved_info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile)));
+  ASSERT_TRUE(loaded_info.Equals(saved_info));
+  ASSERT_EQ(3u, loaded_info.GetNumberOfMethods());
+  for (uint16_t method_idx = 0; method_idx < 3u; ++method_idx) {
+    std::unique_ptr<ProfileCompilationInfo::OfflineProfileMethodInfo> loaded_pmi =
+        loaded_info.GetMethod("dex_location1", /* checksum */ 1, method_idx);
+    ASSERT_TRUE(loaded_pmi != nullptr);
+    ASSERT_TRUE(loaded_pmi->inline_caches != nullptr);
+    EXPECT_EQ((method_idx == 1u) ? 1u : 0u, loaded_pmi->inline_caches->size());
+  }
+  EXPECT_FALSE(loaded_info.GetMethodHotness("dex_location1", /* checksum */ 1, 3).IsHot());
+
+  // Merging keeps the hot methods of both profiles and the inline caches of the other one.
+  ProfileCompilationInfo other_info;
+  ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ 0, pmi, &other_info));
+  ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ 4, &other_info));
+  ASSERT_TRUE(loaded_info.MergeWith(other_info));
+  EXPECT_EQ(4u, loaded_info.GetNumberOfMethods());
+  EXPECT_TRUE(loaded_info.GetMethodHotness("dex_location1", /* checksum */ 1, 4).IsHot());
+  std::unique_ptr<ProfileCompilationInfo::OfflineProfileMethodInfo> merged_pmi =
+      loaded_info.GetMethod("dex_location1", /* checksum */ 1, /* method_idx */ 0);
+  ASSERT_TRUE(merged_pmi != nullptr);
+  EXPECT_EQ(1u, merged_pmi->inline_caches->size());
+}
+
+TEST_F(ProfileCompilationInfoTest, LoadWithFilter) {
+  ScratchFile profile;
+
+  // The inline cache of method 0 of the first dex file refers to a class of the second one.
+  ProfileCompilationInfo::InlineCacheMap* ic_map = CreateInlineCacheMap();
+  ProfileCompilationInfo::DexPcData dex_pc_data(allocator_.get());
+  dex_pc_data.AddClass(/* dex_profile_idx */ 1, dex::TypeIndex(5));
+  ic_map->Put(/*dex_pc*/ 3, dex_pc_data);
+  ProfileCompilationInfo::OfflineProfileMethodInfo pmi(ic_map);
+  pmi.dex_references.emplace_back("dex_location1", /* checksum */ 1, kMaxMethodIds);
+  pmi.dex_references.emplace_back("dex_location2", /* checksum */ 2, kMaxMethodIds);
+
+  ProfileCompilationInfo saved_info;
+  ASSERT_TRUE(AddMethod("dex_location1", /* checksum */ 1, /* method_idx */ 0, pmi, &saved_info));
+  ASSERT_TRUE(AddMethod("dex_location2", /* checksum */ 2, /* method_idx */ 1, &saved_info));
+  ASSERT_TRUE(AddClass("dex_location2", /* checksum */ 2, dex::TypeIndex(7), &saved_info));
+  ASSERT_TRUE(saved_info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(profile.GetFile()->ResetOffset());
+  auto filter_fn = [](const std::string& dex_location, uint32_t checksum ATTRIBUTE_UNUSED) {
+    return dex_location == "dex_location1";
+  };
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile), /* merge_classes */ true, filter_fn));
+
+  // Only the data of the first dex file is loaded.
+  EXPECT_EQ(1u, loaded_info.GetNumberOfMethods());
+  EXPECT_EQ(0u, loaded_info.GetNumberOfResolvedClasses());
+  EXPECT_FALSE(loaded_info.GetMethodHotness("dex_location2", /* checksum */ 2, 1).IsInProfile());
+  std::unique_ptr<ProfileCompilationInfo::OfflineProfileMethodInfo> loaded_pmi =
+      loaded_info.GetMethod("dex_location1", /* checksum */ 1, /* method_idx */ 0);
+  ASSERT_TRUE(loaded_pmi != nullptr);
+  // The inline cache still refers to the second dex file.
+  ASSERT_TRUE(*loaded_pmi == pmi);
+}
+
 }  // namespace art
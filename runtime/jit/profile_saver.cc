@@ -283,14 +283,21 @@ using TypeReferenceCollection = DexReferenceCollection<dex::TypeIndex,
 // resolved_classes out argument if startup is true.
 // Add methods to the hot_methods out argument if the number of samples is greater or equal to
 // hot_method_sample_threshold, add it to sampled_methods if it has at least one sample.
+// After startup, the classes in fully_hot_classes are skipped, and the classes of the
+// tracked_locations with only hot methods are added to it: their methods are final in the
+// profile, as hot post startup.
 static void SampleClassesAndExecutedMethods(pthread_t profiler_pthread,
                                             bool profile_boot_class_path,
                                             ScopedArenaAllocator* allocator,
                                             uint32_t hot_method_sample_threshold,
                                             bool startup,
+                                            const std::set<std::string>& tracked_locations,
                                             TypeReferenceCollection* resolved_classes,
                                             MethodReferenceCollection* hot_methods,
-                                            MethodReferenceCollection* sampled_methods) {
+                                            MethodReferenceCollection* sampled_methods,
+                                            /*inout*/ std::unordered_set<const DexFile::ClassDef*>*
+                                                fully_hot_classes,
+                                            /*out*/ size_t* number_of_skipped_classes) {
   Thread* const self = Thread::Current();
   ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
   // Restore profile saver thread priority during the GC critical section. This helps prevent
@@ -324,6 +331,19 @@ static void SampleClassesAndExecutedMethods(pthread_t profiler_pthread,
     class_linker->VisitClassLoaders(&class_loader_visitor);
   }
   ScopedArenaVector<ObjPtr<mirror::Class>> classes(allocator->Adapter());
+  // Whether each dex file is tracked, to avoid looking up its base location for each class.
+  ScopedArenaSafeMap<const DexFile*, bool> tracked_dex_files(
+      std::less<const DexFile*>(), allocator->Adapter());
+  auto is_tracked = [&](const DexFile* dex_file) {
+    auto it = tracked_dex_files.find(dex_file);
+    if (it == tracked_dex_files.end()) {
+      const std::string base_location = DexFileLoader::GetBaseLocation(dex_file->GetLocation());
+      bool tracked = tracked_locations.find(base_location) != tracked_locations.end();
+      it = tracked_dex_files.Put(dex_file, tracked);
+    }
+    return it->second;
+  };
+  *number_of_skipped_classes = 0u;
   for (Handle<mirror::ClassLoader> class_loader : class_loaders) {
     ClassTable* table = class_linker->ClassTableForClassLoader(class_loader.Get());
     if (table == nullptr) {
@@ -339,10 +359,18 @@ static void SampleClassesAndExecutedMethods(pthread_t profiler_pthread,
       table->Visit(get_classes_visitor);
     }
     for (ObjPtr<mirror::Class> klass : classes) {
+      const DexFile::ClassDef* class_def = klass->GetClassDef();
+      if (!startup &&
+          class_def != nullptr &&
+          fully_hot_classes->find(class_def) != fully_hot_classes->end()) {
+        ++*number_of_skipped_classes;
+        continue;
+      }
       if (startup) {
         // We only record classes for the startup case. This may change in the future.
         resolved_classes->AddReference(&klass->GetDexFile(), klass->GetDexTypeIndex());
       }
+      bool all_methods_hot = true;
       // Visit all of the methods in the class to see which ones were executed.
       for (ArtMethod& method : klass->GetMethods(kRuntimePointerSize)) {
         if (!method.IsNative()) {
@@ -354,14 +382,20 @@ static void SampleClassesAndExecutedMethods(pthread_t profiler_pthread,
               method.PreviouslyWarm() ||
               counter >= hot_method_sample_threshold) {
             hot_methods->AddReference(method.GetDexFile(), method.GetDexMethodIndex());
-          } else if (counter != 0) {
-            sampled_methods->AddReference(method.GetDexFile(), method.GetDexMethodIndex());
+          } else {
+            all_methods_hot = false;
+            if (counter != 0) {
+              sampled_methods->AddReference(method.GetDexFile(), method.GetDexMethodIndex());
+            }
           }
         } else {
           // We do not record native methods. Once we AOT-compile the app, all native
           // methods shall have their thunks compiled.
         }
       }
+      if (!startup && all_methods_hot && class_def != nullptr && is_tracked(&klass->GetDexFile())) {
+        fully_hot_classes->insert(class_def);
+      }
     }
     classes.clear();
   }
@@ -390,15 +424,34 @@ void ProfileSaver::FetchAndCacheResolvedClassesAndMethods(bool startup) {
   const uint32_t hot_method_sample_threshold = startup ?
       options_.GetHotStartupMethodSamples(is_low_ram) :
       std::numeric_limits<uint32_t>::max();
+  std::set<std::string> tracked_locations;
+  std::unordered_set<const DexFile::ClassDef*> fully_hot_classes;
+  {
+    MutexLock mu(self, *Locks::profiler_lock_);
+    for (const auto& it : tracked_dex_base_locations_) {
+      tracked_locations.insert(it.second.begin(), it.second.end());
+    }
+    fully_hot_classes.swap(fully_hot_classes_);
+  }
+  size_t number_of_skipped_classes;
   SampleClassesAndExecutedMethods(profiler_pthread,
                                   options_.GetProfileBootClassPath(),
                                   &allocator,
                                   hot_method_sample_threshold,
                                   startup,
+                                  tracked_locations,
                                   &resolved_classes,
                                   &hot_methods,
-                                  &sampled_methods);
+                                  &sampled_methods,
+                                  &fully_hot_classes,
+                                  &number_of_skipped_classes);
   MutexLock mu(self, *Locks::profiler_lock_);
+  if (fully_hot_classes_.empty()) {
+    fully_hot_classes_.swap(fully_hot_classes);
+  } else {
+    // Another sampling ran concurrently.
+    fully_hot_classes_.insert(fully_hot_classes.begin(), fully_hot_classes.end());
+  }
   uint64_t total_number_of_profile_entries_cached = 0;
   using Hotness = ProfileCompilationInfo::MethodHotness;
 
@@ -460,8 +513,8 @@ void ProfileSaver::FetchAndCacheResolvedClassesAndMethods(bool startup) {
       total_number_of_profile_entries_cached);
   VLOG(profiler) << "Profile saver recorded " << hot_methods.NumReferences() << " hot methods and "
                  << sampled_methods.NumReferences() << " sampled methods with threshold "
-                 << hot_method_sample_threshold << " in "
-                 << PrettyDuration(NanoTime() - start_time);
+                 << hot_method_sample_threshold << ", skipped " << number_of_skipped_classes
+                 << " fully hot classes, in " << PrettyDuration(NanoTime() - start_time);
 }
 
 bool ProfileSaver::ProcessProfilingInfo(bool force_save, /*out*/uint16_t* number_of_new_methods) {
@@ -17,7 +17,10 @@
 #ifndef ART_RUNTIME_JIT_PROFILE_SAVER_H_
 #define ART_RUNTIME_JIT_PROFILE_SAVER_H_
 
+#include <unordered_set>
+
 #include "base/mutex.h"
+#include "dex_file.h"
 #include "jit_code_cache.h"
 #include "method_reference.h"
 #include "profile_compilation_info.h"
@@ -133,6 +136,14 @@ class ProfileSaver {
   // to just a few hundreds entries in the ProfileCompilationInfo objects.
   SafeMap<std::string, ProfileCompilationInfo*> profile_cache_;
 
+  // The classes of the tracked dex files whose methods all were recorded as hot post startup,
+  // so that they can be skipped when sampling the methods. A sampling takes the set out while
+  // it visits the classes, which avoids holding the lock during the visit. The entries of
+  // unloaded dex files are not removed, at worst a later dex file mapped at the same address
+  // misses some samples.
+  std::unordered_set<const DexFile::ClassDef*> fully_hot_classes_
+      GUARDED_BY(Locks::profiler_lock_);
+
   // Save period condition support.
   Mutex wait_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   ConditionVariable period_condition_ GUARDED_BY(wait_lock_);
@@ -21,6 +21,7 @@
 
 #include "base/macros.h"
 #include "gc_root.h"
+#include "offsets.h"
 
 namespace art {
 
@@ -37,13 +38,28 @@ class Class;
 
 // Structure to store the classes seen at runtime for a specific instruction.
 // Once the classes_ array is full, we consider the INVOKE to be megamorphic.
+// The counts are updated without synchronization, and saturate. They are only used as
+// a hint of which receivers are the most frequent.
 class InlineCache {
  public:
   static constexpr uint8_t kIndividualCacheSize = 5;
 
+  // The number of receivers seen, whether or not the cache recorded their class.
+  uint32_t GetTotalCount() const {
+    uint32_t total = misses_;
+    for (uint16_t count : counts_) {
+      total += count;
+    }
+    return total;
+  }
+
  private:
   uint32_t dex_pc_;
   GcRoot<mirror::Class> classes_[kIndividualCacheSize];
+  // The number of times each receiver in classes_ was seen.
+  uint16_t counts_[kIndividualCacheSize];
+  // The number of times a receiver was not recorded because the cache was full.
+  uint16_t misses_;
 
   friend class jit::JitCodeCache;
   friend class ProfilingInfo;
@@ -51,6 +67,40 @@ class InlineCache {
   DISALLOW_COPY_AND_ASSIGN(InlineCache);
 };
 
+// Structure to store the number of times the branch of an IF instruction was taken
+// and not taken. The counts are updated without synchronization, and saturate.
+class BranchCache {
+ public:
+  uint32_t GetDexPc() const {
+    return dex_pc_;
+  }
+
+  // The number of times the IF jumped to its target.
+  uint16_t GetTakenCount() const {
+    return taken_;
+  }
+
+  // The number of times the IF fell through to the next instruction.
+  uint16_t GetNotTakenCount() const {
+    return not_taken_;
+  }
+
+  // Baseline code indexes the counters with the outcome of the branch: the taken count
+  // follows the not taken count.
+  static MemberOffset NotTakenCountOffset() {
+    return MemberOffset(OFFSETOF_MEMBER(BranchCache, not_taken_));
+  }
+
+ private:
+  uint32_t dex_pc_;
+  uint16_t not_taken_;
+  uint16_t taken_;
+
+  friend class ProfilingInfo;
+
+  DISALLOW_COPY_AND_ASSIGN(BranchCache);
+};
+
 /**
  * Profiling info for a method, created and filled by the interpreter once the
  * method is warm, and used by the compiler to drive optimizations.
@@ -62,8 +112,9 @@ class ProfilingInfo {
   static bool Create(Thread* self, ArtMethod* method, bool retry_allocation)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Add information from an executed INVOKE instruction to the profile.
-  void AddInvokeInfo(uint32_t dex_pc, mirror::Class* cls)
+  // Add information from an executed INVOKE instruction to the profile. `count` is the
+  // number of times the receiver was seen.
+  void AddInvokeInfo(uint32_t dex_pc, mirror::Class* cls, uint16_t count = 1)
       // Method should not be interruptible, as it manipulates the ProfilingInfo
       // which can be concurrently collected.
       REQUIRES(Roles::uninterruptible_)
@@ -77,6 +128,21 @@ class ProfilingInfo {
   InlineCache* GetInlineCache(uint32_t dex_pc)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  bool HasInlineCache(uint32_t dex_pc) const {
+    for (size_t i = 0; i < number_of_inline_caches_; ++i) {
+      if (cache_[i].dex_pc_ == dex_pc) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Return the branch counters of the IF instruction at `dex_pc`, or null if there is none.
+  BranchCache* GetBranchCache(uint32_t dex_pc);
+
+  // Record that the IF instruction at `dex_pc` was taken or not.
+  void AddBranchInfo(uint32_t dex_pc, bool taken);
+
   bool IsMethodBeingCompiled(bool osr) const {
     return osr
         ? is_osr_method_being_compiled_
@@ -99,12 +165,22 @@ class ProfilingInfo {
     return saved_entry_point_;
   }
 
+  void SetInstrumentedEntryPoint(const void* entry_point) {
+    instrumented_entry_point_ = entry_point;
+  }
+
+  const void* GetInstrumentedEntryPoint() const {
+    return instrumented_entry_point_;
+  }
+
   void ClearGcRootsInInlineCaches() {
     for (size_t i = 0; i < number_of_inline_caches_; ++i) {
       InlineCache* cache = &cache_[i];
       memset(&cache->classes_[0],
              0,
              InlineCache::kIndividualCacheSize * sizeof(GcRoot<mirror::Class>));
+      memset(&cache->counts_[0], 0, InlineCache::kIndividualCacheSize * sizeof(uint16_t));
+      cache->misses_ = 0u;
     }
   }
 
@@ -129,12 +205,40 @@ class ProfilingInfo {
         (current_inline_uses_ > 0);
   }
 
+  // Baseline JIT code increments the count on each invocation, and asks for an optimized
+  // compilation when it wraps around to zero.
+  void SetBaselineHotnessCount(uint16_t count) {
+    baseline_hotness_count_ = count;
+  }
+
+  uint16_t GetBaselineHotnessCount() const {
+    return baseline_hotness_count_;
+  }
+
+  static MemberOffset BaselineHotnessCountOffset() {
+    return MemberOffset(OFFSETOF_MEMBER(ProfilingInfo, baseline_hotness_count_));
+  }
+
  private:
-  ProfilingInfo(ArtMethod* method, const std::vector<uint32_t>& entries);
+  ProfilingInfo(ArtMethod* method,
+                const std::vector<uint32_t>& entries,
+                const std::vector<uint32_t>& branch_entries);
+
+  // The branch caches are stored after the inline caches.
+  BranchCache* GetBranchCaches() {
+    return reinterpret_cast<BranchCache*>(&cache_[number_of_inline_caches_]);
+  }
+
+  const BranchCache* GetBranchCaches() const {
+    return reinterpret_cast<const BranchCache*>(&cache_[number_of_inline_caches_]);
+  }
 
   // Number of instructions we are profiling in the ArtMethod.
   const uint32_t number_of_inline_caches_;
 
+  // Number of IF instructions we are profiling in the ArtMethod.
+  const uint32_t number_of_branch_caches_;
+
   // Method this profiling info is for.
   // Not 'const' as JVMTI introduces obsolete methods that we implement by creating new ArtMethods.
   // See JitCodeCache::MoveObsoleteMethod.
@@ -150,11 +254,20 @@ class ProfilingInfo {
   // it updates this counter so that the GC does not try to clear the inline caches.
   uint16_t current_inline_uses_;
 
+  // Updated by the baseline compiled code of the method, which embeds the address of this
+  // ProfilingInfo.
+  uint16_t baseline_hotness_count_;
+
   // Entry point of the corresponding ArtMethod, while the JIT code cache
   // is poking for the liveness of compiled code.
   const void* saved_entry_point_;
 
-  // Dynamically allocated array of size `number_of_inline_caches_`.
+  // Compiled code of the corresponding ArtMethod, while the instrumentation entry
+  // stub is its entry point and calls this code instead of the interpreter.
+  const void* instrumented_entry_point_;
+
+  // Dynamically allocated array of size `number_of_inline_caches_`, followed by
+  // `number_of_branch_caches_` BranchCache entries sorted by dex pc.
   InlineCache cache_[0];
 
   friend class jit::JitCodeCache;
@@ -19,14 +19,19 @@
 
 #include "jni_env_ext.h"
 
+#include "indirect_reference_table-inl.h"
 #include "mirror/object.h"
 
 namespace art {
 
 template<typename T>
 inline T JNIEnvExt::AddLocalReference(ObjPtr<mirror::Object> obj) {
+  IndirectRef ref = locals_.TryAddFast(local_ref_cookie_, obj);
+  if (LIKELY(ref != nullptr)) {
+    return reinterpret_cast<T>(ref);
+  }
   std::string error_msg;
-  IndirectRef ref = locals_.Add(local_ref_cookie_, obj, &error_msg);
+  ref = locals_.Add(local_ref_cookie_, obj, &error_msg);
   if (UNLIKELY(ref == nullptr)) {
     // This is really unexpected if we allow resizing local IRTs...
     LOG(FATAL) << error_msg;
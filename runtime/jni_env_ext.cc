@@ -25,6 +25,7 @@
 #include "check_jni.h"
 #include "indirect_reference_table.h"
 #include "java_vm_ext.h"
+#include "jni_env_ext-inl.h"
 #include "jni_internal.h"
 #include "lock_word.h"
 #include "mirror/object-inl.h"
@@ -98,14 +99,7 @@ jobject JNIEnvExt::NewLocalRef(mirror::Object* obj) {
   if (obj == nullptr) {
     return nullptr;
   }
-  std::string error_msg;
-  jobject ref = reinterpret_cast<jobject>(locals_.Add(local_ref_cookie_, obj, &error_msg));
-  if (UNLIKELY(ref == nullptr)) {
-    // This is really unexpected if we allow resizing local IRTs...
-    LOG(FATAL) << error_msg;
-    UNREACHABLE();
-  }
-  return ref;
+  return AddLocalReference<jobject>(obj);
 }
 
 void JNIEnvExt::DeleteLocalRef(jobject obj) {
@@ -193,6 +193,35 @@ static inline bool DecodeSignedLeb128Checked(const uint8_t** data,
   return true;
 }
 
+// Reads `count` consecutive unsigned LEB128 values into `out`, updating the given pointer
+// to point just past the end of the last read value. Most values in dex and stack map data
+// fit in a single byte, so those are stored without entering the multi-byte decoder.
+static inline void DecodeUnsignedLeb128s(const uint8_t** data, uint32_t* out, size_t count) {
+  const uint8_t* ptr = *data;
+  for (size_t i = 0; i != count; ++i) {
+    uint32_t value = *ptr;
+    if (LIKELY(value <= 0x7f)) {
+      out[i] = value;
+      ++ptr;
+    } else {
+      out[i] = DecodeUnsignedLeb128(&ptr);
+    }
+  }
+  *data = ptr;
+}
+
+// Skips `count` consecutive LEB128 values, signed or unsigned, updating the given pointer
+// to point just past the end of the last skipped value. Every value ends with the only one
+// of its bytes that has the high bit clear, so this only counts terminating bytes and does
+// not branch on the encoded length.
+static inline void SkipLeb128s(const uint8_t** data, size_t count) {
+  const uint8_t* ptr = *data;
+  while (count != 0u) {
+    count -= static_cast<size_t>(*ptr++ <= 0x7f);
+  }
+  *data = ptr;
+}
+
 // Returns the number of bytes needed to encode the value in unsigned LEB128.
 static inline uint32_t UnsignedLeb128Size(uint32_t data) {
   // bits_to_encode = (data != 0) ? 32 - CLZ(x) : 1  // 32 - CLZ(data | 1)
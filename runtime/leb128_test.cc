@@ -173,6 +173,39 @@ TEST(Leb128Test, UnsignedStream) {
   EXPECT_EQ(data_size, static_cast<size_t>(encoded_data_ptr - encoded_data));
 }
 
+TEST(Leb128Test, UnsignedBulkAndSkip) {
+  // Encode all test values, interleaving them with single byte values.
+  uint8_t encoded_data[6 * arraysize(uleb128_tests) + 5 * arraysize(sleb128_tests)];
+  uint8_t* end = encoded_data;
+  for (size_t i = 0; i < arraysize(uleb128_tests); ++i) {
+    end = EncodeUnsignedLeb128(end, uleb128_tests[i].decoded);
+    end = EncodeUnsignedLeb128(end, static_cast<uint32_t>(i & 0x7f));
+  }
+  uint8_t* unsigned_end = end;
+  for (size_t i = 0; i < arraysize(sleb128_tests); ++i) {
+    end = EncodeSignedLeb128(end, sleb128_tests[i].decoded);
+  }
+  uint32_t decoded[2 * arraysize(uleb128_tests)];
+  const uint8_t* encoded_data_ptr = encoded_data;
+  DecodeUnsignedLeb128s(&encoded_data_ptr, decoded, arraysize(decoded));
+  EXPECT_EQ(unsigned_end, encoded_data_ptr);
+  for (size_t i = 0; i < arraysize(uleb128_tests); ++i) {
+    EXPECT_EQ(uleb128_tests[i].decoded, decoded[2 * i]) << " i = " << i;
+    EXPECT_EQ(static_cast<uint32_t>(i & 0x7f), decoded[2 * i + 1]) << " i = " << i;
+  }
+  // Skip all values from the start, then only the signed values.
+  encoded_data_ptr = encoded_data;
+  SkipLeb128s(&encoded_data_ptr, arraysize(decoded) + arraysize(sleb128_tests));
+  EXPECT_EQ(end, encoded_data_ptr);
+  encoded_data_ptr = unsigned_end;
+  SkipLeb128s(&encoded_data_ptr, arraysize(sleb128_tests));
+  EXPECT_EQ(end, encoded_data_ptr);
+  // Zero-length operations do not move the pointer.
+  DecodeUnsignedLeb128s(&encoded_data_ptr, decoded, 0u);
+  SkipLeb128s(&encoded_data_ptr, 0u);
+  EXPECT_EQ(end, encoded_data_ptr);
+}
+
 TEST(Leb128Test, SignedSinglesVector) {
   // Test individual encodings.
   for (size_t i = 0; i < arraysize(sleb128_tests); ++i) {
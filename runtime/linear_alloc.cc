@@ -16,6 +16,8 @@
 
 #include "linear_alloc.h"
 
+#include <string.h>
+
 #include "thread-current-inl.h"
 
 namespace art {
@@ -30,9 +32,19 @@ void* LinearAlloc::Realloc(Thread* self, void* ptr, size_t old_size, size_t new_
 
 void* LinearAlloc::Alloc(Thread* self, size_t size) {
   MutexLock mu(self, lock_);
+  void* block = allocator_.AllocFreed(size);
+  if (block != nullptr) {
+    memset(block, 0, size);
+    return block;
+  }
   return allocator_.Alloc(size);
 }
 
+void LinearAlloc::Free(Thread* self, void* ptr, size_t size) {
+  MutexLock mu(self, lock_);
+  allocator_.Free(ptr, size);
+}
+
 void* LinearAlloc::AllocAlign16(Thread* self, size_t size) {
   MutexLock mu(self, lock_);
   return allocator_.AllocAlign16(size);
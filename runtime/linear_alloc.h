@@ -23,17 +23,22 @@ namespace art {
 
 class ArenaPool;
 
-// TODO: Support freeing if we add poor man's class unloading.
+// The allocator of the native data of the classes of a class loader, freed with the class loader.
 class LinearAlloc {
  public:
   explicit LinearAlloc(ArenaPool* pool);
 
+  // Returns zeroed memory, reusing the memory released with Free() when possible.
   void* Alloc(Thread* self, size_t size) REQUIRES(!lock_);
   void* AllocAlign16(Thread* self, size_t size) REQUIRES(!lock_);
 
   // Realloc never frees the input pointer, it is the caller's job to do this if necessary.
   void* Realloc(Thread* self, void* ptr, size_t old_size, size_t new_size) REQUIRES(!lock_);
 
+  // Releases the memory of an allocation nothing refers to anymore, such as the input of a
+  // Realloc() which moved it, for reuse by Alloc().
+  void Free(Thread* self, void* ptr, size_t size) REQUIRES(!lock_);
+
   // Allocate an array of structs of type T.
   template<class T>
   T* AllocArray(Thread* self, size_t elements) REQUIRES(!lock_) {
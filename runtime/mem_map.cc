@@ -23,9 +23,12 @@
 #include <sys/resource.h>
 #endif
 
+#include <atomic>
+#include <limits>
 #include <map>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include "android-base/stringprintf.h"
 #include "android-base/unique_fd.h"
@@ -58,6 +61,25 @@ using Maps = AllocationTrackingMultiMap<void*, MemMap*, kAllocatorTagMaps>;
 // All the non-empty MemMaps. Use a multimap as we do a reserve-and-divide (eg ElfMap::Load()).
 static Maps* gMaps GUARDED_BY(MemMap::GetMemMapsLock()) = nullptr;
 
+// A mapping kept for MapAnonymousRecyclable() after its MemMap was deleted. Its pages have
+// been released, so it holds only address space.
+struct RecycledMap {
+  std::string name;
+  void* begin;
+  size_t size;
+  int prot;
+};
+
+// The cached mappings, the most recently deleted last.
+static std::vector<RecycledMap>* gRecycledMaps GUARDED_BY(MemMap::GetMemMapsLock()) = nullptr;
+static size_t gRecycledMapsBytes GUARDED_BY(MemMap::GetMemMapsLock()) = 0u;
+
+// Bounds of the recycled map cache. Larger maps are rarely requested with the same size again
+// and are unmapped on deletion.
+static constexpr size_t kMaxRecycledMapSize = 2 * MB;
+static constexpr size_t kMaxRecycledMaps = 64u;
+static constexpr size_t kMaxRecycledMapsBytes = 32 * MB;
+
 static std::ostream& operator<<(
     std::ostream& os,
     std::pair<BacktraceMap::iterator, BacktraceMap::iterator> iters) {
@@ -86,6 +108,8 @@ std::ostream& operator<<(std::ostream& os, const Maps& mem_maps) {
 
 std::mutex* MemMap::mem_maps_lock_ = nullptr;
 
+bool MemMap::transparent_huge_pages_enabled_ = false;
+
 #if USE_ART_LOW_4G_ALLOCATOR
 // Handling mem_map in 32b address range for 64b architectures that do not support MAP_32BIT.
 
@@ -297,7 +321,8 @@ MemMap* MemMap::MapAnonymous(const char* name,
                              bool low_4gb,
                              bool reuse,
                              std::string* error_msg,
-                             bool use_ashmem) {
+                             bool use_ashmem,
+                             bool huge_pages) {
 #ifndef __LP64__
   UNUSED(low_4gb);
 #endif
@@ -306,6 +331,20 @@ MemMap* MemMap::MapAnonymous(const char* name,
     return new MemMap(name, nullptr, 0, nullptr, 0, prot, false);
   }
   size_t page_aligned_byte_count = RoundUp(byte_count, kPageSize);
+  const bool use_huge_pages = huge_pages && transparent_huge_pages_enabled_;
+  if (use_huge_pages) {
+    // Transparent huge pages only back private anonymous memory, not ashmem.
+    use_ashmem = false;
+  }
+  // Reserve extra space to trim the map to a huge page boundary, unless the caller asks for a
+  // given address. Otherwise the first and the last huge page of the map are more often partial
+  // and are left as small pages.
+  const bool align_to_huge_pages = use_huge_pages &&
+                                   expected_ptr == nullptr &&
+                                   page_aligned_byte_count >= kHugePageSize;
+  const size_t map_byte_count = align_to_huge_pages
+      ? page_aligned_byte_count + kHugePageSize - kPageSize
+      : page_aligned_byte_count;
 
   int flags = MAP_PRIVATE | MAP_ANONYMOUS;
   if (reuse) {
@@ -356,7 +395,7 @@ MemMap* MemMap::MapAnonymous(const char* name,
   int saved_errno = 0;
 
   void* actual = MapInternal(expected_ptr,
-                             page_aligned_byte_count,
+                             map_byte_count,
                              prot,
                              flags,
                              fd.get(),
@@ -381,11 +420,107 @@ MemMap* MemMap::MapAnonymous(const char* name,
     }
     return nullptr;
   }
+  if (align_to_huge_pages) {
+    // Unmap the parts before the first huge page boundary and after the requested size.
+    uint8_t* map_begin = reinterpret_cast<uint8_t*>(actual);
+    uint8_t* map_end = map_begin + map_byte_count;
+    uint8_t* aligned_begin = AlignUp(map_begin, kHugePageSize);
+    uint8_t* aligned_end = aligned_begin + page_aligned_byte_count;
+    DCHECK_LE(aligned_end, map_end);
+    if (map_begin < aligned_begin) {
+      CHECK_EQ(munmap(map_begin, aligned_begin - map_begin), 0);
+    }
+    if (aligned_end < map_end) {
+      CHECK_EQ(munmap(aligned_end, map_end - aligned_end), 0);
+    }
+    actual = aligned_begin;
+  }
   if (!CheckMapRequest(expected_ptr, actual, page_aligned_byte_count, error_msg)) {
     return nullptr;
   }
-  return new MemMap(name, reinterpret_cast<uint8_t*>(actual), byte_count, actual,
-                    page_aligned_byte_count, prot, reuse);
+  MemMap* mem_map = new MemMap(name, reinterpret_cast<uint8_t*>(actual), byte_count, actual,
+                               page_aligned_byte_count, prot, reuse);
+  if (use_huge_pages) {
+    mem_map->AdviseHugePages();
+  }
+  return mem_map;
+}
+
+MemMap* MemMap::MapAnonymousRecyclable(const char* name,
+                                       size_t byte_count,
+                                       int prot,
+                                       bool low_4gb,
+                                       std::string* error_msg) {
+  const size_t page_aligned_byte_count = RoundUp(byte_count, kPageSize);
+  // Recycling relies on madvise() to zero the released pages. Under a memory tool, unmap the
+  // maps on deletion so that stale accesses are caught.
+  const bool recyclable = kMadviseZeroes &&
+                          RUNNING_ON_MEMORY_TOOL == 0 &&
+                          byte_count != 0u &&
+                          page_aligned_byte_count <= kMaxRecycledMapSize;
+  MemMap* mem_map = nullptr;
+  if (recyclable) {
+    void* actual = TakeRecycledMap(name, page_aligned_byte_count, prot, low_4gb);
+    if (actual != nullptr) {
+      mem_map = new MemMap(name, reinterpret_cast<uint8_t*>(actual), byte_count, actual,
+                           page_aligned_byte_count, prot, false);
+    }
+  }
+  if (mem_map == nullptr) {
+    mem_map = MapAnonymous(name, nullptr, byte_count, prot, low_4gb, false, error_msg);
+    if (mem_map == nullptr) {
+      return nullptr;
+    }
+  }
+  mem_map->recyclable_ = recyclable;
+  return mem_map;
+}
+
+void* MemMap::TakeRecycledMap(const std::string& name, size_t size, int prot, bool low_4gb) {
+  std::lock_guard<std::mutex> mu(*mem_maps_lock_);
+  DCHECK(gRecycledMaps != nullptr);
+  const uint64_t limit = low_4gb ? UINT64_C(4) * GB : std::numeric_limits<uint64_t>::max();
+  // Prefer the most recently deleted mapping.
+  for (auto it = gRecycledMaps->rbegin(); it != gRecycledMaps->rend(); ++it) {
+    if (it->size == size &&
+        it->prot == prot &&
+        it->name == name &&
+        static_cast<uint64_t>(reinterpret_cast<uintptr_t>(it->begin)) + size <= limit) {
+      void* begin = it->begin;
+      gRecycledMapsBytes -= size;
+      gRecycledMaps->erase(std::next(it).base());
+      return begin;
+    }
+  }
+  return nullptr;
+}
+
+void MemMap::RecycleOrUnmap(const std::string& name, void* begin, size_t size, int prot) {
+  std::vector<RecycledMap> unmapped;
+  // Release the pages before the mapping can be taken by another thread, so that the next map
+  // reads as zero.
+  if (madvise(begin, size, MADV_DONTNEED) == 0) {
+    std::lock_guard<std::mutex> mu(*mem_maps_lock_);
+    DCHECK(gRecycledMaps != nullptr);
+    gRecycledMaps->push_back(RecycledMap {name, begin, size, prot});
+    gRecycledMapsBytes += size;
+    auto evicted_end = gRecycledMaps->begin();
+    while (static_cast<size_t>(gRecycledMaps->end() - evicted_end) > kMaxRecycledMaps ||
+           gRecycledMapsBytes > kMaxRecycledMapsBytes) {
+      gRecycledMapsBytes -= evicted_end->size;
+      ++evicted_end;
+    }
+    unmapped.assign(gRecycledMaps->begin(), evicted_end);
+    gRecycledMaps->erase(gRecycledMaps->begin(), evicted_end);
+  } else {
+    unmapped.push_back(RecycledMap {name, begin, size, prot});
+  }
+  // Unmap outside of mem_maps_lock_.
+  for (const RecycledMap& map : unmapped) {
+    if (munmap(map.begin, map.size) == -1) {
+      PLOG(FATAL) << "munmap failed";
+    }
+  }
 }
 
 MemMap* MemMap::MapDummy(const char* name, uint8_t* addr, size_t byte_count) {
@@ -499,9 +634,13 @@ MemMap::~MemMap() {
 
   if (!reuse_) {
     MEMORY_TOOL_MAKE_UNDEFINED(base_begin_, base_size_);
-    int result = munmap(base_begin_, base_size_);
-    if (result == -1) {
-      PLOG(FATAL) << "munmap failed";
+    if (recyclable_ && begin_ == base_begin_ && base_size_ == RoundUp(size_, kPageSize)) {
+      RecycleOrUnmap(name_, base_begin_, base_size_, prot_);
+    } else {
+      int result = munmap(base_begin_, base_size_);
+      if (result == -1) {
+        PLOG(FATAL) << "munmap failed";
+      }
     }
   }
 
@@ -523,7 +662,7 @@ MemMap::~MemMap() {
 MemMap::MemMap(const std::string& name, uint8_t* begin, size_t size, void* base_begin,
                size_t base_size, int prot, bool reuse, size_t redzone_size)
     : name_(name), begin_(begin), size_(size), base_begin_(base_begin), base_size_(base_size),
-      prot_(prot), reuse_(reuse), redzone_size_(redzone_size) {
+      prot_(prot), reuse_(reuse), redzone_size_(redzone_size), recyclable_(false) {
   if (size_ == 0) {
     CHECK(begin_ == nullptr);
     CHECK(base_begin_ == nullptr);
@@ -611,6 +750,18 @@ MemMap* MemMap::RemapAtEnd(uint8_t* new_end, const char* tail_name, int tail_pro
   return new MemMap(tail_name, actual, tail_size, actual, tail_base_size, tail_prot, false);
 }
 
+void MemMap::AdviseHugePages() {
+  if (!transparent_huge_pages_enabled_ || base_size_ == 0) {
+    return;
+  }
+#ifdef MADV_HUGEPAGE
+  // Not fatal, e.g. the kernel may be built without transparent huge pages.
+  if (madvise(base_begin_, base_size_, MADV_HUGEPAGE) != 0) {
+    PLOG(WARNING) << "madvise(MADV_HUGEPAGE) failed for '" << name_ << "'";
+  }
+#endif
+}
+
 void MemMap::MadviseDontNeedAndZero() {
   if (base_begin_ != nullptr || base_size_ != 0) {
     if (!kMadviseZeroes) {
@@ -775,6 +926,8 @@ void MemMap::Init() {
   std::lock_guard<std::mutex> mu(*mem_maps_lock_);
   DCHECK(gMaps == nullptr);
   gMaps = new Maps;
+  DCHECK(gRecycledMaps == nullptr);
+  gRecycledMaps = new std::vector<RecycledMap>();
 }
 
 void MemMap::Shutdown() {
@@ -788,6 +941,13 @@ void MemMap::Shutdown() {
     DCHECK(gMaps != nullptr);
     delete gMaps;
     gMaps = nullptr;
+    DCHECK(gRecycledMaps != nullptr);
+    for (const RecycledMap& map : *gRecycledMaps) {
+      munmap(map.begin, map.size);
+    }
+    delete gRecycledMaps;
+    gRecycledMaps = nullptr;
+    gRecycledMapsBytes = 0u;
   }
   delete mem_maps_lock_;
   mem_maps_lock_ = nullptr;
@@ -1021,6 +1181,23 @@ void ZeroAndReleasePages(void* address, size_t length) {
   }
 }
 
+void LazyReleasePages(void* address, size_t length) {
+  DCHECK_ALIGNED(address, kPageSize);
+  DCHECK_ALIGNED(length, kPageSize);
+#ifdef MADV_FREE
+  // Kernels before 4.5 and shared mappings such as ashmem reject MADV_FREE.
+  static std::atomic<bool> madv_free_unsupported(false);
+  if (!madv_free_unsupported.load(std::memory_order_relaxed)) {
+    if (madvise(address, length, MADV_FREE) == 0) {
+      return;
+    }
+    CHECK_EQ(errno, EINVAL) << "madvise failed";
+    madv_free_unsupported.store(true, std::memory_order_relaxed);
+  }
+#endif
+  CHECK_NE(madvise(address, length, MADV_DONTNEED), -1) << "madvise failed";
+}
+
 void MemMap::AlignBy(size_t size) {
   CHECK_EQ(begin_, base_begin_) << "Unsupported";
   CHECK_EQ(size_, base_size_) << "Unsupported";
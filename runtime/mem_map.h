@@ -60,6 +60,10 @@ class MemMap {
   // 'name' will be used -- on systems that support it -- to give the mapping
   // a name.
   //
+  // If "huge_pages" is true and transparent huge pages are enabled, see
+  // SetTransparentHugePagesEnabled(), the region is not backed by ashmem, starts at a
+  // kHugePageSize boundary unless an address is requested and is advised with MADV_HUGEPAGE.
+  //
   // On success, returns returns a MemMap instance.  On failure, returns null.
   static MemMap* MapAnonymous(const char* name,
                               uint8_t* addr,
@@ -68,7 +72,21 @@ class MemMap {
                               bool low_4gb,
                               bool reuse,
                               std::string* error_msg,
-                              bool use_ashmem = true);
+                              bool use_ashmem = true,
+                              bool huge_pages = false);
+
+  // Like MapAnonymous() without a requested address, but for short-lived maps that are
+  // created and deleted over and over with the same name, size and protection, such as
+  // indirect reference tables. Deleting such a map releases its pages but may keep the
+  // mapping in a small runtime-wide cache, and a later request with the same name, size and
+  // protection takes it from there instead of calling mmap. The memory of a recycled map
+  // reads as zero, like the memory of a new one. Users must not resize the map or change the
+  // protection of a part of it, and must not keep pointers into it past its deletion.
+  static MemMap* MapAnonymousRecyclable(const char* name,
+                                        size_t byte_count,
+                                        int prot,
+                                        bool low_4gb,
+                                        std::string* error_msg);
 
   // Create placeholder for a region allocated by direct call to mmap.
   // This is useful when we do not have control over the code calling mmap,
@@ -132,6 +150,9 @@ class MemMap {
 
   void MadviseDontNeedAndZero();
 
+  // Ask the kernel to back the map with transparent huge pages. No-op unless they are enabled.
+  void AdviseHugePages();
+
   int GetProtect() const {
     return prot_;
   }
@@ -185,6 +206,15 @@ class MemMap {
   static void Init() REQUIRES(!MemMap::mem_maps_lock_);
   static void Shutdown() REQUIRES(!MemMap::mem_maps_lock_);
 
+  // Whether the anonymous maps that ask for huge pages get them. Off by default, since huge pages
+  // may increase the memory footprint. Must be set before such maps are created.
+  static void SetTransparentHugePagesEnabled(bool enabled) {
+    transparent_huge_pages_enabled_ = enabled;
+  }
+  static bool TransparentHugePagesEnabled() {
+    return transparent_huge_pages_enabled_;
+  }
+
   // If the map is PROT_READ, try to read each page of the map to check it is in fact readable (not
   // faulting). This is used to diagnose a bug b/19894268 where mprotect doesn't seem to be working
   // intermittently.
@@ -226,6 +256,13 @@ class MemMap {
                            off_t offset,
                            bool low_4gb)
       REQUIRES(!MemMap::mem_maps_lock_);
+  // Take a cached mapping for MapAnonymousRecyclable(), or return null.
+  static void* TakeRecycledMap(const std::string& name, size_t size, int prot, bool low_4gb)
+      REQUIRES(!MemMap::mem_maps_lock_);
+  // Keep the mapping of a deleted recyclable map in the cache or unmap it.
+  static void RecycleOrUnmap(const std::string& name, void* begin, size_t size, int prot)
+      REQUIRES(!MemMap::mem_maps_lock_);
+
   static void* MapInternalArtLow4GBAllocator(size_t length,
                                              int prot,
                                              int flags,
@@ -248,12 +285,17 @@ class MemMap {
 
   const size_t redzone_size_;
 
+  // Whether the mapping may be cached for MapAnonymousRecyclable() when the map is deleted.
+  bool recyclable_;
+
 #if USE_ART_LOW_4G_ALLOCATOR
   static uintptr_t next_mem_pos_;   // Next memory location to check for low_4g extent.
 #endif
 
   static std::mutex* mem_maps_lock_;
 
+  static bool transparent_huge_pages_enabled_;
+
   friend class MemMapTest;  // To allow access to base_begin_ and base_size_.
 };
 
@@ -262,6 +304,11 @@ std::ostream& operator<<(std::ostream& os, const MemMap& mem_map);
 // Zero and release pages if possible, no requirements on alignments.
 void ZeroAndReleasePages(void* address, size_t length);
 
+// Release page aligned pages with MADV_FREE if the kernel supports it, MADV_DONTNEED otherwise.
+// The kernel only drops MADV_FREE pages when it needs the memory, which is cheaper for both
+// the release and a later reuse, but the pages may keep their content until then.
+void LazyReleasePages(void* address, size_t length);
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_MEM_MAP_H_
@@ -367,6 +367,73 @@ TEST_F(MemMapTest, MapAnonymousReuse) {
   ASSERT_TRUE(error_msg.empty());
 }
 
+TEST_F(MemMapTest, MapAnonymousHugePages) {
+  CommonInit();
+  MemMap::SetTransparentHugePagesEnabled(true);
+  std::string error_msg;
+  const size_t size = 4 * kHugePageSize + 3 * kPageSize;
+  std::unique_ptr<MemMap> map(MemMap::MapAnonymous("MapAnonymousHugePages",
+                                                   nullptr,
+                                                   size,
+                                                   PROT_READ | PROT_WRITE,
+                                                   false,
+                                                   false,
+                                                   &error_msg,
+                                                   /* use_ashmem */ true,
+                                                   /* huge_pages */ true));
+  MemMap::SetTransparentHugePagesEnabled(false);
+  ASSERT_NE(nullptr, map.get()) << error_msg;
+  ASSERT_TRUE(error_msg.empty());
+  EXPECT_TRUE(IsAlignedParam(map->Begin(), kHugePageSize));
+  EXPECT_EQ(size, map->Size());
+  EXPECT_EQ(size, map->BaseSize());
+  memset(map->Begin(), 0xcd, map->Size());
+}
+
+TEST_F(MemMapTest, MapAnonymousRecyclable) {
+  CommonInit();
+  std::string error_msg;
+  const size_t size = 3 * kPageSize;
+  std::unique_ptr<MemMap> map(MemMap::MapAnonymousRecyclable("MapAnonymousRecyclable",
+                                                             size,
+                                                             PROT_READ | PROT_WRITE,
+                                                             /* low_4gb */ false,
+                                                             &error_msg));
+  ASSERT_NE(nullptr, map.get()) << error_msg;
+  ASSERT_TRUE(error_msg.empty());
+  uint8_t* const begin = map->Begin();
+  memset(begin, 0xcd, size);
+  map.reset();
+  // A map of another size or name does not take the released mapping.
+  std::unique_ptr<MemMap> other(MemMap::MapAnonymousRecyclable("MapAnonymousRecyclable",
+                                                               2 * kPageSize,
+                                                               PROT_READ | PROT_WRITE,
+                                                               /* low_4gb */ false,
+                                                               &error_msg));
+  ASSERT_NE(nullptr, other.get()) << error_msg;
+  EXPECT_NE(begin, other->Begin());
+  std::unique_ptr<MemMap> other_name(MemMap::MapAnonymousRecyclable("MapAnonymousOther",
+                                                                    size,
+                                                                    PROT_READ | PROT_WRITE,
+                                                                    /* low_4gb */ false,
+                                                                    &error_msg));
+  ASSERT_NE(nullptr, other_name.get()) << error_msg;
+  EXPECT_NE(begin, other_name->Begin());
+  map.reset(MemMap::MapAnonymousRecyclable("MapAnonymousRecyclable",
+                                           size,
+                                           PROT_READ | PROT_WRITE,
+                                           /* low_4gb */ false,
+                                           &error_msg));
+  ASSERT_NE(nullptr, map.get()) << error_msg;
+  if (kMadviseZeroes && RUNNING_ON_MEMORY_TOOL == 0) {
+    EXPECT_EQ(begin, map->Begin());
+  }
+  EXPECT_EQ(size, map->Size());
+  for (size_t i = 0; i < size; ++i) {
+    ASSERT_EQ(0u, map->Begin()[i]) << i;
+  }
+}
+
 TEST_F(MemMapTest, CheckNoGaps) {
   CommonInit();
   std::string error_msg;
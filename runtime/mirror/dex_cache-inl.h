@@ -54,9 +54,16 @@ inline uint32_t DexCache::ClassSize(PointerSize pointer_size) {
   return Class::ComputeClassSize(true, vtable_entries, 0, 0, 0, 0, 0, pointer_size);
 }
 
+inline void DexCache::RecordStore(CacheKind kind, bool evicts) {
+  num_stores_[kind].FetchAndAddRelaxed(1u);
+  if (evicts) {
+    num_evictions_[kind].FetchAndAddRelaxed(1u);
+  }
+}
+
 inline uint32_t DexCache::StringSlotIndex(dex::StringIndex string_idx) {
   DCHECK_LT(string_idx.index_, GetDexFile()->NumStringIds());
-  const uint32_t slot_idx = string_idx.index_ % kDexCacheStringCacheSize;
+  const uint32_t slot_idx = SlotIndex(string_idx.index_, NumStrings());
   DCHECK_LT(slot_idx, NumStrings());
   return slot_idx;
 }
@@ -68,8 +75,10 @@ inline String* DexCache::GetResolvedString(dex::StringIndex string_idx) {
 
 inline void DexCache::SetResolvedString(dex::StringIndex string_idx, ObjPtr<String> resolved) {
   DCHECK(resolved != nullptr);
-  GetStrings()[StringSlotIndex(string_idx)].store(
-      StringDexCachePair(resolved, string_idx.index_), std::memory_order_relaxed);
+  StringDexCacheType* slot = &GetStrings()[StringSlotIndex(string_idx)];
+  StringDexCachePair old_pair = slot->load(std::memory_order_relaxed);
+  RecordStore(kStringCache, !old_pair.object.IsNull() && old_pair.index != string_idx.index_);
+  slot->store(StringDexCachePair(resolved, string_idx.index_), std::memory_order_relaxed);
   Runtime* const runtime = Runtime::Current();
   if (UNLIKELY(runtime->IsActiveTransaction())) {
     DCHECK(runtime->IsAotCompiler());
@@ -92,7 +101,7 @@ inline void DexCache::ClearString(dex::StringIndex string_idx) {
 
 inline uint32_t DexCache::TypeSlotIndex(dex::TypeIndex type_idx) {
   DCHECK_LT(type_idx.index_, GetDexFile()->NumTypeIds());
-  const uint32_t slot_idx = type_idx.index_ % kDexCacheTypeCacheSize;
+  const uint32_t slot_idx = SlotIndex(type_idx.index_, NumResolvedTypes());
   DCHECK_LT(slot_idx, NumResolvedTypes());
   return slot_idx;
 }
@@ -110,8 +119,10 @@ inline void DexCache::SetResolvedType(dex::TypeIndex type_idx, ObjPtr<Class> res
   // Use a release store for SetResolvedType. This is done to prevent other threads from seeing a
   // class but not necessarily seeing the loaded members like the static fields array.
   // See b/32075261.
-  GetResolvedTypes()[TypeSlotIndex(type_idx)].store(
-      TypeDexCachePair(resolved, type_idx.index_), std::memory_order_release);
+  TypeDexCacheType* slot = &GetResolvedTypes()[TypeSlotIndex(type_idx)];
+  TypeDexCachePair old_pair = slot->load(std::memory_order_relaxed);
+  RecordStore(kTypeCache, !old_pair.object.IsNull() && old_pair.index != type_idx.index_);
+  slot->store(TypeDexCachePair(resolved, type_idx.index_), std::memory_order_release);
   // TODO: Fine-grained marking, so that we don't need to go through all arrays in full.
   Runtime::Current()->GetHeap()->WriteBarrierEveryFieldOf(this);
 }
@@ -130,7 +141,7 @@ inline void DexCache::ClearResolvedType(dex::TypeIndex type_idx) {
 inline uint32_t DexCache::MethodTypeSlotIndex(uint32_t proto_idx) {
   DCHECK(Runtime::Current()->IsMethodHandlesEnabled());
   DCHECK_LT(proto_idx, GetDexFile()->NumProtoIds());
-  const uint32_t slot_idx = proto_idx % kDexCacheMethodTypeCacheSize;
+  const uint32_t slot_idx = SlotIndex(proto_idx, NumResolvedMethodTypes());
   DCHECK_LT(slot_idx, NumResolvedMethodTypes());
   return slot_idx;
 }
@@ -142,8 +153,10 @@ inline MethodType* DexCache::GetResolvedMethodType(uint32_t proto_idx) {
 
 inline void DexCache::SetResolvedMethodType(uint32_t proto_idx, MethodType* resolved) {
   DCHECK(resolved != nullptr);
-  GetResolvedMethodTypes()[MethodTypeSlotIndex(proto_idx)].store(
-      MethodTypeDexCachePair(resolved, proto_idx), std::memory_order_relaxed);
+  MethodTypeDexCacheType* slot = &GetResolvedMethodTypes()[MethodTypeSlotIndex(proto_idx)];
+  MethodTypeDexCachePair old_pair = slot->load(std::memory_order_relaxed);
+  RecordStore(kMethodTypeCache, !old_pair.object.IsNull() && old_pair.index != proto_idx);
+  slot->store(MethodTypeDexCachePair(resolved, proto_idx), std::memory_order_relaxed);
   // TODO: Fine-grained marking, so that we don't need to go through all arrays in full.
   Runtime::Current()->GetHeap()->WriteBarrierEveryFieldOf(this);
 }
@@ -179,7 +192,7 @@ inline CallSite* DexCache::SetResolvedCallSite(uint32_t call_site_idx, CallSite*
 
 inline uint32_t DexCache::FieldSlotIndex(uint32_t field_idx) {
   DCHECK_LT(field_idx, GetDexFile()->NumFieldIds());
-  const uint32_t slot_idx = field_idx % kDexCacheFieldCacheSize;
+  const uint32_t slot_idx = SlotIndex(field_idx, NumResolvedFields());
   DCHECK_LT(slot_idx, NumResolvedFields());
   return slot_idx;
 }
@@ -193,8 +206,11 @@ inline ArtField* DexCache::GetResolvedField(uint32_t field_idx, PointerSize ptr_
 inline void DexCache::SetResolvedField(uint32_t field_idx, ArtField* field, PointerSize ptr_size) {
   DCHECK_EQ(Runtime::Current()->GetClassLinker()->GetImagePointerSize(), ptr_size);
   DCHECK(field != nullptr);
+  uint32_t slot_idx = FieldSlotIndex(field_idx);
+  FieldDexCachePair old_pair = GetNativePairPtrSize(GetResolvedFields(), slot_idx, ptr_size);
+  RecordStore(kFieldCache, old_pair.object != nullptr && old_pair.index != field_idx);
   FieldDexCachePair pair(field, field_idx);
-  SetNativePairPtrSize(GetResolvedFields(), FieldSlotIndex(field_idx), pair, ptr_size);
+  SetNativePairPtrSize(GetResolvedFields(), slot_idx, pair, ptr_size);
 }
 
 inline void DexCache::ClearResolvedField(uint32_t field_idx, PointerSize ptr_size) {
@@ -227,8 +243,11 @@ inline void DexCache::SetResolvedMethod(uint32_t method_idx,
                                         PointerSize ptr_size) {
   DCHECK_EQ(Runtime::Current()->GetClassLinker()->GetImagePointerSize(), ptr_size);
   DCHECK(method != nullptr);
+  uint32_t slot_idx = MethodSlotIndex(method_idx);
+  MethodDexCachePair old_pair = GetNativePairPtrSize(GetResolvedMethods(), slot_idx, ptr_size);
+  RecordStore(kMethodCache, old_pair.object != nullptr && old_pair.index != method_idx);
   MethodDexCachePair pair(method, method_idx);
-  SetNativePairPtrSize(GetResolvedMethods(), MethodSlotIndex(method_idx), pair, ptr_size);
+  SetNativePairPtrSize(GetResolvedMethods(), slot_idx, pair, ptr_size);
 }
 
 inline void DexCache::ClearResolvedMethod(uint32_t method_idx, PointerSize ptr_size) {
@@ -356,8 +375,11 @@ inline void DexCache::FixupStrings(StringDexCacheType* dest, const Visitor& visi
     StringDexCachePair source = src[i].load(std::memory_order_relaxed);
     String* ptr = source.object.Read<kReadBarrierOption>();
     String* new_source = visitor(ptr);
-    source.object = GcRoot<String>(new_source);
-    dest[i].store(source, std::memory_order_relaxed);
+    // When fixing up in place, leave the unchanged entries alone to keep their pages clean.
+    if (dest != src || ptr != new_source) {
+      source.object = GcRoot<String>(new_source);
+      dest[i].store(source, std::memory_order_relaxed);
+    }
   }
 }
 
@@ -368,8 +390,10 @@ inline void DexCache::FixupResolvedTypes(TypeDexCacheType* dest, const Visitor&
     TypeDexCachePair source = src[i].load(std::memory_order_relaxed);
     Class* ptr = source.object.Read<kReadBarrierOption>();
     Class* new_source = visitor(ptr);
-    source.object = GcRoot<Class>(new_source);
-    dest[i].store(source, std::memory_order_relaxed);
+    if (dest != src || ptr != new_source) {
+      source.object = GcRoot<Class>(new_source);
+      dest[i].store(source, std::memory_order_relaxed);
+    }
   }
 }
 
@@ -381,8 +405,10 @@ inline void DexCache::FixupResolvedMethodTypes(MethodTypeDexCacheType* dest,
     MethodTypeDexCachePair source = src[i].load(std::memory_order_relaxed);
     MethodType* ptr = source.object.Read<kReadBarrierOption>();
     MethodType* new_source = visitor(ptr);
-    source.object = GcRoot<MethodType>(new_source);
-    dest[i].store(source, std::memory_order_relaxed);
+    if (dest != src || ptr != new_source) {
+      source.object = GcRoot<MethodType>(new_source);
+      dest[i].store(source, std::memory_order_relaxed);
+    }
   }
 }
 
@@ -393,7 +419,9 @@ inline void DexCache::FixupResolvedCallSites(GcRoot<mirror::CallSite>* dest,
   for (size_t i = 0, count = NumResolvedCallSites(); i < count; ++i) {
     mirror::CallSite* source = src[i].Read<kReadBarrierOption>();
     mirror::CallSite* new_source = visitor(source);
-    dest[i] = GcRoot<mirror::CallSite>(new_source);
+    if (dest != src || source != new_source) {
+      dest[i] = GcRoot<mirror::CallSite>(new_source);
+    }
   }
 }
 
@@ -16,6 +16,8 @@
 
 #include "dex_cache-inl.h"
 
+#include <ostream>
+
 #include "art_method-inl.h"
 #include "class_linker.h"
 #include "gc/accounting/card_table-inl.h"
@@ -34,6 +36,21 @@
 namespace art {
 namespace mirror {
 
+Atomic<uint64_t> DexCache::num_stores_[DexCache::kNumCacheKinds];
+Atomic<uint64_t> DexCache::num_evictions_[DexCache::kNumCacheKinds];
+
+void DexCache::DumpConflictCounts(std::ostream& os) {
+  static const char* const kCacheNames[kNumCacheKinds] = {
+      "strings", "types", "fields", "methods", "method types"
+  };
+  os << "Dex cache evictions/stores:";
+  for (size_t i = 0; i != kNumCacheKinds; ++i) {
+    os << (i == 0u ? " " : ", ") << kCacheNames[i] << "="
+       << num_evictions_[i].LoadRelaxed() << "/" << num_stores_[i].LoadRelaxed();
+  }
+  os << "\n";
+}
+
 void DexCache::InitializeDexCache(Thread* self,
                                   ObjPtr<mirror::DexCache> dex_cache,
                                   ObjPtr<mirror::String> location,
@@ -66,18 +83,9 @@ void DexCache::InitializeDexCache(Thread* self,
   FieldDexCacheType* fields = (dex_file->NumFieldIds() == 0u) ? nullptr :
       reinterpret_cast<FieldDexCacheType*>(raw_arrays + layout.FieldsOffset());
 
-  size_t num_strings = kDexCacheStringCacheSize;
-  if (dex_file->NumStringIds() < num_strings) {
-    num_strings = dex_file->NumStringIds();
-  }
-  size_t num_types = kDexCacheTypeCacheSize;
-  if (dex_file->NumTypeIds() < num_types) {
-    num_types = dex_file->NumTypeIds();
-  }
-  size_t num_fields = kDexCacheFieldCacheSize;
-  if (dex_file->NumFieldIds() < num_fields) {
-    num_fields = dex_file->NumFieldIds();
-  }
+  size_t num_strings = CacheSize(dex_file->NumStringIds(), kDexCacheStringCacheSize);
+  size_t num_types = CacheSize(dex_file->NumTypeIds(), kDexCacheTypeCacheSize);
+  size_t num_fields = CacheSize(dex_file->NumFieldIds(), kDexCacheFieldCacheSize);
   size_t num_methods = kDexCacheMethodCacheSize;
   if (dex_file->NumMethodIds() < num_methods) {
     num_methods = dex_file->NumMethodIds();
@@ -90,13 +98,7 @@ void DexCache::InitializeDexCache(Thread* self,
   // If this needs to be mitigated in a production system running this code,
   // DexCache::kDexCacheMethodTypeCacheSize can be set to zero.
   MethodTypeDexCacheType* method_types = nullptr;
-  size_t num_method_types = 0;
-
-  if (dex_file->NumProtoIds() < kDexCacheMethodTypeCacheSize) {
-    num_method_types = dex_file->NumProtoIds();
-  } else {
-    num_method_types = kDexCacheMethodTypeCacheSize;
-  }
+  size_t num_method_types = CacheSize(dex_file->NumProtoIds(), kDexCacheMethodTypeCacheSize);
 
   if (num_method_types > 0) {
     method_types = reinterpret_cast<MethodTypeDexCacheType*>(
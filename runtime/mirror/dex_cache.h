@@ -17,7 +17,10 @@
 #ifndef ART_RUNTIME_MIRROR_DEX_CACHE_H_
 #define ART_RUNTIME_MIRROR_DEX_CACHE_H_
 
+#include <iosfwd>
+
 #include "array.h"
+#include "atomic.h"
 #include "base/bit_utils.h"
 #include "base/mutex.h"
 #include "dex_file_types.h"
@@ -188,6 +191,36 @@ class MANAGED DexCache FINAL : public Object {
     return kDexCacheMethodTypeCacheSize;
   }
 
+  // Largest size of the string, type, field and method type dex caches of large dex files.
+  // The method dex cache keeps kDexCacheMethodCacheSize for the IMT conflict trampolines.
+  static constexpr size_t kDexCacheMaxCacheSize = 4096;
+  static_assert(IsPowerOfTwo(kDexCacheMaxCacheSize),
+                "Maximum dex cache size is not a power of 2.");
+
+  // Returns the number of entries of a dex cache for a dex file with `num_ids` ids of a kind
+  // whose static size is `static_size`. Dex files with no more ids than that get an entry per id.
+  // Larger ones get a quarter of their ids rounded up to a power of two, between `static_size`
+  // and kDexCacheMaxCacheSize, so that they do not thrash their dex caches.
+  static constexpr size_t CacheSize(size_t num_ids, size_t static_size) {
+    return (num_ids <= static_size)
+        ? num_ids
+        : (RoundUpToPowerOfTwo(num_ids) / 4u <= static_size)
+            ? static_size
+            : (RoundUpToPowerOfTwo(num_ids) / 4u <= kDexCacheMaxCacheSize)
+                ? RoundUpToPowerOfTwo(num_ids) / 4u
+                : kDexCacheMaxCacheSize;
+  }
+
+  // Returns the slot of the id `idx` in a dex cache of `cache_size` entries from CacheSize().
+  // Such a dex cache either has an entry per id or a power of two of entries.
+  static constexpr uint32_t SlotIndex(uint32_t idx, size_t cache_size) {
+    return (idx < cache_size) ? idx : (idx & static_cast<uint32_t>(cache_size - 1u));
+  }
+
+  // Prints how many entries were stored in the dex caches of each kind, and how many of them
+  // evicted the entry of another id from their slot.
+  static void DumpConflictCounts(std::ostream& os);
+
   // Size of an instance of java.lang.DexCache not including referenced values.
   static constexpr uint32_t InstanceSize() {
     return sizeof(DexCache);
@@ -445,6 +478,18 @@ class MANAGED DexCache FINAL : public Object {
   uint32_t MethodTypeSlotIndex(uint32_t proto_idx) REQUIRES_SHARED(Locks::mutator_lock_);
 
  private:
+  enum CacheKind {
+    kStringCache,
+    kTypeCache,
+    kFieldCache,
+    kMethodCache,
+    kMethodTypeCache,
+    kNumCacheKinds
+  };
+
+  // Counts a store to a dex cache of `kind`, which `evicts` the entry of another id or not.
+  ALWAYS_INLINE static void RecordStore(CacheKind kind, bool evicts);
+
   void Init(const DexFile* dex_file,
             ObjPtr<String> location,
             StringDexCacheType* strings,
@@ -547,6 +592,10 @@ class MANAGED DexCache FINAL : public Object {
   uint32_t num_resolved_types_;         // Number of elements in the resolved_types_ array.
   uint32_t num_strings_;                // Number of elements in the strings_ array.
 
+  // The number of stores, and of evicting stores, to the dex caches of each kind.
+  static Atomic<uint64_t> num_stores_[kNumCacheKinds];
+  static Atomic<uint64_t> num_evictions_[kNumCacheKinds];
+
   friend struct art::DexCacheOffsets;  // for verifying offset information
   friend class Object;  // For VisitReferences
   DISALLOW_IMPLICIT_CONSTRUCTORS(DexCache);
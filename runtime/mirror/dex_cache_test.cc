@@ -50,16 +50,36 @@ TEST_F(DexCacheTest, Open) {
           Runtime::Current()->GetLinearAlloc())));
   ASSERT_TRUE(dex_cache != nullptr);
 
-  EXPECT_TRUE(dex_cache->StaticStringSize() == dex_cache->NumStrings()
-      || java_lang_dex_file_->NumStringIds() == dex_cache->NumStrings());
-  EXPECT_TRUE(dex_cache->StaticTypeSize() == dex_cache->NumResolvedTypes()
-      || java_lang_dex_file_->NumTypeIds() == dex_cache->NumResolvedTypes());
+  EXPECT_EQ(DexCache::CacheSize(java_lang_dex_file_->NumStringIds(),
+                                dex_cache->StaticStringSize()),
+            dex_cache->NumStrings());
+  EXPECT_EQ(DexCache::CacheSize(java_lang_dex_file_->NumTypeIds(), dex_cache->StaticTypeSize()),
+            dex_cache->NumResolvedTypes());
   EXPECT_TRUE(dex_cache->StaticMethodSize() == dex_cache->NumResolvedMethods()
       || java_lang_dex_file_->NumMethodIds() == dex_cache->NumResolvedMethods());
-  EXPECT_TRUE(dex_cache->StaticArtFieldSize() == dex_cache->NumResolvedFields()
-      || java_lang_dex_file_->NumFieldIds() ==  dex_cache->NumResolvedFields());
-  EXPECT_TRUE(dex_cache->StaticMethodTypeSize() == dex_cache->NumResolvedMethodTypes()
-      || java_lang_dex_file_->NumProtoIds() == dex_cache->NumResolvedMethodTypes());
+  EXPECT_EQ(DexCache::CacheSize(java_lang_dex_file_->NumFieldIds(),
+                                dex_cache->StaticArtFieldSize()),
+            dex_cache->NumResolvedFields());
+  EXPECT_EQ(DexCache::CacheSize(java_lang_dex_file_->NumProtoIds(),
+                                dex_cache->StaticMethodTypeSize()),
+            dex_cache->NumResolvedMethodTypes());
+}
+
+TEST_F(DexCacheTest, CacheSize) {
+  // Small dex files get an entry per id.
+  EXPECT_EQ(0u, DexCache::CacheSize(0u, 1024u));
+  EXPECT_EQ(1000u, DexCache::CacheSize(1000u, 1024u));
+  EXPECT_EQ(1024u, DexCache::CacheSize(1024u, 1024u));
+  // Larger ones get a quarter of their ids, rounded up to a power of two.
+  EXPECT_EQ(1024u, DexCache::CacheSize(1025u, 1024u));
+  EXPECT_EQ(1024u, DexCache::CacheSize(4096u, 1024u));
+  EXPECT_EQ(2048u, DexCache::CacheSize(4097u, 1024u));
+  EXPECT_EQ(DexCache::kDexCacheMaxCacheSize, DexCache::CacheSize(65535u, 1024u));
+
+  // Ids map to their own slot in arrays with an entry per id, and are hashed otherwise.
+  EXPECT_EQ(999u, DexCache::SlotIndex(999u, 1000u));
+  EXPECT_EQ(999u, DexCache::SlotIndex(999u, 1024u));
+  EXPECT_EQ(1u, DexCache::SlotIndex(2049u, 2048u));
 }
 
 TEST_F(DexCacheMethodHandlesTest, Open) {
@@ -72,8 +92,9 @@ TEST_F(DexCacheMethodHandlesTest, Open) {
           *java_lang_dex_file_,
           Runtime::Current()->GetLinearAlloc())));
 
-  EXPECT_TRUE(dex_cache->StaticMethodTypeSize() == dex_cache->NumResolvedMethodTypes()
-      || java_lang_dex_file_->NumProtoIds() == dex_cache->NumResolvedMethodTypes());
+  EXPECT_EQ(DexCache::CacheSize(java_lang_dex_file_->NumProtoIds(),
+                                dex_cache->StaticMethodTypeSize()),
+            dex_cache->NumResolvedMethodTypes());
 }
 
 TEST_F(DexCacheTest, LinearAlloc) {
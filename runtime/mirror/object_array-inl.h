@@ -141,59 +141,41 @@ inline void ObjectArray<T>::AssignableMemmove(int32_t dst_pos,
   // Perform the memmove using int memmove then perform the write barrier.
   static_assert(sizeof(HeapReference<T>) == sizeof(uint32_t),
                 "art::mirror::HeapReference<T> and uint32_t have different sizes.");
-  // TODO: Optimize this later?
   // We can't use memmove since it does not handle read barriers and may do by per byte copying.
   // See b/32012820.
   const bool copy_forward = (src != this) || (dst_pos < src_pos) || (dst_pos - src_pos >= count);
-  if (copy_forward) {
-    // Forward copy.
-    bool baker_non_gray_case = false;
-    if (kUseReadBarrier && kUseBakerReadBarrier) {
-      uintptr_t fake_address_dependency;
-      if (!ReadBarrier::IsGray(src.Ptr(), &fake_address_dependency)) {
-        baker_non_gray_case = true;
-        DCHECK_EQ(fake_address_dependency, 0U);
-        src.Assign(reinterpret_cast<ObjectArray<T>*>(
-            reinterpret_cast<uintptr_t>(src.Ptr()) | fake_address_dependency));
-        for (int i = 0; i < count; ++i) {
-          // We can skip the RB here because 'src' isn't gray.
-          T* obj = src->template GetWithoutChecks<kDefaultVerifyFlags, kWithoutReadBarrier>(
-              src_pos + i);
-          SetWithoutChecksAndWriteBarrier<false>(dst_pos + i, obj);
-        }
-      }
+  bool needs_read_barrier = kUseReadBarrier;
+  if (kUseReadBarrier && kUseBakerReadBarrier) {
+    uintptr_t fake_address_dependency;
+    if (!ReadBarrier::IsGray(src.Ptr(), &fake_address_dependency)) {
+      needs_read_barrier = false;
+      DCHECK_EQ(fake_address_dependency, 0U);
+      src.Assign(reinterpret_cast<ObjectArray<T>*>(
+          reinterpret_cast<uintptr_t>(src.Ptr()) | fake_address_dependency));
     }
-    if (!baker_non_gray_case) {
-      for (int i = 0; i < count; ++i) {
-        // We need a RB here. ObjectArray::GetWithoutChecks() contains a RB.
-        T* obj = src->GetWithoutChecks(src_pos + i);
-        SetWithoutChecksAndWriteBarrier<false>(dst_pos + i, obj);
-      }
+  }
+  if (!needs_read_barrier) {
+    // Without read barriers, the references are copied as is, so copy them in bulk with
+    // untearable 32-bit accesses that the compiler can vectorize.
+    uint32_t* d = reinterpret_cast<uint32_t*>(GetRawData(sizeof(HeapReference<T>), dst_pos));
+    const uint32_t* s =
+        reinterpret_cast<const uint32_t*>(src->GetRawData(sizeof(HeapReference<T>), src_pos));
+    if (copy_forward) {
+      ArrayForwardCopy<uint32_t>(d, s, count);
+    } else {
+      ArrayBackwardCopy<uint32_t>(d, s, count);
     }
-  } else {
-    // Backward copy.
-    bool baker_non_gray_case = false;
-    if (kUseReadBarrier && kUseBakerReadBarrier) {
-      uintptr_t fake_address_dependency;
-      if (!ReadBarrier::IsGray(src.Ptr(), &fake_address_dependency)) {
-        baker_non_gray_case = true;
-        DCHECK_EQ(fake_address_dependency, 0U);
-        src.Assign(reinterpret_cast<ObjectArray<T>*>(
-            reinterpret_cast<uintptr_t>(src.Ptr()) | fake_address_dependency));
-        for (int i = count - 1; i >= 0; --i) {
-          // We can skip the RB here because 'src' isn't gray.
-          T* obj = src->template GetWithoutChecks<kDefaultVerifyFlags, kWithoutReadBarrier>(
-              src_pos + i);
-          SetWithoutChecksAndWriteBarrier<false>(dst_pos + i, obj);
-        }
-      }
+  } else if (copy_forward) {
+    for (int i = 0; i < count; ++i) {
+      // We need a RB here. ObjectArray::GetWithoutChecks() contains a RB.
+      T* obj = src->GetWithoutChecks(src_pos + i);
+      SetWithoutChecksAndWriteBarrier<false>(dst_pos + i, obj);
     }
-    if (!baker_non_gray_case) {
-      for (int i = count - 1; i >= 0; --i) {
-        // We need a RB here. ObjectArray::GetWithoutChecks() contains a RB.
-        T* obj = src->GetWithoutChecks(src_pos + i);
-        SetWithoutChecksAndWriteBarrier<false>(dst_pos + i, obj);
-      }
+  } else {
+    for (int i = count - 1; i >= 0; --i) {
+      // We need a RB here. ObjectArray::GetWithoutChecks() contains a RB.
+      T* obj = src->GetWithoutChecks(src_pos + i);
+      SetWithoutChecksAndWriteBarrier<false>(dst_pos + i, obj);
     }
   }
   Runtime::Current()->GetHeap()->WriteBarrierArray(this, dst_pos, count);
@@ -219,26 +201,25 @@ inline void ObjectArray<T>::AssignableMemcpy(int32_t dst_pos,
   // Perform the memmove using int memcpy then perform the write barrier.
   static_assert(sizeof(HeapReference<T>) == sizeof(uint32_t),
                 "art::mirror::HeapReference<T> and uint32_t have different sizes.");
-  // TODO: Optimize this later?
   // We can't use memmove since it does not handle read barriers and may do by per byte copying.
   // See b/32012820.
-  bool baker_non_gray_case = false;
+  bool needs_read_barrier = kUseReadBarrier;
   if (kUseReadBarrier && kUseBakerReadBarrier) {
     uintptr_t fake_address_dependency;
     if (!ReadBarrier::IsGray(src.Ptr(), &fake_address_dependency)) {
-      baker_non_gray_case = true;
+      needs_read_barrier = false;
       DCHECK_EQ(fake_address_dependency, 0U);
       src.Assign(reinterpret_cast<ObjectArray<T>*>(
           reinterpret_cast<uintptr_t>(src.Ptr()) | fake_address_dependency));
-      for (int i = 0; i < count; ++i) {
-        // We can skip the RB here because 'src' isn't gray.
-        Object* obj = src->template GetWithoutChecks<kDefaultVerifyFlags, kWithoutReadBarrier>(
-            src_pos + i);
-        SetWithoutChecksAndWriteBarrier<false>(dst_pos + i, obj);
-      }
     }
   }
-  if (!baker_non_gray_case) {
+  if (!needs_read_barrier) {
+    // Like in AssignableMemmove(), copy the references in bulk.
+    uint32_t* d = reinterpret_cast<uint32_t*>(GetRawData(sizeof(HeapReference<T>), dst_pos));
+    const uint32_t* s =
+        reinterpret_cast<const uint32_t*>(src->GetRawData(sizeof(HeapReference<T>), src_pos));
+    ArrayForwardCopy<uint32_t>(d, s, count);
+  } else {
     for (int i = 0; i < count; ++i) {
       // We need a RB here. ObjectArray::GetWithoutChecks() contains a RB.
       T* obj = src->GetWithoutChecks(src_pos + i);
@@ -83,10 +83,7 @@ class SetStringCountAndBytesVisitor {
     int32_t length = String::GetLengthFromCount(count_);
     const uint8_t* const src = reinterpret_cast<uint8_t*>(src_array_->GetData()) + offset_;
     if (string->IsCompressed()) {
-      uint8_t* valueCompressed = string->GetValueCompressed();
-      for (int i = 0; i < length; i++) {
-        valueCompressed[i] = (src[i] & 0xFF);
-      }
+      memcpy(string->GetValueCompressed(), src, length * sizeof(uint8_t));
     } else {
       uint16_t* value = string->GetValue();
       for (int i = 0; i < length; i++) {
@@ -118,8 +115,9 @@ class SetStringCountAndValueVisitorFromCharArray {
     const uint16_t* const src = src_array_->GetData() + offset_;
     const int32_t length = String::GetLengthFromCount(count_);
     if (kUseStringCompression && String::IsCompressed(count_)) {
+      uint8_t* value_compressed = string->GetValueCompressed();
       for (int i = 0; i < length; ++i) {
-        string->GetValueCompressed()[i] = static_cast<uint8_t>(src[i]);
+        value_compressed[i] = static_cast<uint8_t>(src[i]);
       }
     } else {
       memcpy(string->GetValue(), src, length * sizeof(uint16_t));
@@ -154,8 +152,9 @@ class SetStringCountAndValueVisitorFromString {
     } else {
       const uint16_t* const src = src_string_->GetValue() + offset_;
       if (compressible) {
+        uint8_t* value_compressed = string->GetValueCompressed();
         for (int i = 0; i < length; ++i) {
-          string->GetValueCompressed()[i] = static_cast<uint8_t>(src[i]);
+          value_compressed[i] = static_cast<uint8_t>(src[i]);
         }
       } else {
         memcpy(string->GetValue(), src, length * sizeof(uint16_t));
@@ -261,8 +260,9 @@ inline String* String::AllocFromByteArray(Thread* self, int32_t byte_length,
                                           int32_t high_byte, gc::AllocatorType allocator_type) {
   const uint8_t* const src = reinterpret_cast<uint8_t*>(array->GetData()) + offset;
   high_byte &= 0xff;  // Extract the relevant bits before determining `compressible`.
+  // Only scan the bytes if the high byte doesn't already rule out compression.
   const bool compressible =
-      kUseStringCompression && String::AllASCII<uint8_t>(src, byte_length) && (high_byte == 0);
+      kUseStringCompression && (high_byte == 0) && String::AllASCII<uint8_t>(src, byte_length);
   const int32_t length_with_flag = String::GetFlaggedCount(byte_length, compressible);
   SetStringCountAndBytesVisitor visitor(length_with_flag, array, offset, high_byte << 8);
   String* string = Alloc<kIsInstrumented>(self, length_with_flag, allocator_type, visitor);
@@ -315,12 +315,8 @@ inline int32_t String::GetHashCode() {
 template<typename MemoryType>
 inline bool String::AllASCII(const MemoryType* chars, const int length) {
   static_assert(std::is_unsigned<MemoryType>::value, "Expecting unsigned MemoryType");
-  for (int i = 0; i < length; ++i) {
-    if (!IsASCII(chars[i])) {
-      return false;
-    }
-  }
-  return true;
+  DCHECK_GE(length, 0);
+  return AllAsciiChars(chars, static_cast<size_t>(length));
 }
 
 inline bool String::DexFileStringAllASCII(const char* chars, const int length) {
@@ -183,9 +183,11 @@ String* String::AllocFromUtf16(Thread* self, int32_t utf16_length, const uint16_
     return nullptr;
   }
   if (compressible) {
-    for (int i = 0; i < utf16_length; ++i) {
-      string->GetValueCompressed()[i] = static_cast<uint8_t>(utf16_data_in[i]);
-    }
+    // All the characters are ASCII, so this just narrows them.
+    ConvertUtf16ToModifiedUtf8(reinterpret_cast<char*>(string->GetValueCompressed()),
+                               utf16_length,
+                               utf16_data_in,
+                               utf16_length);
   } else {
     uint16_t* array = string->GetValue();
     memcpy(array, utf16_data_in, utf16_length * sizeof(uint16_t));
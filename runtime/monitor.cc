@@ -16,6 +16,9 @@
 
 #include "monitor.h"
 
+#include <unistd.h>
+#include <algorithm>
+#include <tuple>
 #include <vector>
 
 #include "android-base/stringprintf.h"
@@ -34,6 +37,9 @@
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "object_callbacks.h"
+#include "runtime.h"
+#include "runtime_counters.h"
+#include "safe_map.h"
 #include "scoped_thread_state_change-inl.h"
 #include "stack.h"
 #include "thread.h"
@@ -77,6 +83,101 @@ static constexpr uint64_t kLongWaitMs = 100 * kDebugThresholdFudgeFactor;
 
 uint32_t Monitor::lock_profiling_threshold_ = 0;
 uint32_t Monitor::stack_dump_lock_profiling_threshold_ = 0;
+ContentionProfile* Monitor::contention_profile_ = nullptr;
+bool Monitor::spin_on_contention_ = false;
+
+// The sampled contention of the monitors, by lock class, owner site and contender site. The sites
+// are recorded as strings since their methods may be unloaded before the profile is dumped.
+class ContentionProfile {
+ public:
+  // Stop adding sites past this many, so that a pathological program can't use unbounded memory.
+  static constexpr size_t kMaxSites = 1024;
+  // The number of sites with the longest total wait which are dumped.
+  static constexpr size_t kSitesToDump = 32;
+
+  ContentionProfile() : lock_("monitor contention profile lock"), dropped_samples_(0u) {}
+
+  void Record(const std::string& lock_class,
+              const std::string& owner_site,
+              const std::string& contender_site,
+              uint32_t wait_ms) REQUIRES(!lock_) {
+    MutexLock mu(Thread::Current(), lock_);
+    Key key(lock_class, owner_site, contender_site);
+    auto it = sites_.find(key);
+    if (it == sites_.end()) {
+      if (sites_.size() == kMaxSites) {
+        ++dropped_samples_;
+        return;
+      }
+      it = sites_.Put(key, Stats());
+    }
+    ++it->second.samples;
+    it->second.total_wait_ms += wait_ms;
+    it->second.max_wait_ms = std::max(it->second.max_wait_ms, wait_ms);
+  }
+
+  void Dump(std::ostream& os) REQUIRES(!lock_) {
+    std::vector<std::pair<Key, Stats>> sites;
+    size_t dropped_samples;
+    {
+      MutexLock mu(Thread::Current(), lock_);
+      sites.assign(sites_.begin(), sites_.end());
+      dropped_samples = dropped_samples_;
+    }
+    if (sites.empty()) {
+      return;
+    }
+    std::sort(sites.begin(),
+              sites.end(),
+              [](const std::pair<Key, Stats>& lhs, const std::pair<Key, Stats>& rhs) {
+                return lhs.second.total_wait_ms > rhs.second.total_wait_ms;
+              });
+    os << "Monitor contention samples at " << sites.size() << " sites";
+    if (dropped_samples != 0u) {
+      os << " (" << dropped_samples << " samples of further sites dropped)";
+    }
+    os << ":\n";
+    const size_t sites_to_dump = kSitesToDump;
+    for (size_t i = 0, size = std::min(sites.size(), sites_to_dump); i != size; ++i) {
+      const Key& key = sites[i].first;
+      const Stats& stats = sites[i].second;
+      os << "  " << std::get<0>(key) << ": " << stats.samples << " samples, total "
+         << PrettyDuration(MsToNs(stats.total_wait_ms)) << ", max "
+         << PrettyDuration(MsToNs(stats.max_wait_ms)) << "\n"
+         << "    held at " << std::get<1>(key) << "\n"
+         << "    waited at " << std::get<2>(key) << "\n";
+    }
+  }
+
+ private:
+  typedef std::tuple<std::string, std::string, std::string> Key;
+
+  struct Stats {
+    Stats() : samples(0u), total_wait_ms(0u), max_wait_ms(0u) {}
+
+    size_t samples;
+    uint64_t total_wait_ms;
+    uint32_t max_wait_ms;
+  };
+
+  Mutex lock_;
+  SafeMap<Key, Stats> sites_ GUARDED_BY(lock_);
+  size_t dropped_samples_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(ContentionProfile);
+};
+
+// Tells the processor that we are busy waiting, so that it can save power and let the other
+// hardware thread of the core run.
+static inline void SpinPause() {
+#if defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+  __asm__ __volatile__("yield" : : : "memory");
+#else
+  __asm__ __volatile__("" : : : "memory");
+#endif
+}
 
 void Monitor::Init(uint32_t lock_profiling_threshold,
                    uint32_t stack_dump_lock_profiling_threshold) {
@@ -86,6 +187,16 @@ void Monitor::Init(uint32_t lock_profiling_threshold,
       lock_profiling_threshold * kDebugThresholdFudgeFactor;
   stack_dump_lock_profiling_threshold_ =
       stack_dump_lock_profiling_threshold * kDebugThresholdFudgeFactor;
+  spin_on_contention_ = sysconf(_SC_NPROCESSORS_CONF) > 1;
+  if (contention_profile_ == nullptr) {
+    contention_profile_ = new ContentionProfile();
+  }
+}
+
+void Monitor::DumpContentionProfile(std::ostream& os) {
+  if (contention_profile_ != nullptr) {
+    contention_profile_->Dump(os);
+  }
 }
 
 Monitor::Monitor(Thread* self, Thread* owner, mirror::Object* obj, int32_t hash_code)
@@ -94,6 +205,7 @@ Monitor::Monitor(Thread* self, Thread* owner, mirror::Object* obj, int32_t hash_
       num_waiters_(0),
       owner_(owner),
       lock_count_(0),
+      spin_limit_(kInitialMonitorSpinIterations),
       obj_(GcRoot<mirror::Object>(obj)),
       wait_set_(nullptr),
       hash_code_(hash_code),
@@ -117,6 +229,7 @@ Monitor::Monitor(Thread* self, Thread* owner, mirror::Object* obj, int32_t hash_
       num_waiters_(0),
       owner_(owner),
       lock_count_(0),
+      spin_limit_(kInitialMonitorSpinIterations),
       obj_(GcRoot<mirror::Object>(obj)),
       wait_set_(nullptr),
       hash_code_(hash_code),
@@ -386,11 +499,53 @@ bool Monitor::TryLockLocked(Thread* self) {
   return true;
 }
 
+std::string Monitor::PrettySite(ArtMethod* method, uint32_t dex_pc) {
+  if (method == nullptr) {
+    return "<unknown>";
+  }
+  const char* filename;
+  int32_t line_number;
+  TranslateLocation(method, dex_pc, &filename, &line_number);
+  return StringPrintf("%s(%s:%d)",
+                      ArtMethod::PrettyMethod(method).c_str(),
+                      filename != nullptr ? filename : "null",
+                      line_number);
+}
+
 bool Monitor::TryLock(Thread* self) {
   MutexLock mu(self, monitor_lock_);
   return TryLockLocked(self);
 }
 
+bool Monitor::SpinAndTryLock(Thread* self) {
+  Thread* owner = owner_;
+  // The owner can't go away while we hold monitor_lock_, so its state can be read. Don't spin on
+  // an owner which is blocked or waiting, it won't release the lock soon.
+  if (!spin_on_contention_ || owner == nullptr || owner->GetState() != kRunnable) {
+    return false;
+  }
+  const uint32_t spin_limit = spin_limit_;
+  monitor_lock_.Unlock(self);
+  uint32_t spins = 0u;
+  // Stop early if the lock changed hands, or if we are asked to suspend or run a checkpoint.
+  while (spins != spin_limit && GetOwnerRacy() == owner && !self->TestAllFlags()) {
+    SpinPause();
+    ++spins;
+  }
+  monitor_lock_.Lock(self);
+  bool acquired = TryLockLocked(self);
+  if (acquired) {
+    // Leave room for twice the last hold time.
+    uint32_t new_limit = std::max(spin_limit_, 2u * spins);
+    spin_limit_ = (new_limit < kMaxMonitorSpinIterations) ? new_limit : kMaxMonitorSpinIterations;
+  } else if (spins == spin_limit) {
+    // The owner held the lock for longer than we spun, spin less next time.
+    uint32_t new_limit = spin_limit_ / 2u;
+    spin_limit_ = (new_limit > kMinMonitorSpinIterations) ? new_limit : kMinMonitorSpinIterations;
+  }
+  return acquired;
+}
+
 // Asserts that a mutex isn't held when the class comes into and out of scope.
 class ScopedAssertNotHeld {
  public:
@@ -412,12 +567,20 @@ template <LockReason reason>
 void Monitor::Lock(Thread* self) {
   ScopedAssertNotHeld sanh(self, monitor_lock_);
   bool called_monitors_callback = false;
+  bool spun = false;
   monitor_lock_.Lock(self);
   while (true) {
     if (TryLockLocked(self)) {
       break;
     }
-    // Contended.
+    // Contended. Short critical sections are cheaper to wait for than a context switch.
+    if (!spun) {
+      spun = true;
+      if (SpinAndTryLock(self)) {
+        break;
+      }
+      continue;
+    }
     const bool log_contention = (lock_profiling_threshold_ != 0);
     uint64_t wait_start_ms = log_contention ? MilliTime() : 0;
     ArtMethod* owners_method = locking_method_;
@@ -429,7 +592,7 @@ void Monitor::Lock(Thread* self) {
     // If systrace logging is enabled, first look at the lock owner. Acquiring the monitor's
     // lock and then re-acquiring the mutator lock can deadlock.
     bool started_trace = false;
-    if (ATRACE_ENABLED()) {
+    if (IsTraceCategoryEnabled(TraceCategory::kMonitorContention)) {
       if (owner_ != nullptr) {  // Did the owner_ give the lock up?
         std::ostringstream oss;
         std::string name;
@@ -573,6 +736,14 @@ void Monitor::Lock(Thread* self) {
                                 sample_percent,
                                 owners_method,
                                 owners_dex_pc);
+              if (contention_profile_ != nullptr) {
+                uint32_t pc;
+                ArtMethod* m = self->GetCurrentMethod(&pc);
+                contention_profile_->Record(GetObject()->GetClass()->PrettyDescriptor(),
+                                            PrettySite(owners_method, owners_dex_pc),
+                                            PrettySite(m, pc),
+                                            wait_ms);
+              }
             }
           }
         }
@@ -968,6 +1139,7 @@ void Monitor::Inflate(Thread* self, Thread* owner, mirror::Object* obj, int32_t
           << " created monitor " << m << " for object " << obj;
     }
     Runtime::Current()->GetMonitorList()->Add(m);
+    Runtime::Current()->GetRuntimeCounters()->Increment(self, kCounterMonitorsInflated);
     CHECK_EQ(obj->GetLockWord(true).GetState(), LockWord::kFatLocked);
   } else {
     MonitorPool::ReleaseMonitor(self, m);
@@ -1078,16 +1250,25 @@ mirror::Object* Monitor::MonitorEnter(Thread* self, mirror::Object* obj, bool tr
           }
           // Contention.
           contention_count++;
+          if (contention_count == 1u && spin_on_contention_) {
+            // Literally spin first, without sched_yield. Sched_yield either does nothing (at
+            // significant expense), or guarantees that we wait at least microseconds. If the
+            // owner is running, the median lock hold time is hundreds of nanoseconds or less.
+            for (uint32_t i = 0; i != kThinLockSpinIterations; ++i) {
+              SpinPause();
+              if (!LockWord::Equal<false>(h_obj->GetLockWord(false), lock_word) ||
+                  self->TestAllFlags()) {
+                break;
+              }
+            }
+            continue;  // Start from the beginning.
+          }
           Runtime* runtime = Runtime::Current();
           if (contention_count <= runtime->GetMaxSpinsBeforeThinLockInflation()) {
             // TODO: Consider switching the thread state to kWaitingForLockInflation when we are
             // yielding.  Use sched_yield instead of NanoSleep since NanoSleep can wait much longer
             // than the parameter you pass in. This can cause thread suspension to take excessively
             // long and make long pauses. See b/16307460.
-            // TODO: We should literally spin first, without sched_yield. Sched_yield either does
-            // nothing (at significant expense), or guarantees that we wait at least microseconds.
-            // If the owner is running, I would expect the median lock hold time to be hundreds
-            // of nanoseconds or less.
             sched_yield();
           } else {
             contention_count = 0;
@@ -1490,7 +1671,8 @@ uint32_t Monitor::GetOwnerThreadId() {
 
 MonitorList::MonitorList()
     : allow_new_monitors_(true), monitor_list_lock_("MonitorList lock", kMonitorListLock),
-      monitor_add_condition_("MonitorList disallow condition", monitor_list_lock_) {
+      monitor_add_condition_("MonitorList disallow condition", monitor_list_lock_),
+      size_after_deflation_(0u) {
 }
 
 MonitorList::~MonitorList() {
@@ -1564,6 +1746,12 @@ size_t MonitorList::Size() {
   return list_.size();
 }
 
+bool MonitorList::ShouldDeflateMonitorsInForeground() {
+  MutexLock mu(Thread::Current(), monitor_list_lock_);
+  return list_.size() >= kMinMonitorsForForegroundDeflation &&
+      list_.size() >= 2u * size_after_deflation_;
+}
+
 class MonitorDeflateVisitor : public IsMarkedVisitor {
  public:
   MonitorDeflateVisitor() : self_(Thread::Current()), deflate_count_(0) {}
@@ -1587,6 +1775,8 @@ size_t MonitorList::DeflateMonitors() {
   MonitorDeflateVisitor visitor;
   Locks::mutator_lock_->AssertExclusiveHeld(visitor.self_);
   SweepMonitorList(&visitor);
+  MutexLock mu(visitor.self_, monitor_list_lock_);
+  size_after_deflation_ = list_.size();
   return visitor.deflate_count_;
 }
 
@@ -37,6 +37,7 @@
 namespace art {
 
 class ArtMethod;
+class ContentionProfile;
 class IsMarkedVisitor;
 class LockWord;
 template<class T> class Handle;
@@ -59,10 +60,25 @@ class Monitor {
   // a lock word. See Runtime::max_spins_before_thin_lock_inflation_.
   constexpr static size_t kDefaultMaxSpinsBeforeThinLockInflation = 50;
 
+  // The number of times a contended thin lock word is re-read while busy waiting, before the
+  // contending thread starts yielding. Most critical sections are shorter than this.
+  constexpr static uint32_t kThinLockSpinIterations = 200;
+
+  // Bounds of the number of times a contended inflated monitor is polled while its owner runs,
+  // before the contending thread blocks. Each monitor adapts its own limit to how long the
+  // owner held it the last times spinning was tried.
+  constexpr static uint32_t kMinMonitorSpinIterations = 16;
+  constexpr static uint32_t kInitialMonitorSpinIterations = 200;
+  constexpr static uint32_t kMaxMonitorSpinIterations = 4000;
+
   ~Monitor();
 
   static void Init(uint32_t lock_profiling_threshold, uint32_t stack_dump_lock_profiling_threshold);
 
+  // Dumps the sampled monitor contention, aggregated by lock class, owner and contender site.
+  // Contention is sampled when -Xlockprofthreshold is set.
+  static void DumpContentionProfile(std::ostream& os);
+
   // Return the thread id of the lock owner or 0 when there is no owner.
   static uint32_t GetLockOwnerThreadId(mirror::Object* obj)
       NO_THREAD_SAFETY_ANALYSIS;  // TODO: Reading lock owner without holding lock is racy.
@@ -213,6 +229,17 @@ class Monitor {
       REQUIRES(monitor_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // If the owner is running, busy waits without holding monitor_lock_ for the owner to release
+  // the lock, then tries to acquire it. Returns true if we acquired the lock.
+  bool SpinAndTryLock(Thread* self)
+      REQUIRES(monitor_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Reads the owner without holding monitor_lock_, the result may be stale.
+  Thread* GetOwnerRacy() const NO_THREAD_SAFETY_ANALYSIS {
+    return owner_;
+  }
+
   template<LockReason reason = LockReason::kForLock>
   void Lock(Thread* self)
       REQUIRES(!monitor_lock_)
@@ -269,6 +296,10 @@ class Monitor {
                                 int32_t* line_number)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Returns the method and source line of a lock operation, for the contention profile.
+  static std::string PrettySite(ArtMethod* method, uint32_t dex_pc)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   uint32_t GetOwnerThreadId() REQUIRES(!monitor_lock_);
 
   // Support for systrace output of monitor operations.
@@ -284,6 +315,9 @@ class Monitor {
 
   static uint32_t lock_profiling_threshold_;
   static uint32_t stack_dump_lock_profiling_threshold_;
+  static ContentionProfile* contention_profile_;
+  // Busy waiting only helps if the owner can run at the same time.
+  static bool spin_on_contention_;
 
   Mutex monitor_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
@@ -298,6 +332,9 @@ class Monitor {
   // Owner's recursive lock depth.
   int lock_count_ GUARDED_BY(monitor_lock_);
 
+  // How many times SpinAndTryLock() polls the owner.
+  uint32_t spin_limit_ GUARDED_BY(monitor_lock_);
+
   // What object are we part of. This is a weak root. Do not access
   // this directly, use GetObject() to read it so it will be guarded
   // by a read barrier.
@@ -332,6 +369,10 @@ class Monitor {
 
 class MonitorList {
  public:
+  // Monitors are deflated while pauses are user perceptible only when there are at least this
+  // many of them, and twice as many as after the previous deflation.
+  static constexpr size_t kMinMonitorsForForegroundDeflation = 1024;
+
   MonitorList();
   ~MonitorList();
 
@@ -345,6 +386,9 @@ class MonitorList {
   // Returns how many monitors were deflated.
   size_t DeflateMonitors() REQUIRES(!monitor_list_lock_) REQUIRES(Locks::mutator_lock_);
   size_t Size() REQUIRES(!monitor_list_lock_);
+  // Returns whether enough monitors were inflated since the previous deflation to deflate them
+  // even when we care about pause times.
+  bool ShouldDeflateMonitorsInForeground() REQUIRES(!monitor_list_lock_);
 
   typedef std::list<Monitor*, TrackingAllocator<Monitor*, kAllocatorTagMonitorList>> Monitors;
 
@@ -357,6 +401,8 @@ class MonitorList {
   Mutex monitor_list_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   ConditionVariable monitor_add_condition_ GUARDED_BY(monitor_list_lock_);
   Monitors list_ GUARDED_BY(monitor_list_lock_);
+  // The number of monitors left by the previous deflation.
+  size_t size_after_deflation_ GUARDED_BY(monitor_list_lock_);
 
   friend class Monitor;
   DISALLOW_COPY_AND_ASSIGN(MonitorList);
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "monitor.h"
+
+#include "class_linker-inl.h"
+#include "common_runtime_benchmark.h"
+#include "handle_scope-inl.h"
+#include "lock_word.h"
+#include "mirror/class-inl.h"
+#include "mirror/object-inl.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+class MonitorBenchmark : public CommonRuntimeBenchmark {
+ protected:
+  static constexpr size_t kLocks = 100000u;
+
+  void BenchmarkEnterExit(const char* name, Handle<mirror::Object> obj)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    Thread* self = Thread::Current();
+    Benchmark(name, kLocks, [&](size_t i ATTRIBUTE_UNUSED) REQUIRES_SHARED(Locks::mutator_lock_) {
+      Monitor::MonitorEnter(self, obj.Get(), /* trylock */ false);
+      Monitor::MonitorExit(self, obj.Get());
+    });
+  }
+
+  mirror::Object* AllocObject() REQUIRES_SHARED(Locks::mutator_lock_) {
+    Thread* self = Thread::Current();
+    return class_linker_->FindSystemClass(self, "Ljava/lang/Object;")->AllocObject(self);
+  }
+};
+
+// An uncontended thin lock.
+TEST_F(MonitorBenchmark, EnterExitThin) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::Object> obj = hs.NewHandle(AllocObject());
+  ASSERT_TRUE(obj != nullptr);
+  BenchmarkEnterExit("Monitor::MonitorEnter+MonitorExit/thin", obj);
+  EXPECT_EQ(LockWord::kUnlocked, obj->GetLockWord(false).GetState());
+}
+
+// A thin lock already held by the thread.
+TEST_F(MonitorBenchmark, EnterExitRecursive) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::Object> obj = hs.NewHandle(AllocObject());
+  ASSERT_TRUE(obj != nullptr);
+  Monitor::MonitorEnter(soa.Self(), obj.Get(), /* trylock */ false);
+  BenchmarkEnterExit("Monitor::MonitorEnter+MonitorExit/recursive", obj);
+  Monitor::MonitorExit(soa.Self(), obj.Get());
+}
+
+// Locking an object with an identity hash code inflates its lock.
+TEST_F(MonitorBenchmark, EnterExitFat) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::Object> obj = hs.NewHandle(AllocObject());
+  ASSERT_TRUE(obj != nullptr);
+  obj->IdentityHashCode();
+  Monitor::MonitorEnter(soa.Self(), obj.Get(), /* trylock */ false);
+  Monitor::MonitorExit(soa.Self(), obj.Get());
+  ASSERT_EQ(LockWord::kFatLocked, obj->GetLockWord(false).GetState());
+  BenchmarkEnterExit("Monitor::MonitorEnter+MonitorExit/fat", obj);
+}
+
+}  // namespace art
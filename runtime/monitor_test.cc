@@ -28,6 +28,7 @@
 #include "mirror/string-inl.h"  // Strings are easiest to allocate
 #include "object_lock.h"
 #include "scoped_thread_state_change-inl.h"
+#include "thread_list.h"
 #include "thread_pool.h"
 
 namespace art {
@@ -374,5 +375,29 @@ TEST_F(MonitorTest, TestTryLock) {
   thread_pool.StopWorkers(self);
 }
 
+TEST_F(MonitorTest, DeflateInForeground) {
+  Thread* const self = Thread::Current();
+  MonitorList* const monitor_list = Runtime::Current()->GetMonitorList();
+  ScopedObjectAccess soa(self);
+  VariableSizedHandleScope hs(self);
+  // Objects locked while their identity hash code is taken get an inflated monitor.
+  const size_t num_monitors = MonitorList::kMinMonitorsForForegroundDeflation;
+  for (size_t i = 0; i != num_monitors; ++i) {
+    Handle<mirror::Object> obj(
+        hs.NewHandle<mirror::Object>(mirror::String::AllocFromModifiedUtf8(self, "monitor")));
+    ASSERT_TRUE(obj != nullptr);
+    ObjectLock<mirror::Object> lock(self, obj);
+    obj->IdentityHashCode();
+    ASSERT_EQ(LockWord::kFatLocked, obj->GetLockWord(false).GetState());
+  }
+  EXPECT_TRUE(monitor_list->ShouldDeflateMonitorsInForeground());
+
+  {
+    ScopedThreadSuspension sts(self, kSuspended);
+    ScopedSuspendAll ssa(__FUNCTION__);
+    EXPECT_GE(monitor_list->DeflateMonitors(), num_monitors);
+  }
+  EXPECT_FALSE(monitor_list->ShouldDeflateMonitorsInForeground());
+}
 
 }  // namespace art
@@ -29,6 +29,7 @@
 #include "compiler_filter.h"
 #include "dex_file-inl.h"
 #include "dex_file_loader.h"
+#include "interpreter/interpreter_cache.h"
 #include "jni_internal.h"
 #include "mirror/class_loader.h"
 #include "mirror/object-inl.h"
@@ -334,6 +335,8 @@ static jboolean DexFile_closeDexFile(JNIEnv* env, jclass, jobject cookie) {
         if (!class_linker->IsDexFileRegistered(soa.Self(), *dex_file)) {
           // Clear the element in the array so that we can call close again.
           long_dex_files->Set(i, 0);
+          // The interpreter caches are keyed by the addresses of the instructions.
+          InterpreterCache::InvalidateAll();
           delete dex_file;
         } else {
           all_deleted = false;
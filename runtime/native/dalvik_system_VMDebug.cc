@@ -28,6 +28,7 @@
 #include "class_linker.h"
 #include "common_throws.h"
 #include "debugger.h"
+#include "gc/reference_processor.h"
 #include "gc/space/bump_pointer_space.h"
 #include "gc/space/dlmalloc_space.h"
 #include "gc/space/large_object_space.h"
@@ -36,12 +37,15 @@
 #include "handle_scope-inl.h"
 #include "hprof/hprof.h"
 #include "java_vm_ext.h"
+#include "jit/jit.h"
+#include "jit/jit_code_cache.h"
 #include "jni_internal.h"
 #include "mirror/class.h"
 #include "mirror/object_array-inl.h"
 #include "native_util.h"
 #include "nativehelper/scoped_local_ref.h"
 #include "nativehelper/scoped_utf_chars.h"
+#include "runtime_counters.h"
 #include "scoped_fast_native_object_access-inl.h"
 #include "trace.h"
 #include "well_known_classes.h"
@@ -439,9 +443,48 @@ enum class VMDebugRuntimeStatId {
   kArtGcBlockingGcTime,
   kArtGcGcCountRateHistogram,
   kArtGcBlockingGcCountRateHistogram,
+  kArtGcRegionFragmentationHistogram,
+  kArtGcFinalizerReferencesEnqueued,
+  kArtGcMaxFinalizerBatchSize,
+  kArtGcClassHistogram,
+  kArtJitCompilationRecords,
+  kArtRuntimeCounters,
+  kArtGcPauseTimePercentiles,
+  kArtJitCodeCacheSize,
   kNumRuntimeStats,
 };
 
+// Number of classes reported by the art.gc.class-histogram runtime stat.
+static constexpr size_t kMaxClassHistogramEntries = 100;
+
+// The art.jit.compilation-records runtime stat, empty without JIT.
+static std::string GetJitCompilationRecords() {
+  std::ostringstream output;
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit != nullptr) {
+    jit->DumpCompilationRecords(output);
+  }
+  return output.str();
+}
+
+// The art.jit.code-cache-size runtime stat, the bytes of code and data in the JIT code cache, 0
+// without JIT.
+static std::string GetJitCodeCacheSize() {
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit == nullptr) {
+    return "0";
+  }
+  jit::JitCodeCache* code_cache = jit->GetCodeCache();
+  return std::to_string(code_cache->CodeCacheSize() + code_cache->DataCacheSize());
+}
+
+// The art.runtime.counters runtime stat.
+static std::string GetRuntimeCounters() {
+  std::ostringstream output;
+  Runtime::Current()->GetRuntimeCounters()->Dump(output);
+  return output.str();
+}
+
 static jobject VMDebug_getRuntimeStatInternal(JNIEnv* env, jclass, jint statId) {
   gc::Heap* heap = Runtime::Current()->GetHeap();
   switch (static_cast<VMDebugRuntimeStatId>(statId)) {
@@ -479,6 +522,40 @@ static jobject VMDebug_getRuntimeStatInternal(JNIEnv* env, jclass, jint statId)
       heap->DumpBlockingGcCountRateHistogram(output);
       return env->NewStringUTF(output.str().c_str());
     }
+    case VMDebugRuntimeStatId::kArtGcRegionFragmentationHistogram: {
+      std::ostringstream output;
+      heap->DumpRegionFragmentationHistogram(output);
+      return env->NewStringUTF(output.str().c_str());
+    }
+    case VMDebugRuntimeStatId::kArtGcFinalizerReferencesEnqueued: {
+      std::string output =
+          std::to_string(heap->GetReferenceProcessor()->GetFinalizerReferencesEnqueued());
+      return env->NewStringUTF(output.c_str());
+    }
+    case VMDebugRuntimeStatId::kArtGcMaxFinalizerBatchSize: {
+      std::string output =
+          std::to_string(heap->GetReferenceProcessor()->GetMaxFinalizerBatchSize());
+      return env->NewStringUTF(output.c_str());
+    }
+    case VMDebugRuntimeStatId::kArtGcClassHistogram: {
+      std::ostringstream output;
+      heap->DumpClassHistogram(output, kMaxClassHistogramEntries);
+      return env->NewStringUTF(output.str().c_str());
+    }
+    case VMDebugRuntimeStatId::kArtJitCompilationRecords: {
+      return env->NewStringUTF(GetJitCompilationRecords().c_str());
+    }
+    case VMDebugRuntimeStatId::kArtRuntimeCounters: {
+      return env->NewStringUTF(GetRuntimeCounters().c_str());
+    }
+    case VMDebugRuntimeStatId::kArtGcPauseTimePercentiles: {
+      std::ostringstream output;
+      heap->DumpPausePercentiles(output);
+      return env->NewStringUTF(output.str().c_str());
+    }
+    case VMDebugRuntimeStatId::kArtJitCodeCacheSize: {
+      return env->NewStringUTF(GetJitCodeCacheSize().c_str());
+    }
     default:
       return nullptr;
   }
@@ -545,6 +622,56 @@ static jobjectArray VMDebug_getRuntimeStatsInternal(JNIEnv* env, jclass) {
       return nullptr;
     }
   }
+  {
+    std::ostringstream output;
+    heap->DumpRegionFragmentationHistogram(output);
+    if (!SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtGcRegionFragmentationHistogram,
+                             output.str())) {
+      return nullptr;
+    }
+  }
+  if (!SetRuntimeStatValue(
+          env,
+          result,
+          VMDebugRuntimeStatId::kArtGcFinalizerReferencesEnqueued,
+          std::to_string(heap->GetReferenceProcessor()->GetFinalizerReferencesEnqueued()))) {
+    return nullptr;
+  }
+  if (!SetRuntimeStatValue(
+          env,
+          result,
+          VMDebugRuntimeStatId::kArtGcMaxFinalizerBatchSize,
+          std::to_string(heap->GetReferenceProcessor()->GetMaxFinalizerBatchSize()))) {
+    return nullptr;
+  }
+  {
+    std::ostringstream output;
+    heap->DumpClassHistogram(output, kMaxClassHistogramEntries);
+    if (!SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtGcClassHistogram,
+                             output.str())) {
+      return nullptr;
+    }
+  }
+  if (!SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtJitCompilationRecords,
+                           GetJitCompilationRecords())) {
+    return nullptr;
+  }
+  if (!SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtRuntimeCounters,
+                           GetRuntimeCounters())) {
+    return nullptr;
+  }
+  {
+    std::ostringstream output;
+    heap->DumpPausePercentiles(output);
+    if (!SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtGcPauseTimePercentiles,
+                             output.str())) {
+      return nullptr;
+    }
+  }
+  if (!SetRuntimeStatValue(env, result, VMDebugRuntimeStatId::kArtJitCodeCacheSize,
+                           GetJitCodeCacheSize())) {
+    return nullptr;
+  }
   return result;
 }
 
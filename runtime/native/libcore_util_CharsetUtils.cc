@@ -18,6 +18,7 @@
 
 #include <string.h>
 
+#include "common_throws.h"
 #include "jni_internal.h"
 #include "mirror/string-inl.h"
 #include "mirror/string.h"
@@ -148,6 +149,19 @@ static void CharsetUtils_isoLatin1BytesToChars(JNIEnv* env, jclass, jbyteArray j
   }
 }
 
+// Checks the range of characters to convert like String.charAt() does, the conversions read the
+// characters of the string directly.
+static bool CheckStringRange(ObjPtr<mirror::String> string, jint offset, jint length)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  const int32_t string_length = string->GetLength();
+  if (UNLIKELY(offset < 0 || length < 0 || offset > string_length - length)) {
+    ThrowStringIndexOutOfBoundsException((offset < 0 || length < 0) ? offset : offset + length - 1,
+                                         string_length);
+    return false;
+  }
+  return true;
+}
+
 /**
  * Translates the given characters to US-ASCII or ISO-8859-1 bytes, using the fact that
  * Unicode code points between U+0000 and U+007f inclusive are identical to US-ASCII, while
@@ -158,7 +172,7 @@ static jbyteArray charsToBytes(JNIEnv* env, jstring java_string, jint offset, ji
   ScopedObjectAccess soa(env);
   StackHandleScope<1> hs(soa.Self());
   Handle<mirror::String> string(hs.NewHandle(soa.Decode<mirror::String>(java_string)));
-  if (string == nullptr) {
+  if (string == nullptr || !CheckStringRange(string.Get(), offset, length)) {
     return nullptr;
   }
 
@@ -169,8 +183,14 @@ static jbyteArray charsToBytes(JNIEnv* env, jstring java_string, jint offset, ji
   }
 
   jbyte* dst = &bytes[0];
+  if (string->IsCompressed()) {
+    // The compressed strings are ASCII, which both charsets encode as is.
+    memcpy(dst, string->GetValueCompressed() + offset, length);
+    return javaBytes;
+  }
+  const uint16_t* src = string->GetValue() + offset;
   for (int i = 0; i < length; ++i) {
-    jchar ch = string->CharAt(offset + i);
+    jchar ch = src[i];
     if (ch > maxValidChar) {
       ch = '?';
     }
@@ -195,10 +215,24 @@ static jbyteArray CharsetUtils_toUtf8Bytes(JNIEnv* env, jclass, jstring java_str
   ScopedObjectAccess soa(env);
   StackHandleScope<1> hs(soa.Self());
   Handle<mirror::String> string(hs.NewHandle(soa.Decode<mirror::String>(java_string)));
-  if (string == nullptr) {
+  if (string == nullptr || !CheckStringRange(string.Get(), offset, length)) {
     return nullptr;
   }
 
+  if (string->IsCompressed()) {
+    // The compressed strings are ASCII, their UTF-8 bytes are their characters.
+    jbyteArray javaBytes = env->NewByteArray(length);
+    if (javaBytes == nullptr) {
+      return nullptr;
+    }
+    // Read the characters after the allocation, which may have moved the string.
+    env->SetByteArrayRegion(javaBytes,
+                            0,
+                            length,
+                            reinterpret_cast<const jbyte*>(string->GetValueCompressed() + offset));
+    return javaBytes;
+  }
+
   NativeUnsafeByteSequence out(env);
   if (!out.resize(length)) {
     return nullptr;
@@ -18,6 +18,7 @@
 
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <atomic>
@@ -31,6 +32,7 @@
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "native_util.h"
+#include "runtime.h"
 #include "scoped_fast_native_object_access-inl.h"
 
 namespace art {
@@ -307,11 +309,29 @@ static void Unsafe_copyMemory(JNIEnv *env, jobject unsafe ATTRIBUTE_UNUSED, jlon
   if (size < 0 || size != (jlong)(size_t) size) {
     ScopedFastNativeObjectAccess soa(env);
     ThrowIllegalAccessException("wrong number of bytes");
+    return;
   }
   size_t sz = (size_t)size;
   memcpy(reinterpret_cast<void *>(dst), reinterpret_cast<void *>(src), sz);
 }
 
+// Checks that the elements [offset, offset + count) are within the array, throwing
+// ArrayIndexOutOfBoundsException for the first one that is not.
+template<typename T>
+static bool CheckArrayRange(ObjPtr<mirror::PrimitiveArray<T>> array, size_t offset, size_t count)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  size_t length = static_cast<size_t>(array->GetLength());
+  if (offset > length || count > length - offset) {
+    ThrowArrayIndexOutOfBoundsException(static_cast<int>(std::max(offset, length)),
+                                        array->GetLength());
+    return false;
+  }
+  return true;
+}
+
+// The copies below are done element by element so that array values do not tear, but on the raw
+// array data once the range is checked so that the compiler can vectorize them. Transactions
+// still need the checked Set() to record the old values.
 template<typename T>
 static void copyToArray(jlong srcAddr,
                         ObjPtr<mirror::PrimitiveArray<T>> array,
@@ -321,8 +341,18 @@ static void copyToArray(jlong srcAddr,
   const T* src = reinterpret_cast<T*>(srcAddr);
   size_t sz = size / sizeof(T);
   size_t of = array_offset / sizeof(T);
+  if (!CheckArrayRange(array, of, sz)) {
+    return;
+  }
+  if (UNLIKELY(Runtime::Current()->IsActiveTransaction())) {
+    for (size_t i = 0; i < sz; ++i) {
+      array->Set(i + of, *(src + i));
+    }
+    return;
+  }
+  T* dst = array->GetData() + of;
   for (size_t i = 0; i < sz; ++i) {
-    array->Set(i + of, *(src + i));
+    dst[i] = src[i];
   }
 }
 
@@ -335,8 +365,12 @@ static void copyFromArray(jlong dstAddr,
   T* dst = reinterpret_cast<T*>(dstAddr);
   size_t sz = size / sizeof(T);
   size_t of = array_offset / sizeof(T);
+  if (!CheckArrayRange(array, of, sz)) {
+    return;
+  }
+  const T* src = array->GetData() + of;
   for (size_t i = 0; i < sz; ++i) {
-    *(dst + i) = array->Get(i + of);
+    dst[i] = src[i];
   }
 }
 
@@ -346,13 +380,14 @@ static void Unsafe_copyMemoryToPrimitiveArray(JNIEnv *env,
                                               jobject dstObj,
                                               jlong dstOffset,
                                               jlong size) {
-  ScopedObjectAccess soa(env);
+  ScopedFastNativeObjectAccess soa(env);
   if (size == 0) {
     return;
   }
   // size is nonnegative and fits into size_t
   if (size < 0 || size != (jlong)(size_t) size) {
     ThrowIllegalAccessException("wrong number of bytes");
+    return;
   }
   size_t sz = (size_t)size;
   size_t dst_offset = (size_t)dstOffset;
@@ -377,13 +412,14 @@ static void Unsafe_copyMemoryFromPrimitiveArray(JNIEnv *env,
                                                 jlong srcOffset,
                                                 jlong dstAddr,
                                                 jlong size) {
-  ScopedObjectAccess soa(env);
+  ScopedFastNativeObjectAccess soa(env);
   if (size == 0) {
     return;
   }
   // size is nonnegative and fits into size_t
   if (size < 0 || size != (jlong)(size_t) size) {
     ThrowIllegalAccessException("wrong number of bytes");
+    return;
   }
   size_t sz = (size_t)size;
   size_t src_offset = (size_t)srcOffset;
@@ -271,6 +271,12 @@ static bool RunCommand(const std::string& cmd) {
   }
 }
 
+// Checking for addr2line forks a shell, so only do it once even if many threads are dumped.
+static bool HasAddr2line() {
+  static const bool has_addr2line = RunCommand("addr2line -h");
+  return has_addr2line;
+}
+
 static bool PcIsWithinQuickCode(ArtMethod* method, uintptr_t pc) NO_THREAD_SAFETY_ANALYSIS {
   uintptr_t code = reinterpret_cast<uintptr_t>(EntryPointToCodePointer(
       method->GetEntryPointFromQuickCompiledCode()));
@@ -313,7 +319,7 @@ void DumpNativeStack(std::ostream& os,
   if (kUseAddr2line) {
     // Try to run it to see whether we have it. Push an argument so that it doesn't assume a.out
     // and print to stderr.
-    use_addr2line = (gAborting > 0) && RunCommand("addr2line -h");
+    use_addr2line = (gAborting > 0) && HasAddr2line();
   } else {
     use_addr2line = false;
   }
@@ -1837,6 +1837,10 @@ std::string OatFile::GetClassLoaderContext() const {
   return GetOatHeader().GetStoreValueByKey(OatHeader::kClassPathKey);
 }
 
+const char* OatFile::GetClassLoaderContextFingerprint() const {
+  return GetOatHeader().GetStoreValueByKey(OatHeader::kClassPathFingerprintKey);
+}
+
 OatFile::OatClass OatFile::FindOatClass(const DexFile& dex_file,
                                         uint16_t class_def_idx,
                                         bool* found) {
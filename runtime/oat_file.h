@@ -133,6 +133,9 @@ class OatFile {
 
   std::string GetClassLoaderContext() const;
 
+  // Returns the fingerprint of the class loader context, or null if the oat file has none.
+  const char* GetClassLoaderContextFingerprint() const;
+
   const std::string& GetLocation() const {
     return location_;
   }
@@ -19,6 +19,7 @@
 #include <sstream>
 
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include "android-base/stringprintf.h"
 #include "android-base/strings.h"
@@ -863,11 +864,132 @@ std::string OatFileAssistant::ImageLocation() {
   return image_spaces[0]->GetImageLocation();
 }
 
+// The header of a dex checksums record, followed by the checksums. The record is valid as long as
+// the dex location has the size, modification time and inode it had when the checksums were
+// computed, so that checking it only needs a stat() of the dex location.
+struct DexChecksumsRecordHeader {
+  static constexpr uint8_t kMagic[] = { 'd', 'c', 'k', '\n' };
+  static constexpr uint8_t kVersion[] = { '0', '0', '1', '\0' };
+
+  uint8_t magic[4];
+  uint8_t version[4];
+  uint64_t dex_size;
+  uint64_t dex_mtime_ns;
+  uint64_t dex_inode;
+  uint32_t number_of_checksums;
+  uint32_t padding;
+};
+
+constexpr uint8_t DexChecksumsRecordHeader::kMagic[];
+constexpr uint8_t DexChecksumsRecordHeader::kVersion[];
+
+// Fills the fields of `header` describing the dex location.
+static bool StatDexLocation(const std::string& dex_location, DexChecksumsRecordHeader* header) {
+  struct stat dex_stat;
+  if (stat(dex_location.c_str(), &dex_stat) != 0) {
+    return false;
+  }
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, DexChecksumsRecordHeader::kMagic, sizeof(header->magic));
+  memcpy(header->version, DexChecksumsRecordHeader::kVersion, sizeof(header->version));
+  header->dex_size = static_cast<uint64_t>(dex_stat.st_size);
+  header->dex_mtime_ns = static_cast<uint64_t>(dex_stat.st_mtim.tv_sec) * UINT64_C(1000000000) +
+      static_cast<uint64_t>(dex_stat.st_mtim.tv_nsec);
+  header->dex_inode = static_cast<uint64_t>(dex_stat.st_ino);
+  return true;
+}
+
+std::string OatFileAssistant::GetDexChecksumsRecordFilename(const std::string& oat_filename) {
+  return ReplaceFileExtension(oat_filename, "dexsum");
+}
+
+bool OatFileAssistant::ReadDexChecksumsRecord(const std::string& filename,
+                                              const std::string& dex_location,
+                                              std::vector<uint32_t>* checksums) {
+  DexChecksumsRecordHeader expected;
+  if (!StatDexLocation(dex_location, &expected)) {
+    return false;
+  }
+  std::unique_ptr<File> file(OS::OpenFileForReading(filename.c_str()));
+  if (file == nullptr) {
+    return false;
+  }
+  DexChecksumsRecordHeader header;
+  if (!file->ReadFully(&header, sizeof(header))) {
+    return false;
+  }
+  // Everything but the number of checksums must match.
+  expected.number_of_checksums = header.number_of_checksums;
+  if (memcmp(&header, &expected, sizeof(header)) != 0 ||
+      header.number_of_checksums == 0u ||
+      static_cast<uint64_t>(file->GetLength()) !=
+          sizeof(header) + header.number_of_checksums * sizeof(uint32_t)) {
+    VLOG(oat) << "Ignoring stale dex checksums record " << filename;
+    return false;
+  }
+  checksums->resize(header.number_of_checksums);
+  if (!file->ReadFully(checksums->data(), checksums->size() * sizeof(uint32_t))) {
+    checksums->clear();
+    return false;
+  }
+  return true;
+}
+
+bool OatFileAssistant::WriteDexChecksumsRecord(const std::string& filename,
+                                               const std::string& dex_location,
+                                               const std::vector<uint32_t>& checksums) {
+  DexChecksumsRecordHeader header;
+  if (checksums.empty() || !StatDexLocation(dex_location, &header)) {
+    return false;
+  }
+  header.number_of_checksums = checksums.size();
+  // Write to a temporary file first, so that concurrent readers see either no record or a
+  // complete one.
+  std::string temp_filename = StringPrintf("%s.%d.tmp", filename.c_str(), getpid());
+  std::unique_ptr<File> file(OS::CreateEmptyFileWriteOnly(temp_filename.c_str()));
+  if (file == nullptr) {
+    return false;
+  }
+  if (!file->WriteFully(&header, sizeof(header)) ||
+      !file->WriteFully(checksums.data(), checksums.size() * sizeof(uint32_t))) {
+    file->Erase(/* unlink */ true);
+    return false;
+  }
+  if (file->FlushCloseOrErase() != 0) {
+    unlink(temp_filename.c_str());
+    return false;
+  }
+  if (rename(temp_filename.c_str(), filename.c_str()) != 0) {
+    unlink(temp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
 const std::vector<uint32_t>* OatFileAssistant::GetRequiredDexChecksums() {
   if (!required_dex_checksums_attempted_) {
     required_dex_checksums_attempted_ = true;
     required_dex_checksums_found_ = false;
     cached_required_dex_checksums_.clear();
+    // Without a zip fd, the checksums recorded beside the odex or oat file save opening the zip
+    // archive if the dex location did not change.
+    std::vector<const std::string*> oat_filenames;
+    if (zip_fd_ < 0) {
+      for (OatFileInfo* info : { &odex_, &oat_ }) {
+        if (info->Filename() != nullptr) {
+          oat_filenames.push_back(info->Filename());
+        }
+      }
+    }
+    for (const std::string* oat_filename : oat_filenames) {
+      if (ReadDexChecksumsRecord(GetDexChecksumsRecordFilename(*oat_filename),
+                                 dex_location_,
+                                 &cached_required_dex_checksums_)) {
+        required_dex_checksums_found_ = true;
+        has_original_dex_files_ = true;
+        return &cached_required_dex_checksums_;
+      }
+    }
     std::string error_msg;
     if (DexFileLoader::GetMultiDexChecksums(dex_location_.c_str(),
                                             &cached_required_dex_checksums_,
@@ -875,6 +997,14 @@ const std::vector<uint32_t>* OatFileAssistant::GetRequiredDexChecksums() {
                                             zip_fd_)) {
       required_dex_checksums_found_ = true;
       has_original_dex_files_ = true;
+      // Record the checksums in the first location we can write to.
+      for (const std::string* oat_filename : oat_filenames) {
+        if (WriteDexChecksumsRecord(GetDexChecksumsRecordFilename(*oat_filename),
+                                    dex_location_,
+                                    cached_required_dex_checksums_)) {
+          break;
+        }
+      }
     } else {
       // This can happen if the original dex file has been stripped from the
       // apk.
@@ -1190,7 +1320,8 @@ bool OatFileAssistant::OatFileInfo::ClassLoaderContextIsOkay(ClassLoaderContext*
     return false;
   }
 
-  bool result = context->VerifyClassLoaderContextMatch(file->GetClassLoaderContext());
+  bool result = context->VerifyClassLoaderContextMatch(file->GetClassLoaderContext(),
+                                                       file->GetClassLoaderContextFingerprint());
   if (!result) {
     VLOG(oat) << "ClassLoaderContext check failed. Context was "
               << file->GetClassLoaderContext()
@@ -299,6 +299,11 @@ class OatFileAssistant {
                                        std::string* oat_filename,
                                        std::string* error_msg);
 
+  // Returns the name of the dex checksums record stored beside the given odex or oat file.
+  // The record saves reading the zip archive of an unchanged dex location to compute its
+  // checksums.
+  static std::string GetDexChecksumsRecordFilename(const std::string& oat_filename);
+
  private:
   struct ImageInfo {
     uint32_t oat_checksum = 0;
@@ -464,6 +469,18 @@ class OatFileAssistant {
   // dex_location_ dex file.
   const std::vector<uint32_t>* GetRequiredDexChecksums();
 
+  // Reads the dex checksums recorded for `dex_location`. Returns false if there is no record or
+  // if the dex location changed since it was written.
+  static bool ReadDexChecksumsRecord(const std::string& filename,
+                                     const std::string& dex_location,
+                                     std::vector<uint32_t>* checksums);
+
+  // Records the dex checksums of `dex_location` with its current size, modification time and
+  // inode. Returns false if the record cannot be written.
+  static bool WriteDexChecksumsRecord(const std::string& filename,
+                                      const std::string& dex_location,
+                                      const std::vector<uint32_t>& checksums);
+
   // Returns the loaded image info.
   // Loads the image info if needed. Returns null if the image info failed
   // to load.
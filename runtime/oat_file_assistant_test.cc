@@ -17,6 +17,7 @@
 #include "oat_file_assistant.h"
 
 #include <sys/param.h>
+#include <sys/stat.h>
 
 #include <string>
 #include <vector>
@@ -27,6 +28,7 @@
 #include "android-base/strings.h"
 
 #include "art_field-inl.h"
+#include "base/file_utils.h"
 #include "class_linker-inl.h"
 #include "class_loader_context.h"
 #include "common_runtime_test.h"
@@ -156,6 +158,59 @@ TEST_F(OatFileAssistantTest, OdexUpToDate) {
   EXPECT_TRUE(oat_file_assistant.HasOriginalDexFiles());
 }
 
+// Case: We have a DEX file and an ODEX file, and the dex checksums are recorded beside the ODEX.
+// Expect: The record is used while the dex file is unchanged, and ignored once it changed.
+TEST_F(OatFileAssistantTest, DexChecksumsRecord) {
+  std::string dex_location = GetScratchDir() + "/DexChecksumsRecord.jar";
+  std::string odex_location = GetOdexDir() + "/DexChecksumsRecord.odex";
+  std::string record_location = OatFileAssistant::GetDexChecksumsRecordFilename(odex_location);
+  Copy(GetDexSrc1(), dex_location);
+  GeneratePicOdexForTest(dex_location, odex_location, CompilerFilter::kSpeed);
+
+  {
+    // Computing the checksums from the dex file records them.
+    OatFileAssistant oat_file_assistant(dex_location.c_str(), kRuntimeISA, false);
+    EXPECT_EQ(OatFileAssistant::kOatUpToDate, oat_file_assistant.OdexFileStatus());
+    EXPECT_TRUE(OS::FileExists(record_location.c_str()));
+  }
+
+  // Change the recorded checksum. The record is trusted as long as the dex file is unchanged.
+  std::string record;
+  ASSERT_TRUE(ReadFileToString(record_location, &record));
+  ASSERT_GE(record.size(), sizeof(uint32_t));
+  record[record.size() - 1u] ^= 1;
+  {
+    std::unique_ptr<File> file(OS::CreateEmptyFileWriteOnly(record_location.c_str()));
+    ASSERT_TRUE(file != nullptr);
+    ASSERT_TRUE(file->WriteFully(record.data(), record.size()));
+    ASSERT_EQ(0, file->FlushCloseOrErase());
+  }
+  {
+    OatFileAssistant oat_file_assistant(dex_location.c_str(), kRuntimeISA, false);
+    EXPECT_EQ(OatFileAssistant::kOatDexOutOfDate, oat_file_assistant.OdexFileStatus());
+    EXPECT_TRUE(oat_file_assistant.HasOriginalDexFiles());
+  }
+
+  // Modifying the dex file makes the record stale, the checksums are computed again.
+  struct stat dex_stat;
+  ASSERT_EQ(0, stat(dex_location.c_str(), &dex_stat));
+  struct timespec times[2] = { dex_stat.st_atim, dex_stat.st_mtim };
+  times[1].tv_sec += 1;
+  ASSERT_EQ(0, utimensat(AT_FDCWD, dex_location.c_str(), times, 0));
+  {
+    OatFileAssistant oat_file_assistant(dex_location.c_str(), kRuntimeISA, false);
+    EXPECT_EQ(OatFileAssistant::kOatUpToDate, oat_file_assistant.OdexFileStatus());
+  }
+  {
+    // The rewritten record is used again.
+    OatFileAssistant oat_file_assistant(dex_location.c_str(), kRuntimeISA, false);
+    EXPECT_EQ(OatFileAssistant::kOatUpToDate, oat_file_assistant.OdexFileStatus());
+  }
+  std::string new_record;
+  ASSERT_TRUE(ReadFileToString(record_location, &new_record));
+  EXPECT_NE(record, new_record);
+}
+
 // Case: We have a DEX file and a PIC ODEX file, but no OAT file. We load the dex
 // file via a symlink.
 // Expect: The status is kNoDexOptNeeded, because PIC needs no relocation.
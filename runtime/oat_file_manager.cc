@@ -375,7 +375,8 @@ bool OatFileManager::HasCollisions(const OatFile* oat_file,
 
   // If the pat file loading context matches the context used during compilation then we accept
   // the oat file without addition checks
-  if (context->VerifyClassLoaderContextMatch(oat_file->GetClassLoaderContext())) {
+  if (context->VerifyClassLoaderContextMatch(oat_file->GetClassLoaderContext(),
+                                             oat_file->GetClassLoaderContextFingerprint())) {
     return false;
   }
 
@@ -17,6 +17,7 @@
 #include "oat_quick_method_header.h"
 
 #include "art_method.h"
+#include "code_item_accessors-inl.h"
 #include "dex_file_types.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread.h"
@@ -36,6 +37,12 @@ OatQuickMethodHeader::OatQuickMethodHeader(uint32_t vmap_table_offset,
 
 OatQuickMethodHeader::~OatQuickMethodHeader() {}
 
+// Catch blocks are never inlined, so only the method's own try items lead to catch stack maps,
+// which are the only ones emitted out of native pc order.
+static bool HasCatchStackMaps(ArtMethod* method) NO_THREAD_SAFETY_ANALYSIS {
+  return CodeItemDataAccessor(method).TriesSize() != 0u;
+}
+
 uint32_t OatQuickMethodHeader::ToDexPc(ArtMethod* method,
                                        const uintptr_t pc,
                                        bool abort_on_failure) const {
@@ -44,7 +51,9 @@ uint32_t OatQuickMethodHeader::ToDexPc(ArtMethod* method,
   if (IsOptimized()) {
     CodeInfo code_info = GetOptimizedCodeInfo();
     CodeInfoEncoding encoding = code_info.ExtractEncoding();
-    StackMap stack_map = code_info.GetStackMapForNativePcOffset(sought_offset, encoding);
+    StackMap stack_map = HasCatchStackMaps(method)
+        ? code_info.GetStackMapForNativePcOffset(sought_offset, encoding)
+        : code_info.GetStackMapForNativePcOffsetWithoutCatch(sought_offset, encoding);
     if (stack_map.IsValid()) {
       return stack_map.GetDexPc(encoding.stack_map.encoding);
     }
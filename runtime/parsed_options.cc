@@ -147,14 +147,50 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:LongGCLogThreshold=_")  // in ms
           .WithType<MillisecondsToNanoseconds>()  // store as ns
           .IntoKey(M::LongGCLogThreshold)
+      .Define("-XX:GcPauseTarget=_")  // in ms
+          .WithType<MillisecondsToNanoseconds>()  // store as ns
+          .IntoKey(M::GcPauseTarget)
+      .Define("-XX:GcCpuBudgetPercent=_")
+          .WithType<unsigned int>().WithRange(1, 99)
+          .IntoKey(M::GcCpuBudgetPercent)
+      .Define("-XX:AllocSampleInterval=_")
+          .WithType<Memory<1>>()
+          .IntoKey(M::AllocSampleInterval)
+      .Define("-XX:HeapTrimReleaseBudget=_")
+          .WithType<Memory<1>>()
+          .IntoKey(M::HeapTrimReleaseBudget)
       .Define("-XX:DumpGCPerformanceOnShutdown")
           .IntoKey(M::DumpGCPerformanceOnShutdown)
       .Define("-XX:DumpJITInfoOnShutdown")
           .IntoKey(M::DumpJITInfoOnShutdown)
+      .Define("-XX:DumpStartupTimeline")
+          .IntoKey(M::DumpStartupTimeline)
       .Define("-XX:IgnoreMaxFootprint")
           .IntoKey(M::IgnoreMaxFootprint)
       .Define("-XX:LowMemoryMode")
           .IntoKey(M::LowMemoryMode)
+      .Define("-XX:TransparentHugePages")
+          .IntoKey(M::TransparentHugePages)
+      .Define("-XX:NumaAwareHeap")
+          .IntoKey(M::NumaAwareHeap)
+      .Define("-XX:GcMetricsFile=_")
+          .WithType<std::string>()
+          .IntoKey(M::GcMetricsFile)
+      .Define("-XX:RuntimeCountersFile=_")
+          .WithType<std::string>()
+          .IntoKey(M::RuntimeCountersFile)
+      .Define("-XX:TraceCategories=_")
+          .WithType<std::string>()
+          .IntoKey(M::TraceCategories)
+      .Define("-XX:TimingTraceFile=_")
+          .WithType<std::string>()
+          .IntoKey(M::TimingTraceFile)
+      .Define("-XX:StartupClassInitProfile=_")
+          .WithType<std::string>()
+          .IntoKey(M::StartupClassInitProfile)
+      .Define("-XX:StartupClassInitThreads=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::StartupClassInitThreads)
       .Define("-XX:UseTLAB")
           .WithValue(true)
           .IntoKey(M::UseTLAB)
@@ -194,6 +230,17 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-Xjittransitionweight:_")
           .WithType<unsigned int>()
           .IntoKey(M::JITInvokeTransitionWeight)
+      .Define("-Xjitsampleperiod:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::JITSamplePeriod)
+      .Define("-Xjitthreads:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::JITThreadPoolSize)
+      .Define("-Xjitoptimizethreshold:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::JITOptimizeThreshold)
+      .Define("-Xjitprecompilehotmethods")
+          .IntoKey(M::JITPrecompileHotMethods)
       .Define("-Xjitsaveprofilinginfo")
           .WithType<ProfileSaverOptions>()
           .AppendValues()
@@ -709,6 +756,8 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Xgc:[no]postsweepingverify_rosalloc\n");
   UsageMessage(stream, "  -Xgc:[no]postverify_rosalloc\n");
   UsageMessage(stream, "  -Xgc:[no]presweepingverify\n");
+  UsageMessage(stream, "  -Xgc:[no]classhistogram\n");
+  UsageMessage(stream, "  -Xgc:[no]measuretlb\n");
   UsageMessage(stream, "  -Ximage:filename\n");
   UsageMessage(stream, "  -Xbootclasspath-locations:bootclasspath\n"
                        "     (override the dex locations of the -Xbootclasspath files)\n");
@@ -718,10 +767,24 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:MaxSpinsBeforeThinLockInflation=integervalue\n");
   UsageMessage(stream, "  -XX:LongPauseLogThreshold=integervalue\n");
   UsageMessage(stream, "  -XX:LongGCLogThreshold=integervalue\n");
+  UsageMessage(stream, "  -XX:GcPauseTarget=integervalue\n");
+  UsageMessage(stream, "  -XX:GcCpuBudgetPercent=integervalue\n");
+  UsageMessage(stream, "  -XX:AllocSampleInterval=N\n");
+  UsageMessage(stream, "  -XX:HeapTrimReleaseBudget=N\n");
   UsageMessage(stream, "  -XX:ThreadSuspendTimeout=integervalue\n");
   UsageMessage(stream, "  -XX:DumpGCPerformanceOnShutdown\n");
   UsageMessage(stream, "  -XX:DumpJITInfoOnShutdown\n");
+  UsageMessage(stream, "  -XX:DumpStartupTimeline\n");
   UsageMessage(stream, "  -XX:IgnoreMaxFootprint\n");
+  UsageMessage(stream, "  -XX:TransparentHugePages\n");
+  UsageMessage(stream, "  -XX:NumaAwareHeap\n");
+  UsageMessage(stream, "  -XX:GcMetricsFile=file.bin\n");
+  UsageMessage(stream, "  -XX:RuntimeCountersFile=file.bin\n");
+  UsageMessage(stream, "  -XX:TraceCategories=gc,jit,class-linking,verification,"
+                       "monitor-contention\n");
+  UsageMessage(stream, "  -XX:TimingTraceFile=file.bin\n");
+  UsageMessage(stream, "  -XX:StartupClassInitProfile=file.prof\n");
+  UsageMessage(stream, "  -XX:StartupClassInitThreads=integervalue\n");
   UsageMessage(stream, "  -XX:UseTLAB\n");
   UsageMessage(stream, "  -XX:BackgroundGC=none\n");
   UsageMessage(stream, "  -XX:LargeObjectSpace={disabled,map,freelist}\n");
@@ -750,6 +813,10 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Xjitwarmupthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitosrthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitprithreadweight:integervalue\n");
+  UsageMessage(stream, "  -Xjitsampleperiod:integervalue\n");
+  UsageMessage(stream, "  -Xjitthreads:integervalue\n");
+  UsageMessage(stream, "  -Xjitoptimizethreshold:integervalue\n");
+  UsageMessage(stream, "  -Xjitprecompilehotmethods\n");
   UsageMessage(stream, "  -X[no]relocate\n");
   UsageMessage(stream, "  -X[no]dex2oat (Whether to invoke dex2oat on the application)\n");
   UsageMessage(stream, "  -X[no]image-dex2oat (Whether to create and use a boot image)\n");
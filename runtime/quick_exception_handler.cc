@@ -20,6 +20,7 @@
 #include "art_method-inl.h"
 #include "base/enums.h"
 #include "base/logging.h"  // For VLOG_IS_ON.
+#include "code_item_accessors-inl.h"
 #include "dex_file_types.h"
 #include "dex_instruction.h"
 #include "entrypoints/entrypoint_utils.h"
@@ -32,6 +33,8 @@
 #include "mirror/class_loader.h"
 #include "mirror/throwable.h"
 #include "oat_quick_method_header.h"
+#include "runtime.h"
+#include "runtime_counters.h"
 #include "stack.h"
 #include "stack_map.h"
 
@@ -100,10 +103,17 @@ class CatchBlockStackVisitor FINAL : public StackVisitor {
  private:
   bool HandleTryItems(ArtMethod* method)
       REQUIRES_SHARED(Locks::mutator_lock_) {
-    uint32_t dex_pc = dex::kDexNoIndex;
-    if (!method->IsNative()) {
-      dex_pc = GetDexPc();
+    if (method->IsNative() || method->IsProxyMethod()) {
+      return true;  // Continue stack walk.
     }
+    // A method without try items has no catch handler for any dex pc, so don't look up the dex
+    // pc of the frame, which for compiled code means searching its stack maps.
+    if (CodeItemDataAccessor(method).TriesSize() == 0u) {
+      exception_handler_->SetClearException(false);
+      RemoveDebuggerShadowFrame();
+      return true;  // Continue stack walk.
+    }
+    uint32_t dex_pc = GetDexPc();
     if (dex_pc != dex::kDexNoIndex) {
       bool clear_exception = false;
       StackHandleScope<1> hs(GetThread());
@@ -119,20 +129,25 @@ class CatchBlockStackVisitor FINAL : public StackVisitor {
         exception_handler_->SetHandlerQuickFrame(GetCurrentQuickFrame());
         exception_handler_->SetHandlerMethodHeader(GetCurrentOatQuickMethodHeader());
         return false;  // End stack walk.
-      } else if (UNLIKELY(GetThread()->HasDebuggerShadowFrames())) {
-        // We are going to unwind this frame. Did we prepare a shadow frame for debugging?
-        size_t frame_id = GetFrameId();
-        ShadowFrame* frame = GetThread()->FindDebuggerShadowFrame(frame_id);
-        if (frame != nullptr) {
-          // We will not execute this shadow frame so we can safely deallocate it.
-          GetThread()->RemoveDebuggerShadowFrameMapping(frame_id);
-          ShadowFrame::DeleteDeoptimizedFrame(frame);
-        }
       }
+      RemoveDebuggerShadowFrame();
     }
     return true;  // Continue stack walk.
   }
 
+  void RemoveDebuggerShadowFrame() REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (UNLIKELY(GetThread()->HasDebuggerShadowFrames())) {
+      // We are going to unwind this frame. Did we prepare a shadow frame for debugging?
+      size_t frame_id = GetFrameId();
+      ShadowFrame* frame = GetThread()->FindDebuggerShadowFrame(frame_id);
+      if (frame != nullptr) {
+        // We will not execute this shadow frame so we can safely deallocate it.
+        GetThread()->RemoveDebuggerShadowFrameMapping(frame_id);
+        ShadowFrame::DeleteDeoptimizedFrame(frame);
+      }
+    }
+  }
+
   // The exception we're looking for the catch block of.
   Handle<mirror::Throwable>* exception_;
   // The quick exception handler we're visiting for.
@@ -531,6 +546,7 @@ void QuickExceptionHandler::DeoptimizeStack() {
 
   DeoptimizeStackVisitor visitor(self_, context_, this, false);
   visitor.WalkStack(true);
+  Runtime::Current()->GetRuntimeCounters()->Increment(self_, kCounterDeoptimizations);
   PrepareForLongJumpToInvokeStubOrInterpreterBridge();
 }
 
@@ -558,6 +574,7 @@ void QuickExceptionHandler::DeoptimizeSingleFrame(DeoptimizationKind kind) {
     Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
         deopt_method, GetQuickToInterpreterBridge());
   }
+  Runtime::Current()->GetRuntimeCounters()->Increment(self_, kCounterDeoptimizations);
 
   PrepareForLongJumpToInvokeStubOrInterpreterBridge();
 }
@@ -38,6 +38,67 @@ namespace art {
 
 using android::base::StringPrintf;
 
+// Returns the primitive type and the value of a boxed primitive, false if o is not a box. The
+// box classes are final, so this compares class pointers instead of descriptors.
+static bool GetUnboxedTypeAndValue(ObjPtr<mirror::Object> o, Primitive::Type* type, JValue* value)
+    REQUIRES_SHARED(Locks::mutator_lock_) {
+  ObjPtr<mirror::Class> klass = o->GetClass();
+  auto is_box = [klass](jmethodID value_of) REQUIRES_SHARED(Locks::mutator_lock_) {
+    return klass == jni::DecodeArtMethod(value_of)->GetDeclaringClass();
+  };
+  if (is_box(WellKnownClasses::java_lang_Integer_valueOf)) {
+    *type = Primitive::kPrimInt;
+  } else if (is_box(WellKnownClasses::java_lang_Long_valueOf)) {
+    *type = Primitive::kPrimLong;
+  } else if (is_box(WellKnownClasses::java_lang_Boolean_valueOf)) {
+    *type = Primitive::kPrimBoolean;
+  } else if (is_box(WellKnownClasses::java_lang_Double_valueOf)) {
+    *type = Primitive::kPrimDouble;
+  } else if (is_box(WellKnownClasses::java_lang_Float_valueOf)) {
+    *type = Primitive::kPrimFloat;
+  } else if (is_box(WellKnownClasses::java_lang_Character_valueOf)) {
+    *type = Primitive::kPrimChar;
+  } else if (is_box(WellKnownClasses::java_lang_Short_valueOf)) {
+    *type = Primitive::kPrimShort;
+  } else if (is_box(WellKnownClasses::java_lang_Byte_valueOf)) {
+    *type = Primitive::kPrimByte;
+  } else {
+    return false;
+  }
+  // The value is the only instance field of the box classes.
+  ArtField* value_field = klass->GetInstanceField(0);
+  switch (*type) {
+    case Primitive::kPrimBoolean:
+      value->SetZ(value_field->GetBoolean(o));
+      break;
+    case Primitive::kPrimByte:
+      value->SetB(value_field->GetByte(o));
+      break;
+    case Primitive::kPrimChar:
+      value->SetC(value_field->GetChar(o));
+      break;
+    case Primitive::kPrimShort:
+      value->SetS(value_field->GetShort(o));
+      break;
+    case Primitive::kPrimInt:
+      value->SetI(value_field->GetInt(o));
+      break;
+    case Primitive::kPrimLong:
+      value->SetJ(value_field->GetLong(o));
+      break;
+    case Primitive::kPrimFloat:
+      value->SetF(value_field->GetFloat(o));
+      break;
+    case Primitive::kPrimDouble:
+      value->SetD(value_field->GetDouble(o));
+      break;
+    default:
+      LOG(FATAL) << "Unexpected type: " << *type;
+      UNREACHABLE();
+  }
+  return true;
+}
+
 class ArgArray {
  public:
   ArgArray(const char* shorty, uint32_t shorty_len)
@@ -254,99 +315,36 @@ class ArgArray {
         }
       }
 
-#define DO_FIRST_ARG(match_descriptor, get_fn, append) { \
-          if (LIKELY(arg != nullptr && \
-              arg->GetClass()->DescriptorEquals(match_descriptor))) { \
-            ArtField* primitive_field = arg->GetClass()->GetInstanceField(0); \
-            append(primitive_field-> get_fn(arg.Get()));
-
-#define DO_ARG(match_descriptor, get_fn, append) \
-          } else if (LIKELY(arg != nullptr && \
-                            arg->GetClass<>()->DescriptorEquals(match_descriptor))) { \
-            ArtField* primitive_field = arg->GetClass()->GetInstanceField(0); \
-            append(primitive_field-> get_fn(arg.Get()));
-
-#define DO_FAIL(expected) \
-          } else { \
-            if (arg->GetClass<>()->IsPrimitive()) { \
-              std::string temp; \
-              ThrowIllegalPrimitiveArgumentException(expected, \
-                                                     arg->GetClass<>()->GetDescriptor(&temp)); \
-            } else { \
-              ThrowIllegalArgumentException(\
-                  StringPrintf("method %s argument %zd has type %s, got %s", \
-                      ArtMethod::PrettyMethod(m, false).c_str(), \
-                      args_offset + 1, \
-                      expected, \
-                      mirror::Object::PrettyTypeOf(arg.Get()).c_str()).c_str()); \
-            } \
-            return false; \
-          } }
-
-      switch (shorty_[i]) {
-        case 'L':
-          Append(arg.Get());
-          break;
-        case 'Z':
-          DO_FIRST_ARG("Ljava/lang/Boolean;", GetBoolean, Append)
-          DO_FAIL("boolean")
-          break;
-        case 'B':
-          DO_FIRST_ARG("Ljava/lang/Byte;", GetByte, Append)
-          DO_FAIL("byte")
-          break;
-        case 'C':
-          DO_FIRST_ARG("Ljava/lang/Character;", GetChar, Append)
-          DO_FAIL("char")
-          break;
-        case 'S':
-          DO_FIRST_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
-          DO_FAIL("short")
-          break;
-        case 'I':
-          DO_FIRST_ARG("Ljava/lang/Integer;", GetInt, Append)
-          DO_ARG("Ljava/lang/Character;", GetChar, Append)
-          DO_ARG("Ljava/lang/Short;", GetShort, Append)
-          DO_ARG("Ljava/lang/Byte;", GetByte, Append)
-          DO_FAIL("int")
-          break;
-        case 'J':
-          DO_FIRST_ARG("Ljava/lang/Long;", GetLong, AppendWide)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendWide)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendWide)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendWide)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendWide)
-          DO_FAIL("long")
-          break;
-        case 'F':
-          DO_FIRST_ARG("Ljava/lang/Float;", GetFloat, AppendFloat)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendFloat)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendFloat)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendFloat)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendFloat)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendFloat)
-          DO_FAIL("float")
-          break;
-        case 'D':
-          DO_FIRST_ARG("Ljava/lang/Double;", GetDouble, AppendDouble)
-          DO_ARG("Ljava/lang/Float;", GetFloat, AppendDouble)
-          DO_ARG("Ljava/lang/Long;", GetLong, AppendDouble)
-          DO_ARG("Ljava/lang/Integer;", GetInt, AppendDouble)
-          DO_ARG("Ljava/lang/Character;", GetChar, AppendDouble)
-          DO_ARG("Ljava/lang/Short;", GetShort, AppendDouble)
-          DO_ARG("Ljava/lang/Byte;", GetByte, AppendDouble)
-          DO_FAIL("double")
-          break;
-#ifndef NDEBUG
-        default:
-          LOG(FATAL) << "Unexpected shorty character: " << shorty_[i];
-          UNREACHABLE();
-#endif
+      if (shorty_[i] == 'L') {
+        Append(arg.Get());
+        continue;
+      }
+      // The argument was checked against null above.
+      const Primitive::Type dst_type = Primitive::GetType(shorty_[i]);
+      Primitive::Type src_type;
+      JValue src_value;
+      JValue value;
+      if (UNLIKELY(!GetUnboxedTypeAndValue(arg.Get(), &src_type, &src_value) ||
+                   !ConvertPrimitiveValueNoThrow(src_type, dst_type, src_value, &value))) {
+        if (arg->GetClass<>()->IsPrimitive()) {
+          std::string temp;
+          ThrowIllegalPrimitiveArgumentException(PrettyDescriptor(dst_type).c_str(),
+                                                 arg->GetClass<>()->GetDescriptor(&temp));
+        } else {
+          ThrowIllegalArgumentException(
+              StringPrintf("method %s argument %zd has type %s, got %s",
+                  ArtMethod::PrettyMethod(m, false).c_str(),
+                  args_offset + 1,
+                  PrettyDescriptor(dst_type).c_str(),
+                  mirror::Object::PrettyTypeOf(arg.Get()).c_str()).c_str());
+        }
+        return false;
+      }
+      if (dst_type == Primitive::kPrimLong || dst_type == Primitive::kPrimDouble) {
+        AppendWide(value.GetJ());
+      } else {
+        Append(value.GetI());
       }
-#undef DO_FIRST_ARG
-#undef DO_ARG
-#undef DO_FAIL
     }
     return true;
   }
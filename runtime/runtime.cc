@@ -31,9 +31,11 @@
 #include <crt_externs.h>  // for _NSGetEnviron
 #endif
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <limits>
+#include <sstream>
 #include <vector>
 
 #include "android-base/strings.h"
@@ -65,6 +67,7 @@
 #include "base/memory_tool.h"
 #include "base/stl_util.h"
 #include "base/systrace.h"
+#include "base/time_utils.h"
 #include "base/unix_file/fd_file.h"
 #include "class_linker-inl.h"
 #include "compiler_callbacks.h"
@@ -145,15 +148,20 @@
 #include "quick/quick_method_frame_info.h"
 #include "reflection.h"
 #include "runtime_callbacks.h"
+#include "runtime_counters.h"
 #include "runtime_intrinsics.h"
 #include "runtime_options.h"
 #include "scoped_thread_state_change-inl.h"
 #include "sigchain.h"
 #include "signal_catcher.h"
 #include "signal_set.h"
+#include "startup_class_initializer.h"
+#include "startup_timeline.h"
 #include "thread.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "ti/agent.h"
+#include "timing_trace.h"
 #include "trace.h"
 #include "transaction.h"
 #include "utils.h"
@@ -246,6 +254,7 @@ Runtime::Runtime()
       system_thread_group_(nullptr),
       system_class_loader_(nullptr),
       dump_gc_performance_on_shutdown_(false),
+      dump_startup_timeline_(false),
       preinitialization_transactions_(),
       verify_(verifier::VerifyMode::kNone),
       allow_dex_file_fallback_(true),
@@ -353,6 +362,10 @@ Runtime::~Runtime() {
     // JIT compiler threads.
     jit_->DeleteThreadPool();
   }
+  if (startup_class_initializer_ != nullptr) {
+    ScopedTrace trace2("Delete startup class initializer");
+    startup_class_initializer_.reset();
+  }
 
   // Make sure our internal threads are dead before we start tearing down things they're using.
   GetRuntimeCallbacks()->StopDebugger();
@@ -405,6 +418,8 @@ Runtime::~Runtime() {
   arena_pool_.reset();
   jit_arena_pool_.reset();
   protected_fault_page_.reset();
+  runtime_counters_.reset();
+  timing_trace_.reset();
   MemMap::Shutdown();
 
   // TODO: acquire a static mutex on Runtime to avoid racing.
@@ -578,23 +593,132 @@ void Runtime::CallExitHook(jint status) {
   }
 }
 
-void Runtime::SweepSystemWeaks(IsMarkedVisitor* visitor) {
-  GetInternTable()->SweepInternTableWeaks(visitor);
-  GetMonitorList()->SweepMonitorList(visitor);
-  GetJavaVM()->SweepJniWeakGlobals(visitor);
-  GetHeap()->SweepAllocationRecords(visitor);
-  if (GetJit() != nullptr) {
-    // Visit JIT literal tables. Objects in these tables are classes and strings
-    // and only classes can be affected by class unloading. The strings always
-    // stay alive as they are strongly interned.
-    // TODO: Move this closer to CleanupClassLoaders, to avoid blocking weak accesses
-    // from mutators. See b/32167580.
-    GetJit()->GetCodeCache()->SweepRootTables(visitor);
+// The system weaks swept by SweepSystemWeaks(), before the generic system-weak holders.
+enum RuntimeSystemWeakSweep : size_t {
+  kSweepInternTable,
+  kSweepMonitorList,
+  kSweepJniWeakGlobals,
+  kSweepAllocationRecords,
+  kSweepJitRootTables,
+  kNumberOfRuntimeSystemWeakSweeps,
+};
+
+size_t Runtime::GetSystemWeakSweepCount() const {
+  return kNumberOfRuntimeSystemWeakSweeps + system_weak_holders_.size();
+}
+
+void Runtime::SweepSystemWeak(size_t index, IsMarkedVisitor* visitor) {
+  switch (index) {
+    case kSweepInternTable:
+      GetInternTable()->SweepInternTableWeaks(visitor);
+      break;
+    case kSweepMonitorList:
+      GetMonitorList()->SweepMonitorList(visitor);
+      break;
+    case kSweepJniWeakGlobals:
+      GetJavaVM()->SweepJniWeakGlobals(visitor);
+      break;
+    case kSweepAllocationRecords:
+      GetHeap()->SweepAllocationRecords(visitor);
+      break;
+    case kSweepJitRootTables:
+      if (GetJit() != nullptr) {
+        // Visit JIT literal tables. Objects in these tables are classes and strings
+        // and only classes can be affected by class unloading. The strings always
+        // stay alive as they are strongly interned.
+        // TODO: Move this closer to CleanupClassLoaders, to avoid blocking weak accesses
+        // from mutators. See b/32167580.
+        GetJit()->GetCodeCache()->SweepRootTables(visitor);
+      }
+      break;
+    default:
+      // All other generic system-weak holders.
+      system_weak_holders_[index - kNumberOfRuntimeSystemWeakSweeps]->Sweep(visitor);
+      break;
   }
+}
 
-  // All other generic system-weak holders.
-  for (gc::AbstractSystemWeakHolder* holder : system_weak_holders_) {
-    holder->Sweep(visitor);
+void Runtime::DumpSystemWeakSweepName(std::ostream& os, size_t index) const {
+  static const char* const kNames[] = {
+      "InternTable", "MonitorList", "JniWeakGlobals", "AllocationRecords", "JitRootTables" };
+  static_assert(arraysize(kNames) == kNumberOfRuntimeSystemWeakSweeps, "Missing sweep names");
+  if (index < kNumberOfRuntimeSystemWeakSweeps) {
+    os << kNames[index];
+  } else {
+    os << "SystemWeakHolder" << (index - kNumberOfRuntimeSystemWeakSweeps);
+  }
+}
+
+// Sweeps system weaks on a heap thread pool worker. The workers take the sweeps from a shared
+// index until all of them are done, and record the time of each.
+class Runtime::SweepSystemWeaksTask : public Task {
+ public:
+  SweepSystemWeaksTask(Runtime* runtime,
+                       IsMarkedVisitor* visitor,
+                       Atomic<size_t>* next_index,
+                       std::vector<uint64_t>* sweep_ns)
+      : runtime_(runtime), visitor_(visitor), next_index_(next_index), sweep_ns_(sweep_ns) {}
+
+  // No thread safety analysis since multiple threads will use this task. The GC-running thread
+  // holds the mutator lock on behalf of the workers until it has waited for all the tasks.
+  virtual void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    while (true) {
+      const size_t index = next_index_->FetchAndAddSequentiallyConsistent(1);
+      if (index >= sweep_ns_->size()) {
+        break;
+      }
+      ScopedTrace trace("SweepSystemWeak");
+      const uint64_t start_ns = NanoTime();
+      runtime_->SweepSystemWeak(index, visitor_);
+      (*sweep_ns_)[index] = NanoTime() - start_ns;
+    }
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  Runtime* const runtime_;
+  IsMarkedVisitor* const visitor_;
+  Atomic<size_t>* const next_index_;
+  // The time of each sweep, each element only written by the task that did the sweep.
+  std::vector<uint64_t>* const sweep_ns_;
+};
+
+void Runtime::SweepSystemWeaks(IsMarkedVisitor* visitor, size_t thread_count) {
+  const size_t sweep_count = GetSystemWeakSweepCount();
+  std::vector<uint64_t> sweep_ns(sweep_count, 0u);
+  ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+  const bool parallel = thread_count > 1u && thread_pool != nullptr;
+  if (parallel) {
+    Thread* self = Thread::Current();
+    Atomic<size_t> next_index(0u);
+    const size_t num_tasks =
+        std::min({thread_count, sweep_count, thread_pool->GetThreadCount() + 1u});
+    for (size_t i = 0; i < num_tasks; ++i) {
+      thread_pool->AddTask(self, new SweepSystemWeaksTask(this, visitor, &next_index, &sweep_ns));
+    }
+    // The GC-running thread also runs tasks while waiting.
+    thread_pool->SetMaxActiveWorkers(num_tasks - 1);
+    thread_pool->StartWorkers(self);
+    thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+    thread_pool->StopWorkers(self);
+  } else {
+    for (size_t i = 0; i < sweep_count; ++i) {
+      const uint64_t start_ns = NanoTime();
+      SweepSystemWeak(i, visitor);
+      sweep_ns[i] = NanoTime() - start_ns;
+    }
+  }
+  if (VLOG_IS_ON(gc)) {
+    std::ostringstream oss;
+    for (size_t i = 0; i < sweep_count; ++i) {
+      oss << " ";
+      DumpSystemWeakSweepName(oss, i);
+      oss << "=" << PrettyDuration(sweep_ns[i]);
+    }
+    LOG(INFO) << "SweepSystemWeaks" << (parallel ? " (parallel)" : "") << ":" << oss.str();
   }
 }
 
@@ -706,6 +830,7 @@ std::string Runtime::GetCompilerExecutable() const {
 
 bool Runtime::Start() {
   VLOG(startup) << "Runtime::Start entering";
+  startup_timeline_->BeginPhase("Runtime::Start");
 
   CHECK(!no_sig_chain_) << "A started runtime should have sig chain enabled";
 
@@ -725,6 +850,7 @@ bool Runtime::Start() {
   started_ = true;
 
   if (!IsImageDex2OatEnabled() || !GetHeap()->HasBootImageSpace()) {
+    ScopedStartupPhase phase(startup_timeline_.get(), "InitializeClassClasses");
     ScopedObjectAccess soa(self);
     StackHandleScope<2> hs(soa.Self());
 
@@ -739,7 +865,7 @@ bool Runtime::Start() {
   // InitNativeMethods needs to be after started_ so that the classes
   // it touches will have methods linked to the oat file if necessary.
   {
-    ScopedTrace trace2("InitNativeMethods");
+    ScopedStartupPhase phase(startup_timeline_.get(), "InitNativeMethods");
     InitNativeMethods();
   }
 
@@ -751,7 +877,10 @@ bool Runtime::Start() {
   // Initialize well known thread group values that may be accessed threads while attaching.
   InitThreadGroups(self);
 
-  Thread::FinishStartup();
+  {
+    ScopedStartupPhase phase(startup_timeline_.get(), "Thread::FinishStartup");
+    Thread::FinishStartup();
+  }
 
   // Create the JIT either if we have to use JIT compilation or save profiling info. This is
   // done after FinishStartup as the JIT pool needs Java thread peers, which require the main
@@ -765,8 +894,13 @@ bool Runtime::Start() {
     if (!IsZygote()) {
     // If we are the zygote then we need to wait until after forking to create the code cache
     // due to SELinux restrictions on r/w/x memory regions.
+      ScopedStartupPhase phase(startup_timeline_.get(), "CreateJit");
       CreateJit();
+      if (jit_ != nullptr) {
+        jit_->WaitForWorkersToBeCreated();
+      }
     } else if (jit_options_->UseJitCompilation()) {
+      ScopedStartupPhase phase(startup_timeline_.get(), "LoadJitCompiler");
       if (!jit::Jit::LoadCompilerLibrary(&error_msg)) {
         // Try to load compiler pre zygote to reduce PSS. b/27744947
         LOG(WARNING) << "Failed to load JIT compiler with error " << error_msg;
@@ -781,7 +915,16 @@ bool Runtime::Start() {
     callbacks_->NextRuntimePhase(RuntimePhaseCallback::RuntimePhase::kStart);
   }
 
-  system_class_loader_ = CreateSystemClassLoader(this);
+  {
+    ScopedStartupPhase phase(startup_timeline_.get(), "CreateSystemClassLoader");
+    system_class_loader_ = CreateSystemClassLoader(this);
+  }
+
+  // Forking the zygote requires it to be single threaded.
+  if (!startup_class_init_profile_.empty() && !is_zygote_ && startup_class_init_threads_ != 0u) {
+    startup_class_initializer_.reset(new StartupClassInitializer(startup_class_init_threads_));
+    startup_class_initializer_->Start(self, startup_class_init_profile_, system_class_loader_);
+  }
 
   if (!is_zygote_) {
     if (is_native_bridge_loaded_) {
@@ -790,6 +933,7 @@ bool Runtime::Start() {
     NativeBridgeAction action = force_native_bridge_
         ? NativeBridgeAction::kInitialize
         : NativeBridgeAction::kUnload;
+    ScopedStartupPhase phase(startup_timeline_.get(), "InitNonZygoteOrPostFork");
     InitNonZygoteOrPostFork(self->GetJniEnv(),
                             /* is_system_server */ false,
                             action,
@@ -803,13 +947,24 @@ bool Runtime::Start() {
     callbacks_->NextRuntimePhase(RuntimePhaseCallback::RuntimePhase::kInit);
   }
 
-  StartDaemonThreads();
+  {
+    ScopedStartupPhase phase(startup_timeline_.get(), "StartDaemonThreads");
+    StartDaemonThreads();
+  }
 
   {
     ScopedObjectAccess soa(self);
     self->GetJniEnv()->AssertLocalsEmpty();
   }
 
+  startup_timeline_->EndPhase();
+  startup_timeline_->Finish();
+  if (dump_startup_timeline_ || VLOG_IS_ON(startup)) {
+    std::ostringstream oss;
+    startup_timeline_->Dump(oss);
+    LOG(INFO) << oss.str();
+  }
+
   VLOG(startup) << "Runtime::Start exiting";
   finished_starting_ = true;
 
@@ -852,23 +1007,42 @@ void Runtime::InitNonZygoteOrPostFork(
     }
   }
 
-  // Create the thread pools.
-  heap_->CreateThreadPool();
+  const uint64_t start_ns = NanoTime();
+
   // Reset the gc performance data at zygote fork so that the GCs
   // before fork aren't attributed to an app.
   heap_->ResetGcPerformanceInfo();
 
-  // We may want to collect profiling samples for system server, but we never want to JIT there.
-  if ((!is_system_server || !jit_options_->UseJitCompilation()) &&
-      !safe_mode_ &&
-      (jit_options_->UseJitCompilation() || jit_options_->GetSaveProfilingInfo()) &&
-      jit_ == nullptr) {
-    // Note that when running ART standalone (not zygote, nor zygote fork),
-    // the jit may have already been created.
-    CreateJit();
-  }
+  // Attaching a thread to the runtime takes much longer than creating it, so the JIT workers and
+  // the signal catcher attach in the background while the rest is set up, and we wait for all of
+  // them at the end rather than for each one in turn.
+  {
+    ScopedTrace trace("Start runtime threads");
+    // We may want to collect profiling samples for system server, but we never want to JIT
+    // there.
+    if ((!is_system_server || !jit_options_->UseJitCompilation()) &&
+        !safe_mode_ &&
+        (jit_options_->UseJitCompilation() || jit_options_->GetSaveProfilingInfo()) &&
+        jit_ == nullptr) {
+      // Note that when running ART standalone (not zygote, nor zygote fork),
+      // the jit may have already been created.
+      CreateJit();
+    }
 
-  StartSignalCatcher();
+    StartSignalCatcher();
+
+    // Create the thread pools. The heap pool waits for its own workers.
+    heap_->CreateThreadPool();
+
+    if (jit_ != nullptr) {
+      jit_->WaitForWorkersToBeCreated();
+    }
+    if (signal_catcher_ != nullptr) {
+      signal_catcher_->WaitUntilStarted();
+    }
+  }
+  VLOG(startup) << "Started the runtime threads in "
+                << PrettyDuration(NanoTime() - start_ns);
 
   // Start the JDWP thread. If the command-line debugger flags specified "suspend=y",
   // this will pause the runtime (in the internal debugger implementation), so we probably want
@@ -1065,7 +1239,27 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   ScopedTrace trace(__FUNCTION__);
   CHECK_EQ(sysconf(_SC_PAGE_SIZE), kPageSize);
 
+  startup_timeline_.reset(new StartupTimeline());
+  ScopedStartupPhase init_phase(startup_timeline_.get(), "Runtime::Init");
+  dump_startup_timeline_ = runtime_options.Exists(Opt::DumpStartupTimeline);
+
   MemMap::Init();
+  // Before the heap and the JIT code cache are mapped.
+  MemMap::SetTransparentHugePagesEnabled(runtime_options.Exists(Opt::TransparentHugePages));
+  // Before the class linker, monitors and JIT count their first events.
+  runtime_counters_.reset(
+      RuntimeCounters::Create(runtime_options.GetOrDefault(Opt::RuntimeCountersFile)));
+  if (runtime_options.Exists(Opt::TraceCategories)) {
+    std::string error_msg;
+    if (!ParseTraceCategories(runtime_options.GetOrDefault(Opt::TraceCategories),
+                              &gEnabledTraceCategories,
+                              &error_msg)) {
+      LOG(WARNING) << "Ignoring -XX:TraceCategories: " << error_msg;
+    }
+  }
+  if (runtime_options.Exists(Opt::TimingTraceFile)) {
+    timing_trace_.reset(TimingTrace::Create(runtime_options.GetOrDefault(Opt::TimingTraceFile)));
+  }
 
   // Try to reserve a dedicated fault page. This is allocated for clobbered registers and sentinels.
   // If we cannot reserve it, log a warning.
@@ -1156,6 +1350,9 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
 
   fingerprint_ = runtime_options.ReleaseOrDefault(Opt::Fingerprint);
 
+  startup_class_init_profile_ = runtime_options.ReleaseOrDefault(Opt::StartupClassInitProfile);
+  startup_class_init_threads_ = runtime_options.GetOrDefault(Opt::StartupClassInitThreads);
+
   if (runtime_options.GetOrDefault(Opt::Interpret)) {
     GetInstrumentation()->ForceInterpretOnly();
   }
@@ -1182,39 +1379,51 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
             kExtraDefaultHeapGrowthMultiplier;
   }
   XGcOption xgc_option = runtime_options.GetOrDefault(Opt::GcOption);
-  heap_ = new gc::Heap(runtime_options.GetOrDefault(Opt::MemoryInitialSize),
-                       runtime_options.GetOrDefault(Opt::HeapGrowthLimit),
-                       runtime_options.GetOrDefault(Opt::HeapMinFree),
-                       runtime_options.GetOrDefault(Opt::HeapMaxFree),
-                       runtime_options.GetOrDefault(Opt::HeapTargetUtilization),
-                       foreground_heap_growth_multiplier,
-                       runtime_options.GetOrDefault(Opt::MemoryMaximumSize),
-                       runtime_options.GetOrDefault(Opt::NonMovingSpaceCapacity),
-                       runtime_options.GetOrDefault(Opt::Image),
-                       runtime_options.GetOrDefault(Opt::ImageInstructionSet),
-                       // Override the collector type to CC if the read barrier config.
-                       kUseReadBarrier ? gc::kCollectorTypeCC : xgc_option.collector_type_,
-                       kUseReadBarrier ? BackgroundGcOption(gc::kCollectorTypeCCBackground)
-                                       : runtime_options.GetOrDefault(Opt::BackgroundGc),
-                       runtime_options.GetOrDefault(Opt::LargeObjectSpace),
-                       runtime_options.GetOrDefault(Opt::LargeObjectThreshold),
-                       runtime_options.GetOrDefault(Opt::ParallelGCThreads),
-                       runtime_options.GetOrDefault(Opt::ConcGCThreads),
-                       runtime_options.Exists(Opt::LowMemoryMode),
-                       runtime_options.GetOrDefault(Opt::LongPauseLogThreshold),
-                       runtime_options.GetOrDefault(Opt::LongGCLogThreshold),
-                       runtime_options.Exists(Opt::IgnoreMaxFootprint),
-                       runtime_options.GetOrDefault(Opt::UseTLAB),
-                       xgc_option.verify_pre_gc_heap_,
-                       xgc_option.verify_pre_sweeping_heap_,
-                       xgc_option.verify_post_gc_heap_,
-                       xgc_option.verify_pre_gc_rosalloc_,
-                       xgc_option.verify_pre_sweeping_rosalloc_,
-                       xgc_option.verify_post_gc_rosalloc_,
-                       xgc_option.gcstress_,
-                       xgc_option.measure_,
-                       runtime_options.GetOrDefault(Opt::EnableHSpaceCompactForOOM),
-                       runtime_options.GetOrDefault(Opt::HSpaceCompactForOOMMinIntervalsMs));
+  {
+    ScopedStartupPhase phase(startup_timeline_.get(), "Heap");
+    heap_ = new gc::Heap(runtime_options.GetOrDefault(Opt::MemoryInitialSize),
+                         runtime_options.GetOrDefault(Opt::HeapGrowthLimit),
+                         runtime_options.GetOrDefault(Opt::HeapMinFree),
+                         runtime_options.GetOrDefault(Opt::HeapMaxFree),
+                         runtime_options.GetOrDefault(Opt::HeapTargetUtilization),
+                         foreground_heap_growth_multiplier,
+                         runtime_options.GetOrDefault(Opt::MemoryMaximumSize),
+                         runtime_options.GetOrDefault(Opt::NonMovingSpaceCapacity),
+                         runtime_options.GetOrDefault(Opt::Image),
+                         runtime_options.GetOrDefault(Opt::ImageInstructionSet),
+                         // Override the collector type to CC if the read barrier config.
+                         kUseReadBarrier ? gc::kCollectorTypeCC : xgc_option.collector_type_,
+                         kUseReadBarrier ? BackgroundGcOption(gc::kCollectorTypeCCBackground)
+                                         : runtime_options.GetOrDefault(Opt::BackgroundGc),
+                         runtime_options.GetOrDefault(Opt::LargeObjectSpace),
+                         runtime_options.GetOrDefault(Opt::LargeObjectThreshold),
+                         runtime_options.GetOrDefault(Opt::ParallelGCThreads),
+                         runtime_options.GetOrDefault(Opt::ConcGCThreads),
+                         runtime_options.Exists(Opt::LowMemoryMode),
+                         runtime_options.GetOrDefault(Opt::LongPauseLogThreshold),
+                         runtime_options.GetOrDefault(Opt::LongGCLogThreshold),
+                         runtime_options.GetOrDefault(Opt::GcPauseTarget),
+                         runtime_options.GetOrDefault(Opt::GcCpuBudgetPercent),
+                         runtime_options.GetOrDefault(Opt::AllocSampleInterval),
+                         runtime_options.GetOrDefault(Opt::HeapTrimReleaseBudget),
+                         runtime_options.Exists(Opt::NumaAwareHeap),
+                         runtime_options.GetOrDefault(Opt::GcMetricsFile),
+                         runtime_options.Exists(Opt::IgnoreMaxFootprint),
+                         runtime_options.GetOrDefault(Opt::UseTLAB),
+                         xgc_option.verify_pre_gc_heap_,
+                         xgc_option.verify_pre_sweeping_heap_,
+                         xgc_option.verify_post_gc_heap_,
+                         xgc_option.verify_pre_gc_rosalloc_,
+                         xgc_option.verify_pre_sweeping_rosalloc_,
+                         xgc_option.verify_post_gc_rosalloc_,
+                         xgc_option.gcstress_,
+                         xgc_option.measure_,
+                         xgc_option.generational_cc_,
+                         xgc_option.class_histogram_,
+                         xgc_option.measure_tlb_misses_,
+                         runtime_options.GetOrDefault(Opt::EnableHSpaceCompactForOOM),
+                         runtime_options.GetOrDefault(Opt::HSpaceCompactForOOMMinIntervalsMs));
+  }
 
   if (!heap_->HasBootImageSpace() && !allow_dex_file_fallback_) {
     LOG(ERROR) << "Dex file fallback disabled, cannot continue without image.";
@@ -1323,7 +1532,10 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   }
 
   std::string error_msg;
-  java_vm_ = JavaVMExt::Create(this, runtime_options, &error_msg);
+  {
+    ScopedStartupPhase phase(startup_timeline_.get(), "JavaVMExt::Create");
+    java_vm_ = JavaVMExt::Create(this, runtime_options, &error_msg);
+  }
   if (java_vm_.get() == nullptr) {
     LOG(ERROR) << "Could not initialize JavaVMExt: " << error_msg;
     return false;
@@ -1357,7 +1569,11 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
     class_linker_ = new ClassLinker(intern_table_);
   }
   if (GetHeap()->HasBootImageSpace()) {
-    bool result = class_linker_->InitFromBootImage(&error_msg);
+    bool result;
+    {
+      ScopedStartupPhase phase(startup_timeline_.get(), "ClassLinker::InitFromBootImage");
+      result = class_linker_->InitFromBootImage(&error_msg);
+    }
     if (!result) {
       LOG(ERROR) << "Could not initialize from image: " << error_msg;
       return false;
@@ -1378,7 +1594,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
       boot_class_path_string_ = android::base::Join(dex_locations, ':');
     }
     {
-      ScopedTrace trace2("AddImageStringsToTable");
+      ScopedStartupPhase phase(startup_timeline_.get(), "AddImageStringsToTable");
       GetInternTable()->AddImagesStringsToTable(heap_->GetBootImageSpaces());
     }
     if (IsJavaDebuggable()) {
@@ -1408,7 +1624,12 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
                    &boot_class_path);
     }
     instruction_set_ = runtime_options.GetOrDefault(Opt::ImageInstructionSet);
-    if (!class_linker_->InitWithoutImage(std::move(boot_class_path), &error_msg)) {
+    bool result;
+    {
+      ScopedStartupPhase phase(startup_timeline_.get(), "ClassLinker::InitWithoutImage");
+      result = class_linker_->InitWithoutImage(std::move(boot_class_path), &error_msg);
+    }
+    if (!result) {
       LOG(ERROR) << "Could not initialize without image: " << error_msg;
       return false;
     }
@@ -1457,10 +1678,13 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   // Runtime initialization is largely done now.
   // We load plugins first since that can modify the runtime state slightly.
   // Load all plugins
-  for (auto& plugin : plugins_) {
-    std::string err;
-    if (!plugin.Load(&err)) {
-      LOG(FATAL) << plugin << " failed to load: " << err;
+  {
+    ScopedStartupPhase phase(startup_timeline_.get(), "LoadPlugins");
+    for (auto& plugin : plugins_) {
+      std::string err;
+      if (!plugin.Load(&err)) {
+        LOG(FATAL) << plugin << " failed to load: " << err;
+      }
     }
   }
 
@@ -1498,15 +1722,18 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
 
   // Startup agents
   // TODO Maybe we should start a new thread to run these on. Investigate RI behavior more.
-  for (auto& agent : agents_) {
-    // TODO Check err
-    int res = 0;
-    std::string err = "";
-    ti::Agent::LoadError result = agent.Load(&res, &err);
-    if (result == ti::Agent::kInitializationError) {
-      LOG(FATAL) << "Unable to initialize agent!";
-    } else if (result != ti::Agent::kNoError) {
-      LOG(ERROR) << "Unable to load an agent: " << err;
+  {
+    ScopedStartupPhase phase(startup_timeline_.get(), "LoadAgents");
+    for (auto& agent : agents_) {
+      // TODO Check err
+      int res = 0;
+      std::string err = "";
+      ti::Agent::LoadError result = agent.Load(&res, &err);
+      if (result == ti::Agent::kInitializationError) {
+        LOG(FATAL) << "Unable to initialize agent!";
+      } else if (result != ti::Agent::kNoError) {
+        LOG(ERROR) << "Unable to load an agent: " << err;
+      }
     }
   }
   {
@@ -1590,18 +1817,23 @@ void Runtime::InitNativeMethods() {
 
   // Initialize classes used in JNI. The initialization requires runtime native
   // methods to be loaded first.
-  WellKnownClasses::Init(env);
+  {
+    ScopedStartupPhase phase(startup_timeline_.get(), "WellKnownClasses::Init");
+    WellKnownClasses::Init(env);
+  }
 
   // Then set up libjavacore / libopenjdk, which are just a regular JNI libraries with
   // a regular JNI_OnLoad. Most JNI libraries can just use System.loadLibrary, but
   // libcore can't because it's the library that implements System.loadLibrary!
   {
+    ScopedStartupPhase phase(startup_timeline_.get(), "LoadNativeLibrary libjavacore");
     std::string error_msg;
     if (!java_vm_->LoadNativeLibrary(env, "libjavacore.so", nullptr, nullptr, &error_msg)) {
       LOG(FATAL) << "LoadNativeLibrary failed for \"libjavacore.so\": " << error_msg;
     }
   }
   {
+    ScopedStartupPhase phase(startup_timeline_.get(), "LoadNativeLibrary libopenjdk");
     constexpr const char* kOpenJdkLibrary = kIsDebugBuild
                                                 ? "libopenjdkd.so"
                                                 : "libopenjdk.so";
@@ -1612,7 +1844,10 @@ void Runtime::InitNativeMethods() {
   }
 
   // Initialize well known classes that may invoke runtime native methods.
-  WellKnownClasses::LateInit(env);
+  {
+    ScopedStartupPhase phase(startup_timeline_.get(), "WellKnownClasses::LateInit");
+    WellKnownClasses::LateInit(env);
+  }
 
   VLOG(startup) << "Runtime::InitNativeMethods exiting";
 }
@@ -1712,11 +1947,16 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
     os << "Running non JIT\n";
   }
   DumpDeoptimizations(os);
+  runtime_counters_->Dump(os);
+  if (finished_starting_) {
+    startup_timeline_->Dump(os);
+  }
   TrackedAllocators::Dump(os);
   os << "\n";
 
   thread_list_->DumpForSigQuit(os);
   BaseMutex::DumpAll(os);
+  Monitor::DumpContentionProfile(os);
 
   // Inform anyone else who is interested in SigQuit.
   {
@@ -1890,6 +2130,7 @@ void Runtime::VisitConcurrentRoots(RootVisitor* visitor, VisitRootFlags flags) {
   intern_table_->VisitRoots(visitor, flags);
   class_linker_->VisitRoots(visitor, flags);
   heap_->VisitAllocationRecords(visitor);
+  heap_->GetAllocationSampler()->VisitRoots(visitor);
   if ((flags & kVisitRootFlagNewRoots) == 0) {
     // Guaranteed to have no new roots in the constant roots.
     VisitConstantRoots(visitor);
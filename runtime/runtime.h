@@ -89,10 +89,14 @@ class OatFileManager;
 class Plugin;
 struct RuntimeArgumentMap;
 class RuntimeCallbacks;
+class RuntimeCounters;
 class SignalCatcher;
 class StackOverflowHandler;
+class StartupClassInitializer;
+class StartupTimeline;
 class SuspensionHandler;
 class ThreadList;
+class TimingTrace;
 class Trace;
 struct TraceConfig;
 class Transaction;
@@ -280,6 +284,21 @@ class Runtime {
     return monitor_pool_;
   }
 
+  // The always-on event counters, see RuntimeCounters. Never null after Init().
+  RuntimeCounters* GetRuntimeCounters() const {
+    return runtime_counters_.get();
+  }
+
+  // The ring buffer of the TimingLogger splits, null unless -XX:TimingTraceFile is set.
+  TimingTrace* GetTimingTrace() const {
+    return timing_trace_.get();
+  }
+
+  // The phases of Init() and Start(), see StartupTimeline. Never null after Init() begins.
+  StartupTimeline* GetStartupTimeline() const {
+    return startup_timeline_.get();
+  }
+
   // Is the given object the special object used to mark a cleared JNI weak global?
   bool IsClearedJniWeakGlobal(ObjPtr<mirror::Object> obj) REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -338,8 +357,11 @@ class Runtime {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Sweep system weaks, the system weak is deleted if the visitor return null. Otherwise, the
-  // system weak is updated to be the visitor's returned value.
-  void SweepSystemWeaks(IsMarkedVisitor* visitor)
+  // system weak is updated to be the visitor's returned value. With a thread_count above one,
+  // the intern table, monitor list, JNI weak globals, allocation records, JIT roots and each
+  // system-weak holder are swept in parallel on the heap thread pool, which only the GC-running
+  // thread may do. The visitor must then be safe to call from several threads.
+  void SweepSystemWeaks(IsMarkedVisitor* visitor, size_t thread_count = 1u)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Returns a special method that calls into a trampoline for runtime method resolution
@@ -735,6 +757,14 @@ class Runtime {
   void VisitConstantRoots(RootVisitor* visitor)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  class SweepSystemWeaksTask;
+
+  // Sweeps one of the system weaks swept by SweepSystemWeaks(), by index.
+  size_t GetSystemWeakSweepCount() const;
+  void SweepSystemWeak(size_t index, IsMarkedVisitor* visitor)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+  void DumpSystemWeakSweepName(std::ostream& os, size_t index) const;
+
   // A pointer to the active runtime or null.
   static Runtime* instance_;
 
@@ -802,6 +832,10 @@ class Runtime {
   MonitorList* monitor_list_;
   MonitorPool* monitor_pool_;
 
+  std::unique_ptr<RuntimeCounters> runtime_counters_;
+  std::unique_ptr<TimingTrace> timing_trace_;
+  std::unique_ptr<StartupTimeline> startup_timeline_;
+
   ThreadList* thread_list_;
 
   InternTable* intern_table_;
@@ -823,6 +857,12 @@ class Runtime {
   std::unique_ptr<jit::Jit> jit_;
   std::unique_ptr<jit::JitOptions> jit_options_;
 
+  // The profile whose startup classes are initialized in the background, if any, and the
+  // threads initializing them.
+  std::string startup_class_init_profile_;
+  unsigned int startup_class_init_threads_;
+  std::unique_ptr<StartupClassInitializer> startup_class_initializer_;
+
   // Fault message, printed when we get a SIGSEGV.
   Mutex fault_message_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
   std::string fault_message_ GUARDED_BY(fault_message_lock_);
@@ -870,6 +910,9 @@ class Runtime {
   // If true, then we dump the GC cumulative timings on shutdown.
   bool dump_gc_performance_on_shutdown_;
 
+  // If true, then we log the startup timeline once Start() is done.
+  bool dump_startup_timeline_;
+
   // Transactions used for pre-initializing classes at compilation time.
   // Support nested transactions, maintain a list containing all transactions. Transactions are
   // handled under a stack discipline. Because GC needs to go over all transactions, we choose list
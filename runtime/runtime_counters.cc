@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime_counters.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <ostream>
+
+#include "android-base/unique_fd.h"
+
+#include "base/bit_utils.h"
+#include "base/logging.h"
+#include "globals.h"
+#include "mem_map.h"
+#include "thread.h"
+
+namespace art {
+
+using android::base::unique_fd;
+
+constexpr uint32_t RuntimeCounters::kMagic;
+constexpr uint32_t RuntimeCounters::kVersion;
+constexpr size_t RuntimeCounters::kNumShards;
+
+// Keep the shards on separate cache lines.
+static constexpr size_t kShardAlignment = 64u;
+static constexpr size_t kShardsOffset = RoundUp(sizeof(RuntimeCountersHeader), kShardAlignment);
+static constexpr size_t kShardSize = RoundUp(sizeof(RuntimeCountersShard), kShardAlignment);
+static constexpr size_t kCountersSize = kShardsOffset + RuntimeCounters::kNumShards * kShardSize;
+
+static const char* const kCounterNames[] = {
+  "Classes defined",
+  "Types resolved",
+  "Methods resolved",
+  "Fields resolved",
+  "Monitors inflated",
+  "Deoptimizations",
+  "JIT compilations",
+  "JIT failures",
+};
+static_assert(arraysize(kCounterNames) == kCounterCount, "Missing counter name");
+
+static const char* const kTimingNames[] = {
+  "Class define time",
+  "JIT compile time",
+};
+static_assert(arraysize(kTimingNames) == kTimingCount, "Missing timing name");
+
+void RuntimeCountersHistogram::AddValue(uint64_t value) {
+  const size_t bucket = (value == 0u)
+      ? 0u
+      : std::min(static_cast<size_t>(MinimumBitsToStore(value)), kNumBuckets - 1u);
+  buckets[bucket].FetchAndAddRelaxed(1u);
+  count.FetchAndAddRelaxed(1u);
+  sum.FetchAndAddRelaxed(value);
+}
+
+static MemMap* MapCountersFile(const std::string& file_name, size_t size, std::string* error_msg) {
+  // Readable by the monitoring agents, the counters don't contain anything about the app's data.
+  unique_fd fd(TEMP_FAILURE_RETRY(open(file_name.c_str(),
+                                       O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                       0644)));
+  if (fd.get() == -1) {
+    *error_msg = "Failed to open: " + std::string(strerror(errno));
+    return nullptr;
+  }
+  if (TEMP_FAILURE_RETRY(ftruncate(fd.get(), size)) != 0) {
+    *error_msg = "Failed to resize: " + std::string(strerror(errno));
+    return nullptr;
+  }
+  return MemMap::MapFile(size,
+                         PROT_READ | PROT_WRITE,
+                         MAP_SHARED,
+                         fd.get(),
+                         /* start */ 0,
+                         /* low_4gb */ false,
+                         file_name.c_str(),
+                         error_msg);
+}
+
+RuntimeCounters* RuntimeCounters::Create(const std::string& file_name) {
+  const size_t size = RoundUp(kCountersSize, kPageSize);
+  std::string error_msg;
+  MemMap* mem_map = nullptr;
+  if (!file_name.empty()) {
+    mem_map = MapCountersFile(file_name, size, &error_msg);
+    if (mem_map == nullptr) {
+      LOG(WARNING) << "Failed to map runtime counters file " << file_name << ": " << error_msg;
+    }
+  }
+  const bool file_backed = mem_map != nullptr;
+  if (!file_backed) {
+    mem_map = MemMap::MapAnonymous("runtime counters",
+                                   nullptr,
+                                   size,
+                                   PROT_READ | PROT_WRITE,
+                                   /* low_4gb */ false,
+                                   /* reuse */ false,
+                                   &error_msg);
+    CHECK(mem_map != nullptr) << "Failed to map runtime counters: " << error_msg;
+  }
+  return new RuntimeCounters(mem_map, file_backed ? file_name : "");
+}
+
+RuntimeCounters::RuntimeCounters(MemMap* mem_map, const std::string& file_name)
+    : mem_map_(mem_map), file_name_(file_name) {
+  // The file was truncated and the anonymous mapping is zeroed, so the counters start at 0.
+  RuntimeCountersHeader* header = GetHeader();
+  header->version = kVersion;
+  header->num_shards = kNumShards;
+  header->shard_size = kShardSize;
+  header->num_counters = kCounterCount;
+  header->num_timings = kTimingCount;
+  // Write the magic last so that a reader knows the rest of the header is valid once it sees it.
+  QuasiAtomic::ThreadFenceRelease();
+  header->magic = kMagic;
+}
+
+RuntimeCounters::~RuntimeCounters() {}
+
+RuntimeCountersHeader* RuntimeCounters::GetHeader() const {
+  return reinterpret_cast<RuntimeCountersHeader*>(mem_map_->Begin());
+}
+
+RuntimeCountersShard* RuntimeCounters::GetShard(size_t index) const {
+  DCHECK_LT(index, kNumShards);
+  return reinterpret_cast<RuntimeCountersShard*>(
+      mem_map_->Begin() + kShardsOffset + index * kShardSize);
+}
+
+RuntimeCountersShard* RuntimeCounters::GetShard(Thread* self) const {
+  // The tids of the threads started one after the other are consecutive.
+  return GetShard(self != nullptr ? static_cast<size_t>(self->GetTid()) % kNumShards : 0u);
+}
+
+void RuntimeCounters::Increment(Thread* self, RuntimeCounter counter) {
+  GetShard(self)->counters[counter].FetchAndAddRelaxed(1u);
+}
+
+void RuntimeCounters::AddTiming(Thread* self, RuntimeTiming timing, uint64_t time_us) {
+  GetShard(self)->histograms[timing].AddValue(time_us);
+}
+
+uint64_t RuntimeCounters::GetCount(RuntimeCounter counter) const {
+  uint64_t count = 0u;
+  for (size_t i = 0; i < kNumShards; ++i) {
+    count += GetShard(i)->counters[counter].LoadRelaxed();
+  }
+  return count;
+}
+
+uint64_t RuntimeCounters::GetTimingCount(RuntimeTiming timing) const {
+  uint64_t count = 0u;
+  for (size_t i = 0; i < kNumShards; ++i) {
+    count += GetShard(i)->histograms[timing].count.LoadRelaxed();
+  }
+  return count;
+}
+
+uint64_t RuntimeCounters::GetTimingSum(RuntimeTiming timing) const {
+  uint64_t sum = 0u;
+  for (size_t i = 0; i < kNumShards; ++i) {
+    sum += GetShard(i)->histograms[timing].sum.LoadRelaxed();
+  }
+  return sum;
+}
+
+void RuntimeCounters::Dump(std::ostream& os) const {
+  for (uint32_t i = 0; i < kCounterCount; ++i) {
+    const uint64_t count = GetCount(static_cast<RuntimeCounter>(i));
+    if (count != 0u) {
+      os << kCounterNames[i] << ": " << count << "\n";
+    }
+  }
+  for (uint32_t i = 0; i < kTimingCount; ++i) {
+    const RuntimeTiming timing = static_cast<RuntimeTiming>(i);
+    const uint64_t count = GetTimingCount(timing);
+    if (count == 0u) {
+      continue;
+    }
+    const uint64_t sum = GetTimingSum(timing);
+    os << kTimingNames[i] << ": count=" << count << " sum=" << sum << "us"
+       << " mean=" << sum / count << "us buckets=";
+    for (size_t bucket = 0; bucket < RuntimeCountersHistogram::kNumBuckets; ++bucket) {
+      uint64_t bucket_count = 0u;
+      for (size_t shard = 0; shard < kNumShards; ++shard) {
+        bucket_count += GetShard(shard)->histograms[timing].buckets[bucket].LoadRelaxed();
+      }
+      if (bucket_count != 0u) {
+        // The values of bucket i are below 2^i, but the last bucket is open ended.
+        os << "<" << (UINT64_C(1) << bucket) << "us:" << bucket_count << " ";
+      }
+    }
+    os << "\n";
+  }
+}
+
+const char* RuntimeCounters::GetCounterName(RuntimeCounter counter) {
+  DCHECK_LT(counter, kCounterCount);
+  return kCounterNames[counter];
+}
+
+const char* RuntimeCounters::GetTimingName(RuntimeTiming timing) {
+  DCHECK_LT(timing, kTimingCount);
+  return kTimingNames[timing];
+}
+
+}  // namespace art
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_RUNTIME_COUNTERS_H_
+#define ART_RUNTIME_RUNTIME_COUNTERS_H_
+
+#include <stdint.h>
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+#include "atomic.h"
+#include "base/macros.h"
+
+namespace art {
+
+class MemMap;
+class Thread;
+
+// The events counted by RuntimeCounters. The values are part of the exported layout, only
+// append to this list.
+enum RuntimeCounter : uint32_t {
+  kCounterClassesDefined,     // Classes defined from a dex file.
+  kCounterTypesResolved,      // Types resolved that were not in the dex cache.
+  kCounterMethodsResolved,    // Methods resolved that were not in the dex cache.
+  kCounterFieldsResolved,     // Fields resolved that were not in the dex cache.
+  kCounterMonitorsInflated,   // Thin or unlocked lock words replaced by a monitor.
+  kCounterDeoptimizations,    // Deoptimizations of a single frame or of the whole stack.
+  kCounterJitCompilations,    // Successful JIT compilations.
+  kCounterJitFailures,        // Failed JIT compilations.
+  kCounterCount,
+};
+
+// The durations recorded by RuntimeCounters, in microseconds. The values are part of the exported
+// layout, only append to this list. The GC phases are in GcMetrics.
+enum RuntimeTiming : uint32_t {
+  kTimingClassDefine,   // Loading and linking a class defined from a dex file.
+  kTimingJitCompile,    // A JIT compilation, successful or not.
+  kTimingCount,
+};
+
+// A histogram with power of two buckets, bucket 0 counts the zeros and bucket i > 0 the values in
+// [2^(i-1), 2^i). The last bucket also counts all the larger values.
+struct RuntimeCountersHistogram {
+  static constexpr size_t kNumBuckets = 32;
+
+  void AddValue(uint64_t value);
+
+  Atomic<uint64_t> count;
+  Atomic<uint64_t> sum;
+  Atomic<uint64_t> buckets[kNumBuckets];
+};
+
+// The counters updated by a subset of the threads. Each shard starts on its own cache line, so
+// that threads of different shards don't share lines.
+struct RuntimeCountersShard {
+  Atomic<uint64_t> counters[kCounterCount];
+  RuntimeCountersHistogram histograms[kTimingCount];
+};
+
+// The start of the exported counters, followed by num_shards shards of shard_size bytes. The
+// value of a counter is the sum of its values in all the shards.
+struct RuntimeCountersHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t num_shards;
+  uint32_t shard_size;
+  uint32_t num_counters;
+  uint32_t num_timings;
+};
+
+// Always-on counters and duration histograms of runtime events. A thread only updates the shard
+// picked by its tid, with relaxed atomic adds, so the threads rarely contend on a cache line.
+// The events counted are much more expensive than an update, which is not inlined to keep this
+// header light. Like GcMetrics, the counters are kept in a mapping that may be backed by a file,
+// so that another process can read them with mmap() while the runtime is live.
+class RuntimeCounters {
+ public:
+  static constexpr uint32_t kMagic = 0x63747261;  // "artc" in little endian.
+  static constexpr uint32_t kVersion = 1;
+  static constexpr size_t kNumShards = 16;
+
+  // Maps the counters as a MAP_SHARED mapping of file_name if not empty, anonymously otherwise.
+  // Falls back to an anonymous mapping if the file can't be mapped.
+  static RuntimeCounters* Create(const std::string& file_name);
+  ~RuntimeCounters();
+
+  // Records an event of the thread self, which may be null.
+  void Increment(Thread* self, RuntimeCounter counter);
+  void AddTiming(Thread* self, RuntimeTiming timing, uint64_t time_us);
+
+  // The sum of the shards.
+  uint64_t GetCount(RuntimeCounter counter) const;
+  uint64_t GetTimingCount(RuntimeTiming timing) const;
+  uint64_t GetTimingSum(RuntimeTiming timing) const;
+
+  // Prints the non-zero counters and a summary of the histograms, one per line.
+  void Dump(std::ostream& os) const;
+
+  // The counters file, empty if the counters are not backed by a file.
+  const std::string& GetFileName() const {
+    return file_name_;
+  }
+
+  static const char* GetCounterName(RuntimeCounter counter);
+  static const char* GetTimingName(RuntimeTiming timing);
+
+ private:
+  RuntimeCounters(MemMap* mem_map, const std::string& file_name);
+
+  RuntimeCountersHeader* GetHeader() const;
+  RuntimeCountersShard* GetShard(size_t index) const;
+  RuntimeCountersShard* GetShard(Thread* self) const;
+
+  std::unique_ptr<MemMap> mem_map_;
+  const std::string file_name_;
+
+  DISALLOW_COPY_AND_ASSIGN(RuntimeCounters);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_RUNTIME_COUNTERS_H_
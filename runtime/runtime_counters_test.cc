@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "runtime_counters.h"
+
+#include <sstream>
+
+#include "common_runtime_test.h"
+#include "os.h"
+#include "thread.h"
+
+namespace art {
+
+class RuntimeCountersTest : public CommonRuntimeTest {};
+
+TEST_F(RuntimeCountersTest, CountsAndTimings) {
+  std::unique_ptr<RuntimeCounters> counters(RuntimeCounters::Create(""));
+  ASSERT_TRUE(counters != nullptr);
+  EXPECT_TRUE(counters->GetFileName().empty());
+  EXPECT_EQ(counters->GetCount(kCounterMonitorsInflated), 0u);
+
+  // The counts of the threads in different shards add up.
+  Thread* self = Thread::Current();
+  counters->Increment(self, kCounterMonitorsInflated);
+  counters->Increment(self, kCounterMonitorsInflated);
+  counters->Increment(nullptr, kCounterMonitorsInflated);
+  EXPECT_EQ(counters->GetCount(kCounterMonitorsInflated), 3u);
+  EXPECT_EQ(counters->GetCount(kCounterJitCompilations), 0u);
+
+  counters->AddTiming(self, kTimingJitCompile, 100u);
+  counters->AddTiming(nullptr, kTimingJitCompile, 300u);
+  EXPECT_EQ(counters->GetTimingCount(kTimingJitCompile), 2u);
+  EXPECT_EQ(counters->GetTimingSum(kTimingJitCompile), 400u);
+
+  std::ostringstream os;
+  counters->Dump(os);
+  EXPECT_NE(os.str().find("Monitors inflated: 3\n"), std::string::npos) << os.str();
+  EXPECT_NE(os.str().find("JIT compile time: count=2 sum=400us mean=200us"), std::string::npos)
+      << os.str();
+  EXPECT_EQ(os.str().find(RuntimeCounters::GetCounterName(kCounterJitCompilations)),
+            std::string::npos) << os.str();
+}
+
+TEST_F(RuntimeCountersTest, FileBacked) {
+  ScratchFile file;
+  std::unique_ptr<RuntimeCounters> counters(RuntimeCounters::Create(file.GetFilename()));
+  ASSERT_TRUE(counters != nullptr);
+  EXPECT_EQ(counters->GetFileName(), file.GetFilename());
+  // Another process sees the header through the file.
+  std::unique_ptr<File> reader(OS::OpenFileForReading(file.GetFilename().c_str()));
+  ASSERT_TRUE(reader != nullptr);
+  RuntimeCountersHeader header;
+  ASSERT_TRUE(reader->PreadFully(&header, sizeof(header), 0));
+  EXPECT_EQ(header.magic, RuntimeCounters::kMagic);
+  EXPECT_EQ(header.version, RuntimeCounters::kVersion);
+  EXPECT_EQ(header.num_shards, RuntimeCounters::kNumShards);
+  EXPECT_EQ(header.num_counters, static_cast<uint32_t>(kCounterCount));
+  EXPECT_EQ(header.num_timings, static_cast<uint32_t>(kTimingCount));
+  EXPECT_GE(header.shard_size, sizeof(RuntimeCountersShard));
+}
+
+}  // namespace art
@@ -90,7 +90,9 @@ SignalCatcher::SignalCatcher(const std::string& stack_trace_file,
 
   // Create a raw pthread; its start routine will attach to the runtime.
   CHECK_PTHREAD_CALL(pthread_create, (&pthread_, nullptr, &Run, this), "signal catcher thread");
+}
 
+void SignalCatcher::WaitUntilStarted() {
   Thread* self = Thread::Current();
   MutexLock mu(self, lock_);
   while (thread_ == nullptr) {
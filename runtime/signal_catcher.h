@@ -42,10 +42,16 @@ class SignalCatcher {
   // If false, all traces will be dumped to |stack_trace_file| if it's
   // non-empty. If |stack_trace_file| is empty, all traces will be written
   // to the log buffer.
+  //
+  // The thread attaches to the runtime in the background, see WaitUntilStarted().
   SignalCatcher(const std::string& stack_trace_file,
                 const bool use_tombstoned_stack_trace_fd);
   ~SignalCatcher();
 
+  // Waits for the thread to attach to the runtime. Must be called before the runtime may shut
+  // down. A SIGQUIT arriving earlier stays pending until the thread waits for it.
+  void WaitUntilStarted() REQUIRES(!lock_);
+
   void HandleSigQuit() REQUIRES(!Locks::mutator_lock_, !Locks::thread_list_lock_,
                                 !Locks::thread_suspend_count_lock_);
 
@@ -68,6 +68,9 @@ StackVisitor::StackVisitor(Thread* thread,
       num_frames_(num_frames),
       cur_depth_(0),
       current_inlining_depth_(0),
+      stack_map_frame_(nullptr),
+      stack_map_frame_pc_(0),
+      cur_code_info_(MemoryRegion()),
       context_(context),
       check_suspended_(check_suspended) {
   if (check_suspended_) {
@@ -75,15 +78,19 @@ StackVisitor::StackVisitor(Thread* thread,
   }
 }
 
-static InlineInfo GetCurrentInlineInfo(const OatQuickMethodHeader* method_header,
-                                       uintptr_t cur_quick_frame_pc)
-    REQUIRES_SHARED(Locks::mutator_lock_) {
-  uint32_t native_pc_offset = method_header->NativeQuickPcOffset(cur_quick_frame_pc);
-  CodeInfo code_info = method_header->GetOptimizedCodeInfo();
-  CodeInfoEncoding encoding = code_info.ExtractEncoding();
-  StackMap stack_map = code_info.GetStackMapForNativePcOffset(native_pc_offset, encoding);
-  DCHECK(stack_map.IsValid());
-  return code_info.GetInlineInfoOf(stack_map, encoding);
+void StackVisitor::DecodeCurrentStackMap() const {
+  DCHECK(cur_quick_frame_ != nullptr);
+  DCHECK(cur_oat_quick_method_header_ != nullptr);
+  DCHECK(cur_oat_quick_method_header_->IsOptimized());
+  if (stack_map_frame_ != cur_quick_frame_ || stack_map_frame_pc_ != cur_quick_frame_pc_) {
+    uint32_t native_pc_offset =
+        cur_oat_quick_method_header_->NativeQuickPcOffset(cur_quick_frame_pc_);
+    cur_code_info_ = cur_oat_quick_method_header_->GetOptimizedCodeInfo();
+    cur_encoding_ = cur_code_info_.ExtractEncoding();
+    cur_stack_map_ = cur_code_info_.GetStackMapForNativePcOffset(native_pc_offset, cur_encoding_);
+    stack_map_frame_ = cur_quick_frame_;
+    stack_map_frame_pc_ = cur_quick_frame_pc_;
+  }
 }
 
 ArtMethod* StackVisitor::GetMethod() const {
@@ -92,16 +99,15 @@ ArtMethod* StackVisitor::GetMethod() const {
   } else if (cur_quick_frame_ != nullptr) {
     if (IsInInlinedFrame()) {
       size_t depth_in_stack_map = current_inlining_depth_ - 1;
-      InlineInfo inline_info = GetCurrentInlineInfo(GetCurrentOatQuickMethodHeader(),
-                                                    cur_quick_frame_pc_);
-      const OatQuickMethodHeader* method_header = GetCurrentOatQuickMethodHeader();
-      CodeInfoEncoding encoding = method_header->GetOptimizedCodeInfo().ExtractEncoding();
-      MethodInfo method_info = method_header->GetOptimizedMethodInfo();
+      DecodeCurrentStackMap();
+      DCHECK(cur_stack_map_.IsValid());
+      InlineInfo inline_info = cur_code_info_.GetInlineInfoOf(cur_stack_map_, cur_encoding_);
+      MethodInfo method_info = GetCurrentOatQuickMethodHeader()->GetOptimizedMethodInfo();
       DCHECK(walk_kind_ != StackWalkKind::kSkipInlinedFrames);
       return GetResolvedMethod(*GetCurrentQuickFrame(),
                                method_info,
                                inline_info,
-                               encoding.inline_info.encoding,
+                               cur_encoding_.inline_info.encoding,
                                depth_in_stack_map);
     } else {
       return *cur_quick_frame_;
@@ -116,12 +122,20 @@ uint32_t StackVisitor::GetDexPc(bool abort_on_failure) const {
   } else if (cur_quick_frame_ != nullptr) {
     if (IsInInlinedFrame()) {
       size_t depth_in_stack_map = current_inlining_depth_ - 1;
-      const OatQuickMethodHeader* method_header = GetCurrentOatQuickMethodHeader();
-      CodeInfoEncoding encoding = method_header->GetOptimizedCodeInfo().ExtractEncoding();
-      return GetCurrentInlineInfo(GetCurrentOatQuickMethodHeader(), cur_quick_frame_pc_).
-          GetDexPcAtDepth(encoding.inline_info.encoding, depth_in_stack_map);
+      DecodeCurrentStackMap();
+      DCHECK(cur_stack_map_.IsValid());
+      return cur_code_info_.GetInlineInfoOf(cur_stack_map_, cur_encoding_).
+          GetDexPcAtDepth(cur_encoding_.inline_info.encoding, depth_in_stack_map);
     } else if (cur_oat_quick_method_header_ == nullptr) {
       return dex::kDexNoIndex;
+    } else if (cur_oat_quick_method_header_->IsOptimized()) {
+      DecodeCurrentStackMap();
+      if (cur_stack_map_.IsValid()) {
+        return cur_stack_map_.GetDexPc(cur_encoding_.stack_map.encoding);
+      }
+      // Let the method header report the failure.
+      return cur_oat_quick_method_header_->ToDexPc(
+          GetMethod(), cur_quick_frame_pc_, abort_on_failure);
     } else {
       return cur_oat_quick_method_header_->ToDexPc(
           GetMethod(), cur_quick_frame_pc_, abort_on_failure);
@@ -228,12 +242,10 @@ bool StackVisitor::GetVRegFromOptimizedCode(ArtMethod* m, uint16_t vreg, VRegKin
   CodeItemDataAccessor accessor(m);
   uint16_t number_of_dex_registers = accessor.RegistersSize();
   DCHECK_LT(vreg, number_of_dex_registers);
-  const OatQuickMethodHeader* method_header = GetCurrentOatQuickMethodHeader();
-  CodeInfo code_info = method_header->GetOptimizedCodeInfo();
-  CodeInfoEncoding encoding = code_info.ExtractEncoding();
-
-  uint32_t native_pc_offset = method_header->NativeQuickPcOffset(cur_quick_frame_pc_);
-  StackMap stack_map = code_info.GetStackMapForNativePcOffset(native_pc_offset, encoding);
+  DecodeCurrentStackMap();
+  const CodeInfo& code_info = cur_code_info_;
+  const CodeInfoEncoding& encoding = cur_encoding_;
+  StackMap stack_map = cur_stack_map_;
   DCHECK(stack_map.IsValid());
   size_t depth_in_stack_map = current_inlining_depth_ - 1;
 
@@ -768,6 +780,7 @@ void StackVisitor::WalkStack(bool include_transitions) {
     DCHECK(thread_ == Thread::Current() || thread_->IsSuspended());
   }
   CHECK_EQ(cur_depth_, 0U);
+  stack_map_frame_ = nullptr;  // The stack may have changed since a previous walk.
   bool exit_stubs_installed = Runtime::Current()->GetInstrumentation()->AreExitStubsInstalled();
   uint32_t instrumentation_stack_depth = 0;
   size_t inlined_frames_count = 0;
@@ -830,15 +843,12 @@ void StackVisitor::WalkStack(bool include_transitions) {
         if ((walk_kind_ == StackWalkKind::kIncludeInlinedFrames)
             && (cur_oat_quick_method_header_ != nullptr)
             && cur_oat_quick_method_header_->IsOptimized()) {
-          CodeInfo code_info = cur_oat_quick_method_header_->GetOptimizedCodeInfo();
-          CodeInfoEncoding encoding = code_info.ExtractEncoding();
-          uint32_t native_pc_offset =
-              cur_oat_quick_method_header_->NativeQuickPcOffset(cur_quick_frame_pc_);
-          StackMap stack_map = code_info.GetStackMapForNativePcOffset(native_pc_offset, encoding);
-          if (stack_map.IsValid() && stack_map.HasInlineInfo(encoding.stack_map.encoding)) {
-            InlineInfo inline_info = code_info.GetInlineInfoOf(stack_map, encoding);
+          DecodeCurrentStackMap();
+          if (cur_stack_map_.IsValid() &&
+              cur_stack_map_.HasInlineInfo(cur_encoding_.stack_map.encoding)) {
+            InlineInfo inline_info = cur_code_info_.GetInlineInfoOf(cur_stack_map_, cur_encoding_);
             DCHECK_EQ(current_inlining_depth_, 0u);
-            for (current_inlining_depth_ = inline_info.GetDepth(encoding.inline_info.encoding);
+            for (current_inlining_depth_ = inline_info.GetDepth(cur_encoding_.inline_info.encoding);
                  current_inlining_depth_ != 0;
                  --current_inlining_depth_) {
               bool should_continue = VisitFrame();
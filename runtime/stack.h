@@ -23,6 +23,7 @@
 #include "base/macros.h"
 #include "base/mutex.h"
 #include "quick/quick_method_frame_info.h"
+#include "stack_map.h"
 
 namespace art {
 
@@ -299,6 +300,10 @@ class StackVisitor {
 
   void SanityCheckFrame() const REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Decodes the code info and the stack map of the current frame of optimized code, unless they
+  // are already decoded for this frame, so that its inlined frames and vregs share them.
+  void DecodeCurrentStackMap() const REQUIRES_SHARED(Locks::mutator_lock_);
+
   Thread* const thread_;
   const StackWalkKind walk_kind_;
   ShadowFrame* cur_shadow_frame_;
@@ -312,6 +317,12 @@ class StackVisitor {
   // Current inlining depth of the method we are currently at.
   // 0 if there is no inlined frame.
   size_t current_inlining_depth_;
+  // The frame and pc the decoded stack map is for, null if none is decoded.
+  mutable ArtMethod** stack_map_frame_;
+  mutable uintptr_t stack_map_frame_pc_;
+  mutable CodeInfo cur_code_info_;
+  mutable CodeInfoEncoding cur_encoding_;
+  mutable StackMap cur_stack_map_;
 
  protected:
   Context* const context_;
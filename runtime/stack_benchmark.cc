@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "stack.h"
+
+#include "art_method-inl.h"
+#include "class_linker-inl.h"
+#include "common_runtime_benchmark.h"
+#include "interpreter/shadow_frame.h"
+#include "mirror/class-inl.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-inl.h"
+
+namespace art {
+
+class CountFramesVisitor : public StackVisitor {
+ public:
+  explicit CountFramesVisitor(Thread* thread) REQUIRES_SHARED(Locks::mutator_lock_)
+      : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
+        frames_(0u),
+        dex_pcs_(0u) {}
+
+  bool VisitFrame() OVERRIDE REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (GetMethod() != nullptr && !GetMethod()->IsRuntimeMethod()) {
+      ++frames_;
+      dex_pcs_ += GetDexPc();
+    }
+    return true;
+  }
+
+  size_t frames_;
+  size_t dex_pcs_;
+};
+
+class StackBenchmark : public CommonRuntimeBenchmark {
+ protected:
+  static constexpr size_t kDepth = 32u;
+  static constexpr size_t kWalks = 10000u;
+
+  // Pushes `depth` interpreter frames of `method` and benchmarks walking the stack. Compiled
+  // frames need compiled code, which the gtests do not have. The frames are allocated in the
+  // frames of this function.
+  void PushFramesAndWalk(ArtMethod* method, size_t depth) REQUIRES_SHARED(Locks::mutator_lock_) {
+    Thread* self = Thread::Current();
+    ShadowFrameAllocaUniquePtr shadow_frame =
+        CREATE_SHADOW_FRAME(/* num_vregs */ 1u, /* link */ nullptr, method, /* dex_pc */ depth);
+    self->PushShadowFrame(shadow_frame.get());
+    if (depth > 1u) {
+      PushFramesAndWalk(method, depth - 1u);
+    } else {
+      size_t frames = 0u;
+      Benchmark("StackVisitor::WalkStack/interpreter", kWalks, [&](size_t i ATTRIBUTE_UNUSED)
+          REQUIRES_SHARED(Locks::mutator_lock_) {
+        CountFramesVisitor visitor(self);
+        visitor.WalkStack();
+        frames += visitor.frames_;
+      });
+      EXPECT_EQ((kWarmUpRounds + kRounds) * kWalks * kDepth, frames);
+    }
+    self->PopShadowFrame();
+  }
+};
+
+TEST_F(StackBenchmark, WalkStack) {
+  ScopedObjectAccess soa(Thread::Current());
+  ObjPtr<mirror::Class> c = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  ASSERT_TRUE(c != nullptr);
+  ArtMethod* method =
+      c->FindClassMethod("toString", "()Ljava/lang/String;", class_linker_->GetImagePointerSize());
+  ASSERT_TRUE(method != nullptr);
+  PushFramesAndWalk(method, kDepth);
+}
+
+}  // namespace art
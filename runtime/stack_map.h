@@ -1542,9 +1542,8 @@ class CodeInfo {
 
   StackMap GetStackMapForNativePcOffset(uint32_t native_pc_offset,
                                         const CodeInfoEncoding& encoding) const {
-    // TODO: Safepoint stack maps are sorted by native_pc_offset but catch stack
-    //       maps are not. If we knew that the method does not have try/catch,
-    //       we could do binary search.
+    // Safepoint stack maps are sorted by native_pc_offset but catch stack maps are not.
+    // See GetStackMapForNativePcOffsetWithoutCatch() for methods without try/catch.
     for (size_t i = 0, e = GetNumberOfStackMaps(encoding); i < e; ++i) {
       StackMap stack_map = GetStackMapAt(i, encoding);
       if (stack_map.GetNativePcOffset(encoding.stack_map.encoding, kRuntimeISA) ==
@@ -1555,6 +1554,32 @@ class CodeInfo {
     return StackMap();
   }
 
+  // Same as GetStackMapForNativePcOffset() for a method without try/catch, whose stack maps
+  // are all safepoints and therefore sorted by native_pc_offset. This uses binary search.
+  StackMap GetStackMapForNativePcOffsetWithoutCatch(uint32_t native_pc_offset,
+                                                    const CodeInfoEncoding& encoding) const {
+    const StackMapEncoding& stack_map_encoding = encoding.stack_map.encoding;
+    size_t low = 0u;
+    size_t high = GetNumberOfStackMaps(encoding);
+    while (low != high) {
+      size_t mid = low + (high - low) / 2u;
+      StackMap stack_map = GetStackMapAt(mid, encoding);
+      if (stack_map.GetNativePcOffset(stack_map_encoding, kRuntimeISA) < native_pc_offset) {
+        low = mid + 1u;
+      } else {
+        high = mid;
+      }
+    }
+    // `low` is the first stack map at or after native_pc_offset, as found by the linear search.
+    if (low != GetNumberOfStackMaps(encoding)) {
+      StackMap stack_map = GetStackMapAt(low, encoding);
+      if (stack_map.GetNativePcOffset(stack_map_encoding, kRuntimeISA) == native_pc_offset) {
+        return stack_map;
+      }
+    }
+    return StackMap();
+  }
+
   InvokeInfo GetInvokeInfoForNativePcOffset(uint32_t native_pc_offset,
                                             const CodeInfoEncoding& encoding) {
     for (size_t index = 0; index < encoding.invoke_info.num_entries; index++) {
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "stack_map.h"
+
+#include "base/arena_allocator.h"
+#include "base/arena_bit_vector.h"
+#include "base/scoped_arena_allocator.h"
+#include "common_runtime_benchmark.h"
+#include "memory_region.h"
+#include "optimizing/stack_map_stream.h"
+
+namespace art {
+
+class StackMapBenchmark : public CommonRuntimeBenchmark {
+ protected:
+  static constexpr size_t kStackMaps = 256u;
+  static constexpr size_t kDexRegisters = 8u;
+  static constexpr uint32_t kNativePcStride = 16u;
+  static constexpr size_t kOps = 100000u;
+
+  using Kind = DexRegisterLocation::Kind;
+
+  // Encodes the stack maps of a large method, with registers in every kind of location.
+  void SetUp() OVERRIDE {
+    CommonRuntimeBenchmark::SetUp();
+    ArenaStack arena_stack(&pool_);
+    ScopedArenaAllocator allocator(&arena_stack);
+    StackMapStream stream(&allocator, kRuntimeISA);
+    ArenaBitVector sp_mask(&allocator, 0, /* expandable */ true);
+    for (size_t i = 0; i != kStackMaps; ++i) {
+      sp_mask.SetBit(i % 32u);
+      stream.BeginStackMapEntry(/* dex_pc */ i,
+                                /* native_pc_offset */ i * kNativePcStride,
+                                /* register_mask */ 1u << (i % 16u),
+                                &sp_mask,
+                                kDexRegisters,
+                                /* inlining_depth */ 0u);
+      for (size_t reg = 0; reg != kDexRegisters; ++reg) {
+        switch ((i + reg) % 4u) {
+          case 0u: stream.AddDexRegisterEntry(Kind::kInStack, reg * 4); break;
+          case 1u: stream.AddDexRegisterEntry(Kind::kInRegister, reg); break;
+          case 2u: stream.AddDexRegisterEntry(Kind::kConstant, i); break;
+          default: stream.AddDexRegisterEntry(Kind::kNone, 0); break;
+        }
+      }
+      stream.EndStackMapEntry();
+    }
+    code_info_data_.resize(stream.PrepareForFillIn());
+    stream.FillInCodeInfo(MemoryRegion(code_info_data_.data(), code_info_data_.size()));
+  }
+
+  ArenaPool pool_;
+  std::vector<uint8_t> code_info_data_;
+};
+
+// Decoding the encoding, done for each frame by the stack walks.
+TEST_F(StackMapBenchmark, ExtractEncoding) {
+  size_t stack_maps = 0u;
+  Benchmark("CodeInfo::ExtractEncoding", kOps, [&](size_t i ATTRIBUTE_UNUSED) {
+    CodeInfo code_info(code_info_data_.data());
+    CodeInfoEncoding encoding = code_info.ExtractEncoding();
+    stack_maps += code_info.GetNumberOfStackMaps(encoding);
+  });
+  EXPECT_EQ((kWarmUpRounds + kRounds) * kOps * kStackMaps, stack_maps);
+}
+
+TEST_F(StackMapBenchmark, GetStackMapForNativePcOffset) {
+  CodeInfo code_info(code_info_data_.data());
+  CodeInfoEncoding encoding = code_info.ExtractEncoding();
+  size_t found = 0u;
+  Benchmark("CodeInfo::GetStackMapForNativePcOffset", kOps, [&](size_t i) {
+    // Spread the lookups over the method.
+    uint32_t native_pc_offset = ((i * 97u) % kStackMaps) * kNativePcStride;
+    found += code_info.GetStackMapForNativePcOffset(native_pc_offset, encoding).IsValid() ? 1u : 0u;
+  });
+  EXPECT_EQ((kWarmUpRounds + kRounds) * kOps, found);
+}
+
+// Decoding the locations of all the dex registers of a stack map, as deoptimization does.
+TEST_F(StackMapBenchmark, GetDexRegisterLocations) {
+  CodeInfo code_info(code_info_data_.data());
+  CodeInfoEncoding encoding = code_info.ExtractEncoding();
+  size_t live = 0u;
+  Benchmark("DexRegisterMap::GetDexRegisterLocation", kOps, [&](size_t i) {
+    StackMap stack_map = code_info.GetStackMapAt(i % kStackMaps, encoding);
+    DexRegisterMap map = code_info.GetDexRegisterMapOf(stack_map, encoding, kDexRegisters);
+    for (size_t reg = 0; reg != kDexRegisters; ++reg) {
+      DexRegisterLocation location =
+          map.GetDexRegisterLocation(reg, kDexRegisters, code_info, encoding);
+      live += (location.GetKind() != Kind::kNone) ? 1u : 0u;
+    }
+  });
+  EXPECT_EQ((kWarmUpRounds + kRounds) * kOps * (kDexRegisters - kDexRegisters / 4u), live);
+}
+
+}  // namespace art
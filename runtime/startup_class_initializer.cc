@@ -0,0 +1,432 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "startup_class_initializer.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "art_method-inl.h"
+#include "base/logging.h"
+#include "class_linker-inl.h"
+#include "class_loader_utils.h"
+#include "dex_instruction-inl.h"
+#include "handle_scope-inl.h"
+#include "java_vm_ext.h"
+#include "jit/profile_compilation_info.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "mirror/iftable-inl.h"
+#include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-current-inl.h"
+#include "thread_pool.h"
+
+namespace art {
+
+namespace {
+
+// Checks that the class initializers run by the initialization of a class, and the methods of the
+// class and its superclasses they call, only use these classes and initialized boot classes.
+class InitializerChecker {
+ public:
+  explicit InitializerChecker(ObjPtr<mirror::Class> klass) REQUIRES_SHARED(Locks::mutator_lock_)
+      : klass_(klass), class_linker_(Runtime::Current()->GetClassLinker()) {}
+
+  bool CheckClassInitializer(ObjPtr<mirror::Class> klass) REQUIRES_SHARED(Locks::mutator_lock_) {
+    ArtMethod* clinit = klass->FindClassInitializer(kRuntimePointerSize);
+    if (clinit == nullptr) {
+      return true;
+    }
+    AddMethod(clinit);
+    while (!worklist_.empty()) {
+      ArtMethod* method = worklist_.back();
+      worklist_.pop_back();
+      if (!CheckMethod(method)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  void AddMethod(ArtMethod* method) {
+    if (visited_.insert(method).second) {
+      worklist_.push_back(method);
+    }
+  }
+
+  bool CheckMethod(ArtMethod* method) REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (method->IsNative()) {
+      return false;
+    }
+    if (method->IsAbstract()) {
+      return true;
+    }
+    const DexFile& dex_file = *method->GetDexFile();
+    for (const DexInstructionPcPair& inst : method->DexInstructions()) {
+      if (inst->IsQuickened()) {
+        return false;
+      }
+      switch (inst->Opcode()) {
+        case Instruction::CONST_CLASS:
+        case Instruction::CHECK_CAST:
+        case Instruction::NEW_INSTANCE:
+          if (!IsUsableType(method, dex::TypeIndex(inst->VRegB_21c()))) {
+            return false;
+          }
+          break;
+        case Instruction::INSTANCE_OF:
+        case Instruction::NEW_ARRAY:
+          if (!IsUsableType(method, dex::TypeIndex(inst->VRegC_22c()))) {
+            return false;
+          }
+          break;
+        case Instruction::FILLED_NEW_ARRAY:
+          if (!IsUsableType(method, dex::TypeIndex(inst->VRegB_35c()))) {
+            return false;
+          }
+          break;
+        case Instruction::FILLED_NEW_ARRAY_RANGE:
+          if (!IsUsableType(method, dex::TypeIndex(inst->VRegB_3rc()))) {
+            return false;
+          }
+          break;
+        case Instruction::SGET:
+        case Instruction::SGET_WIDE:
+        case Instruction::SGET_OBJECT:
+        case Instruction::SGET_BOOLEAN:
+        case Instruction::SGET_BYTE:
+        case Instruction::SGET_CHAR:
+        case Instruction::SGET_SHORT:
+        case Instruction::SPUT:
+        case Instruction::SPUT_WIDE:
+        case Instruction::SPUT_OBJECT:
+        case Instruction::SPUT_BOOLEAN:
+        case Instruction::SPUT_BYTE:
+        case Instruction::SPUT_CHAR:
+        case Instruction::SPUT_SHORT:
+          if (!IsUsableType(method, dex_file.GetFieldId(inst->VRegB_21c()).class_idx_)) {
+            return false;
+          }
+          break;
+        case Instruction::IGET:
+        case Instruction::IGET_WIDE:
+        case Instruction::IGET_OBJECT:
+        case Instruction::IGET_BOOLEAN:
+        case Instruction::IGET_BYTE:
+        case Instruction::IGET_CHAR:
+        case Instruction::IGET_SHORT:
+        case Instruction::IPUT:
+        case Instruction::IPUT_WIDE:
+        case Instruction::IPUT_OBJECT:
+        case Instruction::IPUT_BOOLEAN:
+        case Instruction::IPUT_BYTE:
+        case Instruction::IPUT_CHAR:
+        case Instruction::IPUT_SHORT:
+          if (!IsUsableType(method, dex_file.GetFieldId(inst->VRegC_22c()).class_idx_)) {
+            return false;
+          }
+          break;
+        case Instruction::INVOKE_VIRTUAL:
+        case Instruction::INVOKE_SUPER:
+        case Instruction::INVOKE_DIRECT:
+        case Instruction::INVOKE_STATIC:
+        case Instruction::INVOKE_INTERFACE:
+          if (!CheckInvoke(method, inst->VRegB_35c())) {
+            return false;
+          }
+          break;
+        case Instruction::INVOKE_VIRTUAL_RANGE:
+        case Instruction::INVOKE_SUPER_RANGE:
+        case Instruction::INVOKE_DIRECT_RANGE:
+        case Instruction::INVOKE_STATIC_RANGE:
+        case Instruction::INVOKE_INTERFACE_RANGE:
+          if (!CheckInvoke(method, inst->VRegB_3rc())) {
+            return false;
+          }
+          break;
+        case Instruction::INVOKE_POLYMORPHIC:
+        case Instruction::INVOKE_POLYMORPHIC_RANGE:
+        case Instruction::INVOKE_CUSTOM:
+        case Instruction::INVOKE_CUSTOM_RANGE:
+        case Instruction::CONST_METHOD_HANDLE:
+        case Instruction::CONST_METHOD_TYPE:
+          return false;
+        default:
+          break;
+      }
+    }
+    return true;
+  }
+
+  // Calls into initialized boot classes are fine. The methods of the superclasses which a call
+  // into them may dispatch to need to be checked too.
+  bool CheckInvoke(ArtMethod* method, uint32_t method_idx) REQUIRES_SHARED(Locks::mutator_lock_) {
+    const DexFile& dex_file = *method->GetDexFile();
+    const DexFile::MethodId& method_id = dex_file.GetMethodId(method_idx);
+    ObjPtr<mirror::Class> type = LookupType(method, method_id.class_idx_);
+    if (type == nullptr) {
+      return false;
+    }
+    if (IsInitializedBootClass(type)) {
+      return true;
+    }
+    if (!klass_->IsSubClass(type)) {
+      return false;
+    }
+    const char* name = dex_file.GetMethodName(method_id);
+    const Signature signature = dex_file.GetMethodSignature(method_id);
+    for (ObjPtr<mirror::Class> k = klass_; !IsInitializedBootClass(k); k = k->GetSuperClass()) {
+      AddMethods(k, name, signature);
+    }
+    // Default methods.
+    ObjPtr<mirror::IfTable> iftable = klass_->GetIfTable();
+    for (int32_t i = 0, count = klass_->GetIfTableCount(); i != count; ++i) {
+      ObjPtr<mirror::Class> iface = iftable->GetInterface(i);
+      if (!IsInitializedBootClass(iface)) {
+        AddMethods(iface, name, signature);
+      }
+    }
+    return true;
+  }
+
+  void AddMethods(ObjPtr<mirror::Class> klass, const char* name, const Signature& signature)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    for (ArtMethod& m : klass->GetDeclaredMethods(kRuntimePointerSize)) {
+      if (strcmp(m.GetName(), name) == 0 && m.GetSignature() == signature) {
+        AddMethod(&m);
+      }
+    }
+  }
+
+  bool IsUsableType(ArtMethod* method, dex::TypeIndex type_idx)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    ObjPtr<mirror::Class> type = LookupType(method, type_idx);
+    if (type == nullptr) {
+      return false;
+    }
+    while (type->IsArrayClass()) {
+      type = type->GetComponentType();
+    }
+    return type->IsPrimitive() || IsInitializedBootClass(type) || klass_->IsSubClass(type);
+  }
+
+  ObjPtr<mirror::Class> LookupType(ArtMethod* method, dex::TypeIndex type_idx)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    // Don't load classes, the classes not loaded yet are not initialized either.
+    return class_linker_->LookupResolvedType(
+        type_idx, method->GetDexCache(), method->GetClassLoader());
+  }
+
+  static bool IsInitializedBootClass(ObjPtr<mirror::Class> klass)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    return klass->GetClassLoader() == nullptr && klass->IsInitialized();
+  }
+
+  const ObjPtr<mirror::Class> klass_;
+  ClassLinker* const class_linker_;
+  std::unordered_set<ArtMethod*> visited_;
+  std::vector<ArtMethod*> worklist_;
+};
+
+// The number of superclasses and interfaces of a class, greater than the one of each of them.
+size_t GetDependencyDepth(ObjPtr<mirror::Class> klass) REQUIRES_SHARED(Locks::mutator_lock_) {
+  return klass->Depth() + static_cast<size_t>(klass->GetIfTableCount());
+}
+
+}  // namespace
+
+class StartupClassInitializer::InitializeClassTask FINAL : public Task {
+ public:
+  // Takes ownership of the global reference.
+  explicit InitializeClassTask(jobject klass) : klass_(klass) {}
+
+  void Run(Thread* self) OVERRIDE {
+    // Unlike the other thread pools, this one runs Java code.
+    self->SetCanCallIntoJava(true);
+    ScopedObjectAccess soa(self);
+    StackHandleScope<1> hs(self);
+    Handle<mirror::Class> klass = hs.NewHandle(soa.Decode<mirror::Class>(klass_));
+    if (!Runtime::Current()->GetClassLinker()->EnsureInitialized(self, klass, true, true)) {
+      VLOG(class_linker) << "Failed to initialize " << klass->PrettyDescriptor()
+                         << " in the background: " << self->GetException()->Dump();
+      self->ClearException();
+    }
+    soa.Vm()->DeleteGlobalRef(self, klass_);
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  const jobject klass_;
+
+  DISALLOW_COPY_AND_ASSIGN(InitializeClassTask);
+};
+
+class StartupClassInitializer::LoadProfileTask FINAL : public Task {
+ public:
+  LoadProfileTask(StartupClassInitializer* initializer,
+                  const std::string& profile_file,
+                  jobject class_loader)
+      : initializer_(initializer), profile_file_(profile_file), class_loader_(class_loader) {}
+
+  void Run(Thread* self) OVERRIDE {
+    // Resolving the classes may call into the class loader.
+    self->SetCanCallIntoJava(true);
+    ProfileCompilationInfo profile;
+    if (!profile.Load(profile_file_, /* clear_if_invalid */ false)) {
+      // Load() logged why. The classes are initialized when first used.
+      return;
+    }
+    std::vector<const DexFile*> dex_files;
+    {
+      ScopedObjectAccess soa(self);
+      StackHandleScope<1> hs(self);
+      Handle<mirror::ClassLoader> class_loader =
+          hs.NewHandle(soa.Decode<mirror::ClassLoader>(class_loader_));
+      if (class_loader == nullptr) {
+        dex_files = Runtime::Current()->GetClassLinker()->GetBootClassPath();
+      } else if (IsPathOrDexClassLoader(soa, class_loader) ||
+                 IsDelegateLastClassLoader(soa, class_loader)) {
+        VisitClassLoaderDexFiles(soa, class_loader, [&](const DexFile* dex_file) {
+          dex_files.push_back(dex_file);
+          return true;
+        });
+      }
+    }
+    std::unordered_set<std::string> descriptors = profile.GetClassDescriptors(dex_files);
+    initializer_->InitializeClasses(
+        self, class_loader_, std::vector<std::string>(descriptors.begin(), descriptors.end()));
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  StartupClassInitializer* const initializer_;
+  const std::string profile_file_;
+  const jobject class_loader_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadProfileTask);
+};
+
+StartupClassInitializer::StartupClassInitializer(size_t num_threads) {
+  // The class initializers may need the java.lang.Thread of the workers, which can only be
+  // created once the runtime started.
+  thread_pool_.reset(new ThreadPool("Startup class initializer thread pool",
+                                    num_threads,
+                                    /* create_peers */ Runtime::Current()->IsStarted()));
+  thread_pool_->StartWorkers(Thread::Current());
+}
+
+StartupClassInitializer::~StartupClassInitializer() {
+  Stop(Thread::Current());
+}
+
+void StartupClassInitializer::Start(Thread* self,
+                                    const std::string& profile_file,
+                                    jobject class_loader) {
+  thread_pool_->AddTask(self, new LoadProfileTask(this, profile_file, class_loader));
+}
+
+void StartupClassInitializer::InitializeClasses(Thread* self,
+                                                jobject class_loader,
+                                                const std::vector<std::string>& descriptors) {
+  ScopedObjectAccess soa(self);
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  VariableSizedHandleScope hs(self);
+  Handle<mirror::ClassLoader> loader = hs.NewHandle(soa.Decode<mirror::ClassLoader>(class_loader));
+  std::vector<Handle<mirror::Class>> classes;
+  for (const std::string& descriptor : descriptors) {
+    ObjPtr<mirror::Class> klass = class_linker->FindClass(self, descriptor.c_str(), loader);
+    if (klass == nullptr) {
+      self->ClearException();
+    } else if (!klass->IsInitialized() && CanInitializeInBackground(klass)) {
+      classes.push_back(hs.NewHandle(klass));
+    }
+  }
+  SortByDependencies(&classes);
+  VLOG(class_linker) << "Initializing " << classes.size() << " of " << descriptors.size()
+                     << " startup classes in the background";
+  for (Handle<mirror::Class> klass : classes) {
+    thread_pool_->AddTask(self, new InitializeClassTask(soa.Vm()->AddGlobalRef(self, klass.Get())));
+  }
+}
+
+void StartupClassInitializer::Wait(Thread* self) {
+  thread_pool_->Wait(self, /* do_work */ false, /* may_hold_locks */ false);
+}
+
+void StartupClassInitializer::Stop(Thread* self) {
+  if (thread_pool_ == nullptr) {
+    return;
+  }
+  // When running sanitized, let all tasks finish to not leak. Otherwise just clear the queue.
+  if (!RUNNING_ON_MEMORY_TOOL) {
+    thread_pool_->StopWorkers(self);
+    thread_pool_->RemoveAllTasks(self);
+  }
+  Wait(self);
+  thread_pool_.reset();
+}
+
+bool StartupClassInitializer::CanInitializeInBackground(ObjPtr<mirror::Class> klass) {
+  if (klass->IsErroneous() || klass->IsProxyClass()) {
+    return false;
+  }
+  InitializerChecker checker(klass);
+  for (ObjPtr<mirror::Class> k = klass; !k->IsInitialized(); k = k->GetSuperClass()) {
+    if (!checker.CheckClassInitializer(k)) {
+      return false;
+    }
+  }
+  // Conservatively check all the interfaces, not only the ones with default methods which the
+  // initialization of a class initializes.
+  ObjPtr<mirror::IfTable> iftable = klass->GetIfTable();
+  for (int32_t i = 0, count = klass->GetIfTableCount(); i != count; ++i) {
+    ObjPtr<mirror::Class> iface = iftable->GetInterface(i);
+    if (!iface->IsInitialized() && !InitializerChecker(iface).CheckClassInitializer(iface)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void StartupClassInitializer::SortByDependencies(std::vector<Handle<mirror::Class>>* classes) {
+  std::vector<std::pair<size_t, Handle<mirror::Class>>> depths;
+  depths.reserve(classes->size());
+  for (Handle<mirror::Class> klass : *classes) {
+    depths.emplace_back(GetDependencyDepth(klass.Get()), klass);
+  }
+  std::stable_sort(depths.begin(),
+                   depths.end(),
+                   [](const std::pair<size_t, Handle<mirror::Class>>& lhs,
+                      const std::pair<size_t, Handle<mirror::Class>>& rhs) {
+                     return lhs.first < rhs.first;
+                   });
+  classes->clear();
+  for (const std::pair<size_t, Handle<mirror::Class>>& entry : depths) {
+    classes->push_back(entry.second);
+  }
+}
+
+}  // namespace art
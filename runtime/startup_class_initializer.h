@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_STARTUP_CLASS_INITIALIZER_H_
+#define ART_RUNTIME_STARTUP_CLASS_INITIALIZER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "handle.h"
+#include "jni.h"
+#include "obj_ptr.h"
+
+namespace art {
+
+namespace mirror {
+class Class;
+}  // namespace mirror
+
+class Thread;
+class ThreadPool;
+
+// Runs the class initializers of the startup classes of a profile on a thread pool, so that the
+// main thread finds these classes initialized instead of running their initializers one after
+// the other. Enabled with -XX:StartupClassInitProfile.
+//
+// Only the classes whose initialization cannot wait for another thread are initialized in the
+// background, see CanInitializeInBackground(). An exception thrown by a class initializer is
+// dropped, so the thread using the class afterwards gets a NoClassDefFoundError rather than
+// the ExceptionInInitializerError.
+class StartupClassInitializer {
+ public:
+  explicit StartupClassInitializer(size_t num_threads);
+  ~StartupClassInitializer();
+
+  // Reads the classes of the profile in the background and initializes the ones defined by the
+  // dex files loaded so far, resolving them with `class_loader`.
+  void Start(Thread* self, const std::string& profile_file, jobject class_loader);
+
+  // Resolves the classes with `class_loader` and initializes in the background the ones which
+  // can be, superclasses and interfaces first.
+  void InitializeClasses(Thread* self,
+                         jobject class_loader,
+                         const std::vector<std::string>& descriptors)
+      REQUIRES(!Locks::mutator_lock_);
+
+  // Waits for the initializations started so far.
+  void Wait(Thread* self);
+
+  // Stops the initializations which have not started yet and waits for the others, at shutdown.
+  void Stop(Thread* self);
+
+  // Returns whether the initialization of `klass` only runs class initializers which use their
+  // own class, its superclasses and initialized boot classes. Such an initialization doesn't wait
+  // for the initialization of another class, which could wait for it in turn. The class
+  // initializers can still reach other classes through reflection in the boot classes.
+  static bool CanInitializeInBackground(ObjPtr<mirror::Class> klass)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Orders the classes so that the superclasses and interfaces of each class come before it.
+  static void SortByDependencies(std::vector<Handle<mirror::Class>>* classes)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+ private:
+  class InitializeClassTask;
+  class LoadProfileTask;
+
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  DISALLOW_COPY_AND_ASSIGN(StartupClassInitializer);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_STARTUP_CLASS_INITIALIZER_H_
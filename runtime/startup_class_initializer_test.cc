@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "startup_class_initializer.h"
+
+#include "art_field-inl.h"
+#include "class_linker-inl.h"
+#include "common_runtime_test.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/iftable-inl.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+
+class StartupClassInitializerTest : public CommonRuntimeTest {};
+
+TEST_F(StartupClassInitializerTest, CanInitializeInBackground) {
+  ScopedObjectAccess soa(Thread::Current());
+  jobject jclass_loader = LoadDex("Transaction");
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> class_loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
+  auto can_initialize = [&](const char* descriptor) REQUIRES_SHARED(Locks::mutator_lock_) {
+    ObjPtr<mirror::Class> klass = class_linker_->FindClass(soa.Self(), descriptor, class_loader);
+    CHECK(klass != nullptr) << descriptor;
+    return StartupClassInitializer::CanInitializeInBackground(klass);
+  };
+
+  // The class initializers only use their own class.
+  EXPECT_TRUE(can_initialize("LTransaction$EmptyStatic;"));
+  EXPECT_TRUE(can_initialize("LTransaction$ResolveString;"));
+  EXPECT_TRUE(can_initialize("LTransaction$StaticFieldClass;"));
+  // The class initializers use a class which is not initialized.
+  EXPECT_FALSE(can_initialize("LTransaction$FinalizableAbortClass;"));
+  EXPECT_FALSE(can_initialize("LTransaction$NativeCallAbortClass;"));
+  EXPECT_FALSE(can_initialize("LTransaction$SynchronizedNativeCallAbortClass;"));
+}
+
+TEST_F(StartupClassInitializerTest, SortByDependencies) {
+  ScopedObjectAccess soa(Thread::Current());
+  VariableSizedHandleScope hs(soa.Self());
+  std::vector<Handle<mirror::Class>> classes;
+  for (const char* descriptor : { "Ljava/util/ArrayList;",
+                                  "Ljava/util/AbstractList;",
+                                  "Ljava/util/List;",
+                                  "Ljava/util/AbstractCollection;",
+                                  "Ljava/util/Collection;",
+                                  "Ljava/lang/Iterable;",
+                                  "Ljava/lang/Object;" }) {
+    classes.push_back(hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), descriptor)));
+    ASSERT_TRUE(classes.back() != nullptr) << descriptor;
+  }
+  StartupClassInitializer::SortByDependencies(&classes);
+  ASSERT_EQ(7u, classes.size());
+  for (size_t i = 0; i != classes.size(); ++i) {
+    ObjPtr<mirror::Class> klass = classes[i].Get();
+    for (size_t j = i + 1u; j != classes.size(); ++j) {
+      ObjPtr<mirror::Class> later = classes[j].Get();
+      EXPECT_FALSE(klass->IsSubClass(later)) << klass->PrettyDescriptor();
+      EXPECT_FALSE(later->IsInterface() && klass->Implements(later)) << klass->PrettyDescriptor();
+    }
+  }
+}
+
+TEST_F(StartupClassInitializerTest, InitializeClasses) {
+  Thread* self = Thread::Current();
+  jobject jclass_loader;
+  {
+    ScopedObjectAccess soa(self);
+    jclass_loader = LoadDex("Transaction");
+  }
+  StartupClassInitializer initializer(/* num_threads */ 2u);
+  initializer.InitializeClasses(
+      self,
+      jclass_loader,
+      { "LTransaction$StaticFieldClass;", "LTransaction$NativeCallAbortClass;" });
+  initializer.Wait(self);
+
+  ScopedObjectAccess soa(self);
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> class_loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
+  ObjPtr<mirror::Class> klass =
+      class_linker_->FindClass(soa.Self(), "LTransaction$StaticFieldClass;", class_loader);
+  ASSERT_TRUE(klass != nullptr);
+  EXPECT_TRUE(klass->IsInitialized());
+  ArtField* field = klass->FindDeclaredStaticField("intField", "I");
+  ASSERT_TRUE(field != nullptr);
+  EXPECT_EQ(5, field->GetInt(klass));
+  // Left for the thread using it first.
+  klass = class_linker_->FindClass(soa.Self(), "LTransaction$NativeCallAbortClass;", class_loader);
+  ASSERT_TRUE(klass != nullptr);
+  EXPECT_FALSE(klass->IsInitialized());
+}
+
+}  // namespace art
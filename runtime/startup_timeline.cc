@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "startup_timeline.h"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <ostream>
+#include <string>
+
+#include "android-base/stringprintf.h"
+#include "android-base/unique_fd.h"
+
+#include "base/logging.h"
+#include "base/systrace.h"
+#include "base/time_utils.h"
+#include "globals.h"
+#include "utils.h"
+
+namespace art {
+
+using android::base::StringPrintf;
+using android::base::unique_fd;
+
+// Reads the first field of /proc/self/statm, the size of the address space in pages. This is
+// cheaper than parsing /proc/self/maps, and the startup only has a few dozen samples.
+static uint64_t GetMappedBytes() {
+#if defined(__linux__)
+  unique_fd fd(TEMP_FAILURE_RETRY(open("/proc/self/statm", O_RDONLY | O_CLOEXEC)));
+  if (fd.get() == -1) {
+    return 0u;
+  }
+  char buf[64];
+  ssize_t length = TEMP_FAILURE_RETRY(read(fd.get(), buf, sizeof(buf) - 1u));
+  if (length <= 0) {
+    return 0u;
+  }
+  buf[length] = '\0';
+  return strtoull(buf, nullptr, 10) * kPageSize;
+#else
+  return 0u;
+#endif
+}
+
+StartupSample StartupSample::Now() {
+  StartupSample sample;
+  sample.wall_ns = NanoTime();
+  sample.thread_cpu_ns = ThreadCpuNanoTime();
+  sample.process_cpu_ns = ProcessCpuNanoTime();
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    sample.minor_faults = static_cast<uint64_t>(usage.ru_minflt);
+    sample.major_faults = static_cast<uint64_t>(usage.ru_majflt);
+  } else {
+    sample.minor_faults = 0u;
+    sample.major_faults = 0u;
+  }
+  sample.mapped_bytes = GetMappedBytes();
+  return sample;
+}
+
+void StartupTimeline::BeginPhase(const char* name) {
+  if (finished_) {
+    return;
+  }
+  ATRACE_BEGIN(name);
+  open_phases_.push_back(phases_.size());
+  Phase phase;
+  phase.name = name;
+  phase.depth = open_phases_.size() - 1u;
+  // Sample last so that the bookkeeping is not counted in the phase.
+  phase.begin = StartupSample::Now();
+  phase.end = phase.begin;
+  phases_.push_back(phase);
+}
+
+void StartupTimeline::EndPhase() {
+  if (open_phases_.empty()) {
+    // Begun after Finish().
+    return;
+  }
+  phases_[open_phases_.back()].end = StartupSample::Now();
+  open_phases_.pop_back();
+  ATRACE_END();
+}
+
+void StartupTimeline::Finish() {
+  DCHECK(open_phases_.empty()) << phases_[open_phases_.back()].name;
+  finished_ = true;
+}
+
+static std::string FormatDelta(uint64_t begin, uint64_t end) {
+  // The address space may shrink during a phase, the other values are monotonic.
+  return (end >= begin) ? std::to_string(end - begin) : "-" + std::to_string(begin - end);
+}
+
+void StartupTimeline::Dump(std::ostream& os) const {
+  if (phases_.empty()) {
+    return;
+  }
+  os << "Startup timeline (wall, thread cpu, process cpu, minor/major faults, mapped KB):\n";
+  const uint64_t start_ns = phases_.front().begin.wall_ns;
+  for (const Phase& phase : phases_) {
+    const double offset_ms = static_cast<double>(phase.begin.wall_ns - start_ns) / MsToNs(1);
+    os << StringPrintf("  +%7.1fms ", offset_ms)
+       << std::string(2u * phase.depth, ' ') << phase.name << ": "
+       << PrettyDuration(phase.end.wall_ns - phase.begin.wall_ns) << ", "
+       << PrettyDuration(phase.end.thread_cpu_ns - phase.begin.thread_cpu_ns) << ", "
+       << PrettyDuration(phase.end.process_cpu_ns - phase.begin.process_cpu_ns) << ", "
+       << (phase.end.minor_faults - phase.begin.minor_faults) << "/"
+       << (phase.end.major_faults - phase.begin.major_faults) << ", "
+       << FormatDelta(phase.begin.mapped_bytes / KB, phase.end.mapped_bytes / KB) << "\n";
+  }
+}
+
+}  // namespace art
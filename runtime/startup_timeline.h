@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_STARTUP_TIMELINE_H_
+#define ART_RUNTIME_STARTUP_TIMELINE_H_
+
+#include <stdint.h>
+#include <iosfwd>
+#include <vector>
+
+#include "base/macros.h"
+
+namespace art {
+
+// The resource usage of the process at a point of the startup.
+struct StartupSample {
+  uint64_t wall_ns;
+  uint64_t thread_cpu_ns;
+  uint64_t process_cpu_ns;
+  uint64_t minor_faults;
+  uint64_t major_faults;
+  uint64_t mapped_bytes;  // The size of the address space, 0 if /proc/self/statm is unavailable.
+
+  static StartupSample Now();
+};
+
+// Records the wall time, CPU time, page faults and address space growth of the phases of
+// Runtime::Init and Runtime::Start, so that the slow phases of the startup can be found without
+// a systrace. The phases are only recorded by the thread starting the runtime, and the timeline
+// is not changed once Finish() is called, so that it can be dumped from the signal catcher.
+class StartupTimeline {
+ public:
+  struct Phase {
+    const char* name;  // Must outlive the timeline, usually a string literal.
+    size_t depth;
+    StartupSample begin;
+    StartupSample end;
+  };
+
+  StartupTimeline() : finished_(false) {}
+
+  // Starts a phase, nested in the current phase if any. Also starts an ATRACE section.
+  void BeginPhase(const char* name);
+  // Ends the innermost phase.
+  void EndPhase();
+  // Stops recording, once all the phases are ended. Phases begun after this are ignored.
+  void Finish();
+
+  bool IsFinished() const {
+    return finished_;
+  }
+
+  const std::vector<Phase>& GetPhases() const {
+    return phases_;
+  }
+
+  // Dumps the finished phases in the order they were begun, indented by depth.
+  void Dump(std::ostream& os) const;
+
+ private:
+  std::vector<Phase> phases_;
+  // The indexes in phases_ of the phases not ended yet, innermost last.
+  std::vector<size_t> open_phases_;
+  bool finished_;
+
+  DISALLOW_COPY_AND_ASSIGN(StartupTimeline);
+};
+
+// Records a phase for the lifetime of the object. The timeline may be null.
+class ScopedStartupPhase {
+ public:
+  ScopedStartupPhase(StartupTimeline* timeline, const char* name) : timeline_(timeline) {
+    if (timeline_ != nullptr) {
+      timeline_->BeginPhase(name);
+    }
+  }
+
+  ~ScopedStartupPhase() {
+    if (timeline_ != nullptr) {
+      timeline_->EndPhase();
+    }
+  }
+
+ private:
+  StartupTimeline* const timeline_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedStartupPhase);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_STARTUP_TIMELINE_H_
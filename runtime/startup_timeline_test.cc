@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "startup_timeline.h"
+
+#include <sstream>
+
+#include "common_runtime_test.h"
+
+namespace art {
+
+class StartupTimelineTest : public CommonRuntimeTest {};
+
+TEST_F(StartupTimelineTest, NestedPhases) {
+  StartupTimeline timeline;
+  {
+    ScopedStartupPhase outer(&timeline, "Outer");
+    ScopedStartupPhase inner(&timeline, "Inner");
+  }
+  {
+    ScopedStartupPhase second(&timeline, "Second");
+  }
+  timeline.Finish();
+  {
+    // Ignored once finished.
+    ScopedStartupPhase late(&timeline, "Late");
+  }
+
+  const std::vector<StartupTimeline::Phase>& phases = timeline.GetPhases();
+  ASSERT_EQ(phases.size(), 3u);
+  EXPECT_STREQ(phases[0].name, "Outer");
+  EXPECT_EQ(phases[0].depth, 0u);
+  EXPECT_STREQ(phases[1].name, "Inner");
+  EXPECT_EQ(phases[1].depth, 1u);
+  EXPECT_STREQ(phases[2].name, "Second");
+  EXPECT_EQ(phases[2].depth, 0u);
+  // The outer phase covers the inner one.
+  EXPECT_LE(phases[0].begin.wall_ns, phases[1].begin.wall_ns);
+  EXPECT_GE(phases[0].end.wall_ns, phases[1].end.wall_ns);
+  EXPECT_LE(phases[1].end.wall_ns, phases[2].begin.wall_ns);
+  EXPECT_LE(phases[0].begin.minor_faults, phases[0].end.minor_faults);
+
+  std::ostringstream oss;
+  timeline.Dump(oss);
+  EXPECT_NE(oss.str().find("    Inner: "), std::string::npos) << oss.str();
+  EXPECT_EQ(oss.str().find("Late"), std::string::npos) << oss.str();
+}
+
+TEST_F(StartupTimelineTest, RuntimeTimeline) {
+  // The test runtime is not started, so the timeline only has the phases of Runtime::Init.
+  StartupTimeline* timeline = Runtime::Current()->GetStartupTimeline();
+  ASSERT_TRUE(timeline != nullptr);
+  EXPECT_FALSE(timeline->IsFinished());
+  const std::vector<StartupTimeline::Phase>& phases = timeline->GetPhases();
+  ASSERT_FALSE(phases.empty());
+  EXPECT_STREQ(phases[0].name, "Runtime::Init");
+  EXPECT_EQ(phases[0].depth, 0u);
+  for (size_t i = 1; i != phases.size(); ++i) {
+    EXPECT_GT(phases[i].depth, 0u) << phases[i].name;
+  }
+}
+
+}  // namespace art
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "string_builder_append.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "base/logging.h"
+#include "gc/heap.h"
+#include "handle_scope-inl.h"
+#include "mirror/string-inl.h"
+#include "obj_ptr-inl.h"
+#include "runtime.h"
+#include "stack_reference.h"
+#include "thread-inl.h"
+
+namespace art {
+
+class StringBuilderAppend::Builder {
+ public:
+  Builder(uint32_t format, const uint32_t* args, Thread* self)
+      : format_(format), args_(args), self_(self), hs_(self) {}
+
+  // Creates the handles of the arguments and returns the count of the result, with the
+  // compression flag. Returns -1 with a pending OutOfMemoryError if the result is too long.
+  int32_t CalculateLengthWithFlag() REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Pre-fence visitor for the allocation of the result, which fills in its characters.
+  void operator()(ObjPtr<mirror::Object> obj, size_t usable_size) const
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+ private:
+  template <typename CharType>
+  void StoreData(CharType* data) const REQUIRES_SHARED(Locks::mutator_lock_);
+
+  static constexpr char kNull[] = "null";
+  static constexpr size_t kNullLength = sizeof(kNull) - 1u;
+
+  const uint32_t format_;
+  const uint32_t* const args_;
+  Thread* const self_;
+  // The arguments may move during the allocation of the result, which reads them from here.
+  StackHandleScope<kMaxArgs> hs_;
+  int32_t length_with_flag_ = 0;
+};
+
+constexpr char StringBuilderAppend::Builder::kNull[];
+constexpr size_t StringBuilderAppend::Builder::kNullLength;
+
+int32_t StringBuilderAppend::Builder::CalculateLengthWithFlag() {
+  // The sum of kMaxArgs lengths of at most 2^31 - 1 cannot overflow.
+  uint64_t length = 0u;
+  bool compressible = mirror::kUseStringCompression;
+  const uint32_t* current_arg = args_;
+  for (uint32_t f = format_; f != 0u; f >>= kBitsPerArg) {
+    switch (static_cast<Argument>(f & kArgMask)) {
+      case Argument::kString: {
+        Handle<mirror::String> str = hs_.NewHandle(
+            reinterpret_cast<const StackReference<mirror::String>*>(current_arg)->AsMirrorPtr());
+        if (str != nullptr) {
+          length += str->GetLength();
+          compressible = compressible && str->IsCompressed();
+        } else {
+          length += kNullLength;
+        }
+        break;
+      }
+      default:
+        LOG(FATAL) << "Unexpected arg format: 0x" << std::hex << (f & kArgMask)
+                   << " full format: 0x" << format_;
+        UNREACHABLE();
+    }
+    ++current_arg;
+  }
+
+  if (length > static_cast<uint64_t>(std::numeric_limits<int32_t>::max())) {
+    // Like the capacity of the StringBuilder overflowing.
+    self_->ThrowOutOfMemoryError("Appended string too long");
+    return -1;
+  }
+  length_with_flag_ = mirror::String::GetFlaggedCount(static_cast<int32_t>(length), compressible);
+  return length_with_flag_;
+}
+
+template <typename CharType>
+inline void StringBuilderAppend::Builder::StoreData(CharType* data) const {
+  size_t handle_index = 0u;
+  for (uint32_t f = format_; f != 0u; f >>= kBitsPerArg) {
+    DCHECK_EQ(f & kArgMask, static_cast<uint32_t>(Argument::kString));
+    ObjPtr<mirror::String> str =
+        ObjPtr<mirror::String>::DownCast(MakeObjPtr(hs_.GetReference(handle_index)));
+    ++handle_index;
+    if (str == nullptr) {
+      data = std::copy_n(kNull, kNullLength, data);
+    } else if (str->IsCompressed()) {
+      data = std::copy_n(str->GetValueCompressed(), str->GetLength(), data);
+    } else {
+      // The result is only compressed if all the strings are.
+      DCHECK_EQ(sizeof(CharType), sizeof(uint16_t));
+      data = std::copy_n(str->GetValue(), str->GetLength(), data);
+    }
+  }
+}
+
+void StringBuilderAppend::Builder::operator()(ObjPtr<mirror::Object> obj,
+                                              size_t usable_size ATTRIBUTE_UNUSED) const {
+  // Avoid AsString as object is not yet in live bitmap or allocation stack.
+  ObjPtr<mirror::String> new_string = ObjPtr<mirror::String>::DownCast(obj);
+  new_string->SetCount(length_with_flag_);
+  if (mirror::kUseStringCompression && mirror::String::IsCompressed(length_with_flag_)) {
+    StoreData(new_string->GetValueCompressed());
+  } else {
+    StoreData(new_string->GetValue());
+  }
+}
+
+mirror::String* StringBuilderAppend::AppendF(uint32_t format, const uint32_t* args, Thread* self) {
+  Builder builder(format, args, self);
+  self->AssertNoPendingException();
+  int32_t length_with_flag = builder.CalculateLengthWithFlag();
+  if (self->IsExceptionPending()) {
+    return nullptr;
+  }
+  gc::AllocatorType allocator_type = Runtime::Current()->GetHeap()->GetCurrentAllocator();
+  return mirror::String::Alloc</* kIsInstrumented */ true>(
+      self, length_with_flag, allocator_type, builder);
+}
+
+}  // namespace art
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_STRING_BUILDER_APPEND_H_
+#define ART_RUNTIME_STRING_BUILDER_APPEND_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/bit_utils.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+class Thread;
+
+namespace mirror {
+class String;
+}  // namespace mirror
+
+// Support for the compiled `new StringBuilder().append(...)...append(...).toString()` chains,
+// which allocate the resulting string directly.
+class StringBuilderAppend {
+ public:
+  // The kinds of the appended arguments. The format of a chain stores the kind of each of its
+  // arguments in kBitsPerArg bits, starting with the first one in the least significant bits,
+  // and is terminated by kEnd.
+  enum class Argument : uint8_t {
+    kEnd = 0u,
+    // A java.lang.String reference, or null which appends "null".
+    kString,
+    kLast = kString
+  };
+
+  // Leave room for other kinds of arguments.
+  static constexpr size_t kBitsPerArg = 4u;
+  static constexpr size_t kMaxArgs = BitSizeOf<uint32_t>() / kBitsPerArg;
+  static_assert(kMaxArgs * kBitsPerArg == BitSizeOf<uint32_t>(), "Expecting no extra bits.");
+  static_assert(static_cast<uint32_t>(Argument::kLast) < (1u << kBitsPerArg), "Too many kinds.");
+  static constexpr uint32_t kArgMask = MaxInt<uint32_t>(kBitsPerArg);
+
+  // Returns the concatenation of the arguments described by `format`, or null with a pending
+  // OutOfMemoryError. The arguments are in `args`, one 32-bit slot for each of them, as in the
+  // outgoing arguments of a managed call.
+  static mirror::String* AppendF(uint32_t format, const uint32_t* args, Thread* self)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+ private:
+  class Builder;
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_STRING_BUILDER_APPEND_H_
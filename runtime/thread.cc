@@ -43,6 +43,7 @@
 #include "base/memory_tool.h"
 #include "base/mutex.h"
 #include "base/systrace.h"
+#include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "base/to_str.h"
 #include "class_linker-inl.h"
@@ -1310,6 +1311,7 @@ bool Thread::PassActiveSuspendBarriers(Thread* self) {
     AtomicClearFlag(kActiveSuspendBarrier);
   }
 
+  suspend_barrier_pass_time_ns_ = NanoTime();
   uint32_t barrier_count = 0;
   for (uint32_t i = 0; i < kMaxSuspendBarriers; i++) {
     AtomicInteger* pending_threads = pass_barriers[i];
@@ -1733,6 +1735,12 @@ void Thread::DumpState(std::ostream& os, const Thread* thread, pid_t tid) {
     os << "  | stack=" << reinterpret_cast<void*>(thread->tlsPtr_.stack_begin) << "-"
         << reinterpret_cast<void*>(thread->tlsPtr_.stack_end) << " stackSize="
         << PrettySize(thread->tlsPtr_.stack_size) << "\n";
+    if (thread->tlab_refill_count_ != 0 || thread->tlab_bypass_count_ != 0) {
+      os << "  | tlab refills=" << thread->tlab_refill_count_
+         << " refilled=" << PrettySize(thread->tlab_refill_total_bytes_)
+         << " bypassed=" << thread->tlab_bypass_count_
+         << " refillSize=" << PrettySize(thread->tlab_refill_size_) << "\n";
+    }
     // Dump the held mutexes.
     os << "  | held mutexes=";
     for (size_t i = 0; i < kLockLevelCount; ++i) {
@@ -2549,8 +2557,9 @@ class BuildInternalStackTraceVisitor : public StackVisitor {
         dex_pc,
         pointer_size_);
     // Save the declaring class of the method to ensure that the declaring classes of the methods
-    // do not get unloaded while the stack trace is live.
-    trace_->Set(count_ + 1, method->GetDeclaringClass());
+    // do not get unloaded while the stack trace is live. The array was allocated for the depth
+    // of the stack and can hold any object, so it needs neither bounds nor type checks.
+    trace_->SetWithoutChecks<kTransactionActive>(count_ + 1, method->GetDeclaringClass());
     ++count_;
   }
 
@@ -3066,6 +3075,7 @@ void Thread::DumpThreadOffset(std::ostream& os, uint32_t offset) {
   QUICK_ENTRY_POINT_INFO(pNewStringFromString)
   QUICK_ENTRY_POINT_INFO(pNewStringFromStringBuffer)
   QUICK_ENTRY_POINT_INFO(pNewStringFromStringBuilder)
+  QUICK_ENTRY_POINT_INFO(pStringBuilderAppend)
   QUICK_ENTRY_POINT_INFO(pReadBarrierJni)
   QUICK_ENTRY_POINT_INFO(pReadBarrierMarkReg00)
   QUICK_ENTRY_POINT_INFO(pReadBarrierMarkReg01)
@@ -3099,6 +3109,7 @@ void Thread::DumpThreadOffset(std::ostream& os, uint32_t offset) {
   QUICK_ENTRY_POINT_INFO(pReadBarrierMarkReg29)
   QUICK_ENTRY_POINT_INFO(pReadBarrierSlow)
   QUICK_ENTRY_POINT_INFO(pReadBarrierForRootSlow)
+  QUICK_ENTRY_POINT_INFO(pCompileOptimized)
 
   QUICK_ENTRY_POINT_INFO(pJniMethodFastStart)
   QUICK_ENTRY_POINT_INFO(pJniMethodFastEnd)
@@ -37,6 +37,7 @@
 #include "globals.h"
 #include "handle_scope.h"
 #include "instrumentation.h"
+#include "interpreter/interpreter_cache.h"
 #include "jvalue.h"
 #include "managed_stack.h"
 #include "offsets.h"
@@ -961,6 +962,11 @@ class Thread {
     can_call_into_java_ = can_call_into_java;
   }
 
+  // Only to be used by the thread itself.
+  InterpreterCache* GetInterpreterCache() {
+    return &interpreter_cache_;
+  }
+
   // Activates single step control for debugging. The thread takes the
   // ownership of the given SingleStepControl*. It is deleted by a call
   // to DeactivateSingleStepControl or upon thread destruction.
@@ -1058,6 +1064,18 @@ class Thread {
     tlsPtr_.deps_or_stack_trace_sample.verifier_deps = verifier_deps;
   }
 
+  uint8_t* GetMethodTraceBuffer() const {
+    return tlsPtr_.method_trace_buffer;
+  }
+
+  void SetMethodTraceBuffer(uint8_t* buffer) {
+    tlsPtr_.method_trace_buffer = buffer;
+  }
+
+  size_t* GetMethodTraceIndexPtr() {
+    return &tlsPtr_.method_trace_buffer_index;
+  }
+
   uint64_t GetTraceClockBase() const {
     return tls64_.trace_clock_base;
   }
@@ -1122,6 +1140,53 @@ class Thread {
     return tlsPtr_.thread_local_pos;
   }
 
+  // Adaptive TLAB sizing, see Heap::AllocWithNewTLAB(). The refill size is the smoothed number of
+  // bytes this thread allocates per target refill interval, zero before the first refill.
+  size_t GetTlabRefillSize() const {
+    return tlab_refill_size_;
+  }
+  uint64_t GetLastTlabRefillTimeNs() const {
+    return last_tlab_refill_time_ns_;
+  }
+  size_t GetLastTlabRefillBytes() const {
+    return last_tlab_refill_bytes_;
+  }
+  // Records a slow path allocation of `bytes`, either a TLAB refill or expansion or an allocation
+  // that bypassed the TLAB.
+  void RecordTlabRefill(size_t refill_size, size_t bytes, uint64_t now_ns, bool is_tlab) {
+    tlab_refill_size_ = refill_size;
+    last_tlab_refill_time_ns_ = now_ns;
+    last_tlab_refill_bytes_ = bytes;
+    if (is_tlab) {
+      ++tlab_refill_count_;
+      tlab_refill_total_bytes_ += bytes;
+    } else {
+      ++tlab_bypass_count_;
+    }
+  }
+
+  // Allocation sampling state, see gc::AllocationSampler::ShouldSample().
+  int64_t GetAllocSampleBytesLeft() const {
+    return alloc_sample_bytes_left_;
+  }
+  void SetAllocSampleBytesLeft(int64_t bytes) {
+    alloc_sample_bytes_left_ = bytes;
+  }
+  uint64_t* GetAllocSampleRandomState() {
+    return &alloc_sample_random_state_;
+  }
+
+  // Invocation sampling state, see jit::Jit::AddInvocationSample().
+  int32_t GetJitSampleCountdown() const {
+    return jit_sample_countdown_;
+  }
+  void SetJitSampleCountdown(int32_t countdown) {
+    jit_sample_countdown_ = countdown;
+  }
+  uint64_t* GetJitSampleRandomState() {
+    return &jit_sample_random_state_;
+  }
+
   // Remove the suspend trigger for this thread by making the suspend_trigger_ TLS value
   // equal to a valid pointer.
   // TODO: does this need to atomic?  I don't think so.
@@ -1547,7 +1612,7 @@ class Thread {
       mterp_alt_ibase(nullptr), thread_local_alloc_stack_top(nullptr),
       thread_local_alloc_stack_end(nullptr),
       flip_function(nullptr), method_verifier(nullptr), thread_local_mark_stack(nullptr),
-      async_exception(nullptr) {
+      async_exception(nullptr), method_trace_buffer(nullptr), method_trace_buffer_index(0) {
       std::fill(held_mutexes, held_mutexes + kLockLevelCount, nullptr);
     }
 
@@ -1707,6 +1772,11 @@ class Thread {
 
     // The pending async-exception or null.
     mirror::Throwable* async_exception;
+
+    // The method trace records of this thread not copied to the streaming trace yet, and the
+    // index of the next one.
+    uint8_t* method_trace_buffer;
+    size_t method_trace_buffer_index;
   } tlsPtr_;
 
   // Guards the 'wait_monitor_' members.
@@ -1734,6 +1804,33 @@ class Thread {
   // By default this is true.
   bool can_call_into_java_;
 
+  // Adaptive TLAB sizing state and per thread counters. Not in the packed struct since compiled
+  // code never accesses them. Only accessed by the thread itself, or when it's suspended.
+  size_t tlab_refill_size_ = 0;
+  uint64_t last_tlab_refill_time_ns_ = 0;
+  size_t last_tlab_refill_bytes_ = 0;
+  uint64_t tlab_refill_count_ = 0;
+  uint64_t tlab_refill_total_bytes_ = 0;
+  uint64_t tlab_bypass_count_ = 0;
+
+  // Bytes the thread can allocate before its next allocation sample and the state of the random
+  // generator picking the sample points. A zero state means no sample point was picked yet.
+  int64_t alloc_sample_bytes_left_ = 0;
+  uint64_t alloc_sample_random_state_ = 0;
+
+  // Invocations of the thread left before its next JIT hotness sample, and the state of the
+  // random generator picking the sample points.
+  int32_t jit_sample_countdown_ = 0;
+  uint64_t jit_sample_random_state_ = 0;
+
+  // When the thread last passed an active suspend barrier, so that a slow SuspendAll can tell
+  // which threads delayed it. Only read by the suspender once all threads are suspended.
+  uint64_t suspend_barrier_pass_time_ns_ = 0;
+
+  // Data resolved by the interpreter for the instructions it executed. Not in the packed struct
+  // since only the runtime accesses it.
+  InterpreterCache interpreter_cache_;
+
   friend class Dbg;  // For SetStateUnsafe.
   friend class gc::collector::SemiSpace;  // For getting stack traces.
   friend class Runtime;  // For CreatePeer.
@@ -1798,13 +1895,18 @@ class ScopedStackedShadowFramePusher {
 };
 
 // Only works for debug builds.
+// The thread may be null, for the boot image relocation before the main thread is attached.
 class ScopedDebugDisallowReadBarriers {
  public:
   explicit ScopedDebugDisallowReadBarriers(Thread* self) : self_(self) {
-    self_->ModifyDebugDisallowReadBarrier(1);
+    if (self_ != nullptr) {
+      self_->ModifyDebugDisallowReadBarrier(1);
+    }
   }
   ~ScopedDebugDisallowReadBarriers() {
-    self_->ModifyDebugDisallowReadBarrier(-1);
+    if (self_ != nullptr) {
+      self_->ModifyDebugDisallowReadBarrier(-1);
+    }
   }
 
  private:
@@ -20,6 +20,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <functional>
 #include <sstream>
 #include <vector>
 
@@ -46,6 +48,7 @@
 #include "native_stack_dump.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread.h"
+#include "thread_pool.h"
 #include "trace.h"
 #include "well_known_classes.h"
 
@@ -62,6 +65,8 @@ namespace art {
 using android::base::StringPrintf;
 
 static constexpr uint64_t kLongThreadSuspendThreshold = MsToNs(5);
+// The number of threads which delayed a long SuspendAll the most that are logged.
+static constexpr size_t kSlowestSuspendedThreadsToLog = 3;
 // Use 0 since we want to yield to prevent blocking for an unpredictable amount of time.
 static constexpr useconds_t kThreadSuspendInitialSleepUs = 0;
 static constexpr useconds_t kThreadSuspendMaxYieldUs = 3000;
@@ -157,14 +162,17 @@ void ThreadList::DumpForSigQuit(std::ostream& os) {
   DumpUnattachedThreads(os, dump_native_stack && kDumpUnattachedThreadNativeStackForSigQuit);
 }
 
-static void DumpUnattachedThread(std::ostream& os, pid_t tid, bool dump_native_stack)
+static void DumpUnattachedThread(std::ostream& os,
+                                 pid_t tid,
+                                 bool dump_native_stack,
+                                 BacktraceMap* backtrace_map)
     NO_THREAD_SAFETY_ANALYSIS {
   // TODO: No thread safety analysis as DumpState with a null thread won't access fields, should
   // refactor DumpState to avoid skipping analysis.
   Thread::DumpState(os, nullptr, tid);
   DumpKernelStack(os, tid, "  kernel: ", false);
   if (dump_native_stack) {
-    DumpNativeStack(os, tid, nullptr, "  native: ");
+    DumpNativeStack(os, tid, backtrace_map, "  native: ");
   }
   os << std::endl;
 }
@@ -175,6 +183,15 @@ void ThreadList::DumpUnattachedThreads(std::ostream& os, bool dump_native_stack)
     return;
   }
 
+  // Share the map between the threads instead of parsing /proc/self/maps for each of them.
+  std::unique_ptr<BacktraceMap> backtrace_map;
+  if (dump_native_stack) {
+    backtrace_map.reset(BacktraceMap::Create(getpid()));
+    if (backtrace_map != nullptr) {
+      backtrace_map->SetSuffixesToIgnore(std::vector<std::string> { "oat", "odex" });
+    }
+  }
+
   Thread* self = Thread::Current();
   dirent* e;
   while ((e = readdir(d)) != nullptr) {
@@ -187,7 +204,7 @@ void ThreadList::DumpUnattachedThreads(std::ostream& os, bool dump_native_stack)
         contains = Contains(tid);
       }
       if (!contains) {
-        DumpUnattachedThread(os, tid, dump_native_stack);
+        DumpUnattachedThread(os, tid, dump_native_stack, backtrace_map.get());
       }
     }
   }
@@ -539,10 +556,55 @@ size_t ThreadList::RunCheckpointOnRunnableThreads(Closure* checkpoint_function)
 // from-space to to-space refs. Used to synchronize threads at a point
 // to mark the initiation of marking while maintaining the to-space
 // invariant.
+void ThreadList::FlipAndResumeThread(Thread* self, Thread* thread) {
+  Closure* flip_func = thread->GetFlipFunction();
+  if (flip_func != nullptr) {
+    flip_func->Run(thread);
+  }
+  // The thread need not wait for the roots of the other threads to be flipped.
+  MutexLock mu(self, *Locks::thread_suspend_count_lock_);
+  bool updated = thread->ModifySuspendCount(self, -1, nullptr, SuspendReason::kInternal);
+  DCHECK(updated);
+  Thread::resume_cond_->Broadcast(self);
+}
+
+// Flips the roots of suspended threads on a heap thread pool worker. The workers take the threads
+// from a shared index until all of them are flipped, so that a thread with a deep stack does not
+// hold up the others.
+class ThreadList::FlipThreadsTask : public Task {
+ public:
+  FlipThreadsTask(ThreadList* thread_list,
+                  const std::vector<Thread*>* threads,
+                  Atomic<size_t>* next_index)
+      : thread_list_(thread_list), threads_(threads), next_index_(next_index) {}
+
+  // No thread safety analysis since multiple threads will use this task. The GC-running thread
+  // holds the mutator lock on behalf of the workers until it has waited for all the tasks.
+  virtual void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    while (true) {
+      const size_t index = next_index_->FetchAndAddSequentiallyConsistent(1);
+      if (index >= threads_->size()) {
+        break;
+      }
+      thread_list_->FlipAndResumeThread(self, (*threads_)[index]);
+    }
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ThreadList* const thread_list_;
+  const std::vector<Thread*>* const threads_;
+  Atomic<size_t>* const next_index_;
+};
+
 size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor,
                                    Closure* flip_callback,
                                    gc::collector::GarbageCollector* collector,
-                                   gc::GcPauseListener* pause_listener) {
+                                   gc::GcPauseListener* pause_listener,
+                                   size_t thread_count) {
   TimingLogger::ScopedTiming split("ThreadListFlip", collector->GetTimings());
   Thread* self = Thread::Current();
   Locks::mutator_lock_->AssertNotHeld(self);
@@ -606,14 +668,27 @@ size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor,
 
   collector->GetHeap()->ThreadFlipEnd(self);
 
-  // Run the closure on the other threads and let them resume.
+  // Run the closure on the other threads and let each of them resume.
   {
     TimingLogger::ScopedTiming split3("FlipOtherThreads", collector->GetTimings());
     ReaderMutexLock mu(self, *Locks::mutator_lock_);
-    for (const auto& thread : other_threads) {
-      Closure* flip_func = thread->GetFlipFunction();
-      if (flip_func != nullptr) {
-        flip_func->Run(thread);
+    ThreadPool* thread_pool = collector->GetHeap()->GetThreadPool();
+    const size_t num_tasks = (thread_pool == nullptr)
+        ? 1u
+        : std::min({thread_count, other_threads.size(), thread_pool->GetThreadCount() + 1u});
+    if (num_tasks > 1u) {
+      Atomic<size_t> next_index(0u);
+      for (size_t i = 0; i < num_tasks; ++i) {
+        thread_pool->AddTask(self, new FlipThreadsTask(this, &other_threads, &next_index));
+      }
+      // The GC-running thread also runs tasks while waiting.
+      thread_pool->SetMaxActiveWorkers(num_tasks - 1);
+      thread_pool->StartWorkers(self);
+      thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+      thread_pool->StopWorkers(self);
+    } else {
+      for (Thread* thread : other_threads) {
+        FlipAndResumeThread(self, thread);
       }
     }
     // Run it for self.
@@ -623,17 +698,6 @@ size_t ThreadList::FlipThreadRoots(Closure* thread_flip_visitor,
     }
   }
 
-  // Resume other threads.
-  {
-    TimingLogger::ScopedTiming split4("ResumeOtherThreads", collector->GetTimings());
-    MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
-    for (const auto& thread : other_threads) {
-      bool updated = thread->ModifySuspendCount(self, -1, nullptr, SuspendReason::kInternal);
-      DCHECK(updated);
-    }
-    Thread::resume_cond_->Broadcast(self);
-  }
-
   return runnable_thread_count + other_threads.size() + 1;  // +1 for self.
 }
 
@@ -676,6 +740,7 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
     suspend_all_historam_.AdjustAndAddValue(suspend_time);
     if (suspend_time > kLongThreadSuspendThreshold) {
       LOG(WARNING) << "Suspending all threads took: " << PrettyDuration(suspend_time);
+      LogSlowestSuspendedThreads(self, start_time);
     }
 
     if (kDebugLocking) {
@@ -696,6 +761,31 @@ void ThreadList::SuspendAll(const char* cause, bool long_suspend) {
 // Debugger thread might be set to kRunnable for a short period of time after the
 // SuspendAllInternal. This is safe because it will be set back to suspended state before
 // the SuspendAll returns.
+void ThreadList::LogSlowestSuspendedThreads(Thread* self, uint64_t start_time) {
+  std::vector<std::pair<uint64_t, Thread*>> delays;
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  for (Thread* thread : list_) {
+    // Threads which were already suspended did not pass the barrier of this suspension.
+    uint64_t pass_time = thread->suspend_barrier_pass_time_ns_;
+    if (thread != self && pass_time >= start_time) {
+      delays.emplace_back(pass_time - start_time, thread);
+    }
+  }
+  std::sort(delays.begin(), delays.end(), std::greater<std::pair<uint64_t, Thread*>>());
+  size_t num_threads_to_log = std::min(delays.size(), kSlowestSuspendedThreadsToLog);
+  for (size_t i = 0; i != num_threads_to_log; ++i) {
+    Thread* thread = delays[i].second;
+    std::string name;
+    thread->GetThreadName(name);
+    uint32_t dex_pc = 0u;
+    ArtMethod* method =
+        thread->GetCurrentMethod(&dex_pc, /* check_suspended */ false, /* abort_on_error */ false);
+    LOG(WARNING) << "  \"" << name << "\" tid=" << thread->GetTid() << " suspended after "
+                 << PrettyDuration(delays[i].first) << " in state " << thread->GetState()
+                 << " at " << ArtMethod::PrettyMethod(method) << " dex_pc=" << dex_pc;
+  }
+}
+
 void ThreadList::SuspendAllInternal(Thread* self,
                                     Thread* ignore1,
                                     Thread* ignore2,
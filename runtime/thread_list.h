@@ -122,11 +122,14 @@ class ThreadList {
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
   // Flip thread roots from from-space refs to to-space refs. Used by
-  // the concurrent copying collector.
+  // the concurrent copying collector. The roots of the threads which stay suspended after the
+  // pause are flipped on up to thread_count threads of the heap thread pool, and each of these
+  // threads is resumed as soon as its own roots are flipped.
   size_t FlipThreadRoots(Closure* thread_flip_visitor,
                          Closure* flip_callback,
                          gc::collector::GarbageCollector* collector,
-                         gc::GcPauseListener* pause_listener)
+                         gc::GcPauseListener* pause_listener,
+                         size_t thread_count = 1u)
       REQUIRES(!Locks::mutator_lock_,
                !Locks::thread_list_lock_,
                !Locks::thread_suspend_count_lock_);
@@ -182,6 +185,8 @@ class ThreadList {
   }
 
  private:
+  class FlipThreadsTask;
+
   uint32_t AllocThreadId(Thread* self);
   void ReleaseThreadId(Thread* self, uint32_t id) REQUIRES(!Locks::allocated_thread_ids_lock_);
 
@@ -193,11 +198,21 @@ class ThreadList {
   void DumpUnattachedThreads(std::ostream& os, bool dump_native_stack)
       REQUIRES(!Locks::thread_list_lock_);
 
+  // Runs the flip function of a thread suspended by FlipThreadRoots(), then resumes it.
+  void FlipAndResumeThread(Thread* self, Thread* thread)
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!Locks::thread_suspend_count_lock_);
+
   void SuspendAllDaemonThreadsForShutdown()
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
   void WaitForOtherNonDaemonThreadsToExit()
       REQUIRES(!Locks::thread_list_lock_, !Locks::thread_suspend_count_lock_);
 
+  // Logs the threads which took the longest to pass the suspend barrier of a SuspendAll started
+  // at `start_time`, with their state and the method in which they stopped.
+  void LogSlowestSuspendedThreads(Thread* self, uint64_t start_time)
+      REQUIRES(Locks::mutator_lock_, !Locks::thread_list_lock_);
+
   void SuspendAllInternal(Thread* self,
                           Thread* ignore1,
                           Thread* ignore2 = nullptr,
@@ -83,7 +83,7 @@ void ThreadPoolWorker::SetPthreadPriority(int priority) {
 void ThreadPoolWorker::Run() {
   Thread* self = Thread::Current();
   Task* task = nullptr;
-  thread_pool_->creation_barier_.Wait(self);
+  thread_pool_->creation_barier_.Pass(self);
   while ((task = thread_pool_->GetTask(self)) != nullptr) {
     task->Run(self);
     task->Finalize();
@@ -121,6 +121,12 @@ void ThreadPool::RemoveAllTasks(Thread* self) {
 }
 
 ThreadPool::ThreadPool(const char* name, size_t num_threads, bool create_peers)
+    : ThreadPool(name, num_threads, create_peers, /* create_threads */ true) {}
+
+ThreadPool::ThreadPool(const char* name,
+                       size_t num_threads,
+                       bool create_peers,
+                       bool create_threads)
   : name_(name),
     task_queue_lock_("task queue lock"),
     task_queue_condition_("task queue condition", task_queue_lock_),
@@ -130,19 +136,29 @@ ThreadPool::ThreadPool(const char* name, size_t num_threads, bool create_peers)
     waiting_count_(0),
     start_time_(0),
     total_wait_time_(0),
-    // Add one since the caller of constructor waits on the barrier too.
-    creation_barier_(num_threads + 1),
+    creation_barier_(num_threads),
     max_active_workers_(num_threads),
     create_peers_(create_peers) {
-  Thread* self = Thread::Current();
+  if (create_threads) {
+    CreateThreads(num_threads);
+  }
+}
+
+void ThreadPool::CreateThreads(size_t num_threads, bool wait_for_workers) {
   while (GetThreadCount() < num_threads) {
     const std::string worker_name = StringPrintf("%s worker thread %zu", name_.c_str(),
                                                  GetThreadCount());
     threads_.push_back(
         new ThreadPoolWorker(this, worker_name, ThreadPoolWorker::kDefaultStackSize));
   }
-  // Wait for all of the threads to attach.
-  creation_barier_.Wait(self);
+  if (wait_for_workers) {
+    WaitForWorkersToBeCreated();
+  }
+}
+
+void ThreadPool::WaitForWorkersToBeCreated() {
+  // The workers pass the barrier once attached, so this returns at once if they all have.
+  creation_barier_.Increment(Thread::Current(), 0);
 }
 
 void ThreadPool::SetMaxActiveWorkers(size_t threads) {
@@ -210,6 +226,128 @@ Task* ThreadPool::GetTask(Thread* self) {
   return nullptr;
 }
 
+WorkStealingThreadPool::WorkStealingThreadPool(const char* name,
+                                               size_t num_threads,
+                                               bool create_peers)
+    : ThreadPool(name, num_threads, create_peers, /* create_threads */ false),
+      num_tasks_(0),
+      num_idle_workers_(0),
+      next_queue_(0) {
+  for (size_t i = 0; i != num_threads; ++i) {
+    queues_.emplace_back(new WorkerQueue());
+  }
+  CreateThreads(num_threads);
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    Thread* self = Thread::Current();
+    MutexLock mu(self, task_queue_lock_);
+    shutting_down_ = true;
+    task_queue_condition_.Broadcast(self);
+    completion_condition_.Broadcast(self);
+  }
+  // The workers use the queues, wait for them before the queues are destroyed.
+  STLDeleteElements(&threads_);
+}
+
+size_t WorkStealingThreadPool::GetQueueIndex(Thread* self) const {
+  size_t index = 0;
+  while (index != threads_.size() && threads_[index]->GetThread() != self) {
+    ++index;
+  }
+  return index;
+}
+
+void WorkStealingThreadPool::AddTask(Thread* self, Task* task) {
+  size_t index = GetQueueIndex(self);
+  if (index == queues_.size()) {
+    index = static_cast<uint32_t>(next_queue_.FetchAndAddRelaxed(1)) % queues_.size();
+  }
+  {
+    MutexLock mu(self, queues_[index]->lock);
+    queues_[index]->tasks.push_back(task);
+  }
+  // Pairs with the idle worker publishing itself before checking for tasks: either it sees this
+  // task, or we see it and wake it up.
+  num_tasks_.FetchAndAddSequentiallyConsistent(1);
+  if (num_idle_workers_.LoadSequentiallyConsistent() != 0) {
+    MutexLock mu(self, task_queue_lock_);
+    if (started_) {
+      task_queue_condition_.Signal(self);
+    }
+  }
+}
+
+void WorkStealingThreadPool::RemoveAllTasks(Thread* self) {
+  for (const std::unique_ptr<WorkerQueue>& queue : queues_) {
+    MutexLock mu(self, queue->lock);
+    num_tasks_.FetchAndSubSequentiallyConsistent(static_cast<int32_t>(queue->tasks.size()));
+    queue->tasks.clear();
+  }
+}
+
+size_t WorkStealingThreadPool::GetTaskCount(Thread* self ATTRIBUTE_UNUSED) {
+  return num_tasks_.LoadSequentiallyConsistent();
+}
+
+Task* WorkStealingThreadPool::TakeOrStealTask(Thread* self, size_t index) {
+  const size_t num_queues = queues_.size();
+  if (index != num_queues) {
+    WorkerQueue* queue = queues_[index].get();
+    MutexLock mu(self, queue->lock);
+    if (!queue->tasks.empty()) {
+      Task* task = queue->tasks.back();
+      queue->tasks.pop_back();
+      num_tasks_.FetchAndSubSequentiallyConsistent(1);
+      return task;
+    }
+  }
+  for (size_t i = 1; i <= num_queues; ++i) {
+    WorkerQueue* queue = queues_[(index + i) % num_queues].get();
+    MutexLock mu(self, queue->lock);
+    if (!queue->tasks.empty()) {
+      Task* task = queue->tasks.front();
+      queue->tasks.pop_front();
+      num_tasks_.FetchAndSubSequentiallyConsistent(1);
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+Task* WorkStealingThreadPool::TryGetTask(Thread* self) {
+  return IsStartedRacy() ? TakeOrStealTask(self, GetQueueIndex(self)) : nullptr;
+}
+
+Task* WorkStealingThreadPool::GetTask(Thread* self) {
+  const size_t index = GetQueueIndex(self);
+  while (true) {
+    if (IsStartedRacy()) {
+      Task* task = TakeOrStealTask(self, index);
+      if (task != nullptr) {
+        return task;
+      }
+    }
+    MutexLock mu(self, task_queue_lock_);
+    if (IsShuttingDown()) {
+      // We are shutting down, return null to tell the worker thread to stop looping.
+      return nullptr;
+    }
+    ++waiting_count_;
+    num_idle_workers_.FetchAndAddSequentiallyConsistent(1);
+    if (!started_ || num_tasks_.LoadSequentiallyConsistent() == 0) {
+      if (waiting_count_ == GetThreadCount() && !HasOutstandingTasks()) {
+        // We may be done, lets broadcast to the completion condition.
+        completion_condition_.Broadcast(self);
+      }
+      task_queue_condition_.Wait(self);
+    }
+    num_idle_workers_.FetchAndSubSequentiallyConsistent(1);
+    --waiting_count_;
+  }
+}
+
 Task* ThreadPool::TryGetTask(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
   return TryGetTaskLocked();
@@ -18,8 +18,10 @@
 #define ART_RUNTIME_THREAD_POOL_H_
 
 #include <deque>
+#include <memory>
 #include <vector>
 
+#include "atomic.h"
 #include "barrier.h"
 #include "base/mutex.h"
 #include "mem_map.h"
@@ -100,10 +102,10 @@ class ThreadPool {
 
   // Add a new task, the first available started worker will process it. Does not delete the task
   // after running it, it is the caller's responsibility.
-  void AddTask(Thread* self, Task* task) REQUIRES(!task_queue_lock_);
+  virtual void AddTask(Thread* self, Task* task) REQUIRES(!task_queue_lock_);
 
   // Remove all tasks in the queue.
-  void RemoveAllTasks(Thread* self) REQUIRES(!task_queue_lock_);
+  virtual void RemoveAllTasks(Thread* self) REQUIRES(!task_queue_lock_);
 
   // Create a named thread pool with the given number of threads.
   //
@@ -118,7 +120,7 @@ class ThreadPool {
   // When the pool was created with peers for workers, do_work must not be true (see ThreadPool()).
   void Wait(Thread* self, bool do_work, bool may_hold_locks) REQUIRES(!task_queue_lock_);
 
-  size_t GetTaskCount(Thread* self) REQUIRES(!task_queue_lock_);
+  virtual size_t GetTaskCount(Thread* self) REQUIRES(!task_queue_lock_);
 
   // Returns the total amount of workers waited for tasks.
   uint64_t GetWaitTime() const {
@@ -132,23 +134,35 @@ class ThreadPool {
   // Set the "nice" priorty for threads in the pool.
   void SetPthreadPriority(int priority);
 
+  // Wait for all of the workers to attach to the runtime. The pool must not be deleted before
+  // they have, so pools whose workers are created without waiting must call this before
+  // the runtime can shut down.
+  void WaitForWorkersToBeCreated();
+
  protected:
   // get a task to run, blocks if there are no tasks left
   virtual Task* GetTask(Thread* self) REQUIRES(!task_queue_lock_);
 
-  // Try to get a task, returning null if there is none available.
-  Task* TryGetTask(Thread* self) REQUIRES(!task_queue_lock_);
-  Task* TryGetTaskLocked() REQUIRES(task_queue_lock_);
+  // Try to get a task, returning null if there is none available. Takes the oldest task,
+  // subclasses may order the queue differently.
+  virtual Task* TryGetTask(Thread* self) REQUIRES(!task_queue_lock_);
+  virtual Task* TryGetTaskLocked() REQUIRES(task_queue_lock_);
 
   // Are we shutting down?
   bool IsShuttingDown() const REQUIRES(task_queue_lock_) {
     return shutting_down_;
   }
 
-  bool HasOutstandingTasks() const REQUIRES(task_queue_lock_) {
+  virtual bool HasOutstandingTasks() const REQUIRES(task_queue_lock_) {
     return started_ && !tasks_.empty();
   }
 
+  // For subclasses whose workers must not start before the subclass is constructed. They call
+  // CreateThreads() at the end of their constructor. If wait_for_workers is false, the workers
+  // attach to the runtime in the background, see WaitForWorkersToBeCreated().
+  ThreadPool(const char* name, size_t num_threads, bool create_peers, bool create_threads);
+  void CreateThreads(size_t num_threads, bool wait_for_workers = true);
+
   const std::string name_;
   Mutex task_queue_lock_;
   ConditionVariable task_queue_condition_ GUARDED_BY(task_queue_lock_);
@@ -173,6 +187,60 @@ class ThreadPool {
   DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
 
+// A thread pool in which each worker has its own deque of tasks, for tasks which add more tasks,
+// such as the traversal of a graph. A worker adds its tasks to its own deque and runs the newest
+// of them first, while an idle worker steals the oldest task of another worker. Tasks added by
+// other threads are spread over the deques. The task queue lock is only taken to wait for tasks,
+// not to add or take one. SetMaxActiveWorkers() is not supported.
+class WorkStealingThreadPool FINAL : public ThreadPool {
+ public:
+  WorkStealingThreadPool(const char* name, size_t num_threads, bool create_peers = false);
+  ~WorkStealingThreadPool();
+
+  void AddTask(Thread* self, Task* task) OVERRIDE REQUIRES(!task_queue_lock_);
+  void RemoveAllTasks(Thread* self) OVERRIDE REQUIRES(!task_queue_lock_);
+  size_t GetTaskCount(Thread* self) OVERRIDE REQUIRES(!task_queue_lock_);
+
+ protected:
+  Task* GetTask(Thread* self) OVERRIDE REQUIRES(!task_queue_lock_);
+  Task* TryGetTask(Thread* self) OVERRIDE REQUIRES(!task_queue_lock_);
+
+  bool HasOutstandingTasks() const OVERRIDE REQUIRES(task_queue_lock_) {
+    return started_ && num_tasks_.LoadSequentiallyConsistent() != 0;
+  }
+
+ private:
+  struct WorkerQueue {
+    WorkerQueue() : lock("work stealing thread pool worker queue lock") {}
+
+    Mutex lock;
+    std::deque<Task*> tasks GUARDED_BY(lock);
+  };
+
+  // Returns the index of the queue of the worker `self`, or the number of workers if `self` is
+  // not a worker of this pool.
+  size_t GetQueueIndex(Thread* self) const;
+
+  // Takes the newest task of the queue `index` if there is one, otherwise steals the oldest task
+  // of another queue. Returns null if all queues are empty.
+  Task* TakeOrStealTask(Thread* self, size_t index) REQUIRES(!task_queue_lock_);
+
+  // The flags are read without task_queue_lock_ to take tasks without it, and re-read with the
+  // lock before waiting.
+  bool IsStartedRacy() const NO_THREAD_SAFETY_ANALYSIS {
+    return started_ && !shutting_down_;
+  }
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  // The number of tasks in the queues, and of workers about to wait or waiting for a task.
+  AtomicInteger num_tasks_;
+  AtomicInteger num_idle_workers_;
+  // The queue which gets the next task added by a thread which is not a worker.
+  AtomicInteger next_queue_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingThreadPool);
+};
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_THREAD_POOL_H_
@@ -211,4 +211,39 @@ TEST_F(ThreadPoolTest, PeerTest) {
   }
 }
 
+TEST_F(ThreadPoolTest, WorkStealingCheckRun) {
+  Thread* self = Thread::Current();
+  WorkStealingThreadPool thread_pool("Work stealing thread pool test thread pool", num_threads);
+  AtomicInteger count(0);
+  static const int32_t num_tasks = num_threads * 4;
+  for (int32_t i = 0; i < num_tasks; ++i) {
+    thread_pool.AddTask(self, new CountTask(&count));
+  }
+  EXPECT_EQ(static_cast<size_t>(num_tasks), thread_pool.GetTaskCount(self));
+  usleep(200);
+  // Check that no threads started prematurely.
+  EXPECT_EQ(0, count.LoadSequentiallyConsistent());
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, true, false);
+  EXPECT_EQ(num_tasks, count.LoadSequentiallyConsistent());
+  EXPECT_EQ(0u, thread_pool.GetTaskCount(self));
+}
+
+// Tasks added by a worker go to its own queue, the others must steal them.
+TEST_F(ThreadPoolTest, WorkStealingRecursiveTest) {
+  Thread* self = Thread::Current();
+  WorkStealingThreadPool thread_pool("Work stealing thread pool test thread pool", num_threads);
+  AtomicInteger count(0);
+  static const int depth = 12;
+  thread_pool.AddTask(self, new TreeTask(&thread_pool, &count, depth));
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, false, false);
+  EXPECT_EQ((1 << depth) - 1, count.LoadSequentiallyConsistent());
+
+  // The pool can be used again after it completed.
+  thread_pool.AddTask(self, new TreeTask(&thread_pool, &count, depth));
+  thread_pool.Wait(self, true, false);
+  EXPECT_EQ(2 * ((1 << depth) - 1), count.LoadSequentiallyConsistent());
+}
+
 }  // namespace art
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "timing_trace.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "android-base/unique_fd.h"
+
+#include "base/bit_utils.h"
+#include "base/logging.h"
+#include "globals.h"
+#include "mem_map.h"
+#include "thread-current-inl.h"
+#include "utils.h"
+
+namespace art {
+
+using android::base::unique_fd;
+
+constexpr uint32_t TimingTrace::kMagic;
+constexpr uint32_t TimingTrace::kVersion;
+constexpr size_t TimingTrace::kNumEvents;
+constexpr size_t TimingTrace::kMaxLabels;
+constexpr size_t TimingTrace::kMaxLabelLength;
+constexpr uint16_t TimingTrace::kNoLabel;
+
+static_assert(IsPowerOfTwo(TimingTrace::kNumEvents), "Slot index computed with a mask");
+static_assert(TimingTrace::kMaxLabels <= TimingTrace::kNoLabel, "Label ids are 16 bits");
+
+static constexpr size_t kLabelsOffset = RoundUp(sizeof(TimingTraceHeader), kObjectAlignment);
+static constexpr size_t kEventsOffset = RoundUp(
+    kLabelsOffset + TimingTrace::kMaxLabels * TimingTrace::kMaxLabelLength, kObjectAlignment);
+static constexpr size_t kTraceSize =
+    kEventsOffset + TimingTrace::kNumEvents * sizeof(TimingTraceEvent);
+
+static MemMap* MapTraceFile(const std::string& file_name, size_t size, std::string* error_msg) {
+  // Readable by the tracing tools, the trace only has the labels of the runtime's splits.
+  unique_fd fd(TEMP_FAILURE_RETRY(open(file_name.c_str(),
+                                       O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                       0644)));
+  if (fd.get() == -1) {
+    *error_msg = "Failed to open: " + std::string(strerror(errno));
+    return nullptr;
+  }
+  if (TEMP_FAILURE_RETRY(ftruncate(fd.get(), size)) != 0) {
+    *error_msg = "Failed to resize: " + std::string(strerror(errno));
+    return nullptr;
+  }
+  return MemMap::MapFile(size,
+                         PROT_READ | PROT_WRITE,
+                         MAP_SHARED,
+                         fd.get(),
+                         /* start */ 0,
+                         /* low_4gb */ false,
+                         file_name.c_str(),
+                         error_msg);
+}
+
+TimingTrace* TimingTrace::Create(const std::string& file_name) {
+  const size_t size = RoundUp(kTraceSize, kPageSize);
+  std::string error_msg;
+  MemMap* mem_map = nullptr;
+  if (!file_name.empty()) {
+    mem_map = MapTraceFile(file_name, size, &error_msg);
+    if (mem_map == nullptr) {
+      LOG(WARNING) << "Failed to map timing trace file " << file_name << ": " << error_msg;
+    }
+  }
+  const bool file_backed = mem_map != nullptr;
+  if (!file_backed) {
+    mem_map = MemMap::MapAnonymous("timing trace",
+                                   nullptr,
+                                   size,
+                                   PROT_READ | PROT_WRITE,
+                                   /* low_4gb */ false,
+                                   /* reuse */ false,
+                                   &error_msg);
+    CHECK(mem_map != nullptr) << "Failed to map timing trace: " << error_msg;
+  }
+  return new TimingTrace(mem_map, file_backed ? file_name : "");
+}
+
+TimingTrace::TimingTrace(MemMap* mem_map, const std::string& file_name)
+    : mem_map_(mem_map),
+      file_name_(file_name),
+      labels_lock_("timing trace labels lock", kTimingTraceLabelsLock) {
+  // The file was truncated and the anonymous mapping is zeroed, so there are no labels nor events.
+  TimingTraceHeader* header = GetHeader();
+  header->version = kVersion;
+  header->pid = static_cast<uint32_t>(getpid());
+  header->num_events = kNumEvents;
+  header->event_size = sizeof(TimingTraceEvent);
+  header->max_labels = kMaxLabels;
+  header->max_label_length = kMaxLabelLength;
+  // Write the magic last so that a reader knows the rest of the header is valid once it sees it.
+  QuasiAtomic::ThreadFenceRelease();
+  header->magic = kMagic;
+}
+
+TimingTrace::~TimingTrace() {}
+
+TimingTraceHeader* TimingTrace::GetHeader() const {
+  return reinterpret_cast<TimingTraceHeader*>(mem_map_->Begin());
+}
+
+char* TimingTrace::GetLabelSlot(size_t index) const {
+  DCHECK_LT(index, kMaxLabels);
+  return reinterpret_cast<char*>(mem_map_->Begin() + kLabelsOffset + index * kMaxLabelLength);
+}
+
+TimingTraceEvent* TimingTrace::GetEventSlot(uint64_t index) const {
+  return reinterpret_cast<TimingTraceEvent*>(mem_map_->Begin() + kEventsOffset) +
+      (index & (kNumEvents - 1u));
+}
+
+uint16_t TimingTrace::InternLabel(const char* label) {
+  MutexLock mu(Thread::Current(), labels_lock_);
+  auto it = label_ids_.find(label);
+  if (it != label_ids_.end()) {
+    return it->second;
+  }
+  TimingTraceHeader* header = GetHeader();
+  const uint32_t index = header->num_labels.LoadRelaxed();
+  if (index == kMaxLabels) {
+    return kNoLabel;
+  }
+  // The slot is zeroed, so the copy stays null terminated.
+  strncpy(GetLabelSlot(index), label, kMaxLabelLength - 1u);
+  header->num_labels.StoreRelease(index + 1u);
+  label_ids_.emplace(label, static_cast<uint16_t>(index));
+  return static_cast<uint16_t>(index);
+}
+
+void TimingTrace::AddEvent(TimingTraceEventKind kind, uint16_t label, uint64_t time_ns) {
+  const uint64_t index = GetHeader()->next_event.FetchAndAddRelaxed(1u);
+  TimingTraceEvent* event = GetEventSlot(index);
+  event->sequence.StoreRelaxed(0u);
+  QuasiAtomic::ThreadFenceRelease();
+  event->data.time_ns = time_ns;
+  event->data.tid = static_cast<uint32_t>(GetTid());
+  event->data.label = label;
+  event->data.kind = kind;
+  event->sequence.StoreRelease(index + 1u);
+}
+
+void TimingTrace::Begin(const char* label, uint64_t time_ns) {
+  AddEvent(TimingTraceEventKind::kBegin, InternLabel(label), time_ns);
+}
+
+void TimingTrace::End(uint64_t time_ns) {
+  AddEvent(TimingTraceEventKind::kEnd, kNoLabel, time_ns);
+}
+
+void TimingTrace::GetEvents(std::vector<TimingTraceEventData>* events) const {
+  const uint64_t end = GetHeader()->next_event.LoadAcquire();
+  const uint64_t begin = (end > kNumEvents) ? end - kNumEvents : 0u;
+  for (uint64_t index = begin; index != end; ++index) {
+    TimingTraceEvent* event = GetEventSlot(index);
+    if (event->sequence.LoadAcquire() != index + 1u) {
+      continue;
+    }
+    TimingTraceEventData data = event->data;
+    QuasiAtomic::ThreadFenceAcquire();
+    if (event->sequence.LoadRelaxed() == index + 1u) {
+      events->push_back(data);
+    }
+  }
+}
+
+const char* TimingTrace::GetLabel(uint16_t label) const {
+  if (label == kNoLabel || label >= GetHeader()->num_labels.LoadAcquire()) {
+    return nullptr;
+  }
+  return GetLabelSlot(label);
+}
+
+}  // namespace art
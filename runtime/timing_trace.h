@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_TIMING_TRACE_H_
+#define ART_RUNTIME_TIMING_TRACE_H_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+
+namespace art {
+
+class MemMap;
+
+enum class TimingTraceEventKind : uint16_t {
+  kBegin,
+  kEnd,
+};
+
+struct TimingTraceEventData {
+  uint64_t time_ns;  // CLOCK_MONOTONIC, comparable across processes.
+  uint32_t tid;
+  uint16_t label;  // Index in the label table, kNoLabel for the end events.
+  TimingTraceEventKind kind;
+};
+
+// A fixed size event slot of the trace. The sequence is the index of the event plus one once the
+// event is written, and 0 while it is being written, so that a reader can detect torn events.
+struct TimingTraceEvent {
+  Atomic<uint64_t> sequence;
+  TimingTraceEventData data;
+};
+
+// The start of the trace, followed by max_labels labels of max_label_length bytes, and then by
+// num_events events of event_size bytes. Event i is in slot i % num_events.
+struct TimingTraceHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t pid;
+  uint32_t num_events;
+  uint32_t event_size;
+  uint32_t max_labels;
+  uint32_t max_label_length;
+  Atomic<uint32_t> num_labels;
+  // The index of the next event, the number of events written so far.
+  Atomic<uint64_t> next_event;
+};
+
+// A ring buffer of the begin and end events of the TimingLogger splits, for the external tracing
+// tools. The labels are interned in a table, so that an event is a few stores and the labels are
+// never formatted. Like RuntimeCounters, the trace is kept in a mapping that may be backed by a
+// file, so that another process can read it with mmap() while the runtime is live.
+class TimingTrace {
+ public:
+  static constexpr uint32_t kMagic = 0x74747261;  // "artt" in little endian.
+  static constexpr uint32_t kVersion = 1;
+  static constexpr size_t kNumEvents = 16 * 1024;
+  static constexpr size_t kMaxLabels = 1024;
+  static constexpr size_t kMaxLabelLength = 64;
+  static constexpr uint16_t kNoLabel = 0xffff;
+
+  // Maps the trace as a MAP_SHARED mapping of file_name if not empty, anonymously otherwise.
+  // Falls back to an anonymous mapping if the file can't be mapped.
+  static TimingTrace* Create(const std::string& file_name);
+  ~TimingTrace();
+
+  // Records the start of a split. The label must outlive the trace, as TimingLogger labels do.
+  void Begin(const char* label, uint64_t time_ns) REQUIRES(!labels_lock_);
+  // Records the end of the innermost split of the calling thread.
+  void End(uint64_t time_ns);
+
+  // Copies the events still in the buffer, oldest first, skipping those being overwritten.
+  void GetEvents(std::vector<TimingTraceEventData>* events) const;
+  // The label of an event, null for kNoLabel. Labels longer than kMaxLabelLength - 1 are
+  // truncated.
+  const char* GetLabel(uint16_t label) const;
+
+  // The trace file, empty if the trace is not backed by a file.
+  const std::string& GetFileName() const {
+    return file_name_;
+  }
+
+ private:
+  TimingTrace(MemMap* mem_map, const std::string& file_name);
+
+  TimingTraceHeader* GetHeader() const;
+  char* GetLabelSlot(size_t index) const;
+  TimingTraceEvent* GetEventSlot(uint64_t index) const;
+
+  uint16_t InternLabel(const char* label) REQUIRES(!labels_lock_);
+  void AddEvent(TimingTraceEventKind kind, uint16_t label, uint64_t time_ns);
+
+  std::unique_ptr<MemMap> mem_map_;
+  const std::string file_name_;
+
+  Mutex labels_lock_;
+  // The interned labels, by address. Labels are mostly string literals, so the same address is
+  // almost always the same label.
+  std::unordered_map<const char*, uint16_t> label_ids_ GUARDED_BY(labels_lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(TimingTrace);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_TIMING_TRACE_H_
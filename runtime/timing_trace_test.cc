@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "timing_trace.h"
+
+#include "common_runtime_test.h"
+#include "os.h"
+#include "utils.h"
+
+namespace art {
+
+class TimingTraceTest : public CommonRuntimeTest {};
+
+TEST_F(TimingTraceTest, Events) {
+  std::unique_ptr<TimingTrace> trace(TimingTrace::Create(""));
+  ASSERT_TRUE(trace != nullptr);
+  EXPECT_TRUE(trace->GetFileName().empty());
+
+  static const char* const kOuter = "Outer";
+  static const char* const kInner = "Inner";
+  trace->Begin(kOuter, 10u);
+  trace->Begin(kInner, 20u);
+  trace->End(30u);
+  trace->Begin(kInner, 40u);
+  trace->End(50u);
+  trace->End(60u);
+
+  std::vector<TimingTraceEventData> events;
+  trace->GetEvents(&events);
+  ASSERT_EQ(events.size(), 6u);
+  EXPECT_EQ(events[0].kind, TimingTraceEventKind::kBegin);
+  EXPECT_STREQ(trace->GetLabel(events[0].label), kOuter);
+  EXPECT_EQ(events[0].time_ns, 10u);
+  EXPECT_EQ(events[0].tid, static_cast<uint32_t>(GetTid()));
+  // The label is interned once.
+  EXPECT_EQ(events[1].label, events[3].label);
+  EXPECT_STREQ(trace->GetLabel(events[3].label), kInner);
+  EXPECT_EQ(events[5].kind, TimingTraceEventKind::kEnd);
+  EXPECT_EQ(events[5].label, TimingTrace::kNoLabel);
+  EXPECT_TRUE(trace->GetLabel(events[5].label) == nullptr);
+  EXPECT_EQ(events[5].time_ns, 60u);
+}
+
+TEST_F(TimingTraceTest, WrapAround) {
+  std::unique_ptr<TimingTrace> trace(TimingTrace::Create(""));
+  ASSERT_TRUE(trace != nullptr);
+  for (uint64_t i = 0; i != TimingTrace::kNumEvents + 2u; ++i) {
+    trace->End(i);
+  }
+  // Only the last kNumEvents events are kept, oldest first.
+  std::vector<TimingTraceEventData> events;
+  trace->GetEvents(&events);
+  ASSERT_EQ(events.size(), TimingTrace::kNumEvents);
+  EXPECT_EQ(events.front().time_ns, 2u);
+  EXPECT_EQ(events.back().time_ns, TimingTrace::kNumEvents + 1u);
+}
+
+TEST_F(TimingTraceTest, FileBacked) {
+  ScratchFile file;
+  std::unique_ptr<TimingTrace> trace(TimingTrace::Create(file.GetFilename()));
+  ASSERT_TRUE(trace != nullptr);
+  EXPECT_EQ(trace->GetFileName(), file.GetFilename());
+  trace->Begin("Split", 1u);
+  // Another process sees the header through the file.
+  std::unique_ptr<File> reader(OS::OpenFileForReading(file.GetFilename().c_str()));
+  ASSERT_TRUE(reader != nullptr);
+  TimingTraceHeader header;
+  ASSERT_TRUE(reader->PreadFully(&header, sizeof(header), 0));
+  EXPECT_EQ(header.magic, TimingTrace::kMagic);
+  EXPECT_EQ(header.version, TimingTrace::kVersion);
+  EXPECT_EQ(header.pid, static_cast<uint32_t>(getpid()));
+  EXPECT_EQ(header.num_events, TimingTrace::kNumEvents);
+  EXPECT_EQ(header.event_size, sizeof(TimingTraceEvent));
+  EXPECT_EQ(header.max_labels, TimingTrace::kMaxLabels);
+  EXPECT_EQ(header.num_labels.LoadRelaxed(), 1u);
+  EXPECT_EQ(header.next_event.LoadRelaxed(), 1u);
+}
+
+}  // namespace art
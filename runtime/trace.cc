@@ -22,6 +22,7 @@
 #include "android-base/stringprintf.h"
 
 #include "art_method-inl.h"
+#include "barrier.h"
 #include "base/casts.h"
 #include "base/enums.h"
 #include "base/stl_util.h"
@@ -56,12 +57,14 @@ static constexpr size_t TraceActionBits = MinimumBitsToStore(
 static constexpr uint8_t kOpNewMethod = 1U;
 static constexpr uint8_t kOpNewThread = 2U;
 static constexpr uint8_t kOpTraceSummary = 3U;
+// The size of the buffer of each thread for the records of a streaming trace.
+static constexpr size_t kPerThreadBufSize = 16 * KB;
 
 class BuildStackTraceVisitor : public StackVisitor {
  public:
-  explicit BuildStackTraceVisitor(Thread* thread)
+  BuildStackTraceVisitor(Thread* thread, std::vector<ArtMethod*>* method_trace)
       : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
-        method_trace_(Trace::AllocStackTrace()) {}
+        method_trace_(method_trace) {}
 
   bool VisitFrame() REQUIRES_SHARED(Locks::mutator_lock_) {
     ArtMethod* m = GetMethod();
@@ -72,12 +75,8 @@ class BuildStackTraceVisitor : public StackVisitor {
     return true;
   }
 
-  // Returns a stack trace where the topmost frame corresponds with the first element of the vector.
-  std::vector<ArtMethod*>* GetStackTrace() const {
-    return method_trace_;
-  }
-
  private:
+  // The stack trace, where the topmost frame corresponds with the first element of the vector.
   std::vector<ArtMethod*>* const method_trace_;
 
   DISALLOW_COPY_AND_ASSIGN(BuildStackTraceVisitor);
@@ -95,7 +94,6 @@ TraceClockSource Trace::default_clock_source_ = kDefaultTraceClockSource;
 
 Trace* volatile Trace::the_trace_ = nullptr;
 pthread_t Trace::sampling_pthread_ = 0U;
-std::unique_ptr<std::vector<ArtMethod*>> Trace::temp_stack_trace_;
 
 // The key identifying the tracer to update instrumentation.
 static constexpr const char* kTracerInstrumentationKey = "Tracer";
@@ -131,16 +129,6 @@ uint32_t Trace::EncodeTraceMethodAndAction(ArtMethod* method, TraceAction action
   return tmid;
 }
 
-std::vector<ArtMethod*>* Trace::AllocStackTrace() {
-  return (temp_stack_trace_.get() != nullptr)  ? temp_stack_trace_.release() :
-      new std::vector<ArtMethod*>();
-}
-
-void Trace::FreeStackTrace(std::vector<ArtMethod*>* stack_trace) {
-  stack_trace->clear();
-  temp_stack_trace_.reset(stack_trace);
-}
-
 void Trace::SetDefaultClockSource(TraceClockSource clock_source) {
 #if defined(__linux__)
   default_clock_source_ = clock_source;
@@ -226,13 +214,41 @@ static void Append8LE(uint8_t* buf, uint64_t val) {
   *buf++ = static_cast<uint8_t>(val >> 56);
 }
 
-static void GetSample(Thread* thread, void* arg) REQUIRES_SHARED(Locks::mutator_lock_) {
-  BuildStackTraceVisitor build_trace_visitor(thread);
-  build_trace_visitor.WalkStack();
-  std::vector<ArtMethod*>* stack_trace = build_trace_visitor.GetStackTrace();
-  Trace* the_trace = reinterpret_cast<Trace*>(arg);
-  the_trace->CompareAndUpdateStackTrace(thread, stack_trace);
-}
+// Takes a sample of each thread in a checkpoint, so that a runnable thread walks its own stack at
+// its next suspend point and only a suspended thread is walked by the sampling thread. Unlike a
+// suspension of all threads, no thread waits for the samples of the other ones.
+class SampleCheckpoint FINAL : public Closure {
+ public:
+  explicit SampleCheckpoint(Trace* trace) : trace_(trace), barrier_(0) {}
+
+  void Run(Thread* thread) OVERRIDE {
+    // The thread is either the current one or suspended, so nothing else uses its sample.
+    Thread* self = Thread::Current();
+    {
+      ScopedObjectAccess soa(self);
+      std::vector<ArtMethod*> stack_trace;
+      std::vector<ArtMethod*>* old_stack_trace = thread->GetStackTraceSample();
+      if (old_stack_trace != nullptr) {
+        stack_trace.reserve(old_stack_trace->size());
+      }
+      BuildStackTraceVisitor build_trace_visitor(thread, &stack_trace);
+      build_trace_visitor.WalkStack();
+      trace_->CompareAndUpdateStackTrace(thread, &stack_trace);
+    }
+    barrier_.Pass(self);
+  }
+
+  void WaitForThreadsToRunThroughCheckpoint(size_t threads_running_checkpoint) {
+    Thread* self = Thread::Current();
+    ScopedThreadStateChange tsc(self, kWaitingForCheckPointsToRun);
+    barrier_.Increment(self, threads_running_checkpoint);
+  }
+
+ private:
+  Trace* const trace_;
+  // The barrier to be passed through and for the sampling thread to wait upon.
+  Barrier barrier_;
+};
 
 static void ClearThreadStackTraceAndClockBase(Thread* thread, void* arg ATTRIBUTE_UNUSED) {
   thread->SetTraceClockBase(0);
@@ -243,10 +259,7 @@ static void ClearThreadStackTraceAndClockBase(Thread* thread, void* arg ATTRIBUT
 
 void Trace::CompareAndUpdateStackTrace(Thread* thread,
                                        std::vector<ArtMethod*>* stack_trace) {
-  CHECK_EQ(pthread_self(), sampling_pthread_);
   std::vector<ArtMethod*>* old_stack_trace = thread->GetStackTraceSample();
-  // Update the thread's stack trace sample.
-  thread->SetStackTraceSample(stack_trace);
   // Read timer clocks to use for all events in this trace.
   uint32_t thread_clock_diff = 0;
   uint32_t wall_clock_diff = 0;
@@ -258,6 +271,8 @@ void Trace::CompareAndUpdateStackTrace(Thread* thread,
       LogMethodTraceEvent(thread, *rit, instrumentation::Instrumentation::kMethodEntered,
                           thread_clock_diff, wall_clock_diff);
     }
+    // Update the thread's stack trace sample.
+    thread->SetStackTraceSample(new std::vector<ArtMethod*>(std::move(*stack_trace)));
   } else {
     // If there's a previous stack trace for this thread, diff the traces and emit entry and exit
     // events accordingly.
@@ -278,7 +293,8 @@ void Trace::CompareAndUpdateStackTrace(Thread* thread,
       LogMethodTraceEvent(thread, *rit, instrumentation::Instrumentation::kMethodEntered,
                           thread_clock_diff, wall_clock_diff);
     }
-    FreeStackTrace(old_stack_trace);
+    // Update the thread's stack trace sample, keeping the memory of the old one for the next.
+    old_stack_trace->swap(*stack_trace);
   }
 }
 
@@ -301,10 +317,15 @@ void* Trace::RunSamplingThread(void* arg) {
         break;
       }
     }
+    // The trace is not deleted before this thread is joined, which is after the checkpoint ran.
+    SampleCheckpoint checkpoint(the_trace);
+    size_t threads_running_checkpoint;
     {
-      ScopedSuspendAll ssa(__FUNCTION__);
-      MutexLock mu(self, *Locks::thread_list_lock_);
-      runtime->GetThreadList()->ForEach(GetSample, the_trace);
+      ScopedObjectAccess soa(self);
+      threads_running_checkpoint = runtime->GetThreadList()->RunCheckpoint(&checkpoint);
+    }
+    if (threads_running_checkpoint != 0) {
+      checkpoint.WaitForThreadsToRunThroughCheckpoint(threads_running_checkpoint);
     }
   }
 
@@ -415,24 +436,36 @@ void Trace::StopTracing(bool finish_tracing, bool flush_file) {
 
   if (the_trace != nullptr) {
     stop_alloc_counting = (the_trace->flags_ & Trace::kTraceCountAllocs) != 0;
+    {
+      gc::ScopedGCCriticalSection gcs(self,
+                                      gc::kGcCauseInstrumentation,
+                                      gc::kCollectorTypeInstrumentation);
+      ScopedSuspendAll ssa(__FUNCTION__);
+
+      if (the_trace->trace_mode_ == TraceMode::kSampling) {
+        MutexLock mu(self, *Locks::thread_list_lock_);
+        runtime->GetThreadList()->ForEach(ClearThreadStackTraceAndClockBase, nullptr);
+      } else {
+        runtime->GetInstrumentation()->DisableMethodTracing(kTracerInstrumentationKey);
+        runtime->GetInstrumentation()->RemoveListener(
+            the_trace, instrumentation::Instrumentation::kMethodEntered |
+            instrumentation::Instrumentation::kMethodExited |
+            instrumentation::Instrumentation::kMethodUnwind);
+      }
+      if (the_trace->trace_output_mode_ == TraceOutputMode::kStreaming) {
+        // No record is added anymore, collect the ones still buffered by the threads.
+        MutexLock mu(self, *Locks::thread_list_lock_);
+        for (Thread* thread : runtime->GetThreadList()->GetList()) {
+          if (finish_tracing) {
+            the_trace->FlushThreadBuf(thread);
+          }
+          FreeThreadBuf(thread);
+        }
+      }
+    }
     if (finish_tracing) {
       the_trace->FinishTracing();
     }
-    gc::ScopedGCCriticalSection gcs(self,
-                                    gc::kGcCauseInstrumentation,
-                                    gc::kCollectorTypeInstrumentation);
-    ScopedSuspendAll ssa(__FUNCTION__);
-
-    if (the_trace->trace_mode_ == TraceMode::kSampling) {
-      MutexLock mu(self, *Locks::thread_list_lock_);
-      runtime->GetThreadList()->ForEach(ClearThreadStackTraceAndClockBase, nullptr);
-    } else {
-      runtime->GetInstrumentation()->DisableMethodTracing(kTracerInstrumentationKey);
-      runtime->GetInstrumentation()->RemoveListener(
-          the_trace, instrumentation::Instrumentation::kMethodEntered |
-          instrumentation::Instrumentation::kMethodExited |
-          instrumentation::Instrumentation::kMethodUnwind);
-    }
     if (the_trace->trace_file_.get() != nullptr) {
       // Do not try to erase, so flush and close explicitly.
       if (flush_file) {
@@ -960,9 +993,20 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
   // Write data
   uint8_t* ptr;
   static constexpr size_t kPacketSize = 14U;  // The maximum size of data in a packet.
-  uint8_t stack_buf[kPacketSize];             // Space to store a packet when in streaming mode.
+  static_assert(kPacketSize <= kPerThreadBufSize, "Thread buffer size not large enough");
   if (trace_output_mode_ == TraceOutputMode::kStreaming) {
-    ptr = stack_buf;
+    // The records go to a buffer of the thread, written by the thread itself or by the sampling
+    // thread while the thread is suspended, and copied to the main buffer when it is full.
+    if (thread->GetMethodTraceBuffer() == nullptr) {
+      thread->SetMethodTraceBuffer(new uint8_t[kPerThreadBufSize]);
+      *thread->GetMethodTraceIndexPtr() = 0u;
+    }
+    size_t record_size = GetRecordSize(clock_source_);
+    if (*thread->GetMethodTraceIndexPtr() + record_size > kPerThreadBufSize) {
+      FlushThreadBuf(thread);
+    }
+    ptr = thread->GetMethodTraceBuffer() + *thread->GetMethodTraceIndexPtr();
+    *thread->GetMethodTraceIndexPtr() += record_size;
   } else {
     ptr = buf_.get() + old_offset;
   }
@@ -979,9 +1023,31 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
     Append4LE(ptr, wall_clock_diff);
   }
   static_assert(kPacketSize == 2 + 4 + 4 + 4, "Packet size incorrect.");
+}
 
-  if (trace_output_mode_ == TraceOutputMode::kStreaming) {
-    MutexLock mu(Thread::Current(), *streaming_lock_);  // To serialize writing.
+void Trace::FlushThreadBuf(Thread* thread) {
+  uint8_t* thread_buf = thread->GetMethodTraceBuffer();
+  if (thread_buf == nullptr) {
+    return;
+  }
+  size_t thread_buf_size = *thread->GetMethodTraceIndexPtr();
+  MutexLock mu(Thread::Current(), *streaming_lock_);  // To serialize writing.
+  if (RegisterThread(thread)) {
+    // It might be better to postpone this. Threads might not have received names...
+    std::string thread_name;
+    thread->GetThreadName(thread_name);
+    uint8_t buf2[7];
+    Append2LE(buf2, 0);
+    buf2[2] = kOpNewThread;
+    Append2LE(buf2 + 3, static_cast<uint16_t>(thread->GetTid()));
+    Append2LE(buf2 + 5, static_cast<uint16_t>(thread_name.length()));
+    WriteToBuf(buf2, sizeof(buf2));
+    WriteToBuf(reinterpret_cast<const uint8_t*>(thread_name.c_str()), thread_name.length());
+  }
+  // The name of each method must come before its first record.
+  size_t record_size = GetRecordSize(clock_source_);
+  for (size_t offset = 0; offset != thread_buf_size; offset += record_size) {
+    ArtMethod* method = DecodeTraceMethod(ReadBytes(thread_buf + offset + 2, sizeof(uint32_t)));
     if (RegisterMethod(method)) {
       // Write a special block with the name.
       std::string method_line(GetMethodLine(method));
@@ -992,20 +1058,14 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
       WriteToBuf(buf2, sizeof(buf2));
       WriteToBuf(reinterpret_cast<const uint8_t*>(method_line.c_str()), method_line.length());
     }
-    if (RegisterThread(thread)) {
-      // It might be better to postpone this. Threads might not have received names...
-      std::string thread_name;
-      thread->GetThreadName(thread_name);
-      uint8_t buf2[7];
-      Append2LE(buf2, 0);
-      buf2[2] = kOpNewThread;
-      Append2LE(buf2 + 3, static_cast<uint16_t>(thread->GetTid()));
-      Append2LE(buf2 + 5, static_cast<uint16_t>(thread_name.length()));
-      WriteToBuf(buf2, sizeof(buf2));
-      WriteToBuf(reinterpret_cast<const uint8_t*>(thread_name.c_str()), thread_name.length());
-    }
-    WriteToBuf(stack_buf, sizeof(stack_buf));
   }
+  WriteToBuf(thread_buf, thread_buf_size);
+  *thread->GetMethodTraceIndexPtr() = 0u;
+}
+
+void Trace::FreeThreadBuf(Thread* thread) {
+  delete[] thread->GetMethodTraceBuffer();
+  thread->SetMethodTraceBuffer(nullptr);
 }
 
 void Trace::GetVisitedMethods(size_t buf_size,
@@ -1045,6 +1105,8 @@ void Trace::DumpThreadList(std::ostream& os) {
 }
 
 void Trace::StoreExitingThreadInfo(Thread* thread) {
+  // The buffered records refer to methods, and the buffer is freed with all threads suspended.
+  ScopedObjectAccess soa(thread);
   MutexLock mu(thread, *Locks::trace_lock_);
   if (the_trace_ != nullptr) {
     std::string name;
@@ -1052,7 +1114,11 @@ void Trace::StoreExitingThreadInfo(Thread* thread) {
     // The same thread/tid may be used multiple times. As SafeMap::Put does not allow to override
     // a previous mapping, use SafeMap::Overwrite.
     the_trace_->exited_threads_.Overwrite(thread->GetTid(), name);
+    if (the_trace_->trace_output_mode_ == TraceOutputMode::kStreaming) {
+      the_trace_->FlushThreadBuf(thread);
+    }
   }
+  FreeThreadBuf(thread);
 }
 
 Trace::TraceOutputMode Trace::GetOutputMode() {
@@ -137,6 +137,8 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   void MeasureClockOverhead();
   uint32_t GetClockOverheadNanoSeconds();
 
+  // Logs the method entries and exits between the previous sample of `thread` and `stack_trace`,
+  // which becomes the new sample. The content of `stack_trace` is taken over.
   void CompareAndUpdateStackTrace(Thread* thread, std::vector<ArtMethod*>* stack_trace)
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_, !*streaming_lock_);
 
@@ -197,12 +199,8 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_) OVERRIDE;
   void WatchedFramePop(Thread* thread, const ShadowFrame& frame)
       REQUIRES_SHARED(Locks::mutator_lock_) OVERRIDE;
-  // Reuse an old stack trace if it exists, otherwise allocate a new one.
-  static std::vector<ArtMethod*>* AllocStackTrace();
-  // Clear and store an old stack trace for later use.
-  static void FreeStackTrace(std::vector<ArtMethod*>* stack_trace);
-  // Save id and name of a thread before it exits.
-  static void StoreExitingThreadInfo(Thread* thread);
+  // Save id and name of a thread before it exits, and write its buffered records when streaming.
+  static void StoreExitingThreadInfo(Thread* thread) REQUIRES(!Locks::trace_lock_);
 
   static TraceOutputMode GetOutputMode() REQUIRES(!Locks::trace_lock_);
   static TraceMode GetMode() REQUIRES(!Locks::trace_lock_);
@@ -257,6 +255,13 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   void FlushBuf()
       REQUIRES(streaming_lock_);
 
+  // Copy the records buffered by `thread` to the main buffer, after registering the thread and
+  // the methods they use. Used for streaming.
+  void FlushThreadBuf(Thread* thread)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_, !*streaming_lock_);
+  // Free the record buffer of `thread`, which must be the current thread or suspended.
+  static void FreeThreadBuf(Thread* thread);
+
   uint32_t EncodeTraceMethod(ArtMethod* method) REQUIRES(!*unique_methods_lock_);
   uint32_t EncodeTraceMethodAndAction(ArtMethod* method, TraceAction action)
       REQUIRES(!*unique_methods_lock_);
@@ -276,9 +281,6 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   // Sampling thread, non-zero when sampling.
   static pthread_t sampling_pthread_;
 
-  // Used to remember an unused stack trace to avoid re-allocation during sampling.
-  static std::unique_ptr<std::vector<ArtMethod*>> temp_stack_trace_;
-
   // File to write trace data out to, null if direct to ddms.
   std::unique_ptr<File> trace_file_;
 
@@ -16,6 +16,14 @@
 
 #include "utf.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <string.h>
+
 #include <android-base/logging.h>
 
 #include "mirror/array.h"
@@ -24,6 +32,126 @@
 
 namespace art {
 
+// Number of bytes the ASCII fast paths below look at in one step.
+static constexpr size_t kAsciiVectorBytes = 16;
+
+// Returns true if none of the kAsciiVectorBytes bytes at utf8 has its high bit set.
+static inline bool IsAsciiVector(const char* utf8) {
+#if defined(__SSE2__)
+  const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8));
+  return _mm_movemask_epi8(bytes) == 0;
+#else
+  uint64_t words[2];
+  memcpy(words, utf8, sizeof(words));
+  return ((words[0] | words[1]) & UINT64_C(0x8080808080808080)) == 0u;
+#endif
+}
+
+// Zero-extends kAsciiVectorBytes bytes at utf8 to UTF-16.
+static inline void WidenAsciiVector(uint16_t* utf16_out, const char* utf8) {
+#if defined(__SSE2__)
+  const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8));
+  const __m128i zero = _mm_setzero_si128();
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16_out), _mm_unpacklo_epi8(bytes, zero));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16_out + 8), _mm_unpackhi_epi8(bytes, zero));
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+  const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(utf8));
+  vst1q_u16(utf16_out, vmovl_u8(vget_low_u8(bytes)));
+  vst1q_u16(utf16_out + 8, vmovl_u8(vget_high_u8(bytes)));
+#else
+  for (size_t i = 0; i < kAsciiVectorBytes; ++i) {
+    utf16_out[i] = static_cast<uint8_t>(utf8[i]);
+  }
+#endif
+}
+
+// Narrows kAsciiVectorBytes UTF-16 characters, which must all be below 0x80, to bytes.
+static inline void NarrowAsciiVector(char* utf8_out, const uint16_t* utf16) {
+#if defined(__SSE2__)
+  const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16));
+  const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf16 + 8));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(utf8_out), _mm_packus_epi16(low, high));
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+  const uint8x8_t low = vmovn_u16(vld1q_u16(utf16));
+  const uint8x8_t high = vmovn_u16(vld1q_u16(utf16 + 8));
+  vst1q_u8(reinterpret_cast<uint8_t*>(utf8_out), vcombine_u8(low, high));
+#else
+  for (size_t i = 0; i < kAsciiVectorBytes; ++i) {
+    utf8_out[i] = static_cast<char>(utf16[i]);
+  }
+#endif
+}
+
+// Returns true if the 8 UTF-16 characters at chars are all in the range 1..0x7f.
+static inline bool IsAsciiCharVector(const uint16_t* chars) {
+#if defined(__SSE2__)
+  // Subtracting one wraps zero around, so that (c - 1) <= 0x7e is the whole check.
+  const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars));
+  const __m128i excess = _mm_subs_epu16(_mm_sub_epi16(values, _mm_set1_epi16(1)),
+                                        _mm_set1_epi16(0x7e));
+  return _mm_movemask_epi8(_mm_cmpeq_epi16(excess, _mm_setzero_si128())) == 0xFFFF;
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+  const uint16x8_t values = vld1q_u16(chars);
+  const uint16x8_t non_ascii = vcgtq_u16(vsubq_u16(values, vdupq_n_u16(1)), vdupq_n_u16(0x7e));
+  const uint64x2_t words = vreinterpretq_u64_u16(non_ascii);
+  return (vgetq_lane_u64(words, 0) | vgetq_lane_u64(words, 1)) == 0u;
+#else
+  for (size_t i = 0; i < 8u; ++i) {
+    if (static_cast<uint16_t>(chars[i] - 1u) >= 0x7fu) {
+      return false;
+    }
+  }
+  return true;
+#endif
+}
+
+// Returns true if the kAsciiVectorBytes characters at chars are all in the range 1..0x7f.
+static inline bool IsAsciiCharVector(const uint8_t* chars) {
+#if defined(__SSE2__)
+  const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars));
+  const __m128i excess = _mm_subs_epu8(_mm_sub_epi8(values, _mm_set1_epi8(1)),
+                                       _mm_set1_epi8(0x7e));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(excess, _mm_setzero_si128())) == 0xFFFF;
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+  const uint8x16_t values = vld1q_u8(chars);
+  const uint8x16_t non_ascii = vcgtq_u8(vsubq_u8(values, vdupq_n_u8(1)), vdupq_n_u8(0x7e));
+  const uint64x2_t words = vreinterpretq_u64_u8(non_ascii);
+  return (vgetq_lane_u64(words, 0) | vgetq_lane_u64(words, 1)) == 0u;
+#else
+  for (size_t i = 0; i < kAsciiVectorBytes; ++i) {
+    if (static_cast<uint8_t>(chars[i] - 1u) >= 0x7fu) {
+      return false;
+    }
+  }
+  return true;
+#endif
+}
+
+template <typename MemoryType>
+static inline bool AllAsciiCharsImpl(const MemoryType* chars, size_t char_count) {
+  constexpr size_t kCharsPerVector = kAsciiVectorBytes / sizeof(MemoryType);
+  const MemoryType* end = chars + char_count;
+  for (; end - chars >= static_cast<ptrdiff_t>(kCharsPerVector); chars += kCharsPerVector) {
+    if (!IsAsciiCharVector(chars)) {
+      return false;
+    }
+  }
+  for (; chars < end; ++chars) {
+    if (static_cast<MemoryType>(*chars - 1u) >= 0x7fu) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool AllAsciiChars(const uint16_t* chars, size_t char_count) {
+  return AllAsciiCharsImpl(chars, char_count);
+}
+
+bool AllAsciiChars(const uint8_t* chars, size_t char_count) {
+  return AllAsciiCharsImpl(chars, char_count);
+}
+
 // This is used only from debugger and test code.
 size_t CountModifiedUtf8Chars(const char* utf8) {
   return CountModifiedUtf8Chars(utf8, strlen(utf8));
@@ -49,6 +177,14 @@ size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count) {
   size_t len = 0;
   const char* end = utf8 + byte_count;
   for (; utf8 < end; ++utf8) {
+    // Skip runs of one-byte encodings a vector at a time.
+    while (end - utf8 >= static_cast<ptrdiff_t>(kAsciiVectorBytes) && IsAsciiVector(utf8)) {
+      utf8 += kAsciiVectorBytes;
+      len += kAsciiVectorBytes;
+    }
+    if (utf8 == end) {
+      break;
+    }
     int ic = *utf8;
     len++;
     if (LIKELY((ic & 0x80) == 0)) {
@@ -97,7 +233,12 @@ void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, size_t out_chars,
 
   if (LIKELY(out_chars == in_bytes)) {
     // Common case where all characters are ASCII.
-    for (const char *p = in_start; p < in_end;) {
+    const char *p = in_start;
+    for (; in_end - p >= static_cast<ptrdiff_t>(kAsciiVectorBytes); p += kAsciiVectorBytes) {
+      WidenAsciiVector(out_p, p);
+      out_p += kAsciiVectorBytes;
+    }
+    while (p < in_end) {
       // Safe even if char is signed because ASCII characters always have
       // the high bit cleared.
       *out_p++ = dchecked_integral_cast<uint16_t>(*p++);
@@ -107,6 +248,13 @@ void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, size_t out_chars,
 
   // String contains non-ASCII characters.
   for (const char *p = in_start; p < in_end;) {
+    // Widen runs of ASCII characters a vector at a time.
+    if (in_end - p >= static_cast<ptrdiff_t>(kAsciiVectorBytes) && IsAsciiVector(p)) {
+      WidenAsciiVector(out_p, p);
+      p += kAsciiVectorBytes;
+      out_p += kAsciiVectorBytes;
+      continue;
+    }
     const uint32_t ch = GetUtf16FromUtf8(&p);
     const uint16_t leading = GetLeadingUtf16Char(ch);
     const uint16_t trailing = GetTrailingUtf16Char(ch);
@@ -123,7 +271,12 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
   if (LIKELY(byte_count == char_count)) {
     // Common case where all characters are ASCII.
     const uint16_t *utf16_end = utf16_in + char_count;
-    for (const uint16_t *p = utf16_in; p < utf16_end;) {
+    const uint16_t *p = utf16_in;
+    for (; utf16_end - p >= static_cast<ptrdiff_t>(kAsciiVectorBytes); p += kAsciiVectorBytes) {
+      NarrowAsciiVector(utf8_out, p);
+      utf8_out += kAsciiVectorBytes;
+    }
+    while (p < utf16_end) {
       *utf8_out++ = dchecked_integral_cast<char>(*p++);
     }
     return;
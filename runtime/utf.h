@@ -36,6 +36,14 @@ namespace art {
 size_t CountModifiedUtf8Chars(const char* utf8);
 size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count);
 
+/*
+ * Returns true if all the given characters are in the range 1..0x7f, i.e. ASCII
+ * characters which are encoded as a single byte in modified UTF-8. Checks 16
+ * bytes at a time.
+ */
+bool AllAsciiChars(const uint16_t* chars, size_t char_count);
+bool AllAsciiChars(const uint8_t* chars, size_t char_count);
+
 /*
  * Returns the number of modified UTF-8 bytes needed to represent the given
  * UTF-16 string.
@@ -196,6 +196,52 @@ TEST_F(UtfTest, CountAndConvertUtf8Bytes_UnpairedSurrogate) {
   }
 }
 
+// The ASCII fast paths work on 16 bytes at a time, check that a non-ASCII character is found
+// at any position relative to those blocks.
+TEST_F(UtfTest, AsciiRunsAroundNonAsciiChars) {
+  for (size_t length = 1; length <= 48; ++length) {
+    for (size_t pos = 0; pos <= length; ++pos) {
+      // A string of ASCII characters with a two byte character at 'pos' (none if pos == length).
+      std::vector<uint16_t> utf16;
+      std::vector<uint8_t> utf8;
+      for (size_t i = 0; i < length; ++i) {
+        if (i == pos) {
+          utf16.push_back(0xe9);
+          utf8.push_back(0xc3);
+          utf8.push_back(0xa9);
+        } else {
+          uint16_t c = 'a' + (i % 26);
+          utf16.push_back(c);
+          utf8.push_back(c);
+        }
+      }
+      const bool all_ascii = (pos == length);
+      EXPECT_EQ(all_ascii, AllAsciiChars(utf16.data(), utf16.size())) << length << " " << pos;
+      EXPECT_EQ(all_ascii, AllAsciiChars(utf8.data(), utf8.size())) << length << " " << pos;
+
+      std::string utf8_string(utf8.begin(), utf8.end());
+      EXPECT_EQ(utf16.size(), CountModifiedUtf8Chars(utf8_string.c_str(), utf8_string.size()));
+      std::vector<uint16_t> utf16_out(utf16.size());
+      ConvertModifiedUtf8ToUtf16(utf16_out.data(), utf16_out.size(),
+                                 utf8_string.c_str(), utf8_string.size());
+      EXPECT_EQ(utf16, utf16_out) << length << " " << pos;
+
+      AssertConversion(utf16, utf8);
+    }
+  }
+
+  // Zero is not encoded as a single byte, so it isn't ASCII here.
+  std::vector<uint16_t> with_zero(32, 'a');
+  with_zero[20] = 0;
+  EXPECT_FALSE(AllAsciiChars(with_zero.data(), with_zero.size()));
+  EXPECT_TRUE(AllAsciiChars(with_zero.data(), 20u));
+  std::vector<uint8_t> with_zero8(32, 'a');
+  with_zero8[17] = 0;
+  EXPECT_FALSE(AllAsciiChars(with_zero8.data(), with_zero8.size()));
+  with_zero8[17] = 0x7f;
+  EXPECT_TRUE(AllAsciiChars(with_zero8.data(), with_zero8.size()));
+}
+
 // Old versions of functions, here to compare answers with optimized versions.
 
 size_t CountModifiedUtf8Chars_reference(const char* utf8) {
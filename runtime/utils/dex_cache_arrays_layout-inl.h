@@ -33,6 +33,12 @@ inline DexCacheArraysLayout::DexCacheArraysLayout(PointerSize pointer_size,
                                                   const DexFile::Header& header,
                                                   uint32_t num_call_sites)
     : pointer_size_(pointer_size),
+      num_type_slots_(mirror::DexCache::CacheSize(header.type_ids_size_,
+                                                  mirror::DexCache::kDexCacheTypeCacheSize)),
+      num_string_slots_(mirror::DexCache::CacheSize(header.string_ids_size_,
+                                                    mirror::DexCache::kDexCacheStringCacheSize)),
+      num_field_slots_(mirror::DexCache::CacheSize(header.field_ids_size_,
+                                                   mirror::DexCache::kDexCacheFieldCacheSize)),
       /* types_offset_ is always 0u, so it's constexpr */
       methods_offset_(
           RoundUp(types_offset_ + TypesSize(header.type_ids_size_), MethodsAlignment())),
@@ -76,15 +82,14 @@ constexpr PointerSize GcRootAsPointerSize() {
 }
 
 inline size_t DexCacheArraysLayout::TypeOffset(dex::TypeIndex type_idx) const {
-  return types_offset_ + ElementOffset(PointerSize::k64,
-                                       type_idx.index_ % mirror::DexCache::kDexCacheTypeCacheSize);
+  return types_offset_ +
+      ElementOffset(PointerSize::k64,
+                    mirror::DexCache::SlotIndex(type_idx.index_, num_type_slots_));
 }
 
 inline size_t DexCacheArraysLayout::TypesSize(size_t num_elements) const {
-  size_t cache_size = mirror::DexCache::kDexCacheTypeCacheSize;
-  if (num_elements < cache_size) {
-    cache_size = num_elements;
-  }
+  size_t cache_size =
+      mirror::DexCache::CacheSize(num_elements, mirror::DexCache::kDexCacheTypeCacheSize);
   return PairArraySize(GcRootAsPointerSize<mirror::Class>(), cache_size);
 }
 
@@ -109,15 +114,13 @@ inline size_t DexCacheArraysLayout::MethodsAlignment() const {
 }
 
 inline size_t DexCacheArraysLayout::StringOffset(uint32_t string_idx) const {
-  uint32_t string_hash = string_idx % mirror::DexCache::kDexCacheStringCacheSize;
+  uint32_t string_hash = mirror::DexCache::SlotIndex(string_idx, num_string_slots_);
   return strings_offset_ + ElementOffset(PointerSize::k64, string_hash);
 }
 
 inline size_t DexCacheArraysLayout::StringsSize(size_t num_elements) const {
-  size_t cache_size = mirror::DexCache::kDexCacheStringCacheSize;
-  if (num_elements < cache_size) {
-    cache_size = num_elements;
-  }
+  size_t cache_size =
+      mirror::DexCache::CacheSize(num_elements, mirror::DexCache::kDexCacheStringCacheSize);
   return PairArraySize(GcRootAsPointerSize<mirror::String>(), cache_size);
 }
 
@@ -128,15 +131,13 @@ inline size_t DexCacheArraysLayout::StringsAlignment() const {
 }
 
 inline size_t DexCacheArraysLayout::FieldOffset(uint32_t field_idx) const {
-  uint32_t field_hash = field_idx % mirror::DexCache::kDexCacheFieldCacheSize;
+  uint32_t field_hash = mirror::DexCache::SlotIndex(field_idx, num_field_slots_);
   return fields_offset_ + 2u * static_cast<size_t>(pointer_size_) * field_hash;
 }
 
 inline size_t DexCacheArraysLayout::FieldsSize(size_t num_elements) const {
-  size_t cache_size = mirror::DexCache::kDexCacheFieldCacheSize;
-  if (num_elements < cache_size) {
-    cache_size = num_elements;
-  }
+  size_t cache_size =
+      mirror::DexCache::CacheSize(num_elements, mirror::DexCache::kDexCacheFieldCacheSize);
   return PairArraySize(pointer_size_, cache_size);
 }
 
@@ -145,11 +146,8 @@ inline size_t DexCacheArraysLayout::FieldsAlignment() const {
 }
 
 inline size_t DexCacheArraysLayout::MethodTypesSize(size_t num_elements) const {
-  size_t cache_size = mirror::DexCache::kDexCacheMethodTypeCacheSize;
-  if (num_elements < cache_size) {
-    cache_size = num_elements;
-  }
-
+  size_t cache_size =
+      mirror::DexCache::CacheSize(num_elements, mirror::DexCache::kDexCacheMethodTypeCacheSize);
   return ArraySize(PointerSize::k64, cache_size);
 }
 
@@ -178,6 +178,19 @@ template <class RegTypeType>
 inline RegTypeType& RegTypeCache::AddEntry(RegTypeType* new_entry) {
   DCHECK(new_entry != nullptr);
   entries_.push_back(new_entry);
+  const StringPiece& descriptor = new_entry->descriptor_;
+  if (!descriptor.empty()) {
+    uint16_t id = new_entry->GetId();
+    DCHECK_EQ(id, entries_.size() - 1u);
+    next_entry_with_descriptor_.resize(entries_.size(), kNoEntry);
+    auto it = descriptor_entries_.find(descriptor);
+    if (it == descriptor_entries_.end()) {
+      descriptor_entries_.emplace(descriptor, std::make_pair(id, id));
+    } else {
+      next_entry_with_descriptor_[it->second.second] = id;
+      it->second.second = id;
+    }
+  }
   if (new_entry->HasClass()) {
     mirror::Class* klass = new_entry->GetClass();
     DCHECK(!klass->IsPrimitive());
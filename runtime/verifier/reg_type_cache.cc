@@ -180,9 +180,20 @@ const RegType& RegTypeCache::From(mirror::ClassLoader* loader,
   StringPiece sp_descriptor(descriptor);
   // Try looking up the class in the cache first. We use a StringPiece to avoid continual strlen
   // operations on the descriptor.
-  for (size_t i = primitive_count_; i < entries_.size(); i++) {
-    if (MatchDescriptor(i, sp_descriptor, precise)) {
-      return *(entries_[i]);
+  if (!sp_descriptor.empty()) {
+    auto it = descriptor_entries_.find(sp_descriptor);
+    if (it != descriptor_entries_.end()) {
+      for (uint16_t i = it->second.first; i != kNoEntry; i = next_entry_with_descriptor_[i]) {
+        if (MatchDescriptor(i, sp_descriptor, precise)) {
+          return *(entries_[i]);
+        }
+      }
+    }
+  } else {
+    for (size_t i = primitive_count_; i < entries_.size(); i++) {
+      if (MatchDescriptor(i, sp_descriptor, precise)) {
+        return *(entries_[i]);
+      }
     }
   }
   // Class not found in the cache, will create a new type for that.
@@ -273,8 +284,19 @@ const RegType& RegTypeCache::FromClass(const char* descriptor, mirror::Class* kl
   return *reg_type;
 }
 
+size_t RegTypeCache::DescriptorHash::operator()(const StringPiece& descriptor) const {
+  // The descriptors share prefixes such as "Ljava/lang/", hash all of the characters.
+  size_t hash = 0u;
+  for (char c : descriptor) {
+    hash = hash * 31u + static_cast<unsigned char>(c);
+  }
+  return hash;
+}
+
 RegTypeCache::RegTypeCache(bool can_load_classes, ScopedArenaAllocator& allocator, bool can_suspend)
     : entries_(allocator.Adapter(kArenaAllocVerifier)),
+      descriptor_entries_(allocator.Adapter(kArenaAllocVerifier)),
+      next_entry_with_descriptor_(allocator.Adapter(kArenaAllocVerifier)),
       klass_entries_(allocator.Adapter(kArenaAllocVerifier)),
       can_load_classes_(can_load_classes),
       allocator_(allocator) {
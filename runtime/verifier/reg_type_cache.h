@@ -23,6 +23,7 @@
 #include "base/casts.h"
 #include "base/macros.h"
 #include "base/scoped_arena_containers.h"
+#include "base/stringpiece.h"
 #include "gc_root.h"
 #include "primitive.h"
 
@@ -32,7 +33,6 @@ class Class;
 class ClassLoader;
 }  // namespace mirror
 class ScopedArenaAllocator;
-class StringPiece;
 
 namespace verifier {
 
@@ -193,6 +193,17 @@ class RegTypeCache {
   // The actual storage for the RegTypes.
   ScopedArenaVector<const RegType*> entries_;
 
+  // Index of the entries by descriptor, so that From() does not compare the descriptor with
+  // every entry. Maps each non-empty descriptor to the ids of the first and last entries with
+  // it, the others being linked in id order through `next_entry_with_descriptor_`.
+  struct DescriptorHash {
+    size_t operator()(const StringPiece& descriptor) const;
+  };
+  static constexpr uint16_t kNoEntry = static_cast<uint16_t>(-1);
+  ScopedArenaUnorderedMap<StringPiece, std::pair<uint16_t, uint16_t>, DescriptorHash>
+      descriptor_entries_;
+  ScopedArenaVector<uint16_t> next_entry_with_descriptor_;
+
   // Fast lookup for quickly finding entries that have a matching class.
   ScopedArenaVector<std::pair<GcRoot<mirror::Class>, const RegType*>> klass_entries_;
 
@@ -16,7 +16,10 @@
 
 #include "reg_type.h"
 
+#include <algorithm>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "base/bit_vector.h"
 #include "base/casts.h"
@@ -393,6 +396,33 @@ TEST_F(RegTypeReferenceTest, UnresolvedType) {
   EXPECT_TRUE(unresolved_super_class.IsNonZeroReferenceTypes());
 }
 
+TEST_F(RegTypeReferenceTest, ManyDescriptors) {
+  // Tests that each descriptor finds its own entry, with the precision asked for.
+  ArenaStack stack(Runtime::Current()->GetArenaPool());
+  ScopedArenaAllocator allocator(&stack);
+  ScopedObjectAccess soa(Thread::Current());
+  RegTypeCache cache(true, allocator);
+  std::vector<std::string> descriptors;
+  std::vector<uint16_t> ids;
+  for (size_t i = 0; i != 100u; ++i) {
+    descriptors.push_back("Ljava/lang/DoesNotExist" + std::to_string(i) + ";");
+    const RegType& ref_type = cache.FromDescriptor(nullptr, descriptors.back().c_str(), false);
+    EXPECT_TRUE(ref_type.IsUnresolvedReference());
+    EXPECT_TRUE(std::find(ids.begin(), ids.end(), ref_type.GetId()) == ids.end());
+    ids.push_back(ref_type.GetId());
+  }
+  for (size_t i = 0; i != 100u; ++i) {
+    EXPECT_EQ(ids[i], cache.FromDescriptor(nullptr, descriptors[i].c_str(), false).GetId());
+  }
+
+  const RegType& imprecise_obj = cache.FromDescriptor(nullptr, "Ljava/lang/Object;", false);
+  const RegType& precise_obj = cache.FromDescriptor(nullptr, "Ljava/lang/Object;", true);
+  EXPECT_FALSE(imprecise_obj.Equals(precise_obj));
+  EXPECT_TRUE(precise_obj.IsPreciseReference());
+  EXPECT_TRUE(imprecise_obj.Equals(cache.FromDescriptor(nullptr, "Ljava/lang/Object;", false)));
+  EXPECT_TRUE(precise_obj.Equals(cache.FromDescriptor(nullptr, "Ljava/lang/Object;", true)));
+}
+
 TEST_F(RegTypeReferenceTest, UnresolvedUnintializedType) {
   // Tests creating types uninitialized types from unresolved types.
   ArenaStack stack(Runtime::Current()->GetArenaPool());
@@ -17,12 +17,15 @@
 #include "verifier_deps.h"
 
 #include <cstring>
+#include <unordered_map>
 
 #include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "base/stl_util.h"
+#include "class_linker.h"
 #include "compiler_callbacks.h"
 #include "dex_file-inl.h"
+#include "handle_scope-inl.h"
 #include "indenter.h"
 #include "leb128.h"
 #include "mirror/class-inl.h"
@@ -846,16 +849,6 @@ void VerifierDeps::Dump(VariableIndentationOutputStream* vios) const {
   }
 }
 
-bool VerifierDeps::ValidateDependencies(Handle<mirror::ClassLoader> class_loader,
-                                        Thread* self) const {
-  for (const auto& entry : dex_deps_) {
-    if (!VerifyDexFile(class_loader, *entry.first, *entry.second, self)) {
-      return false;
-    }
-  }
-  return true;
-}
-
 // TODO: share that helper with other parts of the compiler that have
 // the same lookup pattern.
 static mirror::Class* FindClassAndClearException(ClassLinker* class_linker,
@@ -871,23 +864,63 @@ static mirror::Class* FindClassAndClearException(ClassLinker* class_linker,
   return result;
 }
 
-bool VerifierDeps::VerifyAssignability(Handle<mirror::ClassLoader> class_loader,
+// Memoizes the classes looked up by descriptor while validating the dependencies, as the same
+// classes, such as java.lang.Object, are recorded by many dependencies of all the dex files.
+// Failed lookups are memoized too. The classes are held in handles so that they are kept
+// up to date across suspensions.
+class ClassResolutionCache {
+ public:
+  ClassResolutionCache(Thread* self, Handle<mirror::ClassLoader> class_loader)
+      : class_linker_(Runtime::Current()->GetClassLinker()),
+        class_loader_(class_loader),
+        handles_(self) {}
+
+  mirror::Class* FindClass(Thread* self, const char* descriptor)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    auto it = classes_.find(descriptor);
+    if (it != classes_.end()) {
+      return it->second.Get();
+    }
+    mirror::Class* result =
+        FindClassAndClearException(class_linker_, self, descriptor, class_loader_);
+    classes_.emplace(descriptor, handles_.NewHandle(result));
+    return result;
+  }
+
+ private:
+  ClassLinker* const class_linker_;
+  const Handle<mirror::ClassLoader> class_loader_;
+  VariableSizedHandleScope handles_;
+  std::unordered_map<std::string, Handle<mirror::Class>> classes_;
+
+  DISALLOW_COPY_AND_ASSIGN(ClassResolutionCache);
+};
+
+bool VerifierDeps::ValidateDependencies(Handle<mirror::ClassLoader> class_loader,
+                                        Thread* self) const {
+  ClassResolutionCache cache(self, class_loader);
+  for (const auto& entry : dex_deps_) {
+    if (!VerifyDexFile(&cache, *entry.first, *entry.second, self)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool VerifierDeps::VerifyAssignability(ClassResolutionCache* cache,
                                        const DexFile& dex_file,
                                        const std::set<TypeAssignability>& assignables,
                                        bool expected_assignability,
                                        Thread* self) const {
   StackHandleScope<2> hs(self);
-  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
   MutableHandle<mirror::Class> source(hs.NewHandle<mirror::Class>(nullptr));
   MutableHandle<mirror::Class> destination(hs.NewHandle<mirror::Class>(nullptr));
 
   for (const auto& entry : assignables) {
     const std::string& destination_desc = GetStringFromId(dex_file, entry.GetDestination());
-    destination.Assign(
-        FindClassAndClearException(class_linker, self, destination_desc.c_str(), class_loader));
+    destination.Assign(cache->FindClass(self, destination_desc.c_str()));
     const std::string& source_desc = GetStringFromId(dex_file, entry.GetSource());
-    source.Assign(
-        FindClassAndClearException(class_linker, self, source_desc.c_str(), class_loader));
+    source.Assign(cache->FindClass(self, source_desc.c_str()));
 
     if (destination == nullptr) {
       LOG(INFO) << "VerifiersDeps: Could not resolve class " << destination_desc;
@@ -912,16 +945,15 @@ bool VerifierDeps::VerifyAssignability(Handle<mirror::ClassLoader> class_loader,
   return true;
 }
 
-bool VerifierDeps::VerifyClasses(Handle<mirror::ClassLoader> class_loader,
+bool VerifierDeps::VerifyClasses(ClassResolutionCache* cache,
                                  const DexFile& dex_file,
                                  const std::set<ClassResolution>& classes,
                                  Thread* self) const {
   StackHandleScope<1> hs(self);
-  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
   MutableHandle<mirror::Class> cls(hs.NewHandle<mirror::Class>(nullptr));
   for (const auto& entry : classes) {
     const char* descriptor = dex_file.StringByTypeIdx(entry.GetDexTypeIndex());
-    cls.Assign(FindClassAndClearException(class_linker, self, descriptor, class_loader));
+    cls.Assign(cache->FindClass(self, descriptor));
 
     if (entry.IsResolved()) {
       if (cls == nullptr) {
@@ -955,13 +987,12 @@ static std::string GetFieldDescription(const DexFile& dex_file, uint32_t index)
       + dex_file.GetFieldTypeDescriptor(field_id);
 }
 
-bool VerifierDeps::VerifyFields(Handle<mirror::ClassLoader> class_loader,
+bool VerifierDeps::VerifyFields(ClassResolutionCache* cache,
                                 const DexFile& dex_file,
                                 const std::set<FieldResolution>& fields,
                                 Thread* self) const {
   // Check recorded fields are resolved the same way, have the same recorded class,
   // and have the same recorded flags.
-  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
   for (const auto& entry : fields) {
     const DexFile::FieldId& field_id = dex_file.GetFieldId(entry.GetDexFieldIndex());
     StringPiece name(dex_file.StringDataByIdx(field_id.name_idx_));
@@ -971,8 +1002,7 @@ bool VerifierDeps::VerifyFields(Handle<mirror::ClassLoader> class_loader,
     std::string expected_decl_klass = entry.IsResolved()
         ? GetStringFromId(dex_file, entry.GetDeclaringClassIndex())
         : dex_file.StringByTypeIdx(field_id.class_idx_);
-    mirror::Class* cls = FindClassAndClearException(
-        class_linker, self, expected_decl_klass.c_str(), class_loader);
+    mirror::Class* cls = cache->FindClass(self, expected_decl_klass.c_str());
     if (cls == nullptr) {
       LOG(INFO) << "VerifierDeps: Could not resolve class " << expected_decl_klass;
       return false;
@@ -1016,7 +1046,7 @@ static std::string GetMethodDescription(const DexFile& dex_file, uint32_t index)
       + dex_file.GetMethodSignature(method_id).ToString();
 }
 
-bool VerifierDeps::VerifyMethods(Handle<mirror::ClassLoader> class_loader,
+bool VerifierDeps::VerifyMethods(ClassResolutionCache* cache,
                                  const DexFile& dex_file,
                                  const std::set<MethodResolution>& methods,
                                  Thread* self) const {
@@ -1034,8 +1064,7 @@ bool VerifierDeps::VerifyMethods(Handle<mirror::ClassLoader> class_loader,
         ? GetStringFromId(dex_file, entry.GetDeclaringClassIndex())
         : dex_file.StringByTypeIdx(method_id.class_idx_);
 
-    mirror::Class* cls = FindClassAndClearException(
-        class_linker, self, expected_decl_klass.c_str(), class_loader);
+    mirror::Class* cls = cache->FindClass(self, expected_decl_klass.c_str());
     if (cls == nullptr) {
       LOG(INFO) << "VerifierDeps: Could not resolve class " << expected_decl_klass;
       return false;
@@ -1083,19 +1112,19 @@ bool VerifierDeps::VerifyMethods(Handle<mirror::ClassLoader> class_loader,
   return true;
 }
 
-bool VerifierDeps::VerifyDexFile(Handle<mirror::ClassLoader> class_loader,
+bool VerifierDeps::VerifyDexFile(ClassResolutionCache* cache,
                                  const DexFile& dex_file,
                                  const DexFileDeps& deps,
                                  Thread* self) const {
   bool result = VerifyAssignability(
-      class_loader, dex_file, deps.assignable_types_, /* expected_assignability */ true, self);
+      cache, dex_file, deps.assignable_types_, /* expected_assignability */ true, self);
   result = result && VerifyAssignability(
-      class_loader, dex_file, deps.unassignable_types_, /* expected_assignability */ false, self);
+      cache, dex_file, deps.unassignable_types_, /* expected_assignability */ false, self);
 
-  result = result && VerifyClasses(class_loader, dex_file, deps.classes_, self);
-  result = result && VerifyFields(class_loader, dex_file, deps.fields_, self);
+  result = result && VerifyClasses(cache, dex_file, deps.classes_, self);
+  result = result && VerifyFields(cache, dex_file, deps.fields_, self);
 
-  result = result && VerifyMethods(class_loader, dex_file, deps.methods_, self);
+  result = result && VerifyMethods(cache, dex_file, deps.methods_, self);
 
   return result;
 }
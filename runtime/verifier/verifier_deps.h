@@ -43,6 +43,8 @@ class ClassLoader;
 
 namespace verifier {
 
+class ClassResolutionCache;
+
 // Verification dependencies collector class used by the MethodVerifier to record
 // resolution outcomes and type assignability tests of classes/methods/fields
 // not present in the set of compiled DEX files, that is classes/methods/fields
@@ -284,13 +286,13 @@ class VerifierDeps {
   // Verify `dex_file` according to the `deps`, that is going over each
   // `DexFileDeps` field, and checking that the recorded information still
   // holds.
-  bool VerifyDexFile(Handle<mirror::ClassLoader> class_loader,
+  bool VerifyDexFile(ClassResolutionCache* cache,
                      const DexFile& dex_file,
                      const DexFileDeps& deps,
                      Thread* self) const
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  bool VerifyAssignability(Handle<mirror::ClassLoader> class_loader,
+  bool VerifyAssignability(ClassResolutionCache* cache,
                            const DexFile& dex_file,
                            const std::set<TypeAssignability>& assignables,
                            bool expected_assignability,
@@ -299,7 +301,7 @@ class VerifierDeps {
 
   // Verify that the set of resolved classes at the point of creation
   // of this `VerifierDeps` is still the same.
-  bool VerifyClasses(Handle<mirror::ClassLoader> class_loader,
+  bool VerifyClasses(ClassResolutionCache* cache,
                      const DexFile& dex_file,
                      const std::set<ClassResolution>& classes,
                      Thread* self) const
@@ -308,7 +310,7 @@ class VerifierDeps {
   // Verify that the set of resolved fields at the point of creation
   // of this `VerifierDeps` is still the same, and each field resolves to the
   // same field holder and access flags.
-  bool VerifyFields(Handle<mirror::ClassLoader> class_loader,
+  bool VerifyFields(ClassResolutionCache* cache,
                     const DexFile& dex_file,
                     const std::set<FieldResolution>& classes,
                     Thread* self) const
@@ -318,7 +320,7 @@ class VerifierDeps {
   // Verify that the set of resolved methods at the point of creation
   // of this `VerifierDeps` is still the same, and each method resolves to the
   // same method holder, access flags, and invocation kind.
-  bool VerifyMethods(Handle<mirror::ClassLoader> class_loader,
+  bool VerifyMethods(ClassResolutionCache* cache,
                      const DexFile& dex_file,
                      const std::set<MethodResolution>& methods,
                      Thread* self) const
@@ -92,6 +92,31 @@ MemMap* ZipEntry::ExtractToMemMap(const char* zip_filename, const char* entry_fi
   return map.release();
 }
 
+MemMap* ZipEntry::MapDirectlyOrExtract(const char* zip_filename,
+                                       const char* entry_filename,
+                                       size_t alignment,
+                                       std::string* extract_reason,
+                                       std::string* error_msg) {
+  extract_reason->clear();
+  if (!IsUncompressed()) {
+    *extract_reason = "the entry is compressed";
+  } else if (!IsAlignedTo(alignment)) {
+    *extract_reason = StringPrintf("the entry is not aligned to %zu bytes, please zipalign",
+                                   alignment);
+  } else if (GetFileDescriptor(handle_) < 0) {
+    *extract_reason = "the zip archive is not file backed";
+  } else {
+    std::string map_error_msg;
+    MemMap* map = MapDirectlyFromFile(zip_filename, &map_error_msg);
+    if (map != nullptr) {
+      return map;
+    }
+    // Extraction still has a chance of recovery.
+    *extract_reason = "mapping failed: " + map_error_msg;
+  }
+  return ExtractToMemMap(zip_filename, entry_filename, error_msg);
+}
+
 MemMap* ZipEntry::MapDirectlyFromFile(const char* zip_filename, std::string* error_msg) {
   const int zip_fd = GetFileDescriptor(handle_);
   const char* entry_filename = entry_name_.c_str();
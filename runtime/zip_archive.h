@@ -53,6 +53,15 @@ class ZipEntry {
   // Will only succeed if the entry is stored uncompressed.
   // Returns null on failure and sets error_msg.
   MemMap* MapDirectlyFromFile(const char* zip_filename, /*out*/std::string* error_msg);
+  // Maps this entry directly from the file if it is stored uncompressed at an offset aligned to
+  // `alignment`, so that its pages stay file-backed and clean, and extracts it otherwise.
+  // If the entry is extracted, sets 'extract_reason' to why it was not mapped directly.
+  // Returns null on failure and sets error_msg.
+  MemMap* MapDirectlyOrExtract(const char* zip_filename,
+                               const char* entry_filename,
+                               size_t alignment,
+                               /*out*/std::string* extract_reason,
+                               /*out*/std::string* error_msg);
   virtual ~ZipEntry();
 
   uint32_t GetUncompressedLength();
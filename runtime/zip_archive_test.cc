@@ -63,4 +63,26 @@ TEST_F(ZipArchiveTest, FindAndExtract) {
   EXPECT_EQ(zip_entry->GetCrc32(), computed_crc);
 }
 
+TEST_F(ZipArchiveTest, MapDirectlyOrExtract) {
+  std::string error_msg;
+  const std::string zip_filename = GetLibCoreDexFileNames()[0];
+  std::unique_ptr<ZipArchive> zip_archive(ZipArchive::Open(zip_filename.c_str(), &error_msg));
+  ASSERT_TRUE(zip_archive != nullptr) << error_msg;
+  std::unique_ptr<ZipEntry> zip_entry(zip_archive->Find("classes.dex", &error_msg));
+  ASSERT_TRUE(zip_entry != nullptr) << error_msg;
+
+  std::string extract_reason;
+  std::unique_ptr<MemMap> map(zip_entry->MapDirectlyOrExtract(zip_filename.c_str(),
+                                                              "classes.dex",
+                                                              /* alignment */ 4u,
+                                                              &extract_reason,
+                                                              &error_msg));
+  ASSERT_TRUE(map != nullptr) << error_msg;
+  ASSERT_EQ(zip_entry->GetUncompressedLength(), map->Size());
+  EXPECT_EQ(zip_entry->GetCrc32(), crc32(crc32(0L, Z_NULL, 0), map->Begin(), map->Size()));
+  // The entry is only mapped directly if it is stored uncompressed and aligned.
+  EXPECT_EQ(!zip_entry->IsUncompressed() || !zip_entry->IsAlignedTo(4u), !extract_reason.empty())
+      << extract_reason;
+}
+
 }  // namespace art
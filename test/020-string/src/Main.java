@@ -26,6 +26,7 @@ public class Main {
         indexTest();
         constructorTest();
         copyTest();
+        equalsAndCompareToTest();
     }
 
     public static void basicTest() {
@@ -169,4 +170,48 @@ public class Main {
         src.getChars(2, 9, dst, 0);
         System.out.println(new String(dst));
     }
+
+    // Covers each length and position of the first difference around the 8 and 16 byte blocks
+    // compared at a time, for compressed and uncompressed strings.
+    public static void equalsAndCompareToTest() {
+        for (char base : new char[] { 'a', '\u0100' }) {
+            for (int length = 0; length <= 40; ++length) {
+                String s = makeString(base, length);
+                expectEquals(true, s.equals(makeString(base, length)));
+                expectEquals(0, s.compareTo(makeString(base, length)));
+                expectEquals(false, s.equals(makeString(base, length + 1)));
+                expectEquals(-1, s.compareTo(makeString(base, length + 1)));
+                for (int pos = 0; pos < length; ++pos) {
+                    char[] chars = s.toCharArray();
+                    chars[pos] += 2;
+                    String other = new String(chars);
+                    expectEquals(false, s.equals(other));
+                    expectEquals(false, other.equals(s));
+                    expectEquals(-2, s.compareTo(other));
+                    expectEquals(2, other.compareTo(s));
+                }
+            }
+        }
+        System.out.println("equals and compareTo passed");
+    }
+
+    private static String makeString(char base, int length) {
+        char[] chars = new char[length];
+        for (int i = 0; i < length; ++i) {
+            chars[i] = (char) (base + (i % 26));
+        }
+        return new String(chars);
+    }
+
+    private static void expectEquals(boolean expected, boolean result) {
+        if (expected != result) {
+            throw new Error("Expected: " + expected + ", found: " + result);
+        }
+    }
+
+    private static void expectEquals(int expected, int result) {
+        if (expected != result) {
+            throw new Error("Expected: " + expected + ", found: " + result);
+        }
+    }
 }
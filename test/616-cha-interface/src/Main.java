@@ -17,6 +17,7 @@
 interface Base {
   void foo(int i);
   void $noinline$bar();
+  int $noinline$baz(int i);
 }
 
 class Main1 implements Base {
@@ -38,6 +39,20 @@ class Main1 implements Base {
     System.out.print("");
   }
 
+  // Test calling the single implementation directly when inlining fails, which must
+  // not survive the loading of Main2 that overrides it.
+  public int $noinline$baz(int i) {
+    System.out.print("");
+    System.out.print("");
+    System.out.print("");
+    System.out.print("");
+    System.out.print("");
+    System.out.print("");
+    System.out.print("");
+    System.out.print("");
+    return i;
+  }
+
   void printError(String msg) {
     System.out.println(msg);
   }
@@ -49,6 +64,10 @@ class Main2 extends Main1 {
       printError("error2");
     }
   }
+
+  public int $noinline$baz(int i) {
+    return -i;
+  }
 }
 
 public class Main {
@@ -84,6 +103,9 @@ public class Main {
 
     sMain1.foo(sMain1.getClass() == Main1.class ? 1 : 2);
     sMain1.$noinline$bar();
+    if (sMain1.$noinline$baz(1) != 1) {
+      System.out.println("1 expected.");
+    }
 
     if (createMain2) {
       // Wait for the other thread to start.
@@ -119,6 +141,9 @@ public class Main {
 
     if (sMain2 != null) {
       sMain2.foo(sMain2.getClass() == Main1.class ? 1 : 2);
+      if (sMain2.$noinline$baz(2) != -2) {
+        System.out.println("-2 expected.");
+      }
     }
   }
 
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class Point {
+  int x;
+  int y;
+}
+
+public class Main {
+
+  public static void main(String[] args) {
+    System.out.println(testEscapeOnThrow(1, 2));
+    doThrow = true;
+    try {
+      testEscapeOnThrow(1, 2);
+    } catch (Error e) {
+      // expected
+      System.out.println(e.getMessage());
+    }
+    System.out.println(testEscapeOnCommonPath(3, 4));
+  }
+
+  /// CHECK-START: int Main.testEscapeOnThrow(int, int) partial_escape_analysis (before)
+  /// CHECK: <<LoadClass:l\d+>> LoadClass class_name:Point
+  /// CHECK: <<New:l\d+>>       NewInstance [<<LoadClass>>]
+  /// CHECK:                    If
+  /// CHECK:                    begin_block
+  /// CHECK:                    InvokeStaticOrDirect [<<New>>{{.*}}] method_name:Main.$noinline$describe
+  /// CHECK:                    Throw
+
+  /// CHECK-START: int Main.testEscapeOnThrow(int, int) partial_escape_analysis (after)
+  /// CHECK: <<LoadClass:l\d+>> LoadClass class_name:Point
+  /// CHECK: <<New:l\d+>>       NewInstance [<<LoadClass>>]
+  /// CHECK:                    If
+  /// CHECK:                    begin_block
+  /// CHECK: <<Copy:l\d+>>      NewInstance [<<LoadClass>>]
+  /// CHECK:                    InstanceFieldSet [<<Copy>>,{{i\d+}}]
+  /// CHECK:                    InstanceFieldSet [<<Copy>>,{{i\d+}}]
+  /// CHECK:                    ConstructorFence [<<Copy>>]
+  /// CHECK:                    InvokeStaticOrDirect [<<Copy>>{{.*}}] method_name:Main.$noinline$describe
+  /// CHECK:                    Throw
+
+  /// CHECK-START: int Main.testEscapeOnThrow(int, int) load_store_elimination (after)
+  /// CHECK: <<LoadClass:l\d+>> LoadClass class_name:Point
+  /// CHECK-NOT:                NewInstance
+  /// CHECK:                    If
+  /// CHECK:                    begin_block
+  /// CHECK: <<Copy:l\d+>>      NewInstance [<<LoadClass>>]
+  /// CHECK:                    InvokeStaticOrDirect [<<Copy>>{{.*}}] method_name:Main.$noinline$describe
+  /// CHECK:                    Throw
+
+  /// CHECK-START: int Main.testEscapeOnThrow(int, int) load_store_elimination (after)
+  /// CHECK-NOT:                InstanceFieldGet
+  public static int testEscapeOnThrow(int x, int y) {
+    Point p = new Point();
+    p.x = x;
+    p.y = y;
+    if (doThrow) {
+      throw new Error($noinline$describe(p));
+    }
+    return p.x + p.y;
+  }
+
+  /// CHECK-START: int Main.testEscapeOnCommonPath(int, int) partial_escape_analysis (after)
+  /// CHECK:                    NewInstance
+  /// CHECK-NOT:                NewInstance
+  public static int testEscapeOnCommonPath(int x, int y) {
+    Point p = new Point();
+    p.x = x;
+    p.y = y;
+    if (doThrow) {
+      throw new Error();
+    }
+    $noinline$describe(p);
+    return p.x + p.y;
+  }
+
+  public static String $noinline$describe(Point p) {
+    return "Point(" + p.x + ", " + p.y + ")";
+  }
+
+  static boolean doThrow = false;
+}
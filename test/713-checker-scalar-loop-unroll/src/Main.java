@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for the unrolling of scalar loops that cannot be vectorized.
+ */
+public class Main {
+
+  static class Node {
+    int value;
+
+    Node(int value) {
+      this.value = value;
+    }
+  }
+
+  /// CHECK-START-{ARM64,X86_64}: int Main.sumValues(Main$Node[]) loop_optimization (before)
+  /// CHECK:     InstanceFieldGet loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-NOT: InstanceFieldGet
+  //
+  /// CHECK-START-{ARM64,X86_64}: int Main.sumValues(Main$Node[]) loop_optimization (after)
+  /// CHECK:      InstanceFieldGet loop:<<Rem:B\d+>>  outer_loop:none
+  /// CHECK:      InstanceFieldGet loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK:      InstanceFieldGet loop:<<Loop>>      outer_loop:none
+  /// CHECK-EVAL: "<<Rem>>" != "<<Loop>>"
+  static int sumValues(Node[] nodes) {
+    int sum = 0;
+    for (int i = 0; i < nodes.length; i++) {
+      sum += nodes[i].value;
+    }
+    return sum;
+  }
+
+  static Node[] makeNodes(int n) {
+    Node[] nodes = new Node[n];
+    for (int i = 0; i < n; i++) {
+      nodes[i] = new Node(i + 1);
+    }
+    return nodes;
+  }
+
+  public static void main(String[] args) {
+    // Cover all the remainders of the unrolled loop.
+    for (int n = 0; n <= 9; n++) {
+      expectEquals(n * (n + 1) / 2, sumValues(makeNodes(n)));
+    }
+    // A null reference throws from the middle of the unrolled loop.
+    Node[] nodes = makeNodes(9);
+    nodes[6] = null;
+    try {
+      sumValues(nodes);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+      // Expected.
+    }
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for the vectorization of min/max written as conditionals.
+ */
+public class Main {
+
+  /// CHECK-START: int Main.selectMinReduction(int[]) loop_optimization (before)
+  /// CHECK-DAG:              Phi                           loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG:              ArrayGet                      loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:              Select [{{i\d+}},{{i\d+}},{{z\d+}}] loop:<<Loop>> outer_loop:none
+  //
+  /// CHECK-START-{ARM64,X86_64}: int Main.selectMinReduction(int[]) loop_optimization (after)
+  /// CHECK-DAG: <<Set:d\d+>>  VecReplicateScalar            loop:none
+  /// CHECK-DAG: <<Phi:d\d+>>  Phi [<<Set>>,{{d\d+}}]        loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Load:d\d+>> VecLoad                       loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:               VecMin [<<Load>>,<<Phi>>]     loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Red:d\d+>>  VecReduce [<<Phi>>]           loop:none
+  /// CHECK-DAG:               VecExtractScalar [<<Red>>]    loop:none
+  private static int selectMinReduction(int[] x) {
+    int min = Integer.MAX_VALUE;
+    for (int i = 0; i < x.length; i++) {
+      int v = x[i];
+      min = v < min ? v : min;
+    }
+    return min;
+  }
+
+  /// CHECK-START-{ARM64,X86_64}: int Main.selectMaxReduction(int[]) loop_optimization (after)
+  /// CHECK-DAG: <<Phi:d\d+>>  Phi                           loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Load:d\d+>> VecLoad                       loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:               VecMax [<<Phi>>,<<Load>>]     loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Red:d\d+>>  VecReduce [<<Phi>>]           loop:none
+  private static int selectMaxReduction(int[] x) {
+    int max = Integer.MIN_VALUE;
+    for (int i = 0; i < x.length; i++) {
+      int v = x[i];
+      max = max >= v ? max : v;
+    }
+    return max;
+  }
+
+  /// CHECK-START-{ARM64,X86_64}: void Main.selectMin(int[], int[], int[]) loop_optimization (after)
+  /// CHECK-DAG: <<Ld1:d\d+>>  VecLoad                       loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Ld2:d\d+>>  VecLoad                       loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Min:d\d+>>  VecMin [<<Ld1>>,<<Ld2>>]      loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:               VecStore [{{l\d+}},{{i\d+}},<<Min>>] loop:<<Loop>> outer_loop:none
+  private static void selectMin(int[] a, int[] b, int[] c) {
+    for (int i = 0; i < c.length; i++) {
+      int x = a[i];
+      int y = b[i];
+      c[i] = x <= y ? x : y;
+    }
+  }
+
+  /// CHECK-START-X86_64: long Main.selectMaxLongReduction(long[]) loop_optimization (after)
+  /// CHECK-DAG: <<Phi:d\d+>>  Phi                           loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Load:d\d+>> VecLoad                       loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:               VecMax [<<Load>>,<<Phi>>]     loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Red:d\d+>>  VecReduce [<<Phi>>]           loop:none
+  private static long selectMaxLongReduction(long[] x) {
+    long max = Long.MIN_VALUE;
+    for (int i = 0; i < x.length; i++) {
+      long v = x[i];
+      max = v > max ? v : max;
+    }
+    return max;
+  }
+
+  public static void main(String[] args) {
+    int[] a = new int[100];
+    int[] b = new int[100];
+    int[] c = new int[100];
+    long[] l = new long[100];
+    for (int i = 0; i < 100; i++) {
+      a[i] = (i * 37) % 101 - 50;
+      b[i] = 25 - i;
+      l[i] = (long) a[i] << 33;
+    }
+    expectEquals(-50, selectMinReduction(a));
+    expectEquals(50, selectMaxReduction(a));
+    expectEquals(Long.MIN_VALUE, selectMaxLongReduction(new long[0]));
+    expectEquals(50L << 33, selectMaxLongReduction(l));
+    selectMin(a, b, c);
+    for (int i = 0; i < 100; i++) {
+      expectEquals(Math.min(a[i], b[i]), c[i]);
+    }
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(long expected, long result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
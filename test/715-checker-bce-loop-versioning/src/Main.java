@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for the elimination of bounds checks in a copy of their loop, for loops
+ * in which deoptimization does not apply.
+ */
+public class Main {
+
+  // An early exit stops the loop before the end of the tested range.
+  //
+  /// CHECK-START: int Main.indexOf(int[], int, int) BCE (before)
+  /// CHECK:     BoundsCheck loop:<<Loop:B\d+>>
+  /// CHECK-NOT: BoundsCheck
+  //
+  /// CHECK-START: int Main.indexOf(int[], int, int) BCE (after)
+  /// CHECK-DAG:  ArrayGet [{{l\d+}},<<Bounds:i\d+>>] loop:<<Slow:B\d+>>
+  /// CHECK-DAG:  <<Bounds>> BoundsCheck            loop:<<Slow>>
+  /// CHECK-DAG:  ArrayGet [{{l\d+}},<<Phi:i\d+>>]    loop:<<Fast:B\d+>>
+  /// CHECK-DAG:  <<Phi>>    Phi                    loop:<<Fast>>
+  /// CHECK-EVAL: "<<Slow>>" != "<<Fast>>"
+  //
+  /// CHECK-START: int Main.indexOf(int[], int, int) BCE (after)
+  /// CHECK:     BoundsCheck
+  /// CHECK-NOT: BoundsCheck
+  //
+  /// CHECK-START: int Main.indexOf(int[], int, int) BCE (after)
+  /// CHECK-NOT: Deoptimize
+  static int indexOf(int[] a, int x, int n) {
+    for (int i = 0; i < n; i++) {
+      if (a[i] == x) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // The array access is not executed in each iteration.
+  //
+  /// CHECK-START: int Main.sumEven(int[], int) BCE (after)
+  /// CHECK-DAG:  ArrayGet [{{l\d+}},<<Bounds:i\d+>>] loop:<<Slow:B\d+>>
+  /// CHECK-DAG:  <<Bounds>> BoundsCheck            loop:<<Slow>>
+  /// CHECK-DAG:  ArrayGet [{{l\d+}},<<Phi:i\d+>>]    loop:<<Fast:B\d+>>
+  /// CHECK-DAG:  <<Phi>>    Phi                    loop:<<Fast>>
+  /// CHECK-EVAL: "<<Slow>>" != "<<Fast>>"
+  //
+  /// CHECK-START: int Main.sumEven(int[], int) BCE (after)
+  /// CHECK:     BoundsCheck
+  /// CHECK-NOT: BoundsCheck
+  //
+  /// CHECK-START: int Main.sumEven(int[], int) BCE (after)
+  /// CHECK-NOT: Deoptimize
+  static int sumEven(int[] a, int n) {
+    int sum = 0;
+    for (int i = 0; i < n; i++) {
+      if ((i & 1) == 0) {
+        sum += a[i];
+      }
+    }
+    return sum;
+  }
+
+  public static void main(String[] args) {
+    int[] a = { 1, 2, 3, 4, 5 };
+
+    expectEquals(2, indexOf(a, 3, 5));
+    expectEquals(-1, indexOf(a, 3, 2));
+    expectEquals(-1, indexOf(a, 9, 0));
+    expectEquals(-1, indexOf(null, 9, 0));
+    // The original loop finds the value before the first access out of bounds.
+    expectEquals(2, indexOf(a, 3, 100));
+    try {
+      indexOf(a, 9, 6);
+      throw new Error("Expected ArrayIndexOutOfBoundsException");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      indexOf(null, 9, 1);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+
+    expectEquals(9, sumEven(a, 5));
+    expectEquals(4, sumEven(a, 3));
+    expectEquals(0, sumEven(a, -1));
+    // The odd index out of bounds is not accessed.
+    expectEquals(9, sumEven(a, 6));
+    try {
+      sumEven(a, 7);
+      throw new Error("Expected ArrayIndexOutOfBoundsException");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.invoke.MethodHandles;
+import java.lang.invoke.VarHandle;
+
+/**
+ * Checker test on the VarHandle accessors compiled for int and long fields and
+ * array elements. The compiled code checks the VarHandle and the coordinates, and
+ * falls back to the runtime for everything else.
+ */
+public class Main {
+
+  private int intField;
+  private long longField;
+  private Object objectField;
+  private static int staticIntField;
+
+  private static final VarHandle INT_FIELD;
+  private static final VarHandle LONG_FIELD;
+  private static final VarHandle OBJECT_FIELD;
+  private static final VarHandle STATIC_INT_FIELD;
+  private static final VarHandle INT_ARRAY;
+  private static final VarHandle LONG_ARRAY;
+
+  static {
+    try {
+      MethodHandles.Lookup lookup = MethodHandles.lookup();
+      INT_FIELD = lookup.findVarHandle(Main.class, "intField", int.class);
+      LONG_FIELD = lookup.findVarHandle(Main.class, "longField", long.class);
+      OBJECT_FIELD = lookup.findVarHandle(Main.class, "objectField", Object.class);
+      STATIC_INT_FIELD = lookup.findStaticVarHandle(Main.class, "staticIntField", int.class);
+      INT_ARRAY = MethodHandles.arrayElementVarHandle(int[].class);
+      LONG_ARRAY = MethodHandles.arrayElementVarHandle(long[].class);
+    } catch (ReflectiveOperationException e) {
+      throw new Error(e);
+    }
+  }
+
+  //
+  // Instance fields.
+  //
+
+  /// CHECK-START: int Main.getInt(Main) intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleGet
+  private static int getInt(Main m) {
+    return (int) INT_FIELD.get(m);
+  }
+
+  /// CHECK-START: long Main.getLongVolatile(Main) intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleGetVolatile
+  private static long getLongVolatile(Main m) {
+    return (long) LONG_FIELD.getVolatile(m);
+  }
+
+  /// CHECK-START: void Main.setIntRelease(Main, int) intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleSetRelease
+  private static void setIntRelease(Main m, int value) {
+    INT_FIELD.setRelease(m, value);
+  }
+
+  /// CHECK-START: void Main.setLongVolatile(Main, long) intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleSetVolatile
+  private static void setLongVolatile(Main m, long value) {
+    LONG_FIELD.setVolatile(m, value);
+  }
+
+  /// CHECK-START: boolean Main.casInt(Main, int, int) intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleCompareAndSet
+  private static boolean casInt(Main m, int expected, int value) {
+    return (boolean) INT_FIELD.compareAndSet(m, expected, value);
+  }
+
+  /// CHECK-START: long Main.getAndAddLong(Main, long) intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleGetAndAdd
+  private static long getAndAddLong(Main m, long delta) {
+    return (long) LONG_FIELD.getAndAdd(m, delta);
+  }
+
+  //
+  // Array elements.
+  //
+
+  /// CHECK-START: int Main.getIntAcquire(int[], int) intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleGetAcquire
+  private static int getIntAcquire(int[] array, int index) {
+    return (int) INT_ARRAY.getAcquire(array, index);
+  }
+
+  /// CHECK-START: void Main.setLong(long[], int, long) intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleSet
+  private static void setLong(long[] array, int index, long value) {
+    LONG_ARRAY.set(array, index, value);
+  }
+
+  /// CHECK-START: boolean Main.casLong(long[], int, long, long) intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleCompareAndSet
+  private static boolean casLong(long[] array, int index, long expected, long value) {
+    return (boolean) LONG_ARRAY.compareAndSet(array, index, expected, value);
+  }
+
+  /// CHECK-START: int Main.getAndAddIntAcquire(int[], int, int) intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleGetAndAddAcquire
+  private static int getAndAddIntAcquire(int[] array, int index, int delta) {
+    return (int) INT_ARRAY.getAndAddAcquire(array, index, delta);
+  }
+
+  //
+  // Accesses left to the runtime.
+  //
+
+  /// CHECK-START: java.lang.Object Main.getObject(Main) intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleGet
+  private static Object getObject(Main m) {
+    return (Object) OBJECT_FIELD.get(m);
+  }
+
+  /// CHECK-START: int Main.getStaticInt() intrinsics_recognition (after)
+  /// CHECK-DAG: InvokePolymorphic intrinsic:VarHandleGet
+  private static int getStaticInt() {
+    return (int) STATIC_INT_FIELD.get();
+  }
+
+  // The VarHandle is not known, the compiled code checks its type.
+  private static int getIntWithHandle(VarHandle vh, Main m) {
+    return (int) vh.get(m);
+  }
+
+  //
+  // Driver.
+  //
+
+  public static void main(String[] args) {
+    System.out.println("starting");
+
+    Main m = new Main();
+    setIntRelease(m, 42);
+    expectEquals(42, getInt(m));
+    expectEquals(true, casInt(m, 42, 43));
+    expectEquals(false, casInt(m, 42, 44));
+    expectEquals(43, getInt(m));
+    setLongVolatile(m, 1L << 40);
+    expectEquals(1L << 40, getAndAddLong(m, 5L));
+    expectEquals((1L << 40) + 5L, getLongVolatile(m));
+
+    int[] ints = { 1, 2, 3 };
+    long[] longs = { 4L, 5L, 6L };
+    expectEquals(3, getIntAcquire(ints, 2));
+    expectEquals(2, getAndAddIntAcquire(ints, 1, 10));
+    expectEquals(12, getIntAcquire(ints, 1));
+    setLong(longs, 0, -1L);
+    expectEquals(true, casLong(longs, 0, -1L, 7L));
+    expectEquals(false, casLong(longs, 0, -1L, 8L));
+    expectEquals(7L, longs[0]);
+
+    m.objectField = ints;
+    expectEquals(true, getObject(m) == ints);
+    staticIntField = 17;
+    expectEquals(17, getStaticInt());
+    expectEquals(43, getIntWithHandle(INT_FIELD, m));
+
+    // The runtime throws the exceptions when the checks fail.
+    try {
+      getInt(null);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+    try {
+      getIntAcquire(ints, 3);
+      throw new Error("Expected ArrayIndexOutOfBoundsException");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      getIntAcquire(ints, -1);
+      throw new Error("Expected ArrayIndexOutOfBoundsException");
+    } catch (ArrayIndexOutOfBoundsException expected) {
+    }
+    try {
+      getIntWithHandle(LONG_FIELD, m);
+      throw new Error("Expected WrongMethodTypeException");
+    } catch (java.lang.invoke.WrongMethodTypeException expected) {
+    }
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(long expected, long result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(boolean expected, boolean result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
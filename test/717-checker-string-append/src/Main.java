@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for the replacement of `new StringBuilder().append(...)...toString()` chains with a
+ * single StringBuilderAppend.
+ */
+public class Main {
+
+  /// CHECK-START-{ARM64,X86_64}: java.lang.String Main.append2(java.lang.String, java.lang.String) instruction_simplifier (before)
+  /// CHECK:     NewInstance
+  /// CHECK:     InvokeVirtual intrinsic:StringBuilderToString
+  //
+  /// CHECK-START-{ARM64,X86_64}: java.lang.String Main.append2(java.lang.String, java.lang.String) instruction_simplifier (after)
+  /// CHECK-DAG: <<A:l\d+>>   ParameterValue
+  /// CHECK-DAG: <<B:l\d+>>   ParameterValue
+  /// CHECK-DAG: <<Fmt:i\d+>> IntConstant 17
+  /// CHECK-DAG: <<Str:l\d+>> StringBuilderAppend [<<A>>,<<B>>,<<Fmt>>]
+  /// CHECK-DAG:              Return [<<Str>>]
+  //
+  /// CHECK-START-{ARM64,X86_64}: java.lang.String Main.append2(java.lang.String, java.lang.String) instruction_simplifier (after)
+  /// CHECK-NOT: NewInstance
+  /// CHECK-NOT: InvokeStaticOrDirect
+  /// CHECK-NOT: InvokeVirtual
+  static String append2(String a, String b) {
+    return new StringBuilder().append(a).append(b).toString();
+  }
+
+  /// CHECK-START-{ARM64,X86_64}: java.lang.String Main.append8(java.lang.String) instruction_simplifier (after)
+  /// CHECK:     StringBuilderAppend
+  /// CHECK-NOT: InvokeVirtual
+  static String append8(String a) {
+    return new StringBuilder()
+        .append(a).append(a).append(a).append(a).append(a).append(a).append(a).append(a)
+        .toString();
+  }
+
+  // There are more arguments than the format can describe.
+  //
+  /// CHECK-START: java.lang.String Main.append9(java.lang.String) instruction_simplifier (after)
+  /// CHECK-NOT: StringBuilderAppend
+  static String append9(String a) {
+    return new StringBuilder()
+        .append(a).append(a).append(a).append(a).append(a).append(a).append(a).append(a)
+        .append(a).toString();
+  }
+
+  // The StringBuilder escapes into a call.
+  //
+  /// CHECK-START: java.lang.String Main.appendEscaping(java.lang.String) instruction_simplifier (after)
+  /// CHECK-NOT: StringBuilderAppend
+  static String appendEscaping(String a) {
+    StringBuilder sb = new StringBuilder().append(a);
+    $noinline$use(sb);
+    return sb.append(a).toString();
+  }
+
+  static void $noinline$use(StringBuilder sb) {
+    sb.append('!');
+  }
+
+  public static void main(String[] args) {
+    expectEquals("ab", append2("a", "b"));
+    expectEquals("a", append2("a", ""));
+    expectEquals("", append2("", ""));
+    expectEquals("nullb", append2(null, "b"));
+    expectEquals("nullnull", append2(null, null));
+    // Mixing compressed and uncompressed strings.
+    expectEquals("a\u0100", append2("a", "\u0100"));
+    expectEquals("\u0100\u0101", append2("\u0100", "\u0101"));
+    expectEquals("xyxyxyxyxyxyxyxy", append8("xy"));
+    expectEquals("nullnullnullnullnullnullnullnull", append8(null));
+    expectEquals("aaaaaaaaa", append9("a"));
+    expectEquals("a!a", appendEscaping("a"));
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(String expected, String result) {
+    if (!expected.equals(result)) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
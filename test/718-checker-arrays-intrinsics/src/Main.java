@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.Arrays;
+
+public class Main {
+
+  /// CHECK-START: void Main.fill(byte[], byte) builder (after)
+  /// CHECK-DAG: InvokeStaticOrDirect intrinsic:ArraysFillByte
+  static void fill(byte[] a, byte value) {
+    Arrays.fill(a, value);
+  }
+
+  /// CHECK-START: boolean Main.equals(byte[], byte[]) builder (after)
+  /// CHECK-DAG: InvokeStaticOrDirect intrinsic:ArraysEqualsByte
+  static boolean equals(byte[] a, byte[] b) {
+    return Arrays.equals(a, b);
+  }
+
+  /// CHECK-START: int Main.hashCode(byte[]) builder (after)
+  /// CHECK-DAG: InvokeStaticOrDirect intrinsic:ArraysHashCodeByte
+  static int hashCode(byte[] a) {
+    return Arrays.hashCode(a);
+  }
+
+  static int referenceHashCode(byte[] a) {
+    int result = 1;
+    for (byte b : a) {
+      result = 31 * result + b;
+    }
+    return result;
+  }
+
+  public static void main(String[] args) {
+    // Lengths around the 16 and 4 bytes handled at a time.
+    for (int length = 0; length <= 40; length++) {
+      byte[] a = new byte[length];
+      byte[] b = new byte[length];
+      fill(a, (byte) -3);
+      for (int i = 0; i < length; i++) {
+        expectEquals(-3, a[i]);
+        b[i] = (byte) -3;
+      }
+      expectEquals(true, equals(a, b));
+      expectEquals(referenceHashCode(a), hashCode(a));
+      for (int i = 0; i < length; i++) {
+        b[i] = (byte) (i * 37);
+        expectEquals(false, equals(a, b));
+        a[i] = b[i];
+        expectEquals(true, equals(b, a));
+        expectEquals(referenceHashCode(b), hashCode(b));
+      }
+      expectEquals(false, equals(a, new byte[length + 1]));
+    }
+
+    byte[] a = new byte[3];
+    expectEquals(true, equals(a, a));
+    expectEquals(true, equals(null, null));
+    expectEquals(false, equals(a, null));
+    expectEquals(false, equals(null, a));
+    expectEquals(0, hashCode(null));
+    try {
+      fill(null, (byte) 1);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(boolean expected, boolean result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
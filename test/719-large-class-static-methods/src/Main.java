@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Method;
+
+/**
+ * A class with more direct methods than the class linker links when initializing it. Its
+ * static methods are linked when they are first invoked.
+ */
+class Large {
+  static int base = 1000;
+
+  static int m0(int x) { return x + 0; }
+  static int m1(int x) { return x + 1; }
+  static int m2(int x) { return x + 2; }
+  static int m3(int x) { return x + 3; }
+  static int m4(int x) { return x + 4; }
+  static int m5(int x) { return x + 5; }
+  static int m6(int x) { return x + 6; }
+  static int m7(int x) { return x + 7; }
+  static int m8(int x) { return x + 8; }
+  static int m9(int x) { return x + 9; }
+  static int m10(int x) { return x + 10; }
+  static int m11(int x) { return x + 11; }
+  static int m12(int x) { return x + 12; }
+  static int m13(int x) { return x + 13; }
+  static int m14(int x) { return x + 14; }
+  static int m15(int x) { return x + 15; }
+  static int m16(int x) { return x + 16; }
+  static int m17(int x) { return x + 17; }
+  static int m18(int x) { return x + 18; }
+  static int m19(int x) { return x + 19; }
+  static int m20(int x) { return x + 20; }
+  static int m21(int x) { return x + 21; }
+  static int m22(int x) { return x + 22; }
+  static int m23(int x) { return x + 23; }
+  static int m24(int x) { return x + 24; }
+  static int m25(int x) { return x + 25; }
+  static int m26(int x) { return x + 26; }
+  static int m27(int x) { return x + 27; }
+  static int m28(int x) { return x + 28; }
+  static int m29(int x) { return x + 29; }
+  static int m30(int x) { return x + 30; }
+  static int m31(int x) { return x + 31; }
+  static int m32(int x) { return x + 32; }
+  static int m33(int x) { return x + 33; }
+  static int m34(int x) { return x + 34; }
+  static int m35(int x) { return x + 35; }
+  static int m36(int x) { return x + 36; }
+  static int m37(int x) { return x + 37; }
+  static int m38(int x) { return x + 38; }
+  static int m39(int x) { return x + 39; }
+  static int m40(int x) { return x + 40; }
+  static int m41(int x) { return x + 41; }
+  static int m42(int x) { return x + 42; }
+  static int m43(int x) { return x + 43; }
+  static int m44(int x) { return x + 44; }
+  static int m45(int x) { return x + 45; }
+  static int m46(int x) { return x + 46; }
+  static int m47(int x) { return x + 47; }
+  static int m48(int x) { return x + 48; }
+  static int m49(int x) { return x + 49; }
+  static int m50(int x) { return x + 50; }
+  static int m51(int x) { return x + 51; }
+  static int m52(int x) { return x + 52; }
+  static int m53(int x) { return x + 53; }
+  static int m54(int x) { return x + 54; }
+  static int m55(int x) { return x + 55; }
+  static int m56(int x) { return x + 56; }
+  static int m57(int x) { return x + 57; }
+  static int m58(int x) { return x + 58; }
+  static int m59(int x) { return x + 59; }
+  static int m60(int x) { return x + 60; }
+  static int m61(int x) { return x + 61; }
+  static int m62(int x) { return x + 62; }
+  static int m63(int x) { return x + 63; }
+  static int m64(int x) { return x + 64; }
+  static int m65(int x) { return x + 65; }
+  static int m66(int x) { return x + 66; }
+  static int m67(int x) { return x + 67; }
+  static int m68(int x) { return x + 68; }
+  static int m69(int x) { return x + 69; }
+  static int m70(int x) { return x + 70; }
+  static int m71(int x) { return x + 71; }
+  static int m72(int x) { return x + 72; }
+  static int m73(int x) { return x + 73; }
+  static int m74(int x) { return x + 74; }
+  static int m75(int x) { return x + 75; }
+  static int m76(int x) { return x + 76; }
+  static int m77(int x) { return x + 77; }
+  static int m78(int x) { return x + 78; }
+  static int m79(int x) { return x + 79; }
+}
+
+public class Main {
+  public static void main(String[] args) throws Exception {
+    // Initializes the class.
+    expectEquals(1000, Large.base);
+    // The first invoke of a method links it, the second one goes to its code.
+    for (int i = 0; i < 2; i++) {
+      expectEquals(1, Large.m0(1));
+      expectEquals(41, Large.m40(1));
+      expectEquals(80, Large.m79(1));
+    }
+
+    // Concurrent first invokes.
+    Thread[] threads = new Thread[4];
+    for (int i = 0; i < threads.length; i++) {
+      threads[i] = new Thread() {
+        public void run() {
+          expectEquals(11, Large.m10(1));
+          expectEquals(21, Large.m20(1));
+        }
+      };
+      threads[i].start();
+    }
+    for (Thread thread : threads) {
+      thread.join();
+    }
+
+    // Reflection goes through the same entrypoint.
+    Method m = Large.class.getDeclaredMethod("m50", int.class);
+    expectEquals(51, ((Integer) m.invoke(null, 1)).intValue());
+    expectEquals(51, Large.m50(1));
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+
+  /// CHECK-START: int Main.boxInteger(int) builder (after)
+  /// CHECK-DAG: InvokeStaticOrDirect intrinsic:IntegerValueOf
+  /// CHECK-DAG: intrinsic:IntegerIntValue
+
+  /// CHECK-START: int Main.boxInteger(int) instruction_simplifier (after)
+  /// CHECK-NOT: intrinsic:IntegerIntValue
+
+  /// CHECK-START: int Main.boxInteger(int) dead_code_elimination$initial (after)
+  /// CHECK-NOT: intrinsic:IntegerValueOf
+  static int boxInteger(int value) {
+    Integer box = value;
+    return box + 1;
+  }
+
+  /// CHECK-START: long Main.boxLong(long) builder (after)
+  /// CHECK-DAG: InvokeStaticOrDirect intrinsic:LongValueOf
+  /// CHECK-DAG: intrinsic:LongLongValue
+
+  /// CHECK-START: long Main.boxLong(long) instruction_simplifier (after)
+  /// CHECK-NOT: intrinsic:LongLongValue
+
+  /// CHECK-START: long Main.boxLong(long) dead_code_elimination$initial (after)
+  /// CHECK-NOT: intrinsic:LongValueOf
+  static long boxLong(long value) {
+    Long box = value;
+    return box + 1L;
+  }
+
+  /// CHECK-START: short Main.boxShort(short) instruction_simplifier (after)
+  /// CHECK-NOT: intrinsic:ShortShortValue
+
+  /// CHECK-START: short Main.boxShort(short) dead_code_elimination$initial (after)
+  /// CHECK-NOT: intrinsic:ShortValueOf
+  static short boxShort(short value) {
+    Short box = value;
+    return box;
+  }
+
+  /// CHECK-START: char Main.boxCharacter(char) instruction_simplifier (after)
+  /// CHECK-NOT: intrinsic:CharacterCharValue
+
+  /// CHECK-START: char Main.boxCharacter(char) dead_code_elimination$initial (after)
+  /// CHECK-NOT: intrinsic:CharacterValueOf
+  static char boxCharacter(char value) {
+    Character box = value;
+    return box;
+  }
+
+  // An unboxing without a matching box reads the value field.
+
+  /// CHECK-START: long Main.unboxLong(java.lang.Long) instruction_simplifier (after)
+  /// CHECK-DAG: <<Box:l\d+>>   ParameterValue
+  /// CHECK-DAG: <<Check:l\d+>> NullCheck [<<Box>>]
+  /// CHECK-DAG:                InstanceFieldGet [<<Check>>] field_name:java.lang.Long.value
+  /// CHECK-NOT:                intrinsic:LongLongValue
+  static long unboxLong(Long box) {
+    return box;
+  }
+
+  public static void main(String[] args) {
+    // Values inside and outside of the caches of the boxes.
+    expectEquals(6, boxInteger(5));
+    expectEquals(100001, boxInteger(100000));
+    expectEquals(Integer.MIN_VALUE, boxInteger(Integer.MAX_VALUE));
+    expectEquals(-1L, boxLong(-2L));
+    expectEquals((1L << 40) + 1, boxLong(1L << 40));
+    expectEquals(-129, boxShort((short) -129));
+    expectEquals(Short.MAX_VALUE, boxShort(Short.MAX_VALUE));
+    expectEquals('a', boxCharacter('a'));
+    expectEquals(Character.MAX_VALUE, boxCharacter(Character.MAX_VALUE));
+    expectEquals(42L, unboxLong(42L));
+    try {
+      unboxLong(null);
+      throw new Error("Expected NullPointerException");
+    } catch (NullPointerException expected) {
+    }
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(long expected, long result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
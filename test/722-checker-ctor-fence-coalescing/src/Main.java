@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Field;
+
+import sun.misc.Unsafe;
+
+class Point {
+  final int x;
+  final int y;
+
+  Point(int x, int y) {
+    this.x = x;
+    this.y = y;
+  }
+}
+
+public class Main {
+  private static final Unsafe unsafe = getUnsafe();
+
+  Point point;
+
+  // The fences of the new-instance and of the constructor are merged, and the merged fence
+  // is emitted as the store-release of the publishing store.
+
+  /// CHECK-START: void Main.publish(int) constructor_fence_redundancy_elimination (after)
+  /// CHECK:     <<NewInstance:l\d+>> NewInstance
+  /// CHECK:                          ConstructorFence [<<NewInstance>>]
+  /// CHECK-NOT:                      ConstructorFence
+  /// CHECK:                          InstanceFieldSet [{{l\d+}},<<NewInstance>>]
+
+  /// CHECK-START-ARM64: void Main.publish(int) disassembly (after)
+  /// CHECK:     ConstructorFence
+  /// CHECK-NOT: dmb
+  /// CHECK:     InstanceFieldSet
+  /// CHECK:     stlr
+  void publish(int x) {
+    point = new Point(x, x + 1);
+  }
+
+  // The store fence before the publishing store already orders the stores of the constructor.
+
+  /// CHECK-START: void Main.publishAfterStoreFence(int) constructor_fence_redundancy_elimination (before)
+  /// CHECK:     ConstructorFence
+  /// CHECK:     MemoryBarrier kind:AnyStore
+
+  /// CHECK-START: void Main.publishAfterStoreFence(int) constructor_fence_redundancy_elimination (after)
+  /// CHECK-NOT: ConstructorFence
+  void publishAfterStoreFence(int x) {
+    Point p = new Point(x, x + 1);
+    unsafe.storeFence();
+    point = p;
+  }
+
+  public static void main(String[] args) {
+    Main main = new Main();
+    main.publish(1);
+    expectEquals(1, main.point.x);
+    expectEquals(2, main.point.y);
+    main.publishAfterStoreFence(3);
+    expectEquals(3, main.point.x);
+    expectEquals(4, main.point.y);
+    System.out.println("passed");
+  }
+
+  // Use reflection to implement "Unsafe.getUnsafe()";
+  private static Unsafe getUnsafe() {
+    try {
+      Class<?> unsafeClass = Unsafe.class;
+      Field f = unsafeClass.getDeclaredField("theUnsafe");
+      f.setAccessible(true);
+      return (Unsafe) f.get(null);
+    } catch (Exception e) {
+      throw new Error("Cannot get Unsafe instance");
+    }
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
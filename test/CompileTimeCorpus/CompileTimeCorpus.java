@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// A fixed set of methods exercising the expensive Optimizing passes, compiled by
+// compile_time_test to track the compile time of each pass. Do not change it lightly,
+// as that resets the baseline of the measurements.
+class CompileTimeCorpus {
+    int a;
+    int b;
+    long c;
+    double d;
+    int[] array = new int[64];
+    CompileTimeCorpus next;
+
+    // Nested loops over arrays, for the loop optimization, BCE and the vectorizer.
+    static int loops(int[] x, int[] y, int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < x.length; j++) {
+                x[j] += y[j] * i;
+                sum += x[j] >> 1;
+            }
+            for (int j = x.length - 1; j >= 0; j--) {
+                y[j] ^= sum + j;
+            }
+        }
+        return sum;
+    }
+
+    static long matrix(long[][] m, long[][] p, long[][] out) {
+        long trace = 0;
+        for (int i = 0; i < out.length; i++) {
+            for (int j = 0; j < out[i].length; j++) {
+                long s = 0;
+                for (int k = 0; k < p.length; k++) {
+                    s += m[i][k] * p[k][j];
+                }
+                out[i][j] = s;
+            }
+            trace += out[i][i];
+        }
+        return trace;
+    }
+
+    // Field loads and stores, for the load store analysis and elimination.
+    int fields(CompileTimeCorpus other, boolean flag) {
+        a = other.a + 1;
+        b = a * 2;
+        if (flag) {
+            other.b = b;
+            c = a + other.c;
+        } else {
+            other.a = b;
+            d = other.d * a;
+        }
+        next = other;
+        next.a += b;
+        CompileTimeCorpus tmp = new CompileTimeCorpus();
+        tmp.a = a;
+        tmp.b = b;
+        tmp.array[a & 63] = b;
+        return tmp.a + tmp.b + next.a + b + (int) c + (int) d + tmp.array[b & 63];
+    }
+
+    // A large switch with many live values, for the register allocator.
+    static long switches(int op, long x, long y, int count) {
+        long r0 = x;
+        long r1 = y;
+        long r2 = x ^ y;
+        long r3 = x * 3;
+        long r4 = y * 5;
+        long r5 = x - y;
+        long r6 = x + 7;
+        long r7 = y - 11;
+        for (int i = 0; i < count; i++) {
+            switch ((op + i) & 15) {
+                case 0: r0 += r1; break;
+                case 1: r1 -= r2; break;
+                case 2: r2 *= r3; break;
+                case 3: r3 ^= r4; break;
+                case 4: r4 |= r5; break;
+                case 5: r5 &= r6; break;
+                case 6: r6 <<= (r7 & 7); break;
+                case 7: r7 >>= (r0 & 7); break;
+                case 8: r0 = r1 + r2 + r3; break;
+                case 9: r1 = r4 - r5 - r6; break;
+                case 10: r2 = r7 * r0; break;
+                case 11: r3 = r1 / (r2 | 1); break;
+                case 12: r4 = r3 % (r5 | 1); break;
+                case 13: r5 = -r6; break;
+                case 14: r6 = ~r7; break;
+                default: r7 = r0 + r1 + r2 + r3 + r4 + r5 + r6; break;
+            }
+        }
+        return r0 + r1 + r2 + r3 + r4 + r5 + r6 + r7;
+    }
+
+    // Calls of small methods, for the inliner.
+    int inlining(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += add(i, a) + mul(i, b) + add(mul(i, i), sum);
+            if (isEven(i)) {
+                sum = add(sum, getA());
+            }
+        }
+        return sum;
+    }
+
+    static int add(int x, int y) {
+        return x + y;
+    }
+
+    static int mul(int x, int y) {
+        return x * y;
+    }
+
+    static boolean isEven(int x) {
+        return (x & 1) == 0;
+    }
+
+    int getA() {
+        return a;
+    }
+
+    // Exceptions and try/catch, for the graph building of catch blocks.
+    static int exceptions(Object[] objects, int index) {
+        int result = 0;
+        try {
+            result = objects[index].hashCode();
+            result += ((String) objects[index + 1]).length();
+        } catch (ArrayIndexOutOfBoundsException e) {
+            result = -1;
+        } catch (ClassCastException e) {
+            result = -2;
+        } finally {
+            result++;
+        }
+        return result;
+    }
+
+    // Floating point with conditions, for GVN and LICM.
+    static double floats(double[] values, double scale) {
+        double min = Double.MAX_VALUE;
+        double max = -Double.MAX_VALUE;
+        double sum = 0.0;
+        for (int i = 0; i < values.length; i++) {
+            double v = values[i] * scale + Math.sqrt(scale);
+            if (v < min) {
+                min = v;
+            }
+            if (v > max) {
+                max = v;
+            }
+            sum += v * scale + Math.sqrt(scale);
+        }
+        return (sum - min) / (max - min + 1.0);
+    }
+
+    static String strings(String[] parts) {
+        StringBuilder builder = new StringBuilder();
+        for (String part : parts) {
+            if (part.isEmpty()) {
+                continue;
+            }
+            builder.append(part.charAt(0)).append(part.length()).append(',');
+        }
+        return builder.toString();
+    }
+}
@@ -0,0 +1,203 @@
+#!/usr/bin/env python3.4
+#
+# Copyright (C) 2017 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Measures the JIT warm-up and steady state of the JitWarmup workloads.
+
+See README.md.
+
+Example usage:
+./jit_warmup.py -cp jit-warmup.dex --output new.json --compare old.json
+"""
+
+import argparse
+import json
+import os
+import statistics
+import sys
+
+sys.path.append(os.path.dirname(os.path.dirname(
+        os.path.realpath(__file__))))
+
+from common.common import DeviceTestEnv
+from common.common import HostTestEnv
+from common.common import LogSeverity
+from common.common import RetCode
+
+# The runtime options of the default configurations, compared with each other.
+DEFAULT_CONFIGS = {
+    'interpreter': ['-Xusejit:false'],
+    'jit': ['-Xusejit:true'],
+    'jit-low-threshold': ['-Xusejit:true', '-Xjitthreshold:1000'],
+    'jit-high-threshold': ['-Xusejit:true', '-Xjitthreshold:50000'],
+    'jit-baseline-tier': ['-Xusejit:true', '-Xjitoptimizethreshold:10000'],
+}
+
+# An iteration is in the steady state once within this ratio of the steady state time.
+STEADY_STATE_TOLERANCE = 1.1
+
+
+def ParseOutput(output):
+  """Returns {workload: [(ns, jit compilations, code cache bytes)]} and the JIT records."""
+  iterations = {}
+  records = []
+  for line in output.splitlines():
+    fields = line.split()
+    if fields and fields[0] == 'iteration' and len(fields) == 6:
+      iterations.setdefault(fields[1], []).append(
+          (int(fields[3]), int(fields[4]), int(fields[5])))
+    elif line.startswith('jit-record '):
+      records.append(line[len('jit-record '):])
+  return iterations, records
+
+
+def Summarize(samples):
+  """Summarizes the iterations of a workload.
+
+  The steady state time is the median of the last quarter of the iterations. The warm-up ends
+  with the first iteration within STEADY_STATE_TOLERANCE of it, and its time is the sum of the
+  iterations before.
+  """
+  times = [ns for (ns, _, _) in samples]
+  steady_ns = statistics.median(times[-max(1, len(times) // 4):])
+  warmup_iterations = len(times)
+  for index, ns in enumerate(times):
+    if ns <= steady_ns * STEADY_STATE_TOLERANCE:
+      warmup_iterations = index
+      break
+  return {
+      'first_iteration_ns': times[0],
+      'steady_state_ns': steady_ns,
+      'warmup_iterations': warmup_iterations,
+      'warmup_ns': sum(times[:warmup_iterations]),
+      'total_ns': sum(times),
+      'jit_compilations': samples[-1][1],
+      'code_cache_bytes': samples[-1][2],
+      'iteration_ns': times,
+  }
+
+
+def RunConfig(test_env, base_cmd, options, runs):
+  """Runs the workloads runs times, in new processes, and summarizes the fastest run."""
+  results = {}
+  records = []
+  for _ in range(runs):
+    (output, retcode) = test_env.RunCommand(base_cmd[:1] + options + base_cmd[1:],
+                                            LogSeverity.ERROR)
+    if retcode != RetCode.SUCCESS:
+      raise RuntimeError('Run failed with {0}:\n{1}'.format(retcode, output))
+    iterations, run_records = ParseOutput(output)
+    for workload, samples in iterations.items():
+      summary = Summarize(samples)
+      best = results.get(workload)
+      if best is None or summary['total_ns'] < best['total_ns']:
+        results[workload] = summary
+        records = run_records
+  return {'workloads': results, 'jit_records': records}
+
+
+def Compare(old, new, threshold):
+  """Prints the changes of the warm-up and steady state, returns whether any regressed."""
+  regressed = False
+  for config in sorted(new):
+    if config not in old:
+      continue
+    for workload in sorted(new[config]['workloads']):
+      old_summary = old[config]['workloads'].get(workload)
+      if old_summary is None:
+        continue
+      new_summary = new[config]['workloads'][workload]
+      for metric in ['warmup_ns', 'steady_state_ns', 'total_ns']:
+        old_value = old_summary[metric]
+        new_value = new_summary[metric]
+        change = (new_value - old_value) / old_value if old_value else 0.0
+        flag = ''
+        if change > threshold:
+          flag = '  REGRESSION'
+          regressed = True
+        print('{0:20} {1:12} {2:16} {3:14.0f} -> {4:14.0f} {5:+7.1%}{6}'.format(
+            config, workload, metric, old_value, new_value, change, flag))
+  return regressed
+
+
+def PrepareParser():
+  parser = argparse.ArgumentParser(
+      description='Measures the JIT warm-up and steady state of the JitWarmup workloads.')
+  parser.add_argument('-cp', '--classpath', required=True, help='dex file with JitWarmup')
+  parser.add_argument('--device', action='store_true', default=False, help='run on device')
+  parser.add_argument('--device-serial', help='device serial number, implies --device')
+  parser.add_argument('--64', dest='x64', action='store_true', default=False,
+                      help='x64 mode')
+  parser.add_argument('--iterations', type=int, default=100,
+                      help='iterations of each workload per run')
+  parser.add_argument('--runs', type=int, default=3,
+                      help='runs per configuration, the fastest one is kept')
+  parser.add_argument('--config', action='append', default=[],
+                      help='NAME=OPTION[,OPTION...], replaces the default configurations')
+  parser.add_argument('--workload', action='append', default=[],
+                      help='workload to run, all by default')
+  parser.add_argument('--output', help='file to write the results to, as JSON')
+  parser.add_argument('--compare', help='results of an earlier build to compare with')
+  parser.add_argument('--threshold', type=float, default=0.05,
+                      help='relative slowdown reported as a regression')
+  parser.add_argument('--timeout', type=int, default=600, help='seconds per run')
+  return parser
+
+
+def main():
+  args = PrepareParser().parse_args()
+  if args.device_serial:
+    args.device = True
+  configs = DEFAULT_CONFIGS
+  if args.config:
+    configs = {}
+    for config in args.config:
+      name, _, options = config.partition('=')
+      configs[name] = options.split(',') if options else []
+
+  classpath = args.classpath
+  if args.device:
+    test_env = DeviceTestEnv('jit_warmup_', timeout=args.timeout,
+                             specific_device=args.device_serial)
+    classpath = test_env.PushClasspath(classpath)
+  else:
+    test_env = HostTestEnv('jit_warmup_', timeout=args.timeout, x64=args.x64)
+  # The workloads must not be compiled ahead of time.
+  base_cmd = ['dalvikvm64' if args.x64 else 'dalvikvm',
+              '-Xcompiler-option', '--compiler-filter=quicken',
+              '-cp', classpath, 'JitWarmup', '--iterations', str(args.iterations)]
+  base_cmd += args.workload
+
+  results = {}
+  for name in sorted(configs):
+    results[name] = RunConfig(test_env, base_cmd, configs[name], args.runs)
+    for workload, summary in sorted(results[name]['workloads'].items()):
+      print('{0:20} {1:12} first {2:10.0f}ns steady {3:10.0f}ns warm-up {4:4} iterations '
+            '{5:12.0f}ns, {6} JIT compilations, {7} code cache bytes'.format(
+                name, workload, summary['first_iteration_ns'], summary['steady_state_ns'],
+                summary['warmup_iterations'], summary['warmup_ns'],
+                summary['jit_compilations'], summary['code_cache_bytes']))
+
+  if args.output:
+    with open(args.output, 'w') as output_file:
+      json.dump(results, output_file, indent=2, sort_keys=True)
+  if args.compare:
+    with open(args.compare, 'r') as compare_file:
+      if Compare(json.load(compare_file), results, args.threshold):
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Method;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Runs workloads for a number of iterations and prints the time of each iteration with the JIT
+ * compilations and the code cache size so far, see jit_warmup.py which parses the output:
+ *
+ *   iteration <workload> <index> <ns> <jit compilations> <code cache bytes>
+ *   jit-record <art.jit.compilation-records line>
+ *
+ * Each workload does the same work in every iteration, so that the iteration times only change
+ * with the code that runs them.
+ */
+public class JitWarmup {
+  interface Workload {
+    String name();
+    // Returns a value depending on all of the work, so that it is not optimized away.
+    long run();
+  }
+
+  static class CollectionsWorkload implements Workload {
+    public String name() {
+      return "collections";
+    }
+
+    public long run() {
+      Map<Integer, List<Integer>> buckets = new HashMap<Integer, List<Integer>>();
+      for (int i = 0; i < 20000; ++i) {
+        Integer key = i % 97;
+        List<Integer> bucket = buckets.get(key);
+        if (bucket == null) {
+          bucket = new ArrayList<Integer>();
+          buckets.put(key, bucket);
+        }
+        bucket.add(i * 31);
+      }
+      long sum = 0;
+      for (List<Integer> bucket : buckets.values()) {
+        Collections.sort(bucket, Collections.reverseOrder());
+        sum += bucket.get(0);
+      }
+      return sum;
+    }
+  }
+
+  static class StringsWorkload implements Workload {
+    public String name() {
+      return "strings";
+    }
+
+    public long run() {
+      StringBuilder builder = new StringBuilder();
+      for (int i = 0; i < 2000; ++i) {
+        builder.append("item").append(i).append(',');
+      }
+      String text = builder.toString();
+      long sum = 0;
+      for (String item : text.split(",")) {
+        sum += item.toUpperCase().hashCode() + item.indexOf('1');
+      }
+      return sum;
+    }
+  }
+
+  static class NumericWorkload implements Workload {
+    private static final int N = 48;
+    private final double[][] a = new double[N][N];
+    private final double[][] b = new double[N][N];
+    private final double[][] c = new double[N][N];
+
+    NumericWorkload() {
+      for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+          a[i][j] = i + j;
+          b[i][j] = i - j;
+        }
+      }
+    }
+
+    public String name() {
+      return "numeric";
+    }
+
+    public long run() {
+      // Matrix multiplication and a sieve, for floating point and integer loops.
+      for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+          double sum = 0.0;
+          for (int k = 0; k < N; ++k) {
+            sum += a[i][k] * b[k][j];
+          }
+          c[i][j] = sum;
+        }
+      }
+      boolean[] composite = new boolean[50000];
+      long primes = 0;
+      for (int i = 2; i < composite.length; ++i) {
+        if (!composite[i]) {
+          ++primes;
+          for (int j = 2 * i; j < composite.length; j += i) {
+            composite[j] = true;
+          }
+        }
+      }
+      return primes + (long) c[N - 1][N - 1];
+    }
+  }
+
+  // Usage: JitWarmup [--iterations N] [workload...]
+  public static void main(String[] args) throws Exception {
+    int iterations = 100;
+    List<String> names = new ArrayList<String>();
+    for (int i = 0; i < args.length; ++i) {
+      if (args[i].equals("--iterations")) {
+        iterations = Integer.parseInt(args[++i]);
+      } else {
+        names.add(args[i]);
+      }
+    }
+    Workload[] workloads = {
+        new CollectionsWorkload(), new StringsWorkload(), new NumericWorkload() };
+    long check = 0;
+    for (Workload workload : workloads) {
+      if (!names.isEmpty() && !names.contains(workload.name())) {
+        continue;
+      }
+      for (int i = 0; i < iterations; ++i) {
+        long start = System.nanoTime();
+        check += workload.run();
+        long elapsed = System.nanoTime() - start;
+        System.out.println("iteration " + workload.name() + " " + i + " " + elapsed + " "
+            + getJitCompilations() + " " + getLongStat("art.jit.code-cache-size"));
+      }
+    }
+    // The latest compilations of the whole run, the runtime only keeps a few hundred.
+    String records = getRuntimeStat("art.jit.compilation-records");
+    if (records != null) {
+      for (String record : records.split("\n")) {
+        if (!record.isEmpty()) {
+          System.out.println("jit-record " + record);
+        }
+      }
+    }
+    System.out.println("check " + check);
+  }
+
+  // The "JIT compilations" line of the art.runtime.counters stat.
+  private static long getJitCompilations() {
+    String counters = getRuntimeStat("art.runtime.counters");
+    if (counters != null) {
+      for (String line : counters.split("\n")) {
+        if (line.startsWith("JIT compilations: ")) {
+          return Long.parseLong(line.substring("JIT compilations: ".length()));
+        }
+      }
+    }
+    return 0L;
+  }
+
+  private static String getRuntimeStat(String name) {
+    try {
+      Class<?> vmDebug = Class.forName("dalvik.system.VMDebug");
+      Method getRuntimeStat = vmDebug.getDeclaredMethod("getRuntimeStat", String.class);
+      return (String) getRuntimeStat.invoke(null, name);
+    } catch (Exception e) {
+      // Not running on ART.
+      return null;
+    }
+  }
+
+  private static long getLongStat(String name) {
+    String value = getRuntimeStat(name);
+    return (value != null) ? Long.parseLong(value) : 0L;
+  }
+}